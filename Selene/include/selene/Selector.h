@@ -361,30 +361,43 @@ public:
 
     // Vector of keys in the table
     std::vector<std::string> getKeys() const {
+        std::vector<std::string> vec;
+        forEach([&vec](const std::string& key, int) {
+            vec.push_back(key);
+        });
+        return vec;
+    }
+
+    // Calls fun(key, valueIndex) for every entry of the table in a single
+    // lua_next() pass. The key is converted to a string (entries with other
+    // keys are skipped), the value stays at the absolute stack index
+    // valueIndex during the call. fun may push values, the stack is reset
+    // after each call. Nothing is called if the element is no table.
+    template <typename Fun>
+    void forEach(Fun&& fun) const {
         ResetStackOnScopeExit save(_state);
         _evaluate_retrieve(1);
-        std::vector<std::string> vec;
+        if (!lua_istable(_state, -1)) {
+            return;
+        }
+        const int table = lua_absindex(_state, -1);
 
         // see: https://stackoverflow.com/questions/6137684/iterate-through-lua-table
-        // stack now contains: -1 => table
         lua_pushnil(_state);
-        // stack now contains: -1 => nil; -2 => table
-        while (lua_next(_state, -2))
+        while (lua_next(_state, table))
         {
             // stack now contains: -1 => value; -2 => key; -3 => table
-            // copy the key so that lua_tostring does not modify the original
+            const int value = lua_absindex(_state, -1);
+            // copy the key so that lua_tolstring does not modify the original
             lua_pushvalue(_state, -2);
-            // stack now contains: -1 => key; -2 => value; -3 => key; -4 => table
-            const char *keyStr = lua_tostring(_state, -1);
+            size_t length = 0;
+            const char *keyStr = lua_tolstring(_state, -1, &length);
             if(keyStr != NULL) {
-                vec.push_back(keyStr);
+                fun(std::string(keyStr, length), value);
             }
-            // pop value + copy of key, leaving original key
-            lua_pop(_state, 2);
-            // stack now contains: -1 => key; -2 => table
+            // leave the original key for lua_next()
+            lua_settop(_state, value - 1);
         }
-
-        return vec;
     }
 
     std::string toString() const {
@@ -27,6 +27,13 @@ public:
         _registry.reset(new Registry(_l));
         HandleExceptionsPrintingToStdOut();
     }
+    State(lua_Alloc allocator, void *ud, bool should_open_libs) : _l(nullptr), _l_owner(true), _exception_handler(new ExceptionHandler) {
+        _l = lua_newstate(allocator, ud);
+        if (_l == nullptr) throw 0;
+        if (should_open_libs) luaL_openlibs(_l);
+        _registry.reset(new Registry(_l));
+        HandleExceptionsPrintingToStdOut();
+    }
     State(lua_State *l) : _l(l), _l_owner(false), _exception_handler(new ExceptionHandler) {
         _registry.reset(new Registry(_l));
         HandleExceptionsPrintingToStdOut();
@@ -59,6 +66,10 @@ public:
         return lua_gettop(_l);
     }
 
+    lua_State *GetLuaState() const {
+        return _l;
+    }
+
     bool Load(const std::string &file) {
         ResetStackOnScopeExit savedStack(_l);
         int status = luaL_loadfile(_l, file.c_str());
@@ -0,0 +1,107 @@
+/**
+ * @file benchmark.cpp
+ *
+ * Minimal benchmark runner. Each registered benchmark is calibrated until one
+ * run takes at least `MIN_RUN_TIME`, then it is repeated `REPETITIONS` times
+ * and the median time per iteration is reported, so a single slow run (e.g.
+ * due to a context switch) does not distort the result.
+ *
+ * Usage: `request_path_benchmark [filter]`, only the benchmarks containing
+ * the filter in their name are run.
+ */
+
+#include "benchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+static constexpr chrono::nanoseconds MIN_RUN_TIME = chrono::milliseconds(200);
+static constexpr int REPETITIONS = 5;
+static constexpr uint64_t MAX_ITERATIONS = 1000000000;
+
+static uint64_t nowNs() noexcept
+{
+    return uint64_t(chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static vector<pair<string, function<void(BenchmarkState&)>>>& getBenchmarks()
+{
+    static vector<pair<string, function<void(BenchmarkState&)>>> benchmarks;
+    return benchmarks;
+}
+
+BenchmarkState::BenchmarkState(uint64_t iterations) noexcept
+: iterations_(iterations)
+, remaining_(iterations)
+{
+}
+
+/**
+ * @return true as long as the benchmark has to do another iteration, the
+ *         time is measured from the first to the last call
+ */
+bool BenchmarkState::keepRunning() noexcept
+{
+    if (startNs_ == 0)
+    {
+        startNs_ = nowNs();
+    }
+    if (remaining_ == 0)
+    {
+        elapsedNs_ = nowNs() - startNs_;
+        return false;
+    }
+    --remaining_;
+    return true;
+}
+
+BenchmarkRegistration::BenchmarkRegistration(const string& name, function<void(BenchmarkState&)> function)
+{
+    getBenchmarks().emplace_back(name, move(function));
+}
+
+static uint64_t run(const function<void(BenchmarkState&)>& benchmark, uint64_t iterations)
+{
+    BenchmarkState state(iterations);
+    benchmark(state);
+    return max<uint64_t>(state.getElapsedNs(), 1);
+}
+
+int main(int argc, char** argv)
+{
+    const string filter = argc > 1 ? argv[1] : "";
+    printf("%-50s %12s %14s\n", "benchmark", "iterations", "ns/iteration");
+    for (const auto& benchmark : getBenchmarks())
+    {
+        if (benchmark.first.find(filter) == string::npos)
+        {
+            continue;
+        }
+
+        uint64_t iterations = 1;
+        uint64_t elapsedNs = run(benchmark.second, iterations);
+        while (elapsedNs < uint64_t(MIN_RUN_TIME.count()) && iterations < MAX_ITERATIONS)
+        {
+            const uint64_t factor = min<uint64_t>(10, uint64_t(MIN_RUN_TIME.count()) * 12 / 10 / elapsedNs + 1);
+            iterations = min(iterations * max<uint64_t>(factor, 2), MAX_ITERATIONS);
+            elapsedNs = run(benchmark.second, iterations);
+        }
+
+        vector<double> results;
+        for (int i = 0; i < REPETITIONS; ++i)
+        {
+            results.push_back(double(run(benchmark.second, iterations)) / double(iterations));
+        }
+        sort(results.begin(), results.end());
+        printf("%-50s %12llu %14.1f\n", benchmark.first.c_str(),
+               static_cast<unsigned long long>(iterations), results[REPETITIONS / 2]);
+        fflush(stdout);
+    }
+    return 0;
+}
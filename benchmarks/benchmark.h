@@ -0,0 +1,72 @@
+/**
+ * @file benchmark.h
+ *
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+/**
+ * The loop of one benchmark run:
+ *
+ *     static void benchmarkAscii(BenchmarkState& state)
+ *     {
+ *         while (state.keepRunning())
+ *         {
+ *             doNotOptimize(EcuLuaScript::ascii("SALGA2EV9HA298784"));
+ *         }
+ *     }
+ *     BENCHMARK(benchmarkAscii);
+ *
+ * Everything before the loop is not measured.
+ */
+class BenchmarkState
+{
+public:
+    explicit BenchmarkState(std::uint64_t iterations) noexcept;
+
+    bool keepRunning() noexcept;
+    std::uint64_t getIterations() const noexcept { return iterations_; }
+    std::uint64_t getElapsedNs() const noexcept { return elapsedNs_; }
+
+private:
+    std::uint64_t iterations_;
+    std::uint64_t remaining_;
+    std::uint64_t startNs_ = 0;
+    std::uint64_t elapsedNs_ = 0;
+};
+
+/**
+ * Registers a benchmark, see `BENCHMARK()`.
+ */
+struct BenchmarkRegistration
+{
+    BenchmarkRegistration(const std::string& name, std::function<void(BenchmarkState&)> function);
+};
+
+/**
+ * Keeps the compiler from removing the computation of the given value.
+ */
+template<class T>
+inline void doNotOptimize(const T& value) noexcept
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+#define BENCHMARK_CONCAT_(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT_(a, b)
+
+/// registers the function `void name(BenchmarkState&)`
+#define BENCHMARK(function) \
+    static BenchmarkRegistration BENCHMARK_CONCAT(benchmarkRegistration, __LINE__)(#function, function)
+
+/// registers a benchmark with a fixed argument, e.g. the size of the input
+#define BENCHMARK_WITH_ARG(function, arg) \
+    static BenchmarkRegistration BENCHMARK_CONCAT(benchmarkRegistration, __LINE__)( \
+        std::string(#function "/") + #arg, [](BenchmarkState& state) { function(state, arg); })
+
+#endif /* BENCHMARK_H */
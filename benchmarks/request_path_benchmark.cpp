@@ -0,0 +1,376 @@
+/**
+ * @file request_path_benchmark.cpp
+ *
+ * Microbenchmarks of the request lookup and response functions. Everything
+ * runs without sockets: the Raw tables are generated into temporary Lua
+ * scripts with a given number of entries and a given share of placeholder
+ * ("XX") and wildcard ("*") requests.
+ */
+
+#include "benchmark.h"
+#include "ecu_lua_script.h"
+#include "j1939_simulator.h"
+#include "crc_stream.h"
+#include "libcrc/checksum.h"
+#include <unistd.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+
+constexpr char BENCHMARK_ECU[] = "Bench";
+constexpr size_t REQUEST_COUNT = 1024; ///< the lookups cycle through this many requests
+constexpr unsigned MISS_PERCENT = 10; ///< requests which are not in the table
+constexpr uint8_t SERVICE_IDENTIFIERS[] = {0x22, 0x2E, 0x31, 0x19};
+
+/**
+ * Parameters of a generated Raw table.
+ */
+struct RawTable
+{
+    size_t entries;
+    unsigned placeholderPercent;
+    unsigned wildcardPercent;
+    bool isLuaFunction; ///< all responses are Lua functions instead of strings
+    bool isBinary; ///< the Lua functions are wrapped in `binary()`
+};
+
+const RawTable RAW_10 = {10, 0, 0, false, false};
+const RawTable RAW_1K_MIXED = {1000, 10, 1, false, false};
+const RawTable RAW_100K = {100000, 0, 0, false, false};
+const RawTable RAW_100K_MIXED = {100000, 10, 1, false, false};
+const RawTable RAW_10_LUA = {10, 0, 0, true, false};
+const RawTable RAW_10_BINARY = {10, 0, 0, true, true};
+
+/// deterministic pseudo random number of the given entry
+unsigned hashEntry(size_t entry, unsigned seed) noexcept
+{
+    uint32_t x = uint32_t(entry) * 2654435761u + seed * 40503u;
+    x ^= x >> 15;
+    x *= 2246822519u;
+    x ^= x >> 13;
+    return x % 100;
+}
+
+/**
+ * A generated Raw table, loaded into an `EcuLuaScript`, and the requests to
+ * look up.
+ */
+struct Fixture
+{
+    unique_ptr<EcuLuaScript> pScript;
+    shared_ptr<RequestByteTreeNode<RequestResponse>> pTree;
+    LuaRequestMatcher matcher;
+    vector<vector<uint8_t>> requests;
+};
+
+/**
+ * Generates the Lua script of the given table, e.g. `["22 00 00 01 XX"] =
+ * "62 00 00 01"`. The requests are unique, since the entry number is encoded
+ * in the request bytes.
+ */
+Fixture* createFixture(const RawTable& table)
+{
+    char scriptFile[] = "/tmp/request_path_benchmark_XXXXXX";
+    const int fd = mkstemp(scriptFile);
+    if (fd < 0)
+    {
+        perror("mkstemp");
+        return nullptr;
+    }
+    close(fd);
+
+    Fixture* pFixture = new Fixture();
+    ofstream script(scriptFile);
+    script << BENCHMARK_ECU << " = {\n    Raw = {\n";
+    char bytes[32];
+    for (size_t i = 0; i < table.entries; ++i)
+    {
+        const uint8_t sid = SERVICE_IDENTIFIERS[i % sizeof(SERVICE_IDENTIFIERS)];
+        const size_t id = i / sizeof(SERVICE_IDENTIFIERS);
+        vector<uint8_t> request = {sid, uint8_t(id >> 16), uint8_t(id >> 8), uint8_t(id)};
+        snprintf(bytes, sizeof(bytes), "%02X %02X %02X %02X", request[0], request[1], request[2], request[3]);
+        string key = bytes;
+        if (hashEntry(i, 1) < table.placeholderPercent)
+        {
+            key += " XX";
+            request.push_back(0x5A);
+        }
+        if (hashEntry(i, 2) < table.wildcardPercent)
+        {
+            key += " *";
+            request.push_back(0x01);
+            request.push_back(0x02);
+        }
+        snprintf(bytes, sizeof(bytes), "%02X %02X %02X %02X", sid + 0x40, request[1], request[2], request[3]);
+        script << "        [\"" << key << "\"] = ";
+        if (table.isBinary)
+        {
+            snprintf(bytes, sizeof(bytes), "\\x%02X\\x%02X\\x%02X\\x%02X", sid + 0x40, request[1], request[2], request[3]);
+            script << "binary(function(request) return \"" << bytes << "\" end),\n";
+        }
+        else if (table.isLuaFunction)
+        {
+            script << "function(request) return \"" << bytes << "\" end,\n";
+        }
+        else
+        {
+            script << '"' << bytes << "\",\n";
+        }
+
+        if (i % max<size_t>(1, table.entries / REQUEST_COUNT) == 0)
+        {
+            pFixture->requests.push_back(request);
+        }
+    }
+    script << "    }\n}\n";
+    script.close();
+
+    // add the misses and spread them over the requests
+    const size_t misses = max<size_t>(1, pFixture->requests.size() * MISS_PERCENT / 100);
+    for (size_t i = 0; i < misses; ++i)
+    {
+        const vector<uint8_t> miss = {0x3E, 0xFF, uint8_t(i), 0x00};
+        pFixture->requests.insert(pFixture->requests.begin() + (i * 10) % pFixture->requests.size(), miss);
+    }
+
+    pFixture->pScript = std::make_unique<EcuLuaScript>(BENCHMARK_ECU, scriptFile);
+    pFixture->pTree = pFixture->pScript->buildRequestByteTreeFromRawTable();
+    pFixture->matcher = LuaRequestMatcher(pFixture->pTree);
+    remove(scriptFile);
+    return pFixture;
+}
+
+/**
+ * @return the fixture of the given table, which is created on the first call
+ */
+Fixture& getFixture(const RawTable& table)
+{
+    static map<const RawTable*, unique_ptr<Fixture>> fixtures;
+    unique_ptr<Fixture>& pFixture = fixtures[&table];
+    if (!pFixture)
+    {
+        pFixture.reset(createFixture(table));
+    }
+    return *pFixture;
+}
+
+void getValueFromTree(BenchmarkState& state, const RawTable& table)
+{
+    Fixture& fixture = getFixture(table);
+    size_t i = 0;
+    while (state.keepRunning())
+    {
+        const vector<uint8_t>& request = fixture.requests[i++ % fixture.requests.size()];
+        doNotOptimize(fixture.pScript->getValueFromTree(fixture.pTree, request));
+    }
+}
+
+void getRawResponse(BenchmarkState& state, const RawTable& table)
+{
+    Fixture& fixture = getFixture(table);
+    size_t i = 0;
+    while (state.keepRunning())
+    {
+        const vector<uint8_t>& request = fixture.requests[i++ % fixture.requests.size()];
+        doNotOptimize(fixture.pScript->getRawResponse(fixture.matcher, request.data(), uint32_t(request.size())));
+    }
+}
+
+/// calls the Lua function of the first request with the given calling convention
+void callLuaResponse(BenchmarkState& state, const RawTable& table)
+{
+    Fixture& fixture = getFixture(table);
+    const vector<uint8_t>& request = fixture.requests[0];
+    const RequestResponse *response = fixture.matcher.match(request.data(), request.size());
+    vector<uint8_t> bytes;
+    while (state.keepRunning())
+    {
+        fixture.pScript->callLuaResponse(*response, request.data(), uint32_t(request.size()), bytes);
+        doNotOptimize(bytes.data());
+    }
+}
+
+void buildRequestByteTreeFromRawTable(BenchmarkState& state, const RawTable& table)
+{
+    Fixture& fixture = getFixture(table);
+    while (state.keepRunning())
+    {
+        doNotOptimize(fixture.pScript->buildRequestByteTreeFromRawTable());
+    }
+}
+
+void compileRequestMatcher(BenchmarkState& state, const RawTable& table)
+{
+    Fixture& fixture = getFixture(table);
+    while (state.keepRunning())
+    {
+        const LuaRequestMatcher matcher(fixture.pTree);
+        doNotOptimize(matcher.getNodeCount());
+    }
+}
+
+void literalHexStrToBytes(BenchmarkState& state)
+{
+    const string response = "62 F1 90 53 41 4C 47 41 32 45 56 39 48 41 32 39 38 37 38 34 "
+                            "00 01 02 03 04 05 06 07 08 09 0A 0B 0C 0D 0E 0F";
+    while (state.keepRunning())
+    {
+        doNotOptimize(EcuLuaScript::literalHexStrToBytes(response));
+    }
+}
+
+void toByteResponse(BenchmarkState& state)
+{
+    uint32_t value = 0x12345678;
+    while (state.keepRunning())
+    {
+        doNotOptimize(EcuLuaScript::toByteResponse(value++, 4));
+    }
+}
+
+void ascii(BenchmarkState& state)
+{
+    const string vin = "SALGA2EV9HA298784";
+    while (state.keepRunning())
+    {
+        doNotOptimize(EcuLuaScript::ascii(vin));
+    }
+}
+
+void intToHexString(BenchmarkState& state)
+{
+    Fixture& fixture = getFixture(RAW_10);
+    uint8_t request[64];
+    for (size_t i = 0; i < sizeof(request); ++i)
+    {
+        request[i] = uint8_t(i * 7);
+    }
+    while (state.keepRunning())
+    {
+        doNotOptimize(fixture.pScript->intToHexString(request, sizeof(request)));
+    }
+}
+
+void parseDecimalPGN(BenchmarkState& state)
+{
+    const string pgn = "65226";
+    while (state.keepRunning())
+    {
+        doNotOptimize(J1939Simulator::parsePGN(pgn));
+    }
+}
+
+void parseHexPGN(BenchmarkState& state)
+{
+    const string pgn = "CA FE 00";
+    while (state.keepRunning())
+    {
+        doNotOptimize(J1939Simulator::parsePGN(pgn));
+    }
+}
+
+/// a `TransferData` block of 4 KB
+const vector<uint8_t>& getTransferBlock()
+{
+    static vector<uint8_t> block;
+    if (block.empty())
+    {
+        block.resize(4096);
+        for (size_t i = 0; i < block.size(); ++i)
+        {
+            block[i] = uint8_t(hashEntry(i, 3));
+        }
+    }
+    return block;
+}
+
+void updateCrcPerByte(BenchmarkState& state)
+{
+    const vector<uint8_t>& block = getTransferBlock();
+    while (state.keepRunning())
+    {
+        uint16_t crc = CRC_START_CCITT_FFFF;
+        for (const uint8_t byte : block)
+        {
+            crc = update_crc_ccitt(crc, byte);
+        }
+        doNotOptimize(crc);
+    }
+}
+
+void updateCrcStream(BenchmarkState& state, CrcAlgorithm algorithm)
+{
+    const vector<uint8_t>& block = getTransferBlock();
+    CrcStream crc(algorithm);
+    while (state.keepRunning())
+    {
+        crc.update(block.data(), block.size());
+        doNotOptimize(crc.getValue());
+    }
+}
+
+/// decodes the literal hex string of a 4 KB block into a reused vector
+void literalHexStrToBytesBlock(BenchmarkState& state)
+{
+    const vector<uint8_t>& block = getTransferBlock();
+    string hex;
+    EcuLuaScript::intToHexString(block.data(), block.size(), hex);
+    vector<uint8_t> bytes;
+    while (state.keepRunning())
+    {
+        EcuLuaScript::literalHexStrToBytes(hex, bytes);
+        doNotOptimize(bytes.data());
+    }
+}
+
+/// encodes a 4 KB block into a reused string
+void intToHexStringBlock(BenchmarkState& state)
+{
+    const vector<uint8_t>& block = getTransferBlock();
+    string hex;
+    while (state.keepRunning())
+    {
+        EcuLuaScript::intToHexString(block.data(), block.size(), hex);
+        doNotOptimize(hex.data());
+    }
+}
+
+} // namespace
+
+BENCHMARK_WITH_ARG(getValueFromTree, RAW_10);
+BENCHMARK_WITH_ARG(getValueFromTree, RAW_1K_MIXED);
+BENCHMARK_WITH_ARG(getValueFromTree, RAW_100K);
+BENCHMARK_WITH_ARG(getValueFromTree, RAW_100K_MIXED);
+BENCHMARK_WITH_ARG(getRawResponse, RAW_10);
+BENCHMARK_WITH_ARG(getRawResponse, RAW_1K_MIXED);
+BENCHMARK_WITH_ARG(getRawResponse, RAW_100K);
+BENCHMARK_WITH_ARG(getRawResponse, RAW_100K_MIXED);
+BENCHMARK_WITH_ARG(getRawResponse, RAW_10_LUA);
+BENCHMARK_WITH_ARG(callLuaResponse, RAW_10_LUA);
+BENCHMARK_WITH_ARG(callLuaResponse, RAW_10_BINARY);
+BENCHMARK_WITH_ARG(buildRequestByteTreeFromRawTable, RAW_10);
+BENCHMARK_WITH_ARG(buildRequestByteTreeFromRawTable, RAW_1K_MIXED);
+BENCHMARK_WITH_ARG(buildRequestByteTreeFromRawTable, RAW_100K_MIXED);
+BENCHMARK_WITH_ARG(compileRequestMatcher, RAW_1K_MIXED);
+BENCHMARK_WITH_ARG(compileRequestMatcher, RAW_100K_MIXED);
+BENCHMARK(literalHexStrToBytes);
+BENCHMARK(toByteResponse);
+BENCHMARK(ascii);
+BENCHMARK(intToHexString);
+BENCHMARK(literalHexStrToBytesBlock);
+BENCHMARK(intToHexStringBlock);
+BENCHMARK(parseDecimalPGN);
+BENCHMARK(parseHexPGN);
+BENCHMARK(updateCrcPerByte);
+BENCHMARK_WITH_ARG(updateCrcStream, CrcAlgorithm::CCITT_FFFF);
+BENCHMARK_WITH_ARG(updateCrcStream, CrcAlgorithm::MODBUS);
+BENCHMARK_WITH_ARG(updateCrcStream, CrcAlgorithm::CRC32);
@@ -0,0 +1,430 @@
+/**
+ * @file scalability_benchmark.cpp
+ *
+ * Scalability benchmark of the simulator: how the startup time, the request
+ * tree build, the request latency, the idle CPU, the resident memory and the
+ * number of threads grow with the number of ECUs and the size of their `Raw`
+ * tables. Every data point generates the configurations of its ECUs into a
+ * temporary directory (in the style of `tests/test_config_dir`), loads them
+ * into a `CarSimulator` and drives it through the loopback transport, so
+ * neither vcan nor the `can-isotp` module is needed:
+ *
+ *     scalability_benchmark -e 1,10,100,500 -n 1000,10000,100000 -f json -o report.json
+ *
+ * Each data point runs in a process of its own, so its memory and threads
+ * are not mixed up with the ones of the previous points. The report is a CSV
+ * table (default) or a JSON array with one row per data point, e.g. for a
+ * regression dashboard.
+ */
+
+#include "car_simulator.h"
+#include "ecu_lua_script.h"
+#include "logger.h"
+#include <getopt.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+
+constexpr uint8_t SERVICE_IDENTIFIERS[] = {0x22, 0x2E, 0x31, 0x19};
+constexpr unsigned PLACEHOLDER_PERCENT = 10; ///< entries with an "XX" byte
+constexpr size_t REQUESTS_PER_ECU = 64; ///< the distinct requests sent to each ECU
+
+/**
+ * The options of the command line.
+ */
+struct Options
+{
+    vector<size_t> ecuCounts = {1, 10, 100, 500};
+    vector<size_t> entryCounts = {1000, 10000, 100000};
+    size_t maxTotalEntries = 5000000; ///< larger data points are skipped
+    size_t requests = 20000; ///< the requests of the per-request phase
+    chrono::milliseconds idleTime{1000};
+    bool isJson = false;
+    string outputFile; ///< stdout if empty
+};
+
+/**
+ * The results of one data point, passed from its process through a pipe.
+ */
+struct Result
+{
+    size_t ecus = 0;
+    size_t entries = 0; ///< per ECU
+    double startupMs = 0; ///< loading all configurations, including the request trees
+    double treeBuildMs = 0; ///< building and compiling the request tree of one ECU
+    double requestP50Us = 0;
+    double requestP99Us = 0;
+    double requestsPerSecond = 0;
+    uint64_t failedRequests = 0; ///< requests without the expected response
+    double idleCpuPercent = 0; ///< CPU time of the idle simulator, 100 = one core
+    uint64_t rssKiB = 0; ///< after loading
+    uint64_t threads = 0; ///< after loading
+    bool isValid = false;
+};
+
+/// deterministic pseudo random number of the given entry
+unsigned hashEntry(size_t entry, unsigned seed) noexcept
+{
+    uint32_t x = uint32_t(entry) * 2654435761u + seed * 40503u;
+    x ^= x >> 15;
+    x *= 2246822519u;
+    x ^= x >> 13;
+    return x % 100;
+}
+
+double toMs(chrono::steady_clock::duration duration)
+{
+    return chrono::duration<double, milli>(duration).count();
+}
+
+vector<size_t> parseList(const char* value)
+{
+    vector<size_t> list;
+    stringstream stream(value);
+    string item;
+    while (getline(stream, item, ','))
+    {
+        const size_t number = strtoul(item.c_str(), nullptr, 10);
+        if (number > 0)
+        {
+            list.push_back(number);
+        }
+    }
+    return list;
+}
+
+/**
+ * Writes the configuration of an ECU, e.g. `["22 00 00 01"] = "62 00 00 01"`.
+ * The requests are unique, since the entry number is encoded in their bytes.
+ *
+ * @param requests: receives up to `REQUESTS_PER_ECU` requests of the table
+ */
+void writeConfiguration(const string& file, size_t ecu, size_t entries, vector<vector<uint8_t>>& requests)
+{
+    ofstream script(file);
+    char bytes[32];
+    snprintf(bytes, sizeof(bytes), "0x%X", unsigned(0x18DA0000 + ecu));
+    script << "Main = {\n    RequestId = " << bytes;
+    snprintf(bytes, sizeof(bytes), "0x%X", unsigned(0x18DB0000 + ecu));
+    script << ",\n    ResponseId = " << bytes << ",\n\n    Raw = {\n";
+    for (size_t i = 0; i < entries; ++i)
+    {
+        const uint8_t sid = SERVICE_IDENTIFIERS[i % sizeof(SERVICE_IDENTIFIERS)];
+        const size_t id = i / sizeof(SERVICE_IDENTIFIERS);
+        vector<uint8_t> request = {sid, uint8_t(id >> 16), uint8_t(id >> 8), uint8_t(id)};
+        snprintf(bytes, sizeof(bytes), "%02X %02X %02X %02X", request[0], request[1], request[2], request[3]);
+        string key = bytes;
+        if (hashEntry(i, 1) < PLACEHOLDER_PERCENT)
+        {
+            key += " XX";
+            request.push_back(0x5A);
+        }
+        snprintf(bytes, sizeof(bytes), "%02X %02X %02X %02X", sid + 0x40, request[1], request[2], request[3]);
+        script << "        [\"" << key << "\"] = \"" << bytes << "\",\n";
+        if (i % max<size_t>(1, entries / REQUESTS_PER_ECU) == 0)
+        {
+            requests.push_back(request);
+        }
+    }
+    script << "    }\n}\n";
+}
+
+uint64_t readStatus(const char* field)
+{
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line))
+    {
+        if (line.compare(0, strlen(field), field) == 0)
+        {
+            return strtoull(line.c_str() + strlen(field), nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+double getCpuSeconds()
+{
+    struct rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+    return double(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec)
+        + double(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+/**
+ * Measures one data point, called in the process of the data point.
+ */
+Result measure(const Options& options, size_t ecus, size_t entries)
+{
+    Result result;
+    result.ecus = ecus;
+    result.entries = entries;
+
+    char directory[] = "/tmp/scalability_benchmark_XXXXXX";
+    if (mkdtemp(directory) == nullptr)
+    {
+        perror("mkdtemp");
+        return result;
+    }
+    vector<string> names;
+    vector<vector<vector<uint8_t>>> requests(ecus);
+    for (size_t ecu = 0; ecu < ecus; ++ecu)
+    {
+        names.push_back("ecu" + to_string(ecu));
+        writeConfiguration(string(directory) + "/" + names.back() + ".lua", ecu, entries, requests[ecu]);
+    }
+
+    // request-tree-build: the Raw table of one ECU, without the other tables
+    {
+        EcuLuaScript script("Main", string(directory) + "/" + names[0] + ".lua");
+        const auto begin = chrono::steady_clock::now();
+        const LuaRequestMatcher matcher(script.buildRequestByteTreeFromRawTable());
+        result.treeBuildMs = toMs(chrono::steady_clock::now() - begin);
+    }
+
+    {
+        CarSimulator simulator;
+        const auto begin = chrono::steady_clock::now();
+        const size_t loaded = simulator.loadDirectory(directory);
+        result.startupMs = toMs(chrono::steady_clock::now() - begin);
+        result.rssKiB = readStatus("VmRSS:");
+        result.threads = readStatus("Threads:");
+        if (loaded != ecus)
+        {
+            cerr << "Loaded " << loaded << " of " << ecus << " ECUs" << endl;
+        }
+
+        // per-request: round robin over the ECUs and their requests
+        vector<double> latencies;
+        latencies.reserve(options.requests);
+        vector<uint8_t> response;
+        const auto requestsBegin = chrono::steady_clock::now();
+        for (size_t i = 0; i < options.requests; ++i)
+        {
+            const size_t ecu = i % ecus;
+            const vector<uint8_t>& request = requests[ecu][(i / ecus) % requests[ecu].size()];
+            const auto begin = chrono::steady_clock::now();
+            simulator.request(names[ecu], request.data(), request.size(), response);
+            latencies.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - begin).count());
+            if (response.empty() || response[0] != request[0] + 0x40)
+            {
+                ++result.failedRequests;
+            }
+        }
+        const double requestsSeconds = toMs(chrono::steady_clock::now() - requestsBegin) / 1000.0;
+        sort(latencies.begin(), latencies.end());
+        if (!latencies.empty())
+        {
+            result.requestP50Us = latencies[latencies.size() / 2];
+            result.requestP99Us = latencies[latencies.size() * 99 / 100];
+            result.requestsPerSecond = double(latencies.size()) / max(requestsSeconds, 1e-9);
+        }
+
+        // idle-CPU: the timers and threads of the loaded simulator
+        const double cpuBegin = getCpuSeconds();
+        this_thread::sleep_for(options.idleTime);
+        result.idleCpuPercent = (getCpuSeconds() - cpuBegin) * 100000.0 / double(options.idleTime.count());
+    }
+    filesystem::remove_all(directory);
+    result.isValid = true;
+    return result;
+}
+
+/**
+ * Runs `measure()` in a child process.
+ *
+ * @return the result, not valid if the child failed
+ */
+Result runDataPoint(const Options& options, size_t ecus, size_t entries)
+{
+    Result result;
+    result.ecus = ecus;
+    result.entries = entries;
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        perror("pipe");
+        return result;
+    }
+    const pid_t pid = fork();
+    if (pid < 0)
+    {
+        perror("fork");
+        close(fds[0]);
+        close(fds[1]);
+        return result;
+    }
+    if (pid == 0)
+    {
+        close(fds[0]);
+        const Result measured = measure(options, ecus, entries);
+        Logger::getInstance().flush();
+        const bool isWritten = write(fds[1], &measured, sizeof(measured)) == ssize_t(sizeof(measured));
+        // the simulator is already deleted, skip the destructors of the singletons
+        _exit(isWritten ? 0 : 1);
+    }
+    close(fds[1]);
+    Result measured;
+    if (read(fds[0], &measured, sizeof(measured)) == ssize_t(sizeof(measured)))
+    {
+        result = measured;
+    }
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return result;
+}
+
+void writeCsv(ostream& out, const vector<Result>& results)
+{
+    out << "ecus,entries,startup_ms,tree_build_ms,request_p50_us,request_p99_us,requests_per_s,"
+           "failed_requests,idle_cpu_percent,rss_kib,threads\n";
+    for (const Result& result : results)
+    {
+        out << result.ecus << ',' << result.entries << ',' << result.startupMs << ',' << result.treeBuildMs
+            << ',' << result.requestP50Us << ',' << result.requestP99Us << ',' << result.requestsPerSecond
+            << ',' << result.failedRequests << ',' << result.idleCpuPercent << ',' << result.rssKiB
+            << ',' << result.threads << '\n';
+    }
+}
+
+void writeJson(ostream& out, const vector<Result>& results)
+{
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& result = results[i];
+        out << "  {\"ecus\": " << result.ecus << ", \"entries\": " << result.entries
+            << ", \"startup_ms\": " << result.startupMs << ", \"tree_build_ms\": " << result.treeBuildMs
+            << ", \"request_p50_us\": " << result.requestP50Us << ", \"request_p99_us\": " << result.requestP99Us
+            << ", \"requests_per_s\": " << result.requestsPerSecond
+            << ", \"failed_requests\": " << result.failedRequests
+            << ", \"idle_cpu_percent\": " << result.idleCpuPercent << ", \"rss_kib\": " << result.rssKiB
+            << ", \"threads\": " << result.threads << '}' << (i + 1 < results.size() ? "," : "") << '\n';
+    }
+    out << "]\n";
+}
+
+void printUsage(const char* program)
+{
+    cerr << "Usage: " << program << " [options]\n"
+         << "  -e, --ecus LIST       numbers of ECUs (default 1,10,100,500)\n"
+         << "  -n, --entries LIST    Raw entries per ECU (default 1000,10000,100000)\n"
+         << "  -m, --max-total N     skip data points with more entries in total (default 5000000)\n"
+         << "  -r, --requests N      requests of the per-request phase (default 20000)\n"
+         << "  -i, --idle MS         duration of the idle phase (default 1000)\n"
+         << "  -f, --format FORMAT   csv (default) or json\n"
+         << "  -o, --output FILE     write the report into a file instead of stdout\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    const struct option longOptions[] = {
+        {"ecus", required_argument, nullptr, 'e'},
+        {"entries", required_argument, nullptr, 'n'},
+        {"max-total", required_argument, nullptr, 'm'},
+        {"requests", required_argument, nullptr, 'r'},
+        {"idle", required_argument, nullptr, 'i'},
+        {"format", required_argument, nullptr, 'f'},
+        {"output", required_argument, nullptr, 'o'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+    int option;
+    while ((option = getopt_long(argc, argv, "e:n:m:r:i:f:o:h", longOptions, nullptr)) != -1)
+    {
+        switch (option)
+        {
+            case 'e':
+                options.ecuCounts = parseList(optarg);
+                break;
+            case 'n':
+                options.entryCounts = parseList(optarg);
+                break;
+            case 'm':
+                options.maxTotalEntries = strtoull(optarg, nullptr, 10);
+                break;
+            case 'r':
+                options.requests = strtoull(optarg, nullptr, 10);
+                break;
+            case 'i':
+                options.idleTime = chrono::milliseconds(strtoull(optarg, nullptr, 10));
+                break;
+            case 'f':
+                options.isJson = string(optarg) == "json";
+                break;
+            case 'o':
+                options.outputFile = optarg;
+                break;
+            default:
+                printUsage(argv[0]);
+                return option == 'h' ? 0 : 1;
+        }
+    }
+    if (options.ecuCounts.empty() || options.entryCounts.empty())
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // no thread is started here, the data points are measured in child processes
+    vector<Result> results;
+    int exitCode = 0;
+    for (const size_t ecus : options.ecuCounts)
+    {
+        for (const size_t entries : options.entryCounts)
+        {
+            if (ecus * entries > options.maxTotalEntries)
+            {
+                cerr << "Skipping " << ecus << " ECUs x " << entries << " entries (see --max-total)" << endl;
+                continue;
+            }
+            cerr << "Measuring " << ecus << " ECUs x " << entries << " entries" << endl;
+            const Result result = runDataPoint(options, ecus, entries);
+            if (!result.isValid)
+            {
+                cerr << "Failed to measure " << ecus << " ECUs x " << entries << " entries" << endl;
+                exitCode = 2;
+                continue;
+            }
+            results.push_back(result);
+        }
+    }
+
+    ofstream file;
+    if (!options.outputFile.empty())
+    {
+        file.open(options.outputFile);
+    }
+    ostream& out = options.outputFile.empty() ? cout : file;
+    if (options.isJson)
+    {
+        writeJson(out, results);
+    }
+    else
+    {
+        writeCsv(out, results);
+    }
+    return exitCode;
+}
@@ -48,18 +48,122 @@ OBJECTFILES= \
 	${OBJECTDIR}/src/j1939_simulator.o \
 	${OBJECTDIR}/src/doip_sim_server.o \
 	${OBJECTDIR}/src/doip_simulator.o \
-	${OBJECTDIR}/src/doip_configuration_file.o
+	${OBJECTDIR}/src/doip_configuration_file.o \
+	${OBJECTDIR}/src/lua_worker.o \
+	${OBJECTDIR}/src/receiver_reactor.o \
+	${OBJECTDIR}/src/simulator_configuration.o \
+	${OBJECTDIR}/src/timer_wheel.o \
+	${OBJECTDIR}/src/j1939_cyclic_scheduler.o \
+	${OBJECTDIR}/src/bus_state_monitor.o \
+	${OBJECTDIR}/src/logger.o \
+	${OBJECTDIR}/src/traffic_capture.o \
+	${OBJECTDIR}/src/metrics.o \
+	${OBJECTDIR}/src/thread_pool.o \
+	${OBJECTDIR}/src/request_snapshot.o \
+	${OBJECTDIR}/src/config_watcher.o \
+	${OBJECTDIR}/src/doip_tcp_connection.o \
+	${OBJECTDIR}/src/doip_udp_socket.o \
+	${OBJECTDIR}/src/buffer_pool.o \
+	${OBJECTDIR}/src/download_service.o \
+	${OBJECTDIR}/src/crc_stream.o \
+	${OBJECTDIR}/src/uds_services.o \
+	${OBJECTDIR}/src/dtc_store.o \
+	${OBJECTDIR}/src/did_store.o \
+	${OBJECTDIR}/src/response_pending.o \
+	${OBJECTDIR}/src/security_access.o \
+	${OBJECTDIR}/src/aes128.o \
+	${OBJECTDIR}/src/periodic_data_service.o \
+	${OBJECTDIR}/src/obd_service.o \
+	${OBJECTDIR}/src/vehicle_signals.o \
+	${OBJECTDIR}/src/j1939_bus.o \
+	${OBJECTDIR}/src/isotp_configuration.o \
+	${OBJECTDIR}/src/replay_trace.o \
+	${OBJECTDIR}/src/lua_memory_pool.o \
+	${OBJECTDIR}/src/thread_placement.o \
+	${OBJECTDIR}/src/isotp_engine.o \
+	${OBJECTDIR}/src/can_frame_bus.o \
+	${OBJECTDIR}/src/can_frame_simulator.o \
+	${OBJECTDIR}/src/doip_can_gateway.o \
+	${OBJECTDIR}/src/simulation_clock.o \
+	${OBJECTDIR}/src/loopback_transport.o \
+	${OBJECTDIR}/src/car_simulator.o \
+	${OBJECTDIR}/src/lua_profiler.o \
+	${OBJECTDIR}/src/hex_codec.o \
+	${OBJECTDIR}/src/response_cache.o \
+	${OBJECTDIR}/src/signal_feed.o \
+	${OBJECTDIR}/src/realtime_profile.o \
+	${OBJECTDIR}/src/checkpoint.o \
+	${OBJECTDIR}/src/memory_service.o \
+	${OBJECTDIR}/src/bus_load_budget.o \
+	${OBJECTDIR}/src/j1939_diagnostic_messages.o \
+	${OBJECTDIR}/src/response_delay.o \
+	${OBJECTDIR}/src/communication_gate.o \
+	${OBJECTDIR}/src/idle_monitor.o \
+	${OBJECTDIR}/src/dynamic_data_service.o \
+	${OBJECTDIR}/src/response_on_event_service.o \
+	${OBJECTDIR}/src/worker_supervisor.o \
+	${OBJECTDIR}/src/service_dispatcher.o
 
 # Test Directory
 TESTDIR=${CND_BUILDDIR}/${CND_CONF}/${CND_PLATFORM}/tests
 
 # Test Files
 TESTFILES= \
+	${TESTDIR}/TestFiles/f1 \
 	${TESTDIR}/TestFiles/f3 \
 	${TESTDIR}/TestFiles/f4 \
 	${TESTDIR}/TestFiles/f5 \
 	${TESTDIR}/TestFiles/f6 \
-	${TESTDIR}/TestFiles/f1
+	${TESTDIR}/TestFiles/f7 \
+	${TESTDIR}/TestFiles/f8 \
+	${TESTDIR}/TestFiles/f9 \
+	${TESTDIR}/TestFiles/f10 \
+	${TESTDIR}/TestFiles/f11 \
+	${TESTDIR}/TestFiles/f12 \
+	${TESTDIR}/TestFiles/f13 \
+	${TESTDIR}/TestFiles/f14 \
+	${TESTDIR}/TestFiles/f15 \
+	${TESTDIR}/TestFiles/f16 \
+	${TESTDIR}/TestFiles/f17 \
+	${TESTDIR}/TestFiles/f18 \
+	${TESTDIR}/TestFiles/f19 \
+	${TESTDIR}/TestFiles/f20 \
+	${TESTDIR}/TestFiles/f21 \
+	${TESTDIR}/TestFiles/f22 \
+	${TESTDIR}/TestFiles/f23 \
+	${TESTDIR}/TestFiles/f24 \
+	${TESTDIR}/TestFiles/f25 \
+	${TESTDIR}/TestFiles/f26 \
+	${TESTDIR}/TestFiles/f27 \
+	${TESTDIR}/TestFiles/f28 \
+	${TESTDIR}/TestFiles/f29 \
+	${TESTDIR}/TestFiles/f30 \
+	${TESTDIR}/TestFiles/f31 \
+	${TESTDIR}/TestFiles/f32 \
+	${TESTDIR}/TestFiles/f33 \
+	${TESTDIR}/TestFiles/f34 \
+	${TESTDIR}/TestFiles/f35 \
+	${TESTDIR}/TestFiles/f36 \
+	${TESTDIR}/TestFiles/f37 \
+	${TESTDIR}/TestFiles/f38 \
+	${TESTDIR}/TestFiles/f39 \
+	${TESTDIR}/TestFiles/f40 \
+	${TESTDIR}/TestFiles/f41 \
+	${TESTDIR}/TestFiles/f42 \
+	${TESTDIR}/TestFiles/f43 \
+	${TESTDIR}/TestFiles/f44 \
+	${TESTDIR}/TestFiles/f45 \
+	${TESTDIR}/TestFiles/f46 \
+	${TESTDIR}/TestFiles/f47 \
+	${TESTDIR}/TestFiles/f48 \
+	${TESTDIR}/TestFiles/f49 \
+	${TESTDIR}/TestFiles/f50 \
+	${TESTDIR}/TestFiles/f51 \
+	${TESTDIR}/TestFiles/f52 \
+	${TESTDIR}/TestFiles/f53 \
+	${TESTDIR}/TestFiles/f54 \
+	${TESTDIR}/TestFiles/f55 \
+	${TESTDIR}/TestFiles/f56
 
 # Test Object Files
 TESTOBJECTFILES= \
@@ -72,7 +176,107 @@ TESTOBJECTFILES= \
 	${TESTDIR}/tests/uds_receiver_test.o \
 	${TESTDIR}/tests/uds_receiver_test_runner.o \
 	${TESTDIR}/tests/utils_test.o \
-	${TESTDIR}/tests/utils_test_runner.o
+	${TESTDIR}/tests/j1939_pgn_index_test.o \
+	${TESTDIR}/tests/replay_trace_test.o \
+	${TESTDIR}/tests/lua_memory_pool_test.o \
+	${TESTDIR}/tests/thread_placement_test.o \
+	${TESTDIR}/tests/isotp_engine_test.o \
+	${TESTDIR}/tests/can_frame_bus_test.o \
+	${TESTDIR}/tests/simulation_clock_test.o \
+	${TESTDIR}/tests/car_simulator_test.o \
+	${TESTDIR}/tests/lua_profiler_test.o \
+	${TESTDIR}/tests/hex_codec_test.o \
+	${TESTDIR}/tests/response_cache_test.o \
+	${TESTDIR}/tests/signal_feed_test.o \
+	${TESTDIR}/tests/realtime_profile_test.o \
+	${TESTDIR}/tests/checkpoint_test.o \
+	${TESTDIR}/tests/memory_service_test.o \
+	${TESTDIR}/tests/bus_load_budget_test.o \
+	${TESTDIR}/tests/j1939_diagnostic_messages_test.o \
+	${TESTDIR}/tests/response_delay_test.o \
+	${TESTDIR}/tests/communication_gate_test.o \
+	${TESTDIR}/tests/idle_monitor_test.o \
+	${TESTDIR}/tests/dynamic_data_service_test.o \
+	${TESTDIR}/tests/response_on_event_service_test.o \
+	${TESTDIR}/tests/worker_supervisor_test.o \
+	${TESTDIR}/tests/service_dispatcher_test.o \
+	${TESTDIR}/tests/spsc_queue_test.o \
+	${TESTDIR}/tests/j1939_simulator_test.o \
+	${TESTDIR}/tests/doip_can_gateway_test.o \
+	${TESTDIR}/tests/j1939_cyclic_scheduler_test.o \
+	${TESTDIR}/tests/receiver_reactor_test.o \
+	${TESTDIR}/tests/lua_worker_test.o \
+	${TESTDIR}/tests/j1939_bus_test.o \
+	${TESTDIR}/tests/vehicle_signals_test.o \
+	${TESTDIR}/tests/obd_service_test.o \
+	${TESTDIR}/tests/periodic_data_service_test.o \
+	${TESTDIR}/tests/security_access_test.o \
+	${TESTDIR}/tests/response_pending_test.o \
+	${TESTDIR}/tests/did_store_test.o \
+	${TESTDIR}/tests/dtc_store_test.o \
+	${TESTDIR}/tests/uds_services_test.o \
+	${TESTDIR}/tests/crc_stream_test.o \
+	${TESTDIR}/tests/download_service_test.o \
+	${TESTDIR}/tests/buffer_pool_test.o \
+	${TESTDIR}/tests/request_snapshot_test.o \
+	${TESTDIR}/tests/thread_pool_test.o \
+	${TESTDIR}/tests/metrics_test.o \
+	${TESTDIR}/tests/traffic_capture_test.o \
+	${TESTDIR}/tests/logger_test.o \
+	${TESTDIR}/tests/timer_wheel_test.o \
+	${TESTDIR}/tests/data_identifier_index_test.o \
+	${TESTDIR}/tests/compiled_request_matcher_test.o \
+	${TESTDIR}/tests/utils_test_runner.o \
+	${TESTDIR}/tests/j1939_pgn_index_test_runner.o \
+	${TESTDIR}/tests/replay_trace_test_runner.o \
+	${TESTDIR}/tests/lua_memory_pool_test_runner.o \
+	${TESTDIR}/tests/thread_placement_test_runner.o \
+	${TESTDIR}/tests/isotp_engine_test_runner.o \
+	${TESTDIR}/tests/can_frame_bus_test_runner.o \
+	${TESTDIR}/tests/simulation_clock_test_runner.o \
+	${TESTDIR}/tests/car_simulator_test_runner.o \
+	${TESTDIR}/tests/lua_profiler_test_runner.o \
+	${TESTDIR}/tests/hex_codec_test_runner.o \
+	${TESTDIR}/tests/response_cache_test_runner.o \
+	${TESTDIR}/tests/signal_feed_test_runner.o \
+	${TESTDIR}/tests/realtime_profile_test_runner.o \
+	${TESTDIR}/tests/checkpoint_test_runner.o \
+	${TESTDIR}/tests/memory_service_test_runner.o \
+	${TESTDIR}/tests/bus_load_budget_test_runner.o \
+	${TESTDIR}/tests/j1939_diagnostic_messages_test_runner.o \
+	${TESTDIR}/tests/response_delay_test_runner.o \
+	${TESTDIR}/tests/communication_gate_test_runner.o \
+	${TESTDIR}/tests/idle_monitor_test_runner.o \
+	${TESTDIR}/tests/dynamic_data_service_test_runner.o \
+	${TESTDIR}/tests/response_on_event_service_test_runner.o \
+	${TESTDIR}/tests/worker_supervisor_test_runner.o \
+	${TESTDIR}/tests/service_dispatcher_test_runner.o \
+	${TESTDIR}/tests/spsc_queue_test_runner.o \
+	${TESTDIR}/tests/j1939_simulator_test_runner.o \
+	${TESTDIR}/tests/doip_can_gateway_test_runner.o \
+	${TESTDIR}/tests/j1939_cyclic_scheduler_test_runner.o \
+	${TESTDIR}/tests/receiver_reactor_test_runner.o \
+	${TESTDIR}/tests/lua_worker_test_runner.o \
+	${TESTDIR}/tests/j1939_bus_test_runner.o \
+	${TESTDIR}/tests/vehicle_signals_test_runner.o \
+	${TESTDIR}/tests/obd_service_test_runner.o \
+	${TESTDIR}/tests/periodic_data_service_test_runner.o \
+	${TESTDIR}/tests/security_access_test_runner.o \
+	${TESTDIR}/tests/response_pending_test_runner.o \
+	${TESTDIR}/tests/did_store_test_runner.o \
+	${TESTDIR}/tests/dtc_store_test_runner.o \
+	${TESTDIR}/tests/uds_services_test_runner.o \
+	${TESTDIR}/tests/crc_stream_test_runner.o \
+	${TESTDIR}/tests/download_service_test_runner.o \
+	${TESTDIR}/tests/buffer_pool_test_runner.o \
+	${TESTDIR}/tests/request_snapshot_test_runner.o \
+	${TESTDIR}/tests/thread_pool_test_runner.o \
+	${TESTDIR}/tests/metrics_test_runner.o \
+	${TESTDIR}/tests/traffic_capture_test_runner.o \
+	${TESTDIR}/tests/logger_test_runner.o \
+	${TESTDIR}/tests/timer_wheel_test_runner.o \
+	${TESTDIR}/tests/data_identifier_index_test_runner.o \
+	${TESTDIR}/tests/compiled_request_matcher_test_runner.o
 
 # C Compiler Flags
 CFLAGS=
@@ -88,7 +292,7 @@ FFLAGS=
 ASFLAGS=
 
 # Link Libraries and Options
-LDLIBSOPTIONS=-L/usr/lib/libdoip -Wl,-rpath,'/usr/lib/libdoip' -ldoipserver -ldoipcommon `pkg-config --libs lua5.2` `pkg-config --libs cppunit`  `pkg-config --libs libsocketcan` -lstdc++fs 
+LDLIBSOPTIONS=-L/usr/lib/libdoip -Wl,-rpath,'/usr/lib/libdoip' -ldoipserver -ldoipcommon `pkg-config --libs ${LUA_PACKAGE}` ${LUA_LDFLAGS} `pkg-config --libs cppunit`  `pkg-config --libs libsocketcan` -lstdc++fs 
 
 # Build Targets
 .build-conf: ${BUILD_SUBPROJECTS}
@@ -101,72 +305,342 @@ ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/amos-ss17-proj4: ${OBJECTFILES}
 ${OBJECTDIR}/src/broadcast_receiver.o: src/broadcast_receiver.cpp
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/broadcast_receiver.o src/broadcast_receiver.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/broadcast_receiver.o src/broadcast_receiver.cpp
 
 ${OBJECTDIR}/src/ecu_lua_script.o: src/ecu_lua_script.cpp
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/ecu_lua_script.o src/ecu_lua_script.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/ecu_lua_script.o src/ecu_lua_script.cpp
 
 ${OBJECTDIR}/src/ecu_timer.o: src/ecu_timer.cpp
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/ecu_timer.o src/ecu_timer.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/ecu_timer.o src/ecu_timer.cpp
 
 ${OBJECTDIR}/src/electronic_control_unit.o: src/electronic_control_unit.cpp
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/electronic_control_unit.o src/electronic_control_unit.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/electronic_control_unit.o src/electronic_control_unit.cpp
 
 ${OBJECTDIR}/src/isotp_receiver.o: src/isotp_receiver.cpp
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/isotp_receiver.o src/isotp_receiver.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/isotp_receiver.o src/isotp_receiver.cpp
 
 ${OBJECTDIR}/src/isotp_sender.o: src/isotp_sender.cpp
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/isotp_sender.o src/isotp_sender.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/isotp_sender.o src/isotp_sender.cpp
 
 ${OBJECTDIR}/src/main.o: src/main.cpp
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/main.o src/main.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/main.o src/main.cpp
 
 ${OBJECTDIR}/src/session_controller.o: src/session_controller.cpp
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/session_controller.o src/session_controller.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/session_controller.o src/session_controller.cpp
 
 ${OBJECTDIR}/src/uds_receiver.o: src/uds_receiver.cpp
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/uds_receiver.o src/uds_receiver.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/uds_receiver.o src/uds_receiver.cpp
 
 ${OBJECTDIR}/src/utilities.o: src/utilities.cpp
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/utilities.o src/utilities.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/utilities.o src/utilities.cpp
 
 ${OBJECTDIR}/src/j1939_simulator.o: src/j1939_simulator.cpp
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/j1939_simulator.o src/j1939_simulator.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/j1939_simulator.o src/j1939_simulator.cpp
 
 ${OBJECTDIR}/src/doip_configuration_file.o: src/doip_configuration_file.cpp
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/doip_configuration_file.o src/doip_configuration_file.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/doip_configuration_file.o src/doip_configuration_file.cpp
 
 ${OBJECTDIR}/src/doip_simulator.o: src/doip_simulator.cpp
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/doip_simulator.o src/doip_simulator.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/doip_simulator.o src/doip_simulator.cpp
 
 ${OBJECTDIR}/src/doip_sim_server.o: src/doip_sim_server.cpp
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/doip_sim_server.o src/doip_sim_server.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/doip_sim_server.o src/doip_sim_server.cpp
+
+${OBJECTDIR}/src/lua_worker.o: src/lua_worker.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/lua_worker.o src/lua_worker.cpp
+
+${OBJECTDIR}/src/receiver_reactor.o: src/receiver_reactor.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/receiver_reactor.o src/receiver_reactor.cpp
+
+${OBJECTDIR}/src/simulator_configuration.o: src/simulator_configuration.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/simulator_configuration.o src/simulator_configuration.cpp
+
+${OBJECTDIR}/src/timer_wheel.o: src/timer_wheel.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/timer_wheel.o src/timer_wheel.cpp
+
+${OBJECTDIR}/src/j1939_cyclic_scheduler.o: src/j1939_cyclic_scheduler.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/j1939_cyclic_scheduler.o src/j1939_cyclic_scheduler.cpp
+
+${OBJECTDIR}/src/bus_state_monitor.o: src/bus_state_monitor.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/bus_state_monitor.o src/bus_state_monitor.cpp
+
+${OBJECTDIR}/src/logger.o: src/logger.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/logger.o src/logger.cpp
+
+${OBJECTDIR}/src/traffic_capture.o: src/traffic_capture.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/traffic_capture.o src/traffic_capture.cpp
+
+${OBJECTDIR}/src/metrics.o: src/metrics.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/metrics.o src/metrics.cpp
+
+${OBJECTDIR}/src/thread_pool.o: src/thread_pool.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/thread_pool.o src/thread_pool.cpp
+
+${OBJECTDIR}/src/request_snapshot.o: src/request_snapshot.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/request_snapshot.o src/request_snapshot.cpp
+
+${OBJECTDIR}/src/config_watcher.o: src/config_watcher.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/config_watcher.o src/config_watcher.cpp
+
+${OBJECTDIR}/src/doip_tcp_connection.o: src/doip_tcp_connection.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/doip_tcp_connection.o src/doip_tcp_connection.cpp
+
+${OBJECTDIR}/src/doip_udp_socket.o: src/doip_udp_socket.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/doip_udp_socket.o src/doip_udp_socket.cpp
+
+${OBJECTDIR}/src/buffer_pool.o: src/buffer_pool.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/buffer_pool.o src/buffer_pool.cpp
+
+${OBJECTDIR}/src/download_service.o: src/download_service.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/download_service.o src/download_service.cpp
+
+${OBJECTDIR}/src/crc_stream.o: src/crc_stream.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/crc_stream.o src/crc_stream.cpp
+
+${OBJECTDIR}/src/uds_services.o: src/uds_services.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/uds_services.o src/uds_services.cpp
+
+${OBJECTDIR}/src/dtc_store.o: src/dtc_store.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/dtc_store.o src/dtc_store.cpp
+
+${OBJECTDIR}/src/did_store.o: src/did_store.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/did_store.o src/did_store.cpp
+
+${OBJECTDIR}/src/response_pending.o: src/response_pending.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/response_pending.o src/response_pending.cpp
+
+${OBJECTDIR}/src/security_access.o: src/security_access.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/security_access.o src/security_access.cpp
+
+${OBJECTDIR}/src/aes128.o: src/aes128.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/aes128.o src/aes128.cpp
+
+${OBJECTDIR}/src/periodic_data_service.o: src/periodic_data_service.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/periodic_data_service.o src/periodic_data_service.cpp
+
+${OBJECTDIR}/src/obd_service.o: src/obd_service.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/obd_service.o src/obd_service.cpp
+
+${OBJECTDIR}/src/vehicle_signals.o: src/vehicle_signals.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/vehicle_signals.o src/vehicle_signals.cpp
+
+${OBJECTDIR}/src/j1939_bus.o: src/j1939_bus.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/j1939_bus.o src/j1939_bus.cpp
+
+${OBJECTDIR}/src/isotp_configuration.o: src/isotp_configuration.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/isotp_configuration.o src/isotp_configuration.cpp
+
+${OBJECTDIR}/src/replay_trace.o: src/replay_trace.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/replay_trace.o src/replay_trace.cpp
+
+${OBJECTDIR}/src/lua_memory_pool.o: src/lua_memory_pool.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/lua_memory_pool.o src/lua_memory_pool.cpp
+
+${OBJECTDIR}/src/thread_placement.o: src/thread_placement.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/thread_placement.o src/thread_placement.cpp
+
+${OBJECTDIR}/src/isotp_engine.o: src/isotp_engine.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/isotp_engine.o src/isotp_engine.cpp
+
+${OBJECTDIR}/src/can_frame_bus.o: src/can_frame_bus.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/can_frame_bus.o src/can_frame_bus.cpp
+
+${OBJECTDIR}/src/can_frame_simulator.o: src/can_frame_simulator.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/can_frame_simulator.o src/can_frame_simulator.cpp
+
+${OBJECTDIR}/src/doip_can_gateway.o: src/doip_can_gateway.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/doip_can_gateway.o src/doip_can_gateway.cpp
+
+${OBJECTDIR}/src/simulation_clock.o: src/simulation_clock.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/simulation_clock.o src/simulation_clock.cpp
+
+${OBJECTDIR}/src/loopback_transport.o: src/loopback_transport.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/loopback_transport.o src/loopback_transport.cpp
+
+${OBJECTDIR}/src/car_simulator.o: src/car_simulator.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/car_simulator.o src/car_simulator.cpp
+
+${OBJECTDIR}/src/lua_profiler.o: src/lua_profiler.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/lua_profiler.o src/lua_profiler.cpp
+
+${OBJECTDIR}/src/hex_codec.o: src/hex_codec.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/hex_codec.o src/hex_codec.cpp
+
+${OBJECTDIR}/src/response_cache.o: src/response_cache.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/response_cache.o src/response_cache.cpp
+
+${OBJECTDIR}/src/signal_feed.o: src/signal_feed.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/signal_feed.o src/signal_feed.cpp
+
+${OBJECTDIR}/src/realtime_profile.o: src/realtime_profile.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/realtime_profile.o src/realtime_profile.cpp
+
+${OBJECTDIR}/src/checkpoint.o: src/checkpoint.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/checkpoint.o src/checkpoint.cpp
+
+${OBJECTDIR}/src/memory_service.o: src/memory_service.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/memory_service.o src/memory_service.cpp
+
+${OBJECTDIR}/src/bus_load_budget.o: src/bus_load_budget.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/bus_load_budget.o src/bus_load_budget.cpp
+
+${OBJECTDIR}/src/j1939_diagnostic_messages.o: src/j1939_diagnostic_messages.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/j1939_diagnostic_messages.o src/j1939_diagnostic_messages.cpp
+
+${OBJECTDIR}/src/response_delay.o: src/response_delay.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/response_delay.o src/response_delay.cpp
+
+${OBJECTDIR}/src/communication_gate.o: src/communication_gate.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/communication_gate.o src/communication_gate.cpp
+
+${OBJECTDIR}/src/idle_monitor.o: src/idle_monitor.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/idle_monitor.o src/idle_monitor.cpp
+
+${OBJECTDIR}/src/dynamic_data_service.o: src/dynamic_data_service.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/dynamic_data_service.o src/dynamic_data_service.cpp
+
+${OBJECTDIR}/src/response_on_event_service.o: src/response_on_event_service.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/response_on_event_service.o src/response_on_event_service.cpp
+
+${OBJECTDIR}/src/worker_supervisor.o: src/worker_supervisor.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/worker_supervisor.o src/worker_supervisor.cpp
+
+${OBJECTDIR}/src/service_dispatcher.o: src/service_dispatcher.cpp
+	${MKDIR} -p ${OBJECTDIR}/src
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/service_dispatcher.o src/service_dispatcher.cpp
 
 # Subprojects
 .build-subprojects:
@@ -195,221 +669,1750 @@ ${TESTDIR}/TestFiles/f1: ${TESTDIR}/tests/utils_test.o ${TESTDIR}/tests/utils_te
 	${MKDIR} -p ${TESTDIR}/TestFiles
 	${LINK.cc} -o ${TESTDIR}/TestFiles/f1 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
 
+${TESTDIR}/TestFiles/f26: ${TESTDIR}/tests/j1939_pgn_index_test.o ${TESTDIR}/tests/j1939_pgn_index_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f26 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f27: ${TESTDIR}/tests/replay_trace_test.o ${TESTDIR}/tests/replay_trace_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f27 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f28: ${TESTDIR}/tests/lua_memory_pool_test.o ${TESTDIR}/tests/lua_memory_pool_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f28 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f29: ${TESTDIR}/tests/thread_placement_test.o ${TESTDIR}/tests/thread_placement_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f29 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f30: ${TESTDIR}/tests/isotp_engine_test.o ${TESTDIR}/tests/isotp_engine_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f30 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f31: ${TESTDIR}/tests/can_frame_bus_test.o ${TESTDIR}/tests/can_frame_bus_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f31 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f32: ${TESTDIR}/tests/simulation_clock_test.o ${TESTDIR}/tests/simulation_clock_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f32 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f33: ${TESTDIR}/tests/car_simulator_test.o ${TESTDIR}/tests/car_simulator_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f33 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f34: ${TESTDIR}/tests/lua_profiler_test.o ${TESTDIR}/tests/lua_profiler_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f34 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f35: ${TESTDIR}/tests/hex_codec_test.o ${TESTDIR}/tests/hex_codec_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f35 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f36: ${TESTDIR}/tests/response_cache_test.o ${TESTDIR}/tests/response_cache_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f36 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f37: ${TESTDIR}/tests/signal_feed_test.o ${TESTDIR}/tests/signal_feed_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f37 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f38: ${TESTDIR}/tests/realtime_profile_test.o ${TESTDIR}/tests/realtime_profile_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f38 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f39: ${TESTDIR}/tests/checkpoint_test.o ${TESTDIR}/tests/checkpoint_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f39 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f40: ${TESTDIR}/tests/memory_service_test.o ${TESTDIR}/tests/memory_service_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f40 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f41: ${TESTDIR}/tests/bus_load_budget_test.o ${TESTDIR}/tests/bus_load_budget_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f41 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f42: ${TESTDIR}/tests/j1939_diagnostic_messages_test.o ${TESTDIR}/tests/j1939_diagnostic_messages_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f42 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f43: ${TESTDIR}/tests/response_delay_test.o ${TESTDIR}/tests/response_delay_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f43 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f44: ${TESTDIR}/tests/communication_gate_test.o ${TESTDIR}/tests/communication_gate_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f44 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f45: ${TESTDIR}/tests/idle_monitor_test.o ${TESTDIR}/tests/idle_monitor_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f45 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f46: ${TESTDIR}/tests/dynamic_data_service_test.o ${TESTDIR}/tests/dynamic_data_service_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f46 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f47: ${TESTDIR}/tests/response_on_event_service_test.o ${TESTDIR}/tests/response_on_event_service_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f47 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f48: ${TESTDIR}/tests/worker_supervisor_test.o ${TESTDIR}/tests/worker_supervisor_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f48 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f49: ${TESTDIR}/tests/service_dispatcher_test.o ${TESTDIR}/tests/service_dispatcher_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f49 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f50: ${TESTDIR}/tests/spsc_queue_test.o ${TESTDIR}/tests/spsc_queue_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f50 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f51: ${TESTDIR}/tests/j1939_simulator_test.o ${TESTDIR}/tests/j1939_simulator_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f51 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f52: ${TESTDIR}/tests/doip_can_gateway_test.o ${TESTDIR}/tests/doip_can_gateway_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f52 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f53: ${TESTDIR}/tests/j1939_cyclic_scheduler_test.o ${TESTDIR}/tests/j1939_cyclic_scheduler_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f53 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f54: ${TESTDIR}/tests/receiver_reactor_test.o ${TESTDIR}/tests/receiver_reactor_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f54 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f55: ${TESTDIR}/tests/lua_worker_test.o ${TESTDIR}/tests/lua_worker_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f55 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f56: ${TESTDIR}/tests/j1939_bus_test.o ${TESTDIR}/tests/j1939_bus_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f56 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f25: ${TESTDIR}/tests/vehicle_signals_test.o ${TESTDIR}/tests/vehicle_signals_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f25 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f24: ${TESTDIR}/tests/obd_service_test.o ${TESTDIR}/tests/obd_service_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f24 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f23: ${TESTDIR}/tests/periodic_data_service_test.o ${TESTDIR}/tests/periodic_data_service_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f23 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f22: ${TESTDIR}/tests/security_access_test.o ${TESTDIR}/tests/security_access_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f22 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f21: ${TESTDIR}/tests/response_pending_test.o ${TESTDIR}/tests/response_pending_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f21 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f20: ${TESTDIR}/tests/did_store_test.o ${TESTDIR}/tests/did_store_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f20 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f19: ${TESTDIR}/tests/dtc_store_test.o ${TESTDIR}/tests/dtc_store_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f19 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f18: ${TESTDIR}/tests/uds_services_test.o ${TESTDIR}/tests/uds_services_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f18 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f17: ${TESTDIR}/tests/crc_stream_test.o ${TESTDIR}/tests/crc_stream_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f17 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f16: ${TESTDIR}/tests/download_service_test.o ${TESTDIR}/tests/download_service_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f16 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f15: ${TESTDIR}/tests/buffer_pool_test.o ${TESTDIR}/tests/buffer_pool_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f15 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f14: ${TESTDIR}/tests/request_snapshot_test.o ${TESTDIR}/tests/request_snapshot_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f14 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f13: ${TESTDIR}/tests/thread_pool_test.o ${TESTDIR}/tests/thread_pool_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f13 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f12: ${TESTDIR}/tests/metrics_test.o ${TESTDIR}/tests/metrics_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f12 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f11: ${TESTDIR}/tests/traffic_capture_test.o ${TESTDIR}/tests/traffic_capture_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f11 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f10: ${TESTDIR}/tests/logger_test.o ${TESTDIR}/tests/logger_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f10 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f9: ${TESTDIR}/tests/timer_wheel_test.o ${TESTDIR}/tests/timer_wheel_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f9 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f8: ${TESTDIR}/tests/data_identifier_index_test.o ${TESTDIR}/tests/data_identifier_index_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f8 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+${TESTDIR}/TestFiles/f7: ${TESTDIR}/tests/compiled_request_matcher_test.o ${TESTDIR}/tests/compiled_request_matcher_test_runner.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TESTDIR}/TestFiles
+	${LINK.cc} -o ${TESTDIR}/TestFiles/f7 $^ ${LDLIBSOPTIONS}   `cppunit-config --libs`   
+
+
+${TESTDIR}/tests/ecu_lua_script_test.o: tests/ecu_lua_script_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/ecu_lua_script_test.o tests/ecu_lua_script_test.cpp
+
+
+${TESTDIR}/tests/ecu_lua_script_test_runner.o: tests/ecu_lua_script_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/ecu_lua_script_test_runner.o tests/ecu_lua_script_test_runner.cpp
+
+
+${TESTDIR}/tests/electronic_control_unit_test.o: tests/electronic_control_unit_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/electronic_control_unit_test.o tests/electronic_control_unit_test.cpp
+
+
+${TESTDIR}/tests/electronic_control_unit_test_runner.o: tests/electronic_control_unit_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/electronic_control_unit_test_runner.o tests/electronic_control_unit_test_runner.cpp
+
+
+${TESTDIR}/tests/isotp_sender_test.o: tests/isotp_sender_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/isotp_sender_test.o tests/isotp_sender_test.cpp
+
+
+${TESTDIR}/tests/isotp_sender_test_runner.o: tests/isotp_sender_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/isotp_sender_test_runner.o tests/isotp_sender_test_runner.cpp
+
+
+${TESTDIR}/tests/uds_receiver_test.o: tests/uds_receiver_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/uds_receiver_test.o tests/uds_receiver_test.cpp
+
+
+${TESTDIR}/tests/uds_receiver_test_runner.o: tests/uds_receiver_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/uds_receiver_test_runner.o tests/uds_receiver_test_runner.cpp
+
+
+${TESTDIR}/tests/utils_test.o: tests/utils_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/utils_test.o tests/utils_test.cpp
+
+${TESTDIR}/tests/j1939_pgn_index_test.o: tests/j1939_pgn_index_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/j1939_pgn_index_test.o tests/j1939_pgn_index_test.cpp
+
+${TESTDIR}/tests/replay_trace_test.o: tests/replay_trace_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/replay_trace_test.o tests/replay_trace_test.cpp
+
+${TESTDIR}/tests/lua_memory_pool_test.o: tests/lua_memory_pool_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/lua_memory_pool_test.o tests/lua_memory_pool_test.cpp
+
+${TESTDIR}/tests/thread_placement_test.o: tests/thread_placement_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/thread_placement_test.o tests/thread_placement_test.cpp
+
+${TESTDIR}/tests/isotp_engine_test.o: tests/isotp_engine_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/isotp_engine_test.o tests/isotp_engine_test.cpp
+
+${TESTDIR}/tests/can_frame_bus_test.o: tests/can_frame_bus_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/can_frame_bus_test.o tests/can_frame_bus_test.cpp
+
+${TESTDIR}/tests/simulation_clock_test.o: tests/simulation_clock_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/simulation_clock_test.o tests/simulation_clock_test.cpp
+
+${TESTDIR}/tests/car_simulator_test.o: tests/car_simulator_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/car_simulator_test.o tests/car_simulator_test.cpp
+
+${TESTDIR}/tests/lua_profiler_test.o: tests/lua_profiler_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/lua_profiler_test.o tests/lua_profiler_test.cpp
+
+${TESTDIR}/tests/hex_codec_test.o: tests/hex_codec_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/hex_codec_test.o tests/hex_codec_test.cpp
+
+${TESTDIR}/tests/response_cache_test.o: tests/response_cache_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/response_cache_test.o tests/response_cache_test.cpp
+
+${TESTDIR}/tests/signal_feed_test.o: tests/signal_feed_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/signal_feed_test.o tests/signal_feed_test.cpp
+
+${TESTDIR}/tests/realtime_profile_test.o: tests/realtime_profile_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/realtime_profile_test.o tests/realtime_profile_test.cpp
+
+${TESTDIR}/tests/checkpoint_test.o: tests/checkpoint_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/checkpoint_test.o tests/checkpoint_test.cpp
+
+${TESTDIR}/tests/memory_service_test.o: tests/memory_service_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/memory_service_test.o tests/memory_service_test.cpp
+
+${TESTDIR}/tests/bus_load_budget_test.o: tests/bus_load_budget_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/bus_load_budget_test.o tests/bus_load_budget_test.cpp
+
+${TESTDIR}/tests/j1939_diagnostic_messages_test.o: tests/j1939_diagnostic_messages_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/j1939_diagnostic_messages_test.o tests/j1939_diagnostic_messages_test.cpp
+
+${TESTDIR}/tests/response_delay_test.o: tests/response_delay_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/response_delay_test.o tests/response_delay_test.cpp
+
+${TESTDIR}/tests/communication_gate_test.o: tests/communication_gate_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/communication_gate_test.o tests/communication_gate_test.cpp
+
+${TESTDIR}/tests/idle_monitor_test.o: tests/idle_monitor_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/idle_monitor_test.o tests/idle_monitor_test.cpp
+
+${TESTDIR}/tests/dynamic_data_service_test.o: tests/dynamic_data_service_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/dynamic_data_service_test.o tests/dynamic_data_service_test.cpp
+
+${TESTDIR}/tests/response_on_event_service_test.o: tests/response_on_event_service_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/response_on_event_service_test.o tests/response_on_event_service_test.cpp
+
+${TESTDIR}/tests/worker_supervisor_test.o: tests/worker_supervisor_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/worker_supervisor_test.o tests/worker_supervisor_test.cpp
+
+${TESTDIR}/tests/service_dispatcher_test.o: tests/service_dispatcher_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/service_dispatcher_test.o tests/service_dispatcher_test.cpp
+
+${TESTDIR}/tests/spsc_queue_test.o: tests/spsc_queue_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/spsc_queue_test.o tests/spsc_queue_test.cpp
+
+${TESTDIR}/tests/j1939_simulator_test.o: tests/j1939_simulator_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/j1939_simulator_test.o tests/j1939_simulator_test.cpp
+
+${TESTDIR}/tests/doip_can_gateway_test.o: tests/doip_can_gateway_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/doip_can_gateway_test.o tests/doip_can_gateway_test.cpp
+
+${TESTDIR}/tests/j1939_cyclic_scheduler_test.o: tests/j1939_cyclic_scheduler_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/j1939_cyclic_scheduler_test.o tests/j1939_cyclic_scheduler_test.cpp
+
+${TESTDIR}/tests/receiver_reactor_test.o: tests/receiver_reactor_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/receiver_reactor_test.o tests/receiver_reactor_test.cpp
+
+${TESTDIR}/tests/lua_worker_test.o: tests/lua_worker_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/lua_worker_test.o tests/lua_worker_test.cpp
+
+${TESTDIR}/tests/j1939_bus_test.o: tests/j1939_bus_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/j1939_bus_test.o tests/j1939_bus_test.cpp
+
+${TESTDIR}/tests/vehicle_signals_test.o: tests/vehicle_signals_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/vehicle_signals_test.o tests/vehicle_signals_test.cpp
+
+${TESTDIR}/tests/obd_service_test.o: tests/obd_service_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/obd_service_test.o tests/obd_service_test.cpp
+
+${TESTDIR}/tests/periodic_data_service_test.o: tests/periodic_data_service_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/periodic_data_service_test.o tests/periodic_data_service_test.cpp
+
+${TESTDIR}/tests/security_access_test.o: tests/security_access_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/security_access_test.o tests/security_access_test.cpp
+
+${TESTDIR}/tests/response_pending_test.o: tests/response_pending_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/response_pending_test.o tests/response_pending_test.cpp
+
+${TESTDIR}/tests/did_store_test.o: tests/did_store_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/did_store_test.o tests/did_store_test.cpp
+
+${TESTDIR}/tests/dtc_store_test.o: tests/dtc_store_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/dtc_store_test.o tests/dtc_store_test.cpp
+
+${TESTDIR}/tests/uds_services_test.o: tests/uds_services_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/uds_services_test.o tests/uds_services_test.cpp
+
+${TESTDIR}/tests/crc_stream_test.o: tests/crc_stream_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/crc_stream_test.o tests/crc_stream_test.cpp
+
+${TESTDIR}/tests/download_service_test.o: tests/download_service_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/download_service_test.o tests/download_service_test.cpp
+
+${TESTDIR}/tests/buffer_pool_test.o: tests/buffer_pool_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/buffer_pool_test.o tests/buffer_pool_test.cpp
+
+${TESTDIR}/tests/request_snapshot_test.o: tests/request_snapshot_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/request_snapshot_test.o tests/request_snapshot_test.cpp
+
+${TESTDIR}/tests/thread_pool_test.o: tests/thread_pool_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/thread_pool_test.o tests/thread_pool_test.cpp
+
+${TESTDIR}/tests/metrics_test.o: tests/metrics_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/metrics_test.o tests/metrics_test.cpp
+
+${TESTDIR}/tests/traffic_capture_test.o: tests/traffic_capture_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/traffic_capture_test.o tests/traffic_capture_test.cpp
+
+${TESTDIR}/tests/logger_test.o: tests/logger_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/logger_test.o tests/logger_test.cpp
+
+${TESTDIR}/tests/timer_wheel_test.o: tests/timer_wheel_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/timer_wheel_test.o tests/timer_wheel_test.cpp
+
+${TESTDIR}/tests/data_identifier_index_test.o: tests/data_identifier_index_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/data_identifier_index_test.o tests/data_identifier_index_test.cpp
+
+${TESTDIR}/tests/compiled_request_matcher_test.o: tests/compiled_request_matcher_test.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/compiled_request_matcher_test.o tests/compiled_request_matcher_test.cpp
+
+
+${TESTDIR}/tests/utils_test_runner.o: tests/utils_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/utils_test_runner.o tests/utils_test_runner.cpp
+
+${TESTDIR}/tests/j1939_pgn_index_test_runner.o: tests/j1939_pgn_index_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/j1939_pgn_index_test_runner.o tests/j1939_pgn_index_test_runner.cpp
+
+${TESTDIR}/tests/replay_trace_test_runner.o: tests/replay_trace_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/replay_trace_test_runner.o tests/replay_trace_test_runner.cpp
+
+${TESTDIR}/tests/lua_memory_pool_test_runner.o: tests/lua_memory_pool_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/lua_memory_pool_test_runner.o tests/lua_memory_pool_test_runner.cpp
+
+${TESTDIR}/tests/thread_placement_test_runner.o: tests/thread_placement_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/thread_placement_test_runner.o tests/thread_placement_test_runner.cpp
+
+${TESTDIR}/tests/isotp_engine_test_runner.o: tests/isotp_engine_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/isotp_engine_test_runner.o tests/isotp_engine_test_runner.cpp
+
+${TESTDIR}/tests/can_frame_bus_test_runner.o: tests/can_frame_bus_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/can_frame_bus_test_runner.o tests/can_frame_bus_test_runner.cpp
+
+${TESTDIR}/tests/simulation_clock_test_runner.o: tests/simulation_clock_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/simulation_clock_test_runner.o tests/simulation_clock_test_runner.cpp
+
+${TESTDIR}/tests/car_simulator_test_runner.o: tests/car_simulator_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/car_simulator_test_runner.o tests/car_simulator_test_runner.cpp
+
+${TESTDIR}/tests/lua_profiler_test_runner.o: tests/lua_profiler_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/lua_profiler_test_runner.o tests/lua_profiler_test_runner.cpp
+
+${TESTDIR}/tests/hex_codec_test_runner.o: tests/hex_codec_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/hex_codec_test_runner.o tests/hex_codec_test_runner.cpp
+
+${TESTDIR}/tests/response_cache_test_runner.o: tests/response_cache_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/response_cache_test_runner.o tests/response_cache_test_runner.cpp
+
+${TESTDIR}/tests/signal_feed_test_runner.o: tests/signal_feed_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/signal_feed_test_runner.o tests/signal_feed_test_runner.cpp
+
+${TESTDIR}/tests/realtime_profile_test_runner.o: tests/realtime_profile_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/realtime_profile_test_runner.o tests/realtime_profile_test_runner.cpp
+
+${TESTDIR}/tests/checkpoint_test_runner.o: tests/checkpoint_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/checkpoint_test_runner.o tests/checkpoint_test_runner.cpp
+
+${TESTDIR}/tests/memory_service_test_runner.o: tests/memory_service_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/memory_service_test_runner.o tests/memory_service_test_runner.cpp
+
+${TESTDIR}/tests/bus_load_budget_test_runner.o: tests/bus_load_budget_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/bus_load_budget_test_runner.o tests/bus_load_budget_test_runner.cpp
+
+${TESTDIR}/tests/j1939_diagnostic_messages_test_runner.o: tests/j1939_diagnostic_messages_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/j1939_diagnostic_messages_test_runner.o tests/j1939_diagnostic_messages_test_runner.cpp
+
+${TESTDIR}/tests/response_delay_test_runner.o: tests/response_delay_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/response_delay_test_runner.o tests/response_delay_test_runner.cpp
+
+${TESTDIR}/tests/communication_gate_test_runner.o: tests/communication_gate_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/communication_gate_test_runner.o tests/communication_gate_test_runner.cpp
+
+${TESTDIR}/tests/idle_monitor_test_runner.o: tests/idle_monitor_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/idle_monitor_test_runner.o tests/idle_monitor_test_runner.cpp
+
+${TESTDIR}/tests/dynamic_data_service_test_runner.o: tests/dynamic_data_service_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/dynamic_data_service_test_runner.o tests/dynamic_data_service_test_runner.cpp
+
+${TESTDIR}/tests/response_on_event_service_test_runner.o: tests/response_on_event_service_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/response_on_event_service_test_runner.o tests/response_on_event_service_test_runner.cpp
+
+${TESTDIR}/tests/worker_supervisor_test_runner.o: tests/worker_supervisor_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/worker_supervisor_test_runner.o tests/worker_supervisor_test_runner.cpp
+
+${TESTDIR}/tests/service_dispatcher_test_runner.o: tests/service_dispatcher_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/service_dispatcher_test_runner.o tests/service_dispatcher_test_runner.cpp
+
+${TESTDIR}/tests/spsc_queue_test_runner.o: tests/spsc_queue_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/spsc_queue_test_runner.o tests/spsc_queue_test_runner.cpp
+
+${TESTDIR}/tests/j1939_simulator_test_runner.o: tests/j1939_simulator_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/j1939_simulator_test_runner.o tests/j1939_simulator_test_runner.cpp
+
+${TESTDIR}/tests/doip_can_gateway_test_runner.o: tests/doip_can_gateway_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/doip_can_gateway_test_runner.o tests/doip_can_gateway_test_runner.cpp
+
+${TESTDIR}/tests/j1939_cyclic_scheduler_test_runner.o: tests/j1939_cyclic_scheduler_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/j1939_cyclic_scheduler_test_runner.o tests/j1939_cyclic_scheduler_test_runner.cpp
+
+${TESTDIR}/tests/receiver_reactor_test_runner.o: tests/receiver_reactor_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/receiver_reactor_test_runner.o tests/receiver_reactor_test_runner.cpp
+
+${TESTDIR}/tests/lua_worker_test_runner.o: tests/lua_worker_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/lua_worker_test_runner.o tests/lua_worker_test_runner.cpp
+
+${TESTDIR}/tests/j1939_bus_test_runner.o: tests/j1939_bus_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/j1939_bus_test_runner.o tests/j1939_bus_test_runner.cpp
+
+${TESTDIR}/tests/vehicle_signals_test_runner.o: tests/vehicle_signals_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/vehicle_signals_test_runner.o tests/vehicle_signals_test_runner.cpp
+
+${TESTDIR}/tests/obd_service_test_runner.o: tests/obd_service_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/obd_service_test_runner.o tests/obd_service_test_runner.cpp
+
+${TESTDIR}/tests/periodic_data_service_test_runner.o: tests/periodic_data_service_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/periodic_data_service_test_runner.o tests/periodic_data_service_test_runner.cpp
+
+${TESTDIR}/tests/security_access_test_runner.o: tests/security_access_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/security_access_test_runner.o tests/security_access_test_runner.cpp
+
+${TESTDIR}/tests/response_pending_test_runner.o: tests/response_pending_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/response_pending_test_runner.o tests/response_pending_test_runner.cpp
+
+${TESTDIR}/tests/did_store_test_runner.o: tests/did_store_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/did_store_test_runner.o tests/did_store_test_runner.cpp
+
+${TESTDIR}/tests/dtc_store_test_runner.o: tests/dtc_store_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/dtc_store_test_runner.o tests/dtc_store_test_runner.cpp
+
+${TESTDIR}/tests/uds_services_test_runner.o: tests/uds_services_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/uds_services_test_runner.o tests/uds_services_test_runner.cpp
+
+${TESTDIR}/tests/crc_stream_test_runner.o: tests/crc_stream_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/crc_stream_test_runner.o tests/crc_stream_test_runner.cpp
+
+${TESTDIR}/tests/download_service_test_runner.o: tests/download_service_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/download_service_test_runner.o tests/download_service_test_runner.cpp
+
+${TESTDIR}/tests/buffer_pool_test_runner.o: tests/buffer_pool_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/buffer_pool_test_runner.o tests/buffer_pool_test_runner.cpp
+
+${TESTDIR}/tests/request_snapshot_test_runner.o: tests/request_snapshot_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/request_snapshot_test_runner.o tests/request_snapshot_test_runner.cpp
+
+${TESTDIR}/tests/thread_pool_test_runner.o: tests/thread_pool_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/thread_pool_test_runner.o tests/thread_pool_test_runner.cpp
+
+${TESTDIR}/tests/metrics_test_runner.o: tests/metrics_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/metrics_test_runner.o tests/metrics_test_runner.cpp
+
+${TESTDIR}/tests/traffic_capture_test_runner.o: tests/traffic_capture_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/traffic_capture_test_runner.o tests/traffic_capture_test_runner.cpp
+
+${TESTDIR}/tests/logger_test_runner.o: tests/logger_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/logger_test_runner.o tests/logger_test_runner.cpp
+
+${TESTDIR}/tests/timer_wheel_test_runner.o: tests/timer_wheel_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/timer_wheel_test_runner.o tests/timer_wheel_test_runner.cpp
+
+${TESTDIR}/tests/data_identifier_index_test_runner.o: tests/data_identifier_index_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/data_identifier_index_test_runner.o tests/data_identifier_index_test_runner.cpp
+
+${TESTDIR}/tests/compiled_request_matcher_test_runner.o: tests/compiled_request_matcher_test_runner.cpp 
+	${MKDIR} -p ${TESTDIR}/tests
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/compiled_request_matcher_test_runner.o tests/compiled_request_matcher_test_runner.cpp
+
+
+${OBJECTDIR}/src/broadcast_receiver_nomain.o: ${OBJECTDIR}/src/broadcast_receiver.o src/broadcast_receiver.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/broadcast_receiver.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/broadcast_receiver_nomain.o src/broadcast_receiver.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/broadcast_receiver.o ${OBJECTDIR}/src/broadcast_receiver_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/ecu_lua_script_nomain.o: ${OBJECTDIR}/src/ecu_lua_script.o src/ecu_lua_script.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/ecu_lua_script.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/ecu_lua_script_nomain.o src/ecu_lua_script.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/ecu_lua_script.o ${OBJECTDIR}/src/ecu_lua_script_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/ecu_timer_nomain.o: ${OBJECTDIR}/src/ecu_timer.o src/ecu_timer.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/ecu_timer.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/ecu_timer_nomain.o src/ecu_timer.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/ecu_timer.o ${OBJECTDIR}/src/ecu_timer_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/electronic_control_unit_nomain.o: ${OBJECTDIR}/src/electronic_control_unit.o src/electronic_control_unit.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/electronic_control_unit.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/electronic_control_unit_nomain.o src/electronic_control_unit.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/electronic_control_unit.o ${OBJECTDIR}/src/electronic_control_unit_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/isotp_receiver_nomain.o: ${OBJECTDIR}/src/isotp_receiver.o src/isotp_receiver.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/isotp_receiver.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/isotp_receiver_nomain.o src/isotp_receiver.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/isotp_receiver.o ${OBJECTDIR}/src/isotp_receiver_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/isotp_sender_nomain.o: ${OBJECTDIR}/src/isotp_sender.o src/isotp_sender.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/isotp_sender.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/isotp_sender_nomain.o src/isotp_sender.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/isotp_sender.o ${OBJECTDIR}/src/isotp_sender_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/main_nomain.o: ${OBJECTDIR}/src/main.o src/main.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/main.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/main_nomain.o src/main.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/main.o ${OBJECTDIR}/src/main_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/session_controller_nomain.o: ${OBJECTDIR}/src/session_controller.o src/session_controller.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/session_controller.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/session_controller_nomain.o src/session_controller.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/session_controller.o ${OBJECTDIR}/src/session_controller_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/uds_receiver_nomain.o: ${OBJECTDIR}/src/uds_receiver.o src/uds_receiver.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/uds_receiver.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/uds_receiver_nomain.o src/uds_receiver.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/uds_receiver.o ${OBJECTDIR}/src/uds_receiver_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/utilities_nomain.o: ${OBJECTDIR}/src/utilities.o src/utilities.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/utilities.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/utilities_nomain.o src/utilities.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/utilities.o ${OBJECTDIR}/src/utilities_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/j1939_simulator_nomain.o: ${OBJECTDIR}/src/j1939_simulator.o src/j1939_simulator.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/j1939_simulator.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/j1939_simulator_nomain.o src/j1939_simulator.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/j1939_simulator.o ${OBJECTDIR}/src/j1939_simulator_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/lua_worker_nomain.o: ${OBJECTDIR}/src/lua_worker.o src/lua_worker.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/lua_worker.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/lua_worker_nomain.o src/lua_worker.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/lua_worker.o ${OBJECTDIR}/src/lua_worker_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/receiver_reactor_nomain.o: ${OBJECTDIR}/src/receiver_reactor.o src/receiver_reactor.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/receiver_reactor.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/receiver_reactor_nomain.o src/receiver_reactor.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/receiver_reactor.o ${OBJECTDIR}/src/receiver_reactor_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/simulator_configuration_nomain.o: ${OBJECTDIR}/src/simulator_configuration.o src/simulator_configuration.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/simulator_configuration.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/simulator_configuration_nomain.o src/simulator_configuration.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/simulator_configuration.o ${OBJECTDIR}/src/simulator_configuration_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/timer_wheel_nomain.o: ${OBJECTDIR}/src/timer_wheel.o src/timer_wheel.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/timer_wheel.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/timer_wheel_nomain.o src/timer_wheel.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/timer_wheel.o ${OBJECTDIR}/src/timer_wheel_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/j1939_cyclic_scheduler_nomain.o: ${OBJECTDIR}/src/j1939_cyclic_scheduler.o src/j1939_cyclic_scheduler.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/j1939_cyclic_scheduler.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/j1939_cyclic_scheduler_nomain.o src/j1939_cyclic_scheduler.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/j1939_cyclic_scheduler.o ${OBJECTDIR}/src/j1939_cyclic_scheduler_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/bus_state_monitor_nomain.o: ${OBJECTDIR}/src/bus_state_monitor.o src/bus_state_monitor.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/bus_state_monitor.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/bus_state_monitor_nomain.o src/bus_state_monitor.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/bus_state_monitor.o ${OBJECTDIR}/src/bus_state_monitor_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/logger_nomain.o: ${OBJECTDIR}/src/logger.o src/logger.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/logger.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/logger_nomain.o src/logger.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/logger.o ${OBJECTDIR}/src/logger_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/traffic_capture_nomain.o: ${OBJECTDIR}/src/traffic_capture.o src/traffic_capture.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/traffic_capture.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/traffic_capture_nomain.o src/traffic_capture.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/traffic_capture.o ${OBJECTDIR}/src/traffic_capture_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/metrics_nomain.o: ${OBJECTDIR}/src/metrics.o src/metrics.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/metrics.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/metrics_nomain.o src/metrics.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/metrics.o ${OBJECTDIR}/src/metrics_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/thread_pool_nomain.o: ${OBJECTDIR}/src/thread_pool.o src/thread_pool.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/thread_pool.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/thread_pool_nomain.o src/thread_pool.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/thread_pool.o ${OBJECTDIR}/src/thread_pool_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/request_snapshot_nomain.o: ${OBJECTDIR}/src/request_snapshot.o src/request_snapshot.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/request_snapshot.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/request_snapshot_nomain.o src/request_snapshot.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/request_snapshot.o ${OBJECTDIR}/src/request_snapshot_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/config_watcher_nomain.o: ${OBJECTDIR}/src/config_watcher.o src/config_watcher.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/config_watcher.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/config_watcher_nomain.o src/config_watcher.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/config_watcher.o ${OBJECTDIR}/src/config_watcher_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/doip_tcp_connection_nomain.o: ${OBJECTDIR}/src/doip_tcp_connection.o src/doip_tcp_connection.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/doip_tcp_connection.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/doip_tcp_connection_nomain.o src/doip_tcp_connection.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/doip_tcp_connection.o ${OBJECTDIR}/src/doip_tcp_connection_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/doip_udp_socket_nomain.o: ${OBJECTDIR}/src/doip_udp_socket.o src/doip_udp_socket.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/doip_udp_socket.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/doip_udp_socket_nomain.o src/doip_udp_socket.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/doip_udp_socket.o ${OBJECTDIR}/src/doip_udp_socket_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/buffer_pool_nomain.o: ${OBJECTDIR}/src/buffer_pool.o src/buffer_pool.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/buffer_pool.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/buffer_pool_nomain.o src/buffer_pool.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/buffer_pool.o ${OBJECTDIR}/src/buffer_pool_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/download_service_nomain.o: ${OBJECTDIR}/src/download_service.o src/download_service.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/download_service.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/download_service_nomain.o src/download_service.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/download_service.o ${OBJECTDIR}/src/download_service_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/crc_stream_nomain.o: ${OBJECTDIR}/src/crc_stream.o src/crc_stream.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/crc_stream.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/crc_stream_nomain.o src/crc_stream.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/crc_stream.o ${OBJECTDIR}/src/crc_stream_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/uds_services_nomain.o: ${OBJECTDIR}/src/uds_services.o src/uds_services.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/uds_services.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/uds_services_nomain.o src/uds_services.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/uds_services.o ${OBJECTDIR}/src/uds_services_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/dtc_store_nomain.o: ${OBJECTDIR}/src/dtc_store.o src/dtc_store.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/dtc_store.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/dtc_store_nomain.o src/dtc_store.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/dtc_store.o ${OBJECTDIR}/src/dtc_store_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/did_store_nomain.o: ${OBJECTDIR}/src/did_store.o src/did_store.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/did_store.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/did_store_nomain.o src/did_store.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/did_store.o ${OBJECTDIR}/src/did_store_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/response_pending_nomain.o: ${OBJECTDIR}/src/response_pending.o src/response_pending.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/response_pending.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/response_pending_nomain.o src/response_pending.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/response_pending.o ${OBJECTDIR}/src/response_pending_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/security_access_nomain.o: ${OBJECTDIR}/src/security_access.o src/security_access.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/security_access.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/security_access_nomain.o src/security_access.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/security_access.o ${OBJECTDIR}/src/security_access_nomain.o;\
+	fi
+
+${OBJECTDIR}/src/aes128_nomain.o: ${OBJECTDIR}/src/aes128.o src/aes128.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/aes128.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/aes128_nomain.o src/aes128.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/aes128.o ${OBJECTDIR}/src/aes128_nomain.o;\
+	fi
 
-${TESTDIR}/tests/ecu_lua_script_test.o: tests/ecu_lua_script_test.cpp 
-	${MKDIR} -p ${TESTDIR}/tests
-	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/ecu_lua_script_test.o tests/ecu_lua_script_test.cpp
+${OBJECTDIR}/src/periodic_data_service_nomain.o: ${OBJECTDIR}/src/periodic_data_service.o src/periodic_data_service.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/periodic_data_service.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/periodic_data_service_nomain.o src/periodic_data_service.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/periodic_data_service.o ${OBJECTDIR}/src/periodic_data_service_nomain.o;\
+	fi
 
+${OBJECTDIR}/src/obd_service_nomain.o: ${OBJECTDIR}/src/obd_service.o src/obd_service.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/obd_service.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/obd_service_nomain.o src/obd_service.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/obd_service.o ${OBJECTDIR}/src/obd_service_nomain.o;\
+	fi
 
-${TESTDIR}/tests/ecu_lua_script_test_runner.o: tests/ecu_lua_script_test_runner.cpp 
-	${MKDIR} -p ${TESTDIR}/tests
-	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/ecu_lua_script_test_runner.o tests/ecu_lua_script_test_runner.cpp
+${OBJECTDIR}/src/vehicle_signals_nomain.o: ${OBJECTDIR}/src/vehicle_signals.o src/vehicle_signals.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/vehicle_signals.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/vehicle_signals_nomain.o src/vehicle_signals.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/vehicle_signals.o ${OBJECTDIR}/src/vehicle_signals_nomain.o;\
+	fi
 
+${OBJECTDIR}/src/j1939_bus_nomain.o: ${OBJECTDIR}/src/j1939_bus.o src/j1939_bus.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/j1939_bus.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/j1939_bus_nomain.o src/j1939_bus.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/j1939_bus.o ${OBJECTDIR}/src/j1939_bus_nomain.o;\
+	fi
 
-${TESTDIR}/tests/electronic_control_unit_test.o: tests/electronic_control_unit_test.cpp 
-	${MKDIR} -p ${TESTDIR}/tests
-	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/electronic_control_unit_test.o tests/electronic_control_unit_test.cpp
+${OBJECTDIR}/src/isotp_configuration_nomain.o: ${OBJECTDIR}/src/isotp_configuration.o src/isotp_configuration.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/isotp_configuration.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/isotp_configuration_nomain.o src/isotp_configuration.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/isotp_configuration.o ${OBJECTDIR}/src/isotp_configuration_nomain.o;\
+	fi
 
+${OBJECTDIR}/src/replay_trace_nomain.o: ${OBJECTDIR}/src/replay_trace.o src/replay_trace.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/replay_trace.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/replay_trace_nomain.o src/replay_trace.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/replay_trace.o ${OBJECTDIR}/src/replay_trace_nomain.o;\
+	fi
 
-${TESTDIR}/tests/electronic_control_unit_test_runner.o: tests/electronic_control_unit_test_runner.cpp 
-	${MKDIR} -p ${TESTDIR}/tests
-	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/electronic_control_unit_test_runner.o tests/electronic_control_unit_test_runner.cpp
+${OBJECTDIR}/src/lua_memory_pool_nomain.o: ${OBJECTDIR}/src/lua_memory_pool.o src/lua_memory_pool.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/lua_memory_pool.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/lua_memory_pool_nomain.o src/lua_memory_pool.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/lua_memory_pool.o ${OBJECTDIR}/src/lua_memory_pool_nomain.o;\
+	fi
 
+${OBJECTDIR}/src/thread_placement_nomain.o: ${OBJECTDIR}/src/thread_placement.o src/thread_placement.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/thread_placement.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/thread_placement_nomain.o src/thread_placement.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/thread_placement.o ${OBJECTDIR}/src/thread_placement_nomain.o;\
+	fi
 
-${TESTDIR}/tests/isotp_sender_test.o: tests/isotp_sender_test.cpp 
-	${MKDIR} -p ${TESTDIR}/tests
-	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/isotp_sender_test.o tests/isotp_sender_test.cpp
+${OBJECTDIR}/src/isotp_engine_nomain.o: ${OBJECTDIR}/src/isotp_engine.o src/isotp_engine.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/isotp_engine.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/isotp_engine_nomain.o src/isotp_engine.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/isotp_engine.o ${OBJECTDIR}/src/isotp_engine_nomain.o;\
+	fi
 
+${OBJECTDIR}/src/can_frame_bus_nomain.o: ${OBJECTDIR}/src/can_frame_bus.o src/can_frame_bus.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/can_frame_bus.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/can_frame_bus_nomain.o src/can_frame_bus.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/can_frame_bus.o ${OBJECTDIR}/src/can_frame_bus_nomain.o;\
+	fi
 
-${TESTDIR}/tests/isotp_sender_test_runner.o: tests/isotp_sender_test_runner.cpp 
-	${MKDIR} -p ${TESTDIR}/tests
-	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/isotp_sender_test_runner.o tests/isotp_sender_test_runner.cpp
+${OBJECTDIR}/src/can_frame_simulator_nomain.o: ${OBJECTDIR}/src/can_frame_simulator.o src/can_frame_simulator.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/can_frame_simulator.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/can_frame_simulator_nomain.o src/can_frame_simulator.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/can_frame_simulator.o ${OBJECTDIR}/src/can_frame_simulator_nomain.o;\
+	fi
 
+${OBJECTDIR}/src/doip_can_gateway_nomain.o: ${OBJECTDIR}/src/doip_can_gateway.o src/doip_can_gateway.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/doip_can_gateway.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/doip_can_gateway_nomain.o src/doip_can_gateway.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/doip_can_gateway.o ${OBJECTDIR}/src/doip_can_gateway_nomain.o;\
+	fi
 
-${TESTDIR}/tests/uds_receiver_test.o: tests/uds_receiver_test.cpp 
-	${MKDIR} -p ${TESTDIR}/tests
-	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/uds_receiver_test.o tests/uds_receiver_test.cpp
+${OBJECTDIR}/src/simulation_clock_nomain.o: ${OBJECTDIR}/src/simulation_clock.o src/simulation_clock.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/simulation_clock.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/simulation_clock_nomain.o src/simulation_clock.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/simulation_clock.o ${OBJECTDIR}/src/simulation_clock_nomain.o;\
+	fi
 
+${OBJECTDIR}/src/loopback_transport_nomain.o: ${OBJECTDIR}/src/loopback_transport.o src/loopback_transport.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/loopback_transport.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/loopback_transport_nomain.o src/loopback_transport.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/loopback_transport.o ${OBJECTDIR}/src/loopback_transport_nomain.o;\
+	fi
 
-${TESTDIR}/tests/uds_receiver_test_runner.o: tests/uds_receiver_test_runner.cpp 
-	${MKDIR} -p ${TESTDIR}/tests
-	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/uds_receiver_test_runner.o tests/uds_receiver_test_runner.cpp
+${OBJECTDIR}/src/car_simulator_nomain.o: ${OBJECTDIR}/src/car_simulator.o src/car_simulator.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/car_simulator.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/car_simulator_nomain.o src/car_simulator.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/car_simulator.o ${OBJECTDIR}/src/car_simulator_nomain.o;\
+	fi
 
+${OBJECTDIR}/src/lua_profiler_nomain.o: ${OBJECTDIR}/src/lua_profiler.o src/lua_profiler.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/lua_profiler.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/lua_profiler_nomain.o src/lua_profiler.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/lua_profiler.o ${OBJECTDIR}/src/lua_profiler_nomain.o;\
+	fi
 
-${TESTDIR}/tests/utils_test.o: tests/utils_test.cpp 
-	${MKDIR} -p ${TESTDIR}/tests
-	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/utils_test.o tests/utils_test.cpp
+${OBJECTDIR}/src/hex_codec_nomain.o: ${OBJECTDIR}/src/hex_codec.o src/hex_codec.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/hex_codec.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/hex_codec_nomain.o src/hex_codec.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/hex_codec.o ${OBJECTDIR}/src/hex_codec_nomain.o;\
+	fi
 
+${OBJECTDIR}/src/response_cache_nomain.o: ${OBJECTDIR}/src/response_cache.o src/response_cache.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/response_cache.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/response_cache_nomain.o src/response_cache.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/response_cache.o ${OBJECTDIR}/src/response_cache_nomain.o;\
+	fi
 
-${TESTDIR}/tests/utils_test_runner.o: tests/utils_test_runner.cpp 
-	${MKDIR} -p ${TESTDIR}/tests
-	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/utils_test_runner.o tests/utils_test_runner.cpp
+${OBJECTDIR}/src/signal_feed_nomain.o: ${OBJECTDIR}/src/signal_feed.o src/signal_feed.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/signal_feed.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/signal_feed_nomain.o src/signal_feed.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/signal_feed.o ${OBJECTDIR}/src/signal_feed_nomain.o;\
+	fi
 
+${OBJECTDIR}/src/realtime_profile_nomain.o: ${OBJECTDIR}/src/realtime_profile.o src/realtime_profile.cpp 
+	${MKDIR} -p ${OBJECTDIR}/src
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/realtime_profile.o`; \
+	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
+	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
+	then  \
+	    ${RM} "$@.d";\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/realtime_profile_nomain.o src/realtime_profile.cpp;\
+	else  \
+	    ${CP} ${OBJECTDIR}/src/realtime_profile.o ${OBJECTDIR}/src/realtime_profile_nomain.o;\
+	fi
 
-${OBJECTDIR}/src/broadcast_receiver_nomain.o: ${OBJECTDIR}/src/broadcast_receiver.o src/broadcast_receiver.cpp 
+${OBJECTDIR}/src/checkpoint_nomain.o: ${OBJECTDIR}/src/checkpoint.o src/checkpoint.cpp 
 	${MKDIR} -p ${OBJECTDIR}/src
-	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/broadcast_receiver.o`; \
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/checkpoint.o`; \
 	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
 	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
 	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
 	then  \
 	    ${RM} "$@.d";\
-	    $(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/broadcast_receiver_nomain.o src/broadcast_receiver.cpp;\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/checkpoint_nomain.o src/checkpoint.cpp;\
 	else  \
-	    ${CP} ${OBJECTDIR}/src/broadcast_receiver.o ${OBJECTDIR}/src/broadcast_receiver_nomain.o;\
+	    ${CP} ${OBJECTDIR}/src/checkpoint.o ${OBJECTDIR}/src/checkpoint_nomain.o;\
 	fi
 
-${OBJECTDIR}/src/ecu_lua_script_nomain.o: ${OBJECTDIR}/src/ecu_lua_script.o src/ecu_lua_script.cpp 
+${OBJECTDIR}/src/memory_service_nomain.o: ${OBJECTDIR}/src/memory_service.o src/memory_service.cpp 
 	${MKDIR} -p ${OBJECTDIR}/src
-	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/ecu_lua_script.o`; \
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/memory_service.o`; \
 	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
 	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
 	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
 	then  \
 	    ${RM} "$@.d";\
-	    $(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/ecu_lua_script_nomain.o src/ecu_lua_script.cpp;\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/memory_service_nomain.o src/memory_service.cpp;\
 	else  \
-	    ${CP} ${OBJECTDIR}/src/ecu_lua_script.o ${OBJECTDIR}/src/ecu_lua_script_nomain.o;\
+	    ${CP} ${OBJECTDIR}/src/memory_service.o ${OBJECTDIR}/src/memory_service_nomain.o;\
 	fi
 
-${OBJECTDIR}/src/ecu_timer_nomain.o: ${OBJECTDIR}/src/ecu_timer.o src/ecu_timer.cpp 
+${OBJECTDIR}/src/bus_load_budget_nomain.o: ${OBJECTDIR}/src/bus_load_budget.o src/bus_load_budget.cpp 
 	${MKDIR} -p ${OBJECTDIR}/src
-	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/ecu_timer.o`; \
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/bus_load_budget.o`; \
 	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
 	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
 	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
 	then  \
 	    ${RM} "$@.d";\
-	    $(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/ecu_timer_nomain.o src/ecu_timer.cpp;\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/bus_load_budget_nomain.o src/bus_load_budget.cpp;\
 	else  \
-	    ${CP} ${OBJECTDIR}/src/ecu_timer.o ${OBJECTDIR}/src/ecu_timer_nomain.o;\
+	    ${CP} ${OBJECTDIR}/src/bus_load_budget.o ${OBJECTDIR}/src/bus_load_budget_nomain.o;\
 	fi
 
-${OBJECTDIR}/src/electronic_control_unit_nomain.o: ${OBJECTDIR}/src/electronic_control_unit.o src/electronic_control_unit.cpp 
+${OBJECTDIR}/src/j1939_diagnostic_messages_nomain.o: ${OBJECTDIR}/src/j1939_diagnostic_messages.o src/j1939_diagnostic_messages.cpp 
 	${MKDIR} -p ${OBJECTDIR}/src
-	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/electronic_control_unit.o`; \
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/j1939_diagnostic_messages.o`; \
 	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
 	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
 	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
 	then  \
 	    ${RM} "$@.d";\
-	    $(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/electronic_control_unit_nomain.o src/electronic_control_unit.cpp;\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/j1939_diagnostic_messages_nomain.o src/j1939_diagnostic_messages.cpp;\
 	else  \
-	    ${CP} ${OBJECTDIR}/src/electronic_control_unit.o ${OBJECTDIR}/src/electronic_control_unit_nomain.o;\
+	    ${CP} ${OBJECTDIR}/src/j1939_diagnostic_messages.o ${OBJECTDIR}/src/j1939_diagnostic_messages_nomain.o;\
 	fi
 
-${OBJECTDIR}/src/isotp_receiver_nomain.o: ${OBJECTDIR}/src/isotp_receiver.o src/isotp_receiver.cpp 
+${OBJECTDIR}/src/response_delay_nomain.o: ${OBJECTDIR}/src/response_delay.o src/response_delay.cpp 
 	${MKDIR} -p ${OBJECTDIR}/src
-	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/isotp_receiver.o`; \
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/response_delay.o`; \
 	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
 	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
 	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
 	then  \
 	    ${RM} "$@.d";\
-	    $(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/isotp_receiver_nomain.o src/isotp_receiver.cpp;\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/response_delay_nomain.o src/response_delay.cpp;\
 	else  \
-	    ${CP} ${OBJECTDIR}/src/isotp_receiver.o ${OBJECTDIR}/src/isotp_receiver_nomain.o;\
+	    ${CP} ${OBJECTDIR}/src/response_delay.o ${OBJECTDIR}/src/response_delay_nomain.o;\
 	fi
 
-${OBJECTDIR}/src/isotp_sender_nomain.o: ${OBJECTDIR}/src/isotp_sender.o src/isotp_sender.cpp 
+${OBJECTDIR}/src/communication_gate_nomain.o: ${OBJECTDIR}/src/communication_gate.o src/communication_gate.cpp 
 	${MKDIR} -p ${OBJECTDIR}/src
-	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/isotp_sender.o`; \
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/communication_gate.o`; \
 	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
 	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
 	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
 	then  \
 	    ${RM} "$@.d";\
-	    $(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/isotp_sender_nomain.o src/isotp_sender.cpp;\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/communication_gate_nomain.o src/communication_gate.cpp;\
 	else  \
-	    ${CP} ${OBJECTDIR}/src/isotp_sender.o ${OBJECTDIR}/src/isotp_sender_nomain.o;\
+	    ${CP} ${OBJECTDIR}/src/communication_gate.o ${OBJECTDIR}/src/communication_gate_nomain.o;\
 	fi
 
-${OBJECTDIR}/src/main_nomain.o: ${OBJECTDIR}/src/main.o src/main.cpp 
+${OBJECTDIR}/src/idle_monitor_nomain.o: ${OBJECTDIR}/src/idle_monitor.o src/idle_monitor.cpp 
 	${MKDIR} -p ${OBJECTDIR}/src
-	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/main.o`; \
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/idle_monitor.o`; \
 	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
 	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
 	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
 	then  \
 	    ${RM} "$@.d";\
-	    $(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/main_nomain.o src/main.cpp;\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/idle_monitor_nomain.o src/idle_monitor.cpp;\
 	else  \
-	    ${CP} ${OBJECTDIR}/src/main.o ${OBJECTDIR}/src/main_nomain.o;\
+	    ${CP} ${OBJECTDIR}/src/idle_monitor.o ${OBJECTDIR}/src/idle_monitor_nomain.o;\
 	fi
 
-${OBJECTDIR}/src/session_controller_nomain.o: ${OBJECTDIR}/src/session_controller.o src/session_controller.cpp 
+${OBJECTDIR}/src/dynamic_data_service_nomain.o: ${OBJECTDIR}/src/dynamic_data_service.o src/dynamic_data_service.cpp 
 	${MKDIR} -p ${OBJECTDIR}/src
-	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/session_controller.o`; \
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/dynamic_data_service.o`; \
 	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
 	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
 	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
 	then  \
 	    ${RM} "$@.d";\
-	    $(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/session_controller_nomain.o src/session_controller.cpp;\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/dynamic_data_service_nomain.o src/dynamic_data_service.cpp;\
 	else  \
-	    ${CP} ${OBJECTDIR}/src/session_controller.o ${OBJECTDIR}/src/session_controller_nomain.o;\
+	    ${CP} ${OBJECTDIR}/src/dynamic_data_service.o ${OBJECTDIR}/src/dynamic_data_service_nomain.o;\
 	fi
 
-${OBJECTDIR}/src/uds_receiver_nomain.o: ${OBJECTDIR}/src/uds_receiver.o src/uds_receiver.cpp 
+${OBJECTDIR}/src/response_on_event_service_nomain.o: ${OBJECTDIR}/src/response_on_event_service.o src/response_on_event_service.cpp 
 	${MKDIR} -p ${OBJECTDIR}/src
-	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/uds_receiver.o`; \
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/response_on_event_service.o`; \
 	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
 	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
 	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
 	then  \
 	    ${RM} "$@.d";\
-	    $(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/uds_receiver_nomain.o src/uds_receiver.cpp;\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/response_on_event_service_nomain.o src/response_on_event_service.cpp;\
 	else  \
-	    ${CP} ${OBJECTDIR}/src/uds_receiver.o ${OBJECTDIR}/src/uds_receiver_nomain.o;\
+	    ${CP} ${OBJECTDIR}/src/response_on_event_service.o ${OBJECTDIR}/src/response_on_event_service_nomain.o;\
 	fi
 
-${OBJECTDIR}/src/utilities_nomain.o: ${OBJECTDIR}/src/utilities.o src/utilities.cpp 
+${OBJECTDIR}/src/worker_supervisor_nomain.o: ${OBJECTDIR}/src/worker_supervisor.o src/worker_supervisor.cpp 
 	${MKDIR} -p ${OBJECTDIR}/src
-	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/utilities.o`; \
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/worker_supervisor.o`; \
 	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
 	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
 	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
 	then  \
 	    ${RM} "$@.d";\
-	    $(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/utilities_nomain.o src/utilities.cpp;\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/worker_supervisor_nomain.o src/worker_supervisor.cpp;\
 	else  \
-	    ${CP} ${OBJECTDIR}/src/utilities.o ${OBJECTDIR}/src/utilities_nomain.o;\
+	    ${CP} ${OBJECTDIR}/src/worker_supervisor.o ${OBJECTDIR}/src/worker_supervisor_nomain.o;\
 	fi
 
-${OBJECTDIR}/src/j1939_simulator_nomain.o: ${OBJECTDIR}/src/j1939_simulator.o src/j1939_simulator.cpp 
+${OBJECTDIR}/src/service_dispatcher_nomain.o: ${OBJECTDIR}/src/service_dispatcher.o src/service_dispatcher.cpp 
 	${MKDIR} -p ${OBJECTDIR}/src
-	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/j1939_simulator.o`; \
+	@NMOUTPUT=`${NM} ${OBJECTDIR}/src/service_dispatcher.o`; \
 	if (echo "$$NMOUTPUT" | ${GREP} '|main$$') || \
 	   (echo "$$NMOUTPUT" | ${GREP} 'T main$$') || \
 	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
 	then  \
 	    ${RM} "$@.d";\
-	    $(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/j1939_simulator_nomain.o src/j1939_simulator.cpp;\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` `pkg-config --cflags cppunit` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/service_dispatcher_nomain.o src/service_dispatcher.cpp;\
 	else  \
-	    ${CP} ${OBJECTDIR}/src/j1939_simulator.o ${OBJECTDIR}/src/j1939_simulator_nomain.o;\
+	    ${CP} ${OBJECTDIR}/src/service_dispatcher.o ${OBJECTDIR}/src/service_dispatcher_nomain.o;\
 	fi
 	
+# Build Benchmark Targets
+BENCHMARKDIR=${CND_BUILDDIR}/${CND_CONF}/${CND_PLATFORM}/benchmarks
+.build-benchmarks-conf: .build-conf ${BENCHMARKDIR}/request_path_benchmark ${BENCHMARKDIR}/scalability_benchmark
+
+${BENCHMARKDIR}/request_path_benchmark: ${BENCHMARKDIR}/benchmark.o ${BENCHMARKDIR}/request_path_benchmark.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${BENCHMARKDIR}
+	${LINK.cc} -o ${BENCHMARKDIR}/request_path_benchmark $^ ${LDLIBSOPTIONS}
+
+${BENCHMARKDIR}/benchmark.o: benchmarks/benchmark.cpp 
+	${MKDIR} -p ${BENCHMARKDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17 -MMD -MP -MF "$@.d" -o ${BENCHMARKDIR}/benchmark.o benchmarks/benchmark.cpp
+
+${BENCHMARKDIR}/request_path_benchmark.o: benchmarks/request_path_benchmark.cpp 
+	${MKDIR} -p ${BENCHMARKDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17 -MMD -MP -MF "$@.d" -o ${BENCHMARKDIR}/request_path_benchmark.o benchmarks/request_path_benchmark.cpp
+
+${BENCHMARKDIR}/scalability_benchmark: ${BENCHMARKDIR}/scalability_benchmark.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${BENCHMARKDIR}
+	${LINK.cc} -o ${BENCHMARKDIR}/scalability_benchmark $^ ${LDLIBSOPTIONS}
+
+${BENCHMARKDIR}/scalability_benchmark.o: benchmarks/scalability_benchmark.cpp 
+	${MKDIR} -p ${BENCHMARKDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17 -MMD -MP -MF "$@.d" -o ${BENCHMARKDIR}/scalability_benchmark.o benchmarks/scalability_benchmark.cpp
+
+# Build Tool Targets
+TOOLSDIR=${CND_BUILDDIR}/${CND_CONF}/${CND_PLATFORM}/tools
+.build-tools-conf: .build-conf ${TOOLSDIR}/load_generator ${TOOLSDIR}/request_validator
+
+${TOOLSDIR}/load_generator: ${TOOLSDIR}/load_generator.o ${TOOLSDIR}/request_mix.o ${TOOLSDIR}/doip_tester.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TOOLSDIR}
+	${LINK.cc} -o ${TOOLSDIR}/load_generator $^ ${LDLIBSOPTIONS}
+
+${TOOLSDIR}/load_generator.o: tools/load_generator.cpp 
+	${MKDIR} -p ${TOOLSDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17 -MMD -MP -MF "$@.d" -o ${TOOLSDIR}/load_generator.o tools/load_generator.cpp
+
+${TOOLSDIR}/request_mix.o: tools/request_mix.cpp 
+	${MKDIR} -p ${TOOLSDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17 -MMD -MP -MF "$@.d" -o ${TOOLSDIR}/request_mix.o tools/request_mix.cpp
+
+${TOOLSDIR}/doip_tester.o: tools/doip_tester.cpp 
+	${MKDIR} -p ${TOOLSDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17 -MMD -MP -MF "$@.d" -o ${TOOLSDIR}/doip_tester.o tools/doip_tester.cpp
+
+${TOOLSDIR}/request_validator: ${TOOLSDIR}/request_validator.o ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${TOOLSDIR}
+	${LINK.cc} -o ${TOOLSDIR}/request_validator $^ ${LDLIBSOPTIONS}
+
+${TOOLSDIR}/request_validator.o: tools/request_validator.cpp 
+	${MKDIR} -p ${TOOLSDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -I/usr/lib/libdoip/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17 -MMD -MP -MF "$@.d" -o ${TOOLSDIR}/request_validator.o tools/request_validator.cpp
+
+# Build Library Targets
+LIBRARYDIR=${CND_BUILDDIR}/${CND_CONF}/${CND_PLATFORM}/lib
+.build-library-conf: .build-conf ${LIBRARYDIR}/libcarsim.a
+
+${LIBRARYDIR}/libcarsim.a: ${OBJECTFILES:%.o=%_nomain.o}
+	${MKDIR} -p ${LIBRARYDIR}
+	${RM} $@
+	${AR} rcs $@ $^
+
+# Run Benchmark Targets
+.benchmark-conf: .build-benchmarks-conf
+	${BENCHMARKDIR}/request_path_benchmark ${BENCHMARK}
+
+.scalability-benchmark-conf: .build-benchmarks-conf
+	${BENCHMARKDIR}/scalability_benchmark ${SCALABILITY}
+
 # Run Test Targets
 .test-conf:
 	@if [ "${TEST}" = "" ]; \
 	then  \
-	    ${TESTDIR}/TestFiles/f3 || true; \
-	    ${TESTDIR}/TestFiles/f4 || true; \
-	    ${TESTDIR}/TestFiles/f5 || true; \
-	    ${TESTDIR}/TestFiles/f6 || true; \
-	    ${TESTDIR}/TestFiles/f1 || true; \
+	    status=0; \
+	    ${TESTDIR}/TestFiles/f1 || status=1; \
+	    ${TESTDIR}/TestFiles/f3 || status=1; \
+	    ${TESTDIR}/TestFiles/f4 || status=1; \
+	    ${TESTDIR}/TestFiles/f5 || status=1; \
+	    ${TESTDIR}/TestFiles/f6 || status=1; \
+	    ${TESTDIR}/TestFiles/f7 || status=1; \
+	    ${TESTDIR}/TestFiles/f8 || status=1; \
+	    ${TESTDIR}/TestFiles/f9 || status=1; \
+	    ${TESTDIR}/TestFiles/f10 || status=1; \
+	    ${TESTDIR}/TestFiles/f11 || status=1; \
+	    ${TESTDIR}/TestFiles/f12 || status=1; \
+	    ${TESTDIR}/TestFiles/f13 || status=1; \
+	    ${TESTDIR}/TestFiles/f14 || status=1; \
+	    ${TESTDIR}/TestFiles/f15 || status=1; \
+	    ${TESTDIR}/TestFiles/f16 || status=1; \
+	    ${TESTDIR}/TestFiles/f17 || status=1; \
+	    ${TESTDIR}/TestFiles/f18 || status=1; \
+	    ${TESTDIR}/TestFiles/f19 || status=1; \
+	    ${TESTDIR}/TestFiles/f20 || status=1; \
+	    ${TESTDIR}/TestFiles/f21 || status=1; \
+	    ${TESTDIR}/TestFiles/f22 || status=1; \
+	    ${TESTDIR}/TestFiles/f23 || status=1; \
+	    ${TESTDIR}/TestFiles/f24 || status=1; \
+	    ${TESTDIR}/TestFiles/f25 || status=1; \
+	    ${TESTDIR}/TestFiles/f26 || status=1; \
+	    ${TESTDIR}/TestFiles/f27 || status=1; \
+	    ${TESTDIR}/TestFiles/f28 || status=1; \
+	    ${TESTDIR}/TestFiles/f29 || status=1; \
+	    ${TESTDIR}/TestFiles/f30 || status=1; \
+	    ${TESTDIR}/TestFiles/f31 || status=1; \
+	    ${TESTDIR}/TestFiles/f32 || status=1; \
+	    ${TESTDIR}/TestFiles/f33 || status=1; \
+	    ${TESTDIR}/TestFiles/f34 || status=1; \
+	    ${TESTDIR}/TestFiles/f35 || status=1; \
+	    ${TESTDIR}/TestFiles/f36 || status=1; \
+	    ${TESTDIR}/TestFiles/f37 || status=1; \
+	    ${TESTDIR}/TestFiles/f38 || status=1; \
+	    ${TESTDIR}/TestFiles/f39 || status=1; \
+	    ${TESTDIR}/TestFiles/f40 || status=1; \
+	    ${TESTDIR}/TestFiles/f41 || status=1; \
+	    ${TESTDIR}/TestFiles/f42 || status=1; \
+	    ${TESTDIR}/TestFiles/f43 || status=1; \
+	    ${TESTDIR}/TestFiles/f44 || status=1; \
+	    ${TESTDIR}/TestFiles/f45 || status=1; \
+	    ${TESTDIR}/TestFiles/f46 || status=1; \
+	    ${TESTDIR}/TestFiles/f47 || status=1; \
+	    ${TESTDIR}/TestFiles/f48 || status=1; \
+	    ${TESTDIR}/TestFiles/f49 || status=1; \
+	    ${TESTDIR}/TestFiles/f50 || status=1; \
+	    ${TESTDIR}/TestFiles/f51 || status=1; \
+	    ${TESTDIR}/TestFiles/f52 || status=1; \
+	    ${TESTDIR}/TestFiles/f53 || status=1; \
+	    ${TESTDIR}/TestFiles/f54 || status=1; \
+	    ${TESTDIR}/TestFiles/f55 || status=1; \
+	    ${TESTDIR}/TestFiles/f56 || status=1; \
+	    exit $$status; \
 	else  \
-	    ./${TEST} || true; \
+	    ./${TEST}; \
 	fi
 
 # Clean Targets
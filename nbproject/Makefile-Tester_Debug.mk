@@ -83,7 +83,7 @@ FFLAGS=
 ASFLAGS=
 
 # Link Libraries and Options
-LDLIBSOPTIONS=`pkg-config --libs lua5.2`  `pkg-config --libs libsocketcan`  -lstdc++fs
+LDLIBSOPTIONS=`pkg-config --libs ${LUA_PACKAGE}` ${LUA_LDFLAGS}  `pkg-config --libs libsocketcan`  -lstdc++fs
 
 # Build Targets
 .build-conf: ${BUILD_SUBPROJECTS}
@@ -96,47 +96,47 @@ ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/amos-ss17-proj4: ${OBJECTFILES}
 ${OBJECTDIR}/src/broadcast_receiver.o: src/broadcast_receiver.cpp
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/broadcast_receiver.o src/broadcast_receiver.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/broadcast_receiver.o src/broadcast_receiver.cpp
 
 ${OBJECTDIR}/src/ecu_lua_script.o: src/ecu_lua_script.cpp
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/ecu_lua_script.o src/ecu_lua_script.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/ecu_lua_script.o src/ecu_lua_script.cpp
 
 ${OBJECTDIR}/src/ecu_timer.o: src/ecu_timer.cpp
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/ecu_timer.o src/ecu_timer.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/ecu_timer.o src/ecu_timer.cpp
 
 ${OBJECTDIR}/src/electronic_control_unit.o: src/electronic_control_unit.cpp
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/electronic_control_unit.o src/electronic_control_unit.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/electronic_control_unit.o src/electronic_control_unit.cpp
 
 ${OBJECTDIR}/src/isotp_receiver.o: src/isotp_receiver.cpp
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/isotp_receiver.o src/isotp_receiver.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/isotp_receiver.o src/isotp_receiver.cpp
 
 ${OBJECTDIR}/src/isotp_sender.o: src/isotp_sender.cpp
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/isotp_sender.o src/isotp_sender.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/isotp_sender.o src/isotp_sender.cpp
 
 ${OBJECTDIR}/src/session_controller.o: src/session_controller.cpp
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/session_controller.o src/session_controller.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/session_controller.o src/session_controller.cpp
 
 ${OBJECTDIR}/src/uds_receiver.o: src/uds_receiver.cpp
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/uds_receiver.o src/uds_receiver.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/uds_receiver.o src/uds_receiver.cpp
 
 ${OBJECTDIR}/src/utilities.o: src/utilities.cpp
 	${MKDIR} -p ${OBJECTDIR}/src
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/utilities.o src/utilities.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/utilities.o src/utilities.cpp
 
 # Subprojects
 .build-subprojects:
@@ -169,61 +169,61 @@ ${TESTDIR}/TestFiles/f1: ${TESTDIR}/tests/utils_test.o ${TESTDIR}/tests/utils_te
 ${TESTDIR}/tests/ecu_lua_script_test.o: tests/ecu_lua_script_test.cpp 
 	${MKDIR} -p ${TESTDIR}/tests
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -Isrc `pkg-config --cflags lua5.2` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/ecu_lua_script_test.o tests/ecu_lua_script_test.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/ecu_lua_script_test.o tests/ecu_lua_script_test.cpp
 
 
 ${TESTDIR}/tests/ecu_lua_script_test_runner.o: tests/ecu_lua_script_test_runner.cpp 
 	${MKDIR} -p ${TESTDIR}/tests
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -Isrc `pkg-config --cflags lua5.2` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/ecu_lua_script_test_runner.o tests/ecu_lua_script_test_runner.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/ecu_lua_script_test_runner.o tests/ecu_lua_script_test_runner.cpp
 
 
 ${TESTDIR}/tests/electronic_control_unit_test.o: tests/electronic_control_unit_test.cpp 
 	${MKDIR} -p ${TESTDIR}/tests
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -Isrc `pkg-config --cflags lua5.2` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/electronic_control_unit_test.o tests/electronic_control_unit_test.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/electronic_control_unit_test.o tests/electronic_control_unit_test.cpp
 
 
 ${TESTDIR}/tests/electronic_control_unit_test_runner.o: tests/electronic_control_unit_test_runner.cpp 
 	${MKDIR} -p ${TESTDIR}/tests
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -Isrc `pkg-config --cflags lua5.2` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/electronic_control_unit_test_runner.o tests/electronic_control_unit_test_runner.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/electronic_control_unit_test_runner.o tests/electronic_control_unit_test_runner.cpp
 
 
 ${TESTDIR}/tests/isotp_sender_test.o: tests/isotp_sender_test.cpp 
 	${MKDIR} -p ${TESTDIR}/tests
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -Isrc `pkg-config --cflags lua5.2` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/isotp_sender_test.o tests/isotp_sender_test.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/isotp_sender_test.o tests/isotp_sender_test.cpp
 
 
 ${TESTDIR}/tests/isotp_sender_test_runner.o: tests/isotp_sender_test_runner.cpp 
 	${MKDIR} -p ${TESTDIR}/tests
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -Isrc `pkg-config --cflags lua5.2` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/isotp_sender_test_runner.o tests/isotp_sender_test_runner.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/isotp_sender_test_runner.o tests/isotp_sender_test_runner.cpp
 
 
 ${TESTDIR}/tests/uds_receiver_test.o: tests/uds_receiver_test.cpp 
 	${MKDIR} -p ${TESTDIR}/tests
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -Isrc `pkg-config --cflags lua5.2` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/uds_receiver_test.o tests/uds_receiver_test.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/uds_receiver_test.o tests/uds_receiver_test.cpp
 
 
 ${TESTDIR}/tests/uds_receiver_test_runner.o: tests/uds_receiver_test_runner.cpp 
 	${MKDIR} -p ${TESTDIR}/tests
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -Isrc `pkg-config --cflags lua5.2` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/uds_receiver_test_runner.o tests/uds_receiver_test_runner.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/uds_receiver_test_runner.o tests/uds_receiver_test_runner.cpp
 
 
 ${TESTDIR}/tests/utils_test.o: tests/utils_test.cpp 
 	${MKDIR} -p ${TESTDIR}/tests
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -Isrc `pkg-config --cflags lua5.2` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/utils_test.o tests/utils_test.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/utils_test.o tests/utils_test.cpp
 
 
 ${TESTDIR}/tests/utils_test_runner.o: tests/utils_test_runner.cpp 
 	${MKDIR} -p ${TESTDIR}/tests
 	${RM} "$@.d"
-	$(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include -Isrc `pkg-config --cflags lua5.2` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/utils_test_runner.o tests/utils_test_runner.cpp
+	$(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include -Isrc `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17 `cppunit-config --cflags` -MMD -MP -MF "$@.d" -o ${TESTDIR}/tests/utils_test_runner.o tests/utils_test_runner.cpp
 
 
 ${OBJECTDIR}/src/broadcast_receiver_nomain.o: ${OBJECTDIR}/src/broadcast_receiver.o src/broadcast_receiver.cpp 
@@ -234,7 +234,7 @@ ${OBJECTDIR}/src/broadcast_receiver_nomain.o: ${OBJECTDIR}/src/broadcast_receive
 	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
 	then  \
 	    ${RM} "$@.d";\
-	    $(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/broadcast_receiver_nomain.o src/broadcast_receiver.cpp;\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/broadcast_receiver_nomain.o src/broadcast_receiver.cpp;\
 	else  \
 	    ${CP} ${OBJECTDIR}/src/broadcast_receiver.o ${OBJECTDIR}/src/broadcast_receiver_nomain.o;\
 	fi
@@ -247,7 +247,7 @@ ${OBJECTDIR}/src/ecu_lua_script_nomain.o: ${OBJECTDIR}/src/ecu_lua_script.o src/
 	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
 	then  \
 	    ${RM} "$@.d";\
-	    $(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/ecu_lua_script_nomain.o src/ecu_lua_script.cpp;\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/ecu_lua_script_nomain.o src/ecu_lua_script.cpp;\
 	else  \
 	    ${CP} ${OBJECTDIR}/src/ecu_lua_script.o ${OBJECTDIR}/src/ecu_lua_script_nomain.o;\
 	fi
@@ -260,7 +260,7 @@ ${OBJECTDIR}/src/ecu_timer_nomain.o: ${OBJECTDIR}/src/ecu_timer.o src/ecu_timer.
 	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
 	then  \
 	    ${RM} "$@.d";\
-	    $(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/ecu_timer_nomain.o src/ecu_timer.cpp;\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/ecu_timer_nomain.o src/ecu_timer.cpp;\
 	else  \
 	    ${CP} ${OBJECTDIR}/src/ecu_timer.o ${OBJECTDIR}/src/ecu_timer_nomain.o;\
 	fi
@@ -273,7 +273,7 @@ ${OBJECTDIR}/src/electronic_control_unit_nomain.o: ${OBJECTDIR}/src/electronic_c
 	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
 	then  \
 	    ${RM} "$@.d";\
-	    $(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/electronic_control_unit_nomain.o src/electronic_control_unit.cpp;\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/electronic_control_unit_nomain.o src/electronic_control_unit.cpp;\
 	else  \
 	    ${CP} ${OBJECTDIR}/src/electronic_control_unit.o ${OBJECTDIR}/src/electronic_control_unit_nomain.o;\
 	fi
@@ -286,7 +286,7 @@ ${OBJECTDIR}/src/isotp_receiver_nomain.o: ${OBJECTDIR}/src/isotp_receiver.o src/
 	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
 	then  \
 	    ${RM} "$@.d";\
-	    $(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/isotp_receiver_nomain.o src/isotp_receiver.cpp;\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/isotp_receiver_nomain.o src/isotp_receiver.cpp;\
 	else  \
 	    ${CP} ${OBJECTDIR}/src/isotp_receiver.o ${OBJECTDIR}/src/isotp_receiver_nomain.o;\
 	fi
@@ -299,7 +299,7 @@ ${OBJECTDIR}/src/isotp_sender_nomain.o: ${OBJECTDIR}/src/isotp_sender.o src/isot
 	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
 	then  \
 	    ${RM} "$@.d";\
-	    $(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/isotp_sender_nomain.o src/isotp_sender.cpp;\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/isotp_sender_nomain.o src/isotp_sender.cpp;\
 	else  \
 	    ${CP} ${OBJECTDIR}/src/isotp_sender.o ${OBJECTDIR}/src/isotp_sender_nomain.o;\
 	fi
@@ -312,7 +312,7 @@ ${OBJECTDIR}/src/session_controller_nomain.o: ${OBJECTDIR}/src/session_controlle
 	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
 	then  \
 	    ${RM} "$@.d";\
-	    $(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/session_controller_nomain.o src/session_controller.cpp;\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/session_controller_nomain.o src/session_controller.cpp;\
 	else  \
 	    ${CP} ${OBJECTDIR}/src/session_controller.o ${OBJECTDIR}/src/session_controller_nomain.o;\
 	fi
@@ -325,7 +325,7 @@ ${OBJECTDIR}/src/uds_receiver_nomain.o: ${OBJECTDIR}/src/uds_receiver.o src/uds_
 	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
 	then  \
 	    ${RM} "$@.d";\
-	    $(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/uds_receiver_nomain.o src/uds_receiver.cpp;\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/uds_receiver_nomain.o src/uds_receiver.cpp;\
 	else  \
 	    ${CP} ${OBJECTDIR}/src/uds_receiver.o ${OBJECTDIR}/src/uds_receiver_nomain.o;\
 	fi
@@ -338,7 +338,7 @@ ${OBJECTDIR}/src/utilities_nomain.o: ${OBJECTDIR}/src/utilities.o src/utilities.
 	   (echo "$$NMOUTPUT" | ${GREP} 'T _main$$'); \
 	then  \
 	    ${RM} "$@.d";\
-	    $(COMPILE.cc) -g -Wall -I/usr/include/lua5.2 -ISelene/include `pkg-config --cflags lua5.2` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/utilities_nomain.o src/utilities.cpp;\
+	    $(COMPILE.cc) -g -Wall ${LUA_CFLAGS} -ISelene/include `pkg-config --cflags ${LUA_PACKAGE}` -std=c++17  -Dmain=__nomain -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/src/utilities_nomain.o src/utilities.cpp;\
 	else  \
 	    ${CP} ${OBJECTDIR}/src/utilities.o ${OBJECTDIR}/src/utilities_nomain.o;\
 	fi
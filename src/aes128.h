@@ -0,0 +1,34 @@
+/**
+ * @file aes128.h
+ *
+ */
+
+#ifndef AES128_H
+#define AES128_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * AES-128 block encryption (FIPS-197), e.g. for the key algorithm of
+ * `SecurityAccess`. The key schedule is expanded once per key, only the
+ * encryption direction is implemented.
+ */
+class Aes128
+{
+public:
+    static constexpr std::size_t BLOCK_SIZE = 16;
+    static constexpr std::size_t KEY_SIZE = 16;
+
+    explicit Aes128(const std::uint8_t* key) noexcept;
+
+    void encryptBlock(const std::uint8_t* input, std::uint8_t* output) const noexcept;
+
+private:
+    static constexpr std::size_t ROUNDS = 10;
+
+    std::array<std::uint8_t, BLOCK_SIZE * (ROUNDS + 1)> roundKeys_;
+};
+
+#endif /* AES128_H */
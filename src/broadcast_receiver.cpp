@@ -7,47 +7,182 @@
 
 #include "broadcast_receiver.h"
 #include "service_identifier.h"
+#include <algorithm>
+#include <array>
 #include <iostream>
+#include <sys/epoll.h>
 
 using namespace std;
 
+mutex BroadcastReceiver::registryMutex_;
+map<BroadcastReceiver::Key, shared_ptr<BroadcastReceiver>> BroadcastReceiver::registry_;
+
+/**
+ * Attaches the given UDS receiver to the broadcast receiver of the given
+ * device and broadcast ID. The broadcast receiver is created and started if
+ * it is the first one on this address.
+ *
+ * @param source: the broadcast CAN address (e.g. 0x7DF)
+ * @param device: the CAN device (e.g. "vcan0")
+ * @param pUdsRec: the UDS receiver of the ECU
+ * @param pReactor: the reactor to register the socket with or `nullptr` to
+ *                  start a dedicated thread
+ * @return the shared broadcast receiver
+ * @see BroadcastReceiver::detach()
+ */
+shared_ptr<BroadcastReceiver> BroadcastReceiver::attach(canid_t source,
+                                                        const string& device,
+                                                        UdsReceiver* pUdsRec,
+                                                        ReceiverReactor* pReactor)
+{
+    lock_guard<mutex> lock(registryMutex_);
+    shared_ptr<BroadcastReceiver>& pReceiver = registry_[Key(device, source)];
+    if (!pReceiver)
+    {
+        try
+        {
+            pReceiver = make_shared<BroadcastReceiver>(source, device, pReactor);
+            pReceiver->start();
+        }
+        catch (...)
+        {
+            registry_.erase(Key(device, source));
+            throw;
+        }
+    }
+
+    lock_guard<mutex> receiversLock(pReceiver->udsReceiversMutex_);
+    pReceiver->udsReceivers_.push_back(pUdsRec);
+    return pReceiver;
+}
+
+/**
+ * Detaches the given UDS receiver. The broadcast receiver is stopped and its
+ * socket closed when the last UDS receiver is detached.
+ *
+ * @param pReceiver: the broadcast receiver returned by `attach()`
+ * @param pUdsRec: the UDS receiver of the ECU
+ * @see BroadcastReceiver::attach()
+ */
+void BroadcastReceiver::detach(const shared_ptr<BroadcastReceiver>& pReceiver,
+                               UdsReceiver* pUdsRec)
+{
+    if (!pReceiver)
+    {
+        return;
+    }
+
+    lock_guard<mutex> lock(registryMutex_);
+    {
+        lock_guard<mutex> receiversLock(pReceiver->udsReceiversMutex_);
+        auto& receivers = pReceiver->udsReceivers_;
+        receivers.erase(remove(receivers.begin(), receivers.end(), pUdsRec), receivers.end());
+        if (!receivers.empty())
+        {
+            return;
+        }
+    }
+
+    pReceiver->stop();
+    auto iter = registry_.find(pReceiver->key_);
+    if (iter != registry_.end() && iter->second == pReceiver)
+    {
+        registry_.erase(iter);
+    }
+}
+
+/**
+ * Constructor. Opens the receiver socket. Use `attach()` instead, which shares
+ * the receiver between all ECUs on the same address.
+ */
 BroadcastReceiver::BroadcastReceiver(canid_t source,
                                      const string& device,
-                                     UdsReceiver* pUdsRec)
+                                     ReceiverReactor* pReactor)
 : IsoTpReceiver(BROADCAST_ADDR, source, device)
-, pUdsReceiver_(pUdsRec)
+, key_(device, source)
+, pReactor_(pReactor)
+{
+}
+
+void BroadcastReceiver::start()
+{
+    if (pReactor_)
+    {
+        if (pReactor_->addHandler(this, EPOLLIN) != 0)
+        {
+            closeReceiver();
+            throw exception();
+        }
+    }
+    else
+    {
+        receiverThread_ = thread(&IsoTpReceiver::readData, this);
+    }
+}
+
+void BroadcastReceiver::stop()
 {
+    if (pReactor_)
+    {
+        // the workers must not use the socket while it is closed
+        pReactor_->removeHandler(this);
+    }
+    stopReceiver();
+    if (receiverThread_.joinable())
+    {
+        receiverThread_.join();
+    }
+    closeReceiver();
 }
 
 /**
- * Handles the broadcast messages (e.g. `TesterPresent`).
+ * Dispatches the received broadcast message to all attached ECUs.
  * 
  * @param buffer: the buffer of the UDS message
  * @param num_bytes: the number of transmitted data in bytes
  */
 void BroadcastReceiver::proceedReceivedData(const uint8_t* buffer,
                                             const size_t num_bytes) noexcept
+{
+    lock_guard<mutex> lock(udsReceiversMutex_);
+    for (UdsReceiver* pUdsReceiver : udsReceivers_)
+    {
+        proceedReceivedData(pUdsReceiver, buffer, num_bytes);
+    }
+}
+
+/**
+ * Handles the broadcast messages (e.g. `TesterPresent`) for one ECU.
+ * `TesterPresent` is answered directly, without calling into Lua.
+ * 
+ * @param pUdsReceiver: the UDS receiver of the ECU
+ * @param buffer: the buffer of the UDS message
+ * @param num_bytes: the number of transmitted data in bytes
+ */
+void BroadcastReceiver::proceedReceivedData(UdsReceiver* pUdsReceiver,
+                                            const uint8_t* buffer,
+                                            const size_t num_bytes) noexcept
 {
     switch (buffer[0])
     {
         case TESTER_PRESENT_REQ:
         {
-            if(buffer[1] == 0x80 && num_bytes >= 2)
+            if(isSuppressPosRsp(buffer, num_bytes))
             {
-                pUdsReceiver_->pSessionCtrl_->reset();
+                pUdsReceiver->pSessionCtrl_->reset();
             }
             else
             {
                 // -> beware of arrows ->
-                pUdsReceiver_->pSessionCtrl_->reset();
+                pUdsReceiver->pSessionCtrl_->reset();
                 constexpr array<uint8_t, 1> tp = {TESTER_PRESENT_RES};
-                pUdsReceiver_->pIsoTpSender_->sendData(tp.data(), tp.size());
+                pUdsReceiver->pTransport_->sendData(tp.data(), tp.size());
             }
             break;
         }
         default:
         {
-            pUdsReceiver_->proceedReceivedData(buffer, num_bytes);
+            pUdsReceiver->proceedReceivedData(buffer, num_bytes);
         }
     }
 }
@@ -9,30 +9,66 @@
 #include "isotp_receiver.h"
 #include "uds_receiver.h"
 #include "session_controller.h"
+#include "receiver_reactor.h"
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 /// CAN address for broadcast messages like `TesterPresent`
 static constexpr canid_t BROADCAST_ADDR = 0x000;
 
+/**
+ * Receiver for functionally addressed requests (e.g. `TesterPresent` or an
+ * OBD scan on 0x7DF).
+ *
+ * Only one socket is opened per CAN device and broadcast ID. All ECUs that
+ * listen on the same address are attached to it and each received request is
+ * dispatched to all of them in-process, instead of letting the kernel copy
+ * it to one socket (and thread) per ECU.
+ */
 class BroadcastReceiver : public IsoTpReceiver
 {
 public:
+    static std::shared_ptr<BroadcastReceiver> attach(canid_t source,
+                                                     const std::string& device,
+                                                     UdsReceiver* pUdsRec,
+                                                     ReceiverReactor* pReactor);
+    static void detach(const std::shared_ptr<BroadcastReceiver>& pReceiver,
+                       UdsReceiver* pUdsRec);
 
+public:
     BroadcastReceiver() = delete;
     BroadcastReceiver(canid_t source,
                       const std::string& device,
-                      UdsReceiver* udsRec);
-    BroadcastReceiver(const BroadcastReceiver& orig) = default;
-    BroadcastReceiver& operator =(const BroadcastReceiver& orig) = default;
-    BroadcastReceiver(BroadcastReceiver&& orig) = default;
-    BroadcastReceiver& operator =(BroadcastReceiver&& orig) = default;
+                      ReceiverReactor* pReactor);
+    BroadcastReceiver(const BroadcastReceiver& orig) = delete;
+    BroadcastReceiver& operator =(const BroadcastReceiver& orig) = delete;
     virtual ~BroadcastReceiver() = default;
 
     virtual void proceedReceivedData(const std::uint8_t* buffer,
                                      const std::size_t num_bytes) noexcept override;
 
 private:
-    UdsReceiver* pUdsReceiver_;
+    using Key = std::pair<std::string, canid_t>; ///< (device, broadcast ID)
+
+    static std::mutex registryMutex_;
+    static std::map<Key, std::shared_ptr<BroadcastReceiver>> registry_;
+
+    Key key_;
+    ReceiverReactor* pReactor_;
+    std::thread receiverThread_;
+    std::mutex udsReceiversMutex_;
+    std::vector<UdsReceiver*> udsReceivers_;
+
+    void start();
+    void stop();
+    void proceedReceivedData(UdsReceiver* pUdsReceiver,
+                             const std::uint8_t* buffer,
+                             const std::size_t num_bytes) noexcept;
 
 };
 
@@ -0,0 +1,66 @@
+/**
+ * @file buffer_pool.cpp
+ *
+ */
+
+#include "buffer_pool.h"
+
+using namespace std;
+
+/**
+ * Constructor. The buffers are allocated on demand.
+ *
+ * @param bufferSize: the size of each buffer in bytes
+ * @param maxFreeBuffers: the max. number of released buffers kept for reuse
+ */
+BufferPool::BufferPool(size_t bufferSize, size_t maxFreeBuffers)
+: bufferSize_(bufferSize)
+, maxFreeBuffers_(maxFreeBuffers)
+{
+    freeBuffers_.reserve(maxFreeBuffers);
+}
+
+/**
+ * @return a released buffer or a new one, if there is none. The content is
+ *         not initialized.
+ */
+BufferPool::Buffer BufferPool::acquire()
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        if (!freeBuffers_.empty())
+        {
+            Buffer buffer = move(freeBuffers_.back());
+            freeBuffers_.pop_back();
+            return buffer;
+        }
+    }
+    return Buffer(new uint8_t[bufferSize_]);
+}
+
+/**
+ * Returns a buffer of `acquire()` to the pool.
+ *
+ * @param buffer: the buffer, freed if the pool is full
+ */
+void BufferPool::release(Buffer buffer) noexcept
+{
+    if (!buffer)
+    {
+        return;
+    }
+    lock_guard<mutex> lock(mutex_);
+    if (freeBuffers_.size() < maxFreeBuffers_)
+    {
+        freeBuffers_.push_back(move(buffer));
+    }
+}
+
+/**
+ * @return the number of buffers kept for reuse
+ */
+size_t BufferPool::getFreeBufferCount() const noexcept
+{
+    lock_guard<mutex> lock(mutex_);
+    return freeBuffers_.size();
+}
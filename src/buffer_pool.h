@@ -0,0 +1,43 @@
+/**
+ * @file buffer_pool.h
+ *
+ */
+
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * Pool of equally sized buffers, e.g. the receive buffers of the DoIP
+ * connections. A released buffer is kept for the next `acquire()`, so
+ * connecting and disconnecting testers does not allocate each time. At most
+ * `maxFreeBuffers` buffers are kept, the others are freed.
+ */
+class BufferPool
+{
+public:
+    using Buffer = std::unique_ptr<std::uint8_t[]>;
+
+    BufferPool(std::size_t bufferSize, std::size_t maxFreeBuffers);
+    BufferPool(const BufferPool& orig) = delete;
+    BufferPool& operator =(const BufferPool& orig) = delete;
+    virtual ~BufferPool() = default;
+
+    Buffer acquire();
+    void release(Buffer buffer) noexcept;
+    std::size_t getBufferSize() const noexcept { return bufferSize_; }
+    std::size_t getFreeBufferCount() const noexcept;
+
+private:
+    const std::size_t bufferSize_;
+    const std::size_t maxFreeBuffers_;
+    mutable std::mutex mutex_;
+    std::vector<Buffer> freeBuffers_;
+};
+
+#endif /* BUFFER_POOL_H */
@@ -0,0 +1,212 @@
+/**
+ * @file bus_load_budget.cpp
+ *
+ * The bus load estimate and the token bucket of a CAN interface, see
+ * `BusLoadBudget`.
+ */
+
+#include "bus_load_budget.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+/// the time covered by `BusLoadBudget::getLoad()`
+static constexpr uint64_t LOAD_WINDOW_NS = 100000000;
+/// the burst the token bucket allows, in time of the max. load
+static constexpr uint64_t BUCKET_NS = 10000000;
+/// the nominal bits of a frame besides the data: 11 bit ID
+static constexpr size_t STANDARD_FRAME_OVERHEAD_BITS = 47;
+/// the nominal bits of a frame besides the data: 29 bit ID
+static constexpr size_t EXTENDED_FRAME_OVERHEAD_BITS = 67;
+
+/**
+ * @param rate: the bits per second of the max. load
+ * @return the size of the token bucket in bits, at least one frame
+ */
+static double getCapacity(double rate) noexcept
+{
+    return max(rate * BUCKET_NS / 1e9, double(BusLoadBudget::getFrameBits(CAN_EFF_FLAG, CANFD_MAX_DLEN)));
+}
+
+atomic<uint32_t> BusLoadBudget::bitRate_{DEFAULT_BUS_BIT_RATE};
+atomic<double> BusLoadBudget::maxLoad_{0};
+mutex BusLoadBudget::registryMutex_;
+map<string, weak_ptr<BusLoadBudget>> BusLoadBudget::registry_;
+
+/**
+ * @param device: the CAN interface (e.g. "can0")
+ * @return the budget of the given interface, which is shared by all senders
+ */
+shared_ptr<BusLoadBudget> BusLoadBudget::getInstance(const string& device)
+{
+    lock_guard<mutex> lock(registryMutex_);
+    shared_ptr<BusLoadBudget> pBudget = registry_[device].lock();
+    if (!pBudget)
+    {
+        pBudget = make_shared<BusLoadBudget>();
+        registry_[device] = pBudget;
+    }
+    return pBudget;
+}
+
+/**
+ * Sets the bit rate and the max. load of all CAN interfaces, before the
+ * simulations are started.
+ *
+ * @param bitRate: the nominal bit rate in bit/s
+ * @param maxLoad: the share of the bit rate the bulk transmissions may use
+ *                 (0..1), 0 = no pacing
+ */
+void BusLoadBudget::configure(uint32_t bitRate, double maxLoad) noexcept
+{
+    bitRate_ = bitRate > 0 ? bitRate : DEFAULT_BUS_BIT_RATE;
+    maxLoad_ = min(max(maxLoad, 0.0), 1.0);
+}
+
+/**
+ * @return the nominal bit rate of the CAN interfaces in bit/s
+ */
+uint32_t BusLoadBudget::getBitRate() noexcept
+{
+    return bitRate_;
+}
+
+/**
+ * @return the max. bus load of the bulk transmissions, 0 = no pacing
+ */
+double BusLoadBudget::getMaxLoad() noexcept
+{
+    return maxLoad_;
+}
+
+/**
+ * @param canId: the CAN ID incl. `CAN_EFF_FLAG`
+ * @param length: the data length of the frame
+ * @return the nominal length of the frame on the bus in bits, without stuff
+ *         bits and at the nominal bit rate
+ */
+size_t BusLoadBudget::getFrameBits(canid_t canId, size_t length) noexcept
+{
+    return ((canId & CAN_EFF_FLAG) ? EXTENDED_FRAME_OVERHEAD_BITS : STANDARD_FRAME_OVERHEAD_BITS) + 8 * length;
+}
+
+/**
+ * @return the current `CLOCK_MONOTONIC` time in nanoseconds
+ */
+uint64_t BusLoadBudget::getNowNs() noexcept
+{
+    return uint64_t(chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/**
+ * Calls a function for the budgets of all interfaces in use, e.g. for the
+ * metrics.
+ *
+ * @param function: called with the interface and its budget
+ */
+void BusLoadBudget::forEach(const function<void(const string&, BusLoadBudget&)>& function)
+{
+    lock_guard<mutex> lock(registryMutex_);
+    for (const auto& entry : registry_)
+    {
+        const shared_ptr<BusLoadBudget> pBudget = entry.second.lock();
+        if (pBudget)
+        {
+            function(entry.first, *pBudget);
+        }
+    }
+}
+
+/**
+ * Constructor. The token bucket starts full. Use `getInstance()` instead,
+ * which shares the budget between all senders on the interface.
+ *
+ * @param nowNs: the current time
+ */
+BusLoadBudget::BusLoadBudget(uint64_t nowNs) noexcept
+: tokens_(numeric_limits<double>::max())
+, refilledAtNs_(nowNs)
+, windowStartNs_(nowNs)
+{
+}
+
+/**
+ * Counts a frame which is sent regardless of the budget and takes its
+ * tokens. The bucket may get into debt by at most its size, which delays
+ * the bulk transmissions.
+ *
+ * @param bits: the length of the frame, see `getFrameBits()`
+ * @param nowNs: the current time
+ */
+void BusLoadBudget::consume(size_t bits, uint64_t nowNs) noexcept
+{
+    lock_guard<mutex> lock(mutex_);
+    update(nowNs);
+    windowBits_ += bits;
+    const double rate = bitRate_ * maxLoad_.load();
+    if (rate > 0)
+    {
+        tokens_ = max(tokens_ - double(bits), -getCapacity(rate));
+    }
+}
+
+/**
+ * Returns the time a bulk frame has to wait for its tokens. A frame sent
+ * right away is counted with `consume()` like any other frame.
+ *
+ * @param bits: the length of the frame, see `getFrameBits()`
+ * @param nowNs: the current time
+ * @return 0 if the frame may be sent now, otherwise the nanoseconds until
+ *         the bucket holds its tokens
+ */
+uint64_t BusLoadBudget::getDelayNs(size_t bits, uint64_t nowNs) noexcept
+{
+    lock_guard<mutex> lock(mutex_);
+    update(nowNs);
+    const double rate = bitRate_ * maxLoad_.load();
+    if (rate <= 0 || tokens_ >= double(bits))
+    {
+        return 0;
+    }
+    deferredFrames_.fetch_add(1, memory_order_relaxed);
+    return max(uint64_t(ceil((double(bits) - tokens_) * 1e9 / rate)), uint64_t(1));
+}
+
+/**
+ * @param nowNs: the current time
+ * @return the estimated bus load of the simulator (0..1) over the last
+ *         complete window of 100 ms or the time since it
+ */
+double BusLoadBudget::getLoad(uint64_t nowNs) noexcept
+{
+    lock_guard<mutex> lock(mutex_);
+    update(nowNs);
+    return load_;
+}
+
+/**
+ * Refills the token bucket and closes the load window if it is complete.
+ * The lock must be held.
+ */
+void BusLoadBudget::update(uint64_t nowNs) noexcept
+{
+    const uint64_t elapsedNs = nowNs > refilledAtNs_ ? nowNs - refilledAtNs_ : 0;
+    const double rate = bitRate_ * maxLoad_.load();
+    if (rate > 0)
+    {
+        tokens_ = min(tokens_ + rate * elapsedNs / 1e9, getCapacity(rate));
+    }
+    refilledAtNs_ = max(refilledAtNs_, nowNs);
+
+    const uint64_t windowNs = nowNs > windowStartNs_ ? nowNs - windowStartNs_ : 0;
+    if (windowNs >= LOAD_WINDOW_NS)
+    {
+        load_ = min(double(windowBits_) * 1e9 / (double(bitRate_) * windowNs), 1.0);
+        windowBits_ = 0;
+        windowStartNs_ = nowNs;
+    }
+}
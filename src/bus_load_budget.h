@@ -0,0 +1,76 @@
+/**
+ * @file bus_load_budget.h
+ *
+ */
+
+#ifndef BUS_LOAD_BUDGET_H
+#define BUS_LOAD_BUDGET_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <linux/can.h>
+
+/// the bit rate of the CAN interfaces if none is configured
+constexpr std::uint32_t DEFAULT_BUS_BIT_RATE = 500000;
+
+/**
+ * The bus load budget of a CAN interface, shared by everything the
+ * simulator sends on it: the cyclic PGNs of the `J1939CyclicScheduler`, the
+ * frames of the `IsoTpEngine` and the responses of the `CanFrameBus`.
+ *
+ * Every frame sent is counted with its nominal length on the bus (without
+ * stuff bits), which gives the estimated bus load over the last 100 ms (see
+ * `getLoad()`). With a max. bus load (see `configure()`), the budget is
+ * also a token bucket filled with the max. load of the bit rate and holding
+ * 10 ms of it: bulk transmissions like the consecutive frames of long UDS
+ * responses ask for a delay before each frame (`getDelayNs()`) and are
+ * spread over time instead of flooding the TX queue of the interface, while
+ * the cyclic and single frames are always sent and only take their tokens.
+ *
+ * The times are `CLOCK_MONOTONIC` nanoseconds, see `getNowNs()`.
+ */
+class BusLoadBudget
+{
+public:
+    static std::shared_ptr<BusLoadBudget> getInstance(const std::string& device);
+    static void configure(std::uint32_t bitRate, double maxLoad) noexcept;
+    static std::uint32_t getBitRate() noexcept;
+    static double getMaxLoad() noexcept;
+    static std::size_t getFrameBits(canid_t canId, std::size_t length) noexcept;
+    static std::uint64_t getNowNs() noexcept;
+    static void forEach(const std::function<void(const std::string&, BusLoadBudget&)>& function);
+
+    explicit BusLoadBudget(std::uint64_t nowNs = getNowNs()) noexcept;
+    BusLoadBudget(const BusLoadBudget& orig) = delete;
+    BusLoadBudget& operator =(const BusLoadBudget& orig) = delete;
+    virtual ~BusLoadBudget() = default;
+
+    void consume(std::size_t bits, std::uint64_t nowNs) noexcept;
+    std::uint64_t getDelayNs(std::size_t bits, std::uint64_t nowNs) noexcept;
+    double getLoad(std::uint64_t nowNs) noexcept;
+    std::uint64_t getDeferredFrames() const noexcept { return deferredFrames_.load(std::memory_order_relaxed); }
+
+private:
+    static std::atomic<std::uint32_t> bitRate_;
+    static std::atomic<double> maxLoad_;
+    static std::mutex registryMutex_;
+    static std::map<std::string, std::weak_ptr<BusLoadBudget>> registry_;
+
+    std::mutex mutex_;
+    double tokens_ = 0; ///< in bits, negative after the cyclic frames exceeded the budget
+    std::uint64_t refilledAtNs_;
+    std::uint64_t windowStartNs_; ///< start of the current load window
+    std::uint64_t windowBits_ = 0; ///< the bits sent in the current load window
+    double load_ = 0; ///< the load of the last complete window
+    std::atomic<std::uint64_t> deferredFrames_{0};
+
+    void update(std::uint64_t nowNs) noexcept;
+};
+
+#endif /* BUS_LOAD_BUDGET_H */
@@ -0,0 +1,285 @@
+/**
+ * @file bus_state_monitor.cpp
+ *
+ * This file contains the monitor of the CAN bus state of an interface.
+ */
+
+#include "bus_state_monitor.h"
+#include "idle_monitor.h"
+#include "logger.h"
+#include "thread_placement.h"
+#include <libsocketcan.h>
+#include <linux/can.h>
+#include <linux/can/error.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+constexpr int STATE_UNKNOWN = -1;
+constexpr int STATE_POLL_INTERVAL_MS = 1000; ///< fallback if there are no error frames
+
+mutex BusStateMonitor::registryMutex_;
+map<string, weak_ptr<BusStateMonitor>> BusStateMonitor::registry_;
+atomic<bool> BusStateMonitor::isRecoveryEnabled_{false};
+
+/**
+ * @param device: the CAN interface (e.g. "can0")
+ * @return the monitor of the given interface, which is shared by all users
+ */
+shared_ptr<BusStateMonitor> BusStateMonitor::getInstance(const string& device)
+{
+    lock_guard<mutex> lock(registryMutex_);
+    shared_ptr<BusStateMonitor> pMonitor = registry_[device].lock();
+    if (!pMonitor)
+    {
+        pMonitor = make_shared<BusStateMonitor>(device);
+        registry_[device] = pMonitor;
+    }
+    return pMonitor;
+}
+
+/**
+ * Enables or disables the restart of interfaces in ERROR-PASSIVE state for
+ * all monitors. Disabled on default.
+ */
+void BusStateMonitor::setRecoveryEnabled(bool isEnabled) noexcept
+{
+    isRecoveryEnabled_ = isEnabled;
+}
+
+/**
+ * Constructor. Queries the current state and starts monitoring.
+ *
+ * @param device: the CAN interface (e.g. "can0")
+ */
+BusStateMonitor::BusStateMonitor(const string& device)
+: device_(device)
+, state_(STATE_UNKNOWN)
+{
+    stop_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    wakeup_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (stop_fd_ < 0 || wakeup_fd_ < 0)
+    {
+        LOG_ERROR(__func__ << "() eventfd: " << strerror(errno));
+        if (stop_fd_ >= 0)
+        {
+            close(stop_fd_);
+        }
+        throw exception();
+    }
+    // without error frames, the state is still polled
+    if (openErrorSocket() != 0)
+    {
+        LOG_WARNING("No CAN error frames on " << device_ << ", polling the bus state only");
+    }
+
+    updateState();
+    idleListenerId_ = IdleMonitor::getInstance().addListener([this](bool)
+    {
+        const uint64_t value = 1;
+        if (write(wakeup_fd_, &value, sizeof(value)) < 0)
+        {
+            LOG_ERROR("BusStateMonitor write: " << strerror(errno));
+        }
+    });
+    thread_ = thread(&BusStateMonitor::run, this);
+}
+
+/**
+ * Destructor. Stops monitoring.
+ */
+BusStateMonitor::~BusStateMonitor()
+{
+    IdleMonitor::getInstance().removeListener(idleListenerId_);
+    const uint64_t value = 1;
+    if (write(stop_fd_, &value, sizeof(value)) < 0)
+    {
+        LOG_ERROR(__func__ << "() write: " << strerror(errno));
+    }
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+    if (error_skt_ >= 0)
+    {
+        close(error_skt_);
+    }
+    close(stop_fd_);
+    close(wakeup_fd_);
+}
+
+/**
+ * @return the last known state of the interface (one of `CAN_STATE_*` or -1
+ *         if it could not be determined)
+ */
+int BusStateMonitor::getState() const noexcept
+{
+    return state_;
+}
+
+/**
+ * @return true if the interface is able to send (ERROR-ACTIVE or
+ *         ERROR-WARNING)
+ */
+bool BusStateMonitor::isBusActive() const noexcept
+{
+    const int state = state_;
+    return state == CAN_STATE_ERROR_ACTIVE || state == CAN_STATE_ERROR_WARNING;
+}
+
+int BusStateMonitor::openErrorSocket() noexcept
+{
+    int skt = socket(PF_CAN, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, CAN_RAW);
+    if (skt < 0)
+    {
+        LOG_ERROR(__func__ << "() socket: " << strerror(errno));
+        return -1;
+    }
+
+    // only error frames, no data frames
+    setsockopt(skt, SOL_CAN_RAW, CAN_RAW_FILTER, nullptr, 0);
+    can_err_mask_t errorMask = CAN_ERR_CRTL | CAN_ERR_BUSOFF | CAN_ERR_RESTARTED;
+    setsockopt(skt, SOL_CAN_RAW, CAN_RAW_ERR_FILTER, &errorMask, sizeof(errorMask));
+
+    struct ifreq ifr = {};
+    strncpy(ifr.ifr_name, device_.c_str(), IFNAMSIZ - 1);
+    if (ioctl(skt, SIOCGIFINDEX, &ifr) < 0)
+    {
+        LOG_ERROR(__func__ << "() ioctl: " << strerror(errno));
+        close(skt);
+        return -2;
+    }
+
+    struct sockaddr_can addr = {};
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+    if (bind(skt, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        LOG_ERROR(__func__ << "() bind: " << strerror(errno));
+        close(skt);
+        return -3;
+    }
+
+    error_skt_ = skt;
+    return 0;
+}
+
+/**
+ * Lets the socket receive all frames of the interface besides the error
+ * frames, or only the error frames.
+ */
+void BusStateMonitor::setDataFramesEnabled(bool isEnabled) noexcept
+{
+    const struct can_filter allFrames = {0, 0};
+    if (setsockopt(error_skt_, SOL_CAN_RAW, CAN_RAW_FILTER, isEnabled ? &allFrames : nullptr,
+                   isEnabled ? sizeof(allFrames) : 0) < 0)
+    {
+        LOG_ERROR(__func__ << "() setsockopt: " << strerror(errno));
+    }
+}
+
+void BusStateMonitor::updateState() noexcept
+{
+    int state;
+    if (can_get_state(device_.c_str(), &state) < 0)
+    {
+        state = STATE_UNKNOWN;
+    }
+
+    const int previous = state_.exchange(state);
+    if (state != previous)
+    {
+        if (state == STATE_UNKNOWN)
+        {
+            LOG_WARNING("Unable to get status for " << device_ << " assuming state OFF");
+        }
+        else
+        {
+            LOG_INFO("Bus state of " << device_ << " changed to " << state);
+        }
+        if (state == CAN_STATE_BUS_OFF || state == CAN_STATE_ERROR_PASSIVE)
+        {
+            IdleMonitor::getInstance().notifyBusError();
+        }
+    }
+
+    if (state == CAN_STATE_ERROR_PASSIVE && isRecoveryEnabled_)
+    {
+        recover();
+    }
+}
+
+/**
+ * Restarts the interface, see `canwatchdog.sh`.
+ */
+void BusStateMonitor::recover() noexcept
+{
+    LOG_INFO("Interface " << device_ << " is in ERROR-PASSIVE state - restarting interface");
+    if (can_do_stop(device_.c_str()) < 0 || can_do_start(device_.c_str()) < 0)
+    {
+        LOG_ERROR("Unable to restart " << device_);
+        return;
+    }
+    int state;
+    state_ = can_get_state(device_.c_str(), &state) < 0 ? STATE_UNKNOWN : state;
+}
+
+void BusStateMonitor::run() noexcept
+{
+    ThreadPlacement::getInstance().apply(ThreadRole::IO);
+    struct pollfd fds[3] = {{stop_fd_, POLLIN, 0}, {wakeup_fd_, POLLIN, 0}, {error_skt_, POLLIN, 0}};
+    const nfds_t numFds = error_skt_ >= 0 ? 3 : 2;
+    IdleMonitor& idleMonitor = IdleMonitor::getInstance();
+    bool isReceivingData = false;
+
+    while (true)
+    {
+        const bool isAwake = idleMonitor.isAwake();
+        if (numFds > 2 && isReceivingData == isAwake)
+        {
+            isReceivingData = !isAwake;
+            setDataFramesEnabled(isReceivingData);
+        }
+        // while the simulator sleeps, the state is only queried after error frames
+        const int result = poll(fds, numFds, isAwake ? STATE_POLL_INTERVAL_MS : -1);
+        if (result < 0 && errno != EINTR)
+        {
+            LOG_ERROR(__func__ << "() poll: " << strerror(errno));
+            return;
+        }
+        if (fds[0].revents & POLLIN)
+        {
+            return;
+        }
+        if (fds[1].revents & POLLIN)
+        {
+            uint64_t value;
+            while (read(wakeup_fd_, &value, sizeof(value)) > 0) { }
+        }
+        if (numFds > 2 && (fds[2].revents & POLLIN))
+        {
+            // the frame content is not needed, the state is queried below
+            struct can_frame frame;
+            bool hasDataFrame = false;
+            while (read(error_skt_, &frame, sizeof(frame)) > 0)
+            {
+                hasDataFrame |= (frame.can_id & CAN_ERR_FLAG) == 0;
+            }
+            if (hasDataFrame)
+            {
+                idleMonitor.notifyActivity();
+            }
+        }
+        updateState();
+    }
+}
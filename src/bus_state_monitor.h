@@ -0,0 +1,69 @@
+/**
+ * @file bus_state_monitor.h
+ *
+ */
+
+#ifndef BUS_STATE_MONITOR_H
+#define BUS_STATE_MONITOR_H
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * Keeps track of the state of one CAN interface (e.g. ERROR-ACTIVE or
+ * BUS-OFF), so the senders don't have to query it via netlink before every
+ * message.
+ *
+ * The monitor listens for CAN error frames on a raw socket and queries the
+ * state only after an error frame was received and once per second as a
+ * fallback (e.g. for interfaces without error reporting). The state is
+ * published atomically and can be read by any thread at no cost.
+ *
+ * Optionally, an interface in ERROR-PASSIVE state is restarted (stopped and
+ * started again), like `canwatchdog.sh` does.
+ *
+ * A change to BUS-OFF or ERROR-PASSIVE puts the simulator to sleep (see
+ * `IdleMonitor`). While it sleeps, the state is not polled and the socket
+ * receives all frames of the interface, the first one wakes the simulator up.
+ */
+class BusStateMonitor
+{
+public:
+    static std::shared_ptr<BusStateMonitor> getInstance(const std::string& device);
+    static void setRecoveryEnabled(bool isEnabled) noexcept;
+
+public:
+    BusStateMonitor() = delete;
+    explicit BusStateMonitor(const std::string& device);
+    BusStateMonitor(const BusStateMonitor& orig) = delete;
+    BusStateMonitor& operator =(const BusStateMonitor& orig) = delete;
+    virtual ~BusStateMonitor();
+
+    int getState() const noexcept;
+    bool isBusActive() const noexcept;
+
+private:
+    static std::mutex registryMutex_;
+    static std::map<std::string, std::weak_ptr<BusStateMonitor>> registry_;
+    static std::atomic<bool> isRecoveryEnabled_;
+
+    std::string device_;
+    std::atomic<int> state_; ///< one of `CAN_STATE_*`, -1 if unknown
+    int error_skt_ = -1; ///< raw CAN socket receiving the error frames, all frames while asleep
+    int stop_fd_ = -1;
+    int wakeup_fd_ = -1; ///< eventfd signalled when the simulator falls asleep or wakes up
+    int idleListenerId_ = -1;
+    std::thread thread_;
+
+    int openErrorSocket() noexcept;
+    void setDataFramesEnabled(bool isEnabled) noexcept;
+    void updateState() noexcept;
+    void recover() noexcept;
+    void run() noexcept;
+};
+
+#endif /* BUS_STATE_MONITOR_H */
@@ -0,0 +1,481 @@
+/**
+ * @file can_frame_bus.cpp
+ *
+ * This file contains the shared receiver of the raw CAN frames and the cyclic
+ * frames of the simulated ECUs of a CAN interface.
+ */
+
+#include "can_frame_bus.h"
+#include "bus_load_budget.h"
+#include "idle_monitor.h"
+#include "logger.h"
+#include "thread_placement.h"
+#include <linux/can.h>
+#include <linux/can/bcm.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+using namespace std;
+
+constexpr size_t RECEIVE_BATCH = 32; ///< max. frames per `recvmmsg()`
+
+/// a BCM message with a single frame, see `J1939CyclicScheduler`
+union BcmMessage
+{
+    struct bcm_msg_head head;
+    uint8_t bytes[sizeof(struct bcm_msg_head) + sizeof(struct can_frame)];
+};
+
+mutex CanFrameBus::registryMutex_;
+map<string, weak_ptr<CanFrameBus>> CanFrameBus::registry_;
+
+/**
+ * @param device: the CAN interface (e.g. "can0")
+ * @return the bus of the given interface, which is shared by all ECUs
+ */
+shared_ptr<CanFrameBus> CanFrameBus::getInstance(const string& device)
+{
+    lock_guard<mutex> lock(registryMutex_);
+    shared_ptr<CanFrameBus> pBus = registry_[device].lock();
+    if (!pBus)
+    {
+        pBus = make_shared<CanFrameBus>(device);
+        registry_[device] = pBus;
+    }
+    return pBus;
+}
+
+/**
+ * @param identifier: an 11 or 29 bit CAN ID as configured
+ * @return the CAN ID, with `CAN_EFF_FLAG` if it does not fit into 11 bits
+ */
+canid_t CanFrameBus::toCanId(uint32_t identifier) noexcept
+{
+    return identifier > CAN_SFF_MASK ? (identifier & CAN_EFF_MASK) | CAN_EFF_FLAG : identifier;
+}
+
+/**
+ * Constructor. Opens the sockets and starts receiving.
+ *
+ * @param device: the CAN interface (e.g. "can0")
+ */
+CanFrameBus::CanFrameBus(const string& device)
+: device_(device)
+, pBudget_(BusLoadBudget::getInstance(device))
+{
+    stop_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (stop_fd_ < 0)
+    {
+        LOG_ERROR(__func__ << "() eventfd: " << strerror(errno));
+        throw exception();
+    }
+    struct sockaddr_can addr = {};
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = int(if_nametoindex(device_.c_str()));
+    skt_ = socket(PF_CAN, SOCK_RAW | SOCK_CLOEXEC, CAN_RAW);
+    if (skt_ < 0 || addr.can_ifindex == 0
+        || bind(skt_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        LOG_ERROR(__func__ << "() " << device_ << ": " << strerror(errno));
+        if (skt_ >= 0)
+        {
+            close(skt_);
+        }
+        close(stop_fd_);
+        throw exception();
+    }
+    updateFilter();
+
+    bcm_skt_ = socket(PF_CAN, SOCK_DGRAM | SOCK_CLOEXEC, CAN_BCM);
+    if (bcm_skt_ >= 0 && connect(bcm_skt_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        close(bcm_skt_);
+        bcm_skt_ = -1;
+    }
+    if (bcm_skt_ < 0)
+    {
+        LOG_WARNING("No cyclic CAN frames on " << device_ << ": " << strerror(errno));
+    }
+
+    rxFrames_.resize(RECEIVE_BATCH);
+    rxMessages_.resize(RECEIVE_BATCH);
+    rxIovecs_.resize(RECEIVE_BATCH);
+    for (size_t i = 0; i < RECEIVE_BATCH; ++i)
+    {
+        rxIovecs_[i].iov_base = &rxFrames_[i];
+        rxIovecs_[i].iov_len = sizeof(struct can_frame);
+    }
+    txFrames_.reserve(RECEIVE_BATCH);
+    IdleMonitor& idleMonitor = IdleMonitor::getInstance();
+    idleListenerId_ = idleMonitor.addListener([this](bool isAwake) { setCyclicPaused(!isAwake); });
+    setCyclicPaused(!idleMonitor.isAwake());
+    thread_ = thread(&CanFrameBus::run, this);
+}
+
+/**
+ * Destructor. Stops receiving, the broadcast manager stops the cyclic frames
+ * when its socket is closed.
+ */
+CanFrameBus::~CanFrameBus()
+{
+    IdleMonitor::getInstance().removeListener(idleListenerId_);
+    const uint64_t value = 1;
+    if (write(stop_fd_, &value, sizeof(value)) < 0)
+    {
+        LOG_ERROR(__func__ << "() write: " << strerror(errno));
+    }
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+    close(skt_);
+    if (bcm_skt_ >= 0)
+    {
+        close(bcm_skt_);
+    }
+    close(stop_fd_);
+}
+
+/**
+ * Adds the frames of an ECU: the responses are dispatched from now on and the
+ * cyclic frames are started. Frames whose CAN ID is already used by another
+ * ECU of the interface are skipped.
+ *
+ * @param pOwner: the ECU, which has to remove its frames before it is destroyed
+ * @param frames: the `CanFrames` table of the ECU
+ * @return false if at least one frame was skipped
+ */
+bool CanFrameBus::addFrames(const void* pOwner, const vector<CanFrameConfiguration>& frames)
+{
+    bool isComplete = true;
+    lock_guard<mutex> lock(handlersMutex_);
+    for (const CanFrameConfiguration& frame : frames)
+    {
+        if (!frame.responses.empty())
+        {
+            unique_ptr<Handler>& pHandler = (frame.canId & CAN_EFF_FLAG)
+                ? extendedHandlers_[frame.canId & CAN_EFF_MASK]
+                : standardHandlers_[frame.canId & CAN_SFF_MASK];
+            if (pHandler)
+            {
+                LOG_ERROR("CAN ID " << hex << (frame.canId & CAN_EFF_MASK) << " is already handled on " << device_);
+                isComplete = false;
+            }
+            else
+            {
+                pHandler.reset(new Handler());
+                pHandler->pOwner = pOwner;
+                pHandler->responseId = frame.responseId;
+                pHandler->responses = frame.responses;
+            }
+        }
+        if (frame.cycleTime > 0)
+        {
+            if (cyclicFrames_.count(frame.canId) > 0)
+            {
+                LOG_ERROR("Cyclic CAN ID " << hex << (frame.canId & CAN_EFF_MASK) << " is already sent on " << device_);
+                isComplete = false;
+            }
+            else if (bcm_skt_ >= 0 && (isCyclicPaused_ || startCyclic(frame.canId, frame.payload, frame.cycleTime)))
+            {
+                cyclicFrames_[frame.canId] = CyclicFrame{pOwner, frame.payload, frame.cycleTime};
+            }
+        }
+    }
+    updateFilter();
+    return isComplete;
+}
+
+/**
+ * Removes the frames of an ECU, its responses are not sent any more when this
+ * returns.
+ */
+void CanFrameBus::removeFrames(const void* pOwner)
+{
+    lock_guard<mutex> lock(handlersMutex_);
+    for (unique_ptr<Handler>& pHandler : standardHandlers_)
+    {
+        if (pHandler && pHandler->pOwner == pOwner)
+        {
+            pHandler.reset();
+        }
+    }
+    for (auto iter = extendedHandlers_.begin(); iter != extendedHandlers_.end();)
+    {
+        iter = iter->second->pOwner == pOwner ? extendedHandlers_.erase(iter) : next(iter);
+    }
+    for (auto iter = cyclicFrames_.begin(); iter != cyclicFrames_.end();)
+    {
+        if (iter->second.pOwner == pOwner)
+        {
+            if (!isCyclicPaused_)
+            {
+                stopCyclic(iter->first);
+            }
+            iter = cyclicFrames_.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+    updateFilter();
+}
+
+/**
+ * @return the handler of a received CAN ID or `nullptr`. The handlers lock
+ *         must be held.
+ */
+CanFrameBus::Handler* CanFrameBus::findHandler(canid_t canId) const noexcept
+{
+    if (canId & CAN_EFF_FLAG)
+    {
+        auto iter = extendedHandlers_.find(canId & CAN_EFF_MASK);
+        return iter != extendedHandlers_.end() ? iter->second.get() : nullptr;
+    }
+    return standardHandlers_[canId & CAN_SFF_MASK].get();
+}
+
+/**
+ * Hands a cyclic frame over to the broadcast manager, which sends the first
+ * frame right away.
+ *
+ * @return false if the frame is not sent
+ */
+bool CanFrameBus::startCyclic(canid_t canId, const vector<uint8_t>& payload, unsigned int cycleTime) noexcept
+{
+    if (bcm_skt_ < 0)
+    {
+        return false;
+    }
+    BcmMessage message = {};
+    message.head.opcode = TX_SETUP;
+    message.head.flags = SETTIMER | STARTTIMER;
+    message.head.can_id = canId;
+    message.head.nframes = 1;
+    message.head.ival2.tv_sec = long(cycleTime / 1000);
+    message.head.ival2.tv_usec = long(cycleTime % 1000 * 1000);
+    struct can_frame& frame = message.head.frames[0];
+    frame.can_id = canId;
+    frame.can_dlc = uint8_t(payload.size());
+    copy(payload.cbegin(), payload.cend(), frame.data);
+    if (write(bcm_skt_, &message, sizeof(message)) != ssize_t(sizeof(message)))
+    {
+        LOG_WARNING("Unable to send CAN ID " << hex << (canId & CAN_EFF_MASK) << " cyclically: " << strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Deletes the transmission of a cyclic frame.
+ */
+void CanFrameBus::stopCyclic(canid_t canId) noexcept
+{
+    BcmMessage message = {};
+    message.head.opcode = TX_DELETE;
+    message.head.can_id = canId;
+    if (write(bcm_skt_, &message.head, sizeof(struct bcm_msg_head)) < 0)
+    {
+        LOG_WARNING("Unable to stop the cyclic CAN ID " << hex << (canId & CAN_EFF_MASK) << ": " << strerror(errno));
+    }
+}
+
+/**
+ * Deletes the cyclic frames from the broadcast manager or starts them again.
+ */
+void CanFrameBus::setCyclicPaused(bool isPaused) noexcept
+{
+    lock_guard<mutex> lock(handlersMutex_);
+    if (isPaused == isCyclicPaused_)
+    {
+        return;
+    }
+    isCyclicPaused_ = isPaused;
+    for (const auto& cyclicFrame : cyclicFrames_)
+    {
+        if (isPaused)
+        {
+            stopCyclic(cyclicFrame.first);
+        }
+        else
+        {
+            startCyclic(cyclicFrame.first, cyclicFrame.second.payload, cyclicFrame.second.cycleTime);
+        }
+    }
+}
+
+/**
+ * Installs the CAN IDs of all handlers as kernel filter of the socket. If
+ * there are too many IDs, the whole bus is received and the frames without
+ * handler are dropped by the lookup. The handlers lock must be held.
+ */
+void CanFrameBus::updateFilter() noexcept
+{
+    vector<struct can_filter> filters;
+    for (size_t id = 0; id < standardHandlers_.size(); ++id)
+    {
+        if (standardHandlers_[id])
+        {
+            filters.push_back({canid_t(id), CAN_EFF_FLAG | CAN_RTR_FLAG | CAN_SFF_MASK});
+        }
+    }
+    for (const auto& handler : extendedHandlers_)
+    {
+        filters.push_back({handler.first | CAN_EFF_FLAG, CAN_EFF_FLAG | CAN_RTR_FLAG | CAN_EFF_MASK});
+    }
+    if (filters.size() > CAN_RAW_FILTER_MAX)
+    {
+        LOG_WARNING("More than " << CAN_RAW_FILTER_MAX << " CAN IDs on " << device_ << ", receiving all frames");
+        filters.assign(1, {0, 0});
+    }
+    if (setsockopt(skt_, SOL_CAN_RAW, CAN_RAW_FILTER, filters.empty() ? nullptr : filters.data(),
+                   socklen_t(filters.size() * sizeof(struct can_filter))) < 0)
+    {
+        LOG_ERROR(__func__ << "() setsockopt: " << strerror(errno));
+    }
+}
+
+/**
+ * Queues the response of a received frame: the first response whose request
+ * bytes the frame starts with. The handlers lock must be held.
+ */
+void CanFrameBus::handleFrame(const struct can_frame& frame)
+{
+    const Handler* pHandler = findHandler(frame.can_id);
+    if (pHandler == nullptr)
+    {
+        return;
+    }
+    const size_t length = min<size_t>(frame.can_dlc, CAN_MAX_DLEN);
+    for (const CanFrameResponse& response : pHandler->responses)
+    {
+        if (response.request.size() <= length
+            && equal(response.request.cbegin(), response.request.cend(), frame.data))
+        {
+            txFrames_.emplace_back();
+            struct can_frame& txFrame = txFrames_.back();
+            memset(&txFrame, 0, sizeof(txFrame));
+            txFrame.can_id = pHandler->responseId;
+            txFrame.can_dlc = uint8_t(response.response.size());
+            copy(response.response.cbegin(), response.response.cend(), txFrame.data);
+            return;
+        }
+    }
+}
+
+/**
+ * Writes the queued responses with one `sendmmsg()`. Responses which do not
+ * fit into the TX queue of the interface are dropped, like a busy ECU would.
+ */
+void CanFrameBus::sendResponses() noexcept
+{
+    txMessages_.resize(txFrames_.size());
+    txIovecs_.resize(txFrames_.size());
+    for (size_t i = 0; i < txFrames_.size(); ++i)
+    {
+        txIovecs_[i].iov_base = &txFrames_[i];
+        txIovecs_[i].iov_len = sizeof(struct can_frame);
+        txMessages_[i] = {};
+        txMessages_[i].msg_hdr.msg_iov = &txIovecs_[i];
+        txMessages_[i].msg_hdr.msg_iovlen = 1;
+    }
+    size_t sent = 0;
+    while (sent < txFrames_.size())
+    {
+        const int count = sendmmsg(skt_, txMessages_.data() + sent, unsigned(txFrames_.size() - sent), MSG_DONTWAIT);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno != ENOBUFS && errno != EAGAIN)
+            {
+                LOG_ERROR(__func__ << "() sendmmsg: " << strerror(errno));
+            }
+            droppedCount_ += txFrames_.size() - sent;
+            break;
+        }
+        sent += size_t(count);
+    }
+    const uint64_t nowNs = BusLoadBudget::getNowNs();
+    for (size_t i = 0; i < sent; ++i)
+    {
+        pBudget_->consume(BusLoadBudget::getFrameBits(txFrames_[i].can_id, txFrames_[i].can_dlc), nowNs);
+    }
+    txFrames_.clear();
+}
+
+/**
+ * Reads the pending frames with one `recvmmsg()` and sends their responses.
+ */
+void CanFrameBus::receiveBatch() noexcept
+{
+    for (size_t i = 0; i < RECEIVE_BATCH; ++i)
+    {
+        rxMessages_[i] = {};
+        rxMessages_[i].msg_hdr.msg_iov = &rxIovecs_[i];
+        rxMessages_[i].msg_hdr.msg_iovlen = 1;
+    }
+    const int count = recvmmsg(skt_, rxMessages_.data(), RECEIVE_BATCH, MSG_DONTWAIT, nullptr);
+    if (count < 0)
+    {
+        if (errno != EAGAIN && errno != EINTR)
+        {
+            LOG_ERROR(__func__ << "() recvmmsg: " << strerror(errno));
+        }
+        return;
+    }
+    if (count > 0)
+    {
+        IdleMonitor::getInstance().notifyActivity();
+    }
+    {
+        // the handlers are not removed while a batch is dispatched
+        lock_guard<mutex> lock(handlersMutex_);
+        for (int i = 0; i < count; ++i)
+        {
+            if (rxMessages_[i].msg_len == sizeof(struct can_frame))
+            {
+                handleFrame(rxFrames_[size_t(i)]);
+            }
+        }
+    }
+    if (!txFrames_.empty())
+    {
+        sendResponses();
+    }
+}
+
+void CanFrameBus::run() noexcept
+{
+    ThreadPlacement::getInstance().apply(ThreadRole::IO);
+    struct pollfd fds[2] = {{stop_fd_, POLLIN, 0}, {skt_, POLLIN, 0}};
+
+    while (true)
+    {
+        const int result = poll(fds, 2, -1);
+        if (result < 0 && errno != EINTR)
+        {
+            LOG_ERROR(__func__ << "() poll: " << strerror(errno));
+            return;
+        }
+        if (fds[0].revents & POLLIN)
+        {
+            return;
+        }
+        if (fds[1].revents & POLLIN)
+        {
+            receiveBatch();
+        }
+    }
+}
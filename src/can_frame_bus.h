@@ -0,0 +1,136 @@
+/**
+ * @file can_frame_bus.h
+ *
+ */
+
+#ifndef CAN_FRAME_BUS_H
+#define CAN_FRAME_BUS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <linux/can.h>
+
+/**
+ * A response of a raw CAN frame, see `CanFrameConfiguration`.
+ */
+struct CanFrameResponse
+{
+    std::vector<std::uint8_t> request; ///< the leading data bytes of the request, empty = any request
+    std::vector<std::uint8_t> response; ///< the data bytes of the response frame
+};
+
+/**
+ * One entry of the `CanFrames` table of the ECU: a cyclic frame, the
+ * responses to a request frame or both.
+ */
+struct CanFrameConfiguration
+{
+    canid_t canId = 0; ///< with `CAN_EFF_FLAG` for 29 bit IDs, see `CanFrameBus::toCanId()`
+    std::vector<std::uint8_t> payload; ///< the data bytes of the cyclic frame
+    unsigned int cycleTime = 0; ///< in ms, 0 = not cyclic
+    canid_t responseId = 0; ///< the CAN ID of the responses
+    /// the responses to the frames received on `canId`, the longest request first
+    std::vector<CanFrameResponse> responses;
+};
+
+/**
+ * Simulates the plain CAN frames (no ISO-TP, no J1939) of all ECUs on one CAN
+ * interface.
+ *
+ * A single `CAN_RAW` socket and thread receive the request frames. The socket
+ * only receives the CAN IDs of the ECUs (`CAN_RAW_FILTER`), the frames are
+ * read in batches with `recvmmsg()` and dispatched through a direct-mapped
+ * table of the 11 bit IDs, respectively a hash map of the 29 bit IDs, to their
+ * static responses. The responses of a batch are written with one
+ * `sendmmsg()`, so no Lua function is called per frame.
+ *
+ * The cyclic frames are handed over to the broadcast manager of the kernel
+ * (`CAN_BCM`), which sends them on its own timers. While the simulator
+ * sleeps (see `IdleMonitor`), they are deleted from the broadcast manager,
+ * the responses are still sent.
+ */
+class BusLoadBudget;
+
+class CanFrameBus
+{
+public:
+    static std::shared_ptr<CanFrameBus> getInstance(const std::string& device);
+    static canid_t toCanId(std::uint32_t identifier) noexcept;
+
+public:
+    CanFrameBus() = delete;
+    explicit CanFrameBus(const std::string& device);
+    CanFrameBus(const CanFrameBus& orig) = delete;
+    CanFrameBus& operator =(const CanFrameBus& orig) = delete;
+    virtual ~CanFrameBus();
+
+    bool addFrames(const void* pOwner, const std::vector<CanFrameConfiguration>& frames);
+    void removeFrames(const void* pOwner);
+    std::uint64_t getDroppedCount() const noexcept { return droppedCount_; }
+
+private:
+    /// the responses of a received CAN ID
+    struct Handler
+    {
+        const void* pOwner = nullptr;
+        canid_t responseId = 0;
+        std::vector<CanFrameResponse> responses;
+    };
+
+    /// a cyclic frame, kept to start it again after the simulator slept
+    struct CyclicFrame
+    {
+        const void* pOwner = nullptr;
+        std::vector<std::uint8_t> payload;
+        unsigned int cycleTime = 0;
+    };
+
+    static std::mutex registryMutex_;
+    static std::map<std::string, std::weak_ptr<CanFrameBus>> registry_;
+
+    std::string device_;
+    int skt_ = -1; ///< receives the requests and sends the responses
+    int bcm_skt_ = -1; ///< sends the cyclic frames, -1 if the interface has no broadcast manager
+    int stop_fd_ = -1;
+    std::shared_ptr<BusLoadBudget> pBudget_; ///< counts the sent responses
+    std::thread thread_;
+    std::atomic<std::uint64_t> droppedCount_{0}; ///< responses the TX queue had no room for
+
+    mutable std::mutex handlersMutex_;
+    std::array<std::unique_ptr<Handler>, CAN_SFF_MASK + 1> standardHandlers_; ///< indexed by the 11 bit ID
+    std::unordered_map<canid_t, std::unique_ptr<Handler>> extendedHandlers_; ///< keyed by the 29 bit ID
+    std::map<canid_t, CyclicFrame> cyclicFrames_;
+    bool isCyclicPaused_ = false; ///< the simulator sleeps, the cyclic frames are not sent
+    int idleListenerId_ = -1;
+
+    // only used by the receiver thread
+    std::vector<struct can_frame> rxFrames_;
+    std::vector<struct mmsghdr> rxMessages_;
+    std::vector<struct iovec> rxIovecs_;
+    std::vector<struct can_frame> txFrames_;
+    std::vector<struct mmsghdr> txMessages_;
+    std::vector<struct iovec> txIovecs_;
+
+    Handler* findHandler(canid_t canId) const noexcept;
+    bool startCyclic(canid_t canId, const std::vector<std::uint8_t>& payload, unsigned int cycleTime) noexcept;
+    void stopCyclic(canid_t canId) noexcept;
+    void setCyclicPaused(bool isPaused) noexcept;
+    void updateFilter() noexcept;
+    void handleFrame(const struct can_frame& frame);
+    void sendResponses() noexcept;
+    void receiveBatch() noexcept;
+    void run() noexcept;
+};
+
+#endif /* CAN_FRAME_BUS_H */
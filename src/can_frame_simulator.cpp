@@ -0,0 +1,54 @@
+/**
+ * @file can_frame_simulator.cpp
+ *
+ */
+
+#include "can_frame_simulator.h"
+#include "ecu_lua_script.h"
+
+using namespace std;
+
+/**
+ * @return true if the ECU has a `CanFrames` table
+ */
+bool CanFrameSimulator::hasSimulation(EcuLuaScript* pEcuScript)
+{
+    return !pEcuScript->getCanFrames().empty();
+}
+
+/**
+ * Constructor. Starts the responses and the cyclic frames of the ECU. They
+ * are stopped while the normal messages are disabled by
+ * `CommunicationControl`, which deletes the jobs of the broadcast manager.
+ *
+ * @param device: the CAN interface (e.g. "can0")
+ * @param pEcuScript: the script of the ECU
+ */
+CanFrameSimulator::CanFrameSimulator(const string& device, EcuLuaScript* pEcuScript)
+: pBus_(CanFrameBus::getInstance(device))
+, pCommunicationGate_(pEcuScript->getCommunicationGate())
+{
+    if (pCommunicationGate_->isTransmitEnabled())
+    {
+        pBus_->addFrames(this, pEcuScript->getCanFrames());
+    }
+    gateListenerId_ = pCommunicationGate_->addListener([this, pEcuScript](bool isTransmitEnabled) {
+        if (isTransmitEnabled)
+        {
+            pBus_->addFrames(this, pEcuScript->getCanFrames());
+        }
+        else
+        {
+            pBus_->removeFrames(this);
+        }
+    });
+}
+
+/**
+ * Destructor. Stops the responses and the cyclic frames of the ECU.
+ */
+CanFrameSimulator::~CanFrameSimulator()
+{
+    pCommunicationGate_->removeListener(gateListenerId_);
+    pBus_->removeFrames(this);
+}
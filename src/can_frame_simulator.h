@@ -0,0 +1,40 @@
+/**
+ * @file can_frame_simulator.h
+ *
+ */
+
+#ifndef CAN_FRAME_SIMULATOR_H
+#define CAN_FRAME_SIMULATOR_H
+
+#include "can_frame_bus.h"
+#include "communication_gate.h"
+#include <memory>
+#include <string>
+
+class EcuLuaScript;
+
+/**
+ * Simulates the `CanFrames` table of an ECU on one CAN interface. The frames
+ * are received and sent by the shared `CanFrameBus` of the interface, from
+ * construction until destruction of the simulator, except while
+ * `CommunicationControl` disables the normal messages of the ECU.
+ */
+class CanFrameSimulator
+{
+public:
+    static bool hasSimulation(EcuLuaScript* pEcuScript);
+
+public:
+    CanFrameSimulator() = delete;
+    CanFrameSimulator(const std::string& device, EcuLuaScript* pEcuScript);
+    CanFrameSimulator(const CanFrameSimulator& orig) = delete;
+    CanFrameSimulator& operator =(const CanFrameSimulator& orig) = delete;
+    virtual ~CanFrameSimulator();
+
+private:
+    std::shared_ptr<CanFrameBus> pBus_;
+    std::shared_ptr<CommunicationGate> pCommunicationGate_;
+    int gateListenerId_ = -1;
+};
+
+#endif /* CAN_FRAME_SIMULATOR_H */
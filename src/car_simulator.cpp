@@ -0,0 +1,252 @@
+/**
+ * @file car_simulator.cpp
+ *
+ * This file contains the simulator library, which answers UDS requests
+ * in-process, and its C interface.
+ */
+
+#include "car_simulator.h"
+#include "carsim.h"
+#include "doip_sim_server.h"
+#include "ecu_lua_script.h"
+#include "electronic_control_unit.h"
+#include "logger.h"
+#include "loopback_transport.h"
+#include "session_controller.h"
+#include "simulator_configuration.h"
+#include "uds_receiver.h"
+#include "utilities.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+
+using namespace std;
+
+/// the interval `request()` checks whether a pending response is finished
+static constexpr chrono::milliseconds PENDING_POLL_INTERVAL(10);
+
+/**
+ * An ECU of the library. The members are destroyed in the reverse order, so
+ * the receiver goes first and the transport outlives the Lua worker, which
+ * might still send a response.
+ */
+struct CarSimulator::Ecu
+{
+    LoopbackTransport transport;
+    unique_ptr<EcuLuaScript> pScript;
+    SessionController sessionControl;
+    unique_ptr<UdsReceiver> pReceiver;
+    mutex requestMutex; ///< one request at a time
+};
+
+CarSimulator::CarSimulator() = default;
+
+/**
+ * Destructor. Deletes the ECUs.
+ */
+CarSimulator::~CarSimulator()
+{
+    ecus_.clear();
+}
+
+/**
+ * Adds the ECUs of all Lua configurations of a directory, except the
+ * `simulator.lua` and the DoIP entities.
+ *
+ * @param directory: the directory of the configurations
+ * @return the number of added ECUs
+ */
+size_t CarSimulator::loadDirectory(const string& directory)
+{
+    vector<string> configFiles = utils::getConfigFilenames(directory);
+    sort(configFiles.begin(), configFiles.end());
+    size_t count = 0;
+    for (const string& configFile : configFiles)
+    {
+        if (configFile == SIMULATOR_CONFIG_FILE || configFile.rfind(DOIP_SERVER_CONFIG_PREFIX, 0) == 0)
+        {
+            continue;
+        }
+        const string name = configFile.substr(0, configFile.size() - strlen(".lua"));
+        if (addEcu(name, directory + "/" + configFile))
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * Loads an ECU configuration.
+ *
+ * @param name: the name of the ECU in `request()`
+ * @param configFile: the Lua configuration
+ * @param ecuTable: the table of the ECU in the configuration
+ * @return false if the configuration can not be loaded, has no UDS simulation
+ *         (i.e. no `RequestId` and `ResponseId`) or the name is in use
+ */
+bool CarSimulator::addEcu(const string& name, const string& configFile, const string& ecuTable)
+{
+    if (ecus_.count(name) > 0)
+    {
+        LOG_WARNING("ECU " << name << " already exists");
+        return false;
+    }
+    try
+    {
+        auto pEcu = std::make_unique<Ecu>();
+        pEcu->pScript = std::make_unique<EcuLuaScript>(ecuTable, configFile);
+        if (!ElectronicControlUnit::hasSimulation(pEcu->pScript.get()))
+        {
+            return false;
+        }
+        pEcu->pReceiver = std::make_unique<UdsReceiver>(pEcu->pScript->getResponseId(),
+                                                        pEcu->pScript->getRequestId(),
+                                                        pEcu->pScript.get(),
+                                                        &pEcu->transport,
+                                                        &pEcu->sessionControl);
+        ecus_.emplace(name, move(pEcu));
+        return true;
+    }
+    catch (exception& e)
+    {
+        LOG_ERROR("Unable to load " << configFile << ": " << e.what());
+        return false;
+    }
+}
+
+/**
+ * @return the names of the ECUs, in no particular order
+ */
+vector<string> CarSimulator::getEcuNames() const
+{
+    vector<string> names;
+    names.reserve(ecus_.size());
+    for (const auto& ecu : ecus_)
+    {
+        names.push_back(ecu.first);
+    }
+    return names;
+}
+
+/**
+ * Passes a UDS request to an ECU and waits for its final response, i.e. the
+ * response pending messages of a `ResponsePending` ECU are skipped.
+ *
+ * @param ecu: the name of the ECU
+ * @param request: the UDS request
+ * @param length: the length of the request in bytes
+ * @param response: set to the response, empty if the ECU did not respond
+ *                  (e.g. to `3E 80`)
+ * @return false if the ECU is unknown or the request is empty or too long
+ */
+bool CarSimulator::request(const string& ecu, const uint8_t* request, size_t length,
+                           vector<uint8_t>& response)
+{
+    response.clear();
+    const auto iter = ecus_.find(ecu);
+    if (iter == ecus_.end())
+    {
+        return false;
+    }
+    Ecu& target = *iter->second;
+    if (length == 0 || length > target.pScript->getIsoTpConfiguration().maxMessageSize)
+    {
+        return false;
+    }
+
+    lock_guard<mutex> lock(target.requestMutex);
+    target.transport.clear();
+    target.pReceiver->proceedReceivedData(request, length);
+    const auto deadline = chrono::steady_clock::now() + chrono::milliseconds(RESPONSE_TIMEOUT_MS);
+    while (target.pReceiver->isResponsePending() && chrono::steady_clock::now() < deadline)
+    {
+        target.transport.waitForResponse(target.transport.getResponseCount() + 1, PENDING_POLL_INTERVAL);
+    }
+    target.transport.copyResponse(response);
+    return true;
+}
+
+/**
+ * Passes a UDS request to an ECU and waits for its final response.
+ *
+ * @param ecu: the name of the ECU
+ * @param request: the UDS request
+ * @return the response, empty if the ECU did not respond or is unknown
+ */
+vector<uint8_t> CarSimulator::request(const string& ecu, const vector<uint8_t>& request)
+{
+    vector<uint8_t> response;
+    this->request(ecu, request.data(), request.size(), response);
+    return response;
+}
+
+struct carsim
+{
+    CarSimulator simulator;
+};
+
+carsim_t* carsim_create(const char* config_dir)
+{
+    try
+    {
+        auto pSim = std::make_unique<carsim>();
+        if (config_dir != nullptr)
+        {
+            pSim->simulator.loadDirectory(config_dir);
+        }
+        return pSim.release();
+    }
+    catch (exception& e)
+    {
+        LOG_ERROR(__func__ << "() " << e.what());
+        return nullptr;
+    }
+}
+
+void carsim_destroy(carsim_t* sim)
+{
+    delete sim;
+}
+
+int carsim_add_ecu(carsim_t* sim, const char* name, const char* config_file)
+{
+    if (sim == nullptr || name == nullptr || config_file == nullptr)
+    {
+        return -1;
+    }
+    return sim->simulator.addEcu(name, config_file) ? 0 : -1;
+}
+
+long carsim_request(carsim_t* sim, const char* ecu, const uint8_t* request, size_t length,
+                    uint8_t* response, size_t size)
+{
+    if (sim == nullptr || ecu == nullptr || request == nullptr)
+    {
+        return -1;
+    }
+    // reused by the calls of a thread, so a request does not allocate
+    static thread_local vector<uint8_t> buffer;
+    try
+    {
+        if (!sim->simulator.request(ecu, request, length, buffer))
+        {
+            return -1;
+        }
+    }
+    catch (exception& e)
+    {
+        LOG_ERROR(__func__ << "() " << e.what());
+        return -1;
+    }
+    if (buffer.size() > size)
+    {
+        return -2;
+    }
+    if (!buffer.empty())
+    {
+        memcpy(response, buffer.data(), buffer.size());
+    }
+    return static_cast<long>(buffer.size());
+}
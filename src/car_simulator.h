@@ -0,0 +1,61 @@
+/**
+ * @file car_simulator.h
+ *
+ */
+
+#ifndef CAR_SIMULATOR_H
+#define CAR_SIMULATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * The simulator as a library, e.g. for the unit tests of a tester: the ECUs
+ * are loaded from their Lua configurations as usual, but are not bound to a
+ * CAN interface. `request()` passes a UDS request to the `UdsReceiver` of an
+ * ECU directly and returns its response, which is sent through a
+ * `LoopbackTransport`, so neither vcan nor the `can-isotp` module is needed.
+ *
+ * ```cpp
+ * CarSimulator simulator;
+ * simulator.loadDirectory("lua_config");
+ * std::vector<std::uint8_t> response = simulator.request("ecu1", {0x22, 0xF1, 0x90});
+ * ```
+ *
+ * The ECUs are named after their configuration file without `.lua`. The
+ * requests of one ECU are proceeded one at a time, different ECUs may be
+ * called by several threads. J1939, plain CAN frames, DoIP and
+ * `ReadDataByPeriodicIdentifier` are not simulated. The C interface is
+ * declared in `carsim.h`.
+ */
+class CarSimulator
+{
+public:
+    /// the max. time `request()` waits for the final response after `7F xx 78`
+    static constexpr unsigned int RESPONSE_TIMEOUT_MS = 30000;
+
+    CarSimulator();
+    CarSimulator(const CarSimulator& orig) = delete;
+    CarSimulator& operator =(const CarSimulator& orig) = delete;
+    virtual ~CarSimulator();
+
+    std::size_t loadDirectory(const std::string& directory);
+    bool addEcu(const std::string& name, const std::string& configFile,
+                const std::string& ecuTable = "Main");
+    std::vector<std::string> getEcuNames() const;
+
+    bool request(const std::string& ecu, const std::uint8_t* request, std::size_t length,
+                 std::vector<std::uint8_t>& response);
+    std::vector<std::uint8_t> request(const std::string& ecu, const std::vector<std::uint8_t>& request);
+
+private:
+    struct Ecu;
+
+    std::unordered_map<std::string, std::unique_ptr<Ecu>> ecus_;
+};
+
+#endif /* CAR_SIMULATOR_H */
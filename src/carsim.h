@@ -0,0 +1,69 @@
+/**
+ * @file carsim.h
+ *
+ * C interface of the simulator library, see `CarSimulator`.
+ *
+ * ```c
+ * carsim_t* sim = carsim_create("lua_config");
+ * uint8_t response[4095];
+ * const uint8_t request[] = {0x22, 0xF1, 0x90};
+ * long length = carsim_request(sim, "ecu1", request, sizeof(request), response, sizeof(response));
+ * carsim_destroy(sim);
+ * ```
+ */
+
+#ifndef CARSIM_H
+#define CARSIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** A simulator with its ECUs. */
+typedef struct carsim carsim_t;
+
+/**
+ * Creates a simulator with the ECUs of all `*.lua` files of a directory.
+ *
+ * @param config_dir: the directory of the ECU configurations, `NULL` for none
+ * @return the simulator, `NULL` on errors
+ */
+carsim_t* carsim_create(const char* config_dir);
+
+/**
+ * Deletes the simulator and its ECUs.
+ */
+void carsim_destroy(carsim_t* sim);
+
+/**
+ * Adds an ECU.
+ *
+ * @param name: the name used in `carsim_request()`
+ * @param config_file: the Lua configuration of the ECU
+ * @return 0 on success, -1 if the configuration has no UDS simulation or the
+ *         name is in use
+ */
+int carsim_add_ecu(carsim_t* sim, const char* name, const char* config_file);
+
+/**
+ * Sends a UDS request to an ECU and waits for its final response.
+ *
+ * @param ecu: the name of the ECU
+ * @param request: the UDS request
+ * @param length: the length of the request in bytes
+ * @param response: the buffer of the response
+ * @param size: the size of the buffer
+ * @return the length of the response, 0 if the ECU did not respond, -1 if the
+ *         ECU is unknown or the request invalid, -2 if the buffer is too small
+ */
+long carsim_request(carsim_t* sim, const char* ecu, const uint8_t* request, size_t length,
+                    uint8_t* response, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CARSIM_H */
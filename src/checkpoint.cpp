@@ -0,0 +1,209 @@
+/**
+ * @file checkpoint.cpp
+ *
+ * The checkpoint file consists of the header and the sections, each of them
+ * its header, the owner and the data, padded to 8 bytes.
+ */
+
+#include "checkpoint.h"
+#include "logger.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+
+using namespace std;
+
+static constexpr char FILE_MAGIC[8] = {'C', 'S', 'I', 'M', 'C', 'K', 'P', 'T'};
+static constexpr uint32_t FILE_VERSION = 1;
+static constexpr size_t SECTION_ALIGNMENT = 8;
+
+namespace
+{
+
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t sectionCount;
+};
+
+struct SectionHeader
+{
+    uint32_t section; ///< see `CheckpointSection`
+    uint32_t ownerLength;
+    uint64_t dataLength;
+};
+
+inline uint64_t alignSection(uint64_t offset) noexcept
+{
+    return (offset + SECTION_ALIGNMENT - 1) & ~uint64_t(SECTION_ALIGNMENT - 1);
+}
+
+} // namespace
+
+Checkpoint::~Checkpoint()
+{
+    clear();
+}
+
+/**
+ * Adds a section to be written by `write()`.
+ *
+ * @param section: the kind of state
+ * @param owner: the configuration the state belongs to
+ * @param data: the state, see `CheckpointEncoder`
+ */
+void Checkpoint::add(CheckpointSection section, const string& owner, string data)
+{
+    buffers_.push_back(owner);
+    const string_view ownerView = buffers_.back();
+    buffers_.push_back(move(data));
+    sections_.push_back(Section{section, ownerView, buffers_.back()});
+}
+
+/**
+ * Writes the sections to a file. The file is written under a temporary name
+ * and renamed, so a simulator restoring it at the same time never sees a
+ * partially written checkpoint.
+ *
+ * @param file: the path of the checkpoint
+ * @return 0 on success, otherwise a negative value
+ */
+int Checkpoint::write(const string& file) const noexcept
+{
+    const string temporaryFile = file + ".tmp" + to_string(getpid());
+    ofstream out(temporaryFile, ios::binary | ios::trunc);
+    FileHeader header = {};
+    memcpy(header.magic, FILE_MAGIC, sizeof(header.magic));
+    header.version = FILE_VERSION;
+    header.sectionCount = uint32_t(sections_.size());
+    out.write(reinterpret_cast<const char*> (&header), sizeof(header));
+    for (const Section& section : sections_)
+    {
+        static const char padding[SECTION_ALIGNMENT] = {};
+        const SectionHeader sectionHeader = {uint32_t(section.section), uint32_t(section.owner.size()),
+                                             section.data.size()};
+        out.write(reinterpret_cast<const char*> (&sectionHeader), sizeof(sectionHeader));
+        out.write(section.owner.data(), streamsize(section.owner.size()));
+        out.write(section.data.data(), streamsize(section.data.size()));
+        const uint64_t length = section.owner.size() + section.data.size();
+        out.write(padding, streamsize(alignSection(length) - length));
+    }
+    out.close();
+    if (!out || rename(temporaryFile.c_str(), file.c_str()) != 0)
+    {
+        LOG_WARNING("Can not write the checkpoint " << file << ": " << strerror(errno));
+        remove(temporaryFile.c_str());
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Maps a checkpoint file, the sections of a previous `add()` or `load()`
+ * are dropped.
+ *
+ * @param file: the path of the checkpoint
+ * @return 0 on success, otherwise a negative value
+ */
+int Checkpoint::load(const string& file) noexcept
+{
+    clear();
+    const int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        LOG_WARNING("Can not open the checkpoint " << file << ": " << strerror(errno));
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(FileHeader))
+    {
+        void* pData = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (pData != MAP_FAILED)
+        {
+            pMapping_ = pData;
+            mappingSize_ = size_t(st.st_size);
+        }
+    }
+    close(fd);
+    if (pMapping_ == nullptr)
+    {
+        LOG_WARNING("Can not map the checkpoint " << file);
+        return -2;
+    }
+
+    const char* pFile = static_cast<const char*> (pMapping_);
+    FileHeader header;
+    memcpy(&header, pFile, sizeof(header));
+    if (memcmp(header.magic, FILE_MAGIC, sizeof(header.magic)) != 0 || header.version != FILE_VERSION)
+    {
+        LOG_WARNING("Ignoring the checkpoint " << file << " of another simulator version");
+        clear();
+        return -3;
+    }
+    uint64_t offset = sizeof(header);
+    sections_.reserve(header.sectionCount);
+    for (uint32_t i = 0; i < header.sectionCount; ++i)
+    {
+        SectionHeader sectionHeader;
+        if (mappingSize_ - offset < sizeof(sectionHeader))
+        {
+            break;
+        }
+        memcpy(&sectionHeader, pFile + offset, sizeof(sectionHeader));
+        offset += sizeof(sectionHeader);
+        if (sectionHeader.ownerLength > mappingSize_ - offset
+            || sectionHeader.dataLength > mappingSize_ - offset - sectionHeader.ownerLength)
+        {
+            break;
+        }
+        const char* pOwner = pFile + offset;
+        sections_.push_back(Section{CheckpointSection(sectionHeader.section),
+                                    string_view(pOwner, sectionHeader.ownerLength),
+                                    string_view(pOwner + sectionHeader.ownerLength, sectionHeader.dataLength)});
+        offset += alignSection(sectionHeader.ownerLength + sectionHeader.dataLength);
+        offset = min(offset, uint64_t(mappingSize_));
+    }
+    if (sections_.size() != header.sectionCount)
+    {
+        LOG_WARNING("Ignoring the truncated checkpoint " << file);
+        clear();
+        return -4;
+    }
+    return 0;
+}
+
+/**
+ * @param section: the kind of state
+ * @param owner: the configuration the state belongs to
+ * @return the data of the section, valid as long as the checkpoint, or
+ *         nothing if the checkpoint has no such section
+ */
+optional<string_view> Checkpoint::find(CheckpointSection section, string_view owner) const noexcept
+{
+    for (const Section& entry : sections_)
+    {
+        if (entry.section == section && entry.owner == owner)
+        {
+            return entry.data;
+        }
+    }
+    return nullopt;
+}
+
+void Checkpoint::clear() noexcept
+{
+    sections_.clear();
+    buffers_.clear();
+    if (pMapping_ != nullptr)
+    {
+        munmap(pMapping_, mappingSize_);
+        pMapping_ = nullptr;
+        mappingSize_ = 0;
+    }
+}
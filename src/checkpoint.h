@@ -0,0 +1,146 @@
+/**
+ * @file checkpoint.h
+ *
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/// the kinds of runtime state stored in a `Checkpoint`
+enum class CheckpointSection : std::uint32_t
+{
+    DTC_STORE = 1, ///< see `DtcStore::serialize()`
+    DID_STORE = 2, ///< see `DidStore::serialize()`
+    SESSION = 3, ///< the active UDS session
+    SEQUENCES = 4, ///< the positions of the response lists, see `ResponseSequence`
+    LUA_GLOBALS = 5, ///< the globals of the `Checkpoint` field, as Lua chunk
+    J1939_PHASES = 6 ///< the time until the next transmission of the cyclic PGNs
+};
+
+/**
+ * Appends the fields of a checkpoint section to a buffer, in the byte order
+ * of the host.
+ */
+class CheckpointEncoder
+{
+public:
+    explicit CheckpointEncoder(std::string& data) noexcept : data_(data) { }
+
+    template<typename T>
+    void put(T value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values are encoded");
+        data_.append(reinterpret_cast<const char*> (&value), sizeof(value));
+    }
+
+    /// appends the length (uint32) and the bytes
+    void putBytes(const void* data, std::size_t length)
+    {
+        put(std::uint32_t(length));
+        data_.append(static_cast<const char*> (data), length);
+    }
+
+    void putString(std::string_view text) { putBytes(text.data(), text.size()); }
+
+private:
+    std::string& data_;
+};
+
+/**
+ * Reads the fields written by a `CheckpointEncoder`. A read past the end
+ * fails and leaves the value unchanged.
+ */
+class CheckpointDecoder
+{
+public:
+    explicit CheckpointDecoder(std::string_view data) noexcept : data_(data) { }
+
+    template<typename T>
+    bool get(T& value) noexcept
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values are decoded");
+        if (data_.size() < sizeof(value))
+        {
+            return false;
+        }
+        std::memcpy(&value, data_.data(), sizeof(value));
+        data_.remove_prefix(sizeof(value));
+        return true;
+    }
+
+    /// @param bytes: set to the bytes within the data of the decoder
+    bool getBytes(std::string_view& bytes) noexcept
+    {
+        std::uint32_t length;
+        if (!get(length) || data_.size() < length)
+        {
+            return false;
+        }
+        bytes = data_.substr(0, length);
+        data_.remove_prefix(length);
+        return true;
+    }
+
+    bool isAtEnd() const noexcept { return data_.empty(); }
+
+private:
+    std::string_view data_;
+};
+
+/**
+ * A snapshot of the runtime state of the simulation: the fault memories,
+ * the written DIDs, the sessions, the positions of the response lists,
+ * selected Lua globals and the phases of the cyclic PGNs, see
+ * `EcuLuaScript::saveCheckpoint()`.
+ *
+ * The state is stored in sections, each owned by a configuration (the path
+ * of its Lua script). A checkpoint is either built by `add()` and written to
+ * a file, or loaded from a file by `load()`, which maps the file read-only:
+ * the sections point into the mapping, nothing is copied until a store is
+ * restored from it. So a test can restore a prepared state in a few
+ * milliseconds instead of driving the simulation into it.
+ *
+ * The fields are stored in the byte order of the host, a checkpoint is only
+ * meant for the simulator that wrote it (or one on the same platform).
+ */
+class Checkpoint
+{
+public:
+    Checkpoint() = default;
+    Checkpoint(const Checkpoint& orig) = delete;
+    Checkpoint& operator =(const Checkpoint& orig) = delete;
+    virtual ~Checkpoint();
+
+    void add(CheckpointSection section, const std::string& owner, std::string data);
+    int write(const std::string& file) const noexcept;
+    int load(const std::string& file) noexcept;
+    std::optional<std::string_view> find(CheckpointSection section, std::string_view owner) const noexcept;
+    std::size_t size() const noexcept { return sections_.size(); }
+
+private:
+    struct Section
+    {
+        CheckpointSection section;
+        std::string_view owner;
+        std::string_view data;
+    };
+
+    std::vector<Section> sections_;
+    std::deque<std::string> buffers_; ///< the owners and data of `add()`, a deque keeps them in place
+    void* pMapping_ = nullptr; ///< the file of `load()`
+    std::size_t mappingSize_ = 0;
+
+    void clear() noexcept;
+};
+
+#endif /* CHECKPOINT_H */
@@ -0,0 +1,97 @@
+/**
+ * @file communication_gate.cpp
+ *
+ * The communication state of an ECU, see `CommunicationGate`.
+ */
+
+#include "communication_gate.h"
+
+using namespace std;
+
+/// the communicationType bits of the message types, the subnet number is ignored
+static constexpr uint8_t MESSAGE_TYPES = CommunicationGate::NORMAL_MESSAGES
+    | CommunicationGate::NETWORK_MANAGEMENT_MESSAGES;
+
+/**
+ * Enables or disables the reception and transmission of the given
+ * communication types, the other types keep their state.
+ *
+ * @param controlType: the control type of `CommunicationControl` (0x00 - 0x03)
+ * @param communicationType: the communication types (bits 0 and 1), 0 is ignored
+ * @return false if the control type is not supported
+ */
+bool CommunicationGate::setControl(uint8_t controlType, uint8_t communicationType)
+{
+    if (controlType > DISABLE_RX_AND_TX)
+    {
+        return false;
+    }
+    const uint8_t types = communicationType & MESSAGE_TYPES;
+    lock_guard<mutex> lock(mutex_);
+    const bool wasTransmitEnabled = isTransmitEnabled();
+    const bool isTxDisabled = controlType == ENABLE_RX_AND_DISABLE_TX || controlType == DISABLE_RX_AND_TX;
+    const bool isRxDisabled = controlType == DISABLE_RX_AND_ENABLE_TX || controlType == DISABLE_RX_AND_TX;
+    txDisabled_ = isTxDisabled ? txDisabled_ | types : txDisabled_ & ~types;
+    rxDisabled_ = isRxDisabled ? rxDisabled_ | types : rxDisabled_ & ~types;
+    controlType_ = controlType;
+    communicationType_ = communicationType;
+    notifyListeners(wasTransmitEnabled);
+    return true;
+}
+
+/**
+ * Enables the communication again, e.g. after an `ECUReset`.
+ */
+void CommunicationGate::reset()
+{
+    lock_guard<mutex> lock(mutex_);
+    const bool wasTransmitEnabled = isTransmitEnabled();
+    txDisabled_ = 0;
+    rxDisabled_ = 0;
+    controlType_ = ENABLE_RX_AND_TX;
+    communicationType_ = 0x00;
+    notifyListeners(wasTransmitEnabled);
+}
+
+/**
+ * Registers a listener, which is called when the transmission of the normal
+ * messages is disabled or enabled. It is called on the thread changing the
+ * state and must not change it itself.
+ *
+ * @param listener: the listener
+ * @return the ID for `removeListener()`
+ */
+int CommunicationGate::addListener(Listener listener)
+{
+    lock_guard<mutex> lock(mutex_);
+    listeners_[nextListenerId_] = move(listener);
+    return nextListenerId_++;
+}
+
+/**
+ * Removes a listener. It is not called anymore after returning.
+ *
+ * @param id: the ID returned by `addListener()`
+ */
+void CommunicationGate::removeListener(int id)
+{
+    lock_guard<mutex> lock(mutex_);
+    listeners_.erase(id);
+}
+
+/**
+ * Calls the listeners if the transmission of the normal messages changed.
+ * The lock must be held.
+ */
+void CommunicationGate::notifyListeners(bool wasTransmitEnabled)
+{
+    const bool isEnabled = isTransmitEnabled();
+    if (isEnabled == wasTransmitEnabled)
+    {
+        return;
+    }
+    for (const auto& listener : listeners_)
+    {
+        listener.second(isEnabled);
+    }
+}
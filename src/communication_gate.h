@@ -0,0 +1,88 @@
+/**
+ * @file communication_gate.h
+ *
+ */
+
+#ifndef COMMUNICATION_GATE_H
+#define COMMUNICATION_GATE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+
+/**
+ * The communication state of an ECU set by `CommunicationControl` (0x28),
+ * shared by the UDS transports and the simulations sending cyclic traffic,
+ * e.g. before flashing a tester disables the normal messages of all ECUs with
+ * a functional request to free the bus.
+ *
+ * The state is kept in atomic bit masks of the communication types (see
+ * `NORMAL_MESSAGES` and `NETWORK_MANAGEMENT_MESSAGES`), so the senders check
+ * it per batch without a lock: the `J1939CyclicScheduler` via
+ * `J1939Simulator::isBusActive()`. Senders which hand their frames over to the
+ * kernel (`CAN_BCM`) register a listener instead, which is called when the
+ * transmission of the normal messages is disabled or enabled.
+ */
+class CommunicationGate
+{
+public:
+    /// communicationType bit of the normal communication messages
+    static constexpr std::uint8_t NORMAL_MESSAGES = 0x01;
+    /// communicationType bit of the network management messages
+    static constexpr std::uint8_t NETWORK_MANAGEMENT_MESSAGES = 0x02;
+    static constexpr std::uint8_t ENABLE_RX_AND_TX = 0x00;
+    static constexpr std::uint8_t ENABLE_RX_AND_DISABLE_TX = 0x01;
+    static constexpr std::uint8_t DISABLE_RX_AND_ENABLE_TX = 0x02;
+    static constexpr std::uint8_t DISABLE_RX_AND_TX = 0x03;
+
+    /// called with the new state of the normal messages, see `addListener()`
+    using Listener = std::function<void(bool isTransmitEnabled)>;
+
+    CommunicationGate() = default;
+    CommunicationGate(const CommunicationGate& orig) = delete;
+    CommunicationGate& operator =(const CommunicationGate& orig) = delete;
+    virtual ~CommunicationGate() = default;
+
+    bool setControl(std::uint8_t controlType, std::uint8_t communicationType);
+    void reset();
+
+    /**
+     * @param communicationType: the communication types, see `NORMAL_MESSAGES`
+     * @return false if the transmission of one of the types is disabled
+     */
+    bool isTransmitEnabled(std::uint8_t communicationType = NORMAL_MESSAGES) const noexcept
+    {
+        return (txDisabled_.load(std::memory_order_relaxed) & communicationType) == 0;
+    }
+
+    /**
+     * @param communicationType: the communication types, see `NORMAL_MESSAGES`
+     * @return false if the reception of one of the types is disabled
+     */
+    bool isReceiveEnabled(std::uint8_t communicationType = NORMAL_MESSAGES) const noexcept
+    {
+        return (rxDisabled_.load(std::memory_order_relaxed) & communicationType) == 0;
+    }
+
+    std::uint8_t getControlType() const noexcept { return controlType_.load(std::memory_order_relaxed); }
+    std::uint8_t getCommunicationType() const noexcept { return communicationType_.load(std::memory_order_relaxed); }
+
+    int addListener(Listener listener);
+    void removeListener(int id);
+
+private:
+    std::atomic<std::uint8_t> txDisabled_{0}; ///< the communication types not sent
+    std::atomic<std::uint8_t> rxDisabled_{0}; ///< the communication types not received
+    std::atomic<std::uint8_t> controlType_{ENABLE_RX_AND_TX}; ///< of the last request
+    std::atomic<std::uint8_t> communicationType_{0x00}; ///< of the last request
+    /// serializes the changes, so the listeners are called in order
+    std::mutex mutex_;
+    std::map<int, Listener> listeners_;
+    int nextListenerId_ = 0;
+
+    void notifyListeners(bool wasTransmitEnabled);
+};
+
+#endif /* COMMUNICATION_GATE_H */
@@ -0,0 +1,713 @@
+/**
+ * @file compiled_request_matcher.h
+ *
+ * Read-only, flat representation of a `RequestByteTreeNode` tree which is used
+ * for the request lookups at runtime.
+ */
+
+#ifndef COMPILED_REQUEST_MATCHER_H
+#define COMPILED_REQUEST_MATCHER_H
+
+#include "request_byte_tree_node.h"
+#include "request_hit_counters.h"
+#include "request_response.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define REQUEST_MATCHER_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define REQUEST_MATCHER_NEON
+#endif
+
+/**
+ * The `RequestByteTreeNode` tree is convenient to build, but walking it means
+ * chasing `shared_ptr`s, `std::map` lookups and filling a `std::set` per
+ * request byte. Once all requests of a simulation are added, the tree never
+ * changes again, so it gets "frozen" into this matcher:
+ *
+ * - all nodes are stored in one contiguous vector in breadth-first order,
+ *   child links are plain indices into that vector
+ * - the byte edges of a node are a sorted (byte, index) array, nodes with many
+ *   children get a dense table with 256 entries instead
+ * - placeholder and wildcard children are stored as indices as well
+ * - the byte patterns of a node (e.g. "3X" or "[F1-F3]") are stored in blocks
+ *   of 16, as one array per field, so a byte is compared with all patterns
+ *   of a block at once with SSE2 or NEON
+ * - the responses are stored in a separate vector, referenced by the leaves.
+ *   The vector is sorted by `RequestByteTreeNode::getPriority()`, so the index
+ *   of a response is its rank and the best match is the smallest index.
+ * - a node without response refers to the response of its wildcard child, as
+ *   a wildcard also matches 0 bytes
+ *
+ * A lookup works on the raw request bytes and does not allocate any memory
+ * (the scratch buffers are kept per thread). The best matching request is
+ * kept as a running minimum of the ranks, so it is deterministic and the
+ * same as the one of `EcuLuaScript::findBestMatchingRequest()`.
+ *
+ * `match()` counts the hits of the responses in `getHitCounters()`, which
+ * shows the entries of a table that are never used. Since usually a few
+ * requests make up most of the traffic, `relayout()` moves the nodes of the
+ * hit requests to the front of the arrays, so their lookups touch a few
+ * cache lines instead of ones scattered over the whole table.
+ *
+ * The nodes only depend on the requests, not on the responses, so a table
+ * of which only responses changed gets a matcher with the same nodes by
+ * `withLeaves()`, without building the tree again.
+ *
+ * The matcher is immutable after construction (except for the hit counters
+ * and `relayout()`), so it can be used from several threads at the same
+ * time, e.g. by `matchRequests()` to replay a trace. Copies share the node
+ * arrays, which are either owned by the matcher or memory-mapped from a
+ * `RequestSnapshot`, and the hit counters.
+ */
+template<class T>
+class CompiledRequestMatcher {
+	friend class RequestSnapshot;
+
+public:
+	CompiledRequestMatcher() = default;
+	explicit CompiledRequestMatcher(const shared_ptr<RequestByteTreeNode<T>> &requestByteTree);
+
+	/// the result of `matchRequest()`
+	struct MatchResult {
+		const T *response = nullptr; ///< `nullptr` if no request matches
+		uint32_t rank = numeric_limits<uint32_t>::max(); ///< the index of the response, see `getLeaf()`
+		bool isWildcard = false; ///< the matching request ends with a wildcard
+		/// another request matches with the same priority except for the definition order
+		bool isAmbiguous = false;
+	};
+
+	const T *match(const uint8_t *request, size_t requestLength, bool *pIsWildcard = nullptr) const;
+	MatchResult matchRequest(const uint8_t *request, size_t requestLength) const;
+	vector<MatchResult> matchRequests(const vector<vector<uint8_t>> &requests, ThreadPool &threadPool) const;
+
+	inline const T &getLeaf(size_t rank) const {
+		return leaves_[rank];
+	}
+
+	inline bool empty() const {
+		return leaves_.empty();
+	}
+
+	inline size_t getNodeCount() const {
+		return nodeCount_;
+	}
+
+	inline size_t getLeafCount() const {
+		return leaves_.size();
+	}
+
+	/// the hits of the responses by rank, `nullptr` for an empty matcher
+	inline const shared_ptr<RequestHitCounters> &getHitCounters() const {
+		return pHits_;
+	}
+
+	void relayout();
+	CompiledRequestMatcher withLeaves(vector<T> leaves) const;
+
+private:
+	static constexpr uint32_t NO_NODE = numeric_limits<uint32_t>::max();
+
+	/**
+	 * Nodes with more byte edges than this get a dense 256 entry table,
+	 * smaller ones are scanned linearly.
+	 */
+	static constexpr size_t DENSE_THRESHOLD = 16;
+
+	struct Node {
+		uint32_t firstEdge = 0; ///< offset into `edges_` or `denseEdges_`
+		uint32_t edgeCount = 0;
+		uint32_t placeholder = NO_NODE;
+		uint32_t wildcardChild = NO_NODE;
+		uint32_t leaf = NO_NODE; ///< index into `leaves_`, the own or the one of the wildcard child
+		uint32_t firstPatternBlock = 0; ///< offset into `patternBlocks_`
+		uint32_t patternBlockCount = 0;
+		bool dense = false;
+		bool wildcard = false;
+		bool leafIsWildcard = false; ///< the leaf belongs to a request with wildcard
+	};
+
+	struct Edge {
+		uint8_t byte;
+		uint32_t node;
+	};
+
+	/// the number of patterns of a `PatternBlock`
+	static constexpr size_t PATTERN_BLOCK_SIZE = 16;
+
+	/**
+	 * Up to 16 byte patterns of a node, see `RequestBytePattern`. Unused
+	 * entries have mask 0 and value 1, so they never match.
+	 */
+	struct PatternBlock {
+		uint8_t values[PATTERN_BLOCK_SIZE];
+		uint8_t masks[PATTERN_BLOCK_SIZE];
+		uint8_t lows[PATTERN_BLOCK_SIZE];
+		uint8_t highs[PATTERN_BLOCK_SIZE];
+		uint32_t nodes[PATTERN_BLOCK_SIZE];
+	};
+
+	/// the arrays of a matcher compiled from a tree
+	struct Storage {
+		vector<Node> nodes;
+		vector<Edge> edges;
+		vector<uint32_t> denseEdges;
+		vector<PatternBlock> patternBlocks;
+	};
+
+	const Node *nodes_ = nullptr;
+	size_t nodeCount_ = 0;
+	const Edge *edges_ = nullptr;
+	size_t edgeCount_ = 0;
+	const uint32_t *denseEdges_ = nullptr;
+	size_t denseEdgeCount_ = 0;
+	const PatternBlock *patternBlocks_ = nullptr;
+	size_t patternBlockCount_ = 0;
+	vector<T> leaves_;
+	/// the priorities of `leaves_`, see `RequestByteTreeNode::getPriority()`
+	vector<uint64_t> leafPriorities_;
+	/// keeps the arrays alive, a `Storage` or the mapping of a snapshot
+	shared_ptr<const void> pStorage_;
+	/// counted by `match()`, shared by the copies
+	shared_ptr<RequestHitCounters> pHits_;
+
+	uint32_t findSubsequentByte(const Node &node, uint8_t requestByte) const;
+	void addMatchingPatterns(const Node &node, uint8_t requestByte, vector<uint32_t> &matchingNodes) const;
+	static uint32_t matchPatternBlock(const PatternBlock &block, uint8_t requestByte);
+	const vector<uint32_t> &findMatchingNodes(const uint8_t *request, size_t requestLength) const;
+	template<class F>
+	void forEachChild(const Node &node, F function) const;
+};
+
+/**
+ * Freezes the given request byte tree. The tree itself is not modified.
+ *
+ * @param requestByteTree: the root of the tree to compile
+ */
+template<class T>
+CompiledRequestMatcher<T>::CompiledRequestMatcher(const shared_ptr<RequestByteTreeNode<T>> &requestByteTree) {
+	if(!requestByteTree) {
+		return;
+	}
+
+	auto pStorage = make_shared<Storage>();
+	vector<Node> &nodes = pStorage->nodes;
+	vector<Edge> &edges = pStorage->edges;
+	vector<uint32_t> &denseEdges = pStorage->denseEdges;
+	vector<PatternBlock> &patternBlocks = pStorage->patternBlocks;
+
+	// index i in `pending` is the source of `nodes[i]`
+	vector<RequestByteTreeNode<T>*> pending;
+	auto enqueue = [&nodes, &pending](RequestByteTreeNode<T> *treeNode) -> uint32_t {
+		pending.push_back(treeNode);
+		nodes.emplace_back();
+		return uint32_t(nodes.size() - 1);
+	};
+
+	enqueue(requestByteTree.get());
+	// the wildcard flag is derived from the edge type, the root is never a wildcard
+	vector<bool> reachedByWildcard(1, false);
+	// the responses in tree order with their priority, sorted below
+	vector<pair<uint64_t, uint32_t>> leafPriorities;
+	vector<T> leaves;
+
+	for(size_t i = 0; i < pending.size(); i++) {
+		RequestByteTreeNode<T> *treeNode = pending[i];
+		Node node;
+		node.wildcard = reachedByWildcard[i];
+		node.leafIsWildcard = node.wildcard;
+
+		if(treeNode->getLuaResponse()) {
+			node.leaf = uint32_t(leaves.size());
+			leafPriorities.emplace_back(treeNode->getPriority(), node.leaf);
+			leaves.push_back(*treeNode->getLuaResponse());
+		}
+
+		const auto &subsequentBytes = treeNode->getSubsequentBytes();
+		node.edgeCount = uint32_t(subsequentBytes.size());
+		if(subsequentBytes.size() > DENSE_THRESHOLD) {
+			node.dense = true;
+			node.firstEdge = uint32_t(denseEdges.size());
+			denseEdges.resize(denseEdges.size() + 256, NO_NODE);
+			for(const auto &subsequentByte : subsequentBytes) {
+				const uint32_t child = enqueue(subsequentByte.second);
+				denseEdges[node.firstEdge + subsequentByte.first] = child;
+			}
+		} else {
+			node.firstEdge = uint32_t(edges.size());
+			// the edges of the tree node are sorted by the byte already
+			for(const auto &subsequentByte : subsequentBytes) {
+				const uint32_t child = enqueue(subsequentByte.second);
+				edges.push_back(Edge{subsequentByte.first, child});
+			}
+		}
+
+		const auto &subsequentPatterns = treeNode->getSubsequentPatterns();
+		node.firstPatternBlock = uint32_t(patternBlocks.size());
+		node.patternBlockCount = uint32_t((subsequentPatterns.size() + PATTERN_BLOCK_SIZE - 1) / PATTERN_BLOCK_SIZE);
+		for(size_t p = 0; p < subsequentPatterns.size(); p++) {
+			if(p % PATTERN_BLOCK_SIZE == 0) {
+				PatternBlock block;
+				fill(begin(block.values), end(block.values), uint8_t(1));
+				fill(begin(block.masks), end(block.masks), uint8_t(0));
+				fill(begin(block.lows), end(block.lows), uint8_t(0x00));
+				fill(begin(block.highs), end(block.highs), uint8_t(0xFF));
+				fill(begin(block.nodes), end(block.nodes), NO_NODE);
+				patternBlocks.push_back(block);
+			}
+			const RequestBytePattern &pattern = subsequentPatterns[p].first;
+			const size_t lane = p % PATTERN_BLOCK_SIZE;
+			const uint32_t child = enqueue(subsequentPatterns[p].second);
+			// `enqueue()` does not touch `patternBlocks`, the reference stays valid
+			PatternBlock &block = patternBlocks.back();
+			block.values[lane] = pattern.value;
+			block.masks[lane] = pattern.mask;
+			block.lows[lane] = pattern.low;
+			block.highs[lane] = pattern.high;
+			block.nodes[lane] = child;
+		}
+
+		if(treeNode->getSubsequentPlaceholder()) {
+			node.placeholder = enqueue(treeNode->getSubsequentPlaceholder());
+		}
+		if(treeNode->getSubsequentWildcard()) {
+			node.wildcardChild = enqueue(treeNode->getSubsequentWildcard());
+		}
+		reachedByWildcard.resize(nodes.size(), false);
+		if(node.wildcardChild != NO_NODE) {
+			reachedByWildcard[node.wildcardChild] = true;
+		}
+
+		nodes[i] = node;
+	}
+
+	// rank the responses, the priorities are unique
+	sort(leafPriorities.begin(), leafPriorities.end(),
+	     [](const pair<uint64_t, uint32_t> &a, const pair<uint64_t, uint32_t> &b) { return a.first > b.first; });
+	vector<uint32_t> ranks(leaves.size());
+	leaves_.reserve(leaves.size());
+	leafPriorities_.reserve(leaves.size());
+	for(const auto &leafPriority : leafPriorities) {
+		ranks[leafPriority.second] = uint32_t(leaves_.size());
+		leaves_.push_back(move(leaves[leafPriority.second]));
+		leafPriorities_.push_back(leafPriority.first);
+	}
+	// children come after their parent, so a wildcard child is final when its parent is visited
+	for(size_t i = nodes.size(); i-- > 0;) {
+		Node &node = nodes[i];
+		if(node.leaf != NO_NODE) {
+			node.leaf = ranks[node.leaf];
+		} else if(node.wildcardChild != NO_NODE) {
+			node.leaf = nodes[node.wildcardChild].leaf;
+			node.leafIsWildcard = nodes[node.wildcardChild].leafIsWildcard;
+		}
+	}
+
+	nodes_ = nodes.data();
+	nodeCount_ = nodes.size();
+	edges_ = edges.data();
+	edgeCount_ = edges.size();
+	denseEdges_ = denseEdges.data();
+	denseEdgeCount_ = denseEdges.size();
+	patternBlocks_ = patternBlocks.data();
+	patternBlockCount_ = patternBlocks.size();
+	pStorage_ = move(pStorage);
+	pHits_ = make_shared<RequestHitCounters>(leaves_.size());
+}
+
+/**
+ * Finds the response of the request that matches the given bytes best and
+ * counts a hit of it.
+ *
+ * @param request: the received request
+ * @param requestLength: the number of bytes in `request`
+ * @param pIsWildcard: optional, set to true if the matching request ends with
+ *                     a wildcard
+ * @return pointer to the response or `nullptr` if no request matches
+ */
+template<class T>
+const T *CompiledRequestMatcher<T>::match(const uint8_t *request, size_t requestLength, bool *pIsWildcard) const {
+	if(pIsWildcard) {
+		*pIsWildcard = false;
+	}
+
+	// NO_NODE is larger than every rank, so nodes without response never win
+	const Node *bestMatchingNode = nullptr;
+	uint32_t bestLeaf = NO_NODE;
+	for(const uint32_t nodeIndex : findMatchingNodes(request, requestLength)) {
+		const Node &candidate = nodes_[nodeIndex];
+		if(candidate.leaf < bestLeaf) {
+			bestLeaf = candidate.leaf;
+			bestMatchingNode = &candidate;
+		}
+	}
+	if(!bestMatchingNode) {
+		return nullptr;
+	}
+	if(pIsWildcard) {
+		*pIsWildcard = bestMatchingNode->leafIsWildcard;
+	}
+	pHits_->hit(bestLeaf);
+	return &leaves_[bestLeaf];
+}
+
+/**
+ * Like `match()`, but also reports the rank of the response and whether the
+ * best match was only decided by the definition order of the requests.
+ *
+ * @param request: the request
+ * @param requestLength: the number of bytes in `request`
+ * @return the best match, without response if no request matches
+ */
+template<class T>
+typename CompiledRequestMatcher<T>::MatchResult CompiledRequestMatcher<T>::matchRequest(const uint8_t *request, size_t requestLength) const {
+	MatchResult result;
+	const vector<uint32_t> &matchingNodes = findMatchingNodes(request, requestLength);
+	for(const uint32_t nodeIndex : matchingNodes) {
+		const Node &candidate = nodes_[nodeIndex];
+		if(candidate.leaf < result.rank) {
+			result.rank = candidate.leaf;
+			result.isWildcard = candidate.leafIsWildcard;
+		}
+	}
+	if(result.rank == NO_NODE) {
+		return result;
+	}
+	result.response = &leaves_[result.rank];
+
+	const uint64_t tie = leafPriorities_[result.rank] >> RequestByteTreeNode<T>::DEFINITION_ORDER_BITS;
+	for(const uint32_t nodeIndex : matchingNodes) {
+		const uint32_t leaf = nodes_[nodeIndex].leaf;
+		if(leaf != NO_NODE && leaf != result.rank
+		   && (leafPriorities_[leaf] >> RequestByteTreeNode<T>::DEFINITION_ORDER_BITS) == tie) {
+			result.isAmbiguous = true;
+			break;
+		}
+	}
+	return result;
+}
+
+/**
+ * Matches many requests at once, e.g. the requests of a recorded trace. The
+ * requests are split into one chunk per thread of the pool.
+ *
+ * @param requests: the requests to match
+ * @param threadPool: the threads to use, must not be busy with other tasks
+ *                    since the call waits for the pool to be idle
+ * @return the results in the order of `requests`
+ */
+template<class T>
+vector<typename CompiledRequestMatcher<T>::MatchResult> CompiledRequestMatcher<T>::matchRequests(
+	const vector<vector<uint8_t>> &requests, ThreadPool &threadPool) const {
+
+	vector<MatchResult> results(requests.size());
+	const size_t chunkCount = threadPool.getThreadCount();
+	const size_t chunkSize = (requests.size() + chunkCount - 1) / chunkCount;
+	for(size_t begin = 0; begin < requests.size(); begin += chunkSize) {
+		const size_t end = min(begin + chunkSize, requests.size());
+		threadPool.submit([this, &requests, &results, begin, end]() {
+			for(size_t i = begin; i < end; i++) {
+				results[i] = matchRequest(requests[i].data(), requests[i].size());
+			}
+		});
+	}
+	threadPool.wait();
+	return results;
+}
+
+/**
+ * Returns a matcher with the nodes of this one and other responses, e.g. for
+ * a changed table with the same requests. The copy shares the node arrays
+ * and gets hit counters of its own.
+ *
+ * @param leaves: the new responses in the order of `getLeaf()`, as many as
+ *                this matcher has, i.e. the response of rank i replaces the
+ *                one of the same request
+ */
+template<class T>
+CompiledRequestMatcher<T> CompiledRequestMatcher<T>::withLeaves(vector<T> leaves) const {
+	CompiledRequestMatcher<T> matcher;
+	matcher.nodes_ = nodes_;
+	matcher.nodeCount_ = nodeCount_;
+	matcher.edges_ = edges_;
+	matcher.edgeCount_ = edgeCount_;
+	matcher.denseEdges_ = denseEdges_;
+	matcher.denseEdgeCount_ = denseEdgeCount_;
+	matcher.patternBlocks_ = patternBlocks_;
+	matcher.patternBlockCount_ = patternBlockCount_;
+	matcher.leaves_ = move(leaves);
+	matcher.leafPriorities_ = leafPriorities_;
+	matcher.pStorage_ = pStorage_;
+	matcher.pHits_ = make_shared<RequestHitCounters>(matcher.leaves_.size());
+	return matcher;
+}
+
+/**
+ * Orders the nodes by the hits counted so far: the nodes leading to hit
+ * responses come first, breadth-first with the most hit children first,
+ * followed by all other nodes in their previous order. The edges and
+ * patterns are ordered like their nodes. The matches stay the same.
+ *
+ * Builds new arrays, also for a memory-mapped snapshot. Must not be called
+ * while another thread uses the matcher or a copy of it, e.g. before a
+ * reloaded table is published.
+ */
+template<class T>
+void CompiledRequestMatcher<T>::relayout() {
+	if(nodeCount_ == 0) {
+		return;
+	}
+
+	// the hits of a subtree, summed up from the leaves in reverse depth-first order
+	vector<uint32_t> depthFirst;
+	depthFirst.reserve(nodeCount_);
+	vector<uint32_t> stack(1, 0);
+	while(!stack.empty()) {
+		const uint32_t nodeIndex = stack.back();
+		stack.pop_back();
+		depthFirst.push_back(nodeIndex);
+		forEachChild(nodes_[nodeIndex], [&stack](uint32_t child) { stack.push_back(child); });
+	}
+	vector<uint64_t> heat(nodeCount_, 0);
+	for(size_t i = depthFirst.size(); i-- > 0;) {
+		const Node &node = nodes_[depthFirst[i]];
+		uint64_t &nodeHeat = heat[depthFirst[i]];
+		// a leaf taken over from the wildcard child is counted there
+		const bool hasOwnLeaf = node.leaf != NO_NODE
+			&& (node.wildcardChild == NO_NODE || nodes_[node.wildcardChild].leaf != node.leaf);
+		if(hasOwnLeaf) {
+			nodeHeat += pHits_->get(node.leaf);
+		}
+		forEachChild(node, [&heat, &nodeHeat](uint32_t child) { nodeHeat += heat[child]; });
+	}
+	if(heat[0] == 0) {
+		return;
+	}
+
+	vector<uint32_t> order(1, 0);
+	order.reserve(nodeCount_);
+	vector<uint32_t> newIndices(nodeCount_, NO_NODE);
+	newIndices[0] = 0;
+	vector<uint32_t> hotChildren;
+	for(size_t i = 0; i < order.size(); i++) {
+		hotChildren.clear();
+		forEachChild(nodes_[order[i]], [&heat, &hotChildren](uint32_t child) {
+			if(heat[child] != 0) {
+				hotChildren.push_back(child);
+			}
+		});
+		stable_sort(hotChildren.begin(), hotChildren.end(),
+		            [&heat](uint32_t a, uint32_t b) { return heat[a] > heat[b]; });
+		for(const uint32_t child : hotChildren) {
+			newIndices[child] = uint32_t(order.size());
+			order.push_back(child);
+		}
+	}
+	for(uint32_t nodeIndex = 0; nodeIndex < nodeCount_; nodeIndex++) {
+		if(newIndices[nodeIndex] == NO_NODE) {
+			newIndices[nodeIndex] = uint32_t(order.size());
+			order.push_back(nodeIndex);
+		}
+	}
+
+	auto pStorage = make_shared<Storage>();
+	pStorage->nodes.reserve(nodeCount_);
+	pStorage->edges.reserve(edgeCount_);
+	pStorage->denseEdges.reserve(denseEdgeCount_);
+	pStorage->patternBlocks.reserve(patternBlockCount_);
+	auto remap = [&newIndices](uint32_t nodeIndex) {
+		return nodeIndex == NO_NODE ? NO_NODE : newIndices[nodeIndex];
+	};
+	for(const uint32_t nodeIndex : order) {
+		Node node = nodes_[nodeIndex];
+		if(node.dense) {
+			const uint32_t firstEdge = uint32_t(pStorage->denseEdges.size());
+			for(size_t byte = 0; byte < 256; byte++) {
+				pStorage->denseEdges.push_back(remap(denseEdges_[node.firstEdge + byte]));
+			}
+			node.firstEdge = firstEdge;
+		} else {
+			const uint32_t firstEdge = uint32_t(pStorage->edges.size());
+			for(const Edge *edge = edges_ + node.firstEdge; edge != edges_ + node.firstEdge + node.edgeCount; edge++) {
+				pStorage->edges.push_back(Edge{edge->byte, newIndices[edge->node]});
+			}
+			node.firstEdge = firstEdge;
+		}
+		const uint32_t firstPatternBlock = uint32_t(pStorage->patternBlocks.size());
+		for(uint32_t b = 0; b < node.patternBlockCount; b++) {
+			PatternBlock block = patternBlocks_[node.firstPatternBlock + b];
+			for(uint32_t &child : block.nodes) {
+				child = remap(child);
+			}
+			pStorage->patternBlocks.push_back(block);
+		}
+		node.firstPatternBlock = firstPatternBlock;
+		node.placeholder = remap(node.placeholder);
+		node.wildcardChild = remap(node.wildcardChild);
+		pStorage->nodes.push_back(node);
+	}
+
+	nodes_ = pStorage->nodes.data();
+	edges_ = pStorage->edges.data();
+	denseEdges_ = pStorage->denseEdges.data();
+	patternBlocks_ = pStorage->patternBlocks.data();
+	pStorage_ = move(pStorage);
+}
+
+/**
+ * Calls the function with the index of every child of the node.
+ */
+template<class T>
+template<class F>
+void CompiledRequestMatcher<T>::forEachChild(const Node &node, F function) const {
+	if(node.dense) {
+		for(size_t byte = 0; byte < 256; byte++) {
+			if(denseEdges_[node.firstEdge + byte] != NO_NODE) {
+				function(denseEdges_[node.firstEdge + byte]);
+			}
+		}
+	} else {
+		for(const Edge *edge = edges_ + node.firstEdge; edge != edges_ + node.firstEdge + node.edgeCount; edge++) {
+			function(edge->node);
+		}
+	}
+	for(const PatternBlock *block = patternBlocks_ + node.firstPatternBlock;
+	    block != patternBlocks_ + node.firstPatternBlock + node.patternBlockCount; block++) {
+		for(const uint32_t child : block->nodes) {
+			if(child != NO_NODE) {
+				function(child);
+			}
+		}
+	}
+	if(node.placeholder != NO_NODE) {
+		function(node.placeholder);
+	}
+	if(node.wildcardChild != NO_NODE) {
+		function(node.wildcardChild);
+	}
+}
+
+/**
+ * Walks the nodes along the given request.
+ *
+ * @return the nodes matching the whole request, valid until the next call
+ *         from the same thread
+ */
+template<class T>
+const vector<uint32_t> &CompiledRequestMatcher<T>::findMatchingNodes(const uint8_t *request, size_t requestLength) const {
+	// Every node except the wildcards is only reachable at exactly one request
+	// position, so the sets of potentially matching nodes never contain duplicates.
+	static thread_local vector<uint32_t> potentiallyMatchingNodes;
+	static thread_local vector<uint32_t> matchingNodes;
+	potentiallyMatchingNodes.clear();
+	if(nodeCount_ == 0) {
+		return potentiallyMatchingNodes;
+	}
+	potentiallyMatchingNodes.push_back(0);
+
+	for(size_t i = 0; i < requestLength && !potentiallyMatchingNodes.empty(); i++) {
+		const uint8_t nextByte = request[i];
+		matchingNodes.clear();
+		for(const uint32_t nodeIndex : potentiallyMatchingNodes) {
+			const Node &node = nodes_[nodeIndex];
+			if(node.wildcard) {
+				matchingNodes.push_back(nodeIndex);
+				continue;
+			}
+			const uint32_t subsequentByte = findSubsequentByte(node, nextByte);
+			if(subsequentByte != NO_NODE) {
+				matchingNodes.push_back(subsequentByte);
+			}
+			if(node.patternBlockCount != 0) {
+				addMatchingPatterns(node, nextByte, matchingNodes);
+			}
+			if(node.placeholder != NO_NODE) {
+				matchingNodes.push_back(node.placeholder);
+			}
+			if(node.wildcardChild != NO_NODE) {
+				matchingNodes.push_back(node.wildcardChild);
+			}
+		}
+		potentiallyMatchingNodes.swap(matchingNodes);
+	}
+	return potentiallyMatchingNodes;
+}
+
+template<class T>
+uint32_t CompiledRequestMatcher<T>::findSubsequentByte(const Node &node, uint8_t requestByte) const {
+	if(node.dense) {
+		return denseEdges_[node.firstEdge + requestByte];
+	}
+	const Edge *edge = edges_ + node.firstEdge;
+	const Edge *end = edge + node.edgeCount;
+	for(; edge != end && edge->byte <= requestByte; edge++) {
+		if(edge->byte == requestByte) {
+			return edge->node;
+		}
+	}
+	return NO_NODE;
+}
+
+/**
+ * Adds the children of all patterns of the node that match the given byte.
+ */
+template<class T>
+void CompiledRequestMatcher<T>::addMatchingPatterns(const Node &node, uint8_t requestByte, vector<uint32_t> &matchingNodes) const {
+	const PatternBlock *block = patternBlocks_ + node.firstPatternBlock;
+	const PatternBlock *end = block + node.patternBlockCount;
+	for(; block != end; block++) {
+		for(uint32_t matches = matchPatternBlock(*block, requestByte); matches != 0; matches &= matches - 1) {
+			matchingNodes.push_back(block->nodes[__builtin_ctz(matches)]);
+		}
+	}
+}
+
+/**
+ * @return a bit per pattern of the block, set if the pattern matches the byte
+ */
+template<class T>
+uint32_t CompiledRequestMatcher<T>::matchPatternBlock(const PatternBlock &block, uint8_t requestByte) {
+#if defined(REQUEST_MATCHER_SSE2)
+	const __m128i bytes = _mm_set1_epi8(char(requestByte));
+	const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block.values));
+	const __m128i masks = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block.masks));
+	const __m128i lows = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block.lows));
+	const __m128i highs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block.highs));
+	// SSE2 has no unsigned byte compare: low <= byte <=> max(byte, low) == byte
+	const __m128i isMasked = _mm_cmpeq_epi8(_mm_and_si128(bytes, masks), values);
+	const __m128i isAboveLow = _mm_cmpeq_epi8(_mm_max_epu8(bytes, lows), bytes);
+	const __m128i isBelowHigh = _mm_cmpeq_epi8(_mm_min_epu8(bytes, highs), bytes);
+	return uint32_t(_mm_movemask_epi8(_mm_and_si128(isMasked, _mm_and_si128(isAboveLow, isBelowHigh))));
+#elif defined(REQUEST_MATCHER_NEON)
+	const uint8x16_t bytes = vdupq_n_u8(requestByte);
+	const uint8x16_t matches = vandq_u8(vceqq_u8(vandq_u8(bytes, vld1q_u8(block.masks)), vld1q_u8(block.values)),
+	                                    vandq_u8(vcgeq_u8(bytes, vld1q_u8(block.lows)), vcleq_u8(bytes, vld1q_u8(block.highs))));
+	// NEON has no movemask, weight the lanes by their bit and add them per half
+	static const uint8_t LANE_BITS[PATTERN_BLOCK_SIZE] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+	const uint8x16_t bits = vandq_u8(matches, vld1q_u8(LANE_BITS));
+	const uint64x2_t sums = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(bits)));
+	return uint32_t(vgetq_lane_u64(sums, 0)) | (uint32_t(vgetq_lane_u64(sums, 1)) << 8);
+#else
+	uint32_t matches = 0;
+	for(size_t lane = 0; lane < PATTERN_BLOCK_SIZE; lane++) {
+		const RequestBytePattern pattern{block.values[lane], block.masks[lane], block.lows[lane], block.highs[lane]};
+		if(pattern.matches(requestByte)) {
+			matches |= 1u << lane;
+		}
+	}
+	return matches;
+#endif
+}
+
+/// Frozen request byte tree with the entries of the `Raw` or `PGNs` table.
+using LuaRequestMatcher = CompiledRequestMatcher<RequestResponse>;
+
+#endif /* COMPILED_REQUEST_MATCHER_H */
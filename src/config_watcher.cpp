@@ -0,0 +1,144 @@
+/**
+ * @file config_watcher.cpp
+ *
+ */
+
+#include "config_watcher.h"
+#include "logger.h"
+#include "utilities.h"
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <set>
+
+using namespace std;
+
+constexpr chrono::milliseconds ConfigWatcher::SETTLE_TIME;
+
+/**
+ * Destructor. Stops the watcher.
+ */
+ConfigWatcher::~ConfigWatcher()
+{
+    stop();
+}
+
+/**
+ * Starts watching the given directory.
+ *
+ * @param directory: the directory of the Lua configurations
+ * @param onChanged: called with the file name (without the directory) of
+ *                   every changed `.lua` file
+ * @return 0 on success, otherwise a negative value
+ */
+int ConfigWatcher::start(const string& directory, function<void(const string& file)> onChanged) noexcept
+{
+    if (isRunning_)
+    {
+        return -1;
+    }
+
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd_ < 0)
+    {
+        LOG_ERROR(__func__ << "() inotify_init1: " << strerror(errno));
+        return -2;
+    }
+    // IN_MOVED_TO: editors replacing the file by a renamed temporary file
+    if (inotify_add_watch(inotify_fd_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        LOG_ERROR(__func__ << "() inotify_add_watch " << directory << ": " << strerror(errno));
+        close(inotify_fd_);
+        inotify_fd_ = -1;
+        return -3;
+    }
+    stop_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (stop_fd_ < 0)
+    {
+        LOG_ERROR(__func__ << "() eventfd: " << strerror(errno));
+        close(inotify_fd_);
+        inotify_fd_ = -1;
+        return -4;
+    }
+
+    onChanged_ = move(onChanged);
+    isRunning_ = true;
+    watcherThread_ = thread(&ConfigWatcher::watch, this);
+    LOG_INFO("Watching " << directory << " for changed configurations");
+    return 0;
+}
+
+/**
+ * Stops the watcher and waits for the running callback.
+ */
+void ConfigWatcher::stop() noexcept
+{
+    if (!isRunning_.exchange(false))
+    {
+        return;
+    }
+    const uint64_t one = 1;
+    if (write(stop_fd_, &one, sizeof(one)) < 0)
+    {
+        LOG_WARNING(__func__ << "() write: " << strerror(errno));
+    }
+    if (watcherThread_.joinable())
+    {
+        watcherThread_.join();
+    }
+    close(inotify_fd_);
+    close(stop_fd_);
+    inotify_fd_ = -1;
+    stop_fd_ = -1;
+}
+
+void ConfigWatcher::watch() noexcept
+{
+    // inotify events are aligned, so the buffer has to be aligned as well
+    alignas(inotify_event) char buffer[4096];
+    set<string> changedFiles;
+    pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {stop_fd_, POLLIN, 0}};
+
+    while (isRunning_)
+    {
+        // wait forever for the first change, then until the directory is quiet
+        const int timeout = changedFiles.empty() ? -1 : int(SETTLE_TIME.count());
+        const int ready = poll(fds, 2, timeout);
+        if (ready < 0 && errno != EINTR)
+        {
+            LOG_ERROR(__func__ << "() poll: " << strerror(errno));
+            return;
+        }
+        if (fds[1].revents != 0)
+        {
+            return;
+        }
+        if (ready == 0)
+        {
+            for (const string& file : changedFiles)
+            {
+                onChanged_(file);
+            }
+            changedFiles.clear();
+            continue;
+        }
+
+        ssize_t length;
+        while ((length = read(inotify_fd_, buffer, sizeof(buffer))) > 0)
+        {
+            for (char* p = buffer; p < buffer + length;)
+            {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+                if (event->len > 0 && utils::endsWith(event->name, ".lua"))
+                {
+                    changedFiles.insert(event->name);
+                }
+                p += sizeof(inotify_event) + event->len;
+            }
+        }
+    }
+}
@@ -0,0 +1,46 @@
+/**
+ * @file config_watcher.h
+ *
+ */
+
+#ifndef CONFIG_WATCHER_H
+#define CONFIG_WATCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+
+/**
+ * Watches the Lua config directory with inotify and reports the changed
+ * `.lua` files to a callback, which is called by the thread of the watcher.
+ *
+ * Editors write a file in several steps (or write a temporary file and rename
+ * it), so the changes are collected until the directory is quiet for
+ * `SETTLE_TIME` and every file is reported once.
+ */
+class ConfigWatcher
+{
+public:
+    static constexpr std::chrono::milliseconds SETTLE_TIME{200};
+
+    ConfigWatcher() = default;
+    ConfigWatcher(const ConfigWatcher& orig) = delete;
+    ConfigWatcher& operator =(const ConfigWatcher& orig) = delete;
+    virtual ~ConfigWatcher();
+
+    int start(const std::string& directory, std::function<void(const std::string& file)> onChanged) noexcept;
+    void stop() noexcept;
+
+private:
+    int inotify_fd_ = -1;
+    int stop_fd_ = -1;
+    std::atomic<bool> isRunning_{false};
+    std::function<void(const std::string& file)> onChanged_;
+    std::thread watcherThread_;
+
+    void watch() noexcept;
+};
+
+#endif /* CONFIG_WATCHER_H */
@@ -0,0 +1,113 @@
+/**
+ * @file crc_stream.cpp
+ *
+ * Incremental CRC calculation on top of libcrc. The used libcrc sources are
+ * compiled with this file.
+ */
+
+#include "crc_stream.h"
+#include "libcrc/crc16.c"
+#include "libcrc/crc32.c"
+#include "libcrc/crcccitt.c"
+
+using namespace std;
+
+/**
+ * @param name: the name used in Lua, e.g. "ccitt_ffff" or "crc32"
+ * @return the algorithm or nothing if the name is unknown
+ */
+optional<CrcAlgorithm> CrcStream::parseAlgorithm(const string& name) noexcept
+{
+    if (name == "ccitt_ffff")
+    {
+        return CrcAlgorithm::CCITT_FFFF;
+    }
+    if (name == "ccitt_1d0f")
+    {
+        return CrcAlgorithm::CCITT_1D0F;
+    }
+    if (name == "xmodem")
+    {
+        return CrcAlgorithm::XMODEM;
+    }
+    if (name == "crc16")
+    {
+        return CrcAlgorithm::CRC16;
+    }
+    if (name == "modbus")
+    {
+        return CrcAlgorithm::MODBUS;
+    }
+    if (name == "crc32")
+    {
+        return CrcAlgorithm::CRC32;
+    }
+    return {};
+}
+
+CrcStream::CrcStream(CrcAlgorithm algorithm) noexcept
+: algorithm_(algorithm)
+{
+    reset();
+}
+
+/**
+ * Adds the next block of the stream.
+ *
+ * @param data: the bytes of the block
+ * @param length: the length of the block in bytes
+ */
+void CrcStream::update(const uint8_t* data, size_t length) noexcept
+{
+    switch (algorithm_)
+    {
+        case CrcAlgorithm::CCITT_FFFF:
+        case CrcAlgorithm::CCITT_1D0F:
+        case CrcAlgorithm::XMODEM:
+            crc_ = update_crc_ccitt_block(uint16_t(crc_), data, length);
+            break;
+        case CrcAlgorithm::CRC16:
+        case CrcAlgorithm::MODBUS:
+            crc_ = update_crc_16_block(uint16_t(crc_), data, length);
+            break;
+        case CrcAlgorithm::CRC32:
+            crc_ = update_crc_32_block(crc_, data, length);
+            break;
+    }
+}
+
+/**
+ * @return the CRC of all blocks so far, the stream can be continued
+ */
+uint32_t CrcStream::getValue() const noexcept
+{
+    return algorithm_ == CrcAlgorithm::CRC32 ? finalize_crc_32(crc_) : crc_;
+}
+
+/**
+ * Starts a new stream with the same algorithm.
+ */
+void CrcStream::reset() noexcept
+{
+    switch (algorithm_)
+    {
+        case CrcAlgorithm::CCITT_FFFF:
+            crc_ = CRC_START_CCITT_FFFF;
+            break;
+        case CrcAlgorithm::CCITT_1D0F:
+            crc_ = CRC_START_CCITT_1D0F;
+            break;
+        case CrcAlgorithm::XMODEM:
+            crc_ = CRC_START_XMODEM;
+            break;
+        case CrcAlgorithm::CRC16:
+            crc_ = CRC_START_16;
+            break;
+        case CrcAlgorithm::MODBUS:
+            crc_ = CRC_START_MODBUS;
+            break;
+        case CrcAlgorithm::CRC32:
+            crc_ = CRC_START_32;
+            break;
+    }
+}
@@ -0,0 +1,54 @@
+/**
+ * @file crc_stream.h
+ *
+ */
+
+#ifndef CRC_STREAM_H
+#define CRC_STREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+/**
+ * The CRC variants of libcrc, which can be calculated incrementally.
+ */
+enum class CrcAlgorithm
+{
+    CCITT_FFFF, ///< as used by `createHash()`
+    CCITT_1D0F,
+    XMODEM,
+    CRC16,
+    MODBUS,
+    CRC32
+};
+
+/**
+ * A CRC calculated over a stream of blocks, e.g. the `TransferData`
+ * requests of a download. Only the CRC register is kept, so the memory is
+ * constant however long the stream is:
+ *
+ *     CrcStream crc(CrcAlgorithm::CRC32);
+ *     crc.update(block1, length1);
+ *     crc.update(block2, length2);
+ *     crc.getValue(); // == crc_32() of both blocks
+ */
+class CrcStream
+{
+public:
+    static std::optional<CrcAlgorithm> parseAlgorithm(const std::string& name) noexcept;
+
+    explicit CrcStream(CrcAlgorithm algorithm = CrcAlgorithm::CCITT_FFFF) noexcept;
+
+    void update(const std::uint8_t* data, std::size_t length) noexcept;
+    std::uint32_t getValue() const noexcept;
+    void reset() noexcept;
+    CrcAlgorithm getAlgorithm() const noexcept { return algorithm_; }
+
+private:
+    CrcAlgorithm algorithm_;
+    std::uint32_t crc_; ///< the register, not finalized
+};
+
+#endif /* CRC_STREAM_H */
@@ -0,0 +1,102 @@
+/**
+ * @file data_identifier_index.h
+ *
+ */
+
+#ifndef DATA_IDENTIFIER_INDEX_H
+#define DATA_IDENTIFIER_INDEX_H
+
+#include <algorithm>
+#include "request_hit_counters.h"
+#include "response_cache.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Index of a `ReadDataByIdentifier`-table of one session, built at load time.
+ * The entries are kept in a vector that is sorted by the numeric 16 bit data
+ * identifier, so a lookup is a binary search without any string formatting.
+ * Once all entries are added, `countHits()` lets `find()` count the hits of
+ * the entries by their position.
+ */
+class DataIdentifierIndex
+{
+public:
+    struct Entry
+    {
+        std::uint16_t identifier;
+        /// true if the value is a Lua function, which has to be called on request
+        bool isLuaFunction;
+        /// the static value or the key of the Lua function in the table (e.g. "F1 90")
+        std::string data;
+        /// the value of a function wrapped in `cached()`, `nullptr` otherwise
+        std::shared_ptr<ResponseCache> pCache;
+    };
+
+    /**
+     * Adds an entry. An already existing entry of the same identifier gets
+     * replaced.
+     */
+    void add(std::uint16_t identifier, bool isLuaFunction, const std::string& data,
+             std::shared_ptr<ResponseCache> pCache = nullptr)
+    {
+        auto iter = lowerBound(identifier);
+        if (iter != entries_.end() && iter->identifier == identifier)
+        {
+            iter->isLuaFunction = isLuaFunction;
+            iter->data = data;
+            iter->pCache = std::move(pCache);
+        }
+        else
+        {
+            entries_.insert(iter, Entry{identifier, isLuaFunction, data, std::move(pCache)});
+        }
+    }
+
+    /**
+     * Allocates the hit counters, after the last `add()`.
+     */
+    void countHits()
+    {
+        pHits_ = std::make_shared<RequestHitCounters>(entries_.size());
+    }
+
+    /**
+     * @return the entry of the given identifier or `nullptr` if there is none
+     */
+    const Entry *find(std::uint16_t identifier) const
+    {
+        auto iter = std::lower_bound(entries_.cbegin(), entries_.cend(), identifier,
+            [](const Entry& entry, std::uint16_t id) { return entry.identifier < id; });
+        if (iter != entries_.cend() && iter->identifier == identifier)
+        {
+            if (pHits_)
+            {
+                pHits_->hit(std::size_t(iter - entries_.cbegin()));
+            }
+            return &(*iter);
+        }
+        return nullptr;
+    }
+
+    bool empty() const { return entries_.empty(); }
+    std::size_t size() const { return entries_.size(); }
+    /// the entries sorted by identifier, the order of the hit counters
+    const std::vector<Entry>& getEntries() const { return entries_; }
+    /// `nullptr` until `countHits()`
+    const std::shared_ptr<RequestHitCounters>& getHitCounters() const { return pHits_; }
+
+private:
+    std::vector<Entry> entries_;
+    std::shared_ptr<RequestHitCounters> pHits_;
+
+    std::vector<Entry>::iterator lowerBound(std::uint16_t identifier)
+    {
+        return std::lower_bound(entries_.begin(), entries_.end(), identifier,
+            [](const Entry& entry, std::uint16_t id) { return entry.identifier < id; });
+    }
+};
+
+#endif /* DATA_IDENTIFIER_INDEX_H */
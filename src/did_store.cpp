@@ -0,0 +1,434 @@
+/**
+ * @file did_store.cpp
+ *
+ * The values written by `WriteDataByIdentifier`, see `DidStore`.
+ */
+
+#include "did_store.h"
+#include "checkpoint.h"
+#include "logger.h"
+#include "session_controller.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+
+using namespace std;
+
+static constexpr char FILE_MAGIC[8] = {'C', 'S', 'I', 'M', 'D', 'I', 'D', '1'};
+static constexpr uint32_t FILE_VERSION = 1;
+static constexpr size_t HEADER_SIZE = 64;
+static constexpr size_t RECORD_HEADER_SIZE = 8;
+static constexpr size_t RECORD_ALIGNMENT = 4;
+static constexpr size_t MIN_FILE_SIZE = 4096;
+
+namespace
+{
+
+/**
+ * The header of the DID store file. It is followed by `used` bytes of
+ * records, each one `key (4 bytes) length (4 bytes) data` padded to 4 bytes.
+ * A later record of a key replaces the earlier ones.
+ */
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t used;
+};
+
+inline size_t alignRecord(size_t size) noexcept
+{
+    return (size + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+}
+
+} // namespace
+
+/**
+ * @param data: the new value
+ * @param length: the length of the value in bytes
+ */
+void DidValue::assign(const uint8_t* data, size_t length)
+{
+    if (length <= INLINE_CAPACITY)
+    {
+        pHeap_.reset();
+        heapCapacity_ = 0;
+        if (length > 0)
+        {
+            memcpy(inline_.data(), data, length);
+        }
+    }
+    else
+    {
+        if (heapCapacity_ < length)
+        {
+            pHeap_ = std::make_unique<uint8_t[]>(length);
+            heapCapacity_ = length;
+        }
+        memcpy(pHeap_.get(), data, length);
+    }
+    size_ = length;
+}
+
+/**
+ * @return true if the value is the given one
+ */
+bool DidValue::equals(const uint8_t* data, size_t length) const noexcept
+{
+    return size_ == length && (length == 0 || memcmp(this->data(), data, length) == 0);
+}
+
+DidStore::~DidStore()
+{
+    close();
+}
+
+/**
+ * Loads the values of the given file and writes all further values to it.
+ * A missing file is created.
+ *
+ * @param file: path of the DID store file
+ * @param fileSize: the size of the file in bytes, if it is created
+ * @return 0 on success, otherwise a negative value
+ */
+int DidStore::open(const string& file, size_t fileSize) noexcept
+{
+    unique_lock<shared_mutex> lock(mutex_);
+    if (pMapping_ != nullptr)
+    {
+        LOG_ERROR(__func__ << "() DID store is already open!");
+        return -1;
+    }
+
+    const int fd = ::open(file.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        LOG_ERROR(__func__ << "() open " << file << ": " << strerror(errno));
+        return -2;
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) < 0)
+    {
+        LOG_ERROR(__func__ << "() fstat: " << strerror(errno));
+        ::close(fd);
+        return -3;
+    }
+    const bool isNew = fileStat.st_size == 0;
+    const size_t mappingSize = isNew ? max(fileSize, MIN_FILE_SIZE) : size_t(fileStat.st_size);
+    if (mappingSize < HEADER_SIZE)
+    {
+        LOG_ERROR(__func__ << "() " << file << " is not a DID store file");
+        ::close(fd);
+        return -4;
+    }
+    if (isNew && ftruncate(fd, off_t(mappingSize)) < 0)
+    {
+        LOG_ERROR(__func__ << "() ftruncate: " << strerror(errno));
+        ::close(fd);
+        return -3;
+    }
+    void* pMapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (pMapping == MAP_FAILED)
+    {
+        LOG_ERROR(__func__ << "() mmap: " << strerror(errno));
+        return -5;
+    }
+
+    FileHeader* pHeader = static_cast<FileHeader*>(pMapping);
+    if (isNew)
+    {
+        memcpy(pHeader->magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+        pHeader->version = FILE_VERSION;
+        pHeader->headerSize = HEADER_SIZE;
+        pHeader->used = 0;
+    }
+    else if (memcmp(pHeader->magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0
+             || pHeader->version != FILE_VERSION
+             || pHeader->headerSize != HEADER_SIZE
+             || pHeader->used > mappingSize - HEADER_SIZE)
+    {
+        LOG_ERROR(__func__ << "() " << file << " is not a DID store file");
+        munmap(pMapping, mappingSize);
+        return -4;
+    }
+
+    // replay the records, a truncated last record is dropped
+    const uint8_t* pRecords = static_cast<const uint8_t*>(pMapping) + HEADER_SIZE;
+    size_t position = 0;
+    while (position + RECORD_HEADER_SIZE <= pHeader->used)
+    {
+        uint32_t key;
+        uint32_t length;
+        memcpy(&key, pRecords + position, sizeof(key));
+        memcpy(&length, pRecords + position + sizeof(key), sizeof(length));
+        if (length > pHeader->used - position - RECORD_HEADER_SIZE)
+        {
+            break;
+        }
+        setValue(key, pRecords + position + RECORD_HEADER_SIZE, length);
+        position += alignRecord(RECORD_HEADER_SIZE + length);
+    }
+    pHeader->used = min<uint64_t>(position, pHeader->used);
+
+    pMapping_ = static_cast<uint8_t*>(pMapping);
+    mappingSize_ = mappingSize;
+    LOG_INFO("Storing the written DIDs in " << file << " (" << entries_.size() << " values loaded)");
+    return 0;
+}
+
+/**
+ * Stops writing the values to the file. The values are kept.
+ */
+void DidStore::close() noexcept
+{
+    unique_lock<shared_mutex> lock(mutex_);
+    if (pMapping_ == nullptr)
+    {
+        return;
+    }
+    msync(pMapping_, mappingSize_, MS_SYNC);
+    munmap(pMapping_, mappingSize_);
+    pMapping_ = nullptr;
+    mappingSize_ = 0;
+}
+
+/**
+ * Stores the value of a data identifier in the given session.
+ *
+ * @param session: the UDS session byte, e.g. `UdsSession::DEFAULT`
+ * @param identifier: the data identifier
+ * @param data: the value
+ * @param length: the length of the value in bytes
+ */
+void DidStore::write(uint8_t session, uint16_t identifier, const uint8_t* data, size_t length)
+{
+    const uint32_t key = makeKey(session, identifier);
+    unique_lock<shared_mutex> lock(mutex_);
+    if (setValue(key, data, length))
+    {
+        persist(key, data, length);
+    }
+}
+
+/**
+ * @param session: the UDS session byte
+ * @param identifier: the data identifier
+ * @param value: set to the stored value
+ * @return false if no value is stored for the session or the default session
+ */
+bool DidStore::read(uint8_t session, uint16_t identifier, vector<uint8_t>& value) const
+{
+    shared_lock<shared_mutex> lock(mutex_);
+    const Entry* pEntry = find(session, identifier);
+    if (pEntry == nullptr)
+    {
+        return false;
+    }
+    value.assign(pEntry->value.data(), pEntry->value.data() + pEntry->value.size());
+    return true;
+}
+
+/**
+ * Appends `DID value` to a `ReadDataByIdentifier` response.
+ *
+ * @param session: the UDS session byte
+ * @param identifier: the data identifier
+ * @param response: the response to append to, unchanged if no value is stored
+ * @return false if no value is stored for the session or the default session
+ */
+bool DidStore::appendRecord(uint8_t session, uint16_t identifier, vector<uint8_t>& response) const
+{
+    shared_lock<shared_mutex> lock(mutex_);
+    const Entry* pEntry = find(session, identifier);
+    if (pEntry == nullptr)
+    {
+        return false;
+    }
+    response.push_back(uint8_t(identifier >> 8));
+    response.push_back(uint8_t(identifier));
+    response.insert(response.cend(), pEntry->value.data(), pEntry->value.data() + pEntry->value.size());
+    return true;
+}
+
+/**
+ * @return the number of stored values over all sessions
+ */
+size_t DidStore::size() const
+{
+    shared_lock<shared_mutex> lock(mutex_);
+    return entries_.size();
+}
+
+/**
+ * Drops the written values on an `ECUReset`, like the RAM of an ECU. The
+ * values of a persistent store are kept, they survive a reset like a restart.
+ */
+void DidStore::reset()
+{
+    unique_lock<shared_mutex> lock(mutex_);
+    if (pMapping_ == nullptr)
+    {
+        entries_.clear();
+    }
+}
+
+/**
+ * Appends all values to a checkpoint section, see `deserialize()`.
+ *
+ * @param data: the data of the section
+ */
+void DidStore::serialize(string& data) const
+{
+    CheckpointEncoder encoder(data);
+    shared_lock<shared_mutex> lock(mutex_);
+    encoder.put(uint32_t(entries_.size()));
+    for (const Entry& entry : entries_)
+    {
+        encoder.put(entry.key);
+        encoder.putBytes(entry.value.data(), entry.value.size());
+    }
+}
+
+/**
+ * Replaces all values by the ones of a checkpoint section written by
+ * `serialize()`. The file of a persistent store is rewritten with them.
+ *
+ * @param data: the data of the section
+ * @return false if the data is invalid, the values are not changed then
+ */
+bool DidStore::deserialize(string_view data)
+{
+    CheckpointDecoder decoder(data);
+    uint32_t count;
+    if (!decoder.get(count))
+    {
+        return false;
+    }
+    vector<pair<uint32_t, string_view>> values;
+    values.reserve(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t key;
+        string_view value;
+        if (!decoder.get(key) || !decoder.getBytes(value))
+        {
+            return false;
+        }
+        values.emplace_back(key, value);
+    }
+
+    unique_lock<shared_mutex> lock(mutex_);
+    entries_.clear();
+    for (const auto& value : values)
+    {
+        setValue(value.first, reinterpret_cast<const uint8_t*> (value.second.data()), value.second.size());
+    }
+    if (pMapping_ != nullptr)
+    {
+        compact();
+    }
+    return true;
+}
+
+uint32_t DidStore::makeKey(uint8_t session, uint16_t identifier) noexcept
+{
+    return (uint32_t(session) << 16) | identifier;
+}
+
+/**
+ * Finds the value of the session, or else of the default session. The mutex
+ * has to be locked.
+ */
+const DidStore::Entry* DidStore::find(uint8_t session, uint16_t identifier) const noexcept
+{
+    const auto lookup = [this](uint32_t key) -> const Entry* {
+        auto it = lower_bound(entries_.cbegin(), entries_.cend(), key,
+                              [](const Entry& entry, uint32_t k) { return entry.key < k; });
+        return it != entries_.cend() && it->key == key ? &*it : nullptr;
+    };
+    const Entry* pEntry = lookup(makeKey(session, identifier));
+    if (pEntry == nullptr && session != UdsSession::DEFAULT)
+    {
+        pEntry = lookup(makeKey(UdsSession::DEFAULT, identifier));
+    }
+    return pEntry;
+}
+
+/**
+ * Stores the value in memory, the mutex has to be locked.
+ *
+ * @return false if the value was already stored
+ */
+bool DidStore::setValue(uint32_t key, const uint8_t* data, size_t length)
+{
+    auto it = lower_bound(entries_.begin(), entries_.end(), key,
+                          [](const Entry& entry, uint32_t k) { return entry.key < k; });
+    if (it == entries_.end() || it->key != key)
+    {
+        it = entries_.insert(it, Entry{key, DidValue()});
+    }
+    else if (it->value.equals(data, length))
+    {
+        return false;
+    }
+    it->value.assign(data, length);
+    return true;
+}
+
+/**
+ * Appends the value to the file, compacting the file if it is full. The
+ * mutex has to be locked.
+ */
+void DidStore::persist(uint32_t key, const uint8_t* data, size_t length) noexcept
+{
+    if (pMapping_ == nullptr || appendToFile(key, data, length))
+    {
+        return;
+    }
+    // the in-memory values already contain the new value
+    compact();
+}
+
+/**
+ * Rewrites the file with the current values. The used size is reset first,
+ * so an interrupted compaction loses the values instead of corrupting them.
+ */
+void DidStore::compact() noexcept
+{
+    FileHeader* pHeader = reinterpret_cast<FileHeader*>(pMapping_);
+    pHeader->used = 0;
+    for (const Entry& entry : entries_)
+    {
+        if (!appendToFile(entry.key, entry.value.data(), entry.value.size()))
+        {
+            LOG_WARNING("DID store file is full, " << hex << entry.key << " is not persisted");
+        }
+    }
+}
+
+bool DidStore::appendToFile(uint32_t key, const uint8_t* data, size_t length) noexcept
+{
+    FileHeader* pHeader = reinterpret_cast<FileHeader*>(pMapping_);
+    const size_t recordSize = alignRecord(RECORD_HEADER_SIZE + length);
+    if (pHeader->used + recordSize > mappingSize_ - HEADER_SIZE)
+    {
+        return false;
+    }
+    uint8_t* pRecord = pMapping_ + HEADER_SIZE + pHeader->used;
+    const uint32_t length32 = uint32_t(length);
+    memcpy(pRecord, &key, sizeof(key));
+    memcpy(pRecord + sizeof(key), &length32, sizeof(length32));
+    if (length > 0)
+    {
+        memcpy(pRecord + RECORD_HEADER_SIZE, data, length);
+    }
+    pHeader->used += recordSize;
+    return true;
+}
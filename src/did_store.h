@@ -0,0 +1,104 @@
+/**
+ * @file did_store.h
+ *
+ */
+
+#ifndef DID_STORE_H
+#define DID_STORE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * The value of a data identifier. Values up to `INLINE_CAPACITY` bytes (most
+ * DIDs) are stored inline, longer ones in a heap buffer, which is kept when
+ * the value is overwritten.
+ */
+class DidValue
+{
+public:
+    static constexpr std::size_t INLINE_CAPACITY = 16;
+
+    DidValue() = default;
+    DidValue(DidValue&& orig) noexcept = default;
+    DidValue& operator =(DidValue&& orig) noexcept = default;
+    DidValue(const DidValue& orig) = delete;
+    DidValue& operator =(const DidValue& orig) = delete;
+    ~DidValue() = default;
+
+    void assign(const std::uint8_t* data, std::size_t length);
+    bool equals(const std::uint8_t* data, std::size_t length) const noexcept;
+    const std::uint8_t* data() const noexcept { return pHeap_ ? pHeap_.get() : inline_.data(); }
+    std::size_t size() const noexcept { return size_; }
+    bool isInline() const noexcept { return !pHeap_; }
+
+private:
+    std::unique_ptr<std::uint8_t[]> pHeap_;
+    std::size_t heapCapacity_ = 0;
+    std::size_t size_ = 0;
+    std::array<std::uint8_t, INLINE_CAPACITY> inline_{};
+};
+
+/**
+ * The values written by `WriteDataByIdentifier` (0x2E) of one ECU, read back
+ * by `ReadDataByIdentifier` (0x22) before the `ReadDataByIdentifier` tables.
+ * The values are kept per session, a value written in the default session is
+ * read in all sessions, unless the session has a value of its own.
+ *
+ * The values are kept in a flat map (a sorted vector) guarded by a shared
+ * mutex, so reads and writes neither access Lua nor block each other longer
+ * than a copy of the value.
+ *
+ * With `open()`, every write is appended to a memory-mapped file as well and
+ * the values of the file are loaded, so they survive a restart. If the file
+ * is full, it is compacted to the current values.
+ */
+class DidStore
+{
+public:
+    static constexpr std::size_t DEFAULT_FILE_SIZE = 1024 * 1024;
+
+    DidStore() = default;
+    DidStore(const DidStore& orig) = delete;
+    DidStore& operator =(const DidStore& orig) = delete;
+    virtual ~DidStore();
+
+    int open(const std::string& file, std::size_t fileSize = DEFAULT_FILE_SIZE) noexcept;
+    void close() noexcept;
+    bool isPersistent() const noexcept { return pMapping_ != nullptr; }
+
+    void write(std::uint8_t session, std::uint16_t identifier, const std::uint8_t* data, std::size_t length);
+    bool read(std::uint8_t session, std::uint16_t identifier, std::vector<std::uint8_t>& value) const;
+    bool appendRecord(std::uint8_t session, std::uint16_t identifier, std::vector<std::uint8_t>& response) const;
+    std::size_t size() const;
+    void reset();
+    void serialize(std::string& data) const;
+    bool deserialize(std::string_view data);
+
+private:
+    struct Entry
+    {
+        std::uint32_t key; ///< see `makeKey()`
+        DidValue value;
+    };
+
+    mutable std::shared_mutex mutex_;
+    std::vector<Entry> entries_; ///< sorted by the key
+    std::uint8_t* pMapping_ = nullptr;
+    std::size_t mappingSize_ = 0;
+
+    static std::uint32_t makeKey(std::uint8_t session, std::uint16_t identifier) noexcept;
+    const Entry* find(std::uint8_t session, std::uint16_t identifier) const noexcept;
+    bool setValue(std::uint32_t key, const std::uint8_t* data, std::size_t length);
+    void persist(std::uint32_t key, const std::uint8_t* data, std::size_t length) noexcept;
+    void compact() noexcept;
+    bool appendToFile(std::uint32_t key, const std::uint8_t* data, std::size_t length) noexcept;
+};
+
+#endif /* DID_STORE_H */
@@ -0,0 +1,112 @@
+/**
+ * @file doip_can_gateway.cpp
+ *
+ */
+
+#include "doip_can_gateway.h"
+#include "logger.h"
+#include "receiver_reactor.h"
+#include "service_identifier.h"
+#include <sys/epoll.h>
+
+using namespace std;
+
+/**
+ * Constructor. Opens the ISO-TP sockets of the route and registers them with
+ * the reactor.
+ *
+ * @param route: the logical address and the CAN IDs of the real ECU
+ * @param pReactor: the reactor of the entity
+ * @param relay: sends the responses to the testers
+ * @param responseTimeout: the time after which an unanswered request does
+ *                         not block the other testers any more
+ */
+DoIPCanGateway::DoIPCanGateway(const DoipGatewayRoute& route, ReceiverReactor* pReactor, Relay relay,
+                               chrono::milliseconds responseTimeout)
+: IsoTpReceiver(route.requestId, route.responseId, route.interface)
+, relay_(move(relay))
+, logicalAddress_(route.logicalAddress)
+, sender_(route.requestId, route.responseId, route.interface)
+, pReactor_(pReactor)
+, responseTimeout_(responseTimeout)
+{
+    if (pReactor_->addHandler(this, EPOLLIN) != 0)
+    {
+        throw exception();
+    }
+    isRegistered_ = true;
+    if (sender_.enableAsyncSend(pReactor_) != 0)
+    {
+        LOG_WARNING("Failed to enable the non-blocking sender, using blocking writes");
+    }
+}
+
+DoIPCanGateway::~DoIPCanGateway()
+{
+    stop();
+}
+
+/**
+ * Sends a diagnostic message to the real ECU, unless it still has to answer
+ * the request of another tester.
+ *
+ * @param testerAddress: the tester the response is relayed to
+ * @param data: the UDS message
+ * @param length: the length of the message
+ * @return whether the message was sent, see `Forwarded`
+ */
+DoIPCanGateway::Forwarded DoIPCanGateway::forward(uint16_t testerAddress, const uint8_t* data, size_t length) noexcept
+{
+    const auto now = chrono::steady_clock::now();
+    lock_guard<mutex> lock(requestMutex_);
+    if (isOutstanding_ && testerAddress != testerAddress_ && now < responseDeadline_)
+    {
+        LOG_DEBUG("Gateway 0x" << hex << logicalAddress_ << " is busy with a request of tester 0x"
+                  << testerAddress_);
+        return Forwarded::BUSY;
+    }
+    if (sender_.sendData(data, length) <= 0)
+    {
+        return Forwarded::FAILED;
+    }
+    testerAddress_ = testerAddress;
+    isOutstanding_ = !isSuppressPosRsp(data, length);
+    responseDeadline_ = now + responseTimeout_;
+    return Forwarded::SENT;
+}
+
+/**
+ * Stops forwarding and relaying, the gateway is not called by the reactor any
+ * more when this returns.
+ */
+void DoIPCanGateway::stop() noexcept
+{
+    if (isRegistered_)
+    {
+        pReactor_->removeHandler(this);
+        sender_.closeSender();
+        isRegistered_ = false;
+    }
+}
+
+/**
+ * Relays a response of the real ECU to the tester of the last request. Any
+ * response but "response pending" completes the request.
+ */
+void DoIPCanGateway::proceedReceivedData(const uint8_t* buffer, const size_t num_bytes) noexcept
+{
+    uint16_t testerAddress;
+    {
+        lock_guard<mutex> lock(requestMutex_);
+        testerAddress = testerAddress_;
+        if (num_bytes == 3 && buffer[0] == ERROR && buffer[2] == RESPONSE_PENDING)
+        {
+            responseDeadline_ = chrono::steady_clock::now() + responseTimeout_;
+        }
+        else
+        {
+            isOutstanding_ = false;
+        }
+    }
+    relay_(logicalAddress_, testerAddress, buffer, num_bytes);
+}
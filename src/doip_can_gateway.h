@@ -0,0 +1,85 @@
+/**
+ * @file doip_can_gateway.h
+ *
+ */
+
+#ifndef DOIP_CAN_GATEWAY_H
+#define DOIP_CAN_GATEWAY_H
+
+#include "doip_configuration_file.h"
+#include "isotp_receiver.h"
+#include "isotp_sender.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+class ReceiverReactor;
+
+/// the time the real ECU has to answer a forwarded request (P2* of ISO 14229-2)
+constexpr std::chrono::milliseconds GATEWAY_RESPONSE_TIMEOUT(5000);
+
+/**
+ * Forwards the diagnostic messages of a DoIP entity to a real ECU on a CAN
+ * interface and relays its responses, e.g. on a test rack where only some of
+ * the ECUs are simulated.
+ *
+ * The requests are sent with the non-blocking `IsoTpSender` directly from the
+ * receive buffer of the DoIP connection. The responses are read by the
+ * reactor of the entity into the message buffer of the worker and relayed
+ * without allocating a buffer per message.
+ *
+ * A UDS response does not tell which request it answers, so like the real
+ * ECU the gateway handles one request at a time: while the response to the
+ * request of one tester is outstanding, the request of another tester is not
+ * forwarded (`Forwarded::BUSY`, the entity answers it with NRC 0x21). The
+ * request is outstanding until the final response arrives ("response
+ * pending" extends it) or the response timeout expires. A request with the
+ * suppressPosRspMsgIndicationBit is not outstanding. Responses without an
+ * outstanding request (e.g. late ones) go to the tester of the last request.
+ */
+class DoIPCanGateway : public IsoTpReceiver
+{
+public:
+    /// relays a response of the real ECU to a tester
+    using Relay = std::function<void(std::uint16_t logicalAddress, std::uint16_t testerAddress,
+                                     const std::uint8_t* data, std::size_t length)>;
+
+    /// the outcome of `forward()`
+    enum class Forwarded
+    {
+        SENT, ///< sent or queued
+        BUSY, ///< another tester waits for a response
+        FAILED ///< the message could not be sent
+    };
+
+    DoIPCanGateway() = delete;
+    DoIPCanGateway(const DoipGatewayRoute& route, ReceiverReactor* pReactor, Relay relay,
+                   std::chrono::milliseconds responseTimeout = GATEWAY_RESPONSE_TIMEOUT);
+    DoIPCanGateway(const DoIPCanGateway& orig) = delete;
+    DoIPCanGateway& operator =(const DoIPCanGateway& orig) = delete;
+    virtual ~DoIPCanGateway();
+
+    std::uint16_t getLogicalAddress() const noexcept { return logicalAddress_; }
+    Forwarded forward(std::uint16_t testerAddress, const std::uint8_t* data, std::size_t length) noexcept;
+    void stop() noexcept;
+
+protected:
+    virtual void proceedReceivedData(const std::uint8_t* buffer, const std::size_t num_bytes) noexcept override;
+
+private:
+    Relay relay_;
+    std::uint16_t logicalAddress_;
+    IsoTpSender sender_;
+    ReceiverReactor* pReactor_;
+    const std::chrono::milliseconds responseTimeout_;
+    bool isRegistered_ = false; ///< the receiver is handled by the reactor
+
+    std::mutex requestMutex_; ///< guards the request state below
+    std::uint16_t testerAddress_ = 0; ///< the tester of the last forwarded request
+    bool isOutstanding_ = false; ///< the response to the last request has not arrived yet
+    std::chrono::steady_clock::time_point responseDeadline_; ///< of the outstanding request
+};
+
+#endif /* DOIP_CAN_GATEWAY_H */
@@ -1,11 +1,13 @@
 #include "doip_configuration_file.h"
+#include "logger.h"
+#include <cstdlib>
 
 /**
  * Default Constructor if no lua file was found.
  */
 DoipConfigurationFile ::DoipConfigurationFile(){ //if there is no config for the doip server or the ecus this default configuration will be used
     
-    std::cout<<"Setting Default Configuration for the DoIPServer"<<std::endl;
+    LOG_INFO("Setting Default Configuration for the DoIPServer");
     this->A_DoIP_Announce_Num = 3;
     this->A_DoIP_Announce_Interval = 500;
     this->vin = "00000000000000000";
@@ -24,7 +26,7 @@ DoipConfigurationFile::DoipConfigurationFile (const std::string& luaScript) {
 
     const std::string id = "Main";
 
-    std::cout << "Trying to load DoIP configuration from: " << luaScript << std::endl;
+    LOG_INFO("Trying to load DoIP configuration from: " << luaScript);
     
     if(utils::existsFile(luaScript)) {
         lua_state.Load(luaScript);
@@ -94,6 +96,16 @@ DoipConfigurationFile::DoipConfigurationFile (const std::string& luaScript) {
                 this->furtherAction = int(0x00);
             }
             
+            std::string lua_ipaddress = lua_state[id.c_str()][IP_ADDRESS];
+            //empty for all addresses, which is the default
+            this->ipAddress = lua_ipaddress;
+            
+            auto gateway = lua_state[id.c_str()][GATEWAY];
+            if(gateway.exists()) {
+                //forward the addresses of real ECUs to CAN
+                loadGatewayRoutes(gateway, lua_state[id.c_str()][GATEWAY_INTERFACE]);
+            }
+            
             auto generalInactivity = lua_state[id.c_str()][GI];
             if(generalInactivity.exists()) {
                 //set general inactivity time from lua
@@ -112,6 +124,38 @@ DoipConfigurationFile::DoipConfigurationFile (const std::string& luaScript) {
 }
 
 
+/**
+ * Reads the `GATEWAY` table, e.g.
+ * `[0x0E80] = { REQUEST_ID = 0x7E0, RESPONSE_ID = 0x7E8, INTERFACE = "can1" }`.
+ * The routes without `INTERFACE` use the `GATEWAY_INTERFACE`.
+ * @param gateway           the `GATEWAY` table
+ * @param defaultInterface  the `GATEWAY_INTERFACE` field
+ */
+void DoipConfigurationFile::loadGatewayRoutes(sel::Selector gateway, sel::Selector defaultInterface) {
+    const std::string interface = defaultInterface.exists() ? std::string(defaultInterface) : "";
+    for(const std::string& key : gateway.getKeys()) {
+        char *end;
+        const long address = std::strtol(key.c_str(), &end, 0);
+        auto route = gateway[int(address)];
+        if(*end != '\0' || address < 0 || address > 0xFFFF || !route.isTable()
+           || !route[GATEWAY_REQUEST_ID].exists() || !route[GATEWAY_RESPONSE_ID].exists()) {
+            LOG_WARNING("Ignoring invalid gateway route '" << key << "'");
+            continue;
+        }
+        DoipGatewayRoute gatewayRoute;
+        gatewayRoute.logicalAddress = std::uint16_t(address);
+        gatewayRoute.requestId = uint32_t(route[GATEWAY_REQUEST_ID]);
+        gatewayRoute.responseId = uint32_t(route[GATEWAY_RESPONSE_ID]);
+        gatewayRoute.interface = route[GATEWAY_ROUTE_INTERFACE].exists()
+                ? std::string(route[GATEWAY_ROUTE_INTERFACE]) : interface;
+        if(gatewayRoute.interface.empty()) {
+            LOG_WARNING("Ignoring gateway route '" << key << "' without " << GATEWAY_INTERFACE);
+            continue;
+        }
+        gatewayRoutes.push_back(gatewayRoute);
+    }
+}
+
 /**
  * Gets the VIN from the lua configuration file
  * @return      vin as string
@@ -189,3 +233,12 @@ bool DoipConfigurationFile ::getEIDflag() const
 {
     return this->EIDflag;
 }
+
+/**
+ * Gets the IP address the DoIP entity is bound to
+ * @return      the address (e.g. "192.168.0.10") or an empty string for all addresses
+ */
+std::string DoipConfigurationFile ::getIpAddress() const
+{
+    return this->ipAddress;
+}
@@ -1,10 +1,13 @@
 #ifndef DOIP_CONFIGURATION_FILE_H
 #define DOIP_CONFIGURATION_FILE_H
 
-#include "selene.h"
+#include "lua_compat.h"
 #include "utilities.h"
+#include <cstdint>
 #include <string>
+#include <vector>
 #include <stdio.h>
+#include <linux/can.h>
 
 constexpr char VIN[] = "VIN";
 constexpr char LA[] = "LOGICAL_ADDRESS";
@@ -12,10 +15,28 @@ constexpr char EID[] = "EID";
 constexpr char GID[] = "GID";
 constexpr char FA[] = "FURTHER_ACTION";
 constexpr char GI[] = "T_TCP_General_Inactivity";
+constexpr char IP_ADDRESS[] = "IP_ADDRESS";
 
 constexpr char ANNOUNCE_NUM[] = "ANNOUNCE_NUM";
 constexpr char ANNOUNCE_INTERVAL[] = "ANNOUNCE_INTERVAL";
 
+constexpr char GATEWAY[] = "GATEWAY";
+constexpr char GATEWAY_INTERFACE[] = "GATEWAY_INTERFACE";
+constexpr char GATEWAY_REQUEST_ID[] = "REQUEST_ID";
+constexpr char GATEWAY_RESPONSE_ID[] = "RESPONSE_ID";
+constexpr char GATEWAY_ROUTE_INTERFACE[] = "INTERFACE";
+
+/**
+ * A real ECU behind the DoIP entity, see `DoIPCanGateway`.
+ */
+struct DoipGatewayRoute
+{
+    std::uint16_t logicalAddress = 0; ///< the DoIP address the tester sends to
+    canid_t requestId = 0; ///< the CAN ID the requests are forwarded with
+    canid_t responseId = 0; ///< the CAN ID of the responses of the ECU
+    std::string interface; ///< the CAN interface of the ECU
+};
+
 class DoipConfigurationFile 
 {
 public:
@@ -31,10 +52,14 @@ public:
     int getAnnounceNumber() const;
     int getAnnounceInterval() const;
     bool getEIDflag() const;
+    std::string getIpAddress() const;
+    const std::vector<DoipGatewayRoute>& getGatewayRoutes() const { return gatewayRoutes; }
     
 private:
     sel::State lua_state;
     
+    void loadGatewayRoutes(sel::Selector gateway, sel::Selector defaultInterface);
+    
 
     std::string vin;
     std::uint64_t eid;
@@ -42,6 +67,8 @@ private:
     std::uint16_t logicalAddress;
     std::uint8_t furtherAction;
     std::uint16_t generalInactivity;
+    std::string ipAddress; ///< the address the sockets are bound to, empty for all
+    std::vector<DoipGatewayRoute> gatewayRoutes; ///< the real ECUs, empty if the entity is no gateway
 
     
 
@@ -0,0 +1,100 @@
+/**
+ * @file doip_protocol.h
+ *
+ * The message format of DoIP (ISO 13400-2), shared by the TCP connections
+ * and the UDP vehicle identification.
+ */
+
+#ifndef DOIP_PROTOCOL_H
+#define DOIP_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+
+constexpr std::uint8_t DOIP_PROTOCOL_VERSION = 0x02;
+constexpr std::size_t DOIP_HEADER_SIZE = 8;
+/// max. payload of a received message, larger ones are discarded
+constexpr std::size_t DOIP_MAX_PAYLOAD_SIZE = 0x10000;
+/// the TCP and UDP port of the DoIP entity
+constexpr std::uint16_t DOIP_PORT = 13400;
+/// the UDP port the vehicle announcements are sent to
+constexpr std::uint16_t DOIP_TEST_EQUIPMENT_PORT = 13401;
+
+constexpr std::uint16_t DOIP_GENERIC_NACK = 0x0000;
+constexpr std::uint16_t DOIP_VEHICLE_IDENTIFICATION_REQUEST = 0x0001;
+constexpr std::uint16_t DOIP_VEHICLE_IDENTIFICATION_REQUEST_EID = 0x0002;
+constexpr std::uint16_t DOIP_VEHICLE_IDENTIFICATION_REQUEST_VIN = 0x0003;
+constexpr std::uint16_t DOIP_VEHICLE_ANNOUNCEMENT = 0x0004;
+constexpr std::uint16_t DOIP_ROUTING_ACTIVATION_REQUEST = 0x0005;
+constexpr std::uint16_t DOIP_ROUTING_ACTIVATION_RESPONSE = 0x0006;
+constexpr std::uint16_t DOIP_ALIVE_CHECK_REQUEST = 0x0007;
+constexpr std::uint16_t DOIP_ALIVE_CHECK_RESPONSE = 0x0008;
+constexpr std::uint16_t DOIP_DIAGNOSTIC_MESSAGE = 0x8001;
+constexpr std::uint16_t DOIP_DIAGNOSTIC_POSITIVE_ACK = 0x8002;
+constexpr std::uint16_t DOIP_DIAGNOSTIC_NEGATIVE_ACK = 0x8003;
+
+/// generic header NACK codes
+constexpr std::uint8_t DOIP_INCORRECT_PATTERN = 0x00;
+constexpr std::uint8_t DOIP_UNKNOWN_PAYLOAD_TYPE = 0x01;
+constexpr std::uint8_t DOIP_MESSAGE_TOO_LARGE = 0x02;
+constexpr std::uint8_t DOIP_INVALID_PAYLOAD_LENGTH = 0x04;
+
+/// routing activation response codes
+constexpr std::uint8_t DOIP_ROUTING_DIFFERENT_SOURCE_ADDRESS = 0x02;
+constexpr std::uint8_t DOIP_ROUTING_SOURCE_ADDRESS_IN_USE = 0x03;
+constexpr std::uint8_t DOIP_ROUTING_UNSUPPORTED_TYPE = 0x06;
+constexpr std::uint8_t DOIP_ROUTING_SUCCESSFULLY_ACTIVATED = 0x10;
+
+/// diagnostic message NACK codes
+constexpr std::uint8_t DOIP_DIAGNOSTIC_ACK = 0x00;
+constexpr std::uint8_t DOIP_INVALID_SOURCE_ADDRESS = 0x02;
+constexpr std::uint8_t DOIP_UNKNOWN_TARGET_ADDRESS = 0x03;
+constexpr std::uint8_t DOIP_TARGET_UNREACHABLE = 0x06;
+
+namespace doip
+{
+
+inline std::uint16_t readUint16(const std::uint8_t* data) noexcept
+{
+    return std::uint16_t((data[0] << 8) | data[1]);
+}
+
+inline std::uint32_t readUint32(const std::uint8_t* data) noexcept
+{
+    return (std::uint32_t(data[0]) << 24) | (std::uint32_t(data[1]) << 16)
+        | (std::uint32_t(data[2]) << 8) | data[3];
+}
+
+inline void writeUint16(std::uint8_t* data, std::uint16_t value) noexcept
+{
+    data[0] = std::uint8_t(value >> 8);
+    data[1] = std::uint8_t(value);
+}
+
+/**
+ * Writes the DoIP header of a message.
+ *
+ * @param header: at least `DOIP_HEADER_SIZE` bytes
+ * @param payloadType: the DoIP payload type
+ * @param length: the length of the payload
+ */
+inline void writeHeader(std::uint8_t* header, std::uint16_t payloadType, std::size_t length) noexcept
+{
+    header[0] = DOIP_PROTOCOL_VERSION;
+    header[1] = std::uint8_t(~DOIP_PROTOCOL_VERSION);
+    writeUint16(header + 2, payloadType);
+    writeUint16(header + 4, std::uint16_t(length >> 16));
+    writeUint16(header + 6, std::uint16_t(length));
+}
+
+/**
+ * @return true if the header starts with the protocol version and its inverse
+ */
+inline bool hasValidPattern(const std::uint8_t* header) noexcept
+{
+    return header[0] == DOIP_PROTOCOL_VERSION && header[1] == std::uint8_t(~DOIP_PROTOCOL_VERSION);
+}
+
+} // namespace doip
+
+#endif /* DOIP_PROTOCOL_H */
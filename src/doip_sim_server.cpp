@@ -1,218 +1,421 @@
 #include "doip_sim_server.h"
+#include "doip_can_gateway.h"
+#include "idle_monitor.h"
+#include "logger.h"
+#include "traffic_capture.h"
+#include "receiver_reactor.h"
+#include "service_identifier.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+
+int DoIPSimServer::workerIndex = -1;
 
 /**
- * Constructor. Creates a DoIPServer for this simulator
+ * Constructor. The sockets are not opened until `startWithConfig()` is called.
  */
 DoIPSimServer::DoIPSimServer() :
-        doipConnection(nullptr) {
-    doipServer = new DoIPServer();
+        ecuTable(std::make_unique<std::atomic<DoIPSimulator*>[]>(DOIP_ADDRESS_COUNT)),
+        captureInterface(TrafficCapture::getInstance().getInterfaceIndex(DOIP_CAPTURE_INTERFACE)),
+        receivePool(DOIP_RECEIVE_BUFFER_SIZE, DOIP_FREE_RECEIVE_BUFFERS) {
 }
 
 /**
- * Destructor.
+ * Destructor. Closes the remaining connections.
  */
 DoIPSimServer::~DoIPSimServer() {
-    delete doipServer;
+    if(serverActive) {
+        shutdown();
+    }
+    gateways.clear();
+    // no more workers, which might still use the connections
+    pOwnReactor.reset();
+
+    std::map<DoIPTcpConnection*, std::unique_ptr<DoIPTcpConnection>> remaining;
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        remaining.swap(connections);
+    }
+    for(auto& connection : remaining) {
+        if(pReactor != nullptr) {
+            pReactor->removeHandler(connection.first);
+        }
+    }
 }
 
 /**
  * Parse the given configuration file and start the doip server
+ * @param configFilePath    the DoIP configuration
+ * @param pReactor          handles the TCP connections, if `nullptr` the
+ *                          server starts a reactor of its own
  */
-void DoIPSimServer::startWithConfig(std::string configFilePath) {
+void DoIPSimServer::startWithConfig(std::string configFilePath, ReceiverReactor* pReactor) {
 
     doipConfig = new DoipConfigurationFile(configFilePath);
-    configureDoipServer();
+    name = std::filesystem::path(configFilePath).stem().string();
     
-    doipServer->setupUdpSocket();
+    if(pReactor == nullptr) {
+        pOwnReactor = std::make_unique<ReceiverReactor>();
+        pOwnReactor->start(DOIP_REACTOR_THREADS);
+        pReactor = pOwnReactor.get();
+    }
+    this->pReactor = pReactor;
+    if(workerIndex > 0 && !doipConfig->getGatewayRoutes().empty()) {
+        // a gateway route is opened once, by the first worker
+        LOG_INFO(name << " has gateway routes, it is served by worker 0");
+        return;
+    }
+    startGateways();
   
     serverActive = true;
-    doipReceiver.push_back(std::thread(&DoIPSimServer::listenUdp, this));
-    doipReceiver.push_back(std::thread(&DoIPSimServer::listenTcp, this));
-    
-    doipServer->sendVehicleAnnouncement();
+    if(setupTcpSocket() == 0 && pReactor->addHandler(this, EPOLLIN) != 0) {
+        close(listenSocket);
+        listenSocket = -1;
+    }
+    if(workerIndex > 0) {
+        // the vehicle is identified and announced by the first worker
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(udpMutex);
+        pUdpSocket = std::make_unique<DoIPUdpSocket>(getVehicleIdentification());
+        if(pUdpSocket->open(doipConfig->getIpAddress()) != 0 || pReactor->addHandler(pUdpSocket.get(), EPOLLIN) != 0) {
+            pUdpSocket.reset();
+            return;
+        }
+        // sent by the timer thread, the startup does not wait for the interval
+        pUdpSocket->announce(doipConfig->getAnnounceNumber(),
+                             std::chrono::milliseconds(doipConfig->getAnnounceInterval()));
+    }
 }
 
 void DoIPSimServer::shutdown() {
-    serverActive = false;
-    if(doipConnection) doipConnection->triggerDisconnection();
-    doipServer->closeTcpSocket();
-    doipServer->closeUdpSocket();
-}
+    if(!serverActive.exchange(false)) {
+        return;
+    }
+    if(listenSocket >= 0) {
+        pReactor->removeHandler(this);
+        close(listenSocket);
+        listenSocket = -1;
+    }
+    triggerDisconnection();
+    for(auto& gateway : gateways) {
+        gateway.second->stop();
+    }
 
-/**
- * Callback when connection is terminated
- */
-void DoIPSimServer::closeConnection() {}
+    std::lock_guard<std::mutex> lock(udpMutex);
+    if(pUdpSocket) {
+        pReactor->removeHandler(pUdpSocket.get());
+        pUdpSocket.reset();
+    }
+}
 
 /**
- * Closes the connection from the server side
+ * Closes the connections from the server side
  */
 void DoIPSimServer::triggerDisconnection() {
-    if(doipConnection) doipConnection->triggerDisconnection();
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    for(auto& connection : connections) {
+        connection.second->triggerDisconnection();
+    }
 }
 
+/**
+ * Sends the configured number of vehicle announcements. Does not wait for the
+ * announcement interval, so a Lua script calling this is not blocked.
+ */
 void DoIPSimServer::sendVehicleAnnouncements() {
-    doipServer->sendVehicleAnnouncement();
+    std::lock_guard<std::mutex> lock(udpMutex);
+    if(pUdpSocket) {
+        pUdpSocket->announce(doipConfig->getAnnounceNumber(),
+                             std::chrono::milliseconds(doipConfig->getAnnounceInterval()));
+    }
 }
 
-/*
- * Check permantly if udp message was received
+/**
+ * Opens the CAN routes of the `GATEWAY` table. A route whose interface can
+ * not be opened is skipped, its address is unknown to the testers.
  */
-void DoIPSimServer::listenUdp() {
-
-    while(serverActive) {
-        doipServer->receiveUdpMessage();
+void DoIPSimServer::startGateways() {
+    for(const DoipGatewayRoute& route : doipConfig->getGatewayRoutes()) {
+        try {
+            gateways[route.logicalAddress] = std::make_unique<DoIPCanGateway>(route, pReactor,
+                [this](unsigned short logicalAddress, unsigned short testerAddress,
+                       const unsigned char* data, size_t length) {
+                    relayGatewayResponse(logicalAddress, testerAddress, data, length);
+                });
+            LOG_INFO("DoIP gateway 0x" << std::hex << route.logicalAddress << " -> " << route.interface
+                     << " 0x" << route.requestId << "/0x" << route.responseId);
+        } catch(const std::exception&) {
+            LOG_ERROR("Unable to open the DoIP gateway route 0x" << std::hex << route.logicalAddress
+                      << " on " << route.interface);
+        }
     }
 }
 
-/*
- * Check permantly if tcp message was received
+/**
+ * Opens the non-blocking TCP socket the testers connect to.
+ * @return  0 on success, otherwise a negative value
  */
-void DoIPSimServer::listenTcp() {
-    
-    DiagnosticCallback receiveDiagnosticDataCallback = std::bind(&DoIPSimServer::receiveFromLibrary, 
-            this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
-    DiagnosticMessageNotification notifyDiagnosticMessageCallback = std::bind(&DoIPSimServer::diagnosticMessageReceived, 
-            this, std::placeholders::_1);
-    CloseConnectionCallback closeConnectionCallback = std::bind(&DoIPSimServer::closeConnection, this);
-    
-    doipServer->setupTcpSocket();
+int DoIPSimServer::setupTcpSocket() {
+    int skt = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(skt < 0) {
+        LOG_ERROR(__func__ << "() socket: " << strerror(errno));
+        return -1;
+    }
 
-    while(serverActive) {
-        doipConnection = doipServer->waitForTcpConnection();
-        doipConnection->setCallback(receiveDiagnosticDataCallback, notifyDiagnosticMessageCallback, closeConnectionCallback);
-        doipConnection->setGeneralInactivityTime(50000);
+    int enable = 1;
+    setsockopt(skt, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    if(workerIndex >= 0) {
+        // the kernel spreads the testers over the workers
+        setsockopt(skt, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable));
+    }
 
-         while(doipConnection->isSocketActive()) {
-             doipConnection->receiveTcpMessage();
-         }
-         
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(DOIP_PORT);
+    const std::string address = doipConfig->getIpAddress();
+    if(!address.empty() && inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+        LOG_ERROR(__func__ << "() Invalid IP address " << address);
+        close(skt);
+        return -3;
     }
+    if(bind(skt, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0
+       || listen(skt, SOMAXCONN) < 0) {
+        LOG_ERROR(__func__ << "() bind: " << strerror(errno));
+        close(skt);
+        return -2;
+    }
+    listenSocket = skt;
+    return 0;
+}
+
+int DoIPSimServer::getSocket() const noexcept {
+    return listenSocket;
 }
 
 /**
- * Is called when the doip library receives a diagnostic message.
- * @param address   logical address of the ecu
- * @param data      message which was received
- * @param length    length of the message
+ * Is called by the reactor when testers are connecting.
+ * @param events    the epoll events that occurred
+ * @return          `EPOLLIN`, to wait for the next tester
  */
-void DoIPSimServer::receiveFromLibrary(unsigned short address, unsigned char* data, int length) {
-    printf("CarSimulator DoIP Simulator received: ");
-    int logLength = (length > MAX_LOG_LENGTH ? MAX_LOG_LENGTH : length);
-    for(int i = 0; i < logLength; i++) {
-        printf("0x%02X ", data[i]);
-    }
-    printf(" from doip lib.\n");
-    
-    int index = findECU(address);
-    if(index != -1) {
-        std::vector<unsigned char> response = ecus.at(index)->proceedDoIPData(data,length);
-        
-        if(response.size() > 0) {
-            unsigned short logicalAddress = ecus.at(index)->getLogicalEcuAddress();
-            sendDiagnosticResponse(response, logicalAddress);
+std::uint32_t DoIPSimServer::handleEvents(std::uint32_t events) noexcept {
+    acceptConnections();
+    return EPOLLIN;
+}
+
+/**
+ * Accepts all pending connections and adds them to the reactor.
+ */
+void DoIPSimServer::acceptConnections() {
+    while(true) {
+        int skt = accept4(listenSocket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(skt < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            if(errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_ERROR(__func__ << "() accept: " << strerror(errno));
+            }
+            return;
+        }
+
+        IdleMonitor::getInstance().notifyActivity();
+        int enable = 1;
+        setsockopt(skt, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        DoIPTcpConnection* connection;
+        size_t count;
+        {
+            std::lock_guard<std::mutex> lock(connectionsMutex);
+            std::unique_ptr<DoIPTcpConnection> pConnection = std::make_unique<DoIPTcpConnection>(
+                    skt, this, pReactor, &receivePool, doipConfig->getLogicalAddress());
+            connection = pConnection.get();
+            connections[connection] = std::move(pConnection);
+            count = connections.size();
+        }
+        LOG_INFO("DoIP tester connected, " << std::dec << count << " connections");
+        if(pReactor->addHandler(connection, EPOLLIN) != 0) {
+            connectionClosed(connection);
         }
     }
 }
 
 /**
- * Passes the received response from a ecu back to the doip library
- * @param data              respone from a ecu that will be send back
- * @param logicalAddress    logical address of the ecu where data came from
+ * Is called by a connection once it is closed, deletes the connection.
+ * @param connection    the closed connection
  */
-void DoIPSimServer::sendDiagnosticResponse(const std::vector<unsigned char> data, unsigned short logicalAddress) {
-    unsigned char* msg = new unsigned char[data.size()];
-    for(unsigned int i = 0; i < data.size(); i++) {
-        msg[i] = data[i];
+void DoIPSimServer::connectionClosed(DoIPTcpConnection* connection) {
+    std::unique_ptr<DoIPTcpConnection> pConnection;
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        auto iter = connections.find(connection);
+        if(iter == connections.end()) {
+            return;
+        }
+        pConnection = std::move(iter->second);
+        connections.erase(iter);
     }
-    
-    doipConnection->sendDiagnosticPayload(logicalAddress, msg, data.size());
-    delete[] msg;
 }
 
 /**
- * Adds a ECU to the list
- * @param ecu   Pointer to the ecu
+ * Checks if a tester address can be activated on the given connection, i.e.
+ * it is not active on another connection.
+ * @param connection        the connection activating the routing
+ * @param testerAddress     the logical address of the tester
+ * @return                  true if the address is not in use
  */
-void DoIPSimServer::addECU(DoIPSimulator* ecu) {
-    ecus.push_back(ecu);
+bool DoIPSimServer::isTesterAddressAvailable(const DoIPTcpConnection* connection, unsigned short testerAddress) {
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    for(auto& other : connections) {
+        if(other.first != connection && other.first->isRoutingActive()
+           && other.first->getTesterAddress() == testerAddress) {
+            return false;
+        }
+    }
+    return true;
 }
 
 /**
- * Will be called when the doip library receives a diagnostic message.
- * The library notifies the application about the message.
- * Checks if there is a ecu with the logical address
- * @param targetAddress     logical address to the ecu
- * @return                  If a positive or negative ACK should be send to the client
+ * Is called when a connection receives a diagnostic message. Acknowledges
+ * the message and sends the response of the ECU on the same connection.
+ * @param connection    the connection the message arrived on
+ * @param targetAddress logical address of the ecu
+ * @param data          message which was received
+ * @param length        length of the message
  */
-bool DoIPSimServer::diagnosticMessageReceived(unsigned short targetAddress) {
-    unsigned char ackCode;
+void DoIPSimServer::handleDiagnosticMessage(DoIPTcpConnection* connection, unsigned short targetAddress,
+                                            const unsigned char* data, size_t length) {
+    const auto receivedAt = std::chrono::steady_clock::now();
+    TrafficCapture::getInstance().record(TrafficCapture::Protocol::DOIP, TrafficCapture::Direction::RX,
+                                         captureInterface, 0, 0, targetAddress, data, length);
     
-    //if there isnt a ecu with the target address 
-    if(findECU(targetAddress) == -1) {
-        //send negative ack with unknown target address and return
-        ackCode = 0x03;
-        std::cout << "Send negative diagnostic message ack" << std::endl;
-        doipConnection->sendDiagnosticAck(targetAddress, false, ackCode);
-        return false;
+    DoIPSimulator* ecu = findECU(targetAddress);
+    if(ecu == nullptr) {
+        auto gateway = gateways.find(targetAddress);
+        if(gateway != gateways.end()) {
+            // the real ECU takes longer to respond than the acknowledgement takes to be sent
+            const DoIPCanGateway::Forwarded forwarded
+                = gateway->second->forward(connection->getTesterAddress(), data, length);
+            if(forwarded == DoIPCanGateway::Forwarded::FAILED) {
+                connection->sendDiagnosticAck(targetAddress, false, DOIP_TARGET_UNREACHABLE);
+                return;
+            }
+            connection->sendDiagnosticAck(targetAddress, true, DOIP_DIAGNOSTIC_ACK);
+            if(forwarded == DoIPCanGateway::Forwarded::BUSY) {
+                // the real ECU still has to answer the request of another tester
+                const unsigned char busy[] = {ERROR, data[0], BUSY_REPEAT_REQUEST};
+                TrafficCapture::getInstance().record(TrafficCapture::Protocol::DOIP, TrafficCapture::Direction::TX,
+                                                     captureInterface, 0, targetAddress, 0, busy, sizeof(busy));
+                connection->sendDiagnosticMessage(targetAddress, busy, sizeof(busy));
+            }
+            return;
+        }
+        LOG_DEBUG("Send negative diagnostic message ack");
+        connection->sendDiagnosticAck(targetAddress, false, DOIP_UNKNOWN_TARGET_ADDRESS);
+        return;
     }
-  
-    //send positiv ack
-    ackCode = 0x00;
-    std::cout << "Send positive diagnostic message ack" << std::endl;
-    doipConnection->sendDiagnosticAck(targetAddress, true, ackCode);
-    return true;
+    connection->sendDiagnosticAck(targetAddress, true, DOIP_DIAGNOSTIC_ACK);
+
+    size_t logLength = (length > MAX_LOG_LENGTH ? MAX_LOG_LENGTH : length);
+    LOG_DEBUG("CarSimulator DoIP Simulator received:" << hexDump(data, logLength));
+
+    RequestTimer timer(ecu->getMetrics(), data[0], receivedAt);
+    // reused by all requests of this worker, so a Lua response reuses the buffer of the last one
+    thread_local DoIPResponse response;
+    ecu->proceedDoIPData(data, length, response, &timer);
+    if(response.size > 0) {
+        TrafficCapture::getInstance().record(TrafficCapture::Protocol::DOIP, TrafficCapture::Direction::TX,
+                                             captureInterface, 0, targetAddress, 0, response.data, response.size);
+        connection->sendDiagnosticMessage(targetAddress, response.data, response.size);
+        timer.responseSent(response.data, response.size);
+    }
+    response.pRequestMatcher.reset();
 }
 
 /**
- * Find a ECU where the given address matches with the logical address
- * @param logicalEcuAddress   logical address of ECU to find
- * @return                    index of ecu in the vector
- */
-int DoIPSimServer::findECU(unsigned short logicalEcuAddress) {
-    int ecuIndex = -1;
-
-    //Check if there is a running ecu where logicalAddress == targetAddress
-    for(unsigned int i = 0; i < ecus.size(); i++) {
-        unsigned short crntLogicalAddress = ecus.at(i)->getLogicalEcuAddress();
-        
-        if(crntLogicalAddress == logicalEcuAddress) {
-            ecuIndex = i;
-            break;
+ * Sends a response of a real ECU behind the gateway to the tester of the
+ * request, if it is still connected.
+ * @param logicalAddress    logical address of the real ECU
+ * @param testerAddress     logical address of the tester
+ * @param data              the response
+ * @param length            length of the response
+ */
+void DoIPSimServer::relayGatewayResponse(unsigned short logicalAddress, unsigned short testerAddress,
+                                         const unsigned char* data, size_t length) {
+    TrafficCapture::getInstance().record(TrafficCapture::Protocol::DOIP, TrafficCapture::Direction::TX,
+                                         captureInterface, 0, logicalAddress, testerAddress, data, length);
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    for(auto& connection : connections) {
+        if(connection.first->isRoutingActive() && connection.first->getTesterAddress() == testerAddress) {
+            connection.first->sendDiagnosticMessage(logicalAddress, data, length);
+            return;
         }
     }
-    
-    return ecuIndex;
+    LOG_DEBUG("Dropping the gateway response of 0x" << std::hex << logicalAddress << ", tester 0x"
+              << testerAddress << " is not connected");
 }
 
-void DoIPSimServer::configureDoipServer() {
-    
-    std::string tempVIN = doipConfig->getVin();
-    unsigned int tempLogicalAddress = doipConfig->getLogicalAddress();
-    uint64_t tempEID = doipConfig->getEid();
-    uint64_t tempGID = doipConfig->getGid();
-    int tempFAR = doipConfig->getFurtherAction();
-    
-    int tempNum = doipConfig->getAnnounceNumber(); 
-    int tempInterval = doipConfig->getAnnounceInterval();
-        
-    doipServer->setVIN(tempVIN);
-    doipServer->setLogicalGatewayAddress(tempLogicalAddress);
-    
-    if(doipConfig->getEIDflag() == true)
-    {
-        doipServer->setEIDdefault();
+/**
+ * Sends a response of a ecu to all testers with an activated routing, e.g.
+ * a message sent by a Lua script with `sendRaw()`
+ * @param data              respone from a ecu that will be send back
+ * @param logicalAddress    logical address of the ecu where data came from
+ */
+void DoIPSimServer::sendDiagnosticResponse(const std::vector<unsigned char>& data, unsigned short logicalAddress) {
+    TrafficCapture::getInstance().record(TrafficCapture::Protocol::DOIP, TrafficCapture::Direction::TX,
+                                         captureInterface, 0, logicalAddress, 0, data.data(), data.size());
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    for(auto& connection : connections) {
+        if(connection.second->isRoutingActive()) {
+            connection.second->sendDiagnosticMessage(logicalAddress, data.data(), data.size());
+        }
     }
-    else
-    {
-        doipServer->setEID(tempEID);
+}
+
+/**
+ * Adds a ECU to the address table. The ECUs are loaded in parallel, so this
+ * might be called while the server is already receiving messages.
+ * @param ecu   Pointer to the ecu
+ */
+void DoIPSimServer::addECU(DoIPSimulator* ecu) {
+    std::lock_guard<std::mutex> lock(ecusMutex);
+    std::atomic<DoIPSimulator*>& entry = ecuTable[ecu->getLogicalEcuAddress()];
+    if(entry.load(std::memory_order_relaxed) != nullptr) {
+        LOG_WARNING("DoIP logical address 0x" << std::hex << ecu->getLogicalEcuAddress()
+                    << " is already in use, the ECU is ignored");
+        return;
     }
-    
-    doipServer->setGID(tempGID);
-    doipServer->setFAR(tempFAR);
-    
-    doipServer->setA_DoIP_Announce_Num(tempNum);
-    doipServer->setA_DoIP_Announce_Interval(tempInterval);
+    entry.store(ecu, std::memory_order_release);
+}
 
-    
+/**
+ * Find a ECU where the given address matches with the logical address. This
+ * is a single lookup in the address table, independent of the number of ECUs.
+ * @param logicalEcuAddress   logical address of ECU to find
+ * @return                    the ecu or nullptr if it is not (yet) loaded
+ */
+DoIPSimulator* DoIPSimServer::findECU(unsigned short logicalEcuAddress) {
+    return ecuTable[logicalEcuAddress].load(std::memory_order_acquire);
+}
+
+/**
+ * @return the identification of the configured DoIP entity
+ */
+VehicleIdentification DoIPSimServer::getVehicleIdentification() const {
+    VehicleIdentification identification;
+    identification.vin = doipConfig->getVin();
+    identification.logicalAddress = doipConfig->getLogicalAddress();
+    identification.eid = doipConfig->getEIDflag() ? DoIPUdpSocket::getDefaultEid() : doipConfig->getEid();
+    identification.gid = doipConfig->getGid();
+    identification.furtherAction = doipConfig->getFurtherAction();
+    return identification;
 }
@@ -3,48 +3,107 @@
 
 #include "doip_configuration_file.h"
 #include "doip_simulator.h"
-#include "DoIPServer.h"
+#include "buffer_pool.h"
+#include "doip_tcp_connection.h"
+#include "doip_udp_socket.h"
+#include "reactor_handler.h"
+#include <atomic>
 #include <functional>
-#include <thread>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 
 #define MAX_LOG_LENGTH 10
+#define DOIP_CAPTURE_INTERFACE "doip"
+/// the configurations of the DoIP entities start with this
+#define DOIP_SERVER_CONFIG_PREFIX "doipserver"
+/// logical addresses are 16 bit, so the address table has an entry for each
+#define DOIP_ADDRESS_COUNT 0x10000
+/// worker threads of the own reactor, if the server gets none passed
+#define DOIP_REACTOR_THREADS 4
+/// receive buffers kept for reconnecting testers
+#define DOIP_FREE_RECEIVE_BUFFERS 16
 
 class DoIPSimulator;
+class DoIPCanGateway;
+class ReceiverReactor;
 
-class DoIPSimServer
+/**
+ * A DoIP entity of the simulator, configured by a `doipserver*.lua`. The TCP connections of the testers and
+ * the UDP vehicle identification are handled by a `ReceiverReactor`: any
+ * number of testers can be connected at the same time, each with its own
+ * routing activation, and the responses are sent on the connection the
+ * request arrived on. The vehicle announcements are sent by the shared
+ * `TimerWheel`, so the server needs no threads of its own and several
+ * entities (e.g. one per simulated vehicle) can run in one process.
+ *
+ * With a `GATEWAY` table the entity also fronts real ECUs: the messages to
+ * their logical addresses are forwarded to CAN by a `DoIPCanGateway`, unless
+ * a simulated ECU has the same address.
+ *
+ * In a worker process (see `WorkerSupervisor`) the TCP socket is opened with
+ * `SO_REUSEPORT`, so the same entity of every worker accepts a share of the
+ * testers. Only the first worker answers the vehicle identification and
+ * opens the gateway routes, an entity with a `GATEWAY` table is not started
+ * by the other workers at all.
+ */
+class DoIPSimServer : public ReactorHandler
 {
 public:
     DoIPSimServer();
     ~DoIPSimServer();
-    void startWithConfig(std::string configFilePath);
+    void startWithConfig(std::string configFilePath, ReceiverReactor* pReactor = nullptr);
+    static void setWorkerIndex(int index) noexcept { workerIndex = index; }
     void shutdown();
-    void receiveFromLibrary(unsigned short address, unsigned char* data, int length);
-    void sendDiagnosticResponse(const std::vector<unsigned char> data, unsigned short logicalAddress);
+    void sendDiagnosticResponse(const std::vector<unsigned char>& data, unsigned short logicalAddress);
     void addECU(DoIPSimulator* ecu);
     bool isServerActive() { return serverActive; };
-    DoIPServer* getServerInstance();
-    std::vector<std::thread> doipReceiver;
+    const std::string& getName() const { return name; };
 
     void triggerDisconnection();
     void sendVehicleAnnouncements();
 
+    virtual int getSocket() const noexcept override;
+    virtual std::uint32_t handleEvents(std::uint32_t events) noexcept override;
+
+    bool isTesterAddressAvailable(const DoIPTcpConnection* connection, unsigned short testerAddress);
+    void handleDiagnosticMessage(DoIPTcpConnection* connection, unsigned short targetAddress,
+                                 const unsigned char* data, size_t length);
+    void connectionClosed(DoIPTcpConnection* connection);
+    void relayGatewayResponse(unsigned short logicalAddress, unsigned short testerAddress,
+                              const unsigned char* data, size_t length);
+
 private:
-    DoIPServer* doipServer;
+    static int workerIndex; ///< the worker process, -1 without workers
+
     DoipConfigurationFile* doipConfig;
+    std::string name; ///< the name of the configuration, e.g. "doipserver"
+
+    /// the ECUs by their logical address, filled by the loading threads
+    std::unique_ptr<std::atomic<DoIPSimulator*>[]> ecuTable;
+    std::mutex ecusMutex; ///< serializes `addECU()`, the lookups are lock-free
+    std::atomic<bool> serverActive{false}; ///< read by `main()` while the reactor threads run
+    uint8_t captureInterface; ///< see `TrafficCapture::getInterfaceIndex()`
 
-    std::vector<DoIPSimulator*> ecus;
-    std::unique_ptr<DoIPConnection> doipConnection;
-    bool serverActive = false;
+    int listenSocket = -1;
+    ReceiverReactor* pReactor = nullptr;
+    std::unique_ptr<ReceiverReactor> pOwnReactor; ///< only if no reactor was passed
+    BufferPool receivePool; ///< the receive buffers of the connections, outlives them
+    std::map<DoIPTcpConnection*, std::unique_ptr<DoIPTcpConnection>> connections;
+    /// the real ECUs by their logical address, not changed after `startWithConfig()`
+    std::map<unsigned short, std::unique_ptr<DoIPCanGateway>> gateways;
+    std::mutex connectionsMutex; ///< guards `connections`
+    std::unique_ptr<DoIPUdpSocket> pUdpSocket;
+    std::mutex udpMutex; ///< guards `pUdpSocket`, which is used by the Lua scripts
     
-    bool diagnosticMessageReceived(unsigned short targetAddress);
-    int findECU(unsigned short logicalEcuAddress);
+    DoIPSimulator* findECU(unsigned short logicalEcuAddress);
     
-    void configureDoipServer();
-    void listenUdp();
-    void listenTcp();
-   
-    void closeConnection();
+    VehicleIdentification getVehicleIdentification() const;
+    int setupTcpSocket();
+    void startGateways();
+    void acceptConnections();
 
 };
 
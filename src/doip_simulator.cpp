@@ -1,9 +1,14 @@
 #include "doip_simulator.h"
+#include "doip_protocol.h"
 #include "service_identifier.h"
+#include "logger.h"
 #include <iostream>
 
 using namespace std;
 
+/// the max. response, the payload of a diagnostic message without the source and target address
+static constexpr size_t MAX_RESPONSE_LENGTH = DOIP_MAX_PAYLOAD_SIZE - 4;
+
 bool DoIPSimulator::hasSimulation(EcuLuaScript *pEcuScript)
 {
     if(pEcuScript->hasDoIPLogicalEcuAddress()) {
@@ -17,30 +22,99 @@ bool DoIPSimulator::hasSimulation(EcuLuaScript *pEcuScript)
 DoIPSimulator::DoIPSimulator(EcuLuaScript *pEcuScript) :
         pEcuScript_(pEcuScript) {
     logicalEcuAddress = pEcuScript->getDoIPLogicalEcuAddress();
-    requestByteTree = pEcuScript->buildRequestByteTreeFromRawTable();
+    pMetrics_ = Metrics::getInstance().registerEcu("doip", logicalEcuAddress);
+    pMetrics_->setLuaMemory(pEcuScript->getLuaMemoryStatistics());
+    pMetrics_->setRequestHits(pEcuScript->getRequestHitStatistics());
+    sessionControl_.configureSessions(pEcuScript->getSessionConfigurations());
+    pEcuScript->getRawRequestMatcher(); // compile the 'Raw' table before the first request
+    // the unsolicited messages go to all testers, like the ones of `sendRaw()`
+    pDispatcher_ = std::make_unique<ServiceDispatcher>(pEcuScript, &sessionControl_, MAX_RESPONSE_LENGTH,
+        [pEcuScript](const uint8_t* response, size_t length) {
+            pEcuScript->sendDoIPMessage(vector<uint8_t>(response, response + length));
+        },
+        // every periodic record (`pDID data`) is a diagnostic message of its own
+        [pEcuScript](const struct can_frame* frames, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                pEcuScript->sendDoIPMessage(vector<uint8_t>(frames[i].data, frames[i].data + frames[i].can_dlc));
+            }
+        });
 }
 
 /**
- * Proceed received DoIP data
+ * Proceed received DoIP data, in the DoIP session of the ECU: the services
+ * not allowed in the session are rejected with `7F SID 7F`, the 'Raw' table
+ * and the `DataIdentifiers` of the session are used, as over CAN.
  * @param buffer        received DoIP data
  * @param num_bytes     length of data
- * @return              answer from the ecu config file
+ * @param response      answer from the ecu config file, see `DoIPResponse`
+ * @param pTimer        measures the request, might be `nullptr`
  */
-vector<unsigned char> DoIPSimulator::proceedDoIPData(const unsigned char* buffer, const size_t num_bytes) noexcept {
-    const string request = pEcuScript_->intToHexString(buffer, num_bytes);
-
-    const optional<string> response = pEcuScript_->getRawResponse(requestByteTree, buffer, num_bytes);
-    if (response)
+void DoIPSimulator::proceedDoIPData(const unsigned char* buffer, const size_t num_bytes, DoIPResponse& response,
+                                    RequestTimer* pTimer) noexcept {
+    if(num_bytes == 0) {
+        setNegativeResponse(response, 0x00, SERVICE_NOT_SUPPORTED);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    // the tester is present, even if the response takes a while
+    sessionControl_.reset();
+    if(!sessionControl_.isServiceAllowed(buffer[0])) {
+        setNegativeResponse(response, buffer[0], SERVICE_NOT_SUPPORTED_IN_ACTIVE_SESSION);
+        return;
+    }
+    bool isWildcard;
+    // kept until the response is sent, even if the script is reloaded meanwhile
+    response.pRequestMatcher = pEcuScript_->getRawRequestMatcher(sessionControl_.getCurrentUdsSession());
+    // a suppressed request is answered by the entry of its sub-function
+    const RequestResponse *entry = response.pRequestMatcher->match(clearSuppressPosRsp(buffer, num_bytes, response.request),
+                                                                   num_bytes, &isWildcard);
+    if (pTimer) {
+        pTimer->lookupFinished(isWildcard);
+    }
+    if (entry && entry->isLuaFunction())
     {
-        vector<unsigned char> raw = pEcuScript_->literalHexStrToBytes(*response);
-        cout << "DoIP UDS sending: " << dec << raw.size() << " bytes." << endl;
-        return raw;
+        if (pTimer) {
+            pTimer->luaStarted();
+        }
+        pEcuScript_->callLuaResponse(*entry, buffer, uint32_t(num_bytes), response.buffer);
+        if (pTimer) {
+            pTimer->luaFinished();
+        }
+        response.data = response.buffer.data();
+        response.size = response.buffer.size();
+    } else if (entry) {
+        const vector<uint8_t>& bytes = entry->getBytes(sessionControl_.getResetEpoch(),
+                                                       sessionControl_.getSessionEpoch());
+        response.data = bytes.data();
+        response.size = bytes.size();
+    } else if (const ServiceDispatcher::Result result = pDispatcher_->proceedRequest(buffer, num_bytes,
+                                                                                   response.buffer, pTimer);
+               result.route != ServiceDispatcher::Route::NONE) {
+        // answered like over CAN, nothing is sent e.g. for a suppressed positive response
+        response.data = response.buffer.data();
+        response.size = result.isResponse ? response.buffer.size() : 0;
     } else {
-        vector<unsigned char> negResponse = {
-            ERROR, uint8_t(num_bytes > 0 ? buffer[0] : 0x00), SERVICE_NOT_SUPPORTED
-        };
-        cout << "DoIP UDS sending negative response." << endl;
-        return negResponse;
+        setNegativeResponse(response, buffer[0], SERVICE_NOT_SUPPORTED);
+        return;
     }
-    return vector<unsigned char>();
+    sessionControl_.reset();
+    if (entry && isSuppressPosRsp(buffer, num_bytes) && !isNegativeResponse(response.data, response.size)) {
+        // like the native services, a Raw entry does not answer with a suppressed positive response
+        response.size = 0;
+        LOG_DEBUG("DoIP UDS positive response suppressed.");
+        return;
+    }
+    LOG_DEBUG("DoIP UDS sending: " << dec << response.size << " bytes.");
+}
+
+/**
+ * Answers a request with `7F SID NRC`.
+ */
+void DoIPSimulator::setNegativeResponse(DoIPResponse& response, unsigned char sid, unsigned char nrc) noexcept {
+    response.negativeResponse[0] = ERROR;
+    response.negativeResponse[1] = sid;
+    response.negativeResponse[2] = nrc;
+    response.data = response.negativeResponse;
+    response.size = sizeof(response.negativeResponse);
+    LOG_DEBUG("DoIP UDS sending negative response.");
 }
@@ -1,15 +1,37 @@
 #ifndef DOIP_SIMULATOR_H
 #define DOIP_SIMULATOR_H
 
-#include "DoIPServer.h"
 #include "ecu_lua_script.h"
 #include "request_byte_tree_node.h"
+#include "compiled_request_matcher.h"
+#include "metrics.h"
+#include "service_dispatcher.h"
+#include "session_controller.h"
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 
 class EcuLuaScript;
 
+/**
+ * The response of a DoIP ECU, filled by `DoIPSimulator::proceedDoIPData()`.
+ * Static responses are not copied: `data` points into the compiled 'Raw'
+ * table, which is kept alive by `pRequestMatcher` until the response is sent.
+ * Only the responses of Lua functions are stored in `buffer`, which keeps its
+ * capacity if the response is reused.
+ */
+struct DoIPResponse
+{
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    std::shared_ptr<const LuaRequestMatcher> pRequestMatcher; ///< keeps a static response alive
+    std::vector<unsigned char> buffer; ///< the response of a Lua function
+    std::vector<unsigned char> request; ///< a suppressed request without the bit, see `clearSuppressPosRsp()`
+    unsigned char negativeResponse[3];
+};
+
 class DoIPSimulator
 {
 public:
@@ -17,14 +39,21 @@ public:
 
 public:
     DoIPSimulator(EcuLuaScript *pEcuScript);
-    std::vector<unsigned char> proceedDoIPData(const unsigned char* buffer, const size_t num_bytes) noexcept;
+    void proceedDoIPData(const unsigned char* buffer, const size_t num_bytes, DoIPResponse& response,
+                         RequestTimer* pTimer = nullptr) noexcept;
 
     unsigned short getLogicalEcuAddress() { return logicalEcuAddress; };
+    EcuMetrics* getMetrics() { return pMetrics_; };
 
 private:
     EcuLuaScript *pEcuScript_;
-    std::shared_ptr<RequestByteTreeNode<shared_ptr<Selector>>> requestByteTree;
     unsigned short logicalEcuAddress;
+    EcuMetrics* pMetrics_;
+    std::mutex mutex_; ///< serializes the requests of all testers, which share the session
+    SessionController sessionControl_; ///< the session over DoIP, independent of the one over CAN
+    std::unique_ptr<ServiceDispatcher> pDispatcher_; ///< the services behind the 'Raw' table, as over CAN
+
+    static void setNegativeResponse(DoIPResponse& response, unsigned char sid, unsigned char nrc) noexcept;
 
 };
 
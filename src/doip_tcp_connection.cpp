@@ -0,0 +1,480 @@
+/**
+ * @file doip_tcp_connection.cpp
+ *
+ * This file contains the TCP connection of a DoIP tester, which is handled by
+ * the `ReceiverReactor` (see ISO 13400-2 for the message format).
+ */
+
+#include "doip_tcp_connection.h"
+#include "doip_sim_server.h"
+#include "idle_monitor.h"
+#include "receiver_reactor.h"
+#include "logger.h"
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+using namespace std;
+
+/**
+ * Constructor. The connection is not handled until it is added to the reactor.
+ *
+ * @param skt: the accepted, non-blocking socket, which is closed by the connection
+ * @param pServer: the server handling the diagnostic messages
+ * @param pReactor: the reactor handling the socket
+ * @param pReceivePool: the pool of `DOIP_RECEIVE_BUFFER_SIZE` bytes buffers
+ * @param logicalGatewayAddress: the logical address of the DoIP entity
+ */
+DoIPTcpConnection::DoIPTcpConnection(int skt, DoIPSimServer* pServer, ReceiverReactor* pReactor,
+                                     BufferPool* pReceivePool, uint16_t logicalGatewayAddress)
+: skt_(skt)
+, pServer_(pServer)
+, pReactor_(pReactor)
+, logicalGatewayAddress_(logicalGatewayAddress)
+, pReceivePool_(pReceivePool)
+, receiveBuffer_(pReceivePool->acquire())
+{
+}
+
+/**
+ * Destructor. Closes the socket, the connection has to be removed from the
+ * reactor first. The receive buffer is returned to the pool.
+ */
+DoIPTcpConnection::~DoIPTcpConnection()
+{
+    close(skt_);
+    pReceivePool_->release(move(receiveBuffer_));
+}
+
+int DoIPTcpConnection::getSocket() const noexcept
+{
+    return skt_;
+}
+
+/**
+ * Writes the queued responses and reads all received messages.
+ *
+ * @param events: the epoll events that occurred
+ * @return `EPOLLIN` and `EPOLLOUT` if there are queued responses, 0 once the
+ *         connection is closed
+ */
+uint32_t DoIPTcpConnection::handleEvents(uint32_t events) noexcept
+{
+    if ((events & EPOLLOUT) && !flushSendBuffer())
+    {
+        closeConnection();
+        return 0;
+    }
+    if (events & EPOLLIN)
+    {
+        IdleMonitor::getInstance().notifyActivity();
+    }
+    if ((events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && !receiveMessages())
+    {
+        closeConnection();
+        return 0;
+    }
+    if (isClosed_)
+    {
+        return 0;
+    }
+
+    lock_guard<mutex> lock(sendMutex_);
+    return sendBuffer_.empty() ? uint32_t(EPOLLIN) : uint32_t(EPOLLIN | EPOLLOUT);
+}
+
+/**
+ * Tells the server that the connection is closed, which deletes it.
+ */
+void DoIPTcpConnection::handlerRemoved() noexcept
+{
+    pServer_->connectionClosed(this);
+}
+
+/**
+ * Sends a diagnostic message to the tester.
+ *
+ * @param sourceAddress: the logical address of the ECU
+ * @param data: the UDS message
+ * @param size: the size of the UDS message
+ */
+void DoIPTcpConnection::sendDiagnosticMessage(uint16_t sourceAddress, const uint8_t* data, size_t size) noexcept
+{
+    uint8_t addresses[4];
+    doip::writeUint16(addresses, sourceAddress);
+    doip::writeUint16(addresses + 2, testerAddress_);
+    sendMessage(DOIP_DIAGNOSTIC_MESSAGE, addresses, sizeof(addresses), data, size);
+}
+
+/**
+ * Acknowledges a received diagnostic message.
+ *
+ * @param sourceAddress: the logical address of the ECU the message was sent to
+ * @param isPositive: true for a positive ACK, otherwise a NACK is sent
+ * @param ackCode: the (N)ACK code, e.g. `DOIP_UNKNOWN_TARGET_ADDRESS`
+ */
+void DoIPTcpConnection::sendDiagnosticAck(uint16_t sourceAddress, bool isPositive, uint8_t ackCode) noexcept
+{
+    uint8_t ack[5];
+    doip::writeUint16(ack, sourceAddress);
+    doip::writeUint16(ack + 2, testerAddress_);
+    ack[4] = ackCode;
+    sendMessage(isPositive ? DOIP_DIAGNOSTIC_POSITIVE_ACK : DOIP_DIAGNOSTIC_NEGATIVE_ACK,
+                ack, sizeof(ack), nullptr, 0);
+}
+
+/**
+ * Closes the connection from the server side. The socket is only shut down
+ * here, the reactor notices it and closes the connection.
+ */
+void DoIPTcpConnection::triggerDisconnection() noexcept
+{
+    ::shutdown(skt_, SHUT_RDWR);
+}
+
+/**
+ * Reads until the socket has no more data and handles all complete messages.
+ *
+ * @return false if the connection has to be closed
+ */
+bool DoIPTcpConnection::receiveMessages() noexcept
+{
+    uint8_t* const buffer = receiveBuffer_.get();
+    while (!isClosed_)
+    {
+        if (receiveEnd_ == DOIP_RECEIVE_BUFFER_SIZE)
+        {
+            // a message never exceeds the buffer, so this makes room for its rest
+            copy(buffer + receiveStart_, buffer + receiveEnd_, buffer);
+            receiveEnd_ -= receiveStart_;
+            receiveStart_ = 0;
+        }
+
+        const ssize_t num_bytes = recv(skt_, buffer + receiveEnd_, DOIP_RECEIVE_BUFFER_SIZE - receiveEnd_,
+                                       MSG_DONTWAIT);
+        if (num_bytes == 0)
+        {
+            LOG_INFO("DoIP tester 0x" << hex << testerAddress_ << " closed the connection");
+            return false;
+        }
+        if (num_bytes < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return true;
+            }
+            LOG_WARNING(__func__ << "() recv: " << strerror(errno));
+            return false;
+        }
+
+        receiveEnd_ += size_t(num_bytes);
+        receiveStart_ += handleMessages(buffer + receiveStart_, receiveEnd_ - receiveStart_);
+        if (receiveStart_ == receiveEnd_)
+        {
+            receiveStart_ = 0;
+            receiveEnd_ = 0;
+        }
+    }
+    return true;
+}
+
+/**
+ * Handles the complete messages in the given data.
+ *
+ * @param data: the received bytes
+ * @param size: the number of received bytes
+ * @return the number of handled bytes, the rest belongs to an incomplete message
+ */
+size_t DoIPTcpConnection::handleMessages(const uint8_t* data, size_t size) noexcept
+{
+    size_t pos = 0;
+    while (pos < size && !isClosed_)
+    {
+        if (discardBytes_ > 0)
+        {
+            const size_t discarded = min(discardBytes_, size - pos);
+            discardBytes_ -= discarded;
+            pos += discarded;
+            continue;
+        }
+        if (size - pos < DOIP_HEADER_SIZE)
+        {
+            break;
+        }
+
+        const uint8_t* header = data + pos;
+        if (!doip::hasValidPattern(header))
+        {
+            LOG_WARNING("DoIP header with incorrect pattern received");
+            sendGenericNack(DOIP_INCORRECT_PATTERN);
+            closeConnection();
+            return size;
+        }
+        const uint16_t payloadType = doip::readUint16(header + 2);
+        const uint32_t length = doip::readUint32(header + 4);
+        if (length > DOIP_MAX_PAYLOAD_SIZE)
+        {
+            LOG_WARNING("DoIP message of " << dec << length << " bytes discarded");
+            sendGenericNack(DOIP_MESSAGE_TOO_LARGE);
+            discardBytes_ = length;
+            pos += DOIP_HEADER_SIZE;
+            continue;
+        }
+        if (size - pos - DOIP_HEADER_SIZE < length)
+        {
+            break;
+        }
+
+        handleMessage(payloadType, header + DOIP_HEADER_SIZE, length);
+        pos += DOIP_HEADER_SIZE + length;
+    }
+    return isClosed_ ? size : pos;
+}
+
+void DoIPTcpConnection::handleMessage(uint16_t payloadType, const uint8_t* payload, size_t length) noexcept
+{
+    switch (payloadType)
+    {
+    case DOIP_ROUTING_ACTIVATION_REQUEST:
+        handleRoutingActivation(payload, length);
+        break;
+    case DOIP_DIAGNOSTIC_MESSAGE:
+        handleDiagnosticMessage(payload, length);
+        break;
+    case DOIP_ALIVE_CHECK_RESPONSE:
+        break;
+    default:
+        LOG_WARNING("DoIP message with unknown payload type 0x" << hex << payloadType << " received");
+        sendGenericNack(DOIP_UNKNOWN_PAYLOAD_TYPE);
+        break;
+    }
+}
+
+/**
+ * Activates the routing of the tester. A connection belongs to one tester,
+ * a tester address can only be active on one connection at a time.
+ */
+void DoIPTcpConnection::handleRoutingActivation(const uint8_t* payload, size_t length) noexcept
+{
+    // source address, activation type, reserved and the optional OEM specific part
+    if (length != 7 && length != 11)
+    {
+        sendGenericNack(DOIP_INVALID_PAYLOAD_LENGTH);
+        closeConnection();
+        return;
+    }
+
+    const uint16_t sourceAddress = doip::readUint16(payload);
+    const uint8_t activationType = payload[2];
+    uint8_t responseCode = DOIP_ROUTING_SUCCESSFULLY_ACTIVATED;
+    if (activationType != 0x00 && activationType != 0x01)
+    {
+        responseCode = DOIP_ROUTING_UNSUPPORTED_TYPE;
+    }
+    else if (isRoutingActive_ && testerAddress_ != sourceAddress)
+    {
+        responseCode = DOIP_ROUTING_DIFFERENT_SOURCE_ADDRESS;
+    }
+    else if (!pServer_->isTesterAddressAvailable(this, sourceAddress))
+    {
+        responseCode = DOIP_ROUTING_SOURCE_ADDRESS_IN_USE;
+    }
+
+    uint8_t response[9] = {};
+    doip::writeUint16(response, sourceAddress);
+    doip::writeUint16(response + 2, logicalGatewayAddress_);
+    response[4] = responseCode;
+    if (responseCode == DOIP_ROUTING_SUCCESSFULLY_ACTIVATED)
+    {
+        testerAddress_ = sourceAddress;
+        isRoutingActive_ = true;
+        LOG_INFO("DoIP routing activated for tester 0x" << hex << sourceAddress);
+    }
+    sendMessage(DOIP_ROUTING_ACTIVATION_RESPONSE, response, sizeof(response), nullptr, 0);
+    if (responseCode != DOIP_ROUTING_SUCCESSFULLY_ACTIVATED
+        && responseCode != DOIP_ROUTING_DIFFERENT_SOURCE_ADDRESS)
+    {
+        closeConnection();
+    }
+}
+
+void DoIPTcpConnection::handleDiagnosticMessage(const uint8_t* payload, size_t length) noexcept
+{
+    // source address, target address and at least one byte of user data
+    if (length < 5)
+    {
+        sendGenericNack(DOIP_INVALID_PAYLOAD_LENGTH);
+        closeConnection();
+        return;
+    }
+    if (!isRoutingActive_)
+    {
+        LOG_WARNING("DoIP diagnostic message without routing activation received");
+        closeConnection();
+        return;
+    }
+
+    const uint16_t sourceAddress = doip::readUint16(payload);
+    const uint16_t targetAddress = doip::readUint16(payload + 2);
+    if (sourceAddress != testerAddress_)
+    {
+        sendDiagnosticAck(targetAddress, false, DOIP_INVALID_SOURCE_ADDRESS);
+        return;
+    }
+    pServer_->handleDiagnosticMessage(this, targetAddress, payload + 4, length - 4);
+}
+
+void DoIPTcpConnection::sendGenericNack(uint8_t nackCode) noexcept
+{
+    sendMessage(DOIP_GENERIC_NACK, &nackCode, 1, nullptr, 0);
+}
+
+/**
+ * Sends a DoIP message. The DoIP header and the first part are written
+ * together with the payload by a single `sendmsg()`, so the payload (e.g. a
+ * response of the 'Raw' table) is not copied. Nothing waits for the socket:
+ * whatever can not be written immediately is queued and written on
+ * `EPOLLOUT`.
+ *
+ * @param payloadType: the DoIP payload type
+ * @param header: the first part of the payload, e.g. the addresses
+ * @param headerSize: the size of the first part, at most `DOIP_MAX_HEADER_SIZE`
+ * @param payload: the rest of the payload, might be `nullptr`
+ * @param size: the size of the rest
+ */
+void DoIPTcpConnection::sendMessage(uint16_t payloadType, const uint8_t* header, size_t headerSize,
+                                    const uint8_t* payload, size_t size) noexcept
+{
+    const size_t length = headerSize + size;
+    uint8_t headers[DOIP_HEADER_SIZE + DOIP_MAX_HEADER_SIZE];
+    doip::writeHeader(headers, payloadType, length);
+    copy(header, header + headerSize, headers + DOIP_HEADER_SIZE);
+
+    struct iovec iov[2];
+    iov[0].iov_base = headers;
+    iov[0].iov_len = DOIP_HEADER_SIZE + headerSize;
+    iov[1].iov_base = const_cast<uint8_t*>(payload);
+    iov[1].iov_len = size;
+    const size_t total = iov[0].iov_len + iov[1].iov_len;
+
+    bool isQueued = false;
+    {
+        lock_guard<mutex> lock(sendMutex_);
+        size_t sent = 0;
+        if (sendBuffer_.empty())
+        {
+            while (sent < total)
+            {
+                struct msghdr msg = {};
+                struct iovec remaining[2];
+                msg.msg_iov = remaining;
+                if (sent < iov[0].iov_len)
+                {
+                    remaining[0].iov_base = headers + sent;
+                    remaining[0].iov_len = iov[0].iov_len - sent;
+                    remaining[1] = iov[1];
+                    msg.msg_iovlen = size > 0 ? 2 : 1;
+                }
+                else
+                {
+                    remaining[0].iov_base = const_cast<uint8_t*>(payload) + (sent - iov[0].iov_len);
+                    remaining[0].iov_len = total - sent;
+                    msg.msg_iovlen = 1;
+                }
+
+                const ssize_t num_bytes = sendmsg(skt_, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+                if (num_bytes < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    if (errno != EAGAIN && errno != EWOULDBLOCK)
+                    {
+                        LOG_WARNING(__func__ << "() sendmsg: " << strerror(errno));
+                        triggerDisconnection();
+                        return;
+                    }
+                    break;
+                }
+                sent += size_t(num_bytes);
+            }
+        }
+        if (sent < total)
+        {
+            if (sendBuffer_.size() + total - sent > DOIP_MAX_SEND_BUFFER_SIZE)
+            {
+                LOG_WARNING("DoIP tester 0x" << hex << testerAddress_ << " does not read its responses");
+                triggerDisconnection();
+                return;
+            }
+            // only copied if the tester does not keep up
+            if (sent < iov[0].iov_len)
+            {
+                sendBuffer_.insert(sendBuffer_.end(), headers + sent, headers + iov[0].iov_len);
+                sent = iov[0].iov_len;
+            }
+            sendBuffer_.insert(sendBuffer_.end(), payload + (sent - iov[0].iov_len), payload + size);
+            isQueued = true;
+        }
+    }
+    if (isQueued)
+    {
+        pReactor_->rearm(this, EPOLLIN | EPOLLOUT);
+    }
+}
+
+/**
+ * Writes the queued bytes, as far as the socket takes them.
+ *
+ * @return false if the connection has to be closed
+ */
+bool DoIPTcpConnection::flushSendBuffer() noexcept
+{
+    lock_guard<mutex> lock(sendMutex_);
+    size_t sent = 0;
+    while (sent < sendBuffer_.size())
+    {
+        const ssize_t num_bytes = send(skt_, sendBuffer_.data() + sent, sendBuffer_.size() - sent,
+                                       MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (num_bytes < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                LOG_WARNING(__func__ << "() send: " << strerror(errno));
+                return false;
+            }
+            break;
+        }
+        sent += size_t(num_bytes);
+    }
+    sendBuffer_.erase(sendBuffer_.begin(), sendBuffer_.begin() + sent);
+    return true;
+}
+
+/**
+ * Unregisters the connection from the reactor, which calls `handlerRemoved()`
+ * once `handleEvents()` returned. Only called by the reactor worker.
+ */
+void DoIPTcpConnection::closeConnection() noexcept
+{
+    if (isClosed_)
+    {
+        return;
+    }
+    isClosed_ = true;
+    isRoutingActive_ = false;
+    pReactor_->removeHandler(this);
+}
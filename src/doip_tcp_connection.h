@@ -0,0 +1,95 @@
+/**
+ * @file doip_tcp_connection.h
+ *
+ */
+
+#ifndef DOIP_TCP_CONNECTION_H
+#define DOIP_TCP_CONNECTION_H
+
+#include "doip_protocol.h"
+#include "buffer_pool.h"
+#include "reactor_handler.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/// max. size of the payload part written together with the DoIP header (e.g. the addresses)
+constexpr std::size_t DOIP_MAX_HEADER_SIZE = 16;
+/// max. queued responses of a tester which does not read them, before it is disconnected
+constexpr std::size_t DOIP_MAX_SEND_BUFFER_SIZE = 1024 * 1024;
+/// holds the largest accepted message, see `DOIP_MAX_PAYLOAD_SIZE`
+constexpr std::size_t DOIP_RECEIVE_BUFFER_SIZE = DOIP_HEADER_SIZE + DOIP_MAX_PAYLOAD_SIZE;
+
+class DoIPSimServer;
+class ReceiverReactor;
+
+/**
+ * One TCP connection of a tester to the DoIP server (ISO 13400-2). The socket
+ * is handled by a `ReceiverReactor`, so any number of testers can be connected
+ * at the same time without a thread per connection.
+ *
+ * The data is received into a buffer of the server's `BufferPool` and split
+ * into DoIP messages in place: all messages of one `recv()` are handled
+ * before the connection returns to the reactor, only the start of an
+ * incomplete message is moved to the front. The routing activation is
+ * handled here, the
+ * diagnostic messages are passed to the `DoIPSimServer`, which sends the
+ * responses back on the connection the request arrived on.
+ *
+ * Responses are written directly, if the socket is full they are queued and
+ * written on `EPOLLOUT`. The sending functions are thread-safe, since a Lua
+ * script might send messages (`sendRaw()`) from its own thread.
+ */
+class DoIPTcpConnection : public ReactorHandler
+{
+public:
+    DoIPTcpConnection(int skt, DoIPSimServer* pServer, ReceiverReactor* pReactor,
+                      BufferPool* pReceivePool, std::uint16_t logicalGatewayAddress);
+    DoIPTcpConnection(const DoIPTcpConnection& orig) = delete;
+    DoIPTcpConnection& operator =(const DoIPTcpConnection& orig) = delete;
+    virtual ~DoIPTcpConnection();
+
+    virtual int getSocket() const noexcept override;
+    virtual std::uint32_t handleEvents(std::uint32_t events) noexcept override;
+    virtual void handlerRemoved() noexcept override;
+
+    bool isRoutingActive() const noexcept { return isRoutingActive_; }
+    std::uint16_t getTesterAddress() const noexcept { return testerAddress_; }
+
+    void sendDiagnosticMessage(std::uint16_t sourceAddress, const std::uint8_t* data, std::size_t size) noexcept;
+    void sendDiagnosticAck(std::uint16_t sourceAddress, bool isPositive, std::uint8_t ackCode) noexcept;
+    void triggerDisconnection() noexcept;
+
+private:
+    int skt_;
+    DoIPSimServer* pServer_;
+    ReceiverReactor* pReactor_;
+    std::uint16_t logicalGatewayAddress_;
+    std::atomic<bool> isRoutingActive_{false};
+    std::atomic<std::uint16_t> testerAddress_{0};
+    bool isClosed_ = false;
+
+    BufferPool* pReceivePool_;
+    BufferPool::Buffer receiveBuffer_; ///< `DOIP_RECEIVE_BUFFER_SIZE` bytes of the pool
+    std::size_t receiveStart_ = 0; ///< the first not yet handled byte
+    std::size_t receiveEnd_ = 0; ///< the end of the received bytes
+    std::size_t discardBytes_ = 0; ///< remaining payload of a too large message
+
+    std::mutex sendMutex_;
+    std::vector<std::uint8_t> sendBuffer_; ///< not yet written bytes, guarded by `sendMutex_`
+
+    bool receiveMessages() noexcept;
+    std::size_t handleMessages(const std::uint8_t* data, std::size_t size) noexcept;
+    void handleMessage(std::uint16_t payloadType, const std::uint8_t* payload, std::size_t length) noexcept;
+    void handleRoutingActivation(const std::uint8_t* payload, std::size_t length) noexcept;
+    void handleDiagnosticMessage(const std::uint8_t* payload, std::size_t length) noexcept;
+    void sendGenericNack(std::uint8_t nackCode) noexcept;
+    void sendMessage(std::uint16_t payloadType, const std::uint8_t* header, std::size_t headerSize,
+                     const std::uint8_t* payload, std::size_t size) noexcept;
+    bool flushSendBuffer() noexcept;
+    void closeConnection() noexcept;
+};
+
+#endif /* DOIP_TCP_CONNECTION_H */
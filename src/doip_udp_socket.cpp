@@ -0,0 +1,290 @@
+/**
+ * @file doip_udp_socket.cpp
+ *
+ * This file contains the vehicle identification and the vehicle announcements
+ * of the DoIP entity.
+ */
+
+#include "doip_udp_socket.h"
+#include "idle_monitor.h"
+#include "logger.h"
+#include <arpa/inet.h>
+#include <ifaddrs.h>
+#include <linux/if_packet.h>
+#include <net/if.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+using namespace std;
+
+/**
+ * @return the MAC address of the first network interface (except loopback),
+ *         which is the EID if the configuration has none, 0 if there is none
+ */
+uint64_t DoIPUdpSocket::getDefaultEid() noexcept
+{
+    struct ifaddrs* pAddresses;
+    if (getifaddrs(&pAddresses) < 0)
+    {
+        LOG_WARNING(__func__ << "() getifaddrs: " << strerror(errno));
+        return 0;
+    }
+
+    uint64_t eid = 0;
+    for (struct ifaddrs* pAddress = pAddresses; pAddress != nullptr; pAddress = pAddress->ifa_next)
+    {
+        if (pAddress->ifa_addr == nullptr || pAddress->ifa_addr->sa_family != AF_PACKET
+            || (pAddress->ifa_flags & IFF_LOOPBACK))
+        {
+            continue;
+        }
+        const struct sockaddr_ll* pLink = reinterpret_cast<const struct sockaddr_ll*>(pAddress->ifa_addr);
+        if (pLink->sll_halen != EID_LENGTH)
+        {
+            continue;
+        }
+        for (size_t i = 0; i < EID_LENGTH; ++i)
+        {
+            eid = (eid << 8) | pLink->sll_addr[i];
+        }
+        break;
+    }
+    freeifaddrs(pAddresses);
+    return eid;
+}
+
+/**
+ * Constructor. The socket is not opened until `open()` is called.
+ *
+ * @param identification: the identification of the DoIP entity
+ */
+DoIPUdpSocket::DoIPUdpSocket(const VehicleIdentification& identification)
+: announceTimer_(TimerWheel::getInstance(), [this]() { sendAnnouncement(); })
+{
+    uint8_t* pPayload = announcement_ + DOIP_HEADER_SIZE;
+    doip::writeHeader(announcement_, DOIP_VEHICLE_ANNOUNCEMENT, ANNOUNCEMENT_LENGTH);
+    fill(pPayload, pPayload + VIN_LENGTH, uint8_t('0'));
+    copy_n(identification.vin.begin(), min(identification.vin.size(), VIN_LENGTH), pPayload);
+    pPayload += VIN_LENGTH;
+    doip::writeUint16(pPayload, identification.logicalAddress);
+    pPayload += 2;
+    for (size_t i = 0; i < EID_LENGTH; ++i)
+    {
+        pPayload[i] = uint8_t(identification.eid >> (8 * (EID_LENGTH - 1 - i)));
+        pPayload[EID_LENGTH + i] = uint8_t(identification.gid >> (8 * (EID_LENGTH - 1 - i)));
+    }
+    pPayload[2 * EID_LENGTH] = identification.furtherAction;
+}
+
+/**
+ * Destructor. Stops the announcements and closes the socket, which has to be
+ * removed from the reactor first.
+ */
+DoIPUdpSocket::~DoIPUdpSocket()
+{
+    announceTimer_.cancel();
+    close();
+}
+
+/**
+ * Opens the non-blocking UDP socket on the DoIP port.
+ *
+ * @param address: the IP address to bind to (e.g. "192.168.0.10"), empty
+ *                 for all addresses
+ * @return 0 on success, otherwise a negative value
+ */
+int DoIPUdpSocket::open(const string& address) noexcept
+{
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(DOIP_PORT);
+    if (!address.empty() && inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1)
+    {
+        LOG_ERROR(__func__ << "() Invalid IP address " << address);
+        return -3;
+    }
+
+    const int skt = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (skt < 0)
+    {
+        LOG_ERROR(__func__ << "() socket: " << strerror(errno));
+        return -1;
+    }
+
+    int enable = 1;
+    setsockopt(skt, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    setsockopt(skt, SOL_SOCKET, SO_BROADCAST, &enable, sizeof(enable));
+
+    if (bind(skt, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        LOG_ERROR(__func__ << "() bind: " << strerror(errno));
+        ::close(skt);
+        return -2;
+    }
+    skt_ = skt;
+    return 0;
+}
+
+/**
+ * Closes the socket, it has to be removed from the reactor first.
+ */
+void DoIPUdpSocket::close() noexcept
+{
+    if (skt_ >= 0)
+    {
+        ::close(skt_);
+        skt_ = -1;
+    }
+}
+
+/**
+ * Sends the given number of vehicle announcements. Only the first one is sent
+ * immediately (by the timer thread), so this returns without waiting for the
+ * interval, e.g. when called by a Lua script.
+ *
+ * @param count: the number of announcements (A_DoIP_Announce_Num)
+ * @param interval: the time between two announcements (A_DoIP_Announce_Interval)
+ */
+void DoIPUdpSocket::announce(int count, chrono::milliseconds interval) noexcept
+{
+    if (count <= 0)
+    {
+        return;
+    }
+    announceInterval_ = interval.count();
+    remainingAnnouncements_ = count;
+    announceTimer_.schedule(chrono::milliseconds(0));
+}
+
+int DoIPUdpSocket::getSocket() const noexcept
+{
+    return skt_;
+}
+
+/**
+ * Answers all received vehicle identification requests.
+ *
+ * @param events: the epoll events that occurred
+ * @return `EPOLLIN`, to wait for the next requests
+ */
+uint32_t DoIPUdpSocket::handleEvents(uint32_t events) noexcept
+{
+    uint8_t buffer[DOIP_HEADER_SIZE + 64];
+    while (true)
+    {
+        struct sockaddr_in sender;
+        socklen_t senderLength = sizeof(sender);
+        const ssize_t num_bytes = recvfrom(skt_, buffer, sizeof(buffer), MSG_DONTWAIT | MSG_TRUNC,
+                                           reinterpret_cast<struct sockaddr*>(&sender), &senderLength);
+        if (num_bytes < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                LOG_WARNING(__func__ << "() recvfrom: " << strerror(errno));
+            }
+            return EPOLLIN;
+        }
+        // with `MSG_TRUNC` the actual size is returned, even if it does not fit
+        handleMessage(buffer, min(size_t(num_bytes), sizeof(buffer)), sender);
+    }
+}
+
+void DoIPUdpSocket::handleMessage(const uint8_t* data, size_t size, const struct sockaddr_in& sender) noexcept
+{
+    IdleMonitor::getInstance().notifyActivity();
+    if (size < DOIP_HEADER_SIZE || !doip::hasValidPattern(data))
+    {
+        sendGenericNack(DOIP_INCORRECT_PATTERN, sender);
+        return;
+    }
+
+    const uint16_t payloadType = doip::readUint16(data + 2);
+    const uint32_t length = doip::readUint32(data + 4);
+    const uint8_t* payload = data + DOIP_HEADER_SIZE;
+    const uint8_t* identification = announcement_ + DOIP_HEADER_SIZE;
+    size_t expectedLength = 0;
+    switch (payloadType)
+    {
+    case DOIP_VEHICLE_IDENTIFICATION_REQUEST:
+        break;
+    case DOIP_VEHICLE_IDENTIFICATION_REQUEST_EID:
+        expectedLength = EID_LENGTH;
+        break;
+    case DOIP_VEHICLE_IDENTIFICATION_REQUEST_VIN:
+        expectedLength = VIN_LENGTH;
+        break;
+    case DOIP_GENERIC_NACK:
+    case DOIP_VEHICLE_ANNOUNCEMENT:
+        return; // e.g. our own broadcasts, never answered
+    default:
+        sendGenericNack(DOIP_UNKNOWN_PAYLOAD_TYPE, sender);
+        return;
+    }
+    if (length != expectedLength || size != DOIP_HEADER_SIZE + length)
+    {
+        sendGenericNack(DOIP_INVALID_PAYLOAD_LENGTH, sender);
+        return;
+    }
+
+    if (payloadType == DOIP_VEHICLE_IDENTIFICATION_REQUEST_EID
+        && !equal(payload, payload + EID_LENGTH, identification + VIN_LENGTH + 2))
+    {
+        return;
+    }
+    if (payloadType == DOIP_VEHICLE_IDENTIFICATION_REQUEST_VIN
+        && !equal(payload, payload + VIN_LENGTH, identification))
+    {
+        return;
+    }
+    LOG_DEBUG("DoIP vehicle identification request from " << inet_ntoa(sender.sin_addr));
+    sendTo(announcement_, sizeof(announcement_), sender);
+}
+
+void DoIPUdpSocket::sendTo(const uint8_t* data, size_t size, const struct sockaddr_in& address) noexcept
+{
+    if (sendto(skt_, data, size, MSG_DONTWAIT, reinterpret_cast<const struct sockaddr*>(&address),
+               sizeof(address)) < 0)
+    {
+        LOG_WARNING(__func__ << "() sendto: " << strerror(errno));
+    }
+}
+
+void DoIPUdpSocket::sendGenericNack(uint8_t nackCode, const struct sockaddr_in& address) noexcept
+{
+    uint8_t nack[DOIP_HEADER_SIZE + 1];
+    doip::writeHeader(nack, DOIP_GENERIC_NACK, 1);
+    nack[DOIP_HEADER_SIZE] = nackCode;
+    sendTo(nack, sizeof(nack), address);
+}
+
+/**
+ * Is called by the timer thread for each announcement.
+ */
+void DoIPUdpSocket::sendAnnouncement() noexcept
+{
+    if (skt_ < 0)
+    {
+        return;
+    }
+
+    struct sockaddr_in broadcast = {};
+    broadcast.sin_family = AF_INET;
+    broadcast.sin_addr.s_addr = htonl(INADDR_BROADCAST);
+    broadcast.sin_port = htons(DOIP_TEST_EQUIPMENT_PORT);
+    sendTo(announcement_, sizeof(announcement_), broadcast);
+    LOG_DEBUG("DoIP vehicle announcement sent");
+
+    if (--remainingAnnouncements_ > 0)
+    {
+        announceTimer_.schedule(chrono::milliseconds(announceInterval_.load()));
+    }
+}
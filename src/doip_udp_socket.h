@@ -0,0 +1,72 @@
+/**
+ * @file doip_udp_socket.h
+ *
+ */
+
+#ifndef DOIP_UDP_SOCKET_H
+#define DOIP_UDP_SOCKET_H
+
+#include "doip_protocol.h"
+#include "reactor_handler.h"
+#include "timer_wheel.h"
+#include <netinet/in.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * The identification of the DoIP entity, as sent in the vehicle announcements
+ * and the vehicle identification responses.
+ */
+struct VehicleIdentification
+{
+    std::string vin; ///< 17 characters, shorter ones are padded with '0'
+    std::uint16_t logicalAddress = 0;
+    std::uint64_t eid = 0; ///< 6 bytes, see `getDefaultEid()`
+    std::uint64_t gid = 0; ///< 6 bytes
+    std::uint8_t furtherAction = 0;
+};
+
+/**
+ * The UDP socket of the DoIP entity (ISO 13400-2). Vehicle identification
+ * requests are answered in the `ReceiverReactor`, like the TCP connections,
+ * and the vehicle announcements are timers of the shared `TimerWheel`. So
+ * neither needs a thread of its own and `announce()` never blocks.
+ */
+class DoIPUdpSocket : public ReactorHandler
+{
+public:
+    static std::uint64_t getDefaultEid() noexcept;
+
+    explicit DoIPUdpSocket(const VehicleIdentification& identification);
+    DoIPUdpSocket(const DoIPUdpSocket& orig) = delete;
+    DoIPUdpSocket& operator =(const DoIPUdpSocket& orig) = delete;
+    virtual ~DoIPUdpSocket();
+
+    int open(const std::string& address) noexcept;
+    void close() noexcept;
+    void announce(int count, std::chrono::milliseconds interval) noexcept;
+
+    virtual int getSocket() const noexcept override;
+    virtual std::uint32_t handleEvents(std::uint32_t events) noexcept override;
+
+private:
+    static constexpr std::size_t VIN_LENGTH = 17;
+    static constexpr std::size_t EID_LENGTH = 6;
+    static constexpr std::size_t ANNOUNCEMENT_LENGTH = VIN_LENGTH + 2 + 2 * EID_LENGTH + 1;
+
+    int skt_ = -1;
+    std::uint8_t announcement_[DOIP_HEADER_SIZE + ANNOUNCEMENT_LENGTH]; ///< the complete message, built once
+    std::atomic<int> remainingAnnouncements_{0};
+    std::atomic<std::chrono::milliseconds::rep> announceInterval_{0};
+    TimerWheel::Timer announceTimer_;
+
+    void handleMessage(const std::uint8_t* data, std::size_t size, const struct sockaddr_in& sender) noexcept;
+    void sendTo(const std::uint8_t* data, std::size_t size, const struct sockaddr_in& address) noexcept;
+    void sendGenericNack(std::uint8_t nackCode, const struct sockaddr_in& address) noexcept;
+    void sendAnnouncement() noexcept;
+};
+
+#endif /* DOIP_UDP_SOCKET_H */
@@ -0,0 +1,240 @@
+/**
+ * @file download_service.cpp
+ *
+ * Native flashing: `RequestDownload`, `TransferData` and `RequestTransferExit`
+ * without a Lua call per block.
+ */
+
+#include "download_service.h"
+#include "service_identifier.h"
+#include "libcrc/checksum.h"
+#include "logger.h"
+#include <cstring>
+
+using namespace std;
+
+/// the max. number of bytes of the memory address and the memory size
+static constexpr size_t MAX_ADDRESS_AND_LENGTH_SIZE = sizeof(uint32_t);
+
+static void setNegativeResponse(vector<uint8_t>& response, uint8_t sid, uint8_t nrc)
+{
+    response.assign({ERROR, sid, nrc});
+}
+
+static uint32_t readBigEndian(const uint8_t* data, size_t length) noexcept
+{
+    uint32_t value = 0;
+    for (size_t i = 0; i < length; ++i)
+    {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+/**
+ * @param sid: the UDS service identifier of a request
+ * @return true if the request is handled by the `DownloadService`
+ */
+bool DownloadService::isDownloadRequest(uint8_t sid) noexcept
+{
+    return sid == REQUEST_DOWNLOAD_REQ || sid == TRANSFER_DATA_REQ || sid == REQUEST_TRANSFER_EXIT_REQ;
+}
+
+/**
+ * Constructor. The image buffer is allocated by the first `RequestDownload`.
+ *
+ * @param configuration: the limits of a download
+ * @param onTransferExit: called once a download is completed, might be empty
+ */
+DownloadService::DownloadService(const DownloadConfiguration& configuration, TransferExitHandler onTransferExit)
+: configuration_(configuration)
+, onTransferExit_(move(onTransferExit))
+{
+}
+
+/**
+ * Handles a download request, see `isDownloadRequest()`.
+ *
+ * @param request: the UDS request
+ * @param length: the length of the request in bytes (min. 1 byte)
+ * @param response: replaced by the positive or negative response
+ */
+void DownloadService::proceedRequest(const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    switch (request[0])
+    {
+        case REQUEST_DOWNLOAD_REQ:
+            requestDownload(request, length, response);
+            break;
+        case TRANSFER_DATA_REQ:
+            transferData(request, length, response);
+            break;
+        case REQUEST_TRANSFER_EXIT_REQ:
+            requestTransferExit(length, response);
+            break;
+        default:
+            setNegativeResponse(response, request[0], SERVICE_NOT_SUPPORTED);
+            break;
+    }
+}
+
+/**
+ * @return true between an accepted `RequestDownload` and the `RequestTransferExit`
+ */
+bool DownloadService::isActive() const noexcept
+{
+    lock_guard<mutex> lock(mutex_);
+    return isActive_;
+}
+
+/**
+ * @return a copy of the bytes received by the current or the last download
+ */
+vector<uint8_t> DownloadService::getImage() const
+{
+    lock_guard<mutex> lock(mutex_);
+    return vector<uint8_t>(image_.get(), image_.get() + receivedBytes_);
+}
+
+/**
+ * `34 dataFormatIdentifier addressAndLengthFormatIdentifier memoryAddress memorySize`,
+ * answered with `74 20 maxNumberOfBlockLength`. A running download is
+ * aborted by a new one.
+ */
+void DownloadService::requestDownload(const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    if (length < 3)
+    {
+        setNegativeResponse(response, REQUEST_DOWNLOAD_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+    const size_t addressLength = request[2] & 0x0F;
+    const size_t sizeLength = request[2] >> 4;
+    if (length != 3 + addressLength + sizeLength)
+    {
+        setNegativeResponse(response, REQUEST_DOWNLOAD_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+    if (addressLength == 0 || addressLength > MAX_ADDRESS_AND_LENGTH_SIZE
+        || sizeLength == 0 || sizeLength > MAX_ADDRESS_AND_LENGTH_SIZE)
+    {
+        setNegativeResponse(response, REQUEST_DOWNLOAD_REQ, REQUEST_OUT_OF_RANGE);
+        return;
+    }
+    const uint32_t memoryAddress = readBigEndian(request + 3, addressLength);
+    const uint32_t memorySize = readBigEndian(request + 3 + addressLength, sizeLength);
+    if (memorySize == 0 || memorySize > configuration_.maxSize)
+    {
+        setNegativeResponse(response, REQUEST_DOWNLOAD_REQ, REQUEST_OUT_OF_RANGE);
+        return;
+    }
+
+    lock_guard<mutex> lock(mutex_);
+    if (isActive_)
+    {
+        LOG_WARNING("RequestDownload during a running download, the old one is aborted");
+    }
+    if (imageCapacity_ < memorySize)
+    {
+        image_.reset(new uint8_t[memorySize]);
+        imageCapacity_ = memorySize;
+    }
+    isActive_ = true;
+    receivedBytes_ = 0;
+    lastBlockSequenceCounter_ = 0x00;
+    summary_ = {memoryAddress, memorySize, request[1], 0, CRC_START_CCITT_FFFF};
+
+    response.assign({
+        REQUEST_DOWNLOAD_RES,
+        0x20, // lengthFormatIdentifier: 2 bytes maxNumberOfBlockLength
+        uint8_t(configuration_.maxBlockLength >> 8),
+        uint8_t(configuration_.maxBlockLength)
+    });
+}
+
+/**
+ * `36 blockSequenceCounter transferRequestParameterRecord`, answered with
+ * `76 blockSequenceCounter`.
+ */
+void DownloadService::transferData(const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    if (length < 2 || length > configuration_.maxBlockLength)
+    {
+        setNegativeResponse(response, TRANSFER_DATA_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+
+    lock_guard<mutex> lock(mutex_);
+    if (!isActive_)
+    {
+        setNegativeResponse(response, TRANSFER_DATA_REQ, REQUEST_SEQUENCE_ERROR);
+        return;
+    }
+
+    const uint8_t blockSequenceCounter = request[1];
+    if (blockSequenceCounter == lastBlockSequenceCounter_ && summary_.blockCount > 0)
+    {
+        // the tester did not get the last response, the block is already written
+        response.assign({TRANSFER_DATA_RES, blockSequenceCounter});
+        return;
+    }
+    if (blockSequenceCounter != uint8_t(lastBlockSequenceCounter_ + 1))
+    {
+        setNegativeResponse(response, TRANSFER_DATA_REQ, WRONG_BLOCK_SEQUENCE_COUNTER);
+        return;
+    }
+
+    const uint8_t* data = request + 2;
+    const size_t dataLength = length - 2;
+    if (dataLength > summary_.memorySize - receivedBytes_)
+    {
+        setNegativeResponse(response, TRANSFER_DATA_REQ, TRANSFER_DATA_SUSPENDED);
+        return;
+    }
+    memcpy(image_.get() + receivedBytes_, data, dataLength);
+    summary_.crc = update_crc_ccitt_block(summary_.crc, data, dataLength);
+    receivedBytes_ += dataLength;
+    ++summary_.blockCount;
+    lastBlockSequenceCounter_ = blockSequenceCounter;
+
+    response.assign({TRANSFER_DATA_RES, blockSequenceCounter});
+}
+
+/**
+ * `37 transferRequestParameterRecord`, answered with `77` and the result of
+ * the `onTransferExit` handler or the CRC of the image (big endian).
+ */
+void DownloadService::requestTransferExit(size_t length, vector<uint8_t>& response)
+{
+    (void) length; // the transferRequestParameterRecord is ignored
+    DownloadSummary summary;
+    {
+        lock_guard<mutex> lock(mutex_);
+        if (!isActive_ || receivedBytes_ != summary_.memorySize)
+        {
+            setNegativeResponse(response, REQUEST_TRANSFER_EXIT_REQ, REQUEST_SEQUENCE_ERROR);
+            return;
+        }
+        isActive_ = false;
+        summary = summary_;
+    }
+    LOG_INFO("Download of " << dec << summary.memorySize << " bytes to 0x" << hex << summary.memoryAddress
+             << " completed, CRC 0x" << summary.crc);
+
+    // the handler might call Lua, so the mutex is released meanwhile
+    optional<vector<uint8_t>> record;
+    if (onTransferExit_)
+    {
+        record = onTransferExit_(summary);
+    }
+    response.assign({REQUEST_TRANSFER_EXIT_RES});
+    if (record)
+    {
+        response.insert(response.cend(), record->cbegin(), record->cend());
+    }
+    else
+    {
+        response.push_back(uint8_t(summary.crc >> 8));
+        response.push_back(uint8_t(summary.crc));
+    }
+}
@@ -0,0 +1,84 @@
+/**
+ * @file download_service.h
+ *
+ */
+
+#ifndef DOWNLOAD_SERVICE_H
+#define DOWNLOAD_SERVICE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+constexpr std::size_t DEFAULT_MAX_DOWNLOAD_SIZE = 16 * 1024 * 1024; ///< 16 MiB
+constexpr std::uint16_t DEFAULT_MAX_BLOCK_LENGTH = 4095; ///< a full ISO-TP message
+
+/**
+ * The limits of a download, see the `Download` table of the ECU.
+ */
+struct DownloadConfiguration
+{
+    std::size_t maxSize = DEFAULT_MAX_DOWNLOAD_SIZE; ///< the max. `memorySize` of a `RequestDownload`
+    std::uint16_t maxBlockLength = DEFAULT_MAX_BLOCK_LENGTH; ///< incl. the SID and the block sequence counter
+};
+
+/**
+ * The result of a completed download, passed to the `onTransferExit` function.
+ */
+struct DownloadSummary
+{
+    std::uint32_t memoryAddress;
+    std::uint32_t memorySize;
+    std::uint8_t dataFormatIdentifier;
+    std::size_t blockCount; ///< the number of `TransferData` blocks, without repetitions
+    std::uint16_t crc; ///< the CRC-CCITT (0xFFFF) of the downloaded image
+};
+
+/**
+ * Native implementation of the UDS services `RequestDownload` (0x34),
+ * `TransferData` (0x36) and `RequestTransferExit` (0x37). The blocks are
+ * copied into an image buffer of the announced size and the CRC is updated
+ * block by block, so Lua is only called once at the end of the download.
+ *
+ * The block sequence counter starts at 0x01 and wraps around to 0x00. A
+ * repeated block (e.g. after a lost response) is answered again, but not
+ * written twice.
+ */
+class DownloadService
+{
+public:
+    /// returns the `transferResponseParameterRecord` or nothing to send the CRC
+    using TransferExitHandler = std::function<std::optional<std::vector<std::uint8_t>>(const DownloadSummary&)>;
+
+    static bool isDownloadRequest(std::uint8_t sid) noexcept;
+
+    DownloadService(const DownloadConfiguration& configuration, TransferExitHandler onTransferExit);
+    DownloadService(const DownloadService& orig) = delete;
+    DownloadService& operator =(const DownloadService& orig) = delete;
+    virtual ~DownloadService() = default;
+
+    void proceedRequest(const std::uint8_t* request, std::size_t length, std::vector<std::uint8_t>& response);
+    bool isActive() const noexcept;
+    std::vector<std::uint8_t> getImage() const;
+
+private:
+    const DownloadConfiguration configuration_;
+    const TransferExitHandler onTransferExit_;
+    mutable std::mutex mutex_;
+    bool isActive_ = false;
+    std::unique_ptr<std::uint8_t[]> image_; ///< kept for the next download
+    std::size_t imageCapacity_ = 0;
+    std::size_t receivedBytes_ = 0;
+    std::uint8_t lastBlockSequenceCounter_ = 0x00;
+    DownloadSummary summary_{};
+
+    void requestDownload(const std::uint8_t* request, std::size_t length, std::vector<std::uint8_t>& response);
+    void transferData(const std::uint8_t* request, std::size_t length, std::vector<std::uint8_t>& response);
+    void requestTransferExit(std::size_t length, std::vector<std::uint8_t>& response);
+};
+
+#endif /* DOWNLOAD_SERVICE_H */
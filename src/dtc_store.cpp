@@ -0,0 +1,538 @@
+/**
+ * @file dtc_store.cpp
+ *
+ * The native fault memory of an ECU, see `DtcStore`.
+ */
+
+#include "dtc_store.h"
+#include "checkpoint.h"
+
+using namespace std;
+
+static constexpr size_t BITMAP_WORD_BITS = 64;
+
+static uint32_t unpackDtc(const array<uint8_t, 4>& packed) noexcept
+{
+    return (uint32_t(packed[0]) << 16) | (uint32_t(packed[1]) << 8) | packed[2];
+}
+
+/**
+ * Adds a DTC or updates its status. Ignored while the DTC setting is off (see
+ * `ControlDTCSetting`).
+ *
+ * @param dtc: the 3 byte DTC
+ * @param status: the status byte
+ */
+void DtcStore::setDtc(uint32_t dtc, uint8_t status)
+{
+    lock_guard<mutex> lock(mutex_);
+    if (!isSettingOn_)
+    {
+        return;
+    }
+    dtc &= ALL_DTCS;
+    auto it = indices_.find(dtc);
+    size_t index;
+    if (it == indices_.end())
+    {
+        index = dtcs_.size();
+        dtcs_.push_back({uint8_t(dtc >> 16), uint8_t(dtc >> 8), uint8_t(dtc), status});
+        snapshotRecords_.emplace_back();
+        extendedDataRecords_.emplace_back();
+        indices_.emplace(dtc, index);
+        const size_t words = (dtcs_.size() + BITMAP_WORD_BITS - 1) / BITMAP_WORD_BITS;
+        if (statusBitmaps_[0].size() < words)
+        {
+            for (vector<uint64_t>& bitmap : statusBitmaps_)
+            {
+                bitmap.resize(words);
+            }
+        }
+    }
+    else
+    {
+        index = it->second;
+        if (dtcs_[index][3] == status)
+        {
+            return;
+        }
+        dtcs_[index][3] = status;
+    }
+    setStatusBits(index, status);
+    changed();
+}
+
+/**
+ * Removes a DTC and its records.
+ *
+ * @param dtc: the 3 byte DTC or `ALL_DTCS`
+ * @return false if the DTC is unknown
+ */
+bool DtcStore::clearDtc(uint32_t dtc)
+{
+    lock_guard<mutex> lock(mutex_);
+    dtc &= ALL_DTCS;
+    if (dtc == ALL_DTCS)
+    {
+        clearAll();
+        changed();
+        return true;
+    }
+    auto it = indices_.find(dtc);
+    if (it == indices_.end())
+    {
+        return false;
+    }
+
+    // the last DTC takes the place of the removed one
+    const size_t index = it->second;
+    const size_t last = dtcs_.size() - 1;
+    indices_.erase(it);
+    if (index != last)
+    {
+        dtcs_[index] = dtcs_[last];
+        snapshotRecords_[index] = move(snapshotRecords_[last]);
+        extendedDataRecords_[index] = move(extendedDataRecords_[last]);
+        indices_[unpackDtc(dtcs_[index])] = index;
+        setStatusBits(index, dtcs_[index][3]);
+    }
+    setStatusBits(last, 0x00);
+    dtcs_.pop_back();
+    snapshotRecords_.pop_back();
+    extendedDataRecords_.pop_back();
+    changed();
+    return true;
+}
+
+/**
+ * Stores a snapshot record of a DTC, replacing one with the same number.
+ *
+ * @param dtc: the 3 byte DTC
+ * @param recordNumber: the DTCSnapshotRecordNumber
+ * @param data: the record without its number, i.e. the DTCSnapshotRecordNumberOfIdentifiers and the data identifiers
+ * @return false if the DTC is unknown
+ */
+bool DtcStore::setSnapshotRecord(uint32_t dtc, uint8_t recordNumber, const vector<uint8_t>& data)
+{
+    lock_guard<mutex> lock(mutex_);
+    auto it = indices_.find(dtc & ALL_DTCS);
+    if (it == indices_.end())
+    {
+        return false;
+    }
+    setDataRecord(snapshotRecords_[it->second], recordNumber, data);
+    return true;
+}
+
+/**
+ * Stores an extended data record of a DTC, replacing one with the same number.
+ *
+ * @param dtc: the 3 byte DTC
+ * @param recordNumber: the DTCExtDataRecordNumber
+ * @param data: the record without its number
+ * @return false if the DTC is unknown
+ */
+bool DtcStore::setExtendedDataRecord(uint32_t dtc, uint8_t recordNumber, const vector<uint8_t>& data)
+{
+    lock_guard<mutex> lock(mutex_);
+    auto it = indices_.find(dtc & ALL_DTCS);
+    if (it == indices_.end())
+    {
+        return false;
+    }
+    setDataRecord(extendedDataRecords_[it->second], recordNumber, data);
+    changed();
+    return true;
+}
+
+/**
+ * @param dtc: the 3 byte DTC
+ * @param status: set to the status byte of the DTC
+ * @return false if the DTC is unknown
+ */
+bool DtcStore::getStatus(uint32_t dtc, uint8_t& status) const
+{
+    lock_guard<mutex> lock(mutex_);
+    auto it = indices_.find(dtc & ALL_DTCS);
+    if (it == indices_.end())
+    {
+        return false;
+    }
+    status = dtcs_[it->second][3];
+    return true;
+}
+
+/**
+ * @return a copy of all DTCs and their status
+ */
+vector<DtcRecord> DtcStore::getDtcs() const
+{
+    lock_guard<mutex> lock(mutex_);
+    vector<DtcRecord> dtcs;
+    dtcs.reserve(dtcs_.size());
+    for (const PackedDtc& packed : dtcs_)
+    {
+        dtcs.push_back({unpackDtc(packed), packed[3]});
+    }
+    return dtcs;
+}
+
+/**
+ * @return the number of stored DTCs
+ */
+size_t DtcStore::size() const
+{
+    lock_guard<mutex> lock(mutex_);
+    return dtcs_.size();
+}
+
+/**
+ * @param isOn: false to ignore `setDtc()`
+ */
+void DtcStore::setSettingOn(bool isOn)
+{
+    lock_guard<mutex> lock(mutex_);
+    isSettingOn_ = isOn;
+}
+
+/**
+ * Registers a function called after every change of the DTCs, their status
+ * or their extended data records, e.g. to report a status change. It is
+ * called with the lock of the store held, so it must neither block nor access
+ * the store itself.
+ *
+ * @param listener: the function to call
+ * @return the ID for `removeChangeListener()`
+ */
+int DtcStore::addChangeListener(function<void()> listener)
+{
+    lock_guard<mutex> lock(mutex_);
+    changeListeners_[nextListenerId_] = move(listener);
+    return nextListenerId_++;
+}
+
+/**
+ * Removes a change listener. It is not called anymore after returning.
+ *
+ * @param id: the ID returned by `addChangeListener()`
+ */
+void DtcStore::removeChangeListener(int id)
+{
+    lock_guard<mutex> lock(mutex_);
+    changeListeners_.erase(id);
+}
+
+/**
+ * Keeps the current DTCs and their records as the state after a reset, see
+ * `restoreInitialState()`.
+ */
+void DtcStore::saveInitialState()
+{
+    lock_guard<mutex> lock(mutex_);
+    initialDtcs_ = dtcs_;
+    initialSnapshotRecords_ = snapshotRecords_;
+    initialExtendedDataRecords_ = extendedDataRecords_;
+    initialIndices_ = indices_;
+    initialStatusBitmaps_ = statusBitmaps_;
+}
+
+/**
+ * Restores the fault memory saved by `saveInitialState()` on an `ECUReset`,
+ * with the DTC setting on.
+ */
+void DtcStore::restoreInitialState()
+{
+    lock_guard<mutex> lock(mutex_);
+    dtcs_ = initialDtcs_;
+    snapshotRecords_ = initialSnapshotRecords_;
+    extendedDataRecords_ = initialExtendedDataRecords_;
+    indices_ = initialIndices_;
+    statusBitmaps_ = initialStatusBitmaps_;
+    isSettingOn_ = true;
+    changed();
+}
+
+/**
+ * Appends the DTCs, their records and the DTC setting to a checkpoint
+ * section, see `deserialize()`.
+ *
+ * @param data: the data of the section
+ */
+void DtcStore::serialize(string& data) const
+{
+    CheckpointEncoder encoder(data);
+    auto putRecords = [&encoder](const DataRecords& records) {
+        encoder.put(uint32_t(records.size()));
+        for (const auto& record : records)
+        {
+            encoder.put(record.first);
+            encoder.putBytes(record.second.data(), record.second.size());
+        }
+    };
+    lock_guard<mutex> lock(mutex_);
+    encoder.put(uint8_t(isSettingOn_ ? 1 : 0));
+    encoder.put(uint32_t(dtcs_.size()));
+    for (size_t index = 0; index < dtcs_.size(); ++index)
+    {
+        encoder.put(unpackDtc(dtcs_[index]));
+        encoder.put(dtcs_[index][3]);
+        putRecords(snapshotRecords_[index]);
+        putRecords(extendedDataRecords_[index]);
+    }
+}
+
+/**
+ * Replaces the fault memory by the one of a checkpoint section written by
+ * `serialize()`. The state saved by `saveInitialState()` is not changed.
+ *
+ * @param data: the data of the section
+ * @return false if the data is invalid, the fault memory is not changed then
+ */
+bool DtcStore::deserialize(string_view data)
+{
+    CheckpointDecoder decoder(data);
+    auto getRecords = [&decoder](DataRecords& records) {
+        uint32_t count;
+        if (!decoder.get(count))
+        {
+            return false;
+        }
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint8_t recordNumber;
+            string_view bytes;
+            if (!decoder.get(recordNumber) || !decoder.getBytes(bytes))
+            {
+                return false;
+            }
+            records.emplace_back(recordNumber, vector<uint8_t>(bytes.cbegin(), bytes.cend()));
+        }
+        return true;
+    };
+    uint8_t isSettingOn;
+    uint32_t count;
+    if (!decoder.get(isSettingOn) || !decoder.get(count))
+    {
+        return false;
+    }
+    vector<DtcRecord> dtcs;
+    vector<DataRecords> snapshotRecords;
+    vector<DataRecords> extendedDataRecords;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        DtcRecord record;
+        snapshotRecords.emplace_back();
+        extendedDataRecords.emplace_back();
+        if (!decoder.get(record.dtc) || !decoder.get(record.status)
+            || !getRecords(snapshotRecords.back()) || !getRecords(extendedDataRecords.back()))
+        {
+            return false;
+        }
+        dtcs.push_back(record);
+    }
+
+    lock_guard<mutex> lock(mutex_);
+    clearAll();
+    const size_t words = (dtcs.size() + BITMAP_WORD_BITS - 1) / BITMAP_WORD_BITS;
+    for (vector<uint64_t>& bitmap : statusBitmaps_)
+    {
+        bitmap.resize(words);
+    }
+    for (size_t i = 0; i < dtcs.size(); ++i)
+    {
+        const uint32_t dtc = dtcs[i].dtc & ALL_DTCS;
+        if (!indices_.emplace(dtc, dtcs_.size()).second)
+        {
+            continue;
+        }
+        dtcs_.push_back({uint8_t(dtc >> 16), uint8_t(dtc >> 8), uint8_t(dtc), dtcs[i].status});
+        snapshotRecords_.push_back(move(snapshotRecords[i]));
+        extendedDataRecords_.push_back(move(extendedDataRecords[i]));
+        setStatusBits(dtcs_.size() - 1, dtcs[i].status);
+    }
+    isSettingOn_ = isSettingOn != 0;
+    changed();
+    return true;
+}
+
+/**
+ * @param statusMask: the DTCStatusMask of the request
+ * @return the number of DTCs with at least one of the status bits of the mask
+ */
+size_t DtcStore::countByStatusMask(uint8_t statusMask) const
+{
+    lock_guard<mutex> lock(mutex_);
+    size_t count = 0;
+    for (size_t word = 0; word < statusBitmaps_[0].size(); ++word)
+    {
+        uint64_t bits = 0;
+        for (unsigned bit = 0; bit < statusBitmaps_.size(); ++bit)
+        {
+            if (statusMask & (1u << bit))
+            {
+                bits |= statusBitmaps_[bit][word];
+            }
+        }
+        count += size_t(__builtin_popcountll(bits));
+    }
+    return count;
+}
+
+/**
+ * Appends `DTC status` of all DTCs with at least one of the status bits of
+ * the mask.
+ *
+ * @param statusMask: the DTCStatusMask of the request
+ * @param response: the response to append to
+ */
+void DtcStore::appendByStatusMask(uint8_t statusMask, vector<uint8_t>& response) const
+{
+    lock_guard<mutex> lock(mutex_);
+    forEachMatching(statusMask, [&](size_t index) {
+        response.insert(response.cend(), dtcs_[index].cbegin(), dtcs_[index].cend());
+    });
+}
+
+/**
+ * Appends `DTC status` of all DTCs.
+ *
+ * @param response: the response to append to
+ */
+void DtcStore::appendAll(vector<uint8_t>& response) const
+{
+    lock_guard<mutex> lock(mutex_);
+    for (const PackedDtc& packed : dtcs_)
+    {
+        response.insert(response.cend(), packed.cbegin(), packed.cend());
+    }
+}
+
+/**
+ * Appends `DTC status` and the given snapshot record of a DTC, i.e. the
+ * response of `ReadDTCInformation` 0x04.
+ *
+ * @param dtc: the 3 byte DTC
+ * @param recordNumber: the DTCSnapshotRecordNumber or `ALL_RECORDS`
+ * @param response: the response to append to
+ * @return false if the DTC is unknown
+ */
+bool DtcStore::appendSnapshotRecords(uint32_t dtc, uint8_t recordNumber, vector<uint8_t>& response) const
+{
+    return appendDataRecords(snapshotRecords_, dtc, recordNumber, response);
+}
+
+/**
+ * Appends `DTC status` and the given extended data record of a DTC, i.e. the
+ * response of `ReadDTCInformation` 0x06.
+ *
+ * @param dtc: the 3 byte DTC
+ * @param recordNumber: the DTCExtDataRecordNumber or `ALL_RECORDS`
+ * @param response: the response to append to
+ * @return false if the DTC is unknown
+ */
+bool DtcStore::appendExtendedDataRecords(uint32_t dtc, uint8_t recordNumber, vector<uint8_t>& response) const
+{
+    return appendDataRecords(extendedDataRecords_, dtc, recordNumber, response);
+}
+
+void DtcStore::setStatusBits(size_t index, uint8_t status) noexcept
+{
+    const size_t word = index / BITMAP_WORD_BITS;
+    const uint64_t mask = uint64_t(1) << (index % BITMAP_WORD_BITS);
+    for (unsigned bit = 0; bit < statusBitmaps_.size(); ++bit)
+    {
+        if (status & (1u << bit))
+        {
+            statusBitmaps_[bit][word] |= mask;
+        }
+        else
+        {
+            statusBitmaps_[bit][word] &= ~mask;
+        }
+    }
+}
+
+/**
+ * Counts a change of the fault memory and calls the change listeners, the
+ * mutex has to be locked.
+ */
+void DtcStore::changed()
+{
+    ++generation_;
+    for (const auto& listener : changeListeners_)
+    {
+        listener.second();
+    }
+}
+
+void DtcStore::clearAll() noexcept
+{
+    dtcs_.clear();
+    snapshotRecords_.clear();
+    extendedDataRecords_.clear();
+    indices_.clear();
+    for (vector<uint64_t>& bitmap : statusBitmaps_)
+    {
+        bitmap.clear();
+    }
+}
+
+/**
+ * Calls the function with the index of every DTC matching the status mask,
+ * the mutex has to be locked.
+ */
+template <typename Function>
+void DtcStore::forEachMatching(uint8_t statusMask, Function function) const
+{
+    for (size_t word = 0; word < statusBitmaps_[0].size(); ++word)
+    {
+        uint64_t bits = 0;
+        for (unsigned bit = 0; bit < statusBitmaps_.size(); ++bit)
+        {
+            if (statusMask & (1u << bit))
+            {
+                bits |= statusBitmaps_[bit][word];
+            }
+        }
+        while (bits != 0)
+        {
+            function(word * BITMAP_WORD_BITS + size_t(__builtin_ctzll(bits)));
+            bits &= bits - 1;
+        }
+    }
+}
+
+bool DtcStore::appendDataRecords(const vector<DataRecords>& records, uint32_t dtc, uint8_t recordNumber,
+                                 vector<uint8_t>& response) const
+{
+    lock_guard<mutex> lock(mutex_);
+    auto it = indices_.find(dtc & ALL_DTCS);
+    if (it == indices_.end())
+    {
+        return false;
+    }
+    const PackedDtc& packed = dtcs_[it->second];
+    response.insert(response.cend(), packed.cbegin(), packed.cend());
+    for (const auto& record : records[it->second])
+    {
+        if (recordNumber == ALL_RECORDS || record.first == recordNumber)
+        {
+            response.push_back(record.first);
+            response.insert(response.cend(), record.second.cbegin(), record.second.cend());
+        }
+    }
+    return true;
+}
+
+void DtcStore::setDataRecord(DataRecords& records, uint8_t recordNumber, const vector<uint8_t>& data)
+{
+    for (auto& record : records)
+    {
+        if (record.first == recordNumber)
+        {
+            record.second = data;
+            return;
+        }
+    }
+    records.emplace_back(recordNumber, data);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file dtc_store.h
+ *
+ */
+
+#ifndef DTC_STORE_H
+#define DTC_STORE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * One entry of the fault memory.
+ */
+struct DtcRecord
+{
+    std::uint32_t dtc; ///< the 3 byte DTC
+    std::uint8_t status; ///< the ISO 14229-1 status byte
+};
+
+/**
+ * The fault memory of one ECU, shared by its UDS and DoIP services and its
+ * Lua script.
+ *
+ * The DTCs are kept in a packed array in the byte order of a response
+ * (`DTC high, DTC middle, DTC low, status`), so a report is a copy of 4 bytes
+ * per DTC. For each of the 8 status bits, a bitmap of the DTCs with this bit
+ * set is maintained, so filtering by a status mask only touches the matching
+ * DTCs and counting them is a population count. The snapshot and extended
+ * data records are stored apart from the hot array.
+ *
+ * All functions are thread safe.
+ */
+class DtcStore
+{
+public:
+    static constexpr std::uint8_t STATUS_AVAILABILITY_MASK = 0xFF; ///< all status bits are supported
+    static constexpr std::uint32_t ALL_DTCS = 0xFFFFFF; ///< the group of all DTCs
+    static constexpr std::uint8_t ALL_RECORDS = 0xFF; ///< the record number of all records
+
+    DtcStore() = default;
+    DtcStore(const DtcStore& orig) = delete;
+    DtcStore& operator =(const DtcStore& orig) = delete;
+    virtual ~DtcStore() = default;
+
+    void setDtc(std::uint32_t dtc, std::uint8_t status);
+    bool clearDtc(std::uint32_t dtc);
+    bool setSnapshotRecord(std::uint32_t dtc, std::uint8_t recordNumber, const std::vector<std::uint8_t>& data);
+    bool setExtendedDataRecord(std::uint32_t dtc, std::uint8_t recordNumber, const std::vector<std::uint8_t>& data);
+    bool getStatus(std::uint32_t dtc, std::uint8_t& status) const;
+    std::vector<DtcRecord> getDtcs() const;
+    std::size_t size() const;
+    /// incremented on every change of the DTCs, their status or their extended data records
+    std::uint64_t getGeneration() const noexcept { return generation_.load(std::memory_order_acquire); }
+
+    /// false while no DTCs are set, see `ControlDTCSetting`
+    bool isSettingOn() const noexcept { return isSettingOn_.load(std::memory_order_relaxed); }
+    void setSettingOn(bool isOn);
+    int addChangeListener(std::function<void()> listener);
+    void removeChangeListener(int id);
+    void saveInitialState();
+    void restoreInitialState();
+    void serialize(std::string& data) const;
+    bool deserialize(std::string_view data);
+
+    std::size_t countByStatusMask(std::uint8_t statusMask) const;
+    void appendByStatusMask(std::uint8_t statusMask, std::vector<std::uint8_t>& response) const;
+    void appendAll(std::vector<std::uint8_t>& response) const;
+    bool appendSnapshotRecords(std::uint32_t dtc, std::uint8_t recordNumber, std::vector<std::uint8_t>& response) const;
+    bool appendExtendedDataRecords(std::uint32_t dtc, std::uint8_t recordNumber, std::vector<std::uint8_t>& response) const;
+
+private:
+    using PackedDtc = std::array<std::uint8_t, 4>;
+    /// the record numbers and the data of the snapshot or extended data records of a DTC
+    using DataRecords = std::vector<std::pair<std::uint8_t, std::vector<std::uint8_t>>>;
+
+    mutable std::mutex mutex_;
+    std::vector<PackedDtc> dtcs_;
+    std::vector<DataRecords> snapshotRecords_; ///< same index as `dtcs_`
+    std::vector<DataRecords> extendedDataRecords_; ///< same index as `dtcs_`
+    std::unordered_map<std::uint32_t, std::size_t> indices_; ///< DTC -> index into `dtcs_`
+    std::array<std::vector<std::uint64_t>, 8> statusBitmaps_; ///< per status bit, one bit per DTC
+    std::atomic<bool> isSettingOn_{true}; ///< read by `isSettingOn()` without the lock
+    std::atomic<std::uint64_t> generation_{0}; ///< see `getGeneration()`
+    std::map<int, std::function<void()>> changeListeners_;
+    int nextListenerId_ = 0;
+    /// the fault memory after loading the configuration, see `saveInitialState()`
+    std::vector<PackedDtc> initialDtcs_;
+    std::vector<DataRecords> initialSnapshotRecords_;
+    std::vector<DataRecords> initialExtendedDataRecords_;
+    std::unordered_map<std::uint32_t, std::size_t> initialIndices_;
+    std::array<std::vector<std::uint64_t>, 8> initialStatusBitmaps_;
+
+    void setStatusBits(std::size_t index, std::uint8_t status) noexcept;
+    void changed();
+    void clearAll() noexcept;
+    template <typename Function>
+    void forEachMatching(std::uint8_t statusMask, Function function) const;
+    bool appendDataRecords(const std::vector<DataRecords>& records, std::uint32_t dtc, std::uint8_t recordNumber,
+                           std::vector<std::uint8_t>& response) const;
+    static void setDataRecord(DataRecords& records, std::uint8_t recordNumber, const std::vector<std::uint8_t>& data);
+};
+
+#endif /* DTC_STORE_H */
@@ -0,0 +1,256 @@
+/**
+ * @file dynamic_data_service.cpp
+ *
+ * The data identifiers defined by the tester, see `DynamicDataService`.
+ */
+
+#include "dynamic_data_service.h"
+#include "service_identifier.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+static void setNegativeResponse(vector<uint8_t>& response, uint8_t sid, uint8_t nrc)
+{
+    response.assign({ERROR, sid, nrc});
+}
+
+/**
+ * @param pSessionCtrl: the session of the ECU, `nullptr` for the default session only
+ * @param reader: reads the source identifiers, called from the threads reading
+ *                the defined identifiers
+ * @param maxDataLength: the max. length of a defined record in bytes
+ */
+DynamicDataService::DynamicDataService(SessionController* pSessionCtrl, DataReader reader, size_t maxDataLength)
+: pSessionCtrl_(pSessionCtrl)
+, reader_(move(reader))
+, maxDataLength_(maxDataLength)
+{
+}
+
+/**
+ * `2C 01 dynamicDataIdentifier [sourceDataIdentifier position size]*`, answered
+ * with `6C 01 dynamicDataIdentifier`, or `2C 03 [dynamicDataIdentifier]`,
+ * answered with `6C 03 [dynamicDataIdentifier]`. A definition of an already
+ * defined identifier appends its slices.
+ */
+void DynamicDataService::proceedRequest(const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    if (length < 2)
+    {
+        setNegativeResponse(response, DYNAMICALLY_DEFINE_DATA_IDENTIFIER_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+    switch (request[1] & ~SUPPRESS_POS_RSP_MSG_INDICATION_BIT)
+    {
+        case DEFINE_BY_IDENTIFIER:
+            defineByIdentifier(request, length, response);
+            break;
+        case CLEAR_DYNAMICALLY_DEFINED_DATA_IDENTIFIER:
+            clearDefinitions(request, length, response);
+            break;
+        default:
+            setNegativeResponse(response, DYNAMICALLY_DEFINE_DATA_IDENTIFIER_REQ, SUBFUNCTION_NOT_SUPPORTED);
+            break;
+    }
+}
+
+/**
+ * Reads a defined identifier.
+ *
+ * @param session: the session to read the sources in
+ * @param dataIdentifier: the defined identifier
+ * @param data: replaced by the record
+ * @return false if the identifier is not defined or a source is unknown or
+ *         shorter than at its definition
+ */
+bool DynamicDataService::read(UdsSession session, uint16_t dataIdentifier, vector<uint8_t>& data) const
+{
+    const shared_ptr<const Definition> pDefinition = find(dataIdentifier);
+    if (!pDefinition)
+    {
+        return false;
+    }
+    data.resize(pDefinition->size);
+    return gather(session, *pDefinition, data.data());
+}
+
+/**
+ * Appends the identifier and its record to a `ReadDataByIdentifier` response.
+ *
+ * @param response: the response, unchanged if false is returned
+ * @return false if the identifier cannot be read, see `read()`
+ */
+bool DynamicDataService::appendRecord(UdsSession session, uint16_t dataIdentifier, vector<uint8_t>& response) const
+{
+    const shared_ptr<const Definition> pDefinition = find(dataIdentifier);
+    if (!pDefinition)
+    {
+        return false;
+    }
+    const size_t start = response.size();
+    response.resize(start + 2 + pDefinition->size);
+    response[start] = uint8_t(dataIdentifier >> 8);
+    response[start + 1] = uint8_t(dataIdentifier & 0xFF);
+    if (!gather(session, *pDefinition, &response[start + 2]))
+    {
+        response.resize(start);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Clears all definitions.
+ */
+void DynamicDataService::clearAll() noexcept
+{
+    lock_guard<mutex> lock(mutex_);
+    atomic_store(&pDefinitions_, make_shared<const Definitions>());
+}
+
+/**
+ * @return the number of defined identifiers
+ */
+size_t DynamicDataService::getDefinedCount() const noexcept
+{
+    return atomic_load(&pDefinitions_)->size();
+}
+
+void DynamicDataService::defineByIdentifier(const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    if (length < 8 || (length - 4) % 4 != 0)
+    {
+        setNegativeResponse(response, DYNAMICALLY_DEFINE_DATA_IDENTIFIER_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+    const uint16_t dataIdentifier = uint16_t((request[2] << 8) | request[3]);
+    if (!isDynamicIdentifier(dataIdentifier))
+    {
+        setNegativeResponse(response, DYNAMICALLY_DEFINE_DATA_IDENTIFIER_REQ, REQUEST_OUT_OF_RANGE);
+        return;
+    }
+
+    lock_guard<mutex> lock(mutex_);
+    const shared_ptr<const Definition> pPrevious = find(dataIdentifier);
+    auto pDefinition = pPrevious ? make_shared<Definition>(*pPrevious) : make_shared<Definition>();
+    // the sources are checked against their current values, read once per request
+    const UdsSession session = getCurrentSession();
+    vector<size_t> sourceSizes(pDefinition->sources.size(), SIZE_MAX);
+    vector<uint8_t> data;
+    for (size_t i = 4; i < length; i += 4)
+    {
+        const uint16_t source = uint16_t((request[i] << 8) | request[i + 1]);
+        const uint8_t position = request[i + 2];
+        const uint8_t size = request[i + 3];
+        auto iter = std::find(pDefinition->sources.cbegin(), pDefinition->sources.cend(), source);
+        const size_t index = size_t(iter - pDefinition->sources.cbegin());
+        if (iter == pDefinition->sources.cend())
+        {
+            pDefinition->sources.push_back(source);
+            sourceSizes.push_back(SIZE_MAX);
+        }
+        if (sourceSizes[index] == SIZE_MAX)
+        {
+            // a defined identifier is no source, its record is gathered itself
+            data.clear();
+            sourceSizes[index] = !isDynamicIdentifier(source) && reader_(session, source, data) ? data.size() : 0;
+        }
+        if (position == 0 || size == 0 || size_t(position - 1 + size) > sourceSizes[index]
+            || pDefinition->size + size > maxDataLength_)
+        {
+            setNegativeResponse(response, DYNAMICALLY_DEFINE_DATA_IDENTIFIER_REQ, REQUEST_OUT_OF_RANGE);
+            return;
+        }
+        pDefinition->slices.push_back(Slice{uint16_t(index), uint16_t(position - 1), size});
+        pDefinition->size += size;
+    }
+
+    auto pDefinitions = make_shared<Definitions>(*atomic_load(&pDefinitions_));
+    (*pDefinitions)[dataIdentifier] = move(pDefinition);
+    atomic_store(&pDefinitions_, shared_ptr<const Definitions>(move(pDefinitions)));
+    response.assign({DYNAMICALLY_DEFINE_DATA_IDENTIFIER_RES, DEFINE_BY_IDENTIFIER, request[2], request[3]});
+}
+
+void DynamicDataService::clearDefinitions(const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    if (length == 2)
+    {
+        clearAll();
+        response.assign({DYNAMICALLY_DEFINE_DATA_IDENTIFIER_RES, CLEAR_DYNAMICALLY_DEFINED_DATA_IDENTIFIER});
+        return;
+    }
+    if (length != 4)
+    {
+        setNegativeResponse(response, DYNAMICALLY_DEFINE_DATA_IDENTIFIER_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+    const uint16_t dataIdentifier = uint16_t((request[2] << 8) | request[3]);
+    if (!isDynamicIdentifier(dataIdentifier))
+    {
+        setNegativeResponse(response, DYNAMICALLY_DEFINE_DATA_IDENTIFIER_REQ, REQUEST_OUT_OF_RANGE);
+        return;
+    }
+    {
+        lock_guard<mutex> lock(mutex_);
+        auto pDefinitions = make_shared<Definitions>(*atomic_load(&pDefinitions_));
+        pDefinitions->erase(dataIdentifier);
+        atomic_store(&pDefinitions_, shared_ptr<const Definitions>(move(pDefinitions)));
+    }
+    response.assign({DYNAMICALLY_DEFINE_DATA_IDENTIFIER_RES, CLEAR_DYNAMICALLY_DEFINED_DATA_IDENTIFIER,
+                     request[2], request[3]});
+}
+
+/**
+ * @return the definition of the identifier, `nullptr` if it is not defined
+ */
+shared_ptr<const DynamicDataService::Definition> DynamicDataService::find(uint16_t dataIdentifier) const noexcept
+{
+    if (!isDynamicIdentifier(dataIdentifier))
+    {
+        return nullptr;
+    }
+    const shared_ptr<const Definitions> pDefinitions = atomic_load(&pDefinitions_);
+    const auto iter = pDefinitions->find(dataIdentifier);
+    return iter != pDefinitions->cend() ? iter->second : nullptr;
+}
+
+/**
+ * Reads the sources of a definition and copies its slices.
+ *
+ * @param record: receives the `size` bytes of the record
+ */
+bool DynamicDataService::gather(UdsSession session, const Definition& definition, uint8_t* record) const
+{
+    // reused by the receiver and the wheel thread, so a poll does not allocate
+    static thread_local vector<vector<uint8_t>> sources;
+    if (sources.size() < definition.sources.size())
+    {
+        sources.resize(definition.sources.size());
+    }
+    for (size_t i = 0; i < definition.sources.size(); ++i)
+    {
+        sources[i].clear();
+        if (!reader_(session, definition.sources[i], sources[i]))
+        {
+            return false;
+        }
+    }
+    for (const Slice& slice : definition.slices)
+    {
+        const vector<uint8_t>& source = sources[slice.source];
+        if (size_t(slice.offset) + slice.length > source.size())
+        {
+            return false;
+        }
+        memcpy(record, source.data() + slice.offset, slice.length);
+        record += slice.length;
+    }
+    return true;
+}
+
+UdsSession DynamicDataService::getCurrentSession() const noexcept
+{
+    return pSessionCtrl_ != nullptr ? pSessionCtrl_->getCurrentUdsSession() : UdsSession::DEFAULT;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file dynamic_data_service.h
+ *
+ */
+
+#ifndef DYNAMIC_DATA_SERVICE_H
+#define DYNAMIC_DATA_SERVICE_H
+
+#include "uds_service_handler.h"
+#include "session_controller.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+constexpr std::uint16_t FIRST_DYNAMIC_DATA_IDENTIFIER = 0xF200;
+constexpr std::uint16_t LAST_DYNAMIC_DATA_IDENTIFIER = 0xF3FF;
+
+/**
+ * `DynamicallyDefineDataIdentifier` (0x2C). A tester composes a data
+ * identifier of the range `F200` - `F3FF` of slices of other data identifiers
+ * and reads it with `ReadDataByIdentifier` or `ReadDataByPeriodicIdentifier`.
+ *
+ * A definition is checked against the current values of its sources once and
+ * kept as gather list: the distinct source identifiers and the slices
+ * (source, offset, length) in order. A read reads every source once and
+ * copies the slices into the response, so polling a composed identifier
+ * neither parses the definition nor concatenates strings.
+ *
+ * The definitions are replaced as a whole (copy on write), so a read needs no
+ * lock. They are cleared with `03` (clearDynamicallyDefinedDataIdentifier) and
+ * on `clearAll()`, e.g. on a return to the default session or an ECU reset.
+ * `02` (defineByMemoryAddress) is not supported.
+ */
+class DynamicDataService : public UdsServiceHandler
+{
+public:
+    /// reads a source identifier, returns false if it is unknown
+    using DataReader = std::function<bool(UdsSession session, std::uint16_t dataIdentifier,
+                                          std::vector<std::uint8_t>& data)>;
+
+    /// the `definitionType` of the request
+    enum DefinitionType : std::uint8_t
+    {
+        DEFINE_BY_IDENTIFIER = 0x01,
+        DEFINE_BY_MEMORY_ADDRESS = 0x02,
+        CLEAR_DYNAMICALLY_DEFINED_DATA_IDENTIFIER = 0x03
+    };
+
+    DynamicDataService(SessionController* pSessionCtrl, DataReader reader, std::size_t maxDataLength);
+    DynamicDataService(const DynamicDataService& orig) = delete;
+    DynamicDataService& operator =(const DynamicDataService& orig) = delete;
+    virtual ~DynamicDataService() = default;
+
+    void proceedRequest(const std::uint8_t* request, std::size_t length,
+                        std::vector<std::uint8_t>& response) override;
+    bool hasSubFunction(std::uint8_t sid) const noexcept override { return true; }
+
+    static bool isDynamicIdentifier(std::uint16_t dataIdentifier) noexcept
+    {
+        return dataIdentifier >= FIRST_DYNAMIC_DATA_IDENTIFIER && dataIdentifier <= LAST_DYNAMIC_DATA_IDENTIFIER;
+    }
+
+    bool read(UdsSession session, std::uint16_t dataIdentifier, std::vector<std::uint8_t>& data) const;
+    bool appendRecord(UdsSession session, std::uint16_t dataIdentifier, std::vector<std::uint8_t>& response) const;
+    void clearAll() noexcept;
+    std::size_t getDefinedCount() const noexcept;
+
+private:
+    struct Slice
+    {
+        std::uint16_t source; ///< the index of the source identifier
+        std::uint16_t offset; ///< 0-based, the request has the 1-based position
+        std::uint16_t length;
+    };
+
+    struct Definition
+    {
+        std::vector<std::uint16_t> sources; ///< the distinct source identifiers
+        std::vector<Slice> slices; ///< in the order of the record
+        std::size_t size = 0; ///< the length of the record in bytes
+    };
+
+    using Definitions = std::map<std::uint16_t, std::shared_ptr<const Definition>>;
+
+    SessionController* pSessionCtrl_; ///< might be `nullptr`, e.g. for DoIP
+    const DataReader reader_;
+    const std::size_t maxDataLength_;
+    std::mutex mutex_; ///< serializes the changes of the definitions
+    std::shared_ptr<const Definitions> pDefinitions_ = std::make_shared<const Definitions>();
+
+    void defineByIdentifier(const std::uint8_t* request, std::size_t length, std::vector<std::uint8_t>& response);
+    void clearDefinitions(const std::uint8_t* request, std::size_t length, std::vector<std::uint8_t>& response);
+    std::shared_ptr<const Definition> find(std::uint16_t dataIdentifier) const noexcept;
+    bool gather(UdsSession session, const Definition& definition, std::uint8_t* record) const;
+    UdsSession getCurrentSession() const noexcept;
+};
+
+#endif /* DYNAMIC_DATA_SERVICE_H */
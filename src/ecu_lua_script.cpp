@@ -5,8 +5,16 @@
  */
 
 #include "ecu_lua_script.h"
-#include "libcrc/crcccitt.c"
+#include "j1939_simulator.h"
+#include "checkpoint.h"
+#include "crc_stream.h"
+#include "hex_codec.h"
+#include "aes128.h"
 #include "utilities.h"
+#include "logger.h"
+#include "request_snapshot.h"
+#include "service_identifier.h"
+#include "simulation_clock.h"
 #include <iostream>
 #include <string.h>
 #include <stdio.h>
@@ -15,17 +23,270 @@
 #include <stdexcept>
 #include <unistd.h>
 #include <cassert>
+#include <cctype>
+#include <unordered_map>
 
 using namespace std;
 using namespace sel;
 
-/// Look-up table for (uppercase) hexadecimal digits [0..F].
-static constexpr char HEX_LUT[] = "0123456789ABCDEF";
-
 /// Defines the maximum size of an UDS message in bytes.
 static constexpr int MAX_UDS_SIZE = 4096;
 
-static string receivedDataBytes = "";
+/// the state of `getDataBytes()` and `createHash()`
+static CrcStream receivedDataCrc(CrcAlgorithm::CCITT_FFFF);
+static char receivedDataDigit = '\0'; ///< the first digit of a byte split between two requests
+atomic<bool> EcuLuaScript::isSnapshotEnabled_{false};
+atomic<bool> EcuLuaScript::isHotRelayoutEnabled_{false};
+
+/// the coroutine of the response function resumed by this (worker) thread, see `luaSleep()`
+static thread_local lua_State *runningCoroutine = nullptr;
+/// the registry key of the finished coroutines kept for reuse
+static const char COROUTINE_POOL_KEY = 0;
+/// the max. number of pooled coroutines per Lua state
+static constexpr size_t MAX_POOLED_COROUTINES = 16;
+
+/// the request and response buffer of a running `direct()` function
+struct DirectCall
+{
+    const uint8_t *request;
+    size_t length;
+    vector<uint8_t> *pResponse;
+};
+/// the `direct()` function running on this (worker) thread, see `simulator_request()`
+static thread_local DirectCall *pDirectCall = nullptr;
+
+/// the `cached()` wrapper, loaded into every Lua state, see `RequestResponse::pCache`
+static constexpr char CACHED_FUNCTION_PRELUDE[] = R"(
+function cached(f, ttl)
+    if type(f) == 'table' then
+        f.cache = ttl or 'pure'
+        return f
+    end
+    return { cachedFunction = f, cache = ttl or 'pure' }
+end
+)";
+
+/// the `delayed()` wrapper, loaded into every Lua state, see `RequestResponse::pDelay`
+static constexpr char DELAYED_RESPONSE_PRELUDE[] = R"(
+function delayed(response, delay)
+    return { delayedResponse = response, responseDelay = delay }
+end
+)";
+
+/**
+ * Captures the globals after loading and returns the function restoring them,
+ * see `EcuLuaScript::resetState()`. Every table reachable from `_G` (except
+ * the libraries) gets a shallow copy, which references the original tables,
+ * so restoring the copies in place keeps the identity of all tables.
+ */
+static constexpr char STATE_SNAPSHOT_CHUNK[] = R"(
+local next, type, rawset = next, type, rawset
+local libraries = {}
+for name, library in next, package.loaded do
+    if type(library) == 'table' and name ~= '_G' then libraries[library] = true end
+end
+local copies = {}
+local function capture(t)
+    if copies[t] or libraries[t] then return end
+    local copy = {}
+    copies[t] = copy
+    for k, v in next, t do
+        rawset(copy, k, v)
+        if type(k) == 'table' then capture(k) end
+        if type(v) == 'table' then capture(v) end
+    end
+end
+capture(_G)
+return function()
+    for t, copy in next, copies do
+        for k in next, t do rawset(t, k, nil) end
+        for k, v in next, copy do rawset(t, k, v) end
+    end
+end
+)";
+
+/**
+ * Encodes the globals named in the given list as Lua chunk returning a table
+ * of them, see `EcuLuaScript::saveCheckpoint()`. Numbers, strings, booleans
+ * and tables of them are kept, other values (e.g. functions) are dropped.
+ */
+static constexpr char CHECKPOINT_GLOBALS_CHUNK[] = R"(
+local names = ...
+local format, type, next, ipairs, concat = string.format, type, next, ipairs, table.concat
+local mathType = math.type
+local function encodeNumber(v)
+    if v ~= v then return '0/0' end
+    if v == 1/0 then return '1/0' end
+    if v == -1/0 then return '-1/0' end
+    if mathType and mathType(v) == 'integer' then return format('%d', v) end
+    return format('%.17g', v)
+end
+local function encode(v, visiting)
+    local t = type(v)
+    if t == 'number' then return encodeNumber(v) end
+    if t == 'string' then return format('%q', v) end
+    if t == 'boolean' then return v and 'true' or 'false' end
+    if t ~= 'table' or visiting[v] then return nil end
+    visiting[v] = true
+    local fields = {}
+    for key, value in next, v do
+        local encodedKey, encodedValue = encode(key, visiting), encode(value, visiting)
+        if encodedKey and encodedValue then fields[#fields + 1] = '[' .. encodedKey .. ']=' .. encodedValue end
+    end
+    visiting[v] = nil
+    return '{' .. concat(fields, ',') .. '}'
+end
+local fields = {}
+for _, name in ipairs(names) do
+    local value = encode(_G[name], {})
+    if value then fields[#fields + 1] = '[' .. format('%q', name) .. ']=' .. value end
+end
+return 'return {' .. concat(fields, ',') .. '}'
+)";
+
+#ifdef USE_LUAJIT
+/// the FFI declarations and the `direct()` wrapper, loaded into every Lua state
+static constexpr char DIRECT_FUNCTION_PRELUDE[] = R"(
+local ffi = require('ffi')
+ffi.cdef[[
+const uint8_t *simulator_request(size_t *length);
+uint8_t *simulator_response(size_t length);
+]]
+local request = ffi.C.simulator_request
+function direct(f)
+    return { directFunction = function (length) f(request(nil), length) end }
+end
+responseBuffer = ffi.C.simulator_response
+)";
+
+extern "C" {
+
+/**
+ * FFI: the request of the running `direct()` function.
+ *
+ * @param length: set to the length of the request, if not `NULL`
+ * @return the request bytes, `NULL` outside of a `direct()` function
+ */
+__attribute__((visibility("default"))) const uint8_t *simulator_request(size_t *length)
+{
+    if (length)
+    {
+        *length = pDirectCall ? pDirectCall->length : 0;
+    }
+    return pDirectCall ? pDirectCall->request : nullptr;
+}
+
+/**
+ * FFI: sizes the response of the running `direct()` function, which is the
+ * buffer the ECU sends from. Without a call no response is sent.
+ *
+ * @param length: the length of the response
+ * @return the response bytes to write, `NULL` outside of a `direct()` function
+ */
+__attribute__((visibility("default"))) uint8_t *simulator_response(size_t length)
+{
+    if (!pDirectCall)
+    {
+        return nullptr;
+    }
+    pDirectCall->pResponse->resize(length);
+    return pDirectCall->pResponse->data();
+}
+
+} // extern "C"
+#endif
+
+/**
+ * Pushes the first argument as big endian byte string of the given size,
+ * e.g. `u16(0xF190)` returns "\xF1\x90".
+ */
+static int pushBigEndian(lua_State *l, size_t size)
+{
+    const uint32_t value = static_cast<uint32_t> (static_cast<int64_t> (luaL_checknumber(l, 1)));
+    char bytes[sizeof(uint32_t)];
+    for (size_t i = 0; i < size; ++i)
+    {
+        bytes[i] = static_cast<char> (value >> (8 * (size - 1 - i)));
+    }
+    lua_pushlstring(l, bytes, size);
+    return 1;
+}
+
+/**
+ * Pushes the big endian number of the given size read from the byte string
+ * (1st argument) at the position (2nd argument, 1-based, default 1), e.g.
+ * `getU16(request, 2)` returns the data identifier of a
+ * `ReadDataByIdentifier` request. Pushes `nil` if the string is too short.
+ */
+static int pushReadBigEndian(lua_State *l, size_t size)
+{
+    size_t length = 0;
+    const char *bytes = luaL_checklstring(l, 1, &length);
+    const lua_Integer position = luaL_optinteger(l, 2, 1);
+    if (position < 1 || size_t(position - 1) + size > length)
+    {
+        lua_pushnil(l);
+        return 1;
+    }
+    uint32_t value = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        value = (value << 8) | static_cast<uint8_t> (bytes[position - 1 + i]);
+    }
+    lua_pushnumber(l, lua_Number(value));
+    return 1;
+}
+
+/**
+ * `sleep(ms)`: suspends a response function, which runs as coroutine on the
+ * Lua worker, by yielding the time to `resumeLuaCoroutine()`. Other Lua
+ * functions (e.g. of `ReadDataByIdentifier`) block the worker instead.
+ */
+static int luaSleep(lua_State *l)
+{
+    const lua_Integer ms = max<lua_Integer>(0, luaL_checkinteger(l, 1));
+    if (l == runningCoroutine)
+    {
+        lua_settop(l, 0);
+        lua_pushinteger(l, ms);
+        return lua_yield(l, 1);
+    }
+    EcuLuaScript::sleep(static_cast<unsigned int> (ms));
+    return 0;
+}
+
+/**
+ * `sendRawBatch(messages)`: sends the literal hex strings of the table in
+ * order, as `sendRaw()` does for each of them, without a call into the C++
+ * glue per message. The script is the upvalue of the closure.
+ */
+static int luaSendRawBatch(lua_State *l)
+{
+    EcuLuaScript *pScript = static_cast<EcuLuaScript*> (lua_touserdata(l, lua_upvalueindex(1)));
+    luaL_checktype(l, 1, LUA_TTABLE);
+    const lua_Integer count = lua_Integer(lua_rawlen(l, 1));
+    for (lua_Integer i = 1; i <= count; ++i)
+    {
+        lua_rawgeti(l, 1, i);
+        size_t length = 0;
+        const char *message = lua_tolstring(l, -1, &length);
+        if (message == nullptr)
+        {
+            return luaL_error(l, "sendRawBatch: message %d is no string", int(i));
+        }
+        pScript->sendRaw(string_view(message, length));
+        lua_pop(l, 1);
+    }
+    return 0;
+}
+
+static int luaU8(lua_State *l) { return pushBigEndian(l, 1); }
+static int luaU16(lua_State *l) { return pushBigEndian(l, 2); }
+static int luaU32(lua_State *l) { return pushBigEndian(l, 4); }
+static int luaGetU8(lua_State *l) { return pushReadBigEndian(l, 1); }
+static int luaGetU16(lua_State *l) { return pushReadBigEndian(l, 2); }
+static int luaGetU32(lua_State *l) { return pushReadBigEndian(l, 4); }
+
 /**
  * Constructor. Loads a Lua script and injects common used functions.
  *
@@ -33,88 +294,519 @@ static string receivedDataBytes = "";
  * @param luaScript: the path to the Lua script
  */
 EcuLuaScript::EcuLuaScript(const string& ecuIdent, const string& luaScript)
+: luaWorker_(new LuaWorker())
 {
-    const std::lock_guard<std::mutex> lock(luaLock_);
-
+    // No other thread knows this instance yet, so the Lua state is accessed directly.
     if (utils::existsFile(luaScript))
     {
-        // inject the C++ functions into the Lua script
-        // static functions
-        lua_state_["ascii"] = [](const string& utf8_str) -> string { return ascii(utf8_str); };
-        lua_state_["getCounterByte"] = [](const string& msg) -> string { return getCounterByte(msg); };
-        lua_state_["getDataBytes"] = [](const string& msg) { return getDataBytes(msg); };
-        lua_state_["createHash"] = []() -> string { return createHash(); };
-        lua_state_["toByteResponse"] = [](uint32_t value, uint32_t len = sizeof(uint32_t)) -> string { return toByteResponse(value, len); };
-        lua_state_["sleep"] = [](unsigned int ms) { return sleep(ms); };
-        // member functions
-        lua_state_["getCurrentSession"] = [this]() -> uint32_t { return this->getCurrentSession(); }; 
-        lua_state_["switchToSession"] = [this](uint32_t ses) { this->switchToSession(ses); };
-        lua_state_["disconnectDoip"] = [this]() { this->disconnectDoip(); }; 
-        lua_state_["sendDoipVehicleAnnouncements"] = [this]() { this->sendDoipVehicleAnnouncements(); }; 
-        lua_state_["sendRaw"] = [this](const string& msg) { this->sendRaw(msg); };
-
-        lua_state_.Load(luaScript);
-        if (lua_state_[ecuIdent.c_str()].exists())
+        sel::State &luaState = *pLuaState_;
+        loadScript(luaState, luaScript);
+        if (luaState[ecuIdent.c_str()].exists())
         {
             ecu_ident_ = ecuIdent;
+            scriptFile_ = luaScript;
+            configureLuaState(luaState);
 
-            auto requId = lua_state_[ecu_ident_.c_str()][REQ_ID_FIELD];
+            auto requId = luaState[ecu_ident_.c_str()][REQ_ID_FIELD];
             if (requId.exists())
             {
                 hasRequestId_ = true;
                 requestId_ = uint32_t(requId);
             }
 
-            auto respId = lua_state_[ecu_ident_.c_str()][RES_ID_FIELD];
+            auto respId = luaState[ecu_ident_.c_str()][RES_ID_FIELD];
             if (respId.exists())
             {
                 hasResponseId_ = true;
                 responseId_ = uint32_t(respId);
             }
 
-            auto broadcastId = lua_state_[ecu_ident_.c_str()][BROADCAST_ID_FIELD];
+            auto broadcastId = luaState[ecu_ident_.c_str()][BROADCAST_ID_FIELD];
             if (broadcastId.exists())
             {
                 hasBroadcastId_ = true;
                 broadcastId_ = uint32_t(broadcastId);
             }
 
-            auto j1939SourceAddress = lua_state_[ecu_ident_.c_str()][J1939_SOURCE_ADDRESS_FIELD];
+            auto j1939SourceAddress = luaState[ecu_ident_.c_str()][J1939_SOURCE_ADDRESS_FIELD];
             if (j1939SourceAddress.exists())
             {
                 hasJ1939SourceAddress_ = true;
                 j1939SourceAddress_ = uint32_t(j1939SourceAddress);
             }
 
-            auto doipLogicalEcuAddress = lua_state_[ecu_ident_.c_str()][DOIP_LOGICAL_ECU_ADDRESS_FIELD];
+            // the 64 bit NAME as literal hex string (MSB first), Lua numbers are too short
+            auto j1939Name = luaState[ecu_ident_.c_str()][J1939_NAME_FIELD];
+            if (j1939Name.exists())
+            {
+                for (uint8_t byte : literalHexStrToBytes(string(j1939Name)))
+                {
+                    j1939Name_ = (j1939Name_ << 8) | byte;
+                }
+            }
+
+            auto j1939ReceiveBuffer = luaState[ecu_ident_.c_str()][J1939_RECEIVE_BUFFER_FIELD];
+            if (j1939ReceiveBuffer.exists())
+            {
+                j1939ReceiveBufferSize_ = int(j1939ReceiveBuffer);
+            }
+
+            auto j1939DiagnosticMessages = luaState[ecu_ident_.c_str()][J1939_DIAGNOSTIC_MESSAGES_FIELD];
+            if (j1939DiagnosticMessages.exists())
+            {
+                hasJ1939DiagnosticMessages_ = bool(j1939DiagnosticMessages);
+            }
+
+            // the transport settings of the ISO-TP sockets
+            auto isoTp = luaState[ecu_ident_.c_str()][ISOTP_TABLE];
+            if (isoTp.isTable())
+            {
+                if (isoTp[ISOTP_BLOCK_SIZE].exists())
+                {
+                    isoTpConfiguration_.blockSize = uint8_t(uint32_t(isoTp[ISOTP_BLOCK_SIZE]));
+                }
+                if (isoTp[ISOTP_ST_MIN].exists())
+                {
+                    isoTpConfiguration_.stMin = uint8_t(uint32_t(isoTp[ISOTP_ST_MIN]));
+                }
+                if (isoTp[ISOTP_MAX_WAIT_FRAMES].exists())
+                {
+                    isoTpConfiguration_.maxWaitFrames = uint8_t(uint32_t(isoTp[ISOTP_MAX_WAIT_FRAMES]));
+                }
+                if (isoTp[ISOTP_RECEIVE_BUFFER].exists())
+                {
+                    isoTpConfiguration_.receiveBufferSize = int(isoTp[ISOTP_RECEIVE_BUFFER]);
+                }
+                if (isoTp[ISOTP_CAN_FD].exists() && bool(isoTp[ISOTP_CAN_FD]))
+                {
+                    isoTpConfiguration_.isCanFd = true;
+                    isoTpConfiguration_.txDataLength = 64;
+                    isoTpConfiguration_.isBitRateSwitch = isoTp[ISOTP_BIT_RATE_SWITCH].exists() && bool(isoTp[ISOTP_BIT_RATE_SWITCH]);
+                    if (isoTp[ISOTP_TX_DATA_LENGTH].exists())
+                    {
+                        isoTpConfiguration_.txDataLength = uint8_t(uint32_t(isoTp[ISOTP_TX_DATA_LENGTH]));
+                    }
+                }
+                if (isoTp[ISOTP_PADDING].exists())
+                {
+                    isoTpConfiguration_.padding = uint8_t(uint32_t(isoTp[ISOTP_PADDING]));
+                }
+                if (isoTp[ISOTP_EXTENDED_ADDRESS].exists())
+                {
+                    isoTpConfiguration_.extendedAddress = uint8_t(uint32_t(isoTp[ISOTP_EXTENDED_ADDRESS]));
+                    if (isoTp[ISOTP_RX_EXTENDED_ADDRESS].exists())
+                    {
+                        isoTpConfiguration_.rxExtendedAddress = uint8_t(uint32_t(isoTp[ISOTP_RX_EXTENDED_ADDRESS]));
+                    }
+                }
+                if (isoTp[ISOTP_MAX_MESSAGE_SIZE].exists())
+                {
+                    isoTpConfiguration_.maxMessageSize = uint32_t(isoTp[ISOTP_MAX_MESSAGE_SIZE]);
+                }
+            }
+
+            // either one CAN interface or a list, e.g. `{ "can0", "can1" }`
+            auto canInterface = luaState[ecu_ident_.c_str()][INTERFACE_FIELD];
+            if (canInterface.exists())
+            {
+                const string name = canInterface;
+                if (!name.empty())
+                {
+                    interfaces_.push_back(name);
+                }
+                for (int i = 1; name.empty() && canInterface[i].exists(); ++i)
+                {
+                    interfaces_.push_back(canInterface[i]);
+                }
+            }
+
+            auto doipLogicalEcuAddress = luaState[ecu_ident_.c_str()][DOIP_LOGICAL_ECU_ADDRESS_FIELD];
             if (doipLogicalEcuAddress.exists())
             {
                 hasDoIPLogicalEcuAddress_ = true;
                 doipLogicalEcuAddress_ = uint32_t(doipLogicalEcuAddress);
             }
 
+            // either the name of one entity or a list of names
+            auto doipEntity = luaState[ecu_ident_.c_str()][DOIP_ENTITY_FIELD];
+            if (doipEntity.exists())
+            {
+                const string entity = doipEntity;
+                if (!entity.empty())
+                {
+                    doipEntities_.push_back(entity);
+                }
+                for (int i = 1; entity.empty() && doipEntity[i].exists(); ++i)
+                {
+                    doipEntities_.push_back(doipEntity[i]);
+                }
+            }
+
+            // native flashing, see `DownloadService`
+            auto download = luaState[ecu_ident_.c_str()][DOWNLOAD_TABLE];
+            if (download.exists())
+            {
+                hasDownload_ = true;
+                if (download[DOWNLOAD_MAX_SIZE].exists())
+                {
+                    downloadConfiguration_.maxSize = uint32_t(download[DOWNLOAD_MAX_SIZE]);
+                }
+                if (download[DOWNLOAD_MAX_BLOCK_LENGTH].exists())
+                {
+                    downloadConfiguration_.maxBlockLength = uint16_t(uint32_t(download[DOWNLOAD_MAX_BLOCK_LENGTH]));
+                }
+            }
+
+            // native seed/key engine, see `SecurityAccessService`
+            auto securityAccess = luaState[ecu_ident_.c_str()][SECURITY_ACCESS_TABLE];
+            if (securityAccess.isTable())
+            {
+                loadSecurityLevels(securityAccess);
+            }
+
+            // asynchronous Lua responses, see `ResponsePending`
+            auto responsePending = luaState[ecu_ident_.c_str()][RESPONSE_PENDING_TABLE];
+            if (responsePending.exists())
+            {
+                hasResponsePending_ = true;
+                if (responsePending[RESPONSE_PENDING_P2].exists())
+                {
+                    responsePendingConfiguration_.p2 = chrono::milliseconds(uint32_t(responsePending[RESPONSE_PENDING_P2]));
+                }
+                if (responsePending[RESPONSE_PENDING_P2_STAR].exists())
+                {
+                    responsePendingConfiguration_.p2Star = chrono::milliseconds(uint32_t(responsePending[RESPONSE_PENDING_P2_STAR]));
+                }
+            }
+
+            // admission control of the Lua requests, see `UdsReceiver::proceedLuaResponseAsync()`
+            auto maxQueuedRequests = luaState[ecu_ident_.c_str()][MAX_QUEUED_REQUESTS_FIELD];
+            if (maxQueuedRequests.exists())
+            {
+                maxQueuedRequests_ = max(uint32_t(maxQueuedRequests), uint32_t(1));
+            }
+
+            // the response times of the ECU, see `DelayedResponses`
+            {
+                lua_State *l = luaState.GetLuaState();
+                ResetStackOnScopeExit savedStack(l);
+                lua_getglobal(l, ecu_ident_.c_str());
+                lua_getfield(l, -1, RESPONSE_DELAY_FIELD);
+                if (!lua_isnil(l, -1))
+                {
+                    pResponseDelay_ = createResponseDelay(l, lua_gettop(l));
+                }
+            }
+
+            // custom sessions, their timing and allowed services, see `SessionController`
+            auto sessions = luaState[ecu_ident_.c_str()][SESSIONS_TABLE];
+            if (sessions.isTable())
+            {
+                loadSessionConfigurations(sessions);
+            }
+
+            // ReadDataByPeriodicIdentifier, see `PeriodicDataService`
+            auto periodicData = luaState[ecu_ident_.c_str()][PERIODIC_DATA_TABLE];
+            if (periodicData.isTable() && periodicData[PERIODIC_DATA_RESPONSE_ID].exists())
+            {
+                hasPeriodicData_ = true;
+                periodicDataConfiguration_.responseId = uint32_t(periodicData[PERIODIC_DATA_RESPONSE_ID]);
+                if (periodicData[PERIODIC_DATA_SLOW_RATE].exists())
+                {
+                    periodicDataConfiguration_.slowRate = chrono::milliseconds(uint32_t(periodicData[PERIODIC_DATA_SLOW_RATE]));
+                }
+                if (periodicData[PERIODIC_DATA_MEDIUM_RATE].exists())
+                {
+                    periodicDataConfiguration_.mediumRate = chrono::milliseconds(uint32_t(periodicData[PERIODIC_DATA_MEDIUM_RATE]));
+                }
+                if (periodicData[PERIODIC_DATA_FAST_RATE].exists())
+                {
+                    periodicDataConfiguration_.fastRate = chrono::milliseconds(uint32_t(periodicData[PERIODIC_DATA_FAST_RATE]));
+                }
+            }
+            else if (periodicData.exists())
+            {
+                LOG_ERROR("The " << PERIODIC_DATA_TABLE << " table of " << ecu_ident_ << " has no " << PERIODIC_DATA_RESPONSE_ID);
+            }
+
+            // native OBD modes 0x01 and 0x09, see `ObdService`
+            auto obd = luaState[ecu_ident_.c_str()][OBD_TABLE];
+            if (obd.isTable())
+            {
+                loadObdPids(obd);
+            }
+
+            // native ReadMemoryByAddress and WriteMemoryByAddress, see `MemoryService`
+            auto memory = luaState[ecu_ident_.c_str()][MEMORY_TABLE];
+            if (memory.isTable())
+            {
+                loadMemoryRegions(memory);
+            }
+
+            // plain CAN frames, see `CanFrameBus`
+            auto canFrames = luaState[ecu_ident_.c_str()][CAN_FRAMES_TABLE];
+            if (canFrames.isTable())
+            {
+                loadCanFrames(canFrames);
+            }
+
+            // DIDs, OBD PIDs and PGNs encoded from the vehicle signals, see `SignalRecord`
+            auto signals = luaState[ecu_ident_.c_str()][SIGNALS_TABLE];
+            if (signals.isTable())
+            {
+                pSignalMappings_ = loadSignalMappings(signals);
+            }
+
+            // the initial fault memory, see `DtcStore`
+            auto dtcs = luaState[ecu_ident_.c_str()][DTC_TABLE];
+            if (dtcs.exists())
+            {
+                loadDtcs(dtcs);
+            }
+
+            // keep the written DIDs over restarts, see `DidStore`
+            auto didStoreFile = luaState[ecu_ident_.c_str()][DID_STORE_FILE_FIELD];
+            if (didStoreFile.exists())
+            {
+                pDidStore_->open(string(didStoreFile));
+            }
+
+            // answer the requests from a recorded trace before the 'Raw' table, see `ReplayTrace`
+            auto replay = luaState[ecu_ident_.c_str()][REPLAY_FIELD];
+            if (replay.exists())
+            {
+                replayFile_ = string(replay);
+            }
+
+            pDtcStore_->saveInitialState();
+            pDataIdentifierIndices_ = compileDataIdentifierIndices(luaState);
+            publishRequestHits();
+            createTableRefs();
+            captureLuaState();
             return;
         }
     }
 }
 
+/**
+ * Creates a Lua state with the standard libraries. Its memory comes from a
+ * `LuaMemoryPool` of its own, which is released together with the state, so
+ * the states of the ECUs don't share and fragment one heap. LuaJIT manages
+ * its memory itself (a custom allocator is not supported on 64 bit), so its
+ * states use the default allocator and are not counted. The `LuaProfiler`
+ * samples the state if it is enabled.
+ *
+ * @param pStatistics: the memory statistics of the ECU
+ * @return the new state
+ */
+shared_ptr<sel::State> EcuLuaScript::createLuaState(const shared_ptr<LuaMemoryStatistics>& pStatistics)
+{
+#ifdef USE_LUAJIT
+    (void) pStatistics;
+    auto pLuaState = make_shared<sel::State>(true);
+    LuaProfiler::getInstance().attach(pLuaState->GetLuaState());
+    return pLuaState;
+#else
+    // the state is declared last, so it is closed before its pool is released
+    struct PooledState
+    {
+        LuaMemoryPool pool;
+        sel::State state;
+
+        explicit PooledState(const shared_ptr<LuaMemoryStatistics>& pStatistics)
+        : pool(pStatistics)
+        , state(&LuaMemoryPool::allocate, &pool, true)
+        {
+        }
+    };
+    auto pPooledState = make_shared<PooledState>(pStatistics);
+    LuaProfiler::getInstance().attach(pPooledState->state.GetLuaState());
+    return shared_ptr<sel::State>(pPooledState, &pPooledState->state);
+#endif
+}
+
+/**
+ * Applies the `Lua` table of the ECU to a loaded state: the memory limit of
+ * its `LuaMemoryPool` and the mode and parameters of the garbage collector.
+ * The limit applies after loading the script, a script exceeding it fails
+ * with "not enough memory" in the functions called later.
+ *
+ * @param luaState: the state with the loaded script
+ */
+void EcuLuaScript::configureLuaState(sel::State& luaState)
+{
+    auto luaTable = luaState[ecu_ident_.c_str()][LUA_TABLE];
+    if (!luaTable.isTable())
+    {
+        return;
+    }
+    lua_State *l = luaState.GetLuaState();
+    if (luaTable[LUA_MEMORY_LIMIT].exists())
+    {
+#ifdef USE_LUAJIT
+        LOG_WARNING(ecu_ident_ << "." << LUA_TABLE << "." << LUA_MEMORY_LIMIT << " is not supported with LuaJIT");
+#else
+        void *pPool = nullptr;
+        lua_getallocf(l, &pPool);
+        static_cast<LuaMemoryPool*> (pPool)->setLimit(uint32_t(luaTable[LUA_MEMORY_LIMIT]));
+#endif
+    }
+    if (luaTable[LUA_GC_MODE].exists())
+    {
+        const string mode = luaTable[LUA_GC_MODE];
+        if (mode == "incremental")
+        {
+#ifdef LUA_GCINC
+            lua_gc(l, LUA_GCINC, 0);
+#endif
+        }
+        else if (mode == "generational")
+        {
+#ifdef LUA_GCGEN
+            lua_gc(l, LUA_GCGEN, 0);
+#else
+            LOG_WARNING("The generational garbage collector is not supported by this Lua version");
+#endif
+        }
+        else
+        {
+            LOG_ERROR("Unknown garbage collector of " << ecu_ident_ << ": " << mode);
+        }
+    }
+    if (luaTable[LUA_GC_PAUSE].exists())
+    {
+        lua_gc(l, LUA_GCSETPAUSE, int(luaTable[LUA_GC_PAUSE]));
+    }
+    if (luaTable[LUA_GC_STEP_MULTIPLIER].exists())
+    {
+        lua_gc(l, LUA_GCSETSTEPMUL, int(luaTable[LUA_GC_STEP_MULTIPLIER]));
+    }
+}
+
+/**
+ * Injects the C++ functions into the given Lua state and executes the script.
+ * The functions are bound to this instance, so a state loaded by `reload()`
+ * behaves like the one of the constructor.
+ *
+ * @param luaState: a new Lua state, which is not used by other threads yet
+ * @param luaScript: the path to the Lua script
+ * @return false if the script could not be loaded (e.g. a syntax error)
+ */
+bool EcuLuaScript::loadScript(sel::State& luaState, const string& luaScript)
+{
+    // static functions
+    luaState["ascii"] = [](const string& utf8_str) -> string { return ascii(utf8_str); };
+    luaState["getCounterByte"] = [](const string& msg) -> string { return getCounterByte(msg); };
+    luaState["getDataBytes"] = [](const string& msg) { return getDataBytes(msg); };
+    luaState["createHash"] = []() -> string { return createHash(); };
+    luaState["toByteResponse"] = [](uint32_t value, uint32_t len = sizeof(uint32_t)) -> string { return toByteResponse(value, len); };
+    // member functions
+    luaState["getCurrentSession"] = [this]() -> uint32_t { return this->getCurrentSession(); }; 
+    luaState["switchToSession"] = [this](uint32_t ses) { this->switchToSession(ses); };
+    luaState["disconnectDoip"] = [this]() { this->disconnectDoip(); }; 
+    luaState["sendDoipVehicleAnnouncements"] = [this]() { this->sendDoipVehicleAnnouncements(); }; 
+    luaState["sendRaw"] = [this](const string& msg) { this->sendRaw(msg); };
+    // binary calling convention, see `RequestResponse::isBinary`
+    lua_State *l = luaState.GetLuaState();
+    lua_register(l, "sleep", luaSleep);
+    lua_pushlightuserdata(l, this);
+    lua_pushcclosure(l, luaSendRawBatch, 1);
+    lua_setglobal(l, "sendRawBatch");
+    lua_register(l, "u8", luaU8);
+    lua_register(l, "u16", luaU16);
+    lua_register(l, "u32", luaU32);
+    lua_register(l, "getU8", luaGetU8);
+    lua_register(l, "getU16", luaGetU16);
+    lua_register(l, "getU32", luaGetU32);
+    luaState((string("function binary(f) return { ") + BINARY_FUNCTION_FIELD + " = f } end").c_str());
+#ifdef USE_LUAJIT
+    // FFI calling convention, see `RequestResponse::isDirect`
+    luaState(DIRECT_FUNCTION_PRELUDE);
+#endif
+    luaState(CACHED_FUNCTION_PRELUDE);
+    luaState(DELAYED_RESPONSE_PRELUDE);
+    luaState["invalidateCache"] = [this]() { this->invalidateCache(); };
+    luaState["crcCreate"] = [this](const string& algorithm) -> uint32_t { return this->crcCreate(algorithm); };
+    luaState["crcUpdate"] = [this](uint32_t handle, const string& bytes) -> uint32_t { return this->crcUpdate(handle, bytes); };
+    luaState["crcValue"] = [this](uint32_t handle) -> uint32_t { return this->crcValue(handle); };
+    luaState["crcRelease"] = [this](uint32_t handle) { this->crcRelease(handle); };
+    luaState["setDTC"] = [this](uint32_t dtc, uint32_t status) { this->setDtc(dtc, status); };
+    luaState["clearDTC"] = [this](uint32_t dtc) -> bool { return this->clearDtc(dtc); };
+    luaState["setDTCSetting"] = [this](bool isOn) { this->pDtcStore_->setSettingOn(isOn); };
+    luaState["isDTCSettingOn"] = [this]() -> bool { return this->pDtcStore_->isSettingOn(); };
+    luaState["setCommunicationControl"] = [this](uint32_t controlType, uint32_t communicationType) -> bool {
+        return this->setCommunicationControl(controlType, communicationType);
+    };
+    luaState["getCommunicationControl"] = [this]() -> uint32_t { return this->pCommunicationGate_->getControlType(); };
+    luaState["getDTCStatus"] = [this](uint32_t dtc) -> uint32_t { return this->getDtcStatus(dtc); };
+    luaState["setDTCSnapshot"] = [this](uint32_t dtc, uint32_t recordNumber, const string& data) -> bool {
+        return this->setDtcSnapshot(dtc, recordNumber, data);
+    };
+    luaState["setDTCExtendedData"] = [this](uint32_t dtc, uint32_t recordNumber, const string& data) -> bool {
+        return this->setDtcExtendedData(dtc, recordNumber, data);
+    };
+    luaState["invalidatePGN"] = [this](const string& pgn) { this->invalidatePGN(pgn); };
+    luaState["setPGNPayload"] = [this](const string& pgn, const string& payload) { this->setPGNPayload(pgn, payload); };
+    luaState["setSignal"] = [](const string& name, double value) { setSignal(name, value); };
+    luaState["getSignal"] = [](const string& name) -> double { return getSignal(name); };
+
+    return luaState.Load(luaScript);
+}
+
 /**
  * Move constructor.
  * 
  * @param orig: the originating instance
  */
 EcuLuaScript::EcuLuaScript(EcuLuaScript&& orig) noexcept
-: lua_state_(move(orig.lua_state_))
+: pLuaMemory_(move(orig.pLuaMemory_))
+, pLuaState_(move(orig.pLuaState_))
+, pJ1939Version_(move(orig.pJ1939Version_))
 , ecu_ident_(move(orig.ecu_ident_))
+, scriptFile_(move(orig.scriptFile_))
 , pSessionCtrl_(orig.pSessionCtrl_)
-, pIsoTpSender_(orig.pIsoTpSender_)
+, pTransport_(orig.pTransport_)
+, pJ1939Simulator_(orig.pJ1939Simulator_)
 , requestId_(orig.requestId_)
 , responseId_(orig.responseId_)
 , broadcastId_(orig.broadcastId_)
+, interfaces_(move(orig.interfaces_))
 , j1939SourceAddress_(orig.j1939SourceAddress_)
+, j1939Name_(orig.j1939Name_)
+, j1939ReceiveBufferSize_(orig.j1939ReceiveBufferSize_)
+, hasJ1939DiagnosticMessages_(orig.hasJ1939DiagnosticMessages_)
+, isoTpConfiguration_(orig.isoTpConfiguration_)
+, replayFile_(move(orig.replayFile_))
+, hasDownload_(orig.hasDownload_)
+, downloadConfiguration_(orig.downloadConfiguration_)
+, securityLevels_(move(orig.securityLevels_))
+, hasResponsePending_(orig.hasResponsePending_)
+, responsePendingConfiguration_(orig.responsePendingConfiguration_)
+, maxQueuedRequests_(orig.maxQueuedRequests_)
+, pResponseDelay_(move(orig.pResponseDelay_))
+, sessionConfigurations_(move(orig.sessionConfigurations_))
+, hasPeriodicData_(orig.hasPeriodicData_)
+, periodicDataConfiguration_(orig.periodicDataConfiguration_)
+, obdPids_(move(orig.obdPids_))
+, canFrames_(move(orig.canFrames_))
+, pSignalMappings_(move(orig.pSignalMappings_))
+, pDtcStore_(move(orig.pDtcStore_))
+, pDidStore_(move(orig.pDidStore_))
+, pCommunicationGate_(move(orig.pCommunicationGate_))
+, pDataIdentifierIndices_(move(orig.pDataIdentifierIndices_))
+, ecuTableRef_(move(orig.ecuTableRef_))
+, dataIdentifierTableRefs_(move(orig.dataIdentifierTableRefs_))
+, restoreStateRef_(move(orig.restoreStateRef_))
+, pRawRequestMatchers_(move(orig.pRawRequestMatchers_))
+, pJ1939Tables_(move(orig.pJ1939Tables_))
+, pRequestHits_(move(orig.pRequestHits_))
+, crcStreams_(move(orig.crcStreams_))
+, pCacheEpoch_(move(orig.pCacheEpoch_))
+, luaWorker_(move(orig.luaWorker_))
 {
     orig.pSessionCtrl_ = nullptr;
-    orig.pIsoTpSender_ = nullptr;
+    orig.pTransport_ = nullptr;
+    orig.pJ1939Simulator_ = nullptr;
 }
 
 /**
@@ -126,16 +818,52 @@ EcuLuaScript::EcuLuaScript(EcuLuaScript&& orig) noexcept
 EcuLuaScript& EcuLuaScript::operator=(EcuLuaScript&& orig) noexcept
 {
     assert(this != &orig);
-    lua_state_ = move(orig.lua_state_);
+    pLuaMemory_ = move(orig.pLuaMemory_);
+    pLuaState_ = move(orig.pLuaState_);
+    pJ1939Version_ = move(orig.pJ1939Version_);
     ecu_ident_ = move(orig.ecu_ident_);
+    scriptFile_ = move(orig.scriptFile_);
     pSessionCtrl_ = orig.pSessionCtrl_;
-    pIsoTpSender_ = orig.pIsoTpSender_;
+    pTransport_ = orig.pTransport_;
+    pJ1939Simulator_ = orig.pJ1939Simulator_;
     requestId_ = orig.requestId_;
     responseId_ = orig.responseId_;
     broadcastId_ = orig.broadcastId_;
+    interfaces_ = move(orig.interfaces_);
     j1939SourceAddress_ = orig.j1939SourceAddress_;
-    orig.pIsoTpSender_ = nullptr;
+    j1939Name_ = orig.j1939Name_;
+    j1939ReceiveBufferSize_ = orig.j1939ReceiveBufferSize_;
+    hasJ1939DiagnosticMessages_ = orig.hasJ1939DiagnosticMessages_;
+    isoTpConfiguration_ = orig.isoTpConfiguration_;
+    replayFile_ = move(orig.replayFile_);
+    hasDownload_ = orig.hasDownload_;
+    downloadConfiguration_ = orig.downloadConfiguration_;
+    securityLevels_ = move(orig.securityLevels_);
+    hasResponsePending_ = orig.hasResponsePending_;
+    responsePendingConfiguration_ = orig.responsePendingConfiguration_;
+    maxQueuedRequests_ = orig.maxQueuedRequests_;
+    pResponseDelay_ = move(orig.pResponseDelay_);
+    sessionConfigurations_ = move(orig.sessionConfigurations_);
+    hasPeriodicData_ = orig.hasPeriodicData_;
+    periodicDataConfiguration_ = orig.periodicDataConfiguration_;
+    obdPids_ = move(orig.obdPids_);
+    canFrames_ = move(orig.canFrames_);
+    pSignalMappings_ = move(orig.pSignalMappings_);
+    pDtcStore_ = move(orig.pDtcStore_);
+    pDidStore_ = move(orig.pDidStore_);
+    pCommunicationGate_ = move(orig.pCommunicationGate_);
+    pDataIdentifierIndices_ = move(orig.pDataIdentifierIndices_);
+    ecuTableRef_ = move(orig.ecuTableRef_);
+    dataIdentifierTableRefs_ = move(orig.dataIdentifierTableRefs_);
+    restoreStateRef_ = move(orig.restoreStateRef_);
+    pRawRequestMatchers_ = move(orig.pRawRequestMatchers_);
+    pJ1939Tables_ = move(orig.pJ1939Tables_);
+    pRequestHits_ = move(orig.pRequestHits_);
+    crcStreams_ = move(orig.crcStreams_);
+    luaWorker_ = move(orig.luaWorker_);
+    orig.pTransport_ = nullptr;
     orig.pSessionCtrl_ = nullptr;
+    orig.pJ1939Simulator_ = nullptr;
     return *this;
 };
 
@@ -186,24 +914,15 @@ uint8_t EcuLuaScript::getJ1939SourceAddress() const
 
 /**
  * Reads the data according to `ReadDataByIdentifier`-table in the Lua script.
+ * Static entries are served from the values compiled at load time, only
+ * functions are evaluated in Lua.
  *
  * @param identifier: the identifier to access the field in the Lua table
  * @return the identifier field on success, otherwise an empty string
  */
 string EcuLuaScript::getDataByIdentifier(const string& identifier)
 {
-    const std::lock_guard<std::mutex> lock(luaLock_);
-
-    auto val = lua_state_[ecu_ident_.c_str()][READ_DATA_BY_IDENTIFIER_TABLE][identifier];
-
-    if (val.isFunction())
-    {
-        return val(identifier);
-    }
-    else
-    {
-        return val;
-    }
+    return getDataByIdentifier(identifier, "");
 }
 
 /**
@@ -215,72 +934,179 @@ string EcuLuaScript::getDataByIdentifier(const string& identifier)
  */
 string EcuLuaScript::getDataByIdentifier(const string& identifier, const string& session)
 {
-    const std::lock_guard<std::mutex> lock(luaLock_);
-
-    auto val = lua_state_[ecu_ident_.c_str()][session][READ_DATA_BY_IDENTIFIER_TABLE][identifier];
-
-    if (val.isFunction())
-    {
-        return val(identifier);
-    }
-    else
+    const vector<uint8_t> did = literalHexStrToBytes(cleanupString(identifier));
+    if (did.size() == 2)
     {
-        return val;
+        const auto pIndices = getDataIdentifierIndices();
+        const DataIdentifierIndex::Entry *entry = findDataIdentifier(*pIndices, session, uint16_t((did[0] << 8) + did[1]));
+        if (entry != nullptr)
+        {
+            return readDataIdentifier(session, *entry);
+        }
     }
+
+    return luaWorker_->call([&]() -> string {
+        return callDataIdentifier(session, identifier);
+    });
 }
 
-string EcuLuaScript::getSeed(uint8_t seed_level)
+/**
+ * Returns the index of the `ReadDataByIdentifier` tables built at load time.
+ * Keep the returned pointer while using its entries, a `reload()` replaces
+ * the index.
+ *
+ * @return the index of the current version of the script
+ */
+shared_ptr<const EcuLuaScript::DataIdentifierIndices> EcuLuaScript::getDataIdentifierIndices() const
 {
-    const std::lock_guard<std::mutex> lock(luaLock_);
+    return atomic_load(&pDataIdentifierIndices_);
+}
 
-    auto val = lua_state_[ecu_ident_.c_str()][READ_SEED][seed_level];
-    if (val.exists())
+/**
+ * Looks up the given data identifier in the index built at load time.
+ *
+ * @param indices: the index returned by `getDataIdentifierIndices()`
+ * @param session: the session name ("" for the default session)
+ * @param identifier: the numeric data identifier (e.g. `0xF190`)
+ * @return the index entry or `nullptr` if there is no entry
+ */
+const DataIdentifierIndex::Entry *EcuLuaScript::findDataIdentifier(const DataIdentifierIndices& indices,
+                                                                   string_view session, uint16_t identifier)
+{
+    auto index = indices.find(session);
+    if (index == indices.end())
     {
-        return val;
+        return nullptr;
     }
-    return "";
+    return index->second.find(identifier);
 }
 
 /**
- * Converts a literal hex string into a value vector.
+ * Gets the data of an index entry. Static values are returned directly, only
+ * functions are called in Lua.
  *
- * @param hexString: the literal hex string (e.g. "41 6f 54")
- * @return a vector with the byte values
+ * @param session: the session name the entry belongs to
+ * @param entry: the entry returned by `findDataIdentifier()`
+ * @return the data or an empty string
  */
-vector<uint8_t> EcuLuaScript::literalHexStrToBytes(const string& hexString)
+string EcuLuaScript::readDataIdentifier(const string& session, const DataIdentifierIndex::Entry& entry)
 {
-    // make a working copy
-    string tmpStr = hexString;
-    // remove white spaces from string
-    tmpStr.erase(remove(tmpStr.begin(), tmpStr.end(), ' '), tmpStr.end());
-    vector<uint8_t> data;
-    // plus `% 2` just in case of a "odd" byte number
-    data.reserve(tmpStr.length() / 2 + (tmpStr.length() % 2));
-    string byteString;
-    uint8_t byte;
-    for (size_t i = 0; i < tmpStr.length(); i += 2)
+    if (!entry.isLuaFunction)
     {
-        byteString = tmpStr.substr(i, 2);
-        byte = static_cast<uint8_t> (strtol(byteString.c_str(), NULL, 16));
-        data.push_back(byte);
+        return entry.data;
     }
-    cout << endl;
-    return data;
+    string value;
+    readDataIdentifier(session, entry, value);
+    return value;
 }
 
 /**
- * Convert the given string into another string that represents the hex bytes of
- * the input string. This is a convenience function to use ascii strings in
- * responses.
+ * Gets the data of an index entry into the given string, like the variant
+ * above. The string keeps its capacity and a function result is copied from
+ * the Lua string directly, so reading into a reused string does not allocate.
  *
- * Example:
- *     `ascii("Hello")` -> `" 48 65 6C 6C 6F "`
- *
- * @param utf8_str: the input string to convert
- * @return a literal string of hex bytes (e.g. " 12 4A FF ") or an empty string
- * on error
- *
- * @note To allow a seamless string concatenation, the returned string always
+ * @param session: the session name the entry belongs to
+ * @param entry: the entry returned by `findDataIdentifier()`
+ * @param value: replaced by the data, empty on errors
+ */
+void EcuLuaScript::readDataIdentifier(const string& session, const DataIdentifierIndex::Entry& entry, string& value)
+{
+    if (!entry.isLuaFunction)
+    {
+        value.assign(entry.data);
+        return;
+    }
+    // a `cached()` function has a single value, its parameter is the identifier
+    if (entry.pCache && entry.pCache->find("", value))
+    {
+        return;
+    }
+    luaWorker_->call([&]() {
+        callDataIdentifier(session, entry.data, value);
+    });
+    if (entry.pCache && !value.empty())
+    {
+        entry.pCache->insert("", value);
+    }
+}
+
+/**
+ * Maps the numeric UDS session to the name of its table in the Lua script.
+ *
+ * @param session: the session ID (e.g. `0x02` = PROGRAMMING)
+ * @return the table name or "" for the default session
+ */
+const char *EcuLuaScript::getSessionTableName(uint8_t session) noexcept
+{
+    switch (session)
+    {
+        case UdsSession::PROGRAMMING:
+            return PROGRAMMING_SESSION_TABLE;
+        case UdsSession::EXTENDED:
+            return EXTENDED_SESSION_TABLE;
+        default:
+            return "";
+    }
+}
+
+string EcuLuaScript::getSeed(uint8_t seed_level)
+{
+    return luaWorker_->call([&]() -> string {
+        if (!ecuTableRef_)
+        {
+            return "";
+        }
+        lua_State *l = pLuaState_->GetLuaState();
+        ResetStackOnScopeExit savedStack(l);
+        ecuTableRef_->Push(l);
+        lua_getfield(l, -1, READ_SEED);
+        if (!lua_istable(l, -1))
+        {
+            return "";
+        }
+        lua_rawgeti(l, -1, seed_level);
+        return popLuaString(l);
+    });
+}
+
+/**
+ * Converts a literal hex string into a value vector.
+ *
+ * @param hexString: the literal hex string (e.g. "41 6f 54")
+ * @return a vector with the byte values
+ */
+vector<uint8_t> EcuLuaScript::literalHexStrToBytes(const string& hexString)
+{
+    vector<uint8_t> data;
+    literalHexStrToBytes(hexString, data);
+    return data;
+}
+
+/**
+ * Converts a literal hex string into the given vector. The vector keeps its
+ * capacity, so converting into a reused vector does not allocate.
+ *
+ * @param hexString: the literal hex string (e.g. "41 6f 54")
+ * @param bytes: replaced by the byte values
+ */
+void EcuLuaScript::literalHexStrToBytes(string_view hexString, vector<uint8_t>& bytes)
+{
+    hex_codec::decode(hexString, bytes);
+}
+
+/**
+ * Convert the given string into another string that represents the hex bytes of
+ * the input string. This is a convenience function to use ascii strings in
+ * responses.
+ *
+ * Example:
+ *     `ascii("Hello")` -> `" 48 65 6C 6C 6F "`
+ *
+ * @param utf8_str: the input string to convert
+ * @return a literal string of hex bytes (e.g. " 12 4A FF ") or an empty string
+ * on error
+ *
+ * @note To allow a seamless string concatenation, the returned string always
  * begins and ends with an whitespace.
  */
 string EcuLuaScript::ascii(const string& utf8_str) noexcept
@@ -291,18 +1117,9 @@ string EcuLuaScript::ascii(const string& utf8_str) noexcept
         return "";
     }
 
-    string output;
     // str length * (1 whitespace + 2 characters per byte) + last whitespace
-    output.reserve(len * 3 + 1);
-    unsigned char c;
-    for (size_t i = 0; i < len; ++i)
-    {
-        c = utf8_str[i];
-        output.push_back(' ');
-        output.push_back(HEX_LUT[c >> 4]);
-        output.push_back(HEX_LUT[c & 0x0F]);
-    }
-    output.push_back(' ');
+    string output(len * 3 + 1, ' ');
+    hex_codec::encode(reinterpret_cast<const uint8_t*> (utf8_str.data()), len, &output[1]);
     return output;
 }
 /**
@@ -319,25 +1136,64 @@ string EcuLuaScript::getCounterByte(const string& msg) noexcept
     return answer;
 }
 /**
-*Substrings the data bytes value of the message which is the second byte
-**/
+ * Adds the data bytes of a `TransferData` request (i.e. without the first two
+ * bytes) to the CRC returned by `createHash()`. Only the CRC is kept, not the
+ * data itself.
+ *
+ * @param msg: the request as literal hex string (e.g. "36 01 AA BB")
+ */
 void EcuLuaScript::getDataBytes(const string& msg) noexcept
 {
-    // make a working copy
-    string tmpStr = msg;
-    // remove white spaces from string
-    tmpStr.erase(remove(tmpStr.begin(), tmpStr.end(), ' '), tmpStr.end());
-    string answer = tmpStr;
-    //cut the first two bytes which indicate the request 
-    answer = answer.substr(4,answer.length());
-    //save the answer in global var, which is also available for createHash()
-    receivedDataBytes = receivedDataBytes + answer;
+    uint8_t bytes[256];
+    size_t numBytes = 0;
+    size_t skippedDigits = 0;
+    char byteString[3] = {};
+    for (const char c : msg)
+    {
+        // white spaces are removed
+        if (c == ' ')
+        {
+            continue;
+        }
+        // cut the first two bytes which indicate the request
+        if (skippedDigits < 4)
+        {
+            ++skippedDigits;
+            continue;
+        }
+        // a byte might be split between two requests
+        if (receivedDataDigit == '\0')
+        {
+            receivedDataDigit = c;
+            continue;
+        }
+        byteString[0] = receivedDataDigit;
+        byteString[1] = c;
+        receivedDataDigit = '\0';
+        bytes[numBytes++] = static_cast<uint8_t> (strtol(byteString, NULL, 16));
+        if (numBytes == sizeof(bytes))
+        {
+            receivedDataCrc.update(bytes, numBytes);
+            numBytes = 0;
+        }
+    }
+    receivedDataCrc.update(bytes, numBytes);
 }
 
+/**
+ * @return the CRC-CCITT (0xFFFF) of all data bytes passed to `getDataBytes()`
+ *         as hex string, the CRC is reset afterwards
+ */
 string EcuLuaScript::createHash() noexcept
 {
-    vector <uint8_t> resp = literalHexStrToBytes(receivedDataBytes);
-    uint16_t crc2 = crc_ccitt_ffff(resp.data(), resp.size());
+    if (receivedDataDigit != '\0')
+    {
+        const char byteString[2] = {receivedDataDigit, '\0'};
+        const uint8_t byte = static_cast<uint8_t> (strtol(byteString, NULL, 16));
+        receivedDataCrc.update(&byte, 1);
+        receivedDataDigit = '\0';
+    }
+    const uint16_t crc2 = uint16_t(receivedDataCrc.getValue());
     char hash[5];
     snprintf(hash, 5, "%X", crc2);
     string answer(hash);
@@ -345,11 +1201,160 @@ string EcuLuaScript::createHash() noexcept
         answer = "0" + answer;
     }
     //reset the received Data variable
-    receivedDataBytes = "";
-    cout << answer << endl;
+    receivedDataCrc.reset();
+    LOG_DEBUG(answer);
     return answer;
 }
 
+/**
+ * Creates a CRC stream, see `CrcStream`. Must be called from Lua.
+ *
+ * @param algorithm: the name of the CRC variant (e.g. "ccitt_ffff" or "crc32")
+ * @return the handle of the stream or 0 if the algorithm is unknown
+ */
+uint32_t EcuLuaScript::crcCreate(const string& algorithm)
+{
+    const optional<CrcAlgorithm> crcAlgorithm = CrcStream::parseAlgorithm(algorithm);
+    if (!crcAlgorithm)
+    {
+        LOG_ERROR("Unknown CRC algorithm: " << algorithm);
+        return 0;
+    }
+    for (size_t i = 0; i < crcStreams_.size(); ++i)
+    {
+        if (!crcStreams_[i])
+        {
+            crcStreams_[i].emplace(*crcAlgorithm);
+            return uint32_t(i + 1);
+        }
+    }
+    crcStreams_.emplace_back(std::in_place, *crcAlgorithm);
+    return uint32_t(crcStreams_.size());
+}
+
+/**
+ * Adds bytes to a CRC stream. Must be called from Lua.
+ *
+ * @param handle: the handle of `crcCreate()`
+ * @param bytes: the bytes as literal hex string (e.g. "AA BB CC")
+ * @return the CRC of all bytes added so far
+ */
+uint32_t EcuLuaScript::crcUpdate(uint32_t handle, const string& bytes)
+{
+    if (handle == 0 || handle > crcStreams_.size() || !crcStreams_[handle - 1])
+    {
+        LOG_ERROR("Invalid CRC handle: " << handle);
+        return 0;
+    }
+    literalHexStrToBytes(bytes, crcBuffer_);
+    CrcStream& stream = *crcStreams_[handle - 1];
+    stream.update(crcBuffer_.data(), crcBuffer_.size());
+    return stream.getValue();
+}
+
+/**
+ * @param handle: the handle of `crcCreate()`
+ * @return the CRC of all bytes added so far or 0 if the handle is invalid
+ */
+uint32_t EcuLuaScript::crcValue(uint32_t handle) const
+{
+    if (handle == 0 || handle > crcStreams_.size() || !crcStreams_[handle - 1])
+    {
+        return 0;
+    }
+    return crcStreams_[handle - 1]->getValue();
+}
+
+/**
+ * Releases a CRC stream, its handle might be returned by the next
+ * `crcCreate()`.
+ *
+ * @param handle: the handle of `crcCreate()`
+ */
+void EcuLuaScript::crcRelease(uint32_t handle)
+{
+    if (handle > 0 && handle <= crcStreams_.size())
+    {
+        crcStreams_[handle - 1].reset();
+    }
+}
+
+/**
+ * Adds a DTC to the fault memory or updates its status. Must be called from
+ * Lua.
+ *
+ * @param dtc: the 3 byte DTC (e.g. `0xC01234`)
+ * @param status: the status byte
+ */
+void EcuLuaScript::setDtc(uint32_t dtc, uint32_t status)
+{
+    pDtcStore_->setDtc(dtc, uint8_t(status));
+}
+
+/**
+ * Enables or disables the communication of the ECU like `CommunicationControl`
+ * (0x28), e.g. to stop its cyclic traffic from a Lua function. Must be
+ * called from Lua.
+ *
+ * @param controlType: the control type (0x00 - 0x03)
+ * @param communicationType: the communication types, 0x01 = normal messages
+ * @return false if the control type is not supported
+ */
+bool EcuLuaScript::setCommunicationControl(uint32_t controlType, uint32_t communicationType)
+{
+    return controlType <= 0xFF && pCommunicationGate_->setControl(uint8_t(controlType), uint8_t(communicationType));
+}
+
+/**
+ * Removes a DTC from the fault memory. Must be called from Lua.
+ *
+ * @param dtc: the 3 byte DTC or 0xFFFFFF to remove all DTCs
+ * @return false if the DTC is unknown
+ */
+bool EcuLuaScript::clearDtc(uint32_t dtc)
+{
+    return pDtcStore_->clearDtc(dtc);
+}
+
+/**
+ * @param dtc: the 3 byte DTC
+ * @return the status byte of the DTC or 0 if it is unknown
+ */
+uint32_t EcuLuaScript::getDtcStatus(uint32_t dtc) const
+{
+    uint8_t status = 0x00;
+    pDtcStore_->getStatus(dtc, status);
+    return status;
+}
+
+/**
+ * Stores a snapshot record of a DTC (`ReadDTCInformation` 0x04). Must be
+ * called from Lua.
+ *
+ * @param dtc: the 3 byte DTC
+ * @param recordNumber: the DTCSnapshotRecordNumber
+ * @param data: the record as literal hex string, starting with the number of identifiers
+ * @return false if the DTC is unknown
+ */
+bool EcuLuaScript::setDtcSnapshot(uint32_t dtc, uint32_t recordNumber, const string& data)
+{
+    return pDtcStore_->setSnapshotRecord(dtc, uint8_t(recordNumber), literalHexStrToBytes(data));
+}
+
+/**
+ * Stores an extended data record of a DTC (`ReadDTCInformation` 0x06). Must
+ * be called from Lua.
+ *
+ * @param dtc: the 3 byte DTC
+ * @param recordNumber: the DTCExtDataRecordNumber
+ * @param data: the record as literal hex string
+ * @return false if the DTC is unknown
+ */
+bool EcuLuaScript::setDtcExtendedData(uint32_t dtc, uint32_t recordNumber, const string& data)
+{
+    return pDtcStore_->setExtendedDataRecord(dtc, uint8_t(recordNumber), literalHexStrToBytes(data));
+}
+
 /**
  * Convert the given unsigned value into a hex byte string as used in requests
  * and responses. The parameter `len` [0..4096] gives the number of bytes that
@@ -372,64 +1377,120 @@ string EcuLuaScript::toByteResponse(uint32_t value,
         len = MAX_UDS_SIZE;
     }
 
-    static constexpr int CHAR_SP = 3; // character space for 2 hex digits + 1 whitespace
-    const int zeroFill = len - sizeof(value);
+    if (len == 0)
+    {
+        return "";
+    }
 
-    if (zeroFill < 0)
+    // the zeros filled up in front are already separated by the spaces
+    string str(hex_codec::getEncodedSize(len), ' ');
+    const uint32_t valueLen = min<uint32_t>(len, sizeof(value));
+    size_t pos = 0;
+    for (uint32_t i = valueLen; i < len; i++, pos += 3)
     {
-        // truncated value
-        const size_t space = len * CHAR_SP;
-        char str[space];
-        for (size_t i = 0, j = (len * 2 - 1) * 4; i < space; i += CHAR_SP, j -= 8)
-        {
-            str[i] = HEX_LUT[(value >> j) & 0x0F];
-            str[i + 1] = HEX_LUT[(value >> (j - 4)) & 0x0F];
-            str[i + 2] = ' ';
-        }
-        str[space - 1] = '\0';
-        return str;
+        str[pos] = '0';
+        str[pos + 1] = '0';
     }
-    else
+
+    // big endian, truncated to the lower bytes
+    uint8_t bytes[sizeof(value)];
+    for (uint32_t i = 0; i < valueLen; i++)
     {
-        // fill up wit zeros
-        const size_t space = ((sizeof(value) + zeroFill) * CHAR_SP);
-        const size_t valSpace = zeroFill * CHAR_SP;
-        char str[space];
-        for (size_t i = 0; i < valSpace; i += CHAR_SP)
-        {
-            str[i] = '0';
-            str[i + 1] = '0';
-            str[i + 2] = ' ';
-        }
+        bytes[i] = uint8_t(value >> ((valueLen - 1 - i) * 8));
+    }
+    hex_codec::encode(bytes, valueLen, &str[pos]);
+    return str;
+}
 
-        // insert hex values
-        for (size_t i = valSpace, j = (sizeof(value) * 2 - 1) * 4; i < space; i += CHAR_SP, j -= 8)
+/**
+ * Sends the given response (string of hex bytes). Called by a running
+ * response function (see `DeferredSendScope`), the message is only decoded
+ * into a reused buffer and sent when the function returns or sleeps, before
+ * its own response. Elsewhere (e.g. in a `ReadDataByIdentifier` function) it
+ * is sent immediately.
+ *
+ * @param response: the raw response message to send (e.g. "DE AD C0 DE")
+ */
+void EcuLuaScript::sendRaw(string_view response)
+{
+    if (deferredDepth_ > 0)
+    {
+        if (deferredCount_ == deferredMessages_.size())
         {
-            str[i] = HEX_LUT[(value >> j) & 0x0F];
-            str[i + 1] = HEX_LUT[(value >> (j - 4)) & 0x0F];
-            str[i + 2] = ' ';
+            deferredMessages_.emplace_back();
         }
-        str[space - 1] = '\0';
-        return str;
+        literalHexStrToBytes(response, deferredMessages_[deferredCount_++]);
+        return;
     }
-    return "";
+    static thread_local vector<uint8_t> message;
+    literalHexStrToBytes(response, message);
+    sendMessage(message);
 }
 
 /**
- * Sends the given response (string of hex bytes) immediately.
- *
- * @param response: the raw response message to send (e.g. "DE AD C0 DE")
+ * Sends a message of `sendRaw()` with the transport and to the DoIP entities
+ * of the ECU.
+ */
+void EcuLuaScript::sendMessage(const vector<uint8_t>& message) const
+{
+    if(pTransport_) {
+        pTransport_->sendData(message.data(), message.size());
+    }
+    sendDoIPMessage(message);
+}
+
+/**
+ * Sends a message of the ECU to the testers of all its DoIP entities, e.g.
+ * a message of `sendRaw()` or a response of `ResponseOnEvent` over DoIP.
+ */
+void EcuLuaScript::sendDoIPMessage(const vector<uint8_t>& message) const
+{
+    for(DoIPSimServer *pDoipSimServer : doipSimServers_) {
+        pDoipSimServer->sendDiagnosticResponse(message, doipLogicalEcuAddress_);
+    }
+}
+
+/**
+ * Defers the messages of `sendRaw()` and `sendRawBatch()` while a response
+ * function runs on the Lua worker. At the end of the outermost scope they are
+ * sent in order, so the transport is not called with the Lua state in use and
+ * gets the messages of a function back to back. The buffers are kept for the
+ * next function.
  */
-void EcuLuaScript::sendRaw(const string& response) const
+class EcuLuaScript::DeferredSendScope
 {
-    vector<uint8_t> resp = literalHexStrToBytes(response);
-    if(pIsoTpSender_) {
-        pIsoTpSender_->sendData(resp.data(), resp.size());
+public:
+    explicit DeferredSendScope(EcuLuaScript& script) noexcept
+    : script_(script)
+    {
+        ++script_.deferredDepth_;
     }
-    if(pDoipSimServer_) {
-        pDoipSimServer_->sendDiagnosticResponse(resp, doipLogicalEcuAddress_);
+
+    ~DeferredSendScope()
+    {
+        if (--script_.deferredDepth_ == 0 && script_.deferredCount_ > 0)
+        {
+            script_.flushDeferredMessages();
+        }
     }
 
+    DeferredSendScope(const DeferredSendScope& orig) = delete;
+    DeferredSendScope& operator =(const DeferredSendScope& orig) = delete;
+
+private:
+    EcuLuaScript& script_;
+};
+
+/**
+ * Sends the deferred messages of `sendRaw()` in order.
+ */
+void EcuLuaScript::flushDeferredMessages()
+{
+    for (size_t i = 0; i < deferredCount_; ++i)
+    {
+        sendMessage(deferredMessages_[i]);
+    }
+    deferredCount_ = 0;
 }
 
 /**
@@ -439,7 +1500,7 @@ void EcuLuaScript::sendRaw(const string& response) const
  */
 void EcuLuaScript::sleep(unsigned int ms) noexcept
 {
-    usleep(ms * 1000);
+    SimulationClock::getInstance().sleepFor(chrono::milliseconds(ms));
 }
 
 /**
@@ -466,246 +1527,2753 @@ void EcuLuaScript::switchToSession(int ses)
 }
 
 /**
- * Disconnect the currently active DoIP TCP connection
+ * Disconnect the DoIP TCP connections of all entities the ECU belongs to
+ */
+void EcuLuaScript::disconnectDoip()
+{
+    for(DoIPSimServer *pDoipSimServer : doipSimServers_) {
+        pDoipSimServer->triggerDisconnection();
+    }
+}
+
+void EcuLuaScript::sendDoipVehicleAnnouncements()
+{
+    for(DoIPSimServer *pDoipSimServer : doipSimServers_) {
+        pDoipSimServer->sendVehicleAnnouncements();
+    }
+}
+
+/**
+ * Checks if the ECU is simulated by the given DoIP entity, set by `DoIPEntity`
+ * (e.g. `DoIPEntity = "doipserver_rack2"` or `DoIPEntity = {"doipserver",
+ * "doipserver_rack2"}`). Without `DoIPEntity` the ECU belongs to all entities.
+ *
+ * @param entity: the name of the entity (its configuration without ".lua")
+ * @return true if the ECU belongs to the entity
+ */
+bool EcuLuaScript::isInDoIPEntity(const string& entity) const
+{
+    return doipEntities_.empty()
+        || find(doipEntities_.begin(), doipEntities_.end(), entity) != doipEntities_.end();
+}
+
+/**
+ * Creates the native flashing service of the `Download` table, e.g.
+ *
+ *     Download = {
+ *         maxSize = 0x200000,
+ *         maxBlockLength = 0x0FFA,
+ *         onTransferExit = function(address, size, crc) return toByteResponse(crc, 2) end
+ *     }
+ *
+ * @return the service or `nullptr` if the ECU has no `Download` table
+ */
+unique_ptr<DownloadService> EcuLuaScript::createDownloadService()
+{
+    if (!hasDownload_)
+    {
+        return nullptr;
+    }
+    return std::make_unique<DownloadService>(downloadConfiguration_, [this](const DownloadSummary& summary) {
+        return this->callTransferExit(summary);
+    });
+}
+
+/**
+ * @return the OBD service of the `OBD` table, whose Lua PIDs are bound to this
+ *         script, or `nullptr` if the ECU has no `OBD` table
+ */
+unique_ptr<ObdService> EcuLuaScript::createObdService()
+{
+    if (obdPids_.empty())
+    {
+        return nullptr;
+    }
+    return std::make_unique<ObdService>(obdPids_, [this](uint8_t mode, uint8_t pid) {
+        return this->callObdPid(mode, pid);
+    });
+}
+
+/**
+ * @param maxResponseLength: the max. length of a response of the transport
+ * @return the memory service of the `Memory` table or `nullptr` if the ECU
+ *         has no `Memory` table
+ */
+unique_ptr<MemoryService> EcuLuaScript::createMemoryService(size_t maxResponseLength) const
+{
+    if (memoryRegions_.empty())
+    {
+        return nullptr;
+    }
+    return std::make_unique<MemoryService>(memoryRegions_, maxResponseLength);
+}
+
+/**
+ * Calls `OBD[mode][pid](pid)` to get the current data of a PID.
+ *
+ * @param mode: 0x01 or 0x09
+ * @param pid: the PID respectively the InfoType
+ * @return the returned data or nothing if the function is missing or fails
+ */
+optional<vector<uint8_t>> EcuLuaScript::callObdPid(uint8_t mode, uint8_t pid)
+{
+    const optional<string> data = luaWorker_->call([&]() -> optional<string> {
+        if (!ecuTableRef_)
+        {
+            return {};
+        }
+        lua_State *l = pLuaState_->GetLuaState();
+        ResetStackOnScopeExit savedStack(l);
+        ecuTableRef_->Push(l);
+        lua_getfield(l, -1, OBD_TABLE);
+        if (!lua_istable(l, -1))
+        {
+            return {};
+        }
+        lua_rawgeti(l, -1, mode);
+        if (!lua_istable(l, -1))
+        {
+            return {};
+        }
+        lua_rawgeti(l, -1, pid);
+        if (!lua_isfunction(l, -1))
+        {
+            return {};
+        }
+        lua_pushinteger(l, pid);
+        if (lua_pcall(l, 1, 1, 0) != LUA_OK)
+        {
+            const char *msg = lua_tostring(l, -1);
+            LOG_ERROR("Error in " << OBD_TABLE << " PID function: " << (msg ? msg : "unknown"));
+            return {};
+        }
+        return popLuaString(l);
+    });
+    if (!data)
+    {
+        return {};
+    }
+    return literalHexStrToBytes(*data);
+}
+
+/**
+ * @return the levels of the `SecurityAccess` table, the `key` functions are
+ *         bound to this script
+ */
+vector<SecurityLevelConfiguration> EcuLuaScript::getSecurityLevels()
+{
+    vector<SecurityLevelConfiguration> levels = securityLevels_;
+    for (SecurityLevelConfiguration& level : levels)
+    {
+        if (level.algorithm == KeyAlgorithm::LUA)
+        {
+            level.keyFunction = [this, identifier = level.level](const vector<uint8_t>& seed) {
+                return this->callSecurityKey(identifier, seed);
+            };
+        }
+    }
+    return levels;
+}
+
+/**
+ * Calls `SecurityAccess[level].key(seed)` to calculate the key of a seed.
+ *
+ * @param level: the `requestSeed` sub-function
+ * @param seed: the generated seed
+ * @return the returned key or nothing if the function is missing or fails
+ */
+optional<vector<uint8_t>> EcuLuaScript::callSecurityKey(uint8_t level, const vector<uint8_t>& seed)
+{
+    const string seedString = intToHexString(seed.data(), seed.size());
+    const optional<string> key = luaWorker_->call([&]() -> optional<string> {
+        if (!ecuTableRef_)
+        {
+            return {};
+        }
+        lua_State *l = pLuaState_->GetLuaState();
+        ResetStackOnScopeExit savedStack(l);
+        ecuTableRef_->Push(l);
+        lua_getfield(l, -1, SECURITY_ACCESS_TABLE);
+        if (!lua_istable(l, -1))
+        {
+            return {};
+        }
+        lua_rawgeti(l, -1, level);
+        if (!lua_istable(l, -1))
+        {
+            return {};
+        }
+        lua_getfield(l, -1, SECURITY_KEY_FUNCTION);
+        if (!lua_isfunction(l, -1))
+        {
+            return {};
+        }
+        lua_pushlstring(l, seedString.data(), seedString.size());
+        if (lua_pcall(l, 1, 1, 0) != LUA_OK)
+        {
+            const char *msg = lua_tostring(l, -1);
+            LOG_ERROR("Error in " << SECURITY_ACCESS_TABLE << " key function: " << (msg ? msg : "unknown"));
+            return {};
+        }
+        return popLuaString(l);
+    });
+    if (!key)
+    {
+        return {};
+    }
+    return literalHexStrToBytes(*key);
+}
+
+/**
+ * Calls `Download.onTransferExit(address, size, crc)` at the end of a native
+ * download. The function may return the `transferResponseParameterRecord`
+ * as hex string (e.g. `return toByteResponse(crc, 2)`).
+ *
+ * @param summary: the completed download
+ * @return the returned bytes or nothing if the ECU has no `onTransferExit`
+ *         function
+ */
+optional<vector<uint8_t>> EcuLuaScript::callTransferExit(const DownloadSummary& summary)
+{
+    const optional<string> record = luaWorker_->call([&]() -> optional<string> {
+        if (!ecuTableRef_)
+        {
+            return {};
+        }
+        lua_State *l = pLuaState_->GetLuaState();
+        ResetStackOnScopeExit savedStack(l);
+        ecuTableRef_->Push(l);
+        lua_getfield(l, -1, DOWNLOAD_TABLE);
+        if (!lua_istable(l, -1))
+        {
+            return {};
+        }
+        lua_getfield(l, -1, DOWNLOAD_ON_TRANSFER_EXIT);
+        if (!lua_isfunction(l, -1))
+        {
+            return {};
+        }
+        lua_pushinteger(l, lua_Integer(summary.memoryAddress));
+        lua_pushinteger(l, lua_Integer(summary.memorySize));
+        lua_pushinteger(l, lua_Integer(summary.crc));
+        if (lua_pcall(l, 3, 1, 0) != LUA_OK)
+        {
+            const char *msg = lua_tostring(l, -1);
+            LOG_ERROR("Error in " << DOWNLOAD_ON_TRANSFER_EXIT << ": " << (msg ? msg : "unknown"));
+            return string();
+        }
+        return popLuaString(l);
+    });
+    if (!record)
+    {
+        return {};
+    }
+    return literalHexStrToBytes(*record);
+}
+
+/**
+ * Marks the cached payload of a cyclic PGN as outdated, so it is read from the
+ * `PGNs` table (i.e. the payload function is called) before it is sent next.
+ *
+ * @param pgn: the PGN as defined in the `PGNs` table (e.g. "65265" or "F1 FE 00")
+ */
+void EcuLuaScript::invalidatePGN(const string& pgn)
+{
+    if(pJ1939Simulator_) pJ1939Simulator_->invalidatePGN(pgn);
+}
+
+/**
+ * Drops the cached responses of all `cached()` functions of the ECU, so each
+ * of them is called again on its next request.
+ */
+void EcuLuaScript::invalidateCache() noexcept
+{
+    pCacheEpoch_->fetch_add(1, memory_order_relaxed);
+}
+
+/**
+ * Replaces the payload of a cyclic PGN without calling its payload function.
+ * The new payload is sent with the next cycle.
+ *
+ * @param pgn: the PGN as defined in the `PGNs` table (e.g. "65265" or "F1 FE 00")
+ * @param payload: the new payload (e.g. "DE AD C0 DE")
+ */
+void EcuLuaScript::setPGNPayload(const string& pgn, const string& payload)
+{
+    if(pJ1939Simulator_) pJ1939Simulator_->setPGNPayload(pgn, literalHexStrToBytes(payload));
+}
+
+/**
+ * Sets a vehicle signal, which is registered if it is new. The value is
+ * encoded into the records of the `Signals` tables of all ECUs.
+ *
+ * @param name: the name of the signal (e.g. "VehicleSpeed")
+ * @param value: the physical value
+ */
+void EcuLuaScript::setSignal(const string& name, double value)
+{
+    const optional<VehicleSignals::SignalId> signal = VehicleSignals::getInstance().registerSignal(name);
+    if (signal)
+    {
+        VehicleSignals::getInstance().set(*signal, value);
+    }
+}
+
+/**
+ * @param name: the name of the signal (e.g. "VehicleSpeed")
+ * @return the physical value of the signal or 0 if it is unknown
+ */
+double EcuLuaScript::getSignal(const string& name)
+{
+    const optional<VehicleSignals::SignalId> signal = VehicleSignals::getInstance().findSignal(name);
+    return signal ? VehicleSignals::getInstance().get(*signal) : 0.0;
+}
+
+
+/**
+ * Gets all keys from the given Lua table
+ *
+ * @return vector of keys or an empty vector if not table given
+ */
+vector<string> EcuLuaScript::getLuaTableKeys(Selector luaTable)
+{
+    if(luaTable.exists()) {
+        return luaTable.getKeys();
+    } else {
+        return vector<string>();
+    }
+}
+
+/**
+ * @brief Remove all separator characters from given string
+ * 
+ * @param rawString 
+ * @return string rawString with all separator characters removed
+ */
+string EcuLuaScript::cleanupString(string rawString)
+{
+    hex_codec::removeSeparators(rawString);
+    return rawString;
+}
+
+/**
+ * Gets J1939 PGNS from the Lua PGN-Table.
+ *
+ * @return vector of raw message data as they are configured in lua
+ */
+vector<string> EcuLuaScript::getJ1939PGNs()
+{
+    return luaWorker_->call([&]() -> vector<string> {
+        LOG_INFO("Get PGNs from ident: " << ecu_ident_);
+        return getLuaTableKeys((*pLuaState_)[ecu_ident_.c_str()][J1939_PGN_TABLE]);
+    });
+}
+
+/**
+ * Builds the index of the `ReadDataByIdentifier`-tables of all sessions. The
+ * hits of the running index are taken over, so they continue over a reload.
+ *
+ * @param luaState: the loaded Lua state
+ * @return the index
+ */
+shared_ptr<const EcuLuaScript::DataIdentifierIndices> EcuLuaScript::compileDataIdentifierIndices(sel::State& luaState)
+{
+    auto pIndices = std::make_shared<DataIdentifierIndices>();
+    lua_State *l = luaState.GetLuaState();
+    compileDataIdentifiers(*pIndices, "", l, luaState[ecu_ident_.c_str()][READ_DATA_BY_IDENTIFIER_TABLE]);
+    compileDataIdentifiers(*pIndices, PROGRAMMING_SESSION_TABLE, l, luaState[ecu_ident_.c_str()][PROGRAMMING_SESSION_TABLE][READ_DATA_BY_IDENTIFIER_TABLE]);
+    compileDataIdentifiers(*pIndices, EXTENDED_SESSION_TABLE, l, luaState[ecu_ident_.c_str()][EXTENDED_SESSION_TABLE][READ_DATA_BY_IDENTIFIER_TABLE]);
+
+    const auto pOldIndices = getDataIdentifierIndices();
+    for (auto& index : *pIndices)
+    {
+        index.second.countHits();
+        const auto oldIndex = pOldIndices->find(index.first);
+        if (oldIndex == pOldIndices->end() || !oldIndex->second.getHitCounters())
+        {
+            continue;
+        }
+        // both indices are sorted by the identifier
+        const vector<DataIdentifierIndex::Entry>& entries = index.second.getEntries();
+        const vector<DataIdentifierIndex::Entry>& oldEntries = oldIndex->second.getEntries();
+        size_t oldPosition = 0;
+        for (size_t position = 0; position < entries.size(); ++position)
+        {
+            while (oldPosition < oldEntries.size() && oldEntries[oldPosition].identifier < entries[position].identifier)
+            {
+                ++oldPosition;
+            }
+            if (oldPosition < oldEntries.size() && oldEntries[oldPosition].identifier == entries[position].identifier)
+            {
+                index.second.getHitCounters()->add(position, oldIndex->second.getHitCounters()->get(oldPosition));
+            }
+        }
+    }
+    return pIndices;
+}
+
+/**
+ * Builds the index of the given `ReadDataByIdentifier`-table. Static values
+ * are copied, for functions the table key is stored to call them on request.
+ * Functions wrapped in `cached()` get a `ResponseCache`.
+ *
+ * @param indices: the index to add the entries to
+ * @param session: the session name the table belongs to ("" for the default session)
+ * @param l: the Lua state of the table
+ * @param dataIdentifierTable: the `ReadDataByIdentifier`-table
+ */
+void EcuLuaScript::compileDataIdentifiers(DataIdentifierIndices& indices, const string& session, lua_State *l,
+                                          Selector dataIdentifierTable)
+{
+    dataIdentifierTable.forEach([&](const string& identifier, int value) {
+        const string cleanIdentifier = cleanupString(identifier);
+        if (cleanIdentifier.length() != 4 || !all_of(cleanIdentifier.cbegin(), cleanIdentifier.cend(), ::isxdigit))
+        {
+            LOG_WARNING("Ignoring invalid data identifier '" << identifier << "'");
+            return;
+        }
+        const uint16_t did = uint16_t(strtoul(cleanIdentifier.c_str(), NULL, 16));
+
+        bool isFunction = lua_isfunction(l, value);
+        shared_ptr<ResponseCache> pCache;
+        if (lua_istable(l, value))
+        {
+            lua_getfield(l, value, CACHED_FUNCTION_FIELD);
+            isFunction = lua_isfunction(l, -1);
+            if (isFunction)
+            {
+                pCache = createResponseCache(l, value);
+            }
+        }
+        if (isFunction)
+        {
+            indices[session].add(did, true, identifier, move(pCache));
+        }
+        else
+        {
+            indices[session].add(did, false, string(toStringView(l, value)));
+        }
+    });
+}
+
+/**
+ * Fills the fault memory from the `DTCs` table. The keys are the DTCs as
+ * literal hex string, the values either the status byte or a table with the
+ * `status` and optionally the `snapshots` and `extendedData` records by their
+ * record number.
+ *
+ * @param dtcTable: the `DTCs` table of the ECU
+ */
+void EcuLuaScript::loadDtcs(Selector dtcTable)
+{
+    for (const string& key : getLuaTableKeys(dtcTable))
+    {
+        const vector<uint8_t> bytes = literalHexStrToBytes(key);
+        if (bytes.size() != 3)
+        {
+            LOG_WARNING("Ignoring invalid DTC '" << key << "'");
+            continue;
+        }
+        const uint32_t dtc = (uint32_t(bytes[0]) << 16) | (uint32_t(bytes[1]) << 8) | bytes[2];
+
+        auto entry = dtcTable[key];
+        if (!entry.isTable())
+        {
+            pDtcStore_->setDtc(dtc, uint8_t(uint32_t(entry)));
+            continue;
+        }
+        pDtcStore_->setDtc(dtc, uint8_t(uint32_t(entry[DTC_STATUS])));
+        const auto loadRecords = [&](const char *field, bool (DtcStore::*setRecord)(uint32_t, uint8_t, const vector<uint8_t>&)) {
+            auto records = entry[field];
+            if (!records.isTable())
+            {
+                return;
+            }
+            for (const string& recordNumber : getLuaTableKeys(records))
+            {
+                char *end;
+                const long number = strtol(recordNumber.c_str(), &end, 0);
+                if (*end != '\0' || number < 0x00 || number > 0xFF)
+                {
+                    LOG_WARNING("Ignoring invalid record number '" << recordNumber << "' of DTC '" << key << "'");
+                    continue;
+                }
+                ((*pDtcStore_).*setRecord)(dtc, uint8_t(number), literalHexStrToBytes(records[int(number)].toString()));
+            }
+        };
+        loadRecords(DTC_SNAPSHOTS, &DtcStore::setSnapshotRecord);
+        loadRecords(DTC_EXTENDED_DATA, &DtcStore::setExtendedDataRecord);
+    }
+}
+
+/**
+ * Reads the PIDs of the `OBD` table, e.g. `[0x01] = { [0x0D] = "32" }`.
+ *
+ * @param obdTable: the `OBD` table of the ECU
+ */
+void EcuLuaScript::loadObdPids(Selector obdTable)
+{
+    for (const string& modeKey : getLuaTableKeys(obdTable))
+    {
+        char *end;
+        const long mode = strtol(modeKey.c_str(), &end, 0);
+        if (*end != '\0' || mode < 0x00 || mode > 0xFF || !ObdService::isObdRequest(uint8_t(mode)))
+        {
+            LOG_WARNING("Ignoring unsupported OBD mode '" << modeKey << "'");
+            continue;
+        }
+        auto pidTable = obdTable[int(mode)];
+        if (!pidTable.isTable())
+        {
+            LOG_WARNING("Ignoring OBD mode '" << modeKey << "' without table");
+            continue;
+        }
+        for (const string& pidKey : getLuaTableKeys(pidTable))
+        {
+            const long pid = strtol(pidKey.c_str(), &end, 0);
+            if (*end != '\0' || pid < 0x00 || pid > 0xFF)
+            {
+                LOG_WARNING("Ignoring invalid OBD PID '" << pidKey << "'");
+                continue;
+            }
+            ObdPidConfiguration configuration;
+            configuration.mode = uint8_t(mode);
+            configuration.pid = uint8_t(pid);
+            auto value = pidTable[int(pid)];
+            if (value.isFunction())
+            {
+                configuration.isLuaFunction = true;
+            }
+            else
+            {
+                configuration.data = literalHexStrToBytes(value.toString());
+            }
+            obdPids_.push_back(move(configuration));
+        }
+    }
+}
+
+/**
+ * Reads the memory regions of the `Memory` table, e.g.
+ * `{ address = 0x00800000, file = "calibration.bin", offset = 0x100, size = 0x10000 }`
+ * for a read-only region or `{ address = 0x20000000, file = "ram.bin", writable = true }`.
+ * Without a size, the region ends with the file. The files are mapped by the
+ * `MemoryService` of each transport.
+ *
+ * @param memoryTable: the `Memory` table of the ECU
+ */
+void EcuLuaScript::loadMemoryRegions(Selector memoryTable)
+{
+    for (int i = 1; memoryTable[i].exists(); ++i)
+    {
+        auto entry = memoryTable[i];
+        if (!entry.isTable() || !entry[MEMORY_ADDRESS].exists() || !entry[MEMORY_FILE].exists())
+        {
+            LOG_WARNING("Ignoring memory region " << i << " without " << MEMORY_ADDRESS << " and " << MEMORY_FILE);
+            continue;
+        }
+        MemoryRegionConfiguration configuration;
+        configuration.address = uint32_t(entry[MEMORY_ADDRESS]);
+        configuration.file = string(entry[MEMORY_FILE]);
+        if (entry[MEMORY_OFFSET].exists())
+        {
+            configuration.offset = uint32_t(entry[MEMORY_OFFSET]);
+        }
+        if (entry[MEMORY_SIZE].exists())
+        {
+            configuration.size = uint32_t(entry[MEMORY_SIZE]);
+        }
+        configuration.isWritable = entry[MEMORY_WRITABLE].exists() && bool(entry[MEMORY_WRITABLE]);
+        memoryRegions_.push_back(move(configuration));
+    }
+}
+
+/**
+ * Reads the `CanFrames` table, e.g.
+ * `[0x3E1] = { payload = "01 02 03 04", cycleTime = 100 }` for a cyclic frame
+ * or `[0x6F0] = { responseId = 0x6F8, responses = { ["22 01"] = "62 01 AA", ["*"] = "7F 22 11" } }`
+ * for the responses to a request frame. A response is sent for the frames
+ * starting with its request bytes, "*" matches any frame. IDs above 0x7FF are
+ * 29 bit IDs. The payloads are static, no Lua function is called per frame.
+ *
+ * @param canFramesTable: the `CanFrames` table of the ECU
+ */
+void EcuLuaScript::loadCanFrames(Selector canFramesTable)
+{
+    for (const string& idKey : getLuaTableKeys(canFramesTable))
+    {
+        char *end;
+        const long id = strtol(idKey.c_str(), &end, 0);
+        if (*end != '\0' || id < 0 || id > long(CAN_EFF_MASK))
+        {
+            LOG_WARNING("Ignoring invalid CAN ID '" << idKey << "'");
+            continue;
+        }
+        auto entry = canFramesTable[int(id)];
+        if (!entry.isTable())
+        {
+            LOG_WARNING("Ignoring CAN ID '" << idKey << "' without table");
+            continue;
+        }
+        CanFrameConfiguration configuration;
+        configuration.canId = CanFrameBus::toCanId(uint32_t(id));
+        if (entry[CAN_FRAME_PAYLOAD].exists())
+        {
+            configuration.payload = literalHexStrToBytes(entry[CAN_FRAME_PAYLOAD].toString());
+        }
+        if (entry[CAN_FRAME_CYCLETIME].exists())
+        {
+            configuration.cycleTime = uint32_t(entry[CAN_FRAME_CYCLETIME]);
+        }
+        if (configuration.payload.size() > CAN_MAX_DLEN)
+        {
+            LOG_WARNING("Ignoring the payload of CAN ID '" << idKey << "' longer than " << CAN_MAX_DLEN << " bytes");
+            configuration.payload.clear();
+            configuration.cycleTime = 0;
+        }
+
+        auto responses = entry[CAN_FRAME_RESPONSES];
+        if (responses.isTable() && entry[CAN_FRAME_RESPONSE_ID].exists())
+        {
+            configuration.responseId = CanFrameBus::toCanId(uint32_t(entry[CAN_FRAME_RESPONSE_ID]));
+            for (const string& requestKey : getLuaTableKeys(responses))
+            {
+                CanFrameResponse response;
+                if (requestKey != REQUEST_WILDCARD)
+                {
+                    response.request = literalHexStrToBytes(requestKey);
+                }
+                response.response = literalHexStrToBytes(responses[requestKey.c_str()].toString());
+                if (response.request.size() > CAN_MAX_DLEN || response.response.size() > CAN_MAX_DLEN)
+                {
+                    LOG_WARNING("Ignoring the response '" << requestKey << "' of CAN ID '" << idKey
+                                << "' longer than " << CAN_MAX_DLEN << " bytes");
+                    continue;
+                }
+                configuration.responses.push_back(move(response));
+            }
+            stable_sort(configuration.responses.begin(), configuration.responses.end(),
+                        [](const CanFrameResponse& a, const CanFrameResponse& b)
+                        {
+                            return a.request.size() > b.request.size();
+                        });
+        }
+        else if (responses.exists())
+        {
+            LOG_ERROR("The " << CAN_FRAMES_TABLE << " entry '" << idKey << "' of " << ecu_ident_ << " has no " << CAN_FRAME_RESPONSE_ID);
+        }
+        canFrames_.push_back(move(configuration));
+    }
+}
+
+/**
+ * Reads the `Signals` table, e.g.
+ * `DIDs = { [0xF40D] = { signal = "VehicleSpeed", length = 16, scale = 0.01 } }`.
+ * A record is either one mapping or a list of mappings. The sub-tables `DIDs`
+ * and `OBD` (mode 0x01) default to big endian and the fill byte 0x00, `PGNs`
+ * to little endian, the fill byte 0xFF and 8 bytes. A PGN record is an SPN
+ * template and may set the `cycleTime` of the PGN. The signal names are
+ * registered in the `VehicleSignals`.
+ *
+ * @param signalsTable: the `Signals` table of the ECU
+ * @return the DID and PGN records, the OBD PIDs are added to `obdPids_`
+ */
+shared_ptr<const SignalMappings> EcuLuaScript::loadSignalMappings(Selector signalsTable)
+{
+    auto pMappings = std::make_shared<SignalMappings>();
+    auto dids = signalsTable[SIGNALS_DIDS];
+    for (const string& key : getLuaTableKeys(dids))
+    {
+        char *end;
+        const long identifier = strtol(key.c_str(), &end, 0);
+        if (*end != '\0' || identifier < 0x0000 || identifier > 0xFFFF)
+        {
+            LOG_WARNING("Ignoring invalid signal DID '" << key << "'");
+            continue;
+        }
+        optional<SignalRecord> record = loadSignalRecord(dids[int(identifier)], true, 0, 0x00);
+        if (record)
+        {
+            pMappings->dataIdentifiers[uint16_t(identifier)] = move(*record);
+        }
+    }
+
+    auto pids = signalsTable[SIGNALS_OBD_PIDS];
+    for (const string& key : getLuaTableKeys(pids))
+    {
+        char *end;
+        const long pid = strtol(key.c_str(), &end, 0);
+        if (*end != '\0' || pid < 0x00 || pid > 0xFF)
+        {
+            LOG_WARNING("Ignoring invalid signal OBD PID '" << key << "'");
+            continue;
+        }
+        optional<SignalRecord> record = loadSignalRecord(pids[int(pid)], true, 0, 0x00);
+        if (record)
+        {
+            ObdPidConfiguration configuration;
+            configuration.mode = OBD_CURRENT_DATA_REQ;
+            configuration.pid = uint8_t(pid);
+            configuration.pSignals = std::make_shared<const SignalRecord>(move(*record));
+            obdPids_.push_back(move(configuration));
+        }
+    }
+
+    auto pgns = signalsTable[SIGNALS_PGNS];
+    for (const string& key : getLuaTableKeys(pgns))
+    {
+        const uint32_t pgn = J1939Simulator::parsePGN(key);
+        // numeric keys (e.g. `[0xF004]`) are listed as decimal strings
+        char *end;
+        const long number = strtol(key.c_str(), &end, 10);
+        Selector pgnTable = *end == '\0' && !pgns[key.c_str()].exists() ? pgns[int(number)] : pgns[key.c_str()];
+        optional<SignalRecord> record = loadSignalRecord(pgnTable, false, 8, 0xFF);
+        if (record)
+        {
+            pMappings->pgns[pgn] = move(*record);
+            pMappings->pgnCycleTimes[pgn] = pgnTable[J1939_PGN_CYCLETIME].exists()
+                ? uint32_t(pgnTable[J1939_PGN_CYCLETIME]) : 0;
+        }
+    }
+    return pMappings;
+}
+
+/**
+ * Reads one record of the `Signals` table.
+ *
+ * @param recordTable: a mapping (with `signal`) or a list of mappings
+ * @param isBigEndian: the default `byteOrder` of the mappings
+ * @param size: the default `size` of the record in bytes
+ * @param fill: the default `fill` byte of the record
+ * @return the record or nothing if it has no valid mapping
+ */
+optional<SignalRecord> EcuLuaScript::loadSignalRecord(Selector recordTable, bool isBigEndian, size_t size, uint8_t fill)
+{
+    if (!recordTable.isTable())
+    {
+        LOG_WARNING("Ignoring signal record without table");
+        return {};
+    }
+    if (recordTable[SIGNAL_RECORD_SIZE].exists())
+    {
+        size = size_t(uint32_t(recordTable[SIGNAL_RECORD_SIZE]));
+    }
+    if (recordTable[SIGNAL_RECORD_FILL].exists())
+    {
+        fill = uint8_t(uint32_t(recordTable[SIGNAL_RECORD_FILL]));
+    }
+
+    vector<Selector> mappings;
+    if (recordTable[SIGNAL_NAME].exists())
+    {
+        mappings.push_back(recordTable);
+    }
+    else
+    {
+        for (int i = 1; recordTable[i].isTable(); ++i)
+        {
+            mappings.push_back(recordTable[i]);
+        }
+    }
+
+    vector<SignalEncoding> encodings;
+    for (Selector& mapping : mappings)
+    {
+        const optional<VehicleSignals::SignalId> signal = mapping[SIGNAL_NAME].exists()
+            ? VehicleSignals::getInstance().registerSignal(string(mapping[SIGNAL_NAME]))
+            : nullopt;
+        if (!signal)
+        {
+            LOG_WARNING("Ignoring signal mapping without valid " << SIGNAL_NAME);
+            continue;
+        }
+        SignalEncoding encoding;
+        encoding.signal = *signal;
+        encoding.isBigEndian = isBigEndian;
+        if (mapping[SIGNAL_START_BIT].exists())
+        {
+            encoding.startBit = uint32_t(mapping[SIGNAL_START_BIT]);
+        }
+        if (mapping[SIGNAL_BIT_LENGTH].exists())
+        {
+            encoding.bitLength = uint32_t(mapping[SIGNAL_BIT_LENGTH]);
+        }
+        if (mapping[SIGNAL_SCALE].exists())
+        {
+            encoding.scale = lua_Number(mapping[SIGNAL_SCALE]);
+        }
+        else if (mapping[SIGNAL_RESOLUTION].exists())
+        {
+            encoding.scale = lua_Number(mapping[SIGNAL_RESOLUTION]);
+        }
+        if (mapping[SIGNAL_OFFSET].exists())
+        {
+            encoding.offset = lua_Number(mapping[SIGNAL_OFFSET]);
+        }
+        if (mapping[SIGNAL_BYTE_ORDER].exists())
+        {
+            encoding.isBigEndian = string(mapping[SIGNAL_BYTE_ORDER]) != "little";
+        }
+        if (mapping[SIGNAL_SIGNED].exists())
+        {
+            encoding.isSigned = bool(mapping[SIGNAL_SIGNED]);
+        }
+        encodings.push_back(encoding);
+    }
+    if (encodings.empty())
+    {
+        return {};
+    }
+    return SignalRecord(move(encodings), size, fill);
+}
+
+/**
+ * Loads the security levels from the `SecurityAccess` table. The keys are the
+ * `requestSeed` sub-functions, the values tables with either the `algorithm`
+ * ("xor", "aes128" or a CRC like "crc32") and its `secret` as literal hex
+ * string or a `key` function, which gets the seed and returns the key as
+ * literal hex strings. `seedLength`, `maxAttempts` and `delay` (in ms) are
+ * optional.
+ *
+ * @param securityTable: the `SecurityAccess` table of the ECU
+ */
+void EcuLuaScript::loadSecurityLevels(Selector securityTable)
+{
+    for (const string& key : getLuaTableKeys(securityTable))
+    {
+        char *end;
+        const long level = strtol(key.c_str(), &end, 0);
+        if (*end != '\0' || level < 0x01 || level > 0x7D || (level & 0x01) == 0)
+        {
+            LOG_WARNING("Ignoring invalid security level '" << key << "'");
+            continue;
+        }
+        auto entry = securityTable[int(level)];
+        if (!entry.isTable())
+        {
+            LOG_WARNING("Ignoring security level '" << key << "' without table");
+            continue;
+        }
+
+        SecurityLevelConfiguration configuration;
+        configuration.level = uint8_t(level);
+        if (entry[SECURITY_KEY_FUNCTION].isFunction())
+        {
+            configuration.algorithm = KeyAlgorithm::LUA;
+        }
+        else
+        {
+            const string algorithm = entry[SECURITY_ALGORITHM].exists() ? string(entry[SECURITY_ALGORITHM]) : "xor";
+            const optional<CrcAlgorithm> crcAlgorithm = CrcStream::parseAlgorithm(algorithm);
+            if (algorithm == "xor")
+            {
+                configuration.algorithm = KeyAlgorithm::XOR;
+            }
+            else if (algorithm == "aes128")
+            {
+                configuration.algorithm = KeyAlgorithm::AES128;
+            }
+            else if (crcAlgorithm)
+            {
+                configuration.algorithm = KeyAlgorithm::CRC;
+                configuration.crcAlgorithm = *crcAlgorithm;
+            }
+            else
+            {
+                LOG_WARNING("Ignoring security level '" << key << "' with unknown algorithm '" << algorithm << "'");
+                continue;
+            }
+            if (entry[SECURITY_SECRET].exists())
+            {
+                configuration.secret = literalHexStrToBytes(entry[SECURITY_SECRET].toString());
+            }
+            if (configuration.algorithm == KeyAlgorithm::AES128 && configuration.secret.size() != Aes128::KEY_SIZE)
+            {
+                LOG_WARNING("Ignoring security level '" << key << "', the AES-128 secret needs 16 bytes");
+                continue;
+            }
+        }
+        if (entry[SECURITY_SEED_LENGTH].exists())
+        {
+            configuration.seedLength = max<size_t>(1, uint32_t(entry[SECURITY_SEED_LENGTH]));
+        }
+        if (entry[SECURITY_MAX_ATTEMPTS].exists())
+        {
+            configuration.maxAttempts = max<unsigned>(1, uint32_t(entry[SECURITY_MAX_ATTEMPTS]));
+        }
+        if (entry[SECURITY_DELAY].exists())
+        {
+            configuration.delay = chrono::milliseconds(uint32_t(entry[SECURITY_DELAY]));
+        }
+        securityLevels_.push_back(move(configuration));
+    }
+}
+
+/**
+ * Reads the `Sessions` table, e.g.
+ *
+ *     Sessions = {
+ *         [0x03] = { s3 = 10000 },
+ *         [0x60] = { p2 = 25, p2Star = 2000, services = { 0x22, 0x2E, 0x31 } }
+ *     }
+ *
+ * Without `services` all services are allowed in the session. Otherwise
+ * DiagnosticSessionControl and TesterPresent are always allowed, so the
+ * session can be kept and left.
+ *
+ * @param sessionsTable: the `Sessions` table of the ECU
+ */
+void EcuLuaScript::loadSessionConfigurations(Selector sessionsTable)
+{
+    for (const string& key : getLuaTableKeys(sessionsTable))
+    {
+        char *end;
+        const long session = strtol(key.c_str(), &end, 0);
+        if (*end != '\0' || session < 0x01 || session > 0x7F)
+        {
+            LOG_WARNING("Ignoring invalid session '" << key << "'");
+            continue;
+        }
+        auto entry = sessionsTable[int(session)];
+        if (!entry.isTable())
+        {
+            LOG_WARNING("Ignoring session '" << key << "' without table");
+            continue;
+        }
+
+        SessionConfiguration configuration;
+        if (entry[SESSION_S3].exists())
+        {
+            configuration.s3 = chrono::milliseconds(max<uint32_t>(1, uint32_t(entry[SESSION_S3])));
+        }
+        if (entry[SESSION_P2].exists())
+        {
+            configuration.p2 = chrono::milliseconds(uint32_t(entry[SESSION_P2]));
+        }
+        if (entry[SESSION_P2_STAR].exists())
+        {
+            configuration.p2Star = chrono::milliseconds(uint32_t(entry[SESSION_P2_STAR]));
+        }
+        auto services = entry[SESSION_SERVICES];
+        if (services.isTable())
+        {
+            configuration.allowedServices.reset();
+            configuration.allowedServices.set(DIAGNOSTIC_SESSION_CONTROL_REQ);
+            configuration.allowedServices.set(TESTER_PRESENT_REQ);
+            for (int i = 1; services[i].exists(); ++i)
+            {
+                configuration.allowedServices.set(uint8_t(uint32_t(services[i])));
+            }
+        }
+        sessionConfigurations_[uint8_t(session)] = configuration;
+    }
+}
+
+/**
+ * Compiles the value of a single request table entry, see
+ * `compileResponseValue()`. The table is looked up from the global table, so
+ * use `Selector::forEach()` and `compileResponseValue()` to compile all entries.
+ *
+ * @param luaState: the loaded Lua state
+ * @param table: the request table of the ECU (e.g. 'Raw')
+ * @param key: the key of the entry
+ * @param session: the session the table belongs to, see `getSessionTable()`
+ * @return the compiled response
+ */
+RequestResponse EcuLuaScript::compileResponse(sel::State& luaState, const char *table, const string& key,
+                                              uint8_t session)
+{
+    lua_State *l = luaState.GetLuaState();
+    ResetStackOnScopeExit savedStack(l);
+    RequestResponse response;
+
+    lua_getglobal(l, ecu_ident_.c_str());
+    if (!lua_istable(l, -1))
+    {
+        return response;
+    }
+    if (session != UdsSession::DEFAULT)
+    {
+        const char *sessionTable = getSessionTableName(session);
+        if (*sessionTable != '\0')
+        {
+            lua_getfield(l, -1, sessionTable);
+        }
+        else
+        {
+            lua_rawgeti(l, -1, session);
+        }
+        if (!lua_istable(l, -1))
+        {
+            return response;
+        }
+    }
+    lua_getfield(l, -1, table);
+    if (!lua_istable(l, -1))
+    {
+        return response;
+    }
+    lua_getfield(l, -1, key.c_str());
+    return compileResponseValue(l, lua_gettop(l));
+}
+
+/**
+ * Turns the value of a request table entry into the value stored in the
+ * request byte tree. Static values are decoded here once, lists of static
+ * values into a `ResponseSequence`. Functions are kept as registry reference
+ * (`LuaFunctionRef`) to be called on request.
+ *
+ * @param l: the Lua state
+ * @param index: the stack index of the value, it is not removed
+ * @return the compiled response
+ */
+RequestResponse EcuLuaScript::compileResponseValue(lua_State *l, int index)
+{
+    ResetStackOnScopeExit savedStack(l);
+    RequestResponse response;
+
+    lua_pushvalue(l, index);
+    if (lua_istable(l, -1))
+    {
+        // `delayed()` wraps a static response or list, e.g. delayed("62 F1 90 01", 20)
+        lua_getfield(l, -1, DELAYED_RESPONSE_FIELD);
+        if (!lua_isnil(l, -1))
+        {
+            lua_getfield(l, -2, DELAYED_RESPONSE_DELAY);
+            shared_ptr<const ResponseDelay> pDelay = createResponseDelay(l, lua_gettop(l));
+            response = compileResponseValue(l, lua_gettop(l) - 1);
+            if (response.isLuaFunction())
+            {
+                LOG_WARNING("Ignoring delayed() of a Lua function, which takes its time with sleep()");
+            }
+            else
+            {
+                response.pDelay = move(pDelay);
+            }
+            return response;
+        }
+        lua_pop(l, 1);
+    }
+    if (lua_istable(l, -1) && lua_rawlen(l, -1) > 0)
+    {
+        // a list of static responses, e.g. { "71 03 02 00 01", "71 03 02 00 02", hold = true }
+        auto pSequence = make_shared<ResponseSequence>();
+        const size_t count = lua_rawlen(l, -1);
+        for (size_t i = 1; i <= count; ++i)
+        {
+            lua_rawgeti(l, -1, int(i));
+            pSequence->literals.push_back(popLuaString(l));
+            pSequence->responses.push_back(literalHexStrToBytes(pSequence->literals.back()));
+        }
+        lua_getfield(l, -1, SEQUENCE_HOLD_FIELD);
+        pSequence->isHeld = lua_toboolean(l, -1);
+        lua_pop(l, 1);
+        lua_getfield(l, -1, SEQUENCE_SESSION_FIELD);
+        pSequence->isSessionScoped = lua_toboolean(l, -1);
+        lua_pop(l, 1);
+        response.literal = pSequence->literals.front();
+        response.bytes = pSequence->responses.front();
+        response.pSequence = move(pSequence);
+        return response;
+    }
+    shared_ptr<ResponseCache> pCache;
+    if (lua_istable(l, -1))
+    {
+        // `cached()` wraps a plain function or the table of `binary()` or `direct()`
+        pCache = createResponseCache(l, lua_gettop(l));
+        lua_getfield(l, -1, CACHED_FUNCTION_FIELD);
+        if (!lua_isfunction(l, -1))
+        {
+            lua_pop(l, 1);
+            lua_getfield(l, -1, BINARY_FUNCTION_FIELD);
+            response.isBinary = lua_isfunction(l, -1);
+            if (!response.isBinary)
+            {
+                lua_pop(l, 1);
+                lua_getfield(l, -1, DIRECT_FUNCTION_FIELD);
+                response.isDirect = lua_isfunction(l, -1);
+                if (!response.isDirect)
+                {
+                    lua_pop(l, 1);
+                }
+            }
+        }
+    }
+    if (lua_isfunction(l, -1))
+    {
+        response.luaFunction.l = l;
+        response.luaFunction.ref = luaL_ref(l, LUA_REGISTRYINDEX);
+        response.pCache = move(pCache);
+    }
+    else
+    {
+        response.literal = popLuaString(l);
+        response.bytes = literalHexStrToBytes(response.literal);
+    }
+    return response;
+}
+
+/**
+ * Creates the cache of a function wrapped in `cached()`, configured by the
+ * `cache` field of its table: "pure" keeps the responses until
+ * `invalidateCache()` is called, a number for that many milliseconds.
+ *
+ * @param l: the Lua state
+ * @param index: the stack index of the table of the entry
+ * @return the cache, `nullptr` if the table has no valid `cache` field
+ */
+shared_ptr<ResponseCache> EcuLuaScript::createResponseCache(lua_State *l, int index)
+{
+    ResetStackOnScopeExit savedStack(l);
+    lua_getfield(l, index, CACHE_FIELD);
+    if (lua_isnil(l, -1))
+    {
+        return nullptr;
+    }
+    if (lua_type(l, -1) == LUA_TNUMBER && lua_tonumber(l, -1) > 0)
+    {
+        const chrono::duration<double, milli> ttl(lua_tonumber(l, -1));
+        return std::make_shared<ResponseCache>(chrono::duration_cast<SimulationClock::Duration>(ttl), pCacheEpoch_);
+    }
+    if (lua_type(l, -1) == LUA_TSTRING && toStringView(l, -1) == CACHE_PURE)
+    {
+        return std::make_shared<ResponseCache>(SimulationClock::Duration::zero(), pCacheEpoch_);
+    }
+    LOG_WARNING("Ignoring invalid cache '" << toStringView(l, -1) << "', expected \"" << CACHE_PURE
+                << "\" or a TTL in ms");
+    return nullptr;
+}
+
+/**
+ * Creates the response time distribution of the `ResponseDelay` field or of
+ * an entry wrapped in `delayed()`: a number is a fixed delay in ms, a table
+ * has the `distribution` "fixed" (`delay`), "uniform" (`min`, `max`),
+ * "normal" (`mean`, `stddev`) or "histogram" (`bins`, the recorded delays in
+ * ms with their counts).
+ *
+ * @param l: the Lua state
+ * @param index: the stack index of the delay
+ * @return the distribution, `nullptr` if it is invalid
+ */
+shared_ptr<const ResponseDelay> EcuLuaScript::createResponseDelay(lua_State *l, int index)
+{
+    ResetStackOnScopeExit savedStack(l);
+    const auto getNumber = [l, index](const char *field) {
+        lua_getfield(l, index, field);
+        const double value = lua_type(l, -1) == LUA_TNUMBER ? lua_tonumber(l, -1) : -1;
+        lua_pop(l, 1);
+        return value;
+    };
+
+    ResponseDelay delay;
+    if (lua_type(l, index) == LUA_TNUMBER)
+    {
+        delay = ResponseDelay::fixed(lua_tonumber(l, index));
+    }
+    else if (!lua_istable(l, index))
+    {
+        LOG_WARNING("Ignoring the response delay of type " << lua_typename(l, lua_type(l, index))
+                    << ", expected ms or a table");
+        return nullptr;
+    }
+    else
+    {
+        lua_getfield(l, index, RESPONSE_DELAY_DISTRIBUTION);
+        const string distribution = lua_type(l, -1) == LUA_TSTRING ? string(toStringView(l, -1)) : "fixed";
+        if (distribution == "fixed")
+        {
+            delay = ResponseDelay::fixed(getNumber(RESPONSE_DELAY_VALUE));
+        }
+        else if (distribution == "uniform")
+        {
+            delay = ResponseDelay::uniform(getNumber(RESPONSE_DELAY_MIN), getNumber(RESPONSE_DELAY_MAX));
+        }
+        else if (distribution == "normal")
+        {
+            delay = ResponseDelay::normal(getNumber(RESPONSE_DELAY_MEAN), getNumber(RESPONSE_DELAY_STDDEV));
+        }
+        else if (distribution == "histogram")
+        {
+            vector<pair<double, double>> bins;
+            lua_getfield(l, index, RESPONSE_DELAY_BINS);
+            if (lua_istable(l, -1))
+            {
+                lua_pushnil(l);
+                while (lua_next(l, -2) != 0)
+                {
+                    if (lua_type(l, -2) == LUA_TNUMBER && lua_type(l, -1) == LUA_TNUMBER)
+                    {
+                        bins.emplace_back(lua_tonumber(l, -2), lua_tonumber(l, -1));
+                    }
+                    lua_pop(l, 1);
+                }
+            }
+            delay = ResponseDelay::histogram(bins);
+        }
+        else
+        {
+            LOG_WARNING("Ignoring the response delay with the unknown distribution '" << distribution << "'");
+            return nullptr;
+        }
+    }
+    if (!delay.isValid())
+    {
+        LOG_WARNING("Ignoring an invalid response delay");
+        return nullptr;
+    }
+    return make_shared<const ResponseDelay>(move(delay));
+}
+
+/**
+ * Calls the Lua function of a request table entry. Must be called from the Lua
+ * worker.
+ *
+ * @param function: the function of the entry
+ * @param argument: the request, as literal hex string or raw bytes
+ * @return the string returned by the function, empty on errors
+ */
+string EcuLuaScript::callLuaFunction(const LuaFunctionRef& function, string_view argument)
+{
+    lua_State *l = function.l;
+    ResetStackOnScopeExit savedStack(l);
+    lua_rawgeti(l, LUA_REGISTRYINDEX, function.ref);
+    lua_pushlstring(l, argument.data(), argument.size());
+    if (lua_pcall(l, 1, 1, 0) != LUA_OK)
+    {
+        const char *msg = lua_tostring(l, -1);
+        LOG_ERROR("Error in the response function: " << (msg ? msg : "unknown"));
+        return "";
+    }
+    return popLuaString(l);
+}
+
+/**
+ * Builds a RequestByteTree from the compiled entries of a request table.
+ *
+ * @param entries: the table keys and their compiled responses
+ */
+shared_ptr<RequestByteTreeNode<RequestResponse>> EcuLuaScript::buildRequestByteTree(
+    vector<pair<string, RequestResponse>> entries) {
+
+    shared_ptr<RequestByteTreeNode<RequestResponse>> requestByteTree(new RequestByteTreeNode<RequestResponse>());
+    // the keys of a Lua table come in hash order, sort them for a reproducible definition order
+    sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (auto& entry : entries)
+    {
+        try {
+            string requestString = cleanupString(entry.first);
+            auto requestByteLeaf = addRequestToTree(requestByteTree.get(), requestString);
+            requestByteLeaf->setLuaResponse(move(entry.second));
+        } catch(exception &e) {
+            LOG_WARNING("Ignoring invalid request '" << entry.first << "': " << e.what());
+        }
+    }
+
+    return requestByteTree;
+}
+
+/**
+ * Compiles all entries of a request table in a single pass over the table.
+ *
+ * @param l: the Lua state of the table
+ * @param table: the request table
+ * @param entries: the compiled entries are appended
+ * @param isIncluded: returns false for the keys to skip
+ * @param pPreviousResponses: the static responses of the previous version of
+ *                            the table by key, an unchanged string is taken
+ *                            over instead of being decoded again
+ */
+void EcuLuaScript::compileRequestTable(lua_State *l, sel::Selector table, vector<pair<string, RequestResponse>>& entries,
+                                       const std::function<bool(const string& key)>& isIncluded,
+                                       const PreviousResponses *pPreviousResponses)
+{
+    table.forEach([&](const string& key, int value) {
+        if (isIncluded && !isIncluded(key))
+        {
+            return;
+        }
+        if (pPreviousResponses && lua_type(l, value) == LUA_TSTRING)
+        {
+            const auto previous = pPreviousResponses->find(key);
+            if (previous != pPreviousResponses->end() && previous->second->literal == toStringView(l, value))
+            {
+                entries.emplace_back(key, *previous->second);
+                return;
+            }
+        }
+        try {
+            RequestResponse response = compileResponseValue(l, value);
+            response.tableKey = key;
+            entries.emplace_back(key, move(response));
+        } catch(exception &e) {
+            LOG_WARNING("Ignoring invalid request '" << key << "': " << e.what());
+        }
+    });
+}
+
+/**
+ * Build a RequestByteTree from the 'Raw' table in the current simulation
+ */
+shared_ptr<RequestByteTreeNode<RequestResponse>> EcuLuaScript::buildRequestByteTreeFromRawTable() {
+    return luaWorker_->call([&]() -> shared_ptr<RequestByteTreeNode<RequestResponse>> {
+        return buildRawRequestTree(*pLuaState_);
+    });
+}
+
+/**
+ * Returns a table of the given session in the ECU table: the ECU table itself
+ * for the default session, `Programming` and `Extended`, or the table with the
+ * session ID as key for other sessions, e.g. `[0x40] = { Raw = { ... } }`.
+ *
+ * @param luaState: the loaded Lua state
+ * @param session: the session ID
+ * @return the selector of the table, which might not exist
+ */
+sel::Selector EcuLuaScript::getSessionTable(sel::State& luaState, uint8_t session)
+{
+    const char *sessionTable = getSessionTableName(session);
+    if (session == UdsSession::DEFAULT)
+    {
+        return luaState[ecu_ident_.c_str()];
+    }
+    if (*sessionTable != '\0')
+    {
+        return luaState[ecu_ident_.c_str()][sessionTable];
+    }
+    return luaState[ecu_ident_.c_str()][int(session)];
+}
+
+/**
+ * Build a RequestByteTree from the 'Raw' table of the given Lua state. Must be
+ * called from the Lua worker or with a state no other thread knows yet.
+ *
+ * The tree of a session contains the entries of its own 'Raw' table and the
+ * ones of the ECU table with other keys, so the session table only needs the
+ * entries which differ.
+ *
+ * @param luaState: the loaded Lua state
+ * @param session: the session of the table, see `getSessionTable()`
+ */
+shared_ptr<RequestByteTreeNode<RequestResponse>> EcuLuaScript::buildRawRequestTree(sel::State& luaState, uint8_t session) {
+    return buildRequestByteTree(compileRawEntries(luaState, session));
+}
+
+/**
+ * Compiles the entries of the 'Raw' table of a session, see
+ * `buildRawRequestTree()`.
+ *
+ * @param luaState: the loaded Lua state
+ * @param session: the session of the table, see `getSessionTable()`
+ * @param pPreviousResponses: the static responses of the previous version of
+ *                            the table, see `compileRequestTable()`
+ * @return the table keys and their compiled responses
+ */
+vector<pair<string, RequestResponse>> EcuLuaScript::compileRawEntries(sel::State& luaState, uint8_t session,
+                                                                      const PreviousResponses *pPreviousResponses) {
+    LOG_INFO("Get 'Raw' request tree from ident: " << ecu_ident_ << ", session: 0x" << hex << unsigned(session));
+    lua_State *l = luaState.GetLuaState();
+    vector<pair<string, RequestResponse>> entries;
+    set<string> overriddenRequests;
+    if (session != UdsSession::DEFAULT)
+    {
+        compileRequestTable(l, getSessionTable(luaState, session)[RAW_TABLE], entries, nullptr, pPreviousResponses);
+        for (const auto& entry : entries)
+        {
+            overriddenRequests.insert(cleanupString(entry.first));
+        }
+    }
+    compileRequestTable(l, luaState[ecu_ident_.c_str()][RAW_TABLE], entries,
+        [this, &overriddenRequests](const string &key) {
+            return overriddenRequests.empty() || overriddenRequests.count(cleanupString(key)) == 0;
+        }, pPreviousResponses);
+    return entries;
+}
+
+/**
+ * Compiles the 'Raw' table of a session again after a reload. The unchanged
+ * static responses of the previous matcher are taken over instead of being
+ * decoded again. If the table still has the same keys, only the responses
+ * changed, so the new matcher shares the nodes of the previous one (see
+ * `LuaRequestMatcher::withLeaves()`) and no tree is built at all.
+ *
+ * @param luaState: the loaded Lua state
+ * @param session: the session of the table, see `getSessionTable()`
+ * @param pPreviousMatcher: the matcher of the table before the reload,
+ *                          `nullptr` to build the matcher from scratch
+ * @return the matcher of the table
+ */
+shared_ptr<const LuaRequestMatcher> EcuLuaScript::compileRawRequestMatcher(sel::State& luaState, uint8_t session,
+                                                                           const LuaRequestMatcher *pPreviousMatcher) {
+    if (!pPreviousMatcher) {
+        return std::make_shared<const LuaRequestMatcher>(buildRawRequestTree(luaState, session));
+    }
+    unordered_map<string_view, size_t> previousRanks;
+    PreviousResponses previousResponses;
+    for (size_t rank = 0; rank < pPreviousMatcher->getLeafCount(); ++rank) {
+        const RequestResponse& response = pPreviousMatcher->getLeaf(rank);
+        previousRanks.emplace(response.tableKey, rank);
+        // list entries and caches have a state, `delayed()` is a table
+        if (!response.isLuaFunction() && !response.pSequence && !response.pCache && !response.pDelay) {
+            previousResponses.emplace(response.tableKey, &response);
+        }
+    }
+    vector<pair<string, RequestResponse>> entries = compileRawEntries(luaState, session, &previousResponses);
+    const bool hasSameKeys = entries.size() == previousRanks.size()
+        && all_of(entries.cbegin(), entries.cend(), [&previousRanks](const auto& entry) {
+            return previousRanks.count(entry.first) != 0;
+        });
+    if (!hasSameKeys) {
+        return std::make_shared<const LuaRequestMatcher>(buildRequestByteTree(move(entries)));
+    }
+    vector<RequestResponse> leaves(entries.size());
+    for (auto& entry : entries) {
+        leaves[previousRanks[entry.first]] = move(entry.second);
+    }
+    LOG_INFO("Keeping the 'Raw' request tree of ident: " << ecu_ident_ << ", session: 0x" << hex << unsigned(session)
+             << ", the keys are unchanged");
+    return std::make_shared<const LuaRequestMatcher>(pPreviousMatcher->withLeaves(move(leaves)));
+}
+
+/**
+ * Enables or disables the snapshots of the 'Raw' tables, see
+ * `getRawRequestMatcher()`. Disabled by default.
+ *
+ * @param isEnabled: true to load and write `<script>.snapshot` files
+ */
+void EcuLuaScript::setSnapshotsEnabled(bool isEnabled) noexcept
+{
+    isSnapshotEnabled_ = isEnabled;
+}
+
+/**
+ * Enables laying out the nodes of the hit requests first when a 'Raw' table
+ * is reloaded, see `LuaRequestMatcher::relayout()`. Disabled by default.
+ *
+ * @param isEnabled: true to lay out the reloaded tables by their hits
+ */
+void EcuLuaScript::setHotRelayoutEnabled(bool isEnabled) noexcept
+{
+    isHotRelayoutEnabled_ = isEnabled;
+}
+
+/**
+ * Returns the compiled 'Raw' table of a session. The tables of all sessions
+ * are built on the first call only, so the UDS and the DoIP simulation of the
+ * same script share one matcher instead of walking all keys of the table twice.
+ *
+ * A session with its own 'Raw' table (see `getSessionTable()`) gets its own
+ * matcher, all other sessions the one of the ECU table. The session is
+ * selected by a single lookup, so session dependent responses need no Lua
+ * function calling `getCurrentSession()`.
+ *
+ * The matchers are replaced by `reload()`, so the receivers fetch them for
+ * every request and keep them until the response is sent. A request in flight
+ * ends on the version it was started with.
+ *
+ * @param session: the current session, e.g. `SessionController::getCurrentUdsSession()`
+ * @return the matcher of the 'Raw' table of the session
+ */
+shared_ptr<const LuaRequestMatcher> EcuLuaScript::getRawRequestMatcher(uint8_t session) {
+    shared_ptr<const RawRequestMatchers> pMatchers = atomic_load(&pRawRequestMatchers_);
+    if (!pMatchers) {
+        lock_guard<mutex> lock(rawRequestMatcherMutex_);
+        pMatchers = atomic_load(&pRawRequestMatchers_);
+        if (!pMatchers) {
+            pMatchers = luaWorker_->call([&]() -> shared_ptr<const RawRequestMatchers> {
+                return compileRawRequestMatchers(pLuaState_);
+            });
+            atomic_store(&pRawRequestMatchers_, pMatchers);
+            publishRequestHits();
+        }
+    }
+    // shares the ownership of all matchers and the Lua state
+    return shared_ptr<const LuaRequestMatcher>(pMatchers, pMatchers->sessions[session]);
+}
+
+/**
+ * Compiles the 'Raw' tables of all sessions of the given Lua state. Must be
+ * called from the Lua worker or with a state no other thread knows yet.
+ *
+ * With snapshots enabled the matcher of the ECU table is loaded from the
+ * snapshot of the script, if it is up to date, otherwise it is built and the
+ * snapshot is written for the next start. The tables of the sessions are
+ * always built.
+ *
+ * On a reload the tables are compiled incrementally from the running ones,
+ * see `compileRawRequestMatcher()`.
+ *
+ * The hits of the running tables are taken over by the table key, so they
+ * continue over a reload. With `setHotRelayoutEnabled()` a reloaded table
+ * which was hit is laid out by its hits.
+ *
+ * @param pLuaState: the loaded Lua state, it is kept alive by the matchers,
+ *                   since the Lua functions in the leaves belong to it
+ * @return the matchers of the 'Raw' tables
+ */
+shared_ptr<const EcuLuaScript::RawRequestMatchers> EcuLuaScript::compileRawRequestMatchers(
+    const shared_ptr<sel::State>& pLuaState) {
+    const shared_ptr<const RawRequestMatchers> pOldMatchers = atomic_load(&pRawRequestMatchers_);
+    shared_ptr<const LuaRequestMatcher> pMatcher;
+    const string snapshotFile = RequestSnapshot::getSnapshotFile(scriptFile_);
+    const bool useSnapshot = isSnapshotEnabled_ && !scriptFile_.empty();
+    if (useSnapshot) {
+        pMatcher = RequestSnapshot::load(snapshotFile, scriptFile_, ecu_ident_,
+            [this, &pLuaState](const string &tableKey) {
+                RequestResponse response = compileResponse(*pLuaState, RAW_TABLE, tableKey);
+                response.tableKey = tableKey;
+                return response;
+            });
+    }
+    if (!pMatcher) {
+        pMatcher = compileRawRequestMatcher(*pLuaState, UdsSession::DEFAULT,
+            pOldMatchers ? pOldMatchers->sessions[UdsSession::DEFAULT] : nullptr);
+        if (useSnapshot) {
+            RequestSnapshot::write(snapshotFile, scriptFile_, ecu_ident_, *pMatcher);
+        }
+    }
+
+    auto takeOverHits = [&pOldMatchers](shared_ptr<const LuaRequestMatcher> pNewMatcher, uint8_t session) {
+        if (!pOldMatchers || !pNewMatcher->getHitCounters()) {
+            return pNewMatcher;
+        }
+        // a session gets the hits of its own table, not the ones of the ECU table
+        const LuaRequestMatcher *pOldMatcher = pOldMatchers->sessions[session];
+        if (!pOldMatcher->getHitCounters()
+            || (pOldMatcher == pOldMatchers->sessions[UdsSession::DEFAULT]) != (session == UdsSession::DEFAULT)) {
+            return pNewMatcher;
+        }
+        unordered_map<string_view, uint64_t> oldHits;
+        for (size_t rank = 0; rank < pOldMatcher->getLeafCount(); ++rank) {
+            const uint64_t hits = pOldMatcher->getHitCounters()->get(rank);
+            if (hits != 0) {
+                oldHits.emplace(pOldMatcher->getLeaf(rank).tableKey, hits);
+            }
+        }
+        if (oldHits.empty()) {
+            return pNewMatcher;
+        }
+        for (size_t rank = 0; rank < pNewMatcher->getLeafCount(); ++rank) {
+            const auto oldHit = oldHits.find(pNewMatcher->getLeaf(rank).tableKey);
+            if (oldHit != oldHits.end()) {
+                pNewMatcher->getHitCounters()->add(rank, oldHit->second);
+            }
+        }
+        if (!isHotRelayoutEnabled_) {
+            return pNewMatcher;
+        }
+        // a snapshot is read-only, so the copy gets its own arrays
+        auto pRelayoutMatcher = std::make_shared<LuaRequestMatcher>(*pNewMatcher);
+        pRelayoutMatcher->relayout();
+        return shared_ptr<const LuaRequestMatcher>(move(pRelayoutMatcher));
+    };
+    pMatcher = takeOverHits(move(pMatcher), UdsSession::DEFAULT);
+
+    auto pMatchers = std::make_shared<RawRequestMatchers>();
+    pMatchers->pLuaState = pLuaState;
+    pMatchers->sessions.fill(pMatcher.get());
+    pMatchers->matchers.push_back(move(pMatcher));
+    for (unsigned session = UdsSession::DEFAULT + 1; session < pMatchers->sessions.size(); ++session) {
+        if (getSessionTable(*pLuaState, uint8_t(session))[RAW_TABLE].exists()) {
+            // a session sharing the ECU table before the reload starts from scratch
+            const LuaRequestMatcher *pOldMatcher = pOldMatchers
+                && pOldMatchers->sessions[session] != pOldMatchers->sessions[UdsSession::DEFAULT]
+                ? pOldMatchers->sessions[session] : nullptr;
+            auto pSessionMatcher = takeOverHits(
+                compileRawRequestMatcher(*pLuaState, uint8_t(session), pOldMatcher), uint8_t(session));
+            pMatchers->sessions[session] = pSessionMatcher.get();
+            pMatchers->matchers.push_back(move(pSessionMatcher));
+        }
+    }
+    return pMatchers;
+}
+
+/**
+ * Publishes the hit counters of the compiled 'Raw' and `ReadDataByIdentifier`
+ * tables with their keys, after they are compiled or replaced. A table shared
+ * by several sessions is published once, without session.
+ */
+void EcuLuaScript::publishRequestHits() const
+{
+    auto pTables = std::make_shared<RequestHitStatistics::Tables>();
+    const shared_ptr<const RawRequestMatchers> pMatchers = atomic_load(&pRawRequestMatchers_);
+    if (pMatchers)
+    {
+        set<const LuaRequestMatcher*> visited;
+        for (size_t session = 0; session < pMatchers->sessions.size(); ++session)
+        {
+            const LuaRequestMatcher *pMatcher = pMatchers->sessions[session];
+            if (!visited.insert(pMatcher).second || !pMatcher->getHitCounters())
+            {
+                continue;
+            }
+            RequestHitStatistics::Table table;
+            table.name = RAW_TABLE;
+            if (pMatcher != pMatchers->sessions[UdsSession::DEFAULT])
+            {
+                const uint8_t sessionId = uint8_t(session);
+                intToHexString(&sessionId, 1, table.session);
+            }
+            table.keys.reserve(pMatcher->getLeafCount());
+            for (size_t rank = 0; rank < pMatcher->getLeafCount(); ++rank)
+            {
+                table.keys.push_back(pMatcher->getLeaf(rank).tableKey);
+            }
+            table.pCounters = pMatcher->getHitCounters();
+            pTables->push_back(move(table));
+        }
+    }
+    for (const auto& index : *getDataIdentifierIndices())
+    {
+        if (!index.second.getHitCounters())
+        {
+            continue;
+        }
+        RequestHitStatistics::Table table;
+        table.name = READ_DATA_BY_IDENTIFIER_TABLE;
+        table.session = index.first;
+        table.keys.reserve(index.second.size());
+        for (const DataIdentifierIndex::Entry& entry : index.second.getEntries())
+        {
+            const uint8_t identifier[] = {uint8_t(entry.identifier >> 8), uint8_t(entry.identifier)};
+            table.keys.emplace_back();
+            intToHexString(identifier, sizeof(identifier), table.keys.back());
+        }
+        table.pCounters = index.second.getHitCounters();
+        pTables->push_back(move(table));
+    }
+    pRequestHits_->setTables(move(pTables));
+}
+
+/**
+ * Loads the script again, e.g. after it was changed, without interrupting the
+ * simulation. The new version is loaded into a new Lua state and compiled by
+ * the calling thread, only the final swap is done by the Lua worker, so the
+ * requests are not blocked while the script is compiled.
+ *
+ * The CAN IDs and the DoIP address are not changed, since the sockets are
+ * bound to them, and the J1939 simulation keeps the version it was started
+ * with. Both need a restart of the simulator.
+ *
+ * @return true if the new version is active, false if the script could not be
+ *         loaded and the old version is kept
+ */
+bool EcuLuaScript::reload()
+{
+    lock_guard<mutex> lock(rawRequestMatcherMutex_);
+    if (scriptFile_.empty())
+    {
+        return false;
+    }
+
+    auto pLuaState = createLuaState(pLuaMemory_);
+    if (!utils::existsFile(scriptFile_) || !loadScript(*pLuaState, scriptFile_)
+        || !(*pLuaState)[ecu_ident_.c_str()].exists())
+    {
+        LOG_WARNING("Can not reload " << scriptFile_ << ", keeping the running version");
+        return false;
+    }
+
+    auto hasChanged = [&pLuaState, this](const char *field, bool hasValue, uint32_t value) {
+        auto newValue = (*pLuaState)[ecu_ident_.c_str()][field];
+        return newValue.exists() != hasValue || (hasValue && uint32_t(newValue) != value);
+    };
+    if (hasChanged(REQ_ID_FIELD, hasRequestId_, requestId_) || hasChanged(RES_ID_FIELD, hasResponseId_, responseId_)
+        || hasChanged(DOIP_LOGICAL_ECU_ADDRESS_FIELD, hasDoIPLogicalEcuAddress_, doipLogicalEcuAddress_))
+    {
+        LOG_WARNING("The addresses in " << scriptFile_ << " are only changed by a restart");
+    }
+    configureLuaState(*pLuaState);
+
+    const auto pIndices = compileDataIdentifierIndices(*pLuaState);
+    shared_ptr<const RawRequestMatchers> pMatchers;
+    if (atomic_load(&pRawRequestMatchers_))
+    {
+        pMatchers = compileRawRequestMatchers(pLuaState);
+    }
+
+    luaWorker_->call([&]() {
+        // the old registry references are released while the old state is still alive
+        shared_ptr<sel::State> pOldLuaState = move(pLuaState_);
+        if (pJ1939Simulator_ && !pJ1939Version_)
+        {
+            // the old 'Raw' matcher shares the state with the J1939 simulation, so
+            // it must not be released by a receiver while the worker runs a PGN
+            shared_ptr<const RawRequestMatchers> pOldMatchers = atomic_load(&pRawRequestMatchers_);
+            pJ1939Version_ = pOldMatchers ? shared_ptr<const void>(pOldMatchers) : shared_ptr<const void>(pOldLuaState);
+        }
+        pLuaState_ = pLuaState;
+        ecuTableRef_.reset();
+        dataIdentifierTableRefs_.clear();
+        restoreStateRef_.reset();
+        createTableRefs();
+        captureLuaState();
+        atomic_store(&pDataIdentifierIndices_, pIndices);
+        if (pMatchers)
+        {
+            atomic_store(&pRawRequestMatchers_, pMatchers);
+        }
+        publishRequestHits();
+    });
+    LOG_INFO("Reloaded " << scriptFile_);
+    return true;
+}
+
+/**
+ * Returns the ECU to the state after loading its configuration, on an
+ * `ECUReset`: the globals of the Lua state (including the tables of the ECU),
+ * the fault memory, the DIDs written into RAM (see `DidStore::reset()`) and
+ * the communication, which is enabled again.
+ * The cached responses are dropped. The Lua state is restored by the Lua
+ * worker before it runs the next request, so the reset neither waits for the
+ * worker nor reloads the script. The locals of the script (e.g. upvalues of
+ * its functions) are not restored.
+ */
+void EcuLuaScript::resetState()
+{
+    pDidStore_->reset();
+    pDtcStore_->restoreInitialState();
+    pCommunicationGate_->reset();
+    invalidateCache();
+    luaWorker_->post([this]() {
+        crcStreams_.clear();
+        if (!restoreStateRef_)
+        {
+            return;
+        }
+        lua_State *l = pLuaState_->GetLuaState();
+        ResetStackOnScopeExit savedStack(l);
+        restoreStateRef_->Push(l);
+        if (lua_pcall(l, 0, 0, 0) != LUA_OK)
+        {
+            LOG_ERROR("Can not restore the Lua state of " << ecu_ident_ << ": " << popLuaString(l));
+        }
+    });
+}
+
+/**
+ * Adds the runtime state of the ECU to a checkpoint: the fault memory, the
+ * written DIDs, the session, the positions of the response lists, the globals
+ * listed in the `Checkpoint` field of the ECU table and the phases of the
+ * cyclic PGNs. The sections are owned by the script file.
+ *
+ * @param checkpoint: the checkpoint to add the sections to
+ */
+void EcuLuaScript::saveCheckpoint(Checkpoint& checkpoint)
+{
+    if (scriptFile_.empty())
+    {
+        return;
+    }
+    string dtcs;
+    pDtcStore_->serialize(dtcs);
+    checkpoint.add(CheckpointSection::DTC_STORE, scriptFile_, move(dtcs));
+    string dids;
+    pDidStore_->serialize(dids);
+    checkpoint.add(CheckpointSection::DID_STORE, scriptFile_, move(dids));
+
+    uint32_t resetEpoch = 0;
+    uint32_t sessionEpoch = 0;
+    if (pSessionCtrl_ != nullptr)
+    {
+        string session;
+        CheckpointEncoder(session).put(uint8_t(pSessionCtrl_->getCurrentUdsSession()));
+        checkpoint.add(CheckpointSection::SESSION, scriptFile_, move(session));
+        resetEpoch = pSessionCtrl_->getResetEpoch();
+        sessionEpoch = pSessionCtrl_->getSessionEpoch();
+    }
+
+    string sequences;
+    CheckpointEncoder encoder(sequences);
+    forEachResponseSequence([&encoder, resetEpoch, sessionEpoch](uint8_t session, const RequestResponse& response) {
+        const ResponseSequence& sequence = *response.pSequence;
+        const uint64_t epoch = sequence.isSessionScoped ? sessionEpoch : resetEpoch;
+        const uint64_t state = sequence.state.load(memory_order_relaxed);
+        encoder.put(session);
+        encoder.putString(response.tableKey);
+        encoder.put((state >> 32) == epoch ? uint32_t(state) : uint32_t(0));
+    });
+    checkpoint.add(CheckpointSection::SEQUENCES, scriptFile_, move(sequences));
+
+    string globals = luaWorker_->call([this]() { return saveLuaGlobals(); });
+    if (!globals.empty())
+    {
+        checkpoint.add(CheckpointSection::LUA_GLOBALS, scriptFile_, move(globals));
+    }
+
+    if (pJ1939Simulator_ != nullptr)
+    {
+        string phases;
+        CheckpointEncoder phaseEncoder(phases);
+        for (const auto& phase : J1939CyclicScheduler::getInstance().getPhases(pJ1939Simulator_))
+        {
+            phaseEncoder.put(phase.first);
+            phaseEncoder.put(phase.second);
+        }
+        checkpoint.add(CheckpointSection::J1939_PHASES, scriptFile_, move(phases));
+    }
+}
+
+/**
+ * Restores the runtime state of the ECU from the sections of a checkpoint
+ * written by `saveCheckpoint()`. The state without section in the checkpoint
+ * is kept, the caches of the `cached()` functions are dropped.
+ *
+ * @param checkpoint: the loaded checkpoint
+ */
+void EcuLuaScript::restoreCheckpoint(const Checkpoint& checkpoint)
+{
+    if (scriptFile_.empty())
+    {
+        return;
+    }
+    auto restore = [this, &checkpoint](CheckpointSection section, const char *name, auto deserialize) {
+        const auto data = checkpoint.find(section, scriptFile_);
+        if (data && !deserialize(*data))
+        {
+            LOG_WARNING("Ignoring the invalid " << name << " of " << scriptFile_ << " in the checkpoint");
+        }
+    };
+    restore(CheckpointSection::DTC_STORE, "DTCs", [this](string_view data) {
+        return pDtcStore_->deserialize(data);
+    });
+    restore(CheckpointSection::DID_STORE, "DIDs", [this](string_view data) {
+        return pDidStore_->deserialize(data);
+    });
+    restore(CheckpointSection::SESSION, "session", [this](string_view data) {
+        uint8_t session;
+        if (!CheckpointDecoder(data).get(session))
+        {
+            return false;
+        }
+        if (pSessionCtrl_ != nullptr && pSessionCtrl_->isSessionSupported(session))
+        {
+            pSessionCtrl_->stop();
+            pSessionCtrl_->setCurrentUdsSession(UdsSession(session));
+            if (session != UdsSession::DEFAULT)
+            {
+                pSessionCtrl_->startSession();
+            }
+        }
+        return true;
+    });
+    // after the session, which starts the session scoped lists over
+    restore(CheckpointSection::SEQUENCES, "response lists", [this](string_view data) {
+        CheckpointDecoder decoder(data);
+        map<pair<uint8_t, string_view>, uint32_t> positions;
+        while (!decoder.isAtEnd())
+        {
+            uint8_t session;
+            string_view tableKey;
+            uint32_t position;
+            if (!decoder.get(session) || !decoder.getBytes(tableKey) || !decoder.get(position))
+            {
+                return false;
+            }
+            positions[make_pair(session, tableKey)] = position;
+        }
+        if (positions.empty())
+        {
+            return true;
+        }
+        getRawRequestMatcher();
+        const uint64_t resetEpoch = pSessionCtrl_ ? pSessionCtrl_->getResetEpoch() : 0;
+        const uint64_t sessionEpoch = pSessionCtrl_ ? pSessionCtrl_->getSessionEpoch() : 0;
+        forEachResponseSequence([&](uint8_t session, const RequestResponse& response) {
+            const ResponseSequence& sequence = *response.pSequence;
+            const auto position = positions.find(make_pair(session, string_view(response.tableKey)));
+            const uint32_t next = position != positions.end() && position->second < sequence.responses.size()
+                ? position->second : 0;
+            sequence.state.store(((sequence.isSessionScoped ? sessionEpoch : resetEpoch) << 32) | next,
+                                 memory_order_relaxed);
+        });
+        return true;
+    });
+    invalidateCache();
+    luaWorker_->call([this, &checkpoint]() {
+        crcStreams_.clear();
+        const auto globals = checkpoint.find(CheckpointSection::LUA_GLOBALS, scriptFile_);
+        if (globals)
+        {
+            restoreLuaGlobals(*globals);
+        }
+    });
+    restore(CheckpointSection::J1939_PHASES, "J1939 phases", [this](string_view data) {
+        CheckpointDecoder decoder(data);
+        map<uint32_t, uint64_t> phases;
+        while (!decoder.isAtEnd())
+        {
+            uint32_t pgn;
+            uint64_t phase;
+            if (!decoder.get(pgn) || !decoder.get(phase))
+            {
+                return false;
+            }
+            phases[pgn] = phase;
+        }
+        if (pJ1939Simulator_ != nullptr)
+        {
+            J1939CyclicScheduler::getInstance().setPhases(pJ1939Simulator_, phases);
+        }
+        return true;
+    });
+}
+
+/**
+ * Calls the function with every response list of the compiled 'Raw' tables,
+ * nothing if they are not compiled yet. The session is the first one using
+ * the table, 0 for the one of the ECU table.
+ */
+void EcuLuaScript::forEachResponseSequence(
+    const std::function<void(uint8_t session, const RequestResponse& response)>& callback) const
+{
+    const shared_ptr<const RawRequestMatchers> pMatchers = atomic_load(&pRawRequestMatchers_);
+    if (!pMatchers)
+    {
+        return;
+    }
+    set<const LuaRequestMatcher*> visited;
+    for (size_t session = 0; session < pMatchers->sessions.size(); ++session)
+    {
+        const LuaRequestMatcher *pMatcher = pMatchers->sessions[session];
+        if (!visited.insert(pMatcher).second)
+        {
+            continue;
+        }
+        for (size_t rank = 0; rank < pMatcher->getLeafCount(); ++rank)
+        {
+            const RequestResponse& response = pMatcher->getLeaf(rank);
+            if (response.pSequence)
+            {
+                callback(uint8_t(session), response);
+            }
+        }
+    }
+}
+
+/**
+ * Encodes the globals listed in the `Checkpoint` field of the ECU table,
+ * with the Lua worker.
+ *
+ * @return the Lua chunk restoring them, empty if there is no such field
+ */
+string EcuLuaScript::saveLuaGlobals()
+{
+    if (!ecuTableRef_)
+    {
+        return string();
+    }
+    lua_State *l = pLuaState_->GetLuaState();
+    ResetStackOnScopeExit savedStack(l);
+    ecuTableRef_->Push(l);
+    lua_getfield(l, -1, CHECKPOINT_GLOBALS_FIELD);
+    if (!lua_istable(l, -1))
+    {
+        return string();
+    }
+    if (luaL_loadstring(l, CHECKPOINT_GLOBALS_CHUNK) != LUA_OK)
+    {
+        LOG_ERROR("Can not save the Lua globals of " << ecu_ident_ << ": " << popLuaString(l));
+        return string();
+    }
+    lua_insert(l, -2);
+    if (lua_pcall(l, 1, 1, 0) != LUA_OK)
+    {
+        LOG_ERROR("Can not save the Lua globals of " << ecu_ident_ << ": " << popLuaString(l));
+        return string();
+    }
+    return popLuaString(l);
+}
+
+/**
+ * Sets the globals listed in the `Checkpoint` field of the ECU table to the
+ * values of a checkpoint, with the Lua worker. Globals without value in the
+ * checkpoint are set to `nil`.
+ *
+ * @param globals: the chunk returned by `saveLuaGlobals()`
+ */
+void EcuLuaScript::restoreLuaGlobals(string_view globals)
+{
+    if (!ecuTableRef_)
+    {
+        return;
+    }
+    lua_State *l = pLuaState_->GetLuaState();
+    ResetStackOnScopeExit savedStack(l);
+    if (luaL_loadbuffer(l, globals.data(), globals.size(), "=checkpoint") != LUA_OK
+        || lua_pcall(l, 0, 1, 0) != LUA_OK)
+    {
+        LOG_ERROR("Can not restore the Lua globals of " << ecu_ident_ << ": " << popLuaString(l));
+        return;
+    }
+    const int values = lua_gettop(l);
+    ecuTableRef_->Push(l);
+    lua_getfield(l, -1, CHECKPOINT_GLOBALS_FIELD);
+    if (!lua_istable(l, values) || !lua_istable(l, -1))
+    {
+        return;
+    }
+    const int names = lua_gettop(l);
+    const size_t count = lua_rawlen(l, names);
+    for (size_t i = 1; i <= count; ++i)
+    {
+        lua_rawgeti(l, names, int(i));
+        if (lua_type(l, -1) == LUA_TSTRING)
+        {
+            const char *name = lua_tostring(l, -1);
+            lua_getfield(l, values, name);
+            lua_setglobal(l, name);
+        }
+        lua_pop(l, 1);
+    }
+}
+
+/**
+ * Build a RequestByteTree from the 'PGN' table in the current simulation
+ */
+shared_ptr<RequestByteTreeNode<RequestResponse>> EcuLuaScript::buildRequestByteTreeFromPGNTable() {
+    return luaWorker_->call([&]() -> shared_ptr<RequestByteTreeNode<RequestResponse>> {
+        LOG_INFO("Get 'PGN' request tree from ident: " << ecu_ident_);
+        vector<pair<string, RequestResponse>> entries;
+        compileRequestTable(pLuaState_->GetLuaState(), (*pLuaState_)[ecu_ident_.c_str()][J1939_PGN_TABLE], entries,
+            [](const string &key) { return key.find('#') != string::npos; });
+        return buildRequestByteTree(move(entries));
+    });
+}
+
+/**
+ * Fetch list of PGNs that do not contain the '#' character and map their
+ * numeric PGN to their Lua response
+ */
+J1939PgnIndex<shared_ptr<Selector>> EcuLuaScript::buildRequestPGNIndex() {
+    return luaWorker_->call([&]() -> J1939PgnIndex<shared_ptr<Selector>> {
+        J1939PgnIndex<shared_ptr<Selector>> pgnIndex;
+
+        auto pgnTable = (*pLuaState_)[ecu_ident_.c_str()][J1939_PGN_TABLE];
+        for (const string& pgnKey : getLuaTableKeys(pgnTable)) {
+            if(pgnKey.find('#') == string::npos) {
+                pgnIndex.add(J1939Simulator::parsePGN(pgnKey), make_shared<Selector>(pgnTable[pgnKey]));
+            }
+        }
+
+        return pgnIndex;
+    });
+}
+
+/**
+ * Returns the 'PGNs' table compiled for the J1939 simulations of the ECU. It
+ * is compiled once and shared by the simulations on all interfaces of the
+ * ECU. `reload()` keeps it, the J1939 simulation stays on the Lua state it
+ * was started with.
+ *
+ * @return the request matcher and the PGN index of the 'PGNs' table
+ */
+shared_ptr<const EcuLuaScript::J1939Tables> EcuLuaScript::getJ1939Tables()
+{
+    lock_guard<mutex> lock(j1939TablesMutex_);
+    if (!pJ1939Tables_)
+    {
+        pJ1939Tables_ = luaWorker_->call([&]() -> shared_ptr<const J1939Tables> {
+            auto pTables = make_shared<J1939Tables>();
+            pTables->pLuaState = pLuaState_;
+            pTables->requestMatcher = LuaRequestMatcher(buildRequestByteTreeFromPGNTable());
+            pTables->pgnIndex = buildRequestPGNIndex();
+            return pTables;
+        });
+    }
+    return pJ1939Tables_;
+}
+
+
+/**
+ * Gets the data of a PGN without request payload (e.g. for cyclic messages or
+ * a PGN request). Only the Lua part of the lookup is executed by the worker.
+ *
+ * @param pgnIndex: the PGNs mapped to their Lua value, see `buildRequestPGNIndex()`
+ * @param pgn: the PGN to look for
+ * @return the payload and cycle time of the PGN, an empty payload if not found
+ */
+J1939PGNData EcuLuaScript::getJ1939RequestPGNData(const J1939PgnIndex<shared_ptr<Selector>> &pgnIndex, uint32_t pgn)
+{
+    LOG_DEBUG("Looking for requested PGN: " << pgn);
+    J1939PGNData pgnData;
+    pgnData.cycleTime = 0;
+
+    const shared_ptr<Selector> *pgnItem = pgnIndex.find(pgn);
+    if(pgnItem == nullptr) {
+        return pgnData;
+    }
+
+    LOG_DEBUG("Found PGN: " << pgn);
+    return luaWorker_->call([&]() -> J1939PGNData {
+        LuaProfiler::Scope profile(scriptFile_, LuaHandler::J1939_PGN,
+                                   LuaProfiler::isEnabled() ? to_string(pgn) : string());
+        auto val = **pgnItem;
+        if (val.isFunction())
+        {
+            pgnData.payload = val().toString();
+        }
+        else if(val.isTable())
+        {
+            auto pgnPayload = val[J1939_PGN_PAYLOAD];
+            auto pgnCycleTime = val[J1939_PGN_CYCLETIME];
+            if(pgnCycleTime.exists() == true) {
+                pgnData.cycleTime = pgnCycleTime;
+            }
+            if(pgnPayload.exists() == true) {
+                if(pgnPayload.isFunction())
+                {
+                    pgnData.payload = pgnPayload().toString();
+                }
+                else
+                {
+                    pgnData.payload = pgnPayload.toString();
+                }
+            }
+        }
+        else
+        {
+            pgnData.payload = val.toString(); // will be cast into string
+        }
+        return pgnData;
+    });
+}
+
+/**
+ * Gets the definition of a PGN without calling any Lua function. Static
+ * payloads are returned as they are, for payload functions only
+ * `isLuaFunction` (and `cachePayload`) is set.
+ *
+ * @param pgnIndex: the PGNs mapped to their Lua value, see `buildRequestPGNIndex()`
+ * @param pgn: the PGN to look for
+ * @return the definition of the PGN, an empty payload if not found
+ */
+J1939PGNData EcuLuaScript::getJ1939PGNDefinition(const J1939PgnIndex<shared_ptr<Selector>> &pgnIndex, uint32_t pgn)
+{
+    J1939PGNData pgnData;
+    pgnData.cycleTime = 0;
+
+    const shared_ptr<Selector> *pgnItem = pgnIndex.find(pgn);
+    if(pgnItem == nullptr) {
+        return pgnData;
+    }
+
+    return luaWorker_->call([&]() -> J1939PGNData {
+        auto val = **pgnItem;
+        if (val.isFunction())
+        {
+            pgnData.isLuaFunction = true;
+        }
+        else if(val.isTable())
+        {
+            auto pgnPayload = val[J1939_PGN_PAYLOAD];
+            auto pgnCycleTime = val[J1939_PGN_CYCLETIME];
+            auto pgnCachePayload = val[J1939_PGN_CACHE_PAYLOAD];
+            if(pgnCycleTime.exists() == true) {
+                pgnData.cycleTime = pgnCycleTime;
+            }
+            if(pgnCachePayload.exists() == true) {
+                pgnData.cachePayload = static_cast<bool>(pgnCachePayload);
+            }
+            if(pgnPayload.exists() == true) {
+                if(pgnPayload.isFunction())
+                {
+                    pgnData.isLuaFunction = true;
+                }
+                else
+                {
+                    pgnData.payload = pgnPayload.toString();
+                }
+            }
+        }
+        else
+        {
+            pgnData.payload = val.toString(); // will be cast into string
+        }
+        return pgnData;
+    });
+}
+
+string EcuLuaScript::getJ1939Response(const LuaRequestMatcher &requestMatcher, const uint32_t pgn, const uint8_t *payload, const uint32_t payloadLength)
+{
+    static thread_local vector<uint8_t> lookupPayload;
+    lookupPayload.resize(3 + payloadLength);
+    lookupPayload[0] = (uint8_t)(pgn >> 0);
+    lookupPayload[1] = (uint8_t)(pgn >> 8);
+    lookupPayload[2] = (uint8_t)(pgn >> 16);
+
+    for(uint32_t i = 0; i < payloadLength; i++) {
+        lookupPayload[i+3] = payload[i];
+    }
+
+    const RequestResponse *val = requestMatcher.match(lookupPayload.data(), lookupPayload.size());
+
+    if(val == nullptr) {
+        return "";
+    }
+    if(val->isLuaFunction()) {
+        return callLuaResponse(*val, payload, payloadLength, LuaHandler::J1939_RESPONSE);
+    }
+    return val->literal;
+}
+
+/**
+ * Gets the response from the given requestByteTree that matches the given payload
+ * The entries in the table are either strings or functions that will
+ * to be called, with the payload string as the default parameter.
+ *
+ * @param requestMatcher: The compiled tree-representation of the request table
+ * @param payload: Request payload to be matched with the table
+ * @param payloadLength Length of the payload
+ * @return the response to be sent as literal hex byte string, an empty string when no response should be sent
+ *          or an empty optional when no table entry matches the request
+ */
+optional<string> EcuLuaScript::getRawResponse(const LuaRequestMatcher &requestMatcher, const uint8_t *payload, const uint32_t payloadLength)
+{ 
+    const RequestResponse *val = requestMatcher.match(payload, payloadLength);
+
+    optional<string> response = {};
+    if(val != nullptr) {
+        if (val->isLuaFunction())
+        {
+            response = callLuaResponse(*val, payload, payloadLength);
+        }
+        else if (pSessionCtrl_)
+        {
+            response = val->getLiteral(pSessionCtrl_->getResetEpoch(), pSessionCtrl_->getSessionEpoch());
+        }
+        else
+        {
+            response = val->getLiteral(0, 0);
+        }
+    }
+    return response;
+}
+
+/**
+ * Caches the response of a `cached()` function, unless it is empty (e.g. on
+ * errors).
+ *
+ * @param response: the table entry of the function
+ * @param request: the request, see `ResponseCache::toKey()`
+ * @param bytes: the response of the function
  */
-void EcuLuaScript::disconnectDoip()
-{
-    if(pDoipSimServer_) pDoipSimServer_->triggerDisconnection();
-}
-
-void EcuLuaScript::sendDoipVehicleAnnouncements()
+static void cacheResponse(const RequestResponse &response, string_view request, const vector<uint8_t>& bytes)
 {
-    if(pDoipSimServer_) pDoipSimServer_->sendVehicleAnnouncements();
+    if (response.pCache && !bytes.empty())
+    {
+        response.pCache->insert(request, ResponseCache::toKey(bytes.data(), bytes.size()));
+    }
 }
 
-
 /**
- * Gets all keys from the given Lua table
+ * Calls the Lua function of a request table entry with the payload string as
+ * parameter.
  *
- * @return vector of keys or an empty vector if not table given
+ * @param response: the matched table entry, must be a Lua function
+ * @param payload: the received request
+ * @param payloadLength: length of the payload
+ * @param handler: the kind of the table, for the `LuaProfiler`
+ * @return the response as literal hex byte string
  */
-vector<string> EcuLuaScript::getLuaTableKeys(Selector luaTable)
+string EcuLuaScript::callLuaResponse(const RequestResponse &response, const uint8_t *payload, const uint32_t payloadLength,
+                                     LuaHandler handler)
 {
-    if(luaTable.exists()) {
-        return luaTable.getKeys();
-    } else {
-        return vector<string>();
+    assert(response.isLuaFunction());
+    if (response.isBinary || response.isDirect || response.pCache)
+    {
+        vector<uint8_t> bytes;
+        callLuaResponse(response, payload, payloadLength, bytes, handler);
+        return intToHexString(bytes.data(), bytes.size());
     }
+    // the caller waits for the result, so the request is not copied for the worker
+    static thread_local string hexRequest;
+    intToHexString(payload, payloadLength, hexRequest);
+    string result;
+    runLuaResponse(response, handler, hexRequest, [&result](string_view value) {
+        result.assign(value);
+    });
+    return result;
 }
 
 /**
- * @brief Remove all separator characters from given string
- * 
- * @param rawString 
- * @return string rawString with all separator characters removed
+ * Calls the Lua function of a request table entry and converts its response
+ * into bytes. Functions wrapped in `binary()` get the request as raw byte
+ * string and return raw bytes, so neither the request nor the response is
+ * converted from or to literal hex strings. Functions wrapped in `cached()`
+ * are only called if the request is not in their `ResponseCache`.
+ *
+ * @param response: the matched table entry, must be a Lua function
+ * @param payload: the received request
+ * @param payloadLength: length of the payload
+ * @param bytes: replaced by the response, keeps its capacity
+ * @param handler: the kind of the table, for the `LuaProfiler`
  */
-string EcuLuaScript::cleanupString(string rawString)
+void EcuLuaScript::callLuaResponse(const RequestResponse &response, const uint8_t *payload, const uint32_t payloadLength,
+                                   vector<uint8_t>& bytes, LuaHandler handler)
 {
-    rawString.erase(remove_if(rawString.begin(), rawString.end(),
-        [](char &x){return string("_.,; #\t").find(x) != string::npos;}
-    ), rawString.end());
-    return rawString;
+    assert(response.isLuaFunction());
+    const string_view request = ResponseCache::toKey(payload, payloadLength);
+    if (response.pCache && response.pCache->find(request, bytes))
+    {
+        return;
+    }
+    if (response.isDirect)
+    {
+        luaWorker_->call([&]() {
+            LuaProfiler::Scope profile(scriptFile_, handler, response.tableKey);
+            callDirectFunction(response.luaFunction, payload, payloadLength, bytes);
+        });
+    }
+    else if (response.isBinary)
+    {
+        runLuaResponse(response, handler, request, [&bytes](string_view result) {
+            bytes.assign(result.cbegin(), result.cend());
+        });
+    }
+    else
+    {
+        static thread_local string hexRequest;
+        intToHexString(payload, payloadLength, hexRequest);
+        runLuaResponse(response, handler, hexRequest, [&bytes](string_view result) {
+            literalHexStrToBytes(result, bytes);
+        });
+    }
+    cacheResponse(response, request, bytes);
 }
 
 /**
- * Gets J1939 PGNS from the Lua PGN-Table.
+ * Calls a response function as coroutine on the Lua worker and waits for its
+ * result. While the function sleeps, the worker proceeds other Lua calls. On
+ * the worker thread itself (a C++ function called by Lua) the function is
+ * called directly.
  *
- * @return vector of raw message data as they are configured in lua
+ * The state of the call stays on the stack of the waiting caller and the
+ * result is passed as view into the Lua string, so a call does not allocate
+ * unless the function sleeps.
+ *
+ * @param response: the table entry of the response function
+ * @param handler: the kind of the table, for the `LuaProfiler`
+ * @param argument: the request, as literal hex or binary string, must be
+ *                  valid until the function is started
+ * @param onResult: called on the worker thread with the response (empty on
+ *                  error), which is only valid during the call
  */
-vector<string> EcuLuaScript::getJ1939PGNs()
+void EcuLuaScript::runLuaResponse(const RequestResponse& response, LuaHandler handler, string_view argument,
+                                  const std::function<void(string_view)>& onResult)
 {
-    const std::lock_guard<std::mutex> lock(luaLock_);
-
-    cout << "Get PGNs from ident: " << ecu_ident_ << endl;
-    return getLuaTableKeys(lua_state_[ecu_ident_.c_str()][J1939_PGN_TABLE]);
+    if (luaWorker_->isWorkerThread())
+    {
+        LuaProfiler::Scope profile(scriptFile_, handler, response.tableKey);
+        string result;
+        {
+            DeferredSendScope deferredSend(*this);
+            result = callLuaFunction(response.luaFunction, argument);
+        }
+        onResult(result);
+        return;
+    }
+    struct Call
+    {
+        EcuLuaScript *pScript;
+        const RequestResponse& response;
+        LuaHandler handler;
+        string_view argument;
+        const std::function<void(string_view)>& onResult;
+        LuaWorker::Completion completion;
+    } call{this, response, handler, argument, onResult, {}};
+    // `call` is gone once the completion is finished, neither the coroutine nor
+    // this task may touch it afterwards (the argument is copied into Lua when
+    // the coroutine starts)
+    luaWorker_->post([pCall = &call]() {
+        try
+        {
+            LuaProfiler::Scope profile(pCall->pScript->scriptFile_, pCall->handler, pCall->response.tableKey);
+            pCall->pScript->startLuaCoroutine(pCall->response.luaFunction, pCall->argument, [pCall](string_view result) {
+                // also called by a delayed task after `sleep()`, nothing would report an exception there
+                exception_ptr error;
+                try
+                {
+                    pCall->onResult(result);
+                }
+                catch (...)
+                {
+                    error = current_exception();
+                }
+                pCall->completion.finish(error);
+            });
+        }
+        catch (...)
+        {
+            // `onFinished` is called last and does not throw, so the coroutine did not finish yet
+            pCall->completion.finish(current_exception());
+        }
+    });
+    call.completion.wait();
 }
 
 /**
- * Build a RequestByteTree from given keys with given response mapping function
+ * Calls a `direct()` function, which reads the request from and writes the
+ * response into the given buffers through the FFI, so neither is copied into
+ * a Lua string. The function runs to completion, `sleep()` blocks the worker.
+ * Must be called on the Lua worker.
+ *
+ * @param function: the wrapped function of the entry
+ * @param payload: the received request
+ * @param payloadLength: length of the payload
+ * @param bytes: replaced by the response, keeps its capacity
  */
-shared_ptr<RequestByteTreeNode<shared_ptr<Selector>>> EcuLuaScript::buildRequestByteTree(
-    vector<string> requestKeys, std::function<shared_ptr<Selector>(string &key)> mappingFunction) {
-
-    shared_ptr<RequestByteTreeNode<shared_ptr<Selector>>> requestByteTree(new RequestByteTreeNode<shared_ptr<Selector>>());
-    for(string requestStringRaw : requestKeys)
+void EcuLuaScript::callDirectFunction(const LuaFunctionRef& function, const uint8_t *payload, size_t payloadLength,
+                                      vector<uint8_t>& bytes)
+{
+    bytes.clear();
+    DirectCall call = {payload, payloadLength, &bytes};
+    DirectCall *pOuterCall = pDirectCall;
+    pDirectCall = &call;
+    lua_State *l = function.l;
     {
-        string requestString = cleanupString(requestStringRaw);
-        
-        try {
-            shared_ptr<Selector> response = mappingFunction(requestStringRaw);
-
-            auto requestByteLeaf = addRequestToTree(requestByteTree, requestString);
-            requestByteLeaf->setLuaResponse(response);
-        } catch(exception &e) {
-            cerr << "Ignoring invalid request '" << requestStringRaw << "': " << e.what();
+        ResetStackOnScopeExit savedStack(l);
+        DeferredSendScope deferredSend(*this);
+        lua_rawgeti(l, LUA_REGISTRYINDEX, function.ref);
+        lua_pushinteger(l, lua_Integer(payloadLength));
+        if (lua_pcall(l, 1, 0, 0) != LUA_OK)
+        {
+            const char *msg = lua_tostring(l, -1);
+            LOG_ERROR("Error in the response function: " << (msg ? msg : "unknown"));
+            bytes.clear();
         }
     }
-		
-	return requestByteTree;
-}
-/**
- * Build a RequestByteTree from the 'Raw' table in the current simulation
- */
-shared_ptr<RequestByteTreeNode<shared_ptr<Selector>>> EcuLuaScript::buildRequestByteTreeFromRawTable() {
-    const std::lock_guard<std::mutex> lock(luaLock_);
-
-    cout << "Get 'Raw' request tree from ident: " << ecu_ident_ << endl;
-    auto rawTable = lua_state_[ecu_ident_.c_str()][RAW_TABLE];
-    vector<string> requestKeys = getLuaTableKeys(rawTable);
-
-    return buildRequestByteTree(requestKeys, [&rawTable](string &x){ return shared_ptr<Selector>(new Selector(rawTable[x]));});
+    pDirectCall = pOuterCall;
 }
 
-
 /**
- * Build a RequestByteTree from the 'PGN' table in the current simulation
+ * Starts a response function as coroutine. The finished coroutines of a Lua
+ * state are pooled in its registry and reused, so a call usually does not
+ * allocate a new Lua thread. Must be called on the Lua worker.
+ *
+ * @param function: the response function
+ * @param argument: the request, as literal hex or binary string, copied into Lua
+ * @param onFinished: called on the worker thread with the response (empty on
+ *                    error) when the function returns, the response is only
+ *                    valid during the call
  */
-shared_ptr<RequestByteTreeNode<shared_ptr<Selector>>> EcuLuaScript::buildRequestByteTreeFromPGNTable() {
-    const std::lock_guard<std::mutex> lock(luaLock_);
-
-    cout << "Get 'PGN' request tree from ident: " << ecu_ident_ << endl;
-    auto pgnTable = lua_state_[ecu_ident_.c_str()][J1939_PGN_TABLE];
-    vector<string> requestKeys = getLuaTableKeys(pgnTable);
-
-    requestKeys.erase(remove_if(requestKeys.begin(), requestKeys.end(),
-        [](string &x){return x.find('#') == string::npos;}
-    ), requestKeys.end());
-
-    return buildRequestByteTree(requestKeys, [&pgnTable](string &x){ return shared_ptr<Selector>(new Selector(pgnTable[x]));});
+void EcuLuaScript::startLuaCoroutine(const LuaFunctionRef& function, string_view argument,
+                                     std::function<void(string_view)> onFinished)
+{
+    lua_State *l = function.l;
+    lua_State *co;
+    int threadRef;
+    {
+        ResetStackOnScopeExit savedStack(l);
+        lua_rawgetp(l, LUA_REGISTRYINDEX, &COROUTINE_POOL_KEY);
+        if (!lua_istable(l, -1))
+        {
+            lua_pop(l, 1);
+            lua_newtable(l);
+            lua_pushvalue(l, -1);
+            lua_rawsetp(l, LUA_REGISTRYINDEX, &COROUTINE_POOL_KEY);
+        }
+        const int pooled = int(lua_rawlen(l, -1));
+        if (pooled > 0)
+        {
+            lua_rawgeti(l, -1, pooled);
+            lua_pushnil(l);
+            lua_rawseti(l, -3, pooled);
+        }
+        else
+        {
+            lua_newthread(l);
+        }
+        co = lua_tothread(l, -1);
+        threadRef = luaL_ref(l, LUA_REGISTRYINDEX);
+    }
+    lua_rawgeti(co, LUA_REGISTRYINDEX, function.ref);
+    lua_pushlstring(co, argument.data(), argument.size());
+    resumeLuaCoroutine(l, co, threadRef, 1, move(onFinished));
 }
 
 /**
- * Fetch list of PGNs that do not contain the '#' character and map them to their Lua response
+ * Resumes a coroutine of `startLuaCoroutine()` until it yields or returns. A
+ * coroutine suspended by `sleep()` is resumed by a delayed task of the worker.
+ *
+ * @param l: the main thread of the Lua state
+ * @param co: the coroutine, referenced by `threadRef` in the registry
+ * @param threadRef: released when the coroutine is finished
+ * @param argumentCount: the number of arguments on the stack of `co`
+ * @param onFinished: see `startLuaCoroutine()`
  */
-map<string,shared_ptr<Selector>> EcuLuaScript::buildRequestPGNMap() {
-    const std::lock_guard<std::mutex> lock(luaLock_);
-
-    map<string,shared_ptr<Selector>> pgnMap = map<string,shared_ptr<Selector>>();
-
-    auto pgnTable = lua_state_[ecu_ident_.c_str()][J1939_PGN_TABLE];
-    vector<string> pgnKeys = getLuaTableKeys(pgnTable);
+void EcuLuaScript::resumeLuaCoroutine(lua_State *l, lua_State *co, int threadRef, int argumentCount,
+                                      std::function<void(string_view)> onFinished)
+{
+    lua_State *pOuterCoroutine = runningCoroutine;
+    runningCoroutine = co;
+    int status;
+    {
+        // the messages of `sendRaw()` are sent before the function sleeps or its response is sent
+        DeferredSendScope deferredSend(*this);
+        status = lua_resume(co, l, argumentCount);
+    }
+    runningCoroutine = pOuterCoroutine;
 
-    pgnKeys.erase(remove_if(pgnKeys.begin(), pgnKeys.end(),
-        [](string &x){return x.find('#') != string::npos;}
-    ), pgnKeys.end());
+    if (status == LUA_YIELD)
+    {
+        // sleep() yields the time, a plain coroutine.yield() lets the other tasks run once
+        const lua_Integer ms = lua_isnumber(co, -1) ? max<lua_Integer>(0, lua_tointeger(co, -1)) : 0;
+        lua_settop(co, 0);
+        luaWorker_->postDelayed(chrono::milliseconds(ms),
+            [this, l, co, threadRef, onFinished = move(onFinished),
+             pProfile = LuaProfiler::getCurrentHandler()]() mutable {
+                LuaProfiler::Scope profile(pProfile);
+                resumeLuaCoroutine(l, co, threadRef, 0, move(onFinished));
+            });
+        return;
+    }
 
-    for( string pgnKey : pgnKeys) {
-        if(pgnKey.find('#') == string::npos) {
-            string pgnNormalized = cleanupString(pgnKey);
-            pgnMap.insert(pair<string,shared_ptr<Selector>>(pgnNormalized, shared_ptr<Selector>(new Selector(pgnTable[pgnKey]))));
+    // the response is moved to the main thread, so it stays referenced after the coroutine is released
+    ResetStackOnScopeExit savedStack(l);
+    if (status == LUA_OK && lua_gettop(co) > 0)
+    {
+        lua_settop(co, 1);
+        lua_xmove(co, l, 1);
+    }
+    else
+    {
+        lua_pushnil(l);
+    }
+    const int responseIndex = lua_gettop(l);
+    if (status == LUA_OK)
+    {
+        // a returned coroutine can run the next function
+        lua_rawgetp(l, LUA_REGISTRYINDEX, &COROUTINE_POOL_KEY);
+        const int pooled = int(lua_rawlen(l, -1));
+        if (size_t(pooled) < MAX_POOLED_COROUTINES)
+        {
+            lua_rawgeti(l, LUA_REGISTRYINDEX, threadRef);
+            lua_rawseti(l, -2, pooled + 1);
         }
+        lua_pop(l, 1);
     }
-
-    return pgnMap;
+    else
+    {
+        const char *msg = lua_tostring(co, -1);
+        LOG_ERROR("Error in the response function: " << (msg ? msg : "unknown"));
+    }
+    lua_settop(co, 0);
+    luaL_unref(l, LUA_REGISTRYINDEX, threadRef);
+    onFinished(toStringView(l, responseIndex));
 }
 
-
-J1939PGNData EcuLuaScript::getJ1939RequestPGNData(const map<string,shared_ptr<Selector>> pgnMap, const std::string& pgn)
+/**
+ * Queues the call of the Lua function of a request table entry to the Lua
+ * worker and returns immediately, like `callLuaResponse()` otherwise. The call
+ * is queued with `LuaWorker::Priority::LOW`, so it does not delay the other
+ * accesses to the Lua state.
+ *
+ * @param pRequestMatcher: the matcher of the entry, kept until the call is done
+ * @param response: the matched table entry, must be a Lua function
+ * @param payload: the received request, copied
+ * @param payloadLength: length of the payload
+ * @param bytes: replaced by the response on the worker thread, must be valid until `onFinished` is called
+ * @param onFinished: called on the worker thread after the response is written to `bytes`
+ * @param onStarted: optional, called on the worker thread before the function is called
+ */
+void EcuLuaScript::postLuaResponse(shared_ptr<const LuaRequestMatcher> pRequestMatcher, const RequestResponse &response,
+                                   const uint8_t *payload, const uint32_t payloadLength, vector<uint8_t>& bytes,
+                                   std::function<void()> onFinished, std::function<void()> onStarted)
 {
-    cout << "Looking for requested PGN: " << pgn << endl;
-    J1939PGNData pgnData;
-    pgnData.cycleTime = 0;
-
-    auto pgnItem = pgnMap.find(cleanupString(pgn));
-    if(pgnItem != pgnMap.end()) {
-        auto val = *(pgnItem->second);
-        cout << "Found PGN: " << pgn << endl;
-        if (val.isFunction())
+    assert(response.isLuaFunction());
+    if (response.isDirect)
+    {
+        vector<uint8_t> request(payload, payload + payloadLength);
+        luaWorker_->post([this, pRequestMatcher = move(pRequestMatcher), &response, request = move(request), &bytes,
+                          onFinished = move(onFinished), onStarted = move(onStarted)]() {
+            if (onStarted)
+            {
+                onStarted();
+            }
+            {
+                LuaProfiler::Scope profile(scriptFile_, LuaHandler::RAW, response.tableKey);
+                callDirectFunction(response.luaFunction, request.data(), request.size(), bytes);
+            }
+            cacheResponse(response, ResponseCache::toKey(request.data(), request.size()), bytes);
+            onFinished();
+        }, LuaWorker::Priority::LOW);
+        return;
+    }
+    // copied, since the caller does not wait
+    string request = response.isBinary ? string(reinterpret_cast<const char*> (payload), payloadLength)
+                                       : intToHexString(payload, payloadLength);
+    string cacheKey = response.pCache ? string(ResponseCache::toKey(payload, payloadLength)) : string();
+    luaWorker_->post([this, pRequestMatcher = move(pRequestMatcher), &response, request = move(request),
+                      cacheKey = move(cacheKey), &bytes, onFinished = move(onFinished), onStarted = move(onStarted)]() {
+        if (onStarted)
         {
-            pgnData.payload = val().toString();
+            onStarted();
         }
-        else if(val.isTable())
-        {
-            auto pgnPayload = val[J1939_PGN_PAYLOAD];
-            auto pgnCycleTime = val[J1939_PGN_CYCLETIME];
-            if(pgnCycleTime.exists() == true) {
-                pgnData.cycleTime = pgnCycleTime;
-            }
-            if(pgnPayload.exists() == true) {
-                if(pgnPayload.isFunction())
+        LuaProfiler::Scope profile(scriptFile_, LuaHandler::RAW, response.tableKey);
+        // the matcher keeps the Lua state of the function alive while it sleeps, e.g. on `reload()`
+        startLuaCoroutine(response.luaFunction, request,
+            [pRequestMatcher, &response, cacheKey, &bytes, onFinished](string_view result) {
+                if (response.isBinary)
                 {
-                    pgnData.payload = pgnPayload().toString();
+                    bytes.assign(result.cbegin(), result.cend());
                 }
                 else
                 {
-                    pgnData.payload = pgnPayload.toString();
+                    literalHexStrToBytes(result, bytes);
                 }
-            }
-        }
-        else
-        {
-            pgnData.payload = val.toString(); // will be cast into string
-        }
-    }
-    return pgnData;
-
+                cacheResponse(response, cacheKey, bytes);
+                onFinished();
+            });
+    }, LuaWorker::Priority::LOW);
 }
 
-string EcuLuaScript::getJ1939Response(const shared_ptr<RequestByteTreeNode<shared_ptr<Selector>>> requestByteTree, const uint32_t pgn, const uint8_t *payload, const uint32_t payloadLength)
+
+/**
+ * Captures the globals of the current Lua state for `resetState()`, with the
+ * Lua worker or before it runs.
+ */
+void EcuLuaScript::captureLuaState()
 {
-    const std::lock_guard<std::mutex> lock(luaLock_);
-    string response;
+    lua_State *l = pLuaState_->GetLuaState();
+    ResetStackOnScopeExit savedStack(l);
+    if (luaL_loadstring(l, STATE_SNAPSHOT_CHUNK) != LUA_OK || lua_pcall(l, 0, 1, 0) != LUA_OK)
+    {
+        LOG_ERROR("Can not capture the Lua state of " << ecu_ident_ << ": " << popLuaString(l));
+        return;
+    }
+    restoreStateRef_.emplace(l, luaL_ref(l, LUA_REGISTRYINDEX));
+}
 
-    vector<uint8_t> lookupPayload(3 + payloadLength);
-    lookupPayload[0] = (uint8_t)(pgn >> 0);
-    lookupPayload[1] = (uint8_t)(pgn >> 8);
-    lookupPayload[2] = (uint8_t)(pgn >> 16);
+/**
+ * Creates registry references to the ECU table and its `ReadDataByIdentifier`
+ * tables, so the lookups at runtime don't need to traverse the path from the
+ * global table again. Must be called from the constructor or the Lua worker.
+ */
+void EcuLuaScript::createTableRefs()
+{
+    lua_State *l = pLuaState_->GetLuaState();
+    ResetStackOnScopeExit savedStack(l);
 
-    for(uint32_t i = 0; i < payloadLength; i++) {
-        lookupPayload[i+3] = payload[i];
+    lua_getglobal(l, ecu_ident_.c_str());
+    if (!lua_istable(l, -1))
+    {
+        return;
     }
+    const int ecuTable = lua_gettop(l);
+    lua_pushvalue(l, ecuTable);
+    ecuTableRef_.emplace(l, luaL_ref(l, LUA_REGISTRYINDEX));
 
-    auto val = getValueFromTree(requestByteTree, lookupPayload);
-
-    if(val.has_value() == true) {
-        shared_ptr<Selector> luaResp = *val;
-        if (luaResp->isFunction())
+    auto addDataIdentifierTable = [this, l](const string& session) {
+        if (lua_istable(l, -1))
         {
-            response = (*luaResp)(intToHexString(payload, payloadLength)).toString();
+            lua_getfield(l, -1, READ_DATA_BY_IDENTIFIER_TABLE);
+            if (lua_istable(l, -1))
+            {
+                dataIdentifierTableRefs_.emplace(session, LuaRef(l, luaL_ref(l, LUA_REGISTRYINDEX)));
+            }
+            else
+            {
+                lua_pop(l, 1);
+            }
         }
-        else
-        {
-            response = luaResp->toString();
-        } 
-    }
+        lua_pop(l, 1);
+    };
 
-    return response;
+    lua_pushvalue(l, ecuTable);
+    addDataIdentifierTable("");
+    for (const char *session : {PROGRAMMING_SESSION_TABLE, EXTENDED_SESSION_TABLE})
+    {
+        lua_getfield(l, ecuTable, session);
+        addDataIdentifierTable(session);
+    }
 }
 
 /**
- * Gets the response from the given requestByteTree that matches the given payload
- * The entries in the table are either strings or functions that will
- * to be called, with the payload string as the default parameter.
+ * Looks up a `ReadDataByIdentifier` entry with a single `lua_rawget` on the
+ * cached table. Functions are called with the identifier as parameter. Must
+ * be called from the Lua worker.
  *
- * @param requestByteTree: The prepared tree-representation of the request table
- * @param payload: Request payload to be matched with the table
- * @param payloadLength Length of the payload
- * @return the response to be sent as literal hex byte string, an empty string when no response should be sent
- *          or an empty optional when no table entry matches the request
+ * @param session: the session name ("" for the default session)
+ * @param identifier: the identifier to access the field in the Lua table
+ * @return the identifier field on success, otherwise an empty string
  */
-optional<string> EcuLuaScript::getRawResponse(const shared_ptr<RequestByteTreeNode<shared_ptr<Selector>>> requestByteTree, const uint8_t *payload, const uint32_t payloadLength)
-{ 
-    const std::lock_guard<std::mutex> scopelock(luaLock_);
+string EcuLuaScript::callDataIdentifier(const string& session, const string& identifier)
+{
+    string value;
+    callDataIdentifier(session, identifier, value);
+    return value;
+}
 
-    vector<uint8_t> lookupPayload(payload, payload + payloadLength);
+/**
+ * Looks up a `ReadDataByIdentifier` entry like the variant above and copies
+ * the result from the Lua string into the given string, which keeps its
+ * capacity. Must be called from the Lua worker.
+ *
+ * @param session: the session name ("" for the default session)
+ * @param identifier: the identifier to access the field in the Lua table
+ * @param value: replaced by the identifier field, empty on errors
+ */
+void EcuLuaScript::callDataIdentifier(const string& session, const string& identifier, string& value)
+{
+    value.clear();
+    auto tableRef = dataIdentifierTableRefs_.find(session);
+    if (tableRef == dataIdentifierTableRefs_.end())
+    {
+        return;
+    }
 
-    auto val = getValueFromTree(requestByteTree, lookupPayload);
+    lua_State *l = pLuaState_->GetLuaState();
+    ResetStackOnScopeExit savedStack(l);
+    tableRef->second.Push(l);
+    lua_pushlstring(l, identifier.data(), identifier.size());
+    lua_rawget(l, -2);
+    if (lua_istable(l, -1))
+    {
+        // a function wrapped in `cached()`
+        lua_getfield(l, -1, CACHED_FUNCTION_FIELD);
+    }
 
-    optional<string> response = {};
-    if(val.has_value() == true) {
-        shared_ptr<Selector> luaResp = *val;
-        if (luaResp->isFunction())
+    if (lua_isfunction(l, -1))
+    {
+        LuaProfiler::Scope profile(scriptFile_, LuaHandler::DATA_IDENTIFIER, identifier);
+        lua_pushlstring(l, identifier.data(), identifier.size());
+        if (lua_pcall(l, 1, 1, 0) != LUA_OK)
         {
-            response = (*luaResp)(intToHexString(payload, payloadLength)).toString();
+            const char *msg = lua_tostring(l, -1);
+            LOG_ERROR("Error in ReadDataByIdentifier function " << identifier << ": " << (msg ? msg : "unknown"));
+            return;
         }
-        else
-        {
-            response = luaResp->toString();
-        } 
     }
-    return response;
+    value.assign(toStringView(l, -1));
+}
+
+/**
+ * Converts the value on top of the Lua stack into a string and pops it.
+ *
+ * @return the string value or an empty string for `nil` and other values that
+ *         have no string representation
+ */
+string EcuLuaScript::popLuaString(lua_State *l)
+{
+    string result(toStringView(l, -1));
+    lua_pop(l, 1);
+    return result;
 }
 
+/**
+ * Views the string representation of a value on the Lua stack without
+ * copying it. Numbers are converted in place.
+ *
+ * @return the view into the Lua string, valid while the value stays on the
+ *         stack, or an empty view for `nil` and other values that have no
+ *         string representation
+ */
+string_view EcuLuaScript::toStringView(lua_State *l, int index)
+{
+    size_t len = 0;
+    const char *str = lua_tolstring(l, index, &len);
+    return (str != nullptr) ? string_view(str, len) : string_view();
+}
 
 /**
  * Sets the SessionController required for session handling.
@@ -717,32 +4285,53 @@ void EcuLuaScript::registerSessionController(SessionController* pSesCtrl) noexce
     pSessionCtrl_ = pSesCtrl;
 }
 
-void EcuLuaScript::registerIsoTpSender(IsoTpSender* pSender) noexcept
+/**
+ * Sets the transport `sendRaw()` sends its messages with.
+ *
+ * @param pTransport: the ISO-TP sender or the loopback of the ECU
+ */
+void EcuLuaScript::registerTransport(UdsTransport* pTransport) noexcept
 {
-    pIsoTpSender_ = pSender;
+    pTransport_ = pTransport;
 }
 
+/**
+ * Adds a DoIP entity the ECU belongs to. All entities have to be registered
+ * before the ECU is added to the first one, since the Lua functions might be
+ * called from then on.
+ *
+ * @param pDoipSimServer: the DoIP entity
+ */
 void EcuLuaScript::registerDoipSimServer(DoIPSimServer *pDoipSimServer) noexcept
 {
-    pDoipSimServer_ = pDoipSimServer;
+    doipSimServers_.push_back(pDoipSimServer);
 }
 
-string EcuLuaScript::intToHexString(const uint8_t* buffer, const size_t num_bytes)
+void EcuLuaScript::registerJ1939Simulator(J1939Simulator *pJ1939Simulator) noexcept
 {
-    string a = "";
+    pJ1939Simulator_ = pJ1939Simulator;
+}
 
-    for (uint32_t i = 0; i < num_bytes; i++)
-    {
-        a.push_back(HEX_LUT[buffer[i] / 16]);
-        a.push_back(HEX_LUT[buffer[i] % 16]);
-        if (!(i == num_bytes - 1))
-        {
-            a.push_back(' ');
-        }
-    }
+string EcuLuaScript::intToHexString(const uint8_t* buffer, const size_t num_bytes)
+{
+    string a;
+    intToHexString(buffer, num_bytes, a);
     return a;
 }
 
+/**
+ * Converts bytes into a literal hex string (e.g. "62 F1 90") in the given
+ * string, which keeps its capacity.
+ *
+ * @param buffer: the bytes
+ * @param num_bytes: the number of bytes in `buffer`
+ * @param hex: replaced by the literal hex string
+ */
+void EcuLuaScript::intToHexString(const uint8_t* buffer, size_t num_bytes, string& hex)
+{
+    hex_codec::encode(buffer, num_bytes, hex);
+}
+
 /**
  * Tries to get the Value by using the request tree, including wildcard and placeholder keys
  * See {@link RequestByteTreeNode} to see how the tree works
@@ -750,24 +4339,25 @@ string EcuLuaScript::intToHexString(const uint8_t* buffer, const size_t num_byte
  */
 template<class T>
 optional<T> EcuLuaScript::getValueFromTree(const shared_ptr<RequestByteTreeNode<T>> requestByteTree, const vector<uint8_t> payload) {
-    set<shared_ptr<RequestByteTreeNode<T>>> potentiallyMatchingRequests;
-    potentiallyMatchingRequests.insert(requestByteTree);
+    // every node except the wildcards is only reachable at one request position, so there are no duplicates
+    static thread_local vector<RequestByteTreeNode<T>*> potentiallyMatchingRequests;
+    static thread_local vector<RequestByteTreeNode<T>*> matchingNodes;
+    potentiallyMatchingRequests.clear();
+    potentiallyMatchingRequests.push_back(requestByteTree.get());
     
     for(auto nextByte : payload) {
         if(potentiallyMatchingRequests.empty()) {
             break;
         }
-        set<shared_ptr<RequestByteTreeNode<T>>> matchingNodes;
-        for (typename set<shared_ptr<RequestByteTreeNode<T>>>::iterator reqIter = potentiallyMatchingRequests.begin();
-                reqIter != potentiallyMatchingRequests.end(); reqIter++) {
-            auto crntRequestByte = *reqIter;
+        matchingNodes.clear();
+        for(auto crntRequestByte : potentiallyMatchingRequests) {
             if(crntRequestByte->isWildcard()) {
-                matchingNodes.insert(crntRequestByte);
+                matchingNodes.push_back(crntRequestByte);
                 continue;
             }
             findAndAddMatchesForNextByte(matchingNodes, crntRequestByte, nextByte);				
         }
-        potentiallyMatchingRequests = matchingNodes;
+        potentiallyMatchingRequests.swap(matchingNodes);
     }
     
     auto bestMatchingRequest = findBestMatchingRequest(potentiallyMatchingRequests);
@@ -778,51 +4368,43 @@ optional<T> EcuLuaScript::getValueFromTree(const shared_ptr<RequestByteTreeNode<
 }
 
 template<class T>
-void EcuLuaScript::findAndAddMatchesForNextByte(set<shared_ptr<RequestByteTreeNode<T>>> &matchingNodes, shared_ptr<RequestByteTreeNode<T>> currentByte, uint8_t nextByte) {
-    shared_ptr<RequestByteTreeNode<T>> crntByteTreeOpt;
+void EcuLuaScript::findAndAddMatchesForNextByte(vector<RequestByteTreeNode<T>*> &matchingNodes, RequestByteTreeNode<T> *currentByte, uint8_t nextByte) {
+    RequestByteTreeNode<T> *crntByteTreeOpt;
     crntByteTreeOpt = currentByte->getSubsequentByte(nextByte);
     if(crntByteTreeOpt) {
-        matchingNodes.insert(crntByteTreeOpt);
+        matchingNodes.push_back(crntByteTreeOpt);
+    }
+    for(const auto &subsequentPattern : currentByte->getSubsequentPatterns()) {
+        if(subsequentPattern.first.matches(nextByte)) {
+            matchingNodes.push_back(subsequentPattern.second);
+        }
     }
     crntByteTreeOpt = currentByte->getSubsequentPlaceholder();
     if(crntByteTreeOpt) {
-        matchingNodes.insert(crntByteTreeOpt);
+        matchingNodes.push_back(crntByteTreeOpt);
     }
     crntByteTreeOpt = currentByte->getSubsequentWildcard();
     if(crntByteTreeOpt) {
-        matchingNodes.insert(crntByteTreeOpt);
+        matchingNodes.push_back(crntByteTreeOpt);
     }
 }
 
 /**
- * From the list of potentially matching requests find the one that matches best
- * according these rules in the specified order:
- * * Prefer requests without wildcard (*)
- * * Prefer requests with fewer placeholders (XX)
- * * If there are only requests with wildcard, prefer longer ones (no matter how many placeholders)
- *   (All requests without wildcard have per definition the same length as the received request)
- * * If there are still multiple requests, it is undefined which one is chosen
+ * From the list of potentially matching requests find the one with the
+ * highest priority, see `RequestByteTreeNode::getPriority()`. As the
+ * priorities are unique, the result does not depend on the order of the list.
  * @param potentiallyMatchingRequests
- * @return
+ * @return the best matching request or `nullptr` if none has a response
  */
 template<class T>
-shared_ptr<RequestByteTreeNode<T>> EcuLuaScript::findBestMatchingRequest(set<shared_ptr<RequestByteTreeNode<T>>> &potentiallyMatchingRequests) {
-    shared_ptr<RequestByteTreeNode<T>> bestMatchingRequest;
+RequestByteTreeNode<T> *EcuLuaScript::findBestMatchingRequest(const vector<RequestByteTreeNode<T>*> &potentiallyMatchingRequests) {
+    RequestByteTreeNode<T> *bestMatchingRequest = nullptr;
+    uint64_t bestPriority = 0;
     for (auto matchingRequestItem : potentiallyMatchingRequests) {
         auto matchingRequest = getThisOrNextWildcardWithResponse(matchingRequestItem);
-        if(!matchingRequest->getLuaResponse()) {
-            continue;
-        }
-        if(!bestMatchingRequest) {
+        if(matchingRequest->getPriority() > bestPriority) {
+            bestPriority = matchingRequest->getPriority();
             bestMatchingRequest = matchingRequest;
-        } else {				
-            if(bestMatchingRequest->isWildcard() && !matchingRequest->isWildcard()) {
-                bestMatchingRequest = matchingRequest;
-            } else if(matchingRequest->isWildcard() && matchingRequest->getRequestLength() > bestMatchingRequest->getRequestLength()) {
-                bestMatchingRequest = matchingRequest;
-            } else if(matchingRequest->getPlaceholderCount() < bestMatchingRequest->getPlaceholderCount()) {
-                bestMatchingRequest = matchingRequest;
-            }
         }
     }
     return bestMatchingRequest;
@@ -835,7 +4417,7 @@ shared_ptr<RequestByteTreeNode<T>> EcuLuaScript::findBestMatchingRequest(set<sha
  * @return
  */
 template<class T>
-shared_ptr<RequestByteTreeNode<T>> EcuLuaScript::getThisOrNextWildcardWithResponse(shared_ptr<RequestByteTreeNode<T>> requestByteNode) {
+RequestByteTreeNode<T> *EcuLuaScript::getThisOrNextWildcardWithResponse(RequestByteTreeNode<T> *requestByteNode) {
     if(!requestByteNode->getLuaResponse()) {
         return (requestByteNode->getSubsequentWildcard() ? requestByteNode->getSubsequentWildcard() : requestByteNode);
     }
@@ -843,38 +4425,117 @@ shared_ptr<RequestByteTreeNode<T>> EcuLuaScript::getThisOrNextWildcardWithRespon
 }
 
 /**
- * Add the given request to the given request byte tree and return the leaf node
+ * @return the value of a hex digit or -1 if the character is none
+ */
+static int hexDigitValue(char c)
+{
+    if (!isxdigit(static_cast<unsigned char> (c)))
+    {
+        return -1;
+    }
+    return isdigit(static_cast<unsigned char> (c)) ? c - '0' : (tolower(static_cast<unsigned char> (c)) - 'a' + 10);
+}
+
+/**
+ * Parses a byte pattern of a request key, i.e. a nibble pattern like "3X" or
+ * "X3", or the inner part of a range like "[F1-F3]", i.e. "F1-F3".
+ *
+ * @param token: the pattern
+ * @param pattern: set to the parsed pattern
+ * @return false if the token is no byte pattern
+ */
+static bool parseRequestBytePattern(const string &token, RequestBytePattern &pattern)
+{
+    if (token.length() == 2)
+    {
+        const bool isHighPlaceholder = toupper(static_cast<unsigned char> (token[0])) == REQUEST_PLACEHOLDER[0];
+        const bool isLowPlaceholder = toupper(static_cast<unsigned char> (token[1])) == REQUEST_PLACEHOLDER[1];
+        if (isHighPlaceholder == isLowPlaceholder)
+        {
+            return false;
+        }
+        const int digit = hexDigitValue(isHighPlaceholder ? token[1] : token[0]);
+        if (digit < 0)
+        {
+            return false;
+        }
+        pattern = RequestBytePattern();
+        pattern.mask = isHighPlaceholder ? 0x0F : 0xF0;
+        pattern.value = uint8_t(isHighPlaceholder ? digit : digit << 4);
+        return true;
+    }
+    if (token.length() == 5 && token[2] == '-')
+    {
+        int digits[4];
+        const char range[4] = {token[0], token[1], token[3], token[4]};
+        for (size_t i = 0; i < 4; i++)
+        {
+            digits[i] = hexDigitValue(range[i]);
+            if (digits[i] < 0)
+            {
+                return false;
+            }
+        }
+        pattern = RequestBytePattern();
+        pattern.low = uint8_t(digits[0] << 4 | digits[1]);
+        pattern.high = uint8_t(digits[2] << 4 | digits[3]);
+        return pattern.low <= pattern.high;
+    }
+    return false;
+}
+
+/**
+ * Add the given request to the given request byte tree and return the leaf node.
+ * Besides hex bytes, a request consists of placeholders "XX", byte patterns
+ * like "3X", "X3" or "[F1-F3]" and a final wildcard "*".
  * @param requestByteTree The root of the tree this request should be added to
- * @param requestStringRaw
  * @param requestString The normalized (i.e. without spaces and other separators) string representation of the request 
  * @return tree node that represents the leaf ready for the response to be added
  */
 template<class T>
-shared_ptr<RequestByteTreeNode<T>> EcuLuaScript::addRequestToTree(shared_ptr<RequestByteTreeNode<T>> requestByteTree, string &requestString) {
+RequestByteTreeNode<T> *EcuLuaScript::addRequestToTree(RequestByteTreeNode<T> *requestByteTree, string &requestString) {
     auto currentRequestByteTreePosition = requestByteTree;
-    for(uint32_t i = 0; i + 1 < requestString.length(); i+=2) {
+    uint32_t i = 0;
+    while(i + 1 < requestString.length()) {
+        RequestBytePattern pattern;
+        if(requestString[i] == '[') {
+            const size_t rangeEnd = requestString.find(']', i);
+            if(rangeEnd == string::npos || !parseRequestBytePattern(requestString.substr(i + 1, rangeEnd - i - 1), pattern)) {
+                LOG_ERROR(requestString.substr(i) << " is not a byte range like [F1-F3].");
+                throw exception();
+            }
+            currentRequestByteTreePosition = currentRequestByteTreePosition->appendPattern(pattern);
+            i = uint32_t(rangeEnd + 1);
+            continue;
+        }
         string requestByteString = requestString.substr(i,2);
+        i += 2;
         if(strncasecmp(requestByteString.c_str(), REQUEST_PLACEHOLDER.c_str(), REQUEST_PLACEHOLDER.length()) == 0) {
             currentRequestByteTreePosition = currentRequestByteTreePosition->appendPlaceholder();
+        } else if(parseRequestBytePattern(requestByteString, pattern)) {
+            currentRequestByteTreePosition = currentRequestByteTreePosition->appendPattern(pattern);
         } else {
             try {
                 uint8_t requestByte = literalHexStrToBytes(requestByteString).at(0);
                 currentRequestByteTreePosition = currentRequestByteTreePosition->appendByte(requestByte);
             } catch(out_of_range &e) {
-                cerr << requestByteString << " is not a hex number." << endl;
+                LOG_ERROR(requestByteString << " is not a hex number.");
                 throw exception();
             }
         }
     }
     
-    if(requestString.length() % 2 != 0) {
-        if(requestString.compare(requestString.length() - REQUEST_WILDCARD.length(), REQUEST_WILDCARD.length(), REQUEST_WILDCARD) == 0) {
+    if(i < requestString.length()) {
+        if(requestString.compare(i, REQUEST_WILDCARD.length(), REQUEST_WILDCARD) == 0) {
             currentRequestByteTreePosition = currentRequestByteTreePosition->appendWildcard();
         } else {
-            cerr << requestString << " has odd number of digits." << endl;
+            LOG_ERROR(requestString << " has odd number of digits.");
             throw exception();
         }
     }
     return currentRequestByteTreePosition;
 }
 
+// compared with `LuaRequestMatcher` in the benchmarks
+template optional<RequestResponse> EcuLuaScript::getValueFromTree<RequestResponse>(
+    const shared_ptr<RequestByteTreeNode<RequestResponse>> requestByteTree, const vector<uint8_t> payload);
@@ -6,30 +6,158 @@
 #ifndef ECU_LUA_SCRIPT_H
 #define ECU_LUA_SCRIPT_H
 
-#include "selene.h"
-#include "isotp_sender.h"
+#include "lua_compat.h"
+#include "uds_transport.h"
+#include "isotp_configuration.h"
 #include "doip_sim_server.h"
 #include "session_controller.h"
 #include "request_byte_tree_node.h"
+#include "lua_worker.h"
+#include "lua_profiler.h"
+#include "lua_memory_pool.h"
+#include "data_identifier_index.h"
+#include "response_cache.h"
+#include "response_delay.h"
+#include "compiled_request_matcher.h"
+#include "request_hit_counters.h"
+#include "download_service.h"
+#include "crc_stream.h"
+#include "dtc_store.h"
+#include "did_store.h"
+#include "communication_gate.h"
+#include "response_pending.h"
+#include "security_access.h"
+#include "periodic_data_service.h"
+#include "memory_service.h"
+#include "obd_service.h"
+#include "vehicle_signals.h"
+#include "j1939_pgn_index.h"
+#include "can_frame_bus.h"
+#include <array>
+#include <atomic>
 #include <string>
+#include <string_view>
 #include <cstdint>
 #include <vector>
+#include <memory>
+#include <map>
 #include <mutex>
 #include <set>
 #include <optional>
 #include <functional>
+#include <unordered_map>
 
 constexpr char REQ_ID_FIELD[] = "RequestId";
 constexpr char RES_ID_FIELD[] = "ResponseId";
 constexpr char BROADCAST_ID_FIELD[] = "BroadcastId";
+constexpr char INTERFACE_FIELD[] = "Interface";
 constexpr char READ_DATA_BY_IDENTIFIER_TABLE[] = "ReadDataByIdentifier";
 constexpr char READ_SEED[] = "Seed";
 constexpr char RAW_TABLE[] = "Raw";
+constexpr char PROGRAMMING_SESSION_TABLE[] = "Programming";
+constexpr char EXTENDED_SESSION_TABLE[] = "Extended";
 constexpr char J1939_SOURCE_ADDRESS_FIELD[] = "J1939SourceAddress";
+constexpr char J1939_NAME_FIELD[] = "J1939Name";
+constexpr char J1939_RECEIVE_BUFFER_FIELD[] = "J1939ReceiveBuffer";
+constexpr char J1939_DIAGNOSTIC_MESSAGES_FIELD[] = "J1939DiagnosticMessages";
+constexpr char ISOTP_TABLE[] = "IsoTp";
+constexpr char ISOTP_BLOCK_SIZE[] = "blockSize";
+constexpr char ISOTP_ST_MIN[] = "stMin";
+constexpr char ISOTP_MAX_WAIT_FRAMES[] = "maxWaitFrames";
+constexpr char ISOTP_RECEIVE_BUFFER[] = "receiveBuffer";
+constexpr char ISOTP_CAN_FD[] = "canFd";
+constexpr char ISOTP_TX_DATA_LENGTH[] = "txDataLength";
+constexpr char ISOTP_BIT_RATE_SWITCH[] = "bitRateSwitch";
+constexpr char ISOTP_PADDING[] = "padding";
+constexpr char ISOTP_EXTENDED_ADDRESS[] = "extendedAddress";
+constexpr char ISOTP_RX_EXTENDED_ADDRESS[] = "rxExtendedAddress";
+constexpr char ISOTP_MAX_MESSAGE_SIZE[] = "maxMessageSize";
 constexpr char J1939_PGN_TABLE[] = "PGNs";
 constexpr char J1939_PGN_PAYLOAD[] = "payload";
 constexpr char J1939_PGN_CYCLETIME[] = "cycleTime";
+constexpr char J1939_PGN_CACHE_PAYLOAD[] = "cachePayload";
 constexpr char DOIP_LOGICAL_ECU_ADDRESS_FIELD[] = "DoIPLogicalEcuAddress";
+constexpr char DOIP_ENTITY_FIELD[] = "DoIPEntity";
+constexpr char BINARY_FUNCTION_FIELD[] = "binaryFunction";
+constexpr char DIRECT_FUNCTION_FIELD[] = "directFunction";
+constexpr char CACHED_FUNCTION_FIELD[] = "cachedFunction";
+constexpr char CACHE_FIELD[] = "cache";
+constexpr char CACHE_PURE[] = "pure";
+constexpr char SEQUENCE_HOLD_FIELD[] = "hold";
+constexpr char SEQUENCE_SESSION_FIELD[] = "session";
+constexpr char DELAYED_RESPONSE_FIELD[] = "delayedResponse";
+constexpr char RESPONSE_DELAY_FIELD[] = "ResponseDelay";
+constexpr char DELAYED_RESPONSE_DELAY[] = "responseDelay";
+constexpr char RESPONSE_DELAY_DISTRIBUTION[] = "distribution";
+constexpr char RESPONSE_DELAY_VALUE[] = "delay";
+constexpr char RESPONSE_DELAY_MIN[] = "min";
+constexpr char RESPONSE_DELAY_MAX[] = "max";
+constexpr char RESPONSE_DELAY_MEAN[] = "mean";
+constexpr char RESPONSE_DELAY_STDDEV[] = "stddev";
+constexpr char RESPONSE_DELAY_BINS[] = "bins";
+constexpr char DOWNLOAD_TABLE[] = "Download";
+constexpr char DOWNLOAD_MAX_SIZE[] = "maxSize";
+constexpr char DOWNLOAD_MAX_BLOCK_LENGTH[] = "maxBlockLength";
+constexpr char DOWNLOAD_ON_TRANSFER_EXIT[] = "onTransferExit";
+constexpr char DTC_TABLE[] = "DTCs";
+constexpr char DTC_STATUS[] = "status";
+constexpr char DTC_SNAPSHOTS[] = "snapshots";
+constexpr char DTC_EXTENDED_DATA[] = "extendedData";
+constexpr char DID_STORE_FILE_FIELD[] = "DIDStoreFile";
+constexpr char CHECKPOINT_GLOBALS_FIELD[] = "Checkpoint";
+constexpr char REPLAY_FIELD[] = "Replay";
+constexpr char SECURITY_ACCESS_TABLE[] = "SecurityAccess";
+constexpr char SECURITY_ALGORITHM[] = "algorithm";
+constexpr char SECURITY_SECRET[] = "secret";
+constexpr char SECURITY_KEY_FUNCTION[] = "key";
+constexpr char SECURITY_SEED_LENGTH[] = "seedLength";
+constexpr char SECURITY_MAX_ATTEMPTS[] = "maxAttempts";
+constexpr char SECURITY_DELAY[] = "delay";
+constexpr char MAX_QUEUED_REQUESTS_FIELD[] = "MaxQueuedRequests";
+constexpr char RESPONSE_PENDING_TABLE[] = "ResponsePending";
+constexpr char RESPONSE_PENDING_P2[] = "p2";
+constexpr char RESPONSE_PENDING_P2_STAR[] = "p2Star";
+constexpr char SESSIONS_TABLE[] = "Sessions";
+constexpr char SESSION_S3[] = "s3";
+constexpr char SESSION_P2[] = "p2";
+constexpr char SESSION_P2_STAR[] = "p2Star";
+constexpr char SESSION_SERVICES[] = "services";
+constexpr char PERIODIC_DATA_TABLE[] = "PeriodicData";
+constexpr char PERIODIC_DATA_RESPONSE_ID[] = "responseId";
+constexpr char PERIODIC_DATA_SLOW_RATE[] = "slow";
+constexpr char PERIODIC_DATA_MEDIUM_RATE[] = "medium";
+constexpr char PERIODIC_DATA_FAST_RATE[] = "fast";
+constexpr char OBD_TABLE[] = "OBD";
+constexpr char MEMORY_TABLE[] = "Memory";
+constexpr char MEMORY_ADDRESS[] = "address";
+constexpr char MEMORY_FILE[] = "file";
+constexpr char MEMORY_OFFSET[] = "offset";
+constexpr char MEMORY_SIZE[] = "size";
+constexpr char MEMORY_WRITABLE[] = "writable";
+constexpr char SIGNALS_TABLE[] = "Signals";
+constexpr char SIGNALS_DIDS[] = "DIDs";
+constexpr char SIGNALS_OBD_PIDS[] = "OBD";
+constexpr char SIGNALS_PGNS[] = "PGNs";
+constexpr char SIGNAL_NAME[] = "signal";
+constexpr char SIGNAL_START_BIT[] = "start";
+constexpr char SIGNAL_BIT_LENGTH[] = "length";
+constexpr char SIGNAL_SCALE[] = "scale";
+constexpr char SIGNAL_RESOLUTION[] = "resolution"; ///< the J1939 name of the scale
+constexpr char SIGNAL_OFFSET[] = "offset";
+constexpr char SIGNAL_BYTE_ORDER[] = "byteOrder";
+constexpr char SIGNAL_SIGNED[] = "signed";
+constexpr char SIGNAL_RECORD_SIZE[] = "size";
+constexpr char SIGNAL_RECORD_FILL[] = "fill";
+constexpr char CAN_FRAMES_TABLE[] = "CanFrames";
+constexpr char CAN_FRAME_PAYLOAD[] = "payload";
+constexpr char CAN_FRAME_CYCLETIME[] = "cycleTime";
+constexpr char CAN_FRAME_RESPONSE_ID[] = "responseId";
+constexpr char CAN_FRAME_RESPONSES[] = "responses";
+constexpr char LUA_TABLE[] = "Lua";
+constexpr char LUA_MEMORY_LIMIT[] = "memoryLimit";
+constexpr char LUA_GC_MODE[] = "gc";
+constexpr char LUA_GC_PAUSE[] = "gcPause";
+constexpr char LUA_GC_STEP_MULTIPLIER[] = "gcStepMultiplier";
 constexpr uint32_t DEFAULT_BROADCAST_ADDR = 0x7DF;
 
 const string REQUEST_PLACEHOLDER("XX");
@@ -39,9 +167,15 @@ struct J1939PGNData
 {
     unsigned int cycleTime;
     std::string payload;
+    /// true if the payload is a Lua function (`payload` is empty then)
+    bool isLuaFunction = false;
+    /// true if the result of the function is kept until `invalidatePGN()`
+    bool cachePayload = false;
 };
 
 class DoIPSimServer;
+class J1939Simulator;
+class Checkpoint;
 
 class EcuLuaScript
 {
@@ -54,6 +188,9 @@ public:
     EcuLuaScript& operator =(EcuLuaScript&& orig) noexcept;
     virtual ~EcuLuaScript() = default;
 
+    /// the `ReadDataByIdentifier` entries per session name ("" = default session)
+    using DataIdentifierIndices = std::map<std::string, DataIdentifierIndex, std::less<>>;
+
     bool hasRequestId() const { return hasRequestId_; };
     std::uint32_t getRequestId() const;
     bool hasResponseId() const { return hasResponseId_; };
@@ -62,74 +199,281 @@ public:
     std::uint32_t getBroadcastId() const;
     bool hasJ1939SourceAddress() const { return hasJ1939SourceAddress_; };
     std::uint8_t getJ1939SourceAddress() const;
+    const std::vector<std::string>& getInterfaces() const { return interfaces_; };
+    std::uint64_t getJ1939Name() const { return j1939Name_; };
+    int getJ1939ReceiveBufferSize() const { return j1939ReceiveBufferSize_; };
+    bool hasJ1939DiagnosticMessages() const { return hasJ1939DiagnosticMessages_; };
+    const IsoTpConfiguration& getIsoTpConfiguration() const { return isoTpConfiguration_; };
+    const std::string& getReplayFile() const { return replayFile_; };
     bool hasDoIPLogicalEcuAddress() const { return hasDoIPLogicalEcuAddress_; };
     std::uint16_t getDoIPLogicalEcuAddress() const { return doipLogicalEcuAddress_; };
+    bool isInDoIPEntity(const std::string& entity) const;
+    bool hasDownload() const { return hasDownload_; };
+    const DownloadConfiguration& getDownloadConfiguration() const { return downloadConfiguration_; };
+    std::unique_ptr<DownloadService> createDownloadService();
+    std::vector<SecurityLevelConfiguration> getSecurityLevels();
+    std::optional<std::vector<std::uint8_t>> callSecurityKey(std::uint8_t level, const std::vector<std::uint8_t>& seed);
+    bool hasResponsePending() const { return hasResponsePending_; };
+    const ResponsePendingConfiguration& getResponsePendingConfiguration() const { return responsePendingConfiguration_; };
+    std::uint32_t getMaxQueuedRequests() const { return maxQueuedRequests_; };
+    std::shared_ptr<const ResponseDelay> getResponseDelay() const { return pResponseDelay_; };
+    const std::map<std::uint8_t, SessionConfiguration>& getSessionConfigurations() const { return sessionConfigurations_; };
+    std::shared_ptr<const LuaMemoryStatistics> getLuaMemoryStatistics() const { return pLuaMemory_; };
+    std::shared_ptr<const RequestHitStatistics> getRequestHitStatistics() const { return pRequestHits_; };
+    bool hasPeriodicData() const { return hasPeriodicData_; };
+    const PeriodicDataConfiguration& getPeriodicDataConfiguration() const { return periodicDataConfiguration_; };
+    std::unique_ptr<ObdService> createObdService();
+    std::unique_ptr<MemoryService> createMemoryService(std::size_t maxResponseLength) const;
+    std::optional<std::vector<std::uint8_t>> callObdPid(std::uint8_t mode, std::uint8_t pid);
+    std::shared_ptr<const SignalMappings> getSignalMappings() const { return pSignalMappings_; };
+    const std::vector<CanFrameConfiguration>& getCanFrames() const { return canFrames_; };
+    std::shared_ptr<DtcStore> getDtcStore() const { return pDtcStore_; };
+    std::shared_ptr<DidStore> getDidStore() const { return pDidStore_; };
+    std::shared_ptr<CommunicationGate> getCommunicationGate() const { return pCommunicationGate_; };
+    std::optional<std::vector<std::uint8_t>> callTransferExit(const DownloadSummary& summary);
 
     std::string getSeed(std::uint8_t identifier);
     std::string getDataByIdentifier(const std::string& identifier);
     std::string getDataByIdentifier(const std::string& identifier, const std::string& session);
+    std::shared_ptr<const DataIdentifierIndices> getDataIdentifierIndices() const;
+    static const DataIdentifierIndex::Entry *findDataIdentifier(const DataIdentifierIndices& indices,
+                                                                std::string_view session,
+                                                                std::uint16_t identifier);
+    std::string readDataIdentifier(const std::string& session, const DataIdentifierIndex::Entry& entry);
+    void readDataIdentifier(const std::string& session, const DataIdentifierIndex::Entry& entry, std::string& value);
+    static const char *getSessionTableName(std::uint8_t session) noexcept;
     std::vector<std::string> getJ1939PGNs();
-    J1939PGNData getJ1939RequestPGNData(const map<string,shared_ptr<Selector>> pgnMap, const std::string& pgn);
-    std::string getJ1939Response(const shared_ptr<RequestByteTreeNode<shared_ptr<Selector>>> requestByteTree, const uint32_t pgn, const uint8_t *payload, const uint32_t payloadLength);
+    J1939PGNData getJ1939RequestPGNData(const J1939PgnIndex<shared_ptr<Selector>> &pgnIndex, std::uint32_t pgn);
+    J1939PGNData getJ1939PGNDefinition(const J1939PgnIndex<shared_ptr<Selector>> &pgnIndex, std::uint32_t pgn);
+    std::string getJ1939Response(const LuaRequestMatcher &requestMatcher, const uint32_t pgn, const uint8_t *payload, const uint32_t payloadLength);
 
-    std::optional<string> getRawResponse(const shared_ptr<RequestByteTreeNode<shared_ptr<Selector>>> requestByteTree, const uint8_t *payload, const uint32_t payloadLength);
+    std::optional<string> getRawResponse(const LuaRequestMatcher &requestMatcher, const uint8_t *payload, const uint32_t payloadLength);
+    std::string callLuaResponse(const RequestResponse &response, const uint8_t *payload, const uint32_t payloadLength,
+                                LuaHandler handler = LuaHandler::RAW);
+    void callLuaResponse(const RequestResponse &response, const uint8_t *payload, const uint32_t payloadLength,
+                         std::vector<std::uint8_t>& bytes, LuaHandler handler = LuaHandler::RAW);
+    void postLuaResponse(std::shared_ptr<const LuaRequestMatcher> pRequestMatcher, const RequestResponse &response,
+                         const uint8_t *payload, const uint32_t payloadLength, std::vector<std::uint8_t>& bytes,
+                         std::function<void()> onFinished, std::function<void()> onStarted = nullptr);
     static std::vector<std::uint8_t> literalHexStrToBytes(const std::string& hexString);
+    static void literalHexStrToBytes(std::string_view hexString, std::vector<std::uint8_t>& bytes);
 
     static std::string ascii(const std::string& utf8_str) noexcept;
     static std::string getCounterByte(const std::string& msg) noexcept;
     static void getDataBytes(const std::string& msg) noexcept;
     static std::string createHash() noexcept;
+    std::uint32_t crcCreate(const std::string& algorithm);
+    std::uint32_t crcUpdate(std::uint32_t handle, const std::string& bytes);
+    std::uint32_t crcValue(std::uint32_t handle) const;
+    void crcRelease(std::uint32_t handle);
+    void setDtc(std::uint32_t dtc, std::uint32_t status);
+    bool clearDtc(std::uint32_t dtc);
+    bool setCommunicationControl(std::uint32_t controlType, std::uint32_t communicationType);
+    std::uint32_t getDtcStatus(std::uint32_t dtc) const;
+    bool setDtcSnapshot(std::uint32_t dtc, std::uint32_t recordNumber, const std::string& data);
+    bool setDtcExtendedData(std::uint32_t dtc, std::uint32_t recordNumber, const std::string& data);
     static std::string toByteResponse(std::uint32_t value, std::uint32_t len = sizeof(std::uint32_t)) noexcept;
     static void sleep(unsigned int ms) noexcept;
-    void sendRaw(const std::string& response) const;
+    void sendRaw(std::string_view response);
     std::uint8_t getCurrentSession() const;
     void switchToSession(int ses);
     void disconnectDoip();
     void sendDoipVehicleAnnouncements();
+    void invalidatePGN(const std::string& pgn);
+    void invalidateCache() noexcept;
+    void setPGNPayload(const std::string& pgn, const std::string& payload);
+    static void setSignal(const std::string& name, double value);
+    static double getSignal(const std::string& name);
 
     void registerSessionController(SessionController* pSesCtrl) noexcept;
-    void registerIsoTpSender(IsoTpSender* pSender) noexcept;
+    void registerTransport(UdsTransport* pTransport) noexcept;
     void registerDoipSimServer(DoIPSimServer *pDoipSimServer) noexcept;
+    void sendDoIPMessage(const std::vector<std::uint8_t>& message) const;
+    void registerJ1939Simulator(J1939Simulator *pJ1939Simulator) noexcept;
 
     std::string intToHexString(const uint8_t* buffer, const std::size_t num_bytes);
+    static void intToHexString(const uint8_t* buffer, std::size_t num_bytes, std::string& hex);
 
     template<class T>
     optional<T> getValueFromTree(const shared_ptr<RequestByteTreeNode<T>> requestByteTree, const vector<uint8_t> payload);
-    shared_ptr<RequestByteTreeNode<shared_ptr<sel::Selector>>> buildRequestByteTreeFromPGNTable();
-    shared_ptr<RequestByteTreeNode<shared_ptr<sel::Selector>>> buildRequestByteTreeFromRawTable();
-    map<string,shared_ptr<sel::Selector>> buildRequestPGNMap();
+    shared_ptr<RequestByteTreeNode<RequestResponse>> buildRequestByteTreeFromPGNTable();
+    shared_ptr<RequestByteTreeNode<RequestResponse>> buildRequestByteTreeFromRawTable();
+    shared_ptr<const LuaRequestMatcher> getRawRequestMatcher(std::uint8_t session = UdsSession::DEFAULT);
+    static void setSnapshotsEnabled(bool isEnabled) noexcept;
+    static void setHotRelayoutEnabled(bool isEnabled) noexcept;
+    const std::string& getScriptFile() const noexcept { return scriptFile_; }
+    bool reload();
+    void resetState();
+    void saveCheckpoint(Checkpoint& checkpoint);
+    void restoreCheckpoint(const Checkpoint& checkpoint);
+    J1939PgnIndex<shared_ptr<sel::Selector>> buildRequestPGNIndex();
+    /// the compiled 'PGNs' table, see `getJ1939Tables()`
+    struct J1939Tables
+    {
+        std::shared_ptr<sel::State> pLuaState; ///< declared first, so it is destroyed after the Lua references
+        LuaRequestMatcher requestMatcher; ///< the entries with request payload ("PGN#payload")
+        J1939PgnIndex<std::shared_ptr<sel::Selector>> pgnIndex; ///< the PGNs without request payload
+    };
+    std::shared_ptr<const J1939Tables> getJ1939Tables();
 
 private:
-    sel::State lua_state_{true};
+    /// the memory of all Lua states of the ECU, see `createLuaState()`
+    std::shared_ptr<LuaMemoryStatistics> pLuaMemory_ = std::make_shared<LuaMemoryStatistics>();
+    /// replaced by `reload()`, the matchers keep the state they were built from alive
+    std::shared_ptr<sel::State> pLuaState_ = createLuaState(pLuaMemory_);
+    /// the Lua state (and 'Raw' matcher) the J1939 simulation was built from, kept after a reload
+    std::shared_ptr<const void> pJ1939Version_;
     std::string ecu_ident_;
+    std::string scriptFile_; ///< the path of the loaded script, empty if it has no ECU table
     SessionController* pSessionCtrl_ = nullptr;
-    IsoTpSender* pIsoTpSender_ = nullptr;
-    DoIPSimServer *pDoipSimServer_ = nullptr;
+    UdsTransport* pTransport_ = nullptr; ///< sends the responses of `sendRaw()`
+    /// the messages of `sendRaw()` deferred until the response function returns, see `DeferredSendScope`
+    std::vector<std::vector<std::uint8_t>> deferredMessages_;
+    std::size_t deferredCount_ = 0; ///< the used buffers of `deferredMessages_`, the others are kept for reuse
+    int deferredDepth_ = 0; ///< the nesting of the `DeferredSendScope`s on the Lua worker
+    std::vector<DoIPSimServer*> doipSimServers_; ///< the DoIP entities the ECU belongs to
+    J1939Simulator *pJ1939Simulator_ = nullptr;
     bool hasRequestId_ = false;
     std::uint32_t requestId_;
     bool hasResponseId_ = false;
     std::uint32_t responseId_;
     bool hasBroadcastId_ = false;
     std::uint32_t broadcastId_ = DEFAULT_BROADCAST_ADDR;
+    std::vector<std::string> interfaces_; ///< the CAN interfaces of the ECU, empty = the one of the command line
     bool hasJ1939SourceAddress_ = false;
     std::uint8_t j1939SourceAddress_;
+    std::uint64_t j1939Name_ = 0; ///< 0 if the address is not claimed
+    int j1939ReceiveBufferSize_ = 0; ///< `SO_RCVBUF` of the J1939 bus, 0 = the kernel default
+    bool hasJ1939DiagnosticMessages_ = false; ///< DM1 and DM2 are generated from the DTC store
+    IsoTpConfiguration isoTpConfiguration_;
+    std::string replayFile_; ///< the recorded trace served by the `ReplayTrace`, empty if none
     bool hasDoIPLogicalEcuAddress_ = false;
     std::uint16_t doipLogicalEcuAddress_;
-    std::mutex luaLock_;
+    std::vector<std::string> doipEntities_; ///< empty if the ECU belongs to all entities
+    bool hasDownload_ = false;
+    DownloadConfiguration downloadConfiguration_;
+    std::vector<SecurityLevelConfiguration> securityLevels_; ///< the Lua key functions are bound by `getSecurityLevels()`
+    bool hasResponsePending_ = false;
+    ResponsePendingConfiguration responsePendingConfiguration_;
+    /// the max. number of Lua requests queued on the Lua worker, see `UdsReceiver`
+    std::uint32_t maxQueuedRequests_ = DEFAULT_MAX_QUEUED_REQUESTS;
+    std::shared_ptr<const ResponseDelay> pResponseDelay_; ///< the `ResponseDelay` of the ECU, `nullptr` = none
+    std::map<std::uint8_t, SessionConfiguration> sessionConfigurations_; ///< the `Sessions` table, by session ID
+    bool hasPeriodicData_ = false;
+    PeriodicDataConfiguration periodicDataConfiguration_;
+    std::vector<ObdPidConfiguration> obdPids_; ///< the PIDs of the `OBD` table, empty if there is none
+    std::vector<MemoryRegionConfiguration> memoryRegions_; ///< the regions of the `Memory` table
+    std::vector<CanFrameConfiguration> canFrames_; ///< the `CanFrames` table, empty if there is none
+    /// the records of the `Signals` table, encoded from the `VehicleSignals`
+    std::shared_ptr<const SignalMappings> pSignalMappings_ = std::make_shared<const SignalMappings>();
+    /// the fault memory, shared with the `UdsServices` of all transports
+    std::shared_ptr<DtcStore> pDtcStore_ = std::make_shared<DtcStore>();
+    /// the values written by `WriteDataByIdentifier`, shared with the `UdsServices` of all transports
+    std::shared_ptr<DidStore> pDidStore_ = std::make_shared<DidStore>();
+    /// the state of `CommunicationControl`, shared with the `UdsServices` and the simulations of the ECU
+    std::shared_ptr<CommunicationGate> pCommunicationGate_ = std::make_shared<CommunicationGate>();
+    /// read without the Lua worker, so it is replaced as a whole by `reload()`
+    std::shared_ptr<const DataIdentifierIndices> pDataIdentifierIndices_ = std::make_shared<const DataIdentifierIndices>();
+    /// registry references to the ECU table and the `ReadDataByIdentifier` tables per session
+    std::optional<sel::LuaRef> ecuTableRef_;
+    std::map<std::string, sel::LuaRef> dataIdentifierTableRefs_;
+    /// registry reference to the function restoring the globals after loading, see `resetState()`
+    std::optional<sel::LuaRef> restoreStateRef_;
+    /// the compiled 'Raw' tables of all sessions and the Lua state they were built from
+    struct RawRequestMatchers
+    {
+        std::shared_ptr<sel::State> pLuaState; ///< declared first, so it is destroyed after the matchers
+        std::vector<std::shared_ptr<const LuaRequestMatcher>> matchers; ///< the one of the ECU table first
+        /// indexed by the session ID, the matcher of the ECU table for sessions without 'Raw' table
+        std::array<const LuaRequestMatcher*, 256> sessions;
+    };
+    /// the compiled 'Raw' tables, see `getRawRequestMatcher()`
+    std::shared_ptr<const RawRequestMatchers> pRawRequestMatchers_;
+    /// serializes building the 'Raw' table and `reload()`
+    std::mutex rawRequestMatcherMutex_;
+    /// shared by the J1939 simulations on all interfaces of the ECU, see `getJ1939Tables()`
+    std::shared_ptr<const J1939Tables> pJ1939Tables_;
+    std::mutex j1939TablesMutex_; ///< serializes building `pJ1939Tables_`
+    static std::atomic<bool> isSnapshotEnabled_;
+    static std::atomic<bool> isHotRelayoutEnabled_;
+    /// the hit counters of the compiled tables, see `publishRequestHits()`
+    std::shared_ptr<RequestHitStatistics> pRequestHits_ = std::make_shared<RequestHitStatistics>();
+    /// the streams of `crcCreate()` (handle - 1), only accessed by Lua
+    std::vector<std::optional<CrcStream>> crcStreams_;
+    std::vector<std::uint8_t> crcBuffer_; ///< reused by `crcUpdate()`
+    /// the epoch of the caches of all `cached()` functions, see `invalidateCache()`
+    std::shared_ptr<ResponseCache::Epoch> pCacheEpoch_ = std::make_shared<ResponseCache::Epoch>(0);
+    /// executes all Lua accesses after loading, declared last to stop it before the Lua state is destroyed
+    std::unique_ptr<LuaWorker> luaWorker_;
 
     vector<string> getLuaTableKeys(Selector luaTable);
     string cleanupString(string rawString);
-    shared_ptr<RequestByteTreeNode<shared_ptr<sel::Selector>>> buildRequestByteTree(
-        vector<string> requestKeys, std::function<shared_ptr<sel::Selector>(string &key)> mappingFunction);
+    sel::Selector getSessionTable(sel::State& luaState, std::uint8_t session);
+    RequestResponse compileResponse(sel::State& luaState, const char *table, const std::string& key,
+                                    std::uint8_t session = UdsSession::DEFAULT);
+    RequestResponse compileResponseValue(lua_State *l, int index);
+    std::shared_ptr<ResponseCache> createResponseCache(lua_State *l, int index);
+    std::shared_ptr<const ResponseDelay> createResponseDelay(lua_State *l, int index);
+    /// the static responses of a compiled table by key, see `compileRequestTable()`
+    using PreviousResponses = std::unordered_map<std::string_view, const RequestResponse*>;
+    void compileRequestTable(lua_State *l, sel::Selector table, vector<pair<string, RequestResponse>>& entries,
+                             const std::function<bool(const string& key)>& isIncluded = nullptr,
+                             const PreviousResponses *pPreviousResponses = nullptr);
+    class DeferredSendScope;
+    void sendMessage(const std::vector<std::uint8_t>& message) const;
+    void flushDeferredMessages();
+    std::string callLuaFunction(const LuaFunctionRef& function, std::string_view argument);
+    void runLuaResponse(const RequestResponse& response, LuaHandler handler, std::string_view argument,
+                        const std::function<void(std::string_view)>& onResult);
+    void callDirectFunction(const LuaFunctionRef& function, const std::uint8_t *payload, std::size_t payloadLength,
+                            std::vector<std::uint8_t>& bytes);
+    void startLuaCoroutine(const LuaFunctionRef& function, std::string_view argument,
+                           std::function<void(std::string_view)> onFinished);
+    void resumeLuaCoroutine(lua_State *l, lua_State *co, int threadRef, int argumentCount,
+                            std::function<void(std::string_view)> onFinished);
+    static std::shared_ptr<sel::State> createLuaState(const std::shared_ptr<LuaMemoryStatistics>& pStatistics);
+    bool loadScript(sel::State& luaState, const std::string& luaScript);
+    void configureLuaState(sel::State& luaState);
+    std::shared_ptr<const DataIdentifierIndices> compileDataIdentifierIndices(sel::State& luaState);
+    void compileDataIdentifiers(DataIdentifierIndices& indices, const std::string& session, lua_State *l,
+                                sel::Selector dataIdentifierTable);
+    shared_ptr<RequestByteTreeNode<RequestResponse>> buildRawRequestTree(sel::State& luaState,
+                                                                         std::uint8_t session = UdsSession::DEFAULT);
+    vector<pair<string, RequestResponse>> compileRawEntries(sel::State& luaState, std::uint8_t session,
+                                                            const PreviousResponses *pPreviousResponses = nullptr);
+    shared_ptr<const LuaRequestMatcher> compileRawRequestMatcher(sel::State& luaState, std::uint8_t session,
+                                                                 const LuaRequestMatcher *pPreviousMatcher);
+    shared_ptr<const RawRequestMatchers> compileRawRequestMatchers(const shared_ptr<sel::State>& pLuaState);
+    void publishRequestHits() const;
+    void createTableRefs();
+    void captureLuaState();
+    void forEachResponseSequence(const std::function<void(std::uint8_t session, const RequestResponse& response)>& callback) const;
+    std::string saveLuaGlobals();
+    void restoreLuaGlobals(std::string_view globals);
+    void loadDtcs(sel::Selector dtcTable);
+    void loadSecurityLevels(sel::Selector securityTable);
+    void loadSessionConfigurations(sel::Selector sessionsTable);
+    void loadObdPids(sel::Selector obdTable);
+    void loadMemoryRegions(sel::Selector memoryTable);
+    void loadCanFrames(sel::Selector canFramesTable);
+    std::shared_ptr<const SignalMappings> loadSignalMappings(sel::Selector signalsTable);
+    std::optional<SignalRecord> loadSignalRecord(sel::Selector recordTable, bool isBigEndian,
+                                                 std::size_t size, std::uint8_t fill);
+    std::string callDataIdentifier(const std::string& session, const std::string& identifier);
+    void callDataIdentifier(const std::string& session, const std::string& identifier, std::string& value);
+    static std::string popLuaString(lua_State *l);
+    static std::string_view toStringView(lua_State *l, int index);
+    shared_ptr<RequestByteTreeNode<RequestResponse>> buildRequestByteTree(
+        vector<pair<string, RequestResponse>> entries);
 
     template<class T>
-    void findAndAddMatchesForNextByte(set<shared_ptr<RequestByteTreeNode<T>>> &matchingNodes, shared_ptr<RequestByteTreeNode<T>> currentByte, uint8_t nextByte);
+    void findAndAddMatchesForNextByte(vector<RequestByteTreeNode<T>*> &matchingNodes, RequestByteTreeNode<T> *currentByte, uint8_t nextByte);
 	template<class T>
-    shared_ptr<RequestByteTreeNode<T>> findBestMatchingRequest(set<shared_ptr<RequestByteTreeNode<T>>> &potentiallyMatchingRequests);
+    RequestByteTreeNode<T> *findBestMatchingRequest(const vector<RequestByteTreeNode<T>*> &potentiallyMatchingRequests);
 	template<class T>
-    shared_ptr<RequestByteTreeNode<T>> getThisOrNextWildcardWithResponse(shared_ptr<RequestByteTreeNode<T>> requestByteNode);
+    RequestByteTreeNode<T> *getThisOrNextWildcardWithResponse(RequestByteTreeNode<T> *requestByteNode);
 	template<class T>
-    shared_ptr<RequestByteTreeNode<T>> addRequestToTree(shared_ptr<RequestByteTreeNode<T>> requestByteTree, string &requestString);
+    RequestByteTreeNode<T> *addRequestToTree(RequestByteTreeNode<T> *requestByteTree, string &requestString);
 
 };
 
@@ -6,30 +6,29 @@
 #ifndef ECU_TIMER_H
 #define ECU_TIMER_H
 
-#include <sys/time.h>
-#include <pthread.h>
-#include <stdio.h>
-#include <sys/select.h>
-#include <unistd.h>
-#include <errno.h>
-#include <mutex>
+#include "timer_wheel.h"
+#include <atomic>
 #include <chrono>
 
+/**
+ * Base class of a timer of a simulated ECU. All timers are driven by the
+ * shared `TimerWheel`, so starting or resetting a timer neither creates a
+ * thread nor blocks the caller.
+ */
 class EcuTimer {
 public:
     EcuTimer();
-    EcuTimer(const EcuTimer& orig)= default;
+    EcuTimer(const EcuTimer& orig) = delete;
+    EcuTimer& operator =(const EcuTimer& orig) = delete;
     virtual ~EcuTimer() = default;
     void start(int ms);
     void reset();
+    void stop();
 
 private:
-    std::mutex mutex_;
-    useconds_t duration_; // [ms]
-    std::chrono::system_clock::time_point t_start_;
-    int t_id_;
+    std::atomic<int> duration_{0}; // [ms]
+    TimerWheel::Timer timer_;
 
-    void sleep();
     virtual void wakeup() = 0;  // overwrite this in derived timers
 };
 
@@ -5,38 +5,111 @@
  */
 
 #include "electronic_control_unit.h"
+#include "logger.h"
+#include "metrics.h"
 #include <array>
+#include <sys/epoll.h>
+#include <iostream>
 #include <unistd.h>
 
 using namespace std;
 
-ElectronicControlUnit::ElectronicControlUnit(const string& device, EcuLuaScript *pEcuScript)
+/**
+ * Constructor. Opens the sockets of the ECU and starts the simulation.
+ *
+ * @param device: the CAN device (e.g. "vcan0")
+ * @param pEcuScript: the Lua script of the ECU
+ * @param pReactor: the reactor that handles the receivers or `nullptr` to
+ *                  start a dedicated thread for each receiver
+ */
+ElectronicControlUnit::ElectronicControlUnit(const string& device,
+                                             EcuLuaScript *pEcuScript,
+                                             ReceiverReactor *pReactor)
 : requId_(pEcuScript->getRequestId())
 , respId_(pEcuScript->getResponseId())
-, sender_(respId_, requId_, device)
-, broadcastReceiver_(pEcuScript->getBroadcastId(), device, &udsReceiver_)
+, sender_(respId_, requId_, device, pEcuScript->getIsoTpConfiguration())
 , udsReceiver_(respId_, requId_, device, pEcuScript, &sender_, &sessionControl_)
-, udsReceiverThread_(&IsoTpReceiver::readData, &udsReceiver_)
-, broadcastReceiverThread_(&IsoTpReceiver::readData, &broadcastReceiver_)
+, pReactor_(pReactor)
 {
+    EcuMetrics* pMetrics = Metrics::getInstance().registerEcu("uds", requId_);
+    udsReceiver_.setMetrics(pMetrics);
+    pMetrics->setLuaMemory(pEcuScript->getLuaMemoryStatistics());
+    pMetrics->setRequestHits(pEcuScript->getRequestHitStatistics());
+    sender_.setMetrics(pMetrics);
+    pBroadcastReceiver_ = BroadcastReceiver::attach(pEcuScript->getBroadcastId(),
+                                                    device,
+                                                    &udsReceiver_,
+                                                    pReactor_);
+    if (pReactor_)
+    {
+        if (pReactor_->addHandler(&udsReceiver_, EPOLLIN) != 0)
+        {
+            BroadcastReceiver::detach(pBroadcastReceiver_, &udsReceiver_);
+            throw exception();
+        }
+        if (sender_.enableAsyncSend(pReactor_) != 0)
+        {
+            LOG_WARNING("Failed to enable the non-blocking sender, using blocking writes");
+        }
+    }
+    else
+    {
+        udsReceiverThread_ = thread(&IsoTpReceiver::readData, &udsReceiver_);
+    }
+    pMetrics->isReady = true;
 }
 
+/**
+ * Stops the receivers and closes the sockets of the ECU. Returns when no
+ * thread uses the receivers anymore, so the ECU can be deleted right away.
+ */
 void ElectronicControlUnit::stopSimulation()
 {
+    BroadcastReceiver::detach(pBroadcastReceiver_, &udsReceiver_);
+    pBroadcastReceiver_.reset();
+    if (pReactor_)
+    {
+        // the workers must not use the socket while it is closed
+        pReactor_->removeHandler(&udsReceiver_);
+    }
+    else if (udsReceiverThread_.joinable())
+    {
+        udsReceiver_.stopReceiver();
+        udsReceiverThread_.join();
+    }
     sender_.closeSender();
-    broadcastReceiver_.closeReceiver();
     udsReceiver_.closeReceiver();
 }
 
+/**
+ * Waits until the receivers are stopped. In reactor mode, this waits until
+ * the reactor is stopped.
+ */
 void ElectronicControlUnit::waitForSimulationEnd()
 {
-    broadcastReceiverThread_.join();
-    udsReceiverThread_.join();
+    if (pReactor_)
+    {
+        pReactor_->waitForStop();
+        return;
+    }
+    if (udsReceiverThread_.joinable())
+    {
+        udsReceiverThread_.join();
+    }
 }
 
 ElectronicControlUnit::~ElectronicControlUnit()
 {
-
+    BroadcastReceiver::detach(pBroadcastReceiver_, &udsReceiver_);
+    if (pReactor_)
+    {
+        pReactor_->removeHandler(&udsReceiver_);
+    }
+    else if (udsReceiverThread_.joinable())
+    {
+        udsReceiver_.stopReceiver();
+        udsReceiverThread_.join();
+    }
 }
 
 bool ElectronicControlUnit::hasSimulation(EcuLuaScript *pEcuScript)
@@ -6,7 +6,7 @@
 #ifndef ELECTRONIC_CONTROL_UNIT_H
 #define ELECTRONIC_CONTROL_UNIT_H
 
-#include "selene.h"
+#include "lua_compat.h"
 #include "ecu_lua_script.h"
 #include "config.h"
 #include "session_controller.h"
@@ -14,6 +14,7 @@
 #include "broadcast_receiver.h"
 #include "uds_receiver.h"
 #include "j1939_simulator.h"
+#include "receiver_reactor.h"
 #include <string>
 #include <thread>
 #include <memory>
@@ -25,11 +26,13 @@ public:
 
 public:
     ElectronicControlUnit() = delete;
-    ElectronicControlUnit(const std::string& device, EcuLuaScript *pEcuScript);
-    ElectronicControlUnit(const ElectronicControlUnit& orig) = default;
-    ElectronicControlUnit& operator =(const ElectronicControlUnit& orig) = default;
-    ElectronicControlUnit(ElectronicControlUnit&& orig) = default;
-    ElectronicControlUnit& operator =(ElectronicControlUnit&& orig) = default;
+    ElectronicControlUnit(const std::string& device,
+                          EcuLuaScript *pEcuScript,
+                          ReceiverReactor *pReactor = nullptr);
+    ElectronicControlUnit(const ElectronicControlUnit& orig) = delete;
+    ElectronicControlUnit& operator =(const ElectronicControlUnit& orig) = delete;
+    ElectronicControlUnit(ElectronicControlUnit&& orig) = delete;
+    ElectronicControlUnit& operator =(ElectronicControlUnit&& orig) = delete;
     virtual ~ElectronicControlUnit();
 
     void stopSimulation();
@@ -41,10 +44,10 @@ private:
     std::uint32_t respId_;
     SessionController sessionControl_;
     IsoTpSender sender_;
-    BroadcastReceiver broadcastReceiver_;
     UdsReceiver udsReceiver_;
+    ReceiverReactor *pReactor_; ///< `nullptr` if every receiver has its own thread
+    std::shared_ptr<BroadcastReceiver> pBroadcastReceiver_; ///< shared with all ECUs on the same address
     std::thread udsReceiverThread_;
-    std::thread broadcastReceiverThread_;
 };
 
 #endif /* ELECTRONIC_CONTROL_UNIT_H */
@@ -0,0 +1,356 @@
+/**
+ * @file hex_codec.cpp
+ *
+ * This file contains the conversions between bytes and literal hex strings,
+ * with vector kernels for the spaced layout of the Lua scripts.
+ */
+
+#include "hex_codec.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define HEX_CODEC_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define HEX_CODEC_NEON
+#endif
+
+using namespace std;
+
+/// the bytes of a block of the vector kernels
+static constexpr size_t BLOCK_BYTES = 16;
+/// the characters of a block, two digits and a space per byte
+static constexpr size_t BLOCK_CHARS = BLOCK_BYTES * 3;
+/// the separators removed by `removeSeparators()`
+static constexpr char SEPARATORS[] = "_.,; #\t";
+/// marks a character which is no hex digit in `HexTables::values`
+static constexpr uint8_t NO_DIGIT = 0xFF;
+
+struct HexTables
+{
+    uint8_t values[256] = {}; ///< the value of a hex digit, `NO_DIGIT` for other characters
+    char digits[256][2] = {}; ///< the two upper case digits of a byte
+    bool separators[256] = {};
+};
+
+static constexpr HexTables makeTables()
+{
+    constexpr char HEX_DIGITS[] = "0123456789ABCDEF";
+    HexTables tables;
+    for (int c = 0; c < 256; c++)
+    {
+        tables.values[c] = NO_DIGIT;
+        tables.digits[c][0] = HEX_DIGITS[c >> 4];
+        tables.digits[c][1] = HEX_DIGITS[c & 0x0F];
+    }
+    for (int i = 0; i < 10; i++)
+    {
+        tables.values['0' + i] = uint8_t(i);
+    }
+    for (int i = 0; i < 6; i++)
+    {
+        tables.values['A' + i] = uint8_t(10 + i);
+        tables.values['a' + i] = uint8_t(10 + i);
+    }
+    for (const char* separator = SEPARATORS; *separator != '\0'; separator++)
+    {
+        tables.separators[uint8_t(*separator)] = true;
+    }
+    return tables;
+}
+
+static constexpr HexTables TABLES = makeTables();
+
+/**
+ * @return the byte of two digits, as `strtol()` converts them: a pair with
+ *         other characters (e.g. "6h") only counts up to the first of them
+ */
+static uint8_t decodePair(char high, char low) noexcept
+{
+    const uint8_t highValue = TABLES.values[uint8_t(high)];
+    const uint8_t lowValue = TABLES.values[uint8_t(low)];
+    if ((highValue | lowValue) < 16)
+    {
+        return uint8_t((highValue << 4) | lowValue);
+    }
+    const char pair[3] = {high, low, '\0'};
+    return static_cast<uint8_t> (strtol(pair, nullptr, 16));
+}
+
+/**
+ * @return the byte of the single digit at the end of an odd string
+ */
+static uint8_t decodeDigit(char digit) noexcept
+{
+    const char single[2] = {digit, '\0'};
+    return static_cast<uint8_t> (strtol(single, nullptr, 16));
+}
+
+#if defined(HEX_CODEC_SSE2)
+
+/**
+ * Converts 16 characters into the values of their hex digits.
+ *
+ * @param chars: the characters
+ * @param valid: set to 0xFF for the hex digits, 0 for other characters
+ * @return the values, undefined for other characters
+ */
+static inline __m128i toNibbles(__m128i chars, __m128i& valid) noexcept
+{
+    const __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    const __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    const __m128i letter = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    const __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+    valid = _mm_or_si128(isDigit, isLetter);
+    return _mm_or_si128(_mm_and_si128(isDigit, digit),
+                        _mm_and_si128(isLetter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+}
+
+/**
+ * Decodes 16 bytes if the 48 characters are in the layout "HH HH ... HH ".
+ * The characters are classified 16 at a time, the spaces are at every third
+ * position, i.e. at the bits 0x4924, 0x2492 and 0x9249 of the three vectors.
+ *
+ * @return false if the characters are in another layout, nothing is written
+ */
+static inline bool decodeBlock(const char* text, uint8_t* bytes) noexcept
+{
+    static constexpr int SPACES[3] = {0x4924, 0x2492, 0x9249};
+    alignas(16) uint8_t nibbles[BLOCK_CHARS];
+    for (size_t i = 0; i < 3; i++)
+    {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*> (text + i * 16));
+        __m128i valid;
+        const __m128i values = toNibbles(chars, valid);
+        const int spaces = _mm_movemask_epi8(_mm_cmpeq_epi8(chars, _mm_set1_epi8(' ')));
+        if (spaces != SPACES[i] || _mm_movemask_epi8(valid) != (~SPACES[i] & 0xFFFF))
+        {
+            return false;
+        }
+        _mm_store_si128(reinterpret_cast<__m128i*> (nibbles + i * 16), values);
+    }
+    for (size_t i = 0; i < BLOCK_BYTES; i++)
+    {
+        bytes[i] = uint8_t((nibbles[i * 3] << 4) | nibbles[i * 3 + 1]);
+    }
+    return true;
+}
+
+#elif defined(HEX_CODEC_NEON)
+
+/// see the SSE2 variant
+static inline uint8x16_t toNibbles(uint8x16_t chars, uint8x16_t& valid) noexcept
+{
+    const uint8x16_t digit = vsubq_u8(chars, vdupq_n_u8('0'));
+    const uint8x16_t isDigit = vcleq_u8(digit, vdupq_n_u8(9));
+    const uint8x16_t letter = vsubq_u8(vorrq_u8(chars, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+    const uint8x16_t isLetter = vcleq_u8(letter, vdupq_n_u8(5));
+    valid = vorrq_u8(isDigit, isLetter);
+    return vbslq_u8(isDigit, digit, vaddq_u8(letter, vdupq_n_u8(10)));
+}
+
+/**
+ * @return true if all lanes of the comparison result are set
+ */
+static inline bool isAllSet(uint8x16_t mask) noexcept
+{
+#if defined(__aarch64__)
+    return vminvq_u8(mask) == 0xFF;
+#else
+    uint8x8_t half = vand_u8(vget_low_u8(mask), vget_high_u8(mask));
+    half = vpmin_u8(half, half);
+    half = vpmin_u8(half, half);
+    half = vpmin_u8(half, half);
+    return vget_lane_u8(half, 0) == 0xFF;
+#endif
+}
+
+/**
+ * Decodes 16 bytes if the 48 characters are in the layout "HH HH ... HH ".
+ * `vld3q_u8()` splits the characters into the high digits, the low digits
+ * and the spaces.
+ *
+ * @return false if the characters are in another layout, nothing is written
+ */
+static inline bool decodeBlock(const char* text, uint8_t* bytes) noexcept
+{
+    const uint8x16x3_t chars = vld3q_u8(reinterpret_cast<const uint8_t*> (text));
+    uint8x16_t isHigh;
+    uint8x16_t isLow;
+    const uint8x16_t high = toNibbles(chars.val[0], isHigh);
+    const uint8x16_t low = toNibbles(chars.val[1], isLow);
+    const uint8x16_t isSpace = vceqq_u8(chars.val[2], vdupq_n_u8(' '));
+    if (!isAllSet(vandq_u8(vandq_u8(isHigh, isLow), isSpace)))
+    {
+        return false;
+    }
+    vst1q_u8(bytes, vorrq_u8(vshlq_n_u8(high, 4), low));
+    return true;
+}
+
+/**
+ * @return the upper case hex digits of 16 values below 16
+ */
+static inline uint8x16_t toDigits(uint8x16_t nibbles) noexcept
+{
+    const uint8x16_t offset = vbslq_u8(vcgtq_u8(nibbles, vdupq_n_u8(9)), vdupq_n_u8('A' - 10), vdupq_n_u8('0'));
+    return vaddq_u8(nibbles, offset);
+}
+
+/**
+ * Encodes 16 bytes into 48 characters "HH HH ... HH ", `vst3q_u8()`
+ * interleaves the high digits, the low digits and the spaces.
+ */
+static inline void encodeBlock(const uint8_t* bytes, char* text) noexcept
+{
+    const uint8x16_t values = vld1q_u8(bytes);
+    uint8x16x3_t chars;
+    chars.val[0] = toDigits(vshrq_n_u8(values, 4));
+    chars.val[1] = toDigits(vandq_u8(values, vdupq_n_u8(0x0F)));
+    chars.val[2] = vdupq_n_u8(' ');
+    vst3q_u8(reinterpret_cast<uint8_t*> (text), chars);
+}
+
+#endif
+
+/**
+ * Decodes a literal hex string (e.g. "62 F1 90") in one pass. Spaces are
+ * skipped anywhere, the other characters are taken in pairs; pairs with
+ * characters which are no hex digits are converted as by `strtol()` (e.g.
+ * "6h" = 0x06), and a single digit at the end is a byte of its own.
+ *
+ * @param text: the literal hex string
+ * @param bytes: receives the bytes, must have room for
+ *               `getMaxDecodedSize(text)` bytes
+ * @return the number of written bytes
+ */
+size_t hex_codec::decode(string_view text, uint8_t* bytes) noexcept
+{
+    const char* pos = text.data();
+    const char* const end = pos + text.size();
+    uint8_t* out = bytes;
+#if defined(HEX_CODEC_SSE2) || defined(HEX_CODEC_NEON)
+    // after a block in another layout, the next bytes are decoded by the
+    // tables, so an unspaced string is not checked for a block at every byte
+    size_t tableBytes = 0;
+#endif
+    while (true)
+    {
+        while (pos != end && *pos == ' ')
+        {
+            ++pos;
+        }
+        if (pos == end)
+        {
+            break;
+        }
+#if defined(HEX_CODEC_SSE2) || defined(HEX_CODEC_NEON)
+        if (tableBytes == 0 && size_t(end - pos) >= BLOCK_CHARS)
+        {
+            if (decodeBlock(pos, out))
+            {
+                pos += BLOCK_CHARS;
+                out += BLOCK_BYTES;
+                continue;
+            }
+            tableBytes = BLOCK_BYTES;
+        }
+        else if (tableBytes > 0)
+        {
+            --tableBytes;
+        }
+#endif
+        const char high = *pos++;
+        while (pos != end && *pos == ' ')
+        {
+            ++pos;
+        }
+        if (pos == end)
+        {
+            *out++ = decodeDigit(high);
+            break;
+        }
+        *out++ = decodePair(high, *pos++);
+    }
+    return size_t(out - bytes);
+}
+
+/**
+ * Decodes a literal hex string into the given vector, which keeps its
+ * capacity, so decoding into a reused vector does not allocate.
+ *
+ * @param text: the literal hex string
+ * @param bytes: replaced by the bytes
+ */
+void hex_codec::decode(string_view text, vector<uint8_t>& bytes)
+{
+    bytes.resize(getMaxDecodedSize(text));
+    bytes.resize(decode(text, bytes.data()));
+}
+
+/**
+ * Encodes bytes into upper case hex digits separated by spaces (e.g.
+ * "62 F1 90"), without a leading or trailing space.
+ *
+ * @param bytes: the bytes
+ * @param length: the number of bytes
+ * @param text: receives `getEncodedSize(length)` characters, not terminated
+ */
+void hex_codec::encode(const uint8_t* bytes, size_t length, char* text) noexcept
+{
+    size_t i = 0;
+#if defined(HEX_CODEC_NEON)
+    // a block writes the space after its last byte, so the last byte is left
+    for (; i + BLOCK_BYTES < length; i += BLOCK_BYTES)
+    {
+        encodeBlock(bytes + i, text);
+        text += BLOCK_CHARS;
+    }
+#endif
+    // SSE2 lacks the byte shuffles to interleave the spaces, the table is as fast
+    for (; i < length; ++i)
+    {
+        memcpy(text, TABLES.digits[bytes[i]], 2);
+        text += 2;
+        if (i + 1 < length)
+        {
+            *text++ = ' ';
+        }
+    }
+}
+
+/**
+ * Encodes bytes like the variant above into the given string, which keeps
+ * its capacity.
+ *
+ * @param bytes: the bytes
+ * @param length: the number of bytes
+ * @param text: replaced by the literal hex string
+ */
+void hex_codec::encode(const uint8_t* bytes, size_t length, string& text)
+{
+    text.resize(getEncodedSize(length));
+    encode(bytes, length, text.data());
+}
+
+/**
+ * @return true if the character separates the bytes of a table key, i.e. is
+ *         one of "_.,; #" or a tab
+ */
+bool hex_codec::isSeparator(char c) noexcept
+{
+    return TABLES.separators[uint8_t(c)];
+}
+
+/**
+ * Removes all separators from a table key, see `isSeparator()`.
+ *
+ * @param text: the key, e.g. "22_F1_90"
+ */
+void hex_codec::removeSeparators(string& text) noexcept
+{
+    text.erase(remove_if(text.begin(), text.end(), isSeparator), text.end());
+}
@@ -0,0 +1,54 @@
+/**
+ * @file hex_codec.h
+ *
+ */
+
+#ifndef HEX_CODEC_H
+#define HEX_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Conversions between bytes and the literal hex strings of the Lua scripts
+ * (e.g. "62 F1 90"), which are done on every request that is not answered by
+ * a precompiled or binary response.
+ *
+ * The common layout of two digits and a space per byte is decoded and encoded
+ * 16 bytes at a time with SSE2 (x86-64) or NEON (ARM), which every CPU of
+ * these architectures has, so no runtime dispatch is needed. Any other
+ * layout, and the rest of a string, is converted by table lookups. The
+ * results are the same in all cases.
+ */
+namespace hex_codec
+{
+    /**
+     * @param text: a literal hex string
+     * @return the max. number of bytes `decode()` writes for the string
+     */
+    inline std::size_t getMaxDecodedSize(std::string_view text) noexcept
+    {
+        return (text.size() + 1) / 2;
+    }
+
+    /**
+     * @param length: the number of bytes
+     * @return the length of their literal hex string, see `encode()`
+     */
+    inline std::size_t getEncodedSize(std::size_t length) noexcept
+    {
+        return length == 0 ? 0 : length * 3 - 1;
+    }
+
+    std::size_t decode(std::string_view text, std::uint8_t* bytes) noexcept;
+    void decode(std::string_view text, std::vector<std::uint8_t>& bytes);
+    void encode(const std::uint8_t* bytes, std::size_t length, char* text) noexcept;
+    void encode(const std::uint8_t* bytes, std::size_t length, std::string& text);
+    bool isSeparator(char c) noexcept;
+    void removeSeparators(std::string& text) noexcept;
+}
+
+#endif /* HEX_CODEC_H */
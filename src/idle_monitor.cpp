@@ -0,0 +1,131 @@
+/**
+ * @file idle_monitor.cpp
+ *
+ * The sleep mode of the simulator, see `IdleMonitor`.
+ */
+
+#include "idle_monitor.h"
+#include "logger.h"
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * @return the monitor shared by all receivers and senders
+ */
+IdleMonitor& IdleMonitor::getInstance()
+{
+    static IdleMonitor monitor;
+    return monitor;
+}
+
+/**
+ * Constructor. The simulator is awake and never falls asleep until a
+ * timeout is configured.
+ *
+ * @param wheel: the timer wheel measuring the timeout
+ */
+IdleMonitor::IdleMonitor(TimerWheel& wheel)
+: timer_(wheel, [this]() { fallAsleep("No traffic received"); })
+{
+}
+
+/**
+ * Sets the time without received traffic after which the simulator falls
+ * asleep, measured from now on.
+ *
+ * @param timeout: the timeout, 0 = never fall asleep
+ */
+void IdleMonitor::configure(chrono::milliseconds timeout)
+{
+    timeoutMs_ = max<int64_t>(timeout.count(), 0);
+    if (timeoutMs_ > 0)
+    {
+        if (isAwake())
+        {
+            timer_.schedule(timeout);
+        }
+        return;
+    }
+    timer_.cancel();
+    wakeUp();
+}
+
+/**
+ * Reports that a CAN interface went bus-off or error-passive. The simulator
+ * falls asleep right away, unless no timeout is configured.
+ */
+void IdleMonitor::notifyBusError() noexcept
+{
+    fallAsleep("Bus error");
+}
+
+/**
+ * Registers a listener, which is called when the simulator falls asleep or
+ * wakes up. It is called on the thread changing the state (e.g. a receiver
+ * or the timer wheel) and must neither change the state itself nor wait for
+ * a thread which calls `notifyActivity()`.
+ *
+ * @param listener: the listener
+ * @return the ID for `removeListener()`
+ */
+int IdleMonitor::addListener(Listener listener)
+{
+    lock_guard<mutex> lock(mutex_);
+    listeners_[nextListenerId_] = move(listener);
+    return nextListenerId_++;
+}
+
+/**
+ * Removes a listener. It is not called anymore after returning.
+ *
+ * @param id: the ID returned by `addListener()`
+ */
+void IdleMonitor::removeListener(int id)
+{
+    lock_guard<mutex> lock(mutex_);
+    listeners_.erase(id);
+}
+
+void IdleMonitor::wakeUp() noexcept
+{
+    lock_guard<mutex> lock(mutex_);
+    if (!isAsleep_)
+    {
+        return;
+    }
+    isAsleep_ = false;
+    LOG_INFO("Traffic received, waking up");
+    notifyListeners(true);
+    if (timeoutMs_ > 0)
+    {
+        timer_.schedule(getTimeout());
+    }
+}
+
+/**
+ * @param reason: the reason for the log
+ */
+void IdleMonitor::fallAsleep(const char* reason) noexcept
+{
+    lock_guard<mutex> lock(mutex_);
+    if (isAsleep_ || timeoutMs_ == 0)
+    {
+        return;
+    }
+    isAsleep_ = true;
+    sleepCount_.fetch_add(1, memory_order_relaxed);
+    LOG_INFO(reason << ", falling asleep until the next traffic");
+    notifyListeners(false);
+}
+
+/**
+ * Calls the listeners, the lock must be held.
+ */
+void IdleMonitor::notifyListeners(bool isAwake) noexcept
+{
+    for (const auto& listener : listeners_)
+    {
+        listener.second(isAwake);
+    }
+}
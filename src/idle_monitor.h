@@ -0,0 +1,92 @@
+/**
+ * @file idle_monitor.h
+ *
+ */
+
+#ifndef IDLE_MONITOR_H
+#define IDLE_MONITOR_H
+
+#include "timer_wheel.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+
+/**
+ * The sleep mode of the simulator, similar to the network management of a
+ * real ECU: after `IdleTimeout` without received traffic, or when a CAN
+ * interface goes bus-off or error-passive, the simulator falls asleep and
+ * wakes up again on the first received frame, request or DoIP connection.
+ *
+ * The receivers report every received message with `notifyActivity()`,
+ * which only postpones a timer of the `TimerWheel` and costs no wakeup of
+ * its own. The components sending on their own register a listener, which
+ * is called when the simulator falls asleep or wakes up: the
+ * `J1939CyclicScheduler` parks its thread, the `CanFrameBus` deletes its
+ * cyclic frames from the broadcast manager and the `BusStateMonitor` stops
+ * polling the bus state and receives all frames of its interface instead,
+ * to wake the simulator up on any traffic.
+ *
+ * Without a timeout, the simulator never falls asleep.
+ */
+class IdleMonitor
+{
+public:
+    /// called with the new state, see `addListener()`
+    using Listener = std::function<void(bool isAwake)>;
+
+    static IdleMonitor& getInstance();
+
+    explicit IdleMonitor(TimerWheel& wheel = TimerWheel::getInstance());
+    IdleMonitor(const IdleMonitor& orig) = delete;
+    IdleMonitor& operator =(const IdleMonitor& orig) = delete;
+    virtual ~IdleMonitor() = default;
+
+    void configure(std::chrono::milliseconds timeout);
+    std::chrono::milliseconds getTimeout() const noexcept
+    {
+        return std::chrono::milliseconds(timeoutMs_.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * Reports received traffic: restarts the timeout or wakes the simulator
+     * up. Cheap enough to be called for every received message.
+     */
+    void notifyActivity() noexcept
+    {
+        if (isAsleep_.load(std::memory_order_relaxed))
+        {
+            wakeUp();
+        }
+        else
+        {
+            timer_.postpone(getTimeout());
+        }
+    }
+
+    void notifyBusError() noexcept;
+    bool isAwake() const noexcept { return !isAsleep_.load(std::memory_order_relaxed); }
+    std::uint64_t getSleepCount() const noexcept { return sleepCount_.load(std::memory_order_relaxed); }
+
+    int addListener(Listener listener);
+    void removeListener(int id);
+
+private:
+    std::atomic<std::int64_t> timeoutMs_{0}; ///< 0 = never fall asleep
+    std::atomic<bool> isAsleep_{false};
+    std::atomic<std::uint64_t> sleepCount_{0};
+    /// serializes the changes, so the listeners are called in order
+    std::mutex mutex_;
+    std::map<int, Listener> listeners_;
+    int nextListenerId_ = 0;
+    /// destroyed first, so its callback never runs on a destroyed monitor
+    TimerWheel::Timer timer_;
+
+    void wakeUp() noexcept;
+    void fallAsleep(const char* reason) noexcept;
+    void notifyListeners(bool isAwake) noexcept;
+};
+
+#endif /* IDLE_MONITOR_H */
@@ -0,0 +1,62 @@
+/**
+ * @file isotp_configuration.cpp
+ *
+ * Applies the `IsoTpConfiguration` of an ECU to its ISO-TP sockets.
+ */
+
+#include "isotp_configuration.h"
+#include "can/isotp.h"
+#include "logger.h"
+#include <linux/can.h>
+#include <sys/socket.h>
+#include <cerrno>
+#include <cstring>
+
+using namespace std;
+
+/**
+ * Sets the addressing, padding and link layer options of an ISO-TP socket.
+ * Each socket gets its own options, so ECUs on the same interface may use
+ * different settings. This has to be done before the socket is bound.
+ *
+ * @param skt: the unbound ISO-TP socket
+ * @param configuration: the settings of the ECU
+ * @return 0 on success, otherwise a negative value
+ */
+int setIsoTpOptions(int skt, const IsoTpConfiguration& configuration) noexcept
+{
+    struct can_isotp_options opts = {};
+    opts.flags = CAN_ISOTP_TX_PADDING | CAN_ISOTP_RX_PADDING;
+    opts.txpad_content = configuration.padding;
+    opts.rxpad_content = configuration.padding;
+    if (configuration.extendedAddress)
+    {
+        opts.flags |= CAN_ISOTP_EXTEND_ADDR;
+        opts.ext_address = *configuration.extendedAddress;
+        if (configuration.rxExtendedAddress)
+        {
+            opts.flags |= CAN_ISOTP_RX_EXT_ADDR;
+            opts.rx_ext_address = *configuration.rxExtendedAddress;
+        }
+    }
+    if (setsockopt(skt, SOL_CAN_ISOTP, CAN_ISOTP_OPTS, &opts, sizeof(opts)) < 0)
+    {
+        LOG_ERROR(__func__ << "() setsockopt CAN_ISOTP_OPTS: " << strerror(errno));
+        return -1;
+    }
+
+    if (configuration.isCanFd)
+    {
+        struct can_isotp_ll_options llOpts = {};
+        llOpts.mtu = CANFD_MTU;
+        llOpts.tx_dl = configuration.txDataLength;
+        llOpts.tx_flags = configuration.isBitRateSwitch ? CANFD_BRS : 0;
+        if (setsockopt(skt, SOL_CAN_ISOTP, CAN_ISOTP_LL_OPTS, &llOpts, sizeof(llOpts)) < 0)
+        {
+            LOG_ERROR(__func__ << "() setsockopt CAN_ISOTP_LL_OPTS (TX_DL " << unsigned(llOpts.tx_dl)
+                      << "): " << strerror(errno));
+            return -2;
+        }
+    }
+    return 0;
+}
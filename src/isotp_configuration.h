@@ -0,0 +1,45 @@
+/**
+ * @file isotp_configuration.h
+ *
+ */
+
+#ifndef ISOTP_CONFIGURATION_H
+#define ISOTP_CONFIGURATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+constexpr std::size_t MAX_UDS_MSG_SIZE = 4096; ///< the default max. size of a UDS message
+
+/**
+ * The kernel settings of the ISO-TP sockets of an ECU, see the `IsoTp` table
+ * of the ECU. Except for the padding, which the simulator always enables, the
+ * defaults are the ones of the kernel.
+ */
+struct IsoTpConfiguration
+{
+    /// the block size of the flow control frames sent by the ECU, 0 = no further flow control
+    std::uint8_t blockSize = 0;
+    /// the STmin of the flow control frames sent by the ECU (0x00-0x7F ms, 0xF1-0xF9 100-900 µs)
+    std::uint8_t stMin = 0;
+    /// the max. number of wait frames, 0 = wait frames are not supported
+    std::uint8_t maxWaitFrames = 0;
+    /// the receive buffer of the socket in bytes (`SO_RCVBUF`), 0 = the kernel default
+    int receiveBufferSize = 0;
+    bool isCanFd = false; ///< send CAN FD frames
+    /// the max. payload of the sent frames: 8, 12, 16, 20, 24, 32, 48 or 64 with CAN FD
+    std::uint8_t txDataLength = 8;
+    bool isBitRateSwitch = false; ///< sets the BRS flag of the sent CAN FD frames
+    std::uint8_t padding = 0x00; ///< the byte the frames are padded with
+    /// the address byte of the sent frames, no extended addressing if empty
+    std::optional<std::uint8_t> extendedAddress;
+    /// the address byte of the received frames if it differs from `extendedAddress`
+    std::optional<std::uint8_t> rxExtendedAddress;
+    /// the max. size of a received or sent message, up to 4 GB with the ISO 15765-2:2016 escape sequence
+    std::size_t maxMessageSize = MAX_UDS_MSG_SIZE;
+};
+
+int setIsoTpOptions(int skt, const IsoTpConfiguration& configuration) noexcept;
+
+#endif /* ISOTP_CONFIGURATION_H */
@@ -0,0 +1,901 @@
+/**
+ * @file isotp_engine.cpp
+ *
+ * This file contains the user-space ISO-TP transport over `CAN_RAW`, which
+ * replaces the `can-isotp` kernel module if enabled.
+ */
+
+#include "isotp_engine.h"
+#include "bus_load_budget.h"
+#include "logger.h"
+#include "realtime_profile.h"
+#include "spsc_queue.h"
+#include "thread_placement.h"
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <limits>
+
+using namespace std;
+
+constexpr uint64_t NS_PER_US = 1000;
+constexpr uint64_t NS_PER_MS = 1000000;
+constexpr uint64_t NO_DEADLINE = numeric_limits<uint64_t>::max();
+constexpr uint64_t TIMEOUT_NS = 1000 * NS_PER_MS; ///< N_Bs and N_Cr, the defaults of the kernel module
+constexpr uint64_t RETRY_DELAY_NS = 250 * NS_PER_US; ///< the pause after the TX queue of the interface was full
+constexpr size_t RECEIVE_BATCH = 32; ///< frames per `recvmmsg()`
+constexpr size_t MAX_BURST = 16; ///< consecutive frames per channel and round without STmin
+constexpr size_t MAX_PENDING_FRAMES = 64; ///< no new frames are generated above
+
+constexpr uint8_t PCI_SINGLE_FRAME = 0x0;
+constexpr uint8_t PCI_FIRST_FRAME = 0x1;
+constexpr uint8_t PCI_CONSECUTIVE_FRAME = 0x2;
+constexpr uint8_t PCI_FLOW_CONTROL = 0x3;
+constexpr uint8_t FLOW_CONTINUE = 0x0;
+constexpr uint8_t FLOW_WAIT = 0x1;
+constexpr uint8_t FLOW_OVERFLOW = 0x2;
+constexpr size_t MAX_FIRST_FRAME_LENGTH = 0xFFF; ///< above, the 32 bit escape sequence is used
+
+/// a reassembled message, queued for the receiver thread
+struct ReceivedMessage
+{
+    vector<uint8_t> data;
+};
+
+/**
+ * The state of the CAN ID pair of an ECU (or a broadcast address), shared by
+ * its receiver and sender.
+ */
+struct IsoTpEngine::Channel
+{
+    enum class TxState
+    {
+        IDLE,
+        WAIT_FLOW_CONTROL,
+        SENDING
+    };
+
+    canid_t txId; ///< with `CAN_EFF_FLAG` for 29 bit IDs
+    canid_t rxId;
+    IsoTpConfiguration configuration;
+    int rxExtendedAddress = -1; ///< -1 without extended addressing
+    unsigned int receivers = 0;
+    unsigned int senders = 0;
+
+    /// counts the queued messages (`EFD_SEMAPHORE`), polled by the receiver thread
+    int receive_fd = -1;
+    SpscQueue<ReceivedMessage, ISOTP_ENGINE_QUEUE_SIZE> receiveQueue;
+
+    // reception, only used by the engine thread
+    vector<uint8_t> rxMessage;
+    size_t rxExpected = 0;
+    uint8_t rxSequenceNumber = 0;
+    uint8_t rxBlockCount = 0; ///< consecutive frames since the last flow control
+    bool isReceiving = false;
+    uint64_t rxTimeoutNs = 0;
+
+    // transmission, `txQueue` is a ring of reused buffers
+    array<vector<uint8_t>, ISOTP_ENGINE_QUEUE_SIZE> txQueue;
+    size_t txHead = 0;
+    size_t txCount = 0;
+    TxState txState = TxState::IDLE;
+    size_t txOffset = 0; ///< the bytes of the current message already sent
+    uint8_t txSequenceNumber = 0;
+    uint8_t txBlockRemaining = 0; ///< consecutive frames until the next flow control, 0 = unlimited
+    uint64_t txStMinNs = 0;
+    uint64_t txNextNs = 0; ///< the next consecutive frame or the flow control timeout
+
+    /// the max. payload of a sent frame
+    size_t getTxDataLength() const noexcept
+    {
+        return configuration.isCanFd ? configuration.txDataLength : CAN_MAX_DLEN;
+    }
+
+    /// the byte of the protocol control information, after the extended address
+    size_t getPciIndex() const noexcept
+    {
+        return configuration.extendedAddress ? 1 : 0;
+    }
+
+    void popMessage() noexcept
+    {
+        txHead = (txHead + 1) % txQueue.size();
+        --txCount;
+        txState = TxState::IDLE;
+    }
+};
+
+atomic<bool> IsoTpEngine::isEnabled_{false};
+mutex IsoTpEngine::registryMutex_;
+map<string, weak_ptr<IsoTpEngine>> IsoTpEngine::registry_;
+
+/**
+ * @param device: the CAN interface (e.g. "can0")
+ * @return the engine of the given interface, which is shared by all ECUs
+ */
+shared_ptr<IsoTpEngine> IsoTpEngine::getInstance(const string& device)
+{
+    lock_guard<mutex> lock(registryMutex_);
+    shared_ptr<IsoTpEngine> pEngine = registry_[device].lock();
+    if (!pEngine)
+    {
+        pEngine = make_shared<IsoTpEngine>(device);
+        registry_[device] = pEngine;
+    }
+    return pEngine;
+}
+
+/**
+ * Lets the ISO-TP receivers and senders opened afterwards use the engine
+ * instead of the kernel module. Disabled on default.
+ */
+void IsoTpEngine::setEnabled(bool isEnabled) noexcept
+{
+    isEnabled_ = isEnabled;
+}
+
+/**
+ * @return true if the receivers and senders use the engine
+ */
+bool IsoTpEngine::isEnabled() noexcept
+{
+    return isEnabled_;
+}
+
+/**
+ * Constructor. Opens the raw socket of the interface and starts the engine
+ * thread. Use `getInstance()` instead, which shares the engine between all
+ * ECUs on the interface.
+ *
+ * @param device: the CAN interface (e.g. "can0")
+ */
+IsoTpEngine::IsoTpEngine(const string& device)
+: device_(device)
+, pBudget_(BusLoadBudget::getInstance(device))
+{
+    skt_ = socket(PF_CAN, SOCK_RAW | SOCK_CLOEXEC, CAN_RAW);
+    timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    wakeup_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    struct sockaddr_can addr = {};
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = int(if_nametoindex(device.c_str()));
+    if (skt_ < 0 || timer_fd_ < 0 || wakeup_fd_ < 0 || addr.can_ifindex == 0
+        || bind(skt_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        LOG_ERROR(__func__ << "() " << device << ": " << strerror(errno));
+        for (const int fd : {skt_, timer_fd_, wakeup_fd_})
+        {
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+        }
+        throw exception();
+    }
+
+    const int isEnabled = 1;
+    isCanFdEnabled_ = setsockopt(skt_, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &isEnabled, sizeof(isEnabled)) == 0;
+    if (!isCanFdEnabled_)
+    {
+        LOG_WARNING("No CAN FD frames on " << device << ": " << strerror(errno));
+    }
+    updateFilter();
+
+    rxFrames_.resize(RECEIVE_BATCH);
+    messages_.resize(RECEIVE_BATCH);
+    iovecs_.resize(RECEIVE_BATCH);
+    outFrames_.reserve(MAX_PENDING_FRAMES + MAX_BURST);
+    thread_ = thread(&IsoTpEngine::run, this);
+}
+
+/**
+ * Destructor. Stops the engine thread. The channels have to be closed
+ * before.
+ */
+IsoTpEngine::~IsoTpEngine()
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        isOnExit_ = true;
+    }
+    wakeup();
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+    for (const auto& channel : channels_)
+    {
+        close(channel.second->receive_fd);
+    }
+    close(skt_);
+    close(timer_fd_);
+    close(wakeup_fd_);
+}
+
+/**
+ * Opens the channel of a CAN ID pair. The receiver and the sender of an ECU
+ * share the channel, so the flow control frames of the tester reach the
+ * sender.
+ *
+ * @param txId: the CAN ID of the sent frames
+ * @param rxId: the CAN ID of the received frames
+ * @param configuration: the transport settings of the ECU
+ * @param isReceiver: true for the receiver, false for the sender
+ * @return the channel or `nullptr` if the received CAN ID is already used
+ *         with another sent CAN ID
+ * @see IsoTpEngine::closeChannel()
+ */
+IsoTpEngine::Channel* IsoTpEngine::openChannel(canid_t txId, canid_t rxId, const IsoTpConfiguration& configuration,
+                                               bool isReceiver) noexcept
+{
+    const canid_t tx = txId > CAN_SFF_MASK ? txId | CAN_EFF_FLAG : txId;
+    const canid_t rx = rxId > CAN_SFF_MASK ? rxId | CAN_EFF_FLAG : rxId;
+    int rxExtendedAddress = -1;
+    if (configuration.extendedAddress)
+    {
+        rxExtendedAddress = configuration.rxExtendedAddress.value_or(*configuration.extendedAddress);
+    }
+    if (configuration.isCanFd && !isCanFdEnabled_)
+    {
+        LOG_ERROR(__func__ << "() " << device_ << " does not support CAN FD frames");
+        return nullptr;
+    }
+
+    lock_guard<mutex> lock(mutex_);
+    unique_ptr<Channel>& pChannel = channels_[getKey(rx, rxExtendedAddress)];
+    if (!pChannel)
+    {
+        pChannel.reset(new Channel());
+        pChannel->txId = tx;
+        pChannel->rxId = rx;
+        pChannel->configuration = configuration;
+        pChannel->rxExtendedAddress = rxExtendedAddress;
+        pChannel->receive_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK | EFD_SEMAPHORE);
+        if (pChannel->receive_fd < 0)
+        {
+            LOG_ERROR(__func__ << "() eventfd: " << strerror(errno));
+            channels_.erase(getKey(rx, rxExtendedAddress));
+            return nullptr;
+        }
+        updateFilter();
+    }
+    else if (pChannel->txId != tx)
+    {
+        LOG_ERROR(__func__ << "() CAN ID " << hex << rxId << " is already used on " << device_);
+        return nullptr;
+    }
+    ++(isReceiver ? pChannel->receivers : pChannel->senders);
+    return pChannel.get();
+}
+
+/**
+ * Closes the receiver or sender side of a channel. The channel is deleted
+ * with its last side, pending messages are dropped.
+ *
+ * @param pChannel: the channel returned by `openChannel()`
+ * @param isReceiver: the side passed to `openChannel()`
+ */
+void IsoTpEngine::closeChannel(Channel* pChannel, bool isReceiver) noexcept
+{
+    lock_guard<mutex> lock(mutex_);
+    --(isReceiver ? pChannel->receivers : pChannel->senders);
+    if (pChannel->receivers > 0 || pChannel->senders > 0)
+    {
+        return;
+    }
+    close(pChannel->receive_fd);
+    channels_.erase(getKey(pChannel->rxId, pChannel->rxExtendedAddress));
+    updateFilter();
+}
+
+/**
+ * @return the file descriptor which is readable while received messages are
+ *         queued, see `receive()`
+ */
+int IsoTpEngine::getReceiveFd(const Channel* pChannel) const noexcept
+{
+    return pChannel->receive_fd;
+}
+
+/**
+ * Takes the oldest received message of a channel without blocking. Must only
+ * be called by one thread at a time, the receiver of the channel.
+ *
+ * @param pChannel: the channel returned by `openChannel()`
+ * @param buffer: filled with the message
+ * @param size: the size of the buffer, longer messages are truncated
+ * @return the number of bytes in the buffer or -1 with `errno` set to
+ *         `EAGAIN` if no message is queued
+ */
+ssize_t IsoTpEngine::receive(Channel* pChannel, uint8_t* buffer, size_t size) noexcept
+{
+    uint64_t value;
+    if (read(pChannel->receive_fd, &value, sizeof(value)) < 0)
+    {
+        return -1;
+    }
+    ReceivedMessage* pMessage = pChannel->receiveQueue.front();
+    if (pMessage == nullptr)
+    {
+        errno = EAGAIN;
+        return -1;
+    }
+    const size_t length = min(size, pMessage->data.size());
+    copy_n(pMessage->data.cbegin(), length, buffer);
+    pChannel->receiveQueue.pop();
+    return ssize_t(length);
+}
+
+/**
+ * Queues a message for sending. The engine thread sends it as soon as the
+ * previous messages of the channel are sent.
+ *
+ * @param pChannel: the channel returned by `openChannel()`
+ * @param buffer: the message
+ * @param size: the length of the message
+ * @return the number of queued bytes or a negative value if the queue of
+ *         the channel is full
+ */
+int IsoTpEngine::send(Channel* pChannel, const void* buffer, size_t size) noexcept
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        if (pChannel->txCount == pChannel->txQueue.size())
+        {
+            return -1;
+        }
+        vector<uint8_t>& message = pChannel->txQueue[(pChannel->txHead + pChannel->txCount) % pChannel->txQueue.size()];
+        const uint8_t* bytes = static_cast<const uint8_t*>(buffer);
+        message.assign(bytes, bytes + size);
+        ++pChannel->txCount;
+    }
+    wakeup();
+    return int(size);
+}
+
+uint64_t IsoTpEngine::getNowNs() noexcept
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return uint64_t(now.tv_sec) * 1000000000ull + uint64_t(now.tv_nsec);
+}
+
+/**
+ * @param rxId: the received CAN ID, with `CAN_EFF_FLAG` for 29 bit IDs
+ * @param extendedAddress: the first byte of the received frames, -1 without
+ *                         extended addressing
+ * @return the key of the channel in `channels_`
+ */
+uint64_t IsoTpEngine::getKey(canid_t rxId, int extendedAddress) noexcept
+{
+    return (uint64_t(rxId) << 16) | (extendedAddress >= 0 ? 0x100u | unsigned(extendedAddress) : 0u);
+}
+
+/**
+ * @return the STmin of a flow control frame in ns. The reserved values mean
+ *         127 ms, like in the kernel module.
+ */
+uint64_t IsoTpEngine::decodeStMin(uint8_t stMin) noexcept
+{
+    if (stMin <= 0x7F)
+    {
+        return stMin * NS_PER_MS;
+    }
+    if (stMin >= 0xF1 && stMin <= 0xF9)
+    {
+        return (stMin - 0xF0) * 100 * NS_PER_US;
+    }
+    return 0x7F * NS_PER_MS;
+}
+
+/**
+ * Lets the socket only receive the CAN IDs of the channels. The engine lock
+ * must be held.
+ */
+void IsoTpEngine::updateFilter() noexcept
+{
+    vector<struct can_filter> filters;
+    for (const auto& channel : channels_)
+    {
+        const canid_t rxId = channel.second->rxId;
+        const canid_t mask = (rxId & CAN_EFF_FLAG) ? CAN_EFF_FLAG | CAN_RTR_FLAG | CAN_EFF_MASK
+                                                   : CAN_EFF_FLAG | CAN_RTR_FLAG | CAN_SFF_MASK;
+        filters.push_back({rxId, mask});
+    }
+    // without filters, nothing is received
+    if (setsockopt(skt_, SOL_CAN_RAW, CAN_RAW_FILTER, filters.data(),
+                   socklen_t(filters.size() * sizeof(struct can_filter))) < 0)
+    {
+        LOG_ERROR(__func__ << "() setsockopt CAN_RAW_FILTER: " << strerror(errno));
+    }
+}
+
+void IsoTpEngine::wakeup() noexcept
+{
+    const uint64_t value = 1;
+    if (write(wakeup_fd_, &value, sizeof(value)) < 0)
+    {
+        LOG_ERROR(__func__ << "() write: " << strerror(errno));
+    }
+}
+
+/**
+ * Reads a batch of frames with `recvmmsg()` and passes them to the state
+ * machines of their channels. Called without the engine lock.
+ */
+void IsoTpEngine::receiveFrames(uint64_t nowNs) noexcept
+{
+    for (size_t i = 0; i < RECEIVE_BATCH; ++i)
+    {
+        iovecs_[i].iov_base = &rxFrames_[i];
+        iovecs_[i].iov_len = sizeof(struct canfd_frame);
+        messages_[i] = {};
+        messages_[i].msg_hdr.msg_iov = &iovecs_[i];
+        messages_[i].msg_hdr.msg_iovlen = 1;
+    }
+    const int received = recvmmsg(skt_, messages_.data(), RECEIVE_BATCH, MSG_DONTWAIT, nullptr);
+    if (received < 0)
+    {
+        if (errno != EAGAIN && errno != EINTR)
+        {
+            LOG_ERROR(__func__ << "() recvmmsg: " << strerror(errno));
+        }
+        return;
+    }
+
+    lock_guard<mutex> lock(mutex_);
+    for (int i = 0; i < received; ++i)
+    {
+        const unsigned int mtu = messages_[i].msg_len;
+        if (mtu == CAN_MTU || mtu == CANFD_MTU)
+        {
+            handleFrame(rxFrames_[i], nowNs);
+        }
+    }
+}
+
+/**
+ * Runs the state machine of the channel of a received frame. The engine lock
+ * must be held.
+ */
+void IsoTpEngine::handleFrame(const struct canfd_frame& frame, uint64_t nowNs) noexcept
+{
+    auto iter = channels_.find(getKey(frame.can_id, -1));
+    if (iter == channels_.end() && frame.len > 0)
+    {
+        iter = channels_.find(getKey(frame.can_id, frame.data[0]));
+    }
+    if (iter == channels_.end())
+    {
+        return;
+    }
+    Channel& channel = *iter->second;
+    const size_t pciIndex = channel.rxExtendedAddress >= 0 ? 1 : 0;
+    if (frame.len <= pciIndex)
+    {
+        return;
+    }
+    const uint8_t* data = frame.data + pciIndex;
+    const size_t length = frame.len - pciIndex;
+
+    switch (data[0] >> 4)
+    {
+    case PCI_SINGLE_FRAME:
+    {
+        // the length is in the 2nd byte for CAN FD frames of more than 8 bytes
+        size_t messageLength = data[0] & 0x0F;
+        size_t start = 1;
+        if (messageLength == 0 && frame.len > CAN_MAX_DLEN && length > 1)
+        {
+            messageLength = data[1];
+            start = 2;
+        }
+        if (messageLength == 0 || start + messageLength > length)
+        {
+            return;
+        }
+        channel.isReceiving = false;
+        deliver(channel, data + start, messageLength);
+        return;
+    }
+    case PCI_FIRST_FRAME:
+    {
+        if (length < 2)
+        {
+            return;
+        }
+        size_t expected = (size_t(data[0] & 0x0F) << 8) | data[1];
+        size_t start = 2;
+        if (expected == 0 && length >= 6)
+        {
+            expected = (size_t(data[2]) << 24) | (size_t(data[3]) << 16) | (size_t(data[4]) << 8) | data[5];
+            start = 6;
+        }
+        if (expected > channel.configuration.maxMessageSize)
+        {
+            LOG_WARNING("Rejecting a message of " << dec << expected << " bytes on " << hex << channel.rxId);
+            sendFlowControl(channel, FLOW_OVERFLOW);
+            return;
+        }
+        if (expected <= length - start || channel.receivers == 0)
+        {
+            return;
+        }
+        channel.rxMessage.assign(data + start, data + length);
+        channel.rxExpected = expected;
+        channel.rxSequenceNumber = 1;
+        channel.rxBlockCount = 0;
+        channel.isReceiving = true;
+        channel.rxTimeoutNs = nowNs + TIMEOUT_NS;
+        sendFlowControl(channel, FLOW_CONTINUE);
+        return;
+    }
+    case PCI_CONSECUTIVE_FRAME:
+    {
+        if (!channel.isReceiving)
+        {
+            return;
+        }
+        if ((data[0] & 0x0F) != channel.rxSequenceNumber)
+        {
+            LOG_WARNING("Wrong sequence number on " << hex << channel.rxId << ", dropping the message");
+            channel.isReceiving = false;
+            return;
+        }
+        channel.rxSequenceNumber = (channel.rxSequenceNumber + 1) & 0x0F;
+        const size_t count = min(length - 1, channel.rxExpected - channel.rxMessage.size());
+        channel.rxMessage.insert(channel.rxMessage.end(), data + 1, data + 1 + count);
+        if (channel.rxMessage.size() == channel.rxExpected)
+        {
+            channel.isReceiving = false;
+            deliver(channel, channel.rxMessage.data(), channel.rxMessage.size());
+            return;
+        }
+        channel.rxTimeoutNs = nowNs + TIMEOUT_NS;
+        if (channel.configuration.blockSize > 0 && ++channel.rxBlockCount == channel.configuration.blockSize)
+        {
+            channel.rxBlockCount = 0;
+            sendFlowControl(channel, FLOW_CONTINUE);
+        }
+        return;
+    }
+    case PCI_FLOW_CONTROL:
+        handleFlowControl(channel, data, length, nowNs);
+        return;
+    default:
+        return;
+    }
+}
+
+/**
+ * Continues, delays or aborts the message being sent by the channel.
+ */
+void IsoTpEngine::handleFlowControl(Channel& channel, const uint8_t* data, size_t length, uint64_t nowNs) noexcept
+{
+    if (channel.txState != Channel::TxState::WAIT_FLOW_CONTROL || length < 3)
+    {
+        return;
+    }
+    switch (data[0] & 0x0F)
+    {
+    case FLOW_CONTINUE:
+        channel.txState = Channel::TxState::SENDING;
+        channel.txBlockRemaining = data[1];
+        channel.txStMinNs = decodeStMin(data[2]);
+        channel.txNextNs = nowNs;
+        break;
+    case FLOW_WAIT:
+        channel.txNextNs = nowNs + TIMEOUT_NS;
+        break;
+    default:
+        LOG_WARNING("Flow control " << hex << unsigned(data[0]) << " on " << channel.rxId << ", dropping the message");
+        channel.popMessage();
+        break;
+    }
+}
+
+/**
+ * Queues a received message for the receiver thread of the channel.
+ */
+void IsoTpEngine::deliver(Channel& channel, const uint8_t* data, size_t length) noexcept
+{
+    if (channel.receivers == 0)
+    {
+        return;
+    }
+    ReceivedMessage* pMessage = channel.receiveQueue.prepareBack();
+    if (pMessage == nullptr)
+    {
+        LOG_WARNING("Receive queue of " << hex << channel.rxId << " is full, dropping message!");
+        return;
+    }
+    pMessage->data.assign(data, data + length);
+    channel.receiveQueue.commitBack();
+    const uint64_t value = 1;
+    if (write(channel.receive_fd, &value, sizeof(value)) < 0)
+    {
+        LOG_ERROR(__func__ << "() write: " << strerror(errno));
+    }
+}
+
+/**
+ * Appends a frame of the channel to the frames to send, filled with the
+ * padding byte and starting with the extended address, if any. The frame
+ * has to be completed with `finishFrame()`.
+ *
+ * @param pciIndex: set to the index of the protocol control information
+ * @return the appended frame
+ */
+struct canfd_frame& IsoTpEngine::appendFrame(const Channel& channel, size_t& pciIndex)
+{
+    outFrames_.emplace_back();
+    OutFrame& out = outFrames_.back();
+    out.isCanFd = channel.configuration.isCanFd;
+    out.frame = {};
+    out.frame.can_id = channel.txId;
+    if (out.isCanFd && channel.configuration.isBitRateSwitch)
+    {
+        out.frame.flags = CANFD_BRS;
+    }
+    memset(out.frame.data, channel.configuration.padding, sizeof(out.frame.data));
+    pciIndex = channel.getPciIndex();
+    if (channel.configuration.extendedAddress)
+    {
+        out.frame.data[0] = *channel.configuration.extendedAddress;
+    }
+    return out.frame;
+}
+
+/**
+ * Sets the length of the last appended frame and counts it in the bus load
+ * budget. The frames are padded to 8 bytes, CAN FD frames to the next valid
+ * length.
+ *
+ * @param length: the used bytes of the frame
+ */
+void IsoTpEngine::finishFrame(size_t length) noexcept
+{
+    static constexpr uint8_t CANFD_LENGTHS[] = {8, 12, 16, 20, 24, 32, 48, 64};
+    OutFrame& out = outFrames_.back();
+    uint8_t frameLength = CAN_MAX_DLEN;
+    if (out.isCanFd)
+    {
+        frameLength = *lower_bound(begin(CANFD_LENGTHS), end(CANFD_LENGTHS), uint8_t(min(length, size_t(CANFD_MAX_DLEN))));
+    }
+    out.frame.len = frameLength;
+    pBudget_->consume(BusLoadBudget::getFrameBits(out.frame.can_id, frameLength), getNowNs());
+}
+
+/**
+ * Sends a flow control frame with the block size and STmin of the channel.
+ */
+void IsoTpEngine::sendFlowControl(const Channel& channel, uint8_t flowStatus)
+{
+    size_t pciIndex;
+    struct canfd_frame& frame = appendFrame(channel, pciIndex);
+    frame.data[pciIndex] = uint8_t((PCI_FLOW_CONTROL << 4) | flowStatus);
+    frame.data[pciIndex + 1] = channel.configuration.blockSize;
+    frame.data[pciIndex + 2] = channel.configuration.stMin;
+    finishFrame(pciIndex + 3);
+}
+
+/**
+ * Starts the next queued message or continues the current one with its
+ * consecutive frames, as far as the flow control of the tester allows.
+ */
+void IsoTpEngine::sendFrames(Channel& channel, uint64_t nowNs)
+{
+    const size_t txDataLength = channel.getTxDataLength();
+    const size_t pciIndex = channel.getPciIndex();
+
+    // single frames are sent right away, a first frame waits for the flow control
+    while (channel.txState == Channel::TxState::IDLE && channel.txCount > 0)
+    {
+        const vector<uint8_t>& message = channel.txQueue[channel.txHead];
+        const size_t maxSingleFrame = txDataLength > CAN_MAX_DLEN ? txDataLength - pciIndex - 2
+                                                                  : CAN_MAX_DLEN - pciIndex - 1;
+        size_t index;
+        struct canfd_frame& frame = appendFrame(channel, index);
+        if (message.size() <= maxSingleFrame)
+        {
+            if (message.size() <= CAN_MAX_DLEN - pciIndex - 1)
+            {
+                frame.data[index++] = uint8_t(message.size());
+            }
+            else
+            {
+                frame.data[index++] = 0;
+                frame.data[index++] = uint8_t(message.size());
+            }
+            copy(message.cbegin(), message.cend(), frame.data + index);
+            finishFrame(index + message.size());
+            channel.popMessage();
+            continue;
+        }
+
+        if (message.size() <= MAX_FIRST_FRAME_LENGTH)
+        {
+            frame.data[index++] = uint8_t((PCI_FIRST_FRAME << 4) | (message.size() >> 8));
+            frame.data[index++] = uint8_t(message.size());
+        }
+        else
+        {
+            frame.data[index++] = uint8_t(PCI_FIRST_FRAME << 4);
+            frame.data[index++] = 0;
+            for (int shift = 24; shift >= 0; shift -= 8)
+            {
+                frame.data[index++] = uint8_t(message.size() >> shift);
+            }
+        }
+        const size_t count = txDataLength - index;
+        copy_n(message.cbegin(), count, frame.data + index);
+        finishFrame(txDataLength);
+        channel.txOffset = count;
+        channel.txSequenceNumber = 1;
+        channel.txState = Channel::TxState::WAIT_FLOW_CONTROL;
+        channel.txNextNs = nowNs + TIMEOUT_NS;
+    }
+
+    // without STmin a burst of frames, otherwise one frame per period
+    size_t burst = channel.txStMinNs == 0 ? MAX_BURST : 1;
+    while (channel.txState == Channel::TxState::SENDING && channel.txNextNs <= nowNs && burst-- > 0)
+    {
+        const uint64_t delayNs = pBudget_->getDelayNs(BusLoadBudget::getFrameBits(channel.txId, txDataLength), nowNs);
+        if (delayNs > 0)
+        {
+            // the max. bus load is reached, the frame waits for its tokens
+            channel.txNextNs = nowNs + delayNs;
+            break;
+        }
+        const vector<uint8_t>& message = channel.txQueue[channel.txHead];
+        size_t index;
+        struct canfd_frame& frame = appendFrame(channel, index);
+        frame.data[index++] = uint8_t((PCI_CONSECUTIVE_FRAME << 4) | channel.txSequenceNumber);
+        const size_t count = min(txDataLength - index, message.size() - channel.txOffset);
+        copy_n(message.cbegin() + channel.txOffset, count, frame.data + index);
+        finishFrame(index + count);
+        channel.txOffset += count;
+        channel.txSequenceNumber = (channel.txSequenceNumber + 1) & 0x0F;
+
+        if (channel.txOffset == message.size())
+        {
+            channel.popMessage();
+        }
+        else if (channel.txBlockRemaining > 0 && --channel.txBlockRemaining == 0)
+        {
+            channel.txState = Channel::TxState::WAIT_FLOW_CONTROL;
+            channel.txNextNs = nowNs + TIMEOUT_NS;
+        }
+        else
+        {
+            channel.txNextNs = nowNs + channel.txStMinNs;
+        }
+    }
+}
+
+/**
+ * Handles the timeouts and generates the due frames of all channels. The
+ * engine lock must be held.
+ *
+ * @return the time the next frame is due or a timeout expires
+ */
+uint64_t IsoTpEngine::process(uint64_t nowNs)
+{
+    // the frames are only generated if the previous ones could be sent
+    const bool canSend = outFrames_.size() < MAX_PENDING_FRAMES && retryNs_ <= nowNs;
+    uint64_t deadlineNs = NO_DEADLINE;
+    for (const auto& entry : channels_)
+    {
+        Channel& channel = *entry.second;
+        if (channel.isReceiving && channel.rxTimeoutNs <= nowNs)
+        {
+            LOG_WARNING("Timeout receiving on " << hex << channel.rxId << ", dropping the message");
+            channel.isReceiving = false;
+        }
+        if (channel.isReceiving)
+        {
+            deadlineNs = min(deadlineNs, channel.rxTimeoutNs);
+        }
+        if (channel.txState == Channel::TxState::WAIT_FLOW_CONTROL && channel.txNextNs <= nowNs)
+        {
+            LOG_WARNING("No flow control on " << hex << channel.rxId << ", dropping the message");
+            channel.popMessage();
+        }
+        if (canSend)
+        {
+            sendFrames(channel, nowNs);
+        }
+        if (channel.txState != Channel::TxState::IDLE)
+        {
+            deadlineNs = min(deadlineNs, channel.txNextNs);
+        }
+        else if (channel.txCount > 0)
+        {
+            deadlineNs = nowNs;
+        }
+    }
+    // the frames have to wait for the interface
+    return canSend ? deadlineNs : max(deadlineNs, retryNs_);
+}
+
+/**
+ * Sends the pending frames with `sendmmsg()`. If the TX queue of the
+ * interface is full, the rest is sent after `RETRY_DELAY_NS`, since the
+ * socket does not tell when the queue has space again.
+ */
+void IsoTpEngine::flushFrames(uint64_t nowNs) noexcept
+{
+    size_t numSent = 0;
+    while (numSent < outFrames_.size())
+    {
+        const size_t count = min(outFrames_.size() - numSent, messages_.size());
+        for (size_t i = 0; i < count; ++i)
+        {
+            OutFrame& out = outFrames_[numSent + i];
+            iovecs_[i].iov_base = &out.frame;
+            iovecs_[i].iov_len = out.isCanFd ? CANFD_MTU : CAN_MTU;
+            messages_[i] = {};
+            messages_[i].msg_hdr.msg_iov = &iovecs_[i];
+            messages_[i].msg_hdr.msg_iovlen = 1;
+        }
+        const int result = sendmmsg(skt_, messages_.data(), static_cast<unsigned int>(count), MSG_DONTWAIT);
+        if (result <= 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)
+            {
+                retryNs_ = nowNs + RETRY_DELAY_NS;
+                break;
+            }
+            LOG_ERROR(__func__ << "() sendmmsg: " << strerror(errno));
+            numSent = outFrames_.size();
+            break;
+        }
+        numSent += size_t(result);
+    }
+    outFrames_.erase(outFrames_.begin(), outFrames_.begin() + ptrdiff_t(numSent));
+}
+
+void IsoTpEngine::run() noexcept
+{
+    ThreadPlacement::getInstance().apply(ThreadRole::IO);
+    unique_lock<mutex> lock(mutex_);
+    while (!isOnExit_)
+    {
+        uint64_t nowNs = getNowNs();
+        const uint64_t deadlineNs = process(nowNs);
+        flushFrames(nowNs);
+        lock.unlock();
+
+        struct itimerspec deadline = {};
+        if (deadlineNs != NO_DEADLINE)
+        {
+            // an all-zero value disarms the timer, so a due deadline is set to 1 ns
+            const uint64_t timerNs = max(deadlineNs, uint64_t(1));
+            deadline.it_value.tv_sec = time_t(timerNs / 1000000000ull);
+            deadline.it_value.tv_nsec = long(timerNs % 1000000000ull);
+        }
+        timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &deadline, nullptr);
+
+        struct pollfd fds[3] = {{skt_, POLLIN, 0}, {timer_fd_, POLLIN, 0}, {wakeup_fd_, POLLIN, 0}};
+        if (RealTimeProfile::poll(fds, 3) < 0 && errno != EINTR)
+        {
+            LOG_ERROR(__func__ << "() poll: " << strerror(errno));
+        }
+        uint64_t value;
+        while (read(timer_fd_, &value, sizeof(value)) > 0) { }
+        while (read(wakeup_fd_, &value, sizeof(value)) > 0) { }
+        if (fds[0].revents & POLLIN)
+        {
+            receiveFrames(getNowNs());
+        }
+        lock.lock();
+    }
+}
@@ -0,0 +1,128 @@
+/**
+ * @file isotp_engine.h
+ *
+ */
+
+#ifndef ISOTP_ENGINE_H
+#define ISOTP_ENGINE_H
+
+#include "isotp_configuration.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <linux/can.h>
+
+/// max. number of pending messages per channel and direction
+constexpr std::size_t ISOTP_ENGINE_QUEUE_SIZE = 32;
+
+class BusLoadBudget;
+
+/**
+ * ISO-TP (ISO 15765-2) in user space over one `CAN_RAW` socket per CAN
+ * interface, an alternative to the `can-isotp` kernel module, which needs
+ * one kernel socket per ECU and direction.
+ *
+ * The `IsoTpReceiver` and `IsoTpSender` of an ECU open a channel for their
+ * CAN IDs (see `setEnabled()`), the engine thread of the interface
+ * demultiplexes the received frames by their CAN ID (and extended address)
+ * into the state machines of the channels. It answers first frames with flow
+ * control frames, reassembles the messages and queues them for the receiver
+ * thread, whose file descriptor (`getReceiveFd()`) becomes readable. The
+ * messages passed to `send()` are segmented by the engine thread, which
+ * waits for the flow control of the tester and keeps its STmin and block
+ * size on a timerfd. The frames are read with `recvmmsg()` and written with
+ * `sendmmsg()`, the socket only receives the CAN IDs of the channels
+ * (`CAN_RAW_FILTER`).
+ *
+ * The padding, the extended addressing, CAN FD and the flow control
+ * parameters of the `IsoTpConfiguration` of the ECU are applied like the
+ * kernel module does. N_Bs and N_Cr are 1 s.
+ *
+ * The sent frames are counted in the `BusLoadBudget` of the interface. With
+ * a max. bus load, the consecutive frames wait for their tokens in addition
+ * to STmin, so long responses are paced instead of filling the TX queue.
+ */
+class IsoTpEngine
+{
+public:
+    struct Channel;
+
+    static std::shared_ptr<IsoTpEngine> getInstance(const std::string& device);
+    static void setEnabled(bool isEnabled) noexcept;
+    static bool isEnabled() noexcept;
+
+public:
+    IsoTpEngine() = delete;
+    explicit IsoTpEngine(const std::string& device);
+    IsoTpEngine(const IsoTpEngine& orig) = delete;
+    IsoTpEngine& operator =(const IsoTpEngine& orig) = delete;
+    virtual ~IsoTpEngine();
+
+    Channel* openChannel(canid_t txId, canid_t rxId, const IsoTpConfiguration& configuration,
+                         bool isReceiver) noexcept;
+    void closeChannel(Channel* pChannel, bool isReceiver) noexcept;
+    int getReceiveFd(const Channel* pChannel) const noexcept;
+    ssize_t receive(Channel* pChannel, std::uint8_t* buffer, std::size_t size) noexcept;
+    int send(Channel* pChannel, const void* buffer, std::size_t size) noexcept;
+
+private:
+    /// a frame to send, see `appendFrame()`
+    struct OutFrame
+    {
+        struct canfd_frame frame;
+        bool isCanFd;
+    };
+
+    static std::atomic<bool> isEnabled_;
+    static std::mutex registryMutex_;
+    static std::map<std::string, std::weak_ptr<IsoTpEngine>> registry_;
+
+    std::string device_;
+    int skt_ = -1; ///< the `CAN_RAW` socket of the interface
+    int timer_fd_ = -1; ///< armed with the next STmin or timeout
+    int wakeup_fd_ = -1; ///< interrupts the poll on new messages to send and on exit
+    bool isCanFdEnabled_ = false; ///< `CAN_RAW_FD_FRAMES` is set
+    std::shared_ptr<BusLoadBudget> pBudget_;
+    std::thread thread_;
+
+    std::mutex mutex_; ///< guards the channels, except their receive queues
+    bool isOnExit_ = false;
+    /// keyed by the received CAN ID and extended address, see `getKey()`
+    std::map<std::uint64_t, std::unique_ptr<Channel>> channels_;
+
+    // only used by the engine thread
+    std::vector<OutFrame> outFrames_; ///< not yet sent, in order
+    std::uint64_t retryNs_ = 0; ///< sending is paused until then after a full TX queue
+    std::vector<struct canfd_frame> rxFrames_;
+    std::vector<struct mmsghdr> messages_;
+    std::vector<struct iovec> iovecs_;
+
+    static std::uint64_t getNowNs() noexcept;
+    static std::uint64_t getKey(canid_t rxId, int extendedAddress) noexcept;
+    static std::uint64_t decodeStMin(std::uint8_t stMin) noexcept;
+    void updateFilter() noexcept;
+    void wakeup() noexcept;
+    void receiveFrames(std::uint64_t nowNs) noexcept;
+    void handleFrame(const struct canfd_frame& frame, std::uint64_t nowNs) noexcept;
+    void handleFlowControl(Channel& channel, const std::uint8_t* data, std::size_t length,
+                           std::uint64_t nowNs) noexcept;
+    void deliver(Channel& channel, const std::uint8_t* data, std::size_t length) noexcept;
+    struct canfd_frame& appendFrame(const Channel& channel, std::size_t& pciIndex);
+    void finishFrame(std::size_t length) noexcept;
+    void sendFlowControl(const Channel& channel, std::uint8_t flowStatus);
+    void sendFrames(Channel& channel, std::uint64_t nowNs);
+    std::uint64_t process(std::uint64_t nowNs);
+    void flushFrames(std::uint64_t nowNs) noexcept;
+    void run() noexcept;
+};
+
+#endif /* ISOTP_ENGINE_H */
@@ -14,14 +14,42 @@
 #include <net/if.h>
 #include <sys/socket.h>
 #include <sys/ioctl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include "logger.h"
+#include "realtime_profile.h"
+#include "traffic_capture.h"
+#include "thread_placement.h"
 #include <iostream>
 #include <unistd.h>
+#include <cerrno>
 #include <cstring>
 #include <iomanip>
+#include <vector>
 
 using namespace std;
 
-constexpr size_t MAX_BUFSIZE = 4096; ///< max. 4096 bytes per UDS message
+/// the time the last message was read by this thread, see `getReceiveTime()`
+static thread_local chrono::steady_clock::time_point receiveTime;
+
+/**
+ * The messages are read into a buffer per thread, which grows to the largest
+ * `maxMessageSize` of the receivers read by the thread. So large messages
+ * neither need a large stack nor a buffer per ECU.
+ *
+ * @param size: the size the message buffer needs at least
+ * @return the message buffer of the calling thread
+ */
+static uint8_t* getMessageBuffer(size_t size)
+{
+    static thread_local vector<uint8_t> messageBuffer;
+    if (messageBuffer.size() < size)
+    {
+        messageBuffer.resize(size);
+    }
+    return messageBuffer.data();
+}
 
 /**
  * Constructor. Opens the receiver socket.
@@ -29,13 +57,17 @@ constexpr size_t MAX_BUFSIZE = 4096; ///< max. 4096 bytes per UDS message
  * @param source: the source CAN address
  * @param dest: the destination CAN address
  * @param device: the device used for the transmission (e.g. "vcan0")
+ * @param configuration: the transport settings of the socket
  */
 IsoTpReceiver::IsoTpReceiver(canid_t source,
                              canid_t dest,
-                             const string& device)
+                             const string& device,
+                             const IsoTpConfiguration& configuration)
 : source_(source)
 , dest_(dest)
 , device_(device)
+, captureInterface_(TrafficCapture::getInstance().getInterfaceIndex(device))
+, configuration_(configuration)
 {
     int err = openReceiver();
     if (err != 0)
@@ -45,10 +77,87 @@ IsoTpReceiver::IsoTpReceiver(canid_t source,
 }
 
 /**
- * Destructor. Closes the receiver socket.
+ * Constructor of a receiver without socket, whose messages are passed to
+ * `proceedReceivedData()` by the owner, e.g. in-process through a
+ * `LoopbackTransport`. `openReceiver()` is not called.
+ *
+ * @param source: the CAN ID the responses are sent to
+ * @param dest: the CAN ID the requests are received on
+ * @param configuration: the ISO-TP settings of the ECU, e.g. the max. message size
+ */
+IsoTpReceiver::IsoTpReceiver(canid_t source, canid_t dest, const IsoTpConfiguration& configuration)
+: source_(source)
+, dest_(dest)
+, captureInterface_(0)
+, configuration_(configuration)
+{
+}
+
+/**
+ * Move constructor. The sockets are handed over to the new instance.
+ *
+ * @param orig: the originating instance
+ */
+IsoTpReceiver::IsoTpReceiver(IsoTpReceiver&& orig) noexcept
+: source_(orig.source_)
+, dest_(orig.dest_)
+, device_(move(orig.device_))
+, captureInterface_(orig.captureInterface_)
+, configuration_(orig.configuration_)
+, receive_skt_(orig.receive_skt_)
+, stop_fd_(orig.stop_fd_)
+, isOnExit_(orig.isOnExit_.load())
+, pEngine_(move(orig.pEngine_))
+, pChannel_(orig.pChannel_)
+{
+    orig.receive_skt_ = -1;
+    orig.stop_fd_ = -1;
+    orig.pChannel_ = nullptr;
+}
+
+/**
+ * Move assignment operator. The sockets are handed over to this instance.
+ *
+ * @param orig: the originating instance
+ * @return reference to the moved instance
+ */
+IsoTpReceiver& IsoTpReceiver::operator=(IsoTpReceiver&& orig) noexcept
+{
+    if (this != &orig)
+    {
+        closeSocket();
+        if (stop_fd_ >= 0)
+        {
+            close(stop_fd_);
+        }
+        source_ = orig.source_;
+        dest_ = orig.dest_;
+        device_ = move(orig.device_);
+        captureInterface_ = orig.captureInterface_;
+        configuration_ = orig.configuration_;
+        receive_skt_ = orig.receive_skt_;
+        stop_fd_ = orig.stop_fd_;
+        isOnExit_ = orig.isOnExit_.load();
+        pEngine_ = move(orig.pEngine_);
+        pChannel_ = orig.pChannel_;
+        orig.receive_skt_ = -1;
+        orig.stop_fd_ = -1;
+        orig.pChannel_ = nullptr;
+    }
+    return *this;
+}
+
+/**
+ * Destructor. Closes the receiver socket. A thread in `readData()` has to be
+ * stopped and joined before.
  */
 IsoTpReceiver::~IsoTpReceiver()
 {
+    closeSocket();
+    if (stop_fd_ >= 0)
+    {
+        close(stop_fd_);
+    }
 }
 
 /**
@@ -59,37 +168,70 @@ IsoTpReceiver::~IsoTpReceiver()
  */
 int IsoTpReceiver::openReceiver() noexcept
 {
+    if (stop_fd_ < 0)
+    {
+        stop_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (stop_fd_ < 0)
+        {
+            LOG_ERROR(__func__ << "() eventfd: " << strerror(errno));
+            return -4;
+        }
+    }
+    else
+    {
+        // reopened after `stopReceiver()`, drop the old wakeup
+        uint64_t value;
+        while (read(stop_fd_, &value, sizeof(value)) > 0) { }
+    }
     isOnExit_ = false;
+    if (IsoTpEngine::isEnabled())
+    {
+        return openEngineChannel();
+    }
     struct sockaddr_can addr;
 
-    cout << "receiver tx_id: " << dec << (uint32_t)source_ << " - ";
+    LOG_INFO("receiver tx_id: " << dec << (uint32_t)source_ << " - " << (source_ > 0x7FFu ? "29bit" : ""));
     addr.can_addr.tp.tx_id = source_;
     if(source_ > 0x7FFu) {
-        cout << "29bit";
         addr.can_addr.tp.tx_id |= CAN_EFF_FLAG;
     }
-    cout << endl;
 
-    cout << "receiver rx_id: " << dec << (uint32_t)dest_ << " - ";
+    LOG_INFO("receiver rx_id: " << dec << (uint32_t)dest_ << " - " << (dest_ > 0x7FFu ? "29bit" : ""));
     addr.can_addr.tp.rx_id = dest_;
     if(dest_ > 0x7FFu) {
-        cout << "29bit";
         addr.can_addr.tp.rx_id |= CAN_EFF_FLAG;
     }
-    cout << endl;
 
     addr.can_family = AF_CAN;
 
     int skt = socket(PF_CAN, SOCK_DGRAM, CAN_ISOTP);
     if (skt < 0)
     {
-        cerr << __func__ << "() socket: " << strerror(errno) << '\n';
+        LOG_ERROR(__func__ << "() socket: " << strerror(errno));
         return -1;
     }
 
-    static struct can_isotp_options opts;
-    opts.flags |= (CAN_ISOTP_TX_PADDING | CAN_ISOTP_RX_PADDING);
-    setsockopt(skt, SOL_CAN_ISOTP, CAN_ISOTP_OPTS, &opts, sizeof(opts));
+    if (setIsoTpOptions(skt, configuration_) != 0)
+    {
+        close(skt);
+        return -3;
+    }
+
+    // the flow control frames the ECU answers a first frame with
+    struct can_isotp_fc_options fcOpts = {};
+    fcOpts.bs = configuration_.blockSize;
+    fcOpts.stmin = configuration_.stMin;
+    fcOpts.wftmax = configuration_.maxWaitFrames;
+    if (setsockopt(skt, SOL_CAN_ISOTP, CAN_ISOTP_RECV_FC, &fcOpts, sizeof(fcOpts)) < 0)
+    {
+        LOG_WARNING(__func__ << "() setsockopt CAN_ISOTP_RECV_FC: " << strerror(errno));
+    }
+
+    if (configuration_.receiveBufferSize > 0 &&
+        setsockopt(skt, SOL_SOCKET, SO_RCVBUF, &configuration_.receiveBufferSize, sizeof(configuration_.receiveBufferSize)) < 0)
+    {
+        LOG_WARNING(__func__ << "() setsockopt SO_RCVBUF: " << strerror(errno));
+    }
 
     struct ifreq ifr;
     strncpy(ifr.ifr_name, device_.c_str(), device_.length() + 1);
@@ -101,7 +243,7 @@ int IsoTpReceiver::openReceiver() noexcept
                          sizeof(addr));
     if (bind_res < 0)
     {
-        cerr << __func__ << "() bind: " << strerror(errno) << '\n';
+        LOG_ERROR(__func__ << "() bind: " << strerror(errno));
         close(skt);
         return -2;
     }
@@ -111,25 +253,105 @@ int IsoTpReceiver::openReceiver() noexcept
 }
 
 /**
- * Closes the socket for receiving data.
+ * Opens the channel of the CAN IDs on the user-space ISO-TP engine of the
+ * interface instead of a kernel socket, see `IsoTpEngine::setEnabled()`.
+ *
+ * @return 0 on success, otherwise a negative value
+ */
+int IsoTpReceiver::openEngineChannel() noexcept
+{
+    try
+    {
+        pEngine_ = IsoTpEngine::getInstance(device_);
+    }
+    catch (const exception&)
+    {
+        return -1;
+    }
+    pChannel_ = pEngine_->openChannel(source_, dest_, configuration_, true);
+    if (pChannel_ == nullptr)
+    {
+        pEngine_.reset();
+        return -2;
+    }
+    receive_skt_ = pEngine_->getReceiveFd(pChannel_);
+    return 0;
+}
+
+/**
+ * Closes the ISO-TP socket or the engine channel.
+ */
+void IsoTpReceiver::closeSocket() noexcept
+{
+    if (pChannel_ != nullptr)
+    {
+        pEngine_->closeChannel(pChannel_, true);
+        pChannel_ = nullptr;
+        pEngine_.reset();
+    }
+    else if (receive_skt_ >= 0)
+    {
+        close(receive_skt_);
+    }
+    receive_skt_ = -1;
+}
+
+/**
+ * Reads one message without blocking, from the socket or the engine channel.
+ *
+ * @return the length of the message or -1 with `errno` set
+ */
+ssize_t IsoTpReceiver::receiveMessage(uint8_t* buffer, size_t size) noexcept
+{
+    if (pChannel_ != nullptr)
+    {
+        return pEngine_->receive(pChannel_, buffer, size);
+    }
+    return recv(receive_skt_, buffer, size, MSG_DONTWAIT);
+}
+
+/**
+ * Makes `readData()` return, without waiting for the next message. The socket
+ * stays open, so the owner can join the reading thread before it calls
+ * `closeReceiver()`.
+ *
+ * @see IsoTpReceiver::readData()
+ */
+void IsoTpReceiver::stopReceiver() noexcept
+{
+    if (isOnExit_.exchange(true) || stop_fd_ < 0)
+    {
+        return;
+    }
+    const uint64_t value = 1;
+    if (write(stop_fd_, &value, sizeof(value)) < 0)
+    {
+        LOG_ERROR(__func__ << "() write: " << strerror(errno));
+    }
+}
+
+/**
+ * Closes the socket for receiving data. Stops `readData()` first, if it is
+ * still running.
  * 
  * @see IsoTpReceiver::openReceiver()
+ * @see IsoTpReceiver::stopReceiver()
  */
 void IsoTpReceiver::closeReceiver() noexcept
 {
-    isOnExit_ = true;
+    stopReceiver();
 
     if (receive_skt_ < 0)
     {
-        cerr << __func__ << "() Receiver socket is already closed!\n";
+        LOG_ERROR(__func__ << "() Receiver socket is already closed!");
         return;
     }
-    close(receive_skt_);
-    receive_skt_ = -1;
+    closeSocket();
 }
 
 /**
- * Reads the data from the opened receiver socket. The handling of the received
+ * Reads the data from the opened receiver socket until `stopReceiver()` is
+ * called. The handling of the received
  * data is controlled by the inside nested `proceedReceivedData()` function. To 
  * change its behavior, deduce a new class form `IsoTpSocket` and override the
  * `proceedReceivedData()`-function to your likings.
@@ -142,26 +364,137 @@ int IsoTpReceiver::readData() noexcept
 {
     if (receive_skt_ < 0)
     {
-        cerr << __func__ << "() Can not read data. Receiver socket invalid!\n";
+        LOG_ERROR(__func__ << "() Can not read data. Receiver socket invalid!");
         return -1;
     }
+    ThreadPlacement::getInstance().apply(ThreadRole::IO);
 
-    uint8_t msg[MAX_BUFSIZE];
-    size_t num_bytes;
-    do
+    // one more byte than allowed, so too long messages can be told apart
+    const size_t bufferSize = configuration_.maxMessageSize + 1;
+    uint8_t* msg = getMessageBuffer(bufferSize);
+    struct pollfd fds[2] = {{stop_fd_, POLLIN, 0}, {receive_skt_, POLLIN, 0}};
+    while (!isOnExit_.load(memory_order_acquire))
     {
-        num_bytes = read(receive_skt_, msg, MAX_BUFSIZE);
-        cout << "READ returned" << endl;
-        if (num_bytes > 0 && num_bytes < MAX_BUFSIZE)
+        if (RealTimeProfile::poll(fds, 2) < 0)
+        {
+            if (errno != EINTR)
+            {
+                LOG_ERROR(__func__ << "() poll: " << strerror(errno));
+                return -2;
+            }
+            continue;
+        }
+        if (fds[0].revents != 0)
+        {
+            break;
+        }
+        if (fds[1].revents == 0)
         {
-            proceedReceivedData(msg, num_bytes);
+            continue;
         }
+        // also reads the pending error of the socket, e.g. a timed out transfer
+        const ssize_t num_bytes = receiveMessage(msg, bufferSize);
+        receiveTime = chrono::steady_clock::now();
+        LOG_DEBUG("READ returned");
+        if (num_bytes < 0)
+        {
+            if (errno != EINTR && errno != EAGAIN && !isOnExit_)
+            {
+                LOG_ERROR(__func__ << "() read: " << strerror(errno));
+            }
+        }
+        else if (static_cast<size_t>(num_bytes) > configuration_.maxMessageSize)
+        {
+            LOG_WARNING(__func__ << "() Discarding a message of more than " << configuration_.maxMessageSize << " bytes");
+        }
+        else if (num_bytes > 0)
+        {
+            TrafficCapture::getInstance().record(TrafficCapture::Protocol::UDS, TrafficCapture::Direction::RX,
+                                                 captureInterface_, dest_, 0, 0, msg, num_bytes);
+            proceedReceivedData(msg, static_cast<size_t>(num_bytes));
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Reads one message from the opened receiver socket without blocking and
+ * passes it to `proceedReceivedData()`. This is used by the
+ * `ReceiverReactor`, which calls it whenever the socket is readable, instead
+ * of blocking a thread in `readData()`.
+ *
+ * @return 0 on success, 1 if there was no data available, otherwise a
+ *         negative value
+ * @see ReceiverReactor
+ */
+int IsoTpReceiver::readSingleMessage() noexcept
+{
+    if (receive_skt_ < 0)
+    {
+        LOG_ERROR(__func__ << "() Can not read data. Receiver socket invalid!");
+        return -1;
     }
-    while (!isOnExit_);
 
+    const size_t bufferSize = configuration_.maxMessageSize + 1;
+    uint8_t* msg = getMessageBuffer(bufferSize);
+    const ssize_t num_bytes = receiveMessage(msg, bufferSize);
+    receiveTime = chrono::steady_clock::now();
+    if (num_bytes < 0)
+    {
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            return 1;
+        }
+        LOG_ERROR(__func__ << "() recv: " << strerror(errno));
+        return -2;
+    }
+    if (static_cast<size_t>(num_bytes) > configuration_.maxMessageSize)
+    {
+        LOG_WARNING(__func__ << "() Discarding a message of more than " << configuration_.maxMessageSize << " bytes");
+    }
+    else if (num_bytes > 0)
+    {
+        TrafficCapture::getInstance().record(TrafficCapture::Protocol::UDS, TrafficCapture::Direction::RX,
+                                             captureInterface_, dest_, 0, 0, msg, num_bytes);
+        proceedReceivedData(msg, static_cast<size_t>(num_bytes));
+    }
     return 0;
 }
 
+/**
+ * @return the file descriptor of the receiver socket or a negative value if
+ *         it is closed
+ */
+int IsoTpReceiver::getSocket() const noexcept
+{
+    return receive_skt_;
+}
+
+/**
+ * Called by the `ReceiverReactor` when the receiver socket is readable.
+ *
+ * @param events: the epoll events that occurred
+ * @return `EPOLLIN`, since the receiver always waits for the next message
+ */
+uint32_t IsoTpReceiver::handleEvents(uint32_t events) noexcept
+{
+    readSingleMessage();
+    return EPOLLIN;
+}
+
+/**
+ * Returns the time the message passed to `proceedReceivedData()` was read
+ * from the socket. This is kept per thread, since the message might have been
+ * read by another receiver (e.g. the shared `BroadcastReceiver`).
+ *
+ * @return the time the last message was read by the calling thread
+ */
+chrono::steady_clock::time_point IsoTpReceiver::getReceiveTime() noexcept
+{
+    return receiveTime;
+}
+
 /**
  * Proceeds the received data. This is the default implementation, which simply
  * prints out the received data in hexadecimal notation to `std::out`. This 
@@ -173,14 +506,5 @@ int IsoTpReceiver::readData() noexcept
  */
 void IsoTpReceiver::proceedReceivedData(const uint8_t* buffer, const size_t num_bytes) noexcept
 {
-    cout << __func__ << "() Received " << dec << num_bytes << " bytes.\n";
-    for (size_t i = 0; i < num_bytes; i++)
-    {
-        cout << " 0x"
-                << hex
-                << setw(2)
-                << setfill('0')
-                << static_cast<int> (buffer[i]);
-    }
-    cout << endl;
+    LOG_DEBUG(__func__ << "() Received " << dec << num_bytes << " bytes.\n" << hexDump(buffer, num_bytes));
 }
\ No newline at end of file
@@ -6,26 +6,40 @@
 #ifndef ISOTP_RECEIVER_H
 #define ISOTP_RECEIVER_H
 
+#include "reactor_handler.h"
+#include "isotp_configuration.h"
+#include "isotp_engine.h"
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <linux/can.h>
 
-class IsoTpReceiver
+class IsoTpReceiver : public ReactorHandler
 {
 public:
     IsoTpReceiver() = delete;
-    IsoTpReceiver(canid_t source, canid_t dest, const std::string& device);
-    IsoTpReceiver(const IsoTpReceiver& orig) = default;
-    IsoTpReceiver& operator =(const IsoTpReceiver& orig) = default;
-    IsoTpReceiver(IsoTpReceiver&& orig) = default;
-    IsoTpReceiver& operator =(IsoTpReceiver&& orig) = default;
+    IsoTpReceiver(canid_t source, canid_t dest, const std::string& device,
+                  const IsoTpConfiguration& configuration = IsoTpConfiguration());
+    IsoTpReceiver(const IsoTpReceiver& orig) = delete;
+    IsoTpReceiver& operator =(const IsoTpReceiver& orig) = delete;
+    IsoTpReceiver(IsoTpReceiver&& orig) noexcept;
+    IsoTpReceiver& operator =(IsoTpReceiver&& orig) noexcept;
     virtual ~IsoTpReceiver();
 
     int openReceiver() noexcept;
+    void stopReceiver() noexcept;
     void closeReceiver() noexcept;
     int readData() noexcept;
+    int readSingleMessage() noexcept;
+    virtual int getSocket() const noexcept override;
+    virtual std::uint32_t handleEvents(std::uint32_t events) noexcept override;
 
 protected:
+    IsoTpReceiver(canid_t source, canid_t dest, const IsoTpConfiguration& configuration);
+    static std::chrono::steady_clock::time_point getReceiveTime() noexcept;
     virtual void proceedReceivedData(const std::uint8_t* buffer,
                                      const std::size_t num_bytes) noexcept;
 
@@ -33,8 +47,17 @@ private:
     canid_t source_;
     canid_t dest_;
     std::string device_;
-    int receive_skt_ = -1;
-    bool isOnExit_ = false;
+    std::uint8_t captureInterface_; ///< see `TrafficCapture::getInterfaceIndex()`
+    IsoTpConfiguration configuration_;
+    int receive_skt_ = -1; ///< the ISO-TP socket or the receive fd of the engine channel
+    int stop_fd_ = -1; ///< wakes up `readData()`, see `stopReceiver()`
+    std::atomic<bool> isOnExit_{false};
+    std::shared_ptr<IsoTpEngine> pEngine_; ///< `nullptr` if the kernel module is used
+    IsoTpEngine::Channel* pChannel_ = nullptr;
+
+    int openEngineChannel() noexcept;
+    void closeSocket() noexcept;
+    ssize_t receiveMessage(std::uint8_t* buffer, std::size_t size) noexcept;
 
 };
 
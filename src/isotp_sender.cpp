@@ -6,19 +6,26 @@
  */
 
 #include "isotp_sender.h"
+#include "receiver_reactor.h"
+#include "logger.h"
+#include "metrics.h"
+#include "traffic_capture.h"
 #include "can/isotp.h"
 #include <net/if.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/ioctl.h>
+#include <fcntl.h>
 #include <iostream>
 #include <unistd.h>
+#include <cerrno>
 #include <cstring>
 
 using namespace std;
 
-constexpr size_t MAX_UDS_MSG_SIZE = 4096; ///< max. 4096 bytes per UDS message
 
 #define NUM_SEND_RETRIES 5
+#define FIRST_RETRY_DELAY_US 1000 ///< doubled with each retry in blocking mode
 
 /**
  * Constructor. Opens the sender socket.
@@ -26,13 +33,17 @@ constexpr size_t MAX_UDS_MSG_SIZE = 4096; ///< max. 4096 bytes per UDS message
  * @param source: the source CAN address
  * @param dest: the destination CAN address
  * @param device: the device used for the transmission (e.g. "vcan0")
+ * @param configuration: the transport settings of the socket
  */
 IsoTpSender::IsoTpSender(canid_t source,
                          canid_t dest,
-                         const string& device)
+                         const string& device,
+                         const IsoTpConfiguration& configuration)
 : source_(source)
 , dest_(dest)
 , device_(device)
+, captureInterface_(TrafficCapture::getInstance().getInterfaceIndex(device))
+, configuration_(configuration)
 {
     int err = openSender();
     if (err != 0)
@@ -42,10 +53,18 @@ IsoTpSender::IsoTpSender(canid_t source,
 }
 
 /**
- * Destructor. Closes the sender socket.
+ * Destructor. Unregisters the sender from the reactor.
  */
 IsoTpSender::~IsoTpSender()
 {
+    if (pReactor_)
+    {
+        pReactor_->removeHandler(this);
+    }
+    if (pChannel_ != nullptr)
+    {
+        pEngine_->closeChannel(pChannel_, false);
+    }
 }
 
 /**
@@ -56,34 +75,36 @@ IsoTpSender::~IsoTpSender()
  */
 int IsoTpSender::openSender() noexcept
 {
+    if (IsoTpEngine::isEnabled())
+    {
+        return openEngineChannel();
+    }
     struct sockaddr_can addr;
-    cout << "sender: tx_id: " << source_ << " - ";
+    LOG_INFO("sender: tx_id: " << source_ << " - " << (source_ > 0x7FFu ? "29bit" : ""));
     addr.can_addr.tp.tx_id = source_;
     if(source_ > 0x7FFu) {
-        cout << "29bit";
         addr.can_addr.tp.tx_id |= CAN_EFF_FLAG;
     }
-    cout << endl;
 
-    cout << "sender: rx_id: " << dest_ << " - ";
+    LOG_INFO("sender: rx_id: " << dest_ << " - " << (dest_ > 0x7FFu ? "29bit" : ""));
     addr.can_addr.tp.rx_id = dest_;
     if(dest_ > 0x7FFu) {
-        cout << "29bit";
         addr.can_addr.tp.rx_id |= CAN_EFF_FLAG;
     }
-    cout << endl;
     addr.can_family = AF_CAN;
 
     int skt = socket(PF_CAN, SOCK_DGRAM, CAN_ISOTP);
     if (skt < 0)
     {
-        cerr << __func__ << "() socket: " << strerror(errno) << '\n';
+        LOG_ERROR(__func__ << "() socket: " << strerror(errno));
         return -1;
     }
 
-    static struct can_isotp_options opts;
-    opts.flags |= (CAN_ISOTP_TX_PADDING | CAN_ISOTP_RX_PADDING);
-    setsockopt(skt, SOL_CAN_ISOTP, CAN_ISOTP_OPTS, &opts, sizeof(opts));
+    if (setIsoTpOptions(skt, configuration_) != 0)
+    {
+        close(skt);
+        return -3;
+    }
 
     struct ifreq ifr;
     strncpy(ifr.ifr_name, device_.c_str(), device_.length() + 1);
@@ -95,7 +116,7 @@ int IsoTpSender::openSender() noexcept
                          sizeof(addr));
     if (bind_res < 0)
     {
-        cerr << __func__ << "() bind: " << strerror(errno) << '\n';
+        LOG_ERROR(__func__ << "() bind: " << strerror(errno));
         close(skt);
         return -2;
     }
@@ -104,6 +125,31 @@ int IsoTpSender::openSender() noexcept
     return 0;
 }
 
+/**
+ * Opens the channel of the CAN IDs on the user-space ISO-TP engine of the
+ * interface instead of a kernel socket, see `IsoTpEngine::setEnabled()`.
+ *
+ * @return 0 on success, otherwise a negative value
+ */
+int IsoTpSender::openEngineChannel() noexcept
+{
+    try
+    {
+        pEngine_ = IsoTpEngine::getInstance(device_);
+    }
+    catch (const exception&)
+    {
+        return -1;
+    }
+    pChannel_ = pEngine_->openChannel(source_, dest_, configuration_, false);
+    if (pChannel_ == nullptr)
+    {
+        pEngine_.reset();
+        return -2;
+    }
+    return 0;
+}
+
 /**
  * Closes the ISO_TP socket for sending.
  * 
@@ -111,53 +157,312 @@ int IsoTpSender::openSender() noexcept
  */
 void IsoTpSender::closeSender() noexcept
 {
+    if (pReactor_)
+    {
+        // the reactor must not use the socket while it is closed
+        pReactor_->removeHandler(this);
+        pReactor_ = nullptr;
+    }
+
+    if (pChannel_ != nullptr)
+    {
+        pEngine_->closeChannel(pChannel_, false);
+        pChannel_ = nullptr;
+        pEngine_.reset();
+        return;
+    }
+
     if (send_skt_ < 0)
     {
-        cerr << __func__ << "() Sender socket is already closed!\n";
+        LOG_ERROR(__func__ << "() Sender socket is already closed!");
         return;
     }
     close(send_skt_);
     send_skt_ = -1;
 }
 
+/**
+ * Switches the sender into the non-blocking mode. From now on `sendData()`
+ * never waits for the socket: if the message can not be written immediately
+ * (e.g. due to a busy bus), it is queued and written by the reactor as soon
+ * as the socket is writable again.
+ *
+ * @param pReactor: the reactor completing the queued writes
+ * @return 0 on success, otherwise a negative value
+ * @see IsoTpSender::handleEvents()
+ */
+int IsoTpSender::enableAsyncSend(ReceiverReactor* pReactor) noexcept
+{
+    if (pChannel_ != nullptr)
+    {
+        // the engine never blocks the caller anyway
+        return 0;
+    }
+    if (send_skt_ < 0)
+    {
+        LOG_ERROR(__func__ << "() Invalid socket file descriptor!");
+        return -1;
+    }
+
+    const int flags = fcntl(send_skt_, F_GETFL, 0);
+    if (flags < 0 || fcntl(send_skt_, F_SETFL, flags | O_NONBLOCK) < 0)
+    {
+        LOG_ERROR(__func__ << "() fcntl: " << strerror(errno));
+        return -2;
+    }
+
+    // nothing to wait for until a message gets queued
+    if (pReactor->addHandler(this, 0) != 0)
+    {
+        fcntl(send_skt_, F_SETFL, flags);
+        return -3;
+    }
+    pReactor_ = pReactor;
+    return 0;
+}
+
 /**
  * Send the given number of bytes located in the buffer. The sender socket
  * has to be opened first.
  * 
  * @param buffer: the pointer to the data buffer
  * @param size: the number of bytes to write in the socket
- * @return the number of sent bytes or a negative value on error
+ * @return the number of sent bytes or a negative value on error, in
+ *         non-blocking mode the message might only be queued
  * @see IsoTpSender::openSender()
+ * @see IsoTpSender::enableAsyncSend()
  * @see IsoTpSender::closeSender()
  */
-int IsoTpSender::sendData(const void* buffer, size_t size) const noexcept
+int IsoTpSender::sendData(const void* buffer, size_t size) noexcept
 {
-    if (size > MAX_UDS_MSG_SIZE)
+    if (size > configuration_.maxMessageSize)
     {
-        cerr << __func__ << "() Message size exceeds the maximum of 4096 bytes!\n";
+        LOG_ERROR(__func__ << "() Message size " << size << " exceeds the maximum of "
+                  << configuration_.maxMessageSize << " bytes!");
         return 0;
     }
 
-    if (send_skt_ < 0)
+    if (send_skt_ < 0 && pChannel_ == nullptr)
     {
-        cerr << __func__ << "() Invalid socket file descriptor!\n";
+        LOG_ERROR(__func__ << "() Invalid socket file descriptor!");
         return -1;
     }
 
+    TrafficCapture::getInstance().record(TrafficCapture::Protocol::UDS, TrafficCapture::Direction::TX,
+                                         captureInterface_, source_, 0, 0, buffer, size);
+    if (pChannel_ != nullptr)
+    {
+        return sendToEngine(buffer, size);
+    }
+    if (pReactor_)
+    {
+        return sendAsync(buffer, size);
+    }
+    return sendBlocking(buffer, size);
+}
+
+/**
+ * @return a snapshot of the counters of this sender
+ */
+IsoTpSender::Statistics IsoTpSender::getStatistics() const noexcept
+{
+    Statistics statistics;
+    statistics.queueDepth = sendQueue_.size();
+    statistics.maxQueueDepth = maxQueueDepth_.load();
+    statistics.sent = sent_.load();
+    statistics.queued = queued_.load();
+    statistics.dropped = dropped_.load();
+    statistics.maxRetryLatencyUs = maxRetryLatencyUs_.load();
+    statistics.totalRetryLatencyUs = totalRetryLatencyUs_.load();
+    return statistics;
+}
+
+/**
+ * Counts the retries and dropped messages additionally in the metrics of the
+ * ECU.
+ *
+ * @param pMetrics: the metrics of the ECU
+ */
+void IsoTpSender::setMetrics(EcuMetrics* pMetrics) noexcept
+{
+    pMetrics_ = pMetrics;
+}
+
+/**
+ * @return the file descriptor of the sender socket or a negative value if it
+ *         is closed
+ */
+int IsoTpSender::getSocket() const noexcept
+{
+    return send_skt_;
+}
+
+/**
+ * Called by the `ReceiverReactor` when the socket is writable again. Writes
+ * the queued messages until the queue is empty or the socket is busy again.
+ *
+ * @param events: the epoll events that occurred
+ * @return `EPOLLOUT` if there are still messages queued, otherwise 0
+ */
+uint32_t IsoTpSender::handleEvents(uint32_t events) noexcept
+{
+    PendingMessage* pMessage;
+    while ((pMessage = sendQueue_.front()) != nullptr)
+    {
+        const ssize_t bytes_sent = write(send_skt_, pMessage->data.data(), pMessage->data.size());
+        if (bytes_sent < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)
+            {
+                return EPOLLOUT;
+            }
+            LOG_ERROR(__func__ << "() write: " << strerror(errno));
+            countDrop();
+        }
+        else
+        {
+            sent_++;
+            recordRetryLatency(pMessage->queuedAt);
+        }
+        sendQueue_.pop();
+    }
+    return 0;
+}
+
+/**
+ * Queues the message on the engine channel, which segments and sends it.
+ *
+ * @return the number of queued bytes or a negative value if the queue of
+ *         the channel is full
+ */
+int IsoTpSender::sendToEngine(const void* buffer, size_t size) noexcept
+{
+    const int result = pEngine_->send(pChannel_, buffer, size);
+    if (result < 0)
+    {
+        LOG_WARNING(__func__ << "() Send queue is full, dropping message!");
+        countDrop();
+        return -2;
+    }
+    sent_++;
+    return result;
+}
+
+int IsoTpSender::sendBlocking(const void* buffer, size_t size) noexcept
+{
     int bytes_sent = 0;
     int retries = NUM_SEND_RETRIES;
+    useconds_t delay = FIRST_RETRY_DELAY_US;
+    const auto start = chrono::steady_clock::now();
     while(retries > 0)
     {
         bytes_sent = write(send_skt_, buffer, size);
         if (bytes_sent < 0)
         {
-            cerr << __func__ << "() write: " << strerror(errno) << '\n';
+            LOG_ERROR(__func__ << "() write: " << strerror(errno));
             retries--;
-            usleep(1000*5); // wait 5ms before retry
+            if (retries > 0)
+            {
+                countRetry();
+                usleep(delay);
+                delay *= 2;
+            }
         } else {
             retries = 0;
         }
     }
 
+    if (bytes_sent < 0)
+    {
+        countDrop();
+    }
+    else
+    {
+        sent_++;
+        if (delay != FIRST_RETRY_DELAY_US)
+        {
+            queued_++;
+            recordRetryLatency(start);
+        }
+    }
     return bytes_sent;
 }
+
+/**
+ * Writes the message immediately if nothing is queued and the socket is
+ * ready, otherwise appends it to the send queue.
+ *
+ * @return the number of sent or queued bytes or a negative value on error
+ */
+int IsoTpSender::sendAsync(const void* buffer, size_t size) noexcept
+{
+    lock_guard<mutex> lock(producerMutex_);
+
+    // keep the order: only bypass the queue if it is empty
+    if (sendQueue_.empty())
+    {
+        const ssize_t bytes_sent = write(send_skt_, buffer, size);
+        if (bytes_sent >= 0)
+        {
+            sent_++;
+            return static_cast<int>(bytes_sent);
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ENOBUFS)
+        {
+            LOG_ERROR(__func__ << "() write: " << strerror(errno));
+            countDrop();
+            return -1;
+        }
+    }
+
+    PendingMessage* pMessage = sendQueue_.prepareBack();
+    if (pMessage == nullptr)
+    {
+        LOG_WARNING(__func__ << "() Send queue is full, dropping message!");
+        countDrop();
+        return -2;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(buffer);
+    pMessage->data.assign(bytes, bytes + size);
+    pMessage->queuedAt = chrono::steady_clock::now();
+    sendQueue_.commitBack();
+    queued_++;
+    countRetry();
+
+    const size_t depth = sendQueue_.size();
+    size_t maxDepth = maxQueueDepth_.load();
+    while (depth > maxDepth && !maxQueueDepth_.compare_exchange_weak(maxDepth, depth))
+    {
+    }
+
+    pReactor_->rearm(this, EPOLLOUT);
+    return static_cast<int>(size);
+}
+
+void IsoTpSender::recordRetryLatency(chrono::steady_clock::time_point since) noexcept
+{
+    const uint64_t latency = chrono::duration_cast<chrono::microseconds>(
+        chrono::steady_clock::now() - since).count();
+    totalRetryLatencyUs_ += latency;
+    uint64_t maxLatency = maxRetryLatencyUs_.load();
+    while (latency > maxLatency && !maxRetryLatencyUs_.compare_exchange_weak(maxLatency, latency))
+    {
+    }
+}
+
+void IsoTpSender::countRetry() noexcept
+{
+    if (pMetrics_)
+    {
+        pMetrics_->sendRetries.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+void IsoTpSender::countDrop() noexcept
+{
+    dropped_++;
+    if (pMetrics_)
+    {
+        pMetrics_->droppedFrames.fetch_add(1, memory_order_relaxed);
+    }
+}
@@ -6,30 +6,96 @@
 #ifndef ISOTP_SENDER_H
 #define ISOTP_SENDER_H
 
+#include "reactor_handler.h"
+#include "isotp_configuration.h"
+#include "isotp_engine.h"
+#include "uds_transport.h"
+#include "spsc_queue.h"
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 #include <linux/can.h>
 
-class IsoTpSender
+constexpr std::size_t SEND_QUEUE_SIZE = 32; ///< max. number of pending responses per sender
+
+class ReceiverReactor;
+class EcuMetrics;
+
+class IsoTpSender : public ReactorHandler, public UdsTransport
 {
 public:
+    /// Counters of the send path, see `IsoTpSender::getStatistics()`.
+    struct Statistics
+    {
+        std::size_t queueDepth; ///< currently queued messages
+        std::size_t maxQueueDepth; ///< max. number of queued messages so far
+        std::uint64_t sent; ///< successfully sent messages
+        std::uint64_t queued; ///< messages which could not be sent immediately
+        std::uint64_t dropped; ///< messages dropped due to a full queue or an error
+        std::uint64_t maxRetryLatencyUs; ///< max. delay of a queued message
+        std::uint64_t totalRetryLatencyUs; ///< sum of the delays of all queued messages
+    };
+
     IsoTpSender() = delete;
-    IsoTpSender(canid_t source, canid_t dest, const std::string& device);
-    IsoTpSender(const IsoTpSender& orig) = default;
-    IsoTpSender& operator =(const IsoTpSender& orig) = default;
-    IsoTpSender(IsoTpSender&& orig) = default;
-    IsoTpSender& operator =(IsoTpSender&&) = default;
+    IsoTpSender(canid_t source, canid_t dest, const std::string& device,
+                const IsoTpConfiguration& configuration = IsoTpConfiguration());
+    IsoTpSender(const IsoTpSender& orig) = delete;
+    IsoTpSender& operator =(const IsoTpSender& orig) = delete;
     virtual ~IsoTpSender();
 
     int openSender() noexcept;
     void closeSender() noexcept;
-    int sendData(const void* buffer, std::size_t size) const noexcept;
+    int enableAsyncSend(ReceiverReactor* pReactor) noexcept;
+    virtual int sendData(const void* buffer, std::size_t size) noexcept override;
+    Statistics getStatistics() const noexcept;
+    void setMetrics(EcuMetrics* pMetrics) noexcept;
+
+    virtual int getSocket() const noexcept override;
+    virtual std::uint32_t handleEvents(std::uint32_t events) noexcept override;
 
 private:
+    struct PendingMessage
+    {
+        std::vector<std::uint8_t> data;
+        std::chrono::steady_clock::time_point queuedAt;
+    };
+
     canid_t source_;
     canid_t dest_;
     std::string device_;
+    std::uint8_t captureInterface_; ///< see `TrafficCapture::getInterfaceIndex()`
+    IsoTpConfiguration configuration_;
     int send_skt_ = -1;
+    std::shared_ptr<IsoTpEngine> pEngine_; ///< `nullptr` if the kernel module is used
+    IsoTpEngine::Channel* pChannel_ = nullptr; ///< the channel of the engine, sends asynchronously
+
+    ReceiverReactor* pReactor_ = nullptr; ///< `nullptr` in blocking mode
+    /// serializes the producers, since responses are sent from the UDS,
+    /// broadcast and Lua threads of an ECU
+    std::mutex producerMutex_;
+    /// consumed by the reactor worker handling `EPOLLOUT`
+    SpscQueue<PendingMessage, SEND_QUEUE_SIZE> sendQueue_;
+
+    std::atomic<std::size_t> maxQueueDepth_{0};
+    std::atomic<std::uint64_t> sent_{0};
+    std::atomic<std::uint64_t> queued_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<std::uint64_t> maxRetryLatencyUs_{0};
+    std::atomic<std::uint64_t> totalRetryLatencyUs_{0};
+    EcuMetrics* pMetrics_ = nullptr; ///< counts the retries and drops of the ECU
+
+    int openEngineChannel() noexcept;
+    int sendToEngine(const void* buffer, std::size_t size) noexcept;
+    int sendBlocking(const void* buffer, std::size_t size) noexcept;
+    int sendAsync(const void* buffer, std::size_t size) noexcept;
+    void recordRetryLatency(std::chrono::steady_clock::time_point since) noexcept;
+    void countRetry() noexcept;
+    void countDrop() noexcept;
 };
 
 #endif /* ISOTP_SENDER_H */
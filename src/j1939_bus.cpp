@@ -0,0 +1,545 @@
+/**
+ * @file j1939_bus.cpp
+ *
+ * This file contains the shared J1939 receiver and the address claiming of
+ * the simulated nodes of a CAN interface.
+ */
+
+#include "j1939_bus.h"
+#include "can/j1939.h"
+#include "idle_monitor.h"
+#include "logger.h"
+#include "realtime_profile.h"
+#include "thread_placement.h"
+#include "traffic_capture.h"
+#include <linux/can.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <net/if.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <set>
+
+using namespace std;
+
+constexpr size_t MAX_BUFSIZE = 1788; // 255*7 Byte + 3 byte PGN
+constexpr size_t NAME_LENGTH = 8;
+constexpr size_t RECEIVE_BATCH = 16; ///< max. messages per `recvmmsg()`
+/// the destination address, the NAMEs, the priority and the timestamps
+constexpr size_t CONTROL_SIZE = 3 * CMSG_SPACE(sizeof(uint64_t)) + CMSG_SPACE(sizeof(struct scm_timestamping));
+
+/// the time the dispatched message was received, see `getReceiveTime()`
+static thread_local chrono::steady_clock::time_point receiveTime;
+
+mutex J1939Bus::registryMutex_;
+map<string, weak_ptr<J1939Bus>> J1939Bus::registry_;
+
+/**
+ * @param device: the CAN interface (e.g. "can0")
+ * @return the bus of the given interface, which is shared by all nodes
+ */
+shared_ptr<J1939Bus> J1939Bus::getInstance(const string& device)
+{
+    lock_guard<mutex> lock(registryMutex_);
+    shared_ptr<J1939Bus> pBus = registry_[device].lock();
+    if (!pBus)
+    {
+        pBus = make_shared<J1939Bus>(device);
+        registry_[device] = pBus;
+    }
+    return pBus;
+}
+
+/**
+ * @param buffer: the 8 bytes of an address claim, little endian
+ * @return the NAME of the claim
+ */
+uint64_t J1939Bus::parseName(const uint8_t* buffer) noexcept
+{
+    uint64_t name = 0;
+    for (size_t i = NAME_LENGTH; i > 0; --i)
+    {
+        name = (name << 8) | buffer[i - 1];
+    }
+    return name;
+}
+
+/**
+ * Returns the time the message passed to `J1939Node::processReceivedData()`
+ * was received by the kernel, on the clock of the `RequestTimer`.
+ */
+chrono::steady_clock::time_point J1939Bus::getReceiveTime() noexcept
+{
+    return receiveTime;
+}
+
+/**
+ * Constructor. Opens the promiscuous socket and starts receiving.
+ *
+ * @param device: the CAN interface (e.g. "can0")
+ */
+J1939Bus::J1939Bus(const string& device)
+: device_(device)
+, captureInterface_(TrafficCapture::getInstance().getInterfaceIndex(device))
+{
+    stop_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (stop_fd_ < 0)
+    {
+        LOG_ERROR(__func__ << "() eventfd: " << strerror(errno));
+        throw exception();
+    }
+    receive_skt_ = openSocket(J1939_NO_ADDR, true);
+    if (receive_skt_ < 0)
+    {
+        close(stop_fd_);
+        throw exception();
+    }
+    const int timestamping = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    if (setsockopt(receive_skt_, SOL_SOCKET, SO_TIMESTAMPING, &timestamping, sizeof(timestamping)) < 0)
+    {
+        LOG_WARNING("No J1939 receive timestamps on " << device_ << ": " << strerror(errno));
+    }
+    updateFilter();
+
+    payloads_.resize(RECEIVE_BATCH * MAX_BUFSIZE);
+    controls_.resize(RECEIVE_BATCH * CONTROL_SIZE);
+    messages_.resize(RECEIVE_BATCH);
+    iovecs_.resize(RECEIVE_BATCH);
+    addresses_.resize(RECEIVE_BATCH);
+    for (size_t i = 0; i < RECEIVE_BATCH; ++i)
+    {
+        iovecs_[i].iov_base = payloads_.data() + i * MAX_BUFSIZE;
+        iovecs_[i].iov_len = MAX_BUFSIZE;
+    }
+    thread_ = thread(&J1939Bus::run, this);
+}
+
+/**
+ * Destructor. Stops receiving.
+ */
+J1939Bus::~J1939Bus()
+{
+    const uint64_t value = 1;
+    if (write(stop_fd_, &value, sizeof(value)) < 0)
+    {
+        LOG_ERROR(__func__ << "() write: " << strerror(errno));
+    }
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+    close(receive_skt_);
+    if (null_skt_ >= 0)
+    {
+        close(null_skt_);
+    }
+    close(stop_fd_);
+}
+
+/**
+ * Opens the socket a node sends with. The messages to the node are received
+ * by the promiscuous socket of the bus, so the receive buffer of this socket
+ * is kept minimal and its messages are dropped.
+ *
+ * @param address: the source address of the node
+ * @return the socket or a negative value on errors
+ */
+int J1939Bus::openSendSocket(uint8_t address) const noexcept
+{
+    const int skt = openSocket(address, false);
+    if (skt >= 0)
+    {
+        const int size = 0; // the kernel rounds up to its minimum
+        setsockopt(skt, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    }
+    return skt;
+}
+
+/**
+ * Adds a node to the dispatch table. A node with a NAME claims its address.
+ *
+ * @param pNode: the node, which has to be removed before it is destroyed
+ * @return false if another node of the process already uses the address
+ */
+bool J1939Bus::addNode(J1939Node* pNode)
+{
+    const uint8_t address = pNode->getSourceAddress();
+    lock_guard<mutex> lock(nodesMutex_);
+    NodeEntry& entry = nodes_[address];
+    if (entry.pNode != nullptr)
+    {
+        LOG_ERROR("J1939 address " << hex << unsigned(address) << " is already used on " << device_);
+        return false;
+    }
+    entry.pNode = pNode;
+    entry.hasLost = false;
+    updateFilter();
+    if (pNode->getName() != 0)
+    {
+        sendAddressClaim(pNode->getSendSocket(), address, pNode->getName());
+    }
+    return true;
+}
+
+/**
+ * Removes a node, it is not called any more when this returns.
+ */
+void J1939Bus::removeNode(J1939Node* pNode)
+{
+    lock_guard<mutex> lock(nodesMutex_);
+    NodeEntry& entry = nodes_[pNode->getSourceAddress()];
+    if (entry.pNode == pNode)
+    {
+        entry = NodeEntry();
+        updateFilter();
+    }
+}
+
+/**
+ * @return false if the node lost its address to a node with a lower NAME and
+ *         must not send any more
+ */
+bool J1939Bus::hasAddress(const J1939Node* pNode) const
+{
+    lock_guard<mutex> lock(nodesMutex_);
+    const NodeEntry& entry = nodes_[pNode->getSourceAddress()];
+    return entry.pNode == pNode && !entry.hasLost;
+}
+
+/**
+ * Enlarges the receive buffer of the shared socket (`SO_RCVBUF`), e.g. for a
+ * node which is flooded with transport protocol messages. The buffer is never
+ * shrunk, so the largest size of all nodes wins.
+ *
+ * @param size: the requested size in bytes
+ */
+void J1939Bus::setReceiveBufferSize(int size) noexcept
+{
+    lock_guard<mutex> lock(nodesMutex_);
+    if (size <= receiveBufferSize_)
+    {
+        return;
+    }
+    if (setsockopt(receive_skt_, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)) < 0)
+    {
+        LOG_WARNING(__func__ << "() setsockopt SO_RCVBUF: " << strerror(errno));
+        return;
+    }
+    receiveBufferSize_ = size;
+}
+
+/**
+ * Opens a J1939 socket on the interface.
+ *
+ * @param address: the bound source address, `J1939_NO_ADDR` to only receive
+ * @param isPromiscuous: true to receive all messages of the bus
+ * @return the socket or a negative value on errors
+ */
+int J1939Bus::openSocket(uint8_t address, bool isPromiscuous) const noexcept
+{
+    int skt = socket(PF_CAN, SOCK_DGRAM | SOCK_CLOEXEC, CAN_J1939);
+    if (skt < 0)
+    {
+        LOG_ERROR(__func__ << "() socket: " << strerror(errno));
+        return -1;
+    }
+
+    struct ifreq ifr = {};
+    strncpy(ifr.ifr_name, device_.c_str(), IFNAMSIZ - 1);
+    if (ioctl(skt, SIOCGIFINDEX, &ifr) < 0)
+    {
+        LOG_ERROR(__func__ << "() ioctl: " << strerror(errno));
+        close(skt);
+        return -2;
+    }
+    int value = 1;
+    setsockopt(skt, SOL_SOCKET, SO_BROADCAST, &value, sizeof(value));
+    if (isPromiscuous)
+    {
+        setsockopt(skt, SOL_CAN_J1939, SO_J1939_PROMISC, &value, sizeof(value));
+    }
+
+    struct sockaddr_can addr = {};
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+    addr.can_addr.j1939.pgn = J1939_NO_PGN;
+    addr.can_addr.j1939.name = J1939_NO_NAME;
+    addr.can_addr.j1939.addr = address;
+    if (bind(skt, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        LOG_ERROR(__func__ << "() bind: " << strerror(errno));
+        close(skt);
+        return -3;
+    }
+    return skt;
+}
+
+/**
+ * Installs the PGNs of all nodes and the address claiming as kernel filter of
+ * the receiving socket. Without a filter, if there are too many PGNs, the
+ * whole bus is received. The nodes lock must be held.
+ */
+void J1939Bus::updateFilter() noexcept
+{
+    set<uint32_t> pgns = {J1939_PGN_ADDRESSCLAIMED, J1939_PGN_REQUEST};
+    for (const NodeEntry& entry : nodes_)
+    {
+        if (entry.pNode != nullptr)
+        {
+            for (uint32_t pgn : entry.pNode->getReceivedPgns())
+            {
+                // the kernel passes PDU1 PGNs without their destination address
+                pgns.insert(((pgn >> 8) & 0xFF) < 0xF0 ? pgn & J1939_PGN_PDU1_MAX : pgn & J1939_PGN_MAX);
+            }
+        }
+    }
+
+    vector<struct j1939_filter> filters;
+    if (pgns.size() <= J1939_FILTER_MAX)
+    {
+        for (uint32_t pgn : pgns)
+        {
+            struct j1939_filter filter = {};
+            filter.pgn = pgn;
+            filter.pgn_mask = ((pgn >> 8) & 0xFF) < 0xF0 ? J1939_PGN_PDU1_MAX : J1939_PGN_MAX;
+            filters.push_back(filter);
+        }
+    }
+    else
+    {
+        LOG_WARNING("More than " << J1939_FILTER_MAX << " PGNs on " << device_ << ", receiving all PGNs");
+    }
+    if (setsockopt(receive_skt_, SOL_CAN_J1939, SO_J1939_FILTER, filters.empty() ? nullptr : filters.data(),
+                   socklen_t(filters.size() * sizeof(struct j1939_filter))) < 0)
+    {
+        LOG_ERROR(__func__ << "() setsockopt: " << strerror(errno));
+    }
+}
+
+/**
+ * Broadcasts an address claim (or "Cannot Claim Address" from the NULL
+ * address).
+ */
+void J1939Bus::sendAddressClaim(int skt, uint8_t sourceAddress, uint64_t name) noexcept
+{
+    uint8_t payload[NAME_LENGTH];
+    for (size_t i = 0; i < NAME_LENGTH; ++i)
+    {
+        payload[i] = uint8_t(name >> (8 * i));
+    }
+    struct sockaddr_can saddr = {};
+    saddr.can_family = AF_CAN;
+    saddr.can_addr.j1939.name = J1939_NO_NAME;
+    saddr.can_addr.j1939.addr = J1939_NO_ADDR;
+    saddr.can_addr.j1939.pgn = J1939_PGN_ADDRESSCLAIMED;
+    if (sendto(skt, payload, sizeof(payload), 0, reinterpret_cast<const struct sockaddr*>(&saddr), sizeof(saddr)) < 0)
+    {
+        LOG_ERROR("Unable to claim the J1939 address " << hex << unsigned(sourceAddress) << ": " << strerror(errno));
+        return;
+    }
+    TrafficCapture::getInstance().record(TrafficCapture::Protocol::J1939, TrafficCapture::Direction::TX,
+                                         captureInterface_, J1939_PGN_ADDRESSCLAIMED,
+                                         sourceAddress, J1939_NO_ADDR, payload, sizeof(payload));
+}
+
+/**
+ * Resolves the contention of an address claimed by another node: the lower
+ * NAME wins. The nodes lock must be held.
+ */
+void J1939Bus::handleAddressClaim(uint8_t sourceAddress, uint64_t name) noexcept
+{
+    NodeEntry& entry = nodes_[sourceAddress];
+    if (entry.pNode == nullptr || entry.hasLost)
+    {
+        return;
+    }
+    const uint64_t ownName = entry.pNode->getName();
+    if (ownName == 0 || ownName == name)
+    {
+        return; // a static address or the own claim
+    }
+    if (ownName < name)
+    {
+        sendAddressClaim(entry.pNode->getSendSocket(), sourceAddress, ownName);
+        return;
+    }
+
+    LOG_WARNING("J1939 address " << hex << unsigned(sourceAddress) << " lost to the NAME " << name);
+    entry.hasLost = true;
+    if (null_skt_ < 0)
+    {
+        null_skt_ = openSocket(J1939_NULL_ADDRESS, false);
+    }
+    if (null_skt_ >= 0)
+    {
+        sendAddressClaim(null_skt_, J1939_NULL_ADDRESS, ownName);
+    }
+}
+
+/**
+ * Answers a request for the address claims, sent to one node or to all. The
+ * nodes lock must be held.
+ */
+void J1939Bus::handleClaimRequest(uint8_t destinationAddress) noexcept
+{
+    for (size_t address = 0; address < nodes_.size(); ++address)
+    {
+        const NodeEntry& entry = nodes_[address];
+        if (entry.pNode == nullptr || entry.pNode->getName() == 0 || entry.hasLost)
+        {
+            continue;
+        }
+        if (destinationAddress == J1939_NO_ADDR || destinationAddress == address)
+        {
+            sendAddressClaim(entry.pNode->getSendSocket(), uint8_t(address), entry.pNode->getName());
+        }
+    }
+}
+
+/**
+ * Passes a received message to its destination node or, for broadcasts, to
+ * all nodes except the sender. The address claims are handled here.
+ *
+ * @return false if the message was sent by a node of the simulator, e.g. one
+ *         of its cyclic PGNs
+ */
+bool J1939Bus::dispatch(const uint8_t* buffer, size_t num_bytes, uint8_t sourceAddress,
+                        uint8_t destinationAddress, uint32_t pgn) noexcept
+{
+    TrafficCapture::getInstance().record(TrafficCapture::Protocol::J1939, TrafficCapture::Direction::RX,
+                                         captureInterface_, pgn, sourceAddress, destinationAddress,
+                                         buffer, num_bytes);
+
+    // the nodes are not removed while they handle a message
+    lock_guard<mutex> lock(nodesMutex_);
+    const bool isForeign = nodes_[sourceAddress].pNode == nullptr;
+    if (pgn == J1939_PGN_ADDRESSCLAIMED)
+    {
+        if (num_bytes >= NAME_LENGTH)
+        {
+            handleAddressClaim(sourceAddress, parseName(buffer));
+        }
+        return isForeign;
+    }
+    if (pgn == J1939_PGN_REQUEST && num_bytes >= 3
+        && (buffer[0] | (buffer[1] << 8) | (buffer[2] << 16)) == int(J1939_PGN_ADDRESSCLAIMED))
+    {
+        handleClaimRequest(destinationAddress);
+        return isForeign;
+    }
+
+    if (destinationAddress != J1939_NO_ADDR)
+    {
+        const NodeEntry& entry = nodes_[destinationAddress];
+        if (entry.pNode != nullptr && !entry.hasLost && destinationAddress != sourceAddress)
+        {
+            entry.pNode->processReceivedData(buffer, num_bytes, sourceAddress, pgn);
+        }
+        return isForeign;
+    }
+    for (size_t address = 0; address < nodes_.size(); ++address)
+    {
+        const NodeEntry& entry = nodes_[address];
+        if (entry.pNode != nullptr && !entry.hasLost && address != sourceAddress)
+        {
+            entry.pNode->processReceivedData(buffer, num_bytes, sourceAddress, pgn);
+        }
+    }
+    return isForeign;
+}
+
+/**
+ * Reads the pending messages with one `recvmmsg()` and dispatches them.
+ */
+void J1939Bus::receiveBatch() noexcept
+{
+    for (size_t i = 0; i < RECEIVE_BATCH; ++i)
+    {
+        struct msghdr& header = messages_[i].msg_hdr;
+        header.msg_name = &addresses_[i];
+        header.msg_namelen = sizeof(addresses_[i]);
+        header.msg_iov = &iovecs_[i];
+        header.msg_iovlen = 1;
+        header.msg_control = controls_.data() + i * CONTROL_SIZE;
+        header.msg_controllen = CONTROL_SIZE;
+        header.msg_flags = 0;
+    }
+    const int count = recvmmsg(receive_skt_, messages_.data(), RECEIVE_BATCH, MSG_DONTWAIT, nullptr);
+    if (count < 0)
+    {
+        if (errno != EAGAIN && errno != EINTR)
+        {
+            LOG_ERROR(__func__ << "() recvmmsg: " << strerror(errno));
+        }
+        return;
+    }
+
+    // the kernel timestamps are on the realtime clock
+    const chrono::steady_clock::time_point steadyNow = chrono::steady_clock::now();
+    struct timespec realtimeNow;
+    clock_gettime(CLOCK_REALTIME, &realtimeNow);
+
+    bool hasForeignMessage = false;
+    for (int i = 0; i < count; ++i)
+    {
+        struct msghdr& header = messages_[i].msg_hdr;
+        uint8_t destinationAddress = J1939_NO_ADDR;
+        receiveTime = steadyNow;
+        for (struct cmsghdr *pCmsg = CMSG_FIRSTHDR(&header); pCmsg != nullptr; pCmsg = CMSG_NXTHDR(&header, pCmsg))
+        {
+            if (pCmsg->cmsg_level == SOL_CAN_J1939 && pCmsg->cmsg_type == SCM_J1939_DEST_ADDR)
+            {
+                destinationAddress = *CMSG_DATA(pCmsg);
+            }
+            else if (pCmsg->cmsg_level == SOL_SOCKET && pCmsg->cmsg_type == SCM_TIMESTAMPING)
+            {
+                struct scm_timestamping timestamps;
+                memcpy(&timestamps, CMSG_DATA(pCmsg), sizeof(timestamps));
+                const int64_t delayNs = (int64_t(realtimeNow.tv_sec) - timestamps.ts[0].tv_sec) * 1000000000
+                                      + (int64_t(realtimeNow.tv_nsec) - timestamps.ts[0].tv_nsec);
+                if (delayNs > 0)
+                {
+                    receiveTime = steadyNow - chrono::nanoseconds(delayNs);
+                }
+            }
+        }
+        const struct sockaddr_can& saddr = addresses_[i];
+        hasForeignMessage |= dispatch(payloads_.data() + i * MAX_BUFSIZE, messages_[i].msg_len,
+                                      saddr.can_addr.j1939.addr, destinationAddress, saddr.can_addr.j1939.pgn);
+    }
+    // the own cyclic PGNs do not keep the simulator awake
+    if (hasForeignMessage)
+    {
+        IdleMonitor::getInstance().notifyActivity();
+    }
+}
+
+void J1939Bus::run() noexcept
+{
+    ThreadPlacement::getInstance().apply(ThreadRole::IO);
+    struct pollfd fds[2] = {{stop_fd_, POLLIN, 0}, {receive_skt_, POLLIN, 0}};
+
+    while (true)
+    {
+        const int result = RealTimeProfile::poll(fds, 2);
+        if (result < 0 && errno != EINTR)
+        {
+            LOG_ERROR(__func__ << "() poll: " << strerror(errno));
+            return;
+        }
+        if (fds[0].revents & POLLIN)
+        {
+            return;
+        }
+        if (fds[1].revents & POLLIN)
+        {
+            receiveBatch();
+        }
+    }
+}
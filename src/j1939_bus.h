@@ -0,0 +1,141 @@
+/**
+ * @file j1939_bus.h
+ *
+ */
+
+#ifndef J1939_BUS_H
+#define J1939_BUS_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <linux/can.h>
+
+constexpr std::uint32_t J1939_PGN_ADDRESSCLAIMED = 0xEE00;
+constexpr std::uint8_t J1939_NULL_ADDRESS = 0xFE; ///< the source of "Cannot Claim Address"
+
+/**
+ * A simulated J1939 node on a `J1939Bus`, implemented by the `J1939Simulator`.
+ */
+class J1939Node
+{
+public:
+    virtual ~J1939Node() = default;
+
+    /**
+     * @return the source address of the node
+     */
+    virtual std::uint8_t getSourceAddress() const noexcept = 0;
+
+    /**
+     * @return the 64 bit NAME of the node, 0 if it does not claim its address
+     */
+    virtual std::uint64_t getName() const noexcept = 0;
+
+    /**
+     * @return the J1939 socket bound to the source address, which is used to
+     *         send the address claims
+     */
+    virtual int getSendSocket() const noexcept = 0;
+
+    /**
+     * @return the PGNs handled by the node. The bus installs them as kernel
+     *         filter, so the other messages of the bus are not received.
+     */
+    virtual std::vector<std::uint32_t> getReceivedPgns() const = 0;
+
+    /**
+     * Handles a message to the node or a broadcast, called by the receiver
+     * thread of the bus.
+     */
+    virtual void processReceivedData(const std::uint8_t* buffer, std::size_t num_bytes,
+                                     std::uint8_t sourceAddress, std::uint32_t pgn) noexcept = 0;
+};
+
+/**
+ * Receives the J1939 messages of all simulated nodes of one CAN interface.
+ *
+ * A single promiscuous J1939 socket and thread receive all messages of the
+ * bus. The messages are dispatched by their destination address through a
+ * table of the nodes, broadcasts are passed to every node except the sender.
+ * The nodes send with their own socket bound to their source address, so the
+ * number of threads does not grow with the number of nodes.
+ *
+ * The socket only receives the PGNs handled by the nodes (`SO_J1939_FILTER`),
+ * the messages are read in batches with `recvmmsg()` and carry the kernel
+ * receive timestamp, see `getReceiveTime()`.
+ *
+ * Nodes with a NAME claim their address (PGN 0xEE00) when they are added and
+ * on request. A node which loses the contention against a lower NAME sends
+ * "Cannot Claim Address" and stays silent, it does not pick another address.
+ */
+class J1939Bus
+{
+public:
+    static std::shared_ptr<J1939Bus> getInstance(const std::string& device);
+    static std::uint64_t parseName(const std::uint8_t* buffer) noexcept;
+    static std::chrono::steady_clock::time_point getReceiveTime() noexcept;
+
+public:
+    J1939Bus() = delete;
+    explicit J1939Bus(const std::string& device);
+    J1939Bus(const J1939Bus& orig) = delete;
+    J1939Bus& operator =(const J1939Bus& orig) = delete;
+    virtual ~J1939Bus();
+
+    int openSendSocket(std::uint8_t address) const noexcept;
+    bool addNode(J1939Node* pNode);
+    void removeNode(J1939Node* pNode);
+    bool hasAddress(const J1939Node* pNode) const;
+    void setReceiveBufferSize(int size) noexcept;
+
+private:
+    /// the node of a source address
+    struct NodeEntry
+    {
+        J1939Node* pNode = nullptr;
+        bool hasLost = false; ///< lost the address claim contention
+    };
+
+    static std::mutex registryMutex_;
+    static std::map<std::string, std::weak_ptr<J1939Bus>> registry_;
+
+    std::string device_;
+    std::uint8_t captureInterface_; ///< see `TrafficCapture::getInterfaceIndex()`
+    int receive_skt_ = -1; ///< promiscuous, receives all messages of the bus
+    int null_skt_ = -1; ///< bound to the NULL address, opened on the first lost claim
+    int receiveBufferSize_ = 0; ///< the largest `SO_RCVBUF` of the nodes, 0 = the kernel default
+    int stop_fd_ = -1;
+    std::thread thread_;
+
+    mutable std::mutex nodesMutex_;
+    std::array<NodeEntry, 256> nodes_; ///< indexed by the source address
+
+    // buffers for `recvmmsg()`, only used by the receiver thread
+    std::vector<std::uint8_t> payloads_;
+    std::vector<char> controls_;
+    std::vector<struct mmsghdr> messages_;
+    std::vector<struct iovec> iovecs_;
+    std::vector<struct sockaddr_can> addresses_;
+
+    int openSocket(std::uint8_t address, bool isPromiscuous) const noexcept;
+    void updateFilter() noexcept;
+    void receiveBatch() noexcept;
+    void sendAddressClaim(int skt, std::uint8_t sourceAddress, std::uint64_t name) noexcept;
+    void handleAddressClaim(std::uint8_t sourceAddress, std::uint64_t name) noexcept;
+    void handleClaimRequest(std::uint8_t destinationAddress) noexcept;
+    bool dispatch(const std::uint8_t* buffer, std::size_t num_bytes, std::uint8_t sourceAddress,
+                  std::uint8_t destinationAddress, std::uint32_t pgn) noexcept;
+    void run() noexcept;
+};
+
+#endif /* J1939_BUS_H */
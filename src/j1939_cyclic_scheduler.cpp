@@ -0,0 +1,853 @@
+/**
+ * @file j1939_cyclic_scheduler.cpp
+ *
+ * This file contains the scheduler sending the cyclic PGNs of all J1939
+ * simulations.
+ */
+
+#include "j1939_cyclic_scheduler.h"
+#include "bus_load_budget.h"
+#include "can/j1939.h"
+#include "idle_monitor.h"
+#include "logger.h"
+#include "thread_placement.h"
+#include "traffic_capture.h"
+#include "vehicle_signals.h"
+#include <linux/can/bcm.h>
+#include <net/if.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+using namespace std;
+
+constexpr uint64_t NS_PER_MS = 1000000;
+/// the priority of the J1939 socket for the offloaded PGNs, see `SO_J1939_SEND_PRIO`
+constexpr uint32_t J1939_DEFAULT_PRIORITY = 6;
+
+atomic<bool> J1939CyclicScheduler::isOffloadEnabled_{false};
+
+/**
+ * @param length: the payload of a PGN
+ * @return the nominal bits of the PGN on the bus, incl. the frames of the
+ *         transport protocol if it is longer than a frame
+ */
+static size_t getTransmissionBits(size_t length) noexcept
+{
+    if (length <= CAN_MAX_DLEN)
+    {
+        return BusLoadBudget::getFrameBits(CAN_EFF_FLAG, length);
+    }
+    // the connection management and the data transfer frames of 7 bytes each
+    const size_t frames = 1 + (length + 6) / 7;
+    return frames * BusLoadBudget::getFrameBits(CAN_EFF_FLAG, CAN_MAX_DLEN);
+}
+
+/**
+ * @param index: the index within the sequence
+ * @return the element of the van der Corput sequence (0, 1/2, 1/4, 3/4,
+ *         1/8, ...), which fills the gaps of its previous elements
+ */
+static double getVanDerCorput(uint32_t index) noexcept
+{
+    double value = 0;
+    for (double fraction = 0.5; index > 0; index >>= 1, fraction /= 2)
+    {
+        value += (index & 1) ? fraction : 0;
+    }
+    return value;
+}
+
+/**
+ * A message to the broadcast manager with a single frame.
+ */
+union BcmMessage
+{
+    struct bcm_msg_head head;
+    uint8_t bytes[sizeof(struct bcm_msg_head) + sizeof(struct can_frame)];
+};
+
+/**
+ * @return the scheduler shared by all J1939 simulations
+ */
+J1939CyclicScheduler& J1939CyclicScheduler::getInstance()
+{
+    static J1939CyclicScheduler scheduler;
+    return scheduler;
+}
+
+/**
+ * Constructor. Starts the scheduler thread.
+ */
+J1939CyclicScheduler::J1939CyclicScheduler()
+: waiter_([this]()
+    {
+        if (wakeup_fd_ >= 0)
+        {
+            wakeup();
+        }
+    })
+{
+    timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    wakeup_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (timer_fd_ < 0 || wakeup_fd_ < 0)
+    {
+        LOG_ERROR(__func__ << "() " << strerror(errno));
+        if (timer_fd_ >= 0)
+        {
+            close(timer_fd_);
+        }
+        if (wakeup_fd_ >= 0)
+        {
+            close(wakeup_fd_);
+        }
+        throw exception();
+    }
+    IdleMonitor& idleMonitor = IdleMonitor::getInstance();
+    idleListenerId_ = idleMonitor.addListener([this](bool isAwake)
+    {
+        {
+            lock_guard<mutex> lock(mutex_);
+            isAsleep_ = !isAwake;
+        }
+        wakeup();
+    });
+    {
+        lock_guard<mutex> lock(mutex_);
+        isAsleep_ = !idleMonitor.isAwake();
+    }
+    thread_ = thread(&J1939CyclicScheduler::run, this);
+    signalListenerId_ = VehicleSignals::getInstance().addUpdateListener([this]()
+    {
+        if (offloadedCount_ > 0)
+        {
+            hasSignalUpdate_ = true;
+            wakeup();
+        }
+    });
+}
+
+/**
+ * Destructor. Stops the scheduler thread and drops all PGNs.
+ */
+J1939CyclicScheduler::~J1939CyclicScheduler()
+{
+    VehicleSignals::getInstance().removeUpdateListener(signalListenerId_);
+    IdleMonitor::getInstance().removeListener(idleListenerId_);
+    {
+        lock_guard<mutex> lock(mutex_);
+        isOnExit_ = true;
+    }
+    wakeup();
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+    for (CyclicPGN* pCyclicPGN : heap_)
+    {
+        delete pCyclicPGN;
+    }
+    for (CyclicPGN* pCyclicPGN : offloaded_)
+    {
+        delete pCyclicPGN;
+    }
+    // closing a `CAN_BCM` socket deletes its transmissions
+    for (const auto& bcmSocket : bcmSockets_)
+    {
+        if (bcmSocket.second >= 0)
+        {
+            close(bcmSocket.second);
+        }
+    }
+    close(timer_fd_);
+    close(wakeup_fd_);
+}
+
+/**
+ * Enables or disables sending the static cyclic PGNs by the kernel (`CAN_BCM`).
+ * Disabled on default, set before the simulations are started.
+ */
+void J1939CyclicScheduler::setOffloadEnabled(bool isEnabled) noexcept
+{
+    isOffloadEnabled_ = isEnabled;
+}
+
+/**
+ * Adds a cyclic PGN. It is sent immediately (or after its phase, see
+ * `getPhaseNs()`) and then with the cycle time returned by
+ * `J1939CyclicSource::getCyclicPayload()`.
+ *
+ * @param pSource: the simulation sending the PGN
+ * @param pgnKey: the PGN as defined in the simulation
+ * @param pgn: the numeric PGN
+ */
+void J1939CyclicScheduler::addPGN(J1939CyclicSource* pSource, const string& pgnKey, uint32_t pgn)
+{
+    CyclicPGN* pCyclicPGN = new CyclicPGN();
+    pCyclicPGN->pSource = pSource;
+    pCyclicPGN->pgnKey = pgnKey;
+    pCyclicPGN->pgn = pgn;
+    pCyclicPGN->deadlineNs = getNowNs();
+    {
+        lock_guard<mutex> lock(mutex_);
+        heap_.push_back(pCyclicPGN);
+        push_heap(heap_.begin(), heap_.end(), isLater);
+    }
+    wakeup();
+}
+
+/**
+ * Tells the scheduler that the payload or cycle time of an offloaded PGN
+ * changed. The PGN is read from the simulation again right away and the
+ * transmission of the kernel is updated. Does nothing for the PGNs sent by
+ * the scheduler thread, since these are read on every cycle anyway.
+ *
+ * @param pSource: the simulation sending the PGN
+ * @param pgn: the numeric PGN
+ */
+void J1939CyclicScheduler::updatePGN(J1939CyclicSource* pSource, uint32_t pgn)
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        auto iter = find_if(offloaded_.begin(), offloaded_.end(), [pSource, pgn](const CyclicPGN* pCyclicPGN)
+        {
+            return pCyclicPGN->pSource == pSource && pCyclicPGN->pgn == pgn;
+        });
+        if (iter == offloaded_.end())
+        {
+            return;
+        }
+        (*iter)->deadlineNs = getNowNs();
+        heap_.push_back(*iter);
+        push_heap(heap_.begin(), heap_.end(), isLater);
+        offloaded_.erase(iter);
+        offloadedCount_ = offloaded_.size();
+    }
+    wakeup();
+}
+
+/**
+ * Tells the scheduler that all offloaded PGNs of a simulation have to be read
+ * again, e.g. since `J1939CyclicSource::isBusActive()` changed. The kernel
+ * stops sending them while the source is not active.
+ *
+ * @param pSource: the simulation sending the PGNs
+ */
+void J1939CyclicScheduler::updateSource(J1939CyclicSource* pSource)
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        const uint64_t nowNs = getNowNs();
+        auto iter = stable_partition(offloaded_.begin(), offloaded_.end(), [pSource](const CyclicPGN* pCyclicPGN)
+        {
+            return pCyclicPGN->pSource != pSource;
+        });
+        if (iter == offloaded_.end())
+        {
+            return;
+        }
+        for (auto moved = iter; moved != offloaded_.end(); ++moved)
+        {
+            (*moved)->deadlineNs = nowNs;
+            heap_.push_back(*moved);
+            push_heap(heap_.begin(), heap_.end(), isLater);
+        }
+        offloaded_.erase(iter, offloaded_.end());
+        offloadedCount_ = offloaded_.size();
+    }
+    wakeup();
+}
+
+/**
+ * Removes all PGNs of the given simulation and waits until the scheduler
+ * does not use it anymore. Must not be called from within the callbacks of
+ * `J1939CyclicSource`.
+ *
+ * @param pSource: the simulation to remove
+ */
+void J1939CyclicScheduler::removeSource(J1939CyclicSource* pSource)
+{
+    unique_lock<mutex> lock(mutex_);
+    auto isRemoved = [this, pSource](CyclicPGN* pCyclicPGN)
+    {
+        if (pCyclicPGN->pSource != pSource)
+        {
+            return false;
+        }
+        stopOffload(pCyclicPGN);
+        delete pCyclicPGN;
+        return true;
+    };
+    heap_.erase(remove_if(heap_.begin(), heap_.end(), isRemoved), heap_.end());
+    make_heap(heap_.begin(), heap_.end(), isLater);
+    offloaded_.erase(remove_if(offloaded_.begin(), offloaded_.end(), isRemoved), offloaded_.end());
+    offloadedCount_ = offloaded_.size();
+
+    // the PGNs being sent right now are deleted by the scheduler thread
+    for (CyclicPGN* pCyclicPGN : due_)
+    {
+        if (pCyclicPGN->pSource == pSource)
+        {
+            pCyclicPGN->isRemoved = true;
+        }
+    }
+    condition_.wait(lock, [this]() { return !isProcessing_; });
+}
+
+/**
+ * @param pSource: the simulation sending the PGNs
+ * @return the statistics of all cyclic PGNs of the given simulation
+ */
+map<uint32_t, J1939CyclicScheduler::Statistics> J1939CyclicScheduler::getStatistics(const J1939CyclicSource* pSource) const
+{
+    map<uint32_t, Statistics> statistics;
+    lock_guard<mutex> lock(mutex_);
+    for (const vector<CyclicPGN*>* pPGNs : {&heap_, &due_, &offloaded_})
+    {
+        for (const CyclicPGN* pCyclicPGN : *pPGNs)
+        {
+            if (pCyclicPGN->pSource == pSource && !pCyclicPGN->isRemoved)
+            {
+                statistics[pCyclicPGN->pgn] = pCyclicPGN->statistics;
+            }
+        }
+    }
+    return statistics;
+}
+
+/**
+ * Returns the phases of the cyclic PGNs of a simulation, i.e. the time until
+ * their next transmission, e.g. for a `Checkpoint`. The offloaded PGNs and
+ * the ones being sent right now have no phase.
+ *
+ * @param pSource: the simulation sending the PGNs
+ * @return the nanoseconds until the next deadline by PGN
+ */
+map<uint32_t, uint64_t> J1939CyclicScheduler::getPhases(const J1939CyclicSource* pSource) const
+{
+    map<uint32_t, uint64_t> phases;
+    const uint64_t nowNs = getNowNs();
+    lock_guard<mutex> lock(mutex_);
+    for (const CyclicPGN* pCyclicPGN : heap_)
+    {
+        if (pCyclicPGN->pSource == pSource)
+        {
+            phases[pCyclicPGN->pgn] = pCyclicPGN->deadlineNs > nowNs ? pCyclicPGN->deadlineNs - nowNs : 0;
+        }
+    }
+    return phases;
+}
+
+/**
+ * Moves the next deadlines of the cyclic PGNs of a simulation, so they are
+ * sent with the phases returned by `getPhases()`. The PGNs without phase are
+ * not changed.
+ *
+ * @param pSource: the simulation sending the PGNs
+ * @param phases: the nanoseconds until the next deadline by PGN
+ */
+void J1939CyclicScheduler::setPhases(const J1939CyclicSource* pSource, const map<uint32_t, uint64_t>& phases)
+{
+    const uint64_t nowNs = getNowNs();
+    {
+        lock_guard<mutex> lock(mutex_);
+        for (CyclicPGN* pCyclicPGN : heap_)
+        {
+            const auto phase = phases.find(pCyclicPGN->pgn);
+            if (pCyclicPGN->pSource == pSource && phase != phases.end())
+            {
+                pCyclicPGN->deadlineNs = nowNs + phase->second;
+                pCyclicPGN->isPhased = true;
+            }
+        }
+        make_heap(heap_.begin(), heap_.end(), isLater);
+    }
+    wakeup();
+}
+
+uint64_t J1939CyclicScheduler::getNowNs() noexcept
+{
+    const auto now = SimulationClock::getInstance().now().time_since_epoch();
+    return uint64_t(chrono::duration_cast<chrono::nanoseconds>(now).count());
+}
+
+void J1939CyclicScheduler::wakeup() noexcept
+{
+    const uint64_t value = 1;
+    if (write(wakeup_fd_, &value, sizeof(value)) < 0)
+    {
+        LOG_ERROR(__func__ << "() write: " << strerror(errno));
+    }
+}
+
+/**
+ * Sleeps until the deadline of the earliest PGN or until `wakeup()` is
+ * called, without a deadline while the simulator sleeps. The lock is
+ * released while sleeping.
+ */
+void J1939CyclicScheduler::waitForDeadline(unique_lock<mutex>& lock)
+{
+    struct itimerspec deadline = {};
+    if (!heap_.empty() && !isAsleep_)
+    {
+        SimulationClock& clock = SimulationClock::getInstance();
+        const SimulationClock::TimePoint deadlineTime(chrono::nanoseconds(heap_.front()->deadlineNs));
+        waiter_.setDeadline(deadlineTime);
+        // the timerfd runs in real time
+        const uint64_t realNs = uint64_t(max<int64_t>(1, chrono::duration_cast<chrono::nanoseconds>(
+            clock.toRealTime(deadlineTime).time_since_epoch()).count()));
+        deadline.it_value.tv_sec = time_t(realNs / 1000000000ull);
+        deadline.it_value.tv_nsec = long(realNs % 1000000000ull);
+    }
+    else
+    {
+        waiter_.clearDeadline();
+    }
+    // an all-zero value disarms the timer
+    timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &deadline, nullptr);
+
+    lock.unlock();
+    struct pollfd fds[2] = {{timer_fd_, POLLIN, 0}, {wakeup_fd_, POLLIN, 0}};
+    if (poll(fds, 2, -1) < 0 && errno != EINTR)
+    {
+        LOG_ERROR(__func__ << "() poll: " << strerror(errno));
+    }
+    uint64_t value;
+    while (read(timer_fd_, &value, sizeof(value)) > 0) { }
+    while (read(wakeup_fd_, &value, sizeof(value)) > 0) { }
+    lock.lock();
+}
+
+/**
+ * Sends all due PGNs, grouped by their simulation (i.e. socket).
+ */
+void J1939CyclicScheduler::sendDue()
+{
+    stable_sort(due_.begin(), due_.end(), [](const CyclicPGN* pLeft, const CyclicPGN* pRight)
+    {
+        return pLeft->pSource < pRight->pSource;
+    });
+
+    auto first = due_.begin();
+    while (first != due_.end())
+    {
+        auto last = find_if(first, due_.end(), [first](const CyclicPGN* pCyclicPGN)
+        {
+            return pCyclicPGN->pSource != (*first)->pSource;
+        });
+        sendBatch(first, last);
+        first = last;
+    }
+}
+
+/**
+ * Sends the given PGNs, which all belong to the same simulation, with a single
+ * `sendmmsg()`.
+ */
+void J1939CyclicScheduler::sendBatch(vector<CyclicPGN*>::iterator first,
+                                     vector<CyclicPGN*>::iterator last)
+{
+    J1939CyclicSource* pSource = (*first)->pSource;
+    const bool isActive = pSource->isBusActive();
+    const string device = pSource->getCyclicDevice();
+
+    messages_.clear();
+    iovecs_.clear();
+    addresses_.clear();
+    vector<CyclicPGN*> batch;
+    for (auto iter = first; iter != last; ++iter)
+    {
+        CyclicPGN* pCyclicPGN = *iter;
+        unsigned int cycleTime = 0;
+        pSource->getCyclicPayload(pCyclicPGN->pgnKey, pCyclicPGN->pgn, pCyclicPGN->payload, cycleTime);
+        pCyclicPGN->periodNs = uint64_t(cycleTime) * NS_PER_MS;
+        pCyclicPGN->isSent = false;
+        pCyclicPGN->canOffload = false;
+        if (!pCyclicPGN->isPhased && cycleTime > 0)
+        {
+            pCyclicPGN->isPhased = true;
+            pCyclicPGN->deferNs = getPhaseNs(device, pCyclicPGN->periodNs);
+            if (pCyclicPGN->deferNs > 0)
+            {
+                continue;
+            }
+        }
+        pCyclicPGN->canOffload = isOffloadEnabled_ && !pCyclicPGN->isOffloadFailed && isActive
+            && cycleTime > 0 && pCyclicPGN->payload.size() <= CAN_MAX_DLEN
+            && pSource->isStaticPayload(pCyclicPGN->pgn);
+        // the kernel sends the PGNs to offload, see `offload()`
+        if (isActive && cycleTime > 0 && !pCyclicPGN->canOffload)
+        {
+            batch.push_back(pCyclicPGN);
+        }
+    }
+
+    // fill the buffers after the sizes are known, since the headers point into them
+    iovecs_.resize(batch.size());
+    addresses_.resize(batch.size());
+    messages_.resize(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i)
+    {
+        addresses_[i] = {};
+        addresses_[i].can_family = AF_CAN;
+        addresses_[i].can_addr.j1939.name = J1939_NO_NAME;
+        addresses_[i].can_addr.j1939.pgn = batch[i]->pgn;
+        addresses_[i].can_addr.j1939.addr = 0xff;
+        iovecs_[i].iov_base = batch[i]->payload.data();
+        iovecs_[i].iov_len = batch[i]->payload.size();
+        messages_[i] = {};
+        messages_[i].msg_hdr.msg_name = &addresses_[i];
+        messages_[i].msg_hdr.msg_namelen = sizeof(addresses_[i]);
+        messages_[i].msg_hdr.msg_iov = &iovecs_[i];
+        messages_[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    const int skt = pSource->getCyclicSocket();
+    size_t numSent = 0;
+    while (numSent < batch.size())
+    {
+        const int result = sendmmsg(skt, messages_.data() + numSent,
+                                    static_cast<unsigned int>(batch.size() - numSent),
+                                    MSG_DONTWAIT);
+        if (result <= 0)
+        {
+            LOG_WARNING("Unable to send PGN " << dec << batch[numSent]->pgn << ": " << strerror(errno));
+            break;
+        }
+        numSent += size_t(result);
+    }
+
+    const uint64_t sentAtNs = getNowNs();
+    for (auto iter = first; iter != last; ++iter)
+    {
+        (*iter)->sentAtNs = sentAtNs;
+    }
+    shared_ptr<BusLoadBudget>& pBudget = budgets_[device];
+    if (!pBudget && !device.empty())
+    {
+        pBudget = BusLoadBudget::getInstance(device);
+    }
+    const uint64_t budgetNowNs = BusLoadBudget::getNowNs();
+    TrafficCapture& capture = TrafficCapture::getInstance();
+    for (size_t i = 0; i < numSent; ++i)
+    {
+        if (pBudget)
+        {
+            pBudget->consume(getTransmissionBits(batch[i]->payload.size()), budgetNowNs);
+        }
+        batch[i]->isSent = true;
+        capture.record(TrafficCapture::Protocol::J1939, TrafficCapture::Direction::TX,
+                       pSource->getCaptureInterface(), batch[i]->pgn,
+                       pSource->getCyclicSourceAddress(), J1939_NO_ADDR,
+                       batch[i]->payload.data(), batch[i]->payload.size());
+    }
+}
+
+/**
+ * Returns the phase of the next PGN with the given cycle time on an
+ * interface: the first one has none, the next ones fill the largest gap
+ * within the period. Only called by the scheduler thread.
+ *
+ * @param device: the CAN interface of the PGN
+ * @param periodNs: the cycle time of the PGN
+ * @return the time the first transmission of the PGN is deferred
+ */
+uint64_t J1939CyclicScheduler::getPhaseNs(const string& device, uint64_t periodNs)
+{
+    uint32_t& slot = phaseSlots_[make_pair(device, periodNs)];
+    return uint64_t(double(periodNs) * getVanDerCorput(slot++));
+}
+
+/**
+ * Updates the statistics of a sent PGN and calculates its next deadline.
+ */
+void J1939CyclicScheduler::reschedule(CyclicPGN* pCyclicPGN, uint64_t nowNs) noexcept
+{
+    Statistics& statistics = pCyclicPGN->statistics;
+    if (pCyclicPGN->isSent)
+    {
+        const uint64_t jitterUs = (pCyclicPGN->sentAtNs - pCyclicPGN->deadlineNs) / 1000;
+        statistics.sent++;
+        statistics.totalJitterUs += jitterUs;
+        statistics.maxJitterUs = max(statistics.maxJitterUs, jitterUs);
+    }
+    else
+    {
+        statistics.dropped++;
+    }
+
+    uint64_t deadlineNs = pCyclicPGN->deadlineNs + pCyclicPGN->periodNs;
+    if (deadlineNs <= nowNs)
+    {
+        const uint64_t missed = (nowNs - deadlineNs) / pCyclicPGN->periodNs + 1;
+        statistics.overruns += missed;
+        deadlineNs += missed * pCyclicPGN->periodNs;
+    }
+    pCyclicPGN->deadlineNs = deadlineNs;
+    heap_.push_back(pCyclicPGN);
+    push_heap(heap_.begin(), heap_.end(), isLater);
+}
+
+/**
+ * Moves all offloaded PGNs back into the heap as due, so their payloads are
+ * read again, e.g. after the vehicle signals changed. The transmissions of
+ * the kernel are only updated if the payload differs, see `offload()`.
+ */
+void J1939CyclicScheduler::refreshOffloaded(uint64_t nowNs)
+{
+    for (CyclicPGN* pCyclicPGN : offloaded_)
+    {
+        pCyclicPGN->deadlineNs = nowNs;
+        heap_.push_back(pCyclicPGN);
+        push_heap(heap_.begin(), heap_.end(), isLater);
+    }
+    offloaded_.clear();
+    offloadedCount_ = 0;
+}
+
+/**
+ * Moves the offloaded PGNs back into the heap and stops their transmissions,
+ * while the simulator sleeps. Their deadlines stay untouched, see `resume()`.
+ */
+void J1939CyclicScheduler::park()
+{
+    for (CyclicPGN* pCyclicPGN : offloaded_)
+    {
+        stopOffload(pCyclicPGN);
+        heap_.push_back(pCyclicPGN);
+        push_heap(heap_.begin(), heap_.end(), isLater);
+    }
+    offloaded_.clear();
+    offloadedCount_ = 0;
+}
+
+/**
+ * Moves the deadlines missed while the simulator slept by whole periods, so
+ * the PGNs continue with their phases and the skipped transmissions are not
+ * counted as overruns.
+ */
+void J1939CyclicScheduler::resume(uint64_t nowNs)
+{
+    for (CyclicPGN* pCyclicPGN : heap_)
+    {
+        if (pCyclicPGN->deadlineNs >= nowNs)
+        {
+            continue;
+        }
+        if (pCyclicPGN->periodNs > 0)
+        {
+            const uint64_t missed = (nowNs - pCyclicPGN->deadlineNs) / pCyclicPGN->periodNs + 1;
+            pCyclicPGN->deadlineNs += missed * pCyclicPGN->periodNs;
+        }
+        else
+        {
+            pCyclicPGN->deadlineNs = nowNs;
+        }
+    }
+    make_heap(heap_.begin(), heap_.end(), isLater);
+}
+
+/**
+ * @param device: the CAN interface, e.g. "can0"
+ * @return the `CAN_BCM` socket of the interface, opened on the first call,
+ *         or -1 if the interface has no broadcast manager
+ */
+int J1939CyclicScheduler::getBcmSocket(const string& device) noexcept
+{
+    auto iter = bcmSockets_.find(device);
+    if (iter != bcmSockets_.end())
+    {
+        return iter->second;
+    }
+
+    int skt = socket(PF_CAN, SOCK_DGRAM | SOCK_CLOEXEC, CAN_BCM);
+    struct sockaddr_can addr = {};
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = int(if_nametoindex(device.c_str()));
+    if (skt < 0 || addr.can_ifindex == 0
+        || connect(skt, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        LOG_WARNING("Can not offload the cyclic PGNs of " << device << ": " << strerror(errno));
+        if (skt >= 0)
+        {
+            close(skt);
+            skt = -1;
+        }
+    }
+    bcmSockets_[device] = skt;
+    return skt;
+}
+
+/**
+ * Hands a cyclic PGN over to the broadcast manager or updates its
+ * transmission. The kernel sends the first frame right away, the timer is
+ * only restarted if the cycle time changed.
+ *
+ * @return false if the PGN has to be sent by the scheduler thread, e.g.
+ *         because the interface has no broadcast manager
+ */
+bool J1939CyclicScheduler::offload(CyclicPGN* pCyclicPGN) noexcept
+{
+    const bool isOffloaded = pCyclicPGN->bcm_skt >= 0;
+    if (isOffloaded && pCyclicPGN->offloadedPayload == pCyclicPGN->payload
+        && pCyclicPGN->offloadedPeriodNs == pCyclicPGN->periodNs)
+    {
+        return true;
+    }
+    const int skt = isOffloaded ? pCyclicPGN->bcm_skt : getBcmSocket(pCyclicPGN->pSource->getCyclicDevice());
+    if (skt < 0)
+    {
+        return false;
+    }
+
+    // the PDU1 PGNs are sent to all (0xFF) like the J1939 socket does
+    uint32_t pgn = pCyclicPGN->pgn;
+    if (((pgn >> 8) & 0xFF) < 0xF0)
+    {
+        pgn = (pgn & 0x3FF00) | 0xFF;
+    }
+    BcmMessage message = {};
+    message.head.opcode = TX_SETUP;
+    message.head.can_id = CAN_EFF_FLAG | (J1939_DEFAULT_PRIORITY << 26) | (pgn << 8)
+        | pCyclicPGN->pSource->getCyclicSourceAddress();
+    message.head.nframes = 1;
+    if (!isOffloaded || pCyclicPGN->offloadedPeriodNs != pCyclicPGN->periodNs)
+    {
+        message.head.flags = SETTIMER | STARTTIMER;
+        message.head.ival2.tv_sec = long(pCyclicPGN->periodNs / 1000000000ull);
+        message.head.ival2.tv_usec = long(pCyclicPGN->periodNs % 1000000000ull / 1000);
+    }
+    struct can_frame& frame = message.head.frames[0];
+    frame.can_id = message.head.can_id;
+    frame.can_dlc = uint8_t(pCyclicPGN->payload.size());
+    copy(pCyclicPGN->payload.cbegin(), pCyclicPGN->payload.cend(), frame.data);
+    if (write(skt, &message, sizeof(message)) != ssize_t(sizeof(message)))
+    {
+        LOG_WARNING("Unable to offload PGN " << dec << pCyclicPGN->pgn << ": " << strerror(errno));
+        return false;
+    }
+
+    pCyclicPGN->bcm_skt = skt;
+    pCyclicPGN->bcmCanId = message.head.can_id;
+    pCyclicPGN->offloadedPayload = pCyclicPGN->payload;
+    pCyclicPGN->offloadedPeriodNs = pCyclicPGN->periodNs;
+    pCyclicPGN->statistics.isOffloaded = true;
+    return true;
+}
+
+/**
+ * Deletes the transmission of an offloaded PGN, if any.
+ */
+void J1939CyclicScheduler::stopOffload(CyclicPGN* pCyclicPGN) noexcept
+{
+    if (pCyclicPGN->bcm_skt < 0)
+    {
+        return;
+    }
+    BcmMessage message = {};
+    message.head.opcode = TX_DELETE;
+    message.head.can_id = pCyclicPGN->bcmCanId;
+    if (write(pCyclicPGN->bcm_skt, &message.head, sizeof(struct bcm_msg_head)) < 0)
+    {
+        LOG_WARNING("Unable to stop the offloaded PGN " << dec << pCyclicPGN->pgn << ": " << strerror(errno));
+    }
+    pCyclicPGN->bcm_skt = -1;
+    pCyclicPGN->statistics.isOffloaded = false;
+}
+
+void J1939CyclicScheduler::run()
+{
+    ThreadPlacement::getInstance().apply(ThreadRole::IO);
+    unique_lock<mutex> lock(mutex_);
+    while (!isOnExit_)
+    {
+        if (isAsleep_)
+        {
+            park();
+            waitForDeadline(lock);
+            if (!isAsleep_)
+            {
+                resume(getNowNs());
+            }
+            continue;
+        }
+        uint64_t nowNs = getNowNs();
+        if (hasSignalUpdate_.exchange(false))
+        {
+            refreshOffloaded(nowNs);
+        }
+        if (heap_.empty() || heap_.front()->deadlineNs > nowNs)
+        {
+            waitForDeadline(lock);
+            continue;
+        }
+
+        while (!heap_.empty() && heap_.front()->deadlineNs <= nowNs)
+        {
+            pop_heap(heap_.begin(), heap_.end(), isLater);
+            due_.push_back(heap_.back());
+            heap_.pop_back();
+        }
+
+        isProcessing_ = true;
+        lock.unlock();
+        sendDue();
+        lock.lock();
+        isProcessing_ = false;
+
+        nowNs = getNowNs();
+        for (CyclicPGN* pCyclicPGN : due_)
+        {
+            if (pCyclicPGN->isRemoved || pCyclicPGN->periodNs == 0)
+            {
+                // removed or the cycle time was set to 0 in the simulation
+                stopOffload(pCyclicPGN);
+                delete pCyclicPGN;
+            }
+            else if (pCyclicPGN->deferNs > 0)
+            {
+                // not sent yet, the first transmission is at the phase
+                pCyclicPGN->deadlineNs += pCyclicPGN->deferNs;
+                pCyclicPGN->deferNs = 0;
+                heap_.push_back(pCyclicPGN);
+                push_heap(heap_.begin(), heap_.end(), isLater);
+            }
+            else if (pCyclicPGN->canOffload)
+            {
+                if (offload(pCyclicPGN))
+                {
+                    offloaded_.push_back(pCyclicPGN);
+                    continue;
+                }
+                // sent by this thread from now on, starting right away
+                pCyclicPGN->isOffloadFailed = true;
+                stopOffload(pCyclicPGN);
+                heap_.push_back(pCyclicPGN);
+                push_heap(heap_.begin(), heap_.end(), isLater);
+            }
+            else
+            {
+                stopOffload(pCyclicPGN);
+                reschedule(pCyclicPGN, nowNs);
+            }
+        }
+        due_.clear();
+        offloadedCount_ = offloaded_.size();
+        condition_.notify_all();
+    }
+}
+
+/**
+ * Heap order: the PGN with the earliest deadline is on top.
+ */
+bool J1939CyclicScheduler::isLater(const CyclicPGN* pLeft, const CyclicPGN* pRight) noexcept
+{
+    return pLeft->deadlineNs > pRight->deadlineNs;
+}
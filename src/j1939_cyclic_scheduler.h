@@ -0,0 +1,217 @@
+/**
+ * @file j1939_cyclic_scheduler.h
+ *
+ */
+
+#ifndef J1939_CYCLIC_SCHEDULER_H
+#define J1939_CYCLIC_SCHEDULER_H
+
+#include "simulation_clock.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <linux/can.h>
+
+class BusLoadBudget;
+
+/**
+ * Interface of a simulation sending cyclic PGNs, implemented by the
+ * `J1939Simulator`.
+ */
+class J1939CyclicSource
+{
+public:
+    virtual ~J1939CyclicSource() = default;
+
+    /**
+     * @return the bound J1939 socket the cyclic PGNs are sent with
+     */
+    virtual int getCyclicSocket() const noexcept = 0;
+
+    /**
+     * @return the J1939 source address of the sent PGNs
+     */
+    virtual std::uint8_t getCyclicSourceAddress() const noexcept = 0;
+
+    /**
+     * @return the interface of the socket, see `TrafficCapture::getInterfaceIndex()`
+     */
+    virtual std::uint8_t getCaptureInterface() const noexcept = 0;
+
+    /**
+     * @return true if the PGNs should be sent (e.g. the bus is not off).
+     *         Called once per batch, not per PGN.
+     */
+    virtual bool isBusActive() = 0;
+
+    /**
+     * Gets the current payload and cycle time of a cyclic PGN.
+     *
+     * @param pgnKey: the PGN as defined in the simulation
+     * @param pgn: the numeric PGN
+     * @param payload: filled with the payload to send
+     * @param cycleTime: set to the cycle time in milliseconds, 0 stops
+     *                   sending the PGN
+     */
+    virtual void getCyclicPayload(const std::string& pgnKey,
+                                  std::uint32_t pgn,
+                                  std::vector<std::uint8_t>& payload,
+                                  unsigned int& cycleTime) = 0;
+
+    /**
+     * @return true if the payload of the PGN only changes with the vehicle
+     *         signals or before `J1939CyclicScheduler::updatePGN()` is
+     *         called, so the kernel may send it, see
+     *         `J1939CyclicScheduler::setOffloadEnabled()`
+     */
+    virtual bool isStaticPayload(std::uint32_t /*pgn*/) { return false; }
+
+    /**
+     * @return the CAN interface of the socket (e.g. "can0"), needed for
+     *         offloaded PGNs
+     */
+    virtual std::string getCyclicDevice() const { return std::string(); }
+};
+
+/**
+ * Sends the cyclic PGNs of all J1939 simulations with a single thread.
+ *
+ * The PGNs are kept in a heap ordered by their next deadline. The thread
+ * sleeps on a timerfd armed with the absolute (`CLOCK_MONOTONIC`) deadline of
+ * the earliest PGN. All PGNs which are due are collected and sent with one
+ * `sendmmsg()` per socket. The next deadline is the previous one plus the
+ * cycle time, so the period does not drift with the processing time. If a
+ * deadline was missed by more than a period, the missed transmissions are
+ * skipped instead of being sent as burst. The deadlines are times of the
+ * `SimulationClock`.
+ *
+ * The PGNs with the same cycle time on the same interface do not start
+ * together, which would send them as burst in every period: the first
+ * transmissions are staggered over the period (by the van der Corput
+ * sequence, i.e. at 0, 1/2, 1/4, 3/4, ... of it), so the frames stay evenly
+ * spread however many PGNs are added. The sent frames are counted in the
+ * `BusLoadBudget` of the interface.
+ *
+ * With `setOffloadEnabled()`, the PGNs with a static payload of up to 8 bytes
+ * (see `J1939CyclicSource::isStaticPayload()`) are handed over to the
+ * SocketCAN broadcast manager (`CAN_BCM`) after their first transmission, so
+ * the kernel sends them without waking up the thread. The simulation calls
+ * `updatePGN()` when such a payload changes, changed vehicle signals are
+ * picked up without that. Offloaded PGNs are not recorded by the
+ * `TrafficCapture`.
+ *
+ * While the simulator sleeps (see `IdleMonitor`), the thread is parked
+ * without a deadline and the offloaded PGNs are deleted from the broadcast
+ * manager. On wakeup, the PGNs continue with their phases.
+ */
+class J1939CyclicScheduler
+{
+public:
+    /// Timing statistics of one cyclic PGN.
+    struct Statistics
+    {
+        std::uint64_t sent = 0; ///< number of sent messages
+        std::uint64_t dropped = 0; ///< messages not sent due to bus state or errors
+        std::uint64_t overruns = 0; ///< number of skipped periods
+        std::uint64_t maxJitterUs = 0; ///< max. delay after the deadline
+        std::uint64_t totalJitterUs = 0; ///< sum of the delays after the deadlines
+        bool isOffloaded = false; ///< sent by the kernel, which is not counted
+    };
+
+    static J1939CyclicScheduler& getInstance();
+
+    J1939CyclicScheduler();
+    J1939CyclicScheduler(const J1939CyclicScheduler& orig) = delete;
+    J1939CyclicScheduler& operator =(const J1939CyclicScheduler& orig) = delete;
+    virtual ~J1939CyclicScheduler();
+
+    static void setOffloadEnabled(bool isEnabled) noexcept;
+
+    void addPGN(J1939CyclicSource* pSource, const std::string& pgnKey, std::uint32_t pgn);
+    void updatePGN(J1939CyclicSource* pSource, std::uint32_t pgn);
+    void updateSource(J1939CyclicSource* pSource);
+    void removeSource(J1939CyclicSource* pSource);
+    std::map<std::uint32_t, Statistics> getStatistics(const J1939CyclicSource* pSource) const;
+    std::map<std::uint32_t, std::uint64_t> getPhases(const J1939CyclicSource* pSource) const;
+    void setPhases(const J1939CyclicSource* pSource, const std::map<std::uint32_t, std::uint64_t>& phases);
+
+private:
+    struct CyclicPGN
+    {
+        J1939CyclicSource* pSource;
+        std::string pgnKey; ///< the PGN as defined in the simulation
+        std::uint32_t pgn;
+        std::uint64_t deadlineNs;
+        std::uint64_t periodNs = 0;
+        std::uint64_t sentAtNs = 0; ///< time of the last transmission attempt
+        bool isSent = false; ///< result of the last transmission attempt
+        bool isRemoved = false;
+        bool canOffload = false; ///< result of the last `getCyclicPayload()`
+        bool isOffloadFailed = false; ///< sent by the scheduler thread for good
+        bool isPhased = false; ///< the phase of the PGN is set, see `getPhaseNs()`
+        std::uint64_t deferNs = 0; ///< the first transmission waits for the phase
+        std::vector<std::uint8_t> payload;
+        std::vector<std::uint8_t> offloadedPayload; ///< the payload sent by the kernel
+        std::uint64_t offloadedPeriodNs = 0;
+        int bcm_skt = -1; ///< the `CAN_BCM` socket sending the PGN, -1 if not offloaded
+        canid_t bcmCanId = 0;
+        Statistics statistics;
+    };
+
+    static std::atomic<bool> isOffloadEnabled_;
+
+    int timer_fd_ = -1;
+    int wakeup_fd_ = -1; ///< eventfd to interrupt the sleep on changes
+
+    mutable std::mutex mutex_;
+    std::condition_variable condition_;
+    std::vector<CyclicPGN*> heap_; ///< ordered by `deadlineNs`, earliest first
+    std::vector<CyclicPGN*> due_; ///< the PGNs currently being sent
+    std::vector<CyclicPGN*> offloaded_; ///< sent by the kernel, not in `heap_`
+    std::map<std::string, int> bcmSockets_; ///< per interface, -1 if it can not be opened
+    std::atomic<std::size_t> offloadedCount_{0}; ///< the size of `offloaded_`
+    std::atomic<bool> hasSignalUpdate_{false}; ///< set by the listener of the vehicle signals
+    bool isProcessing_ = false;
+    bool isOnExit_ = false;
+    bool isAsleep_ = false; ///< the simulator sleeps, see `IdleMonitor`
+    int idleListenerId_ = -1;
+    int signalListenerId_ = -1;
+    SimulationClock::Waiter waiter_; ///< reports the earliest deadline in virtual time
+    std::thread thread_;
+
+    // buffers for `sendmmsg()`, only used by the scheduler thread
+    std::vector<struct mmsghdr> messages_;
+    std::vector<struct iovec> iovecs_;
+    std::vector<struct sockaddr_can> addresses_;
+    /// the number of staggered PGNs by interface and cycle time
+    std::map<std::pair<std::string, std::uint64_t>, std::uint32_t> phaseSlots_;
+    std::map<std::string, std::shared_ptr<BusLoadBudget>> budgets_; ///< by interface
+
+    static std::uint64_t getNowNs() noexcept;
+    static bool isLater(const CyclicPGN* pLeft, const CyclicPGN* pRight) noexcept;
+    void wakeup() noexcept;
+    void waitForDeadline(std::unique_lock<std::mutex>& lock);
+    void sendDue();
+    void sendBatch(std::vector<CyclicPGN*>::iterator first,
+                   std::vector<CyclicPGN*>::iterator last);
+    std::uint64_t getPhaseNs(const std::string& device, std::uint64_t periodNs);
+    void reschedule(CyclicPGN* pCyclicPGN, std::uint64_t nowNs) noexcept;
+    void refreshOffloaded(std::uint64_t nowNs);
+    void park();
+    void resume(std::uint64_t nowNs);
+    int getBcmSocket(const std::string& device) noexcept;
+    bool offload(CyclicPGN* pCyclicPGN) noexcept;
+    void stopOffload(CyclicPGN* pCyclicPGN) noexcept;
+    void run();
+};
+
+#endif /* J1939_CYCLIC_SCHEDULER_H */
@@ -0,0 +1,93 @@
+/**
+ * @file j1939_diagnostic_messages.cpp
+ *
+ * The DM1 and DM2 payloads of the fault memory, see
+ * `J1939DiagnosticMessages`.
+ */
+
+#include "j1939_diagnostic_messages.h"
+#include <algorithm>
+
+using namespace std;
+
+constexpr uint8_t LAMP_MIL_ON = 0x40; ///< bits 8-7 of the lamp status
+constexpr uint8_t LAMP_FLASH_NOT_AVAILABLE = 0xFF;
+constexpr uint8_t MAX_OCCURRENCE_COUNT = 126; ///< 127 means not available
+constexpr size_t MIN_PAYLOAD_LENGTH = 8;
+
+/**
+ * @return the occurrence count of a DTC, see `J1939DiagnosticMessages`
+ */
+static uint8_t getOccurrenceCount(const DtcStore& store, uint32_t dtc)
+{
+    // the DTC and status, the record number and the data of the record
+    vector<uint8_t> record;
+    if (store.appendExtendedDataRecords(dtc, J1939DiagnosticMessages::OCCURRENCE_COUNTER_RECORD, record)
+        && record.size() > 5)
+    {
+        return min(record[5], MAX_OCCURRENCE_COUNT);
+    }
+    return 1;
+}
+
+/**
+ * Encodes the lamp status and the SPN/FMI/OC records of the DTCs matching a
+ * condition. A message without DTCs has one record of zeros, a message is
+ * padded to 8 bytes, longer ones are sent by the transport protocol of the
+ * kernel.
+ */
+template<typename Condition>
+static void encodeMessage(const DtcStore& store, const vector<DtcRecord>& dtcs, Condition isIncluded,
+                          vector<uint8_t>& payload)
+{
+    payload.assign({0x00, LAMP_FLASH_NOT_AVAILABLE});
+    for (const DtcRecord& record : dtcs)
+    {
+        if (!isIncluded(record.status))
+        {
+            continue;
+        }
+        if (record.status & J1939DiagnosticMessages::WARNING_INDICATOR_REQUESTED)
+        {
+            payload[0] |= LAMP_MIL_ON;
+        }
+        payload.push_back(uint8_t(record.dtc >> 16));
+        payload.push_back(uint8_t(record.dtc >> 8));
+        payload.push_back(uint8_t(record.dtc));
+        payload.push_back(getOccurrenceCount(store, record.dtc));
+    }
+    if (payload.size() == 2)
+    {
+        payload.insert(payload.cend(), 4, 0x00);
+    }
+    if (payload.size() < MIN_PAYLOAD_LENGTH)
+    {
+        payload.resize(MIN_PAYLOAD_LENGTH, 0xFF);
+    }
+}
+
+/**
+ * @param pgn: the numeric PGN
+ * @return true for DM1 and DM2
+ */
+bool J1939DiagnosticMessages::isDiagnosticMessage(uint32_t pgn) noexcept
+{
+    return pgn == J1939_PGN_DM1 || pgn == J1939_PGN_DM2;
+}
+
+/**
+ * Encodes the current DM1 and DM2 payloads of the fault memory.
+ *
+ * @param store: the fault memory of the ECU
+ * @param dm1: replaced by the active DTCs
+ * @param dm2: replaced by the previously active DTCs
+ */
+void J1939DiagnosticMessages::encode(const DtcStore& store, vector<uint8_t>& dm1, vector<uint8_t>& dm2)
+{
+    const vector<DtcRecord> dtcs = store.getDtcs();
+    encodeMessage(store, dtcs, [](uint8_t status) { return (status & TEST_FAILED) != 0; }, dm1);
+    encodeMessage(store, dtcs, [](uint8_t status)
+    {
+        return (status & (TEST_FAILED | CONFIRMED_DTC)) == CONFIRMED_DTC;
+    }, dm2);
+}
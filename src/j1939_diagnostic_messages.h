@@ -0,0 +1,42 @@
+/**
+ * @file j1939_diagnostic_messages.h
+ *
+ */
+
+#ifndef J1939_DIAGNOSTIC_MESSAGES_H
+#define J1939_DIAGNOSTIC_MESSAGES_H
+
+#include "dtc_store.h"
+#include <cstdint>
+#include <vector>
+
+constexpr std::uint32_t J1939_PGN_DM1 = 0xFECA; ///< active diagnostic trouble codes
+constexpr std::uint32_t J1939_PGN_DM2 = 0xFECB; ///< previously active diagnostic trouble codes
+constexpr unsigned int J1939_DM1_CYCLE_TIME = 1000; ///< ms, see J1939-73
+
+/**
+ * Encodes the diagnostic messages DM1 and DM2 (J1939-73) from the
+ * `DtcStore` of an ECU.
+ *
+ * The 3 byte DTCs of the store are taken as J1939 DTCs in the DTC format of
+ * ISO 14229-1 for J1939-73 (`SPN low, SPN middle, SPN high << 5 | FMI`),
+ * so the first 3 bytes of every SPN/FMI/OC record are the bytes of the DTC.
+ * The occurrence count (OC) is the first byte of the extended data record
+ * 0x01 of the DTC, 1 without it. A DTC is active (DM1) while its
+ * `testFailed` bit is set and previously active (DM2) if it is confirmed
+ * but not failed anymore. The malfunction indicator lamp is on if one of
+ * the DTCs of the message requests the warning indicator.
+ */
+class J1939DiagnosticMessages
+{
+public:
+    static constexpr std::uint8_t TEST_FAILED = 0x01; ///< ISO 14229-1 status bit 0
+    static constexpr std::uint8_t CONFIRMED_DTC = 0x08; ///< ISO 14229-1 status bit 3
+    static constexpr std::uint8_t WARNING_INDICATOR_REQUESTED = 0x80; ///< ISO 14229-1 status bit 7
+    static constexpr std::uint8_t OCCURRENCE_COUNTER_RECORD = 0x01; ///< the extended data record of the OC
+
+    static bool isDiagnosticMessage(std::uint32_t pgn) noexcept;
+    static void encode(const DtcStore& store, std::vector<std::uint8_t>& dm1, std::vector<std::uint8_t>& dm2);
+};
+
+#endif /* J1939_DIAGNOSTIC_MESSAGES_H */
@@ -0,0 +1,114 @@
+/**
+ * @file j1939_pgn_index.h
+ *
+ */
+
+#ifndef J1939_PGN_INDEX_H
+#define J1939_PGN_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * Index of the J1939 PGNs of a simulation, keyed by the numeric 18 bit PGN.
+ * The PGNs of the `PGNs` table are parsed once at load time, so a lookup on
+ * request does not format or parse any string.
+ *
+ * The entries are kept in a flat open addressing table with linear probing.
+ * The capacity is a power of two with at least twice the number of entries,
+ * so the probe sequences stay short. Entries are never removed.
+ */
+template<typename T>
+class J1939PgnIndex
+{
+public:
+    /**
+     * Adds an entry. An already existing entry of the same PGN gets replaced.
+     */
+    void add(std::uint32_t pgn, T value)
+    {
+        if ((size_ + 1) * 2 > slots_.size())
+        {
+            grow();
+        }
+        Slot& slot = probe(pgn);
+        if (!slot.isUsed)
+        {
+            slot.isUsed = true;
+            slot.pgn = pgn;
+            ++size_;
+        }
+        slot.value = std::move(value);
+    }
+
+    /**
+     * @return the value of the given PGN or `nullptr` if there is none
+     */
+    const T *find(std::uint32_t pgn) const noexcept
+    {
+        if (slots_.empty())
+        {
+            return nullptr;
+        }
+        const std::size_t mask = slots_.size() - 1;
+        for (std::size_t i = hash(pgn) & mask; slots_[i].isUsed; i = (i + 1) & mask)
+        {
+            if (slots_[i].pgn == pgn)
+            {
+                return &slots_[i].value;
+            }
+        }
+        return nullptr;
+    }
+
+    bool empty() const noexcept { return size_ == 0; }
+    std::size_t size() const noexcept { return size_; }
+
+private:
+    struct Slot
+    {
+        bool isUsed = false;
+        std::uint32_t pgn = 0;
+        T value{};
+    };
+
+    std::vector<Slot> slots_;
+    std::size_t size_ = 0;
+
+    /// spreads the PDU specific byte, which often only differs in few bits
+    static std::size_t hash(std::uint32_t pgn) noexcept
+    {
+        return std::size_t((pgn * 0x9E3779B1u) >> 14);
+    }
+
+    /**
+     * @return the slot of the PGN or the free slot it would be stored in
+     */
+    Slot& probe(std::uint32_t pgn) noexcept
+    {
+        const std::size_t mask = slots_.size() - 1;
+        std::size_t i = hash(pgn) & mask;
+        while (slots_[i].isUsed && slots_[i].pgn != pgn)
+        {
+            i = (i + 1) & mask;
+        }
+        return slots_[i];
+    }
+
+    void grow()
+    {
+        std::vector<Slot> slots(slots_.empty() ? 16 : slots_.size() * 2);
+        slots.swap(slots_);
+        for (Slot& slot : slots)
+        {
+            if (slot.isUsed)
+            {
+                probe(slot.pgn) = std::move(slot);
+            }
+        }
+    }
+};
+
+#endif /* J1939_PGN_INDEX_H */
@@ -1,6 +1,10 @@
 
 #include "j1939_simulator.h"
 #include "can/j1939.h"
+#include "j1939_diagnostic_messages.h"
+#include "logger.h"
+#include "metrics.h"
+#include "traffic_capture.h"
 #include <linux/can.h>
 #include <iostream>
 #include <iomanip>
@@ -9,7 +13,6 @@
 #include <string>
 #include <vector>
 #include <unistd.h>
-#include <libsocketcan.h>
 
 
 #include <net/if.h>
@@ -21,8 +24,6 @@
 
 using namespace std;
 
-constexpr size_t MAX_BUFSIZE = 1788; // 255*7 Byte + 3 byte PGN
-
 bool J1939Simulator::hasSimulation(EcuLuaScript *pEcuScript)
 {
     if(pEcuScript->hasJ1939SourceAddress()) {
@@ -34,155 +35,195 @@ bool J1939Simulator::hasSimulation(EcuLuaScript *pEcuScript)
 J1939Simulator::J1939Simulator(const std::string& device,
                                EcuLuaScript *pEcuScript)
 : device_(device)
+, captureInterface_(TrafficCapture::getInstance().getInterfaceIndex(device))
 , pEcuScript_(pEcuScript)
+, name_(pEcuScript->getJ1939Name())
 , isOnExit_(false)
+, pBusStateMonitor_(BusStateMonitor::getInstance(device))
+, pBus_(J1939Bus::getInstance(device))
+, pSignalMappings_(pEcuScript->getSignalMappings())
+, pDtcStore_(pEcuScript->hasJ1939DiagnosticMessages() ? pEcuScript->getDtcStore() : nullptr)
+, pCommunicationGate_(pEcuScript->getCommunicationGate())
 {
     source_address_ = pEcuScript->getJ1939SourceAddress();
-    pgnsWithoutSeparator = pEcuScript->buildRequestPGNMap();
-    requestByteTree = pEcuScript->buildRequestByteTreeFromPGNTable();
+    pTables_ = pEcuScript->getJ1939Tables();
+    pMetrics_ = Metrics::getInstance().registerEcu("j1939", source_address_);
+    pMetrics_->setLuaMemory(pEcuScript->getLuaMemoryStatistics());
+
+    // the PGNs of the request entries ("PGN#payload") and the PGN requests
+    receivedPgns_.push_back(J1939_PGN_REQUESTPGN);
+    for (const string& pgnDefinition : pEcuScript->getJ1939PGNs()) {
+        size_t separatorPos = pgnDefinition.find_first_of('#');
+        if(separatorPos != string::npos) {
+            receivedPgns_.push_back(parsePGN(pgnDefinition.substr(0, separatorPos)));
+        }
+    }
 
-    int err = openReceiver();
+    int err = openSender();
     if (err != 0)
     {
         throw exception();
     }
+    if (pEcuScript->getJ1939ReceiveBufferSize() > 0)
+    {
+        pBus_->setReceiveBufferSize(pEcuScript->getJ1939ReceiveBufferSize());
+    }
+    if (!pBus_->addNode(this))
+    {
+        closeSender();
+        throw exception();
+    }
 
-    j1939ReceiverThread_ = new std::thread(&J1939Simulator::readDataThread, this);
-    startPeriodicSenderThreads();
+    pEcuScript->registerJ1939Simulator(this);
+    startCyclicMessages();
+    // the offloaded PGNs are sent by the kernel, which does not check `isBusActive()`
+    gateListenerId_ = pCommunicationGate_->addListener([this](bool) {
+        J1939CyclicScheduler::getInstance().updateSource(this);
+    });
+    pMetrics_->isReady = true;
 }
 
 void J1939Simulator::stopSimulation()
 {
-    closeReceiver();
+    // neither the scheduler nor the bus must use the socket while it is closed
+    pCommunicationGate_->removeListener(gateListenerId_);
+    J1939CyclicScheduler::getInstance().removeSource(this);
+    pBus_->removeNode(this);
+    closeSender();
 }
 
+/**
+ * Waits until `stopSimulation()` is called.
+ */
 void J1939Simulator::waitForSimulationEnd()
 {
-    for (auto cyclicThread : cyclicMessageThreads) {
-        cyclicThread->join();
-        delete cyclicThread;
-    }
-    j1939ReceiverThread_->join();
-    delete j1939ReceiverThread_;
+    unique_lock<mutex> lock(exitMutex_);
+    exitCondition_.wait(lock, [this]() { return isOnExit_; });
 }
 
 
 J1939Simulator::~J1939Simulator()
 {
-    for (auto cyclicThread : cyclicMessageThreads) {
-        delete cyclicThread;
-    }
-    cyclicMessageThreads.clear();
+    pCommunicationGate_->removeListener(gateListenerId_);
+    J1939CyclicScheduler::getInstance().removeSource(this);
+    pBus_->removeNode(this);
+    pEcuScript_->registerJ1939Simulator(nullptr);
 }
 
-void J1939Simulator::startPeriodicSenderThreads()
+/**
+ * Adds the cyclic PGNs of the simulation to the `J1939CyclicScheduler`. PGNs
+ * without cycle time are only sent once and then on request via EA00. Static
+ * payloads are decoded here once, so sending them does not involve Lua. The
+ * PGNs which are only defined as SPN templates in the `Signals` table start
+ * with an empty payload, which is filled by `overlaySignals()`. DM1 is added
+ * with `J1939DiagnosticMessages`.
+ */
+void J1939Simulator::startCyclicMessages()
 {
     vector<string> pgnDefinitions = pEcuScript_->getJ1939PGNs();
-    cout << "Found " << pgnDefinitions.size() << " PGN definitions in simulation" << endl;
+    LOG_INFO("Found " << pgnDefinitions.size() << " PGN definitions in simulation");
 
     for (auto pgnDefinition : pgnDefinitions) {
         size_t separatorPos = pgnDefinition.find_first_of('#');
         // cyclic sent PGNs or PGNs requested via EA00
         if(separatorPos == string::npos) {
-            cout << "Found PGN " << pgnDefinition << " as cyclic PGN or to be requested via EA00" << endl;
-            std::thread *cyclicThread = new std::thread(&J1939Simulator::sendCyclicMessage, this, pgnDefinition);
-            cyclicMessageThreads.push_back(cyclicThread);
+            const uint32_t pgn = parsePGN(pgnDefinition);
+            if (pDtcStore_ && J1939DiagnosticMessages::isDiagnosticMessage(pgn)) {
+                LOG_WARNING("PGN " << pgnDefinition << " is generated from the DTCs, ignoring its definition");
+                continue;
+            }
+            LOG_INFO("Found PGN " << pgnDefinition << " as cyclic PGN or to be requested via EA00");
+            cachePGNPayload(pgn);
+            J1939CyclicScheduler::getInstance().addPGN(this, pgnDefinition, pgn);
+        }
+    }
+
+    // the SPN templates of the `Signals` table without payload in the `PGNs` table
+    for (const auto& pgnCycleTime : pSignalMappings_->pgnCycleTimes) {
+        const uint32_t pgn = pgnCycleTime.first;
+        {
+            lock_guard<mutex> lock(cachedPayloadsMutex_);
+            if (cachedPayloads_.count(pgn) != 0) {
+                continue;
+            }
+            CachedPayload cachedPayload;
+            cachedPayload.cycleTime = pgnCycleTime.second;
+            cachedPayload.isValid = true; // the payload is only encoded from the signals
+            cachedPayloads_[pgn] = move(cachedPayload);
         }
+        LOG_INFO("Found PGN " << pgn << " as SPN template");
+        J1939CyclicScheduler::getInstance().addPGN(this, to_string(pgn), pgn);
     }
-    cout << "PGN threads started" << endl;
+
+    if (pDtcStore_) {
+        J1939CyclicScheduler::getInstance().addPGN(this, to_string(J1939_PGN_DM1), J1939_PGN_DM1);
+    }
+    LOG_INFO("Cyclic PGNs scheduled");
 }
 
 /**
- * Opens the socket for receiving J1939 PGNs
- *
- * @return 0 on success, otherwise a negative value
- * @see J1939Simulator::closeReceiver()
+ * @return the timing statistics of the cyclic PGNs of this simulation
  */
-int J1939Simulator::openReceiver() noexcept
+map<uint32_t, J1939CyclicScheduler::Statistics> J1939Simulator::getCyclicStatistics() const
 {
-    int skt = openJ1939Socket(source_address_);
-    if (skt < 0)
-    {
-        cerr << __func__ << "() socket: " << strerror(errno) << '\n';
-        return -1;
-    }
-    receive_skt_ = skt;
-    return 0;
+    return J1939CyclicScheduler::getInstance().getStatistics(this);
 }
 
 /**
- * Closes the socket for receiving data.
- * 
- * @see J1939Simulator::openReceiver()
+ * Opens the socket bound to the source address, which sends all messages of
+ * the simulation.
+ *
+ * @return 0 on success, otherwise a negative value
+ * @see J1939Simulator::closeSender()
  */
-void J1939Simulator::closeReceiver() noexcept
+int J1939Simulator::openSender() noexcept
 {
-    isOnExit_ = true;
-
-    if (receive_skt_ < 0)
+    int skt = pBus_->openSendSocket(source_address_);
+    if (skt < 0)
     {
-        cerr << __func__ << "() Receiver socket is already closed!\n";
-        return;
+        return -1;
     }
-    close(receive_skt_);
-    receive_skt_ = -1;
+    send_skt_ = skt;
+    return 0;
 }
 
 /**
- * Reads the data from the opened receiver socket. The handling of the received
- * data is controlled by the inside nested `proceedReceivedData()` function.
+ * Closes the socket for sending data and ends `waitForSimulationEnd()`.
  * 
- * @return 0 on success, otherwise a negative value
+ * @see J1939Simulator::openSender()
  */
-int J1939Simulator::readDataThread() noexcept
+void J1939Simulator::closeSender() noexcept
 {
-    if (receive_skt_ < 0)
     {
-        cerr << __func__ << "() Can not read data. J1939 receiver socket invalid!\n";
-        return -1;
+        lock_guard<mutex> lock(exitMutex_);
+        isOnExit_ = true;
     }
+    exitCondition_.notify_all();
 
-    uint8_t msg[MAX_BUFSIZE];
-    size_t num_bytes;
-    struct sockaddr_can saddr = {};
-    socklen_t addrlen = sizeof(saddr);
-
-    do
+    if (send_skt_ < 0)
     {
-        cout << "Reading from socket" << endl;
-        num_bytes = recvfrom(receive_skt_, msg, sizeof(msg), 0, (struct sockaddr *)&saddr, &addrlen);
-
-        cout << "Message received from: " << hex << (unsigned short)saddr.can_addr.j1939.addr << dec << endl;
-        cout << " -> PGN: " << hex << (unsigned short)saddr.can_addr.j1939.pgn << dec << endl;
-
-        if (num_bytes >= 0 && num_bytes < MAX_BUFSIZE)
-        {
-            processReceivedData(msg, num_bytes, saddr.can_addr.j1939.addr, saddr.can_addr.j1939.pgn);
-        }
+        LOG_ERROR(__func__ << "() Sender socket is already closed!");
+        return;
     }
-    while (!isOnExit_);
-
-    return 0;
+    close(send_skt_);
+    send_skt_ = -1;
 }
 
 /**
- * Prints out the received data and should be called once per received message
- * 
- * @see J1939Simulator::readData()
+ * Handles a message to the source address of the simulation or a broadcast,
+ * called by the `J1939Bus` once per received message.
  */
-void J1939Simulator::processReceivedData(const uint8_t* buffer, const size_t num_bytes, const uint8_t sourceAddress, const uint32_t pgn) noexcept
+void J1939Simulator::processReceivedData(const uint8_t* buffer, size_t num_bytes, uint8_t sourceAddress, uint32_t pgn) noexcept
 {
     // Print out what we received
-    cout << __func__ << "() Received " << dec << num_bytes << " bytes.\n";
-    for (size_t i = 0; i < num_bytes; i++)
-    {
-        cout << " 0x" << hex << setw(2) << setfill('0') << static_cast<int> (buffer[i]);
-    }
-    cout << endl;
-    cout << "on PGN " << pgn << endl;
+    LOG_DEBUG(__func__ << "() Received " << dec << num_bytes << " bytes.\n"
+              << hexDump(buffer, num_bytes) << "\non PGN " << pgn);
 
-    string pgnResponse = pEcuScript_->getJ1939Response(requestByteTree, pgn, buffer, num_bytes);
-    cout << "-> Response: " << pgnResponse << endl;
+    // the PDU format takes the place of the SID in the metrics
+    RequestTimer timer(pMetrics_, uint8_t(pgn >> 8), J1939Bus::getReceiveTime());
+    string pgnResponse = pEcuScript_->getJ1939Response(pTables_->requestMatcher, pgn, buffer, num_bytes);
+    timer.lookupFinished(false);
+    LOG_DEBUG("-> Response: " << pgnResponse);
 
     struct sockaddr_can saddr = {};
     saddr.can_family = AF_CAN;
@@ -209,26 +250,30 @@ void J1939Simulator::processReceivedData(const uint8_t* buffer, const size_t num
         }
         saddr.can_addr.j1939.pgn = respondingPgn;
 
-        sendJ1939Message(receive_skt_, saddr, responsePayload);
-    } else if(pgn == 0xEA00) {
-        string pgnRequestPayload = pEcuScript_->intToHexString(buffer, num_bytes);
-        uint32_t requestedPgn = parsePGN(pgnRequestPayload);
-        cout << "Requested PGN: " << requestedPgn << endl;
+        sendJ1939Message(send_skt_, saddr, responsePayload);
+        timer.responseSent(responsePayload.data(), responsePayload.size());
+    } else if(pgn == J1939_PGN_REQUESTPGN && num_bytes >= 3) {
+        // the requested PGN, little endian
+        const uint32_t requestedPgn = uint32_t(buffer[0]) | uint32_t(buffer[1]) << 8 | uint32_t(buffer[2]) << 16;
+        LOG_DEBUG("Requested PGN: " << requestedPgn);
         saddr.can_addr.j1939.pgn = requestedPgn;
-        string pgnResponse = pEcuScript_->getJ1939RequestPGNData(pgnsWithoutSeparator, pgnRequestPayload).payload;
-        cout << "-> Response: " << pgnResponse << endl;
-
-        responsePayload = pEcuScript_->literalHexStrToBytes(pgnResponse);
-        sendJ1939Message(receive_skt_, saddr, responsePayload);
+        unsigned int cycleTime;
+        getPGNPayload(requestedPgn, responsePayload, cycleTime);
+        sendJ1939Message(send_skt_, saddr, responsePayload);
+        timer.responseSent(responsePayload.data(), responsePayload.size());
     }
 }
 
 ssize_t J1939Simulator::sendJ1939Message(int skt, struct sockaddr_can saddr, vector<unsigned char> payload) noexcept
 {
     ssize_t sentBytes = sendto(skt, payload.data(), payload.size(), 0, (const struct sockaddr *)&saddr, sizeof(saddr));
-    cout << "sentBytes: " << sentBytes << endl;
+    LOG_DEBUG("sentBytes: " << sentBytes);
     if(sentBytes < 0) {
-        cout << "Unable to send PGN " << saddr.can_addr.j1939.pgn << ": " << strerror(errno) << endl;
+        LOG_ERROR("Unable to send PGN " << saddr.can_addr.j1939.pgn << ": " << strerror(errno));
+    } else {
+        TrafficCapture::getInstance().record(TrafficCapture::Protocol::J1939, TrafficCapture::Direction::TX,
+                                             captureInterface_, saddr.can_addr.j1939.pgn,
+                                             source_address_, saddr.can_addr.j1939.addr, payload.data(), payload.size());
     }
     return sentBytes;
 }
@@ -265,77 +310,260 @@ vector<unsigned char> J1939Simulator::assembleACK(const string ackInfoByteString
     return rawMessage;
 }
 
-void J1939Simulator::sendCyclicMessage(const string pgn) noexcept
+/**
+ * @return the J1939 source address of the simulation
+ */
+uint8_t J1939Simulator::getSourceAddress() const noexcept
 {
-    uint32_t pgnNum = parsePGN(pgn);
-    cout << "Sending Cyclic PGN: " << pgn << " as " << pgnNum << endl;
+    return source_address_;
+}
 
-    struct sockaddr_can saddr = {};
-    saddr.can_family = AF_CAN;
-    saddr.can_addr.j1939.name = J1939_NO_NAME;
-    saddr.can_addr.j1939.pgn = pgnNum;
-    saddr.can_addr.j1939.addr = 0xff;
+/**
+ * @return the NAME of the `J1939Name` field, 0 if the address is not claimed
+ */
+uint64_t J1939Simulator::getName() const noexcept
+{
+    return name_;
+}
 
+/**
+ * @return the socket bound to the source address
+ */
+int J1939Simulator::getSendSocket() const noexcept
+{
+    return send_skt_;
+}
+
+/**
+ * @return the PGNs of the request entries of the `PGNs` table and the PGN
+ *         request (EA00), the other PGNs are filtered out by the kernel
+ */
+vector<uint32_t> J1939Simulator::getReceivedPgns() const
+{
+    return receivedPgns_;
+}
+
+/**
+ * The cyclic PGNs are sent with the socket, which is already bound to the
+ * source address, so no socket has to be opened per message.
+ */
+int J1939Simulator::getCyclicSocket() const noexcept
+{
+    return send_skt_;
+}
+
+/**
+ * @return the J1939 source address of the simulation
+ */
+uint8_t J1939Simulator::getCyclicSourceAddress() const noexcept
+{
+    return source_address_;
+}
+
+/**
+ * @return the interface of the simulation in the traffic capture
+ */
+uint8_t J1939Simulator::getCaptureInterface() const noexcept
+{
+    return captureInterface_;
+}
 
-    do {
-        J1939PGNData pgnData = pEcuScript_->getJ1939RequestPGNData(pgnsWithoutSeparator, pgn);
-        string pgnMessage = pgnData.payload;
-        vector<unsigned char> rawMessage = pEcuScript_->literalHexStrToBytes(pgnMessage);
-        unsigned int cycleTime = pgnData.cycleTime;
-        if(cycleTime == 0) {
+/**
+ * Called by the `J1939CyclicScheduler` every time a cyclic PGN is due.
+ */
+void J1939Simulator::getCyclicPayload(const string& pgnKey,
+                                      uint32_t pgn,
+                                      vector<uint8_t>& payload,
+                                      unsigned int& cycleTime)
+{
+    getPGNPayload(pgn, payload, cycleTime);
+}
+
+/**
+ * The static payloads and the cached payloads of payload functions only
+ * change with `invalidatePGN()`, `setPGNPayload()` or the signals, so the
+ * kernel may send them. Not for a node claiming its address, since it has to
+ * stop sending when the address is lost.
+ */
+bool J1939Simulator::isStaticPayload(uint32_t pgn)
+{
+    if (name_ != 0) {
+        return false;
+    }
+    lock_guard<mutex> lock(cachedPayloadsMutex_);
+    auto iter = cachedPayloads_.find(pgn);
+    return iter != cachedPayloads_.end() && (!iter->second.isLuaFunction || iter->second.cachePayload);
+}
+
+/**
+ * @return the CAN interface of the simulation
+ */
+string J1939Simulator::getCyclicDevice() const
+{
+    return device_;
+}
+
+/**
+ * Marks the cached payload of the given PGN as outdated. It is read from the
+ * `PGNs` table again before it is sent next, an offloaded PGN right away.
+ *
+ * @param pgn: the PGN in one of the formats accepted by `parsePGN()`
+ */
+void J1939Simulator::invalidatePGN(const string& pgn)
+{
+    const uint32_t pgnNum = parsePGN(pgn);
+    {
+        lock_guard<mutex> lock(cachedPayloadsMutex_);
+        auto iter = cachedPayloads_.find(pgnNum);
+        if (iter == cachedPayloads_.end()) {
+            LOG_ERROR(__func__ << "() Unknown PGN " << pgn);
             return;
         }
+        iter->second.isValid = false;
+        ++iter->second.generation;
+    }
+    J1939CyclicScheduler::getInstance().updatePGN(this, pgnNum);
+}
 
-        if(isBusActive()) {
-            int sendSkt = openCyclicSendSocket();
-
-            int retries = 5;
-            while(retries > 0)
-            {
-                cout << "Trying to send PGN: " << dec << pgnNum << endl;
-
-                int sendResult = sendto(sendSkt, rawMessage.data(), rawMessage.size(), MSG_DONTWAIT, (const struct sockaddr *)&saddr, sizeof(saddr));
-                if(sendResult < 0)
-                {
-                    if (errno == EAGAIN || errno == EWOULDBLOCK)
-                    {
-                        retries--;
-                        cout << "Sending PGN " << dec << pgnNum << " blocked - " << retries << " retries remaining." << endl;
-                        usleep(1000 * 50); // wait for 50ms before retry
-                    } else {
-                        cout << "Error sending PGN: " << strerror(errno) << endl;
-                        retries = 0;
-                    }
-                }
-                else
-                {
-                    retries = 0;
-                }
-            }
+/**
+ * Replaces the payload of the given PGN. The payload is kept (even for
+ * payload functions) until `invalidatePGN()` is called.
+ *
+ * @param pgn: the PGN in one of the formats accepted by `parsePGN()`
+ * @param payload: the new payload
+ */
+void J1939Simulator::setPGNPayload(const string& pgn, const vector<uint8_t>& payload)
+{
+    const uint32_t pgnNum = parsePGN(pgn);
+    {
+        lock_guard<mutex> lock(cachedPayloadsMutex_);
+        auto iter = cachedPayloads_.find(pgnNum);
+        if (iter == cachedPayloads_.end()) {
+            LOG_ERROR(__func__ << "() Unknown PGN " << pgn);
+            return;
+        }
+        iter->second.payload = payload;
+        iter->second.isValid = true;
+        ++iter->second.generation;
+    }
+    J1939CyclicScheduler::getInstance().updatePGN(this, pgnNum);
+}
 
-            close(sendSkt);
+/**
+ * Creates the cache entry of a PGN without request payload. Lua functions are
+ * not called here.
+ *
+ * @param pgn: the numeric PGN
+ */
+void J1939Simulator::cachePGNPayload(uint32_t pgn)
+{
+    J1939PGNData pgnData = pEcuScript_->getJ1939PGNDefinition(pTables_->pgnIndex, pgn);
+    CachedPayload cachedPayload;
+    cachedPayload.cycleTime = pgnData.cycleTime;
+    cachedPayload.isLuaFunction = pgnData.isLuaFunction;
+    cachedPayload.cachePayload = pgnData.cachePayload;
+    if (!pgnData.isLuaFunction) {
+        cachedPayload.payload = pEcuScript_->literalHexStrToBytes(pgnData.payload);
+        cachedPayload.isValid = true;
+    }
 
-            cout << "PGN sent: " << pgn << endl;
+    lock_guard<mutex> lock(cachedPayloadsMutex_);
+    cachedPayloads_[pgn] = move(cachedPayload);
+}
 
+/**
+ * Gets the payload and cycle time of a PGN without request payload. A valid
+ * cached payload is copied, otherwise the PGN is looked up in Lua and the
+ * result is cached if the PGN allows it. The signals of the PGN are encoded
+ * into the copy.
+ *
+ * @param pgn: the numeric PGN
+ * @param payload: filled with the payload
+ * @param cycleTime: set to the cycle time in milliseconds
+ */
+void J1939Simulator::getPGNPayload(uint32_t pgn, vector<uint8_t>& payload, unsigned int& cycleTime)
+{
+    if (pDtcStore_ && J1939DiagnosticMessages::isDiagnosticMessage(pgn)) {
+        getDiagnosticMessage(pgn, payload, cycleTime);
+        return;
+    }
+    uint64_t generation = 0;
+    {
+        lock_guard<mutex> lock(cachedPayloadsMutex_);
+        auto iter = cachedPayloads_.find(pgn);
+        if (iter != cachedPayloads_.end()) {
+            if (iter->second.isValid) {
+                payload.assign(iter->second.payload.cbegin(), iter->second.payload.cend());
+                cycleTime = iter->second.cycleTime;
+                overlaySignals(pgn, payload);
+                return;
+            }
+            generation = iter->second.generation;
         }
+    }
 
-        usleep(1000 * cycleTime); // takes microseconds
-
-    } while (!isOnExit_);
+    // the Lua function might call `invalidatePGN()`, so the lock is not held
+    J1939PGNData pgnData = pEcuScript_->getJ1939RequestPGNData(pTables_->pgnIndex, pgn);
+    payload = pEcuScript_->literalHexStrToBytes(pgnData.payload);
+    cycleTime = pgnData.cycleTime;
+
+    lock_guard<mutex> lock(cachedPayloadsMutex_);
+    auto iter = cachedPayloads_.find(pgn);
+    // an invalidation or update in the meantime wins over the looked up payload
+    if (iter != cachedPayloads_.end() && iter->second.generation == generation) {
+        iter->second.cycleTime = pgnData.cycleTime;
+        if (!iter->second.isLuaFunction || iter->second.cachePayload) {
+            iter->second.payload = payload;
+            iter->second.isValid = true;
+        }
+    }
+    overlaySignals(pgn, payload);
 }
 
-bool J1939Simulator::isBusActive()
+/**
+ * Gets the payload of DM1 or DM2, which are encoded again if the DTCs
+ * changed since the last call.
+ *
+ * @param pgn: `J1939_PGN_DM1` or `J1939_PGN_DM2`
+ * @param payload: filled with the payload
+ * @param cycleTime: set to the cycle time in milliseconds, 0 for DM2
+ */
+void J1939Simulator::getDiagnosticMessage(uint32_t pgn, vector<uint8_t>& payload, unsigned int& cycleTime)
 {
-    int state;
-    if(can_get_state(this->device_.c_str(), &state) < 0) {
-        cerr << "Unable to get status for " << this->device_ << " assuming state OFF" << endl;
-        return false;
+    // read before encoding, so a change in the meantime is encoded on the next call
+    const uint64_t generation = pDtcStore_->getGeneration();
+    lock_guard<mutex> lock(cachedPayloadsMutex_);
+    if (!hasDiagnosticMessages_ || generation != dtcGeneration_) {
+        J1939DiagnosticMessages::encode(*pDtcStore_, dm1Payload_, dm2Payload_);
+        dtcGeneration_ = generation;
+        hasDiagnosticMessages_ = true;
     }
+    const vector<uint8_t>& message = pgn == J1939_PGN_DM1 ? dm1Payload_ : dm2Payload_;
+    payload.assign(message.cbegin(), message.cend());
+    cycleTime = pgn == J1939_PGN_DM1 ? J1939_DM1_CYCLE_TIME : 0;
+}
 
-    if(state == CAN_STATE_ERROR_ACTIVE || state == CAN_STATE_ERROR_WARNING) {
-        return true;
+/**
+ * Writes the current vehicle signals of the `Signals` table into the payload,
+ * the cached payload is kept as the background of the signals.
+ */
+void J1939Simulator::overlaySignals(uint32_t pgn, vector<uint8_t>& payload) const
+{
+    const SignalRecord *pSignals = pSignalMappings_->findPgn(pgn);
+    if (pSignals != nullptr) {
+        pSignals->overlay(payload);
     }
-    return false;
+}
+
+/**
+ * @return true if the CAN bus is able to send, as seen by the bus state
+ *         monitor of the interface, the address was not lost to another
+ *         node and the normal messages are not disabled by
+ *         `CommunicationControl`
+ */
+bool J1939Simulator::isBusActive()
+{
+    return pBusStateMonitor_->isBusActive() && pBus_->hasAddress(this) && pCommunicationGate_->isTransmitEnabled();
 }
 
 /**
@@ -351,7 +579,7 @@ bool J1939Simulator::isBusActive()
  * @param pgn 
  * @return * this 
  */
-uint32_t J1939Simulator::parsePGN(string pgn) const noexcept
+uint32_t J1939Simulator::parsePGN(const string& pgn) noexcept
 {
     uint32_t pgnNum = 0;
     // try to parse the number as decimal if the string is not more than 5 digits long
@@ -361,7 +589,7 @@ uint32_t J1939Simulator::parsePGN(string pgn) const noexcept
 
     // If number parsing fails or number is longer than 5 digits, try parsing a string instead
     if(pgnNum == 0 || pgnNum > 99999) {
-        vector<uint8_t> pgnBytes = pEcuScript_->literalHexStrToBytes(pgn);
+        vector<uint8_t> pgnBytes = EcuLuaScript::literalHexStrToBytes(pgn);
         pgnNum = 0;
         if(pgnBytes.size() <= 3) {
             // put byte together in reverse order (little endian)
@@ -374,54 +602,3 @@ uint32_t J1939Simulator::parsePGN(string pgn) const noexcept
 
     return pgnNum;
 }
-
-/**
- * Opens a socket to send a J1939 PGN
- *
- * @return socket
- */
-int J1939Simulator::openCyclicSendSocket() const noexcept
-{
-    return openJ1939Socket(source_address_);
-}
-
-/**
- * Opens a socket for sending/receiving J1939 PGNs
- *
- * @return 0 on success, otherwise a negative value
- */
-int J1939Simulator::openJ1939Socket(const uint8_t node_address) const noexcept
-{
-    // see also: https://www.kernel.org/doc/html/latest/networking/j1939.html
-    struct sockaddr_can addr = {};
-    addr.can_family = AF_CAN;
-    addr.can_addr.j1939.pgn = J1939_NO_PGN; // Receive all PGNs
-    addr.can_addr.j1939.name = J1939_NO_NAME; // Don't do name lookups
-    addr.can_addr.j1939.addr = node_address; // source address
-
-    int skt = socket(PF_CAN, SOCK_DGRAM, CAN_J1939);
-    if (skt < 0)
-    {
-        cerr << __func__ << "() socket: " << strerror(errno) << endl;
-        return -1;
-    }
-
-    struct ifreq ifr = {};
-    strncpy(ifr.ifr_name, device_.c_str(), device_.length() + 1);
-    ioctl(skt, SIOCGIFINDEX, &ifr);
-    addr.can_ifindex = ifr.ifr_ifindex;
-    int value = 1;
-    setsockopt(skt, SOL_SOCKET, SO_BROADCAST, &value, sizeof(value));
-
-    auto bind_res = bind(skt,
-                         reinterpret_cast<struct sockaddr*> (&addr),
-                         sizeof(addr));
-    if (bind_res < 0)
-    {
-        cerr << __func__ << "() bind: " << strerror(errno) << '\n';
-        close(skt);
-        return -2;
-    }
-
-    return skt;
-}
\ No newline at end of file
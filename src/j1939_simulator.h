@@ -10,56 +10,125 @@
 #include <string>
 #include <vector>
 #include <memory>
-#include <thread>
+#include <condition_variable>
 #include <map>
+#include <mutex>
 
 #include "ecu_lua_script.h"
+#include "j1939_bus.h"
+#include "j1939_cyclic_scheduler.h"
+#include "bus_state_monitor.h"
+
+class EcuMetrics;
 
 constexpr uint32_t J1939_PGN_REQUESTPGN = 0xEA00;
 constexpr uint32_t J1939_PGN_ACKPGN = 0xE800;
 constexpr uint8_t J1939_BROADCAST_ID = 0xFF;
 
-class J1939Simulator
+/**
+ * Simulates the J1939 node of an ECU. The messages to the node are received
+ * by the shared `J1939Bus` of the interface, the node only owns the socket
+ * bound to its source address, which sends the responses and the cyclic PGNs.
+ *
+ * With `J1939DiagnosticMessages`, DM1 is sent every second and DM2 is
+ * answered on request from the `DtcStore` of the ECU (see
+ * `J1939DiagnosticMessages`), instead of the `PGNs` table. Their payloads
+ * are only encoded again after the DTCs changed.
+ */
+class J1939Simulator : public J1939CyclicSource, public J1939Node
 {
 public:
     static bool hasSimulation(EcuLuaScript *pEcuScript);
+    static std::uint32_t parsePGN(const std::string& pgn) noexcept;
 
 public:
     J1939Simulator() = delete;
     J1939Simulator(const std::string& device,
                    EcuLuaScript* pEcuScript);
     virtual ~J1939Simulator();
-    int openReceiver() noexcept;
-    void closeReceiver() noexcept;
-    int readDataThread() noexcept;
-    void startPeriodicSenderThreads();
-    void processReceivedData(const uint8_t* buffer, const size_t num_bytes, const uint8_t sourceAddress, const uint32_t pgn) noexcept;
+    int openSender() noexcept;
+    void closeSender() noexcept;
+    void startCyclicMessages();
+    virtual void processReceivedData(const std::uint8_t* buffer, std::size_t num_bytes,
+                                     std::uint8_t sourceAddress, std::uint32_t pgn) noexcept override;
     std::vector<unsigned char> assembleACK(const std::string ackInfoByteString, const uint8_t targetAddress, const uint32_t pgn);
-    void sendCyclicMessage(const std::string pgn) noexcept;
+    std::map<std::uint32_t, J1939CyclicScheduler::Statistics> getCyclicStatistics() const;
+
+    virtual std::uint8_t getSourceAddress() const noexcept override;
+    virtual std::uint64_t getName() const noexcept override;
+    virtual int getSendSocket() const noexcept override;
+    virtual std::vector<std::uint32_t> getReceivedPgns() const override;
+    virtual int getCyclicSocket() const noexcept override;
+    virtual std::uint8_t getCyclicSourceAddress() const noexcept override;
+    virtual std::uint8_t getCaptureInterface() const noexcept override;
+    virtual bool isBusActive() override;
+    virtual void getCyclicPayload(const std::string& pgnKey,
+                                  std::uint32_t pgn,
+                                  std::vector<std::uint8_t>& payload,
+                                  unsigned int& cycleTime) override;
+    virtual bool isStaticPayload(std::uint32_t pgn) override;
+    virtual std::string getCyclicDevice() const override;
+    void invalidatePGN(const std::string& pgn);
+    void setPGNPayload(const std::string& pgn, const std::vector<std::uint8_t>& payload);
 
     void stopSimulation();
     void waitForSimulationEnd();
 
 
 private:
+    /**
+     * The decoded payload of a PGN without request payload. Static payloads
+     * are decoded once, payload functions are called on every cycle or, with
+     * `cachePayload`, only after `invalidatePGN()`.
+     */
+    struct CachedPayload
+    {
+        std::vector<std::uint8_t> payload;
+        unsigned int cycleTime = 0;
+        bool isLuaFunction = false;
+        bool cachePayload = false;
+        bool isValid = false; ///< false if the payload has to be read from Lua
+        std::uint64_t generation = 0; ///< incremented on every invalidation or update
+    };
+
     uint8_t source_address_;
     std::string device_;
+    std::uint8_t captureInterface_; ///< see `TrafficCapture::getInterfaceIndex()`
     EcuLuaScript* pEcuScript_;
-    int receive_skt_ = -1;
+    std::uint64_t name_; ///< the NAME of the address claim, 0 for a static address
+    int send_skt_ = -1; ///< bound to the source address
     bool isOnExit_ = false;
-    std::thread *j1939ReceiverThread_;
-    std::vector<std::thread*> cyclicMessageThreads;
-    shared_ptr<RequestByteTreeNode<shared_ptr<Selector>>> requestByteTree;
-    map<string,shared_ptr<Selector>> pgnsWithoutSeparator;
+    std::mutex exitMutex_;
+    std::condition_variable exitCondition_;
+    /// the compiled 'PGNs' table, shared by the simulations of the ECU on all interfaces
+    std::shared_ptr<const EcuLuaScript::J1939Tables> pTables_;
+    std::shared_ptr<BusStateMonitor> pBusStateMonitor_;
+    std::shared_ptr<J1939Bus> pBus_;
+    std::vector<std::uint32_t> receivedPgns_; ///< see `getReceivedPgns()`
+    EcuMetrics* pMetrics_;
+    std::map<std::uint32_t, CachedPayload> cachedPayloads_; ///< keyed by the numeric PGN
+    std::mutex cachedPayloadsMutex_;
+    /// the PGNs of the `Signals` table, overlaid on every payload
+    std::shared_ptr<const SignalMappings> pSignalMappings_;
+    /// the DTCs of DM1 and DM2, `nullptr` if they are defined in the `PGNs` table
+    std::shared_ptr<DtcStore> pDtcStore_;
+    // the encoded DM1 and DM2, guarded by `cachedPayloadsMutex_`
+    std::vector<std::uint8_t> dm1Payload_;
+    std::vector<std::uint8_t> dm2Payload_;
+    std::uint64_t dtcGeneration_ = 0; ///< the `DtcStore::getGeneration()` of the payloads
+    bool hasDiagnosticMessages_ = false; ///< the payloads are encoded
+    /// stops the cyclic PGNs while `CommunicationControl` disables the normal messages
+    std::shared_ptr<CommunicationGate> pCommunicationGate_;
+    int gateListenerId_ = -1;
 
     uint16_t *pgns_;
 
-    int openCyclicSendSocket() const noexcept;
-    int openJ1939Socket(const uint8_t node_address) const noexcept;
     ssize_t sendJ1939Message(int skt, struct sockaddr_can saddr, std::vector<unsigned char> payload) noexcept;
 
-    uint32_t parsePGN(std::string pgn) const noexcept;
-    bool isBusActive();
+    void cachePGNPayload(std::uint32_t pgn);
+    void getPGNPayload(std::uint32_t pgn, std::vector<std::uint8_t>& payload, unsigned int& cycleTime);
+    void overlaySignals(std::uint32_t pgn, std::vector<std::uint8_t>& payload) const;
+    void getDiagnosticMessage(std::uint32_t pgn, std::vector<std::uint8_t>& payload, unsigned int& cycleTime);
 
 };
 
@@ -91,4 +91,15 @@ uint16_t		update_crc_dnp(    uint16_t crc, unsigned char c
 uint16_t		update_crc_kermit( uint16_t crc, unsigned char c                          );
 uint16_t		update_crc_sick(   uint16_t crc, unsigned char c, unsigned char prev_byte );
 
+/*
+ * Incremental calculation over a stream of blocks. The CRC starts with the
+ * CRC_START_... value of the variant, is updated with every block and, for
+ * CRC-32 only, finalized once at the end.
+ */
+
+uint16_t		update_crc_16_block(    uint16_t crc, const unsigned char *input_str, size_t num_bytes );
+uint32_t		update_crc_32_block(    uint32_t crc, const unsigned char *input_str, size_t num_bytes );
+uint16_t		update_crc_ccitt_block( uint16_t crc, const unsigned char *input_str, size_t num_bytes );
+uint32_t		finalize_crc_32(        uint32_t crc                                           );
+
 #endif  // DEF_LIBCRC_CHECKSUM_H
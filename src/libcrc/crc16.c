@@ -39,6 +39,7 @@ static void             init_crc16_tab( void );
 
 static bool             crc_tab16_init          = false;
 static uint16_t         crc_tab16[256];
+static uint16_t         crc_tab16_slice[8][256];
 
 /*
  * uint16_t crc_16( const unsigned char *input_str, size_t num_bytes );
@@ -51,27 +52,9 @@ static uint16_t         crc_tab16[256];
 
 uint16_t crc_16( const unsigned char *input_str, size_t num_bytes ) {
 
-	uint16_t crc;
-	uint16_t tmp;
-	uint16_t short_c;
-	const unsigned char *ptr;
-	size_t a;
-
-	if ( ! crc_tab16_init ) init_crc16_tab();
-
-	crc = CRC_START_16;
-	ptr = input_str;
-
-	if ( ptr != NULL ) for (a=0; a<num_bytes; a++) {
+	if ( input_str == NULL ) return CRC_START_16;
 
-		short_c = 0x00ff & (uint16_t) *ptr;
-		tmp     =  crc       ^ short_c;
-		crc     = (crc >> 8) ^ crc_tab16[ tmp & 0xff ];
-
-		ptr++;
-	}
-
-	return crc;
+	return update_crc_16_block( CRC_START_16, input_str, num_bytes );
 
 }  /* crc_16 */
 
@@ -85,27 +68,9 @@ uint16_t crc_16( const unsigned char *input_str, size_t num_bytes ) {
 
 uint16_t crc_modbus( const unsigned char *input_str, size_t num_bytes ) {
 
-	uint16_t crc;
-	uint16_t tmp;
-	uint16_t short_c;
-	const unsigned char *ptr;
-	size_t a;
-
-	if ( ! crc_tab16_init ) init_crc16_tab();
-
-	crc = CRC_START_MODBUS;
-	ptr = input_str;
+	if ( input_str == NULL ) return CRC_START_MODBUS;
 
-	if ( ptr != NULL ) for (a=0; a<num_bytes; a++) {
-
-		short_c = 0x00ff & (uint16_t) *ptr;
-		tmp     =  crc       ^ short_c;
-		crc     = (crc >> 8) ^ crc_tab16[ tmp & 0xff ];
-
-		ptr++;
-	}
-
-	return crc;
+	return update_crc_16_block( CRC_START_MODBUS, input_str, num_bytes );
 
 }  /* crc_modbus */
 
@@ -132,6 +97,43 @@ uint16_t update_crc_16( uint16_t crc, unsigned char c ) {
 
 }  /* update_crc_16 */
 
+/*
+ * uint16_t update_crc_16_block( uint16_t crc, const unsigned char *input_str, size_t num_bytes );
+ *
+ * The function update_crc_16_block() calculates a new CRC-16 (or Modbus) value
+ * based on the previous value of the CRC and the next block of data to be
+ * checked. Eight bytes are processed at once with the slicing-by-8 tables.
+ */
+
+uint16_t update_crc_16_block( uint16_t crc, const unsigned char *input_str, size_t num_bytes ) {
+
+	const unsigned char *ptr;
+
+	if ( ! crc_tab16_init ) init_crc16_tab();
+
+	ptr = input_str;
+
+	while ( num_bytes >= 8 ) {
+
+		crc ^= (uint16_t) ( ptr[0] | (ptr[1] << 8) );
+		crc  = crc_tab16_slice[7][crc & 0xff] ^ crc_tab16_slice[6][crc >> 8]
+		     ^ crc_tab16_slice[5][ptr[2]    ] ^ crc_tab16_slice[4][ptr[3] ]
+		     ^ crc_tab16_slice[3][ptr[4]    ] ^ crc_tab16_slice[2][ptr[5] ]
+		     ^ crc_tab16_slice[1][ptr[6]    ] ^ crc_tab16_slice[0][ptr[7] ];
+
+		ptr       += 8;
+		num_bytes -= 8;
+	}
+
+	while ( num_bytes-- > 0 ) {
+
+		crc = (crc >> 8) ^ crc_tab16[ (crc ^ *ptr++) & 0xff ];
+	}
+
+	return crc;
+
+}  /* update_crc_16_block */
+
 /*
  * static void init_crc16_tab( void );
  *
@@ -164,6 +166,17 @@ static void init_crc16_tab( void ) {
 		crc_tab16[i] = crc;
 	}
 
+	for (i=0; i<256; i++) {
+
+		crc_tab16_slice[0][i] = crc_tab16[i];
+
+		for (j=1; j<8; j++) {
+
+			crc = crc_tab16_slice[j-1][i];
+			crc_tab16_slice[j][i] = (crc >> 8) ^ crc_tab16[crc & 0xff];
+		}
+	}
+
 	crc_tab16_init = true;
 
 }  /* init_crc16_tab */
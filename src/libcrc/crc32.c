@@ -33,12 +33,18 @@
 
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 #include "checksum.h"
 
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
 static void             init_crc32_tab( void );
 
 static bool             crc_tab32_init          = false;
 static uint32_t		crc_tab32[256];
+static uint32_t		crc_tab32_slice[8][256];
 
 /*
  * uint32_t crc_32( const unsigned char *input_str, size_t num_bytes );
@@ -51,28 +57,12 @@ static uint32_t		crc_tab32[256];
 uint32_t crc_32( const unsigned char *input_str, size_t num_bytes ) {
 
 	uint32_t crc;
-	uint32_t tmp;
-	uint32_t long_c;
-	const unsigned char *ptr;
-	size_t a;
-
-	if ( ! crc_tab32_init ) init_crc32_tab();
 
 	crc = CRC_START_32;
-	ptr = input_str;
 
-	if ( ptr != NULL ) for (a=0; a<num_bytes; a++) {
+	if ( input_str != NULL ) crc = update_crc_32_block( crc, input_str, num_bytes );
 
-		long_c = 0x000000FFL & (uint32_t) *ptr;
-		tmp    =  crc       ^ long_c;
-		crc    = (crc >> 8) ^ crc_tab32[ tmp & 0xff ];
-
-		ptr++;
-	}
-
-	crc ^= 0xffffffffL;
-
-	return crc & 0xffffffffL;
+	return finalize_crc_32( crc );
 
 }  /* crc_32 */
 
@@ -99,6 +89,77 @@ uint32_t update_crc_32( uint32_t crc, unsigned char c ) {
 
 }  /* update_crc_32 */
 
+/*
+ * uint32_t update_crc_32_block( uint32_t crc, const unsigned char *input_str, size_t num_bytes );
+ *
+ * The function update_crc_32_block() calculates a new CRC-32 value based on
+ * the previous value of the CRC and the next block of the data to be checked.
+ * Like update_crc_32() the value is not finalized, see finalize_crc_32(). The
+ * ARMv8 CRC32 instructions are used if the compiler targets them, otherwise
+ * eight bytes are processed at once with the slicing-by-8 tables.
+ */
+
+uint32_t update_crc_32_block( uint32_t crc, const unsigned char *input_str, size_t num_bytes ) {
+
+	const unsigned char *ptr;
+
+	ptr = input_str;
+
+#if defined(__ARM_FEATURE_CRC32) && defined(__ORDER_LITTLE_ENDIAN__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+
+	while ( num_bytes >= 8 ) {
+
+		uint64_t value;
+
+		memcpy( &value, ptr, sizeof(value) );
+		crc = __crc32d( crc, value );
+
+		ptr       += 8;
+		num_bytes -= 8;
+	}
+
+	while ( num_bytes-- > 0 ) crc = __crc32b( crc, *ptr++ );
+
+#else
+
+	if ( ! crc_tab32_init ) init_crc32_tab();
+
+	while ( num_bytes >= 8 ) {
+
+		crc ^= (uint32_t) ptr[0] | ((uint32_t) ptr[1] << 8) | ((uint32_t) ptr[2] << 16) | ((uint32_t) ptr[3] << 24);
+		crc  = crc_tab32_slice[7][ crc        & 0xff] ^ crc_tab32_slice[6][(crc >>  8) & 0xff]
+		     ^ crc_tab32_slice[5][(crc >> 16) & 0xff] ^ crc_tab32_slice[4][ crc >> 24        ]
+		     ^ crc_tab32_slice[3][ptr[4]            ] ^ crc_tab32_slice[2][ptr[5]            ]
+		     ^ crc_tab32_slice[1][ptr[6]            ] ^ crc_tab32_slice[0][ptr[7]            ];
+
+		ptr       += 8;
+		num_bytes -= 8;
+	}
+
+	while ( num_bytes-- > 0 ) {
+
+		crc = (crc >> 8) ^ crc_tab32[ (crc ^ *ptr++) & 0xff ];
+	}
+
+#endif
+
+	return crc;
+
+}  /* update_crc_32_block */
+
+/*
+ * uint32_t finalize_crc_32( uint32_t crc );
+ *
+ * The function finalize_crc_32() returns the CRC-32 value of the data, after
+ * it has been calculated with update_crc_32() or update_crc_32_block().
+ */
+
+uint32_t finalize_crc_32( uint32_t crc ) {
+
+	return crc ^ 0xffffffffL;
+
+}  /* finalize_crc_32 */
+
 /*
  * static void init_crc32_tab( void );
  *
@@ -126,6 +187,17 @@ static void init_crc32_tab( void ) {
 		crc_tab32[i] = crc;
 	}
 
+	for (i=0; i<256; i++) {
+
+		crc_tab32_slice[0][i] = crc_tab32[i];
+
+		for (j=1; j<8; j++) {
+
+			crc = crc_tab32_slice[j-1][i];
+			crc_tab32_slice[j][i] = (crc >> 8) ^ crc_tab32[crc & 0xff];
+		}
+	}
+
 	crc_tab32_init = true;
 
 }  /* init_crc32_tab */
@@ -40,6 +40,7 @@ static void             init_crcccitt_tab( void );
 
 static bool             crc_tabccitt_init       = false;
 static uint16_t         crc_tabccitt[256];
+static uint16_t         crc_tabccitt_slice[8][256];
 
 /*
  * uint16_t crc_xmodem( const unsigned char *input_str, size_t num_bytes );
@@ -92,27 +93,9 @@ uint16_t crc_ccitt_ffff( const unsigned char *input_str, size_t num_bytes ) {
 
 static uint16_t crc_ccitt_generic( const unsigned char *input_str, size_t num_bytes, uint16_t start_value ) {
 
-	uint16_t crc;
-	uint16_t tmp;
-	uint16_t short_c;
-	const unsigned char *ptr;
-	size_t a;
-
-	if ( ! crc_tabccitt_init ) init_crcccitt_tab();
-
-	crc = start_value;
-	ptr = input_str;
-
-	if ( ptr != NULL ) for (a=0; a<num_bytes; a++) {
-
-		short_c = 0x00ff & (unsigned short) *ptr;
-		tmp     = (crc >> 8) ^ short_c;
-		crc     = (crc << 8) ^ crc_tabccitt[tmp];
-
-		ptr++;
-	}
+	if ( input_str == NULL ) return start_value;
 
-	return crc;
+	return update_crc_ccitt_block( start_value, input_str, num_bytes );
 
 }  /* crc_ccitt_generic */
 
@@ -139,6 +122,44 @@ uint16_t update_crc_ccitt( uint16_t crc, unsigned char c ) {
 
 }  /* update_crc_ccitt */
 
+/*
+ * uint16_t update_crc_ccitt_block( uint16_t crc, const unsigned char *input_str, size_t num_bytes );
+ *
+ * The function update_crc_ccitt_block() calculates a new CRC-CCITT value based
+ * on the previous value of the CRC and the next block of the data to be
+ * checked. Eight bytes are processed at once with the slicing-by-8 tables,
+ * which is several times faster than calling update_crc_ccitt() per byte.
+ */
+
+uint16_t update_crc_ccitt_block( uint16_t crc, const unsigned char *input_str, size_t num_bytes ) {
+
+	const unsigned char *ptr;
+
+	if ( ! crc_tabccitt_init ) init_crcccitt_tab();
+
+	ptr = input_str;
+
+	while ( num_bytes >= 8 ) {
+
+		crc ^= (uint16_t) ( (ptr[0] << 8) | ptr[1] );
+		crc  = crc_tabccitt_slice[7][crc >> 8  ] ^ crc_tabccitt_slice[6][crc & 0xff]
+		     ^ crc_tabccitt_slice[5][ptr[2]    ] ^ crc_tabccitt_slice[4][ptr[3]    ]
+		     ^ crc_tabccitt_slice[3][ptr[4]    ] ^ crc_tabccitt_slice[2][ptr[5]    ]
+		     ^ crc_tabccitt_slice[1][ptr[6]    ] ^ crc_tabccitt_slice[0][ptr[7]    ];
+
+		ptr       += 8;
+		num_bytes -= 8;
+	}
+
+	while ( num_bytes-- > 0 ) {
+
+		crc = (crc << 8) ^ crc_tabccitt[ (crc >> 8) ^ *ptr++ ];
+	}
+
+	return crc;
+
+}  /* update_crc_ccitt_block */
+
 /*
  * static void init_crcccitt_tab( void );
  *
@@ -171,6 +192,22 @@ static void init_crcccitt_tab( void ) {
 		crc_tabccitt[i] = crc;
 	}
 
+	/*
+	 * crc_tabccitt_slice[k][i] is the CRC of the byte i followed by k zero
+	 * bytes, i.e. slice 0 is the table above.
+	 */
+
+	for (i=0; i<256; i++) {
+
+		crc_tabccitt_slice[0][i] = crc_tabccitt[i];
+
+		for (j=1; j<8; j++) {
+
+			crc = crc_tabccitt_slice[j-1][i];
+			crc_tabccitt_slice[j][i] = (crc << 8) ^ crc_tabccitt[crc >> 8];
+		}
+	}
+
 	crc_tabccitt_init = true;
 
 }  /* init_crcccitt_tab */
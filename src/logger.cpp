@@ -0,0 +1,283 @@
+/**
+ * @file logger.cpp
+ *
+ * This file contains the asynchronous logger, which takes the console output
+ * off the receiving and sending threads.
+ */
+
+#include "logger.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+/// The time the writer thread sleeps if there are no messages.
+static constexpr chrono::milliseconds IDLE_INTERVAL(5);
+
+atomic<int> Logger::level_(LOG_LEVEL_INFO);
+
+namespace
+{
+
+/**
+ * Stream buffer writing into a fixed array. Output beyond the array is
+ * discarded, i.e. the message gets truncated.
+ */
+class LineBuffer : public streambuf
+{
+public:
+    LineBuffer() { reset(); }
+
+    void reset() { setp(buffer_, buffer_ + Logger::MAX_MESSAGE_SIZE); }
+    const char* data() const { return pbase(); }
+    size_t length() const { return static_cast<size_t>(pptr() - pbase()); }
+
+private:
+    char buffer_[Logger::MAX_MESSAGE_SIZE];
+};
+
+struct LineStream
+{
+    LineBuffer buffer;
+    ostream stream{&buffer};
+};
+
+/// The stream of the calling thread, created once per thread.
+LineStream& getLineStream()
+{
+    static thread_local LineStream lineStream;
+    return lineStream;
+}
+
+} // namespace
+
+/**
+ * Writes the bytes without the formatting flags of the stream. Stops when the
+ * message is truncated.
+ */
+ostream& operator <<(ostream& stream, const HexDump& dump)
+{
+    static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+    char byteString[] = " 0x00";
+    for (size_t i = 0; i < dump.length && stream.good(); ++i)
+    {
+        byteString[3] = HEX_DIGITS[dump.data[i] >> 4];
+        byteString[4] = HEX_DIGITS[dump.data[i] & 0x0F];
+        stream.write(byteString, sizeof(byteString) - 1);
+    }
+    return stream;
+}
+
+/**
+ * Prepares the stream of the calling thread for a new message.
+ *
+ * @param level: the level of the message
+ */
+Logger::Line::Line(LogLevel level) noexcept
+: level_(level)
+, stream_(getLineStream().stream)
+{
+    LineStream& lineStream = getLineStream();
+    lineStream.buffer.reset();
+    lineStream.stream.clear();
+    lineStream.stream.flags(ios_base::dec | ios_base::skipws);
+    lineStream.stream.fill(' ');
+    lineStream.stream.width(0);
+    lineStream.stream.precision(6);
+}
+
+/**
+ * Queues the formatted message.
+ */
+Logger::Line::~Line()
+{
+    const LineBuffer& buffer = getLineStream().buffer;
+    Logger::getInstance().log(level_, buffer.data(), buffer.length());
+}
+
+/**
+ * @return the logger of the process, the writer thread is started on the
+ *         first call
+ */
+Logger& Logger::getInstance()
+{
+    static Logger logger;
+    return logger;
+}
+
+/**
+ * Constructor. Allocates the queue and starts the writer thread.
+ */
+Logger::Logger()
+: pSlots_(new array<Slot, QUEUE_SIZE>())
+{
+    for (size_t i = 0; i < QUEUE_SIZE; ++i)
+    {
+        (*pSlots_)[i].sequence.store(i, memory_order_relaxed);
+    }
+    writerThread_ = thread(&Logger::run, this);
+}
+
+/**
+ * Destructor. Writes the remaining messages and stops the writer thread.
+ */
+Logger::~Logger()
+{
+    isRunning_ = false;
+    if (writerThread_.joinable())
+    {
+        writerThread_.join();
+    }
+}
+
+/**
+ * Sets the minimum level of the messages to write. Levels below `LOG_MIN_LEVEL`
+ * are not compiled in and can not be enabled.
+ *
+ * @param level: the new minimum level (`LogLevel::INFO` on default)
+ */
+void Logger::setLevel(LogLevel level) noexcept
+{
+    level_.store(static_cast<int>(level), memory_order_relaxed);
+}
+
+LogLevel Logger::getLevel() noexcept
+{
+    return static_cast<LogLevel>(level_.load(memory_order_relaxed));
+}
+
+/**
+ * Converts the name of a level (e.g. "debug" or "WARNING") into the level.
+ *
+ * @param name: the name of the level
+ * @param level: set to the level, unchanged if the name is unknown
+ * @return true if the name is valid
+ */
+bool Logger::parseLevel(const string& name, LogLevel& level) noexcept
+{
+    string lowerName = name;
+    transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
+    if (lowerName == "debug") level = LogLevel::DEBUG;
+    else if (lowerName == "info") level = LogLevel::INFO;
+    else if (lowerName == "warning") level = LogLevel::WARNING;
+    else if (lowerName == "error") level = LogLevel::ERROR;
+    else if (lowerName == "none") level = LogLevel::NONE;
+    else return false;
+    return true;
+}
+
+/**
+ * Queues a message without waiting. If the queue is full, the message is
+ * dropped.
+ *
+ * @param level: the level of the message
+ * @param message: the message without line break
+ * @param length: the length of the message
+ */
+void Logger::log(LogLevel level, const char* message, size_t length) noexcept
+{
+    size_t pos = enqueuePos_.load(memory_order_relaxed);
+    Slot* pSlot;
+    while (true)
+    {
+        pSlot = &(*pSlots_)[pos & (QUEUE_SIZE - 1)];
+        const size_t sequence = pSlot->sequence.load(memory_order_acquire);
+        const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (difference == 0)
+        {
+            if (enqueuePos_.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            dropped_.fetch_add(1, memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            pos = enqueuePos_.load(memory_order_relaxed);
+        }
+    }
+
+    pSlot->level = level;
+    pSlot->length = static_cast<uint32_t>(min(length, MAX_MESSAGE_SIZE));
+    memcpy(pSlot->message, message, pSlot->length);
+    pSlot->sequence.store(pos + 1, memory_order_release);
+}
+
+/**
+ * Blocks until all messages queued before the call are written.
+ */
+void Logger::flush() noexcept
+{
+    const size_t target = enqueuePos_.load(memory_order_acquire);
+    while (dequeuePos_.load(memory_order_acquire) < target && isRunning_)
+    {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+}
+
+/**
+ * @return the number of messages dropped due to a full queue
+ */
+uint64_t Logger::getDroppedMessages() const noexcept
+{
+    return dropped_.load(memory_order_relaxed);
+}
+
+void Logger::run() noexcept
+{
+    while (isRunning_)
+    {
+        if (!writeQueued())
+        {
+            this_thread::sleep_for(IDLE_INTERVAL);
+        }
+    }
+    writeQueued();
+}
+
+/**
+ * Writes all queued messages.
+ *
+ * @return true if there was at least one message
+ */
+bool Logger::writeQueued() noexcept
+{
+    static uint64_t reportedDropped = 0;
+    bool hasWritten = false;
+    size_t pos = dequeuePos_.load(memory_order_relaxed);
+    while (true)
+    {
+        Slot& slot = (*pSlots_)[pos & (QUEUE_SIZE - 1)];
+        if (slot.sequence.load(memory_order_acquire) != pos + 1)
+        {
+            break;
+        }
+        FILE* pStream = slot.level >= LogLevel::WARNING ? stderr : stdout;
+        fwrite(slot.message, 1, slot.length, pStream);
+        fputc('\n', pStream);
+        slot.sequence.store(pos + QUEUE_SIZE, memory_order_release);
+        dequeuePos_.store(++pos, memory_order_release);
+        hasWritten = true;
+    }
+
+    const uint64_t dropped = dropped_.load(memory_order_relaxed);
+    if (dropped != reportedDropped)
+    {
+        fprintf(stderr, "Logger: %llu messages dropped\n",
+                static_cast<unsigned long long>(dropped - reportedDropped));
+        reportedDropped = dropped;
+    }
+    if (hasWritten)
+    {
+        fflush(stdout);
+        fflush(stderr);
+    }
+    return hasWritten;
+}
@@ -0,0 +1,174 @@
+/**
+ * @file logger.h
+ *
+ */
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARNING 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE 4
+
+/**
+ * Messages below this level are removed by the compiler, e.g. build with
+ * `-DLOG_MIN_LEVEL=LOG_LEVEL_INFO` to drop all debug output (like the hex
+ * dumps of the received frames).
+ */
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+enum class LogLevel : int
+{
+    DEBUG = LOG_LEVEL_DEBUG,
+    INFO = LOG_LEVEL_INFO,
+    WARNING = LOG_LEVEL_WARNING,
+    ERROR = LOG_LEVEL_ERROR,
+    NONE = LOG_LEVEL_NONE
+};
+
+/**
+ * Asynchronous logger.
+ *
+ * A message is formatted into a buffer of the calling thread and copied into
+ * a slot of a bounded, lock-free queue. A background thread drains the queue
+ * and writes the messages to stdout (warnings and errors to stderr), so the
+ * receiving and sending threads never wait for the console. If the queue is
+ * full, the message is dropped and counted instead of blocking.
+ *
+ * Use the `LOG_*` macros, which check the level before any argument is
+ * evaluated:
+ *
+ *     LOG_DEBUG(__func__ << "() Received " << num_bytes << " bytes.");
+ */
+class Logger
+{
+public:
+    /// Longer messages are truncated.
+    static constexpr std::size_t MAX_MESSAGE_SIZE = 512;
+    /// The number of queued messages (has to be a power of 2).
+    static constexpr std::size_t QUEUE_SIZE = 4096;
+
+    /**
+     * One message, which is queued when it is destroyed at the end of the
+     * `LOG_*` statement.
+     */
+    class Line
+    {
+    public:
+        explicit Line(LogLevel level) noexcept;
+        Line(const Line& orig) = delete;
+        Line& operator =(const Line& orig) = delete;
+        ~Line();
+
+        template<class T>
+        Line& operator <<(const T& value)
+        {
+            stream_ << value;
+            return *this;
+        }
+
+        Line& operator <<(std::ostream& (*manipulator)(std::ostream&))
+        {
+            stream_ << manipulator;
+            return *this;
+        }
+
+    private:
+        LogLevel level_;
+        std::ostream& stream_;
+    };
+
+    static Logger& getInstance();
+
+    Logger();
+    Logger(const Logger& orig) = delete;
+    Logger& operator =(const Logger& orig) = delete;
+    virtual ~Logger();
+
+    /**
+     * @return true if messages of the given level are written
+     */
+    static bool isEnabled(LogLevel level) noexcept
+    {
+        return static_cast<int>(level) >= LOG_MIN_LEVEL
+            && static_cast<int>(level) >= level_.load(std::memory_order_relaxed);
+    }
+
+    static void setLevel(LogLevel level) noexcept;
+    static LogLevel getLevel() noexcept;
+    static bool parseLevel(const std::string& name, LogLevel& level) noexcept;
+
+    void log(LogLevel level, const char* message, std::size_t length) noexcept;
+    void flush() noexcept;
+    std::uint64_t getDroppedMessages() const noexcept;
+
+private:
+    struct Slot
+    {
+        std::atomic<std::size_t> sequence;
+        LogLevel level;
+        std::uint32_t length;
+        char message[MAX_MESSAGE_SIZE];
+    };
+
+    static std::atomic<int> level_;
+
+    std::unique_ptr<std::array<Slot, QUEUE_SIZE>> pSlots_;
+    alignas(64) std::atomic<std::size_t> enqueuePos_{0};
+    alignas(64) std::atomic<std::size_t> dequeuePos_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<bool> isRunning_{true};
+    std::thread writerThread_;
+
+    void run() noexcept;
+    bool writeQueued() noexcept;
+};
+
+/**
+ * Bytes written as " 0x01 0x02 ..." into a log message, see `hexDump()`.
+ */
+struct HexDump
+{
+    const std::uint8_t* data;
+    std::size_t length;
+};
+
+/**
+ * @param data: the bytes to write
+ * @param length: the number of bytes
+ * @return the bytes to be written into a log message
+ */
+inline HexDump hexDump(const std::uint8_t* data, std::size_t length) noexcept
+{
+    return HexDump{data, length};
+}
+
+std::ostream& operator <<(std::ostream& stream, const HexDump& dump);
+
+#define LOG(level, message) \
+    do { \
+        if (static_cast<int>(level) >= LOG_MIN_LEVEL && Logger::isEnabled(level)) { \
+            Logger::Line(level) << message; \
+        } \
+    } while (false)
+
+#define LOG_DEBUG(message) LOG(LogLevel::DEBUG, message)
+#define LOG_INFO(message) LOG(LogLevel::INFO, message)
+#define LOG_WARNING(message) LOG(LogLevel::WARNING, message)
+#define LOG_ERROR(message) LOG(LogLevel::ERROR, message)
+
+#endif /* LOGGER_H */
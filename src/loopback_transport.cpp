@@ -0,0 +1,77 @@
+/**
+ * @file loopback_transport.cpp
+ *
+ */
+
+#include "loopback_transport.h"
+
+using namespace std;
+
+/**
+ * Keeps the message as the last response.
+ *
+ * @param buffer: the message
+ * @param size: the length of the message in bytes
+ * @return the length of the message
+ */
+int LoopbackTransport::sendData(const void* buffer, size_t size) noexcept
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        const uint8_t* pBytes = static_cast<const uint8_t*>(buffer);
+        try
+        {
+            response_.assign(pBytes, pBytes + size);
+        }
+        catch (exception&)
+        {
+            return -1;
+        }
+        responseCount_++;
+    }
+    condition_.notify_all();
+    return static_cast<int>(size);
+}
+
+/**
+ * Drops the last response, called before a request is passed to the ECU.
+ */
+void LoopbackTransport::clear() noexcept
+{
+    lock_guard<mutex> lock(mutex_);
+    response_.clear();
+    responseCount_ = 0;
+}
+
+/**
+ * @return the number of messages sent since `clear()`
+ */
+size_t LoopbackTransport::getResponseCount() const noexcept
+{
+    lock_guard<mutex> lock(mutex_);
+    return responseCount_;
+}
+
+/**
+ * Waits until the given number of messages was sent since `clear()`.
+ *
+ * @param count: the number of messages to wait for
+ * @param timeout: the max. time to wait
+ * @return false on timeout
+ */
+bool LoopbackTransport::waitForResponse(size_t count, chrono::milliseconds timeout)
+{
+    unique_lock<mutex> lock(mutex_);
+    return condition_.wait_for(lock, timeout, [this, count]() { return responseCount_ >= count; });
+}
+
+/**
+ * @param response: set to the last response, empty if there is none
+ * @return the number of messages sent since `clear()`
+ */
+size_t LoopbackTransport::copyResponse(vector<uint8_t>& response) const
+{
+    lock_guard<mutex> lock(mutex_);
+    response.assign(response_.cbegin(), response_.cend());
+    return responseCount_;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file loopback_transport.h
+ *
+ */
+
+#ifndef LOOPBACK_TRANSPORT_H
+#define LOOPBACK_TRANSPORT_H
+
+#include "uds_transport.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * In-process transport of an ECU without CAN interface: the requests are
+ * passed to `UdsReceiver::proceedReceivedData()` directly and the responses
+ * are kept here until the caller picks them up, see `CarSimulator`. No socket
+ * and no kernel round trip is involved.
+ *
+ * Only the last response is kept, e.g. the final response after some
+ * `7F xx 78`. Its buffer keeps its capacity, so a response does not allocate.
+ */
+class LoopbackTransport : public UdsTransport
+{
+public:
+    LoopbackTransport() = default;
+    LoopbackTransport(const LoopbackTransport& orig) = delete;
+    LoopbackTransport& operator =(const LoopbackTransport& orig) = delete;
+    virtual ~LoopbackTransport() = default;
+
+    virtual int sendData(const void* buffer, std::size_t size) noexcept override;
+
+    void clear() noexcept;
+    std::size_t getResponseCount() const noexcept;
+    bool waitForResponse(std::size_t count, std::chrono::milliseconds timeout);
+    std::size_t copyResponse(std::vector<std::uint8_t>& response) const;
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable condition_;
+    std::vector<std::uint8_t> response_; ///< the last sent message
+    std::size_t responseCount_ = 0; ///< the messages sent since `clear()`
+};
+
+#endif /* LOOPBACK_TRANSPORT_H */
@@ -0,0 +1,100 @@
+/**
+ * @file lua_compat.h
+ *
+ * Includes Selene for the Lua VM of the build. Selene and the simulator use
+ * the Lua 5.2 C API. In a LuaJIT build (`make LUAJIT=1`, which defines
+ * `USE_LUAJIT`) the functions of the 5.2 API that the 5.1 API of LuaJIT lacks
+ * are mapped onto it here, so the same code compiles against both VMs.
+ */
+
+#ifndef LUA_COMPAT_H
+#define LUA_COMPAT_H
+
+#ifdef USE_LUAJIT
+
+extern "C" {
+#include <lua.h>
+#include <lauxlib.h>
+#include <lualib.h>
+#include <luajit.h>
+}
+#include <cstdint>
+
+namespace lua_compat
+{
+
+inline int absindex(lua_State *l, int index)
+{
+    return (index > 0 || index <= LUA_REGISTRYINDEX) ? index : lua_gettop(l) + index + 1;
+}
+
+inline unsigned int tounsignedx(lua_State *l, int index, int *isNum)
+{
+    return static_cast<unsigned int> (static_cast<std::int64_t> (lua_tonumberx(l, index, isNum)));
+}
+
+inline unsigned int checkunsigned(lua_State *l, int index)
+{
+    return static_cast<unsigned int> (static_cast<std::int64_t> (luaL_checknumber(l, index)));
+}
+
+inline void rawgetp(lua_State *l, int index, const void *p)
+{
+    index = absindex(l, index);
+    lua_pushlightuserdata(l, const_cast<void*> (p));
+    lua_rawget(l, index);
+}
+
+inline void rawsetp(lua_State *l, int index, const void *p)
+{
+    index = absindex(l, index);
+    lua_pushlightuserdata(l, const_cast<void*> (p));
+    lua_insert(l, -2);
+    lua_rawset(l, index);
+}
+
+inline void requiref(lua_State *l, const char *modname, lua_CFunction openf, int glb)
+{
+    lua_pushcfunction(l, openf);
+    lua_pushstring(l, modname);
+    lua_call(l, 1, 1);
+    lua_getfield(l, LUA_REGISTRYINDEX, "_LOADED");
+    lua_pushvalue(l, -2);
+    lua_setfield(l, -2, modname);
+    lua_pop(l, 1);
+    if (glb)
+    {
+        lua_pushvalue(l, -1);
+        lua_setglobal(l, modname);
+    }
+}
+
+} // namespace lua_compat
+
+// the API level provided by the mappings, checked by Selene
+#undef LUA_VERSION_NUM
+#define LUA_VERSION_NUM 502
+#ifndef LUA_OK
+#define LUA_OK 0
+#endif
+
+typedef unsigned int lua_Unsigned;
+
+#define lua_absindex(l, index) lua_compat::absindex(l, index)
+#define lua_rawlen(l, index) lua_objlen(l, index)
+#define lua_rawgetp(l, index, p) lua_compat::rawgetp(l, index, p)
+#define lua_rawsetp(l, index, p) lua_compat::rawsetp(l, index, p)
+#define lua_pushglobaltable(l) lua_pushvalue(l, LUA_GLOBALSINDEX)
+#define lua_tounsignedx(l, index, isNum) lua_compat::tounsignedx(l, index, isNum)
+#define lua_tounsigned(l, index) lua_compat::tounsignedx(l, index, nullptr)
+#define lua_pushunsigned(l, value) lua_pushnumber(l, static_cast<lua_Number> (value))
+#define luaL_checkunsigned(l, index) lua_compat::checkunsigned(l, index)
+#define luaL_requiref(l, modname, openf, glb) lua_compat::requiref(l, modname, openf, glb)
+// coroutines are resumed without the `from` thread of Lua 5.2
+#define lua_resume(l, from, argumentCount) lua_resume(l, argumentCount)
+
+#endif /* USE_LUAJIT */
+
+#include "selene.h"
+
+#endif /* LUA_COMPAT_H */
@@ -0,0 +1,214 @@
+/**
+ * @file lua_memory_pool.cpp
+ *
+ */
+
+#include "lua_memory_pool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+/**
+ * Constructor.
+ *
+ * @param pStatistics: the statistics of the ECU, updated with the usage of
+ *                     this pool, or `nullptr`
+ */
+LuaMemoryPool::LuaMemoryPool(shared_ptr<LuaMemoryStatistics> pStatistics)
+: pStatistics_(move(pStatistics))
+{
+}
+
+/**
+ * Destructor. Frees the chunks, the Lua state must be closed before.
+ */
+LuaMemoryPool::~LuaMemoryPool()
+{
+    while (pLastChunk_ != nullptr)
+    {
+        void* pChunk = pLastChunk_;
+        pLastChunk_ = *static_cast<void**> (pChunk);
+        free(pChunk);
+    }
+    addUsedBytes(usedBytes_, 0);
+    subtractReservedBytes(reservedBytes_);
+}
+
+/**
+ * The `lua_Alloc` function, pass the pool as user data to `lua_newstate()`.
+ *
+ * @param ud: the `LuaMemoryPool`
+ * @param ptr: the block to reallocate or free, `nullptr` for a new block
+ * @param osize: the size of `ptr` (for a new block the type of the object)
+ * @param nsize: the new size, 0 to free the block
+ * @return the new block, `nullptr` if it is freed or can not be allocated
+ */
+void* LuaMemoryPool::allocate(void* ud, void* ptr, size_t osize, size_t nsize) noexcept
+{
+    return static_cast<LuaMemoryPool*> (ud)->reallocate(ptr, ptr != nullptr ? osize : 0, nsize);
+}
+
+/**
+ * Sets the max. memory of the Lua state. Allocations beyond it fail, the
+ * memory already in use is kept.
+ *
+ * @param limit: the limit in bytes, 0 = unlimited
+ */
+void LuaMemoryPool::setLimit(size_t limit) noexcept
+{
+    limit_ = limit;
+    if (pStatistics_)
+    {
+        pStatistics_->limitBytes.store(limit, memory_order_relaxed);
+    }
+}
+
+void* LuaMemoryPool::reallocate(void* ptr, size_t oldSize, size_t newSize) noexcept
+{
+    if (newSize == 0)
+    {
+        if (ptr != nullptr)
+        {
+            freeBlock(ptr, oldSize);
+            addUsedBytes(oldSize, 0);
+        }
+        return nullptr;
+    }
+
+    void* pBlock = nullptr;
+    if (newSize > oldSize && limit_ > 0 && usedBytes_ - oldSize + newSize > limit_)
+    {
+        // refused, Lua collects the garbage and tries again
+    }
+    else if (ptr != nullptr && oldSize > MAX_POOLED_SIZE && newSize > MAX_POOLED_SIZE)
+    {
+        pBlock = realloc(ptr, newSize);
+        if (pBlock != nullptr)
+        {
+            addReservedBytes(newSize);
+            subtractReservedBytes(oldSize);
+        }
+    }
+    else if (ptr != nullptr && oldSize <= MAX_POOLED_SIZE && newSize <= MAX_POOLED_SIZE
+             && getSizeClass(oldSize) == getSizeClass(newSize))
+    {
+        pBlock = ptr;
+    }
+    else
+    {
+        pBlock = allocateBlock(newSize);
+        if (pBlock != nullptr && ptr != nullptr)
+        {
+            memcpy(pBlock, ptr, min(oldSize, newSize));
+            freeBlock(ptr, oldSize);
+        }
+    }
+
+    if (pBlock == nullptr)
+    {
+        if (pStatistics_)
+        {
+            pStatistics_->failedAllocations.fetch_add(1, memory_order_relaxed);
+        }
+        return nullptr;
+    }
+    addUsedBytes(oldSize, newSize);
+    return pBlock;
+}
+
+void* LuaMemoryPool::allocateBlock(size_t size) noexcept
+{
+    if (size > MAX_POOLED_SIZE)
+    {
+        void* pBlock = malloc(size);
+        if (pBlock != nullptr)
+        {
+            addReservedBytes(size);
+        }
+        return pBlock;
+    }
+
+    const size_t sizeClass = getSizeClass(size);
+    FreeBlock* pFree = freeLists_[sizeClass];
+    if (pFree != nullptr)
+    {
+        freeLists_[sizeClass] = pFree->pNext;
+        return pFree;
+    }
+
+    const size_t blockSize = (sizeClass + 1) * GRANULARITY;
+    if (size_t(pChunkEnd_ - pChunkPosition_) < blockSize)
+    {
+        void* pChunk = malloc(CHUNK_SIZE);
+        if (pChunk == nullptr)
+        {
+            return nullptr;
+        }
+        addReservedBytes(CHUNK_SIZE);
+        // the rest of the previous chunk is still good for a smaller block
+        if (pChunkEnd_ != pChunkPosition_)
+        {
+            freeBlock(pChunkPosition_, size_t(pChunkEnd_ - pChunkPosition_));
+        }
+        *static_cast<void**> (pChunk) = pLastChunk_;
+        pLastChunk_ = pChunk;
+        pChunkPosition_ = static_cast<char*> (pChunk) + GRANULARITY;
+        pChunkEnd_ = static_cast<char*> (pChunk) + CHUNK_SIZE;
+    }
+    void* pBlock = pChunkPosition_;
+    pChunkPosition_ += blockSize;
+    return pBlock;
+}
+
+void LuaMemoryPool::freeBlock(void* ptr, size_t size) noexcept
+{
+    if (size > MAX_POOLED_SIZE)
+    {
+        free(ptr);
+        subtractReservedBytes(size);
+        return;
+    }
+    const size_t sizeClass = getSizeClass(size);
+    FreeBlock* pFree = static_cast<FreeBlock*> (ptr);
+    pFree->pNext = freeLists_[sizeClass];
+    freeLists_[sizeClass] = pFree;
+}
+
+void LuaMemoryPool::addUsedBytes(size_t oldSize, size_t newSize) noexcept
+{
+    usedBytes_ = usedBytes_ - oldSize + newSize;
+    if (!pStatistics_)
+    {
+        return;
+    }
+    if (newSize < oldSize)
+    {
+        pStatistics_->usedBytes.fetch_sub(oldSize - newSize, memory_order_relaxed);
+        return;
+    }
+    const size_t used = pStatistics_->usedBytes.fetch_add(newSize - oldSize, memory_order_relaxed) + newSize - oldSize;
+    size_t peak = pStatistics_->peakBytes.load(memory_order_relaxed);
+    while (used > peak && !pStatistics_->peakBytes.compare_exchange_weak(peak, used, memory_order_relaxed))
+    {
+    }
+}
+
+void LuaMemoryPool::addReservedBytes(size_t bytes) noexcept
+{
+    reservedBytes_ += bytes;
+    if (pStatistics_)
+    {
+        pStatistics_->reservedBytes.fetch_add(bytes, memory_order_relaxed);
+    }
+}
+
+void LuaMemoryPool::subtractReservedBytes(size_t bytes) noexcept
+{
+    reservedBytes_ -= bytes;
+    if (pStatistics_)
+    {
+        pStatistics_->reservedBytes.fetch_sub(bytes, memory_order_relaxed);
+    }
+}
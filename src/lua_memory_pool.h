@@ -0,0 +1,92 @@
+/**
+ * @file lua_memory_pool.h
+ *
+ */
+
+#ifndef LUA_MEMORY_POOL_H
+#define LUA_MEMORY_POOL_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * The memory statistics of the Lua states of one ECU, updated by their
+ * `LuaMemoryPool`s and read by the metrics. A reloaded script counts
+ * together with the previous version as long as both are alive.
+ */
+struct LuaMemoryStatistics
+{
+    std::atomic<std::size_t> usedBytes{0}; ///< requested by Lua
+    std::atomic<std::size_t> peakBytes{0}; ///< the max. of `usedBytes`
+    std::atomic<std::size_t> reservedBytes{0}; ///< the chunks of the size classes plus the large blocks
+    std::atomic<std::size_t> limitBytes{0}; ///< the limit of the current state, 0 = unlimited
+    std::atomic<std::uint64_t> failedAllocations{0}; ///< refused by the limit or by the system
+};
+
+/**
+ * The allocator (`lua_Alloc`) of one Lua state. Most Lua objects (strings,
+ * tables, closures) are small, so blocks of up to `MAX_POOLED_SIZE` bytes are
+ * taken from free lists per size class (multiples of 16 bytes), which are
+ * carved from chunks of `CHUNK_SIZE` bytes. Freed blocks go back to their
+ * free list, so the many VMs of a simulation don't fragment the heap. Larger
+ * blocks (e.g. the arrays of big tables) are allocated by `malloc()`.
+ *
+ * A limit makes the allocations fail once the state would use more memory,
+ * Lua then collects the garbage and raises "not enough memory" if that does
+ * not help. Shrinking blocks never fails.
+ *
+ * A Lua state is only used by one thread at a time (the `LuaWorker`), so the
+ * pool is not locked. The chunks are released with the pool, which has to
+ * outlive the state.
+ */
+class LuaMemoryPool
+{
+public:
+    static constexpr std::size_t GRANULARITY = 16;
+    static constexpr std::size_t MAX_POOLED_SIZE = 256;
+    static constexpr std::size_t CHUNK_SIZE = 64 * 1024;
+
+    explicit LuaMemoryPool(std::shared_ptr<LuaMemoryStatistics> pStatistics = nullptr);
+    LuaMemoryPool(const LuaMemoryPool& orig) = delete;
+    LuaMemoryPool& operator =(const LuaMemoryPool& orig) = delete;
+    virtual ~LuaMemoryPool();
+
+    static void* allocate(void* ud, void* ptr, std::size_t osize, std::size_t nsize) noexcept;
+
+    void setLimit(std::size_t limit) noexcept;
+    std::size_t getLimit() const noexcept { return limit_; }
+    std::size_t getUsedBytes() const noexcept { return usedBytes_; }
+    std::size_t getReservedBytes() const noexcept { return reservedBytes_; }
+
+private:
+    static constexpr std::size_t SIZE_CLASS_COUNT = MAX_POOLED_SIZE / GRANULARITY;
+
+    struct FreeBlock
+    {
+        FreeBlock* pNext;
+    };
+
+    std::array<FreeBlock*, SIZE_CLASS_COUNT> freeLists_{};
+    void* pLastChunk_ = nullptr; ///< each chunk starts with the pointer to the previous one
+    char* pChunkPosition_ = nullptr; ///< the not yet used rest of the last chunk
+    char* pChunkEnd_ = nullptr;
+    std::size_t limit_ = 0;
+    std::size_t usedBytes_ = 0;
+    std::size_t reservedBytes_ = 0;
+    std::shared_ptr<LuaMemoryStatistics> pStatistics_;
+
+    void* reallocate(void* ptr, std::size_t oldSize, std::size_t newSize) noexcept;
+    void* allocateBlock(std::size_t size) noexcept;
+    void freeBlock(void* ptr, std::size_t size) noexcept;
+    void addUsedBytes(std::size_t oldSize, std::size_t newSize) noexcept;
+    void addReservedBytes(std::size_t bytes) noexcept;
+    void subtractReservedBytes(std::size_t bytes) noexcept;
+
+    /// the index of the size class of a pooled block
+    static std::size_t getSizeClass(std::size_t size) noexcept { return (size - 1) / GRANULARITY; }
+};
+
+#endif /* LUA_MEMORY_POOL_H */
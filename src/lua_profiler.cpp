@@ -0,0 +1,427 @@
+/**
+ * @file lua_profiler.cpp
+ *
+ * This file contains the optional profiler of the Lua handlers, with its
+ * report and the export of the sampled stacks for flame graphs.
+ */
+
+#include "lua_profiler.h"
+#include "logger.h"
+#include "lua_compat.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+
+using namespace std;
+
+atomic<bool> LuaProfiler::isEnabled_(false);
+
+/// the handler running on the calling Lua worker, `nullptr` if none
+static thread_local LuaProfiler::HandlerStatistics* pCurrentHandler = nullptr;
+/// the time the task running on the calling Lua worker waited in its queue
+static thread_local chrono::steady_clock::duration currentQueueTime(0);
+/// the time the stack of the calling Lua worker was sampled last
+static thread_local chrono::steady_clock::time_point lastSampleAt;
+
+static uint64_t toNs(chrono::steady_clock::duration duration) noexcept
+{
+    const auto ns = chrono::duration_cast<chrono::nanoseconds>(duration).count();
+    return ns > 0 ? uint64_t(ns) : 0;
+}
+
+static void updateMax(atomic<uint64_t>& maxValue, uint64_t value) noexcept
+{
+    uint64_t current = maxValue.load(memory_order_relaxed);
+    while (value > current && !maxValue.compare_exchange_weak(current, value, memory_order_relaxed))
+    {
+    }
+}
+
+/**
+ * Starts to measure a call of a handler. Does nothing if the profiler is
+ * disabled.
+ *
+ * @param ecu: the name of the ECU, e.g. its configuration file
+ * @param type: the table of the handler
+ * @param key: the key of the handler in its table, e.g. "22 F1 90"
+ */
+LuaProfiler::Scope::Scope(const string& ecu, LuaHandler type, string_view key) noexcept
+{
+    if (!LuaProfiler::isEnabled())
+    {
+        return;
+    }
+    try
+    {
+        HandlerStatistics* pHandler = LuaProfiler::getInstance().getHandler(ecu, type, key);
+        pHandler->calls.fetch_add(1, memory_order_relaxed);
+        if (pCurrentHandler == nullptr)
+        {
+            // a nested handler did not wait, the outer one did
+            pHandler->waitNs.fetch_add(toNs(currentQueueTime), memory_order_relaxed);
+            currentQueueTime = chrono::steady_clock::duration::zero();
+        }
+        start(pHandler);
+    }
+    catch (exception& e)
+    {
+        LOG_ERROR(__func__ << "() " << e.what());
+    }
+}
+
+/**
+ * Continues to measure a call, e.g. when a sleeping coroutine is resumed.
+ *
+ * @param pResumed: the handler returned by `getCurrentHandler()` when the
+ *                  call was suspended, `nullptr` if it was not measured
+ */
+LuaProfiler::Scope::Scope(HandlerStatistics* pResumed) noexcept
+{
+    if (pResumed != nullptr)
+    {
+        start(pResumed);
+    }
+}
+
+/**
+ * Records the time of the call. The time since the last sample of the stack
+ * is added to the handler itself, so its stacks sum up to its time.
+ */
+LuaProfiler::Scope::~Scope()
+{
+    if (pHandler_ == nullptr)
+    {
+        return;
+    }
+    const auto now = chrono::steady_clock::now();
+    const uint64_t runNs = toNs(now - startedAt_);
+    pHandler_->runNs.fetch_add(runNs, memory_order_relaxed);
+    updateMax(pHandler_->maxRunNs, runNs);
+    try
+    {
+        LuaProfiler::getInstance().addSample(pHandler_->stackRoot, now - lastSampleAt);
+    }
+    catch (exception& e)
+    {
+        LOG_ERROR(__func__ << "() " << e.what());
+    }
+    pCurrentHandler = pOuterHandler_;
+    lastSampleAt = now;
+}
+
+void LuaProfiler::Scope::start(HandlerStatistics* pHandler) noexcept
+{
+    const auto now = chrono::steady_clock::now();
+    if (pCurrentHandler != nullptr)
+    {
+        // the outer handler called C++, which called this one
+        try
+        {
+            LuaProfiler::getInstance().addSample(pCurrentHandler->stackRoot, now - lastSampleAt);
+        }
+        catch (exception& e)
+        {
+            LOG_ERROR(__func__ << "() " << e.what());
+        }
+    }
+    pHandler_ = pHandler;
+    pOuterHandler_ = pCurrentHandler;
+    pCurrentHandler = pHandler;
+    startedAt_ = now;
+    lastSampleAt = now;
+}
+
+/**
+ * @return the profiler of all ECUs
+ */
+LuaProfiler& LuaProfiler::getInstance()
+{
+    static LuaProfiler profiler;
+    return profiler;
+}
+
+/**
+ * Enables or disables the profiler. Only the Lua states created while it is
+ * enabled are sampled, see `attach()`.
+ */
+void LuaProfiler::setEnabled(bool isEnabled) noexcept
+{
+    isEnabled_ = isEnabled;
+}
+
+/**
+ * @return the handler running on the calling Lua worker, `nullptr` if none
+ *         or the profiler is disabled
+ */
+LuaProfiler::HandlerStatistics* LuaProfiler::getCurrentHandler() noexcept
+{
+    return pCurrentHandler;
+}
+
+/**
+ * Sets the time the task which the calling Lua worker starts waited in its
+ * queue. Added to the first handler the task calls.
+ *
+ * @param queueTime: the time from posting to starting the task
+ */
+void LuaProfiler::setQueueTime(chrono::steady_clock::duration queueTime) noexcept
+{
+    currentQueueTime = queueTime;
+}
+
+/**
+ * @return the name of a handler type in the report and the stacks
+ */
+const char* LuaProfiler::getTypeName(LuaHandler type) noexcept
+{
+    switch (type)
+    {
+        case LuaHandler::RAW:
+            return "Raw";
+        case LuaHandler::DATA_IDENTIFIER:
+            return "DID";
+        case LuaHandler::J1939_RESPONSE:
+            return "J1939";
+        case LuaHandler::J1939_PGN:
+            return "PGN";
+    }
+    return "?";
+}
+
+/**
+ * Installs the sampling hook into a new Lua state, if the profiler is
+ * enabled. The coroutines created by the state inherit the hook.
+ *
+ * @param l: the main thread of the state
+ */
+void LuaProfiler::attach(lua_State* l) noexcept
+{
+    if (isEnabled())
+    {
+        lua_sethook(l, &LuaProfiler::onHook, LUA_MASKCOUNT, SAMPLE_INSTRUCTIONS);
+    }
+}
+
+/**
+ * Returns the statistics of a handler, created on its first call.
+ *
+ * @param ecu: the name of the ECU
+ * @param type: the table of the handler
+ * @param key: the key of the handler in its table
+ * @return the statistics, valid as long as the profiler
+ */
+LuaProfiler::HandlerStatistics* LuaProfiler::getHandler(const string& ecu, LuaHandler type, string_view key)
+{
+    auto indexKey = make_tuple(ecu, type, string(key));
+    lock_guard<mutex> lock(handlersMutex_);
+    auto iter = handlerIndex_.find(indexKey);
+    if (iter != handlerIndex_.end())
+    {
+        return iter->second;
+    }
+    HandlerStatistics& handler = handlers_.emplace_back();
+    handler.ecu = ecu;
+    handler.type = type;
+    handler.key = string(key);
+    handler.stackRoot = ecu + ";" + getTypeName(type) + " " + handler.key;
+    // the collapsed format separates the frames by ';'
+    replace(handler.stackRoot.begin() + ecu.size() + 1, handler.stackRoot.end(), ';', ',');
+    handlerIndex_.emplace(move(indexKey), &handler);
+    return &handler;
+}
+
+/**
+ * Writes the ECUs and the handlers with the most time spent in Lua. The wait
+ * time shows how long the calls were delayed by the other calls of the ECU.
+ *
+ * @param out: the stream to write to
+ * @param count: the max. number of listed handlers
+ */
+void LuaProfiler::writeReport(ostream& out, size_t count) const
+{
+    struct Row
+    {
+        string name;
+        uint64_t calls;
+        uint64_t runNs;
+        uint64_t maxRunNs;
+        uint64_t waitNs;
+    };
+    vector<Row> ecus;
+    vector<Row> handlers;
+    {
+        lock_guard<mutex> lock(handlersMutex_);
+        for (const HandlerStatistics& handler : handlers_)
+        {
+            const Row row = {
+                handler.ecu + " " + getTypeName(handler.type) + " " + handler.key,
+                handler.calls.load(memory_order_relaxed),
+                handler.runNs.load(memory_order_relaxed),
+                handler.maxRunNs.load(memory_order_relaxed),
+                handler.waitNs.load(memory_order_relaxed)
+            };
+            if (row.calls == 0)
+            {
+                continue;
+            }
+            handlers.push_back(row);
+            auto ecu = find_if(ecus.begin(), ecus.end(), [&handler](const Row& r) { return r.name == handler.ecu; });
+            if (ecu == ecus.end())
+            {
+                ecus.push_back({handler.ecu, 0, 0, 0, 0});
+                ecu = ecus.end() - 1;
+            }
+            ecu->calls += row.calls;
+            ecu->runNs += row.runNs;
+            ecu->maxRunNs = max(ecu->maxRunNs, row.maxRunNs);
+            ecu->waitNs += row.waitNs;
+        }
+    }
+    auto byRunTime = [](const Row& a, const Row& b) { return a.runNs > b.runNs; };
+    sort(ecus.begin(), ecus.end(), byRunTime);
+    sort(handlers.begin(), handlers.end(), byRunTime);
+    handlers.resize(min(handlers.size(), count));
+
+    auto writeRows = [&out](const char* title, const vector<Row>& rows) {
+        out << left << setw(40) << title << right
+            << setw(10) << "calls" << setw(12) << "run ms" << setw(10) << "avg us"
+            << setw(10) << "max us" << setw(12) << "wait ms" << '\n';
+        for (const Row& row : rows)
+        {
+            out << left << setw(40) << row.name << right
+                << setw(10) << row.calls
+                << setw(12) << fixed << setprecision(1) << double(row.runNs) / 1e6
+                << setw(10) << row.runNs / row.calls / 1000
+                << setw(10) << row.maxRunNs / 1000
+                << setw(12) << double(row.waitNs) / 1e6 << '\n';
+        }
+    };
+    out << "Lua profile\n";
+    writeRows("ECU", ecus);
+    out << '\n';
+    writeRows("handler", handlers);
+    out << flush;
+}
+
+/**
+ * Writes the sampled stacks in the collapsed format, one stack and its
+ * microseconds per line, e.g. for `flamegraph.pl`.
+ *
+ * @param out: the stream to write to
+ */
+void LuaProfiler::writeCollapsedStacks(ostream& out) const
+{
+    lock_guard<mutex> lock(stacksMutex_);
+    for (const auto& stack : stacks_)
+    {
+        const uint64_t us = stack.second / 1000;
+        if (us > 0)
+        {
+            out << stack.first << ' ' << us << '\n';
+        }
+    }
+    out << flush;
+}
+
+/**
+ * Writes the sampled stacks into a file, replacing it.
+ *
+ * @param file: the path of the file
+ * @return false if the file can not be written
+ */
+bool LuaProfiler::writeCollapsedStacks(const string& file) const
+{
+    ofstream out(file, ios::trunc);
+    if (!out)
+    {
+        LOG_ERROR(__func__ << "() open " << file << ": " << strerror(errno));
+        return false;
+    }
+    writeCollapsedStacks(out);
+    return bool(out);
+}
+
+/**
+ * Resets all statistics and stacks, e.g. to profile a single test case.
+ */
+void LuaProfiler::clear()
+{
+    {
+        lock_guard<mutex> lock(handlersMutex_);
+        for (HandlerStatistics& handler : handlers_)
+        {
+            handler.calls = 0;
+            handler.runNs = 0;
+            handler.maxRunNs = 0;
+            handler.waitNs = 0;
+        }
+    }
+    lock_guard<mutex> lock(stacksMutex_);
+    stacks_.clear();
+}
+
+/**
+ * Samples the Lua stack of the running handler, called by Lua every
+ * `SAMPLE_INSTRUCTIONS` instructions. Code outside of a handler (e.g. the
+ * loading of a script) is not sampled.
+ */
+void LuaProfiler::onHook(lua_State* l, lua_Debug*)
+{
+    if (pCurrentHandler == nullptr)
+    {
+        return;
+    }
+    const auto now = chrono::steady_clock::now();
+    // reused by the samples of a worker
+    static thread_local string stack;
+    static thread_local vector<string> frames;
+    // Lua must not be left by an exception
+    try
+    {
+        frames.clear();
+        lua_Debug info;
+        for (int level = 0; level < MAX_STACK_DEPTH && lua_getstack(l, level, &info) != 0; level++)
+        {
+            if (lua_getinfo(l, "Sn", &info) == 0)
+            {
+                break;
+            }
+            string frame = info.name != nullptr ? info.name : "?";
+            if (strcmp(info.what, "C") != 0)
+            {
+                frame += "@";
+                frame += info.short_src;
+                frame += ":";
+                frame += to_string(info.linedefined);
+            }
+            replace(frame.begin(), frame.end(), ';', ',');
+            frames.push_back(move(frame));
+        }
+        stack = pCurrentHandler->stackRoot;
+        for (auto frame = frames.rbegin(); frame != frames.rend(); ++frame)
+        {
+            stack += ';';
+            stack += *frame;
+        }
+        getInstance().addSample(stack, now - lastSampleAt);
+    }
+    catch (exception& e)
+    {
+        LOG_ERROR(__func__ << "() " << e.what());
+    }
+    lastSampleAt = now;
+}
+
+void LuaProfiler::addSample(const string& stack, chrono::steady_clock::duration duration)
+{
+    const uint64_t ns = toNs(duration);
+    if (ns == 0)
+    {
+        return;
+    }
+    lock_guard<mutex> lock(stacksMutex_);
+    stacks_[stack] += ns;
+}
@@ -0,0 +1,139 @@
+/**
+ * @file lua_profiler.h
+ *
+ */
+
+#ifndef LUA_PROFILER_H
+#define LUA_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+
+struct lua_State;
+struct lua_Debug;
+
+/**
+ * The kinds of Lua handlers which are profiled.
+ */
+enum class LuaHandler
+{
+    RAW, ///< a function of a `Raw` table
+    DATA_IDENTIFIER, ///< a function of a `ReadDataByIdentifier` table
+    J1939_RESPONSE, ///< a function of the `Raw` table of a J1939 ECU
+    J1939_PGN, ///< a function of a `RequestPGN` entry
+};
+
+/**
+ * Optional profiler of the Lua handlers, to find the `Raw` entry or PGN
+ * function which keeps a Lua worker busy.
+ *
+ * Every handler call is measured by a `Scope` on the Lua worker and
+ * aggregated per ECU and table key: the number of calls, the time spent in
+ * Lua and the time the call waited in the queue of the worker before, i.e.
+ * while the worker was busy with other calls of the same ECU. The time a
+ * coroutine sleeps is not counted, it does not block the worker.
+ *
+ * In addition, a count hook (`lua_sethook()`) samples the Lua stack every
+ * `SAMPLE_INSTRUCTIONS` instructions and adds the time since the previous
+ * sample to it. `writeCollapsedStacks()` writes the stacks in the collapsed
+ * format of `flamegraph.pl`, rooted at the ECU and the handler:
+ *
+ *     ecu1.lua;Raw 22 F1 90;readVin@ecu1.lua:12;string.format 130
+ *
+ * The weights are microseconds. LuaJIT does not call the hook in compiled
+ * code, so only the handler frames are precise there.
+ *
+ * The profiler has to be enabled before the Lua states are created. When
+ * disabled, a `Scope` only checks the flag.
+ */
+class LuaProfiler
+{
+public:
+    /// the instructions between two samples of the Lua stack
+    static constexpr int SAMPLE_INSTRUCTIONS = 1000;
+    /// the max. number of stack frames of a sample
+    static constexpr int MAX_STACK_DEPTH = 32;
+
+    /**
+     * The statistics of one handler. Never removed, so its address stays
+     * valid for a coroutine resumed later.
+     */
+    struct HandlerStatistics
+    {
+        std::string ecu;
+        LuaHandler type;
+        std::string key;
+        std::string stackRoot; ///< "<ecu>;<type> <key>", the root of its collapsed stacks
+        std::atomic<std::uint64_t> calls{0};
+        std::atomic<std::uint64_t> runNs{0}; ///< time spent in Lua
+        std::atomic<std::uint64_t> maxRunNs{0}; ///< the longest run of a call until it returned or slept
+        std::atomic<std::uint64_t> waitNs{0}; ///< time waited for the Lua worker
+    };
+
+    /**
+     * Measures a handler call on the Lua worker, from its construction to
+     * its destruction. The call waited for the worker as long as the task
+     * running it, see `setQueueTime()`. A nested handler (e.g. a DID read by
+     * a `Raw` function) is measured on its own, its time is also part of the
+     * outer handler.
+     */
+    class Scope
+    {
+    public:
+        Scope(const std::string& ecu, LuaHandler type, std::string_view key) noexcept;
+        explicit Scope(HandlerStatistics* pResumed) noexcept;
+        Scope(const Scope& orig) = delete;
+        Scope& operator =(const Scope& orig) = delete;
+        ~Scope();
+
+    private:
+        HandlerStatistics* pHandler_ = nullptr; ///< `nullptr` if disabled
+        HandlerStatistics* pOuterHandler_ = nullptr;
+        std::chrono::steady_clock::time_point startedAt_;
+
+        void start(HandlerStatistics* pHandler) noexcept;
+    };
+
+    static LuaProfiler& getInstance();
+    static void setEnabled(bool isEnabled) noexcept;
+    static bool isEnabled() noexcept { return isEnabled_.load(std::memory_order_relaxed); }
+    static HandlerStatistics* getCurrentHandler() noexcept;
+    static void setQueueTime(std::chrono::steady_clock::duration queueTime) noexcept;
+    static const char* getTypeName(LuaHandler type) noexcept;
+
+    LuaProfiler() = default;
+    LuaProfiler(const LuaProfiler& orig) = delete;
+    LuaProfiler& operator =(const LuaProfiler& orig) = delete;
+    virtual ~LuaProfiler() = default;
+
+    void attach(lua_State* l) noexcept;
+    HandlerStatistics* getHandler(const std::string& ecu, LuaHandler type, std::string_view key);
+    void writeReport(std::ostream& out, std::size_t count) const;
+    void writeCollapsedStacks(std::ostream& out) const;
+    bool writeCollapsedStacks(const std::string& file) const;
+    void clear();
+
+private:
+    static std::atomic<bool> isEnabled_;
+
+    mutable std::mutex handlersMutex_;
+    std::map<std::tuple<std::string, LuaHandler, std::string>, HandlerStatistics*> handlerIndex_;
+    std::list<HandlerStatistics> handlers_; ///< never removed, see `HandlerStatistics`
+    mutable std::mutex stacksMutex_;
+    std::unordered_map<std::string, std::uint64_t> stacks_; ///< the collapsed stacks and their ns
+
+    static void onHook(lua_State* l, lua_Debug* ar);
+    void addSample(const std::string& stack, std::chrono::steady_clock::duration duration);
+};
+
+#endif /* LUA_PROFILER_H */
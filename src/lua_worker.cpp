@@ -0,0 +1,188 @@
+/**
+ * @file lua_worker.cpp
+ *
+ */
+
+#include "lua_worker.h"
+#include "logger.h"
+#include "lua_profiler.h"
+#include "thread_placement.h"
+#include <iostream>
+
+using namespace std;
+
+/**
+ * Constructor. Starts the worker thread.
+ */
+LuaWorker::LuaWorker()
+: waiter_([this]()
+    {
+        lock_guard<mutex> lock(mutex_);
+        condition_.notify_one();
+    })
+, thread_(&LuaWorker::run, this)
+{
+}
+
+/**
+ * Destructor. Processes the already queued tasks and stops the worker thread.
+ * The delayed tasks which are not due yet are executed right away, so the
+ * callers waiting for a sleeping Lua function get its result.
+ */
+LuaWorker::~LuaWorker()
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        isOnExit_ = true;
+    }
+    condition_.notify_one();
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+/**
+ * Queues the given task without waiting for it.
+ *
+ * @param task: the function to execute on the worker thread
+ * @param priority: `Priority::LOW` for long running tasks, see `LuaWorker`
+ */
+void LuaWorker::post(function<void()> task, Priority priority)
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        Task queuedTask{move(task), LuaProfiler::isEnabled() ? chrono::steady_clock::now()
+                                                             : chrono::steady_clock::time_point()};
+        if (priority == Priority::LOW)
+        {
+            lowPriorityTasks_.push_back(move(queuedTask));
+        }
+        else
+        {
+            tasks_.push_back(move(queuedTask));
+        }
+    }
+    condition_.notify_one();
+}
+
+/**
+ * Queues the given task to be executed after a delay, without waiting for it.
+ * The delayed task is executed between the other tasks once it is due.
+ *
+ * @param delay: the min. time until the task is executed
+ * @param task: the function to execute on the worker thread
+ */
+void LuaWorker::postDelayed(chrono::milliseconds delay, function<void()> task)
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        delayedTasks_.emplace(SimulationClock::getInstance().now() + delay, move(task));
+    }
+    condition_.notify_one();
+}
+
+/**
+ * @return true if the calling thread is the worker thread
+ */
+bool LuaWorker::isWorkerThread() const noexcept
+{
+    return this_thread::get_id() == thread_.get_id();
+}
+
+void LuaWorker::run()
+{
+    ThreadPlacement::getInstance().apply(ThreadRole::LUA);
+    SimulationClock& clock = SimulationClock::getInstance();
+    vector<Task> batch;
+    while (true)
+    {
+        {
+            unique_lock<mutex> lock(mutex_);
+            while (true)
+            {
+                batch.swap(tasks_);
+                const auto now = clock.now();
+                while (!delayedTasks_.empty() && (isOnExit_ || delayedTasks_.begin()->first <= now))
+                {
+                    batch.push_back({move(delayedTasks_.begin()->second), {}});
+                    delayedTasks_.erase(delayedTasks_.begin());
+                }
+                if (batch.empty() && !lowPriorityTasks_.empty())
+                {
+                    // one at a time, the tasks posted meanwhile go first
+                    batch.push_back(move(lowPriorityTasks_.front()));
+                    lowPriorityTasks_.pop_front();
+                }
+                if (!batch.empty())
+                {
+                    break;
+                }
+                if (isOnExit_)
+                {
+                    return; // nothing left to do
+                }
+                if (delayedTasks_.empty())
+                {
+                    waiter_.clearDeadline();
+                    condition_.wait(lock);
+                }
+                else
+                {
+                    waiter_.setDeadline(delayedTasks_.begin()->first);
+                    condition_.wait_until(lock, clock.toRealTime(delayedTasks_.begin()->first));
+                }
+            }
+        }
+
+        // the virtual time does not jump while Lua runs
+        SimulationClock::Activity activity;
+        for (Task& task : batch)
+        {
+            if (task.postedAt != chrono::steady_clock::time_point())
+            {
+                LuaProfiler::setQueueTime(chrono::steady_clock::now() - task.postedAt);
+            }
+            try
+            {
+                task.func();
+            }
+            catch (exception &e)
+            {
+                LOG_ERROR("Lua worker: " << e.what());
+            }
+        }
+        batch.clear();
+    }
+}
+
+/**
+ * Marks the task as done and wakes up the waiting caller.
+ *
+ * The completion usually lives on the stack of the caller, which returns as
+ * soon as it sees `isDone_`. So the condition is notified while the mutex is
+ * held, and neither the completion nor anything else of the caller may be
+ * touched after this returned.
+ *
+ * @param error: the exception thrown by the task, rethrown by `wait()`
+ */
+void LuaWorker::Completion::finish(exception_ptr error) noexcept
+{
+    lock_guard<mutex> lock(mutex_);
+    isDone_ = true;
+    error_ = move(error);
+    condition_.notify_one();
+}
+
+/**
+ * Waits until the task is done and rethrows its exception, if any.
+ */
+void LuaWorker::Completion::wait()
+{
+    unique_lock<mutex> lock(mutex_);
+    condition_.wait(lock, [this]() { return isDone_; });
+    if (error_)
+    {
+        rethrow_exception(error_);
+    }
+}
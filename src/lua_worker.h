@@ -0,0 +1,149 @@
+/**
+ * @file lua_worker.h
+ *
+ */
+
+#ifndef LUA_WORKER_H
+#define LUA_WORKER_H
+
+#include "simulation_clock.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Executes all accesses to the Lua state of one ECU on a dedicated thread.
+ *
+ * A Lua state must not be used by several threads at the same time. Instead of
+ * a global lock, which is held by every caller (UDS, broadcast, J1939, DoIP)
+ * until its Lua function returns, the calls are queued and processed in FIFO
+ * order by the worker. Since static responses are compiled at load time, only
+ * requests that really need to run Lua code are queued.
+ *
+ * Delayed tasks (`postDelayed()`) resume the Lua response functions suspended
+ * by `sleep()`, so a sleeping function does not block the other tasks. Their
+ * delay is measured by the `SimulationClock`.
+ *
+ * Tasks of `Priority::LOW` (the Lua functions of the `Raw` tables, which may
+ * run for a long time) are taken one at a time and only if no other task is
+ * queued. So a short call, e.g. of another thread in `call()`, waits for at
+ * most one running handler instead of all queued ones.
+ */
+class LuaWorker
+{
+public:
+    /**
+     * The completion of a task which a caller waits for, e.g. in `call()`.
+     * The waiting caller owns it, so it may live on the stack of the caller.
+     * The task must not touch the completion or the other data of the caller
+     * after `finish()`, the caller may have returned already.
+     */
+    class Completion
+    {
+    public:
+        void finish(std::exception_ptr error = nullptr) noexcept;
+        void wait();
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        bool isDone_ = false;
+        std::exception_ptr error_;
+    };
+
+    enum class Priority
+    {
+        HIGH,
+        LOW
+    };
+
+    LuaWorker();
+    LuaWorker(const LuaWorker& orig) = delete;
+    LuaWorker& operator =(const LuaWorker& orig) = delete;
+    virtual ~LuaWorker();
+
+    void post(std::function<void()> task, Priority priority = Priority::HIGH);
+    void postDelayed(std::chrono::milliseconds delay, std::function<void()> task);
+    bool isWorkerThread() const noexcept;
+
+    /**
+     * Runs the given function on the worker thread and waits for its result.
+     * Exceptions thrown by the function are rethrown to the caller. If called
+     * from the worker thread itself (e.g. a C++ function called by Lua), the
+     * function is executed immediately to avoid a deadlock.
+     *
+     * @param func: the function accessing the Lua state
+     * @return the return value of `func`
+     */
+    template<class F>
+    auto call(F&& func) -> decltype(func())
+    {
+        if (isWorkerThread())
+        {
+            return func();
+        }
+        using Result = decltype(func());
+        // the caller waits, so the state stays on its stack and the posted
+        // task captures only its address, which `std::function` stores inline
+        struct State
+        {
+            F& func;
+            std::conditional_t<std::is_void_v<Result>, bool, std::optional<Result>> result;
+            Completion completion;
+        } state{func, {}, {}};
+        post([pState = &state]()
+        {
+            try
+            {
+                if constexpr (std::is_void_v<Result>)
+                {
+                    pState->func();
+                }
+                else
+                {
+                    pState->result.emplace(pState->func());
+                }
+                pState->completion.finish();
+            }
+            catch (...)
+            {
+                pState->completion.finish(std::current_exception());
+            }
+        });
+        state.completion.wait();
+        if constexpr (!std::is_void_v<Result>)
+        {
+            return std::move(*state.result);
+        }
+    }
+
+private:
+    struct Task
+    {
+        std::function<void()> func;
+        /// the time it was posted, only set while the `LuaProfiler` is enabled
+        std::chrono::steady_clock::time_point postedAt;
+    };
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::vector<Task> tasks_; ///< swapped with the batch of the worker, so it keeps its capacity
+    std::deque<Task> lowPriorityTasks_; ///< in the order they were posted
+    /// by due time, tasks with the same due time in the order they were posted
+    std::multimap<std::chrono::steady_clock::time_point, std::function<void()>> delayedTasks_;
+    bool isOnExit_ = false;
+    SimulationClock::Waiter waiter_; ///< reports the earliest delayed task in virtual time
+    std::thread thread_;
+
+    void run();
+};
+
+#endif /* LUA_WORKER_H */
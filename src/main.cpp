@@ -8,88 +8,410 @@
 #include "ecu_lua_script.h"
 #include "electronic_control_unit.h"
 #include "j1939_simulator.h"
+#include "can_frame_simulator.h"
 #include "doip_simulator.h"
 #include "doip_sim_server.h"
 #include "ecu_timer.h"
+#include "receiver_reactor.h"
+#include "bus_state_monitor.h"
+#include "simulator_configuration.h"
+#include "traffic_capture.h"
+#include "metrics.h"
+#include "lua_profiler.h"
+#include "thread_pool.h"
+#include "config_watcher.h"
+#include "thread_placement.h"
+#include "simulation_clock.h"
+#include "signal_feed.h"
+#include "realtime_profile.h"
+#include "checkpoint.h"
+#include "bus_load_budget.h"
+#include "idle_monitor.h"
+#include "worker_supervisor.h"
 #include "utilities.h"
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <csignal>
-#include <cstdio>
 #include <filesystem>
+#include <pthread.h>
 
 using namespace std;
 
 vector<ElectronicControlUnit *> udsSimulators;
 vector<J1939Simulator *> j1939Simulators;
+vector<CanFrameSimulator *> canFrameSimulators;
 vector<DoIPSimulator *> doipSimulators;
+map<string, EcuLuaScript *> ecuScripts; ///< the scripts by their config file
+mutex simulatorsMutex; ///< guards the simulator lists, which are filled by several threads
 
-DoIPSimServer doipSimServer;
+/// the reactors by their interface, empty if each receiver has its own thread
+map<string, unique_ptr<ReceiverReactor>> receiverReactors;
+mutex reactorsMutex; ///< guards `receiverReactors`
+unsigned int reactorThreads = 0; ///< the threads of each reactor, 0 = no reactors
 
+int workerIndex = -1; ///< the index of this worker process, -1 without workers
+unsigned int workerCount = 0; ///< the number of worker processes, see `WorkerSupervisor`
+
+/// the DoIP entities, one per `doipserver*.lua`, see `isDoipServerConfig()`
+vector<unique_ptr<DoIPSimServer>> doipSimServers;
+
+/// the number of handlers in the report of the Lua profiler
+constexpr size_t LUA_PROFILE_REPORT_SIZE = 20;
+
+/**
+ * @param config_file: a Lua configuration
+ * @return true if the configuration describes a DoIP entity (e.g.
+ *         "doipserver.lua" or "doipserver_rack2.lua") instead of an ECU
+ */
+bool isDoipServerConfig(const string &config_file)
+{
+    return config_file.rfind(DOIP_SERVER_CONFIG_PREFIX, 0) == 0;
+}
+
+/**
+ * Returns the reactor of an interface, which is started on first use. Each
+ * interface has its own reactor, so a busy bus does not delay the others.
+ *
+ * @param interface: the CAN interface or `DOIP_CAPTURE_INTERFACE`
+ * @return the reactor or `nullptr` if each receiver has its own thread
+ */
+ReceiverReactor *getReceiverReactor(const string &interface)
+{
+    if(reactorThreads == 0) {
+        return nullptr;
+    }
+    lock_guard<mutex> lock(reactorsMutex);
+    unique_ptr<ReceiverReactor> &reactor = receiverReactors[interface];
+    if(!reactor) {
+        reactor = std::make_unique<ReceiverReactor>();
+        reactor->start(reactorThreads);
+    }
+    return reactor.get();
+}
+
+/**
+ * Loads the given configuration and starts its simulations. This is called by
+ * the threads of the startup pool, so the configurations are loaded in
+ * parallel and each ECU handles requests as soon as it is started.
+ *
+ * The CAN simulations are started on the interfaces of the ECU table
+ * (`Interface`), all of them share the script and its compiled tables. In a
+ * worker process only on the interfaces of the worker, a script without any
+ * simulation in the worker is deleted again.
+ *
+ * @param config_file: the Lua configuration
+ * @param device: the CAN device of the ECUs without `Interface`, no CAN
+ *                simulation if empty
+ */
 void start_server(const string &config_file, const string &device)
 {
     cout << "start_server for config file: " << config_file << endl;
 
     EcuLuaScript *script = new EcuLuaScript("Main", config_file);
+    {
+        lock_guard<mutex> lock(simulatorsMutex);
+        ecuScripts[config_file] = script;
+    }
 
-    ElectronicControlUnit *udsSimulator = NULL;
-    J1939Simulator *j1939Simulator = NULL;
+    vector<string> devices = script->getInterfaces();
+    if(devices.empty() && device != "") {
+        devices.push_back(device);
+    }
+    const bool hasDevices = !devices.empty();
+    if(workerIndex >= 0) {
+        devices.erase(remove_if(devices.begin(), devices.end(), [](const string &interface) {
+            return WorkerSupervisor::getInterfaceOwner(interface, workerCount) != static_cast<unsigned int>(workerIndex);
+        }), devices.end());
+    }
+    if(hasDevices && devices.empty() && !DoIPSimulator::hasSimulation(script)) {
+        cout << "Simulation of " << config_file << " is run by another worker" << endl;
+        lock_guard<mutex> lock(simulatorsMutex);
+        ecuScripts.erase(config_file);
+        delete script;
+        return;
+    }
     DoIPSimulator *doipSimulator = NULL;
 
-    if(device != "") {
-        cout << " on CAN device: " << device << endl;
+    if(!devices.empty()) {
+        // the Lua functions (e.g. `sendRaw()`) use the simulation started
+        // last, which is the one on the first interface
+        for (auto interface = devices.rbegin(); interface != devices.rend(); ++interface) {
+            cout << " on CAN device: " << *interface << endl;
 
-        if(ElectronicControlUnit::hasSimulation(script)) {
-            udsSimulator = new ElectronicControlUnit(device, script);
-            udsSimulators.push_back(udsSimulator);
-        }
-        if(J1939Simulator::hasSimulation(script)) {
-            j1939Simulator = new J1939Simulator(device, script);
-            j1939Simulators.push_back(j1939Simulator);
+            if(ElectronicControlUnit::hasSimulation(script)) {
+                ElectronicControlUnit *udsSimulator = new ElectronicControlUnit(*interface, script,
+                                                                                getReceiverReactor(*interface));
+                lock_guard<mutex> lock(simulatorsMutex);
+                udsSimulators.push_back(udsSimulator);
+            }
+            if(J1939Simulator::hasSimulation(script)) {
+                J1939Simulator *j1939Simulator = new J1939Simulator(*interface, script);
+                lock_guard<mutex> lock(simulatorsMutex);
+                j1939Simulators.push_back(j1939Simulator);
+            }
+            if(CanFrameSimulator::hasSimulation(script)) {
+                CanFrameSimulator *canFrameSimulator = new CanFrameSimulator(*interface, script);
+                lock_guard<mutex> lock(simulatorsMutex);
+                canFrameSimulators.push_back(canFrameSimulator);
+            }
         }
-
-
-    } else if(ElectronicControlUnit::hasSimulation(script) || J1939Simulator::hasSimulation(script)) {
+    } else if(!hasDevices && (ElectronicControlUnit::hasSimulation(script) || J1939Simulator::hasSimulation(script)
+                              || CanFrameSimulator::hasSimulation(script))) {
         cout << "Ignoring CAN simulation because no CAN device was given." << endl;
     }
 
     if(DoIPSimulator::hasSimulation(script)) {
+        // one simulation (and compiled 'Raw' table) shared by all its entities
         doipSimulator = new DoIPSimulator(script);
-        doipSimServer.addECU(doipSimulator);
-        doipSimulators.push_back(doipSimulator);
-        script->registerDoipSimServer(&doipSimServer);
+        vector<DoIPSimServer *> entities;
+        for (const unique_ptr<DoIPSimServer> &doipSimServer : doipSimServers) {
+            if(script->isInDoIPEntity(doipSimServer->getName())) {
+                script->registerDoipSimServer(doipSimServer.get());
+                entities.push_back(doipSimServer.get());
+            }
+        }
+        if(entities.empty()) {
+            cout << "No DoIP entity for " << config_file << endl;
+        }
+        for (DoIPSimServer *doipSimServer : entities) {
+            doipSimServer->addECU(doipSimulator);
+        }
+        doipSimulator->getMetrics()->isReady = true;
+        {
+            lock_guard<mutex> lock(simulatorsMutex);
+            doipSimulators.push_back(doipSimulator);
+        }
     }
 
-    if(udsSimulator) {
-        udsSimulator->waitForSimulationEnd();
-        cout << "UDS/CAN terminated" << endl;
-        delete udsSimulator;
+    cout << "Simulation of " << config_file << " is ready" << endl;
+}
+
+/**
+ * Reloads the script of the given configuration, called by the `ConfigWatcher`
+ * thread. The simulations of the configuration keep running with the old
+ * version until the new one is compiled.
+ *
+ * @param config_file: the changed Lua configuration
+ */
+void reload_server(const string &config_file)
+{
+    EcuLuaScript *script = nullptr;
+    {
+        lock_guard<mutex> lock(simulatorsMutex);
+        auto ecuScript = ecuScripts.find(config_file);
+        if (ecuScript != ecuScripts.end()) {
+            script = ecuScript->second;
+        }
+    }
+    if (script == nullptr) {
+        cout << "Ignoring " << config_file << ", new configurations need a restart" << endl;
+        return;
+    }
+
+    const auto reloadBegin = chrono::steady_clock::now();
+    if (script->reload()) {
+        cout << "Reloaded " << config_file << " in "
+             << chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - reloadBegin).count()
+             << " ms" << endl;
+    }
+}
+
+/**
+ * Writes the runtime state of all configurations into a checkpoint file.
+ *
+ * @param checkpointFile: the file to write
+ */
+void writeCheckpoint(const string &checkpointFile)
+{
+    const auto begin = chrono::steady_clock::now();
+    Checkpoint checkpoint;
+    {
+        lock_guard<mutex> lock(simulatorsMutex);
+        for (auto &ecuScript : ecuScripts) {
+            ecuScript.second->saveCheckpoint(checkpoint);
+        }
+    }
+    if (checkpoint.write(checkpointFile) == 0) {
+        cout << "Checkpoint written to " << checkpointFile << " in "
+             << chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - begin).count()
+             << " ms" << endl;
+    }
+}
+
+/**
+ * Restores the runtime state of all configurations from a checkpoint file.
+ *
+ * @param checkpointFile: the file written by `writeCheckpoint()`
+ */
+void restoreCheckpoint(const string &checkpointFile)
+{
+    const auto begin = chrono::steady_clock::now();
+    Checkpoint checkpoint;
+    if (checkpoint.load(checkpointFile) != 0) {
+        return;
+    }
+    {
+        lock_guard<mutex> lock(simulatorsMutex);
+        for (auto &ecuScript : ecuScripts) {
+            ecuScript.second->restoreCheckpoint(checkpoint);
+        }
     }
-    if(j1939Simulator) {
-        j1939Simulator->waitForSimulationEnd();
-        cout << "J1939 terminated" << endl;
-        delete j1939Simulator;
+    cout << "Checkpoint " << checkpointFile << " restored in "
+         << chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - begin).count()
+         << " ms" << endl;
+}
+
+/**
+ * Blocks the termination signals (and `SIGUSR1`, `SIGUSR2` and `SIGHUP`) in
+ * the calling thread and in all threads it starts afterwards, so they are
+ * only received by `waitForTerminationSignal()` and no thread is interrupted
+ * in the middle of a request.
+ *
+ * @return the blocked signals
+ */
+sigset_t blockTerminationSignals()
+{
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGUSR1);
+    sigaddset(&signals, SIGUSR2);
+    sigaddset(&signals, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    return signals;
+}
+
+/**
+ * Writes the report of the `LuaProfiler` to stdout and its stacks into the
+ * given file.
+ *
+ * @param profileFile: the file of the collapsed stacks
+ */
+void writeLuaProfile(const string &profileFile)
+{
+    LuaProfiler::getInstance().writeReport(cout, LUA_PROFILE_REPORT_SIZE);
+    if (LuaProfiler::getInstance().writeCollapsedStacks(profileFile)) {
+        cout << "Lua stacks written to " << profileFile << endl;
     }
 }
 
-void signalHandler(int signum) {
-    printf("Received signal %d\n",signum);
-    if(signum == SIGINT) {
-        for (ElectronicControlUnit *simulator : udsSimulators) {
-            simulator->stopSimulation();
-            delete simulator;
+/**
+ * Waits until the process is asked to terminate (e.g. Ctrl+C or the stop of
+ * a container). `SIGUSR1` writes the Lua profile meanwhile, `SIGUSR2` writes
+ * the checkpoint and `SIGHUP` restores it.
+ *
+ * @param signals: the signals returned by `blockTerminationSignals()`
+ * @param profileFile: the file of the Lua stacks, empty if not profiled
+ * @param checkpointFile: the file of the runtime state, empty if disabled
+ */
+void waitForTerminationSignal(const sigset_t &signals, const string &profileFile, const string &checkpointFile)
+{
+    int signum = 0;
+    while (true) {
+        if (sigwait(&signals, &signum) != 0) {
+            continue;
         }
-        for (J1939Simulator *simulator : j1939Simulators) {
-            simulator->stopSimulation();
-            delete simulator;
+        if (signum == SIGUSR2 || signum == SIGHUP) {
+            if (checkpointFile.empty()) {
+                cout << "Received signal " << signum << ", but no " << CHECKPOINT_FILE << " is configured" << endl;
+            } else if (signum == SIGUSR2) {
+                writeCheckpoint(checkpointFile);
+            } else {
+                restoreCheckpoint(checkpointFile);
+            }
+            continue;
         }
-        doipSimServer.shutdown();
-        for (DoIPSimulator *simulator : doipSimulators) {
-            delete simulator;
+        if (signum != SIGUSR1) {
+            break;
+        }
+        if (profileFile.empty()) {
+            cout << "Received SIGUSR1, but the Lua profiler is disabled (see " << LUA_PROFILE << ")" << endl;
+        } else {
+            writeLuaProfile(profileFile);
         }
-        exit(1);
     }
+    cout << "Received signal " << signum << ", stopping the simulations" << endl;
 }
+
+/**
+ * Stops and deletes all simulations, in the order of their dependencies: no
+ * new requests are accepted first, then the receivers are stopped and their
+ * threads joined, then the simulations are deleted, and the Lua scripts
+ * last, since their workers may still answer a request in flight.
+ */
+void stopSimulations()
+{
+    for (const unique_ptr<DoIPSimServer> &doipSimServer : doipSimServers) {
+        doipSimServer->shutdown();
+    }
+    lock_guard<mutex> lock(simulatorsMutex);
+    for (ElectronicControlUnit *simulator : udsSimulators) {
+        simulator->stopSimulation();
+    }
+    for (J1939Simulator *simulator : j1939Simulators) {
+        simulator->stopSimulation();
+    }
+    for (auto &reactor : receiverReactors) {
+        reactor.second->stop();
+    }
+    for (auto &reactor : receiverReactors) {
+        reactor.second->waitForStop();
+    }
+
+    for (ElectronicControlUnit *simulator : udsSimulators) {
+        delete simulator;
+    }
+    udsSimulators.clear();
+    cout << "UDS/CAN terminated" << endl;
+    for (J1939Simulator *simulator : j1939Simulators) {
+        delete simulator;
+    }
+    j1939Simulators.clear();
+    cout << "J1939 terminated" << endl;
+    for (CanFrameSimulator *simulator : canFrameSimulators) {
+        delete simulator;
+    }
+    canFrameSimulators.clear();
+    // the entities refer to their ECUs
+    doipSimServers.clear();
+    for (DoIPSimulator *simulator : doipSimulators) {
+        delete simulator;
+    }
+    doipSimulators.clear();
+    receiverReactors.clear();
+
+    for (auto &ecuScript : ecuScripts) {
+        delete ecuScript.second;
+    }
+    ecuScripts.clear();
+}
+
+/**
+ * Writes the snapshots of the 'Raw' tables of all configurations in the
+ * current directory, see `RequestSnapshot`. Up to date snapshots are kept.
+ *
+ * @param config_files: the Lua configurations
+ * @return 0, snapshots which can not be written are logged as warning
+ */
+int build_snapshots(const vector<string> &config_files)
+{
+    EcuLuaScript::setSnapshotsEnabled(true);
+    for (const string &config_file : config_files)
+    {
+        EcuLuaScript script("Main", config_file);
+        const size_t count = script.getRawRequestMatcher()->getLeafCount();
+        cout << config_file << ": " << count << " requests" << endl;
+    }
+    Logger::getInstance().flush();
+    return 0;
+}
+
 /**
  * The main application only for testing purposes.
  *
@@ -104,35 +426,131 @@ int main(int argc, char** argv)
     {
         device = argv[1];
     }
+    if (device == "--export-candump")
+    {
+        if (argc < 3)
+        {
+            cerr << "Usage: " << argv[0] << " --export-candump <capture file>" << endl;
+            return -1;
+        }
+        return TrafficCapture::exportCandump(argv[2], cout) < 0 ? -1 : 0;
+    }
+    // before any thread is started, see `waitForTerminationSignal()`
+    const sigset_t terminationSignals = blockTerminationSignals();
     
     // listen to this communication with `isotpsniffer -s 100 -d 200 -c -td vcan0`
 
+    const filesystem::path startDirectory = filesystem::current_path();
     filesystem::current_path(filesystem::path(LUA_CONFIG_PATH));
 
     vector<string> config_files = utils::getConfigFilenames(".");
-    vector<thread> threads;
+    config_files.erase(remove(config_files.begin(), config_files.end(), SIMULATOR_CONFIG_FILE), config_files.end());
 
-    signal(SIGINT, signalHandler);
+    SimulatorConfiguration simulatorConfig(SIMULATOR_CONFIG_FILE);
+    Logger::setLevel(simulatorConfig.getLogLevel());
+    workerIndex = WorkerSupervisor::initializeWorker();
+    if (simulatorConfig.getWorkers() > 1 && workerIndex < 0 && device != "--build-snapshots")
+    {
+        // the workers start in the same directory as the supervisor
+        filesystem::current_path(startDirectory);
+        return WorkerSupervisor(simulatorConfig.getWorkers()).run(argv, terminationSignals);
+    }
+    workerCount = workerIndex >= 0 ? max(simulatorConfig.getWorkers(), 1u) : 0;
+    DoIPSimServer::setWorkerIndex(workerIndex);
+    // each worker writes its own files
+    const string captureFile = WorkerSupervisor::getWorkerFile(simulatorConfig.getCaptureFile(), workerIndex);
+    const string luaProfileFile = WorkerSupervisor::getWorkerFile(simulatorConfig.getLuaProfileFile(), workerIndex);
+    const string checkpointFile = WorkerSupervisor::getWorkerFile(simulatorConfig.getCheckpointFile(), workerIndex);
+    ThreadPlacement::getInstance().configure(ThreadRole::IO, simulatorConfig.getThreadConfiguration(ThreadRole::IO));
+    ThreadPlacement::getInstance().configure(ThreadRole::LUA, simulatorConfig.getThreadConfiguration(ThreadRole::LUA));
+    if (device == "--build-snapshots")
+    {
+        // nothing to stop, a signal simply terminates the process
+        pthread_sigmask(SIG_UNBLOCK, &terminationSignals, nullptr);
+        return build_snapshots(config_files);
+    }
+    if(simulatorConfig.isRealTimeEnabled()) {
+        RealTimeProfile::prepare();
+    }
+    RealTimeProfile::setBusyPollWindow(simulatorConfig.getBusyPollWindow());
+    EcuLuaScript::setSnapshotsEnabled(simulatorConfig.useConfigSnapshots());
+    EcuLuaScript::setHotRelayoutEnabled(simulatorConfig.isHotRelayoutEnabled());
+    BusStateMonitor::setRecoveryEnabled(simulatorConfig.isBusRecoveryEnabled());
+    J1939CyclicScheduler::setOffloadEnabled(simulatorConfig.isCyclicOffloadEnabled());
+    IsoTpEngine::setEnabled(simulatorConfig.useUserSpaceIsoTp());
+    BusLoadBudget::configure(simulatorConfig.getBusBitRate(), simulatorConfig.getMaxBusLoad());
+    IdleMonitor::getInstance().configure(simulatorConfig.getIdleTimeout());
+    SimulationClock::getInstance().configure(simulatorConfig.getTimeScale(), simulatorConfig.isVirtualTimeEnabled());
+    LuaProfiler::setEnabled(!simulatorConfig.getLuaProfileFile().empty());
+    if(!captureFile.empty()) {
+        TrafficCapture::getInstance().open(captureFile, simulatorConfig.getCaptureSize());
+    }
+    Metrics::getInstance().setConfigCount(config_files.size());
+    if(simulatorConfig.getMetricsPort() != 0) {
+        // the workers serve their metrics on the following ports
+        Metrics::getInstance().startEndpoint(simulatorConfig.getMetricsPort() + max(workerIndex, 0));
+    }
+    reactorThreads = simulatorConfig.getReactorThreads();
 
-    for (const string &config_file : config_files)
+    const auto startupBegin = chrono::steady_clock::now();
     {
-        if(config_file == "doipserver.lua") {   
-            doipSimServer.startWithConfig(config_file);
+        ThreadPool startupPool(simulatorConfig.getStartupThreads());
+        // the entities are started first, so the ECUs can be added to them
+        for (const string &config_file : config_files)
+        {
+            if(isDoipServerConfig(config_file)) {
+                doipSimServers.push_back(std::make_unique<DoIPSimServer>());
+                doipSimServers.back()->startWithConfig(config_file, getReceiverReactor(DOIP_CAPTURE_INTERFACE));
+            }
         }
-        thread t(start_server, config_file, device);
-        threads.push_back(move(t));
-        usleep(50000);
+        for (const string &config_file : config_files)
+        {
+            startupPool.submit([config_file, &device]() {
+                ThreadPlacement::getInstance().apply(ThreadRole::LUA);
+                try {
+                    start_server(config_file, device);
+                } catch (exception &) {
+                    cerr << "Failed to start the simulation of " << config_file << endl;
+                }
+                Metrics::getInstance().configLoaded();
+            });
+        }
+        startupPool.wait();
+    }
+    cout << "Loaded " << config_files.size() << " configurations in "
+         << chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - startupBegin).count()
+         << " ms" << endl;
+    if(simulatorConfig.isRealTimeEnabled()) {
+        RealTimeProfile::lockMemory();
+    }
+    if(!checkpointFile.empty() && utils::existsFile(checkpointFile)) {
+        restoreCheckpoint(checkpointFile);
     }
 
-    for (unsigned int i = 0; i < threads.size(); ++i)
-    {
-        threads[i].join();
+    ConfigWatcher configWatcher;
+    if(simulatorConfig.isHotReloadEnabled()) {
+        configWatcher.start(".", reload_server);
+    }
+
+    SignalFeed signalFeed;
+    if(!simulatorConfig.getSignalFeed().empty()) {
+        signalFeed.openSharedMemory(simulatorConfig.getSignalFeed());
+    }
+    if(!simulatorConfig.getSignalFeedGroup().empty()) {
+        signalFeed.openMulticast(simulatorConfig.getSignalFeedGroup());
     }
+    signalFeed.start();
 
-    while(doipSimServer.isServerActive()) {
-        usleep(1000000);
+    waitForTerminationSignal(terminationSignals, luaProfileFile, checkpointFile);
+    signalFeed.stop();
+    configWatcher.stop();
+    stopSimulations();
+    if (LuaProfiler::isEnabled()) {
+        writeLuaProfile(luaProfileFile);
     }
+    Metrics::getInstance().stopEndpoint();
 
+    Logger::getInstance().flush();
     return 0;
 }
 
@@ -0,0 +1,298 @@
+/**
+ * @file memory_service.cpp
+ *
+ * Native `ReadMemoryByAddress` and `WriteMemoryByAddress` on memory-mapped
+ * images, see `MemoryService`.
+ */
+
+#include "memory_service.h"
+#include "service_identifier.h"
+#include "logger.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+
+using namespace std;
+
+/// the max. number of bytes of the memory address and the memory size
+static constexpr size_t MAX_ADDRESS_AND_LENGTH_SIZE = sizeof(uint32_t);
+
+static void setNegativeResponse(vector<uint8_t>& response, uint8_t sid, uint8_t nrc)
+{
+    response.assign({ERROR, sid, nrc});
+}
+
+static uint64_t readBigEndian(const uint8_t* data, size_t length) noexcept
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < length; ++i)
+    {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+/**
+ * Reads `SID addressAndLengthFormatIdentifier memoryAddress memorySize` at
+ * the start of a request.
+ *
+ * @param request: the UDS request
+ * @param length: the length of the request in bytes
+ * @param address: set to the memory address
+ * @param size: set to the memory size
+ * @param response: set to the negative response on error
+ * @return the length of the parsed fields in bytes, 0 on error
+ */
+static size_t parseAddressAndSize(const uint8_t* request, size_t length, uint64_t& address, uint64_t& size,
+                                  vector<uint8_t>& response)
+{
+    if (length < 2)
+    {
+        setNegativeResponse(response, request[0], INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return 0;
+    }
+    const size_t addressLength = request[1] & 0x0F;
+    const size_t sizeLength = request[1] >> 4;
+    if (length < 2 + addressLength + sizeLength)
+    {
+        setNegativeResponse(response, request[0], INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return 0;
+    }
+    if (addressLength == 0 || addressLength > MAX_ADDRESS_AND_LENGTH_SIZE
+        || sizeLength == 0 || sizeLength > MAX_ADDRESS_AND_LENGTH_SIZE)
+    {
+        setNegativeResponse(response, request[0], REQUEST_OUT_OF_RANGE);
+        return 0;
+    }
+    address = readBigEndian(request + 2, addressLength);
+    size = readBigEndian(request + 2 + addressLength, sizeLength);
+    return 2 + addressLength + sizeLength;
+}
+
+/**
+ * @param sid: the UDS service identifier of a request
+ * @return true if the request is handled by the `MemoryService`
+ */
+bool MemoryService::isMemoryRequest(uint8_t sid) noexcept
+{
+    return sid == READ_MEMORY_BY_ADDRESS_REQ || sid == WRITE_MEMORY_BY_ADDRESS_REQ;
+}
+
+/**
+ * Constructor. Maps the memory images, a region whose file can not be mapped
+ * or which overlaps another region is skipped.
+ *
+ * @param regions: the regions of the `Memory` table
+ * @param maxResponseLength: the max. length of a response of the transport
+ */
+MemoryService::MemoryService(const vector<MemoryRegionConfiguration>& regions, size_t maxResponseLength)
+: maxResponseLength_(maxResponseLength)
+{
+    for (const MemoryRegionConfiguration& configuration : regions)
+    {
+        mapRegion(configuration);
+    }
+    sort(regions_.begin(), regions_.end(), [](const Region& a, const Region& b) { return a.address < b.address; });
+}
+
+MemoryService::~MemoryService()
+{
+    for (const Region& region : regions_)
+    {
+        munmap(region.pMapping, region.mappingSize);
+    }
+}
+
+/**
+ * Handles a memory request, see `isMemoryRequest()`.
+ *
+ * @param request: the UDS request
+ * @param length: the length of the request in bytes (min. 1 byte)
+ * @param response: replaced by the positive or negative response
+ */
+void MemoryService::proceedRequest(const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    switch (request[0])
+    {
+        case READ_MEMORY_BY_ADDRESS_REQ:
+            readMemoryByAddress(request, length, response);
+            break;
+        case WRITE_MEMORY_BY_ADDRESS_REQ:
+            writeMemoryByAddress(request, length, response);
+            break;
+        default:
+            setNegativeResponse(response, request[0], SERVICE_NOT_SUPPORTED);
+            break;
+    }
+}
+
+/**
+ * Maps the file of a region. The mapping starts at the page of the offset,
+ * the pages are loaded on the first access.
+ *
+ * @param configuration: the region
+ * @return false if the region is skipped
+ */
+bool MemoryService::mapRegion(const MemoryRegionConfiguration& configuration)
+{
+    const int fd = open(configuration.file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        LOG_ERROR("Can not open the memory image " << configuration.file << ": " << strerror(errno));
+        return false;
+    }
+    struct stat st;
+    const size_t fileSize = fstat(fd, &st) == 0 ? size_t(st.st_size) : 0;
+    if (configuration.offset >= fileSize)
+    {
+        LOG_ERROR("The memory image " << configuration.file << " ends before the offset " << configuration.offset);
+        close(fd);
+        return false;
+    }
+    size_t size = fileSize - configuration.offset;
+    if (configuration.size > 0)
+    {
+        if (configuration.size > size)
+        {
+            LOG_WARNING("The memory image " << configuration.file << " is shorter than the region, "
+                        << size << " bytes are mapped");
+        }
+        size = min(size, configuration.size);
+    }
+    if (uint64_t(configuration.address) + size - 1 > UINT32_MAX)
+    {
+        LOG_ERROR("The memory region of " << configuration.file << " exceeds the 32 bit address space");
+        close(fd);
+        return false;
+    }
+
+    const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+    const size_t mappingOffset = configuration.offset - configuration.offset % pageSize;
+    const size_t mappingSize = configuration.offset - mappingOffset + size;
+    const int protection = configuration.isWritable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* pMapping = mmap(nullptr, mappingSize, protection, MAP_PRIVATE, fd, off_t(mappingOffset));
+    close(fd);
+    if (pMapping == MAP_FAILED)
+    {
+        LOG_ERROR("Can not map the memory image " << configuration.file << ": " << strerror(errno));
+        return false;
+    }
+
+    const Region region = {
+        configuration.address,
+        size,
+        static_cast<uint8_t*> (pMapping) + (configuration.offset - mappingOffset),
+        configuration.isWritable,
+        pMapping,
+        mappingSize
+    };
+    for (const Region& other : regions_)
+    {
+        if (region.address < other.address + other.size && other.address < region.address + region.size)
+        {
+            LOG_ERROR("The memory region of " << configuration.file << " overlaps another region");
+            munmap(pMapping, mappingSize);
+            return false;
+        }
+    }
+    regions_.push_back(region);
+    LOG_INFO("Mapped " << dec << size << " bytes of " << configuration.file << " to 0x" << hex
+             << configuration.address);
+    return true;
+}
+
+/**
+ * @param address: the first memory address
+ * @param size: the number of bytes
+ * @return the region containing all of the bytes or `nullptr`
+ */
+const MemoryService::Region* MemoryService::findRegion(uint64_t address, uint64_t size) const noexcept
+{
+    auto it = upper_bound(regions_.cbegin(), regions_.cend(), address,
+                          [](uint64_t value, const Region& region) { return value < region.address; });
+    if (it == regions_.cbegin())
+    {
+        return nullptr;
+    }
+    --it;
+    const uint64_t offset = address - it->address;
+    return offset < it->size && size <= it->size - offset ? &*it : nullptr;
+}
+
+/**
+ * `23 addressAndLengthFormatIdentifier memoryAddress memorySize`, answered
+ * with `63 dataRecord`.
+ */
+void MemoryService::readMemoryByAddress(const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    uint64_t address;
+    uint64_t size;
+    const size_t headerLength = parseAddressAndSize(request, length, address, size, response);
+    if (headerLength == 0)
+    {
+        return;
+    }
+    if (length != headerLength)
+    {
+        setNegativeResponse(response, READ_MEMORY_BY_ADDRESS_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+    const Region* pRegion = findRegion(address, size);
+    if (size == 0 || size >= maxResponseLength_ || pRegion == nullptr)
+    {
+        setNegativeResponse(response, READ_MEMORY_BY_ADDRESS_REQ, REQUEST_OUT_OF_RANGE);
+        return;
+    }
+
+    // the response buffer keeps its capacity, so this is the only copy of the data
+    response.resize(1 + size);
+    response[0] = READ_MEMORY_BY_ADDRESS_RES;
+    const uint8_t* pData = pRegion->pData + (address - pRegion->address);
+    if (pRegion->isWritable)
+    {
+        shared_lock<shared_mutex> lock(mutex_);
+        memcpy(response.data() + 1, pData, size);
+    }
+    else
+    {
+        memcpy(response.data() + 1, pData, size);
+    }
+}
+
+/**
+ * `3D addressAndLengthFormatIdentifier memoryAddress memorySize dataRecord`,
+ * answered with `7D addressAndLengthFormatIdentifier memoryAddress memorySize`.
+ */
+void MemoryService::writeMemoryByAddress(const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    uint64_t address;
+    uint64_t size;
+    const size_t headerLength = parseAddressAndSize(request, length, address, size, response);
+    if (headerLength == 0)
+    {
+        return;
+    }
+    if (length != headerLength + size)
+    {
+        setNegativeResponse(response, WRITE_MEMORY_BY_ADDRESS_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+    const Region* pRegion = findRegion(address, size);
+    if (size == 0 || pRegion == nullptr || !pRegion->isWritable)
+    {
+        setNegativeResponse(response, WRITE_MEMORY_BY_ADDRESS_REQ, REQUEST_OUT_OF_RANGE);
+        return;
+    }
+
+    {
+        unique_lock<shared_mutex> lock(mutex_);
+        memcpy(pRegion->pData + (address - pRegion->address), request + headerLength, size);
+    }
+    response.assign(request, request + headerLength);
+    response[0] = WRITE_MEMORY_BY_ADDRESS_RES;
+}
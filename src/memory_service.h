@@ -0,0 +1,80 @@
+/**
+ * @file memory_service.h
+ *
+ */
+
+#ifndef MEMORY_SERVICE_H
+#define MEMORY_SERVICE_H
+
+#include "uds_service_handler.h"
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+/**
+ * One region of the `Memory` table of the ECU.
+ */
+struct MemoryRegionConfiguration
+{
+    std::uint32_t address = 0; ///< the first memory address of the region
+    std::string file; ///< the memory image
+    std::size_t offset = 0; ///< the offset of the region in the file
+    std::size_t size = 0; ///< the size of the region, 0 = up to the end of the file
+    bool isWritable = false; ///< written by `WriteMemoryByAddress` (copy-on-write, the file is never changed)
+};
+
+/**
+ * The UDS services `ReadMemoryByAddress` (0x23) and `WriteMemoryByAddress`
+ * (0x3D) of an ECU, served from memory images.
+ *
+ * Each region of the `Memory` table maps its file into the simulator, a
+ * read-only region with a read-only mapping, a writable one with a private
+ * (copy-on-write) mapping. The requests are served by offsets into the
+ * mappings: a read copies the requested bytes once into the response, no
+ * Lua function is called and no data is converted, so even megabytes of
+ * calibration data are read at the speed of the transport. The pages are
+ * loaded from the file on the first access.
+ *
+ * The `addressAndLengthFormatIdentifier` of the requests supports memory
+ * addresses and sizes of 1 to 4 bytes. A request must lie within one region.
+ */
+class MemoryService : public UdsServiceHandler
+{
+public:
+    static bool isMemoryRequest(std::uint8_t sid) noexcept;
+
+    MemoryService(const std::vector<MemoryRegionConfiguration>& regions, std::size_t maxResponseLength);
+    MemoryService(const MemoryService& orig) = delete;
+    MemoryService& operator =(const MemoryService& orig) = delete;
+    virtual ~MemoryService();
+
+    void proceedRequest(const std::uint8_t* request, std::size_t length,
+                        std::vector<std::uint8_t>& response) override;
+    bool hasSubFunction(std::uint8_t sid) const noexcept override { return false; }
+
+    std::size_t getRegionCount() const noexcept { return regions_.size(); }
+
+private:
+    struct Region
+    {
+        std::uint64_t address; ///< the first memory address
+        std::uint64_t size;
+        std::uint8_t* pData; ///< the first byte of the region within the mapping
+        bool isWritable;
+        void* pMapping;
+        std::size_t mappingSize;
+    };
+
+    const std::size_t maxResponseLength_; ///< incl. the SID
+    std::vector<Region> regions_; ///< sorted by address, without overlaps
+    mutable std::shared_mutex mutex_; ///< the reads share the writable regions, a write has them exclusively
+
+    bool mapRegion(const MemoryRegionConfiguration& configuration);
+    const Region* findRegion(std::uint64_t address, std::uint64_t size) const noexcept;
+    void readMemoryByAddress(const std::uint8_t* request, std::size_t length, std::vector<std::uint8_t>& response);
+    void writeMemoryByAddress(const std::uint8_t* request, std::size_t length, std::vector<std::uint8_t>& response);
+};
+
+#endif /* MEMORY_SERVICE_H */
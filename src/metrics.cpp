@@ -0,0 +1,901 @@
+/**
+ * @file metrics.cpp
+ *
+ * This file contains the latency histograms and request counters of the
+ * simulated ECUs and their export in the Prometheus text format.
+ */
+
+#include "metrics.h"
+#include "bus_load_budget.h"
+#include "idle_monitor.h"
+#include "logger.h"
+#include "realtime_profile.h"
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <set>
+#include <sstream>
+
+using namespace std;
+
+/// the time the endpoint waits for a connection before checking for a stop
+/// the bucket limits written to Prometheus
+static constexpr array<uint64_t, 13> PROMETHEUS_BUCKETS_US = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000
+};
+static constexpr array<double, 3> PROMETHEUS_QUANTILES = {0.5, 0.99, 0.999};
+
+static void updateMax(atomic<uint64_t>& maxValue, uint64_t value) noexcept
+{
+    uint64_t current = maxValue.load(memory_order_relaxed);
+    while (value > current && !maxValue.compare_exchange_weak(current, value, memory_order_relaxed))
+    {
+    }
+}
+
+/**
+ * @param valueUs: the latency in microseconds
+ */
+void LatencyHistogram::record(uint64_t valueUs) noexcept
+{
+    buckets_[getBucketIndex(valueUs)].fetch_add(1, memory_order_relaxed);
+    count_.fetch_add(1, memory_order_relaxed);
+    sumUs_.fetch_add(valueUs, memory_order_relaxed);
+    updateMax(maxUs_, valueUs);
+}
+
+void LatencyHistogram::record(chrono::steady_clock::duration duration) noexcept
+{
+    const auto valueUs = chrono::duration_cast<chrono::microseconds>(duration).count();
+    record(valueUs > 0 ? uint64_t(valueUs) : 0);
+}
+
+uint64_t LatencyHistogram::getCount() const noexcept
+{
+    return count_.load(memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::getSumUs() const noexcept
+{
+    return sumUs_.load(memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::getMaxUs() const noexcept
+{
+    return maxUs_.load(memory_order_relaxed);
+}
+
+/**
+ * Counts the values of all buckets which end at or below the given value. The
+ * bucket containing the value itself is only counted if it ends there, so the
+ * result is never too high.
+ *
+ * @param valueUs: the limit in microseconds
+ * @return the number of recorded values up to the limit
+ */
+uint64_t LatencyHistogram::getCountAtOrBelow(uint64_t valueUs) const noexcept
+{
+    uint64_t count = 0;
+    for (size_t i = 0; i < BUCKET_COUNT && getBucketUpperBound(i) <= valueUs; ++i)
+    {
+        count += buckets_[i].load(memory_order_relaxed);
+    }
+    return count;
+}
+
+/**
+ * @param quantile: e.g. 0.99 for the 99th percentile
+ * @return the upper bound of the bucket containing the quantile (but not more
+ *         than the max. value), 0 if nothing is recorded yet
+ */
+uint64_t LatencyHistogram::getValueAtQuantile(double quantile) const noexcept
+{
+    uint64_t total = 0;
+    for (const atomic<uint64_t>& bucket : buckets_)
+    {
+        total += bucket.load(memory_order_relaxed);
+    }
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    const uint64_t target = max<uint64_t>(1, uint64_t(ceil(quantile * double(total))));
+    uint64_t count = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i)
+    {
+        count += buckets_[i].load(memory_order_relaxed);
+        if (count >= target)
+        {
+            return min(getBucketUpperBound(i), getMaxUs());
+        }
+    }
+    return getMaxUs();
+}
+
+size_t LatencyHistogram::getBucketIndex(uint64_t valueUs) noexcept
+{
+    if (valueUs < SUB_BUCKETS)
+    {
+        return size_t(valueUs);
+    }
+    const unsigned magnitude = 63 - unsigned(__builtin_clzll(valueUs));
+    if (magnitude > MAX_MAGNITUDE)
+    {
+        return BUCKET_COUNT - 1;
+    }
+    const size_t subBucket = (valueUs >> (magnitude - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return SUB_BUCKETS + (magnitude - SUB_BUCKET_BITS) * SUB_BUCKETS + subBucket;
+}
+
+/**
+ * @return the largest value of the given bucket
+ */
+uint64_t LatencyHistogram::getBucketUpperBound(size_t index) noexcept
+{
+    if (index < SUB_BUCKETS)
+    {
+        return index;
+    }
+    if (index >= BUCKET_COUNT - 1)
+    {
+        return numeric_limits<uint64_t>::max();
+    }
+    const unsigned shift = unsigned((index - SUB_BUCKETS) / SUB_BUCKETS);
+    const uint64_t subBucket = (index - SUB_BUCKETS) % SUB_BUCKETS;
+    return ((SUB_BUCKETS + subBucket + 1) << shift) - 1;
+}
+
+/**
+ * Constructor.
+ *
+ * @param transport: the protocol of the ECU (e.g. "uds")
+ * @param address: the request CAN ID or the logical address of the ECU
+ */
+EcuMetrics::EcuMetrics(const string& transport, uint32_t address)
+: transport_(transport)
+{
+    ostringstream ecu;
+    ecu << hex << uppercase << address;
+    ecu_ = ecu.str();
+}
+
+EcuMetrics::~EcuMetrics()
+{
+    for (atomic<ServiceMetrics*>& service : services_)
+    {
+        delete service.load();
+    }
+}
+
+/**
+ * Exports the memory statistics of the Lua states of the ECU, see
+ * `EcuLuaScript::getLuaMemoryStatistics()`.
+ *
+ * @param pLuaMemory: the statistics, shared with the `LuaMemoryPool`s
+ */
+void EcuMetrics::setLuaMemory(shared_ptr<const LuaMemoryStatistics> pLuaMemory) noexcept
+{
+    atomic_store(&pLuaMemory_, move(pLuaMemory));
+}
+
+/**
+ * @return the memory statistics of the Lua states or `nullptr`
+ */
+shared_ptr<const LuaMemoryStatistics> EcuMetrics::getLuaMemory() const noexcept
+{
+    return atomic_load(&pLuaMemory_);
+}
+
+/**
+ * Exports the hits of the request table entries of the ECU, see
+ * `EcuLuaScript::getRequestHitStatistics()`.
+ *
+ * @param pRequestHits: the statistics, shared with the `EcuLuaScript`
+ */
+void EcuMetrics::setRequestHits(shared_ptr<const RequestHitStatistics> pRequestHits) noexcept
+{
+    atomic_store(&pRequestHits_, move(pRequestHits));
+}
+
+/**
+ * @return the hits of the request table entries or `nullptr`
+ */
+shared_ptr<const RequestHitStatistics> EcuMetrics::getRequestHits() const noexcept
+{
+    return atomic_load(&pRequestHits_);
+}
+
+/**
+ * @param sid: the service identifier of the request
+ * @return the metrics of the service, allocated on the first call, or
+ *         `nullptr` if the allocation failed
+ */
+ServiceMetrics* EcuMetrics::getService(uint8_t sid) noexcept
+{
+    ServiceMetrics* pService = services_[sid].load(memory_order_acquire);
+    if (pService != nullptr)
+    {
+        return pService;
+    }
+
+    ServiceMetrics* pNewService = new (nothrow) ServiceMetrics();
+    if (pNewService == nullptr)
+    {
+        return nullptr;
+    }
+    if (!services_[sid].compare_exchange_strong(pService, pNewService, memory_order_acq_rel))
+    {
+        // allocated by another thread in the meantime
+        delete pNewService;
+        return pService;
+    }
+    return pNewService;
+}
+
+/**
+ * @return the metrics of the service or `nullptr` if it was never requested
+ */
+const ServiceMetrics* EcuMetrics::findService(uint8_t sid) const noexcept
+{
+    return services_[sid].load(memory_order_acquire);
+}
+
+/**
+ * Counts the request.
+ *
+ * @param pMetrics: the metrics of the ECU or `nullptr` to measure nothing
+ * @param sid: the service identifier of the request
+ * @param receivedAt: the time the request was read from the socket
+ */
+RequestTimer::RequestTimer(EcuMetrics* pMetrics, uint8_t sid,
+                           chrono::steady_clock::time_point receivedAt) noexcept
+: pMetrics_(pMetrics)
+, pService_(pMetrics ? pMetrics->getService(sid) : nullptr)
+, receivedAt_(receivedAt)
+{
+    if (pService_)
+    {
+        pService_->requests.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+/**
+ * Move constructor.
+ *
+ * @param orig: the originating instance, records nothing afterwards
+ */
+RequestTimer::RequestTimer(RequestTimer&& orig) noexcept
+: pMetrics_(orig.pMetrics_)
+, pService_(orig.pService_)
+, receivedAt_(orig.receivedAt_)
+, luaStartedAt_(orig.luaStartedAt_)
+, luaTime_(orig.luaTime_)
+, isLookupRecorded_(orig.isLookupRecorded_)
+, isResponseRecorded_(orig.isResponseRecorded_)
+{
+    orig.pMetrics_ = nullptr;
+    orig.pService_ = nullptr;
+}
+
+/**
+ * Records the time from receiving the request until now as lookup time.
+ *
+ * @param isWildcard: true if the request matched a wildcard entry
+ */
+void RequestTimer::lookupFinished(bool isWildcard) noexcept
+{
+    if (!pService_ || isLookupRecorded_)
+    {
+        return;
+    }
+    isLookupRecorded_ = true;
+    pService_->lookupLatency.record(chrono::steady_clock::now() - receivedAt_);
+    if (isWildcard)
+    {
+        pService_->wildcardMatches.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+/**
+ * Records the time from receiving the request until now as the queue latency
+ * of the given lane. A request queued on the Lua worker passes both lanes.
+ *
+ * @param lane: the lane, i.e. the receiving thread or the Lua worker
+ */
+void RequestTimer::dispatched(DispatchLane lane) noexcept
+{
+    if (!pMetrics_)
+    {
+        return;
+    }
+    pMetrics_->queueLatency[size_t(lane)].record(chrono::steady_clock::now() - receivedAt_);
+}
+
+void RequestTimer::luaStarted() noexcept
+{
+    if (pService_)
+    {
+        luaStartedAt_ = chrono::steady_clock::now();
+    }
+}
+
+void RequestTimer::luaFinished() noexcept
+{
+    if (pService_)
+    {
+        luaTime_ += chrono::steady_clock::now() - luaStartedAt_;
+    }
+}
+
+/**
+ * Records the latency of the request. Only the first response is recorded,
+ * e.g. a "response pending" before the final response.
+ *
+ * @param response: the sent response
+ * @param length: the length of the response
+ */
+void RequestTimer::responseSent(const uint8_t* response, size_t length) noexcept
+{
+    if (!pService_ || isResponseRecorded_)
+    {
+        return;
+    }
+    isResponseRecorded_ = true;
+    const chrono::steady_clock::duration latency = chrono::steady_clock::now() - receivedAt_;
+    pService_->responseLatency.record(latency);
+    if (luaTime_.count() > 0)
+    {
+        pService_->luaLatency.record(luaTime_);
+    }
+    if (latency > P2_SERVER_MAX)
+    {
+        pService_->p2Violations.fetch_add(1, memory_order_relaxed);
+    }
+    if (length > 0 && response[0] == 0x7F)
+    {
+        pService_->negativeResponses.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+/**
+ * @return the metrics registry of the process
+ */
+Metrics& Metrics::getInstance()
+{
+    static Metrics metrics;
+    return metrics;
+}
+
+Metrics::~Metrics()
+{
+    stopEndpoint();
+}
+
+/**
+ * Returns the metrics of the given ECU, which are created on the first call.
+ * The metrics are never deleted, so the pointer stays valid until the process
+ * exits, even if the ECU is recreated.
+ *
+ * @param transport: the protocol of the ECU (e.g. "uds" or "doip")
+ * @param address: the request CAN ID or the logical address of the ECU
+ * @return the metrics of the ECU
+ */
+EcuMetrics* Metrics::registerEcu(const string& transport, uint32_t address)
+{
+    lock_guard<mutex> lock(ecusMutex_);
+    unique_ptr<EcuMetrics> pNewEcu = std::make_unique<EcuMetrics>(transport, address);
+    for (const unique_ptr<EcuMetrics>& pEcu : ecus_)
+    {
+        if (pEcu->getTransport() == transport && pEcu->getEcu() == pNewEcu->getEcu())
+        {
+            return pEcu.get();
+        }
+    }
+    ecus_.push_back(move(pNewEcu));
+    return ecus_.back().get();
+}
+
+/**
+ * Sets the number of configurations loaded at startup, see `isReady()`.
+ *
+ * @param count: the number of configuration files
+ */
+void Metrics::setConfigCount(size_t count) noexcept
+{
+    configCount_ = count;
+}
+
+/**
+ * Counts a loaded configuration (successfully or not).
+ */
+void Metrics::configLoaded() noexcept
+{
+    loadedConfigs_.fetch_add(1);
+}
+
+/**
+ * @return true if all configurations given by `setConfigCount()` are loaded
+ */
+bool Metrics::isReady() const noexcept
+{
+    return loadedConfigs_ >= configCount_;
+}
+
+namespace
+{
+
+void writeSeconds(ostream& out, uint64_t valueUs)
+{
+    out << valueUs / 1000000 << '.' << setw(6) << setfill('0') << valueUs % 1000000;
+}
+
+void writeHeader(ostream& out, const char* name, const char* type, const char* help)
+{
+    out << "# HELP " << name << ' ' << help << '\n'
+        << "# TYPE " << name << ' ' << type << '\n';
+}
+
+void writeLabels(ostream& out, const EcuMetrics& ecu, unsigned sid)
+{
+    out << "transport=\"" << ecu.getTransport() << "\",ecu=\"" << ecu.getEcu()
+        << "\",sid=\"0x" << hex << uppercase << setw(2) << setfill('0') << sid << dec << '"';
+}
+
+/**
+ * Writes a histogram with the labels written by the given function.
+ */
+template<class LabelWriter>
+void writeHistogram(ostream& out, const char* name, const LabelWriter& writeLabels, const LatencyHistogram& histogram)
+{
+    for (const uint64_t limitUs : PROMETHEUS_BUCKETS_US)
+    {
+        out << name << "_bucket{";
+        writeLabels();
+        out << ",le=\"";
+        writeSeconds(out, limitUs);
+        out << "\"} " << histogram.getCountAtOrBelow(limitUs) << '\n';
+    }
+    out << name << "_bucket{";
+    writeLabels();
+    out << ",le=\"+Inf\"} " << histogram.getCount() << '\n';
+    out << name << "_sum{";
+    writeLabels();
+    out << "} ";
+    writeSeconds(out, histogram.getSumUs());
+    out << '\n' << name << "_count{";
+    writeLabels();
+    out << "} " << histogram.getCount() << '\n';
+}
+
+void writeHistogram(ostream& out, const char* name, const EcuMetrics& ecu, unsigned sid,
+                    const LatencyHistogram& histogram)
+{
+    writeHistogram(out, name, [&out, &ecu, sid]() { writeLabels(out, ecu, sid); }, histogram);
+}
+
+void writeLaneHistogram(ostream& out, const char* name, const EcuMetrics& ecu, const char* lane,
+                        const LatencyHistogram& histogram)
+{
+    writeHistogram(out, name, [&out, &ecu, lane]()
+    {
+        out << "transport=\"" << ecu.getTransport() << "\",ecu=\"" << ecu.getEcu() << "\",lane=\"" << lane << '"';
+    }, histogram);
+}
+
+} // namespace
+
+/**
+ * Writes the metrics of all ECUs in the Prometheus text format.
+ *
+ * @param out: the stream to write to
+ */
+void Metrics::writePrometheus(ostream& out) const
+{
+    lock_guard<mutex> lock(ecusMutex_);
+    const ios_base::fmtflags flags = out.flags();
+    const char fillCharacter = out.fill();
+
+    auto forEachService = [this](const function<void(const EcuMetrics&, unsigned, const ServiceMetrics&)>& write)
+    {
+        for (const unique_ptr<EcuMetrics>& pEcu : ecus_)
+        {
+            for (unsigned sid = 0; sid < 256; ++sid)
+            {
+                const ServiceMetrics* pService = pEcu->findService(uint8_t(sid));
+                if (pService)
+                {
+                    write(*pEcu, sid, *pService);
+                }
+            }
+        }
+    };
+    auto writeCounter = [&out, &forEachService](const char* name, const char* help,
+                                                 atomic<uint64_t> ServiceMetrics::* counter)
+    {
+        writeHeader(out, name, "counter", help);
+        forEachService([&out, name, counter](const EcuMetrics& ecu, unsigned sid, const ServiceMetrics& service)
+        {
+            out << name << '{';
+            writeLabels(out, ecu, sid);
+            out << "} " << (service.*counter).load(memory_order_relaxed) << '\n';
+        });
+    };
+    auto writeHistograms = [&out, &forEachService](const char* name, const char* help,
+                                                    const LatencyHistogram ServiceMetrics::* histogram)
+    {
+        writeHeader(out, name, "histogram", help);
+        forEachService([&out, name, histogram](const EcuMetrics& ecu, unsigned sid, const ServiceMetrics& service)
+        {
+            writeHistogram(out, name, ecu, sid, service.*histogram);
+        });
+    };
+
+    writeCounter("carsim_requests_total", "Received diagnostic requests.", &ServiceMetrics::requests);
+    writeCounter("carsim_negative_responses_total", "Sent negative responses.", &ServiceMetrics::negativeResponses);
+    writeCounter("carsim_wildcard_matches_total", "Requests answered by a wildcard entry.", &ServiceMetrics::wildcardMatches);
+    writeCounter("carsim_p2_violations_total", "Responses sent later than 50 ms after the request.", &ServiceMetrics::p2Violations);
+    writeHistograms("carsim_response_latency_seconds", "Time from reading the request to sending the response.",
+                    &ServiceMetrics::responseLatency);
+    writeHistograms("carsim_lookup_latency_seconds", "Time from reading the request to finding the response.",
+                    &ServiceMetrics::lookupLatency);
+    writeHistograms("carsim_lua_latency_seconds", "Time spent in Lua functions per request.",
+                    &ServiceMetrics::luaLatency);
+
+    writeHeader(out, "carsim_queue_latency_seconds", "histogram",
+                "Time from reading the request until it is proceeded, by dispatch lane.");
+    for (const unique_ptr<EcuMetrics>& pEcu : ecus_)
+    {
+        static const char* const LANES[DISPATCH_LANE_COUNT] = {"high", "low"};
+        for (size_t lane = 0; lane < DISPATCH_LANE_COUNT; ++lane)
+        {
+            if (pEcu->queueLatency[lane].getCount() == 0)
+            {
+                continue;
+            }
+            writeLaneHistogram(out, "carsim_queue_latency_seconds", *pEcu, LANES[lane], pEcu->queueLatency[lane]);
+        }
+    }
+
+    writeHeader(out, "carsim_response_latency_quantile_seconds", "gauge",
+                "Quantiles of the response latency (12.5 % resolution).");
+    forEachService([&out](const EcuMetrics& ecu, unsigned sid, const ServiceMetrics& service)
+    {
+        for (const double quantile : PROMETHEUS_QUANTILES)
+        {
+            out << "carsim_response_latency_quantile_seconds{";
+            writeLabels(out, ecu, sid);
+            out << ",quantile=\"" << quantile << "\"} ";
+            writeSeconds(out, service.responseLatency.getValueAtQuantile(quantile));
+            out << '\n';
+        }
+        out << "carsim_response_latency_quantile_seconds{";
+        writeLabels(out, ecu, sid);
+        out << ",quantile=\"1\"} ";
+        writeSeconds(out, service.responseLatency.getMaxUs());
+        out << '\n';
+    });
+
+    writeHeader(out, "carsim_send_retries_total", "counter", "Responses which could not be sent immediately.");
+    for (const unique_ptr<EcuMetrics>& pEcu : ecus_)
+    {
+        out << "carsim_send_retries_total{transport=\"" << pEcu->getTransport() << "\",ecu=\"" << pEcu->getEcu()
+            << "\"} " << pEcu->sendRetries.load(memory_order_relaxed) << '\n';
+    }
+    writeHeader(out, "carsim_dropped_frames_total", "counter", "Responses dropped due to a full queue or an error.");
+    for (const unique_ptr<EcuMetrics>& pEcu : ecus_)
+    {
+        out << "carsim_dropped_frames_total{transport=\"" << pEcu->getTransport() << "\",ecu=\"" << pEcu->getEcu()
+            << "\"} " << pEcu->droppedFrames.load(memory_order_relaxed) << '\n';
+    }
+    writeHeader(out, "carsim_overload_responses_total", "counter",
+                "Requests answered with busyRepeatRequest since too many Lua requests were queued.");
+    for (const unique_ptr<EcuMetrics>& pEcu : ecus_)
+    {
+        out << "carsim_overload_responses_total{transport=\"" << pEcu->getTransport() << "\",ecu=\"" << pEcu->getEcu()
+            << "\"} " << pEcu->overloadResponses.load(memory_order_relaxed) << '\n';
+    }
+    auto writeLuaMemory = [&out, this](const char* name, const char* type, const char* help,
+                                       const atomic<size_t> LuaMemoryStatistics::* value)
+    {
+        writeHeader(out, name, type, help);
+        for (const unique_ptr<EcuMetrics>& pEcu : ecus_)
+        {
+            const shared_ptr<const LuaMemoryStatistics> pLuaMemory = pEcu->getLuaMemory();
+            if (pLuaMemory)
+            {
+                out << name << "{transport=\"" << pEcu->getTransport() << "\",ecu=\"" << pEcu->getEcu()
+                    << "\"} " << ((*pLuaMemory).*value).load(memory_order_relaxed) << '\n';
+            }
+        }
+    };
+    writeLuaMemory("carsim_lua_memory_bytes", "gauge", "Memory used by the Lua states of the ECU.",
+                   &LuaMemoryStatistics::usedBytes);
+    writeLuaMemory("carsim_lua_memory_peak_bytes", "gauge", "Max. memory used by the Lua states of the ECU.",
+                   &LuaMemoryStatistics::peakBytes);
+    writeLuaMemory("carsim_lua_memory_reserved_bytes", "gauge", "Memory reserved by the pools of the Lua states.",
+                   &LuaMemoryStatistics::reservedBytes);
+    writeLuaMemory("carsim_lua_memory_limit_bytes", "gauge", "Memory limit of the Lua state, 0 = unlimited.",
+                   &LuaMemoryStatistics::limitBytes);
+    writeHeader(out, "carsim_lua_allocation_failures_total", "counter", "Allocations refused by the memory limit.");
+    for (const unique_ptr<EcuMetrics>& pEcu : ecus_)
+    {
+        const shared_ptr<const LuaMemoryStatistics> pLuaMemory = pEcu->getLuaMemory();
+        if (pLuaMemory)
+        {
+            out << "carsim_lua_allocation_failures_total{transport=\"" << pEcu->getTransport() << "\",ecu=\""
+                << pEcu->getEcu() << "\"} " << pLuaMemory->failedAllocations.load(memory_order_relaxed) << '\n';
+        }
+    }
+    auto forEachRequestTable = [this](const function<void(const EcuMetrics&, const RequestHitStatistics::Table&)>& write)
+    {
+        for (const unique_ptr<EcuMetrics>& pEcu : ecus_)
+        {
+            const shared_ptr<const RequestHitStatistics> pRequestHits = pEcu->getRequestHits();
+            if (!pRequestHits)
+            {
+                continue;
+            }
+            for (const RequestHitStatistics::Table& table : *pRequestHits->getTables())
+            {
+                write(*pEcu, table);
+            }
+        }
+    };
+    auto writeTableLabels = [&out](const EcuMetrics& ecu, const RequestHitStatistics::Table& table)
+    {
+        out << "transport=\"" << ecu.getTransport() << "\",ecu=\"" << ecu.getEcu() << "\",table=\"" << table.name
+            << "\",session=\"" << table.session << '"';
+    };
+    writeHeader(out, "carsim_request_entries", "gauge", "Entries of the request table.");
+    forEachRequestTable([&out, &writeTableLabels](const EcuMetrics& ecu, const RequestHitStatistics::Table& table)
+    {
+        out << "carsim_request_entries{";
+        writeTableLabels(ecu, table);
+        out << "} " << table.keys.size() << '\n';
+    });
+    writeHeader(out, "carsim_request_entries_unused", "gauge", "Entries of the request table never hit, see /unused.");
+    forEachRequestTable([&out, &writeTableLabels](const EcuMetrics& ecu, const RequestHitStatistics::Table& table)
+    {
+        size_t unused = 0;
+        for (size_t i = 0; i < table.keys.size(); ++i)
+        {
+            unused += table.pCounters->get(i) == 0 ? 1 : 0;
+        }
+        out << "carsim_request_entries_unused{";
+        writeTableLabels(ecu, table);
+        out << "} " << unused << '\n';
+    });
+    // only the entries which were hit, usually a few of a large table
+    writeHeader(out, "carsim_request_hits_total", "counter", "Requests answered by the entry of the request table.");
+    forEachRequestTable([&out, &writeTableLabels](const EcuMetrics& ecu, const RequestHitStatistics::Table& table)
+    {
+        for (size_t i = 0; i < table.keys.size(); ++i)
+        {
+            const uint64_t hits = table.pCounters->get(i);
+            if (hits != 0)
+            {
+                out << "carsim_request_hits_total{";
+                writeTableLabels(ecu, table);
+                out << ",key=\"" << table.keys[i] << "\"} " << hits << '\n';
+            }
+        }
+    });
+    writeHeader(out, "carsim_ecu_ready", "gauge", "1 if the ECU handles requests.");
+    for (const unique_ptr<EcuMetrics>& pEcu : ecus_)
+    {
+        out << "carsim_ecu_ready{transport=\"" << pEcu->getTransport() << "\",ecu=\"" << pEcu->getEcu()
+            << "\"} " << (pEcu->isReady ? 1 : 0) << '\n';
+    }
+    writeHeader(out, "carsim_configs_loaded", "gauge", "Configurations loaded since the start.");
+    out << "carsim_configs_loaded " << loadedConfigs_.load() << '\n';
+    writeHeader(out, "carsim_configs", "gauge", "Configurations to load at the start.");
+    out << "carsim_configs " << configCount_.load() << '\n';
+    writeHeader(out, "carsim_memory_locked", "gauge", "1 if the memory is locked by the real-time profile.");
+    out << "carsim_memory_locked " << (RealTimeProfile::isMemoryLocked() ? 1 : 0) << '\n';
+    writeHeader(out, "carsim_busy_poll_hits_total", "counter", "Messages received while busy polling the sockets.");
+    out << "carsim_busy_poll_hits_total " << RealTimeProfile::getBusyPollHits() << '\n';
+    writeHeader(out, "carsim_asleep", "gauge", "1 while the simulator sleeps after the idle timeout or a bus error.");
+    out << "carsim_asleep " << (IdleMonitor::getInstance().isAwake() ? 0 : 1) << '\n';
+    writeHeader(out, "carsim_sleeps_total", "counter", "Times the simulator fell asleep.");
+    out << "carsim_sleeps_total " << IdleMonitor::getInstance().getSleepCount() << '\n';
+    writeHeader(out, "carsim_bus_load_ratio", "gauge", "Estimated bus load of the sent frames (0..1), by CAN interface.");
+    const uint64_t nowNs = BusLoadBudget::getNowNs();
+    BusLoadBudget::forEach([&out, nowNs](const string& device, BusLoadBudget& budget)
+    {
+        out << "carsim_bus_load_ratio{interface=\"" << device << "\"} " << budget.getLoad(nowNs) << '\n';
+    });
+    writeHeader(out, "carsim_paced_frames_total", "counter", "Bulk frames delayed by the max. bus load, by CAN interface.");
+    BusLoadBudget::forEach([&out](const string& device, BusLoadBudget& budget)
+    {
+        out << "carsim_paced_frames_total{interface=\"" << device << "\"} " << budget.getDeferredFrames() << '\n';
+    });
+
+    out.flags(flags);
+    out.fill(fillCharacter);
+}
+
+/**
+ * Writes the request table entries which were never hit, one per line after
+ * a line naming the ECU, the table and the session, e.g. to clean up captured
+ * tables. The tables shared by several transports of a script are written
+ * once, with the first ECU using them.
+ *
+ * @param out: the stream to write to
+ */
+void Metrics::writeUnusedRequests(ostream& out) const
+{
+    lock_guard<mutex> lock(ecusMutex_);
+    set<const RequestHitStatistics*> visited;
+    for (const unique_ptr<EcuMetrics>& pEcu : ecus_)
+    {
+        const shared_ptr<const RequestHitStatistics> pRequestHits = pEcu->getRequestHits();
+        if (!pRequestHits || !visited.insert(pRequestHits.get()).second)
+        {
+            continue;
+        }
+        for (const RequestHitStatistics::Table& table : *pRequestHits->getTables())
+        {
+            out << "# " << pEcu->getTransport() << ' ' << pEcu->getEcu() << ' ' << table.name;
+            if (!table.session.empty())
+            {
+                out << ' ' << table.session;
+            }
+            out << '\n';
+            for (size_t i = 0; i < table.keys.size(); ++i)
+            {
+                if (table.pCounters->get(i) == 0)
+                {
+                    out << table.keys[i] << '\n';
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Starts a background thread answering every HTTP request on the given port
+ * with the current metrics.
+ *
+ * @param port: the TCP port to listen on
+ * @return 0 on success, otherwise a negative value
+ * @see Metrics::stopEndpoint()
+ */
+int Metrics::startEndpoint(uint16_t port) noexcept
+{
+    if (isEndpointRunning_)
+    {
+        LOG_ERROR(__func__ << "() Metrics endpoint is already running!");
+        return -1;
+    }
+
+    const int skt = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (skt < 0)
+    {
+        LOG_ERROR(__func__ << "() socket: " << strerror(errno));
+        return -2;
+    }
+    const int enable = 1;
+    setsockopt(skt, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(skt, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0
+        || listen(skt, 8) < 0)
+    {
+        LOG_ERROR(__func__ << "() bind: " << strerror(errno));
+        close(skt);
+        return -3;
+    }
+    stop_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (stop_fd_ < 0)
+    {
+        LOG_ERROR(__func__ << "() eventfd: " << strerror(errno));
+        close(skt);
+        return -4;
+    }
+
+    listen_skt_ = skt;
+    isEndpointRunning_ = true;
+    endpointThread_ = thread(&Metrics::serveEndpoint, this);
+    LOG_INFO("Metrics endpoint listening on port " << dec << port);
+    return 0;
+}
+
+void Metrics::stopEndpoint() noexcept
+{
+    if (!isEndpointRunning_.exchange(false))
+    {
+        return;
+    }
+    const uint64_t value = 1;
+    if (write(stop_fd_, &value, sizeof(value)) < 0)
+    {
+        LOG_ERROR(__func__ << "() write: " << strerror(errno));
+    }
+    if (endpointThread_.joinable())
+    {
+        endpointThread_.join();
+    }
+    close(listen_skt_);
+    close(stop_fd_);
+    listen_skt_ = -1;
+    stop_fd_ = -1;
+}
+
+void Metrics::serveEndpoint() noexcept
+{
+    struct pollfd fds[2] = {{stop_fd_, POLLIN, 0}, {listen_skt_, POLLIN, 0}};
+    while (isEndpointRunning_)
+    {
+        if (poll(fds, 2, -1) <= 0)
+        {
+            continue;
+        }
+        if (fds[0].revents != 0)
+        {
+            break;
+        }
+        const int client = accept4(listen_skt_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0)
+        {
+            continue;
+        }
+
+        // only the path of the request line matters: `/ready`, `/unused` or the metrics
+        const struct timeval timeout = {1, 0};
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        char request[1024];
+        const ssize_t length = recv(client, request, sizeof(request), 0);
+        if (length >= 0)
+        {
+            const string requestLine(request, size_t(length));
+            string status = "200 OK";
+            ostringstream body;
+            if (requestLine.compare(0, 11, "GET /ready ") == 0)
+            {
+                const bool ready = isReady();
+                if (!ready)
+                {
+                    status = "503 Service Unavailable";
+                }
+                body << (ready ? "ready " : "loading ") << loadedConfigs_ << '/' << configCount_ << '\n';
+            }
+            else if (requestLine.compare(0, 12, "GET /unused ") == 0)
+            {
+                writeUnusedRequests(body);
+            }
+            else
+            {
+                writePrometheus(body);
+            }
+            const string content = body.str();
+            const string response = "HTTP/1.0 " + status + "\r\n"
+                "Content-Type: text/plain; version=0.0.4\r\n"
+                "Content-Length: " + to_string(content.size()) + "\r\n"
+                "Connection: close\r\n\r\n" + content;
+            size_t offset = 0;
+            while (offset < response.size())
+            {
+                const ssize_t written = send(client, response.data() + offset,
+                                             response.size() - offset, MSG_NOSIGNAL);
+                if (written <= 0)
+                {
+                    break;
+                }
+                offset += size_t(written);
+            }
+        }
+        close(client);
+    }
+}
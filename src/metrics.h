@@ -0,0 +1,222 @@
+/**
+ * @file metrics.h
+ *
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "lua_memory_pool.h"
+#include "request_hit_counters.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+/// max. time between the end of the request and the start of the response
+constexpr std::chrono::microseconds P2_SERVER_MAX(50000);
+
+/**
+ * Latency histogram with a bounded relative error, similar to a HdrHistogram:
+ * values below `SUB_BUCKETS` get a bucket of their own, above each power of 2
+ * is divided into `SUB_BUCKETS` buckets of the same width, so the error is at
+ * most 1 / `SUB_BUCKETS` (12.5 %). The values are microseconds, values beyond
+ * 2^32 µs (~71 min) end up in the last bucket.
+ *
+ * Recording is a single relaxed atomic increment (plus the sum and max), so
+ * the histogram can be shared by all threads without locking.
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr unsigned SUB_BUCKET_BITS = 3;
+    static constexpr std::size_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    static constexpr unsigned MAX_MAGNITUDE = 31;
+    static constexpr std::size_t BUCKET_COUNT =
+        SUB_BUCKETS + (MAX_MAGNITUDE - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    LatencyHistogram() = default;
+    LatencyHistogram(const LatencyHistogram& orig) = delete;
+    LatencyHistogram& operator =(const LatencyHistogram& orig) = delete;
+
+    void record(std::uint64_t valueUs) noexcept;
+    void record(std::chrono::steady_clock::duration duration) noexcept;
+
+    std::uint64_t getCount() const noexcept;
+    std::uint64_t getSumUs() const noexcept;
+    std::uint64_t getMaxUs() const noexcept;
+    std::uint64_t getCountAtOrBelow(std::uint64_t valueUs) const noexcept;
+    std::uint64_t getValueAtQuantile(double quantile) const noexcept;
+
+    static std::size_t getBucketIndex(std::uint64_t valueUs) noexcept;
+    static std::uint64_t getBucketUpperBound(std::size_t index) noexcept;
+
+private:
+    std::array<std::atomic<std::uint64_t>, BUCKET_COUNT> buckets_{};
+    std::atomic<std::uint64_t> count_{0};
+    std::atomic<std::uint64_t> sumUs_{0};
+    std::atomic<std::uint64_t> maxUs_{0};
+};
+
+/**
+ * The priority class a request is proceeded in, see `UdsReceiver`. Requests
+ * which need no Lua (e.g. `TesterPresent`, `DiagnosticSessionControl` and the
+ * negative responses) are answered right away by the receiving thread, the
+ * Lua functions are queued on the Lua worker of the ECU.
+ */
+enum class DispatchLane : std::uint8_t
+{
+    HIGH,
+    LOW
+};
+
+constexpr std::size_t DISPATCH_LANE_COUNT = 2;
+
+/**
+ * The counters and latencies of one service (SID) of an ECU.
+ */
+struct ServiceMetrics
+{
+    std::atomic<std::uint64_t> requests{0};
+    std::atomic<std::uint64_t> negativeResponses{0};
+    std::atomic<std::uint64_t> wildcardMatches{0};
+    std::atomic<std::uint64_t> p2Violations{0}; ///< responses slower than `P2_SERVER_MAX`
+    LatencyHistogram responseLatency; ///< from reading the request to sending the response
+    LatencyHistogram lookupLatency; ///< time spent to find the response
+    LatencyHistogram luaLatency; ///< time spent in Lua functions
+};
+
+/**
+ * The metrics of one simulated ECU. The services are allocated on their first
+ * request, so an ECU only pays for the SIDs it actually receives.
+ */
+class EcuMetrics
+{
+public:
+    EcuMetrics(const std::string& transport, std::uint32_t address);
+    EcuMetrics(const EcuMetrics& orig) = delete;
+    EcuMetrics& operator =(const EcuMetrics& orig) = delete;
+    virtual ~EcuMetrics();
+
+    const std::string& getTransport() const noexcept { return transport_; }
+    const std::string& getEcu() const noexcept { return ecu_; }
+
+    ServiceMetrics* getService(std::uint8_t sid) noexcept;
+    const ServiceMetrics* findService(std::uint8_t sid) const noexcept;
+
+    std::atomic<std::uint64_t> sendRetries{0};
+    std::atomic<std::uint64_t> droppedFrames{0};
+    /// requests answered with `7F SID 21` since too many Lua requests were queued
+    std::atomic<std::uint64_t> overloadResponses{0};
+    std::atomic<bool> isReady{false}; ///< set once the ECU handles requests
+    /// by `DispatchLane`, the time from reading a request until the lane proceeds it
+    std::array<LatencyHistogram, DISPATCH_LANE_COUNT> queueLatency;
+
+    void setLuaMemory(std::shared_ptr<const LuaMemoryStatistics> pLuaMemory) noexcept;
+    std::shared_ptr<const LuaMemoryStatistics> getLuaMemory() const noexcept;
+    void setRequestHits(std::shared_ptr<const RequestHitStatistics> pRequestHits) noexcept;
+    std::shared_ptr<const RequestHitStatistics> getRequestHits() const noexcept;
+
+private:
+    std::string transport_; ///< e.g. "uds" or "doip"
+    std::string ecu_; ///< the CAN ID or the logical address in hex
+    std::array<std::atomic<ServiceMetrics*>, 256> services_{};
+    /// the memory of the Lua states of the ECU, `nullptr` if not set, accessed atomically
+    std::shared_ptr<const LuaMemoryStatistics> pLuaMemory_;
+    /// the hits of the request table entries, `nullptr` if not set, accessed atomically
+    std::shared_ptr<const RequestHitStatistics> pRequestHits_;
+};
+
+/**
+ * Measures one request, from reading it until the response is sent. Create it
+ * on the stack of the receiving thread:
+ *
+ *     RequestTimer timer(pMetrics_, buffer[0], getReceiveTime());
+ *     const RequestResponse *response = pRequestMatcher->match(buffer, num_bytes, &isWildcard);
+ *     timer.lookupFinished(isWildcard);
+ *     timer.dispatched(DispatchLane::HIGH);
+ *     ...
+ *     timer.responseSent(response, length);
+ *
+ * All functions do nothing if there are no metrics (i.e. `nullptr`). A request
+ * answered by another thread takes the timer along by moving it, the moved
+ * from timer records nothing.
+ */
+class RequestTimer
+{
+public:
+    RequestTimer(EcuMetrics* pMetrics, std::uint8_t sid,
+                 std::chrono::steady_clock::time_point receivedAt) noexcept;
+    RequestTimer(RequestTimer&& orig) noexcept;
+    RequestTimer(const RequestTimer& orig) = delete;
+    RequestTimer& operator =(const RequestTimer& orig) = delete;
+    ~RequestTimer() = default;
+
+    void lookupFinished(bool isWildcard) noexcept;
+    void dispatched(DispatchLane lane) noexcept;
+    void luaStarted() noexcept;
+    void luaFinished() noexcept;
+    void responseSent(const std::uint8_t* response, std::size_t length) noexcept;
+
+private:
+    EcuMetrics* pMetrics_;
+    ServiceMetrics* pService_;
+    std::chrono::steady_clock::time_point receivedAt_;
+    std::chrono::steady_clock::time_point luaStartedAt_;
+    std::chrono::steady_clock::duration luaTime_{0};
+    bool isLookupRecorded_ = false;
+    bool isResponseRecorded_ = false;
+};
+
+/**
+ * The registry of the metrics of all ECUs. The metrics are written in the
+ * Prometheus text format, either by `writePrometheus()` or by a minimal HTTP
+ * endpoint started with `startEndpoint()` (`curl localhost:9100/metrics`).
+ *
+ * The endpoint also answers `/ready` with 200 once all configurations are
+ * loaded (see `setConfigCount()`) and with 503 before, so a test rack can
+ * wait for the simulator instead of sleeping, and `/unused` with the request
+ * table entries which were never hit, see `writeUnusedRequests()`.
+ */
+class Metrics
+{
+public:
+    static Metrics& getInstance();
+
+    Metrics() = default;
+    Metrics(const Metrics& orig) = delete;
+    Metrics& operator =(const Metrics& orig) = delete;
+    virtual ~Metrics();
+
+    EcuMetrics* registerEcu(const std::string& transport, std::uint32_t address);
+    void writePrometheus(std::ostream& out) const;
+    void writeUnusedRequests(std::ostream& out) const;
+
+    void setConfigCount(std::size_t count) noexcept;
+    void configLoaded() noexcept;
+    bool isReady() const noexcept;
+
+    int startEndpoint(std::uint16_t port) noexcept;
+    void stopEndpoint() noexcept;
+
+private:
+    mutable std::mutex ecusMutex_;
+    std::list<std::unique_ptr<EcuMetrics>> ecus_; ///< never removed, the pointers stay valid
+    int listen_skt_ = -1;
+    int stop_fd_ = -1; ///< wakes up the endpoint thread, see `stopEndpoint()`
+    std::atomic<std::size_t> configCount_{0};
+    std::atomic<std::size_t> loadedConfigs_{0};
+    std::atomic<bool> isEndpointRunning_{false};
+    std::thread endpointThread_;
+
+    void serveEndpoint() noexcept;
+};
+
+#endif /* METRICS_H */
@@ -0,0 +1,229 @@
+/**
+ * @file obd_service.cpp
+ *
+ * The native OBD modes 0x01 and 0x09, see `ObdService`.
+ */
+
+#include "obd_service.h"
+#include "logger.h"
+
+using namespace std;
+
+/**
+ * The NumberOfDataItems of the mode 0x09 InfoTypes on CAN (ISO 15031-5),
+ * which precedes the data.
+ *
+ * @return nothing if the InfoType has no NumberOfDataItems
+ */
+static optional<uint8_t> getNumberOfDataItems(uint8_t infoType, size_t length) noexcept
+{
+    switch (infoType)
+    {
+        case 0x02: // VIN
+        case 0x0A: // ECUNAME
+            return uint8_t(1);
+        case 0x04: // CALID, 16 bytes each
+            return uint8_t((length + 15) / 16);
+        case 0x06: // CVN, 4 bytes each
+            return uint8_t((length + 3) / 4);
+        case 0x08: // IPT, 2 bytes each
+        case 0x0B:
+            return uint8_t((length + 1) / 2);
+        default:
+            return {};
+    }
+}
+
+/**
+ * @return true if the SID is a mode served by `ObdService`
+ */
+bool ObdService::isObdRequest(uint8_t sid) noexcept
+{
+    return sid == OBD_CURRENT_DATA_REQ || sid == OBD_VEHICLE_INFORMATION_REQ;
+}
+
+/**
+ * Builds the records of all PIDs and the "supported PIDs" bitmaps.
+ *
+ * @param pids: the PIDs of the `OBD` table
+ * @param function: calls the Lua PIDs
+ */
+ObdService::ObdService(const vector<ObdPidConfiguration>& pids, PidFunction function)
+: function_(move(function))
+{
+    for (const ObdPidConfiguration& configuration : pids)
+    {
+        Records* pRecords = configuration.mode == OBD_CURRENT_DATA_REQ ? &currentData_
+                          : configuration.mode == OBD_VEHICLE_INFORMATION_REQ ? &vehicleInformation_
+                          : nullptr;
+        if (pRecords == nullptr)
+        {
+            LOG_WARNING("Ignoring OBD PID of the unsupported mode " << hex << int(configuration.mode));
+            continue;
+        }
+        if (isSupportedPidsPid(configuration.pid))
+        {
+            LOG_WARNING("Ignoring OBD PID " << hex << int(configuration.mode) << " " << int(configuration.pid)
+                        << ", the supported PIDs are calculated");
+            continue;
+        }
+        Record& record = (*pRecords)[configuration.pid];
+        record.isSupported = true;
+        record.isLuaFunction = configuration.isLuaFunction;
+        record.pSignals = configuration.pSignals;
+        record.bytes.assign({configuration.pid});
+        if (configuration.isLuaFunction || configuration.pSignals)
+        {
+            continue;
+        }
+        if (configuration.mode == OBD_VEHICLE_INFORMATION_REQ)
+        {
+            const optional<uint8_t> items = getNumberOfDataItems(configuration.pid, configuration.data.size());
+            if (items)
+            {
+                record.bytes.push_back(*items);
+            }
+        }
+        record.bytes.insert(record.bytes.cend(), configuration.data.cbegin(), configuration.data.cend());
+    }
+    computeSupportedPids(currentData_);
+    computeSupportedPids(vehicleInformation_);
+}
+
+/**
+ * `01 PID [PID]*` respectively `09 InfoType`, answered with `41 PID data
+ * [PID data]*` respectively `49 InfoType [NumberOfDataItems] data`.
+ *
+ * @param response: replaced by the response, empty if nothing shall be sent
+ */
+void ObdService::proceedRequest(const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    response.clear();
+    const uint8_t mode = request[0];
+    if (length < 2 || length > 1 + MAX_OBD_PIDS_PER_REQUEST || getRecords(mode) == nullptr)
+    {
+        return;
+    }
+    if (mode == OBD_VEHICLE_INFORMATION_REQ && length > 2)
+    {
+        // only the supported InfoTypes may be requested together
+        for (size_t i = 1; i < length; ++i)
+        {
+            if (!isSupportedPidsPid(request[i]))
+            {
+                return;
+            }
+        }
+    }
+
+    response.push_back(uint8_t(mode + 0x40));
+    for (size_t i = 1; i < length; ++i)
+    {
+        appendRecord(mode, request[i], response);
+    }
+    if (response.size() == 1)
+    {
+        response.clear();
+    }
+}
+
+/**
+ * @param mode: 0x01 or 0x09
+ * @param pid: the PID respectively the InfoType
+ * @return true if the PID is answered, including the "supported PIDs"
+ */
+bool ObdService::isSupported(uint8_t mode, uint8_t pid) const noexcept
+{
+    const Records* pRecords = getRecords(mode);
+    return pRecords != nullptr && (*pRecords)[pid].isSupported;
+}
+
+/**
+ * Builds the bitmaps of the PIDs 0x00, 0x20, ..., 0xE0. The bitmap of PID `n`
+ * covers the PIDs `n + 0x01` to `n + 0x20`, the last of them is the next
+ * bitmap, which is supported if any PID above it is supported.
+ */
+void ObdService::computeSupportedPids(Records& records)
+{
+    // from the top, so the next bitmap is known when the previous one is built
+    bool hasHigherPid = false;
+    for (int base = 0xE0; base >= 0x00; base -= 0x20)
+    {
+        uint32_t bitmap = 0;
+        for (int offset = 1; offset <= 0x20; ++offset)
+        {
+            const int pid = base + offset;
+            if (pid <= 0xFF && records[size_t(pid)].isSupported)
+            {
+                bitmap |= 1u << (0x20 - offset);
+            }
+        }
+        const bool hasPid = bitmap != 0 || hasHigherPid;
+        Record& record = records[size_t(base)];
+        record.isSupported = hasPid;
+        record.isLuaFunction = false;
+        record.pSignals.reset();
+        record.bytes.clear();
+        if (hasPid)
+        {
+            record.bytes.assign({uint8_t(base), uint8_t(bitmap >> 24), uint8_t(bitmap >> 16),
+                                 uint8_t(bitmap >> 8), uint8_t(bitmap)});
+        }
+        hasHigherPid = hasPid;
+    }
+}
+
+const ObdService::Records* ObdService::getRecords(uint8_t mode) const noexcept
+{
+    switch (mode)
+    {
+        case OBD_CURRENT_DATA_REQ:
+            return &currentData_;
+        case OBD_VEHICLE_INFORMATION_REQ:
+            return &vehicleInformation_;
+        default:
+            return nullptr;
+    }
+}
+
+/**
+ * Appends the record of a PID to the response.
+ *
+ * @return false if the PID is not supported or its Lua function failed
+ */
+bool ObdService::appendRecord(uint8_t mode, uint8_t pid, vector<uint8_t>& response) const
+{
+    const Record& record = (*getRecords(mode))[pid];
+    if (!record.isSupported)
+    {
+        return false;
+    }
+    if (record.pSignals)
+    {
+        response.push_back(pid);
+        record.pSignals->append(response);
+        return true;
+    }
+    if (!record.isLuaFunction)
+    {
+        response.insert(response.cend(), record.bytes.cbegin(), record.bytes.cend());
+        return true;
+    }
+
+    const optional<vector<uint8_t>> data = function_ ? function_(mode, pid) : nullopt;
+    if (!data || data->empty())
+    {
+        return false;
+    }
+    response.push_back(pid);
+    if (mode == OBD_VEHICLE_INFORMATION_REQ)
+    {
+        const optional<uint8_t> items = getNumberOfDataItems(pid, data->size());
+        if (items)
+        {
+            response.push_back(*items);
+        }
+    }
+    response.insert(response.cend(), data->cbegin(), data->cend());
+    return true;
+}
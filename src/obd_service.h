@@ -0,0 +1,94 @@
+/**
+ * @file obd_service.h
+ *
+ */
+
+#ifndef OBD_SERVICE_H
+#define OBD_SERVICE_H
+
+#include "uds_service_handler.h"
+#include "vehicle_signals.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+constexpr std::uint8_t OBD_CURRENT_DATA_REQ = 0x01;
+constexpr std::uint8_t OBD_CURRENT_DATA_RES = 0x41;
+constexpr std::uint8_t OBD_VEHICLE_INFORMATION_REQ = 0x09;
+constexpr std::uint8_t OBD_VEHICLE_INFORMATION_RES = 0x49;
+constexpr std::size_t MAX_OBD_PIDS_PER_REQUEST = 6;
+
+/**
+ * One PID of the `OBD` table of the ECU.
+ */
+struct ObdPidConfiguration
+{
+    std::uint8_t mode = OBD_CURRENT_DATA_REQ; ///< 0x01 or 0x09
+    std::uint8_t pid = 0x00; ///< the PID respectively the InfoType of mode 0x09
+    bool isLuaFunction = false; ///< true if the data is returned by a Lua function on every request
+    std::vector<std::uint8_t> data; ///< the static data, without the PID
+    std::shared_ptr<const SignalRecord> pSignals; ///< encodes the data from the vehicle signals, if set
+};
+
+/**
+ * The OBD services "show current data" (mode 0x01) and "request vehicle
+ * information" (mode 0x09) of an ECU.
+ *
+ * The responses are assembled from byte records (PID + data) built once on
+ * construction, one table of 256 records per mode, so a request is served
+ * with an array lookup per PID. Only Lua PIDs call their function per request,
+ * the PIDs of the `Signals` table are encoded natively per request.
+ * The "supported PIDs" bitmaps (PID 0x00, 0x20, ..., 0xE0) are precomputed
+ * from the configured PIDs.
+ *
+ * A mode 0x01 request may contain up to 6 PIDs, the records of all supported
+ * PIDs are concatenated into one response. A mode 0x09 request contains one
+ * InfoType or up to 6 "supported InfoTypes" PIDs. As required for the
+ * functional OBD requests, nothing is answered if no requested PID is
+ * supported.
+ */
+class ObdService : public UdsServiceHandler
+{
+public:
+    /// returns the data of a Lua PID or nothing on error
+    using PidFunction = std::function<std::optional<std::vector<std::uint8_t>>(std::uint8_t mode, std::uint8_t pid)>;
+
+    static bool isObdRequest(std::uint8_t sid) noexcept;
+
+    ObdService(const std::vector<ObdPidConfiguration>& pids, PidFunction function);
+    ObdService(const ObdService& orig) = delete;
+    ObdService& operator =(const ObdService& orig) = delete;
+    virtual ~ObdService() = default;
+
+    void proceedRequest(const std::uint8_t* request, std::size_t length,
+                        std::vector<std::uint8_t>& response) override;
+    bool hasSubFunction(std::uint8_t sid) const noexcept override { return false; }
+
+    bool isSupported(std::uint8_t mode, std::uint8_t pid) const noexcept;
+
+private:
+    struct Record
+    {
+        bool isSupported = false;
+        bool isLuaFunction = false;
+        std::vector<std::uint8_t> bytes; ///< the PID followed by the data, only the PID for Lua PIDs
+        std::shared_ptr<const SignalRecord> pSignals; ///< encoded on every request, if set
+    };
+
+    using Records = std::array<Record, 256>;
+
+    const PidFunction function_;
+    Records currentData_; ///< mode 0x01
+    Records vehicleInformation_; ///< mode 0x09
+
+    static bool isSupportedPidsPid(std::uint8_t pid) noexcept { return (pid & 0x1F) == 0x00; }
+    static void computeSupportedPids(Records& records);
+    const Records* getRecords(std::uint8_t mode) const noexcept;
+    bool appendRecord(std::uint8_t mode, std::uint8_t pid, std::vector<std::uint8_t>& response) const;
+};
+
+#endif /* OBD_SERVICE_H */
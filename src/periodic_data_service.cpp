@@ -0,0 +1,424 @@
+/**
+ * @file periodic_data_service.cpp
+ *
+ * The periodic transmission of data identifiers, see `PeriodicDataService`.
+ */
+
+#include "periodic_data_service.h"
+#include "service_identifier.h"
+#include "logger.h"
+#include "simulation_clock.h"
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+using namespace std;
+
+static void setNegativeResponse(vector<uint8_t>& response, uint8_t sid, uint8_t nrc)
+{
+    response.assign({ERROR, sid, nrc});
+}
+
+/**
+ * @param configuration: the CAN ID and the rates
+ * @param pSessionCtrl: the session of the ECU, `nullptr` for the default session only
+ * @param reader: reads the data identifiers, called from the thread of the
+ *                request and the wheel thread
+ * @param sender: sends the periodic messages, called from the wheel thread
+ */
+PeriodicDataService::PeriodicDataService(const PeriodicDataConfiguration& configuration,
+                                         SessionController* pSessionCtrl,
+                                         DataReader reader, Sender sender)
+: configuration_(configuration)
+, pSessionCtrl_(pSessionCtrl)
+, reader_(move(reader))
+, sender_(move(sender))
+, timer_(TimerWheel::getInstance(), [this]() { expired(); })
+{
+    rates_[0].period = configuration.slowRate;
+    rates_[1].period = configuration.mediumRate;
+    rates_[2].period = configuration.fastRate;
+    due_.reserve(MAX_PERIODIC_DATA_IDENTIFIERS);
+    frames_.reserve(MAX_PERIODIC_DATA_IDENTIFIERS);
+    data_.reserve(CAN_MAX_DLEN);
+}
+
+/**
+ * Destructor. Stops the timer before this object is destroyed, since the
+ * timer calls `expired()`.
+ */
+PeriodicDataService::~PeriodicDataService()
+{
+    timer_.cancel();
+}
+
+/**
+ * `2A transmissionMode [periodicDataIdentifier]*`, answered with `6A`.
+ * Already scheduled identifiers are moved to the requested rate. Unknown
+ * identifiers and identifiers with more than 7 data bytes are skipped, if
+ * none of them is known `7F 2A 31` is sent.
+ */
+void PeriodicDataService::proceedRequest(const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    if (length < 2)
+    {
+        setNegativeResponse(response, READ_DATA_BY_IDENTIFIER_PERIODIC_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+
+    const uint8_t mode = request[1];
+    if (mode == STOP_SENDING)
+    {
+        if (length == 2)
+        {
+            stopAll();
+        }
+        else
+        {
+            lock_guard<mutex> lock(mutex_);
+            for (size_t i = 2; i < length; ++i)
+            {
+                unschedule(request[i]);
+            }
+        }
+        response.assign({READ_DATA_BY_IDENTIFIER_PERIODIC_RES});
+        return;
+    }
+    if (mode < SEND_AT_SLOW_RATE || mode > SEND_AT_FAST_RATE)
+    {
+        setNegativeResponse(response, READ_DATA_BY_IDENTIFIER_PERIODIC_REQ, REQUEST_OUT_OF_RANGE);
+        return;
+    }
+    if (length < 3)
+    {
+        setNegativeResponse(response, READ_DATA_BY_IDENTIFIER_PERIODIC_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+
+    // read outside of the lock, a Lua function must not block the wheel thread
+    const UdsSession session = getCurrentSession();
+    vector<uint8_t> identifiers;
+    vector<uint8_t> data;
+    for (size_t i = 2; i < length; ++i)
+    {
+        struct can_frame frame;
+        if (readFrame(session, request[i], data, frame) &&
+            find(identifiers.cbegin(), identifiers.cend(), request[i]) == identifiers.cend())
+        {
+            identifiers.push_back(request[i]);
+        }
+    }
+    if (identifiers.empty())
+    {
+        setNegativeResponse(response, READ_DATA_BY_IDENTIFIER_PERIODIC_REQ, REQUEST_OUT_OF_RANGE);
+        return;
+    }
+
+    lock_guard<mutex> lock(mutex_);
+    if (session != session_)
+    {
+        // the identifiers of the previous session are not sent anymore
+        for (Rate& rate : rates_)
+        {
+            rate.identifiers.clear();
+        }
+        session_ = session;
+    }
+    size_t count = countScheduled();
+    for (uint8_t identifier : identifiers)
+    {
+        count += isScheduled(identifier) ? 0 : 1;
+    }
+    if (count > MAX_PERIODIC_DATA_IDENTIFIERS)
+    {
+        setNegativeResponse(response, READ_DATA_BY_IDENTIFIER_PERIODIC_REQ, REQUEST_OUT_OF_RANGE);
+        return;
+    }
+    for (uint8_t identifier : identifiers)
+    {
+        unschedule(identifier);
+    }
+
+    const auto now = SimulationClock::getInstance().now();
+    Rate& rate = rates_[mode - SEND_AT_SLOW_RATE];
+    if (rate.identifiers.empty())
+    {
+        // the first message is sent immediately
+        rate.deadline = now;
+    }
+    rate.identifiers.insert(rate.identifiers.cend(), identifiers.cbegin(), identifiers.cend());
+    scheduleNext(now);
+    response.assign({READ_DATA_BY_IDENTIFIER_PERIODIC_RES});
+}
+
+/**
+ * Stops sending all periodic identifiers. Does not wait for a running
+ * transmission, so it may be called while holding a lock the reader takes.
+ */
+void PeriodicDataService::stopAll() noexcept
+{
+    lock_guard<mutex> lock(mutex_);
+    for (Rate& rate : rates_)
+    {
+        rate.identifiers.clear();
+    }
+}
+
+/**
+ * @return the number of scheduled periodic identifiers of all rates
+ */
+size_t PeriodicDataService::getScheduledCount() const
+{
+    lock_guard<mutex> lock(mutex_);
+    return countScheduled();
+}
+
+/**
+ * @return the number of sent periodic messages
+ */
+uint64_t PeriodicDataService::getSentCount() const
+{
+    lock_guard<mutex> lock(mutex_);
+    return sentCount_;
+}
+
+/**
+ * Reads the data identifier of a periodic identifier into a frame.
+ *
+ * @param data: the buffer of the read data
+ * @return false if the identifier is unknown or its data does not fit into a frame
+ */
+bool PeriodicDataService::readFrame(UdsSession session, uint8_t identifier, vector<uint8_t>& data,
+                                    struct can_frame& frame)
+{
+    data.clear();
+    if (!reader_(session, uint16_t(PERIODIC_DATA_IDENTIFIER_BASE | identifier), data) || data.empty())
+    {
+        return false;
+    }
+    if (data.size() > CAN_MAX_DLEN - 1)
+    {
+        LOG_WARNING("Periodic identifier 0x" << hex << int(identifier) << " exceeds a single frame: "
+                    << dec << data.size() << " bytes");
+        return false;
+    }
+    frame = {};
+    frame.can_id = configuration_.responseId > CAN_SFF_MASK
+                   ? (configuration_.responseId | CAN_EFF_FLAG)
+                   : configuration_.responseId;
+    frame.can_dlc = uint8_t(1 + data.size());
+    frame.data[0] = identifier;
+    memcpy(&frame.data[1], data.data(), data.size());
+    return true;
+}
+
+void PeriodicDataService::unschedule(uint8_t identifier) noexcept
+{
+    for (Rate& rate : rates_)
+    {
+        auto iter = find(rate.identifiers.begin(), rate.identifiers.end(), identifier);
+        if (iter != rate.identifiers.end())
+        {
+            rate.identifiers.erase(iter);
+        }
+    }
+}
+
+bool PeriodicDataService::isScheduled(uint8_t identifier) const noexcept
+{
+    for (const Rate& rate : rates_)
+    {
+        if (find(rate.identifiers.cbegin(), rate.identifiers.cend(), identifier) != rate.identifiers.cend())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t PeriodicDataService::countScheduled() const noexcept
+{
+    size_t count = 0;
+    for (const Rate& rate : rates_)
+    {
+        count += rate.identifiers.size();
+    }
+    return count;
+}
+
+/**
+ * Arms the timer with the earliest deadline, must be called with the lock held.
+ */
+void PeriodicDataService::scheduleNext(chrono::steady_clock::time_point now) noexcept
+{
+    const Rate* pNext = nullptr;
+    for (const Rate& rate : rates_)
+    {
+        if (!rate.identifiers.empty() && (pNext == nullptr || rate.deadline < pNext->deadline))
+        {
+            pNext = &rate;
+        }
+    }
+    if (pNext == nullptr)
+    {
+        return;
+    }
+    const auto delay = chrono::ceil<chrono::milliseconds>(pNext->deadline - now);
+    timer_.schedule(max(delay, chrono::milliseconds(0)));
+}
+
+UdsSession PeriodicDataService::getCurrentSession() const noexcept
+{
+    return pSessionCtrl_ != nullptr ? pSessionCtrl_->getCurrentUdsSession() : UdsSession::DEFAULT;
+}
+
+/**
+ * Called by the wheel thread at the earliest deadline. Sends the identifiers
+ * of all rates which are due as one batch.
+ */
+void PeriodicDataService::expired() noexcept
+{
+    const auto now = SimulationClock::getInstance().now();
+    UdsSession session;
+    due_.clear();
+    {
+        lock_guard<mutex> lock(mutex_);
+        if (getCurrentSession() != session_)
+        {
+            LOG_DEBUG("Session changed, periodic transmission stopped");
+            for (Rate& rate : rates_)
+            {
+                rate.identifiers.clear();
+            }
+            return;
+        }
+        for (Rate& rate : rates_)
+        {
+            if (rate.identifiers.empty() || rate.deadline > now)
+            {
+                continue;
+            }
+            due_.insert(due_.cend(), rate.identifiers.cbegin(), rate.identifiers.cend());
+            rate.deadline += rate.period;
+            if (rate.deadline <= now)
+            {
+                // skip the missed periods instead of sending a burst
+                const auto missed = (now - rate.deadline) / rate.period + 1;
+                rate.deadline += missed * rate.period;
+            }
+        }
+        session = session_;
+        scheduleNext(now);
+    }
+
+    frames_.clear();
+    for (uint8_t identifier : due_)
+    {
+        struct can_frame frame;
+        if (readFrame(session, identifier, data_, frame))
+        {
+            frames_.push_back(frame);
+        }
+    }
+    if (frames_.empty())
+    {
+        return;
+    }
+    sender_(frames_.data(), frames_.size());
+    lock_guard<mutex> lock(mutex_);
+    sentCount_ += frames_.size();
+}
+
+/**
+ * @param device: the CAN device (e.g. "vcan0")
+ */
+CanFrameSender::CanFrameSender(const string& device)
+: device_(device)
+{
+}
+
+CanFrameSender::~CanFrameSender()
+{
+    closeSender();
+}
+
+/**
+ * Opens a non-blocking raw CAN socket, which does not receive any frames.
+ *
+ * @return 0 on success, otherwise a negative value
+ */
+int CanFrameSender::openSender() noexcept
+{
+    int skt = socket(PF_CAN, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, CAN_RAW);
+    if (skt < 0)
+    {
+        LOG_ERROR(__func__ << "() socket: " << strerror(errno));
+        return -1;
+    }
+
+    setsockopt(skt, SOL_CAN_RAW, CAN_RAW_FILTER, nullptr, 0);
+
+    struct ifreq ifr = {};
+    strncpy(ifr.ifr_name, device_.c_str(), IFNAMSIZ - 1);
+    if (ioctl(skt, SIOCGIFINDEX, &ifr) < 0)
+    {
+        LOG_ERROR(__func__ << "() ioctl: " << strerror(errno));
+        close(skt);
+        return -2;
+    }
+
+    struct sockaddr_can addr = {};
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+    if (bind(skt, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        LOG_ERROR(__func__ << "() bind: " << strerror(errno));
+        close(skt);
+        return -3;
+    }
+
+    skt_ = skt;
+    return 0;
+}
+
+void CanFrameSender::closeSender() noexcept
+{
+    if (skt_ >= 0)
+    {
+        close(skt_);
+        skt_ = -1;
+    }
+}
+
+/**
+ * Sends the frames with one `sendmmsg()`. Frames which do not fit into the
+ * socket buffer are dropped, the periodic messages are repeated anyway.
+ */
+void CanFrameSender::sendFrames(const struct can_frame* frames, size_t count) noexcept
+{
+    if (skt_ < 0 || count == 0)
+    {
+        return;
+    }
+    struct mmsghdr messages[MAX_PERIODIC_DATA_IDENTIFIERS] = {};
+    struct iovec iovecs[MAX_PERIODIC_DATA_IDENTIFIERS];
+    count = min(count, MAX_PERIODIC_DATA_IDENTIFIERS);
+    for (size_t i = 0; i < count; ++i)
+    {
+        iovecs[i].iov_base = const_cast<struct can_frame*>(&frames[i]);
+        iovecs[i].iov_len = sizeof(struct can_frame);
+        messages[i].msg_hdr.msg_iov = &iovecs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+    const int result = sendmmsg(skt_, messages, static_cast<unsigned int>(count), MSG_DONTWAIT);
+    if (result < int(count))
+    {
+        LOG_WARNING("Unable to send " << dec << (count - size_t(max(result, 0)))
+                    << " periodic messages: " << strerror(errno));
+    }
+}
@@ -0,0 +1,144 @@
+/**
+ * @file periodic_data_service.h
+ *
+ */
+
+#ifndef PERIODIC_DATA_SERVICE_H
+#define PERIODIC_DATA_SERVICE_H
+
+#include "uds_service_handler.h"
+#include "session_controller.h"
+#include "timer_wheel.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <linux/can.h>
+
+constexpr std::chrono::milliseconds DEFAULT_PERIODIC_SLOW_RATE(1000);
+constexpr std::chrono::milliseconds DEFAULT_PERIODIC_MEDIUM_RATE(200);
+constexpr std::chrono::milliseconds DEFAULT_PERIODIC_FAST_RATE(50);
+constexpr std::size_t MAX_PERIODIC_DATA_IDENTIFIERS = 16; ///< scheduled over all rates
+constexpr std::uint16_t PERIODIC_DATA_IDENTIFIER_BASE = 0xF200; ///< the DID of the periodic identifier 0x00
+
+/**
+ * The periodic identifiers of `ReadDataByPeriodicIdentifier`, see the
+ * `PeriodicData` table of the ECU.
+ */
+struct PeriodicDataConfiguration
+{
+    canid_t responseId = 0; ///< the CAN ID of the periodic messages
+    std::chrono::milliseconds slowRate = DEFAULT_PERIODIC_SLOW_RATE;
+    std::chrono::milliseconds mediumRate = DEFAULT_PERIODIC_MEDIUM_RATE;
+    std::chrono::milliseconds fastRate = DEFAULT_PERIODIC_FAST_RATE;
+};
+
+/**
+ * `ReadDataByPeriodicIdentifier` (0x2A). The periodic identifier `xx` reads
+ * the data identifier `F2xx`. Every scheduled identifier is sent as single CAN
+ * frame `pDID data` (max. 7 data bytes) on the periodic response ID.
+ *
+ * All rates are served by one timer of the `TimerWheel`, armed with the
+ * earliest deadline of the three rates. On expiry the identifiers of all rates
+ * which are due are read and sent as one batch, so no thread is needed. The
+ * next deadline of a rate is the previous one plus its period, missed periods
+ * are skipped.
+ *
+ * The transmission stops with `04` (stopSending), on `stopAll()` (e.g. a
+ * session change or an ECU reset) and if the ECU leaves the session the
+ * identifiers were scheduled in (e.g. the S3 timeout).
+ */
+class PeriodicDataService : public UdsServiceHandler
+{
+public:
+    /// reads a data identifier, returns false if it is unknown
+    using DataReader = std::function<bool(UdsSession session, std::uint16_t dataIdentifier,
+                                          std::vector<std::uint8_t>& data)>;
+    /// sends the frames of one tick, called on the wheel thread
+    using Sender = std::function<void(const struct can_frame* frames, std::size_t count)>;
+
+    /// the `transmissionMode` of the request
+    enum TransmissionMode : std::uint8_t
+    {
+        SEND_AT_SLOW_RATE = 0x01,
+        SEND_AT_MEDIUM_RATE = 0x02,
+        SEND_AT_FAST_RATE = 0x03,
+        STOP_SENDING = 0x04
+    };
+
+    PeriodicDataService(const PeriodicDataConfiguration& configuration, SessionController* pSessionCtrl,
+                        DataReader reader, Sender sender);
+    PeriodicDataService(const PeriodicDataService& orig) = delete;
+    PeriodicDataService& operator =(const PeriodicDataService& orig) = delete;
+    virtual ~PeriodicDataService();
+
+    void proceedRequest(const std::uint8_t* request, std::size_t length,
+                        std::vector<std::uint8_t>& response) override;
+    bool hasSubFunction(std::uint8_t sid) const noexcept override { return false; }
+
+    void stopAll() noexcept;
+    std::size_t getScheduledCount() const;
+    std::uint64_t getSentCount() const;
+
+private:
+    static constexpr std::size_t NUM_RATES = 3;
+
+    struct Rate
+    {
+        std::chrono::milliseconds period;
+        std::chrono::steady_clock::time_point deadline;
+        std::vector<std::uint8_t> identifiers; ///< the scheduled periodic identifiers
+    };
+
+    const PeriodicDataConfiguration configuration_;
+    SessionController* pSessionCtrl_; ///< might be `nullptr`, e.g. for DoIP
+    const DataReader reader_;
+    const Sender sender_;
+
+    mutable std::mutex mutex_;
+    Rate rates_[NUM_RATES];
+    UdsSession session_ = UdsSession::DEFAULT; ///< the session of the scheduled identifiers
+    std::uint64_t sentCount_ = 0;
+
+    // only used by the wheel thread
+    std::vector<std::uint8_t> due_;
+    std::vector<struct can_frame> frames_;
+    std::vector<std::uint8_t> data_;
+
+    TimerWheel::Timer timer_;
+
+    bool readFrame(UdsSession session, std::uint8_t identifier, std::vector<std::uint8_t>& data,
+                   struct can_frame& frame);
+    void unschedule(std::uint8_t identifier) noexcept;
+    bool isScheduled(std::uint8_t identifier) const noexcept;
+    std::size_t countScheduled() const noexcept;
+    void scheduleNext(std::chrono::steady_clock::time_point now) noexcept;
+    UdsSession getCurrentSession() const noexcept;
+    void expired() noexcept;
+};
+
+/**
+ * A raw CAN socket sending the periodic messages of an ECU with one
+ * `sendmmsg()` per batch.
+ */
+class CanFrameSender
+{
+public:
+    explicit CanFrameSender(const std::string& device);
+    CanFrameSender(const CanFrameSender& orig) = delete;
+    CanFrameSender& operator =(const CanFrameSender& orig) = delete;
+    virtual ~CanFrameSender();
+
+    int openSender() noexcept;
+    void closeSender() noexcept;
+    void sendFrames(const struct can_frame* frames, std::size_t count) noexcept;
+
+private:
+    std::string device_;
+    int skt_ = -1;
+};
+
+#endif /* PERIODIC_DATA_SERVICE_H */
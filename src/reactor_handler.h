@@ -0,0 +1,42 @@
+/**
+ * @file reactor_handler.h
+ *
+ */
+
+#ifndef REACTOR_HANDLER_H
+#define REACTOR_HANDLER_H
+
+#include <cstdint>
+
+/**
+ * Interface of a socket that is handled by the `ReceiverReactor`.
+ */
+class ReactorHandler
+{
+public:
+    virtual ~ReactorHandler() = default;
+
+    /**
+     * @return the file descriptor to wait for
+     */
+    virtual int getSocket() const noexcept = 0;
+
+    /**
+     * Called by one of the reactor workers when the socket is ready. A handler
+     * is never called by several workers at the same time.
+     *
+     * @param events: the epoll events that occurred (e.g. `EPOLLIN`)
+     * @return the epoll events to wait for next, 0 to wait until the handler
+     *         is armed again by `ReceiverReactor::rearm()`
+     */
+    virtual std::uint32_t handleEvents(std::uint32_t events) noexcept = 0;
+
+    /**
+     * Called by the reactor after the handler removed itself by calling
+     * `ReceiverReactor::removeHandler()` from `handleEvents()`. The reactor
+     * does not use the handler anymore, so it might be deleted here.
+     */
+    virtual void handlerRemoved() noexcept {}
+};
+
+#endif /* REACTOR_HANDLER_H */
@@ -0,0 +1,155 @@
+/**
+ * @file realtime_profile.cpp
+ *
+ * The memory locking and busy polling of the real-time profile, see
+ * `RealTimeProfile`.
+ */
+
+#include "realtime_profile.h"
+#include "logger.h"
+#include <sys/mman.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+constexpr size_t RealTimeProfile::THREAD_STACK_SIZE;
+constexpr size_t RealTimeProfile::HEAP_RESERVE;
+
+atomic<bool> RealTimeProfile::isMemoryLocked_{false};
+atomic<int64_t> RealTimeProfile::busyPollWindowUs_{0};
+atomic<uint64_t> RealTimeProfile::busyPollHits_{0};
+
+/**
+ * Prepares the process for `lockMemory()`, before any thread is started:
+ * the default stack of new threads is limited to `THREAD_STACK_SIZE` (all of
+ * it is locked), freed memory is not returned to the system (it would be
+ * faulted in again) and `HEAP_RESERVE` of the heap is faulted in.
+ *
+ * @return false if a setting failed, the rest is still applied
+ */
+bool RealTimeProfile::prepare() noexcept
+{
+    bool isPrepared = true;
+    pthread_attr_t attributes;
+    if (pthread_getattr_default_np(&attributes) == 0)
+    {
+        const int result = pthread_attr_setstacksize(&attributes, THREAD_STACK_SIZE) != 0
+            ? EINVAL : pthread_setattr_default_np(&attributes);
+        if (result != 0)
+        {
+            LOG_WARNING("Can not set the stack size of the threads: " << strerror(result));
+            isPrepared = false;
+        }
+        pthread_attr_destroy(&attributes);
+    }
+
+    // all allocations on the heap, which is never trimmed
+    if (mallopt(M_TRIM_THRESHOLD, -1) == 0 || mallopt(M_MMAP_MAX, 0) == 0)
+    {
+        LOG_WARNING("Can not keep the freed memory in the heap");
+        isPrepared = false;
+    }
+    char *pReserve = static_cast<char*> (malloc(HEAP_RESERVE));
+    if (pReserve != nullptr)
+    {
+        const long pageSize = sysconf(_SC_PAGESIZE);
+        for (size_t offset = 0; offset < HEAP_RESERVE; offset += size_t(pageSize))
+        {
+            static_cast<volatile char*> (pReserve)[offset] = 0;
+        }
+        free(pReserve);
+    }
+    return isPrepared;
+}
+
+/**
+ * Locks all current and future pages of the process in memory, which faults
+ * in the current ones. Needs `CAP_IPC_LOCK` or an `RLIMIT_MEMLOCK` of the
+ * size of the process.
+ *
+ * @return false if the memory could not be locked
+ */
+bool RealTimeProfile::lockMemory() noexcept
+{
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0)
+    {
+        LOG_WARNING("Can not lock the memory of the simulator: " << strerror(errno));
+        return false;
+    }
+    isMemoryLocked_ = true;
+    LOG_INFO("Locked the memory of the simulator");
+    return true;
+}
+
+/**
+ * @param window: the time the receiving threads poll their sockets after a
+ *                message before they block, 0 = block immediately
+ */
+void RealTimeProfile::setBusyPollWindow(chrono::microseconds window) noexcept
+{
+    busyPollWindowUs_ = max(int64_t(window.count()), int64_t(0));
+}
+
+/**
+ * @return the spin window of the receiving threads, see `setBusyPollWindow()`
+ */
+chrono::microseconds RealTimeProfile::getBusyPollWindow() noexcept
+{
+    return chrono::microseconds(busyPollWindowUs_.load(memory_order_relaxed));
+}
+
+/**
+ * Waits without timeout for an event of the file descriptors like `::poll()`,
+ * but polls them for the busy poll window before.
+ *
+ * @return the result of `::poll()`
+ */
+int RealTimeProfile::poll(struct pollfd* fds, nfds_t count) noexcept
+{
+    const int64_t windowUs = busyPollWindowUs_.load(memory_order_relaxed);
+    if (windowUs > 0)
+    {
+        const auto end = chrono::steady_clock::now() + chrono::microseconds(windowUs);
+        do
+        {
+            const int result = ::poll(fds, count, 0);
+            if (result != 0)
+            {
+                busyPollHits_.fetch_add(result > 0 ? 1 : 0, memory_order_relaxed);
+                return result;
+            }
+        } while (chrono::steady_clock::now() < end);
+    }
+    return ::poll(fds, count, -1);
+}
+
+/**
+ * Waits without timeout for the events of an epoll instance like
+ * `::epoll_wait()`, but polls it for the busy poll window before.
+ *
+ * @return the result of `::epoll_wait()`
+ */
+int RealTimeProfile::epollWait(int epollFd, struct epoll_event* events, int maxEvents) noexcept
+{
+    const int64_t windowUs = busyPollWindowUs_.load(memory_order_relaxed);
+    if (windowUs > 0)
+    {
+        const auto end = chrono::steady_clock::now() + chrono::microseconds(windowUs);
+        do
+        {
+            const int result = ::epoll_wait(epollFd, events, maxEvents, 0);
+            if (result != 0)
+            {
+                busyPollHits_.fetch_add(result > 0 ? 1 : 0, memory_order_relaxed);
+                return result;
+            }
+        } while (chrono::steady_clock::now() < end);
+    }
+    return ::epoll_wait(epollFd, events, maxEvents, -1);
+}
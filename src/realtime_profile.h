@@ -0,0 +1,56 @@
+/**
+ * @file realtime_profile.h
+ *
+ */
+
+#ifndef REALTIME_PROFILE_H
+#define REALTIME_PROFILE_H
+
+#include <sys/epoll.h>
+#include <poll.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * The opt-in tuning of the simulator for latency-critical timing tests,
+ * which removes the page faults and thread wakeups from the response path.
+ *
+ * `prepare()` is called at startup before any thread is started: it limits
+ * the stacks of the new threads, keeps the freed heap in the process and
+ * prefaults a heap reserve. `lockMemory()` is called once the configurations
+ * are loaded and locks all pages of the process, which faults in the compiled
+ * tables, the snapshot mappings, the Lua arenas and the thread stacks at once.
+ * Pages mapped later (e.g. by a reload) are locked when they are mapped.
+ *
+ * Independent of that, the receiving threads (ISO-TP, J1939 and the reactor)
+ * may busy-poll their sockets for a spin window after every message before
+ * they block, so a following request of a burst (e.g. the consecutive
+ * requests of a tester) does not wait for the wakeup of the thread.
+ */
+class RealTimeProfile
+{
+public:
+    /// the stack size of the threads with a locked memory
+    static constexpr std::size_t THREAD_STACK_SIZE = 2 * 1024 * 1024;
+    /// the heap prefaulted by `prepare()`
+    static constexpr std::size_t HEAP_RESERVE = 32 * 1024 * 1024;
+
+    static bool prepare() noexcept;
+    static bool lockMemory() noexcept;
+    static bool isMemoryLocked() noexcept { return isMemoryLocked_.load(std::memory_order_relaxed); }
+
+    static void setBusyPollWindow(std::chrono::microseconds window) noexcept;
+    static std::chrono::microseconds getBusyPollWindow() noexcept;
+    static std::uint64_t getBusyPollHits() noexcept { return busyPollHits_.load(std::memory_order_relaxed); }
+    static int poll(struct pollfd* fds, nfds_t count) noexcept;
+    static int epollWait(int epollFd, struct epoll_event* events, int maxEvents) noexcept;
+
+private:
+    static std::atomic<bool> isMemoryLocked_;
+    static std::atomic<std::int64_t> busyPollWindowUs_;
+    static std::atomic<std::uint64_t> busyPollHits_; ///< events received while spinning
+};
+
+#endif /* REALTIME_PROFILE_H */
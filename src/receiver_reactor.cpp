@@ -0,0 +1,319 @@
+/**
+ * @file receiver_reactor.cpp
+ *
+ * This file contains the epoll based event loop, which dispatches the events
+ * of all registered ISO-TP receivers and senders to a fixed pool of worker
+ * threads.
+ */
+
+#include "receiver_reactor.h"
+#include "logger.h"
+#include "realtime_profile.h"
+#include "thread_placement.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+/**
+ * Constructor. Creates the epoll instance. The workers are not started until
+ * `start()` is called, but handlers can already be added.
+ */
+ReceiverReactor::ReceiverReactor()
+{
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0)
+    {
+        LOG_ERROR(__func__ << "() epoll_create1: " << strerror(errno));
+        throw exception();
+    }
+
+    stop_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (stop_fd_ < 0)
+    {
+        LOG_ERROR(__func__ << "() eventfd: " << strerror(errno));
+        close(epoll_fd_);
+        throw exception();
+    }
+
+    // level triggered and without `EPOLLONESHOT`, so every worker sees it
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, stop_fd_, &event) < 0)
+    {
+        LOG_ERROR(__func__ << "() epoll_ctl: " << strerror(errno));
+        close(stop_fd_);
+        close(epoll_fd_);
+        throw exception();
+    }
+}
+
+/**
+ * Destructor. Stops the workers and closes the epoll instance. The registered
+ * sockets are not closed, this is up to their owners.
+ */
+ReceiverReactor::~ReceiverReactor()
+{
+    stop();
+    waitForStop();
+    close(stop_fd_);
+    close(epoll_fd_);
+}
+
+/**
+ * Starts the worker threads.
+ *
+ * @param numThreads: the number of worker threads (at least 1)
+ */
+void ReceiverReactor::start(unsigned int numThreads)
+{
+    lock_guard<mutex> lock(mutex_);
+    if (isRunning_)
+    {
+        LOG_ERROR(__func__ << "() Reactor is already running!");
+        return;
+    }
+    if (numThreads == 0)
+    {
+        numThreads = 1;
+    }
+
+    isRunning_ = true;
+    for (unsigned int i = 0; i < numThreads; ++i)
+    {
+        workers_.emplace_back(&ReceiverReactor::run, this);
+    }
+    LOG_INFO("Receiver reactor started with " << dec << numThreads << " threads");
+}
+
+/**
+ * Signals all workers to stop. Does not wait for them.
+ *
+ * @see ReceiverReactor::waitForStop()
+ */
+void ReceiverReactor::stop() noexcept
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        if (!isRunning_)
+        {
+            return;
+        }
+        isRunning_ = false;
+    }
+
+    const uint64_t value = 1;
+    if (write(stop_fd_, &value, sizeof(value)) < 0)
+    {
+        LOG_ERROR(__func__ << "() write: " << strerror(errno));
+    }
+    condition_.notify_all();
+}
+
+/**
+ * Blocks until `stop()` got called and all workers are finished.
+ */
+void ReceiverReactor::waitForStop()
+{
+    {
+        unique_lock<mutex> lock(mutex_);
+        condition_.wait(lock, [this]() { return !isRunning_; });
+    }
+    for (thread& worker : workers_)
+    {
+        if (worker.joinable() && worker.get_id() != this_thread::get_id())
+        {
+            worker.join();
+        }
+    }
+}
+
+/**
+ * @return true if the workers are started and `stop()` was not called yet
+ */
+bool ReceiverReactor::isRunning() const noexcept
+{
+    lock_guard<mutex> lock(mutex_);
+    return isRunning_;
+}
+
+/**
+ * Registers the socket of the given handler. From now on the handler is called
+ * by one of the workers, whenever one of the given events occurs.
+ *
+ * @param pHandler: the handler with an opened socket
+ * @param events: the epoll events to wait for (e.g. `EPOLLIN`), might be 0
+ *                to register the handler without waiting for anything yet
+ * @return 0 on success, otherwise a negative value
+ * @see ReceiverReactor::removeHandler()
+ */
+int ReceiverReactor::addHandler(ReactorHandler* pHandler, uint32_t events) noexcept
+{
+    const int skt = pHandler->getSocket();
+    if (skt < 0)
+    {
+        LOG_ERROR(__func__ << "() Can not add handler. Socket invalid!");
+        return -1;
+    }
+
+    lock_guard<mutex> lock(mutex_);
+    struct epoll_event event = {};
+    event.events = events | EPOLLONESHOT;
+    event.data.ptr = pHandler;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, skt, &event) < 0)
+    {
+        LOG_ERROR(__func__ << "() epoll_ctl: " << strerror(errno));
+        return -2;
+    }
+    handlers_[pHandler] = Registration();
+    return 0;
+}
+
+/**
+ * Unregisters the given handler and waits until no worker is using it
+ * anymore. Has to be called before the socket of the handler is closed.
+ *
+ * A handler might also remove itself from `handleEvents()` (e.g. a closed
+ * TCP connection). Then this does not wait, instead the reactor calls
+ * `ReactorHandler::handlerRemoved()` once the handler returned.
+ *
+ * @param pHandler: the handler to remove
+ * @see ReceiverReactor::addHandler()
+ */
+void ReceiverReactor::removeHandler(ReactorHandler* pHandler) noexcept
+{
+    unique_lock<mutex> lock(mutex_);
+    auto iter = handlers_.find(pHandler);
+    if (iter == handlers_.end() || iter->second.isRemoved)
+    {
+        return;
+    }
+    iter->second.isRemoved = true;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, pHandler->getSocket(), nullptr);
+    if (iter->second.isBusy && iter->second.worker == this_thread::get_id())
+    {
+        iter->second.isSelfRemoved = true;
+        return;
+    }
+    condition_.wait(lock, [this, pHandler]()
+    {
+        return !handlers_[pHandler].isBusy;
+    });
+    handlers_.erase(pHandler);
+}
+
+/**
+ * Arms the given handler again, e.g. a sender that has new data to write.
+ * If a worker is currently calling the handler, the events are added to the
+ * ones the handler returns.
+ *
+ * @param pHandler: the registered handler
+ * @param events: the epoll events to wait for
+ */
+void ReceiverReactor::rearm(ReactorHandler* pHandler, uint32_t events) noexcept
+{
+    lock_guard<mutex> lock(mutex_);
+    auto iter = handlers_.find(pHandler);
+    if (iter == handlers_.end() || iter->second.isRemoved)
+    {
+        return;
+    }
+    if (iter->second.isBusy)
+    {
+        iter->second.pendingEvents |= events;
+        return;
+    }
+    modify(pHandler, events);
+}
+
+void ReceiverReactor::run() noexcept
+{
+    ThreadPlacement::getInstance().apply(ThreadRole::IO);
+    while (true)
+    {
+        struct epoll_event event;
+        const int num_events = RealTimeProfile::epollWait(epoll_fd_, &event, 1);
+        if (num_events < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            LOG_ERROR(__func__ << "() epoll_wait: " << strerror(errno));
+            return;
+        }
+        if (num_events == 0)
+        {
+            continue;
+        }
+        if (event.data.ptr == nullptr)
+        {
+            return; // stop_fd_ is readable
+        }
+        handleEvent(static_cast<ReactorHandler*>(event.data.ptr), event.events);
+    }
+}
+
+void ReceiverReactor::handleEvent(ReactorHandler* pHandler, uint32_t events) noexcept
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        // the handler might have been removed after the event was fetched
+        auto iter = handlers_.find(pHandler);
+        if (iter == handlers_.end() || iter->second.isRemoved)
+        {
+            return;
+        }
+        if (iter->second.isBusy)
+        {
+            // re-armed by `rearm()` while being handled, the other worker
+            // arms it again when it is done
+            iter->second.pendingEvents |= events & (EPOLLIN | EPOLLOUT);
+            return;
+        }
+        iter->second.isBusy = true;
+        iter->second.worker = this_thread::get_id();
+    }
+
+    const uint32_t nextEvents = pHandler->handleEvents(events);
+
+    bool isSelfRemoved;
+    {
+        lock_guard<mutex> lock(mutex_);
+        Registration& registration = handlers_[pHandler];
+        registration.isBusy = false;
+        isSelfRemoved = registration.isSelfRemoved;
+        const uint32_t armEvents = nextEvents | registration.pendingEvents;
+        registration.pendingEvents = 0;
+        if (isSelfRemoved)
+        {
+            handlers_.erase(pHandler);
+        }
+        else if (!registration.isRemoved && armEvents != 0)
+        {
+            modify(pHandler, armEvents);
+        }
+    }
+    condition_.notify_all();
+    if (isSelfRemoved)
+    {
+        pHandler->handlerRemoved();
+    }
+}
+
+void ReceiverReactor::modify(ReactorHandler* pHandler, uint32_t events) noexcept
+{
+    struct epoll_event event = {};
+    event.events = events | EPOLLONESHOT;
+    event.data.ptr = pHandler;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, pHandler->getSocket(), &event) < 0)
+    {
+        LOG_ERROR(__func__ << "() epoll_ctl: " << strerror(errno));
+    }
+}
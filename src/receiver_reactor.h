@@ -0,0 +1,75 @@
+/**
+ * @file receiver_reactor.h
+ *
+ */
+
+#ifndef RECEIVER_REACTOR_H
+#define RECEIVER_REACTOR_H
+
+#include "reactor_handler.h"
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Event loop for the sockets of all simulated ECUs.
+ *
+ * Instead of blocking one thread per receiver in `IsoTpReceiver::readData()`,
+ * the sockets are registered with a single epoll instance and a small, fixed
+ * pool of worker threads waits for incoming data. The sockets are registered
+ * with `EPOLLONESHOT`, so a handler is called by at most one worker at a
+ * time and e.g. the messages of a receiver are processed in the order they
+ * arrive. After the handler returned, the socket is armed again with the
+ * events the handler asked for.
+ *
+ * Besides the receivers, the non-blocking `IsoTpSender`s use the reactor to
+ * complete their queued writes on `EPOLLOUT`.
+ *
+ * The number of threads is set by the `ReactorThreads` entry of the simulator
+ * configuration and does not depend on the number of simulated ECUs.
+ */
+class ReceiverReactor
+{
+public:
+    ReceiverReactor();
+    ReceiverReactor(const ReceiverReactor& orig) = delete;
+    ReceiverReactor& operator =(const ReceiverReactor& orig) = delete;
+    virtual ~ReceiverReactor();
+
+    void start(unsigned int numThreads);
+    void stop() noexcept;
+    void waitForStop();
+    bool isRunning() const noexcept;
+
+    int addHandler(ReactorHandler* pHandler, std::uint32_t events) noexcept;
+    void removeHandler(ReactorHandler* pHandler) noexcept;
+    void rearm(ReactorHandler* pHandler, std::uint32_t events) noexcept;
+
+private:
+    struct Registration
+    {
+        bool isBusy = false; ///< true while a worker calls the handler
+        bool isRemoved = false; ///< true while `removeHandler()` waits
+        bool isSelfRemoved = false; ///< removed by the handler itself while being called
+        std::thread::id worker; ///< the worker calling the handler
+        std::uint32_t pendingEvents = 0; ///< events requested while busy
+    };
+
+    int epoll_fd_ = -1;
+    int stop_fd_ = -1; ///< eventfd to wake up all workers on `stop()`
+    std::vector<std::thread> workers_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable condition_;
+    std::map<ReactorHandler*, Registration> handlers_; ///< the currently registered handlers
+    bool isRunning_ = false;
+
+    void run() noexcept;
+    void handleEvent(ReactorHandler* pHandler, std::uint32_t events) noexcept;
+    void modify(ReactorHandler* pHandler, std::uint32_t events) noexcept;
+};
+
+#endif /* RECEIVER_REACTOR_H */
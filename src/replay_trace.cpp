@@ -0,0 +1,385 @@
+/**
+ * @file replay_trace.cpp
+ *
+ */
+
+#include "replay_trace.h"
+#include "traffic_capture.h"
+#include "logger.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+using namespace std;
+
+static constexpr char CAPTURE_MAGIC[8] = {'C', 'S', 'I', 'M', 'C', 'A', 'P', '1'};
+static constexpr uint8_t NEGATIVE_RESPONSE = 0x7F;
+static constexpr uint8_t NRC_RESPONSE_PENDING = 0x78;
+
+namespace
+{
+
+/// the hex values of the characters, -1 if not a hex digit
+constexpr struct HexTable
+{
+    signed char values[256];
+
+    constexpr HexTable() : values()
+    {
+        for (int c = 0; c < 256; ++c)
+        {
+            values[c] = c >= '0' && c <= '9' ? c - '0'
+                : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                : -1;
+        }
+    }
+} HEX_TABLE;
+
+/// the hex value of a character or -1
+inline int hexValue(char c) noexcept
+{
+    return HEX_TABLE.values[static_cast<unsigned char>(c)];
+}
+
+/**
+ * Reassembles the ISO-TP messages (normal addressing) of one CAN ID from
+ * its frames. Flow control frames are ignored.
+ */
+class IsoTpReassembly
+{
+public:
+    /**
+     * @return true if the frame completes a message, see `getMessage()`
+     */
+    bool addFrame(const uint8_t* data, size_t length)
+    {
+        if (length == 0)
+        {
+            return false;
+        }
+        switch (data[0] >> 4)
+        {
+        case 0: // single frame, with the length in the 2nd byte for CAN FD
+        {
+            size_t messageLength = data[0] & 0x0F;
+            size_t start = 1;
+            if (messageLength == 0 && length > 1)
+            {
+                messageLength = data[1];
+                start = 2;
+            }
+            isActive_ = false;
+            if (messageLength == 0 || start + messageLength > length)
+            {
+                return false;
+            }
+            message_.assign(data + start, data + start + messageLength);
+            return true;
+        }
+        case 1: // first frame, with a 32 bit length if the 12 bit length is 0
+        {
+            if (length < 2)
+            {
+                return false;
+            }
+            expected_ = (size_t(data[0] & 0x0F) << 8) | data[1];
+            size_t start = 2;
+            if (expected_ == 0 && length >= 6)
+            {
+                expected_ = (size_t(data[2]) << 24) | (size_t(data[3]) << 16) | (size_t(data[4]) << 8) | data[5];
+                start = 6;
+            }
+            message_.assign(data + start, data + min(length, start + expected_));
+            nextSequenceNumber_ = 1;
+            isActive_ = expected_ > message_.size();
+            return !isActive_ && expected_ > 0;
+        }
+        case 2: // consecutive frame
+        {
+            if (!isActive_ || (data[0] & 0x0F) != nextSequenceNumber_)
+            {
+                isActive_ = false;
+                return false;
+            }
+            nextSequenceNumber_ = (nextSequenceNumber_ + 1) & 0x0F;
+            message_.insert(message_.end(), data + 1, data + 1 + min(length - 1, expected_ - message_.size()));
+            isActive_ = message_.size() < expected_;
+            return !isActive_;
+        }
+        default:
+            return false;
+        }
+    }
+
+    const vector<uint8_t>& getMessage() const noexcept { return message_; }
+
+private:
+    vector<uint8_t> message_;
+    size_t expected_ = 0;
+    uint8_t nextSequenceNumber_ = 0;
+    bool isActive_ = false;
+};
+
+} // namespace
+
+/**
+ * Pairs the messages of the trace in their recorded order.
+ */
+class ReplayTrace::Recorder
+{
+public:
+    explicit Recorder(ReplayTrace& trace) : trace_(trace) { }
+
+    void addRequest(const uint8_t* data, size_t length)
+    {
+        finishRequest();
+        pendingRequest_ = append(data, length);
+        hasPendingRequest_ = true;
+    }
+
+    void addResponse(const uint8_t* data, size_t length)
+    {
+        const bool isResponsePending = length >= 3 && data[0] == NEGATIVE_RESPONSE
+            && data[2] == NRC_RESPONSE_PENDING;
+        // spontaneous responses (e.g. to another tester) have no request
+        if (!hasPendingRequest_ || isResponsePending)
+        {
+            return;
+        }
+        trace_.pairs_.push_back({pendingRequest_, append(data, length)});
+        hasPendingRequest_ = false;
+    }
+
+    /// records the last request without response, if any
+    void finishRequest()
+    {
+        if (hasPendingRequest_)
+        {
+            trace_.pairs_.push_back({pendingRequest_, {trace_.data_.size(), 0}});
+            hasPendingRequest_ = false;
+        }
+    }
+
+private:
+    ReplayTrace& trace_;
+    Message pendingRequest_ = {0, 0};
+    bool hasPendingRequest_ = false;
+
+    Message append(const uint8_t* data, size_t length)
+    {
+        const Message message = {trace_.data_.size(), length};
+        trace_.data_.insert(trace_.data_.end(), data, data + length);
+        return message;
+    }
+};
+
+/**
+ * Loads the request/response pairs of an ECU from a trace.
+ *
+ * @param traceFile: a candump log or a `TrafficCapture` file
+ * @param requestId: the CAN ID of the requests to the ECU
+ * @param responseId: the CAN ID of the responses of the ECU
+ * @return the indexed trace or `nullptr` if the file can not be read
+ */
+shared_ptr<const ReplayTrace> ReplayTrace::load(const string& traceFile, uint32_t requestId, uint32_t responseId)
+{
+    const int fd = open(traceFile.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        LOG_ERROR(__func__ << "() open " << traceFile << ": " << strerror(errno));
+        return nullptr;
+    }
+    struct stat st;
+    void* pMapping = MAP_FAILED;
+    const size_t size = fstat(fd, &st) == 0 ? size_t(st.st_size) : 0;
+    if (size > 0)
+    {
+        pMapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (pMapping == MAP_FAILED)
+    {
+        LOG_ERROR(__func__ << "() Can not map " << traceFile);
+        return nullptr;
+    }
+
+    auto pTrace = make_shared<ReplayTrace>();
+    bool isValid = true;
+    if (size >= sizeof(CAPTURE_MAGIC) && memcmp(pMapping, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) == 0)
+    {
+        munmap(pMapping, size);
+        Recorder recorder(*pTrace);
+        isValid = TrafficCapture::readRecords(traceFile,
+            [&recorder, requestId, responseId](const TrafficCapture::Record& record)
+            {
+                if (record.protocol != TrafficCapture::Protocol::UDS)
+                {
+                    return;
+                }
+                if (record.identifier == requestId)
+                {
+                    recorder.addRequest(record.payload, record.length);
+                }
+                else if (record.identifier == responseId)
+                {
+                    recorder.addResponse(record.payload, record.length);
+                }
+            }) >= 0;
+        recorder.finishRequest();
+    }
+    else
+    {
+        madvise(pMapping, size, MADV_SEQUENTIAL);
+        isValid = pTrace->readCandump(static_cast<const char*>(pMapping), size, requestId, responseId);
+        munmap(pMapping, size);
+    }
+    if (!isValid)
+    {
+        LOG_ERROR(__func__ << "() " << traceFile << " is neither a candump log nor a capture file");
+        return nullptr;
+    }
+
+    pTrace->buildIndex();
+    LOG_INFO("Loaded " << dec << pTrace->getPairCount() << " requests (" << pTrace->size()
+             << " distinct) of " << hex << requestId << "/" << responseId << " from " << traceFile);
+    return pTrace;
+}
+
+/**
+ * Reads the frames of the request and response CAN ID from a candump log,
+ * e.g. `(1500000000.000000) vcan0 7E0#0322F190CCCCCCCC`. CAN FD frames
+ * (`7E0##1...`) are read as well, other lines are skipped.
+ *
+ * @return false if no line of the text is a CAN frame
+ */
+bool ReplayTrace::readCandump(const char* pText, size_t size, uint32_t requestId, uint32_t responseId)
+{
+    Recorder recorder(*this);
+    IsoTpReassembly requests;
+    IsoTpReassembly responses;
+    uint8_t frame[64];
+    bool hasFrames = false;
+
+    const char* p = pText;
+    const char* const pEnd = pText + size;
+    while (p < pEnd)
+    {
+        const char* pLineEnd = static_cast<const char*>(memchr(p, '\n', size_t(pEnd - p)));
+        if (!pLineEnd)
+        {
+            pLineEnd = pEnd;
+        }
+        // the frame is the last field before the optional direction flag, it contains a '#'
+        const char* pHash = static_cast<const char*>(memchr(p, '#', size_t(pLineEnd - p)));
+        if (pHash)
+        {
+            const char* pId = pHash;
+            while (pId > p && pId[-1] != ' ')
+            {
+                --pId;
+            }
+            uint32_t canId = 0;
+            bool isValid = pId < pHash;
+            for (const char* q = pId; q < pHash && isValid; ++q)
+            {
+                const int value = hexValue(*q);
+                isValid = value >= 0;
+                canId = (canId << 4) | uint32_t(value);
+            }
+            const char* q = pHash + 1;
+            if (q < pLineEnd && *q == '#')
+            {
+                q += 2; // CAN FD, skip the flags
+            }
+            size_t length = 0;
+            while (isValid && q + 1 < pLineEnd && length < sizeof(frame)
+                   && hexValue(q[0]) >= 0 && hexValue(q[1]) >= 0)
+            {
+                frame[length++] = uint8_t((hexValue(q[0]) << 4) | hexValue(q[1]));
+                q += 2;
+            }
+            hasFrames = hasFrames || isValid;
+            if (isValid && canId == requestId && requests.addFrame(frame, length))
+            {
+                recorder.addRequest(requests.getMessage().data(), requests.getMessage().size());
+            }
+            else if (isValid && canId == responseId && responses.addFrame(frame, length))
+            {
+                recorder.addResponse(responses.getMessage().data(), responses.getMessage().size());
+            }
+        }
+        p = pLineEnd + 1;
+    }
+    recorder.finishRequest();
+    return hasFrames;
+}
+
+/**
+ * Groups the pairs by their request, keeping the recorded order.
+ */
+void ReplayTrace::buildIndex()
+{
+    unordered_map<string_view, uint32_t> sequenceIndices;
+    vector<uint32_t> pairSequences(pairs_.size());
+    vector<uint32_t> counts;
+    for (size_t i = 0; i < pairs_.size(); ++i)
+    {
+        const string_view request(reinterpret_cast<const char*>(data_.data()) + pairs_[i].request.offset,
+                                  pairs_[i].request.length);
+        auto inserted = sequenceIndices.emplace(request, uint32_t(counts.size()));
+        if (inserted.second)
+        {
+            counts.push_back(0);
+        }
+        pairSequences[i] = inserted.first->second;
+        ++counts[inserted.first->second];
+    }
+
+    sequenceCount_ = counts.size();
+    sequences_.reset(new Sequence[sequenceCount_]);
+    uint32_t first = 0;
+    for (size_t i = 0; i < sequenceCount_; ++i)
+    {
+        sequences_[i].first = first;
+        sequences_[i].count = 0;
+        first += counts[i];
+    }
+    order_.resize(pairs_.size());
+    for (size_t i = 0; i < pairs_.size(); ++i)
+    {
+        Sequence& sequence = sequences_[pairSequences[i]];
+        order_[sequence.first + sequence.count++] = uint32_t(i);
+    }
+
+    index_.reserve(sequenceCount_);
+    for (const auto& sequenceIndex : sequenceIndices)
+    {
+        index_.emplace(sequenceIndex.first, &sequences_[sequenceIndex.second]);
+    }
+}
+
+/**
+ * Finds the recorded response of a request. Successive calls with the same
+ * request return its responses in the recorded order.
+ *
+ * @param request: the received request
+ * @param length: the number of bytes in `request`
+ * @return the response, empty if the request was recorded without response,
+ *         or `nullopt` if the request is not in the trace
+ */
+optional<ReplayTrace::Response> ReplayTrace::match(const uint8_t* request, size_t length) const noexcept
+{
+    auto it = index_.find(string_view(reinterpret_cast<const char*>(request), length));
+    if (it == index_.end())
+    {
+        return nullopt;
+    }
+    const Sequence& sequence = *it->second;
+    const uint32_t position = sequence.next.fetch_add(1, memory_order_relaxed) % sequence.count;
+    const Message& response = pairs_[order_[sequence.first + position]].response;
+    return Response{data_.data() + response.offset, response.length};
+}
@@ -0,0 +1,103 @@
+/**
+ * @file replay_trace.h
+ *
+ */
+
+#ifndef REPLAY_TRACE_H
+#define REPLAY_TRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * The request/response pairs of one ECU from a recorded trace, served without
+ * Lua (see the `Replay` field of the ECU table).
+ *
+ * The trace is either a candump log (`candump -l`, the ISO-TP frames of the
+ * request and response CAN ID are reassembled) or a capture file of the
+ * `TrafficCapture`. It is memory-mapped and indexed once at load time: every
+ * request is paired with the next response of the ECU, "response pending"
+ * (NRC 0x78) responses are skipped. A request without response before the
+ * next request (e.g. with "suppress positive response") is recorded as not
+ * answered.
+ *
+ * If the same request got different responses over time, they are served in
+ * the recorded order and start over after the last one, so e.g. a routine
+ * polled until it is finished behaves like in the recording. The position in
+ * the sequence is an atomic counter per request.
+ */
+class ReplayTrace
+{
+public:
+    /// a recorded response, empty if the request was not answered
+    struct Response
+    {
+        const std::uint8_t* data;
+        std::size_t length;
+    };
+
+    static std::shared_ptr<const ReplayTrace> load(const std::string& traceFile,
+                                                   std::uint32_t requestId,
+                                                   std::uint32_t responseId);
+
+    ReplayTrace() = default;
+    ReplayTrace(const ReplayTrace& orig) = delete;
+    ReplayTrace& operator =(const ReplayTrace& orig) = delete;
+    virtual ~ReplayTrace() = default;
+
+    std::optional<Response> match(const std::uint8_t* request, std::size_t length) const noexcept;
+
+    /**
+     * @return the number of distinct requests
+     */
+    std::size_t size() const noexcept { return sequenceCount_; }
+
+    /**
+     * @return the number of request/response pairs
+     */
+    std::size_t getPairCount() const noexcept { return pairs_.size(); }
+
+private:
+    /// the offsets of a message in `data_`
+    struct Message
+    {
+        std::size_t offset;
+        std::size_t length;
+    };
+
+    struct Pair
+    {
+        Message request;
+        Message response;
+    };
+
+    /// the responses of one request, `pairs_[order_[first + i]]`
+    struct Sequence
+    {
+        std::uint32_t first;
+        std::uint32_t count;
+        mutable std::atomic<std::uint32_t> next{0};
+    };
+
+    std::vector<std::uint8_t> data_; ///< all requests and responses
+    std::vector<Pair> pairs_; ///< in the recorded order
+    std::vector<std::uint32_t> order_; ///< the pairs grouped by their request
+    std::unique_ptr<Sequence[]> sequences_;
+    std::size_t sequenceCount_ = 0;
+    std::unordered_map<std::string_view, const Sequence*> index_; ///< keyed by the request in `data_`
+
+    /// pairs the reassembled messages while the trace is parsed
+    class Recorder;
+
+    bool readCandump(const char* pText, std::size_t size, std::uint32_t requestId, std::uint32_t responseId);
+    void buildIndex();
+};
+
+#endif /* REPLAY_TRACE_H */
@@ -1,15 +1,40 @@
 #ifndef REQUEST_BYTE_TREE_NODE_H
 #define REQUEST_BYTE_TREE_NODE_H
 
-#include <map>
+#include <algorithm>
+#include <deque>
 #include <memory>
+#include <memory_resource>
 #include <optional>
+#include <utility>
+#include <vector>
 
-#include "selene.h"
+#include "lua_compat.h"
 
 using namespace std;
 using namespace sel;
 
+/**
+ * A request byte given as pattern instead of a literal byte, i.e. a nibble
+ * pattern like "3X" or "X3" or a range like "[F1-F3]". A byte matches if
+ * `(byte & mask) == value` and it is within `[low, high]`, so a nibble
+ * pattern covers the whole range and a range masks nothing.
+ */
+struct RequestBytePattern {
+	uint8_t value = 0;
+	uint8_t mask = 0;
+	uint8_t low = 0x00;
+	uint8_t high = 0xFF;
+
+	inline bool matches(uint8_t requestByte) const {
+		return (requestByte & mask) == value && requestByte >= low && requestByte <= high;
+	}
+
+	inline bool operator==(const RequestBytePattern &other) const {
+		return value == other.value && mask == other.mask && low == other.low && high == other.high;
+	}
+};
+
 /**
  * In order to quickly find a request from the simulation that fits the current
  * request coming from the application, all possible requests are defined in
@@ -25,6 +50,7 @@ using namespace sel;
  * * 36 XX *
  * * 31 XX 12
  * * 31 01 12
+ * * 31 0X 12
  * 
  * Then the tree will look like
  * - 22
@@ -42,31 +68,65 @@ using namespace sel;
  *     - 12 -> response5
  *   - 01
  *     - 12 -> response6
+ *   - 0X
+ *     - 12 -> response7
  * 
  * When the application sends request 31 01 12, the simulation can quickly move through
- * the tree to find the matching response "response5"
+ * the tree to find the matching responses "response5", "response6" and
+ * "response7". If several requests match, the one with the highest priority
+ * wins, see `getPriority()`, i.e. "response6" here.
  *
+ * The node created with `new` is the root and owns the whole tree: all other
+ * nodes and their edge arrays are allocated from an arena of the root (a
+ * `std::pmr::monotonic_buffer_resource`), linked by plain pointers and
+ * released in one step with the root. So building a table with many keys
+ * takes a few large allocations instead of several per node.
  */
 template<class T>
 class RequestByteTreeNode {
 
-private:	
+public:
+	using Edge = pair<uint8_t, RequestByteTreeNode<T>*>;
+	using PatternEdge = pair<RequestBytePattern, RequestByteTreeNode<T>*>;
+
+	/// the low bits of a priority, see `getPriority()`. Equal priorities without them are a tie.
+	static constexpr unsigned DEFINITION_ORDER_BITS = 24;
+
+private:
+	/// the memory of the nodes of one tree, owned by the root
+	struct Arena {
+		/// declared first, so it is released after the nodes are destroyed
+		pmr::monotonic_buffer_resource resource;
+		pmr::deque<RequestByteTreeNode<T>> nodes{&resource};
+		uint32_t leafCount = 0; ///< the definition order of the next response
+	};
+
+	/// only set at the root
+	unique_ptr<Arena> ownedArena;
+	Arena *arena;
+
+	/**
+	 * Contains all possible bytes at the next position in the request, sorted
+	 * by the byte. For example, it there are requests available 22 F1 90 and
+	 * 22 17 10 and this object represents byte at position 0 (i.e. 22), then
+	 * the array contains entries for 17 and F1.
+	 */
+	pmr::vector<Edge> subsequentByte;
+
 	/**
-	 * Contains all possible bytes at the next position in the request.
-	 * For example, it there are requests available 22 F1 90 and 22 17 10 and
-	 * this object represents byte at position 0 (i.e. 22), then the map contains
-	 * entries for F1 and 17.  
+	 * Contains the byte patterns at the next position in the request in the
+	 * order they were defined. Several of them can match the same byte.
 	 */
-	map<uint8_t, shared_ptr<RequestByteTreeNode<T>>> subsequentByte;
+	pmr::vector<PatternEdge> subsequentPattern;
 
 	/**
 	 * Points to following placeholder or wildcard entry respectively.
-	 * It works the same as the map but instead of putting entries with magic number
-	 * into the map that represents placeholder and wildcard, we use separate
+	 * It works the same as the edges but instead of putting entries with magic number
+	 * into the array that represents placeholder and wildcard, we use separate
 	 * fields for them. This avoids converting between byte and short.
 	 */
-	shared_ptr<RequestByteTreeNode<T>> subsequentPlaceholder = nullptr;
-	shared_ptr<RequestByteTreeNode<T>> subsequentWildcard =  nullptr;
+	RequestByteTreeNode<T> *subsequentPlaceholder = nullptr;
+	RequestByteTreeNode<T> *subsequentWildcard = nullptr;
 	
 	/**
 	 * Stores the actual rvalue from the lua map in case there is any
@@ -81,40 +141,67 @@ private:
 	 * Meta information to determine best matching request 
 	 */
 	uint32_t placeholderCount;
+	uint32_t patternCount = 0;
 	uint32_t requestLength;
 	bool wildcard;
+	uint64_t priority = 0;
 
-	const shared_ptr<RequestByteTreeNode<T>> self;
+	inline RequestByteTreeNode<T> *createNode(uint32_t placeholderCount, uint32_t requestLength) {
+		arena->nodes.emplace_back(arena, placeholderCount, requestLength);
+		arena->nodes.back().patternCount = patternCount;
+		return &arena->nodes.back();
+	}
 	
 public:	
-	RequestByteTreeNode(uint32_t placeholderCount = 0, uint32_t requestLength = 0) :
-        luaResponse(nullopt),
-        placeholderCount(placeholderCount),
+	RequestByteTreeNode() :
+		ownedArena(new Arena()),
+		arena(ownedArena.get()),
+		subsequentByte(&arena->resource),
+		subsequentPattern(&arena->resource),
+		luaResponse(nullopt),
+		placeholderCount(0),
+		requestLength(0),
+		wildcard(false) {}
+
+	/// creates a node of the tree in the given arena, see `createNode()`
+	RequestByteTreeNode(Arena *arena, uint32_t placeholderCount, uint32_t requestLength) :
+		arena(arena),
+		subsequentByte(&arena->resource),
+		subsequentPattern(&arena->resource),
+		luaResponse(nullopt),
+		placeholderCount(placeholderCount),
 		requestLength(requestLength),
-		self(this) {}
+		wildcard(false) {}
     
-    RequestByteTreeNode(RequestByteTreeNode<T> &rbt) {
-		cerr << "Copy Constructor of RequestByteTreeNode must not be called!" << endl;
-        throw exception();
-    }
-
-	inline shared_ptr<RequestByteTreeNode<T>> getSubsequentByte(uint8_t requestByte) {
-        typename map<uint8_t, shared_ptr<RequestByteTreeNode<T>>>::const_iterator iter = subsequentByte.find(requestByte);
-		if(iter != subsequentByte.end()) {
+	RequestByteTreeNode(const RequestByteTreeNode<T> &rbt) = delete;
+	RequestByteTreeNode<T> &operator=(const RequestByteTreeNode<T> &rbt) = delete;
+
+	inline RequestByteTreeNode<T> *getSubsequentByte(uint8_t requestByte) const {
+		auto iter = lower_bound(subsequentByte.begin(), subsequentByte.end(), requestByte,
+		                        [](const Edge &edge, uint8_t byte) { return edge.first < byte; });
+		if(iter != subsequentByte.end() && iter->first == requestByte) {
 			return iter->second;
 		}
 		return nullptr;
 	}
 
+	inline const pmr::vector<Edge> &getSubsequentBytes() const {
+		return subsequentByte;
+	}
+
+	inline const pmr::vector<PatternEdge> &getSubsequentPatterns() const {
+		return subsequentPattern;
+	}
+
 	inline optional<T> &getLuaResponse() {
 		return luaResponse;
 	}
 	
-	inline shared_ptr<RequestByteTreeNode<T>> getSubsequentPlaceholder() {
+	inline RequestByteTreeNode<T> *getSubsequentPlaceholder() const {
 		return subsequentPlaceholder;
 	}
 
-	inline shared_ptr<RequestByteTreeNode<T>> getSubsequentWildcard() {
+	inline RequestByteTreeNode<T> *getSubsequentWildcard() const {
 		return subsequentWildcard;
 	}
 
@@ -122,6 +209,10 @@ public:
 		return placeholderCount;
 	}
 
+	inline int getPatternCount() const {
+		return patternCount;
+	}
+
 	inline int getRequestLength() const {
 		return requestLength;
 	}
@@ -129,45 +220,78 @@ public:
 	inline bool isWildcard() const {
 		return wildcard;
 	}	
+
+	/**
+	 * The priority of the response of this node among all requests matching
+	 * the same bytes, the higher the better. It is a total order, so the best
+	 * match never depends on the order the candidates are visited:
+	 * 1. requests without wildcard win over requests with wildcard
+	 * 2. longer requests win (only differs between wildcard requests)
+	 * 3. requests with fewer placeholders win
+	 * 4. requests with fewer byte patterns win, so a pattern is more specific
+	 *    than a placeholder and less specific than a byte
+	 * 5. the request defined first wins
+	 *
+	 * @return the priority, 0 if the node has no response
+	 */
+	inline uint64_t getPriority() const {
+		return priority;
+	}
 	
 	// Builder Methods
-	inline shared_ptr<RequestByteTreeNode<T>> appendByte(uint8_t requestByte) {
-        //This would be easier but results in shared_ptr throwing a runtime exception
-		// subsequentByte.emplace(requestByte, shared_ptr<RequestByteTreeNode<T>>(new RequestByteTreeNode<T>(placeholderCount, requestLength + 1)));
-		typename map<uint8_t, shared_ptr<RequestByteTreeNode<T>>>::iterator nextByte = subsequentByte.find(requestByte);
-		if(nextByte != subsequentByte.end()) {
-			return nextByte->second;
-		} else {
-			subsequentByte.insert(pair<uint8_t, shared_ptr<RequestByteTreeNode<T>>>(requestByte, new RequestByteTreeNode<T>(placeholderCount, requestLength + 1)));
-			return subsequentByte[requestByte];
+	inline RequestByteTreeNode<T> *appendByte(uint8_t requestByte) {
+		auto iter = lower_bound(subsequentByte.begin(), subsequentByte.end(), requestByte,
+		                        [](const Edge &edge, uint8_t byte) { return edge.first < byte; });
+		if(iter != subsequentByte.end() && iter->first == requestByte) {
+			return iter->second;
 		}
+		RequestByteTreeNode<T> *nextElement = createNode(placeholderCount, requestLength + 1);
+		subsequentByte.insert(iter, Edge(requestByte, nextElement));
+		return nextElement;
 	}
 	
-	inline shared_ptr<RequestByteTreeNode<T>> appendWildcard() {
+	inline RequestByteTreeNode<T> *appendWildcard() {
 		if(subsequentWildcard) {
 			cerr << "Same request with Wildcard already exists" << endl;
 			throw exception();
 		}
-		subsequentWildcard.reset(new RequestByteTreeNode<T>(placeholderCount, requestLength + 1));
-		shared_ptr<RequestByteTreeNode<T>> nextElement = subsequentWildcard;
-		nextElement->wildcard = true;
-		return nextElement;
+		subsequentWildcard = createNode(placeholderCount, requestLength + 1);
+		subsequentWildcard->wildcard = true;
+		return subsequentWildcard;
 	}
 
-	inline shared_ptr<RequestByteTreeNode<T>> appendPlaceholder() {
+	inline RequestByteTreeNode<T> *appendPlaceholder() {
 		if(!subsequentPlaceholder) {
-			subsequentPlaceholder.reset(new RequestByteTreeNode<T>(placeholderCount + 1, requestLength + 1));
+			subsequentPlaceholder = createNode(placeholderCount + 1, requestLength + 1);
 		}
-		shared_ptr<RequestByteTreeNode<T>> nextElement = subsequentPlaceholder;
-		nextElement->placeholderCount = this->placeholderCount + 1;
+		return subsequentPlaceholder;
+	}
+	
+	inline RequestByteTreeNode<T> *appendPattern(const RequestBytePattern &pattern) {
+		for(const auto &patternEdge : subsequentPattern) {
+			if(patternEdge.first == pattern) {
+				return patternEdge.second;
+			}
+		}
+		RequestByteTreeNode<T> *nextElement = createNode(placeholderCount, requestLength + 1);
+		nextElement->patternCount++;
+		subsequentPattern.emplace_back(pattern, nextElement);
 		return nextElement;
 	}
 	
-	inline shared_ptr<RequestByteTreeNode<T>> setLuaResponse(T luaResponse) {
-		this->luaResponse.emplace(luaResponse);
-		return self;
+	inline RequestByteTreeNode<T> *setLuaResponse(T luaResponse) {
+		if(!this->luaResponse) {
+			const uint32_t definitionOrder = arena->leafCount++;
+			priority = (uint64_t(wildcard ? 0 : 1) << 63)
+				| (uint64_t(min<uint32_t>(requestLength, 0xFFFF)) << 47)
+				| (uint64_t(0xFFF - min<uint32_t>(placeholderCount, 0xFFF)) << 35)
+				| (uint64_t(0x7FF - min<uint32_t>(patternCount, 0x7FF)) << DEFINITION_ORDER_BITS)
+				| uint64_t(0xFFFFFF - min<uint32_t>(definitionOrder, 0xFFFFFE));
+		}
+		this->luaResponse.emplace(move(luaResponse));
+		return this;
 	}
 
 };
 
-#endif
\ No newline at end of file
+#endif
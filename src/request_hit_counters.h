@@ -0,0 +1,70 @@
+/**
+ * @file request_hit_counters.h
+ *
+ */
+
+#ifndef REQUEST_HIT_COUNTERS_H
+#define REQUEST_HIT_COUNTERS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Counts how often each entry of a compiled request table was the answer to a
+ * request, e.g. the leaves of a `CompiledRequestMatcher` by rank or the
+ * entries of a `DataIdentifierIndex`. The counters are relaxed atomics in one
+ * array, so counting costs a single uncontended add on the lookup path.
+ */
+class RequestHitCounters
+{
+public:
+    explicit RequestHitCounters(std::size_t count)
+    : pHits_(new std::atomic<std::uint64_t>[count]())
+    , count_(count)
+    {
+    }
+    RequestHitCounters(const RequestHitCounters& orig) = delete;
+    RequestHitCounters& operator =(const RequestHitCounters& orig) = delete;
+
+    void hit(std::size_t index) noexcept { pHits_[index].fetch_add(1, std::memory_order_relaxed); }
+    /// adds hits counted elsewhere, e.g. by the version of a table before a reload
+    void add(std::size_t index, std::uint64_t hits) noexcept { pHits_[index].fetch_add(hits, std::memory_order_relaxed); }
+    std::uint64_t get(std::size_t index) const noexcept { return pHits_[index].load(std::memory_order_relaxed); }
+    std::size_t size() const noexcept { return count_; }
+
+private:
+    std::unique_ptr<std::atomic<std::uint64_t>[]> pHits_;
+    std::size_t count_;
+};
+
+/**
+ * The hit counters of the request tables of an ECU with the keys of their
+ * entries, for the metrics. The `EcuLuaScript` replaces the tables as a whole
+ * whenever it compiles them, e.g. on a reload, so the readers always see the
+ * tables that answer the requests.
+ */
+class RequestHitStatistics
+{
+public:
+    struct Table
+    {
+        std::string name; ///< e.g. "Raw" or "ReadDataByIdentifier"
+        std::string session; ///< the session of the table, empty for the one of the ECU table
+        std::vector<std::string> keys; ///< the table keys by counter index
+        std::shared_ptr<const RequestHitCounters> pCounters;
+    };
+    using Tables = std::vector<Table>;
+
+    void setTables(std::shared_ptr<const Tables> pTables) noexcept { std::atomic_store(&pTables_, std::move(pTables)); }
+    /// @return the current tables, never `nullptr`
+    std::shared_ptr<const Tables> getTables() const noexcept { return std::atomic_load(&pTables_); }
+
+private:
+    std::shared_ptr<const Tables> pTables_ = std::make_shared<const Tables>();
+};
+
+#endif /* REQUEST_HIT_COUNTERS_H */
@@ -0,0 +1,139 @@
+/**
+ * @file request_response.h
+ *
+ */
+
+#ifndef REQUEST_RESPONSE_H
+#define REQUEST_RESPONSE_H
+
+#include "lua_compat.h"
+#include "response_cache.h"
+#include "response_delay.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * A Lua function of a request table entry, referenced by its slot in the
+ * registry of the Lua state it belongs to. Unlike a `sel::Selector`, which
+ * keeps the whole path from the global table and its own copy of the key, this
+ * is two words and needs no allocation.
+ *
+ * The slot is released when the Lua state is closed, the request matchers keep
+ * the state alive as long as they are used.
+ */
+struct LuaFunctionRef
+{
+    lua_State *l = nullptr;
+    int ref = LUA_NOREF;
+
+    explicit operator bool() const { return l != nullptr; }
+};
+
+/**
+ * A list of static responses of a `Raw` entry, sent one after the other on
+ * successive requests, e.g. a routine which is "in progress" for some polls
+ * before it is finished. By default the list starts over after the last
+ * response; a held list (`hold = true`) keeps sending its last response.
+ *
+ * The position is an atomic of the entry, shared by all transports of the
+ * ECU. It starts over on an ECU reset, and with `session = true` also when
+ * the session changes, see `SessionController::getResetEpoch()`.
+ */
+struct ResponseSequence
+{
+    std::vector<std::string> literals;
+    std::vector<std::vector<std::uint8_t>> responses;
+    bool isHeld = false; ///< keep the last response instead of starting over
+    bool isSessionScoped = false; ///< start over when the session changes
+    /// the epoch the position belongs to (upper 32 bits) and the position of the next response
+    mutable std::atomic<std::uint64_t> state{0};
+
+    /**
+     * Advances to the next response.
+     *
+     * @param resetEpoch: the number of ECU resets
+     * @param sessionEpoch: the number of session changes
+     * @return the index of the response to send
+     */
+    std::size_t advance(std::uint32_t resetEpoch, std::uint32_t sessionEpoch) const noexcept
+    {
+        const std::uint64_t epoch = isSessionScoped ? sessionEpoch : resetEpoch;
+        std::uint64_t current = state.load(std::memory_order_relaxed);
+        std::uint32_t position;
+        std::uint64_t next;
+        do
+        {
+            position = (current >> 32) == epoch ? std::uint32_t(current) : 0;
+            std::uint32_t following = position + 1;
+            if (following == responses.size())
+            {
+                following = isHeld ? position : 0;
+            }
+            next = (epoch << 32) | following;
+        } while (!state.compare_exchange_weak(current, next, std::memory_order_relaxed));
+        return position;
+    }
+};
+
+/**
+ * The value of a request table entry (e.g. `Raw` or `PGNs`) as it is stored in
+ * the leafs of the request byte tree.
+ *
+ * Static entries (i.e. strings) never change after the Lua script is loaded,
+ * so they are decoded once into `bytes`. Only entries defined as Lua function
+ * keep a reference to the Lua value and need to be called on every request.
+ */
+struct RequestResponse
+{
+    /// The Lua function to call, empty for static entries.
+    LuaFunctionRef luaFunction;
+    /// The static entry as written in the Lua script (e.g. "62 F1 90 01").
+    std::string literal;
+    /// The static entry decoded into bytes (e.g. {0x62, 0xF1, 0x90, 0x01}).
+    std::vector<std::uint8_t> bytes;
+    /// The responses of a list entry, `nullptr` for single responses. The
+    /// copies of a compiled entry share the position of the list.
+    std::shared_ptr<const ResponseSequence> pSequence;
+    /// The table key of a `Raw` entry (e.g. "22 F1 XX"), reported by the
+    /// request validator and used to resolve a Lua function again when a
+    /// `RequestSnapshot` is loaded.
+    std::string tableKey;
+    /// The Lua function is wrapped in `binary()`: it gets the request as raw
+    /// byte string and returns raw bytes instead of literal hex strings.
+    bool isBinary = false;
+    /// The Lua function is wrapped in `direct()` (LuaJIT builds only): it
+    /// reads the request and writes the response through the FFI, see
+    /// `simulator_request()`.
+    bool isDirect = false;
+    /// The responses of a function wrapped in `cached()`, `nullptr` if the
+    /// function is called on every request. Shared by the copies of an entry.
+    std::shared_ptr<ResponseCache> pCache;
+    /// The response time of a static entry wrapped in `delayed()`, `nullptr`
+    /// for the response time of the ECU. Shared by the copies of an entry.
+    std::shared_ptr<const ResponseDelay> pDelay;
+
+    bool isLuaFunction() const { return bool(luaFunction); }
+    bool isSequence() const { return bool(pSequence); }
+
+    /**
+     * @return the static response to send, the next one of a list entry
+     * @see ResponseSequence::advance()
+     */
+    const std::vector<std::uint8_t>& getBytes(std::uint32_t resetEpoch, std::uint32_t sessionEpoch) const noexcept
+    {
+        return pSequence ? pSequence->responses[pSequence->advance(resetEpoch, sessionEpoch)] : bytes;
+    }
+
+    /**
+     * @return the static response to send as literal, the next one of a list entry
+     */
+    const std::string& getLiteral(std::uint32_t resetEpoch, std::uint32_t sessionEpoch) const noexcept
+    {
+        return pSequence ? pSequence->literals[pSequence->advance(resetEpoch, sessionEpoch)] : literal;
+    }
+};
+
+#endif /* REQUEST_RESPONSE_H */
@@ -0,0 +1,389 @@
+/**
+ * @file request_snapshot.cpp
+ *
+ * The snapshot file consists of the header, the arrays of the matcher (each
+ * aligned to 8 bytes), the leaf descriptors and the blob with the ECU ident,
+ * the response literals, the response bytes and the table keys. The arrays are stored in the native layout, so a snapshot is
+ * only valid for the build that wrote it (checked by the node and edge sizes
+ * and the format version).
+ */
+
+#include "request_snapshot.h"
+#include "logger.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+static constexpr char FILE_MAGIC[8] = {'C', 'S', 'I', 'M', 'S', 'N', 'A', 'P'};
+static constexpr uint32_t FILE_VERSION = 5;
+static constexpr size_t ARRAY_ALIGNMENT = 8;
+static constexpr char SNAPSHOT_SUFFIX[] = ".snapshot";
+
+namespace
+{
+
+struct SnapshotHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t nodeSize;
+    uint32_t edgeSize;
+    uint32_t ecuIdentLength; ///< the ident is at the start of the blob
+    uint64_t sourceSize;
+    int64_t sourceMtimeNs;
+    uint64_t nodeCount;
+    uint64_t edgeCount;
+    uint64_t denseEdgeCount;
+    uint64_t patternBlockCount;
+    uint64_t leafCount;
+    uint64_t nodesOffset;
+    uint64_t edgesOffset;
+    uint64_t denseEdgesOffset;
+    uint64_t patternBlocksOffset;
+    uint64_t leavesOffset;
+    uint64_t blobOffset;
+    uint64_t blobSize;
+};
+
+/**
+ * A response in the blob: the literal, the bytes and the table key (right
+ * after the bytes), or only the table key of a Lua function or a list of
+ * responses, which are compiled again from the script.
+ */
+struct SnapshotLeaf
+{
+    uint64_t textOffset;
+    uint64_t bytesOffset;
+    uint32_t textLength;
+    uint32_t bytesLength;
+    uint32_t isResolved; ///< a Lua function or list, resolved by its table key
+    uint32_t keyLength; ///< 0 for resolved entries, their text is the key
+    uint64_t priority; ///< see `RequestByteTreeNode::getPriority()`
+};
+
+/// the read-only mapping of a snapshot, kept alive by the matchers using it
+struct MappedSnapshot
+{
+    void* pData = MAP_FAILED;
+    size_t size = 0;
+
+    ~MappedSnapshot()
+    {
+        if (pData != MAP_FAILED)
+        {
+            munmap(pData, size);
+        }
+    }
+};
+
+inline uint64_t alignArray(uint64_t offset) noexcept
+{
+    return (offset + ARRAY_ALIGNMENT - 1) & ~uint64_t(ARRAY_ALIGNMENT - 1);
+}
+
+/**
+ * @return false if the script does not exist
+ */
+bool getSourceStamp(const string& luaScript, uint64_t& size, int64_t& mtimeNs) noexcept
+{
+    struct stat st;
+    if (stat(luaScript.c_str(), &st) != 0)
+    {
+        return false;
+    }
+    size = uint64_t(st.st_size);
+    mtimeNs = int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    return true;
+}
+
+/// @return true if `count` elements of `size` bytes at `offset` are within the file
+bool isInFile(uint64_t offset, uint64_t count, uint64_t size, uint64_t fileSize) noexcept
+{
+    return offset <= fileSize && count <= (fileSize - offset) / (size > 0 ? size : 1);
+}
+
+} // namespace
+
+/**
+ * @param luaScript: the path of the Lua script
+ * @return the path of the snapshot of the given script
+ */
+string RequestSnapshot::getSnapshotFile(const string& luaScript)
+{
+    return luaScript + SNAPSHOT_SUFFIX;
+}
+
+/**
+ * Writes the snapshot of the given matcher. The file is written under a
+ * temporary name and renamed, so a simulator starting at the same time never
+ * sees a partially written snapshot.
+ *
+ * @param snapshotFile: the path of the snapshot, see `getSnapshotFile()`
+ * @param luaScript: the Lua script the matcher was built from
+ * @param ecuIdent: the ident of the ECU table in the script
+ * @param matcher: the compiled request table, the Lua functions need their
+ *                 `tableKey`
+ * @return 0 on success, otherwise a negative value
+ */
+int RequestSnapshot::write(const string& snapshotFile, const string& luaScript,
+                           const string& ecuIdent, const LuaRequestMatcher& matcher) noexcept
+{
+    static_assert(is_trivially_copyable<LuaRequestMatcher::Node>::value, "nodes are stored as they are");
+    static_assert(is_trivially_copyable<LuaRequestMatcher::Edge>::value, "edges are stored as they are");
+    static_assert(is_trivially_copyable<LuaRequestMatcher::PatternBlock>::value, "patterns are stored as they are");
+
+    SnapshotHeader header = {};
+    memcpy(header.magic, FILE_MAGIC, sizeof(header.magic));
+    header.version = FILE_VERSION;
+    header.nodeSize = sizeof(LuaRequestMatcher::Node);
+    header.edgeSize = sizeof(LuaRequestMatcher::Edge);
+    if (!getSourceStamp(luaScript, header.sourceSize, header.sourceMtimeNs))
+    {
+        LOG_ERROR(__func__ << "() stat " << luaScript << ": " << strerror(errno));
+        return -1;
+    }
+
+    // the blob is built in memory, the arrays are written directly from the matcher
+    vector<SnapshotLeaf> leaves;
+    leaves.reserve(matcher.leaves_.size());
+    string blob = ecuIdent;
+    header.ecuIdentLength = uint32_t(ecuIdent.size());
+    for (size_t i = 0; i < matcher.leaves_.size(); ++i)
+    {
+        const RequestResponse& response = matcher.leaves_[i];
+        SnapshotLeaf leaf = {};
+        // the position of a list is state, so lists are compiled again like functions, as the delays
+        const bool isResolved = response.isLuaFunction() || response.isSequence() || response.pDelay;
+        const string& text = isResolved ? response.tableKey : response.literal;
+        if (isResolved && text.empty())
+        {
+            LOG_WARNING("No snapshot of " << luaScript << ", a Lua function has no table key");
+            return -2;
+        }
+        leaf.isResolved = isResolved ? 1 : 0;
+        leaf.textOffset = blob.size();
+        leaf.textLength = uint32_t(text.size());
+        blob += text;
+        leaf.bytesOffset = blob.size();
+        leaf.bytesLength = uint32_t(response.bytes.size());
+        blob.append(reinterpret_cast<const char*>(response.bytes.data()), response.bytes.size());
+        if (!isResolved)
+        {
+            leaf.keyLength = uint32_t(response.tableKey.size());
+            blob += response.tableKey;
+        }
+        leaf.priority = matcher.leafPriorities_[i];
+        leaves.push_back(leaf);
+    }
+
+    header.nodeCount = matcher.nodeCount_;
+    header.edgeCount = matcher.edgeCount_;
+    header.denseEdgeCount = matcher.denseEdgeCount_;
+    header.patternBlockCount = matcher.patternBlockCount_;
+    header.leafCount = leaves.size();
+    header.nodesOffset = alignArray(sizeof(header));
+    header.edgesOffset = alignArray(header.nodesOffset + header.nodeCount * sizeof(LuaRequestMatcher::Node));
+    header.denseEdgesOffset = alignArray(header.edgesOffset + header.edgeCount * sizeof(LuaRequestMatcher::Edge));
+    header.patternBlocksOffset = alignArray(header.denseEdgesOffset + header.denseEdgeCount * sizeof(uint32_t));
+    header.leavesOffset = alignArray(header.patternBlocksOffset
+                                     + header.patternBlockCount * sizeof(LuaRequestMatcher::PatternBlock));
+    header.blobOffset = header.leavesOffset + header.leafCount * sizeof(SnapshotLeaf);
+    header.blobSize = blob.size();
+
+    const string temporaryFile = snapshotFile + ".tmp" + to_string(getpid());
+    ofstream out(temporaryFile, ios::binary | ios::trunc);
+    auto writeAt = [&out](uint64_t offset, const void* pData, size_t size)
+    {
+        static const char padding[ARRAY_ALIGNMENT] = {};
+        const uint64_t position = uint64_t(out.tellp());
+        out.write(padding, streamsize(offset - position));
+        out.write(static_cast<const char*>(pData), streamsize(size));
+    };
+    writeAt(0, &header, sizeof(header));
+    writeAt(header.nodesOffset, matcher.nodes_, header.nodeCount * sizeof(LuaRequestMatcher::Node));
+    writeAt(header.edgesOffset, matcher.edges_, header.edgeCount * sizeof(LuaRequestMatcher::Edge));
+    writeAt(header.denseEdgesOffset, matcher.denseEdges_, header.denseEdgeCount * sizeof(uint32_t));
+    writeAt(header.patternBlocksOffset, matcher.patternBlocks_,
+            header.patternBlockCount * sizeof(LuaRequestMatcher::PatternBlock));
+    writeAt(header.leavesOffset, leaves.data(), leaves.size() * sizeof(SnapshotLeaf));
+    writeAt(header.blobOffset, blob.data(), blob.size());
+    out.close();
+    if (!out || rename(temporaryFile.c_str(), snapshotFile.c_str()) != 0)
+    {
+        LOG_WARNING("Can not write the snapshot " << snapshotFile << ": " << strerror(errno));
+        remove(temporaryFile.c_str());
+        return -3;
+    }
+    LOG_INFO("Wrote the snapshot " << snapshotFile << " (" << dec << header.leafCount << " requests)");
+    return 0;
+}
+
+/**
+ * Loads the snapshot of the given script. The node and edge arrays are used
+ * directly from the mapping, only the responses are copied.
+ *
+ * @param snapshotFile: the path of the snapshot, see `getSnapshotFile()`
+ * @param luaScript: the Lua script the snapshot has to match
+ * @param ecuIdent: the ident of the ECU table the snapshot has to match
+ * @param resolveFunction: returns the response of a Lua function, list or delayed entry
+ * @return the matcher or `nullptr` if there is no valid snapshot of the
+ *         current script
+ */
+shared_ptr<const LuaRequestMatcher> RequestSnapshot::load(const string& snapshotFile, const string& luaScript,
+                                                          const string& ecuIdent,
+                                                          const FunctionResolver& resolveFunction)
+{
+    using Node = LuaRequestMatcher::Node;
+    using Edge = LuaRequestMatcher::Edge;
+    using PatternBlock = LuaRequestMatcher::PatternBlock;
+    constexpr uint32_t NO_NODE = LuaRequestMatcher::NO_NODE;
+
+    uint64_t sourceSize;
+    int64_t sourceMtimeNs;
+    if (!getSourceStamp(luaScript, sourceSize, sourceMtimeNs))
+    {
+        return nullptr;
+    }
+    const int fd = open(snapshotFile.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+    struct stat st;
+    auto pMapping = make_shared<MappedSnapshot>();
+    if (fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(SnapshotHeader))
+    {
+        pMapping->size = size_t(st.st_size);
+        pMapping->pData = mmap(nullptr, pMapping->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (pMapping->pData == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    const uint8_t* pFile = static_cast<const uint8_t*>(pMapping->pData);
+    const uint64_t fileSize = pMapping->size;
+    SnapshotHeader header;
+    memcpy(&header, pFile, sizeof(header));
+    if (memcmp(header.magic, FILE_MAGIC, sizeof(header.magic)) != 0 || header.version != FILE_VERSION
+        || header.nodeSize != sizeof(Node) || header.edgeSize != sizeof(Edge))
+    {
+        LOG_INFO("Ignoring the snapshot " << snapshotFile << " of another simulator version");
+        return nullptr;
+    }
+    if (header.sourceSize != sourceSize || header.sourceMtimeNs != sourceMtimeNs)
+    {
+        LOG_INFO("Ignoring the outdated snapshot " << snapshotFile);
+        return nullptr;
+    }
+    const bool isValidLayout = header.nodeCount < NO_NODE && header.leafCount < NO_NODE
+        && header.nodesOffset % ARRAY_ALIGNMENT == 0 && header.edgesOffset % ARRAY_ALIGNMENT == 0
+        && header.denseEdgesOffset % ARRAY_ALIGNMENT == 0 && header.patternBlocksOffset % ARRAY_ALIGNMENT == 0
+        && header.leavesOffset % ARRAY_ALIGNMENT == 0
+        && isInFile(header.nodesOffset, header.nodeCount, sizeof(Node), fileSize)
+        && isInFile(header.edgesOffset, header.edgeCount, sizeof(Edge), fileSize)
+        && isInFile(header.denseEdgesOffset, header.denseEdgeCount, sizeof(uint32_t), fileSize)
+        && isInFile(header.patternBlocksOffset, header.patternBlockCount, sizeof(PatternBlock), fileSize)
+        && isInFile(header.leavesOffset, header.leafCount, sizeof(SnapshotLeaf), fileSize)
+        && isInFile(header.blobOffset, header.blobSize, 1, fileSize)
+        && header.ecuIdentLength <= header.blobSize;
+    const char* pBlob = reinterpret_cast<const char*>(pFile + header.blobOffset);
+    if (!isValidLayout || string(pBlob, header.ecuIdentLength) != ecuIdent)
+    {
+        LOG_WARNING("Ignoring the invalid snapshot " << snapshotFile);
+        return nullptr;
+    }
+
+    // a broken snapshot must not make the lookups read outside of the arrays
+    const Node* pNodes = reinterpret_cast<const Node*>(pFile + header.nodesOffset);
+    const Edge* pEdges = reinterpret_cast<const Edge*>(pFile + header.edgesOffset);
+    const uint32_t* pDenseEdges = reinterpret_cast<const uint32_t*>(pFile + header.denseEdgesOffset);
+    const PatternBlock* pPatternBlocks = reinterpret_cast<const PatternBlock*>(pFile + header.patternBlocksOffset);
+    auto isNode = [&header](uint32_t index) { return index == NO_NODE || index < header.nodeCount; };
+    bool isValid = true;
+    for (uint64_t i = 0; i < header.nodeCount && isValid; ++i)
+    {
+        const Node& node = pNodes[i];
+        isValid = isNode(node.placeholder) && isNode(node.wildcardChild)
+            && (node.leaf == NO_NODE || node.leaf < header.leafCount)
+            && (node.dense ? uint64_t(node.firstEdge) + 256 <= header.denseEdgeCount
+                           : uint64_t(node.firstEdge) + node.edgeCount <= header.edgeCount)
+            && uint64_t(node.firstPatternBlock) + node.patternBlockCount <= header.patternBlockCount;
+    }
+    for (uint64_t i = 0; i < header.edgeCount && isValid; ++i)
+    {
+        isValid = pEdges[i].node < header.nodeCount;
+    }
+    for (uint64_t i = 0; i < header.denseEdgeCount && isValid; ++i)
+    {
+        isValid = isNode(pDenseEdges[i]);
+    }
+    for (uint64_t i = 0; i < header.patternBlockCount && isValid; ++i)
+    {
+        // an unused entry must never match
+        const PatternBlock& block = pPatternBlocks[i];
+        for (size_t lane = 0; lane < LuaRequestMatcher::PATTERN_BLOCK_SIZE && isValid; ++lane)
+        {
+            isValid = block.nodes[lane] < header.nodeCount || (block.masks[lane] == 0 && block.values[lane] != 0);
+        }
+    }
+
+    auto pMatcher = make_shared<LuaRequestMatcher>();
+    pMatcher->leaves_.reserve(header.leafCount);
+    pMatcher->leafPriorities_.reserve(header.leafCount);
+    const SnapshotLeaf* pLeaves = reinterpret_cast<const SnapshotLeaf*>(pFile + header.leavesOffset);
+    for (uint64_t i = 0; i < header.leafCount && isValid; ++i)
+    {
+        const SnapshotLeaf& leaf = pLeaves[i];
+        isValid = isInFile(leaf.textOffset, leaf.textLength, 1, header.blobSize)
+            && isInFile(leaf.bytesOffset, uint64_t(leaf.bytesLength) + leaf.keyLength, 1, header.blobSize);
+        if (!isValid)
+        {
+            break;
+        }
+        const string text(pBlob + leaf.textOffset, leaf.textLength);
+        if (leaf.isResolved)
+        {
+            RequestResponse response = resolveFunction(text);
+            isValid = response.isLuaFunction() || response.isSequence() || response.pDelay;
+            pMatcher->leaves_.push_back(move(response));
+        }
+        else
+        {
+            RequestResponse response;
+            response.literal = text;
+            response.bytes.assign(pBlob + leaf.bytesOffset, pBlob + leaf.bytesOffset + leaf.bytesLength);
+            response.tableKey.assign(pBlob + leaf.bytesOffset + leaf.bytesLength, leaf.keyLength);
+            pMatcher->leaves_.push_back(move(response));
+        }
+        pMatcher->leafPriorities_.push_back(leaf.priority);
+    }
+    if (!isValid)
+    {
+        LOG_WARNING("Ignoring the invalid snapshot " << snapshotFile);
+        return nullptr;
+    }
+
+    pMatcher->nodes_ = pNodes;
+    pMatcher->nodeCount_ = header.nodeCount;
+    pMatcher->edges_ = pEdges;
+    pMatcher->edgeCount_ = header.edgeCount;
+    pMatcher->denseEdges_ = pDenseEdges;
+    pMatcher->denseEdgeCount_ = header.denseEdgeCount;
+    pMatcher->patternBlocks_ = pPatternBlocks;
+    pMatcher->patternBlockCount_ = header.patternBlockCount;
+    pMatcher->pStorage_ = move(pMapping);
+    pMatcher->pHits_ = make_shared<RequestHitCounters>(pMatcher->leaves_.size());
+    LOG_INFO("Loaded the snapshot " << snapshotFile << " (" << dec << header.leafCount << " requests)");
+    return pMatcher;
+}
@@ -0,0 +1,46 @@
+/**
+ * @file request_snapshot.h
+ *
+ */
+
+#ifndef REQUEST_SNAPSHOT_H
+#define REQUEST_SNAPSHOT_H
+
+#include "compiled_request_matcher.h"
+#include "request_response.h"
+#include <functional>
+#include <memory>
+#include <string>
+
+/**
+ * Binary snapshot of a compiled request table (e.g. the `Raw` table of an
+ * ECU), written next to the Lua script as `<script>.snapshot`.
+ *
+ * Building the matcher of a large table from Lua means enumerating all keys,
+ * cleaning and decoding every key and every response and building the tree
+ * of `shared_ptr`s, which takes seconds for captured tables with hundreds of
+ * thousands of entries. The snapshot holds the result: the node and edge
+ * arrays of the `CompiledRequestMatcher`, which are memory-mapped as they
+ * are (read-only, so several simulator processes share the pages), and the
+ * decoded static responses. Only the entries defined as Lua function are
+ * stored by their table key and resolved in the Lua state on loading.
+ *
+ * The snapshot records the size and modification time of the script and of
+ * the format. A snapshot not matching the script is ignored and rebuilt.
+ */
+class RequestSnapshot
+{
+public:
+    /// resolves the Lua function, list or delayed entry of the given table key
+    using FunctionResolver = std::function<RequestResponse(const std::string& tableKey)>;
+
+    static std::string getSnapshotFile(const std::string& luaScript);
+    static int write(const std::string& snapshotFile, const std::string& luaScript,
+                     const std::string& ecuIdent, const LuaRequestMatcher& matcher) noexcept;
+    static std::shared_ptr<const LuaRequestMatcher> load(const std::string& snapshotFile,
+                                                         const std::string& luaScript,
+                                                         const std::string& ecuIdent,
+                                                         const FunctionResolver& resolveFunction);
+};
+
+#endif /* REQUEST_SNAPSHOT_H */
@@ -0,0 +1,136 @@
+/**
+ * @file response_cache.cpp
+ *
+ * This file contains the cache of the responses of cacheable Lua functions.
+ */
+
+#include "response_cache.h"
+
+using namespace std;
+
+/**
+ * Constructor.
+ *
+ * @param ttl: the time an entry is valid in simulation time, 0 = until
+ *             invalidated
+ * @param pEpoch: the epoch of the ECU, see `invalidateCache()`
+ * @param capacity: the max. number of cached requests
+ */
+ResponseCache::ResponseCache(SimulationClock::Duration ttl, shared_ptr<const Epoch> pEpoch, size_t capacity)
+: ttl_(ttl)
+, pEpoch_(move(pEpoch))
+, capacity_(capacity > 0 ? capacity : 1)
+{
+}
+
+/**
+ * Looks up the cached response of a request and marks it as recently used.
+ * Expired and invalidated entries are removed. Must be called with the mutex
+ * locked.
+ *
+ * @return the entry or `nullptr` if there is no valid one
+ */
+const ResponseCache::Entry *ResponseCache::findEntry(string_view request)
+{
+    const auto iter = index_.find(request);
+    if (iter == index_.end())
+    {
+        return nullptr;
+    }
+    const auto entry = iter->second;
+    if (entry->epoch != pEpoch_->load(memory_order_relaxed)
+        || (ttl_ != SimulationClock::Duration::zero() && SimulationClock::getInstance().now() >= entry->expiresAt))
+    {
+        index_.erase(iter);
+        entries_.erase(entry);
+        return nullptr;
+    }
+    entries_.splice(entries_.begin(), entries_, entry);
+    return &(*entry);
+}
+
+/**
+ * @param request: the request, see `toKey()`
+ * @param response: replaced by the cached response, keeps its capacity
+ * @return false if the request is not cached (`response` is not changed)
+ */
+bool ResponseCache::find(string_view request, vector<uint8_t>& response)
+{
+    lock_guard<mutex> lock(mutex_);
+    const Entry *pEntry = findEntry(request);
+    if (pEntry == nullptr)
+    {
+        return false;
+    }
+    response.assign(pEntry->response.cbegin(), pEntry->response.cend());
+    return true;
+}
+
+/**
+ * @param request: the request
+ * @param response: replaced by the cached response, keeps its capacity
+ * @return false if the request is not cached (`response` is not changed)
+ */
+bool ResponseCache::find(string_view request, string& response)
+{
+    lock_guard<mutex> lock(mutex_);
+    const Entry *pEntry = findEntry(request);
+    if (pEntry == nullptr)
+    {
+        return false;
+    }
+    response.assign(pEntry->response);
+    return true;
+}
+
+/**
+ * Caches the response of a request, the least recently used request is
+ * dropped if the cache is full.
+ *
+ * @param request: the request
+ * @param response: the response of the Lua function
+ */
+void ResponseCache::insert(string_view request, string_view response)
+{
+    const SimulationClock::TimePoint expiresAt = ttl_ != SimulationClock::Duration::zero()
+        ? SimulationClock::getInstance().now() + ttl_ : SimulationClock::TimePoint::max();
+    const uint32_t epoch = pEpoch_->load(memory_order_relaxed);
+
+    lock_guard<mutex> lock(mutex_);
+    const auto iter = index_.find(request);
+    if (iter != index_.end())
+    {
+        auto entry = iter->second;
+        entry->response.assign(response);
+        entry->expiresAt = expiresAt;
+        entry->epoch = epoch;
+        entries_.splice(entries_.begin(), entries_, entry);
+        return;
+    }
+    if (entries_.size() >= capacity_)
+    {
+        index_.erase(entries_.back().request);
+        entries_.pop_back();
+    }
+    entries_.push_front(Entry{string(request), string(response), expiresAt, epoch});
+    index_.emplace(entries_.front().request, entries_.begin());
+}
+
+/**
+ * Removes all entries.
+ */
+void ResponseCache::clear()
+{
+    lock_guard<mutex> lock(mutex_);
+    index_.clear();
+    entries_.clear();
+}
+
+/**
+ * @return the number of cached requests, including expired ones not yet removed
+ */
+size_t ResponseCache::size() const
+{
+    lock_guard<mutex> lock(mutex_);
+    return entries_.size();
+}
@@ -0,0 +1,80 @@
+/**
+ * @file response_cache.h
+ *
+ */
+
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include "simulation_clock.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * The responses of a Lua function declared as cacheable with `cached()`,
+ * by request. A repeated request is answered from the cache without entering
+ * the Lua VM, e.g. the polling of a computed VIN or version string.
+ *
+ * The cache is part of a compiled table entry and holds the latest
+ * `capacity` requests (least recently used first out). An entry expires
+ * after the TTL in simulation time, a TTL of 0 ("pure") never. All caches of
+ * an ECU share an epoch, `invalidateCache()` in Lua increments it, which
+ * drops all their entries at once.
+ */
+class ResponseCache
+{
+public:
+    using Epoch = std::atomic<std::uint32_t>;
+
+    /// the max. number of requests cached by an entry
+    static constexpr std::size_t DEFAULT_CAPACITY = 64;
+
+    ResponseCache(SimulationClock::Duration ttl, std::shared_ptr<const Epoch> pEpoch,
+                  std::size_t capacity = DEFAULT_CAPACITY);
+    ResponseCache(const ResponseCache& orig) = delete;
+    ResponseCache& operator =(const ResponseCache& orig) = delete;
+    virtual ~ResponseCache() = default;
+
+    bool find(std::string_view request, std::vector<std::uint8_t>& response);
+    bool find(std::string_view request, std::string& response);
+    void insert(std::string_view request, std::string_view response);
+    void clear();
+    std::size_t size() const;
+    SimulationClock::Duration getTtl() const noexcept { return ttl_; }
+
+    /**
+     * @return the request bytes as key of `find()` and `insert()`
+     */
+    static std::string_view toKey(const std::uint8_t *request, std::size_t length) noexcept
+    {
+        return std::string_view(reinterpret_cast<const char*> (request), length);
+    }
+
+private:
+    struct Entry
+    {
+        std::string request;
+        std::string response;
+        SimulationClock::TimePoint expiresAt;
+        std::uint32_t epoch;
+    };
+
+    const SimulationClock::Duration ttl_;
+    const std::shared_ptr<const Epoch> pEpoch_;
+    const std::size_t capacity_;
+    mutable std::mutex mutex_;
+    std::list<Entry> entries_; ///< the most recently used first
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index_; ///< views into `Entry::request`
+
+    const Entry *findEntry(std::string_view request);
+};
+
+#endif /* RESPONSE_CACHE_H */
@@ -0,0 +1,217 @@
+/**
+ * @file response_delay.cpp
+ *
+ * The response time distributions of the ECUs and the timer sending the
+ * delayed responses, see `ResponseDelay` and `DelayedResponses`.
+ */
+
+#include "response_delay.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+/// the resolution of the delays, the tick of the `TimerWheel`
+static constexpr chrono::milliseconds DELAY_RESOLUTION(1);
+
+/**
+ * @param delay: the delay in milliseconds
+ * @return a distribution which always returns the given delay
+ */
+ResponseDelay ResponseDelay::fixed(double delay) noexcept
+{
+    ResponseDelay responseDelay;
+    responseDelay.distribution_ = Distribution::FIXED;
+    responseDelay.a_ = delay;
+    return responseDelay;
+}
+
+/**
+ * @param min: the min. delay in milliseconds
+ * @param max: the max. delay in milliseconds
+ * @return a distribution returning delays evenly distributed between both
+ */
+ResponseDelay ResponseDelay::uniform(double min, double max) noexcept
+{
+    ResponseDelay responseDelay;
+    responseDelay.distribution_ = Distribution::UNIFORM;
+    responseDelay.a_ = min;
+    responseDelay.b_ = max;
+    return responseDelay;
+}
+
+/**
+ * @param mean: the mean delay in milliseconds
+ * @param stddev: the standard deviation in milliseconds
+ * @return a distribution returning normally distributed delays, cut off at 0
+ */
+ResponseDelay ResponseDelay::normal(double mean, double stddev) noexcept
+{
+    ResponseDelay responseDelay;
+    responseDelay.distribution_ = Distribution::NORMAL;
+    responseDelay.a_ = mean;
+    responseDelay.b_ = stddev;
+    return responseDelay;
+}
+
+/**
+ * @param bins: the recorded delays in milliseconds with their counts, bins
+ *              without a positive count are skipped
+ * @return a distribution returning one of the delays, with the probability of
+ *         its share of all counts
+ */
+ResponseDelay ResponseDelay::histogram(const vector<pair<double, double>>& bins)
+{
+    ResponseDelay responseDelay;
+    responseDelay.distribution_ = Distribution::HISTOGRAM;
+    double sum = 0;
+    for (const pair<double, double>& bin : bins)
+    {
+        if (bin.second > 0)
+        {
+            sum += bin.second;
+            responseDelay.delays_.push_back(bin.first);
+            responseDelay.cumulativeWeights_.push_back(sum);
+        }
+    }
+    return responseDelay;
+}
+
+/**
+ * @return false if the parameters do not describe a distribution, e.g. a
+ *         negative delay or a histogram without counts
+ */
+bool ResponseDelay::isValid() const noexcept
+{
+    switch (distribution_)
+    {
+        case Distribution::FIXED:
+            return a_ >= 0;
+        case Distribution::UNIFORM:
+            return a_ >= 0 && b_ >= a_;
+        case Distribution::NORMAL:
+            return a_ >= 0 && b_ >= 0;
+        case Distribution::HISTOGRAM:
+            return !delays_.empty() && all_of(delays_.cbegin(), delays_.cend(), [](double d) { return d >= 0; });
+    }
+    return false;
+}
+
+/**
+ * Samples a delay with the random generator of the calling thread.
+ *
+ * @return the delay of the next response, rounded to milliseconds
+ */
+chrono::milliseconds ResponseDelay::sample() const
+{
+    static thread_local mt19937 random{random_device{}()};
+    return sample(random);
+}
+
+/**
+ * @param random: the random generator
+ * @return the delay of the next response, rounded to milliseconds
+ */
+chrono::milliseconds ResponseDelay::sample(mt19937& random) const
+{
+    double delay = a_;
+    switch (distribution_)
+    {
+        case Distribution::FIXED:
+            break;
+        case Distribution::UNIFORM:
+            delay = uniform_real_distribution<double>(a_, b_)(random);
+            break;
+        case Distribution::NORMAL:
+            delay = b_ > 0 ? normal_distribution<double>(a_, b_)(random) : a_;
+            break;
+        case Distribution::HISTOGRAM:
+        {
+            if (delays_.empty())
+            {
+                return chrono::milliseconds::zero();
+            }
+            const double weight = uniform_real_distribution<double>(0, cumulativeWeights_.back())(random);
+            const auto it = upper_bound(cumulativeWeights_.cbegin(), cumulativeWeights_.cend(), weight);
+            delay = delays_[min(size_t(it - cumulativeWeights_.cbegin()), delays_.size() - 1)];
+            break;
+        }
+    }
+    return chrono::milliseconds(llround(max(delay, 0.0)));
+}
+
+/**
+ * Constructor.
+ *
+ * @param pTransport: sends the responses, must outlive the instance
+ * @param wheel: the timer wheel sending the responses
+ */
+DelayedResponses::DelayedResponses(UdsTransport* pTransport, TimerWheel& wheel)
+: pTransport_(pTransport)
+, timer_(wheel, [this]() { sendDueResponses(); })
+{
+}
+
+/**
+ * Queues a response to be sent after the given delay or, if responses are
+ * queued already, after the last of them.
+ *
+ * @param response: the response, copied
+ * @param length: the length of the response in bytes
+ * @param timer: measures the request, taken over if the response is queued
+ * @param delay: the response time
+ * @return false if the response has to be sent right away by the caller,
+ *         i.e. without a delay and with no response queued
+ */
+bool DelayedResponses::send(const uint8_t* response, size_t length, RequestTimer& timer, chrono::milliseconds delay)
+{
+    lock_guard<mutex> lock(mutex_);
+    if (delay <= chrono::milliseconds::zero() && queue_.empty())
+    {
+        return false;
+    }
+    const SimulationClock::TimePoint now = SimulationClock::getInstance().now();
+    SimulationClock::TimePoint deadline = now + delay;
+    if (!queue_.empty())
+    {
+        deadline = max(deadline, queue_.back().deadline);
+    }
+    queue_.push_back(Entry{deadline, vector<uint8_t>(response, response + length), move(timer)});
+    if (queue_.size() == 1)
+    {
+        timer_.schedule(delay);
+    }
+    return true;
+}
+
+/**
+ * @return the number of responses waiting for their delay
+ */
+size_t DelayedResponses::getQueuedResponses() const
+{
+    lock_guard<mutex> lock(mutex_);
+    return queue_.size();
+}
+
+/**
+ * Sends the responses whose delay has passed and schedules the timer for the
+ * next one. Called on the wheel thread. The responses are sent with the lock
+ * held, so a response sent right away by `send()` never overtakes them.
+ */
+void DelayedResponses::sendDueResponses()
+{
+    lock_guard<mutex> lock(mutex_);
+    const SimulationClock::TimePoint now = SimulationClock::getInstance().now();
+    // the wheel fires at the start of a tick, so a deadline within the tick is due
+    while (!queue_.empty() && queue_.front().deadline < now + DELAY_RESOLUTION)
+    {
+        Entry& entry = queue_.front();
+        pTransport_->sendData(entry.response.data(), entry.response.size());
+        entry.timer.responseSent(entry.response.data(), entry.response.size());
+        queue_.pop_front();
+    }
+    if (!queue_.empty())
+    {
+        timer_.schedule(chrono::ceil<chrono::milliseconds>(queue_.front().deadline - now));
+    }
+}
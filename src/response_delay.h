@@ -0,0 +1,102 @@
+/**
+ * @file response_delay.h
+ *
+ */
+
+#ifndef RESPONSE_DELAY_H
+#define RESPONSE_DELAY_H
+
+#include "metrics.h"
+#include "simulation_clock.h"
+#include "timer_wheel.h"
+#include "uds_transport.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <utility>
+#include <vector>
+
+/**
+ * The distribution of the response time of an ECU or of a single `Raw` entry,
+ * in milliseconds from the request to the response:
+ *
+ * - fixed: always the same delay
+ * - uniform: evenly distributed between a min. and a max. delay
+ * - normal: normally distributed around a mean, negative samples are 0
+ * - histogram: one of the recorded delays, weighted by their counts
+ *
+ * The delay is sampled for each response, see `sample()`.
+ */
+class ResponseDelay
+{
+public:
+    enum class Distribution
+    {
+        FIXED,
+        UNIFORM,
+        NORMAL,
+        HISTOGRAM
+    };
+
+    static ResponseDelay fixed(double delay) noexcept;
+    static ResponseDelay uniform(double min, double max) noexcept;
+    static ResponseDelay normal(double mean, double stddev) noexcept;
+    static ResponseDelay histogram(const std::vector<std::pair<double, double>>& bins);
+
+    Distribution getDistribution() const noexcept { return distribution_; }
+    bool isValid() const noexcept;
+    std::chrono::milliseconds sample() const;
+    std::chrono::milliseconds sample(std::mt19937& random) const;
+
+private:
+    Distribution distribution_ = Distribution::FIXED;
+    double a_ = 0; ///< the fixed delay, the min. or the mean
+    double b_ = 0; ///< the max. or the standard deviation
+    std::vector<double> delays_; ///< the delays of the histogram
+    std::vector<double> cumulativeWeights_; ///< the summed up counts of the histogram
+};
+
+/**
+ * Sends the delayed responses of an `UdsReceiver`. Instead of blocking the
+ * receiver (or a Lua function holding the Lua state in `sleep()`), a delayed
+ * response is copied into a queue and sent by a timer of the `TimerWheel`,
+ * so emulating the response times of real ECUs costs neither threads nor Lua
+ * time and the receiver keeps on answering e.g. `TesterPresent`.
+ *
+ * The responses are sent in order: a response is never sent before one
+ * queued earlier, even if it has a shorter delay, like an ECU proceeding its
+ * requests one after another.
+ */
+class DelayedResponses
+{
+public:
+    explicit DelayedResponses(UdsTransport* pTransport, TimerWheel& wheel = TimerWheel::getInstance());
+    DelayedResponses(const DelayedResponses& orig) = delete;
+    DelayedResponses& operator =(const DelayedResponses& orig) = delete;
+    virtual ~DelayedResponses() = default;
+
+    bool send(const std::uint8_t* response, std::size_t length, RequestTimer& timer,
+              std::chrono::milliseconds delay);
+    std::size_t getQueuedResponses() const;
+
+private:
+    struct Entry
+    {
+        SimulationClock::TimePoint deadline;
+        std::vector<std::uint8_t> response;
+        RequestTimer timer;
+    };
+
+    UdsTransport* const pTransport_;
+    mutable std::mutex mutex_;
+    std::deque<Entry> queue_; ///< ordered by deadline
+    /// destroyed first, so its callback never runs on a destroyed queue
+    TimerWheel::Timer timer_;
+
+    void sendDueResponses();
+};
+
+#endif /* RESPONSE_DELAY_H */
@@ -0,0 +1,494 @@
+/**
+ * @file response_on_event_service.cpp
+ *
+ * The responses sent on events, see `ResponseOnEventService`.
+ */
+
+#include "response_on_event_service.h"
+#include "service_identifier.h"
+#include "simulation_clock.h"
+#include "vehicle_signals.h"
+#include <algorithm>
+
+using namespace std;
+
+static void setNegativeResponse(vector<uint8_t>& response, uint8_t sid, uint8_t nrc)
+{
+    response.assign({ERROR, sid, nrc});
+}
+
+/**
+ * @param rates: the periods of the timer events, see `ON_TIMER_INTERRUPT`
+ * @param pSessionCtrl: the session of the ECU, `nullptr` for the default session only
+ * @param pDtcStore: the fault memory of the ECU, reports its changes
+ * @param reader: reads the data identifiers, called from the thread of the
+ *                request and the wheel thread
+ * @param responder: answers the `ReadDTCInformation` requests of the events
+ * @param sender: sends the responses of the events
+ * @param wheel: the timer wheel checking the events
+ */
+ResponseOnEventService::ResponseOnEventService(const PeriodicDataConfiguration& rates,
+                                               SessionController* pSessionCtrl, shared_ptr<DtcStore> pDtcStore,
+                                               DataReader reader, Responder responder, Sender sender,
+                                               TimerWheel& wheel)
+: rates_(rates)
+, pSessionCtrl_(pSessionCtrl)
+, pDtcStore_(move(pDtcStore))
+, reader_(move(reader))
+, responder_(move(responder))
+, sender_(move(sender))
+, timer_(wheel, [this]() { expired(); })
+{
+    signalListenerId_ = VehicleSignals::getInstance().addUpdateListener([this]() { notifyChange(); });
+    dtcListenerId_ = pDtcStore_->addChangeListener([this]() { notifyChange(); });
+}
+
+/**
+ * Destructor. Removes the listeners and stops the timer before this object
+ * is destroyed, since they call `notifyChange()` and `expired()`.
+ */
+ResponseOnEventService::~ResponseOnEventService()
+{
+    VehicleSignals::getInstance().removeUpdateListener(signalListenerId_);
+    pDtcStore_->removeChangeListener(dtcListenerId_);
+    timer_.cancel();
+}
+
+/**
+ * `86 eventType eventWindowTime [eventTypeRecord serviceToRespondToRecord]`,
+ * answered with `C6 eventType numberOfIdentifiedEvents eventWindowTime
+ * [eventTypeRecord serviceToRespondToRecord]`. Setting up an event of the
+ * same type and record again replaces it.
+ */
+void ResponseOnEventService::proceedRequest(const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    if (length < 2)
+    {
+        setNegativeResponse(response, RESPONSE_ON_EVENT_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+    const uint8_t eventType = request[1] & EVENT_TYPE_MASK;
+    switch (eventType)
+    {
+        case ON_DTC_STATUS_CHANGE:
+        case ON_TIMER_INTERRUPT:
+        case ON_CHANGE_OF_DATA_IDENTIFIER:
+            setUpEvent(eventType, request, length, response);
+            return;
+        case REPORT_ACTIVATED_EVENTS:
+            reportActivatedEvents(response);
+            return;
+        case STOP_RESPONSE_ON_EVENT:
+        case START_RESPONSE_ON_EVENT:
+        case CLEAR_RESPONSE_ON_EVENT:
+            break;
+        default:
+            setNegativeResponse(response, RESPONSE_ON_EVENT_REQ, SUBFUNCTION_NOT_SUPPORTED);
+            return;
+    }
+    if (length != 3)
+    {
+        setNegativeResponse(response, RESPONSE_ON_EVENT_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+    const uint8_t window = request[2];
+    if (eventType == START_RESPONSE_ON_EVENT)
+    {
+        startEvents(window, response);
+        return;
+    }
+    {
+        lock_guard<mutex> lock(mutex_);
+        if (eventType == CLEAR_RESPONSE_ON_EVENT)
+        {
+            events_.clear();
+        }
+        for (Event& event : events_)
+        {
+            event.isStarted = false;
+        }
+        ++version_;
+        updateStarted();
+    }
+    response.assign({RESPONSE_ON_EVENT_RES, eventType, 0x00, window});
+}
+
+/**
+ * Reports a change of a value the events might read, e.g. a written data
+ * identifier. Cheap enough to be called on every change: the events are
+ * checked on the wheel thread, only while they are started.
+ */
+void ResponseOnEventService::notifyChange() noexcept
+{
+    if (isStarted_.load(memory_order_relaxed))
+    {
+        hasChange_ = true;
+        timer_.schedule(chrono::milliseconds(0));
+    }
+}
+
+/**
+ * Stops all events, they are kept until they are cleared. Does not wait for
+ * a running check, so it may be called while holding a lock the reader takes.
+ */
+void ResponseOnEventService::stopAll() noexcept
+{
+    lock_guard<mutex> lock(mutex_);
+    for (Event& event : events_)
+    {
+        event.isStarted = false;
+    }
+    ++version_;
+    updateStarted();
+}
+
+/**
+ * @return the number of started events
+ */
+size_t ResponseOnEventService::getStartedCount() const
+{
+    lock_guard<mutex> lock(mutex_);
+    return size_t(count_if(events_.cbegin(), events_.cend(), [](const Event& event) { return event.isStarted; }));
+}
+
+/**
+ * @return the number of responses sent on events, including the final ones
+ */
+uint64_t ResponseOnEventService::getSentCount() const
+{
+    lock_guard<mutex> lock(mutex_);
+    return sentCount_;
+}
+
+void ResponseOnEventService::setUpEvent(uint8_t type, const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    const size_t recordLength = type == ON_CHANGE_OF_DATA_IDENTIFIER ? 2 : 1;
+    if (length < 3 + recordLength + 1)
+    {
+        setNegativeResponse(response, RESPONSE_ON_EVENT_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+    Event event;
+    event.type = type;
+    event.window = request[2];
+    event.record.assign(request + 3, request + 3 + recordLength);
+    event.service.assign(request + 3 + recordLength, request + length);
+
+    const uint8_t sid = event.service[0];
+    const bool isValidService = sid == READ_DTC_INFORMATION_REQ
+        || (sid == READ_DATA_BY_IDENTIFIER_REQ && event.service.size() >= 3 && event.service.size() % 2 == 1);
+    if (event.window == 0x00 || !isValidService)
+    {
+        setNegativeResponse(response, RESPONSE_ON_EVENT_REQ, REQUEST_OUT_OF_RANGE);
+        return;
+    }
+    if (type == ON_TIMER_INTERRUPT)
+    {
+        switch (event.record[0])
+        {
+            case PeriodicDataService::SEND_AT_SLOW_RATE:
+                event.period = rates_.slowRate;
+                break;
+            case PeriodicDataService::SEND_AT_MEDIUM_RATE:
+                event.period = rates_.mediumRate;
+                break;
+            case PeriodicDataService::SEND_AT_FAST_RATE:
+                event.period = rates_.fastRate;
+                break;
+            default:
+                setNegativeResponse(response, RESPONSE_ON_EVENT_REQ, REQUEST_OUT_OF_RANGE);
+                return;
+        }
+        if (event.period <= chrono::milliseconds(0))
+        {
+            setNegativeResponse(response, RESPONSE_ON_EVENT_REQ, REQUEST_OUT_OF_RANGE);
+            return;
+        }
+    }
+
+    response.assign({RESPONSE_ON_EVENT_RES, uint8_t(request[1] & ~SUPPRESS_POS_RSP_MSG_INDICATION_BIT), 0x00,
+                     event.window});
+    response.insert(response.cend(), event.record.cbegin(), event.record.cend());
+    response.insert(response.cend(), event.service.cbegin(), event.service.cend());
+
+    lock_guard<mutex> lock(mutex_);
+    auto iter = find_if(events_.begin(), events_.end(), [&event](const Event& other) {
+        return other.type == event.type && other.record == event.record;
+    });
+    if (iter != events_.end())
+    {
+        *iter = move(event);
+    }
+    else if (events_.size() < MAX_RESPONSE_ON_EVENTS)
+    {
+        events_.push_back(move(event));
+    }
+    else
+    {
+        setNegativeResponse(response, RESPONSE_ON_EVENT_REQ, REQUEST_OUT_OF_RANGE);
+        return;
+    }
+    ++version_;
+    updateStarted();
+}
+
+/**
+ * Starts all events which are set up. Their current values are the ones the
+ * changes are detected against.
+ */
+void ResponseOnEventService::startEvents(uint8_t window, vector<uint8_t>& response)
+{
+    lock_guard<mutex> lock(mutex_);
+    if (events_.empty())
+    {
+        setNegativeResponse(response, RESPONSE_ON_EVENT_REQ, REQUEST_SEQUENCE_ERROR);
+        return;
+    }
+    const auto now = SimulationClock::getInstance().now();
+    const UdsSession session = getCurrentSession();
+    for (Event& event : events_)
+    {
+        event.isStarted = true;
+        event.identifiedCount = 0;
+        event.windowEnd = now + chrono::seconds(event.window);
+        event.deadline = now + event.period;
+        if (event.type == ON_CHANGE_OF_DATA_IDENTIFIER)
+        {
+            readValue(session, event);
+        }
+        else if (event.type == ON_DTC_STATUS_CHANGE)
+        {
+            readDtcs(event);
+        }
+    }
+    ++version_;
+    updateStarted();
+    scheduleNext(now);
+    response.assign({RESPONSE_ON_EVENT_RES, START_RESPONSE_ON_EVENT, 0x00, window});
+}
+
+/**
+ * `C6 04 numberOfActivatedEvents [eventType eventWindowTime eventTypeRecord serviceToRespondToRecord]*`
+ */
+void ResponseOnEventService::reportActivatedEvents(vector<uint8_t>& response) const
+{
+    response.assign({RESPONSE_ON_EVENT_RES, REPORT_ACTIVATED_EVENTS, 0x00});
+    lock_guard<mutex> lock(mutex_);
+    for (const Event& event : events_)
+    {
+        if (event.isStarted)
+        {
+            ++response[2];
+            response.push_back(event.type);
+            response.push_back(event.window);
+            response.insert(response.cend(), event.record.cbegin(), event.record.cend());
+            response.insert(response.cend(), event.service.cbegin(), event.service.cend());
+        }
+    }
+}
+
+/**
+ * Reads the data identifier of an `ON_CHANGE_OF_DATA_IDENTIFIER` event.
+ *
+ * @return true if its value changed since the last read
+ */
+bool ResponseOnEventService::readValue(UdsSession session, Event& event)
+{
+    vector<uint8_t> value;
+    if (!reader_(session, uint16_t((event.record[0] << 8) | event.record[1]), value) || value == event.lastValue)
+    {
+        return false;
+    }
+    event.lastValue = move(value);
+    return true;
+}
+
+/**
+ * Reads the DTCs of an `ON_DTC_STATUS_CHANGE` event, masked by its DTCStatusMask.
+ *
+ * @return true if a DTC gained a status bit of the mask since the last read
+ */
+bool ResponseOnEventService::readDtcs(Event& event) const
+{
+    const uint8_t statusMask = event.record[0];
+    vector<DtcRecord> dtcs = pDtcStore_->getDtcs();
+    for (DtcRecord& record : dtcs)
+    {
+        record.status &= statusMask;
+    }
+    dtcs.erase(remove_if(dtcs.begin(), dtcs.end(), [](const DtcRecord& record) { return record.status == 0; }),
+               dtcs.end());
+    sort(dtcs.begin(), dtcs.end(), [](const DtcRecord& a, const DtcRecord& b) { return a.dtc < b.dtc; });
+
+    bool hasChanged = false;
+    auto last = event.lastDtcs.cbegin();
+    for (const DtcRecord& record : dtcs)
+    {
+        while (last != event.lastDtcs.cend() && last->dtc < record.dtc)
+        {
+            ++last;
+        }
+        const uint8_t lastStatus = last != event.lastDtcs.cend() && last->dtc == record.dtc ? last->status : 0;
+        hasChanged = hasChanged || (record.status & ~lastStatus) != 0;
+    }
+    event.lastDtcs = move(dtcs);
+    return hasChanged;
+}
+
+/**
+ * Answers the service to respond to of an event which occurred.
+ *
+ * @param responses: the response is appended, unless it is empty
+ */
+void ResponseOnEventService::respond(UdsSession session, Event& event, vector<vector<uint8_t>>& responses) const
+{
+    vector<uint8_t> response;
+    if (event.service[0] == READ_DATA_BY_IDENTIFIER_REQ)
+    {
+        response.push_back(READ_DATA_BY_IDENTIFIER_RES);
+        vector<uint8_t> data;
+        for (size_t i = 1; i + 1 < event.service.size(); i += 2)
+        {
+            data.clear();
+            if (reader_(session, uint16_t((event.service[i] << 8) | event.service[i + 1]), data))
+            {
+                response.insert(response.cend(), event.service.cbegin() + i, event.service.cbegin() + i + 2);
+                response.insert(response.cend(), data.cbegin(), data.cend());
+            }
+        }
+        if (response.size() == 1)
+        {
+            return;
+        }
+    }
+    else
+    {
+        responder_(event.service.data(), event.service.size(), response);
+        if (response.empty())
+        {
+            return;
+        }
+    }
+    event.identifiedCount = uint8_t(min(event.identifiedCount + 1, 0xFF));
+    responses.push_back(move(response));
+}
+
+/**
+ * Arms the timer with the earliest deadline of the started events, must be
+ * called with the lock held.
+ */
+void ResponseOnEventService::scheduleNext(chrono::steady_clock::time_point now) noexcept
+{
+    bool hasDeadline = false;
+    chrono::steady_clock::time_point next;
+    for (const Event& event : events_)
+    {
+        if (!event.isStarted)
+        {
+            continue;
+        }
+        if (event.type == ON_TIMER_INTERRUPT && (!hasDeadline || event.deadline < next))
+        {
+            next = event.deadline;
+            hasDeadline = true;
+        }
+        if (event.window != INFINITE_EVENT_WINDOW && (!hasDeadline || event.windowEnd < next))
+        {
+            next = event.windowEnd;
+            hasDeadline = true;
+        }
+    }
+    if (hasDeadline)
+    {
+        const auto delay = chrono::ceil<chrono::milliseconds>(next - now);
+        timer_.schedule(max(delay, chrono::milliseconds(0)));
+    }
+}
+
+/**
+ * Updates `isStarted_`, must be called with the lock held.
+ */
+void ResponseOnEventService::updateStarted() noexcept
+{
+    isStarted_ = any_of(events_.cbegin(), events_.cend(), [](const Event& event) { return event.isStarted; });
+}
+
+UdsSession ResponseOnEventService::getCurrentSession() const noexcept
+{
+    return pSessionCtrl_ != nullptr ? pSessionCtrl_->getCurrentUdsSession() : UdsSession::DEFAULT;
+}
+
+/**
+ * Called by the wheel thread after a change or at the earliest deadline.
+ * Checks the started events outside of the lock, since the reader might call
+ * Lua, and sends the responses of the events which occurred. If a request
+ * changed the events meanwhile, the check is dropped.
+ */
+void ResponseOnEventService::expired() noexcept
+{
+    vector<Event> events;
+    uint64_t version;
+    {
+        lock_guard<mutex> lock(mutex_);
+        if (!isStarted_)
+        {
+            return;
+        }
+        events = events_;
+        version = version_;
+    }
+    const bool hasChange = hasChange_.exchange(false);
+    const auto now = SimulationClock::getInstance().now();
+    const UdsSession session = getCurrentSession();
+    vector<vector<uint8_t>> responses;
+    for (Event& event : events)
+    {
+        if (!event.isStarted)
+        {
+            continue;
+        }
+        bool hasOccurred = false;
+        switch (event.type)
+        {
+            case ON_CHANGE_OF_DATA_IDENTIFIER:
+                hasOccurred = hasChange && readValue(session, event);
+                break;
+            case ON_DTC_STATUS_CHANGE:
+                hasOccurred = hasChange && readDtcs(event);
+                break;
+            case ON_TIMER_INTERRUPT:
+                // missed periods are skipped
+                hasOccurred = event.deadline <= now;
+                while (event.deadline <= now)
+                {
+                    event.deadline += event.period;
+                }
+                break;
+        }
+        if (hasOccurred)
+        {
+            respond(session, event, responses);
+        }
+        if (event.window != INFINITE_EVENT_WINDOW && event.windowEnd <= now)
+        {
+            // the final response of the event
+            event.isStarted = false;
+            responses.push_back({RESPONSE_ON_EVENT_RES, event.type, event.identifiedCount, event.window});
+        }
+    }
+    {
+        lock_guard<mutex> lock(mutex_);
+        if (version != version_)
+        {
+            return;
+        }
+        events_ = move(events);
+        sentCount_ += responses.size();
+        updateStarted();
+        scheduleNext(now);
+    }
+    for (const vector<uint8_t>& response : responses)
+    {
+        sender_(response.data(), response.size());
+    }
+}
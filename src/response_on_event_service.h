@@ -0,0 +1,139 @@
+/**
+ * @file response_on_event_service.h
+ *
+ */
+
+#ifndef RESPONSE_ON_EVENT_SERVICE_H
+#define RESPONSE_ON_EVENT_SERVICE_H
+
+#include "uds_service_handler.h"
+#include "session_controller.h"
+#include "periodic_data_service.h"
+#include "dtc_store.h"
+#include "timer_wheel.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+constexpr std::size_t MAX_RESPONSE_ON_EVENTS = 8;
+
+/**
+ * `ResponseOnEvent` (0x86). The tester sets up events with the service to
+ * respond to, `ReadDataByIdentifier` (0x22) or `ReadDTCInformation` (0x19),
+ * and starts them with `05`. When an event occurs, the response of this
+ * service is sent on its own:
+ *
+ * - `01` onDTCStatusChange: a DTC gains a status bit of the DTCStatusMask
+ * - `02` onTimerInterrupt: every period of the `slow`, `medium` or `fast`
+ *   rate of the `PeriodicData` table
+ * - `03` onChangeOfDataIdentifier: the value of the data identifier changes
+ *
+ * Nothing is polled: the `VehicleSignals` and the `DtcStore` report their
+ * changes (as does `notifyChange()`, e.g. for a `WriteDataByIdentifier`),
+ * which only arms a timer of the `TimerWheel`. On expiry the started events
+ * are checked against the values of their last response and the responses of
+ * the events which occurred are sent in one go. The timer events share the
+ * same timer.
+ *
+ * The `eventWindowTime` `02` is infinite, any other value is the window in
+ * seconds. At the end of its window an event stops and the final response
+ * with the number of identified events is sent. `00` stops the events, `06`
+ * clears them and `04` reports the started ones. The events stop on
+ * `stopAll()` as well, e.g. on a session change or an ECU reset; the
+ * storageState bit is ignored.
+ */
+class ResponseOnEventService : public UdsServiceHandler
+{
+public:
+    /// reads a data identifier, returns false if it is unknown
+    using DataReader = std::function<bool(UdsSession session, std::uint16_t dataIdentifier,
+                                          std::vector<std::uint8_t>& data)>;
+    /// answers a `ReadDTCInformation` request, called on the wheel thread
+    using Responder = std::function<void(const std::uint8_t* request, std::size_t length,
+                                         std::vector<std::uint8_t>& response)>;
+    /// sends the responses of the events, called on the wheel thread
+    using Sender = std::function<void(const std::uint8_t* response, std::size_t length)>;
+
+    /// the `eventType` of the request, without the storageState bit
+    enum EventType : std::uint8_t
+    {
+        STOP_RESPONSE_ON_EVENT = 0x00,
+        ON_DTC_STATUS_CHANGE = 0x01,
+        ON_TIMER_INTERRUPT = 0x02,
+        ON_CHANGE_OF_DATA_IDENTIFIER = 0x03,
+        REPORT_ACTIVATED_EVENTS = 0x04,
+        START_RESPONSE_ON_EVENT = 0x05,
+        CLEAR_RESPONSE_ON_EVENT = 0x06
+    };
+    static constexpr std::uint8_t EVENT_TYPE_MASK = 0x3F;
+    static constexpr std::uint8_t INFINITE_EVENT_WINDOW = 0x02;
+
+    ResponseOnEventService(const PeriodicDataConfiguration& rates, SessionController* pSessionCtrl,
+                           std::shared_ptr<DtcStore> pDtcStore, DataReader reader, Responder responder,
+                           Sender sender, TimerWheel& wheel = TimerWheel::getInstance());
+    ResponseOnEventService(const ResponseOnEventService& orig) = delete;
+    ResponseOnEventService& operator =(const ResponseOnEventService& orig) = delete;
+    virtual ~ResponseOnEventService();
+
+    void proceedRequest(const std::uint8_t* request, std::size_t length,
+                        std::vector<std::uint8_t>& response) override;
+    bool hasSubFunction(std::uint8_t sid) const noexcept override { return true; }
+
+    void notifyChange() noexcept;
+    void stopAll() noexcept;
+    std::size_t getStartedCount() const;
+    std::uint64_t getSentCount() const;
+
+private:
+    struct Event
+    {
+        std::uint8_t type;
+        std::uint8_t window; ///< the eventWindowTime
+        std::vector<std::uint8_t> record; ///< the eventTypeRecord
+        std::vector<std::uint8_t> service; ///< the serviceToRespondToRecord
+        std::chrono::milliseconds period{0}; ///< of a timer event
+        bool isStarted = false;
+        std::uint8_t identifiedCount = 0; ///< the numberOfIdentifiedEvents, saturated
+        std::chrono::steady_clock::time_point windowEnd;
+        std::chrono::steady_clock::time_point deadline; ///< of a timer event
+        std::vector<std::uint8_t> lastValue; ///< the value of the data identifier
+        std::vector<DtcRecord> lastDtcs; ///< the DTCs with a masked status, sorted
+    };
+
+    const PeriodicDataConfiguration rates_;
+    SessionController* pSessionCtrl_; ///< might be `nullptr`, e.g. for DoIP
+    const std::shared_ptr<DtcStore> pDtcStore_;
+    const DataReader reader_;
+    const Responder responder_;
+    const Sender sender_;
+
+    mutable std::mutex mutex_;
+    std::vector<Event> events_;
+    std::uint64_t version_ = 0; ///< incremented on every change of `events_` by a request
+    std::uint64_t sentCount_ = 0;
+    std::atomic<bool> isStarted_{false}; ///< read by the listeners without the lock
+    std::atomic<bool> hasChange_{false};
+
+    int signalListenerId_ = -1;
+    int dtcListenerId_ = -1;
+    TimerWheel::Timer timer_;
+
+    void setUpEvent(std::uint8_t type, const std::uint8_t* request, std::size_t length,
+                    std::vector<std::uint8_t>& response);
+    void startEvents(std::uint8_t window, std::vector<std::uint8_t>& response);
+    void reportActivatedEvents(std::vector<std::uint8_t>& response) const;
+    bool readValue(UdsSession session, Event& event);
+    bool readDtcs(Event& event) const;
+    void respond(UdsSession session, Event& event, std::vector<std::vector<std::uint8_t>>& responses) const;
+    void scheduleNext(std::chrono::steady_clock::time_point now) noexcept;
+    void updateStarted() noexcept;
+    UdsSession getCurrentSession() const noexcept;
+    void expired() noexcept;
+};
+
+#endif /* RESPONSE_ON_EVENT_SERVICE_H */
@@ -0,0 +1,141 @@
+/**
+ * @file response_pending.cpp
+ *
+ * The response pending messages of slow requests, see `ResponsePending`.
+ */
+
+#include "response_pending.h"
+#include "service_identifier.h"
+#include "isotp_sender.h"
+#include "logger.h"
+#include <array>
+
+using namespace std;
+
+/**
+ * @param configuration: the P2 and P2* timing
+ * @param sender: sends a response, called from the wheel thread and the thread of `finish()`
+ */
+ResponsePending::ResponsePending(const ResponsePendingConfiguration& configuration, Sender sender)
+: configuration_(configuration)
+, sender_(move(sender))
+, timer_(TimerWheel::getInstance(), [this]() { expired(); })
+{
+    responseBuffer_.reserve(MAX_UDS_MSG_SIZE);
+}
+
+/**
+ * Destructor. Stops the timer before this object is destroyed, since the
+ * timer calls `expired()`.
+ */
+ResponsePending::~ResponsePending()
+{
+    timer_.cancel();
+}
+
+/**
+ * Starts proceeding a request. The response pending messages are sent until
+ * `finish()` is called.
+ *
+ * @param sid: the SID of the request
+ * @param timer: measures the request, taken over on success
+ * @return false if another request is still pending
+ */
+bool ResponsePending::start(uint8_t sid, RequestTimer& timer)
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        if (isPending_)
+        {
+            return false;
+        }
+        isPending_ = true;
+        sid_ = sid;
+        isPendingSent_ = false;
+        requestTimer_.emplace(move(timer));
+        responseBuffer_.clear();
+    }
+    timer_.schedule(configuration_.p2);
+    return true;
+}
+
+/**
+ * Sends the response buffer as final response, unless it is empty, and ends
+ * the request. A suppressed positive response is still sent after a response
+ * pending message, since the tester waits for it.
+ *
+ * @param isSuppressPosRsp: true if the request suppresses the positive response
+ */
+void ResponsePending::finish(bool isSuppressPosRsp) noexcept
+{
+    // waits for a running `expired()`, so the timer is not armed afterwards
+    timer_.cancel();
+    lock_guard<mutex> lock(mutex_);
+    if (!isPending_)
+    {
+        return;
+    }
+    const bool isSuppressed = isSuppressPosRsp && !isPendingSent_
+                              && !isNegativeResponse(responseBuffer_.data(), responseBuffer_.size());
+    if (!responseBuffer_.empty() && !isSuppressed)
+    {
+        LOG_DEBUG("UDS sending: " << dec << responseBuffer_.size() << " bytes.");
+        sender_(responseBuffer_.data(), responseBuffer_.size());
+        requestTimer_->responseSent(responseBuffer_.data(), responseBuffer_.size());
+    }
+    requestTimer_.reset();
+    isPending_ = false;
+}
+
+/**
+ * Records the queue latency of the current request, see
+ * `RequestTimer::dispatched()`.
+ *
+ * @param lane: the lane the request is proceeded in
+ */
+void ResponsePending::dispatched(DispatchLane lane) noexcept
+{
+    lock_guard<mutex> lock(mutex_);
+    if (requestTimer_)
+    {
+        requestTimer_->dispatched(lane);
+    }
+}
+
+/**
+ * @return true while a request is proceeded
+ */
+bool ResponsePending::isPending() const
+{
+    lock_guard<mutex> lock(mutex_);
+    return isPending_;
+}
+
+/**
+ * @return the number of sent response pending messages
+ */
+size_t ResponsePending::getPendingCount() const
+{
+    lock_guard<mutex> lock(mutex_);
+    return pendingCount_;
+}
+
+/**
+ * Called by the wheel thread if the handler did not finish within P2
+ * respectively P2*.
+ */
+void ResponsePending::expired() noexcept
+{
+    lock_guard<mutex> lock(mutex_);
+    if (!isPending_)
+    {
+        return;
+    }
+    const array<uint8_t, 3> pending = {ERROR, sid_, RESPONSE_PENDING};
+    sender_(pending.data(), pending.size());
+    requestTimer_->responseSent(pending.data(), pending.size());
+    pendingCount_++;
+    isPendingSent_ = true;
+    LOG_DEBUG("UDS response pending for SID 0x" << hex << int(sid_));
+    timer_.schedule(configuration_.p2Star);
+}
@@ -0,0 +1,77 @@
+/**
+ * @file response_pending.h
+ *
+ */
+
+#ifndef RESPONSE_PENDING_H
+#define RESPONSE_PENDING_H
+
+#include "metrics.h"
+#include "timer_wheel.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+constexpr std::chrono::milliseconds DEFAULT_P2_SERVER(50);
+constexpr std::chrono::milliseconds DEFAULT_P2_STAR_SERVER(4000); ///< below the P2* of 5000 ms of a tester
+/// the Lua requests of an ECU queued until further ones are answered with `7F SID 21`
+constexpr std::uint32_t DEFAULT_MAX_QUEUED_REQUESTS = 8;
+
+/**
+ * The timing of the response pending messages, see the `ResponsePending`
+ * table of the ECU.
+ */
+struct ResponsePendingConfiguration
+{
+    std::chrono::milliseconds p2 = DEFAULT_P2_SERVER; ///< the budget of a handler until the first `7F SID 78`
+    std::chrono::milliseconds p2Star = DEFAULT_P2_STAR_SERVER; ///< the interval of the repeated `7F SID 78`
+};
+
+/**
+ * Sends `7F SID 78` (requestCorrectlyReceived-ResponsePending) while a slow
+ * request, i.e. a Lua function running on the Lua worker, is proceeded.
+ *
+ * `start()` arms a timer of the `TimerWheel`. If the handler has not called
+ * `finish()` within P2, the wheel thread sends the first response pending
+ * message and repeats it every P2*. `finish()` sends the final response from
+ * the thread of the handler. Only one request is proceeded at a time.
+ */
+class ResponsePending
+{
+public:
+    using Sender = std::function<void(const std::uint8_t*, std::size_t)>;
+
+    ResponsePending(const ResponsePendingConfiguration& configuration, Sender sender);
+    ResponsePending(const ResponsePending& orig) = delete;
+    ResponsePending& operator =(const ResponsePending& orig) = delete;
+    virtual ~ResponsePending();
+
+    bool start(std::uint8_t sid, RequestTimer& timer);
+    void finish(bool isSuppressPosRsp = false) noexcept;
+    void dispatched(DispatchLane lane) noexcept;
+    bool isPending() const;
+    std::size_t getPendingCount() const;
+
+    /// the response of the current request, written by the handler before `finish()`
+    std::vector<std::uint8_t>& getResponseBuffer() noexcept { return responseBuffer_; }
+
+private:
+    const ResponsePendingConfiguration configuration_;
+    const Sender sender_;
+    mutable std::mutex mutex_;
+    bool isPending_ = false;
+    std::uint8_t sid_ = 0x00;
+    std::size_t pendingCount_ = 0; ///< the response pending messages sent for all requests
+    bool isPendingSent_ = false; ///< a response pending message was sent for the current request
+    std::optional<RequestTimer> requestTimer_;
+    std::vector<std::uint8_t> responseBuffer_;
+    TimerWheel::Timer timer_;
+
+    void expired() noexcept;
+};
+
+#endif /* RESPONSE_PENDING_H */
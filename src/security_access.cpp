@@ -0,0 +1,302 @@
+/**
+ * @file security_access.cpp
+ *
+ * The native seed/key engine of `SecurityAccess`, see `SecurityAccessService`.
+ */
+
+#include "security_access.h"
+#include "service_identifier.h"
+#include "aes128.h"
+#include "logger.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+using namespace std;
+
+static void setNegativeResponse(vector<uint8_t>& response, uint8_t sid, uint8_t nrc)
+{
+    response.assign({ERROR, sid, nrc});
+}
+
+static inline uint64_t rotateLeft(uint64_t value, int bits) noexcept
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+/// SplitMix64, expands the seed into the state of the generator
+static uint64_t splitMix(uint64_t& state) noexcept
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static uint64_t getRandomSeed()
+{
+    random_device device;
+    return (uint64_t(device()) << 32) | device();
+}
+
+/**
+ * Seeds the generator from `std::random_device`.
+ */
+SeedGenerator::SeedGenerator()
+: SeedGenerator(getRandomSeed())
+{
+}
+
+/**
+ * @param seed: the seed, the same seed generates the same numbers
+ */
+SeedGenerator::SeedGenerator(uint64_t seed) noexcept
+{
+    for (uint64_t& word : state_)
+    {
+        word = splitMix(seed);
+    }
+}
+
+/**
+ * @return the next pseudo random number
+ */
+uint64_t SeedGenerator::next() noexcept
+{
+    const uint64_t result = rotateLeft(state_[1] * 5, 7) * 9;
+    const uint64_t t = state_[1] << 17;
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= t;
+    state_[3] = rotateLeft(state_[3], 45);
+    return result;
+}
+
+/**
+ * Fills the buffer with pseudo random bytes.
+ *
+ * @param buffer: the buffer to fill
+ * @param length: the length of the buffer in bytes
+ */
+void SeedGenerator::fill(uint8_t* buffer, size_t length) noexcept
+{
+    while (length > 0)
+    {
+        const uint64_t value = next();
+        const size_t count = min(length, sizeof(value));
+        memcpy(buffer, &value, count);
+        buffer += count;
+        length -= count;
+    }
+}
+
+/**
+ * Calculates the expected key of a seed.
+ *
+ * @param level: the configuration of the security level
+ * @param seed: the sent seed
+ * @return the key or nothing if it can not be calculated (e.g. a failed Lua function)
+ */
+optional<vector<uint8_t>> SecurityAccessService::calculateKey(const SecurityLevelConfiguration& level,
+                                                              const vector<uint8_t>& seed)
+{
+    switch (level.algorithm)
+    {
+        case KeyAlgorithm::XOR:
+        {
+            vector<uint8_t> key = seed;
+            for (size_t i = 0; i < key.size() && !level.secret.empty(); ++i)
+            {
+                key[i] ^= level.secret[i % level.secret.size()];
+            }
+            return key;
+        }
+        case KeyAlgorithm::CRC:
+        {
+            CrcStream crc(level.crcAlgorithm);
+            crc.update(seed.data(), seed.size());
+            crc.update(level.secret.data(), level.secret.size());
+            const uint32_t value = crc.getValue();
+            if (level.crcAlgorithm == CrcAlgorithm::CRC32)
+            {
+                return vector<uint8_t>({uint8_t(value >> 24), uint8_t(value >> 16), uint8_t(value >> 8), uint8_t(value)});
+            }
+            return vector<uint8_t>({uint8_t(value >> 8), uint8_t(value)});
+        }
+        case KeyAlgorithm::AES128:
+        {
+            if (level.secret.size() != Aes128::KEY_SIZE)
+            {
+                return {};
+            }
+            // ECB over the zero padded seed
+            const Aes128 aes(level.secret.data());
+            const size_t blocks = max<size_t>(1, (seed.size() + Aes128::BLOCK_SIZE - 1) / Aes128::BLOCK_SIZE);
+            vector<uint8_t> key(blocks * Aes128::BLOCK_SIZE, 0x00);
+            copy(seed.cbegin(), seed.cend(), key.begin());
+            for (size_t block = 0; block < blocks; ++block)
+            {
+                aes.encryptBlock(&key[block * Aes128::BLOCK_SIZE], &key[block * Aes128::BLOCK_SIZE]);
+            }
+            return key;
+        }
+        case KeyAlgorithm::LUA:
+            if (!level.keyFunction)
+            {
+                return {};
+            }
+            return level.keyFunction(seed);
+    }
+    return {};
+}
+
+SecurityAccessService::Level::Level(const SecurityLevelConfiguration& configuration)
+: configuration(configuration)
+, delayTimer(TimerWheel::getInstance(), [this]() { isDelayed = false; })
+{
+    seed.reserve(configuration.seedLength);
+}
+
+/**
+ * @param pSessionCtrl: the session of the ECU, `nullptr` for the default session only
+ */
+SecurityAccessService::SecurityAccessService(SessionController* pSessionCtrl) noexcept
+: pSessionCtrl_(pSessionCtrl)
+{
+}
+
+/**
+ * Replaces the security levels, all levels are locked afterwards.
+ *
+ * @param levels: the levels of the `SecurityAccess` table
+ */
+void SecurityAccessService::setLevels(const vector<SecurityLevelConfiguration>& levels)
+{
+    levels_.clear();
+    unlockedLevel_ = 0x00;
+    for (const SecurityLevelConfiguration& level : levels)
+    {
+        levels_[level.level] = std::make_unique<Level>(level);
+    }
+}
+
+/**
+ * `27 securityAccessType [securityAccessDataRecord | securityKey]`, answered
+ * with `67 securityAccessType [securitySeed]`.
+ */
+void SecurityAccessService::proceedRequest(const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    if (length < 2)
+    {
+        setNegativeResponse(response, SECURITY_ACCESS_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+    const uint8_t accessType = request[1] & 0x7F;
+    const bool isRequestSeed = (accessType & 0x01) != 0;
+    auto it = levels_.find(isRequestSeed ? accessType : uint8_t(accessType - 1));
+    if (accessType == 0x00 || it == levels_.end())
+    {
+        setNegativeResponse(response, SECURITY_ACCESS_REQ, SUBFUNCTION_NOT_SUPPORTED);
+        return;
+    }
+    if (isRequestSeed)
+    {
+        requestSeed(*it->second, response);
+    }
+    else
+    {
+        sendKey(*it->second, request + 2, length - 2, response);
+    }
+}
+
+/**
+ * Locks all security levels, pending seeds are discarded.
+ */
+void SecurityAccessService::lock() noexcept
+{
+    unlockedLevel_ = 0x00;
+    for (auto& level : levels_)
+    {
+        level.second->seed.clear();
+    }
+}
+
+/**
+ * @return the unlocked level (the `requestSeed` sub-function) or 0x00 if locked
+ */
+uint8_t SecurityAccessService::getUnlockedLevel() const noexcept
+{
+    return unlockedSession_ == getCurrentSession() ? unlockedLevel_ : 0x00;
+}
+
+void SecurityAccessService::requestSeed(Level& level, vector<uint8_t>& response)
+{
+    const uint8_t accessType = level.configuration.level;
+    if (level.isDelayed)
+    {
+        setNegativeResponse(response, SECURITY_ACCESS_REQ, REQUIRED_TIME_DELAY_NOT_EXPIRED);
+        return;
+    }
+    response.assign({SECURITY_ACCESS_RES, accessType});
+    if (getUnlockedLevel() == accessType)
+    {
+        // already unlocked
+        response.resize(2 + level.configuration.seedLength, 0x00);
+        return;
+    }
+
+    level.seed.resize(level.configuration.seedLength);
+    generator_.fill(level.seed.data(), level.seed.size());
+    optional<vector<uint8_t>> key = calculateKey(level.configuration, level.seed);
+    if (!key)
+    {
+        LOG_ERROR("No key for the seed of security level 0x" << hex << int(accessType));
+        level.seed.clear();
+        setNegativeResponse(response, SECURITY_ACCESS_REQ, CONDITIONS_NOT_CORRECT);
+        return;
+    }
+    level.key = move(*key);
+    response.insert(response.cend(), level.seed.cbegin(), level.seed.cend());
+}
+
+void SecurityAccessService::sendKey(Level& level, const uint8_t* key, size_t length, vector<uint8_t>& response)
+{
+    if (level.seed.empty())
+    {
+        setNegativeResponse(response, SECURITY_ACCESS_REQ, REQUEST_SEQUENCE_ERROR);
+        return;
+    }
+    if (length == 0)
+    {
+        setNegativeResponse(response, SECURITY_ACCESS_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+
+    // a seed is valid for one key only
+    level.seed.clear();
+    if (length == level.key.size() && equal(level.key.cbegin(), level.key.cend(), key))
+    {
+        level.attempts = 0;
+        unlockedLevel_ = level.configuration.level;
+        unlockedSession_ = getCurrentSession();
+        response.assign({SECURITY_ACCESS_RES, uint8_t(level.configuration.level + 1)});
+        return;
+    }
+
+    if (++level.attempts >= level.configuration.maxAttempts)
+    {
+        level.attempts = 0;
+        level.isDelayed = true;
+        level.delayTimer.schedule(level.configuration.delay);
+        setNegativeResponse(response, SECURITY_ACCESS_REQ, EXCEEDED_NUMBER_OF_ATTEMPTS);
+        return;
+    }
+    setNegativeResponse(response, SECURITY_ACCESS_REQ, INVALID_KEY);
+}
+
+UdsSession SecurityAccessService::getCurrentSession() const noexcept
+{
+    return pSessionCtrl_ != nullptr ? pSessionCtrl_->getCurrentUdsSession() : UdsSession::DEFAULT;
+}
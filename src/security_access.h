@@ -0,0 +1,130 @@
+/**
+ * @file security_access.h
+ *
+ */
+
+#ifndef SECURITY_ACCESS_H
+#define SECURITY_ACCESS_H
+
+#include "uds_service_handler.h"
+#include "session_controller.h"
+#include "timer_wheel.h"
+#include "crc_stream.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <vector>
+
+constexpr std::size_t DEFAULT_SEED_LENGTH = 4;
+constexpr unsigned DEFAULT_MAX_ATTEMPTS = 3;
+constexpr std::chrono::milliseconds DEFAULT_SECURITY_DELAY(10000);
+
+/**
+ * Fast pseudo random generator (xoshiro256**) for the seeds, seeded from
+ * `std::random_device` once on construction. Not thread safe.
+ */
+class SeedGenerator
+{
+public:
+    SeedGenerator();
+    explicit SeedGenerator(std::uint64_t seed) noexcept;
+
+    std::uint64_t next() noexcept;
+    void fill(std::uint8_t* buffer, std::size_t length) noexcept;
+
+private:
+    std::uint64_t state_[4];
+};
+
+/**
+ * The calculation of the key from the seed.
+ */
+enum class KeyAlgorithm
+{
+    XOR, ///< the seed XOR the secret, the secret is repeated over the seed
+    CRC, ///< the big endian CRC over the seed followed by the secret
+    AES128, ///< the AES-128 encrypted seed (zero padded to 16 bytes), the secret is the key
+    LUA ///< the result of a Lua function
+};
+
+/**
+ * Calculates the key from the given seed, returns nothing on error.
+ */
+using KeyFunction = std::function<std::optional<std::vector<std::uint8_t>>(const std::vector<std::uint8_t>& seed)>;
+
+/**
+ * One security level, see the `SecurityAccess` table of the ECU.
+ */
+struct SecurityLevelConfiguration
+{
+    std::uint8_t level = 0x01; ///< the odd `requestSeed` sub-function
+    std::size_t seedLength = DEFAULT_SEED_LENGTH;
+    KeyAlgorithm algorithm = KeyAlgorithm::XOR;
+    std::vector<std::uint8_t> secret; ///< the XOR mask, the bytes appended for the CRC or the AES key
+    CrcAlgorithm crcAlgorithm = CrcAlgorithm::CRC32;
+    KeyFunction keyFunction; ///< the key of `KeyAlgorithm::LUA`
+    unsigned maxAttempts = DEFAULT_MAX_ATTEMPTS; ///< invalid keys until the delay starts
+    std::chrono::milliseconds delay = DEFAULT_SECURITY_DELAY; ///< the time until a new seed is granted
+};
+
+/**
+ * `SecurityAccess` (0x27). Each level has its own seed/key state machine:
+ * `requestSeed` (odd sub-function) returns a new random seed, or a seed of
+ * zeros if the level is already unlocked, and `sendKey` (the next even
+ * sub-function) unlocks the level if the key matches. After `maxAttempts`
+ * invalid keys further seeds are refused until the delay timer on the
+ * `TimerWheel` expired.
+ *
+ * An unlocked level is locked again by `lock()` (e.g. on a session change or
+ * an ECU reset) and if the ECU leaves the session it was unlocked in (e.g.
+ * the S3 timeout).
+ */
+class SecurityAccessService : public UdsServiceHandler
+{
+public:
+    static std::optional<std::vector<std::uint8_t>> calculateKey(const SecurityLevelConfiguration& level,
+                                                                 const std::vector<std::uint8_t>& seed);
+
+    explicit SecurityAccessService(SessionController* pSessionCtrl) noexcept;
+    SecurityAccessService(const SecurityAccessService& orig) = delete;
+    SecurityAccessService& operator =(const SecurityAccessService& orig) = delete;
+    virtual ~SecurityAccessService() = default;
+
+    void setLevels(const std::vector<SecurityLevelConfiguration>& levels);
+    void proceedRequest(const std::uint8_t* request, std::size_t length,
+                        std::vector<std::uint8_t>& response) override;
+    bool hasSubFunction(std::uint8_t sid) const noexcept override { return true; }
+
+    void lock() noexcept;
+    std::uint8_t getUnlockedLevel() const noexcept;
+
+private:
+    struct Level
+    {
+        explicit Level(const SecurityLevelConfiguration& configuration);
+
+        SecurityLevelConfiguration configuration;
+        std::vector<std::uint8_t> seed; ///< the seed of the pending `sendKey`, empty if none
+        std::vector<std::uint8_t> key; ///< the expected key of `seed`
+        unsigned attempts = 0; ///< invalid keys since the last delay
+        std::atomic<bool> isDelayed{false}; ///< reset by the `delayTimer`
+        TimerWheel::Timer delayTimer;
+    };
+
+    SessionController* pSessionCtrl_; ///< might be `nullptr`, e.g. for DoIP
+    std::map<std::uint8_t, std::unique_ptr<Level>> levels_; ///< by the `requestSeed` sub-function
+    std::uint8_t unlockedLevel_ = 0x00; ///< 0x00 if locked
+    UdsSession unlockedSession_ = UdsSession::DEFAULT;
+    SeedGenerator generator_;
+
+    void requestSeed(Level& level, std::vector<std::uint8_t>& response);
+    void sendKey(Level& level, const std::uint8_t* key, std::size_t length, std::vector<std::uint8_t>& response);
+    UdsSession getCurrentSession() const noexcept;
+};
+
+#endif /* SECURITY_ACCESS_H */
@@ -0,0 +1,380 @@
+/**
+ * @file service_dispatcher.cpp
+ *
+ * The services of an ECU behind its 'Raw' table, see `ServiceDispatcher`.
+ */
+
+#include "service_dispatcher.h"
+#include "ecu_lua_script.h"
+#include "service_identifier.h"
+#include "logger.h"
+#include <algorithm>
+#include <cassert>
+#include <mutex>
+#include <string>
+
+using namespace std;
+
+static void setNegativeResponse(vector<uint8_t>& response, uint8_t sid, uint8_t nrc)
+{
+    response.assign({ERROR, sid, nrc});
+}
+
+/**
+ * Creates the services of the tables of the ECU.
+ *
+ * @param pEcuScript: the script of the ECU
+ * @param pSessionCtrl: the session of the front-end
+ * @param maxMessageSize: the max. length of a response of the transport in bytes
+ * @param eventSender: sends the responses of `ResponseOnEvent`, called on the wheel thread
+ * @param periodicSender: sends the messages of `ReadDataByPeriodicIdentifier`,
+ *                        `nullptr` if the front-end does not support the service
+ */
+ServiceDispatcher::ServiceDispatcher(EcuLuaScript* pEcuScript, SessionController* pSessionCtrl,
+                                     size_t maxMessageSize, ResponseOnEventService::Sender eventSender,
+                                     PeriodicDataService::Sender periodicSender)
+: pEcuScript_(pEcuScript)
+, pSessionCtrl_(pSessionCtrl)
+, maxMessageSize_(maxMessageSize)
+, pDownloadService_(pEcuScript->createDownloadService())
+, pServices_(std::make_unique<UdsServices>(pSessionCtrl, pEcuScript->getDtcStore(), pEcuScript->getDidStore(),
+                                           pEcuScript->getCommunicationGate()))
+, pObdService_(pEcuScript->createObdService())
+, pMemoryService_(pEcuScript->createMemoryService(maxMessageSize))
+{
+    assert(pSessionCtrl != nullptr);
+    pServices_->getSecurityAccessService().setLevels(pEcuScript->getSecurityLevels());
+    pServices_->getEcuResetService().setResetListener([pEcuScript](uint8_t) { pEcuScript->resetState(); });
+
+    // a defined record is read with `62 DID` in front
+    pDynamicData_ = std::make_shared<DynamicDataService>(pSessionCtrl,
+        [pEcuScript](UdsSession session, uint16_t dataIdentifier, vector<uint8_t>& data) {
+            return readData(pEcuScript, session, dataIdentifier, data);
+        },
+        maxMessageSize - 3);
+    shared_ptr<const DynamicDataService> pDynamicData = pDynamicData_;
+    const auto reader = [pEcuScript, pDynamicData](UdsSession session, uint16_t dataIdentifier,
+                                                   vector<uint8_t>& data) {
+        return pDynamicData->read(session, dataIdentifier, data)
+               || readData(pEcuScript, session, dataIdentifier, data);
+    };
+    if (pEcuScript->hasPeriodicData() && periodicSender)
+    {
+        pPeriodicData_ = std::make_unique<PeriodicDataService>(pEcuScript->getPeriodicDataConfiguration(),
+                                                               pSessionCtrl, reader, move(periodicSender));
+    }
+    UdsServices* pServices = pServices_.get();
+    pResponseOnEvent_ = std::make_unique<ResponseOnEventService>(
+        pEcuScript->getPeriodicDataConfiguration(), pSessionCtrl, pEcuScript->getDtcStore(), reader,
+        [pServices](const uint8_t* request, size_t length, vector<uint8_t>& response) {
+            pServices->proceedRequest(request, length, response);
+        },
+        move(eventSender));
+}
+
+/**
+ * Answers a request which is not in the 'Raw' table, in the current session
+ * of the front-end.
+ *
+ * @param request: the UDS request
+ * @param length: the length of the request in bytes (min. 1 byte)
+ * @param response: replaced by the response, if a service answered the request,
+ *                  also if the positive response is suppressed
+ * @param pTimer: measures the request, might be `nullptr`
+ * @return the service which answered the request, `Route::NONE` if none did
+ */
+ServiceDispatcher::Result ServiceDispatcher::proceedRequest(const uint8_t* request, size_t length,
+                                                            vector<uint8_t>& response, RequestTimer* pTimer)
+{
+    Result result;
+    const uint8_t sid = request[0];
+    if (pDownloadService_ && DownloadService::isDownloadRequest(sid))
+    {
+        pDownloadService_->proceedRequest(request, length, response);
+        result.route = Route::DOWNLOAD;
+    }
+    else if (pObdService_ && ObdService::isObdRequest(sid))
+    {
+        // functional OBD requests are not answered if no PID is supported
+        pObdService_->proceedRequest(request, length, response);
+        result.route = Route::OBD;
+    }
+    else if (pMemoryService_ && MemoryService::isMemoryRequest(sid))
+    {
+        pMemoryService_->proceedRequest(request, length, response);
+        result.route = Route::MEMORY;
+    }
+    else if (UdsServices::isNativeService(sid))
+    {
+        pServices_->proceedRequest(request, length, response);
+        result.route = Route::NATIVE;
+        if (sid == WRITE_DATA_BY_IDENTIFIER_REQ && !response.empty() && response[0] == WRITE_DATA_BY_IDENTIFIER_RES)
+        {
+            pResponseOnEvent_->notifyChange();
+        }
+        else if (sid == ECU_RESET_REQ && !response.empty() && response[0] == ECU_RESET_RES)
+        {
+            stopTransmissions(true);
+        }
+    }
+    else if (sid == READ_DATA_BY_IDENTIFIER_REQ)
+    {
+        readDataByIdentifier(request, length, pSessionCtrl_->getCurrentUdsSession(), response, pTimer);
+        result.route = Route::READ_DATA_BY_IDENTIFIER;
+    }
+    else if (sid == DIAGNOSTIC_SESSION_CONTROL_REQ)
+    {
+        diagnosticSessionControl(request, length, response);
+        result.route = Route::SESSION;
+    }
+    else if (sid == TESTER_PRESENT_REQ)
+    {
+        testerPresent(request, length, response);
+        result.route = Route::SESSION;
+    }
+    else if (sid == DYNAMICALLY_DEFINE_DATA_IDENTIFIER_REQ)
+    {
+        pDynamicData_->proceedRequest(request, length, response);
+        result.route = Route::DYNAMIC_DATA;
+    }
+    else if (sid == RESPONSE_ON_EVENT_REQ)
+    {
+        pResponseOnEvent_->proceedRequest(request, length, response);
+        result.route = Route::RESPONSE_ON_EVENT;
+    }
+    else if (sid == READ_DATA_BY_IDENTIFIER_PERIODIC_REQ && pPeriodicData_)
+    {
+        pPeriodicData_->proceedRequest(request, length, response);
+        result.route = Route::PERIODIC_DATA;
+    }
+    else
+    {
+        return result;
+    }
+    // the positive responses of all services are suppressed alike
+    result.isResponse = !response.empty() && (!isSuppressPosRsp(request, length)
+                                              || isNegativeResponse(response.data(), response.size()));
+    return result;
+}
+
+/**
+ * Reads a data identifier for `ReadDataByPeriodicIdentifier`, `ResponseOnEvent`
+ * and as source of `DynamicallyDefineDataIdentifier`, the written values take
+ * precedence over the `Signals` and `DataIdentifiers` tables.
+ *
+ * @param pEcuScript: the script of the ECU
+ * @param session: the session the identifier is read in
+ * @param dataIdentifier: the data identifier (e.g. `0xF190`)
+ * @param data: replaced by the read data
+ * @return false if the identifier is unknown
+ */
+bool ServiceDispatcher::readData(EcuLuaScript* pEcuScript, UdsSession session, uint16_t dataIdentifier,
+                                 vector<uint8_t>& data)
+{
+    if (pEcuScript->getDidStore()->read(session, dataIdentifier, data))
+    {
+        return true;
+    }
+    const SignalRecord *pSignals = pEcuScript->getSignalMappings()->findDataIdentifier(dataIdentifier);
+    if (pSignals != nullptr)
+    {
+        data.clear();
+        pSignals->append(data);
+        return true;
+    }
+    const char *sessionName = EcuLuaScript::getSessionTableName(session);
+    const auto pIndices = pEcuScript->getDataIdentifierIndices();
+    const DataIdentifierIndex::Entry *entry = EcuLuaScript::findDataIdentifier(*pIndices, sessionName, dataIdentifier);
+    if (entry == nullptr)
+    {
+        return false;
+    }
+    if (!entry->isLuaFunction)
+    {
+        data.assign(entry->data.cbegin(), entry->data.cend());
+        return true;
+    }
+    const string value = pEcuScript->readDataIdentifier(sessionName, *entry);
+    data.assign(value.cbegin(), value.cend());
+    return true;
+}
+
+/**
+ * `ReadDataByIdentifier`: a request may contain several data identifiers, the
+ * records of all known identifiers are concatenated into one response.
+ * Unknown identifiers are skipped, if none of them is known the response is
+ * `7F 22 11`. A response longer than the transport allows is `7F 22 14`.
+ */
+void ServiceDispatcher::readDataByIdentifier(const uint8_t* request, size_t length, UdsSession session,
+                                             vector<uint8_t>& response, RequestTimer* pTimer) const
+{
+    // no string copies for static entries, the response is assembled in the reused buffer
+    const char *sessionName = EcuLuaScript::getSessionTableName(session);
+    // reused by the threads of the front-ends, so a Lua value does not allocate
+    static thread_local string value;
+
+    response.clear();
+    response.push_back(READ_DATA_BY_IDENTIFIER_RES);
+
+    const auto pIndices = pEcuScript_->getDataIdentifierIndices();
+    const auto pDidStore = pEcuScript_->getDidStore();
+    const auto pSignalMappings = pEcuScript_->getSignalMappings();
+    for (size_t i = 1; i + 1 < length; i += 2)
+    {
+        const uint16_t dataIdentifier = uint16_t((request[i] << 8) + request[i + 1]);
+        // the identifiers defined by the tester (0x2C) are gathered from their sources, the
+        // written values (0x2E) take precedence over the Lua tables
+        if ((pDynamicData_ && DynamicDataService::isDynamicIdentifier(dataIdentifier)
+             && pDynamicData_->appendRecord(session, dataIdentifier, response))
+            || pDidStore->appendRecord(session, dataIdentifier, response))
+        {
+            if (response.size() > maxMessageSize_)
+            {
+                setNegativeResponse(response, READ_DATA_BY_IDENTIFIER_REQ, RESPONSE_TOO_LONG);
+                return;
+            }
+            continue;
+        }
+
+        // records of the `Signals` table are encoded natively, without Lua
+        const SignalRecord *pSignals = pSignalMappings->findDataIdentifier(dataIdentifier);
+        if (pSignals != nullptr)
+        {
+            if (response.size() + 2 + pSignals->size() > maxMessageSize_)
+            {
+                setNegativeResponse(response, READ_DATA_BY_IDENTIFIER_REQ, RESPONSE_TOO_LONG);
+                return;
+            }
+            response.push_back(request[i]);
+            response.push_back(request[i + 1]);
+            pSignals->append(response);
+            continue;
+        }
+
+        const DataIdentifierIndex::Entry *entry = EcuLuaScript::findDataIdentifier(*pIndices, sessionName,
+                                                                                   dataIdentifier);
+        if (entry == nullptr)
+        {
+            continue;
+        }
+
+        const string *data = &entry->data;
+        if (entry->isLuaFunction)
+        {
+            if (pTimer)
+            {
+                pTimer->luaStarted();
+            }
+            pEcuScript_->readDataIdentifier(sessionName, *entry, value);
+            if (pTimer)
+            {
+                pTimer->luaFinished();
+            }
+            data = &value;
+        }
+        if (data->empty())
+        {
+            continue;
+        }
+
+        if (response.size() + 2 + data->length() > maxMessageSize_)
+        {
+            setNegativeResponse(response, READ_DATA_BY_IDENTIFIER_REQ, RESPONSE_TOO_LONG);
+            return;
+        }
+        response.push_back(request[i]);
+        response.push_back(request[i + 1]);
+        response.insert(response.cend(), data->cbegin(), data->cend()); // insert payload
+    }
+
+    if (response.size() == 1)
+    {
+        setNegativeResponse(response, READ_DATA_BY_IDENTIFIER_REQ, SERVICE_NOT_SUPPORTED);
+    }
+}
+
+/**
+ * Starts a session and answers with the P2 and P2* of the session, see
+ * `SessionConfiguration`. Sessions which are neither a standard session nor
+ * in the `Sessions` table are rejected with `7F 10 12`. A session change
+ * locks the ECU and stops the periodic transmission and the responses on
+ * events, the default session knows no defined identifiers.
+ */
+void ServiceDispatcher::diagnosticSessionControl(const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    if (length != 2)
+    {
+        setNegativeResponse(response, DIAGNOSTIC_SESSION_CONTROL_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+    const uint8_t sessionId = request[1] & ~SUPPRESS_POS_RSP_MSG_INDICATION_BIT;
+    if (!pSessionCtrl_->isSessionSupported(sessionId))
+    {
+        LOG_ERROR("Invalid session ID 0x" << hex << unsigned(sessionId));
+        setNegativeResponse(response, DIAGNOSTIC_SESSION_CONTROL_REQ, SUBFUNCTION_NOT_SUPPORTED);
+        return;
+    }
+    pSessionCtrl_->setCurrentUdsSession(UdsSession(sessionId));
+    if (sessionId == UdsSession::DEFAULT)
+    {
+        pSessionCtrl_->stop();
+    }
+    else
+    {
+        pSessionCtrl_->startSession();
+    }
+    {
+        lock_guard<mutex> lock(pServices_->getMutex());
+        pServices_->getSecurityAccessService().lock();
+    }
+    stopTransmissions(sessionId == UdsSession::DEFAULT);
+
+    // sessionParameterRecord: P2 in 1 ms, P2* in 10 ms resolution
+    const SessionConfiguration& configuration = pSessionCtrl_->getSessionConfiguration(sessionId);
+    const uint16_t p2 = uint16_t(min<long long>(configuration.p2.count(), 0xFFFF));
+    const uint16_t p2Star = uint16_t(min<long long>(configuration.p2Star.count() / 10, 0xFFFF));
+    response.assign({
+        DIAGNOSTIC_SESSION_CONTROL_RES,
+        sessionId,
+        uint8_t(p2 >> 8),
+        uint8_t(p2 & 0xFF),
+        uint8_t(p2Star >> 8),
+        uint8_t(p2Star & 0xFF)
+    });
+}
+
+/**
+ * Answers a physically addressed `TesterPresent`, the front-end resets the
+ * session timer. Only the sub-function `zeroSubFunction` is supported.
+ */
+void ServiceDispatcher::testerPresent(const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    const uint8_t subFunction = length == 2 ? uint8_t(request[1] & ~SUPPRESS_POS_RSP_MSG_INDICATION_BIT) : 0x00;
+    if (length != 2 || subFunction != 0x00)
+    {
+        setNegativeResponse(response, TESTER_PRESENT_REQ,
+                            length != 2 ? INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT : SUBFUNCTION_NOT_SUPPORTED);
+        return;
+    }
+    response.assign({TESTER_PRESENT_RES, subFunction});
+}
+
+/**
+ * Stops the periodic transmission and the responses on events, e.g. on a
+ * session change.
+ *
+ * @param isClearingDefinitions: true to also drop the identifiers defined by
+ *                               the tester, e.g. on an ECU reset
+ */
+void ServiceDispatcher::stopTransmissions(bool isClearingDefinitions) noexcept
+{
+    if (pPeriodicData_)
+    {
+        pPeriodicData_->stopAll();
+    }
+    pResponseOnEvent_->stopAll();
+    if (isClearingDefinitions)
+    {
+        pDynamicData_->clearAll();
+    }
+}
@@ -0,0 +1,113 @@
+/**
+ * @file service_dispatcher.h
+ *
+ */
+
+#ifndef SERVICE_DISPATCHER_H
+#define SERVICE_DISPATCHER_H
+
+#include "session_controller.h"
+#include "metrics.h"
+#include "download_service.h"
+#include "uds_services.h"
+#include "obd_service.h"
+#include "memory_service.h"
+#include "dynamic_data_service.h"
+#include "periodic_data_service.h"
+#include "response_on_event_service.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class EcuLuaScript;
+
+/**
+ * The services of an ECU behind its 'Raw' table, shared by the UDS front-end
+ * (`UdsReceiver`) and the DoIP front-end (`DoIPSimulator`), so a request the
+ * 'Raw' table does not answer is answered alike over CAN and over DoIP. In
+ * order:
+ *
+ * - the `Download` table (`DownloadService`)
+ * - the `OBD` table (`ObdService`)
+ * - the `Memory` table (`MemoryService`)
+ * - the native services (`UdsServices`)
+ * - `ReadDataByIdentifier` from the identifiers defined by the tester, the
+ *   written values, the `Signals` table and the `DataIdentifiers` table of
+ *   the session
+ * - `DiagnosticSessionControl` and `TesterPresent`
+ * - `DynamicallyDefineDataIdentifier` (`DynamicDataService`)
+ * - `ResponseOnEvent` (`ResponseOnEventService`)
+ * - `ReadDataByPeriodicIdentifier` (`PeriodicDataService`), if the front-end
+ *   can send the periodic messages
+ *
+ * The tables are compiled once per ECU by the `EcuLuaScript` and read by
+ * reference. The services keep the state of the front-end (e.g. a running
+ * download or the defined identifiers) and answer in the session of its
+ * `SessionController`, so every front-end has a dispatcher of its own. The
+ * front-end checks the allowed services of the session and looks up the
+ * 'Raw' table before, and resets the S3 timer of the session.
+ */
+class ServiceDispatcher
+{
+public:
+    /// the service which answered a request
+    enum class Route : std::uint8_t
+    {
+        NONE, ///< no service of the dispatcher, the front-end answers it
+        DOWNLOAD,
+        OBD,
+        MEMORY,
+        NATIVE,
+        READ_DATA_BY_IDENTIFIER,
+        SESSION, ///< `DiagnosticSessionControl` or `TesterPresent`
+        DYNAMIC_DATA,
+        RESPONSE_ON_EVENT,
+        PERIODIC_DATA
+    };
+
+    /// the outcome of `proceedRequest()`
+    struct Result
+    {
+        Route route = Route::NONE;
+        bool isResponse = false; ///< false if nothing is sent, e.g. a suppressed positive response
+    };
+
+    ServiceDispatcher(EcuLuaScript* pEcuScript, SessionController* pSessionCtrl, std::size_t maxMessageSize,
+                      ResponseOnEventService::Sender eventSender,
+                      PeriodicDataService::Sender periodicSender = nullptr);
+    ServiceDispatcher(const ServiceDispatcher& orig) = delete;
+    ServiceDispatcher& operator =(const ServiceDispatcher& orig) = delete;
+    virtual ~ServiceDispatcher() = default;
+
+    Result proceedRequest(const std::uint8_t* request, std::size_t length, std::vector<std::uint8_t>& response,
+                          RequestTimer* pTimer = nullptr);
+    UdsServices& getServices() noexcept { return *pServices_; }
+
+    static bool readData(EcuLuaScript* pEcuScript, UdsSession session, std::uint16_t dataIdentifier,
+                         std::vector<std::uint8_t>& data);
+
+private:
+    EcuLuaScript* pEcuScript_;
+    SessionController* pSessionCtrl_; ///< the session of the front-end
+    const std::size_t maxMessageSize_; ///< of a `ReadDataByIdentifier` response
+    std::unique_ptr<DownloadService> pDownloadService_; ///< `nullptr` if the ECU has no `Download` table
+    std::unique_ptr<UdsServices> pServices_; ///< the natively implemented services
+    std::unique_ptr<ObdService> pObdService_; ///< `nullptr` if the ECU has no `OBD` table
+    std::unique_ptr<MemoryService> pMemoryService_; ///< `nullptr` if the ECU has no `Memory` table
+    /// the identifiers defined by the tester, shared with the readers of the services below
+    std::shared_ptr<DynamicDataService> pDynamicData_;
+    /// `nullptr` if the ECU has no `PeriodicData` table or the front-end cannot send it
+    std::unique_ptr<PeriodicDataService> pPeriodicData_;
+    /// sends the responses on events, destroyed before the services it uses
+    std::unique_ptr<ResponseOnEventService> pResponseOnEvent_;
+
+    void readDataByIdentifier(const std::uint8_t* request, std::size_t length, UdsSession session,
+                              std::vector<std::uint8_t>& response, RequestTimer* pTimer) const;
+    void diagnosticSessionControl(const std::uint8_t* request, std::size_t length,
+                                  std::vector<std::uint8_t>& response);
+    static void testerPresent(const std::uint8_t* request, std::size_t length, std::vector<std::uint8_t>& response);
+    void stopTransmissions(bool isClearingDefinitions) noexcept;
+};
+
+#endif /* SERVICE_DISPATCHER_H */
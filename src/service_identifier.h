@@ -8,9 +8,9 @@
 #ifndef SEVICE_IDENTIFIER_H
 #define SEVICE_IDENTIFIER_H
 
+#include <cstddef>
 #include <cstdint>
-
-#define SESSION_TIME 5000
+#include <vector>
 
 // Function Group: Diagnostic and Communications Management
 constexpr uint8_t DIAGNOSTIC_SESSION_CONTROL_REQ = 0x10;
@@ -102,8 +102,93 @@ constexpr uint8_t SERVICE_NOT_SUPPORTED = 0x11;
 constexpr uint8_t SUBFUNCTION_NOT_SUPPORTED = 0x12;
 constexpr uint8_t INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT = 0x13; ///< IMLOIF
 constexpr uint8_t RESPONSE_TOO_LONG = 0x14; ///< RTL
+constexpr uint8_t BUSY_REPEAT_REQUEST = 0x21; ///< BRR
 constexpr uint8_t CONDITIONS_NOT_CORRECT = 0x22; ///< CNC
 constexpr uint8_t REQUEST_OUT_OF_RANGE = 0x31; ///< ROOR
+constexpr uint8_t REQUEST_SEQUENCE_ERROR = 0x24; ///< RSE
 constexpr uint8_t SECURITY_ACCESS_DENIED = 0x33; ///< SAD
+constexpr uint8_t INVALID_KEY = 0x35; ///< IK
+constexpr uint8_t EXCEEDED_NUMBER_OF_ATTEMPTS = 0x36; ///< ENOA
+constexpr uint8_t REQUIRED_TIME_DELAY_NOT_EXPIRED = 0x37; ///< RTDNE
+constexpr uint8_t UPLOAD_DOWNLOAD_NOT_ACCEPTED = 0x70; ///< UDNA
+constexpr uint8_t TRANSFER_DATA_SUSPENDED = 0x71; ///< TDS
+constexpr uint8_t WRONG_BLOCK_SEQUENCE_COUNTER = 0x73; ///< WBSC
+constexpr uint8_t RESPONSE_PENDING = 0x78; ///< RCRRP
+constexpr uint8_t SERVICE_NOT_SUPPORTED_IN_ACTIVE_SESSION = 0x7F; ///< SNSIAS
+
+/// set in the sub-function byte if the tester does not want a positive response
+constexpr uint8_t SUPPRESS_POS_RSP_MSG_INDICATION_BIT = 0x80;
+
+/**
+ * @param sid: the SID of a request
+ * @return true if the second byte of the requests of the service is a
+ *         sub-function, i.e. may carry the suppressPosRspMsgIndicationBit
+ */
+constexpr bool isSubFunctionService(uint8_t sid) noexcept
+{
+    switch (sid)
+    {
+        case DIAGNOSTIC_SESSION_CONTROL_REQ:
+        case ECU_RESET_REQ:
+        case SECURITY_ACCESS_REQ:
+        case COMMUNICATION_CONTROL_REQ:
+        case TESTER_PRESENT_REQ:
+        case ACCESS_TIMING_PARAMETERS_REQ:
+        case CONTROL_DTC_SETTINGS_REQ:
+        case RESPONSE_ON_EVENT_REQ:
+        case LINK_CONTROL_REQ:
+        case READ_DTC_INFORMATION_REQ:
+        case DYNAMICALLY_DEFINE_DATA_IDENTIFIER_REQ:
+        case ROUTINE_CONTROL_REQ:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * Checks the suppressPosRspMsgIndicationBit of a request. If it is set, the
+ * positive response is not sent, a negative response still is.
+ *
+ * @param request: the UDS request
+ * @param length: the length of the request in bytes
+ * @return true if the positive response of the request is suppressed
+ */
+constexpr bool isSuppressPosRsp(const uint8_t* request, std::size_t length) noexcept
+{
+    return length >= 2 && isSubFunctionService(request[0]) && (request[1] & SUPPRESS_POS_RSP_MSG_INDICATION_BIT) != 0;
+}
+
+/**
+ * The request as it is looked up in the `Raw` table: the
+ * suppressPosRspMsgIndicationBit is cleared, so e.g. `3E 80` matches the entry
+ * `3E 00`. The request itself is left untouched.
+ *
+ * @param request: the UDS request
+ * @param length: the length of the request in bytes
+ * @param masked: holds the request without the bit, if it is set
+ * @return `request` if its positive response is not suppressed, otherwise `masked.data()`
+ */
+inline const uint8_t* clearSuppressPosRsp(const uint8_t* request, std::size_t length, std::vector<uint8_t>& masked)
+{
+    if (!isSuppressPosRsp(request, length))
+    {
+        return request;
+    }
+    masked.assign(request, request + length);
+    masked[1] &= uint8_t(~SUPPRESS_POS_RSP_MSG_INDICATION_BIT);
+    return masked.data();
+}
+
+/**
+ * @param response: a UDS response
+ * @param length: the length of the response in bytes
+ * @return true if the response is a negative one, which is sent even if
+ *         the positive response is suppressed
+ */
+constexpr bool isNegativeResponse(const uint8_t* response, std::size_t length) noexcept
+{
+    return length > 0 && response[0] == ERROR;
+}
 
 #endif /* SEVICE_IDENTIFIER_H */
@@ -4,19 +4,43 @@
  */
 
 #include "session_controller.h"
+#include "logger.h"
 #include <iostream>
 
 using namespace std;
 
 /**
- * Starts an UDS session. The session expires after 5000 milliseconds without
- * a reset/extension message and returns to the default-session state.
+ * Constructor. Supports the default, programming, extended and end of line
+ * session with the default timing.
+ */
+SessionController::SessionController()
+{
+    for (const UdsSession session : {UdsSession::DEFAULT, UdsSession::PROGRAMMING, UdsSession::EXTENDED,
+                                     UdsSession::END_OF_LINE})
+    {
+        sessions_[session].emplace();
+    }
+}
+
+/**
+ * Destructor. Stops the session timer before this object is destroyed, since
+ * the timer calls `wakeup()`.
+ */
+SessionController::~SessionController()
+{
+    stop();
+}
+
+/**
+ * Starts the S3 timer of the active session. The session expires after S3
+ * (5000 milliseconds by default) without a reset/extension message and
+ * returns to the default-session state.
  * 
  * @see SessionController::setCurrentUdsSession()
  */
 void SessionController::startSession()
 {
-    start(5000);
+    start(int(getSessionConfiguration(session_).s3.count()));
 }
 
 /**
@@ -32,40 +56,69 @@ UdsSession SessionController::getCurrentUdsSession() const noexcept
 /**
  * Sets the current UDS session state.
  * 
- * @param ses: the UDS session enum to set
+ * @param ses: the UDS session to set, see `isSessionSupported()`
  */
 void SessionController::setCurrentUdsSession(const UdsSession ses) noexcept
 {
-    if (ses == UdsSession::DEFAULT
-        || ses == UdsSession::PROGRAMMING
-        || ses == UdsSession::EXTENDED)
+    if (isSessionSupported(ses))
     {
         session_ = ses;
+        ++sessionEpoch_;
     }
     else
     {
-        cerr << "switch to unkown session: " << ses << endl;
+        LOG_ERROR("switch to unsupported session: 0x" << hex << unsigned(ses));
     }
 }
 
+/**
+ * Counts an ECU reset, which restarts the response lists of the `Raw` table.
+ * The session is switched to the default session by the caller.
+ */
+void SessionController::countEcuReset() noexcept
+{
+    ++resetEpoch_;
+}
+
+/**
+ * Adds or replaces the configurations of sessions. Must be called before the
+ * receivers of the ECU are started.
+ *
+ * @param sessions: the configurations by session ID
+ */
+void SessionController::configureSessions(const map<uint8_t, SessionConfiguration>& sessions)
+{
+    for (const auto& session : sessions)
+    {
+        sessions_[session.first] = session.second;
+    }
+}
+
+/**
+ * @return true if the session is configured, i.e. can be started
+ */
+bool SessionController::isSessionSupported(uint8_t session) const noexcept
+{
+    return sessions_[session].has_value();
+}
+
+/**
+ * @param session: a supported session, the default session is used otherwise
+ * @return the timing and allowed services of the session
+ */
+const SessionConfiguration& SessionController::getSessionConfiguration(uint8_t session) const noexcept
+{
+    return isSessionSupported(session) ? *sessions_[session] : *sessions_[UdsSession::DEFAULT];
+}
+
 /**
  * Overridden function which is called after the timer expired. Since the
  * `session_`-member is atomic, we don't need to use a mutex.
  */
 void SessionController::wakeup()
 {
-    if (session_ == UdsSession::DEFAULT)
-    {
-        cout << "timer finished - DEFAULT" << endl;
-    }
-    else if (session_ == UdsSession::PROGRAMMING)
-    {
-        cout << "timer finished - PROGRAMMING" << endl;
-    }
-    else if (session_ == UdsSession::EXTENDED)
-    {
-        cout << "timer finished - EXTENDED" << endl;
-    }
+    LOG_INFO("timer finished - session 0x" << hex << unsigned(session_.load()));
 
     session_ = UdsSession::DEFAULT;
+    ++sessionEpoch_;
 }
@@ -7,8 +7,13 @@
 #define SESSION_CONTROLLER_H
 
 #include "ecu_timer.h"
+#include <array>
 #include <atomic>
+#include <bitset>
+#include <chrono>
 #include <cstdint>
+#include <map>
+#include <optional>
 
 enum UdsSession : std::uint8_t
 {
@@ -18,22 +23,73 @@ enum UdsSession : std::uint8_t
     END_OF_LINE = 0x40
 };
 
+constexpr std::chrono::milliseconds DEFAULT_S3_SERVER(5000);
+constexpr std::chrono::milliseconds DEFAULT_SESSION_P2(50);
+constexpr std::chrono::milliseconds DEFAULT_SESSION_P2_STAR(5000);
+
+/**
+ * The timing and the allowed services of a UDS session, see the `Sessions`
+ * table of the ECU.
+ */
+struct SessionConfiguration
+{
+    /// the session falls back to the default session after this time without request
+    std::chrono::milliseconds s3 = DEFAULT_S3_SERVER;
+    /// P2 and P2* reported in the positive response of DiagnosticSessionControl
+    std::chrono::milliseconds p2 = DEFAULT_SESSION_P2;
+    std::chrono::milliseconds p2Star = DEFAULT_SESSION_P2_STAR;
+    /// the SIDs allowed in the session, all by default
+    std::bitset<256> allowedServices = std::bitset<256>().set();
+};
+
+/**
+ * Tracks the active UDS session of an ECU and its S3 timeout.
+ *
+ * The default, programming, extended and end of line session are always
+ * supported, further sessions are added by `configureSessions()`. The
+ * configurations are not changed after the receivers are started, so
+ * `isServiceAllowed()` needs no lock on the hot path.
+ */
 class SessionController : public EcuTimer
 {
 public:
-    SessionController() = default;
-    SessionController(const SessionController& orig) = default;
-    SessionController& operator =(const SessionController& orig) = default;
-    SessionController(SessionController&& orig) = default;
-    SessionController& operator =(SessionController&& orig) = default;
-    virtual ~SessionController() = default;
+    SessionController();
+    SessionController(const SessionController& orig) = delete;
+    SessionController& operator =(const SessionController& orig) = delete;
+    virtual ~SessionController();
 
     void startSession();
     UdsSession getCurrentUdsSession() const noexcept;
     void setCurrentUdsSession(const UdsSession ses) noexcept;
+    void countEcuReset() noexcept;
+    void configureSessions(const std::map<std::uint8_t, SessionConfiguration>& sessions);
+    bool isSessionSupported(std::uint8_t session) const noexcept;
+    const SessionConfiguration& getSessionConfiguration(std::uint8_t session) const noexcept;
+
+    /**
+     * @return false if the service is not allowed in the active session
+     */
+    bool isServiceAllowed(std::uint8_t sid) const noexcept
+    {
+        return sessions_[session_.load()]->allowedServices.test(sid);
+    }
+
+    /**
+     * @return the number of ECU resets, see `ResponseSequence`
+     */
+    std::uint32_t getResetEpoch() const noexcept { return resetEpoch_; }
+
+    /**
+     * @return the number of session changes (incl. timeouts and ECU resets)
+     */
+    std::uint32_t getSessionEpoch() const noexcept { return sessionEpoch_; }
 
 private:
     std::atomic<UdsSession> session_{UdsSession::DEFAULT};
+    std::atomic<std::uint32_t> resetEpoch_{0};
+    std::atomic<std::uint32_t> sessionEpoch_{0};
+    /// indexed by the session ID, empty for unsupported sessions
+    std::array<std::optional<SessionConfiguration>, 256> sessions_;
     virtual void wakeup() override;
 };
 
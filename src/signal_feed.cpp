@@ -0,0 +1,470 @@
+/**
+ * @file signal_feed.cpp
+ *
+ * The external feed of the vehicle signals by shared memory or UDP multicast,
+ * see `SignalFeed`.
+ */
+
+#include "signal_feed.h"
+#include "logger.h"
+#include "thread_placement.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+constexpr chrono::microseconds SignalFeed::POLL_INTERVAL;
+constexpr size_t SignalFeed::DEFAULT_CAPACITY;
+
+/// the max. number of attempts to read a frame while the writer is active
+constexpr int MAX_READ_ATTEMPTS = 4;
+constexpr char DATAGRAM_MAGIC[] = "CSF1";
+constexpr size_t DATAGRAM_HEADER_SIZE = 6;
+
+// the writer is another process, which shares the atomics of the header
+static_assert(atomic<uint64_t>::is_always_lock_free && atomic<uint32_t>::is_always_lock_free,
+              "the signal feed needs lock-free atomics");
+
+/**
+ * Destructor. Stops the feed and unmaps the shared memory.
+ */
+SignalFeed::~SignalFeed()
+{
+    stop();
+    if (pHeader_ != nullptr)
+    {
+        munmap(pHeader_, mappedSize_);
+    }
+    if (udp_skt_ >= 0)
+    {
+        close(udp_skt_);
+    }
+}
+
+/**
+ * Maps the shared memory of a plant model on the same host. The shared memory
+ * is created with the given capacity if it does not exist yet, otherwise the
+ * layout of its header is used.
+ *
+ * @param name: the name of the POSIX shared memory (e.g. "/carsim-signals")
+ * @param capacity: the number of signal slots of a new shared memory
+ * @return 0 on success, otherwise a negative value
+ */
+int SignalFeed::openSharedMemory(const string& name, size_t capacity) noexcept
+{
+    if (pHeader_ != nullptr || isRunning_)
+    {
+        return -1;
+    }
+    const int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0660);
+    if (fd < 0)
+    {
+        LOG_ERROR(__func__ << "() shm_open " << name << ": " << strerror(errno));
+        return -2;
+    }
+    struct stat status = {};
+    if (fstat(fd, &status) < 0)
+    {
+        LOG_ERROR(__func__ << "() fstat " << name << ": " << strerror(errno));
+        close(fd);
+        return -2;
+    }
+
+    const bool isNew = status.st_size == 0;
+    const size_t namesOffset = (sizeof(SignalFeedHeader) + 63) & ~size_t(63);
+    capacity = min(max(capacity, size_t(1)), MAX_VEHICLE_SIGNALS);
+    size_t size = size_t(status.st_size);
+    if (isNew)
+    {
+        size = namesOffset + capacity * (SIGNAL_FEED_NAME_SIZE + sizeof(double));
+        if (ftruncate(fd, off_t(size)) < 0)
+        {
+            LOG_ERROR(__func__ << "() ftruncate " << name << ": " << strerror(errno));
+            close(fd);
+            return -2;
+        }
+    }
+    if (size < sizeof(SignalFeedHeader))
+    {
+        LOG_ERROR("The shared memory " << name << " is no signal feed");
+        close(fd);
+        return -3;
+    }
+    void *pMemory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (pMemory == MAP_FAILED)
+    {
+        LOG_ERROR(__func__ << "() mmap " << name << ": " << strerror(errno));
+        return -2;
+    }
+
+    SignalFeedHeader *pHeader = static_cast<SignalFeedHeader*> (pMemory);
+    if (isNew)
+    {
+        // the memory is zeroed by ftruncate(), the magic marks it as complete
+        pHeader->version = SIGNAL_FEED_VERSION;
+        pHeader->capacity = uint32_t(capacity);
+        pHeader->nameSize = uint32_t(SIGNAL_FEED_NAME_SIZE);
+        pHeader->namesOffset = namesOffset;
+        pHeader->valuesOffset = namesOffset + capacity * SIGNAL_FEED_NAME_SIZE;
+        atomic_thread_fence(memory_order_release);
+        pHeader->magic = SIGNAL_FEED_MAGIC;
+    }
+    if (pHeader->magic != SIGNAL_FEED_MAGIC
+        || pHeader->version != SIGNAL_FEED_VERSION
+        || pHeader->nameSize == 0
+        || pHeader->valuesOffset % alignof(double) != 0
+        || pHeader->namesOffset + uint64_t(pHeader->capacity) * pHeader->nameSize > size
+        || pHeader->valuesOffset + uint64_t(pHeader->capacity) * sizeof(double) > size)
+    {
+        LOG_ERROR("The shared memory " << name << " is no signal feed of version " << dec << SIGNAL_FEED_VERSION);
+        munmap(pMemory, size);
+        return -3;
+    }
+
+    pHeader_ = pHeader;
+    mappedSize_ = size;
+    sequence_ = 0;
+    layout_ = UINT64_MAX; // resolve the names of the first frame
+    const size_t slots = min(size_t(pHeader->capacity), MAX_VEHICLE_SIGNALS);
+    slotIds_.assign(slots, 0);
+    isSlotValid_.assign(slots, false);
+    values_.assign(slots, 0.0);
+    frame_.assign(slots, 0.0);
+    changedIds_.reserve(slots);
+    changedValues_.reserve(slots);
+    LOG_INFO("Feeding the vehicle signals from the shared memory " << name
+             << " (" << dec << pHeader->capacity << " signals)");
+    return 0;
+}
+
+/**
+ * Joins a multicast group, which receives the datagrams of a remote model.
+ *
+ * @param group: the group and the UDP port, e.g. "239.255.0.1:30500"
+ * @return 0 on success, otherwise a negative value
+ */
+int SignalFeed::openMulticast(const string& group) noexcept
+{
+    if (udp_skt_ >= 0 || isRunning_)
+    {
+        return -1;
+    }
+    const size_t colon = group.rfind(':');
+    struct ip_mreq membership = {};
+    unsigned long port = 0;
+    if (colon != string::npos)
+    {
+        port = strtoul(group.c_str() + colon + 1, nullptr, 10);
+    }
+    if (colon == string::npos || port == 0 || port > 0xFFFF
+        || inet_pton(AF_INET, group.substr(0, colon).c_str(), &membership.imr_multiaddr) != 1)
+    {
+        LOG_ERROR("Invalid multicast group of the signal feed: " << group);
+        return -2;
+    }
+
+    const int skt = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (skt < 0)
+    {
+        LOG_ERROR(__func__ << "() socket: " << strerror(errno));
+        return -3;
+    }
+    const int enable = 1;
+    setsockopt(skt, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr = membership.imr_multiaddr;
+    addr.sin_port = htons(uint16_t(port));
+    membership.imr_interface.s_addr = htonl(INADDR_ANY);
+    if (bind(skt, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0
+        || setsockopt(skt, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) < 0)
+    {
+        LOG_ERROR(__func__ << "() " << group << ": " << strerror(errno));
+        close(skt);
+        return -3;
+    }
+    udp_skt_ = skt;
+    LOG_INFO("Feeding the vehicle signals from the multicast group " << group);
+    return 0;
+}
+
+/**
+ * Starts the thread, which polls the shared memory every `POLL_INTERVAL` and
+ * receives the datagrams.
+ *
+ * @return 0 on success, otherwise a negative value
+ */
+int SignalFeed::start() noexcept
+{
+    if (isRunning_ || (pHeader_ == nullptr && udp_skt_ < 0))
+    {
+        return -1;
+    }
+    stop_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (stop_fd_ < 0)
+    {
+        LOG_ERROR(__func__ << "() eventfd: " << strerror(errno));
+        return -2;
+    }
+    isRunning_ = true;
+    feedThread_ = thread(&SignalFeed::run, this);
+    return 0;
+}
+
+/**
+ * Stops the thread of the feed.
+ */
+void SignalFeed::stop() noexcept
+{
+    if (!isRunning_.exchange(false))
+    {
+        return;
+    }
+    const uint64_t one = 1;
+    if (write(stop_fd_, &one, sizeof(one)) < 0)
+    {
+        LOG_WARNING(__func__ << "() write: " << strerror(errno));
+    }
+    if (feedThread_.joinable())
+    {
+        feedThread_.join();
+    }
+    close(stop_fd_);
+    stop_fd_ = -1;
+}
+
+/**
+ * Copies the current frame of the shared memory into `frame_` and, if the
+ * layout changed, resolves the names of the slots.
+ *
+ * @param count: set to the number of used slots
+ * @return false if there is no new frame or it was overwritten while reading
+ */
+bool SignalFeed::readFrame(uint32_t& count)
+{
+    const uint64_t sequence = pHeader_->sequence.load(memory_order_acquire);
+    if ((sequence & 1) != 0 || sequence == sequence_)
+    {
+        return false;
+    }
+    const uint64_t layout = pHeader_->layout.load(memory_order_relaxed);
+    count = min(pHeader_->count.load(memory_order_relaxed), uint32_t(slotIds_.size()));
+    const char *pNames = reinterpret_cast<const char*> (pHeader_) + pHeader_->namesOffset;
+    const double *pValues = reinterpret_cast<const double*> (
+        reinterpret_cast<const char*> (pHeader_) + pHeader_->valuesOffset);
+
+    vector<string> names;
+    if (layout != layout_)
+    {
+        names.reserve(count);
+        for (uint32_t slot = 0; slot < count; ++slot)
+        {
+            const char *pName = pNames + size_t(slot) * pHeader_->nameSize;
+            names.emplace_back(pName, strnlen(pName, pHeader_->nameSize));
+        }
+    }
+    memcpy(frame_.data(), pValues, count * sizeof(double));
+    atomic_thread_fence(memory_order_acquire);
+    if (pHeader_->sequence.load(memory_order_relaxed) != sequence)
+    {
+        return false;
+    }
+
+    sequence_ = sequence;
+    if (layout != layout_)
+    {
+        VehicleSignals& signals = VehicleSignals::getInstance();
+        for (uint32_t slot = 0; slot < count; ++slot)
+        {
+            const optional<VehicleSignals::SignalId> id = names[slot].empty()
+                ? optional<VehicleSignals::SignalId>() : signals.registerSignal(names[slot]);
+            isSlotValid_[slot] = id.has_value();
+            slotIds_[slot] = id.value_or(0);
+            values_[slot] = NAN; // publish every value of the new layout
+        }
+        layout_ = layout;
+    }
+    return true;
+}
+
+/**
+ * Publishes the changed values of the latest frame of the shared memory as
+ * one update of the vehicle signals.
+ *
+ * @return the number of changed signals
+ */
+size_t SignalFeed::poll()
+{
+    if (pHeader_ == nullptr)
+    {
+        return 0;
+    }
+    uint32_t count = 0;
+    bool isRead = false;
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS && !isRead; ++attempt)
+    {
+        isRead = readFrame(count);
+        if (!isRead && pHeader_->sequence.load(memory_order_relaxed) == sequence_)
+        {
+            return 0; // no new frame
+        }
+    }
+    if (!isRead)
+    {
+        return 0; // the writer is busy, the next poll gets a newer frame
+    }
+
+    changedIds_.clear();
+    changedValues_.clear();
+    for (uint32_t slot = 0; slot < count; ++slot)
+    {
+        // NaN is never equal, so it is published as well
+        if (isSlotValid_[slot] && !(frame_[slot] == values_[slot]))
+        {
+            values_[slot] = frame_[slot];
+            changedIds_.push_back(slotIds_[slot]);
+            changedValues_.push_back(frame_[slot]);
+        }
+    }
+    if (!changedIds_.empty())
+    {
+        VehicleSignals::getInstance().update(changedIds_.data(), changedValues_.data(), changedIds_.size());
+    }
+    return changedIds_.size();
+}
+
+/**
+ * Decodes a datagram of the multicast feed.
+ *
+ * @param datagram: the received datagram
+ * @param length: the length of the datagram
+ * @param values: replaced by the names (views into the datagram) and values
+ * @return false if the datagram is malformed
+ */
+bool SignalFeed::decodeDatagram(const uint8_t* datagram, size_t length,
+                                vector<pair<string_view, double>>& values)
+{
+    values.clear();
+    if (length < DATAGRAM_HEADER_SIZE || memcmp(datagram, DATAGRAM_MAGIC, 4) != 0)
+    {
+        return false;
+    }
+    const size_t count = size_t(datagram[4]) | (size_t(datagram[5]) << 8);
+    size_t offset = DATAGRAM_HEADER_SIZE;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (offset >= length)
+        {
+            return false;
+        }
+        const size_t nameLength = datagram[offset++];
+        if (nameLength == 0 || offset + nameLength + sizeof(double) > length)
+        {
+            return false;
+        }
+        const string_view name(reinterpret_cast<const char*> (datagram + offset), nameLength);
+        offset += nameLength;
+        uint64_t bits = 0;
+        for (size_t byte = 0; byte < sizeof(double); ++byte)
+        {
+            bits |= uint64_t(datagram[offset + byte]) << (8 * byte);
+        }
+        offset += sizeof(double);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        values.emplace_back(name, value);
+    }
+    return offset == length;
+}
+
+/**
+ * Publishes the values of a datagram of the multicast feed as one update of
+ * the vehicle signals. Unknown signals are registered.
+ *
+ * @param datagram: the received datagram, see `decodeDatagram()`
+ * @param length: the length of the datagram
+ * @return the number of signals, 0 if the datagram was dropped
+ */
+size_t SignalFeed::receive(const uint8_t* datagram, size_t length)
+{
+    if (!decodeDatagram(datagram, length, datagramValues_))
+    {
+        droppedDatagrams_.fetch_add(1, memory_order_relaxed);
+        return 0;
+    }
+    VehicleSignals& signals = VehicleSignals::getInstance();
+    changedIds_.clear();
+    changedValues_.clear();
+    for (const pair<string_view, double>& value : datagramValues_)
+    {
+        string name(value.first);
+        auto iter = datagramIds_.find(name);
+        if (iter == datagramIds_.end())
+        {
+            const optional<VehicleSignals::SignalId> id = signals.registerSignal(name);
+            if (!id)
+            {
+                continue;
+            }
+            iter = datagramIds_.emplace(move(name), *id).first;
+        }
+        changedIds_.push_back(iter->second);
+        changedValues_.push_back(value.second);
+    }
+    if (!changedIds_.empty())
+    {
+        signals.update(changedIds_.data(), changedValues_.data(), changedIds_.size());
+    }
+    return changedIds_.size();
+}
+
+void SignalFeed::run() noexcept
+{
+    ThreadPlacement::getInstance().apply(ThreadRole::IO);
+    const struct timespec interval = {0, long(chrono::nanoseconds(POLL_INTERVAL).count())};
+    pollfd fds[2] = {{stop_fd_, POLLIN, 0}, {udp_skt_, POLLIN, 0}};
+    const nfds_t fdCount = udp_skt_ >= 0 ? 2 : 1;
+    vector<uint8_t> datagram(65536);
+
+    while (isRunning_)
+    {
+        const int ready = ppoll(fds, fdCount, pHeader_ != nullptr ? &interval : nullptr, nullptr);
+        if (ready < 0 && errno != EINTR)
+        {
+            LOG_ERROR(__func__ << "() ppoll: " << strerror(errno));
+            return;
+        }
+        if (fds[0].revents != 0)
+        {
+            return;
+        }
+        try
+        {
+            if (fdCount > 1 && fds[1].revents != 0)
+            {
+                ssize_t length;
+                while ((length = recv(udp_skt_, datagram.data(), datagram.size(), 0)) >= 0)
+                {
+                    receive(datagram.data(), size_t(length));
+                }
+            }
+            poll();
+        }
+        catch (exception& e)
+        {
+            LOG_ERROR(__func__ << "(): " << e.what());
+        }
+    }
+}
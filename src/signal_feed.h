@@ -0,0 +1,114 @@
+/**
+ * @file signal_feed.h
+ *
+ */
+
+#ifndef SIGNAL_FEED_H
+#define SIGNAL_FEED_H
+
+#include "vehicle_signals.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * The header of the shared memory of a `SignalFeed`, followed by the names
+ * (`capacity` slots of `nameSize` chars, zero terminated) and the values
+ * (`capacity` doubles) at the given offsets. The slots are the signals of the
+ * feed, only the first `count` slots are used.
+ *
+ * The writer increments `sequence` before and after every frame, so it is odd
+ * while the names or values are written, and increments `layout` whenever it
+ * changes the names or the count. All fields are in the byte order of the host.
+ */
+struct SignalFeedHeader
+{
+    std::uint64_t magic; ///< `SIGNAL_FEED_MAGIC`, written last by the creator
+    std::uint32_t version; ///< `SIGNAL_FEED_VERSION`
+    std::uint32_t capacity; ///< the number of slots
+    std::uint32_t nameSize; ///< the size of a name slot in chars
+    std::uint32_t reserved;
+    std::uint64_t namesOffset; ///< from the begin of the header
+    std::uint64_t valuesOffset; ///< from the begin of the header, 8 byte aligned
+    std::atomic<std::uint64_t> sequence; ///< odd while a frame is written
+    std::atomic<std::uint64_t> layout; ///< the version of the names and the count
+    std::atomic<std::uint32_t> count; ///< the number of used slots
+};
+
+constexpr std::uint64_t SIGNAL_FEED_MAGIC = 0x4445454653495343; // "CSISFEED"
+constexpr std::uint32_t SIGNAL_FEED_VERSION = 1;
+constexpr std::size_t SIGNAL_FEED_NAME_SIZE = 64;
+
+/**
+ * Feeds the vehicle signals from an external plant model at a high rate
+ * (e.g. 2000 signals at 1 kHz), without entering a Lua VM. The encoders of
+ * the DIDs, OBD PIDs and PGNs read the values without locks, see
+ * `VehicleSignals`.
+ *
+ * A model on the same host writes into a POSIX shared memory
+ * (`SignalFeedHeader`), which is protected by a sequence lock: the feed
+ * thread copies the values, and retries if the sequence changed meanwhile.
+ * The names are resolved to signal IDs only when the layout changes, and only
+ * the changed values are published as one update of the signal store.
+ *
+ * A remote model sends UDP datagrams to a multicast group instead:
+ * "CSF1", the number of signals (uint16, little endian) and per signal the
+ * length of its name (uint8), the name and the value (little endian double).
+ */
+class SignalFeed
+{
+public:
+    /// the max. time until a frame in the shared memory is published
+    static constexpr std::chrono::microseconds POLL_INTERVAL{500};
+    static constexpr std::size_t DEFAULT_CAPACITY = 2048;
+
+    SignalFeed() = default;
+    SignalFeed(const SignalFeed& orig) = delete;
+    SignalFeed& operator =(const SignalFeed& orig) = delete;
+    virtual ~SignalFeed();
+
+    int openSharedMemory(const std::string& name, std::size_t capacity = DEFAULT_CAPACITY) noexcept;
+    int openMulticast(const std::string& group) noexcept;
+    int start() noexcept;
+    void stop() noexcept;
+    std::size_t poll();
+    std::size_t receive(const std::uint8_t* datagram, std::size_t length);
+    std::uint64_t getDroppedDatagrams() const noexcept { return droppedDatagrams_; }
+
+    static bool decodeDatagram(const std::uint8_t* datagram, std::size_t length,
+                               std::vector<std::pair<std::string_view, double>>& values);
+
+private:
+    SignalFeedHeader *pHeader_ = nullptr;
+    std::size_t mappedSize_ = 0;
+    int udp_skt_ = -1;
+    int stop_fd_ = -1;
+    std::atomic<bool> isRunning_{false};
+    std::thread feedThread_;
+
+    // only used by the feed thread
+    std::uint64_t sequence_ = 0; ///< of the last published frame
+    std::uint64_t layout_ = 0; ///< of `slotIds_`
+    std::vector<VehicleSignals::SignalId> slotIds_; ///< by slot of the shared memory
+    std::vector<bool> isSlotValid_;
+    std::vector<double> values_; ///< the last frame
+    std::vector<double> frame_;
+    std::vector<VehicleSignals::SignalId> changedIds_;
+    std::vector<double> changedValues_;
+    std::unordered_map<std::string, VehicleSignals::SignalId> datagramIds_;
+    std::vector<std::pair<std::string_view, double>> datagramValues_;
+    std::atomic<std::uint64_t> droppedDatagrams_{0};
+
+    bool readFrame(std::uint32_t& count);
+    void resolveSlots(std::uint32_t count);
+    void run() noexcept;
+};
+
+#endif /* SIGNAL_FEED_H */
@@ -0,0 +1,272 @@
+/**
+ * @file simulation_clock.cpp
+ *
+ * This file contains the clock of the simulation, which runs in real time, at
+ * a multiple of the real time or in virtual time.
+ */
+
+#include "simulation_clock.h"
+#include "thread_placement.h"
+#include <algorithm>
+
+using namespace std;
+
+/// the activities of the calling thread, which do not count while it sleeps
+static thread_local unsigned int threadActivities = 0;
+
+/**
+ * Constructor. Registers the waiter with the clock.
+ *
+ * @param onJump: wakes up the waiting component after the virtual time
+ *                jumped, so it waits for the new `toRealTime()` of its
+ *                deadline. Must not block, the clock is locked meanwhile.
+ */
+SimulationClock::Waiter::Waiter(function<void()> onJump)
+: onJump_(move(onJump))
+{
+    SimulationClock& clock = SimulationClock::getInstance();
+    lock_guard<mutex> lock(clock.mutex_);
+    clock.waiters_.push_back(this);
+}
+
+/**
+ * Destructor. Unregisters the waiter.
+ */
+SimulationClock::Waiter::~Waiter()
+{
+    SimulationClock& clock = SimulationClock::getInstance();
+    lock_guard<mutex> lock(clock.mutex_);
+    clock.waiters_.erase(remove(clock.waiters_.begin(), clock.waiters_.end(), this), clock.waiters_.end());
+}
+
+/**
+ * Sets the time the component waits for. Cheap enough to be called before
+ * every wait.
+ *
+ * @param deadline: the simulation time, see `SimulationClock::now()`
+ */
+void SimulationClock::Waiter::setDeadline(TimePoint deadline) noexcept
+{
+    const Duration::rep value = deadline.time_since_epoch().count();
+    if (deadline_.exchange(value) != value)
+    {
+        SimulationClock::getInstance().activityCount_++;
+    }
+}
+
+/**
+ * Removes the deadline, i.e. the component waits for an event only.
+ */
+void SimulationClock::Waiter::clearDeadline() noexcept
+{
+    if (deadline_.exchange(0) != 0)
+    {
+        SimulationClock::getInstance().activityCount_++;
+    }
+}
+
+SimulationClock::Activity::Activity() noexcept
+{
+    SimulationClock& clock = SimulationClock::getInstance();
+    threadActivities++;
+    clock.runningActivities_++;
+    clock.activityCount_++;
+}
+
+SimulationClock::Activity::~Activity()
+{
+    SimulationClock& clock = SimulationClock::getInstance();
+    clock.activityCount_++;
+    clock.runningActivities_--;
+    threadActivities--;
+}
+
+/**
+ * @return the clock of the simulation
+ */
+SimulationClock& SimulationClock::getInstance()
+{
+    static SimulationClock clock;
+    return clock;
+}
+
+/**
+ * Constructor. The clock runs in real time until `configure()` is called.
+ */
+SimulationClock::SimulationClock()
+{
+    const Duration::rep realNs = getRealNs();
+    anchorRealNs_ = realNs;
+    anchorNs_ = realNs;
+}
+
+/**
+ * Destructor. Stops jumping, the sleeping callers return.
+ */
+SimulationClock::~SimulationClock()
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        isOnExit_ = true;
+    }
+    condition_.notify_all();
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+/**
+ * Sets the speed of the clock. Should be called before the simulation is
+ * started, the simulation time continues from its current value.
+ *
+ * @param speed: the factor of the real time, e.g. 10 to run ten times as fast
+ * @param isVirtual: true to jump to the next deadline whenever the simulation
+ *                   is idle
+ */
+void SimulationClock::configure(double speed, bool isVirtual)
+{
+    const Duration::rep nowNs = now().time_since_epoch().count();
+    anchorRealNs_ = getRealNs();
+    anchorNs_ = nowNs - skippedNs_;
+    speed_ = speed > 0.0 ? speed : 1.0;
+    isVirtual_ = isVirtual;
+    if (isVirtual && !thread_.joinable())
+    {
+        thread_ = thread(&SimulationClock::run, this);
+    }
+}
+
+/**
+ * @return the current simulation time, which equals the `steady_clock` in
+ *         real time
+ */
+SimulationClock::TimePoint SimulationClock::now() const noexcept
+{
+    const Duration::rep elapsedNs = getRealNs() - anchorRealNs_;
+    const double speed = speed_;
+    const Duration::rep scaledNs = speed == 1.0 ? elapsedNs : Duration::rep(double(elapsedNs) * speed);
+    return TimePoint(Duration(anchorNs_ + scaledNs + skippedNs_));
+}
+
+/**
+ * Converts a simulation time into the `steady_clock` time it is reached,
+ * e.g. to wait for it with `condition_variable::wait_until()` or a timerfd.
+ * A jump of the virtual time makes the result earlier, which is why the
+ * waiters are woken up to convert their deadline again.
+ *
+ * @param time: the simulation time
+ * @return the real time
+ */
+SimulationClock::TimePoint SimulationClock::toRealTime(TimePoint time) const noexcept
+{
+    const Duration::rep scaledNs = time.time_since_epoch().count() - anchorNs_ - skippedNs_;
+    const double speed = speed_;
+    const Duration::rep elapsedNs = speed == 1.0 ? scaledNs : Duration::rep(double(scaledNs) / speed);
+    return TimePoint(Duration(anchorRealNs_ + elapsedNs));
+}
+
+/**
+ * Blocks the calling thread until the given simulation time.
+ *
+ * @param deadline: the simulation time to wait for
+ */
+void SimulationClock::sleepUntil(TimePoint deadline)
+{
+    if (isRealTime())
+    {
+        this_thread::sleep_until(deadline);
+        return;
+    }
+    Waiter waiter;
+    waiter.setDeadline(deadline);
+    // e.g. a Lua function calling `sleep()` does not keep the time from jumping
+    const unsigned int activities = threadActivities;
+    runningActivities_ -= activities;
+    {
+        unique_lock<mutex> lock(mutex_);
+        while (!isOnExit_ && now() < deadline)
+        {
+            condition_.wait_until(lock, toRealTime(deadline));
+        }
+    }
+    runningActivities_ += activities;
+}
+
+/**
+ * Blocks the calling thread for the given simulation time.
+ *
+ * @param duration: the time to sleep
+ */
+void SimulationClock::sleepFor(Duration duration)
+{
+    sleepUntil(now() + duration);
+}
+
+SimulationClock::Duration::rep SimulationClock::getRealNs() noexcept
+{
+    return chrono::duration_cast<Duration>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Advances the virtual time to the earliest deadline of the waiters and wakes
+ * them up, must be called with the lock held.
+ *
+ * @return true if the time jumped
+ */
+bool SimulationClock::jump()
+{
+    Duration::rep nextNs = 0;
+    for (const Waiter* pWaiter : waiters_)
+    {
+        const Duration::rep deadlineNs = pWaiter->deadline_;
+        if (deadlineNs != 0 && (nextNs == 0 || deadlineNs < nextNs))
+        {
+            nextNs = deadlineNs;
+        }
+    }
+    const Duration::rep nowNs = now().time_since_epoch().count();
+    if (nextNs <= nowNs)
+    {
+        return false; // nothing to wait for or already due
+    }
+
+    skippedNs_ += nextNs - nowNs;
+    activityCount_++;
+    for (Waiter* pWaiter : waiters_)
+    {
+        if (pWaiter->onJump_)
+        {
+            pWaiter->onJump_();
+        }
+    }
+    condition_.notify_all();
+    return true;
+}
+
+/**
+ * Lets the virtual time jump after each `IDLE_TIME` without any activity.
+ */
+void SimulationClock::run()
+{
+    ThreadPlacement::getInstance().apply(ThreadRole::IO);
+    unique_lock<mutex> lock(mutex_);
+    uint64_t lastActivityCount = activityCount_;
+    while (!isOnExit_)
+    {
+        const auto idleEnd = chrono::steady_clock::now() + IDLE_TIME;
+        if (condition_.wait_until(lock, idleEnd, [this]() { return isOnExit_; }))
+        {
+            break;
+        }
+        const uint64_t activityCount = activityCount_;
+        if (isVirtual_ && activityCount == lastActivityCount && runningActivities_ == 0 && jump())
+        {
+            lastActivityCount = activityCount_;
+        }
+        else
+        {
+            lastActivityCount = activityCount;
+        }
+    }
+}
@@ -0,0 +1,117 @@
+/**
+ * @file simulation_clock.h
+ *
+ */
+
+#ifndef SIMULATION_CLOCK_H
+#define SIMULATION_CLOCK_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * The time of the simulation, read by everything which waits for simulated
+ * time to pass: the `TimerWheel` (i.e. the `EcuTimer`s, the S3 timeouts and
+ * the DoIP vehicle announcements), the `J1939CyclicScheduler`, the delayed
+ * tasks of the `LuaWorker`s and `sleep()` of the Lua scripts.
+ *
+ * On default the simulation time is the `steady_clock`. With a speed above 1
+ * it runs faster (e.g. 10 = ten times as fast), so a timeout of 5 s expires
+ * after 0.5 s. In virtual time, the clock additionally jumps to the earliest
+ * pending deadline whenever the simulation is idle, i.e. no deadline was
+ * changed and no `Activity` was running for `IDLE_TIME`. The timers then
+ * expire in the order of their deadlines right away, however long the time
+ * in between is.
+ *
+ * The waiting components register a `Waiter` with their next deadline, which
+ * is woken up after a jump, and wait until `toRealTime()` of their deadline.
+ */
+class SimulationClock
+{
+public:
+    using Duration = std::chrono::steady_clock::duration;
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    /// the real time the simulation has to be idle before the clock jumps
+    static constexpr std::chrono::milliseconds IDLE_TIME{2};
+
+    /**
+     * The next deadline of a waiting component. Only considered in virtual
+     * time, where the clock jumps to the earliest deadline of all waiters.
+     */
+    class Waiter
+    {
+        friend class SimulationClock;
+
+    public:
+        explicit Waiter(std::function<void()> onJump = nullptr);
+        Waiter(const Waiter& orig) = delete;
+        Waiter& operator =(const Waiter& orig) = delete;
+        virtual ~Waiter();
+
+        void setDeadline(TimePoint deadline) noexcept;
+        void clearDeadline() noexcept;
+
+    private:
+        std::function<void()> onJump_; ///< wakes up the component, called with the clock locked
+        std::atomic<Duration::rep> deadline_{0}; ///< 0 = none
+    };
+
+    /**
+     * Keeps the virtual time from jumping while the simulation is busy, e.g.
+     * while a Lua function runs. Does not count while its thread is in
+     * `sleepUntil()`.
+     */
+    class Activity
+    {
+    public:
+        Activity() noexcept;
+        Activity(const Activity& orig) = delete;
+        Activity& operator =(const Activity& orig) = delete;
+        ~Activity();
+    };
+
+    static SimulationClock& getInstance();
+
+    SimulationClock();
+    SimulationClock(const SimulationClock& orig) = delete;
+    SimulationClock& operator =(const SimulationClock& orig) = delete;
+    virtual ~SimulationClock();
+
+    void configure(double speed, bool isVirtual);
+    double getSpeed() const noexcept { return speed_; }
+    bool isVirtual() const noexcept { return isVirtual_; }
+    bool isRealTime() const noexcept { return speed_ == 1.0 && !isVirtual_; }
+
+    TimePoint now() const noexcept;
+    TimePoint toRealTime(TimePoint time) const noexcept;
+    void sleepUntil(TimePoint deadline);
+    void sleepFor(Duration duration);
+
+private:
+    std::atomic<double> speed_{1.0};
+    std::atomic<bool> isVirtual_{false};
+    std::atomic<Duration::rep> anchorRealNs_{0}; ///< the real time of the last `configure()`
+    std::atomic<Duration::rep> anchorNs_{0}; ///< the simulation time of the last `configure()`
+    std::atomic<Duration::rep> skippedNs_{0}; ///< the sum of all jumps
+    std::atomic<std::uint64_t> activityCount_{0}; ///< changed deadlines and activities
+    std::atomic<unsigned int> runningActivities_{0};
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::vector<Waiter*> waiters_;
+    bool isOnExit_ = false;
+    std::thread thread_;
+
+    static Duration::rep getRealNs() noexcept;
+    bool jump();
+    void run();
+};
+
+#endif /* SIMULATION_CLOCK_H */
@@ -0,0 +1,526 @@
+/**
+ * @file simulator_configuration.cpp
+ *
+ * This file contains the runtime options of the simulator, which are not
+ * related to a single simulated ECU.
+ */
+
+#include "simulator_configuration.h"
+#include "lua_compat.h"
+#include "utilities.h"
+#include <sched.h>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+/**
+ * Reads the CPUs and the priority of the threads of a role.
+ *
+ * @param lua_state: the loaded configuration
+ * @param cpusKey: the key of the list of CPUs, e.g. `IoCpus`
+ * @param priorityKey: the key of the SCHED_FIFO priority, e.g. `IoPriority`
+ * @param configuration: receives the valid entries
+ */
+static void readThreadConfiguration(const sel::State& lua_state, const char* cpusKey, const char* priorityKey,
+                                    ThreadRoleConfiguration& configuration)
+{
+    auto cpus = lua_state[SIMULATOR_TABLE][cpusKey];
+    for (int i = 1; cpus.exists() && cpus[i].exists(); ++i)
+    {
+        const int cpu = int(cpus[i]);
+        if (cpu >= 0 && cpu < CPU_SETSIZE)
+        {
+            configuration.cpus.push_back(cpu);
+        }
+        else
+        {
+            cerr << "Invalid CPU in " << cpusKey << ": " << cpu << endl;
+        }
+    }
+
+    auto priority = lua_state[SIMULATOR_TABLE][priorityKey];
+    if (priority.exists())
+    {
+        const int value = int(priority);
+        if (value >= 0 && value <= sched_get_priority_max(SCHED_FIFO))
+        {
+            configuration.priority = value;
+        }
+        else
+        {
+            cerr << "Invalid " << priorityKey << ": " << value << endl;
+        }
+    }
+}
+
+/**
+ * Constructor. Reads the `Simulator`-table of the given Lua file. Missing
+ * entries (or a missing file) keep their default values.
+ *
+ * @param luaScript: path to the Lua configuration file
+ */
+SimulatorConfiguration::SimulatorConfiguration(const string& luaScript)
+{
+    if (!utils::existsFile(luaScript))
+    {
+        return;
+    }
+
+    cout << "Loading simulator configuration from: " << luaScript << endl;
+    sel::State lua_state;
+    lua_state.Load(luaScript);
+    if (!lua_state[SIMULATOR_TABLE].exists())
+    {
+        cerr << "No " << SIMULATOR_TABLE << "-table in " << luaScript << endl;
+        return;
+    }
+
+    auto reactorThreads = lua_state[SIMULATOR_TABLE][REACTOR_THREADS];
+    if (reactorThreads.exists())
+    {
+        const int threads = int(reactorThreads);
+        reactorThreads_ = threads > 0 ? static_cast<unsigned int>(threads) : 0;
+    }
+
+    auto busRecovery = lua_state[SIMULATOR_TABLE][BUS_RECOVERY];
+    if (busRecovery.exists())
+    {
+        isBusRecoveryEnabled_ = bool(busRecovery);
+    }
+
+    auto logLevel = lua_state[SIMULATOR_TABLE][LOG_LEVEL];
+    if (logLevel.exists() && !Logger::parseLevel(string(logLevel), logLevel_))
+    {
+        cerr << "Invalid " << LOG_LEVEL << ": " << string(logLevel) << endl;
+    }
+
+    auto captureFile = lua_state[SIMULATOR_TABLE][CAPTURE_FILE];
+    if (captureFile.exists())
+    {
+        captureFile_ = string(captureFile);
+    }
+
+    auto captureSize = lua_state[SIMULATOR_TABLE][CAPTURE_SIZE];
+    if (captureSize.exists() && int(captureSize) > 0)
+    {
+        captureSize_ = size_t(int(captureSize)) * 1024 * 1024;
+    }
+
+    auto metricsPort = lua_state[SIMULATOR_TABLE][METRICS_PORT];
+    if (metricsPort.exists())
+    {
+        const int port = int(metricsPort);
+        if (port > 0 && port <= 0xFFFF)
+        {
+            metricsPort_ = static_cast<uint16_t>(port);
+        }
+        else
+        {
+            cerr << "Invalid " << METRICS_PORT << ": " << port << endl;
+        }
+    }
+
+    auto startupThreads = lua_state[SIMULATOR_TABLE][STARTUP_THREADS];
+    if (startupThreads.exists())
+    {
+        const int threads = int(startupThreads);
+        startupThreads_ = threads > 0 ? static_cast<unsigned int>(threads) : 0;
+    }
+
+    auto configSnapshots = lua_state[SIMULATOR_TABLE][CONFIG_SNAPSHOTS];
+    if (configSnapshots.exists())
+    {
+        useConfigSnapshots_ = bool(configSnapshots);
+    }
+
+    auto hotReload = lua_state[SIMULATOR_TABLE][HOT_RELOAD];
+    if (hotReload.exists())
+    {
+        isHotReloadEnabled_ = bool(hotReload);
+    }
+
+    auto hotRelayout = lua_state[SIMULATOR_TABLE][HOT_RELAYOUT];
+    if (hotRelayout.exists())
+    {
+        isHotRelayoutEnabled_ = bool(hotRelayout);
+    }
+
+    readThreadConfiguration(lua_state, IO_CPUS, IO_PRIORITY, ioThreads_);
+    readThreadConfiguration(lua_state, LUA_CPUS, LUA_PRIORITY, luaThreads_);
+
+    auto cyclicOffload = lua_state[SIMULATOR_TABLE][CYCLIC_OFFLOAD];
+    if (cyclicOffload.exists())
+    {
+        isCyclicOffloadEnabled_ = bool(cyclicOffload);
+    }
+
+    auto userSpaceIsoTp = lua_state[SIMULATOR_TABLE][USER_SPACE_ISOTP];
+    if (userSpaceIsoTp.exists())
+    {
+        useUserSpaceIsoTp_ = bool(userSpaceIsoTp);
+    }
+
+    auto timeScale = lua_state[SIMULATOR_TABLE][TIME_SCALE];
+    if (timeScale.exists())
+    {
+        const double scale = double(lua_Number(timeScale));
+        if (scale > 0.0)
+        {
+            timeScale_ = scale;
+        }
+        else
+        {
+            cerr << "Invalid " << TIME_SCALE << ": " << scale << endl;
+        }
+    }
+
+    auto virtualTime = lua_state[SIMULATOR_TABLE][VIRTUAL_TIME];
+    if (virtualTime.exists())
+    {
+        isVirtualTimeEnabled_ = bool(virtualTime);
+    }
+
+    auto luaProfile = lua_state[SIMULATOR_TABLE][LUA_PROFILE];
+    if (luaProfile.exists())
+    {
+        luaProfileFile_ = string(luaProfile);
+    }
+
+    auto signalFeed = lua_state[SIMULATOR_TABLE][SIGNAL_FEED];
+    if (signalFeed.exists())
+    {
+        signalFeed_ = string(signalFeed);
+    }
+
+    auto signalFeedGroup = lua_state[SIMULATOR_TABLE][SIGNAL_FEED_GROUP];
+    if (signalFeedGroup.exists())
+    {
+        signalFeedGroup_ = string(signalFeedGroup);
+    }
+
+    auto realTime = lua_state[SIMULATOR_TABLE][REAL_TIME];
+    if (realTime.exists())
+    {
+        isRealTimeEnabled_ = bool(realTime);
+    }
+    if (isRealTimeEnabled_)
+    {
+        // unless configured, the I/O threads get the first CPU and the Lua workers the others
+        const unsigned int cpuCount = thread::hardware_concurrency();
+        if (ioThreads_.cpus.empty())
+        {
+            ioThreads_.cpus.push_back(0);
+        }
+        for (unsigned int cpu = 1; luaThreads_.cpus.empty() && cpu < cpuCount; ++cpu)
+        {
+            luaThreads_.cpus.push_back(int(cpu));
+        }
+    }
+
+    auto busyPoll = lua_state[SIMULATOR_TABLE][BUSY_POLL];
+    if (busyPoll.exists())
+    {
+        const int window = int(busyPoll);
+        if (window >= 0)
+        {
+            busyPollWindow_ = chrono::microseconds(window);
+        }
+        else
+        {
+            cerr << "Invalid " << BUSY_POLL << ": " << window << endl;
+        }
+    }
+
+    auto checkpointFile = lua_state[SIMULATOR_TABLE][CHECKPOINT_FILE];
+    if (checkpointFile.exists())
+    {
+        checkpointFile_ = string(checkpointFile);
+    }
+
+    auto busBitRate = lua_state[SIMULATOR_TABLE][BUS_BIT_RATE];
+    if (busBitRate.exists())
+    {
+        const int bitRate = int(busBitRate);
+        if (bitRate > 0)
+        {
+            busBitRate_ = uint32_t(bitRate);
+        }
+        else
+        {
+            cerr << "Invalid " << BUS_BIT_RATE << ": " << bitRate << endl;
+        }
+    }
+
+    auto maxBusLoad = lua_state[SIMULATOR_TABLE][MAX_BUS_LOAD];
+    if (maxBusLoad.exists())
+    {
+        const double load = double(lua_Number(maxBusLoad));
+        if (load > 0.0 && load <= 100.0)
+        {
+            maxBusLoad_ = load / 100.0;
+        }
+        else
+        {
+            cerr << "Invalid " << MAX_BUS_LOAD << ": " << load << endl;
+        }
+    }
+
+    auto idleTimeout = lua_state[SIMULATOR_TABLE][IDLE_TIMEOUT];
+    if (idleTimeout.exists())
+    {
+        const double seconds = double(lua_Number(idleTimeout));
+        if (seconds >= 0.0)
+        {
+            idleTimeout_ = chrono::milliseconds(llround(seconds * 1000.0));
+        }
+        else
+        {
+            cerr << "Invalid " << IDLE_TIMEOUT << ": " << seconds << endl;
+        }
+    }
+
+    auto workers = lua_state[SIMULATOR_TABLE][WORKERS];
+    if (workers.exists())
+    {
+        const int count = int(workers);
+        if (count >= 0 && count <= MAX_WORKERS)
+        {
+            workers_ = static_cast<unsigned int>(count);
+        }
+        else
+        {
+            cerr << "Invalid " << WORKERS << ": " << count << endl;
+        }
+    }
+}
+
+/**
+ * @return the number of worker threads of the receiver reactor, 0 if the
+ *         reactor is disabled
+ */
+unsigned int SimulatorConfiguration::getReactorThreads() const
+{
+    return reactorThreads_;
+}
+
+/**
+ * @return true if the receivers should be handled by a `ReceiverReactor`
+ *         instead of one thread per receiver
+ */
+bool SimulatorConfiguration::useReactor() const
+{
+    return reactorThreads_ > 0;
+}
+
+/**
+ * @return true if CAN interfaces in ERROR-PASSIVE state should be restarted
+ *         by the simulator (replaces `canwatchdog.sh`)
+ */
+bool SimulatorConfiguration::isBusRecoveryEnabled() const
+{
+    return isBusRecoveryEnabled_;
+}
+
+/**
+ * @return the minimum level of the written log messages
+ */
+LogLevel SimulatorConfiguration::getLogLevel() const
+{
+    return logLevel_;
+}
+
+/**
+ * @return the path of the traffic capture file, empty if the capture is disabled
+ */
+const string& SimulatorConfiguration::getCaptureFile() const
+{
+    return captureFile_;
+}
+
+/**
+ * @return the size of the traffic capture ring in bytes
+ */
+size_t SimulatorConfiguration::getCaptureSize() const
+{
+    return captureSize_;
+}
+
+/**
+ * @return the port of the metrics endpoint, 0 if it is disabled
+ */
+uint16_t SimulatorConfiguration::getMetricsPort() const
+{
+    return metricsPort_;
+}
+
+/**
+ * @return the number of threads loading the ECU configurations, 0 means one
+ *         per CPU thread
+ */
+unsigned int SimulatorConfiguration::getStartupThreads() const
+{
+    return startupThreads_;
+}
+
+/**
+ * @return true if the compiled 'Raw' tables should be loaded from and written
+ *         to snapshot files next to the ECU configurations
+ */
+bool SimulatorConfiguration::useConfigSnapshots() const
+{
+    return useConfigSnapshots_;
+}
+
+/**
+ * @return true if changed ECU configurations should be reloaded while the
+ *         simulator is running
+ */
+bool SimulatorConfiguration::isHotReloadEnabled() const
+{
+    return isHotReloadEnabled_;
+}
+
+/**
+ * @return true if a reloaded 'Raw' table should be laid out by the hits of
+ *         its entries, see `EcuLuaScript::setHotRelayoutEnabled()`
+ */
+bool SimulatorConfiguration::isHotRelayoutEnabled() const
+{
+    return isHotRelayoutEnabled_;
+}
+
+/**
+ * @param role: the role of the threads
+ * @return where the threads of the role should run
+ */
+const ThreadRoleConfiguration& SimulatorConfiguration::getThreadConfiguration(ThreadRole role) const
+{
+    return role == ThreadRole::IO ? ioThreads_ : luaThreads_;
+}
+
+/**
+ * @return true if the static cyclic PGNs should be sent by the SocketCAN
+ *         broadcast manager, see `J1939CyclicScheduler::setOffloadEnabled()`
+ */
+bool SimulatorConfiguration::isCyclicOffloadEnabled() const
+{
+    return isCyclicOffloadEnabled_;
+}
+
+/**
+ * @return true if ISO-TP should be implemented in user space over `CAN_RAW`
+ *         instead of using the `can-isotp` kernel module, see `IsoTpEngine`
+ */
+bool SimulatorConfiguration::useUserSpaceIsoTp() const
+{
+    return useUserSpaceIsoTp_;
+}
+
+/**
+ * @return the speed of the simulation time relative to the real time, see
+ *         `SimulationClock::configure()`
+ */
+double SimulatorConfiguration::getTimeScale() const
+{
+    return timeScale_;
+}
+
+/**
+ * @return true if the simulation time should jump over the idle time, see
+ *         `SimulationClock`
+ */
+bool SimulatorConfiguration::isVirtualTimeEnabled() const
+{
+    return isVirtualTimeEnabled_;
+}
+
+/**
+ * @return the file of the collapsed stacks of the Lua profiler, empty if the
+ *         profiler is disabled, see `LuaProfiler`
+ */
+const string& SimulatorConfiguration::getLuaProfileFile() const
+{
+    return luaProfileFile_;
+}
+
+/**
+ * @return the name of the shared memory of the signal feed, empty if it is
+ *         disabled, see `SignalFeed`
+ */
+const string& SimulatorConfiguration::getSignalFeed() const
+{
+    return signalFeed_;
+}
+
+/**
+ * @return the multicast group ("address:port") of the signal feed, empty if
+ *         it is disabled, see `SignalFeed`
+ */
+const string& SimulatorConfiguration::getSignalFeedGroup() const
+{
+    return signalFeedGroup_;
+}
+
+/**
+ * @return true if the memory should be locked and the threads pinned, see
+ *         `RealTimeProfile`
+ */
+bool SimulatorConfiguration::isRealTimeEnabled() const
+{
+    return isRealTimeEnabled_;
+}
+
+/**
+ * @return the time the receivers poll their sockets before they block, 0 if
+ *         they block immediately, see `RealTimeProfile`
+ */
+chrono::microseconds SimulatorConfiguration::getBusyPollWindow() const
+{
+    return busyPollWindow_;
+}
+
+/**
+ * @return the file of the runtime state written on `SIGUSR2` and restored on
+ *         `SIGHUP` and at startup, empty if it is disabled, see `Checkpoint`
+ */
+const string& SimulatorConfiguration::getCheckpointFile() const
+{
+    return checkpointFile_;
+}
+
+/**
+ * @return the nominal bit rate of the CAN interfaces, see `BusLoadBudget`
+ */
+uint32_t SimulatorConfiguration::getBusBitRate() const
+{
+    return busBitRate_;
+}
+
+/**
+ * @return the share of the bit rate the bulk transmissions may use (0..1),
+ *         0 if they are not paced, see `BusLoadBudget`
+ */
+double SimulatorConfiguration::getMaxBusLoad() const
+{
+    return maxBusLoad_;
+}
+
+/**
+ * @return the time without received traffic after which the simulator
+ *         sleeps, 0 if it never sleeps, see `IdleMonitor`
+ */
+chrono::milliseconds SimulatorConfiguration::getIdleTimeout() const
+{
+    return idleTimeout_;
+}
+
+/**
+ * @return the number of worker processes, 0 or 1 if the simulator runs in a
+ *         single process, see `WorkerSupervisor`
+ */
+unsigned int SimulatorConfiguration::getWorkers() const
+{
+    return workers_;
+}
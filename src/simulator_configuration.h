@@ -0,0 +1,154 @@
+/**
+ * @file simulator_configuration.h
+ *
+ */
+
+#ifndef SIMULATOR_CONFIGURATION_H
+#define SIMULATOR_CONFIGURATION_H
+
+#include "bus_load_budget.h"
+#include "logger.h"
+#include "thread_placement.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// name of the optional configuration file in the Lua config directory
+constexpr char SIMULATOR_CONFIG_FILE[] = "simulator.lua";
+
+constexpr char SIMULATOR_TABLE[] = "Simulator";
+constexpr char REACTOR_THREADS[] = "ReactorThreads";
+constexpr char BUS_RECOVERY[] = "BusRecovery";
+constexpr char LOG_LEVEL[] = "LogLevel";
+constexpr char CAPTURE_FILE[] = "CaptureFile";
+constexpr char CAPTURE_SIZE[] = "CaptureSize";
+constexpr char METRICS_PORT[] = "MetricsPort";
+constexpr char STARTUP_THREADS[] = "StartupThreads";
+constexpr char CONFIG_SNAPSHOTS[] = "ConfigSnapshots";
+constexpr char HOT_RELOAD[] = "HotReload";
+constexpr char HOT_RELAYOUT[] = "HotRelayout";
+constexpr char IO_CPUS[] = "IoCpus";
+constexpr char IO_PRIORITY[] = "IoPriority";
+constexpr char LUA_CPUS[] = "LuaCpus";
+constexpr char LUA_PRIORITY[] = "LuaPriority";
+constexpr char CYCLIC_OFFLOAD[] = "CyclicOffload";
+constexpr char USER_SPACE_ISOTP[] = "UserSpaceIsoTp";
+constexpr char TIME_SCALE[] = "TimeScale";
+constexpr char VIRTUAL_TIME[] = "VirtualTime";
+constexpr char LUA_PROFILE[] = "LuaProfile";
+constexpr char SIGNAL_FEED[] = "SignalFeed";
+constexpr char SIGNAL_FEED_GROUP[] = "SignalFeedGroup";
+constexpr char REAL_TIME[] = "RealTime";
+constexpr char BUSY_POLL[] = "BusyPoll";
+constexpr char CHECKPOINT_FILE[] = "CheckpointFile";
+constexpr char BUS_BIT_RATE[] = "BusBitRate";
+constexpr char MAX_BUS_LOAD[] = "MaxBusLoad";
+constexpr char IDLE_TIMEOUT[] = "IdleTimeout";
+constexpr char WORKERS[] = "Workers";
+/// default size of the capture ring in MiB
+constexpr std::size_t DEFAULT_CAPTURE_SIZE = 64;
+/// the max. number of worker processes
+constexpr int MAX_WORKERS = 256;
+
+/**
+ * Runtime options of the simulator itself (i.e. not of a single ECU), read
+ * from the `Simulator`-table of `simulator.lua`:
+ *
+ * ```lua
+ * Simulator = {
+ *     ReactorThreads = 2, -- per CAN interface, 0 (default) starts one thread per receiver
+ *     BusRecovery = true, -- restart interfaces in ERROR-PASSIVE state
+ *     LogLevel = "debug", -- "info" (default), "warning", "error" or "none"
+ *     CaptureFile = "/tmp/carsim.cap", -- record all traffic (off on default)
+ *     CaptureSize = 64, -- size of the capture ring in MiB
+ *     MetricsPort = 9100, -- Prometheus endpoint (off on default)
+ *     StartupThreads = 4, -- 0 (default) loads one config per CPU thread
+ *     ConfigSnapshots = true, -- cache the compiled Raw tables (off on default)
+ *     HotReload = true, -- reload changed ECU configurations (off on default)
+ *     HotRelayout = true, -- lay out reloaded Raw tables by their hits (off on default)
+ *     IoCpus = {0}, -- CPUs of the I/O threads (default: all)
+ *     IoPriority = 50, -- SCHED_FIFO priority of the I/O threads (off on default)
+ *     LuaCpus = {1, 2, 3}, -- CPUs of the Lua workers (default: all)
+ *     LuaPriority = 0, -- SCHED_FIFO priority of the Lua workers (off on default)
+ *     CyclicOffload = true, -- send static cyclic PGNs by CAN_BCM (off on default)
+ *     UserSpaceIsoTp = true, -- ISO-TP over CAN_RAW instead of can-isotp (off on default)
+ *     TimeScale = 10, -- speed of the simulation time (1 on default)
+ *     VirtualTime = true, -- skip the idle time of the simulation (off on default)
+ *     LuaProfile = "/tmp/carsim.folded", -- profile the Lua handlers (off on default)
+ *     SignalFeed = "/carsim-signals", -- shared memory of a plant model (off on default)
+ *     SignalFeedGroup = "239.255.0.1:30500", -- multicast signal feed (off on default)
+ *     RealTime = true, -- lock the memory and pin the threads (off on default)
+ *     BusyPoll = 50, -- µs the receivers poll before they block (off on default)
+ *     CheckpointFile = "/tmp/carsim.ckpt", -- runtime state of SIGUSR2 and SIGHUP (off on default)
+ *     BusBitRate = 250000, -- bit/s of the CAN interfaces (500000 on default)
+ *     MaxBusLoad = 60, -- % of the bit rate the bulk transmissions may use (off on default)
+ *     IdleTimeout = 60, -- seconds without received traffic before sleeping (off on default)
+ *     Workers = 4, -- worker processes sharing the interfaces (off on default)
+ * }
+ * ```
+ */
+class SimulatorConfiguration
+{
+public:
+    SimulatorConfiguration() = default;
+    SimulatorConfiguration(const std::string& luaScript);
+
+    unsigned int getReactorThreads() const;
+    bool useReactor() const;
+    bool isBusRecoveryEnabled() const;
+    LogLevel getLogLevel() const;
+    const std::string& getCaptureFile() const;
+    std::size_t getCaptureSize() const;
+    std::uint16_t getMetricsPort() const;
+    unsigned int getStartupThreads() const;
+    bool useConfigSnapshots() const;
+    bool isHotReloadEnabled() const;
+    bool isHotRelayoutEnabled() const;
+    const ThreadRoleConfiguration& getThreadConfiguration(ThreadRole role) const;
+    bool isCyclicOffloadEnabled() const;
+    bool useUserSpaceIsoTp() const;
+    double getTimeScale() const;
+    bool isVirtualTimeEnabled() const;
+    const std::string& getLuaProfileFile() const;
+    const std::string& getSignalFeed() const;
+    const std::string& getSignalFeedGroup() const;
+    bool isRealTimeEnabled() const;
+    std::chrono::microseconds getBusyPollWindow() const;
+    const std::string& getCheckpointFile() const;
+    std::uint32_t getBusBitRate() const;
+    double getMaxBusLoad() const;
+    std::chrono::milliseconds getIdleTimeout() const;
+    unsigned int getWorkers() const;
+
+private:
+    unsigned int reactorThreads_ = 0;
+    bool isBusRecoveryEnabled_ = false;
+    LogLevel logLevel_ = LogLevel::INFO;
+    std::string captureFile_;
+    std::size_t captureSize_ = DEFAULT_CAPTURE_SIZE * 1024 * 1024;
+    std::uint16_t metricsPort_ = 0;
+    unsigned int startupThreads_ = 0;
+    bool useConfigSnapshots_ = false;
+    bool isHotReloadEnabled_ = false;
+    bool isHotRelayoutEnabled_ = false;
+    ThreadRoleConfiguration ioThreads_;
+    ThreadRoleConfiguration luaThreads_;
+    bool isCyclicOffloadEnabled_ = false;
+    bool useUserSpaceIsoTp_ = false;
+    double timeScale_ = 1.0;
+    bool isVirtualTimeEnabled_ = false;
+    std::string luaProfileFile_;
+    std::string signalFeed_;
+    std::string signalFeedGroup_;
+    bool isRealTimeEnabled_ = false;
+    std::chrono::microseconds busyPollWindow_{0};
+    std::string checkpointFile_;
+    std::uint32_t busBitRate_ = DEFAULT_BUS_BIT_RATE;
+    double maxBusLoad_ = 0;
+    std::chrono::milliseconds idleTimeout_{0};
+    unsigned int workers_ = 0;
+
+};
+
+#endif /* SIMULATOR_CONFIGURATION_H */
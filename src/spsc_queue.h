@@ -0,0 +1,104 @@
+/**
+ * @file spsc_queue.h
+ *
+ */
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * Bounded, lock-free single producer / single consumer ring buffer.
+ *
+ * The slots are allocated once and reused, so the producer writes into the
+ * slot returned by `prepareBack()` and publishes it with `commitBack()`. The
+ * consumer accesses the oldest element with `front()` and releases it with
+ * `pop()`. Nothing is copied or allocated by the queue itself.
+ */
+template<class T, std::size_t Capacity>
+class SpscQueue
+{
+public:
+    /**
+     * @return the slot to fill or `nullptr` if the queue is full (producer only)
+     */
+    T *prepareBack() noexcept
+    {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (increment(tail) == head_.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+        return &slots_[tail];
+    }
+
+    /**
+     * Publishes the slot returned by `prepareBack()` (producer only).
+     */
+    void commitBack() noexcept
+    {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        tail_.store(increment(tail), std::memory_order_release);
+    }
+
+    /**
+     * @return the oldest element or `nullptr` if the queue is empty (consumer only)
+     */
+    T *front() noexcept
+    {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+        return &slots_[head];
+    }
+
+    /**
+     * Releases the element returned by `front()` (consumer only).
+     */
+    void pop() noexcept
+    {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        head_.store(increment(head), std::memory_order_release);
+    }
+
+    bool empty() const noexcept
+    {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @return the number of queued elements, only a snapshot if called
+     *         concurrently
+     */
+    std::size_t size() const noexcept
+    {
+        const std::size_t head = head_.load(std::memory_order_acquire);
+        const std::size_t tail = tail_.load(std::memory_order_acquire);
+        return tail >= head ? tail - head : SLOTS - head + tail;
+    }
+
+    static constexpr std::size_t capacity() noexcept
+    {
+        return Capacity;
+    }
+
+private:
+    /// one slot stays empty to tell a full from an empty queue
+    static constexpr std::size_t SLOTS = Capacity + 1;
+
+    std::array<T, SLOTS> slots_;
+    alignas(64) std::atomic<std::size_t> head_{0};
+    alignas(64) std::atomic<std::size_t> tail_{0};
+
+    static constexpr std::size_t increment(std::size_t index) noexcept
+    {
+        return (index + 1) % SLOTS;
+    }
+};
+
+#endif /* SPSC_QUEUE_H */
@@ -0,0 +1,100 @@
+/**
+ * @file thread_placement.cpp
+ *
+ */
+
+#include "thread_placement.h"
+#include "logger.h"
+#include <pthread.h>
+#include <sched.h>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+/**
+ * @return the placement of all threads of the simulator
+ */
+ThreadPlacement& ThreadPlacement::getInstance()
+{
+    static ThreadPlacement placement;
+    return placement;
+}
+
+/**
+ * Sets where the threads of a role run. Must be called before the first
+ * thread of the role is started.
+ *
+ * @param role: the role of the threads
+ * @param configuration: their CPUs and priority
+ */
+void ThreadPlacement::configure(ThreadRole role, const ThreadRoleConfiguration& configuration)
+{
+    configurations_[size_t(role)] = configuration;
+}
+
+/**
+ * @param role: the role of the threads
+ * @return the CPUs and the priority of the threads of the role
+ */
+const ThreadRoleConfiguration& ThreadPlacement::getConfiguration(ThreadRole role) const noexcept
+{
+    return configurations_[size_t(role)];
+}
+
+/**
+ * Places the calling thread by its role. A role without configuration leaves
+ * the thread as it is. The SCHED_FIFO priority needs `CAP_SYS_NICE` (or an
+ * `RLIMIT_RTPRIO`), without it the thread keeps the normal scheduler.
+ *
+ * @param role: the role of the calling thread
+ * @return false if the CPUs or the priority could not be set
+ */
+bool ThreadPlacement::apply(ThreadRole role) noexcept
+{
+    const ThreadRoleConfiguration& configuration = configurations_[size_t(role)];
+    int result = 0;
+    const char* what = "";
+    if (!configuration.cpus.empty())
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (const int cpu : configuration.cpus)
+        {
+            if (cpu >= 0 && cpu < CPU_SETSIZE)
+            {
+                CPU_SET(cpu, &cpus);
+            }
+        }
+        result = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        what = "CPUs";
+    }
+    if (result == 0 && configuration.priority > 0)
+    {
+        struct sched_param parameter = {};
+        parameter.sched_priority = configuration.priority;
+        result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameter);
+        what = "SCHED_FIFO priority";
+    }
+    if (result != 0 && !isFailureLogged_[size_t(role)].exchange(true))
+    {
+        LOG_WARNING("Can not set the " << what << " of the " << getRoleName(role) << " threads: " << strerror(result));
+    }
+    return result == 0;
+}
+
+/**
+ * @return the name of the role, e.g. for the log
+ */
+const char* ThreadPlacement::getRoleName(ThreadRole role) noexcept
+{
+    switch (role)
+    {
+        case ThreadRole::IO:
+            return "I/O";
+        case ThreadRole::LUA:
+            return "Lua";
+        default:
+            return "unknown";
+    }
+}
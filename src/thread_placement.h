@@ -0,0 +1,69 @@
+/**
+ * @file thread_placement.h
+ *
+ */
+
+#ifndef THREAD_PLACEMENT_H
+#define THREAD_PLACEMENT_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * The kinds of threads of the simulator, which are placed on CPUs of their
+ * own, see `ThreadPlacement`.
+ */
+enum class ThreadRole
+{
+    IO, ///< the CAN and DoIP receivers, the reactor, the timers and the J1939 bus and scheduler
+    LUA, ///< the Lua workers of the ECUs and the loading of the configurations
+};
+
+/**
+ * Where the threads of a role run.
+ */
+struct ThreadRoleConfiguration
+{
+    std::vector<int> cpus; ///< the allowed CPUs, empty = the CPUs of the process
+    int priority = 0; ///< the SCHED_FIFO priority (1 - 99), 0 = the normal scheduler
+};
+
+/**
+ * Pins the threads of the simulator to CPUs and sets their scheduling policy
+ * by their role, e.g. on a 4 core Raspberry Pi the CAN I/O and the timers on
+ * core 0 with a real-time priority and the Lua workers on the cores 1 - 3,
+ * so a busy script does not delay the sockets. The threads are created by
+ * their subsystems as usual and call `apply()` when they start.
+ *
+ * The roles are configured once at startup (see `SimulatorConfiguration`),
+ * before the first thread of a role is started. Threads started before (e.g.
+ * the logger) and the other threads (metrics endpoint, config watcher) keep
+ * the placement of the process.
+ */
+class ThreadPlacement
+{
+public:
+    static ThreadPlacement& getInstance();
+
+    ThreadPlacement() = default;
+    ThreadPlacement(const ThreadPlacement& orig) = delete;
+    ThreadPlacement& operator =(const ThreadPlacement& orig) = delete;
+    virtual ~ThreadPlacement() = default;
+
+    void configure(ThreadRole role, const ThreadRoleConfiguration& configuration);
+    const ThreadRoleConfiguration& getConfiguration(ThreadRole role) const noexcept;
+    bool apply(ThreadRole role) noexcept;
+
+    static const char* getRoleName(ThreadRole role) noexcept;
+
+private:
+    static constexpr std::size_t ROLE_COUNT = 2;
+
+    std::array<ThreadRoleConfiguration, ROLE_COUNT> configurations_;
+    /// a failure is logged once per role, not for each of the many Lua workers
+    std::array<std::atomic<bool>, ROLE_COUNT> isFailureLogged_{};
+};
+
+#endif /* THREAD_PLACEMENT_H */
@@ -0,0 +1,118 @@
+/**
+ * @file thread_pool.cpp
+ *
+ */
+
+#include "thread_pool.h"
+#include "logger.h"
+#include <iostream>
+
+using namespace std;
+
+/**
+ * Constructor. Starts the threads.
+ *
+ * @param numThreads: the number of threads, 0 means
+ *                    `getDefaultThreadCount()`
+ */
+ThreadPool::ThreadPool(unsigned int numThreads)
+{
+    if (numThreads == 0)
+    {
+        numThreads = getDefaultThreadCount();
+    }
+    for (unsigned int i = 0; i < numThreads; ++i)
+    {
+        threads_.emplace_back(&ThreadPool::run, this);
+    }
+}
+
+/**
+ * Destructor. Processes the already queued tasks and stops the threads.
+ */
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        isOnExit_ = true;
+    }
+    taskAvailable_.notify_all();
+    for (thread& t : threads_)
+    {
+        t.join();
+    }
+}
+
+/**
+ * Queues the given task without waiting for it.
+ *
+ * @param task: the function to execute on one of the threads
+ */
+void ThreadPool::submit(function<void()> task)
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        tasks_.push_back(move(task));
+    }
+    taskAvailable_.notify_one();
+}
+
+/**
+ * Waits until all queued tasks are finished.
+ */
+void ThreadPool::wait()
+{
+    unique_lock<mutex> lock(mutex_);
+    tasksDone_.wait(lock, [this]() { return tasks_.empty() && runningTasks_ == 0; });
+}
+
+/**
+ * @return the number of threads of the pool
+ */
+unsigned int ThreadPool::getThreadCount() const noexcept
+{
+    return static_cast<unsigned int>(threads_.size());
+}
+
+/**
+ * @return the number of hardware threads, at least 1
+ */
+unsigned int ThreadPool::getDefaultThreadCount() noexcept
+{
+    const unsigned int hardwareThreads = thread::hardware_concurrency();
+    return hardwareThreads > 0 ? hardwareThreads : 1;
+}
+
+void ThreadPool::run()
+{
+    while (true)
+    {
+        function<void()> task;
+        {
+            unique_lock<mutex> lock(mutex_);
+            taskAvailable_.wait(lock, [this]() { return isOnExit_ || !tasks_.empty(); });
+            if (tasks_.empty())
+            {
+                return; // on exit and nothing left to do
+            }
+            task = move(tasks_.front());
+            tasks_.pop_front();
+            ++runningTasks_;
+        }
+
+        try
+        {
+            task();
+        }
+        catch (exception &e)
+        {
+            LOG_ERROR("Thread pool: " << e.what());
+        }
+
+        {
+            lock_guard<mutex> lock(mutex_);
+            --runningTasks_;
+        }
+        tasksDone_.notify_all();
+    }
+}
@@ -0,0 +1,48 @@
+/**
+ * @file thread_pool.h
+ *
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed number of threads processing queued tasks, e.g. loading the ECU
+ * configurations at startup. Unlike the `LuaWorker`, the tasks are executed
+ * in parallel and in no particular order.
+ */
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned int numThreads);
+    ThreadPool(const ThreadPool& orig) = delete;
+    ThreadPool& operator =(const ThreadPool& orig) = delete;
+    virtual ~ThreadPool();
+
+    void submit(std::function<void()> task);
+    void wait();
+    unsigned int getThreadCount() const noexcept;
+
+    static unsigned int getDefaultThreadCount() noexcept;
+
+private:
+    std::mutex mutex_;
+    std::condition_variable taskAvailable_;
+    std::condition_variable tasksDone_;
+    std::deque<std::function<void()>> tasks_;
+    std::size_t runningTasks_ = 0;
+    bool isOnExit_ = false;
+    std::vector<std::thread> threads_;
+
+    void run();
+};
+
+#endif /* THREAD_POOL_H */
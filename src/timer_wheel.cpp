@@ -0,0 +1,316 @@
+/**
+ * @file timer_wheel.cpp
+ *
+ * This file contains the timer wheel, which drives all timers of the
+ * simulation with a single thread.
+ */
+
+#include "timer_wheel.h"
+#include "thread_placement.h"
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * Constructor. The timer is not armed until `schedule()` is called.
+ *
+ * @param wheel: the wheel driving the timer
+ * @param callback: the function to call when the timer expires
+ */
+TimerWheel::Timer::Timer(TimerWheel& wheel, Callback callback)
+: wheel_(wheel)
+, callback_(move(callback))
+{
+}
+
+/**
+ * Destructor. Cancels the timer and waits for its callback if it is running.
+ */
+TimerWheel::Timer::~Timer()
+{
+    cancel();
+}
+
+/**
+ * Arms the timer. If the timer is already armed, it is restarted.
+ *
+ * @param delay: the time until the timer expires
+ */
+void TimerWheel::Timer::schedule(chrono::milliseconds delay) noexcept
+{
+    wheel_.schedule(*this, delay);
+}
+
+/**
+ * Moves the deadline of an armed timer to `delay` from now. This does not
+ * touch the wheel at all, so it is cheap enough to be called on every
+ * request. A deadline earlier than the current one has no effect. Does
+ * nothing if the timer is not armed.
+ *
+ * @param delay: the time until the timer expires
+ */
+void TimerWheel::Timer::postpone(chrono::milliseconds delay) noexcept
+{
+    if (isArmed_)
+    {
+        deadlineTick_ = wheel_.getNowTick() + wheel_.toTicks(delay);
+    }
+}
+
+/**
+ * Disarms the timer. If its callback is running on the wheel thread, this
+ * waits until the callback returned.
+ */
+void TimerWheel::Timer::cancel() noexcept
+{
+    wheel_.cancel(*this);
+}
+
+/**
+ * @return true if the timer is waiting to expire
+ */
+bool TimerWheel::Timer::isArmed() const noexcept
+{
+    return isArmed_;
+}
+
+/**
+ * @return the wheel shared by all timers of the simulation
+ */
+TimerWheel& TimerWheel::getInstance()
+{
+    static TimerWheel wheel;
+    return wheel;
+}
+
+/**
+ * Constructor. Starts the wheel thread.
+ *
+ * @param tick: the resolution of the wheel
+ * @param slots: the number of ticks of one revolution
+ */
+TimerWheel::TimerWheel(chrono::milliseconds tick, size_t slots)
+: start_(SimulationClock::getInstance().now())
+, tick_(tick)
+, slots_(max<size_t>(slots, 1), nullptr)
+, waiter_([this]()
+    {
+        lock_guard<mutex> lock(mutex_);
+        condition_.notify_all();
+    })
+, thread_(&TimerWheel::run, this)
+{
+}
+
+/**
+ * Destructor. Stops the wheel thread, the remaining timers do not expire.
+ */
+TimerWheel::~TimerWheel()
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        isOnExit_ = true;
+    }
+    condition_.notify_all();
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+uint64_t TimerWheel::getNowTick() const noexcept
+{
+    return uint64_t((SimulationClock::getInstance().now() - start_) / tick_);
+}
+
+/**
+ * Walks through all armed timers, so it is only used in virtual time.
+ *
+ * @return the earliest tick a timer is linked to, must be called with the
+ *         lock held
+ */
+uint64_t TimerWheel::getNextExpiryTick() const noexcept
+{
+    uint64_t nextTick = UINT64_MAX;
+    for (const Timer* pTimer : slots_)
+    {
+        for (; pTimer != nullptr; pTimer = pTimer->next_)
+        {
+            nextTick = min(nextTick, pTimer->expiryTick_);
+        }
+    }
+    return nextTick;
+}
+
+/**
+ * Looks for the first tick with an expiring timer, at most one revolution
+ * ahead, so the idle wheel sleeps over the empty ticks instead of waking up
+ * for each of them. Stops at the first such tick, so it is cheap on a busy
+ * wheel.
+ *
+ * @return the tick to sleep until, must be called with the lock held
+ */
+uint64_t TimerWheel::getWakeupTick() const noexcept
+{
+    const uint64_t lastTick = currentTick_ + slots_.size();
+    for (uint64_t tick = currentTick_; tick < lastTick; ++tick)
+    {
+        for (const Timer* pTimer = slots_[size_t(tick % slots_.size())]; pTimer != nullptr; pTimer = pTimer->next_)
+        {
+            if (pTimer->expiryTick_ <= tick)
+            {
+                return tick;
+            }
+        }
+    }
+    return lastTick;
+}
+
+uint64_t TimerWheel::toTicks(chrono::milliseconds delay) const noexcept
+{
+    const uint64_t ticks = uint64_t((delay + tick_ - chrono::milliseconds(1)) / tick_);
+    return max<uint64_t>(ticks, 1);
+}
+
+void TimerWheel::link(Timer& timer, uint64_t expiryTick) noexcept
+{
+    timer.expiryTick_ = expiryTick;
+    timer.slot_ = size_t(expiryTick % slots_.size());
+    timer.prev_ = nullptr;
+    timer.next_ = slots_[timer.slot_];
+    if (timer.next_)
+    {
+        timer.next_->prev_ = &timer;
+    }
+    slots_[timer.slot_] = &timer;
+}
+
+void TimerWheel::unlink(Timer& timer) noexcept
+{
+    if (timer.prev_)
+    {
+        timer.prev_->next_ = timer.next_;
+    }
+    else
+    {
+        slots_[timer.slot_] = timer.next_;
+    }
+    if (timer.next_)
+    {
+        timer.next_->prev_ = timer.prev_;
+    }
+    timer.prev_ = nullptr;
+    timer.next_ = nullptr;
+}
+
+void TimerWheel::schedule(Timer& timer, chrono::milliseconds delay) noexcept
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        if (timer.isArmed_)
+        {
+            unlink(timer);
+        }
+        else
+        {
+            if (numTimers_ == 0)
+            {
+                // the wheel stood still, continue at the current time
+                currentTick_ = max(currentTick_, getNowTick());
+            }
+            numTimers_++;
+        }
+
+        const uint64_t expiryTick = max(getNowTick(), currentTick_) + toTicks(delay);
+        timer.deadlineTick_ = expiryTick;
+        link(timer, expiryTick);
+        timer.isArmed_ = true;
+    }
+    condition_.notify_all();
+}
+
+void TimerWheel::cancel(Timer& timer) noexcept
+{
+    unique_lock<mutex> lock(mutex_);
+    if (this_thread::get_id() != thread_.get_id())
+    {
+        condition_.wait(lock, [this, &timer]() { return pRunningTimer_ != &timer; });
+    }
+    if (timer.isArmed_)
+    {
+        unlink(timer);
+        timer.isArmed_ = false;
+        numTimers_--;
+    }
+}
+
+/**
+ * Removes the first timer of the given slot, which expires in the current
+ * tick. Postponed timers are moved to the slot of their new deadline.
+ *
+ * @return the expired timer or `nullptr` if there is none (anymore)
+ */
+TimerWheel::Timer* TimerWheel::popExpiredTimer(size_t slot) noexcept
+{
+    Timer* pTimer = slots_[slot];
+    while (pTimer)
+    {
+        Timer* pNext = pTimer->next_;
+        if (pTimer->expiryTick_ <= currentTick_)
+        {
+            const uint64_t deadlineTick = pTimer->deadlineTick_;
+            unlink(*pTimer);
+            if (deadlineTick > currentTick_)
+            {
+                link(*pTimer, deadlineTick);
+            }
+            else
+            {
+                pTimer->isArmed_ = false;
+                numTimers_--;
+                return pTimer;
+            }
+        }
+        pTimer = pNext;
+    }
+    return nullptr;
+}
+
+void TimerWheel::run()
+{
+    ThreadPlacement::getInstance().apply(ThreadRole::IO);
+    SimulationClock& clock = SimulationClock::getInstance();
+    unique_lock<mutex> lock(mutex_);
+    while (!isOnExit_)
+    {
+        if (numTimers_ == 0)
+        {
+            waiter_.clearDeadline();
+            condition_.wait(lock, [this]() { return isOnExit_ || numTimers_ > 0; });
+            continue;
+        }
+
+        if (currentTick_ > getNowTick())
+        {
+            if (clock.isVirtual())
+            {
+                waiter_.setDeadline(start_ + tick_ * max(currentTick_, getNextExpiryTick()));
+            }
+            // a timer scheduled meanwhile wakes the thread up
+            condition_.wait_until(lock, clock.toRealTime(start_ + tick_ * getWakeupTick()));
+            continue;
+        }
+
+        Timer* pTimer;
+        while ((pTimer = popExpiredTimer(size_t(currentTick_ % slots_.size()))) != nullptr)
+        {
+            pRunningTimer_ = pTimer;
+            lock.unlock();
+            pTimer->callback_();
+            lock.lock();
+            pRunningTimer_ = nullptr;
+            condition_.notify_all();
+        }
+        currentTick_++;
+    }
+}
@@ -0,0 +1,112 @@
+/**
+ * @file timer_wheel.h
+ *
+ */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include "simulation_clock.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Hashed timer wheel, which serves all timers of the simulation (e.g. the S3
+ * timeouts of the `SessionController`s) with a single thread.
+ *
+ * The wheel consists of `slots` lists, each covering one tick. A timer is
+ * linked into the slot of its expiry tick, timers more than one revolution
+ * ahead stay in their slot until the wheel has turned often enough. Arming
+ * and cancelling a timer is O(1).
+ *
+ * Postponing a running timer (`postpone()`) is even cheaper, since it is done
+ * very often (e.g. after every UDS request): it only stores the new deadline.
+ * When the original slot of the timer is reached, the timer is moved to the
+ * slot of its new deadline instead of being fired.
+ *
+ * The wheel only wakes up for the ticks a timer expires in, so it costs no
+ * wakeups while the armed timers are far ahead (e.g. an S3 timeout).
+ *
+ * The wheel turns with the `SimulationClock`. In virtual time it reports the
+ * earliest expiry of its timers, so the clock can jump to it.
+ *
+ * The callbacks are called on the wheel thread and should return quickly.
+ */
+class TimerWheel
+{
+public:
+    using Callback = std::function<void()>;
+
+    /**
+     * A timer of the wheel. The timer is owned by its user and linked into the
+     * wheel while it is armed. It must not be destroyed while being armed,
+     * which is ensured by cancelling it in its destructor.
+     */
+    class Timer
+    {
+        friend class TimerWheel;
+
+    public:
+        Timer(TimerWheel& wheel, Callback callback);
+        Timer(const Timer& orig) = delete;
+        Timer& operator =(const Timer& orig) = delete;
+        virtual ~Timer();
+
+        void schedule(std::chrono::milliseconds delay) noexcept;
+        void postpone(std::chrono::milliseconds delay) noexcept;
+        void cancel() noexcept;
+        bool isArmed() const noexcept;
+
+    private:
+        TimerWheel& wheel_;
+        Callback callback_;
+        Timer* prev_ = nullptr;
+        Timer* next_ = nullptr;
+        std::size_t slot_ = 0;
+        std::uint64_t expiryTick_ = 0; ///< the tick of the slot the timer is linked to
+        std::atomic<std::uint64_t> deadlineTick_{0}; ///< might be later after `postpone()`
+        std::atomic<bool> isArmed_{false};
+    };
+
+    static TimerWheel& getInstance();
+
+    TimerWheel(std::chrono::milliseconds tick = std::chrono::milliseconds(1),
+               std::size_t slots = 1024);
+    TimerWheel(const TimerWheel& orig) = delete;
+    TimerWheel& operator =(const TimerWheel& orig) = delete;
+    virtual ~TimerWheel();
+
+private:
+    const std::chrono::steady_clock::time_point start_;
+    const std::chrono::milliseconds tick_;
+    std::vector<Timer*> slots_; ///< heads of the intrusive timer lists
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::size_t numTimers_ = 0;
+    std::uint64_t currentTick_ = 0; ///< all slots before this tick are processed
+    Timer* pRunningTimer_ = nullptr; ///< the timer whose callback is running
+    bool isOnExit_ = false;
+    SimulationClock::Waiter waiter_;
+    std::thread thread_;
+
+    std::uint64_t getNowTick() const noexcept;
+    std::uint64_t getNextExpiryTick() const noexcept;
+    std::uint64_t getWakeupTick() const noexcept;
+    std::uint64_t toTicks(std::chrono::milliseconds delay) const noexcept;
+    void link(Timer& timer, std::uint64_t expiryTick) noexcept;
+    void unlink(Timer& timer) noexcept;
+    void schedule(Timer& timer, std::chrono::milliseconds delay) noexcept;
+    void cancel(Timer& timer) noexcept;
+    Timer* popExpiredTimer(std::size_t slot) noexcept;
+    void run();
+};
+
+#endif /* TIMER_WHEEL_H */
@@ -0,0 +1,520 @@
+/**
+ * @file traffic_capture.cpp
+ *
+ * This file contains the capture of the simulated traffic into a
+ * memory-mapped ring file and its export as candump log.
+ */
+
+#include "traffic_capture.h"
+#include "logger.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <new>
+
+using namespace std;
+
+static constexpr char FILE_MAGIC[8] = {'C', 'S', 'I', 'M', 'C', 'A', 'P', '1'};
+static constexpr uint32_t FILE_VERSION = 1;
+/// the ring starts on its own page
+static constexpr size_t HEADER_SIZE = 4096;
+static constexpr uint32_t RECORD_MAGIC = 0x43524543; // "CREC"
+static constexpr size_t RECORD_ALIGNMENT = 8;
+static constexpr size_t MIN_CAPACITY = 64 * 1024;
+
+/// the highest 11 bit CAN ID
+static constexpr uint32_t CAN_SFF_MAX = 0x7FF;
+static constexpr uint8_t ISOTP_PADDING = 0xCC;
+static constexpr uint8_t J1939_PADDING = 0xFF;
+static constexpr uint32_t J1939_DEFAULT_PRIORITY = 6;
+static constexpr uint32_t J1939_PGN_TP_CM = 0xEC00;
+static constexpr uint32_t J1939_PGN_TP_DT = 0xEB00;
+static constexpr uint8_t J1939_TP_CM_BAM = 0x20;
+static constexpr uint8_t J1939_NO_ADDRESS = 0xFF;
+
+static inline size_t alignRecord(size_t size) noexcept
+{
+    return (size + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+}
+
+namespace
+{
+
+/**
+ * Writes one CAN frame in the format of `candump -l`, e.g.
+ * `(1500000000.000000) vcan0 7E8#0462F19001CCCCCC`.
+ */
+void writeCandumpFrame(ostream& out, uint64_t timestampNs, const string& interface,
+                       uint32_t canId, const uint8_t* data, size_t length)
+{
+    static constexpr char HEX_DIGITS[] = "0123456789ABCDEF";
+    const bool isExtended = canId > CAN_SFF_MAX;
+    out << '(' << dec << timestampNs / 1000000000 << '.'
+        << setw(6) << setfill('0') << (timestampNs % 1000000000) / 1000 << ") "
+        << interface << ' '
+        << hex << uppercase << setw(isExtended ? 8 : 3) << setfill('0') << canId << '#';
+    for (size_t i = 0; i < length; ++i)
+    {
+        out << HEX_DIGITS[data[i] >> 4] << HEX_DIGITS[data[i] & 0x0F];
+    }
+    out << '\n';
+}
+
+/**
+ * Splits an UDS message into ISO-TP single, first and consecutive frames.
+ * Flow control frames of the peer are not part of the capture.
+ */
+void writeIsoTpFrames(ostream& out, uint64_t timestampNs, const string& interface,
+                      uint32_t canId, const vector<uint8_t>& payload)
+{
+    uint8_t frame[8];
+    const size_t length = payload.size();
+    if (length <= 7)
+    {
+        fill(begin(frame), end(frame), ISOTP_PADDING);
+        frame[0] = uint8_t(length);
+        copy(payload.cbegin(), payload.cend(), frame + 1);
+        writeCandumpFrame(out, timestampNs, interface, canId, frame, sizeof(frame));
+        return;
+    }
+
+    size_t offset;
+    if (length <= 0xFFF)
+    {
+        frame[0] = uint8_t(0x10 | (length >> 8));
+        frame[1] = uint8_t(length);
+        copy(payload.cbegin(), payload.cbegin() + 6, frame + 2);
+        offset = 6;
+    }
+    else
+    {
+        // escape sequence for messages with more than 4095 bytes
+        frame[0] = 0x10;
+        frame[1] = 0x00;
+        frame[2] = uint8_t(length >> 24);
+        frame[3] = uint8_t(length >> 16);
+        frame[4] = uint8_t(length >> 8);
+        frame[5] = uint8_t(length);
+        copy(payload.cbegin(), payload.cbegin() + 2, frame + 6);
+        offset = 2;
+    }
+    writeCandumpFrame(out, timestampNs, interface, canId, frame, sizeof(frame));
+
+    for (uint8_t sequenceNumber = 1; offset < length; sequenceNumber = (sequenceNumber + 1) & 0x0F)
+    {
+        const size_t chunk = min<size_t>(7, length - offset);
+        fill(begin(frame), end(frame), ISOTP_PADDING);
+        frame[0] = uint8_t(0x20 | sequenceNumber);
+        copy(payload.cbegin() + offset, payload.cbegin() + offset + chunk, frame + 1);
+        writeCandumpFrame(out, timestampNs, interface, canId, frame, sizeof(frame));
+        offset += chunk;
+    }
+}
+
+/**
+ * @return the 29 bit CAN ID of a J1939 message
+ */
+uint32_t toJ1939CanId(uint32_t pgn, uint8_t sourceAddress, uint8_t targetAddress)
+{
+    uint32_t canId = (J1939_DEFAULT_PRIORITY << 26) | uint32_t(sourceAddress);
+    const uint8_t pduFormat = uint8_t(pgn >> 8);
+    if (pduFormat < 240)
+    {
+        // PDU1: the PDU specific byte is the target address
+        canId |= ((pgn & 0x3FF00) << 8) | (uint32_t(targetAddress) << 8);
+    }
+    else
+    {
+        canId |= (pgn & 0x3FFFF) << 8;
+    }
+    return canId;
+}
+
+/**
+ * Writes a J1939 message as single frame or, if it is longer than 8 bytes,
+ * as BAM transfer (TP.CM followed by TP.DT frames).
+ */
+void writeJ1939Frames(ostream& out, uint64_t timestampNs, const string& interface,
+                      uint32_t pgn, uint8_t sourceAddress, uint8_t targetAddress,
+                      const vector<uint8_t>& payload)
+{
+    const size_t length = payload.size();
+    if (length <= 8)
+    {
+        writeCandumpFrame(out, timestampNs, interface,
+                          toJ1939CanId(pgn, sourceAddress, targetAddress),
+                          payload.data(), length);
+        return;
+    }
+
+    const size_t packets = (length + 6) / 7;
+    const uint8_t announcement[8] = {
+        J1939_TP_CM_BAM, uint8_t(length), uint8_t(length >> 8), uint8_t(packets),
+        0xFF, uint8_t(pgn), uint8_t(pgn >> 8), uint8_t(pgn >> 16)
+    };
+    writeCandumpFrame(out, timestampNs, interface,
+                      toJ1939CanId(J1939_PGN_TP_CM, sourceAddress, J1939_NO_ADDRESS),
+                      announcement, sizeof(announcement));
+
+    uint8_t frame[8];
+    for (size_t packet = 0; packet < packets; ++packet)
+    {
+        const size_t offset = packet * 7;
+        const size_t chunk = min<size_t>(7, length - offset);
+        fill(begin(frame), end(frame), J1939_PADDING);
+        frame[0] = uint8_t(packet + 1);
+        copy(payload.cbegin() + offset, payload.cbegin() + offset + chunk, frame + 1);
+        writeCandumpFrame(out, timestampNs, interface,
+                          toJ1939CanId(J1939_PGN_TP_DT, sourceAddress, J1939_NO_ADDRESS),
+                          frame, sizeof(frame));
+    }
+}
+
+} // namespace
+
+/**
+ * @return the capture of the process, which is closed until `open()` is called
+ */
+TrafficCapture& TrafficCapture::getInstance()
+{
+    static TrafficCapture capture;
+    return capture;
+}
+
+TrafficCapture::~TrafficCapture()
+{
+    close();
+}
+
+/**
+ * Creates (or truncates) the capture file and maps it into memory. The pages
+ * are populated in advance, so recording does not cause page faults.
+ *
+ * @param captureFile: path of the capture file
+ * @param capacity: the size of the ring in bytes (at least 64 KiB)
+ * @return 0 on success, otherwise a negative value
+ */
+int TrafficCapture::open(const string& captureFile, size_t capacity) noexcept
+{
+    if (isOpen())
+    {
+        LOG_ERROR(__func__ << "() Capture is already open!");
+        return -1;
+    }
+
+    capacity = max(capacity, MIN_CAPACITY) & ~(RECORD_ALIGNMENT - 1);
+    const size_t mappingSize = HEADER_SIZE + capacity;
+    const int fd = ::open(captureFile.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        LOG_ERROR(__func__ << "() open " << captureFile << ": " << strerror(errno));
+        return -2;
+    }
+    if (ftruncate(fd, off_t(mappingSize)) < 0)
+    {
+        LOG_ERROR(__func__ << "() ftruncate: " << strerror(errno));
+        ::close(fd);
+        return -3;
+    }
+    void* pMapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    ::close(fd);
+    if (pMapping == MAP_FAILED)
+    {
+        LOG_ERROR(__func__ << "() mmap: " << strerror(errno));
+        return -4;
+    }
+
+    FileHeader* pHeader = new (pMapping) FileHeader();
+    memcpy(pHeader->magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    pHeader->version = FILE_VERSION;
+    pHeader->headerSize = HEADER_SIZE;
+    pHeader->capacity = capacity;
+    pHeader->writePosition.store(0, memory_order_relaxed);
+
+    pRing_ = static_cast<uint8_t*>(pMapping) + HEADER_SIZE;
+    capacity_ = capacity;
+    mappingSize_ = mappingSize;
+    {
+        lock_guard<mutex> lock(interfacesMutex_);
+        pHeader_.store(pHeader, memory_order_release);
+        writeInterfaces();
+    }
+    LOG_INFO("Capturing the traffic into " << captureFile << " (" << capacity / 1024 << " KiB)");
+    return 0;
+}
+
+/**
+ * Stops the capture and unmaps the file. Must not be called while messages
+ * are recorded, i.e. only after the simulations are stopped.
+ */
+void TrafficCapture::close() noexcept
+{
+    FileHeader* pHeader = pHeader_.exchange(nullptr, memory_order_acq_rel);
+    if (pHeader == nullptr)
+    {
+        return;
+    }
+    msync(pHeader, mappingSize_, MS_SYNC);
+    munmap(pHeader, mappingSize_);
+    pRing_ = nullptr;
+}
+
+/**
+ * Gets the index of the given interface in the capture file. Should be called
+ * once per receiver/sender, not per message.
+ *
+ * @param interface: the name of the interface (e.g. "vcan0")
+ * @return the index, `MAX_INTERFACES` if there are too many interfaces
+ */
+uint8_t TrafficCapture::getInterfaceIndex(const string& interface) noexcept
+{
+    lock_guard<mutex> lock(interfacesMutex_);
+    auto iter = find(interfaces_.cbegin(), interfaces_.cend(), interface);
+    if (iter != interfaces_.cend())
+    {
+        return uint8_t(iter - interfaces_.cbegin());
+    }
+    if (interfaces_.size() >= MAX_INTERFACES)
+    {
+        return MAX_INTERFACES;
+    }
+    interfaces_.push_back(interface);
+    writeInterfaces();
+    return uint8_t(interfaces_.size() - 1);
+}
+
+/**
+ * Records a message. Does nothing if the capture is not open. Never blocks.
+ *
+ * @param protocol: the protocol of the message
+ * @param direction: `RX` for received requests, `TX` for sent responses
+ * @param interface: see `getInterfaceIndex()`
+ * @param identifier: the CAN ID (UDS) or the PGN (J1939)
+ * @param sourceAddress: the J1939 source or DoIP source logical address
+ * @param targetAddress: the J1939 target or DoIP target logical address
+ * @param payload: the message, copied directly into the capture file
+ * @param length: the length of the message in bytes
+ */
+void TrafficCapture::record(Protocol protocol,
+                            Direction direction,
+                            uint8_t interface,
+                            uint32_t identifier,
+                            uint16_t sourceAddress,
+                            uint16_t targetAddress,
+                            const void* payload,
+                            size_t length) noexcept
+{
+    FileHeader* pHeader = pHeader_.load(memory_order_acquire);
+    if (pHeader == nullptr)
+    {
+        return;
+    }
+    const size_t recordSize = alignRecord(sizeof(RecordHeader) + length);
+    if (recordSize > capacity_ / 2)
+    {
+        return;
+    }
+
+    const uint64_t position = pHeader->writePosition.fetch_add(recordSize, memory_order_relaxed);
+    // the magic is aligned and never wraps, it marks the record as complete
+    uint32_t* pMagic = reinterpret_cast<uint32_t*>(pRing_ + position % capacity_);
+    __atomic_store_n(pMagic, 0, __ATOMIC_RELAXED);
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    RecordHeader header = {};
+    header.length = uint32_t(length);
+    header.position = position;
+    header.timestampNs = uint64_t(now.tv_sec) * 1000000000 + uint64_t(now.tv_nsec);
+    header.identifier = identifier;
+    header.sourceAddress = sourceAddress;
+    header.targetAddress = targetAddress;
+    header.protocol = protocol;
+    header.direction = direction;
+    header.interface = interface;
+
+    copyToRing(pRing_, capacity_, position + sizeof(header.magic),
+               reinterpret_cast<const uint8_t*>(&header) + sizeof(header.magic),
+               sizeof(header) - sizeof(header.magic));
+    copyToRing(pRing_, capacity_, position + sizeof(header), payload, length);
+    __atomic_store_n(pMagic, RECORD_MAGIC, __ATOMIC_RELEASE);
+}
+
+/**
+ * Reads the complete records of a capture file from the oldest to the newest
+ * one. The file is memory-mapped, only the payload of a record wrapping
+ * around the end of the ring is copied.
+ *
+ * @param captureFile: path of the capture file
+ * @param handler: called for every record
+ * @return the number of records or a negative value on error
+ */
+int TrafficCapture::readRecords(const string& captureFile, const RecordHandler& handler)
+{
+    const int fd = ::open(captureFile.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        LOG_ERROR(__func__ << "() open " << captureFile << ": " << strerror(errno));
+        return -1;
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) < 0 || size_t(fileStat.st_size) < HEADER_SIZE)
+    {
+        LOG_ERROR(__func__ << "() " << captureFile << " is not a capture file");
+        ::close(fd);
+        return -2;
+    }
+    const size_t mappingSize = size_t(fileStat.st_size);
+    void* pMapping = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (pMapping == MAP_FAILED)
+    {
+        LOG_ERROR(__func__ << "() mmap: " << strerror(errno));
+        return -3;
+    }
+
+    const FileHeader* pHeader = static_cast<const FileHeader*>(pMapping);
+    if (memcmp(pHeader->magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0
+        || pHeader->version != FILE_VERSION
+        || pHeader->headerSize + pHeader->capacity > mappingSize)
+    {
+        LOG_ERROR(__func__ << "() " << captureFile << " is not a capture file");
+        munmap(pMapping, mappingSize);
+        return -2;
+    }
+
+    // the names of all possible interface indices, "can<index>" if unknown
+    vector<string> interfaces(256);
+    for (size_t i = 0; i < interfaces.size(); ++i)
+    {
+        interfaces[i] = i < MAX_INTERFACES && pHeader->interfaces[i][0] != '\0'
+            ? string(pHeader->interfaces[i], strnlen(pHeader->interfaces[i], MAX_INTERFACE_NAME))
+            : "can" + to_string(i);
+    }
+
+    const uint8_t* pRing = static_cast<const uint8_t*>(pMapping) + pHeader->headerSize;
+    const size_t capacity = pHeader->capacity;
+    const uint64_t end = pHeader->writePosition.load(memory_order_acquire);
+    uint64_t position = end > capacity ? alignRecord(end - capacity) : 0;
+
+    int count = 0;
+    vector<uint8_t> wrappedPayload;
+    while (position + sizeof(RecordHeader) <= end)
+    {
+        RecordHeader header;
+        copyFromRing(pRing, capacity, position, &header, sizeof(header));
+        // resynchronize after the oldest, partly overwritten record
+        if (header.magic != RECORD_MAGIC || header.position != position || header.length > capacity / 2)
+        {
+            position += RECORD_ALIGNMENT;
+            continue;
+        }
+        Record record;
+        record.protocol = header.protocol;
+        record.direction = header.direction;
+        record.timestampNs = header.timestampNs;
+        record.identifier = header.identifier;
+        record.sourceAddress = header.sourceAddress;
+        record.targetAddress = header.targetAddress;
+        record.interface = interfaces[header.interface];
+        record.length = header.length;
+        const size_t offset = (position + sizeof(header)) % capacity;
+        if (offset + header.length <= capacity)
+        {
+            record.payload = pRing + offset;
+        }
+        else
+        {
+            wrappedPayload.resize(header.length);
+            copyFromRing(pRing, capacity, position + sizeof(header), wrappedPayload.data(), header.length);
+            record.payload = wrappedPayload.data();
+        }
+        position += alignRecord(sizeof(header) + header.length);
+        handler(record);
+        ++count;
+    }
+
+    munmap(pMapping, mappingSize);
+    return count;
+}
+
+/**
+ * Exports a capture file as candump log (`candump -l` format), which can be
+ * replayed with `canplayer` or decoded with e.g. Wireshark. UDS messages are
+ * split into ISO-TP frames, J1939 messages longer than 8 bytes are written as
+ * BAM transfer. DoIP records are skipped, since they are not CAN traffic.
+ *
+ * @param captureFile: path of the capture file
+ * @param out: the stream to write the log to
+ * @return the number of exported records or a negative value on error
+ */
+int TrafficCapture::exportCandump(const string& captureFile, ostream& out)
+{
+    const ios_base::fmtflags flags = out.flags();
+    const char fillCharacter = out.fill();
+    int exported = 0;
+    vector<uint8_t> payload;
+    const int result = readRecords(captureFile, [&out, &exported, &payload](const Record& record)
+    {
+        const string interface(record.interface);
+        payload.assign(record.payload, record.payload + record.length);
+        switch (record.protocol)
+        {
+        case Protocol::UDS:
+            writeIsoTpFrames(out, record.timestampNs, interface, record.identifier, payload);
+            break;
+        case Protocol::J1939:
+            writeJ1939Frames(out, record.timestampNs, interface, record.identifier,
+                             uint8_t(record.sourceAddress), uint8_t(record.targetAddress), payload);
+            break;
+        default:
+            return;
+        }
+        ++exported;
+    });
+    out.flags(flags);
+    out.fill(fillCharacter);
+    return result < 0 ? result : exported;
+}
+
+void TrafficCapture::copyToRing(uint8_t* pRing, size_t capacity,
+                                uint64_t position, const void* data, size_t length) noexcept
+{
+    const size_t offset = position % capacity;
+    const size_t first = min(length, capacity - offset);
+    memcpy(pRing + offset, data, first);
+    memcpy(pRing, static_cast<const uint8_t*>(data) + first, length - first);
+}
+
+void TrafficCapture::copyFromRing(const uint8_t* pRing, size_t capacity,
+                                  uint64_t position, void* data, size_t length) noexcept
+{
+    const size_t offset = position % capacity;
+    const size_t first = min(length, capacity - offset);
+    memcpy(data, pRing + offset, first);
+    memcpy(static_cast<uint8_t*>(data) + first, pRing, length - first);
+}
+
+/**
+ * Copies the interface names into the file header. `interfacesMutex_` has
+ * to be locked.
+ */
+void TrafficCapture::writeInterfaces() noexcept
+{
+    FileHeader* pHeader = pHeader_.load(memory_order_relaxed);
+    if (pHeader == nullptr)
+    {
+        return;
+    }
+    for (size_t i = 0; i < interfaces_.size(); ++i)
+    {
+        strncpy(pHeader->interfaces[i], interfaces_[i].c_str(), MAX_INTERFACE_NAME - 1);
+        pHeader->interfaces[i][MAX_INTERFACE_NAME - 1] = '\0';
+    }
+}
@@ -0,0 +1,140 @@
+/**
+ * @file traffic_capture.h
+ *
+ */
+
+#ifndef TRAFFIC_CAPTURE_H
+#define TRAFFIC_CAPTURE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Records every received request and sent response of the simulations into a
+ * memory-mapped ring file, e.g. to analyze a soak test afterwards.
+ *
+ * The file starts with a `FileHeader`, followed by the ring of records. Each
+ * record is a `RecordHeader` followed by the payload, padded to 8 bytes. A
+ * writer reserves its space with a single atomic addition on the write
+ * position and copies the payload directly from the receive (or send) buffer
+ * into the mapping, so recording never blocks and does not allocate memory.
+ * When the ring is full, the oldest records are overwritten.
+ *
+ * The capture is exported as candump log with `exportCandump()`, or read
+ * record by record with `readRecords()`, e.g. by the `ReplayTrace`.
+ */
+class TrafficCapture
+{
+public:
+    enum class Protocol : std::uint8_t
+    {
+        UDS = 1,
+        J1939 = 2,
+        DOIP = 3
+    };
+
+    enum class Direction : std::uint8_t
+    {
+        RX = 0,
+        TX = 1
+    };
+
+    static constexpr std::size_t MAX_INTERFACES = 16;
+    static constexpr std::size_t MAX_INTERFACE_NAME = 16;
+
+    /// a complete record of a capture file, see `readRecords()`
+    struct Record
+    {
+        Protocol protocol;
+        Direction direction;
+        std::uint64_t timestampNs; ///< `CLOCK_REALTIME`
+        std::uint32_t identifier; ///< CAN ID (UDS) or PGN (J1939)
+        std::uint16_t sourceAddress;
+        std::uint16_t targetAddress;
+        std::string_view interface;
+        const std::uint8_t* payload; ///< only valid during the call of the handler
+        std::size_t length;
+    };
+
+    using RecordHandler = std::function<void(const Record& record)>;
+
+    static TrafficCapture& getInstance();
+
+    TrafficCapture() = default;
+    TrafficCapture(const TrafficCapture& orig) = delete;
+    TrafficCapture& operator =(const TrafficCapture& orig) = delete;
+    virtual ~TrafficCapture();
+
+    int open(const std::string& captureFile, std::size_t capacity) noexcept;
+    void close() noexcept;
+
+    /**
+     * @return true if a capture file is open
+     */
+    bool isOpen() const noexcept
+    {
+        return pHeader_.load(std::memory_order_acquire) != nullptr;
+    }
+
+    std::uint8_t getInterfaceIndex(const std::string& interface) noexcept;
+
+    void record(Protocol protocol,
+                Direction direction,
+                std::uint8_t interface,
+                std::uint32_t identifier,
+                std::uint16_t sourceAddress,
+                std::uint16_t targetAddress,
+                const void* payload,
+                std::size_t length) noexcept;
+
+    static int readRecords(const std::string& captureFile, const RecordHandler& handler);
+    static int exportCandump(const std::string& captureFile, std::ostream& out);
+
+private:
+    struct FileHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t headerSize;
+        std::uint64_t capacity;
+        std::atomic<std::uint64_t> writePosition; ///< monotonic, modulo `capacity` in the ring
+        char interfaces[MAX_INTERFACES][MAX_INTERFACE_NAME];
+    };
+
+    struct RecordHeader
+    {
+        std::uint32_t magic; ///< `RECORD_MAGIC` as soon as the record is complete
+        std::uint32_t length; ///< payload length
+        std::uint64_t position; ///< the write position of the record
+        std::uint64_t timestampNs; ///< `CLOCK_REALTIME`
+        std::uint32_t identifier; ///< CAN ID (UDS) or PGN (J1939)
+        std::uint16_t sourceAddress; ///< J1939 or DoIP logical address
+        std::uint16_t targetAddress; ///< J1939 or DoIP logical address
+        Protocol protocol;
+        Direction direction;
+        std::uint8_t interface; ///< index into `FileHeader::interfaces`
+        std::uint8_t reserved;
+    };
+
+    std::atomic<FileHeader*> pHeader_{nullptr};
+    std::uint8_t* pRing_ = nullptr;
+    std::size_t capacity_ = 0;
+    std::size_t mappingSize_ = 0;
+    std::mutex interfacesMutex_;
+    std::vector<std::string> interfaces_;
+
+    static void copyToRing(std::uint8_t* pRing, std::size_t capacity,
+                           std::uint64_t position, const void* data, std::size_t length) noexcept;
+    static void copyFromRing(const std::uint8_t* pRing, std::size_t capacity,
+                             std::uint64_t position, void* data, std::size_t length) noexcept;
+    void writeInterfaces() noexcept;
+};
+
+#endif /* TRAFFIC_CAPTURE_H */
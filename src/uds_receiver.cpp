@@ -7,43 +7,123 @@
 
 #include "uds_receiver.h"
 #include "service_identifier.h"
+#include "idle_monitor.h"
+#include "logger.h"
 #include <vector>
 #include <array>
 #include <iostream>
-#include <random>
-#include <limits>
 #include <cassert>
 
 using namespace std;
 
-static random_device RANDOM_DEVICE; ///< necessary for `generateSeed()`
-
 /**
- * Constructor.
+ * Constructor. Opens the receiver socket on the given CAN device.
  * 
  * @param source
  * @param dest
  * @param device
  * @param ecuScript
- * @param pSender
+ * @param pTransport: sends the responses, usually the `IsoTpSender` of the ECU
  * @param pSesCtrl
  */
 UdsReceiver::UdsReceiver(canid_t source,
                          canid_t dest,
                          const string& device,
                          EcuLuaScript *pEcuScript,
-                         IsoTpSender* pSender,
+                         UdsTransport* pTransport,
+                         SessionController* pSesCtrl)
+: IsoTpReceiver(source, dest, device, pEcuScript->getIsoTpConfiguration())
+, pEcuScript_(pEcuScript)
+, pTransport_(pTransport)
+, pSessionCtrl_(pSesCtrl)
+{
+    initialize(source, dest, device);
+}
+
+/**
+ * Constructor of a receiver without socket, the requests are passed to
+ * `proceedReceivedData()` directly and the responses are sent with the given
+ * transport, e.g. a `LoopbackTransport`. `ReadDataByPeriodicIdentifier` is not
+ * supported, since its messages are plain CAN frames.
+ *
+ * @param source
+ * @param dest
+ * @param ecuScript
+ * @param pTransport: sends the responses
+ * @param pSesCtrl
+ */
+UdsReceiver::UdsReceiver(canid_t source,
+                         canid_t dest,
+                         EcuLuaScript *pEcuScript,
+                         UdsTransport* pTransport,
                          SessionController* pSesCtrl)
-: IsoTpReceiver(source, dest, device)
+: IsoTpReceiver(source, dest, pEcuScript->getIsoTpConfiguration())
 , pEcuScript_(pEcuScript)
-, pIsoTpSender_(pSender)
+, pTransport_(pTransport)
 , pSessionCtrl_(pSesCtrl)
 {
-    assert(pIsoTpSender_ != nullptr);
+    initialize(source, dest, string());
+}
+
+/**
+ * Prepares the services of the ECU, called by the constructors.
+ *
+ * @param source
+ * @param dest
+ * @param device: the CAN device, empty without socket
+ */
+void UdsReceiver::initialize(canid_t source, canid_t dest, const string& device)
+{
+    responseBuffer_.reserve(MAX_UDS_MSG_SIZE);
+    rawRequest_.reserve(MAX_UDS_MSG_SIZE);
+    maxQueuedRequests_ = pEcuScript_->getMaxQueuedRequests();
+    assert(pTransport_ != nullptr);
+    pResponseDelay_ = pEcuScript_->getResponseDelay();
+    pDelayedResponses_ = std::make_unique<DelayedResponses>(pTransport_);
     assert(pSessionCtrl_ != nullptr);
-    pEcuScript_->registerIsoTpSender(pSender);
-    pEcuScript_->registerSessionController(pSesCtrl);
-    requestByteTree = pEcuScript->buildRequestByteTreeFromRawTable();
+    EcuLuaScript *pEcuScript = pEcuScript_;
+    SessionController* pSesCtrl = pSessionCtrl_;
+    UdsTransport* pTransport = pTransport_;
+    pEcuScript->registerTransport(pTransport);
+    pEcuScript->registerSessionController(pSesCtrl);
+    pSesCtrl->configureSessions(pEcuScript->getSessionConfigurations());
+    pEcuScript->getRawRequestMatcher(); // compile the 'Raw' table before the first request
+    PeriodicDataService::Sender periodicSender;
+    if (pEcuScript->hasPeriodicData() && device.empty())
+    {
+        LOG_WARNING("No CAN interface, ReadDataByPeriodicIdentifier not supported");
+    }
+    else if (pEcuScript->hasPeriodicData())
+    {
+        auto pFrameSender = make_shared<CanFrameSender>(device);
+        if (pFrameSender->openSender() != 0)
+        {
+            LOG_WARNING("Unable to open the periodic sender, ReadDataByPeriodicIdentifier not supported");
+        }
+        else
+        {
+            periodicSender = [pFrameSender](const struct can_frame* frames, size_t count) {
+                pFrameSender->sendFrames(frames, count);
+            };
+        }
+    }
+    pDispatcher_ = std::make_unique<ServiceDispatcher>(pEcuScript, pSesCtrl,
+                                                       pEcuScript->getIsoTpConfiguration().maxMessageSize,
+                                                       [pTransport](const uint8_t* response, size_t length) {
+                                                           pTransport->sendData(response, length);
+                                                       },
+                                                       move(periodicSender));
+    if (!pEcuScript->getReplayFile().empty())
+    {
+        pReplayTrace_ = ReplayTrace::load(pEcuScript->getReplayFile(), dest, source);
+    }
+    if (pEcuScript->hasResponsePending())
+    {
+        pResponsePending_ = make_shared<ResponsePending>(pEcuScript->getResponsePendingConfiguration(),
+                                                         [pTransport](const uint8_t* response, size_t length) {
+                                                             pTransport->sendData(response, length);
+                                                         });
+    }
 }
 
 /**
@@ -54,11 +134,20 @@ UdsReceiver::UdsReceiver(canid_t source,
 UdsReceiver::UdsReceiver(UdsReceiver&& orig) noexcept
 : IsoTpReceiver(move(orig))
 , pEcuScript_(move(orig.pEcuScript_))
-, pIsoTpSender_(orig.pIsoTpSender_)
+, pTransport_(orig.pTransport_)
 , pSessionCtrl_(orig.pSessionCtrl_)
-, securityAccessType_(orig.securityAccessType_)
+, responseBuffer_(move(orig.responseBuffer_))
+, rawRequest_(move(orig.rawRequest_))
+, pDispatcher_(move(orig.pDispatcher_))
+, pReplayTrace_(move(orig.pReplayTrace_))
+, pResponsePending_(move(orig.pResponsePending_))
+, pQueuedRequests_(move(orig.pQueuedRequests_))
+, maxQueuedRequests_(orig.maxQueuedRequests_)
+, pResponseDelay_(move(orig.pResponseDelay_))
+, pDelayedResponses_(move(orig.pDelayedResponses_))
+, pMetrics_(orig.pMetrics_)
 {
-    orig.pIsoTpSender_ = nullptr;
+    orig.pTransport_ = nullptr;
     orig.pSessionCtrl_ = nullptr;
 }
 
@@ -71,11 +160,21 @@ UdsReceiver::UdsReceiver(UdsReceiver&& orig) noexcept
 UdsReceiver& UdsReceiver::operator=(UdsReceiver&& orig) noexcept
 {
     assert(this != &orig);
+    IsoTpReceiver::operator=(move(orig));
     pEcuScript_ = move(orig.pEcuScript_);
-    pIsoTpSender_ = orig.pIsoTpSender_;
+    pTransport_ = orig.pTransport_;
     pSessionCtrl_ = orig.pSessionCtrl_;
-    securityAccessType_ = orig.securityAccessType_;
-    orig.pIsoTpSender_ = nullptr;
+    responseBuffer_ = move(orig.responseBuffer_);
+    rawRequest_ = move(orig.rawRequest_);
+    pDispatcher_ = move(orig.pDispatcher_);
+    pReplayTrace_ = move(orig.pReplayTrace_);
+    pResponsePending_ = move(orig.pResponsePending_);
+    pQueuedRequests_ = move(orig.pQueuedRequests_);
+    maxQueuedRequests_ = orig.maxQueuedRequests_;
+    pResponseDelay_ = move(orig.pResponseDelay_);
+    pDelayedResponses_ = move(orig.pDelayedResponses_);
+    pMetrics_ = orig.pMetrics_;
+    orig.pTransport_ = nullptr;
     orig.pSessionCtrl_ = nullptr;
     return *this;
 }
@@ -93,176 +192,251 @@ UdsReceiver& UdsReceiver::operator=(UdsReceiver&& orig) noexcept
 void UdsReceiver::proceedReceivedData(const uint8_t* buffer, const size_t num_bytes) noexcept
 {
     IsoTpReceiver::proceedReceivedData(buffer, num_bytes);
+    IdleMonitor::getInstance().notifyActivity();
 
     const uint8_t udsServiceIdentifier = buffer[0];
-    const optional<string> response = pEcuScript_->getRawResponse(requestByteTree, buffer, num_bytes);
+    // the positive responses of all sources (Raw, Lua and native) are suppressed alike
+    const bool isSuppressPosRsp = ::isSuppressPosRsp(buffer, num_bytes);
+    RequestTimer timer(pMetrics_, udsServiceIdentifier, getReceiveTime());
+    timer.dispatched(DispatchLane::HIGH);
+    // the tester is present, even if the response waits for the Lua worker
+    pSessionCtrl_->reset();
+    if (pReplayTrace_)
+    {
+        // the recorded responses take precedence over the script
+        const optional<ReplayTrace::Response> replayed = pReplayTrace_->match(buffer, num_bytes);
+        if (replayed)
+        {
+            timer.lookupFinished(false);
+            if (replayed->length > 0)
+            {
+                sendResponse(replayed->data, replayed->length, timer);
+            }
+            pSessionCtrl_->reset();
+            return;
+        }
+    }
+    if (!pSessionCtrl_->isServiceAllowed(udsServiceIdentifier))
+    {
+        const array<uint8_t, 3> nrc = {
+            ERROR,
+            udsServiceIdentifier,
+            SERVICE_NOT_SUPPORTED_IN_ACTIVE_SESSION
+        };
+        sendResponse(nrc.data(), nrc.size(), timer);
+        pSessionCtrl_->reset();
+        return;
+    }
+    bool isWildcard;
+    // kept until the response is sent, even if the script is reloaded meanwhile
+    const shared_ptr<const LuaRequestMatcher> pRequestMatcher =
+        pEcuScript_->getRawRequestMatcher(pSessionCtrl_->getCurrentUdsSession());
+    // a suppressed request is answered by the entry of its sub-function, the Lua functions get it unchanged
+    const RequestResponse *response = pRequestMatcher->match(clearSuppressPosRsp(buffer, num_bytes, rawRequest_),
+                                                             num_bytes, &isWildcard);
+    timer.lookupFinished(isWildcard);
 
     if (response)
     {
-        vector<unsigned char> raw = pEcuScript_->literalHexStrToBytes(*response);
-        cout << "UDS sending: " << dec << raw.size() << " bytes." << endl;
-        pIsoTpSender_->sendData(raw.data(), raw.size());
+        if (response->pCache && response->pCache->find(ResponseCache::toKey(buffer, num_bytes), responseBuffer_))
+        {
+            // answered by a `cached()` function before, no Lua access necessary
+            LOG_DEBUG("UDS sending: " << dec << responseBuffer_.size() << " bytes.");
+            sendResponse(responseBuffer_.data(), responseBuffer_.size(), timer, isSuppressPosRsp,
+                         response->pDelay.get());
+        }
+        else if (response->isLuaFunction())
+        {
+            // the session timer is reset again when the response is sent
+            proceedLuaResponseAsync(pRequestMatcher, *response, buffer, num_bytes, isSuppressPosRsp, timer);
+            return;
+        }
+        else
+        {
+            // precompiled static response (or the next one of a list), no Lua access necessary
+            const vector<uint8_t>& bytes = response->getBytes(pSessionCtrl_->getResetEpoch(),
+                                                              pSessionCtrl_->getSessionEpoch());
+            LOG_DEBUG("UDS sending: " << dec << bytes.size() << " bytes.");
+            sendResponse(bytes.data(), bytes.size(), timer, isSuppressPosRsp, response->pDelay.get());
+        }
         pSessionCtrl_->reset();
     }
-    else
+    else if (const ServiceDispatcher::Result result = pDispatcher_->proceedRequest(buffer, num_bytes,
+                                                                                   responseBuffer_, &timer);
+             result.route != ServiceDispatcher::Route::NONE)
     {
-        switch (udsServiceIdentifier)
+        // the 'Raw' table takes precedence over the tables and the native services
+        if (result.isResponse)
         {
-            case READ_DATA_BY_IDENTIFIER_REQ:
-            {
-                readDataByIdentifier(buffer, num_bytes);
-                pSessionCtrl_->reset();
-                break;
-            }
-            case DIAGNOSTIC_SESSION_CONTROL_REQ:
-                diagnosticSessionControl(buffer, num_bytes);
-                break;
-            case SECURITY_ACCESS_REQ:
-                //                securityAccess(buffer, num_bytes);
-                break;
-                // TODO: implement all other requests ...
-        default:
-            array<uint8_t, 3> resp = {
-                ERROR,
-                udsServiceIdentifier,
-                SERVICE_NOT_SUPPORTED
-            };
-            pIsoTpSender_->sendData(resp.data(), resp.size());
+            sendResponse(responseBuffer_.data(), responseBuffer_.size(), timer);
         }
+        pSessionCtrl_->reset();
+    }
+    else
+    {
+        array<uint8_t, 3> resp = {
+            ERROR,
+            udsServiceIdentifier,
+            SERVICE_NOT_SUPPORTED
+        };
+        sendResponse(resp.data(), resp.size(), timer);
     }
 }
 
 /**
- * Handles the UDS `readDataByIdentifier` request. The ISO-TP layer already
- * ensures the min. length of 3 bytes by filling up the request with zero bytes
- * if necessary.
+ * Counts the UDS requests and measures their latencies.
  *
- * @param buffer: the buffer containing the UDS message
- * @param num_bytes: the length of the message in bytes (min. 3 bytes)
+ * @param pMetrics: the metrics of the ECU
  */
-void UdsReceiver::readDataByIdentifier(const uint8_t* buffer, const size_t num_bytes) noexcept
+void UdsReceiver::setMetrics(EcuMetrics* pMetrics) noexcept
 {
-    assert(pSessionCtrl_ != nullptr);
-    assert(pIsoTpSender_ != nullptr);
+    pMetrics_ = pMetrics;
+}
 
-    const uint16_t dataIdentifier = (buffer[1] << 8) + buffer[2];
-    string data;
+/**
+ * @return true while a Lua function of a `ResponsePending` ECU proceeds a
+ *         request, i.e. its final response has not been sent yet
+ */
+bool UdsReceiver::isResponsePending() const
+{
+    return pResponsePending_ && pResponsePending_->isPending();
+}
 
-    if (pSessionCtrl_->getCurrentUdsSession() == UdsSession::PROGRAMMING)
-    {
-        data = pEcuScript_->getDataByIdentifier(EcuLuaScript::toByteResponse(dataIdentifier, sizeof(dataIdentifier)), "Programming");
-    }
-    else if (pSessionCtrl_->getCurrentUdsSession() == UdsSession::EXTENDED)
+/**
+ * Sends a response to the tester. With a response time (of the entry or the
+ * `ResponseDelay` of the ECU), the response is copied and sent by the timer
+ * wheel, so the receiver is not blocked meanwhile.
+ *
+ * @param response: the response
+ * @param length: the length of the response in bytes
+ * @param timer: measures the request, taken over by a delayed response
+ * @param isSuppressPosRsp: true if a positive response is dropped, see `isSuppressPosRsp()`
+ * @param pDelay: the response time of the `Raw` entry, `nullptr` for the one of the ECU
+ */
+void UdsReceiver::sendResponse(const uint8_t* response, size_t length, RequestTimer& timer,
+                               bool isSuppressPosRsp, const ResponseDelay* pDelay) noexcept
+{
+    if (isSuppressPosRsp && !isNegativeResponse(response, length))
     {
-        data = pEcuScript_->getDataByIdentifier(EcuLuaScript::toByteResponse(dataIdentifier, sizeof(dataIdentifier)), "Extended");
+        LOG_DEBUG("UDS positive response suppressed.");
+        return;
     }
-    else // default session
+    if (pDelay == nullptr)
     {
-        const string resp = EcuLuaScript::toByteResponse(dataIdentifier, sizeof(dataIdentifier));
-        data = pEcuScript_->getDataByIdentifier(resp);
+        pDelay = pResponseDelay_.get();
     }
-
-
-    if (!data.empty())
+    const chrono::milliseconds delay = pDelay ? pDelay->sample() : chrono::milliseconds::zero();
+    // also queued without a delay while earlier responses wait, to keep the order
+    if (pDelayedResponses_->send(response, length, timer, delay))
     {
-        // send positive response
-        vector<uint8_t> resp(data.length() + 3); // data + UDS header
-        resp = {
-            READ_DATA_BY_IDENTIFIER_RES,
-            buffer[1],
-            buffer[2]
-        };
-        resp.insert(resp.cend(), data.cbegin(), data.cend()); // insert payload
-        pIsoTpSender_->sendData(resp.data(), resp.size());
-    }
-    else
-    {
-        array<uint8_t, 3> nrc = {
-            ERROR,
-            0x22,
-            SERVICE_NOT_SUPPORTED
-        };
-        pIsoTpSender_->sendData(nrc.data(), nrc.size());
+        return;
     }
+    pTransport_->sendData(response, length);
+    timer.responseSent(response, length);
 }
 
 /**
- * Starts a session and sends back the corresponding response message.
+ * Answers a request with `7F SID 21` (busyRepeatRequest) without calling Lua,
+ * since the ECU is busy with other Lua requests.
  *
- * @param buffer: the buffer containing the UDS message
- * @param num_bytes: the length of the message in bytes
+ * @param sid: the SID of the request
+ * @param timer: measures the request
  */
-void UdsReceiver::diagnosticSessionControl(const uint8_t* buffer, const size_t num_bytes)
+void UdsReceiver::sendBusyRepeatRequest(uint8_t sid, RequestTimer& timer) noexcept
 {
-    assert(pSessionCtrl_ != nullptr);
-
-    const uint8_t sessionId = buffer[1];
-    switch (sessionId)
+    const array<uint8_t, 3> nrc = {
+        ERROR,
+        sid,
+        BUSY_REPEAT_REQUEST
+    };
+    sendResponse(nrc.data(), nrc.size(), timer);
+    if (pMetrics_)
     {
-        case 0x01: // UdsSession::DEFAULT
-            pSessionCtrl_->setCurrentUdsSession(UdsSession::DEFAULT);
-            break;
-        case 0x02: // UdsSession::PROGRAMMING
-            pSessionCtrl_->setCurrentUdsSession(UdsSession::PROGRAMMING);
-            pSessionCtrl_->start(SESSION_TIME);
-            break;
-        case 0x03: // UdsSession::EXTENDED
-            pSessionCtrl_->setCurrentUdsSession(UdsSession::EXTENDED);
-            pSessionCtrl_->start(SESSION_TIME);
-            break;
-        default:
-            cerr << "Invalid session ID!\n";
-            break;
+        pMetrics_->overloadResponses.fetch_add(1, memory_order_relaxed);
     }
-
-    const array<uint8_t, 2> resp = {
-        DIAGNOSTIC_SESSION_CONTROL_RES,
-        sessionId
-    };
-    pIsoTpSender_->sendData(resp.data(), resp.size());
 }
 
 /**
+ * Proceeds a Lua response on the low priority lane of the Lua worker, so the
+ * receiver does not wait for it and answers e.g. `TesterPresent` and
+ * `DiagnosticSessionControl` meanwhile. The response is sent by the worker.
+ *
+ * With a `ResponsePending` table, `7F SID 78` is sent until the final response
+ * if the function takes longer than P2. Another Lua request received meanwhile
+ * is answered with `7F SID 21` (busyRepeatRequest). Without, the Lua requests
+ * are queued and answered in order. If `MaxQueuedRequests` are queued already,
+ * further ones are answered with `7F SID 21` right away instead of waiting in
+ * the queue until the tester times out.
  *
+ * @param pRequestMatcher: the matcher of the response
+ * @param response: the matched table entry, must be a Lua function
  * @param buffer: the buffer containing the UDS message
  * @param num_bytes: the length of the message in bytes
+ * @param isSuppressPosRsp: true if only a negative response of the function is sent
+ * @param timer: measures the request, taken over if the request is proceeded
  */
-void UdsReceiver::securityAccess(const uint8_t* buffer, const size_t num_bytes) noexcept
+void UdsReceiver::proceedLuaResponseAsync(const shared_ptr<const LuaRequestMatcher>& pRequestMatcher,
+                                          const RequestResponse& response, const uint8_t* buffer,
+                                          const size_t num_bytes, bool isSuppressPosRsp, RequestTimer& timer) noexcept
 {
-    const uint8_t seedId = buffer[1];
-    const string seed = pEcuScript_->getSeed(seedId);
-    if (!seed.empty())
+    SessionController* pSessionCtrl = pSessionCtrl_;
+    if (!pResponsePending_)
     {
-        // send seed
-        vector<uint8_t> resp(seed.length() + 2); // data + UDS header
-        resp = {
-            SECURITY_ACCESS_REQ,
-            seedId
-        };
-        resp.insert(resp.cend(), seed.cbegin(), seed.cend() - 1); // insert payload - nullbyte
-        pIsoTpSender_->sendData(resp.data(), resp.size());
-        securityAccessType_ = seedId + 0x01;
-    }
-    else
-    {
-        if (securityAccessType_ == seedId)
+        shared_ptr<atomic<uint32_t>> pQueuedRequests = pQueuedRequests_;
+        if (pQueuedRequests->fetch_add(1, memory_order_relaxed) >= maxQueuedRequests_)
         {
-            // second request
-            constexpr array<uint8_t, 1> resp = {SECURITY_ACCESS_RES};
-            // Lua seed function
-            pIsoTpSender_->sendData(resp.data(), resp.size());
-            securityAccessType_ = 0x00;
+            pQueuedRequests->fetch_sub(1, memory_order_relaxed);
+            sendBusyRepeatRequest(buffer[0], timer);
+            pSessionCtrl->reset();
+            return;
         }
-        else
+        // the receiver may be moved meanwhile, the transport and the session controller stay
+        struct LuaRequest
         {
-            array<uint8_t, 3> resp = {
-                ERROR,
-                0x27,
-                SERVICE_NOT_SUPPORTED
-            };
-            pIsoTpSender_->sendData(resp.data(), resp.size());
-        }
+            explicit LuaRequest(RequestTimer&& timer) : timer(move(timer)) {}
+
+            RequestTimer timer;
+            vector<uint8_t> response;
+        };
+        auto pRequest = make_shared<LuaRequest>(move(timer));
+        UdsTransport* pTransport = pTransport_;
+        pEcuScript_->postLuaResponse(pRequestMatcher, response, buffer, uint32_t(num_bytes), pRequest->response,
+            [pRequest, pTransport, pSessionCtrl, pQueuedRequests, isSuppressPosRsp]()
+            {
+                pQueuedRequests->fetch_sub(1, memory_order_relaxed);
+                pRequest->timer.luaFinished();
+                // the function still runs for its side effects, only its positive response is dropped
+                if (!pRequest->response.empty() && (!isSuppressPosRsp
+                    || isNegativeResponse(pRequest->response.data(), pRequest->response.size())))
+                {
+                    LOG_DEBUG("UDS sending: " << dec << pRequest->response.size() << " bytes.");
+                    pTransport->sendData(pRequest->response.data(), pRequest->response.size());
+                    pRequest->timer.responseSent(pRequest->response.data(), pRequest->response.size());
+                }
+                pSessionCtrl->reset();
+            },
+            [pRequest]()
+            {
+                pRequest->timer.dispatched(DispatchLane::LOW);
+                pRequest->timer.luaStarted();
+            });
+        return;
+    }
+    if (!pResponsePending_->start(buffer[0], timer))
+    {
+        sendBusyRepeatRequest(buffer[0], timer);
+        pSessionCtrl->reset();
+        return;
     }
+    shared_ptr<ResponsePending> pResponsePending = pResponsePending_;
+    pEcuScript_->postLuaResponse(pRequestMatcher, response, buffer, uint32_t(num_bytes),
+                                 pResponsePending->getResponseBuffer(),
+                                 [pResponsePending, pSessionCtrl, isSuppressPosRsp]()
+                                 {
+                                     pResponsePending->finish(isSuppressPosRsp);
+                                     pSessionCtrl->reset();
+                                 },
+                                 [pResponsePending]() { pResponsePending->dispatched(DispatchLane::LOW); });
 }
 
 /**
@@ -272,7 +446,7 @@ void UdsReceiver::securityAccess(const uint8_t* buffer, const size_t num_bytes)
  */
 uint16_t UdsReceiver::generateSeed()
 {
-    default_random_engine gen(RANDOM_DEVICE());
-    uniform_int_distribution<uint16_t> dist(0, numeric_limits<uint16_t>::max());
-    return dist(gen);
+    // seeded once per thread, not per seed
+    thread_local SeedGenerator generator;
+    return uint16_t(generator.next());
 }
@@ -8,9 +8,19 @@
 
 #include "isotp_receiver.h"
 #include "isotp_sender.h"
+#include "uds_transport.h"
 #include "ecu_lua_script.h"
 #include "session_controller.h"
+#include "metrics.h"
+#include "service_dispatcher.h"
+#include "response_pending.h"
+#include "replay_trace.h"
+#include "response_delay.h"
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
 class UdsReceiver : public IsoTpReceiver
 {
@@ -22,27 +32,58 @@ public:
                 canid_t dest,
                 const std::string& device,
                 EcuLuaScript *pEcuScript,
-                IsoTpSender* pSender,
+                UdsTransport* pTransport,
                 SessionController* pSesCtrl);
-    UdsReceiver(const UdsReceiver& orig) = default;
-    UdsReceiver& operator =(const UdsReceiver& orig) = default;
+    UdsReceiver(canid_t source,
+                canid_t dest,
+                EcuLuaScript *pEcuScript,
+                UdsTransport* pTransport,
+                SessionController* pSesCtrl);
+    UdsReceiver(const UdsReceiver& orig) = delete;
+    UdsReceiver& operator =(const UdsReceiver& orig) = delete;
     UdsReceiver(UdsReceiver&& orig) noexcept;
     UdsReceiver& operator =(UdsReceiver&& orig) noexcept;
     virtual ~UdsReceiver() = default;
 
     static std::uint16_t generateSeed();
     virtual void proceedReceivedData(const uint8_t* buffer, const size_t num_bytes) noexcept override;
+    void setMetrics(EcuMetrics* pMetrics) noexcept;
+    bool isResponsePending() const;
 
 private:
     EcuLuaScript *pEcuScript_;
-    IsoTpSender* pIsoTpSender_ = nullptr;
+    UdsTransport* pTransport_ = nullptr; ///< the `IsoTpSender` or the `LoopbackTransport` of the ECU
     SessionController* pSessionCtrl_ = nullptr;
-    std::uint8_t securityAccessType_ = 0x00;
-    shared_ptr<RequestByteTreeNode<shared_ptr<Selector>>> requestByteTree;
+    /**
+     * The response arena of the ECU: reserved for `MAX_UDS_MSG_SIZE` bytes
+     * once and reused by every transaction, so assembling a response does not
+     * allocate. Larger responses (see `IsoTpConfiguration::maxMessageSize`)
+     * grow it once. Static `Raw` responses are sent from the compiled table
+     * directly.
+     */
+    std::vector<std::uint8_t> responseBuffer_;
+    std::vector<std::uint8_t> rawRequest_; ///< a suppressed request without the bit, see `clearSuppressPosRsp()`
+    /// the services behind the 'Raw' table, shared with the DoIP front-end
+    std::unique_ptr<ServiceDispatcher> pDispatcher_;
+    std::shared_ptr<const ReplayTrace> pReplayTrace_; ///< `nullptr` if the ECU has no `Replay` trace
+    /// `nullptr` if the ECU has no `ResponsePending` table, shared with the Lua worker proceeding a request
+    std::shared_ptr<ResponsePending> pResponsePending_;
+    /// the Lua requests queued on the Lua worker, shared with their tasks
+    std::shared_ptr<std::atomic<std::uint32_t>> pQueuedRequests_ = std::make_shared<std::atomic<std::uint32_t>>(0);
+    std::uint32_t maxQueuedRequests_ = DEFAULT_MAX_QUEUED_REQUESTS;
+    /// the `ResponseDelay` of the ECU, `nullptr` if it answers right away
+    std::shared_ptr<const ResponseDelay> pResponseDelay_;
+    /// sends the responses with a response time, see `sendResponse()`
+    std::unique_ptr<DelayedResponses> pDelayedResponses_;
+    EcuMetrics* pMetrics_ = nullptr;
 
-    void readDataByIdentifier(const std::uint8_t* buffer, const std::size_t num_bytes) noexcept;
-    void diagnosticSessionControl(const std::uint8_t* buffer, const std::size_t num_bytes);
-    void securityAccess(const std::uint8_t* buffer, const std::size_t num_bytes) noexcept;
+    void initialize(canid_t source, canid_t dest, const std::string& device);
+    void sendResponse(const std::uint8_t* response, std::size_t length, RequestTimer& timer,
+                      bool isSuppressPosRsp = false, const ResponseDelay* pDelay = nullptr) noexcept;
+    void sendBusyRepeatRequest(std::uint8_t sid, RequestTimer& timer) noexcept;
+    void proceedLuaResponseAsync(const std::shared_ptr<const LuaRequestMatcher>& pRequestMatcher,
+                                 const RequestResponse& response, const std::uint8_t* buffer,
+                                 const std::size_t num_bytes, bool isSuppressPosRsp, RequestTimer& timer) noexcept;
 
 };
 
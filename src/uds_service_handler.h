@@ -0,0 +1,34 @@
+/**
+ * @file uds_service_handler.h
+ *
+ */
+
+#ifndef UDS_SERVICE_HANDLER_H
+#define UDS_SERVICE_HANDLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Interface of a natively implemented UDS service. Every handler keeps its
+ * own state, one instance exists per simulated ECU.
+ */
+class UdsServiceHandler
+{
+public:
+    virtual ~UdsServiceHandler() = default;
+
+    /**
+     * @param request: the UDS request, starting with the SID
+     * @param length: the length of the request in bytes (min. 1 byte)
+     * @param response: replaced by the positive or negative response
+     */
+    virtual void proceedRequest(const std::uint8_t* request, std::size_t length,
+                                std::vector<std::uint8_t>& response) = 0;
+
+    /// true if the second byte of a request is a sub-function (with the suppressPosRspMsgIndicationBit)
+    virtual bool hasSubFunction(std::uint8_t sid) const noexcept = 0;
+};
+
+#endif /* UDS_SERVICE_HANDLER_H */
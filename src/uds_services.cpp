@@ -0,0 +1,429 @@
+/**
+ * @file uds_services.cpp
+ *
+ * The natively implemented UDS services, served without a Lua call.
+ */
+
+#include "uds_services.h"
+#include "service_identifier.h"
+#include "logger.h"
+
+using namespace std;
+
+static constexpr uint8_t HARD_RESET = 0x01;
+static constexpr uint8_t KEY_OFF_ON_RESET = 0x02;
+static constexpr uint8_t SOFT_RESET = 0x03;
+
+static constexpr uint8_t REPORT_NUMBER_OF_DTC_BY_STATUS_MASK = 0x01;
+static constexpr uint8_t REPORT_DTC_BY_STATUS_MASK = 0x02;
+static constexpr uint8_t REPORT_DTC_SNAPSHOT_RECORD_BY_DTC_NUMBER = 0x04;
+static constexpr uint8_t REPORT_DTC_EXT_DATA_RECORD_BY_DTC_NUMBER = 0x06;
+static constexpr uint8_t REPORT_SUPPORTED_DTC = 0x0A;
+static constexpr uint8_t DTC_FORMAT_ISO_14229_1 = 0x01;
+
+static constexpr uint8_t DTC_SETTING_ON = 0x01;
+static constexpr uint8_t DTC_SETTING_OFF = 0x02;
+
+static constexpr uint8_t START_ROUTINE = 0x01;
+static constexpr uint8_t STOP_ROUTINE = 0x02;
+static constexpr uint8_t REQUEST_ROUTINE_RESULTS = 0x03;
+
+static void setNegativeResponse(vector<uint8_t>& response, uint8_t sid, uint8_t nrc)
+{
+    response.assign({ERROR, sid, nrc});
+}
+
+static uint32_t readDtc(const uint8_t* data) noexcept
+{
+    return (uint32_t(data[0]) << 16) | (uint32_t(data[1]) << 8) | data[2];
+}
+
+/**
+ * @return the handler of every SID, `NO_SERVICE` if it is not implemented natively
+ */
+static constexpr array<uint8_t, 256> makeServiceSlots() noexcept
+{
+    array<uint8_t, 256> slots{};
+    slots[ECU_RESET_REQ] = UdsServices::ECU_RESET_SLOT;
+    slots[CLEAR_DIAGNOSTIC_INFORMATION_REQ] = UdsServices::DTC_SLOT;
+    slots[READ_DTC_INFORMATION_REQ] = UdsServices::DTC_SLOT;
+    slots[CONTROL_DTC_SETTINGS_REQ] = UdsServices::DTC_SLOT;
+    slots[WRITE_DATA_BY_IDENTIFIER_REQ] = UdsServices::WRITE_DATA_SLOT;
+    slots[ROUTINE_CONTROL_REQ] = UdsServices::ROUTINE_CONTROL_SLOT;
+    slots[COMMUNICATION_CONTROL_REQ] = UdsServices::COMMUNICATION_CONTROL_SLOT;
+    slots[SECURITY_ACCESS_REQ] = UdsServices::SECURITY_ACCESS_SLOT;
+    return slots;
+}
+
+/// the dispatch table, indexed by the SID
+static constexpr array<uint8_t, 256> SERVICE_SLOTS = makeServiceSlots();
+
+/**
+ * @param pSessionCtrl: switched to the default session by `ECUReset`, might be `nullptr`
+ */
+EcuResetService::EcuResetService(SessionController* pSessionCtrl) noexcept
+: pSessionCtrl_(pSessionCtrl)
+{
+}
+
+/**
+ * `11 resetType`, answered with `51 resetType`.
+ */
+void EcuResetService::proceedRequest(const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    if (length != 2)
+    {
+        setNegativeResponse(response, ECU_RESET_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+    const uint8_t resetType = request[1] & ~SUPPRESS_POS_RSP_MSG_INDICATION_BIT;
+    if (resetType != HARD_RESET && resetType != KEY_OFF_ON_RESET && resetType != SOFT_RESET)
+    {
+        setNegativeResponse(response, ECU_RESET_REQ, SUBFUNCTION_NOT_SUPPORTED);
+        return;
+    }
+
+    if (pSessionCtrl_ != nullptr)
+    {
+        pSessionCtrl_->stop();
+        pSessionCtrl_->setCurrentUdsSession(UdsSession::DEFAULT);
+        pSessionCtrl_->countEcuReset();
+    }
+    ++resetCount_;
+    lastResetType_ = resetType;
+    LOG_INFO("ECUReset 0x" << hex << unsigned(resetType));
+    if (resetListener_)
+    {
+        resetListener_(resetType);
+    }
+    response.assign({ECU_RESET_RES, resetType});
+}
+
+/**
+ * Sets the function called on every accepted reset, before the response is
+ * sent. It is called with the mutex of the `UdsServices` locked, so it must
+ * not block.
+ *
+ * @param listener: the function to call or `nullptr`
+ */
+void EcuResetService::setResetListener(function<void(uint8_t resetType)> listener)
+{
+    resetListener_ = move(listener);
+}
+
+/**
+ * @param pStore: the fault memory of the ECU
+ */
+DtcService::DtcService(shared_ptr<DtcStore> pStore) noexcept
+: pStore_(move(pStore))
+{
+}
+
+/**
+ * @param sid: 0x14, 0x19 or 0x85
+ * @return true, except for `ClearDiagnosticInformation`
+ */
+bool DtcService::hasSubFunction(uint8_t sid) const noexcept
+{
+    return sid != CLEAR_DIAGNOSTIC_INFORMATION_REQ;
+}
+
+void DtcService::proceedRequest(const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    switch (request[0])
+    {
+        case CLEAR_DIAGNOSTIC_INFORMATION_REQ:
+            clearDiagnosticInformation(request, length, response);
+            break;
+        case READ_DTC_INFORMATION_REQ:
+            readDtcInformation(request, length, response);
+            break;
+        case CONTROL_DTC_SETTINGS_REQ:
+            controlDtcSetting(request, length, response);
+            break;
+        default:
+            setNegativeResponse(response, request[0], SERVICE_NOT_SUPPORTED);
+            break;
+    }
+}
+
+/**
+ * `14 groupOfDTC`, answered with `54`. The group 0xFFFFFF clears all DTCs.
+ */
+void DtcService::clearDiagnosticInformation(const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    if (length != 4)
+    {
+        setNegativeResponse(response, CLEAR_DIAGNOSTIC_INFORMATION_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+    if (!pStore_->clearDtc(readDtc(request + 1)))
+    {
+        setNegativeResponse(response, CLEAR_DIAGNOSTIC_INFORMATION_REQ, REQUEST_OUT_OF_RANGE);
+        return;
+    }
+    response.assign({CLEAR_DIAGNOSTIC_INFORMATION_RES});
+}
+
+/**
+ * `19 01 statusMask`, `19 02 statusMask`, `19 04 DTC recordNumber`,
+ * `19 06 DTC recordNumber` and `19 0A`.
+ */
+void DtcService::readDtcInformation(const uint8_t* request, size_t length, vector<uint8_t>& response) const
+{
+    if (length < 2)
+    {
+        setNegativeResponse(response, READ_DTC_INFORMATION_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+    const uint8_t reportType = request[1] & ~SUPPRESS_POS_RSP_MSG_INDICATION_BIT;
+    size_t expectedLength;
+    switch (reportType)
+    {
+        case REPORT_NUMBER_OF_DTC_BY_STATUS_MASK:
+        case REPORT_DTC_BY_STATUS_MASK:
+            expectedLength = 3;
+            break;
+        case REPORT_DTC_SNAPSHOT_RECORD_BY_DTC_NUMBER:
+        case REPORT_DTC_EXT_DATA_RECORD_BY_DTC_NUMBER:
+            expectedLength = 6;
+            break;
+        case REPORT_SUPPORTED_DTC:
+            expectedLength = 2;
+            break;
+        default:
+            setNegativeResponse(response, READ_DTC_INFORMATION_REQ, SUBFUNCTION_NOT_SUPPORTED);
+            return;
+    }
+    if (length != expectedLength)
+    {
+        setNegativeResponse(response, READ_DTC_INFORMATION_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+
+    response.assign({READ_DTC_INFORMATION_RES, reportType});
+    switch (reportType)
+    {
+        case REPORT_NUMBER_OF_DTC_BY_STATUS_MASK:
+        {
+            const size_t count = pStore_->countByStatusMask(request[2]);
+            response.push_back(DtcStore::STATUS_AVAILABILITY_MASK);
+            response.push_back(DTC_FORMAT_ISO_14229_1);
+            response.push_back(uint8_t(count >> 8));
+            response.push_back(uint8_t(count));
+            break;
+        }
+        case REPORT_DTC_BY_STATUS_MASK:
+            response.push_back(DtcStore::STATUS_AVAILABILITY_MASK);
+            pStore_->appendByStatusMask(request[2], response);
+            break;
+        case REPORT_DTC_SNAPSHOT_RECORD_BY_DTC_NUMBER:
+            if (!pStore_->appendSnapshotRecords(readDtc(request + 2), request[5], response))
+            {
+                setNegativeResponse(response, READ_DTC_INFORMATION_REQ, REQUEST_OUT_OF_RANGE);
+            }
+            break;
+        case REPORT_DTC_EXT_DATA_RECORD_BY_DTC_NUMBER:
+            if (!pStore_->appendExtendedDataRecords(readDtc(request + 2), request[5], response))
+            {
+                setNegativeResponse(response, READ_DTC_INFORMATION_REQ, REQUEST_OUT_OF_RANGE);
+            }
+            break;
+        case REPORT_SUPPORTED_DTC:
+            response.push_back(DtcStore::STATUS_AVAILABILITY_MASK);
+            pStore_->appendAll(response);
+            break;
+    }
+}
+
+/**
+ * `85 DTCSettingType`, answered with `C5 DTCSettingType`.
+ */
+void DtcService::controlDtcSetting(const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    if (length < 2)
+    {
+        setNegativeResponse(response, CONTROL_DTC_SETTINGS_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+    const uint8_t settingType = request[1] & ~SUPPRESS_POS_RSP_MSG_INDICATION_BIT;
+    if (settingType != DTC_SETTING_ON && settingType != DTC_SETTING_OFF)
+    {
+        setNegativeResponse(response, CONTROL_DTC_SETTINGS_REQ, SUBFUNCTION_NOT_SUPPORTED);
+        return;
+    }
+    pStore_->setSettingOn(settingType == DTC_SETTING_ON);
+    response.assign({CONTROL_DTC_SETTINGS_RES, settingType});
+}
+
+WriteDataService::WriteDataService(shared_ptr<DidStore> pStore, SessionController* pSessionCtrl) noexcept
+: pStore_(move(pStore))
+, pSessionCtrl_(pSessionCtrl)
+{
+}
+
+/**
+ * `2E dataIdentifier dataRecord`, answered with `6E dataIdentifier`.
+ */
+void WriteDataService::proceedRequest(const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    if (length < 4)
+    {
+        setNegativeResponse(response, WRITE_DATA_BY_IDENTIFIER_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+    const uint16_t identifier = uint16_t((request[1] << 8) | request[2]);
+    const uint8_t session = pSessionCtrl_ != nullptr ? pSessionCtrl_->getCurrentUdsSession() : UdsSession::DEFAULT;
+    pStore_->write(session, identifier, request + 3, length - 3);
+    response.assign({WRITE_DATA_BY_IDENTIFIER_RES, request[1], request[2]});
+}
+
+/**
+ * `31 routineControlType routineIdentifier`, answered with
+ * `71 routineControlType routineIdentifier`.
+ */
+void RoutineControlService::proceedRequest(const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    if (length < 4)
+    {
+        setNegativeResponse(response, ROUTINE_CONTROL_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+    const uint8_t controlType = request[1] & ~SUPPRESS_POS_RSP_MSG_INDICATION_BIT;
+    const uint16_t identifier = uint16_t((request[2] << 8) | request[3]);
+    switch (controlType)
+    {
+        case START_ROUTINE:
+            routines_[identifier] = true;
+            break;
+        case STOP_ROUTINE:
+        {
+            auto it = routines_.find(identifier);
+            if (it == routines_.end() || !it->second)
+            {
+                setNegativeResponse(response, ROUTINE_CONTROL_REQ, REQUEST_SEQUENCE_ERROR);
+                return;
+            }
+            it->second = false;
+            break;
+        }
+        case REQUEST_ROUTINE_RESULTS:
+            if (routines_.find(identifier) == routines_.end())
+            {
+                setNegativeResponse(response, ROUTINE_CONTROL_REQ, REQUEST_SEQUENCE_ERROR);
+                return;
+            }
+            break;
+        default:
+            setNegativeResponse(response, ROUTINE_CONTROL_REQ, SUBFUNCTION_NOT_SUPPORTED);
+            return;
+    }
+    response.assign({ROUTINE_CONTROL_RES, controlType, request[2], request[3]});
+}
+
+/**
+ * @param identifier: the routine identifier
+ * @return true if the routine is started and not stopped yet
+ */
+bool RoutineControlService::isRunning(uint16_t identifier) const noexcept
+{
+    auto it = routines_.find(identifier);
+    return it != routines_.end() && it->second;
+}
+
+/**
+ * Constructor.
+ *
+ * @param pGate: the communication state of the ECU, shared with its simulations
+ */
+CommunicationControlService::CommunicationControlService(shared_ptr<CommunicationGate> pGate) noexcept
+: pGate_(move(pGate))
+{
+}
+
+/**
+ * `28 controlType communicationType`, answered with `68 controlType`.
+ */
+void CommunicationControlService::proceedRequest(const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    if (length != 3)
+    {
+        setNegativeResponse(response, COMMUNICATION_CONTROL_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT);
+        return;
+    }
+    const uint8_t controlType = request[1] & ~SUPPRESS_POS_RSP_MSG_INDICATION_BIT;
+    if (!pGate_->setControl(controlType, request[2]))
+    {
+        setNegativeResponse(response, COMMUNICATION_CONTROL_REQ, SUBFUNCTION_NOT_SUPPORTED);
+        return;
+    }
+    response.assign({COMMUNICATION_CONTROL_RES, controlType});
+}
+
+/**
+ * Enables the communication again, e.g. after an `ECUReset`.
+ */
+void CommunicationControlService::reset()
+{
+    pGate_->reset();
+}
+
+/**
+ * @param sid: the UDS service identifier of a request
+ * @return true if the request is handled by `UdsServices::proceedRequest()`
+ */
+bool UdsServices::isNativeService(uint8_t sid) noexcept
+{
+    return SERVICE_SLOTS[sid] != NO_SERVICE;
+}
+
+/**
+ * Constructor.
+ *
+ * @param pSessionCtrl: the session of the ECU, might be `nullptr`
+ * @param pDtcStore: the fault memory of the ECU
+ * @param pDidStore: the values written by `WriteDataByIdentifier`
+ * @param pGate: the communication state of the ECU
+ */
+UdsServices::UdsServices(SessionController* pSessionCtrl, shared_ptr<DtcStore> pDtcStore,
+                         shared_ptr<DidStore> pDidStore, shared_ptr<CommunicationGate> pGate)
+: ecuReset_(pSessionCtrl)
+, dtc_(move(pDtcStore))
+, writeData_(move(pDidStore), pSessionCtrl)
+, communicationControl_(move(pGate))
+, securityAccess_(pSessionCtrl)
+, handlers_({nullptr, &ecuReset_, &dtc_, &writeData_, &routineControl_, &communicationControl_, &securityAccess_})
+{
+}
+
+/**
+ * Handles a request of a native service, see `isNativeService()`.
+ *
+ * @param request: the UDS request
+ * @param length: the length of the request in bytes (min. 1 byte)
+ * @param response: replaced by the positive or negative response
+ * @return false if the positive response is suppressed, i.e. nothing is sent
+ */
+bool UdsServices::proceedRequest(const uint8_t* request, size_t length, vector<uint8_t>& response)
+{
+    const uint8_t slot = SERVICE_SLOTS[request[0]];
+    if (slot == NO_SERVICE)
+    {
+        setNegativeResponse(response, request[0], SERVICE_NOT_SUPPORTED);
+        return true;
+    }
+
+    UdsServiceHandler* pHandler = handlers_[slot];
+    lock_guard<mutex> lock(mutex_);
+    pHandler->proceedRequest(request, length, response);
+    const bool isPositive = !response.empty() && response[0] != ERROR;
+    if (isPositive && slot == ECU_RESET_SLOT)
+    {
+        // a reset ECU starts locked, with the default communication and DTC setting
+        communicationControl_.reset();
+        dtc_.getStore().setSettingOn(true);
+        securityAccess_.lock();
+    }
+    return !(isPositive && length >= 2 && pHandler->hasSubFunction(request[0])
+             && (request[1] & SUPPRESS_POS_RSP_MSG_INDICATION_BIT) != 0);
+}
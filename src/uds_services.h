@@ -0,0 +1,195 @@
+/**
+ * @file uds_services.h
+ *
+ */
+
+#ifndef UDS_SERVICES_H
+#define UDS_SERVICES_H
+
+#include "uds_service_handler.h"
+#include "security_access.h"
+#include "session_controller.h"
+#include "did_store.h"
+#include "dtc_store.h"
+#include "communication_gate.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * `ECUReset` (0x11). A hard, key off/on or soft reset returns to the default
+ * session and calls the reset listener, which restores the state of the ECU
+ * after loading (see `EcuLuaScript::resetState()`).
+ */
+class EcuResetService : public UdsServiceHandler
+{
+public:
+    explicit EcuResetService(SessionController* pSessionCtrl) noexcept;
+
+    void proceedRequest(const std::uint8_t* request, std::size_t length,
+                        std::vector<std::uint8_t>& response) override;
+    bool hasSubFunction(std::uint8_t sid) const noexcept override { return true; }
+
+    std::size_t getResetCount() const noexcept { return resetCount_; }
+    std::uint8_t getLastResetType() const noexcept { return lastResetType_; }
+    void setResetListener(std::function<void(std::uint8_t resetType)> listener);
+
+private:
+    SessionController* pSessionCtrl_; ///< might be `nullptr`, e.g. for DoIP
+    std::function<void(std::uint8_t resetType)> resetListener_;
+    std::size_t resetCount_ = 0;
+    std::uint8_t lastResetType_ = 0x00;
+};
+
+/**
+ * `ClearDiagnosticInformation` (0x14), the report types 0x01, 0x02, 0x04,
+ * 0x06 and 0x0A of `ReadDTCInformation` (0x19) and `ControlDTCSetting` (0x85)
+ * on the fault memory of the ECU.
+ */
+class DtcService : public UdsServiceHandler
+{
+public:
+    explicit DtcService(std::shared_ptr<DtcStore> pStore) noexcept;
+
+    void proceedRequest(const std::uint8_t* request, std::size_t length,
+                        std::vector<std::uint8_t>& response) override;
+    bool hasSubFunction(std::uint8_t sid) const noexcept override;
+
+    DtcStore& getStore() noexcept { return *pStore_; }
+
+private:
+    std::shared_ptr<DtcStore> pStore_;
+
+    void clearDiagnosticInformation(const std::uint8_t* request, std::size_t length,
+                                    std::vector<std::uint8_t>& response);
+    void readDtcInformation(const std::uint8_t* request, std::size_t length,
+                            std::vector<std::uint8_t>& response) const;
+    void controlDtcSetting(const std::uint8_t* request, std::size_t length,
+                           std::vector<std::uint8_t>& response);
+};
+
+/**
+ * `WriteDataByIdentifier` (0x2E). The written values are kept in the DID store
+ * of the ECU per session, so `ReadDataByIdentifier` returns them.
+ */
+class WriteDataService : public UdsServiceHandler
+{
+public:
+    WriteDataService(std::shared_ptr<DidStore> pStore, SessionController* pSessionCtrl) noexcept;
+
+    void proceedRequest(const std::uint8_t* request, std::size_t length,
+                        std::vector<std::uint8_t>& response) override;
+    bool hasSubFunction(std::uint8_t sid) const noexcept override { return false; }
+
+    DidStore& getStore() noexcept { return *pStore_; }
+
+private:
+    std::shared_ptr<DidStore> pStore_;
+    SessionController* pSessionCtrl_; ///< might be `nullptr`, i.e. the default session, e.g. for DoIP
+};
+
+/**
+ * `RoutineControl` (0x31). Any routine identifier can be started, a routine
+ * has to be started before it can be stopped or its results be requested.
+ */
+class RoutineControlService : public UdsServiceHandler
+{
+public:
+    void proceedRequest(const std::uint8_t* request, std::size_t length,
+                        std::vector<std::uint8_t>& response) override;
+    bool hasSubFunction(std::uint8_t sid) const noexcept override { return true; }
+
+    bool isRunning(std::uint16_t identifier) const noexcept;
+
+private:
+    std::map<std::uint16_t, bool> routines_; ///< the started routines, true while running
+};
+
+/**
+ * `CommunicationControl` (0x28), the control types 0x00 - 0x03 on the
+ * `CommunicationGate` of the ECU, which stops its cyclic traffic.
+ */
+class CommunicationControlService : public UdsServiceHandler
+{
+public:
+    static constexpr std::uint8_t ENABLE_RX_AND_TX = CommunicationGate::ENABLE_RX_AND_TX;
+
+    explicit CommunicationControlService(std::shared_ptr<CommunicationGate> pGate) noexcept;
+
+    void proceedRequest(const std::uint8_t* request, std::size_t length,
+                        std::vector<std::uint8_t>& response) override;
+    bool hasSubFunction(std::uint8_t sid) const noexcept override { return true; }
+
+    std::uint8_t getControlType() const noexcept { return pGate_->getControlType(); }
+    std::uint8_t getCommunicationType() const noexcept { return pGate_->getCommunicationType(); }
+    CommunicationGate& getGate() noexcept { return *pGate_; }
+    void reset();
+
+private:
+    std::shared_ptr<CommunicationGate> pGate_;
+};
+
+/**
+ * The natively implemented UDS services of one ECU. The handler of a request
+ * is found by a table of all 256 SIDs built at compile time, so serving these
+ * services needs neither a `switch` nor the Lua VM. Requests are only passed
+ * here if the `Raw` table has no matching entry, so Lua still overrides every
+ * service.
+ *
+ * To add a service, derive a handler from `UdsServiceHandler`, add it as
+ * member and assign its `Slot` to the SIDs in `makeServiceSlots()`.
+ */
+class UdsServices
+{
+public:
+    /// the index of a handler in the dispatch table
+    enum Slot : std::uint8_t
+    {
+        NO_SERVICE = 0,
+        ECU_RESET_SLOT,
+        DTC_SLOT,
+        WRITE_DATA_SLOT,
+        ROUTINE_CONTROL_SLOT,
+        COMMUNICATION_CONTROL_SLOT,
+        SECURITY_ACCESS_SLOT,
+        SLOT_COUNT
+    };
+
+    static bool isNativeService(std::uint8_t sid) noexcept;
+
+    explicit UdsServices(SessionController* pSessionCtrl,
+                         std::shared_ptr<DtcStore> pDtcStore = std::make_shared<DtcStore>(),
+                         std::shared_ptr<DidStore> pDidStore = std::make_shared<DidStore>(),
+                         std::shared_ptr<CommunicationGate> pGate = std::make_shared<CommunicationGate>());
+    UdsServices(const UdsServices& orig) = delete;
+    UdsServices& operator =(const UdsServices& orig) = delete;
+    virtual ~UdsServices() = default;
+
+    bool proceedRequest(const std::uint8_t* request, std::size_t length, std::vector<std::uint8_t>& response);
+
+    /// use the handlers only while no request is proceeded, see `getMutex()`
+    EcuResetService& getEcuResetService() noexcept { return ecuReset_; }
+    DtcService& getDtcService() noexcept { return dtc_; }
+    WriteDataService& getWriteDataService() noexcept { return writeData_; }
+    RoutineControlService& getRoutineControlService() noexcept { return routineControl_; }
+    CommunicationControlService& getCommunicationControlService() noexcept { return communicationControl_; }
+    SecurityAccessService& getSecurityAccessService() noexcept { return securityAccess_; }
+    std::mutex& getMutex() noexcept { return mutex_; }
+
+private:
+    std::mutex mutex_;
+    EcuResetService ecuReset_;
+    DtcService dtc_;
+    WriteDataService writeData_;
+    RoutineControlService routineControl_;
+    CommunicationControlService communicationControl_;
+    SecurityAccessService securityAccess_;
+    const std::array<UdsServiceHandler*, SLOT_COUNT> handlers_;
+};
+
+#endif /* UDS_SERVICES_H */
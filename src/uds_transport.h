@@ -0,0 +1,31 @@
+/**
+ * @file uds_transport.h
+ *
+ */
+
+#ifndef UDS_TRANSPORT_H
+#define UDS_TRANSPORT_H
+
+#include <cstddef>
+
+/**
+ * Interface of the transport the responses of an ECU are sent with, i.e. the
+ * `IsoTpSender` on a CAN interface or the in-process `LoopbackTransport`.
+ */
+class UdsTransport
+{
+public:
+    virtual ~UdsTransport() = default;
+
+    /**
+     * Sends a complete UDS message. Called by the UDS, broadcast and Lua
+     * threads of the ECU, so implementations have to be thread-safe.
+     *
+     * @param buffer: the message
+     * @param size: the length of the message in bytes
+     * @return the number of sent (or queued) bytes, a negative value on errors
+     */
+    virtual int sendData(const void* buffer, std::size_t size) noexcept = 0;
+};
+
+#endif /* UDS_TRANSPORT_H */
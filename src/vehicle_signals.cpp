@@ -0,0 +1,346 @@
+/**
+ * @file vehicle_signals.cpp
+ *
+ * The shared vehicle state and its native encoding, see `VehicleSignals` and
+ * `SignalRecord`.
+ */
+
+#include "vehicle_signals.h"
+#include "logger.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+VehicleSignals& VehicleSignals::getInstance()
+{
+    static VehicleSignals signals;
+    return signals;
+}
+
+VehicleSignals::VehicleSignals()
+{
+    for (Buffer& buffer : buffers_)
+    {
+        for (atomic<double>& value : buffer)
+        {
+            value.store(0.0, memory_order_relaxed);
+        }
+    }
+    for (atomic<uint64_t>& sequence : sequences_)
+    {
+        sequence.store(0, memory_order_relaxed);
+    }
+}
+
+/**
+ * Registers a signal, the value of a new signal is 0.
+ *
+ * @param name: the name of the signal (e.g. "VehicleSpeed")
+ * @return the ID of the (already existing) signal or nothing if the store is full
+ */
+optional<VehicleSignals::SignalId> VehicleSignals::registerSignal(const string& name)
+{
+    lock_guard<mutex> lock(registryMutex_);
+    auto iter = ids_.find(name);
+    if (iter != ids_.end())
+    {
+        return iter->second;
+    }
+    const size_t count = count_;
+    if (count >= MAX_VEHICLE_SIGNALS)
+    {
+        LOG_ERROR("Unable to register the signal " << name << ", max. " << dec << MAX_VEHICLE_SIGNALS << " signals");
+        return {};
+    }
+    ids_.emplace(name, SignalId(count));
+    count_ = count + 1;
+    return SignalId(count);
+}
+
+/**
+ * @return the ID of the signal or nothing if it is not registered
+ */
+optional<VehicleSignals::SignalId> VehicleSignals::findSignal(const string& name) const
+{
+    lock_guard<mutex> lock(registryMutex_);
+    auto iter = ids_.find(name);
+    if (iter == ids_.end())
+    {
+        return {};
+    }
+    return iter->second;
+}
+
+/**
+ * Sets the value of a signal.
+ */
+void VehicleSignals::set(SignalId id, double value)
+{
+    update({{id, value}});
+}
+
+/**
+ * Sets the values of several signals, which become visible at once.
+ *
+ * @param values: the pairs of the signal ID and its new value
+ */
+void VehicleSignals::update(const vector<pair<SignalId, double>>& values)
+{
+    write([&values](Buffer& next, size_t count)
+    {
+        for (const pair<SignalId, double>& value : values)
+        {
+            if (value.first < count)
+            {
+                next[value.first].store(value.second, memory_order_relaxed);
+            }
+        }
+    });
+}
+
+/**
+ * Sets the values of several signals, which become visible at once, e.g. a
+ * frame of an external feed, see `SignalFeed`.
+ *
+ * @param ids: the signals to set
+ * @param values: the new values of the signals
+ * @param count: the number of signals
+ */
+void VehicleSignals::update(const SignalId* ids, const double* values, size_t count)
+{
+    write([ids, values, count](Buffer& next, size_t signalCount)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (ids[i] < signalCount)
+            {
+                next[ids[i]].store(values[i], memory_order_relaxed);
+            }
+        }
+    });
+}
+
+/**
+ * Publishes the next buffer: copies the current values into it, lets `apply`
+ * change them and makes it the current buffer.
+ *
+ * @param apply: called with the next buffer and the number of signals
+ */
+template<typename Apply>
+void VehicleSignals::write(Apply apply)
+{
+    lock_guard<mutex> lock(writerMutex_);
+    const uint64_t generation = generation_.load(memory_order_relaxed);
+    const Buffer& current = buffers_[generation & 1];
+    Buffer& next = buffers_[(generation + 1) & 1];
+    atomic<uint64_t>& sequence = sequences_[(generation + 1) & 1];
+
+    const uint64_t startSequence = sequence.load(memory_order_relaxed) + 1;
+    sequence.store(startSequence, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    const size_t count = count_;
+    for (size_t i = 0; i < count; ++i)
+    {
+        next[i].store(current[i].load(memory_order_relaxed), memory_order_relaxed);
+    }
+    apply(next, count);
+    sequence.store(startSequence + 1, memory_order_release);
+    generation_.store(generation + 1, memory_order_release);
+    for (const auto& listener : updateListeners_)
+    {
+        listener.second();
+    }
+}
+
+/**
+ * Registers a function called after every update, e.g. to refresh the
+ * payloads which are not encoded on every transmission. It is called by the
+ * writer with the writer lock held, so it must not block or update signals
+ * itself.
+ *
+ * @param listener: the function to call
+ * @return the ID for `removeUpdateListener()`
+ */
+int VehicleSignals::addUpdateListener(function<void()> listener)
+{
+    lock_guard<mutex> lock(writerMutex_);
+    updateListeners_[nextListenerId_] = move(listener);
+    return nextListenerId_++;
+}
+
+/**
+ * Removes an update listener. It is not called anymore after returning.
+ *
+ * @param id: the ID returned by `addUpdateListener()`
+ */
+void VehicleSignals::removeUpdateListener(int id)
+{
+    lock_guard<mutex> lock(writerMutex_);
+    updateListeners_.erase(id);
+}
+
+/**
+ * @return the current value of the signal, 0 for an unknown ID
+ */
+double VehicleSignals::get(SignalId id) const noexcept
+{
+    if (id >= MAX_VEHICLE_SIGNALS)
+    {
+        return 0.0;
+    }
+    return buffers_[generation_.load(memory_order_acquire) & 1][id].load(memory_order_relaxed);
+}
+
+/**
+ * Reads the values of several signals of the same update.
+ *
+ * @param ids: the signals to read
+ * @param count: the number of signals
+ * @param values: set to the values of the signals
+ */
+void VehicleSignals::snapshot(const SignalId* ids, size_t count, double* values) const noexcept
+{
+    for (;;)
+    {
+        const uint64_t generation = generation_.load(memory_order_acquire);
+        const Buffer& buffer = buffers_[generation & 1];
+        const atomic<uint64_t>& sequence = sequences_[generation & 1];
+        const uint64_t startSequence = sequence.load(memory_order_acquire);
+        if ((startSequence & 1) != 0)
+        {
+            continue; // overwritten by the next but one update
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] = ids[i] < MAX_VEHICLE_SIGNALS ? buffer[ids[i]].load(memory_order_relaxed) : 0.0;
+        }
+        atomic_thread_fence(memory_order_acquire);
+        if (sequence.load(memory_order_relaxed) == startSequence)
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * @param encodings: the encoded signals, max. `MAX_SIGNALS_PER_RECORD`
+ * @param size: the length of the record in bytes, at least the last bit of the encodings
+ * @param fill: the value of the bytes which are not overlaid
+ */
+SignalRecord::SignalRecord(vector<SignalEncoding> encodings, size_t size, uint8_t fill)
+: size_(size)
+, fill_(fill)
+{
+    if (encodings.size() > MAX_SIGNALS_PER_RECORD)
+    {
+        LOG_WARNING("Ignoring the signals after the first " << dec << MAX_SIGNALS_PER_RECORD << " of a record");
+        encodings.resize(MAX_SIGNALS_PER_RECORD);
+    }
+    for (const SignalEncoding& encoding : encodings)
+    {
+        const unsigned length = min(max(encoding.bitLength, 1u), 32u);
+        const unsigned start = encoding.startBit;
+        // both bit orders count the positions upwards through the bytes
+        const unsigned end = start + length;
+        size_ = max<size_t>(size_, (end + 7) / 8);
+
+        Field field;
+        field.scale = encoding.scale != 0.0 ? encoding.scale : 1.0;
+        field.offset = encoding.offset;
+        field.isSigned = encoding.isSigned;
+        field.minimum = encoding.isSigned ? -ldexp(1.0, int(length) - 1) : 0.0;
+        field.maximum = encoding.isSigned ? ldexp(1.0, int(length) - 1) - 1.0 : ldexp(1.0, int(length)) - 1.0;
+        field.firstSegment = uint16_t(segments_.size());
+        for (unsigned byte = start / 8; byte * 8 < end; ++byte)
+        {
+            // the positions of the byte covered by the value
+            const unsigned first = max(start, byte * 8);
+            const unsigned last = min(end, byte * 8 + 8);
+            Segment segment;
+            segment.byte = uint16_t(byte);
+            segment.mask = 0;
+            for (unsigned position = first; position < last; ++position)
+            {
+                segment.mask |= encoding.isBigEndian ? uint8_t(0x80 >> (position % 8)) : uint8_t(0x01 << (position % 8));
+            }
+            // big endian: the LSB of the value is at the last position, counted from the MSB of a byte
+            segment.shift = encoding.isBigEndian ? int8_t(int(end) - int(byte * 8 + 8))
+                                                 : int8_t(int(byte * 8) - int(start));
+            segments_.push_back(segment);
+        }
+        field.segmentCount = uint16_t(segments_.size() - field.firstSegment);
+        fields_.push_back(field);
+        signals_.push_back(encoding.signal);
+    }
+}
+
+/**
+ * Appends the encoded record to the bytes.
+ */
+void SignalRecord::append(vector<uint8_t>& bytes) const
+{
+    const size_t offset = bytes.size();
+    bytes.resize(offset + size_, fill_);
+    encode(bytes.data() + offset);
+}
+
+/**
+ * Writes the signals into existing bytes (e.g. the payload of a PGN), the
+ * other bits are kept. Missing bytes are filled.
+ */
+void SignalRecord::overlay(vector<uint8_t>& bytes) const
+{
+    if (bytes.size() < size_)
+    {
+        bytes.resize(size_, fill_);
+    }
+    encode(bytes.data());
+}
+
+/**
+ * Writes the current values of the signals into the record.
+ *
+ * @param bytes: the record of `size()` bytes
+ */
+void SignalRecord::encode(uint8_t* bytes) const noexcept
+{
+    double values[MAX_SIGNALS_PER_RECORD];
+    VehicleSignals::getInstance().snapshot(signals_.data(), signals_.size(), values);
+
+    for (size_t i = 0; i < fields_.size(); ++i)
+    {
+        const Field& field = fields_[i];
+        const double scaled = nearbyint((values[i] - field.offset) / field.scale);
+        // saturate to the range of the bit length
+        const double saturated = isnan(scaled) ? 0.0 : min(max(scaled, field.minimum), field.maximum);
+        const uint64_t raw = field.isSigned ? uint64_t(int64_t(saturated)) : uint64_t(saturated);
+
+        const Segment *segment = segments_.data() + field.firstSegment;
+        for (const Segment *last = segment + field.segmentCount; segment != last; ++segment)
+        {
+            const uint8_t value = segment->shift >= 0 ? uint8_t(raw >> segment->shift)
+                                                      : uint8_t(raw << -segment->shift);
+            uint8_t& byte = bytes[segment->byte];
+            byte = uint8_t((byte & ~segment->mask) | (value & segment->mask));
+        }
+    }
+}
+
+/**
+ * @return the record of the data identifier or `nullptr` if it is not mapped
+ */
+const SignalRecord* SignalMappings::findDataIdentifier(uint16_t identifier) const noexcept
+{
+    auto iter = dataIdentifiers.find(identifier);
+    return iter != dataIdentifiers.end() ? &iter->second : nullptr;
+}
+
+/**
+ * @return the record of the PGN or `nullptr` if it is not mapped
+ */
+const SignalRecord* SignalMappings::findPgn(uint32_t pgn) const noexcept
+{
+    auto iter = pgns.find(pgn);
+    return iter != pgns.end() ? &iter->second : nullptr;
+}
@@ -0,0 +1,167 @@
+/**
+ * @file vehicle_signals.h
+ *
+ */
+
+#ifndef VEHICLE_SIGNALS_H
+#define VEHICLE_SIGNALS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+constexpr std::size_t MAX_VEHICLE_SIGNALS = 4096;
+constexpr std::size_t MAX_SIGNALS_PER_RECORD = 64;
+
+/**
+ * The process-wide vehicle state (e.g. speed, RPM, temperatures), shared by
+ * all ECUs. The values are updated by Lua (`setSignal()`) or external feeds
+ * and encoded natively into DIDs, OBD PIDs and PGNs, see `SignalRecord`.
+ *
+ * The values are kept as a struct-of-arrays: a name registry, which is only
+ * used at load time, and two buffers of doubles indexed by the signal ID. A
+ * writer copies the current buffer into the other one, applies its updates
+ * and publishes it by incrementing the generation, so a batch of updates
+ * becomes visible at once. Readers never lock: each buffer has a sequence
+ * number, which is odd while the buffer is written, and a snapshot is only
+ * retried if the next but one update started while it was read.
+ */
+class VehicleSignals
+{
+public:
+    using SignalId = std::uint16_t;
+
+    static VehicleSignals& getInstance();
+
+    VehicleSignals();
+    VehicleSignals(const VehicleSignals& orig) = delete;
+    VehicleSignals& operator =(const VehicleSignals& orig) = delete;
+    virtual ~VehicleSignals() = default;
+
+    std::optional<SignalId> registerSignal(const std::string& name);
+    std::optional<SignalId> findSignal(const std::string& name) const;
+    std::size_t size() const noexcept { return count_; }
+
+    void set(SignalId id, double value);
+    void update(const std::vector<std::pair<SignalId, double>>& values);
+    void update(const SignalId* ids, const double* values, std::size_t count);
+    double get(SignalId id) const noexcept;
+    void snapshot(const SignalId* ids, std::size_t count, double* values) const noexcept;
+    std::uint64_t getGeneration() const noexcept { return generation_; }
+    int addUpdateListener(std::function<void()> listener);
+    void removeUpdateListener(int id);
+
+private:
+    using Buffer = std::array<std::atomic<double>, MAX_VEHICLE_SIGNALS>;
+
+    mutable std::mutex registryMutex_;
+    std::map<std::string, SignalId, std::less<>> ids_;
+    std::atomic<std::size_t> count_{0};
+
+    std::mutex writerMutex_; ///< serializes the writers, the readers never lock
+    Buffer buffers_[2]; ///< the current values are in `buffers_[generation_ & 1]`
+    std::atomic<std::uint64_t> sequences_[2]; ///< odd while the buffer is written
+    std::atomic<std::uint64_t> generation_{0};
+    std::map<int, std::function<void()>> updateListeners_; ///< guarded by `writerMutex_`
+    int nextListenerId_ = 0; ///< guarded by `writerMutex_`
+
+    template<typename Apply>
+    void write(Apply apply);
+};
+
+/**
+ * The encoding of one signal into a byte record (e.g. a DID).
+ *
+ * The raw value is `(value - offset) / scale`, rounded and saturated to the
+ * bit length. With big endian (Motorola, e.g. UDS and OBD) the start bit is
+ * the MSB of the value counted from the MSB of the first byte. With little
+ * endian (Intel, e.g. J1939) it is the LSB of the value counted from the LSB
+ * of the first byte.
+ */
+struct SignalEncoding
+{
+    VehicleSignals::SignalId signal = 0;
+    unsigned startBit = 0;
+    unsigned bitLength = 8; ///< 1 to 32 bits
+    double scale = 1.0;
+    double offset = 0.0;
+    bool isBigEndian = true;
+    bool isSigned = false; ///< two's complement
+};
+
+/**
+ * A byte record (DID, OBD PID or PGN), which is encoded from the vehicle
+ * signals at serve time, without any Lua access.
+ *
+ * The encodings are compiled on construction into byte segments: for every
+ * byte a signal touches, the shift of the raw value and the mask of its bits
+ * in that byte. Encoding a signal is therefore one shift and mask per byte
+ * instead of a loop over its bits.
+ */
+class SignalRecord
+{
+public:
+    SignalRecord() = default;
+    SignalRecord(std::vector<SignalEncoding> encodings, std::size_t size, std::uint8_t fill);
+
+    std::size_t size() const noexcept { return size_; }
+    void append(std::vector<std::uint8_t>& bytes) const;
+    void overlay(std::vector<std::uint8_t>& bytes) const;
+    void encode(std::uint8_t* bytes) const noexcept;
+
+private:
+    /// the bits of a raw value in one byte of the record
+    struct Segment
+    {
+        std::uint16_t byte; ///< the index of the byte in the record
+        std::int8_t shift; ///< right shift of the raw value, negative for a left shift
+        std::uint8_t mask; ///< the bits of the value in the byte
+    };
+
+    /// a compiled `SignalEncoding`
+    struct Field
+    {
+        double scale;
+        double offset;
+        double minimum; ///< the saturation range of the raw value
+        double maximum;
+        bool isSigned;
+        std::uint16_t firstSegment; ///< index into `segments_`
+        std::uint16_t segmentCount;
+    };
+
+    std::vector<Field> fields_;
+    std::vector<Segment> segments_;
+    std::vector<VehicleSignals::SignalId> signals_; ///< the signals of `fields_`, for the snapshot
+    std::size_t size_ = 0; ///< the length of the record in bytes
+    std::uint8_t fill_ = 0x00; ///< the value of the unused bits
+};
+
+/**
+ * The `Signals` table of an ECU: the records encoded from the vehicle signals.
+ * The OBD PIDs are served by the `ObdService`, see `ObdPidConfiguration`.
+ *
+ * The PGN records are SPN templates. They are overlaid on the payload of the
+ * `PGNs` table or, for PGNs which are not in that table, sent on their own
+ * with the cycle time of `pgnCycleTimes`.
+ */
+struct SignalMappings
+{
+    std::map<std::uint16_t, SignalRecord> dataIdentifiers;
+    std::map<std::uint32_t, SignalRecord> pgns;
+    std::map<std::uint32_t, unsigned int> pgnCycleTimes; ///< in ms, 0 if only sent on request
+
+    const SignalRecord* findDataIdentifier(std::uint16_t identifier) const noexcept;
+    const SignalRecord* findPgn(std::uint32_t pgn) const noexcept;
+    bool empty() const noexcept { return dataIdentifiers.empty() && pgns.empty(); }
+};
+
+#endif /* VEHICLE_SIGNALS_H */
@@ -0,0 +1,280 @@
+/**
+ * @file worker_supervisor.cpp
+ *
+ * The worker processes of the simulator, see `WorkerSupervisor`.
+ */
+
+#include "worker_supervisor.h"
+#include "logger.h"
+#include <spawn.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+using namespace std;
+
+extern char** environ;
+
+/// started once per worker, the path of the executable of the supervisor
+static constexpr char SELF_EXECUTABLE[] = "/proc/self/exe";
+
+/**
+ * @param count: the number of worker processes
+ */
+WorkerSupervisor::WorkerSupervisor(unsigned int count)
+: workers_(count)
+{
+}
+
+/**
+ * Starts the workers and supervises them until the simulator is asked to
+ * terminate, then waits for all of them to stop.
+ *
+ * @param argv: the arguments of the simulator, passed on to the workers
+ * @param signals: the signals returned by `blockTerminationSignals()`
+ * @return 0, or -1 if no worker could be started
+ */
+int WorkerSupervisor::run(char** argv, const sigset_t& signals)
+{
+    sigset_t waitSignals = signals;
+    sigaddset(&waitSignals, SIGCHLD);
+    pthread_sigmask(SIG_BLOCK, &waitSignals, nullptr);
+
+    for (unsigned int index = 0; index < workers_.size(); ++index)
+    {
+        spawn(index, argv, signals);
+    }
+    if (!isRunning())
+    {
+        return -1;
+    }
+    LOG_INFO("Started " << workers_.size() << " workers");
+
+    int signum = 0;
+    while (isRunning())
+    {
+        if (sigwait(&waitSignals, &signum) != 0)
+        {
+            continue;
+        }
+        if (signum == SIGCHLD)
+        {
+            reap(argv, signals, false);
+            continue;
+        }
+        forward(signum);
+        if (signum == SIGINT || signum == SIGTERM)
+        {
+            break;
+        }
+    }
+    while (isRunning())
+    {
+        reap(argv, signals, true);
+    }
+    LOG_INFO("All workers stopped");
+    return 0;
+}
+
+/**
+ * Prepares a worker process, called before its first thread is started: the
+ * worker is terminated with its supervisor.
+ *
+ * @return the index of the worker, -1 if the process is no worker
+ */
+int WorkerSupervisor::initializeWorker() noexcept
+{
+    const int index = parseWorkerIndex(getenv(WORKER_ENVIRONMENT));
+    if (index >= 0)
+    {
+        prctl(PR_SET_PDEATHSIG, SIGTERM);
+    }
+    return index;
+}
+
+/**
+ * @param value: the value of `CARSIM_WORKER`, might be `nullptr`
+ * @return the index of the worker, -1 if the value is missing or invalid
+ */
+int WorkerSupervisor::parseWorkerIndex(const char* value) noexcept
+{
+    if (value == nullptr || *value == '\0')
+    {
+        return -1;
+    }
+    char* end = nullptr;
+    errno = 0;
+    const long index = strtol(value, &end, 10);
+    if (errno != 0 || *end != '\0' || index < 0 || index > 0xFFFF)
+    {
+        return -1;
+    }
+    return int(index);
+}
+
+/**
+ * The interfaces with a number at the end (e.g. `vcan3`) are dealt round
+ * robin by that number, the others by a hash of their name, so the owner
+ * does not depend on the order the configurations are loaded in.
+ *
+ * @param interface: the name of the CAN interface
+ * @param workers: the number of workers, at least 1
+ * @return the index of the worker simulating the interface
+ */
+unsigned int WorkerSupervisor::getInterfaceOwner(const string& interface, unsigned int workers) noexcept
+{
+    size_t digits = interface.size();
+    while (digits > 0 && interface[digits - 1] >= '0' && interface[digits - 1] <= '9')
+    {
+        --digits;
+    }
+    uint32_t key = 0;
+    if (digits < interface.size() && interface.size() - digits <= 9)
+    {
+        key = uint32_t(strtoul(interface.c_str() + digits, nullptr, 10));
+    }
+    else
+    {
+        // FNV-1a
+        key = 2166136261u;
+        for (const char c : interface)
+        {
+            key = (key ^ uint8_t(c)) * 16777619u;
+        }
+    }
+    return key % workers;
+}
+
+/**
+ * Gives each worker its own output file, e.g. `/tmp/carsim.2.ckpt` for the
+ * checkpoint `/tmp/carsim.ckpt` of worker 2.
+ *
+ * @param file: the file configured in `simulator.lua`
+ * @param index: the index of the worker, -1 without workers
+ * @return the file of the worker, unchanged without workers or if empty
+ */
+string WorkerSupervisor::getWorkerFile(const string& file, int index)
+{
+    if (index < 0 || file.empty())
+    {
+        return file;
+    }
+    filesystem::path path(file);
+    const string extension = path.extension().string();
+    path.replace_extension();
+    return path.string() + "." + to_string(index) + extension;
+}
+
+/**
+ * Starts a worker with the arguments of the supervisor. The termination
+ * signals stay blocked in the worker until it waits for them.
+ */
+bool WorkerSupervisor::spawn(unsigned int index, char** argv, const sigset_t& signals)
+{
+    const string prefix = string(WORKER_ENVIRONMENT) + "=";
+    const string variable = prefix + to_string(index);
+    vector<char*> environment;
+    for (char** entry = environ; *entry != nullptr; ++entry)
+    {
+        if (strncmp(*entry, prefix.c_str(), prefix.size()) != 0)
+        {
+            environment.push_back(*entry);
+        }
+    }
+    environment.push_back(const_cast<char*>(variable.c_str()));
+    environment.push_back(nullptr);
+
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    posix_spawnattr_setsigmask(&attributes, &signals);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGMASK);
+    pid_t pid = -1;
+    const int error = posix_spawn(&pid, SELF_EXECUTABLE, nullptr, &attributes, argv, environment.data());
+    posix_spawnattr_destroy(&attributes);
+    if (error != 0)
+    {
+        LOG_ERROR("Unable to start worker " << index << ": " << strerror(error));
+        return false;
+    }
+    workers_[index].pid = pid;
+    workers_[index].startTime = chrono::steady_clock::now();
+    LOG_INFO("Worker " << index << " started with PID " << pid);
+    return true;
+}
+
+void WorkerSupervisor::forward(int signum) const noexcept
+{
+    for (const Worker& worker : workers_)
+    {
+        if (worker.pid > 0)
+        {
+            kill(worker.pid, signum);
+        }
+    }
+}
+
+/**
+ * Collects the stopped workers. A worker killed by a signal (e.g. a crash)
+ * is restarted, unless the simulator is stopping or the worker crashed
+ * during its startup, which would only crash again.
+ *
+ * @param isStopping: true to wait for a worker to stop
+ */
+void WorkerSupervisor::reap(char** argv, const sigset_t& signals, bool isStopping)
+{
+    int status = 0;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, isStopping ? 0 : WNOHANG)) > 0)
+    {
+        for (unsigned int index = 0; index < workers_.size(); ++index)
+        {
+            Worker& worker = workers_[index];
+            if (worker.pid != pid)
+            {
+                continue;
+            }
+            worker.pid = -1;
+            if (!WIFSIGNALED(status))
+            {
+                LOG_INFO("Worker " << index << " exited with " << WEXITSTATUS(status));
+            }
+            else if (isStopping || chrono::steady_clock::now() - worker.startTime < MIN_WORKER_UPTIME)
+            {
+                LOG_ERROR("Worker " << index << " terminated by signal " << WTERMSIG(status));
+            }
+            else
+            {
+                LOG_ERROR("Worker " << index << " terminated by signal " << WTERMSIG(status) << ", restarting it");
+                spawn(index, argv, signals);
+            }
+        }
+        if (isStopping)
+        {
+            return;
+        }
+    }
+    if (pid < 0 && errno == ECHILD)
+    {
+        // no child left, e.g. if a SIGCHLD was missed
+        for (Worker& worker : workers_)
+        {
+            worker.pid = -1;
+        }
+    }
+}
+
+bool WorkerSupervisor::isRunning() const noexcept
+{
+    for (const Worker& worker : workers_)
+    {
+        if (worker.pid > 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
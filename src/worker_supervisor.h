@@ -0,0 +1,69 @@
+/**
+ * @file worker_supervisor.h
+ *
+ */
+
+#ifndef WORKER_SUPERVISOR_H
+#define WORKER_SUPERVISOR_H
+
+#include <signal.h>
+#include <sys/types.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/// the environment variable with the index of a worker process
+constexpr char WORKER_ENVIRONMENT[] = "CARSIM_WORKER";
+
+/**
+ * Runs the simulator in several processes (`Workers` in `simulator.lua`), so
+ * a few busy ECUs do not limit a whole vehicle to the cores one process
+ * uses. The supervisor starts the simulator executable once per worker with
+ * its index in `CARSIM_WORKER` and does nothing else: it forwards the
+ * signals (termination, Lua profile, checkpoint) to all workers, waits for
+ * them to stop and restarts a worker which crashed.
+ *
+ * Every worker loads all configurations and shards the CAN interfaces: an
+ * interface belongs to exactly one worker, see `getInterfaceOwner()`, so each
+ * ECU, J1939 node and CAN frame simulation runs once. A configuration without
+ * a simulation in the worker is deleted right after loading. The DoIP ECUs
+ * run in every worker and their entities listen with `SO_REUSEPORT`, so the
+ * kernel spreads the connections of the testers over the workers; the UDP
+ * vehicle identification and the entities with CAN gateway routes stay on
+ * the first worker. With `ConfigSnapshots` the workers share the pages of
+ * the compiled `Raw` tables.
+ */
+class WorkerSupervisor
+{
+public:
+    /// a crashed worker is only restarted if it ran at least this long
+    static constexpr std::chrono::seconds MIN_WORKER_UPTIME{5};
+
+    explicit WorkerSupervisor(unsigned int count);
+    WorkerSupervisor(const WorkerSupervisor& orig) = delete;
+    WorkerSupervisor& operator =(const WorkerSupervisor& orig) = delete;
+    virtual ~WorkerSupervisor() = default;
+
+    int run(char** argv, const sigset_t& signals);
+
+    static int initializeWorker() noexcept;
+    static int parseWorkerIndex(const char* value) noexcept;
+    static unsigned int getInterfaceOwner(const std::string& interface, unsigned int workers) noexcept;
+    static std::string getWorkerFile(const std::string& file, int index);
+
+private:
+    struct Worker
+    {
+        pid_t pid = -1; ///< -1 if the worker is not running
+        std::chrono::steady_clock::time_point startTime;
+    };
+
+    std::vector<Worker> workers_; ///< by their index
+
+    bool spawn(unsigned int index, char** argv, const sigset_t& signals);
+    void forward(int signum) const noexcept;
+    void reap(char** argv, const sigset_t& signals, bool isStopping);
+    bool isRunning() const noexcept;
+};
+
+#endif /* WORKER_SUPERVISOR_H */
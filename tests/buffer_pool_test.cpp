@@ -0,0 +1,61 @@
+/**
+ * @file buffer_pool_test.cpp
+ *
+ * Unit test for the pool of the DoIP receive buffers.
+ */
+
+#include "buffer_pool_test.h"
+#include "buffer_pool.h"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BufferPoolTest);
+
+void BufferPoolTest::setUp() { }
+
+void BufferPoolTest::tearDown() { }
+
+void BufferPoolTest::testReleasedBufferIsReused()
+{
+    BufferPool pool(4096, 2);
+    CPPUNIT_ASSERT_EQUAL(size_t(4096), pool.getBufferSize());
+
+    BufferPool::Buffer buffer = pool.acquire();
+    CPPUNIT_ASSERT(buffer != nullptr);
+    buffer[4095] = 0x5A;
+    const uint8_t* pData = buffer.get();
+    pool.release(move(buffer));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), pool.getFreeBufferCount());
+
+    buffer = pool.acquire();
+    CPPUNIT_ASSERT(buffer.get() == pData);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), pool.getFreeBufferCount());
+
+    // a second buffer at the same time is a new one
+    BufferPool::Buffer other = pool.acquire();
+    CPPUNIT_ASSERT(other.get() != pData);
+    pool.release(move(other));
+    pool.release(move(buffer));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), pool.getFreeBufferCount());
+}
+
+void BufferPoolTest::testFreeBuffersAreLimited()
+{
+    BufferPool pool(64, 2);
+    vector<BufferPool::Buffer> buffers;
+    for (int i = 0; i < 5; ++i)
+    {
+        buffers.push_back(pool.acquire());
+    }
+    for (BufferPool::Buffer& buffer : buffers)
+    {
+        pool.release(move(buffer));
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(2), pool.getFreeBufferCount());
+
+    // releasing nothing is ignored
+    pool.release(BufferPool::Buffer());
+    CPPUNIT_ASSERT_EQUAL(size_t(2), pool.getFreeBufferCount());
+}
@@ -0,0 +1,32 @@
+/**
+ * @file buffer_pool_test.h
+ *
+ */
+
+#ifndef BUFFER_POOL_TEST_H
+#define BUFFER_POOL_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class BufferPoolTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(BufferPoolTest);
+
+    CPPUNIT_TEST(testReleasedBufferIsReused);
+    CPPUNIT_TEST(testFreeBuffersAreLimited);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    BufferPoolTest() = default;
+    virtual ~BufferPoolTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testReleasedBufferIsReused();
+    void testFreeBuffersAreLimited();
+
+};
+
+#endif /* BUFFER_POOL_TEST_H */
@@ -0,0 +1,83 @@
+/**
+ * @file bus_load_budget_test.cpp
+ *
+ * Unit test for the bus load estimate and the pacing of the bulk frames.
+ */
+
+#include "bus_load_budget_test.h"
+#include "bus_load_budget.h"
+#include <cstdint>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(BusLoadBudgetTest);
+
+static constexpr uint64_t NS_PER_MS = 1000000;
+/// a classic frame with 8 bytes and an 11 bit ID
+static constexpr size_t FRAME_BITS = 47 + 64;
+
+void BusLoadBudgetTest::setUp()
+{
+    BusLoadBudget::configure(DEFAULT_BUS_BIT_RATE, 0);
+}
+
+void BusLoadBudgetTest::tearDown()
+{
+    BusLoadBudget::configure(DEFAULT_BUS_BIT_RATE, 0);
+}
+
+void BusLoadBudgetTest::testFrameBits()
+{
+    CPPUNIT_ASSERT_EQUAL(FRAME_BITS, BusLoadBudget::getFrameBits(0x7E8, 8));
+    CPPUNIT_ASSERT_EQUAL(size_t(67 + 24), BusLoadBudget::getFrameBits(CAN_EFF_FLAG | 0x18FEF100, 3));
+}
+
+void BusLoadBudgetTest::testLoad()
+{
+    BusLoadBudget budget(0);
+    CPPUNIT_ASSERT_EQUAL(0.0, budget.getLoad(0));
+
+    // 25000 bits in 100 ms are 50 % of 500 kbit/s
+    for (size_t bits = 0; bits < 25000; bits += 1000)
+    {
+        budget.consume(1000, 10 * NS_PER_MS);
+    }
+    CPPUNIT_ASSERT_EQUAL(0.0, budget.getLoad(50 * NS_PER_MS));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, budget.getLoad(100 * NS_PER_MS), 1e-9);
+    // nothing sent in the next window
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, budget.getLoad(150 * NS_PER_MS), 1e-9);
+    CPPUNIT_ASSERT_EQUAL(0.0, budget.getLoad(200 * NS_PER_MS));
+}
+
+void BusLoadBudgetTest::testPacing()
+{
+    // 50 % of 500 kbit/s: 250 bits per ms, the bucket holds 2500 bits
+    BusLoadBudget::configure(DEFAULT_BUS_BIT_RATE, 0.5);
+    BusLoadBudget budget(0);
+    size_t frames = 0;
+    while (budget.getDelayNs(FRAME_BITS, 0) == 0)
+    {
+        budget.consume(FRAME_BITS, 0);
+        ++frames;
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(2500 / FRAME_BITS), frames);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), budget.getDeferredFrames());
+
+    // the tokens of a frame are refilled in 444 µs
+    const uint64_t delayNs = budget.getDelayNs(FRAME_BITS, 0);
+    CPPUNIT_ASSERT(delayNs > 0 && delayNs <= 444000);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), budget.getDelayNs(FRAME_BITS, delayNs));
+
+    // the cyclic frames are always sent and delay the bulk frames
+    budget.consume(10000, NS_PER_MS);
+    CPPUNIT_ASSERT(budget.getDelayNs(FRAME_BITS, NS_PER_MS) > 10 * NS_PER_MS);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), budget.getDelayNs(FRAME_BITS, 30 * NS_PER_MS));
+}
+
+void BusLoadBudgetTest::testUnpaced()
+{
+    BusLoadBudget budget(0);
+    budget.consume(100000, 0);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), budget.getDelayNs(FRAME_BITS, 0));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), budget.getDeferredFrames());
+}
@@ -0,0 +1,36 @@
+/**
+ * @file bus_load_budget_test.h
+ *
+ */
+
+#ifndef BUS_LOAD_BUDGET_TEST_H
+#define BUS_LOAD_BUDGET_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class BusLoadBudgetTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(BusLoadBudgetTest);
+
+    CPPUNIT_TEST(testFrameBits);
+    CPPUNIT_TEST(testLoad);
+    CPPUNIT_TEST(testPacing);
+    CPPUNIT_TEST(testUnpaced);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    BusLoadBudgetTest() = default;
+    virtual ~BusLoadBudgetTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testFrameBits();
+    void testLoad();
+    void testPacing();
+    void testUnpaced();
+
+};
+
+#endif /* BUS_LOAD_BUDGET_TEST_H */
@@ -0,0 +1,171 @@
+/**
+ * @file can_frame_bus_test.cpp
+ *
+ */
+
+#include "can_frame_bus_test.h"
+#include "can_frame_bus.h"
+#include <algorithm>
+#include <cstring>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <poll.h>
+#include <unistd.h>
+
+constexpr canid_t REQUEST_ID = 0x6F0;
+constexpr canid_t RESPONSE_ID = 0x6F8;
+constexpr canid_t CYCLIC_ID = 0x3E1;
+const std::string DEVICE = "vcan0";
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CanFrameBusTest);
+
+CanFrameBusTest::CanFrameBusTest()
+{
+}
+
+CanFrameBusTest::~CanFrameBusTest()
+{
+}
+
+void CanFrameBusTest::setUp()
+{
+    skt_ = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    CPPUNIT_ASSERT(skt_ >= 0);
+    struct sockaddr_can addr = {};
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = int(if_nametoindex(DEVICE.c_str()));
+    CPPUNIT_ASSERT(bind(skt_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) >= 0);
+    // the tester only reads the frames of the ECU
+    struct can_filter filters[] = {
+        {RESPONSE_ID, CAN_EFF_FLAG | CAN_SFF_MASK},
+        {CYCLIC_ID, CAN_EFF_FLAG | CAN_SFF_MASK},
+        {0x18DAF100 | CAN_EFF_FLAG, CAN_EFF_FLAG | CAN_EFF_MASK},
+    };
+    setsockopt(skt_, SOL_CAN_RAW, CAN_RAW_FILTER, filters, sizeof(filters));
+}
+
+void CanFrameBusTest::tearDown()
+{
+    close(skt_);
+    skt_ = -1;
+}
+
+void CanFrameBusTest::writeFrame(canid_t canId, const std::initializer_list<std::uint8_t>& data)
+{
+    struct can_frame frame = {};
+    frame.can_id = canId;
+    frame.can_dlc = std::uint8_t(data.size());
+    std::copy(data.begin(), data.end(), frame.data);
+    CPPUNIT_ASSERT_EQUAL(ssize_t(sizeof(frame)), write(skt_, &frame, sizeof(frame)));
+}
+
+bool CanFrameBusTest::readFrame(struct can_frame& frame, int timeout)
+{
+    struct pollfd pfd = {skt_, POLLIN, 0};
+    if (poll(&pfd, 1, timeout) <= 0)
+    {
+        return false;
+    }
+    return read(skt_, &frame, sizeof(frame)) == ssize_t(sizeof(frame));
+}
+
+void CanFrameBusTest::testToCanId()
+{
+    CPPUNIT_ASSERT_EQUAL(canid_t(0x7FF), CanFrameBus::toCanId(0x7FF));
+    CPPUNIT_ASSERT_EQUAL(canid_t(0x800 | CAN_EFF_FLAG), CanFrameBus::toCanId(0x800));
+    CPPUNIT_ASSERT_EQUAL(canid_t(0x18DAF100 | CAN_EFF_FLAG), CanFrameBus::toCanId(0x18DAF100));
+}
+
+void CanFrameBusTest::testResponse()
+{
+    std::shared_ptr<CanFrameBus> pBus = CanFrameBus::getInstance(DEVICE);
+    CanFrameConfiguration configuration;
+    configuration.canId = REQUEST_ID;
+    configuration.responseId = RESPONSE_ID;
+    configuration.responses.push_back({{0x01, 0x02}, {0x41, 0x02, 0x55}});
+    configuration.responses.push_back({{}, {0x7F}});
+    CPPUNIT_ASSERT(pBus->addFrames(this, {configuration}));
+    // the ID is handled by another ECU already
+    CPPUNIT_ASSERT(!pBus->addFrames(&configuration, {configuration}));
+
+    struct can_frame frame;
+    writeFrame(REQUEST_ID, {0x01, 0x02, 0x00, 0x00});
+    CPPUNIT_ASSERT_MESSAGE("No response!", readFrame(frame));
+    CPPUNIT_ASSERT_EQUAL(RESPONSE_ID, frame.can_id);
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(3), frame.can_dlc);
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0x55), frame.data[2]);
+
+    writeFrame(REQUEST_ID, {0x01, 0x03});
+    CPPUNIT_ASSERT_MESSAGE("No default response!", readFrame(frame));
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(1), frame.can_dlc);
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0x7F), frame.data[0]);
+
+    writeFrame(REQUEST_ID + 1, {0x01, 0x02});
+    CPPUNIT_ASSERT_MESSAGE("Response to an unknown ID!", !readFrame(frame, 100));
+
+    pBus->removeFrames(this);
+}
+
+void CanFrameBusTest::testExtendedId()
+{
+    std::shared_ptr<CanFrameBus> pBus = CanFrameBus::getInstance(DEVICE);
+    CanFrameConfiguration configuration;
+    configuration.canId = CanFrameBus::toCanId(0x18DA00F1);
+    configuration.responseId = CanFrameBus::toCanId(0x18DAF100);
+    configuration.responses.push_back({{0x3E}, {0x7E, 0x00}});
+    CPPUNIT_ASSERT(pBus->addFrames(this, {configuration}));
+
+    struct can_frame frame;
+    // the same ID as 11 bit ID is not handled
+    writeFrame(0x18DA00F1 & CAN_SFF_MASK, {0x3E});
+    CPPUNIT_ASSERT_MESSAGE("Response to an 11 bit ID!", !readFrame(frame, 100));
+    writeFrame(0x18DA00F1 | CAN_EFF_FLAG, {0x3E, 0x00});
+    CPPUNIT_ASSERT_MESSAGE("No response!", readFrame(frame));
+    CPPUNIT_ASSERT_EQUAL(canid_t(0x18DAF100 | CAN_EFF_FLAG), frame.can_id);
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0x7E), frame.data[0]);
+
+    pBus->removeFrames(this);
+}
+
+void CanFrameBusTest::testRemoveFrames()
+{
+    std::shared_ptr<CanFrameBus> pBus = CanFrameBus::getInstance(DEVICE);
+    CanFrameConfiguration configuration;
+    configuration.canId = REQUEST_ID;
+    configuration.responseId = RESPONSE_ID;
+    configuration.responses.push_back({{}, {0x01}});
+    CPPUNIT_ASSERT(pBus->addFrames(this, {configuration}));
+    pBus->removeFrames(this);
+
+    struct can_frame frame;
+    writeFrame(REQUEST_ID, {0x01});
+    CPPUNIT_ASSERT_MESSAGE("Response after the removal!", !readFrame(frame, 100));
+
+    // the ID is free again
+    CPPUNIT_ASSERT(pBus->addFrames(&configuration, {configuration}));
+    pBus->removeFrames(&configuration);
+}
+
+void CanFrameBusTest::testCyclicFrame()
+{
+    std::shared_ptr<CanFrameBus> pBus = CanFrameBus::getInstance(DEVICE);
+    CanFrameConfiguration configuration;
+    configuration.canId = CYCLIC_ID;
+    configuration.payload = {0x01, 0x00, 0xA0, 0x0F};
+    configuration.cycleTime = 20;
+    CPPUNIT_ASSERT(pBus->addFrames(this, {configuration}));
+
+    struct can_frame frame;
+    for (int i = 0; i < 3; ++i)
+    {
+        CPPUNIT_ASSERT_MESSAGE("No cyclic frame!", readFrame(frame));
+        CPPUNIT_ASSERT_EQUAL(CYCLIC_ID, frame.can_id);
+        CPPUNIT_ASSERT_EQUAL(std::uint8_t(4), frame.can_dlc);
+        CPPUNIT_ASSERT_EQUAL(std::uint8_t(0xA0), frame.data[2]);
+    }
+
+    pBus->removeFrames(this);
+    // a frame may have been sent in between
+    readFrame(frame, 50);
+    CPPUNIT_ASSERT_MESSAGE("Cyclic frame after the removal!", !readFrame(frame, 100));
+}
@@ -0,0 +1,46 @@
+/**
+ * @file can_frame_bus_test.h
+ *
+ */
+
+#ifndef CAN_FRAME_BUS_TEST_H
+#define CAN_FRAME_BUS_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cstdint>
+#include <initializer_list>
+#include <linux/can.h>
+
+class CanFrameBusTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(CanFrameBusTest);
+
+    CPPUNIT_TEST(testToCanId);
+    CPPUNIT_TEST(testResponse);
+    CPPUNIT_TEST(testExtendedId);
+    CPPUNIT_TEST(testRemoveFrames);
+    CPPUNIT_TEST(testCyclicFrame);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    CanFrameBusTest();
+    virtual ~CanFrameBusTest();
+    void setUp();
+    void tearDown();
+
+private:
+    int skt_ = -1; ///< the raw socket of the tester
+
+    void testToCanId();
+    void testResponse();
+    void testExtendedId();
+    void testRemoveFrames();
+    void testCyclicFrame();
+
+    void writeFrame(canid_t canId, const std::initializer_list<std::uint8_t>& data);
+    bool readFrame(struct can_frame& frame, int timeout = 500);
+
+};
+
+#endif /* CAN_FRAME_BUS_TEST_H */
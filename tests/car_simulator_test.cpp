@@ -0,0 +1,91 @@
+/**
+ * @file car_simulator_test.cpp
+ *
+ * Unit test for the simulator library. The requests are answered in-process,
+ * so no CAN interface is needed.
+ */
+
+#include "car_simulator_test.h"
+#include "car_simulator.h"
+#include "carsim.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CarSimulatorTest);
+
+static const string LUA_SCRIPT = "tests/test_config_dir/testscript06.lua";
+static const string ECU_TABLE = "PCM";
+
+void CarSimulatorTest::setUp() { }
+
+void CarSimulatorTest::tearDown() { }
+
+void CarSimulatorTest::testAddEcu()
+{
+    CarSimulator simulator;
+    CPPUNIT_ASSERT_EQUAL(true, simulator.addEcu("pcm", LUA_SCRIPT, ECU_TABLE));
+    // the name is in use
+    CPPUNIT_ASSERT_EQUAL(false, simulator.addEcu("pcm", LUA_SCRIPT, ECU_TABLE));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), simulator.getEcuNames().size());
+    CPPUNIT_ASSERT_EQUAL(string("pcm"), simulator.getEcuNames().front());
+}
+
+void CarSimulatorTest::testStaticResponse()
+{
+    CarSimulator simulator;
+    simulator.addEcu("pcm", LUA_SCRIPT, ECU_TABLE);
+
+    const vector<uint8_t> expected = {0x10, 0x33, 0x11};
+    CPPUNIT_ASSERT(expected == simulator.request("pcm", {0x22, 0xFA, 0xBC}));
+    // the same request again, the response buffer is reused
+    CPPUNIT_ASSERT(expected == simulator.request("pcm", {0x22, 0xFA, 0xBC}));
+}
+
+void CarSimulatorTest::testReadDataByIdentifier()
+{
+    CarSimulator simulator;
+    simulator.addEcu("pcm", LUA_SCRIPT, ECU_TABLE);
+
+    const vector<uint8_t> expected = {
+        0x62, 0xF1, 0x90,
+        'S', 'A', 'L', 'G', 'A', '2', 'E', 'V', '9', 'H', 'A', '2', '9', '8', '7', '8', '4'
+    };
+    CPPUNIT_ASSERT(expected == simulator.request("pcm", {0x22, 0xF1, 0x90}));
+}
+
+void CarSimulatorTest::testLuaResponse()
+{
+    CarSimulator simulator;
+    simulator.addEcu("pcm", LUA_SCRIPT, ECU_TABLE);
+
+    const vector<uint8_t> expected = {0x59, 0x02, 0xFF, 0xE3, 0x00, 0x54, 0x2E};
+    CPPUNIT_ASSERT(expected == simulator.request("pcm", {0x19, 0x02, 0xB1}));
+}
+
+void CarSimulatorTest::testInvalidRequest()
+{
+    CarSimulator simulator;
+    simulator.addEcu("pcm", LUA_SCRIPT, ECU_TABLE);
+    vector<uint8_t> response;
+
+    const uint8_t request[] = {0x22, 0xF1, 0x90};
+    CPPUNIT_ASSERT_EQUAL(false, simulator.request("unknown", request, sizeof(request), response));
+    CPPUNIT_ASSERT_EQUAL(true, response.empty());
+    CPPUNIT_ASSERT_EQUAL(false, simulator.request("pcm", request, 0, response));
+}
+
+void CarSimulatorTest::testCInterface()
+{
+    carsim_t* sim = carsim_create(nullptr);
+    CPPUNIT_ASSERT(sim != nullptr);
+    // no ECU table "Main"
+    CPPUNIT_ASSERT_EQUAL(-1, carsim_add_ecu(sim, "pcm", LUA_SCRIPT.c_str()));
+
+    const uint8_t request[] = {0x22, 0xFA, 0xBC};
+    uint8_t response[16];
+    CPPUNIT_ASSERT_EQUAL(-1L, carsim_request(sim, "pcm", request, sizeof(request), response, sizeof(response)));
+    carsim_destroy(sim);
+}
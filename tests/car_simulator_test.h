@@ -0,0 +1,41 @@
+/**
+ * @file car_simulator_test.h
+ *
+ */
+
+#ifndef CAR_SIMULATOR_TEST_H
+#define CAR_SIMULATOR_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class CarSimulatorTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(CarSimulatorTest);
+
+    CPPUNIT_TEST(testAddEcu);
+    CPPUNIT_TEST(testStaticResponse);
+    CPPUNIT_TEST(testReadDataByIdentifier);
+    CPPUNIT_TEST(testLuaResponse);
+    CPPUNIT_TEST(testInvalidRequest);
+    CPPUNIT_TEST(testCInterface);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    CarSimulatorTest() = default;
+    virtual ~CarSimulatorTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testAddEcu();
+    void testStaticResponse();
+    void testReadDataByIdentifier();
+    void testLuaResponse();
+    void testInvalidRequest();
+    void testCInterface();
+
+};
+
+#endif /* CAR_SIMULATOR_TEST_H */
+
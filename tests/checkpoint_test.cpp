@@ -0,0 +1,97 @@
+/**
+ * @file checkpoint_test.cpp
+ *
+ * Unit test for the checkpoint file of the runtime state.
+ */
+
+#include "checkpoint_test.h"
+#include "checkpoint.h"
+#include <unistd.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CheckpointTest);
+
+void CheckpointTest::setUp()
+{
+    checkpointFile_ = "/tmp/checkpoint_test_" + to_string(getpid()) + ".ckpt";
+}
+
+void CheckpointTest::tearDown()
+{
+    remove(checkpointFile_.c_str());
+}
+
+void CheckpointTest::testEncoding()
+{
+    string data;
+    CheckpointEncoder encoder(data);
+    encoder.put(uint8_t(0x03));
+    encoder.put(uint64_t(123456789012));
+    encoder.putString("22 F1 90");
+
+    CheckpointDecoder decoder(data);
+    uint8_t session;
+    uint64_t phase;
+    string_view tableKey;
+    CPPUNIT_ASSERT(decoder.get(session));
+    CPPUNIT_ASSERT(decoder.get(phase));
+    CPPUNIT_ASSERT(decoder.getBytes(tableKey));
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x03), session);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(123456789012), phase);
+    CPPUNIT_ASSERT(tableKey == "22 F1 90");
+    CPPUNIT_ASSERT(decoder.isAtEnd());
+    CPPUNIT_ASSERT(!decoder.get(session));
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x03), session);
+
+    // a length beyond the end
+    CheckpointDecoder truncated(string_view(data).substr(0, data.size() - 1));
+    CPPUNIT_ASSERT(truncated.get(session) && truncated.get(phase));
+    CPPUNIT_ASSERT(!truncated.getBytes(tableKey));
+}
+
+void CheckpointTest::testWriteAndLoad()
+{
+    {
+        Checkpoint checkpoint;
+        checkpoint.add(CheckpointSection::DTC_STORE, "ecu1.lua", string("\x01\x02\x03", 3));
+        checkpoint.add(CheckpointSection::SESSION, "ecu1.lua", string(1, '\x03'));
+        checkpoint.add(CheckpointSection::DTC_STORE, "ecu2.lua", string());
+        CPPUNIT_ASSERT_EQUAL(0, checkpoint.write(checkpointFile_));
+    }
+
+    Checkpoint checkpoint;
+    CPPUNIT_ASSERT_EQUAL(0, checkpoint.load(checkpointFile_));
+    CPPUNIT_ASSERT_EQUAL(size_t(3), checkpoint.size());
+    auto dtcs = checkpoint.find(CheckpointSection::DTC_STORE, "ecu1.lua");
+    CPPUNIT_ASSERT(dtcs && *dtcs == string_view("\x01\x02\x03", 3));
+    auto session = checkpoint.find(CheckpointSection::SESSION, "ecu1.lua");
+    CPPUNIT_ASSERT(session && *session == string_view("\x03", 1));
+    auto empty = checkpoint.find(CheckpointSection::DTC_STORE, "ecu2.lua");
+    CPPUNIT_ASSERT(empty && empty->empty());
+    CPPUNIT_ASSERT(!checkpoint.find(CheckpointSection::SESSION, "ecu2.lua"));
+    CPPUNIT_ASSERT(!checkpoint.find(CheckpointSection::DID_STORE, "ecu1.lua"));
+}
+
+void CheckpointTest::testInvalidFile()
+{
+    Checkpoint checkpoint;
+    CPPUNIT_ASSERT(checkpoint.load(checkpointFile_) < 0);
+
+    ofstream(checkpointFile_) << "not a checkpoint of the simulator";
+    CPPUNIT_ASSERT(checkpoint.load(checkpointFile_) < 0);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), checkpoint.size());
+
+    // a truncated file
+    Checkpoint written;
+    written.add(CheckpointSection::DID_STORE, "ecu1.lua", string(100, 'x'));
+    CPPUNIT_ASSERT_EQUAL(0, written.write(checkpointFile_));
+    CPPUNIT_ASSERT_EQUAL(0, truncate(checkpointFile_.c_str(), 64));
+    CPPUNIT_ASSERT(checkpoint.load(checkpointFile_) < 0);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), checkpoint.size());
+}
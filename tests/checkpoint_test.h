@@ -0,0 +1,37 @@
+/**
+ * @file checkpoint_test.h
+ *
+ */
+
+#ifndef CHECKPOINT_TEST_H
+#define CHECKPOINT_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+class CheckpointTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(CheckpointTest);
+
+    CPPUNIT_TEST(testEncoding);
+    CPPUNIT_TEST(testWriteAndLoad);
+    CPPUNIT_TEST(testInvalidFile);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    CheckpointTest() = default;
+    virtual ~CheckpointTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    std::string checkpointFile_;
+
+    void testEncoding();
+    void testWriteAndLoad();
+    void testInvalidFile();
+
+};
+
+#endif /* CHECKPOINT_TEST_H */
@@ -0,0 +1,85 @@
+/**
+ * @file communication_gate_test.cpp
+ *
+ * Unit test for the communication state of an ECU.
+ */
+
+#include "communication_gate_test.h"
+#include "communication_gate.h"
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CommunicationGateTest);
+
+void CommunicationGateTest::setUp() { }
+
+void CommunicationGateTest::tearDown() { }
+
+void CommunicationGateTest::testControlTypes()
+{
+    CommunicationGate gate;
+    CPPUNIT_ASSERT(gate.isTransmitEnabled());
+    CPPUNIT_ASSERT(gate.isReceiveEnabled());
+
+    CPPUNIT_ASSERT(gate.setControl(CommunicationGate::ENABLE_RX_AND_DISABLE_TX, 0x01));
+    CPPUNIT_ASSERT(!gate.isTransmitEnabled());
+    CPPUNIT_ASSERT(gate.isReceiveEnabled());
+
+    CPPUNIT_ASSERT(gate.setControl(CommunicationGate::DISABLE_RX_AND_ENABLE_TX, 0x01));
+    CPPUNIT_ASSERT(gate.isTransmitEnabled());
+    CPPUNIT_ASSERT(!gate.isReceiveEnabled());
+
+    CPPUNIT_ASSERT(gate.setControl(CommunicationGate::DISABLE_RX_AND_TX, 0x01));
+    CPPUNIT_ASSERT(!gate.isTransmitEnabled());
+    CPPUNIT_ASSERT(!gate.isReceiveEnabled());
+    CPPUNIT_ASSERT_EQUAL(CommunicationGate::DISABLE_RX_AND_TX, gate.getControlType());
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x01), gate.getCommunicationType());
+
+    // not supported, the state is kept
+    CPPUNIT_ASSERT(!gate.setControl(0x04, 0x01));
+    CPPUNIT_ASSERT(!gate.isTransmitEnabled());
+
+    gate.reset();
+    CPPUNIT_ASSERT(gate.isTransmitEnabled());
+    CPPUNIT_ASSERT(gate.isReceiveEnabled());
+    CPPUNIT_ASSERT_EQUAL(CommunicationGate::ENABLE_RX_AND_TX, gate.getControlType());
+}
+
+void CommunicationGateTest::testCommunicationTypes()
+{
+    CommunicationGate gate;
+    // network management only, the normal messages are still sent
+    gate.setControl(CommunicationGate::DISABLE_RX_AND_TX, CommunicationGate::NETWORK_MANAGEMENT_MESSAGES);
+    CPPUNIT_ASSERT(gate.isTransmitEnabled());
+    CPPUNIT_ASSERT(!gate.isTransmitEnabled(CommunicationGate::NETWORK_MANAGEMENT_MESSAGES));
+
+    // both, the subnet number in the upper nibble is ignored
+    gate.setControl(CommunicationGate::ENABLE_RX_AND_DISABLE_TX, 0xF3);
+    CPPUNIT_ASSERT(!gate.isTransmitEnabled());
+    CPPUNIT_ASSERT(!gate.isTransmitEnabled(CommunicationGate::NETWORK_MANAGEMENT_MESSAGES));
+    CPPUNIT_ASSERT(gate.isReceiveEnabled(CommunicationGate::NETWORK_MANAGEMENT_MESSAGES));
+
+    // enabling the normal messages keeps the network management disabled
+    gate.setControl(CommunicationGate::ENABLE_RX_AND_TX, CommunicationGate::NORMAL_MESSAGES);
+    CPPUNIT_ASSERT(gate.isTransmitEnabled());
+    CPPUNIT_ASSERT(!gate.isTransmitEnabled(CommunicationGate::NETWORK_MANAGEMENT_MESSAGES));
+}
+
+void CommunicationGateTest::testListeners()
+{
+    CommunicationGate gate;
+    vector<bool> changes;
+    const int id = gate.addListener([&changes](bool isTransmitEnabled) { changes.push_back(isTransmitEnabled); });
+
+    gate.setControl(CommunicationGate::ENABLE_RX_AND_DISABLE_TX, 0x01);
+    // no change of the normal messages
+    gate.setControl(CommunicationGate::DISABLE_RX_AND_TX, 0x03);
+    gate.setControl(CommunicationGate::DISABLE_RX_AND_TX, 0x02);
+    gate.reset();
+    CPPUNIT_ASSERT(changes == vector<bool>({false, true}));
+
+    gate.removeListener(id);
+    gate.setControl(CommunicationGate::DISABLE_RX_AND_TX, 0x01);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), changes.size());
+}
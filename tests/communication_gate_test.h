@@ -0,0 +1,34 @@
+/**
+ * @file communication_gate_test.h
+ *
+ */
+
+#ifndef COMMUNICATION_GATE_TEST_H
+#define COMMUNICATION_GATE_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class CommunicationGateTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(CommunicationGateTest);
+
+    CPPUNIT_TEST(testControlTypes);
+    CPPUNIT_TEST(testCommunicationTypes);
+    CPPUNIT_TEST(testListeners);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    CommunicationGateTest() = default;
+    virtual ~CommunicationGateTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testControlTypes();
+    void testCommunicationTypes();
+    void testListeners();
+
+};
+
+#endif /* COMMUNICATION_GATE_TEST_H */
@@ -0,0 +1,386 @@
+/**
+ * @file compiled_request_matcher_test.cpp
+ *
+ * Unit test for the compiled (flat) request matcher.
+ */
+
+#include "compiled_request_matcher_test.h"
+#include "compiled_request_matcher.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CompiledRequestMatcherTest);
+
+using RequestTree = std::shared_ptr<RequestByteTreeNode<std::string>>;
+
+/**
+ * Adds a request like "22 F1 XX 3X [10-1F] *" to the given tree, analog to
+ * `EcuLuaScript::addRequestToTree()`.
+ */
+static void addRequest(const RequestTree &tree, const std::vector<std::string> &requestBytes, const std::string &response)
+{
+    auto node = tree.get();
+    for (const std::string &requestByte : requestBytes)
+    {
+        if (requestByte == "XX")
+        {
+            node = node->appendPlaceholder();
+        }
+        else if (requestByte == "*")
+        {
+            node = node->appendWildcard();
+        }
+        else if (requestByte[0] == '[')
+        {
+            RequestBytePattern pattern;
+            pattern.low = uint8_t(std::stoul(requestByte.substr(1, 2), nullptr, 16));
+            pattern.high = uint8_t(std::stoul(requestByte.substr(4, 2), nullptr, 16));
+            node = node->appendPattern(pattern);
+        }
+        else if (requestByte.find('X') != std::string::npos)
+        {
+            const bool isHighPlaceholder = requestByte[0] == 'X';
+            const uint8_t digit = uint8_t(std::stoul(requestByte.substr(isHighPlaceholder ? 1 : 0, 1), nullptr, 16));
+            RequestBytePattern pattern;
+            pattern.mask = isHighPlaceholder ? 0x0F : 0xF0;
+            pattern.value = isHighPlaceholder ? digit : uint8_t(digit << 4);
+            node = node->appendPattern(pattern);
+        }
+        else
+        {
+            node = node->appendByte(uint8_t(std::stoul(requestByte, nullptr, 16)));
+        }
+    }
+    node->setLuaResponse(response);
+}
+
+static std::string match(const CompiledRequestMatcher<std::string> &matcher, const std::vector<uint8_t> &request)
+{
+    const std::string *response = matcher.match(request.data(), request.size());
+    return response ? *response : "<none>";
+}
+
+void CompiledRequestMatcherTest::setUp() { }
+
+void CompiledRequestMatcherTest::tearDown() { }
+
+void CompiledRequestMatcherTest::testExactMatch()
+{
+    RequestTree tree(new RequestByteTreeNode<std::string>());
+    addRequest(tree, {"22", "F1", "90"}, "62 F1 90");
+    addRequest(tree, {"22", "30", "98"}, "62 30 98");
+    addRequest(tree, {"11", "01"}, "51 01");
+    CompiledRequestMatcher<std::string> matcher(tree);
+
+    CPPUNIT_ASSERT_EQUAL(size_t(3), matcher.getLeafCount());
+    CPPUNIT_ASSERT_EQUAL(std::string("62 F1 90"), match(matcher, {0x22, 0xF1, 0x90}));
+    CPPUNIT_ASSERT_EQUAL(std::string("62 30 98"), match(matcher, {0x22, 0x30, 0x98}));
+    CPPUNIT_ASSERT_EQUAL(std::string("51 01"), match(matcher, {0x11, 0x01}));
+
+    // too short, too long or unknown requests don't match
+    CPPUNIT_ASSERT_EQUAL(std::string("<none>"), match(matcher, {0x22, 0xF1}));
+    CPPUNIT_ASSERT_EQUAL(std::string("<none>"), match(matcher, {0x11, 0x01, 0x00}));
+    CPPUNIT_ASSERT_EQUAL(std::string("<none>"), match(matcher, {0x10, 0x01}));
+    CPPUNIT_ASSERT_EQUAL(std::string("<none>"), match(matcher, {}));
+}
+
+void CompiledRequestMatcherTest::testPlaceholder()
+{
+    RequestTree tree(new RequestByteTreeNode<std::string>());
+    addRequest(tree, {"31", "XX", "12"}, "placeholder");
+    addRequest(tree, {"31", "01", "12"}, "exact");
+    addRequest(tree, {"31", "XX", "XX"}, "two placeholders");
+    CompiledRequestMatcher<std::string> matcher(tree);
+
+    // fewer placeholders win
+    CPPUNIT_ASSERT_EQUAL(std::string("exact"), match(matcher, {0x31, 0x01, 0x12}));
+    CPPUNIT_ASSERT_EQUAL(std::string("placeholder"), match(matcher, {0x31, 0x02, 0x12}));
+    CPPUNIT_ASSERT_EQUAL(std::string("two placeholders"), match(matcher, {0x31, 0x02, 0x13}));
+}
+
+void CompiledRequestMatcherTest::testWildcard()
+{
+    RequestTree tree(new RequestByteTreeNode<std::string>());
+    addRequest(tree, {"36", "XX", "*"}, "transfer");
+    addRequest(tree, {"36", "01", "02", "*"}, "longer wildcard");
+    addRequest(tree, {"36", "01", "02"}, "exact");
+    CompiledRequestMatcher<std::string> matcher(tree);
+
+    // a wildcard matches 0 bytes ...
+    CPPUNIT_ASSERT_EQUAL(std::string("transfer"), match(matcher, {0x36, 0x05}));
+    // ... and any number of bytes
+    CPPUNIT_ASSERT_EQUAL(std::string("transfer"), match(matcher, {0x36, 0x05, 0x01, 0x02, 0x03}));
+    // requests without wildcard win
+    CPPUNIT_ASSERT_EQUAL(std::string("exact"), match(matcher, {0x36, 0x01, 0x02}));
+    // among wildcard requests the longer one wins
+    CPPUNIT_ASSERT_EQUAL(std::string("longer wildcard"), match(matcher, {0x36, 0x01, 0x02, 0xFF}));
+    CPPUNIT_ASSERT_EQUAL(std::string("<none>"), match(matcher, {0x36}));
+}
+
+void CompiledRequestMatcherTest::testDefinitionOrder()
+{
+    // equal length and number of placeholders, the request added first wins
+    RequestTree tree(new RequestByteTreeNode<std::string>());
+    addRequest(tree, {"22", "XX", "90"}, "first");
+    addRequest(tree, {"22", "F1", "XX"}, "second");
+    addRequest(tree, {"2E", "*"}, "wildcard");
+    CompiledRequestMatcher<std::string> matcher(tree);
+    CPPUNIT_ASSERT_EQUAL(std::string("first"), match(matcher, {0x22, 0xF1, 0x90}));
+
+    RequestTree reversedTree(new RequestByteTreeNode<std::string>());
+    addRequest(reversedTree, {"22", "F1", "XX"}, "second");
+    addRequest(reversedTree, {"22", "XX", "90"}, "first");
+    CompiledRequestMatcher<std::string> reversedMatcher(reversedTree);
+    CPPUNIT_ASSERT_EQUAL(std::string("second"), match(reversedMatcher, {0x22, 0xF1, 0x90}));
+
+    // the response of a wildcard matching 0 bytes is reported as wildcard
+    bool isWildcard = false;
+    const std::string *response = matcher.match(std::vector<uint8_t>{0x2E}.data(), 1, &isWildcard);
+    CPPUNIT_ASSERT(response != nullptr);
+    CPPUNIT_ASSERT_EQUAL(std::string("wildcard"), *response);
+    CPPUNIT_ASSERT_EQUAL(true, isWildcard);
+    matcher.match(std::vector<uint8_t>{0x22, 0xF1, 0x90}.data(), 3, &isWildcard);
+    CPPUNIT_ASSERT_EQUAL(false, isWildcard);
+}
+
+void CompiledRequestMatcherTest::testMatchRequests()
+{
+    RequestTree tree(new RequestByteTreeNode<std::string>());
+    addRequest(tree, {"22", "XX", "90"}, "first");
+    addRequest(tree, {"22", "F1", "XX"}, "second");
+    addRequest(tree, {"22", "F1", "86"}, "exact");
+    addRequest(tree, {"31", "*"}, "wildcard");
+    CompiledRequestMatcher<std::string> matcher(tree);
+
+    std::vector<std::vector<uint8_t>> requests;
+    for (unsigned int i = 0; i < 1000; i++)
+    {
+        requests.push_back({0x22, 0xF1, 0x90});
+        requests.push_back({0x22, 0xF1, 0x86});
+        requests.push_back({0x31, uint8_t(i)});
+        requests.push_back({0x10, 0x01});
+    }
+    ThreadPool threadPool(4);
+    const auto results = matcher.matchRequests(requests, threadPool);
+
+    CPPUNIT_ASSERT_EQUAL(requests.size(), results.size());
+    for (size_t i = 0; i < results.size(); i += 4)
+    {
+        // the placeholder requests tie, only their definition order decides
+        CPPUNIT_ASSERT_EQUAL(std::string("first"), *results[i].response);
+        CPPUNIT_ASSERT_EQUAL(true, results[i].isAmbiguous);
+        CPPUNIT_ASSERT_EQUAL(std::string("first"), matcher.getLeaf(results[i].rank));
+        // the exact request wins without a tie
+        CPPUNIT_ASSERT_EQUAL(std::string("exact"), *results[i + 1].response);
+        CPPUNIT_ASSERT_EQUAL(false, results[i + 1].isAmbiguous);
+        CPPUNIT_ASSERT_EQUAL(std::string("wildcard"), *results[i + 2].response);
+        CPPUNIT_ASSERT_EQUAL(true, results[i + 2].isWildcard);
+        CPPUNIT_ASSERT(results[i + 3].response == nullptr);
+    }
+}
+
+void CompiledRequestMatcherTest::testDenseNode()
+{
+    // more than 16 subsequent bytes at the root, so the dense table is used
+    RequestTree tree(new RequestByteTreeNode<std::string>());
+    for (unsigned int sid = 0x00; sid <= 0xFF; sid += 3)
+    {
+        tree->appendByte(uint8_t(sid))->appendByte(0x01)->setLuaResponse(std::to_string(sid));
+    }
+    CompiledRequestMatcher<std::string> matcher(tree);
+
+    CPPUNIT_ASSERT_EQUAL(size_t(86), matcher.getLeafCount());
+    for (unsigned int sid = 0x00; sid <= 0xFF; sid++)
+    {
+        const std::string expected = (sid % 3 == 0) ? std::to_string(sid) : "<none>";
+        CPPUNIT_ASSERT_EQUAL(expected, match(matcher, {uint8_t(sid), 0x01}));
+    }
+}
+
+void CompiledRequestMatcherTest::testEmptyMatcher()
+{
+    CompiledRequestMatcher<std::string> matcher;
+    CPPUNIT_ASSERT_EQUAL(true, matcher.empty());
+    CPPUNIT_ASSERT_EQUAL(std::string("<none>"), match(matcher, {0x22, 0xF1, 0x90}));
+
+    CompiledRequestMatcher<std::string> emptyTreeMatcher(RequestTree(new RequestByteTreeNode<std::string>()));
+    CPPUNIT_ASSERT_EQUAL(true, emptyTreeMatcher.empty());
+    CPPUNIT_ASSERT_EQUAL(std::string("<none>"), match(emptyTreeMatcher, {}));
+}
+
+void CompiledRequestMatcherTest::testTreeBuilder()
+{
+    RequestTree tree(new RequestByteTreeNode<std::string>());
+    auto node = tree->appendByte(0x22);
+    CPPUNIT_ASSERT(node == tree->appendByte(0x22));
+    CPPUNIT_ASSERT(node->appendPlaceholder() == node->appendPlaceholder());
+    tree->appendByte(0xF1);
+    tree->appendByte(0x10);
+    CPPUNIT_ASSERT(node == tree->getSubsequentByte(0x22));
+    CPPUNIT_ASSERT(tree->getSubsequentByte(0x23) == nullptr);
+
+    // the edges are kept sorted by the byte
+    const auto &subsequentBytes = tree->getSubsequentBytes();
+    CPPUNIT_ASSERT_EQUAL(size_t(3), subsequentBytes.size());
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x10), subsequentBytes[0].first);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x22), subsequentBytes[1].first);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0xF1), subsequentBytes[2].first);
+
+    CPPUNIT_ASSERT_EQUAL(2, node->appendPlaceholder()->getRequestLength());
+    CPPUNIT_ASSERT_EQUAL(1, node->appendPlaceholder()->getPlaceholderCount());
+    CPPUNIT_ASSERT_EQUAL(true, node->appendWildcard()->isWildcard());
+    CPPUNIT_ASSERT_THROW(node->appendWildcard(), std::exception);
+}
+
+void CompiledRequestMatcherTest::testBytePatterns()
+{
+    RequestTree tree(new RequestByteTreeNode<std::string>());
+    addRequest(tree, {"31", "XX", "12"}, "placeholder");
+    addRequest(tree, {"31", "0X", "12"}, "high nibble");
+    addRequest(tree, {"31", "01", "12"}, "exact");
+    addRequest(tree, {"22", "X3"}, "low nibble");
+    addRequest(tree, {"22", "[F1-F3]"}, "range");
+    CompiledRequestMatcher<std::string> matcher(tree);
+
+    // bytes win over patterns, patterns over placeholders
+    CPPUNIT_ASSERT_EQUAL(std::string("exact"), match(matcher, {0x31, 0x01, 0x12}));
+    CPPUNIT_ASSERT_EQUAL(std::string("high nibble"), match(matcher, {0x31, 0x0F, 0x12}));
+    CPPUNIT_ASSERT_EQUAL(std::string("placeholder"), match(matcher, {0x31, 0x10, 0x12}));
+
+    CPPUNIT_ASSERT_EQUAL(std::string("low nibble"), match(matcher, {0x22, 0x03}));
+    CPPUNIT_ASSERT_EQUAL(std::string("low nibble"), match(matcher, {0x22, 0xA3}));
+    CPPUNIT_ASSERT_EQUAL(std::string("<none>"), match(matcher, {0x22, 0x04}));
+    CPPUNIT_ASSERT_EQUAL(std::string("range"), match(matcher, {0x22, 0xF1}));
+    CPPUNIT_ASSERT_EQUAL(std::string("range"), match(matcher, {0x22, 0xF2}));
+    CPPUNIT_ASSERT_EQUAL(std::string("<none>"), match(matcher, {0x22, 0xF4}));
+    CPPUNIT_ASSERT_EQUAL(std::string("<none>"), match(matcher, {0x22, 0xF0}));
+    // both patterns match, the one defined first wins
+    CPPUNIT_ASSERT_EQUAL(std::string("low nibble"), match(matcher, {0x22, 0xF3}));
+    CPPUNIT_ASSERT_EQUAL(true, matcher.matchRequest(std::vector<uint8_t>{0x22, 0xF3}.data(), 2).isAmbiguous);
+}
+
+void CompiledRequestMatcherTest::testManyBytePatterns()
+{
+    // more patterns than fit into one block, all matching the same byte
+    RequestTree tree(new RequestByteTreeNode<std::string>());
+    for (int i = 0; i < 40; i++)
+    {
+        char range[] = "[00-00]";
+        snprintf(range, sizeof(range), "[%02X-%02X]", i, 0x80 + i);
+        addRequest(tree, {"2E", range, std::to_string(i)}, range);
+    }
+    CompiledRequestMatcher<std::string> matcher(tree);
+
+    CPPUNIT_ASSERT_EQUAL(std::string("[00-80]"), match(matcher, {0x2E, 0x50, 0x00}));
+    CPPUNIT_ASSERT_EQUAL(std::string("[14-94]"), match(matcher, {0x2E, 0x50, 0x20}));
+    CPPUNIT_ASSERT_EQUAL(std::string("[27-A7]"), match(matcher, {0x2E, 0x50, 0x39}));
+    CPPUNIT_ASSERT_EQUAL(std::string("<none>"), match(matcher, {0x2E, 0x10, 0x39}));
+    CPPUNIT_ASSERT_EQUAL(std::string("<none>"), match(matcher, {0x2E, 0xA8, 0x39}));
+}
+
+void CompiledRequestMatcherTest::testHitCounters()
+{
+    RequestTree tree(new RequestByteTreeNode<std::string>());
+    addRequest(tree, {"22", "F1", "90"}, "62 F1 90");
+    addRequest(tree, {"22", "F1", "XX"}, "62 F1 XX");
+    addRequest(tree, {"11", "01"}, "51 01");
+    CompiledRequestMatcher<std::string> matcher(tree);
+    const auto &pHits = matcher.getHitCounters();
+    CPPUNIT_ASSERT_EQUAL(size_t(3), pHits->size());
+
+    match(matcher, {0x22, 0xF1, 0x90});
+    match(matcher, {0x22, 0xF1, 0x90});
+    match(matcher, {0x22, 0xF1, 0x91});
+    match(matcher, {0x10, 0x01});
+    // only the best match counts, copies share the counters
+    const CompiledRequestMatcher<std::string> copy = matcher;
+    match(copy, {0x22, 0xF1, 0x90});
+    for (size_t rank = 0; rank < matcher.getLeafCount(); rank++)
+    {
+        const std::string &leaf = matcher.getLeaf(rank);
+        const uint64_t expected = leaf == "62 F1 90" ? 3 : (leaf == "62 F1 XX" ? 1 : 0);
+        CPPUNIT_ASSERT_EQUAL(expected, pHits->get(rank));
+    }
+    CPPUNIT_ASSERT(copy.getHitCounters() == pHits);
+}
+
+void CompiledRequestMatcherTest::testRelayout()
+{
+    // a dense root, placeholders, patterns and wildcards
+    RequestTree tree(new RequestByteTreeNode<std::string>());
+    for (unsigned int sid = 0x00; sid <= 0xFF; sid += 5)
+    {
+        tree->appendByte(uint8_t(sid))->appendByte(0x01)->setLuaResponse(std::to_string(sid));
+    }
+    addRequest(tree, {"22", "F1", "90"}, "62 F1 90");
+    addRequest(tree, {"22", "F1", "XX"}, "62 F1 XX");
+    addRequest(tree, {"22", "[10-1F]", "*"}, "range");
+    addRequest(tree, {"31", "01", "*"}, "routine");
+    addRequest(tree, {"2E", "0X", "12"}, "nibble");
+    CompiledRequestMatcher<std::string> matcher(tree);
+
+    std::vector<std::vector<uint8_t>> requests;
+    for (unsigned int sid = 0x00; sid <= 0xFF; sid++)
+    {
+        requests.push_back({uint8_t(sid), 0x01});
+    }
+    requests.insert(requests.end(), {{0x22, 0xF1, 0x90}, {0x22, 0xF1, 0x91}, {0x22, 0x12}, {0x22, 0x12, 0x00, 0x01},
+                                     {0x31, 0x01}, {0x31, 0x01, 0xFF}, {0x2E, 0x05, 0x12}, {0x2E, 0x15, 0x12}});
+    std::vector<std::string> expected;
+    uint64_t expectedHits = 0;
+    for (const auto &request : requests)
+    {
+        expected.push_back(match(matcher, request));
+        expectedHits += expected.back() == "<none>" ? 0 : 2;
+    }
+    match(matcher, {0x31, 0x01, 0x02});
+    match(matcher, {0x2E, 0x0A, 0x12});
+    match(matcher, {0x2E, 0x0A, 0x12});
+
+    const size_t nodeCount = matcher.getNodeCount();
+    matcher.relayout();
+    CPPUNIT_ASSERT_EQUAL(nodeCount, matcher.getNodeCount());
+    for (size_t i = 0; i < requests.size(); i++)
+    {
+        CPPUNIT_ASSERT_EQUAL(expected[i], match(matcher, requests[i]));
+    }
+    // the hits are kept
+    uint64_t hits = 0;
+    for (size_t rank = 0; rank < matcher.getLeafCount(); rank++)
+    {
+        hits += matcher.getHitCounters()->get(rank);
+    }
+    CPPUNIT_ASSERT_EQUAL(expectedHits + 3, hits);
+}
+
+void CompiledRequestMatcherTest::testWithLeaves()
+{
+    RequestTree tree(new RequestByteTreeNode<std::string>());
+    addRequest(tree, {"22", "F1", "90"}, "62 F1 90");
+    addRequest(tree, {"22", "F1", "XX"}, "62 F1 XX");
+    addRequest(tree, {"11", "01"}, "51 01");
+    const CompiledRequestMatcher<std::string> matcher(tree);
+    match(matcher, {0x11, 0x01});
+
+    std::vector<std::string> leaves;
+    for (size_t rank = 0; rank < matcher.getLeafCount(); rank++)
+    {
+        leaves.push_back("new " + matcher.getLeaf(rank));
+    }
+    const CompiledRequestMatcher<std::string> reloaded = matcher.withLeaves(leaves);
+    CPPUNIT_ASSERT_EQUAL(matcher.getNodeCount(), reloaded.getNodeCount());
+    CPPUNIT_ASSERT_EQUAL(std::string("new 62 F1 90"), match(reloaded, {0x22, 0xF1, 0x90}));
+    CPPUNIT_ASSERT_EQUAL(std::string("new 62 F1 XX"), match(reloaded, {0x22, 0xF1, 0x91}));
+    CPPUNIT_ASSERT_EQUAL(std::string("new 51 01"), match(reloaded, {0x11, 0x01}));
+    CPPUNIT_ASSERT_EQUAL(std::string("<none>"), match(reloaded, {0x11, 0x02}));
+    // the original is unchanged and the new version counts its own hits
+    CPPUNIT_ASSERT_EQUAL(std::string("51 01"), match(matcher, {0x11, 0x01}));
+    CPPUNIT_ASSERT(reloaded.getHitCounters() != matcher.getHitCounters());
+    uint64_t hits = 0;
+    for (size_t rank = 0; rank < reloaded.getLeafCount(); rank++)
+    {
+        hits += reloaded.getHitCounters()->get(rank);
+    }
+    CPPUNIT_ASSERT_EQUAL(uint64_t(3), hits);
+}
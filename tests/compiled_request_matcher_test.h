@@ -0,0 +1,55 @@
+/**
+ * @file compiled_request_matcher_test.h
+ *
+ */
+
+#ifndef COMPILED_REQUEST_MATCHER_TEST_H
+#define COMPILED_REQUEST_MATCHER_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class CompiledRequestMatcherTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(CompiledRequestMatcherTest);
+
+    CPPUNIT_TEST(testExactMatch);
+    CPPUNIT_TEST(testPlaceholder);
+    CPPUNIT_TEST(testWildcard);
+    CPPUNIT_TEST(testDefinitionOrder);
+    CPPUNIT_TEST(testMatchRequests);
+    CPPUNIT_TEST(testDenseNode);
+    CPPUNIT_TEST(testEmptyMatcher);
+    CPPUNIT_TEST(testTreeBuilder);
+    CPPUNIT_TEST(testBytePatterns);
+    CPPUNIT_TEST(testManyBytePatterns);
+    CPPUNIT_TEST(testHitCounters);
+    CPPUNIT_TEST(testRelayout);
+    CPPUNIT_TEST(testWithLeaves);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    CompiledRequestMatcherTest() = default;
+    virtual ~CompiledRequestMatcherTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testExactMatch();
+    void testPlaceholder();
+    void testWildcard();
+    void testDefinitionOrder();
+    void testMatchRequests();
+    void testDenseNode();
+    void testEmptyMatcher();
+    void testTreeBuilder();
+    void testBytePatterns();
+    void testManyBytePatterns();
+    void testHitCounters();
+    void testRelayout();
+    void testWithLeaves();
+
+};
+
+#endif /* COMPILED_REQUEST_MATCHER_TEST_H */
+
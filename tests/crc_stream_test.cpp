@@ -0,0 +1,81 @@
+/**
+ * @file crc_stream_test.cpp
+ *
+ * Unit test for the incremental CRC calculation.
+ */
+
+#include "crc_stream_test.h"
+#include "crc_stream.h"
+#include "libcrc/checksum.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CrcStreamTest);
+
+static uint32_t calculate(CrcAlgorithm algorithm, const uint8_t* data, size_t length)
+{
+    CrcStream crc(algorithm);
+    crc.update(data, length);
+    return crc.getValue();
+}
+
+void CrcStreamTest::setUp() { }
+
+void CrcStreamTest::tearDown() { }
+
+void CrcStreamTest::testCheckValues()
+{
+    const string check = "123456789";
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(check.data());
+    CPPUNIT_ASSERT_EQUAL(uint32_t(0x29B1), calculate(CrcAlgorithm::CCITT_FFFF, data, check.size()));
+    CPPUNIT_ASSERT_EQUAL(uint32_t(0xE5CC), calculate(CrcAlgorithm::CCITT_1D0F, data, check.size()));
+    CPPUNIT_ASSERT_EQUAL(uint32_t(0x31C3), calculate(CrcAlgorithm::XMODEM, data, check.size()));
+    CPPUNIT_ASSERT_EQUAL(uint32_t(0xBB3D), calculate(CrcAlgorithm::CRC16, data, check.size()));
+    CPPUNIT_ASSERT_EQUAL(uint32_t(0x4B37), calculate(CrcAlgorithm::MODBUS, data, check.size()));
+    CPPUNIT_ASSERT_EQUAL(uint32_t(0xCBF43926), calculate(CrcAlgorithm::CRC32, data, check.size()));
+
+    // nothing added yet
+    CPPUNIT_ASSERT_EQUAL(uint32_t(0xFFFF), CrcStream().getValue());
+    CPPUNIT_ASSERT_EQUAL(uint32_t(0x00000000), CrcStream(CrcAlgorithm::CRC32).getValue());
+}
+
+void CrcStreamTest::testStreamMatchesOnePass()
+{
+    vector<uint8_t> data(3000);
+    uint32_t x = 1;
+    for (uint8_t& byte : data)
+    {
+        x = x * 1103515245 + 12345;
+        byte = uint8_t(x >> 16);
+    }
+
+    CrcStream ccitt(CrcAlgorithm::CCITT_FFFF);
+    CrcStream modbus(CrcAlgorithm::MODBUS);
+    CrcStream crc32(CrcAlgorithm::CRC32);
+    // blocks of 0 .. 12 bytes, i.e. with and without the 8 byte slices
+    size_t offset = 0;
+    for (size_t length = 0; offset + length <= data.size(); length = (length + 5) % 13)
+    {
+        ccitt.update(data.data() + offset, length);
+        modbus.update(data.data() + offset, length);
+        crc32.update(data.data() + offset, length);
+        offset += length;
+
+        CPPUNIT_ASSERT_EQUAL(uint32_t(crc_ccitt_ffff(data.data(), offset)), ccitt.getValue());
+        CPPUNIT_ASSERT_EQUAL(uint32_t(crc_modbus(data.data(), offset)), modbus.getValue());
+        CPPUNIT_ASSERT_EQUAL(crc_32(data.data(), offset), crc32.getValue());
+    }
+
+    crc32.reset();
+    CPPUNIT_ASSERT_EQUAL(uint32_t(0x00000000), crc32.getValue());
+}
+
+void CrcStreamTest::testParseAlgorithm()
+{
+    CPPUNIT_ASSERT(CrcStream::parseAlgorithm("ccitt_ffff") == CrcAlgorithm::CCITT_FFFF);
+    CPPUNIT_ASSERT(CrcStream::parseAlgorithm("crc32") == CrcAlgorithm::CRC32);
+    CPPUNIT_ASSERT(!CrcStream::parseAlgorithm("md5"));
+}
@@ -0,0 +1,34 @@
+/**
+ * @file crc_stream_test.h
+ *
+ */
+
+#ifndef CRC_STREAM_TEST_H
+#define CRC_STREAM_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class CrcStreamTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(CrcStreamTest);
+
+    CPPUNIT_TEST(testCheckValues);
+    CPPUNIT_TEST(testStreamMatchesOnePass);
+    CPPUNIT_TEST(testParseAlgorithm);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    CrcStreamTest() = default;
+    virtual ~CrcStreamTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testCheckValues();
+    void testStreamMatchesOnePass();
+    void testParseAlgorithm();
+
+};
+
+#endif /* CRC_STREAM_TEST_H */
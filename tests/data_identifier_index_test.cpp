@@ -0,0 +1,77 @@
+/**
+ * @file data_identifier_index_test.cpp
+ *
+ * Unit test for the binary `ReadDataByIdentifier` index.
+ */
+
+#include "data_identifier_index_test.h"
+#include "data_identifier_index.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DataIdentifierIndexTest);
+
+void DataIdentifierIndexTest::setUp() { }
+
+void DataIdentifierIndexTest::tearDown() { }
+
+void DataIdentifierIndexTest::testFind()
+{
+    DataIdentifierIndex index;
+    CPPUNIT_ASSERT_EQUAL(true, index.empty());
+    CPPUNIT_ASSERT(index.find(0xF190) == nullptr);
+
+    // insert unsorted
+    index.add(0xF190, false, "SALGA2EV9HA298784");
+    index.add(0x1E23, false, "231132");
+    index.add(0xF124, true, "F1 24");
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), index.size());
+
+    const DataIdentifierIndex::Entry *entry = index.find(0xF190);
+    CPPUNIT_ASSERT(entry != nullptr);
+    CPPUNIT_ASSERT_EQUAL(false, entry->isLuaFunction);
+    CPPUNIT_ASSERT_EQUAL(std::string("SALGA2EV9HA298784"), entry->data);
+
+    entry = index.find(0xF124);
+    CPPUNIT_ASSERT(entry != nullptr);
+    CPPUNIT_ASSERT_EQUAL(true, entry->isLuaFunction);
+    CPPUNIT_ASSERT_EQUAL(std::string("F1 24"), entry->data);
+
+    entry = index.find(0x1E23);
+    CPPUNIT_ASSERT(entry != nullptr);
+    CPPUNIT_ASSERT_EQUAL(std::string("231132"), entry->data);
+
+    CPPUNIT_ASSERT(index.find(0x0000) == nullptr);
+    CPPUNIT_ASSERT(index.find(0xF191) == nullptr);
+    CPPUNIT_ASSERT(index.find(0xFFFF) == nullptr);
+}
+
+void DataIdentifierIndexTest::testReplace()
+{
+    DataIdentifierIndex index;
+    index.add(0xF190, false, "old");
+    index.add(0xF190, true, "F1 90");
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), index.size());
+
+    const DataIdentifierIndex::Entry *entry = index.find(0xF190);
+    CPPUNIT_ASSERT(entry != nullptr);
+    CPPUNIT_ASSERT_EQUAL(true, entry->isLuaFunction);
+    CPPUNIT_ASSERT_EQUAL(std::string("F1 90"), entry->data);
+}
+
+void DataIdentifierIndexTest::testHitCounters()
+{
+    DataIdentifierIndex index;
+    index.add(0xF190, false, "SALGA2EV9HA298784");
+    index.add(0x1E23, false, "231132");
+    index.find(0xF190);
+    CPPUNIT_ASSERT(index.getHitCounters() == nullptr);
+
+    // counted by the position of the entry once enabled
+    index.countHits();
+    index.find(0xF190);
+    index.find(0xF190);
+    index.find(0xF191);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), index.getHitCounters()->size());
+    CPPUNIT_ASSERT_EQUAL(std::uint16_t(0x1E23), index.getEntries()[0].identifier);
+    CPPUNIT_ASSERT_EQUAL(std::uint64_t(0), index.getHitCounters()->get(0));
+    CPPUNIT_ASSERT_EQUAL(std::uint64_t(2), index.getHitCounters()->get(1));
+}
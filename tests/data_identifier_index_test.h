@@ -0,0 +1,35 @@
+/**
+ * @file data_identifier_index_test.h
+ *
+ */
+
+#ifndef DATA_IDENTIFIER_INDEX_TEST_H
+#define DATA_IDENTIFIER_INDEX_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class DataIdentifierIndexTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(DataIdentifierIndexTest);
+
+    CPPUNIT_TEST(testFind);
+    CPPUNIT_TEST(testReplace);
+    CPPUNIT_TEST(testHitCounters);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    DataIdentifierIndexTest() = default;
+    virtual ~DataIdentifierIndexTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testFind();
+    void testReplace();
+    void testHitCounters();
+
+};
+
+#endif /* DATA_IDENTIFIER_INDEX_TEST_H */
+
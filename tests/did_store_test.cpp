@@ -0,0 +1,172 @@
+/**
+ * @file did_store_test.cpp
+ *
+ * Unit test for the values written by `WriteDataByIdentifier`.
+ */
+
+#include "did_store_test.h"
+#include "did_store.h"
+#include "session_controller.h"
+#include <unistd.h>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DidStoreTest);
+
+static void write(DidStore& store, uint8_t session, uint16_t identifier, const vector<uint8_t>& value)
+{
+    store.write(session, identifier, value.data(), value.size());
+}
+
+static vector<uint8_t> read(const DidStore& store, uint8_t session, uint16_t identifier)
+{
+    vector<uint8_t> value;
+    CPPUNIT_ASSERT(store.read(session, identifier, value));
+    return value;
+}
+
+void DidStoreTest::setUp()
+{
+    storeFile_ = "/tmp/did_store_test_" + to_string(getpid()) + ".dids";
+}
+
+void DidStoreTest::tearDown()
+{
+    remove(storeFile_.c_str());
+}
+
+void DidStoreTest::testSessions()
+{
+    DidStore store;
+    vector<uint8_t> value;
+    CPPUNIT_ASSERT(!store.read(UdsSession::DEFAULT, 0xF190, value));
+
+    // the default session is visible in all sessions
+    write(store, UdsSession::DEFAULT, 0xF190, {0x01, 0x02});
+    CPPUNIT_ASSERT(read(store, UdsSession::EXTENDED, 0xF190) == vector<uint8_t>({0x01, 0x02}));
+
+    // until the session has its own value
+    write(store, UdsSession::EXTENDED, 0xF190, {0x03});
+    CPPUNIT_ASSERT(read(store, UdsSession::EXTENDED, 0xF190) == vector<uint8_t>({0x03}));
+    CPPUNIT_ASSERT(read(store, UdsSession::DEFAULT, 0xF190) == vector<uint8_t>({0x01, 0x02}));
+    CPPUNIT_ASSERT(read(store, UdsSession::PROGRAMMING, 0xF190) == vector<uint8_t>({0x01, 0x02}));
+
+    // a value of another session is not visible in the default session
+    write(store, UdsSession::EXTENDED, 0x1234, {0x04});
+    CPPUNIT_ASSERT(!store.read(UdsSession::DEFAULT, 0x1234, value));
+    CPPUNIT_ASSERT_EQUAL(size_t(3), store.size());
+
+    vector<uint8_t> response = {0x62};
+    CPPUNIT_ASSERT(store.appendRecord(UdsSession::EXTENDED, 0x1234, response));
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x62, 0x12, 0x34, 0x04}));
+    CPPUNIT_ASSERT(!store.appendRecord(UdsSession::DEFAULT, 0x1234, response));
+    CPPUNIT_ASSERT_EQUAL(size_t(4), response.size());
+}
+
+void DidStoreTest::testReset()
+{
+    DidStore store;
+    write(store, UdsSession::DEFAULT, 0xF190, {0x01});
+    store.reset();
+    CPPUNIT_ASSERT_EQUAL(size_t(0), store.size());
+
+    // the values of a persistent store survive a reset
+    DidStore persistentStore;
+    CPPUNIT_ASSERT_EQUAL(0, persistentStore.open(storeFile_));
+    write(persistentStore, UdsSession::DEFAULT, 0xF190, {0x02});
+    persistentStore.reset();
+    CPPUNIT_ASSERT(read(persistentStore, UdsSession::DEFAULT, 0xF190) == vector<uint8_t>({0x02}));
+}
+
+void DidStoreTest::testSerialize()
+{
+    DidStore store;
+    write(store, UdsSession::DEFAULT, 0xF190, {0x01, 0x02});
+    write(store, UdsSession::EXTENDED, 0xF190, vector<uint8_t>(100, 0xAB));
+    string data;
+    store.serialize(data);
+
+    // the values are replaced, also in the file of a persistent store
+    DidStore restored;
+    CPPUNIT_ASSERT_EQUAL(0, restored.open(storeFile_));
+    write(restored, UdsSession::DEFAULT, 0x0100, {0x03});
+    CPPUNIT_ASSERT(restored.deserialize(data));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), restored.size());
+    CPPUNIT_ASSERT(read(restored, UdsSession::DEFAULT, 0xF190) == vector<uint8_t>({0x01, 0x02}));
+    CPPUNIT_ASSERT(read(restored, UdsSession::EXTENDED, 0xF190) == vector<uint8_t>(100, 0xAB));
+    restored.close();
+    DidStore reopened;
+    CPPUNIT_ASSERT_EQUAL(0, reopened.open(storeFile_));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), reopened.size());
+
+    CPPUNIT_ASSERT(!restored.deserialize(string_view(data).substr(0, 2)));
+}
+
+void DidStoreTest::testLongValues()
+{
+    DidStore store;
+    const vector<uint8_t> longValue(100, 0xAB);
+    write(store, UdsSession::DEFAULT, 0x0100, longValue);
+    CPPUNIT_ASSERT(read(store, UdsSession::DEFAULT, 0x0100) == longValue);
+
+    // back to the inline storage
+    const vector<uint8_t> shortValue(DidValue::INLINE_CAPACITY, 0xCD);
+    write(store, UdsSession::DEFAULT, 0x0100, shortValue);
+    CPPUNIT_ASSERT(read(store, UdsSession::DEFAULT, 0x0100) == shortValue);
+
+    write(store, UdsSession::DEFAULT, 0x0100, {});
+    CPPUNIT_ASSERT(read(store, UdsSession::DEFAULT, 0x0100).empty());
+}
+
+void DidStoreTest::testPersistence()
+{
+    {
+        DidStore store;
+        CPPUNIT_ASSERT_EQUAL(0, store.open(storeFile_));
+        CPPUNIT_ASSERT(store.isPersistent());
+        write(store, UdsSession::DEFAULT, 0xF190, {'V', 'I', 'N'});
+        write(store, UdsSession::EXTENDED, 0xF190, vector<uint8_t>(40, 0x11));
+        write(store, UdsSession::DEFAULT, 0xF190, {'N', 'E', 'W'});
+    }
+
+    DidStore store;
+    CPPUNIT_ASSERT_EQUAL(0, store.open(storeFile_));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), store.size());
+    CPPUNIT_ASSERT(read(store, UdsSession::DEFAULT, 0xF190) == vector<uint8_t>({'N', 'E', 'W'}));
+    CPPUNIT_ASSERT(read(store, UdsSession::EXTENDED, 0xF190) == vector<uint8_t>(40, 0x11));
+
+    // not a DID store file
+    FILE* pFile = fopen(storeFile_.c_str(), "r+");
+    fputs("garbage", pFile);
+    fclose(pFile);
+    store.close();
+    DidStore other;
+    CPPUNIT_ASSERT(other.open(storeFile_) < 0);
+    CPPUNIT_ASSERT(!other.isPersistent());
+}
+
+void DidStoreTest::testCompaction()
+{
+    const vector<uint8_t> value(100, 0x22);
+    {
+        DidStore store;
+        CPPUNIT_ASSERT_EQUAL(0, store.open(storeFile_, 4096));
+        // far more writes than fit into the file
+        for (unsigned i = 0; i < 1000; ++i)
+        {
+            write(store, UdsSession::DEFAULT, 0x0200, {uint8_t(i), uint8_t(i >> 8)});
+            write(store, UdsSession::DEFAULT, 0x0201, value);
+        }
+    }
+
+    DidStore store;
+    CPPUNIT_ASSERT_EQUAL(0, store.open(storeFile_));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), store.size());
+    CPPUNIT_ASSERT(read(store, UdsSession::DEFAULT, 0x0200) == vector<uint8_t>({uint8_t(999), uint8_t(999 >> 8)}));
+    CPPUNIT_ASSERT(read(store, UdsSession::DEFAULT, 0x0201) == value);
+}
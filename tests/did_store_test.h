@@ -0,0 +1,43 @@
+/**
+ * @file did_store_test.h
+ *
+ */
+
+#ifndef DID_STORE_TEST_H
+#define DID_STORE_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+class DidStoreTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(DidStoreTest);
+
+    CPPUNIT_TEST(testSessions);
+    CPPUNIT_TEST(testReset);
+    CPPUNIT_TEST(testSerialize);
+    CPPUNIT_TEST(testLongValues);
+    CPPUNIT_TEST(testPersistence);
+    CPPUNIT_TEST(testCompaction);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    DidStoreTest() = default;
+    virtual ~DidStoreTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    std::string storeFile_;
+
+    void testSessions();
+    void testReset();
+    void testSerialize();
+    void testLongValues();
+    void testPersistence();
+    void testCompaction();
+
+};
+
+#endif /* DID_STORE_TEST_H */
@@ -0,0 +1,28 @@
+-- An ECU on CAN and DoIP, see `ServiceDispatcherTest`.
+Main = {
+    RequestId = 0x100,
+    ResponseId = 0x200,
+    DoIPLogicalEcuAddress = 0x0010,
+
+    Sessions = {
+        [0x60] = { p2 = 25, p2Star = 2000, services = { 0x10, 0x22, 0x3E } },
+    },
+
+    ReadDataByIdentifier = {
+        ["F1 90"] = "SALGA2EV9HA298784",
+        ["F1 86"] = "01",
+    },
+
+    Raw = {
+        ["22 F1 91"] = "62 F1 91 01",
+    },
+
+    Extended = {
+        Raw = {
+            ["31 01 FF 00"] = "71 01 FF 00",
+        },
+        ReadDataByIdentifier = {
+            ["F1 86"] = "03",
+        },
+    },
+}
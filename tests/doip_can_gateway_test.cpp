@@ -0,0 +1,247 @@
+/**
+ * @file doip_can_gateway_test.cpp
+ *
+ * Unit test for the DoIP gateway to real ECUs. The real ECU is an ISO-TP
+ * receiver/sender pair with the CAN IDs of the route swapped, the testers
+ * are the relayed responses collected by their address. Like the other CAN
+ * tests, this needs the virtual CAN interface `vcan0`.
+ */
+
+#include "doip_can_gateway_test.h"
+#include "doip_can_gateway.h"
+#include "receiver_reactor.h"
+#include "service_identifier.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <sys/epoll.h>
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DoIPCanGatewayTest);
+
+namespace
+{
+
+constexpr uint16_t LOGICAL_ADDRESS = 0x0E10;
+constexpr uint16_t TESTER_A = 0x0E00;
+constexpr uint16_t TESTER_B = 0x0E01;
+const chrono::milliseconds WAIT_TIMEOUT(1000);
+
+DoipGatewayRoute createRoute()
+{
+    DoipGatewayRoute route;
+    route.logicalAddress = LOGICAL_ADDRESS;
+    route.requestId = 0x7E0;
+    route.responseId = 0x7E8;
+    route.interface = "vcan0";
+    return route;
+}
+
+/// messages of one direction, waited for by the test
+class MessageQueue
+{
+public:
+    struct Message
+    {
+        uint16_t address; ///< the tester of a response
+        vector<uint8_t> data;
+    };
+
+    void push(uint16_t address, const uint8_t* data, size_t length)
+    {
+        lock_guard<mutex> lock(mutex_);
+        messages_.push_back({address, vector<uint8_t>(data, data + length)});
+        condition_.notify_all();
+    }
+
+    /// @return false if less than `count` messages arrived in time
+    bool waitFor(size_t count)
+    {
+        unique_lock<mutex> lock(mutex_);
+        return condition_.wait_for(lock, WAIT_TIMEOUT, [this, count]() { return messages_.size() >= count; });
+    }
+
+    vector<Message> get()
+    {
+        lock_guard<mutex> lock(mutex_);
+        return messages_;
+    }
+
+private:
+    mutex mutex_;
+    condition_variable condition_;
+    vector<Message> messages_;
+};
+
+/// the real ECU behind the gateway, answers on request of the test
+class FakeEcu : public IsoTpReceiver
+{
+public:
+    explicit FakeEcu(const DoipGatewayRoute& route)
+    : IsoTpReceiver(route.responseId, route.requestId, route.interface)
+    , sender_(route.responseId, route.requestId, route.interface)
+    {
+    }
+
+    void respond(const vector<uint8_t>& response)
+    {
+        sender_.sendData(response.data(), response.size());
+    }
+
+    MessageQueue requests;
+
+protected:
+    void proceedReceivedData(const uint8_t* buffer, const size_t num_bytes) noexcept override
+    {
+        requests.push(0, buffer, num_bytes);
+    }
+
+private:
+    IsoTpSender sender_;
+};
+
+/// a gateway with its real ECU, both handled by one reactor
+struct GatewayFixture
+{
+    explicit GatewayFixture(chrono::milliseconds responseTimeout = GATEWAY_RESPONSE_TIMEOUT)
+    : ecu(createRoute())
+    {
+        reactor.start(1);
+        reactor.addHandler(&ecu, EPOLLIN);
+        pGateway = make_unique<DoIPCanGateway>(createRoute(), &reactor,
+            [this](uint16_t logicalAddress, uint16_t testerAddress, const uint8_t* data, size_t length) {
+                if (logicalAddress == LOGICAL_ADDRESS)
+                {
+                    responses.push(testerAddress, data, length);
+                }
+            }, responseTimeout);
+    }
+
+    ~GatewayFixture()
+    {
+        pGateway.reset();
+        reactor.removeHandler(&ecu);
+        reactor.stop();
+        reactor.waitForStop();
+    }
+
+    DoIPCanGateway::Forwarded forward(uint16_t testerAddress, const vector<uint8_t>& request)
+    {
+        return pGateway->forward(testerAddress, request.data(), request.size());
+    }
+
+    ReceiverReactor reactor;
+    FakeEcu ecu;
+    MessageQueue responses;
+    unique_ptr<DoIPCanGateway> pGateway;
+};
+
+}
+
+void DoIPCanGatewayTest::setUp()
+{
+}
+
+void DoIPCanGatewayTest::tearDown()
+{
+}
+
+/**
+ * The response goes to the tester of the request, also if another tester
+ * sent the request before.
+ */
+void DoIPCanGatewayTest::testRelayToTester()
+{
+    GatewayFixture fixture;
+    const vector<uint8_t> request = {READ_DATA_BY_IDENTIFIER_REQ, 0xF1, 0x90};
+    const vector<uint8_t> response = {READ_DATA_BY_IDENTIFIER_RES, 0xF1, 0x90, 0x01};
+
+    CPPUNIT_ASSERT(fixture.forward(TESTER_A, request) == DoIPCanGateway::Forwarded::SENT);
+    CPPUNIT_ASSERT(fixture.ecu.requests.waitFor(1));
+    CPPUNIT_ASSERT(request == fixture.ecu.requests.get()[0].data);
+    fixture.ecu.respond(response);
+    CPPUNIT_ASSERT(fixture.responses.waitFor(1));
+
+    CPPUNIT_ASSERT(fixture.forward(TESTER_B, request) == DoIPCanGateway::Forwarded::SENT);
+    CPPUNIT_ASSERT(fixture.ecu.requests.waitFor(2));
+    fixture.ecu.respond(response);
+    CPPUNIT_ASSERT(fixture.responses.waitFor(2));
+
+    const vector<MessageQueue::Message> responses = fixture.responses.get();
+    CPPUNIT_ASSERT_EQUAL(TESTER_A, responses[0].address);
+    CPPUNIT_ASSERT(response == responses[0].data);
+    CPPUNIT_ASSERT_EQUAL(TESTER_B, responses[1].address);
+    CPPUNIT_ASSERT(response == responses[1].data);
+}
+
+/**
+ * While the request of one tester is outstanding, the request of another
+ * tester is not forwarded, so the response can not go to the wrong tester.
+ */
+void DoIPCanGatewayTest::testConcurrentTesters()
+{
+    GatewayFixture fixture;
+    const vector<uint8_t> requestA = {ROUTINE_CONTROL_REQ, 0x01, 0xFF, 0x00};
+    const vector<uint8_t> requestB = {READ_DATA_BY_IDENTIFIER_REQ, 0xF1, 0x86};
+
+    CPPUNIT_ASSERT(fixture.forward(TESTER_A, requestA) == DoIPCanGateway::Forwarded::SENT);
+    CPPUNIT_ASSERT(fixture.ecu.requests.waitFor(1));
+    CPPUNIT_ASSERT(fixture.forward(TESTER_B, requestB) == DoIPCanGateway::Forwarded::BUSY);
+
+    // "response pending" does not complete the request
+    fixture.ecu.respond({ERROR, ROUTINE_CONTROL_REQ, RESPONSE_PENDING});
+    CPPUNIT_ASSERT(fixture.responses.waitFor(1));
+    CPPUNIT_ASSERT(fixture.forward(TESTER_B, requestB) == DoIPCanGateway::Forwarded::BUSY);
+
+    fixture.ecu.respond({ROUTINE_CONTROL_RES, 0x01, 0xFF, 0x00});
+    CPPUNIT_ASSERT(fixture.responses.waitFor(2));
+    CPPUNIT_ASSERT(fixture.forward(TESTER_B, requestB) == DoIPCanGateway::Forwarded::SENT);
+    CPPUNIT_ASSERT(fixture.ecu.requests.waitFor(2));
+    fixture.ecu.respond({READ_DATA_BY_IDENTIFIER_RES, 0xF1, 0x86, 0x01});
+    CPPUNIT_ASSERT(fixture.responses.waitFor(3));
+
+    // the real ECU got no request of tester B while it answered tester A
+    const vector<MessageQueue::Message> requests = fixture.ecu.requests.get();
+    CPPUNIT_ASSERT_EQUAL(size_t(2), requests.size());
+    CPPUNIT_ASSERT(requestA == requests[0].data);
+    CPPUNIT_ASSERT(requestB == requests[1].data);
+    const vector<MessageQueue::Message> responses = fixture.responses.get();
+    CPPUNIT_ASSERT_EQUAL(TESTER_A, responses[0].address);
+    CPPUNIT_ASSERT_EQUAL(TESTER_A, responses[1].address);
+    CPPUNIT_ASSERT_EQUAL(TESTER_B, responses[2].address);
+}
+
+/**
+ * A request without positive response does not keep the other testers
+ * waiting.
+ */
+void DoIPCanGatewayTest::testSuppressedResponse()
+{
+    GatewayFixture fixture;
+    CPPUNIT_ASSERT(fixture.forward(TESTER_A, {TESTER_PRESENT_REQ, 0x80}) == DoIPCanGateway::Forwarded::SENT);
+    CPPUNIT_ASSERT(fixture.ecu.requests.waitFor(1));
+    CPPUNIT_ASSERT(fixture.forward(TESTER_B, {TESTER_PRESENT_REQ, 0x80}) == DoIPCanGateway::Forwarded::SENT);
+    CPPUNIT_ASSERT(fixture.ecu.requests.waitFor(2));
+}
+
+/**
+ * A request the real ECU does not answer blocks the other testers only until
+ * the response timeout.
+ */
+void DoIPCanGatewayTest::testResponseTimeout()
+{
+    GatewayFixture fixture(chrono::milliseconds(100));
+    const vector<uint8_t> request = {READ_DATA_BY_IDENTIFIER_REQ, 0xF1, 0x90};
+
+    CPPUNIT_ASSERT(fixture.forward(TESTER_A, request) == DoIPCanGateway::Forwarded::SENT);
+    CPPUNIT_ASSERT(fixture.forward(TESTER_B, request) == DoIPCanGateway::Forwarded::BUSY);
+    // the same tester may send its next request
+    CPPUNIT_ASSERT(fixture.forward(TESTER_A, request) == DoIPCanGateway::Forwarded::SENT);
+    this_thread::sleep_for(chrono::milliseconds(200));
+    CPPUNIT_ASSERT(fixture.forward(TESTER_B, request) == DoIPCanGateway::Forwarded::SENT);
+}
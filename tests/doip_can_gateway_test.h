@@ -0,0 +1,37 @@
+/**
+ * @file doip_can_gateway_test.h
+ *
+ */
+
+#ifndef DOIP_CAN_GATEWAY_TEST_H
+#define DOIP_CAN_GATEWAY_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class DoIPCanGatewayTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(DoIPCanGatewayTest);
+
+    CPPUNIT_TEST(testRelayToTester);
+    CPPUNIT_TEST(testConcurrentTesters);
+    CPPUNIT_TEST(testSuppressedResponse);
+    CPPUNIT_TEST(testResponseTimeout);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    DoIPCanGatewayTest() = default;
+    virtual ~DoIPCanGatewayTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testRelayToTester();
+    void testConcurrentTesters();
+    void testSuppressedResponse();
+    void testResponseTimeout();
+
+};
+
+#endif /* DOIP_CAN_GATEWAY_TEST_H */
+
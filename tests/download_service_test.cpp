@@ -0,0 +1,141 @@
+/**
+ * @file download_service_test.cpp
+ *
+ * Unit test for the native RequestDownload / TransferData / RequestTransferExit.
+ */
+
+#include "download_service_test.h"
+#include "download_service.h"
+#include "service_identifier.h"
+#include "libcrc/checksum.h"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DownloadServiceTest);
+
+/// `34 00 44 address size`
+static vector<uint8_t> requestDownload(uint32_t address, uint32_t size)
+{
+    return {
+        REQUEST_DOWNLOAD_REQ, 0x00, 0x44,
+        uint8_t(address >> 24), uint8_t(address >> 16), uint8_t(address >> 8), uint8_t(address),
+        uint8_t(size >> 24), uint8_t(size >> 16), uint8_t(size >> 8), uint8_t(size)
+    };
+}
+
+static vector<uint8_t> transferData(uint8_t blockSequenceCounter, size_t length, uint8_t value)
+{
+    vector<uint8_t> request(length + 2, value);
+    request[0] = TRANSFER_DATA_REQ;
+    request[1] = blockSequenceCounter;
+    return request;
+}
+
+static vector<uint8_t> proceed(DownloadService& service, const vector<uint8_t>& request)
+{
+    vector<uint8_t> response;
+    service.proceedRequest(request.data(), request.size(), response);
+    return response;
+}
+
+void DownloadServiceTest::setUp() { }
+
+void DownloadServiceTest::tearDown() { }
+
+void DownloadServiceTest::testDownload()
+{
+    DownloadService service({1024, 0x0102}, nullptr);
+    CPPUNIT_ASSERT(!service.isActive());
+
+    const vector<uint8_t> accepted = {REQUEST_DOWNLOAD_RES, 0x20, 0x01, 0x02};
+    CPPUNIT_ASSERT(proceed(service, requestDownload(0x00080000, 300)) == accepted);
+    CPPUNIT_ASSERT(service.isActive());
+
+    CPPUNIT_ASSERT(proceed(service, transferData(0x01, 0x100, 0xA5)) == vector<uint8_t>({TRANSFER_DATA_RES, 0x01}));
+    CPPUNIT_ASSERT(proceed(service, transferData(0x02, 44, 0x5A)) == vector<uint8_t>({TRANSFER_DATA_RES, 0x02}));
+
+    vector<uint8_t> image(0x100, 0xA5);
+    image.insert(image.end(), 44, 0x5A);
+    CPPUNIT_ASSERT(service.getImage() == image);
+
+    const uint16_t crc = crc_ccitt_ffff(image.data(), image.size());
+    const vector<uint8_t> exit = {REQUEST_TRANSFER_EXIT_RES, uint8_t(crc >> 8), uint8_t(crc)};
+    CPPUNIT_ASSERT(proceed(service, {REQUEST_TRANSFER_EXIT_REQ}) == exit);
+    CPPUNIT_ASSERT(!service.isActive());
+}
+
+void DownloadServiceTest::testBlockSequenceCounter()
+{
+    DownloadService service({DEFAULT_MAX_DOWNLOAD_SIZE, DEFAULT_MAX_BLOCK_LENGTH}, nullptr);
+    proceed(service, requestDownload(0, 300));
+
+    // the first block has the counter 0x01
+    const vector<uint8_t> wrongCounter = {ERROR, TRANSFER_DATA_REQ, WRONG_BLOCK_SEQUENCE_COUNTER};
+    CPPUNIT_ASSERT(proceed(service, transferData(0x00, 1, 0x00)) == wrongCounter);
+
+    for (unsigned i = 1; i <= 256; ++i)
+    {
+        const uint8_t counter = uint8_t(i);
+        CPPUNIT_ASSERT(proceed(service, transferData(counter, 1, counter)) == vector<uint8_t>({TRANSFER_DATA_RES, counter}));
+    }
+
+    // the last block (0x00, after the wrap around) is repeated, but written once
+    CPPUNIT_ASSERT(proceed(service, transferData(0x00, 1, 0x00)) == vector<uint8_t>({TRANSFER_DATA_RES, 0x00}));
+    CPPUNIT_ASSERT_EQUAL(size_t(256), service.getImage().size());
+    CPPUNIT_ASSERT(proceed(service, transferData(0x02, 1, 0x00)) == wrongCounter);
+}
+
+void DownloadServiceTest::testInvalidRequests()
+{
+    DownloadService service({256, 0x0012}, nullptr);
+
+    const vector<uint8_t> sequenceError = {ERROR, TRANSFER_DATA_REQ, REQUEST_SEQUENCE_ERROR};
+    CPPUNIT_ASSERT(proceed(service, transferData(0x01, 4, 0x00)) == sequenceError);
+
+    const vector<uint8_t> outOfRange = {ERROR, REQUEST_DOWNLOAD_REQ, REQUEST_OUT_OF_RANGE};
+    CPPUNIT_ASSERT(proceed(service, requestDownload(0, 257)) == outOfRange);
+    CPPUNIT_ASSERT(proceed(service, requestDownload(0, 0)) == outOfRange);
+    const vector<uint8_t> invalidFormat = {ERROR, REQUEST_DOWNLOAD_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT};
+    CPPUNIT_ASSERT(proceed(service, {REQUEST_DOWNLOAD_REQ, 0x00, 0x44, 0x00}) == invalidFormat);
+    CPPUNIT_ASSERT(!service.isActive());
+
+    proceed(service, requestDownload(0, 20));
+    // longer than maxNumberOfBlockLength
+    const vector<uint8_t> tooLong = {ERROR, TRANSFER_DATA_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT};
+    CPPUNIT_ASSERT(proceed(service, transferData(0x01, 0x11, 0x00)) == tooLong);
+    CPPUNIT_ASSERT(proceed(service, transferData(0x01, 0x10, 0x00)) == vector<uint8_t>({TRANSFER_DATA_RES, 0x01}));
+    // more than the announced memory size
+    const vector<uint8_t> suspended = {ERROR, TRANSFER_DATA_REQ, TRANSFER_DATA_SUSPENDED};
+    CPPUNIT_ASSERT(proceed(service, transferData(0x02, 0x05, 0x00)) == suspended);
+
+    // the image is incomplete
+    const vector<uint8_t> exitError = {ERROR, REQUEST_TRANSFER_EXIT_REQ, REQUEST_SEQUENCE_ERROR};
+    CPPUNIT_ASSERT(proceed(service, {REQUEST_TRANSFER_EXIT_REQ}) == exitError);
+    CPPUNIT_ASSERT(service.isActive());
+}
+
+void DownloadServiceTest::testTransferExitHandler()
+{
+    DownloadSummary summary{};
+    DownloadService service({DEFAULT_MAX_DOWNLOAD_SIZE, DEFAULT_MAX_BLOCK_LENGTH},
+                            [&summary](const DownloadSummary& s) -> optional<vector<uint8_t>> {
+        summary = s;
+        return vector<uint8_t>({0xCA, 0xFE});
+    });
+    proceed(service, {REQUEST_DOWNLOAD_REQ, 0x11, 0x12, 0x12, 0x34, 0x08});
+    proceed(service, transferData(0x01, 8, 0x42));
+
+    CPPUNIT_ASSERT(proceed(service, {REQUEST_TRANSFER_EXIT_REQ}) == vector<uint8_t>({REQUEST_TRANSFER_EXIT_RES, 0xCA, 0xFE}));
+    CPPUNIT_ASSERT_EQUAL(uint32_t(0x1234), summary.memoryAddress);
+    CPPUNIT_ASSERT_EQUAL(uint32_t(8), summary.memorySize);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x11), summary.dataFormatIdentifier);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), summary.blockCount);
+    const vector<uint8_t> image(8, 0x42);
+    CPPUNIT_ASSERT_EQUAL(crc_ccitt_ffff(image.data(), image.size()), summary.crc);
+
+    // a second exit is out of sequence
+    const vector<uint8_t> exitError = {ERROR, REQUEST_TRANSFER_EXIT_REQ, REQUEST_SEQUENCE_ERROR};
+    CPPUNIT_ASSERT(proceed(service, {REQUEST_TRANSFER_EXIT_REQ}) == exitError);
+}
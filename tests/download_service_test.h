@@ -0,0 +1,36 @@
+/**
+ * @file download_service_test.h
+ *
+ */
+
+#ifndef DOWNLOAD_SERVICE_TEST_H
+#define DOWNLOAD_SERVICE_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class DownloadServiceTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(DownloadServiceTest);
+
+    CPPUNIT_TEST(testDownload);
+    CPPUNIT_TEST(testBlockSequenceCounter);
+    CPPUNIT_TEST(testInvalidRequests);
+    CPPUNIT_TEST(testTransferExitHandler);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    DownloadServiceTest() = default;
+    virtual ~DownloadServiceTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testDownload();
+    void testBlockSequenceCounter();
+    void testInvalidRequests();
+    void testTransferExitHandler();
+
+};
+
+#endif /* DOWNLOAD_SERVICE_TEST_H */
@@ -0,0 +1,221 @@
+/**
+ * @file dtc_store_test.cpp
+ *
+ * Unit test for the native fault memory.
+ */
+
+#include "dtc_store_test.h"
+#include "dtc_store.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DtcStoreTest);
+
+void DtcStoreTest::setUp() { }
+
+void DtcStoreTest::tearDown() { }
+
+void DtcStoreTest::testStatusMask()
+{
+    DtcStore store;
+    store.setDtc(0x100001, 0x01);
+    store.setDtc(0x100002, 0x08);
+    store.setDtc(0x100003, 0x09);
+    store.setDtc(0x100004, 0x00);
+
+    CPPUNIT_ASSERT_EQUAL(size_t(2), store.countByStatusMask(0x01));
+    CPPUNIT_ASSERT_EQUAL(size_t(3), store.countByStatusMask(0x09));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), store.countByStatusMask(0x00));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), store.countByStatusMask(0xF0));
+
+    vector<uint8_t> response;
+    store.appendByStatusMask(0x08, response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x10, 0x00, 0x02, 0x08, 0x10, 0x00, 0x03, 0x09}));
+
+    // the bitmaps follow a status change
+    store.setDtc(0x100002, 0x01);
+    response.clear();
+    store.appendByStatusMask(0x08, response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x10, 0x00, 0x03, 0x09}));
+    CPPUNIT_ASSERT_EQUAL(size_t(3), store.countByStatusMask(0x01));
+
+    response.clear();
+    store.appendAll(response);
+    CPPUNIT_ASSERT_EQUAL(size_t(16), response.size());
+
+    uint8_t status;
+    CPPUNIT_ASSERT(store.getStatus(0x100003, status));
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x09), status);
+    CPPUNIT_ASSERT(!store.getStatus(0x200000, status));
+}
+
+void DtcStoreTest::testClear()
+{
+    DtcStore store;
+    store.setDtc(0x100001, 0x01);
+    store.setDtc(0x100002, 0x02);
+    store.setDtc(0x100003, 0x04);
+
+    // the last DTC takes the place of the removed one
+    CPPUNIT_ASSERT(store.clearDtc(0x100001));
+    CPPUNIT_ASSERT(!store.clearDtc(0x100001));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), store.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), store.countByStatusMask(0x01));
+    vector<uint8_t> response;
+    store.appendByStatusMask(0x04, response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x10, 0x00, 0x03, 0x04}));
+    uint8_t status;
+    CPPUNIT_ASSERT(store.getStatus(0x100003, status));
+    CPPUNIT_ASSERT(store.clearDtc(0x100003));
+    CPPUNIT_ASSERT(store.getStatus(0x100002, status));
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x02), status);
+
+    CPPUNIT_ASSERT(store.clearDtc(DtcStore::ALL_DTCS));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), store.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), store.countByStatusMask(0xFF));
+
+    // nothing is set while the DTC setting is off
+    store.setSettingOn(false);
+    store.setDtc(0x100001, 0x01);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), store.size());
+    store.setSettingOn(true);
+    store.setDtc(0x100001, 0x01);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), store.size());
+}
+
+void DtcStoreTest::testInitialState()
+{
+    DtcStore store;
+    store.setDtc(0x100001, 0x01);
+    store.setSnapshotRecord(0x100001, 0x01, {0xAA});
+    store.saveInitialState();
+
+    store.setDtc(0x100002, 0x08);
+    CPPUNIT_ASSERT(store.clearDtc(0x100001));
+    store.setSettingOn(false);
+
+    store.restoreInitialState();
+    CPPUNIT_ASSERT(store.isSettingOn());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), store.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), store.countByStatusMask(0x01));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), store.countByStatusMask(0x08));
+    vector<uint8_t> response;
+    CPPUNIT_ASSERT(store.appendSnapshotRecords(0x100001, 0x01, response));
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x10, 0x00, 0x01, 0x01, 0x01, 0xAA}));
+}
+
+void DtcStoreTest::testSerialize()
+{
+    DtcStore store;
+    store.setDtc(0x100001, 0x09);
+    store.setDtc(0x100002, 0x08);
+    store.setSnapshotRecord(0x100001, 0x01, {0xAA, 0xBB});
+    store.setExtendedDataRecord(0x100002, 0x10, {0x05});
+    store.setSettingOn(false);
+    string data;
+    store.serialize(data);
+
+    DtcStore restored;
+    restored.setDtc(0x200000, 0x01);
+    CPPUNIT_ASSERT(restored.deserialize(data));
+    CPPUNIT_ASSERT(!restored.isSettingOn());
+    CPPUNIT_ASSERT_EQUAL(size_t(2), restored.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), restored.countByStatusMask(0x01));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), restored.countByStatusMask(0x08));
+    vector<uint8_t> response;
+    CPPUNIT_ASSERT(restored.appendSnapshotRecords(0x100001, 0x01, response));
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x10, 0x00, 0x01, 0x09, 0x01, 0xAA, 0xBB}));
+    response.clear();
+    CPPUNIT_ASSERT(restored.appendExtendedDataRecords(0x100002, 0x10, response));
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x10, 0x00, 0x02, 0x08, 0x10, 0x05}));
+
+    // a truncated section does not change the store
+    CPPUNIT_ASSERT(!restored.deserialize(string_view(data).substr(0, data.size() - 1)));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), restored.size());
+}
+
+void DtcStoreTest::testDataRecords()
+{
+    DtcStore store;
+    CPPUNIT_ASSERT(!store.setSnapshotRecord(0x100001, 0x01, {0x01}));
+    store.setDtc(0x100001, 0x09);
+    CPPUNIT_ASSERT(store.setSnapshotRecord(0x100001, 0x01, {0x01, 0xF1, 0x90, 0xAA}));
+    CPPUNIT_ASSERT(store.setSnapshotRecord(0x100001, 0x02, {0x01, 0xF1, 0x90, 0xBB}));
+    CPPUNIT_ASSERT(store.setSnapshotRecord(0x100001, 0x01, {0x01, 0xF1, 0x90, 0xCC})); // replaced
+    CPPUNIT_ASSERT(store.setExtendedDataRecord(0x100001, 0x10, {0x05}));
+
+    vector<uint8_t> response;
+    CPPUNIT_ASSERT(store.appendSnapshotRecords(0x100001, 0x02, response));
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x10, 0x00, 0x01, 0x09, 0x02, 0x01, 0xF1, 0x90, 0xBB}));
+    response.clear();
+    CPPUNIT_ASSERT(store.appendSnapshotRecords(0x100001, DtcStore::ALL_RECORDS, response));
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x10, 0x00, 0x01, 0x09,
+                                                0x01, 0x01, 0xF1, 0x90, 0xCC,
+                                                0x02, 0x01, 0xF1, 0x90, 0xBB}));
+    response.clear();
+    CPPUNIT_ASSERT(store.appendExtendedDataRecords(0x100001, 0x10, response));
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x10, 0x00, 0x01, 0x09, 0x10, 0x05}));
+    response.clear();
+    CPPUNIT_ASSERT(!store.appendExtendedDataRecords(0x100002, 0x10, response));
+    CPPUNIT_ASSERT(response.empty());
+
+    // the records are removed with the DTC
+    store.clearDtc(0x100001);
+    store.setDtc(0x100001, 0x09);
+    CPPUNIT_ASSERT(store.appendSnapshotRecords(0x100001, DtcStore::ALL_RECORDS, response));
+    CPPUNIT_ASSERT_EQUAL(size_t(4), response.size());
+}
+
+void DtcStoreTest::testManyDtcs()
+{
+    // more DTCs than bits in one bitmap word
+    DtcStore store;
+    constexpr uint32_t COUNT = 1000;
+    for (uint32_t i = 0; i < COUNT; ++i)
+    {
+        store.setDtc(0x010000 + i, (i % 3 == 0) ? 0x08 : 0x01);
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(334), store.countByStatusMask(0x08));
+    CPPUNIT_ASSERT_EQUAL(size_t(COUNT), store.countByStatusMask(0x09));
+
+    for (uint32_t i = 0; i < COUNT; i += 2)
+    {
+        store.clearDtc(0x010000 + i);
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(COUNT / 2), store.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(167), store.countByStatusMask(0x08));
+
+    vector<uint8_t> response;
+    store.appendByStatusMask(0x08, response);
+    CPPUNIT_ASSERT_EQUAL(size_t(167 * 4), response.size());
+    for (size_t i = 0; i < response.size(); i += 4)
+    {
+        const uint32_t dtc = (uint32_t(response[i]) << 16) | (uint32_t(response[i + 1]) << 8) | response[i + 2];
+        CPPUNIT_ASSERT((dtc - 0x010000) % 2 == 1);
+        CPPUNIT_ASSERT((dtc - 0x010000) % 3 == 0);
+        CPPUNIT_ASSERT_EQUAL(uint8_t(0x08), response[i + 3]);
+    }
+}
+
+void DtcStoreTest::testGeneration()
+{
+    DtcStore store;
+    uint64_t generation = store.getGeneration();
+    store.setDtc(0x640001, 0x01);
+    CPPUNIT_ASSERT(store.getGeneration() != generation);
+
+    // an unchanged status is no change
+    generation = store.getGeneration();
+    store.setDtc(0x640001, 0x01);
+    CPPUNIT_ASSERT_EQUAL(generation, store.getGeneration());
+
+    store.setExtendedDataRecord(0x640001, 0x01, {3});
+    CPPUNIT_ASSERT(store.getGeneration() != generation);
+    generation = store.getGeneration();
+    store.clearDtc(0x640001);
+    CPPUNIT_ASSERT(store.getGeneration() != generation);
+}
@@ -0,0 +1,42 @@
+/**
+ * @file dtc_store_test.h
+ *
+ */
+
+#ifndef DTC_STORE_TEST_H
+#define DTC_STORE_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class DtcStoreTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(DtcStoreTest);
+
+    CPPUNIT_TEST(testStatusMask);
+    CPPUNIT_TEST(testClear);
+    CPPUNIT_TEST(testInitialState);
+    CPPUNIT_TEST(testSerialize);
+    CPPUNIT_TEST(testDataRecords);
+    CPPUNIT_TEST(testManyDtcs);
+    CPPUNIT_TEST(testGeneration);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    DtcStoreTest() = default;
+    virtual ~DtcStoreTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testStatusMask();
+    void testClear();
+    void testInitialState();
+    void testSerialize();
+    void testDataRecords();
+    void testManyDtcs();
+    void testGeneration();
+
+};
+
+#endif /* DTC_STORE_TEST_H */
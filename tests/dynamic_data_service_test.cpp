@@ -0,0 +1,210 @@
+/**
+ * @file dynamic_data_service_test.cpp
+ *
+ * Unit test for the data identifiers defined by the tester.
+ */
+
+#include "dynamic_data_service_test.h"
+#include "dynamic_data_service.h"
+#include "service_identifier.h"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DynamicDataServiceTest);
+
+namespace
+{
+
+/// the value of F190, changed by the tests
+vector<uint8_t> vin = {'W', 'V', 'W', '1', '2', '3'};
+/// the number of reads of F190
+size_t vinReads = 0;
+
+/// F190 and F40D exist in every session, 0100 in the extended session only
+bool readData(UdsSession session, uint16_t dataIdentifier, vector<uint8_t>& data)
+{
+    switch (dataIdentifier)
+    {
+        case 0xF190:
+            ++vinReads;
+            data = vin;
+            return true;
+        case 0xF40D:
+            data.assign({0x00, 0x50});
+            return true;
+        case 0x0100:
+            data.assign({0xAA, 0xBB, 0xCC});
+            return session == UdsSession::EXTENDED;
+        case 0xF201:
+            // a defined identifier is no source, even if the reader knows it
+            data.assign({0x01});
+            return true;
+        default:
+            return false;
+    }
+}
+
+constexpr size_t MAX_DATA_LENGTH = 16;
+
+} // namespace
+
+void DynamicDataServiceTest::setUp()
+{
+    vin = {'W', 'V', 'W', '1', '2', '3'};
+    vinReads = 0;
+}
+
+void DynamicDataServiceTest::tearDown() { }
+
+void DynamicDataServiceTest::testInvalidRequests()
+{
+    DynamicDataService service(nullptr, readData, MAX_DATA_LENGTH);
+    vector<uint8_t> response;
+
+    const vector<uint8_t> noType = {0x2C};
+    service.proceedRequest(noType.data(), noType.size(), response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({ERROR, 0x2C, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT}));
+
+    const vector<uint8_t> byMemory = {0x2C, 0x02, 0xF2, 0x00, 0x14, 0x12, 0x34, 0x02};
+    service.proceedRequest(byMemory.data(), byMemory.size(), response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({ERROR, 0x2C, SUBFUNCTION_NOT_SUPPORTED}));
+
+    const vector<uint8_t> noSource = {0x2C, 0x01, 0xF2, 0x00};
+    service.proceedRequest(noSource.data(), noSource.size(), response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({ERROR, 0x2C, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT}));
+
+    const vector<uint8_t> incomplete = {0x2C, 0x01, 0xF2, 0x00, 0xF1, 0x90, 0x01};
+    service.proceedRequest(incomplete.data(), incomplete.size(), response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({ERROR, 0x2C, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT}));
+
+    const vector<vector<uint8_t>> outOfRange = {
+        {0x2C, 0x01, 0xF1, 0x90, 0xF1, 0x90, 0x01, 0x01}, // not a dynamic identifier
+        {0x2C, 0x01, 0xF2, 0x00, 0x12, 0x34, 0x01, 0x01}, // unknown source
+        {0x2C, 0x01, 0xF2, 0x00, 0x01, 0x00, 0x01, 0x01}, // only in the extended session
+        {0x2C, 0x01, 0xF2, 0x00, 0xF2, 0x01, 0x01, 0x01}, // a defined identifier
+        {0x2C, 0x01, 0xF2, 0x00, 0xF1, 0x90, 0x00, 0x01}, // the position is 1-based
+        {0x2C, 0x01, 0xF2, 0x00, 0xF1, 0x90, 0x01, 0x00}, // no size
+        {0x2C, 0x01, 0xF2, 0x00, 0xF1, 0x90, 0x05, 0x03}, // beyond the source
+        {0x2C, 0x01, 0xF2, 0x00, 0xF1, 0x90, 0x01, 0x06, 0xF1, 0x90, 0x01, 0x06,
+         0xF1, 0x90, 0x01, 0x06}, // too long
+        {0x2C, 0x03, 0xF1, 0x90} // not a dynamic identifier
+    };
+    for (const auto& request : outOfRange)
+    {
+        service.proceedRequest(request.data(), request.size(), response);
+        CPPUNIT_ASSERT(response == vector<uint8_t>({ERROR, 0x2C, REQUEST_OUT_OF_RANGE}));
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(0), service.getDefinedCount());
+}
+
+void DynamicDataServiceTest::testDefineByIdentifier()
+{
+    SessionController sessionCtrl;
+    sessionCtrl.setCurrentUdsSession(UdsSession::EXTENDED);
+    DynamicDataService service(&sessionCtrl, readData, MAX_DATA_LENGTH);
+    vector<uint8_t> response;
+
+    // the last 3 bytes of the VIN, the speed and the first byte of the VIN
+    const vector<uint8_t> define = {0x2C, 0x01, 0xF2, 0x00, 0xF1, 0x90, 0x04, 0x03,
+                                    0xF4, 0x0D, 0x01, 0x02, 0x01, 0x00, 0x02, 0x01, 0xF1, 0x90, 0x01, 0x01};
+    service.proceedRequest(define.data(), define.size(), response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x6C, 0x01, 0xF2, 0x00}));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), service.getDefinedCount());
+
+    vector<uint8_t> data;
+    vinReads = 0;
+    CPPUNIT_ASSERT(service.read(UdsSession::EXTENDED, 0xF200, data));
+    CPPUNIT_ASSERT(data == vector<uint8_t>({'1', '2', '3', 0x00, 0x50, 0xBB, 'W'}));
+    // a source is read once, even with several slices
+    CPPUNIT_ASSERT_EQUAL(size_t(1), vinReads);
+
+    response = {0x62};
+    CPPUNIT_ASSERT(service.appendRecord(UdsSession::EXTENDED, 0xF200, response));
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x62, 0xF2, 0x00, '1', '2', '3', 0x00, 0x50, 0xBB, 'W'}));
+
+    // the sources are read in the session of the read
+    response = {0x62};
+    CPPUNIT_ASSERT(!service.appendRecord(UdsSession::DEFAULT, 0xF200, response));
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x62}));
+    CPPUNIT_ASSERT(!service.read(UdsSession::EXTENDED, 0xF201, data));
+    CPPUNIT_ASSERT(!service.read(UdsSession::EXTENDED, 0xF190, data));
+}
+
+void DynamicDataServiceTest::testAppendDefinition()
+{
+    DynamicDataService service(nullptr, readData, MAX_DATA_LENGTH);
+    vector<uint8_t> response;
+
+    const vector<uint8_t> first = {0x2C, 0x01, 0xF2, 0x00, 0xF1, 0x90, 0x01, 0x02};
+    service.proceedRequest(first.data(), first.size(), response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x6C, 0x01, 0xF2, 0x00}));
+    const vector<uint8_t> second = {0x2C, 0x01, 0xF2, 0x00, 0xF4, 0x0D, 0x02, 0x01};
+    service.proceedRequest(second.data(), second.size(), response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x6C, 0x01, 0xF2, 0x00}));
+
+    vector<uint8_t> data;
+    CPPUNIT_ASSERT(service.read(UdsSession::DEFAULT, 0xF200, data));
+    CPPUNIT_ASSERT(data == vector<uint8_t>({'W', 'V', 0x50}));
+
+    // a rejected definition keeps the previous one
+    const vector<uint8_t> tooLong = {0x2C, 0x01, 0xF2, 0x00, 0xF1, 0x90, 0x01, 0x06, 0xF1, 0x90, 0x01, 0x06,
+                                     0xF1, 0x90, 0x01, 0x06};
+    service.proceedRequest(tooLong.data(), tooLong.size(), response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({ERROR, 0x2C, REQUEST_OUT_OF_RANGE}));
+    CPPUNIT_ASSERT(service.read(UdsSession::DEFAULT, 0xF200, data));
+    CPPUNIT_ASSERT(data == vector<uint8_t>({'W', 'V', 0x50}));
+}
+
+void DynamicDataServiceTest::testClear()
+{
+    DynamicDataService service(nullptr, readData, MAX_DATA_LENGTH);
+    vector<uint8_t> response;
+
+    for (uint8_t identifier = 0x00; identifier < 0x03; ++identifier)
+    {
+        const vector<uint8_t> define = {0x2C, 0x01, 0xF2, identifier, 0xF4, 0x0D, 0x01, 0x02};
+        service.proceedRequest(define.data(), define.size(), response);
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(3), service.getDefinedCount());
+
+    const vector<uint8_t> clearOne = {0x2C, 0x03, 0xF2, 0x01};
+    service.proceedRequest(clearOne.data(), clearOne.size(), response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x6C, 0x03, 0xF2, 0x01}));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), service.getDefinedCount());
+    vector<uint8_t> data;
+    CPPUNIT_ASSERT(!service.read(UdsSession::DEFAULT, 0xF201, data));
+    CPPUNIT_ASSERT(service.read(UdsSession::DEFAULT, 0xF202, data));
+
+    const vector<uint8_t> clearAll = {0x2C, 0x03};
+    service.proceedRequest(clearAll.data(), clearAll.size(), response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x6C, 0x03}));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), service.getDefinedCount());
+
+    const vector<uint8_t> define = {0x2C, 0x01, 0xF3, 0xFF, 0xF4, 0x0D, 0x01, 0x02};
+    service.proceedRequest(define.data(), define.size(), response);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), service.getDefinedCount());
+    service.clearAll();
+    CPPUNIT_ASSERT_EQUAL(size_t(0), service.getDefinedCount());
+}
+
+void DynamicDataServiceTest::testChangedSource()
+{
+    DynamicDataService service(nullptr, readData, MAX_DATA_LENGTH);
+    vector<uint8_t> response;
+
+    const vector<uint8_t> define = {0x2C, 0x01, 0xF2, 0x00, 0xF1, 0x90, 0x05, 0x02};
+    service.proceedRequest(define.data(), define.size(), response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x6C, 0x01, 0xF2, 0x00}));
+
+    // every read gathers the current values
+    vector<uint8_t> data;
+    vin = {'W', 'V', 'W', '4', '5', '6'};
+    CPPUNIT_ASSERT(service.read(UdsSession::DEFAULT, 0xF200, data));
+    CPPUNIT_ASSERT(data == vector<uint8_t>({'5', '6'}));
+
+    // a source shorter than at its definition cannot be read
+    vin = {'W', 'V', 'W'};
+    CPPUNIT_ASSERT(!service.read(UdsSession::DEFAULT, 0xF200, data));
+}
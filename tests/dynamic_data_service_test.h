@@ -0,0 +1,38 @@
+/**
+ * @file dynamic_data_service_test.h
+ *
+ */
+
+#ifndef DYNAMIC_DATA_SERVICE_TEST_H
+#define DYNAMIC_DATA_SERVICE_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class DynamicDataServiceTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(DynamicDataServiceTest);
+
+    CPPUNIT_TEST(testInvalidRequests);
+    CPPUNIT_TEST(testDefineByIdentifier);
+    CPPUNIT_TEST(testAppendDefinition);
+    CPPUNIT_TEST(testClear);
+    CPPUNIT_TEST(testChangedSource);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    DynamicDataServiceTest() = default;
+    virtual ~DynamicDataServiceTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testInvalidRequests();
+    void testDefineByIdentifier();
+    void testAppendDefinition();
+    void testClear();
+    void testChangedSource();
+
+};
+
+#endif /* DYNAMIC_DATA_SERVICE_TEST_H */
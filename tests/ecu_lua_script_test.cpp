@@ -6,6 +6,16 @@
 
 #include "ecu_lua_script_test.h"
 #include "ecu_lua_script.h"
+#include "j1939_bus.h"
+#include "uds_transport.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <thread>
 
 const std::string ECU_IDENT = "PCM";
 const std::string LUA_SCRIPT = "tests/test_config_dir/testscript05.lua";
@@ -304,43 +314,907 @@ void EcuLuaScriptTest::testToByteResponse()
 void EcuLuaScriptTest::testGetRaw()
 {
     EcuLuaScript ecuLuaScript(ECU_IDENT, LUA_SCRIPT);
-    std::string identStr;
+    const auto pMatcher = ecuLuaScript.getRawRequestMatcher();
+    const auto getRaw = [&ecuLuaScript, &pMatcher](const std::vector<std::uint8_t>& request)
+    {
+        const std::optional<std::string> response = ecuLuaScript.getRawResponse(*pMatcher, request.data(),
+                                                                                std::uint32_t(request.size()));
+        CPPUNIT_ASSERT(response.has_value());
+        return *response;
+    };
     std::string expect;
     std::string result;
 
-    identStr = "10 02";
     expect = "50 02 00 19 01 f4";
-    result = ecuLuaScript.getRaw(identStr);
-    CPPUNIT_ASSERT_EQUAL_MESSAGE("Size mismatch!", expect.size(), result.size());
-    for (unsigned i = 0; i < result.size(); i++)
+    result = getRaw({0x10, 0x02});
+    CPPUNIT_ASSERT_EQUAL(expect, result);
+
+    expect = "10 33 11";
+    result = getRaw({0x22, 0xFA, 0xBC});
+    CPPUNIT_ASSERT_EQUAL(expect, result);
+
+    expect = "62 F1 91" + ecuLuaScript.ascii("SALGA2EV9HA298784");
+    result = getRaw({0x22, 0xF1, 0x91});
+    CPPUNIT_ASSERT_EQUAL(expect, result);
+
+    expect = "62 F1 91 53 41 4C 47 41 32 45 56 39 48 41 32 39 38 37 38 34 ";
+    result = getRaw({0x22, 0xF1, 0x91});
+    CPPUNIT_ASSERT_EQUAL(expect, result);
+
+    // requests which are not in the table
+    const std::uint8_t unknown[] = {0x22, 0xF1, 0x92};
+    CPPUNIT_ASSERT(!ecuLuaScript.getRawResponse(*pMatcher, unknown, sizeof(unknown)).has_value());
+}
+
+/**
+ * Writes a script with one `Raw` entry answering `22 01` with the given response.
+ */
+static void writeReloadScript(const std::string& luaScript, const std::string& response)
+{
+    std::ofstream script(luaScript, std::ios::trunc);
+    script << "Main = {\n"
+           << "    RequestId = 0x100,\n"
+           << "    ResponseId = 0x200,\n"
+           << "    ReadDataByIdentifier = { [\"F190\"] = \"" << response << "\" },\n"
+           << "    Raw = { [\"22 01\"] = \"" << response << "\" }\n"
+           << "}\n";
+}
+
+void EcuLuaScriptTest::testReload()
+{
+    const std::string luaScript = "/tmp/ecu_lua_script_test_reload.lua";
+    const uint8_t request[] = {0x22, 0x01};
+    writeReloadScript(luaScript, "62 01 01");
+    EcuLuaScript ecuLuaScript("Main", luaScript);
+    const auto pOldMatcher = ecuLuaScript.getRawRequestMatcher();
+    CPPUNIT_ASSERT_EQUAL(std::string("62 01 01"), *ecuLuaScript.getRawResponse(*pOldMatcher, request, sizeof(request)));
+
+    writeReloadScript(luaScript, "62 01 02");
+    CPPUNIT_ASSERT(ecuLuaScript.reload());
+    const auto pNewMatcher = ecuLuaScript.getRawRequestMatcher();
+    CPPUNIT_ASSERT_EQUAL(std::string("62 01 02"), *ecuLuaScript.getRawResponse(*pNewMatcher, request, sizeof(request)));
+    CPPUNIT_ASSERT_EQUAL(std::string("62 01 02"), ecuLuaScript.getDataByIdentifier("F190"));
+    // a request in flight is finished with the old version
+    CPPUNIT_ASSERT_EQUAL(std::string("62 01 01"), *ecuLuaScript.getRawResponse(*pOldMatcher, request, sizeof(request)));
+
+    // a broken script keeps the running version
+    std::ofstream(luaScript, std::ios::trunc) << "Main = {\n";
+    CPPUNIT_ASSERT(!ecuLuaScript.reload());
+    CPPUNIT_ASSERT_EQUAL(std::string("62 01 02"), ecuLuaScript.getDataByIdentifier("F190"));
+    std::remove(luaScript.c_str());
+}
+
+void EcuLuaScriptTest::testIsInDoIPEntity()
+{
+    const std::string luaScript = "/tmp/ecu_lua_script_test_entity.lua";
+    std::ofstream(luaScript, std::ios::trunc) << "Main = { DoIPLogicalEcuAddress = 0x4010 }\n";
     {
-        CPPUNIT_ASSERT_EQUAL(expect.at(i), result.at(i));
+        // without `DoIPEntity` the ECU belongs to all entities
+        EcuLuaScript ecuLuaScript("Main", luaScript);
+        CPPUNIT_ASSERT(ecuLuaScript.isInDoIPEntity("doipserver"));
+        CPPUNIT_ASSERT(ecuLuaScript.isInDoIPEntity("doipserver_rack2"));
     }
 
-    identStr = "22 fa bc";
-    expect = "10 33 11";
-    result = ecuLuaScript.getRaw(identStr);
-    CPPUNIT_ASSERT_EQUAL_MESSAGE("Size mismatch!", expect.size(), result.size());
-    for (unsigned i = 0; i < result.size(); i++)
+    std::ofstream(luaScript, std::ios::trunc)
+        << "Main = { DoIPLogicalEcuAddress = 0x4010, DoIPEntity = \"doipserver_rack2\" }\n";
     {
-        CPPUNIT_ASSERT_EQUAL(expect.at(i), result.at(i));
+        EcuLuaScript ecuLuaScript("Main", luaScript);
+        CPPUNIT_ASSERT(!ecuLuaScript.isInDoIPEntity("doipserver"));
+        CPPUNIT_ASSERT(ecuLuaScript.isInDoIPEntity("doipserver_rack2"));
     }
 
-    identStr = "22 F1 91";
-    expect = "62 F1 91" + ecuLuaScript.ascii("SALGA2EV9HA298784");
-    result = ecuLuaScript.getRaw(identStr);
-    CPPUNIT_ASSERT_EQUAL_MESSAGE("Size mismatch!", expect.size(), result.size());
-    for (unsigned i = 0; i < result.size(); i++)
+    std::ofstream(luaScript, std::ios::trunc)
+        << "Main = { DoIPLogicalEcuAddress = 0x4010, DoIPEntity = { \"doipserver\", \"doipserver_rack3\" } }\n";
     {
-        CPPUNIT_ASSERT_EQUAL(expect.at(i), result.at(i));
+        EcuLuaScript ecuLuaScript("Main", luaScript);
+        CPPUNIT_ASSERT(ecuLuaScript.isInDoIPEntity("doipserver"));
+        CPPUNIT_ASSERT(!ecuLuaScript.isInDoIPEntity("doipserver_rack2"));
+        CPPUNIT_ASSERT(ecuLuaScript.isInDoIPEntity("doipserver_rack3"));
     }
+    std::remove(luaScript.c_str());
+}
 
-    identStr = "22 F1 91";
-    expect = "62 F1 91 53 41 4C 47 41 32 45 56 39 48 41 32 39 38 37 38 34 ";
-    result = ecuLuaScript.getRaw(identStr);
-    CPPUNIT_ASSERT_EQUAL_MESSAGE("Size mismatch!", expect.size(), result.size());
-    for (unsigned i = 0; i < result.size(); i++)
+void EcuLuaScriptTest::testInterfaces()
+{
+    const std::string luaScript = "/tmp/ecu_lua_script_test_interface.lua";
+    std::ofstream(luaScript, std::ios::trunc) << "Main = { RequestId = 0x740, ResponseId = 0x748 }\n";
     {
-        CPPUNIT_ASSERT_EQUAL(expect.at(i), result.at(i));
+        // without `Interface` the ECU runs on the interface of the command line
+        EcuLuaScript ecuLuaScript("Main", luaScript);
+        CPPUNIT_ASSERT(ecuLuaScript.getInterfaces().empty());
+    }
+
+    std::ofstream(luaScript, std::ios::trunc)
+        << "Main = { RequestId = 0x740, ResponseId = 0x748, Interface = \"can1\" }\n";
+    {
+        EcuLuaScript ecuLuaScript("Main", luaScript);
+        CPPUNIT_ASSERT(ecuLuaScript.getInterfaces() == std::vector<std::string>({"can1"}));
     }
+
+    std::ofstream(luaScript, std::ios::trunc)
+        << "Main = { RequestId = 0x710, ResponseId = 0x77A, Interface = { \"can0\", \"can2\" } }\n";
+    {
+        EcuLuaScript ecuLuaScript("Main", luaScript);
+        CPPUNIT_ASSERT(ecuLuaScript.getInterfaces() == std::vector<std::string>({"can0", "can2"}));
+    }
+    std::remove(luaScript.c_str());
+}
+
+void EcuLuaScriptTest::testBinaryRawFunction()
+{
+    const std::string luaScript = "/tmp/ecu_lua_script_test_binary.lua";
+    std::ofstream(luaScript, std::ios::trunc)
+        << "Main = {\n"
+        << "    Raw = {\n"
+        << "        [\"22 F1 XX\"] = binary(function (request)\n"
+        << "            return u8(0x62) .. u16(getU16(request, 2)) .. u32(0x00FF0001) .. request:sub(4)\n"
+        << "        end),\n"
+        << "        [\"22 F2 XX\"] = binary(function (request)\n"
+        << "            return tostring(getU32(request, 2))\n"
+        << "        end),\n"
+        << "        [\"22 F3 XX\"] = function (request) return \"62\" .. request:sub(4) end\n"
+        << "    }\n"
+        << "}\n";
+    EcuLuaScript ecuLuaScript("Main", luaScript);
+    const auto pMatcher = ecuLuaScript.getRawRequestMatcher();
+    std::vector<std::uint8_t> response;
+
+    const std::uint8_t request[] = {0x22, 0xF1, 0x00};
+    const RequestResponse *entry = pMatcher->match(request, sizeof(request));
+    CPPUNIT_ASSERT(entry != nullptr && entry->isBinary);
+    ecuLuaScript.callLuaResponse(*entry, request, sizeof(request), response);
+    const std::vector<std::uint8_t> expected = {0x62, 0xF1, 0x00, 0x00, 0xFF, 0x00, 0x01};
+    CPPUNIT_ASSERT(response == expected);
+    // the hex convention of `getRawResponse()` is kept
+    CPPUNIT_ASSERT_EQUAL(std::string("62 F1 00 00 FF 00 01"), *ecuLuaScript.getRawResponse(*pMatcher, request, sizeof(request)));
+
+    // reading beyond the request returns nil
+    const std::uint8_t shortRequest[] = {0x22, 0xF2, 0x00};
+    ecuLuaScript.callLuaResponse(*pMatcher->match(shortRequest, sizeof(shortRequest)), shortRequest, sizeof(shortRequest), response);
+    CPPUNIT_ASSERT(response == std::vector<std::uint8_t>({'n', 'i', 'l'}));
+
+    // functions without `binary()` still use literal hex strings
+    const std::uint8_t hexRequest[] = {0x22, 0xF3, 0x01};
+    entry = pMatcher->match(hexRequest, sizeof(hexRequest));
+    CPPUNIT_ASSERT(entry != nullptr && !entry->isBinary);
+    ecuLuaScript.callLuaResponse(*entry, hexRequest, sizeof(hexRequest), response);
+    CPPUNIT_ASSERT(response == std::vector<std::uint8_t>({0x62, 0xF3, 0x01}));
+    std::remove(luaScript.c_str());
+}
+
+void EcuLuaScriptTest::testDtcTable()
+{
+    const std::string luaScript = "/tmp/ecu_lua_script_test_dtcs.lua";
+    std::ofstream(luaScript, std::ios::trunc)
+        << "Main = {\n"
+        << "    DTCs = {\n"
+        << "        [\"C0 12 34\"] = 0x09,\n"
+        << "        [\"01 23 45\"] = {\n"
+        << "            status = 0x2F,\n"
+        << "            snapshots = { [0x01] = \"01 F1 90 42\" },\n"
+        << "            extendedData = { [0x10] = \"05\" },\n"
+        << "        },\n"
+        << "    },\n"
+        << "    Raw = {\n"
+        << "        [\"31 01 00 01\"] = function (request)\n"
+        << "            setDTC(0xABCDEF, 0x08)\n"
+        << "            clearDTC(0xC01234)\n"
+        << "            return \"71 01 00 01 \" .. toByteResponse(getDTCStatus(0x012345), 1)\n"
+        << "        end\n"
+        << "    }\n"
+        << "}\n";
+    EcuLuaScript ecuLuaScript("Main", luaScript);
+    const std::shared_ptr<DtcStore> pStore = ecuLuaScript.getDtcStore();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), pStore->size());
+    std::vector<std::uint8_t> records;
+    CPPUNIT_ASSERT(pStore->appendSnapshotRecords(0x012345, DtcStore::ALL_RECORDS, records));
+    CPPUNIT_ASSERT(records == std::vector<std::uint8_t>({0x01, 0x23, 0x45, 0x2F, 0x01, 0x01, 0xF1, 0x90, 0x42}));
+    records.clear();
+    CPPUNIT_ASSERT(pStore->appendExtendedDataRecords(0x012345, 0x10, records));
+    CPPUNIT_ASSERT(records == std::vector<std::uint8_t>({0x01, 0x23, 0x45, 0x2F, 0x10, 0x05}));
+
+    const std::uint8_t request[] = {0x31, 0x01, 0x00, 0x01};
+    const auto pMatcher = ecuLuaScript.getRawRequestMatcher();
+    CPPUNIT_ASSERT_EQUAL(std::string("71 01 00 01 2F"), *ecuLuaScript.getRawResponse(*pMatcher, request, sizeof(request)));
+    std::uint8_t status;
+    CPPUNIT_ASSERT(pStore->getStatus(0xABCDEF, status));
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0x08), status);
+    CPPUNIT_ASSERT(!pStore->getStatus(0xC01234, status));
+    std::remove(luaScript.c_str());
+}
+
+void EcuLuaScriptTest::testSecurityAccessTable()
+{
+    const std::string luaScript = "/tmp/ecu_lua_script_test_security.lua";
+    std::ofstream(luaScript, std::ios::trunc)
+        << "Main = {\n"
+        << "    SecurityAccess = {\n"
+        << "        [0x01] = { algorithm = \"xor\", secret = \"11 22\", seedLength = 2, maxAttempts = 5 },\n"
+        << "        [0x03] = { algorithm = \"crc32\", delay = 1000 },\n"
+        << "        [0x05] = { key = function (seed) return seed .. \" FF\" end },\n"
+        << "        [0x07] = { algorithm = \"aes128\", secret = \"00\" },\n"
+        << "    },\n"
+        << "}\n";
+    EcuLuaScript ecuLuaScript("Main", luaScript);
+    std::vector<SecurityLevelConfiguration> levels = ecuLuaScript.getSecurityLevels();
+    std::sort(levels.begin(), levels.end(), [](const SecurityLevelConfiguration& a, const SecurityLevelConfiguration& b) {
+        return a.level < b.level;
+    });
+    // the AES-128 level has no valid secret
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), levels.size());
+
+    CPPUNIT_ASSERT(levels[0].algorithm == KeyAlgorithm::XOR);
+    CPPUNIT_ASSERT(levels[0].secret == std::vector<std::uint8_t>({0x11, 0x22}));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), levels[0].seedLength);
+    CPPUNIT_ASSERT_EQUAL(5u, levels[0].maxAttempts);
+
+    CPPUNIT_ASSERT(levels[1].algorithm == KeyAlgorithm::CRC);
+    CPPUNIT_ASSERT(levels[1].crcAlgorithm == CrcAlgorithm::CRC32);
+    CPPUNIT_ASSERT_EQUAL(std::int64_t(1000), std::int64_t(levels[1].delay.count()));
+
+    CPPUNIT_ASSERT(levels[2].algorithm == KeyAlgorithm::LUA);
+    const auto key = SecurityAccessService::calculateKey(levels[2], {0x12, 0x34});
+    CPPUNIT_ASSERT(key);
+    CPPUNIT_ASSERT(*key == std::vector<std::uint8_t>({0x12, 0x34, 0xFF}));
+    std::remove(luaScript.c_str());
+}
+
+void EcuLuaScriptTest::testPeriodicDataTable()
+{
+    const std::string luaScript = "/tmp/ecu_lua_script_test_periodic.lua";
+    std::ofstream(luaScript, std::ios::trunc)
+        << "Main = {\n"
+        << "    PeriodicData = { responseId = 0x6F1, fast = 25 },\n"
+        << "}\n"
+        << "Other = {\n"
+        << "    PeriodicData = { slow = 500 },\n"
+        << "}\n";
+    EcuLuaScript ecuLuaScript("Main", luaScript);
+    CPPUNIT_ASSERT(ecuLuaScript.hasPeriodicData());
+    const PeriodicDataConfiguration& configuration = ecuLuaScript.getPeriodicDataConfiguration();
+    CPPUNIT_ASSERT_EQUAL(canid_t(0x6F1), configuration.responseId);
+    CPPUNIT_ASSERT_EQUAL(std::int64_t(25), std::int64_t(configuration.fastRate.count()));
+    CPPUNIT_ASSERT_EQUAL(std::int64_t(DEFAULT_PERIODIC_SLOW_RATE.count()), std::int64_t(configuration.slowRate.count()));
+
+    // without a response ID
+    EcuLuaScript otherLuaScript("Other", luaScript);
+    CPPUNIT_ASSERT(!otherLuaScript.hasPeriodicData());
+    std::remove(luaScript.c_str());
+}
+
+void EcuLuaScriptTest::testObdTable()
+{
+    const std::string luaScript = "/tmp/ecu_lua_script_test_obd.lua";
+    std::ofstream(luaScript, std::ios::trunc)
+        << "Main = {\n"
+        << "    OBD = {\n"
+        << "        [0x01] = { [0x0D] = \"32\", [0x0C] = function(pid) return \"1A F8\" end },\n"
+        << "        [0x09] = { [0x02] = ascii(\"WVWZZZ1JZXW000001\") },\n"
+        << "        [0x22] = { [0x01] = \"00\" },\n"
+        << "    },\n"
+        << "}\n";
+    EcuLuaScript ecuLuaScript("Main", luaScript);
+    std::unique_ptr<ObdService> pObdService = ecuLuaScript.createObdService();
+    CPPUNIT_ASSERT(pObdService);
+
+    std::vector<std::uint8_t> response;
+    const std::vector<std::uint8_t> currentData = {0x01, 0x0C, 0x0D};
+    pObdService->proceedRequest(currentData.data(), currentData.size(), response);
+    CPPUNIT_ASSERT(response == std::vector<std::uint8_t>({0x41, 0x0C, 0x1A, 0xF8, 0x0D, 0x32}));
+
+    const std::vector<std::uint8_t> vin = {0x09, 0x02};
+    pObdService->proceedRequest(vin.data(), vin.size(), response);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3 + 17), response.size());
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t('W'), response[3]);
+
+    // only the modes 0x01 and 0x09 are served
+    CPPUNIT_ASSERT(!pObdService->isSupported(0x22, 0x01));
+    std::remove(luaScript.c_str());
+}
+
+void EcuLuaScriptTest::testSignalsTable()
+{
+    const std::string luaScript = "/tmp/ecu_lua_script_test_signals.lua";
+    std::ofstream(luaScript, std::ios::trunc)
+        << "Main = {\n"
+        << "    Signals = {\n"
+        << "        DIDs = {\n"
+        << "            [0xF40D] = { signal = \"TestVehicleSpeed\" },\n"
+        << "            [0xF40C] = {\n"
+        << "                { signal = \"TestEngineSpeed\", length = 16, scale = 0.25 },\n"
+        << "                { signal = \"TestVehicleSpeed\", start = 16 },\n"
+        << "            },\n"
+        << "        },\n"
+        << "        OBD = { [0x0D] = { signal = \"TestVehicleSpeed\" } },\n"
+        << "        PGNs = {\n"
+        << "            [0xF004] = { signal = \"TestEngineSpeed\", start = 24, length = 16, scale = 0.125 },\n"
+        << "            [\"F1 FE 00\"] = { cycleTime = 100, { signal = \"TestVehicleSpeed\", start = 8, length = 16, resolution = 1 / 256 } },\n"
+        << "        },\n"
+        << "    },\n"
+        << "}\n"
+        << "setSignal(\"TestVehicleSpeed\", 50)\n"
+        << "setSignal(\"TestEngineSpeed\", 1000)\n";
+    EcuLuaScript ecuLuaScript("Main", luaScript);
+    const std::shared_ptr<const SignalMappings> pMappings = ecuLuaScript.getSignalMappings();
+
+    const SignalRecord *pSpeed = pMappings->findDataIdentifier(0xF40D);
+    CPPUNIT_ASSERT(pSpeed != nullptr);
+    std::vector<std::uint8_t> bytes;
+    pSpeed->append(bytes);
+    CPPUNIT_ASSERT(bytes == std::vector<std::uint8_t>({0x32}));
+
+    const SignalRecord *pEngine = pMappings->findDataIdentifier(0xF40C);
+    CPPUNIT_ASSERT(pEngine != nullptr);
+    bytes.clear();
+    pEngine->append(bytes);
+    CPPUNIT_ASSERT(bytes == std::vector<std::uint8_t>({0x0F, 0xA0, 0x32}));
+
+    // PGNs are little endian with 8 bytes, the unused bytes are 0xFF
+    const SignalRecord *pPgn = pMappings->findPgn(0xF004);
+    CPPUNIT_ASSERT(pPgn != nullptr);
+    bytes.clear();
+    pPgn->overlay(bytes);
+    CPPUNIT_ASSERT(bytes == std::vector<std::uint8_t>({0xFF, 0xFF, 0xFF, 0x40, 0x1F, 0xFF, 0xFF, 0xFF}));
+    CPPUNIT_ASSERT_EQUAL(0u, pMappings->pgnCycleTimes.at(0xF004));
+
+    // an SPN template with the J1939 resolution and its own cycle time
+    pPgn = pMappings->findPgn(0xFEF1);
+    CPPUNIT_ASSERT(pPgn != nullptr);
+    bytes.clear();
+    pPgn->overlay(bytes);
+    CPPUNIT_ASSERT(bytes == std::vector<std::uint8_t>({0xFF, 0x00, 0x32, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}));
+    CPPUNIT_ASSERT_EQUAL(100u, pMappings->pgnCycleTimes.at(0xFEF1));
+
+    std::unique_ptr<ObdService> pObdService = ecuLuaScript.createObdService();
+    CPPUNIT_ASSERT(pObdService);
+    std::vector<std::uint8_t> response;
+    const std::vector<std::uint8_t> request = {0x01, 0x0D};
+    pObdService->proceedRequest(request.data(), request.size(), response);
+    CPPUNIT_ASSERT(response == std::vector<std::uint8_t>({0x41, 0x0D, 0x32}));
+    CPPUNIT_ASSERT(pMappings->findDataIdentifier(0xF40E) == nullptr);
+    std::remove(luaScript.c_str());
+}
+
+void EcuLuaScriptTest::testJ1939Name()
+{
+    const std::string luaScript = "/tmp/ecu_lua_script_test_j1939_name.lua";
+    std::ofstream(luaScript, std::ios::trunc)
+        << "Main = {\n"
+        << "    J1939SourceAddress = 0x21,\n"
+        << "    J1939Name = \"80 00 12 34 56 78 9A BC\",\n"
+        << "}\n";
+    EcuLuaScript ecuLuaScript("Main", luaScript);
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0x21), ecuLuaScript.getJ1939SourceAddress());
+    CPPUNIT_ASSERT_EQUAL(std::uint64_t(0x8000123456789ABCull), ecuLuaScript.getJ1939Name());
+
+    // the address claim is little endian
+    const std::uint8_t claim[] = {0xBC, 0x9A, 0x78, 0x56, 0x34, 0x12, 0x00, 0x80};
+    CPPUNIT_ASSERT_EQUAL(ecuLuaScript.getJ1939Name(), J1939Bus::parseName(claim));
+    std::remove(luaScript.c_str());
+}
+
+/**
+ * Tests that the 'PGNs' table is compiled once for all J1939 simulations of an
+ * ECU.
+ */
+void EcuLuaScriptTest::testJ1939Tables()
+{
+    const std::string luaScript = "/tmp/ecu_lua_script_test_j1939_tables.lua";
+    std::ofstream(luaScript, std::ios::trunc)
+        << "Main = {\n"
+        << "    J1939SourceAddress = 0x21,\n"
+        << "    PGNs = {\n"
+        << "        [\"65265\"] = { payload = \"FF FF FF FF FF FF FF FF\", cycleTime = 100 },\n"
+        << "        [\"65262\"] = { payload = \"7F FF FF FF FF FF FF FF\" },\n"
+        << "    },\n"
+        << "}\n";
+    EcuLuaScript ecuLuaScript("Main", luaScript);
+    const auto pTables = ecuLuaScript.getJ1939Tables();
+    CPPUNIT_ASSERT(pTables != nullptr);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), pTables->pgnIndex.size());
+    CPPUNIT_ASSERT(pTables->pgnIndex.find(65265) != nullptr);
+    // shared by the simulations on the other interfaces
+    CPPUNIT_ASSERT(ecuLuaScript.getJ1939Tables() == pTables);
+    std::remove(luaScript.c_str());
+}
+
+/**
+ * Tests the socket settings of the `IsoTp` table and the defaults without it.
+ */
+void EcuLuaScriptTest::testIsoTpConfiguration()
+{
+    const std::string luaScript = "/tmp/ecu_lua_script_test_isotp.lua";
+    std::ofstream(luaScript, std::ios::trunc)
+        << "Main = {\n"
+        << "    RequestId = 0x100,\n"
+        << "    ResponseId = 0x200,\n"
+        << "    J1939ReceiveBuffer = 262144,\n"
+        << "    IsoTp = { blockSize = 8, stMin = 0xF5, maxWaitFrames = 2, receiveBuffer = 65536,\n"
+        << "              maxMessageSize = 0x100000 },\n"
+        << "}\n"
+        << "Other = { RequestId = 0x101, ResponseId = 0x201 }\n"
+        << "Fd = {\n"
+        << "    RequestId = 0x102,\n"
+        << "    ResponseId = 0x202,\n"
+        << "    IsoTp = { canFd = true, bitRateSwitch = true, padding = 0xAA, extendedAddress = 0xF1 },\n"
+        << "}\n";
+    EcuLuaScript ecuLuaScript("Main", luaScript);
+    const IsoTpConfiguration& configuration = ecuLuaScript.getIsoTpConfiguration();
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(8), configuration.blockSize);
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0xF5), configuration.stMin);
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(2), configuration.maxWaitFrames);
+    CPPUNIT_ASSERT_EQUAL(65536, configuration.receiveBufferSize);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0x100000), configuration.maxMessageSize);
+    CPPUNIT_ASSERT_EQUAL(262144, ecuLuaScript.getJ1939ReceiveBufferSize());
+
+    EcuLuaScript otherLuaScript("Other", luaScript);
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0), otherLuaScript.getIsoTpConfiguration().blockSize);
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0), otherLuaScript.getIsoTpConfiguration().stMin);
+    CPPUNIT_ASSERT_EQUAL(0, otherLuaScript.getIsoTpConfiguration().receiveBufferSize);
+    CPPUNIT_ASSERT_EQUAL(0, otherLuaScript.getJ1939ReceiveBufferSize());
+    CPPUNIT_ASSERT(!otherLuaScript.getIsoTpConfiguration().isCanFd);
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(8), otherLuaScript.getIsoTpConfiguration().txDataLength);
+    CPPUNIT_ASSERT(!otherLuaScript.getIsoTpConfiguration().extendedAddress);
+    CPPUNIT_ASSERT_EQUAL(MAX_UDS_MSG_SIZE, otherLuaScript.getIsoTpConfiguration().maxMessageSize);
+
+    // CAN FD frames are 64 bytes unless `txDataLength` is given
+    EcuLuaScript fdLuaScript("Fd", luaScript);
+    const IsoTpConfiguration& fdConfiguration = fdLuaScript.getIsoTpConfiguration();
+    CPPUNIT_ASSERT(fdConfiguration.isCanFd);
+    CPPUNIT_ASSERT(fdConfiguration.isBitRateSwitch);
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(64), fdConfiguration.txDataLength);
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0xAA), fdConfiguration.padding);
+    CPPUNIT_ASSERT(fdConfiguration.extendedAddress && *fdConfiguration.extendedAddress == 0xF1);
+    CPPUNIT_ASSERT(!fdConfiguration.rxExtendedAddress);
+    std::remove(luaScript.c_str());
+}
+
+/**
+ * Tests the lists of static responses in the `Raw` table.
+ */
+void EcuLuaScriptTest::testResponseSequence()
+{
+    const std::string luaScript = "/tmp/ecu_lua_script_test_sequence.lua";
+    std::ofstream(luaScript, std::ios::trunc)
+        << "Main = {\n"
+        << "    RequestId = 0x100,\n"
+        << "    ResponseId = 0x200,\n"
+        << "    Raw = {\n"
+        << "        [\"31 03 02 00\"] = { \"71 03 02 00 01\", \"71 03 02 00 02\" },\n"
+        << "        [\"31 03 02 01\"] = { \"71 03 02 01 01\", \"71 03 02 01 02\", hold = true },\n"
+        << "        [\"31 03 02 02\"] = { \"71 03 02 02 01\", \"71 03 02 02 02\", session = true },\n"
+        << "    },\n"
+        << "}\n";
+    SessionController sessionController;
+    EcuLuaScript ecuLuaScript("Main", luaScript);
+    ecuLuaScript.registerSessionController(&sessionController);
+    const auto pMatcher = ecuLuaScript.getRawRequestMatcher();
+    auto respond = [&ecuLuaScript, &pMatcher](std::uint8_t routine) {
+        const std::uint8_t request[] = {0x31, 0x03, 0x02, routine};
+        return *ecuLuaScript.getRawResponse(*pMatcher, request, sizeof(request));
+    };
+
+    // starts over after the last response
+    CPPUNIT_ASSERT_EQUAL(std::string("71 03 02 00 01"), respond(0x00));
+    CPPUNIT_ASSERT_EQUAL(std::string("71 03 02 00 02"), respond(0x00));
+    CPPUNIT_ASSERT_EQUAL(std::string("71 03 02 00 01"), respond(0x00));
+
+    // keeps the last response until the ECU is reset
+    CPPUNIT_ASSERT_EQUAL(std::string("71 03 02 01 01"), respond(0x01));
+    CPPUNIT_ASSERT_EQUAL(std::string("71 03 02 01 02"), respond(0x01));
+    CPPUNIT_ASSERT_EQUAL(std::string("71 03 02 01 02"), respond(0x01));
+    sessionController.setCurrentUdsSession(UdsSession::EXTENDED);
+    CPPUNIT_ASSERT_EQUAL(std::string("71 03 02 01 02"), respond(0x01));
+    sessionController.countEcuReset();
+    CPPUNIT_ASSERT_EQUAL(std::string("71 03 02 01 01"), respond(0x01));
+
+    // starts over when the session changes
+    CPPUNIT_ASSERT_EQUAL(std::string("71 03 02 02 01"), respond(0x02));
+    CPPUNIT_ASSERT_EQUAL(std::string("71 03 02 02 02"), respond(0x02));
+    sessionController.setCurrentUdsSession(UdsSession::DEFAULT);
+    CPPUNIT_ASSERT_EQUAL(std::string("71 03 02 02 01"), respond(0x02));
+    std::remove(luaScript.c_str());
+}
+
+/**
+ * Tests the `Raw` tables of the sessions, which replace single entries of the
+ * `Raw` table of the ECU.
+ */
+void EcuLuaScriptTest::testSessionRawTables()
+{
+    const std::string luaScript = "/tmp/ecu_lua_script_test_session_raw.lua";
+    std::ofstream(luaScript, std::ios::trunc)
+        << "Main = {\n"
+        << "    RequestId = 0x100,\n"
+        << "    ResponseId = 0x200,\n"
+        << "    Raw = { [\"22 F1 86\"] = \"62 F1 86 01\", [\"22 F1 90\"] = \"62 F1 90 00\" },\n"
+        << "    Extended = { Raw = { [\"22F186\"] = \"62 F1 86 03\", [\"31 01 FF 00\"] = \"71 01 FF 00\" } },\n"
+        << "    [0x40] = { Raw = { [\"22 F1 86\"] = \"62 F1 86 40\" } },\n"
+        << "}\n";
+    EcuLuaScript ecuLuaScript("Main", luaScript);
+    auto respond = [&ecuLuaScript](std::uint8_t session, const std::vector<std::uint8_t>& request) {
+        const auto pMatcher = ecuLuaScript.getRawRequestMatcher(session);
+        return ecuLuaScript.getRawResponse(*pMatcher, request.data(), std::uint32_t(request.size()));
+    };
+
+    CPPUNIT_ASSERT_EQUAL(std::string("62 F1 86 01"), *respond(UdsSession::DEFAULT, {0x22, 0xF1, 0x86}));
+    CPPUNIT_ASSERT(!respond(UdsSession::DEFAULT, {0x31, 0x01, 0xFF, 0x00}));
+    CPPUNIT_ASSERT_EQUAL(std::string("62 F1 86 03"), *respond(UdsSession::EXTENDED, {0x22, 0xF1, 0x86}));
+    CPPUNIT_ASSERT_EQUAL(std::string("71 01 FF 00"), *respond(UdsSession::EXTENDED, {0x31, 0x01, 0xFF, 0x00}));
+    // the other entries of the ECU table are kept
+    CPPUNIT_ASSERT_EQUAL(std::string("62 F1 90 00"), *respond(UdsSession::EXTENDED, {0x22, 0xF1, 0x90}));
+    CPPUNIT_ASSERT_EQUAL(std::string("62 F1 86 40"), *respond(0x40, {0x22, 0xF1, 0x86}));
+    // sessions without own table use the one of the ECU
+    CPPUNIT_ASSERT_EQUAL(std::string("62 F1 86 01"), *respond(UdsSession::PROGRAMMING, {0x22, 0xF1, 0x86}));
+    CPPUNIT_ASSERT(ecuLuaScript.getRawRequestMatcher(UdsSession::PROGRAMMING) == ecuLuaScript.getRawRequestMatcher());
+    std::remove(luaScript.c_str());
+}
+
+/**
+ * The Lua functions of one ECU are called one after the other, also if the
+ * requests come from several threads (e.g. UDS, DoIP and a broadcast), so a
+ * function never sees the state of another call half way through.
+ */
+void EcuLuaScriptTest::testSerializedLuaCalls()
+{
+    constexpr unsigned int NUM_THREADS = 4;
+    constexpr unsigned int NUM_CALLS = 50;
+    const std::string luaScript = "/tmp/ecu_lua_script_test_serialized.lua";
+    // the counter is read and written with a loop in between, so calls
+    // running at the same time would return the same value
+    std::ofstream(luaScript, std::ios::trunc)
+        << "counter = 0\n"
+        << "function count()\n"
+        << "    local value = counter\n"
+        << "    for i = 1, 1000 do end\n"
+        << "    counter = value + 1\n"
+        << "    return string.format(\"%04X\", counter)\n"
+        << "end\n"
+        << "Main = {\n"
+        << "    RequestId = 0x100,\n"
+        << "    ResponseId = 0x200,\n"
+        << "    ReadDataByIdentifier = { [\"F191\"] = function () return count() end },\n"
+        << "    Raw = { [\"31 02 FF 00\"] = function (request) return \"71 02 \" .. count() end },\n"
+        << "}\n";
+    EcuLuaScript ecuLuaScript("Main", luaScript);
+    const auto pMatcher = ecuLuaScript.getRawRequestMatcher();
+    const std::uint8_t routine[] = {0x31, 0x02, 0xFF, 0x00};
+
+    std::mutex countersMutex;
+    std::vector<std::string> counters;
+    std::vector<std::thread> callers;
+    for (unsigned int i = 0; i < NUM_THREADS; ++i)
+    {
+        callers.emplace_back([&, i]()
+        {
+            for (unsigned int j = 0; j < NUM_CALLS; ++j)
+            {
+                std::string counter;
+                if (i % 2 == 0)
+                {
+                    counter = ecuLuaScript.getRawResponse(*pMatcher, routine, sizeof(routine)).value_or("").substr(6);
+                }
+                else
+                {
+                    counter = ecuLuaScript.getDataByIdentifier("F191");
+                }
+                std::lock_guard<std::mutex> lock(countersMutex);
+                counters.push_back(counter);
+            }
+        });
+    }
+    for (std::thread& caller : callers)
+    {
+        caller.join();
+    }
+
+    // every call got a counter of its own
+    std::sort(counters.begin(), counters.end());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(NUM_THREADS * NUM_CALLS), counters.size());
+    CPPUNIT_ASSERT(std::adjacent_find(counters.begin(), counters.end()) == counters.end());
+    CPPUNIT_ASSERT_EQUAL(std::string("0001"), counters.front());
+    CPPUNIT_ASSERT_EQUAL(std::string("00C8"), counters.back());
+    std::remove(luaScript.c_str());
+}
+
+/**
+ * Static `Raw` and `ReadDataByIdentifier` entries are compiled into their
+ * bytes at load time and give the same responses as the Lua table; entries
+ * defined as Lua function are not compiled and called on every request.
+ */
+void EcuLuaScriptTest::testPrecompiledResponses()
+{
+    const std::string luaScript = "/tmp/ecu_lua_script_test_precompiled.lua";
+    std::ofstream(luaScript, std::ios::trunc)
+        << "local counter = 0\n"
+        << "Main = {\n"
+        << "    RequestId = 0x100,\n"
+        << "    ResponseId = 0x200,\n"
+        << "    ReadDataByIdentifier = {\n"
+        << "        [\"F190\"] = \"SALGA2EV9HA298784\",\n"
+        << "        [\"F191\"] = function () counter = counter + 1; return \"0\" .. counter end,\n"
+        << "    },\n"
+        << "    Raw = {\n"
+        << "        [\"22 F1 86\"] = \"62 F1 86 01\",\n"
+        << "        [\"22 F1 XX\"] = \"7F 22 31\",\n"
+        << "        [\"31 01 *\"] = \"71 01 FF 00\",\n"
+        << "        [\"31 02 FF 00\"] = function (request) counter = counter + 1; return \"71 02 FF 0\" .. counter end,\n"
+        << "    },\n"
+        << "    Extended = {\n"
+        << "        ReadDataByIdentifier = { [\"F190\"] = \"WP0ZZZ99ZTS392124\" },\n"
+        << "        Raw = { [\"22 F1 86\"] = \"62 F1 86 03\" },\n"
+        << "    },\n"
+        << "}\n";
+    EcuLuaScript ecuLuaScript("Main", luaScript);
+
+    // the compiled entry of a static response, its bytes and the response of the table are the same
+    const auto checkStatic = [&ecuLuaScript](std::uint8_t session, const std::vector<std::uint8_t>& request,
+                                             const std::string& literal)
+    {
+        const auto pMatcher = ecuLuaScript.getRawRequestMatcher(session);
+        const RequestResponse *pResponse = pMatcher->match(request.data(), request.size());
+        CPPUNIT_ASSERT(pResponse != nullptr);
+        CPPUNIT_ASSERT(!pResponse->isLuaFunction());
+        CPPUNIT_ASSERT_EQUAL(literal, pResponse->literal);
+        CPPUNIT_ASSERT(EcuLuaScript::literalHexStrToBytes(literal) == pResponse->bytes);
+        CPPUNIT_ASSERT(pResponse->bytes == pResponse->getBytes(0, 0));
+        CPPUNIT_ASSERT_EQUAL(literal, *ecuLuaScript.getRawResponse(*pMatcher, request.data(),
+                                                                   std::uint32_t(request.size())));
+    };
+    checkStatic(UdsSession::DEFAULT, {0x22, 0xF1, 0x86}, "62 F1 86 01");
+    // placeholders and wildcards
+    checkStatic(UdsSession::DEFAULT, {0x22, 0xF1, 0x87}, "7F 22 31");
+    checkStatic(UdsSession::DEFAULT, {0x31, 0x01}, "71 01 FF 00");
+    checkStatic(UdsSession::DEFAULT, {0x31, 0x01, 0x02, 0x03}, "71 01 FF 00");
+    // the table of the session and the entries of the ECU it keeps
+    checkStatic(UdsSession::EXTENDED, {0x22, 0xF1, 0x86}, "62 F1 86 03");
+    checkStatic(UdsSession::EXTENDED, {0x31, 0x01, 0xFF, 0x00}, "71 01 FF 00");
+
+    // a function is called on every request
+    const auto pMatcher = ecuLuaScript.getRawRequestMatcher();
+    const std::uint8_t routine[] = {0x31, 0x02, 0xFF, 0x00};
+    const RequestResponse *pFunction = pMatcher->match(routine, sizeof(routine));
+    CPPUNIT_ASSERT(pFunction != nullptr);
+    CPPUNIT_ASSERT(pFunction->isLuaFunction());
+    CPPUNIT_ASSERT(pFunction->bytes.empty());
+    CPPUNIT_ASSERT_EQUAL(std::string("71 02 FF 01"), *ecuLuaScript.getRawResponse(*pMatcher, routine, sizeof(routine)));
+    CPPUNIT_ASSERT_EQUAL(std::string("71 02 FF 02"), *ecuLuaScript.getRawResponse(*pMatcher, routine, sizeof(routine)));
+
+    // the index of the 'ReadDataByIdentifier' tables
+    const auto pIndices = ecuLuaScript.getDataIdentifierIndices();
+    const DataIdentifierIndex::Entry *pEntry = EcuLuaScript::findDataIdentifier(*pIndices, "", 0xF190);
+    CPPUNIT_ASSERT(pEntry != nullptr);
+    CPPUNIT_ASSERT(!pEntry->isLuaFunction);
+    CPPUNIT_ASSERT_EQUAL(std::string("SALGA2EV9HA298784"), pEntry->data);
+    CPPUNIT_ASSERT_EQUAL(pEntry->data, ecuLuaScript.getDataByIdentifier("F190"));
+    const std::string extended = EcuLuaScript::getSessionTableName(UdsSession::EXTENDED);
+    pEntry = EcuLuaScript::findDataIdentifier(*pIndices, extended, 0xF190);
+    CPPUNIT_ASSERT(pEntry != nullptr);
+    CPPUNIT_ASSERT(!pEntry->isLuaFunction);
+    CPPUNIT_ASSERT_EQUAL(std::string("WP0ZZZ99ZTS392124"), pEntry->data);
+    CPPUNIT_ASSERT_EQUAL(pEntry->data, ecuLuaScript.getDataByIdentifier("F190", extended));
+    pEntry = EcuLuaScript::findDataIdentifier(*pIndices, "", 0xF191);
+    CPPUNIT_ASSERT(pEntry != nullptr);
+    CPPUNIT_ASSERT(pEntry->isLuaFunction);
+    CPPUNIT_ASSERT_EQUAL(std::string("03"), ecuLuaScript.getDataByIdentifier("F191"));
+    CPPUNIT_ASSERT_EQUAL(std::string("04"), ecuLuaScript.readDataIdentifier("", *pEntry));
+    std::remove(luaScript.c_str());
+}
+
+void EcuLuaScriptTest::testSessionConfigurations()
+{
+    const std::string luaScript = "/tmp/ecu_lua_script_test_sessions.lua";
+    std::ofstream(luaScript, std::ios::trunc)
+        << "Main = {\n"
+        << "    RequestId = 0x100,\n"
+        << "    ResponseId = 0x200,\n"
+        << "    Sessions = {\n"
+        << "        [0x03] = { s3 = 10000 },\n"
+        << "        [0x60] = { p2 = 25, p2Star = 2000, services = { 0x22, 0x31 } },\n"
+        << "        [0x90] = { s3 = 1000 },\n"
+        << "    },\n"
+        << "}\n";
+    EcuLuaScript ecuLuaScript("Main", luaScript);
+    const auto& configurations = ecuLuaScript.getSessionConfigurations();
+    // 0x90 is not a valid session ID
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), configurations.size());
+    CPPUNIT_ASSERT(configurations.at(0x03).s3 == std::chrono::milliseconds(10000));
+    CPPUNIT_ASSERT(configurations.at(0x03).p2 == DEFAULT_SESSION_P2);
+    CPPUNIT_ASSERT(configurations.at(0x03).allowedServices.all());
+    CPPUNIT_ASSERT(configurations.at(0x60).s3 == DEFAULT_S3_SERVER);
+    CPPUNIT_ASSERT(configurations.at(0x60).p2 == std::chrono::milliseconds(25));
+    CPPUNIT_ASSERT(configurations.at(0x60).p2Star == std::chrono::milliseconds(2000));
+
+    SessionController sessionController;
+    CPPUNIT_ASSERT(!sessionController.isSessionSupported(0x60));
+    sessionController.configureSessions(configurations);
+    CPPUNIT_ASSERT(sessionController.isSessionSupported(0x60));
+    CPPUNIT_ASSERT(sessionController.isSessionSupported(UdsSession::PROGRAMMING));
+    CPPUNIT_ASSERT(!sessionController.isSessionSupported(0x61));
+    CPPUNIT_ASSERT(sessionController.isServiceAllowed(0x2E));
+    sessionController.setCurrentUdsSession(UdsSession(0x60));
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0x60), std::uint8_t(sessionController.getCurrentUdsSession()));
+    CPPUNIT_ASSERT(sessionController.isServiceAllowed(0x22));
+    CPPUNIT_ASSERT(!sessionController.isServiceAllowed(0x2E));
+    // the session can always be kept and left
+    CPPUNIT_ASSERT(sessionController.isServiceAllowed(0x10));
+    CPPUNIT_ASSERT(sessionController.isServiceAllowed(0x3E));
+    // unsupported sessions are not set
+    sessionController.setCurrentUdsSession(UdsSession(0x61));
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0x60), std::uint8_t(sessionController.getCurrentUdsSession()));
+    std::remove(luaScript.c_str());
+}
+
+void EcuLuaScriptTest::testSleepingResponse()
+{
+    const std::string luaScript = "/tmp/ecu_lua_script_test_sleep.lua";
+    std::ofstream(luaScript, std::ios::trunc)
+        << "Main = {\n"
+        << "    RequestId = 0x100,\n"
+        << "    ResponseId = 0x200,\n"
+        << "    Raw = {\n"
+        << "        [\"31 01 02 00\"] = function (request) sleep(300) return \"71 01 02 00\" end,\n"
+        << "        [\"22 F1 90\"] = function (request) return \"62 F1 90 01\" end,\n"
+        << "    },\n"
+        << "}\n";
+    EcuLuaScript ecuLuaScript("Main", luaScript);
+    const auto pMatcher = ecuLuaScript.getRawRequestMatcher();
+    const std::uint8_t routine[] = {0x31, 0x01, 0x02, 0x00};
+    const std::uint8_t identifier[] = {0x22, 0xF1, 0x90};
+
+    std::vector<std::uint8_t> sleepingResponse;
+    std::promise<void> finished;
+    const auto start = std::chrono::steady_clock::now();
+    ecuLuaScript.postLuaResponse(pMatcher, *pMatcher->match(routine, sizeof(routine)), routine, sizeof(routine),
+                                 sleepingResponse, [&finished]() { finished.set_value(); });
+    // served while the other function sleeps
+    CPPUNIT_ASSERT_EQUAL(std::string("62 F1 90 01"), *ecuLuaScript.getRawResponse(*pMatcher, identifier, sizeof(identifier)));
+    CPPUNIT_ASSERT(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(300));
+    finished.get_future().wait();
+    CPPUNIT_ASSERT(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(300));
+    CPPUNIT_ASSERT(sleepingResponse == std::vector<std::uint8_t>({0x71, 0x01, 0x02, 0x00}));
+    // the coroutine is reused
+    CPPUNIT_ASSERT_EQUAL(std::string("71 01 02 00"), *ecuLuaScript.getRawResponse(*pMatcher, routine, sizeof(routine)));
+    std::remove(luaScript.c_str());
+}
+
+/// records the messages of `sendRaw()`
+class RecordingTransport : public UdsTransport
+{
+public:
+    int sendData(const void* buffer, std::size_t size) noexcept override
+    {
+        const std::uint8_t *bytes = static_cast<const std::uint8_t*> (buffer);
+        std::lock_guard<std::mutex> lock(mutex);
+        messages.emplace_back(bytes, bytes + size);
+        return int(size);
+    }
+
+    std::size_t getCount()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return messages.size();
+    }
+
+    std::mutex mutex;
+    std::vector<std::vector<std::uint8_t>> messages;
+};
+
+void EcuLuaScriptTest::testDeferredSendRaw()
+{
+    const std::string luaScript = "/tmp/ecu_lua_script_test_send_raw.lua";
+    std::ofstream(luaScript, std::ios::trunc)
+        << "Main = {\n"
+        << "    Raw = {\n"
+        << "        [\"31 01 02 00\"] = function (request)\n"
+        << "            sendRaw(\"7F 31 78\")\n"
+        << "            sendRawBatch({\"7F 31 78\", \"71 01 02 00 01\"})\n"
+        << "            return \"71 01 02 00 02\"\n"
+        << "        end,\n"
+        << "        [\"31 01 03 00\"] = function (request)\n"
+        << "            sendRaw(\"7F 31 78\")\n"
+        << "            sleep(300)\n"
+        << "            return \"71 01 03 00\"\n"
+        << "        end,\n"
+        << "    }\n"
+        << "}\n";
+    EcuLuaScript ecuLuaScript("Main", luaScript);
+    RecordingTransport transport;
+    ecuLuaScript.registerTransport(&transport);
+    const auto pMatcher = ecuLuaScript.getRawRequestMatcher();
+    const std::uint8_t routine[] = {0x31, 0x01, 0x02, 0x00};
+    std::vector<std::uint8_t> response;
+
+    // the messages are sent in order, before the response of the function
+    ecuLuaScript.callLuaResponse(*pMatcher->match(routine, sizeof(routine)), routine, sizeof(routine), response);
+    CPPUNIT_ASSERT(response == std::vector<std::uint8_t>({0x71, 0x01, 0x02, 0x00, 0x02}));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), transport.getCount());
+    CPPUNIT_ASSERT(transport.messages[0] == std::vector<std::uint8_t>({0x7F, 0x31, 0x78}));
+    CPPUNIT_ASSERT(transport.messages[1] == std::vector<std::uint8_t>({0x7F, 0x31, 0x78}));
+    CPPUNIT_ASSERT(transport.messages[2] == std::vector<std::uint8_t>({0x71, 0x01, 0x02, 0x00, 0x01}));
+
+    // a sleeping function sends its messages before it sleeps
+    const std::uint8_t sleepingRoutine[] = {0x31, 0x01, 0x03, 0x00};
+    std::vector<std::uint8_t> sleepingResponse;
+    std::promise<void> finished;
+    ecuLuaScript.postLuaResponse(pMatcher, *pMatcher->match(sleepingRoutine, sizeof(sleepingRoutine)), sleepingRoutine,
+                                 sizeof(sleepingRoutine), sleepingResponse, [&finished]() { finished.set_value(); });
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+    while (transport.getCount() < 4 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CPPUNIT_ASSERT_EQUAL(std::size_t(4), transport.getCount());
+    CPPUNIT_ASSERT(sleepingResponse.empty());
+    finished.get_future().wait();
+    CPPUNIT_ASSERT(sleepingResponse == std::vector<std::uint8_t>({0x71, 0x01, 0x03, 0x00}));
+    ecuLuaScript.registerTransport(nullptr);
+    std::remove(luaScript.c_str());
+}
+
+#ifdef USE_LUAJIT
+void EcuLuaScriptTest::testDirectRawFunction()
+{
+    const std::string luaScript = "/tmp/ecu_lua_script_test_direct.lua";
+    std::ofstream(luaScript, std::ios::trunc)
+        << "Main = {\n"
+        << "    Raw = {\n"
+        << "        [\"22 F1 XX\"] = direct(function (request, length)\n"
+        << "            local response = responseBuffer(length + 1)\n"
+        << "            response[0] = 0x62\n"
+        << "            for i = 1, length - 1 do response[i] = request[i] end\n"
+        << "            response[length] = 0x2A\n"
+        << "        end),\n"
+        << "        [\"22 F2 XX\"] = direct(function (request, length) end),\n"
+        << "    }\n"
+        << "}\n";
+    EcuLuaScript ecuLuaScript("Main", luaScript);
+    const auto pMatcher = ecuLuaScript.getRawRequestMatcher();
+    std::vector<std::uint8_t> response;
+
+    const std::uint8_t request[] = {0x22, 0xF1, 0x90};
+    const RequestResponse *entry = pMatcher->match(request, sizeof(request));
+    CPPUNIT_ASSERT(entry != nullptr && entry->isDirect);
+    ecuLuaScript.callLuaResponse(*entry, request, sizeof(request), response);
+    CPPUNIT_ASSERT(response == std::vector<std::uint8_t>({0x62, 0xF1, 0x90, 0x2A}));
+    CPPUNIT_ASSERT_EQUAL(std::string("62 F1 90 2A"), *ecuLuaScript.getRawResponse(*pMatcher, request, sizeof(request)));
+
+    // no response without `responseBuffer()`
+    const std::uint8_t silentRequest[] = {0x22, 0xF2, 0x00};
+    ecuLuaScript.callLuaResponse(*pMatcher->match(silentRequest, sizeof(silentRequest)), silentRequest,
+                                 sizeof(silentRequest), response);
+    CPPUNIT_ASSERT(response.empty());
+    std::remove(luaScript.c_str());
+}
+#else
+void EcuLuaScriptTest::testLuaMemoryLimit()
+{
+    const std::string luaScript = "/tmp/ecu_lua_script_test_memory.lua";
+    std::ofstream(luaScript, std::ios::trunc)
+        << "Main = {\n"
+        << "    Lua = { memoryLimit = 512 * 1024, gc = \"generational\" },\n"
+        << "    Raw = {\n"
+        << "        [\"31 01 FF 00\"] = function (request)\n"
+        << "            local t = {}\n"
+        << "            for i = 1, 1000000 do t[i] = i end\n"
+        << "            return \"71 01 FF 00\"\n"
+        << "        end,\n"
+        << "        [\"22 F1 90\"] = function (request) return \"62 F1 90 01\" end,\n"
+        << "    }\n"
+        << "}\n";
+    EcuLuaScript ecuLuaScript("Main", luaScript);
+    const auto pMatcher = ecuLuaScript.getRawRequestMatcher();
+    const auto pMemory = ecuLuaScript.getLuaMemoryStatistics();
+    CPPUNIT_ASSERT(pMemory->usedBytes > 0);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(512 * 1024), pMemory->limitBytes.load());
+
+    // the function runs out of memory, the state stays usable
+    const std::uint8_t routine[] = {0x31, 0x01, 0xFF, 0x00};
+    CPPUNIT_ASSERT_EQUAL(std::string(), *ecuLuaScript.getRawResponse(*pMatcher, routine, sizeof(routine)));
+    CPPUNIT_ASSERT(pMemory->failedAllocations > 0);
+    CPPUNIT_ASSERT(pMemory->peakBytes <= std::size_t(512 * 1024));
+    const std::uint8_t identifier[] = {0x22, 0xF1, 0x90};
+    CPPUNIT_ASSERT_EQUAL(std::string("62 F1 90 01"), *ecuLuaScript.getRawResponse(*pMatcher, identifier, sizeof(identifier)));
+    std::remove(luaScript.c_str());
 }
+#endif
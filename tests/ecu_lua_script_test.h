@@ -21,6 +21,30 @@ class EcuLuaScriptTest : public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST(testAscii);
     CPPUNIT_TEST(testToByteResponse);
     CPPUNIT_TEST(testGetRaw);
+    CPPUNIT_TEST(testReload);
+    CPPUNIT_TEST(testIsInDoIPEntity);
+    CPPUNIT_TEST(testInterfaces);
+    CPPUNIT_TEST(testBinaryRawFunction);
+    CPPUNIT_TEST(testDtcTable);
+    CPPUNIT_TEST(testSecurityAccessTable);
+    CPPUNIT_TEST(testPeriodicDataTable);
+    CPPUNIT_TEST(testObdTable);
+    CPPUNIT_TEST(testSignalsTable);
+    CPPUNIT_TEST(testJ1939Name);
+    CPPUNIT_TEST(testJ1939Tables);
+    CPPUNIT_TEST(testIsoTpConfiguration);
+    CPPUNIT_TEST(testResponseSequence);
+    CPPUNIT_TEST(testSessionRawTables);
+    CPPUNIT_TEST(testPrecompiledResponses);
+    CPPUNIT_TEST(testSerializedLuaCalls);
+    CPPUNIT_TEST(testSessionConfigurations);
+    CPPUNIT_TEST(testSleepingResponse);
+    CPPUNIT_TEST(testDeferredSendRaw);
+#ifdef USE_LUAJIT
+    CPPUNIT_TEST(testDirectRawFunction);
+#else
+    CPPUNIT_TEST(testLuaMemoryLimit);
+#endif
 
     CPPUNIT_TEST_SUITE_END();
 
@@ -40,6 +64,30 @@ private:
     void testAscii();
     void testToByteResponse();
     void testGetRaw();
+    void testReload();
+    void testIsInDoIPEntity();
+    void testInterfaces();
+    void testBinaryRawFunction();
+    void testDtcTable();
+    void testSecurityAccessTable();
+    void testPeriodicDataTable();
+    void testObdTable();
+    void testSignalsTable();
+    void testJ1939Name();
+    void testJ1939Tables();
+    void testIsoTpConfiguration();
+    void testResponseSequence();
+    void testSessionRawTables();
+    void testPrecompiledResponses();
+    void testSerializedLuaCalls();
+    void testSessionConfigurations();
+    void testSleepingResponse();
+    void testDeferredSendRaw();
+#ifdef USE_LUAJIT
+    void testDirectRawFunction();
+#else
+    void testLuaMemoryLimit();
+#endif
 
 };
 
@@ -14,6 +14,7 @@
 #include <array>
 #include <cstdint>
 #include <cstring>
+#include <unistd.h>
 
 const std::string ECU_IDENT = "PCM";
 const std::string LUA_SCRIPT = "tests/test_config_dir/testscript06.lua";
@@ -27,10 +28,11 @@ CPPUNIT_TEST_SUITE_REGISTRATION(ElectronicControlUnitTest);
 
 void startEcuServer()
 {
-    auto script = std::make_unique<EcuLuaScript>(ECU_IDENT, LUA_SCRIPT);
-    requId = script->getRequestId();
-    respId = script->getResponseId();
-    ElectronicControlUnit(DEVICE, std::move(script));
+    EcuLuaScript script(ECU_IDENT, LUA_SCRIPT);
+    requId = script.getRequestId();
+    respId = script.getResponseId();
+    ElectronicControlUnit ecu(DEVICE, &script);
+    ecu.waitForSimulationEnd();
 }
 
 ElectronicControlUnitTest::ElectronicControlUnitTest()
@@ -99,6 +101,25 @@ void ElectronicControlUnitTest::testElectronicControlUnit()
     testThread.detach();
 }
 
+/**
+ * The receiver threads are woken up by the stop, they don't wait for a
+ * message, which would never come.
+ */
+void ElectronicControlUnitTest::testStopSimulation()
+{
+    TestReceiver testReceiver(requId, respId, DEVICE);
+    std::thread testThread(&IsoTpReceiver::readData, &testReceiver);
+    usleep(4000);
+    testReceiver.stopReceiver();
+    testThread.join();
+    testReceiver.closeReceiver();
+
+    EcuLuaScript script(ECU_IDENT, LUA_SCRIPT);
+    ElectronicControlUnit ecu(DEVICE, &script);
+    usleep(4000);
+    ecu.stopSimulation();
+}
+
 /**
  * Compares the incoming response data from the corresponding `UdsReceiver` with
  * the expected internal data set. This is done by the 
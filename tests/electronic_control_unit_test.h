@@ -8,8 +8,7 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 #include "isotp_receiver.h"
-
-constexpr size_t MAX_UDS_MSG_SIZE = 4096;
+#include "isotp_sender.h"
 
 /**
  * Simple test receiver class to mock a responding device. Only for testing.
@@ -43,6 +42,7 @@ class ElectronicControlUnitTest : public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST_SUITE(ElectronicControlUnitTest);
 
     CPPUNIT_TEST(testElectronicControlUnit);
+    CPPUNIT_TEST(testStopSimulation);
 
     CPPUNIT_TEST_SUITE_END();
 
@@ -54,6 +54,7 @@ public:
 
 private:
     void testElectronicControlUnit();
+    void testStopSimulation();
 
 };
 
@@ -0,0 +1,193 @@
+/**
+ * @file hex_codec_test.cpp
+ *
+ * Unit test for the hex conversions. The strings of more than 16 bytes are
+ * also converted by the SSE2 or NEON kernels, so they are compared with the
+ * conversion of one byte at a time.
+ */
+
+#include "hex_codec_test.h"
+#include "hex_codec.h"
+#include <cstdlib>
+#include <random>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(HexCodecTest);
+
+/**
+ * The conversion of a literal hex string before the codec, one `strtol()`
+ * per pair of characters.
+ */
+static vector<uint8_t> decodeByPairs(const string& text)
+{
+    vector<uint8_t> bytes;
+    char byteString[3] = {};
+    size_t digits = 0;
+    for (const char c : text)
+    {
+        if (c == ' ')
+        {
+            continue;
+        }
+        byteString[digits++] = c;
+        if (digits == 2)
+        {
+            bytes.push_back(static_cast<uint8_t> (strtol(byteString, nullptr, 16)));
+            digits = 0;
+        }
+    }
+    if (digits == 1)
+    {
+        byteString[1] = '\0';
+        bytes.push_back(static_cast<uint8_t> (strtol(byteString, nullptr, 16)));
+    }
+    return bytes;
+}
+
+static string encode(const vector<uint8_t>& bytes)
+{
+    string text;
+    hex_codec::encode(bytes.data(), bytes.size(), text);
+    return text;
+}
+
+static vector<uint8_t> decode(const string& text)
+{
+    vector<uint8_t> bytes;
+    hex_codec::decode(text, bytes);
+    return bytes;
+}
+
+void HexCodecTest::setUp()
+{
+}
+
+void HexCodecTest::tearDown()
+{
+}
+
+void HexCodecTest::testDecode()
+{
+    const vector<uint8_t> hello = {0x48, 0x65, 0x6c, 0x6c, 0x6f};
+    CPPUNIT_ASSERT(decode("48 65 6c 6c 6f") == hello);
+    CPPUNIT_ASSERT(decode("48656C6C6F") == hello);
+    CPPUNIT_ASSERT(decode("  4 8 65   6c6c 6f  ") == hello);
+    CPPUNIT_ASSERT(decode("") == vector<uint8_t>());
+    CPPUNIT_ASSERT(decode("   ") == vector<uint8_t>());
+
+    // a single digit at the end is a byte of its own
+    const vector<uint8_t> odd = {0x48, 0x65, 0x6c, 0x6c, 0x06};
+    CPPUNIT_ASSERT(decode(" 48 65 6c 6c 6") == odd);
+    CPPUNIT_ASSERT(decode("F") == vector<uint8_t>({0x0F}));
+
+    uint8_t bytes[4] = {};
+    CPPUNIT_ASSERT_EQUAL(size_t(4), hex_codec::getMaxDecodedSize("62 F1 9"));
+    CPPUNIT_ASSERT_EQUAL(size_t(3), hex_codec::decode("62 F1 9", bytes));
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x09), bytes[2]);
+}
+
+void HexCodecTest::testDecodeInvalid()
+{
+    // converted as by `strtol()`, up to the first character which is no digit
+    const vector<uint8_t> expected = {0x48, 0x06, 0x6c, 0x00, 0x6f};
+    CPPUNIT_ASSERT(decode(" 48 6h 6c gg 6f ") == expected);
+    CPPUNIT_ASSERT(decode("x") == vector<uint8_t>({0x00}));
+    CPPUNIT_ASSERT(decode("-1") == decodeByPairs("-1"));
+    CPPUNIT_ASSERT(decode("+F") == decodeByPairs("+F"));
+}
+
+void HexCodecTest::testDecodeBlocks()
+{
+    mt19937 random(68);
+    vector<uint8_t> bytes(100);
+    for (uint8_t& byte : bytes)
+    {
+        byte = uint8_t(random());
+    }
+    const string text = encode(bytes);
+    CPPUNIT_ASSERT(decode(text) == bytes);
+    CPPUNIT_ASSERT(decode(" " + text + " ") == bytes);
+    CPPUNIT_ASSERT(decode(text + " A") == decodeByPairs(text + " A"));
+
+    // an invalid or missing character in every position of a block
+    static constexpr char REPLACEMENTS[] = {'g', ' ', 'a', '0', '\0'};
+    for (size_t i = 0; i < 60; i++)
+    {
+        for (const char replacement : REPLACEMENTS)
+        {
+            string changed = text;
+            if (replacement == '\0')
+            {
+                changed.erase(i, 1);
+            }
+            else
+            {
+                changed[i] = replacement;
+            }
+            CPPUNIT_ASSERT(decode(changed) == decodeByPairs(changed));
+        }
+    }
+
+    // random strings of digits, spaces and other characters
+    static constexpr char CHARS[] = "0123456789abcdefABCDEF   xG";
+    for (int i = 0; i < 200; i++)
+    {
+        string random_text(random() % 200, ' ');
+        for (char& c : random_text)
+        {
+            c = CHARS[random() % (sizeof(CHARS) - 1)];
+        }
+        CPPUNIT_ASSERT(decode(random_text) == decodeByPairs(random_text));
+    }
+}
+
+void HexCodecTest::testEncode()
+{
+    CPPUNIT_ASSERT_EQUAL(string("48 65 6C 6C 6F"), encode({0x48, 0x65, 0x6c, 0x6c, 0x6f}));
+    CPPUNIT_ASSERT_EQUAL(string("00"), encode({0x00}));
+    CPPUNIT_ASSERT_EQUAL(string(""), encode({}));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), hex_codec::getEncodedSize(0));
+    CPPUNIT_ASSERT_EQUAL(size_t(14), hex_codec::getEncodedSize(5));
+
+    // the string keeps its capacity
+    string text(100, 'x');
+    const size_t capacity = text.capacity();
+    const uint8_t bytes[] = {0xFF, 0x0A};
+    hex_codec::encode(bytes, sizeof(bytes), text);
+    CPPUNIT_ASSERT_EQUAL(string("FF 0A"), text);
+    CPPUNIT_ASSERT_EQUAL(capacity, text.capacity());
+}
+
+void HexCodecTest::testRoundTrip()
+{
+    for (size_t length = 0; length <= 64; length++)
+    {
+        vector<uint8_t> bytes(length);
+        string expected;
+        static constexpr char DIGITS[] = "0123456789ABCDEF";
+        for (size_t i = 0; i < length; i++)
+        {
+            bytes[i] = uint8_t(i * 37 + 11);
+            if (i > 0)
+            {
+                expected.push_back(' ');
+            }
+            expected.push_back(DIGITS[bytes[i] >> 4]);
+            expected.push_back(DIGITS[bytes[i] & 0x0F]);
+        }
+        const string text = encode(bytes);
+        CPPUNIT_ASSERT_EQUAL(expected, text);
+        CPPUNIT_ASSERT(decode(text) == bytes);
+    }
+}
+
+void HexCodecTest::testRemoveSeparators()
+{
+    string key = "22_F1.90,01;02 03#04\t05";
+    hex_codec::removeSeparators(key);
+    CPPUNIT_ASSERT_EQUAL(string("22F1900102030405"), key);
+    CPPUNIT_ASSERT(hex_codec::isSeparator('\t'));
+    CPPUNIT_ASSERT(!hex_codec::isSeparator('-'));
+    CPPUNIT_ASSERT(!hex_codec::isSeparator('\0'));
+}
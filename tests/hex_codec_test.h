@@ -0,0 +1,41 @@
+/**
+ * @file hex_codec_test.h
+ *
+ */
+
+#ifndef HEX_CODEC_TEST_H
+#define HEX_CODEC_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class HexCodecTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(HexCodecTest);
+
+    CPPUNIT_TEST(testDecode);
+    CPPUNIT_TEST(testDecodeInvalid);
+    CPPUNIT_TEST(testDecodeBlocks);
+    CPPUNIT_TEST(testEncode);
+    CPPUNIT_TEST(testRoundTrip);
+    CPPUNIT_TEST(testRemoveSeparators);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    HexCodecTest() = default;
+    virtual ~HexCodecTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testDecode();
+    void testDecodeInvalid();
+    void testDecodeBlocks();
+    void testEncode();
+    void testRoundTrip();
+    void testRemoveSeparators();
+
+};
+
+#endif /* HEX_CODEC_TEST_H */
+
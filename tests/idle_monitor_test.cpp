@@ -0,0 +1,96 @@
+/**
+ * @file idle_monitor_test.cpp
+ *
+ * Unit test for the sleep mode of the simulator. The timings are chosen
+ * generously, so the tests also pass on a busy machine.
+ */
+
+#include "idle_monitor_test.h"
+#include "idle_monitor.h"
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(IdleMonitorTest);
+
+void IdleMonitorTest::setUp() { }
+
+void IdleMonitorTest::tearDown() { }
+
+void IdleMonitorTest::testTimeout()
+{
+    TimerWheel wheel;
+    IdleMonitor monitor(wheel);
+    mutex changesMutex;
+    vector<bool> changes;
+    const int id = monitor.addListener([&changesMutex, &changes](bool isAwake)
+    {
+        lock_guard<mutex> lock(changesMutex);
+        changes.push_back(isAwake);
+    });
+
+    monitor.configure(milliseconds(50));
+    CPPUNIT_ASSERT(monitor.isAwake());
+    this_thread::sleep_for(milliseconds(200));
+    CPPUNIT_ASSERT(!monitor.isAwake());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), monitor.getSleepCount());
+
+    // the first traffic wakes the simulator up and restarts the timeout
+    monitor.notifyActivity();
+    CPPUNIT_ASSERT(monitor.isAwake());
+    this_thread::sleep_for(milliseconds(200));
+    CPPUNIT_ASSERT(!monitor.isAwake());
+
+    monitor.removeListener(id);
+    monitor.notifyActivity();
+    lock_guard<mutex> lock(changesMutex);
+    CPPUNIT_ASSERT(changes == vector<bool>({false, true, false}));
+}
+
+void IdleMonitorTest::testActivity()
+{
+    TimerWheel wheel;
+    IdleMonitor monitor(wheel);
+    monitor.configure(milliseconds(100));
+    for (int i = 0; i < 6; ++i)
+    {
+        this_thread::sleep_for(milliseconds(50));
+        monitor.notifyActivity();
+    }
+    // 300 ms passed, but every message restarted the timeout
+    CPPUNIT_ASSERT(monitor.isAwake());
+    this_thread::sleep_for(milliseconds(300));
+    CPPUNIT_ASSERT(!monitor.isAwake());
+}
+
+void IdleMonitorTest::testBusError()
+{
+    TimerWheel wheel;
+    IdleMonitor monitor(wheel);
+    monitor.configure(seconds(60));
+    monitor.notifyBusError();
+    CPPUNIT_ASSERT(!monitor.isAwake());
+    monitor.notifyActivity();
+    CPPUNIT_ASSERT(monitor.isAwake());
+}
+
+void IdleMonitorTest::testDisabled()
+{
+    TimerWheel wheel;
+    IdleMonitor monitor(wheel);
+    monitor.notifyBusError();
+    CPPUNIT_ASSERT(monitor.isAwake());
+
+    // switching the timeout off wakes the simulator up
+    monitor.configure(milliseconds(20));
+    this_thread::sleep_for(milliseconds(150));
+    CPPUNIT_ASSERT(!monitor.isAwake());
+    monitor.configure(milliseconds(0));
+    CPPUNIT_ASSERT(monitor.isAwake());
+    this_thread::sleep_for(milliseconds(100));
+    CPPUNIT_ASSERT(monitor.isAwake());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), monitor.getSleepCount());
+}
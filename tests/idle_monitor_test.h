@@ -0,0 +1,36 @@
+/**
+ * @file idle_monitor_test.h
+ *
+ */
+
+#ifndef IDLE_MONITOR_TEST_H
+#define IDLE_MONITOR_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class IdleMonitorTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(IdleMonitorTest);
+
+    CPPUNIT_TEST(testTimeout);
+    CPPUNIT_TEST(testActivity);
+    CPPUNIT_TEST(testBusError);
+    CPPUNIT_TEST(testDisabled);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    IdleMonitorTest() = default;
+    virtual ~IdleMonitorTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testTimeout();
+    void testActivity();
+    void testBusError();
+    void testDisabled();
+
+};
+
+#endif /* IDLE_MONITOR_TEST_H */
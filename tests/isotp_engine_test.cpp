@@ -0,0 +1,147 @@
+/**
+ * @file isotp_engine_test.cpp
+ *
+ */
+
+#include "isotp_engine_test.h"
+#include "isotp_engine.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+constexpr canid_t ECU_ID = 0x7E8;
+constexpr canid_t TESTER_ID = 0x7E0;
+const std::string DEVICE = "vcan0";
+
+CPPUNIT_TEST_SUITE_REGISTRATION(IsoTpEngineTest);
+
+IsoTpEngineTest::IsoTpEngineTest()
+{
+}
+
+IsoTpEngineTest::~IsoTpEngineTest()
+{
+}
+
+void IsoTpEngineTest::setUp()
+{
+    skt_ = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    CPPUNIT_ASSERT(skt_ >= 0);
+    struct ifreq ifr = {};
+    std::strncpy(ifr.ifr_name, DEVICE.c_str(), IFNAMSIZ - 1);
+    CPPUNIT_ASSERT(ioctl(skt_, SIOCGIFINDEX, &ifr) >= 0);
+    struct sockaddr_can addr = {};
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+    CPPUNIT_ASSERT(bind(skt_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) >= 0);
+    // the tester only reads the frames of the ECU
+    struct can_filter filter = {ECU_ID, CAN_SFF_MASK};
+    setsockopt(skt_, SOL_CAN_RAW, CAN_RAW_FILTER, &filter, sizeof(filter));
+}
+
+void IsoTpEngineTest::tearDown()
+{
+    close(skt_);
+    skt_ = -1;
+}
+
+void IsoTpEngineTest::writeFrame(const std::initializer_list<std::uint8_t>& data)
+{
+    struct can_frame frame = {};
+    frame.can_id = TESTER_ID;
+    frame.can_dlc = 8;
+    std::copy(data.begin(), data.end(), frame.data);
+    CPPUNIT_ASSERT_EQUAL(ssize_t(sizeof(frame)), write(skt_, &frame, sizeof(frame)));
+}
+
+bool IsoTpEngineTest::readFrame(struct can_frame& frame)
+{
+    struct pollfd pfd = {skt_, POLLIN, 0};
+    if (poll(&pfd, 1, 1000) <= 0)
+    {
+        return false;
+    }
+    return read(skt_, &frame, sizeof(frame)) == ssize_t(sizeof(frame));
+}
+
+bool IsoTpEngineTest::waitForMessage(int fd)
+{
+    struct pollfd pfd = {fd, POLLIN, 0};
+    return poll(&pfd, 1, 1000) > 0;
+}
+
+void IsoTpEngineTest::testReceiveSingleFrame()
+{
+    std::shared_ptr<IsoTpEngine> pEngine = IsoTpEngine::getInstance(DEVICE);
+    CPPUNIT_ASSERT(pEngine != nullptr);
+    IsoTpEngine::Channel* pChannel = pEngine->openChannel(ECU_ID, TESTER_ID, IsoTpConfiguration(), true);
+    CPPUNIT_ASSERT(pChannel != nullptr);
+
+    writeFrame({0x02, 0x10, 0x03});
+    CPPUNIT_ASSERT_MESSAGE("Single frame not received!", waitForMessage(pEngine->getReceiveFd(pChannel)));
+    std::array<std::uint8_t, 16> buffer;
+    CPPUNIT_ASSERT_EQUAL(ssize_t(2), pEngine->receive(pChannel, buffer.data(), buffer.size()));
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0x10), buffer[0]);
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0x03), buffer[1]);
+
+    pEngine->closeChannel(pChannel, true);
+}
+
+void IsoTpEngineTest::testReceiveMultiFrame()
+{
+    std::shared_ptr<IsoTpEngine> pEngine = IsoTpEngine::getInstance(DEVICE);
+    IsoTpEngine::Channel* pChannel = pEngine->openChannel(ECU_ID, TESTER_ID, IsoTpConfiguration(), true);
+    CPPUNIT_ASSERT(pChannel != nullptr);
+
+    // 10 bytes: first frame with 6 bytes, one consecutive frame with 4 bytes
+    writeFrame({0x10, 0x0A, 0x2E, 0xF1, 0x90, 0x01, 0x02, 0x03});
+    struct can_frame frame;
+    CPPUNIT_ASSERT_MESSAGE("No flow control frame!", readFrame(frame));
+    CPPUNIT_ASSERT_EQUAL(ECU_ID, frame.can_id);
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0x30), frame.data[0]);
+    writeFrame({0x21, 0x04, 0x05, 0x06, 0x07});
+
+    CPPUNIT_ASSERT_MESSAGE("Message not received!", waitForMessage(pEngine->getReceiveFd(pChannel)));
+    std::array<std::uint8_t, 16> buffer;
+    CPPUNIT_ASSERT_EQUAL(ssize_t(10), pEngine->receive(pChannel, buffer.data(), buffer.size()));
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0x2E), buffer[0]);
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0x07), buffer[9]);
+
+    pEngine->closeChannel(pChannel, true);
+}
+
+void IsoTpEngineTest::testSendMultiFrame()
+{
+    std::shared_ptr<IsoTpEngine> pEngine = IsoTpEngine::getInstance(DEVICE);
+    IsoTpEngine::Channel* pChannel = pEngine->openChannel(ECU_ID, TESTER_ID, IsoTpConfiguration(), false);
+    CPPUNIT_ASSERT(pChannel != nullptr);
+
+    std::array<std::uint8_t, 20> message;
+    for (std::size_t i = 0; i < message.size(); ++i)
+    {
+        message[i] = std::uint8_t(i);
+    }
+    CPPUNIT_ASSERT_EQUAL(int(message.size()), pEngine->send(pChannel, message.data(), message.size()));
+
+    struct can_frame frame;
+    CPPUNIT_ASSERT_MESSAGE("No first frame!", readFrame(frame));
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0x10), frame.data[0]);
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(20), frame.data[1]);
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0x05), frame.data[7]);
+    // continue to send, no block size, no STmin
+    writeFrame({0x30, 0x00, 0x00});
+
+    CPPUNIT_ASSERT_MESSAGE("No 1st consecutive frame!", readFrame(frame));
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0x21), frame.data[0]);
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0x06), frame.data[1]);
+    CPPUNIT_ASSERT_MESSAGE("No 2nd consecutive frame!", readFrame(frame));
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0x22), frame.data[0]);
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0x13), frame.data[7]);
+
+    pEngine->closeChannel(pChannel, false);
+}
@@ -0,0 +1,43 @@
+/**
+ * @file isotp_engine_test.h
+ *
+ */
+
+#ifndef ISOTP_ENGINE_TEST_H
+#define ISOTP_ENGINE_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cstdint>
+#include <initializer_list>
+#include <linux/can.h>
+
+class IsoTpEngineTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(IsoTpEngineTest);
+
+    CPPUNIT_TEST(testReceiveSingleFrame);
+    CPPUNIT_TEST(testReceiveMultiFrame);
+    CPPUNIT_TEST(testSendMultiFrame);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    IsoTpEngineTest();
+    virtual ~IsoTpEngineTest();
+    void setUp();
+    void tearDown();
+
+private:
+    int skt_ = -1; ///< the raw socket of the tester
+
+    void testReceiveSingleFrame();
+    void testReceiveMultiFrame();
+    void testSendMultiFrame();
+
+    void writeFrame(const std::initializer_list<std::uint8_t>& data);
+    bool readFrame(struct can_frame& frame);
+    bool waitForMessage(int fd);
+
+};
+
+#endif /* ISOTP_ENGINE_TEST_H */
@@ -5,6 +5,8 @@
 
 #include "isotp_sender_test.h"
 #include "isotp_sender.h"
+#include "receiver_reactor.h"
+#include <chrono>
 #include <unistd.h>
 
 constexpr canid_t SOURCE_ADDR = 0x100;
@@ -113,3 +115,35 @@ void IsoTpSenderTest::testSendData()
     CPPUNIT_ASSERT_EQUAL_MESSAGE("04 Size mismatch!", expect, result);
 }
 
+/**
+ * In non-blocking mode a full send queue drops the message instead of
+ * waiting for the bus. The reactor is not started, so nothing drains the
+ * queue, and no receiver sends the flow control of the first message, so
+ * the socket stays busy.
+ */
+void IsoTpSenderTest::testSendQueueFull()
+{
+    ReceiverReactor reactor;
+    IsoTpSender isoTpSender(SOURCE_ADDR, DEST_ADDR, DEVICE);
+    CPPUNIT_ASSERT_EQUAL(0, isoTpSender.enableAsyncSend(&reactor));
+
+    // a multi frame message waits for the flow control
+    std::vector<std::uint8_t> message(100, 0x07);
+    const auto start = std::chrono::steady_clock::now();
+    CPPUNIT_ASSERT_EQUAL(int(message.size()), isoTpSender.sendData(message.data(), message.size()));
+    for (std::size_t i = 0; i < SEND_QUEUE_SIZE; ++i)
+    {
+        CPPUNIT_ASSERT_EQUAL(int(message.size()), isoTpSender.sendData(message.data(), message.size()));
+    }
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Full queue not reported!", -2,
+                                 isoTpSender.sendData(message.data(), message.size()));
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    CPPUNIT_ASSERT_MESSAGE("Sending blocked!", elapsed < std::chrono::milliseconds(500));
+
+    const IsoTpSender::Statistics statistics = isoTpSender.getStatistics();
+    CPPUNIT_ASSERT_EQUAL(std::uint64_t(1), statistics.sent);
+    CPPUNIT_ASSERT_EQUAL(std::uint64_t(SEND_QUEUE_SIZE), statistics.queued);
+    CPPUNIT_ASSERT_EQUAL(std::uint64_t(1), statistics.dropped);
+    CPPUNIT_ASSERT_EQUAL(SEND_QUEUE_SIZE, statistics.queueDepth);
+    CPPUNIT_ASSERT_EQUAL(SEND_QUEUE_SIZE, statistics.maxQueueDepth);
+}
@@ -16,6 +16,7 @@ class IsoTpSenderTest : public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST(testOpenSender);
     CPPUNIT_TEST(testCloseSender);
     CPPUNIT_TEST(testSendData);
+    CPPUNIT_TEST(testSendQueueFull);
 
     CPPUNIT_TEST_SUITE_END();
 
@@ -30,6 +31,7 @@ private:
     void testOpenSender();
     void testCloseSender();
     void testSendData();
+    void testSendQueueFull();
 
 };
 
@@ -0,0 +1,246 @@
+/**
+ * @file j1939_bus_test.cpp
+ *
+ * Unit test for the shared J1939 receiver: the kernel filter of the PGNs of
+ * the nodes, the batched receive and the dispatch to the nodes. The test
+ * sends from the sockets of the bus. Like the other CAN tests, this needs the
+ * virtual CAN interface `vcan0` and the J1939 kernel module
+ * (`sudo modprobe can-j1939`).
+ */
+
+#include "j1939_bus_test.h"
+#include "j1939_bus.h"
+#include "can/j1939.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+
+const std::string DEVICE = "vcan0";
+const std::chrono::milliseconds WAIT_TIMEOUT(1000);
+const std::chrono::milliseconds QUIET_TIME(100);
+
+constexpr std::uint8_t NODE_ADDRESS = 0x0B;
+constexpr std::uint8_t OTHER_NODE_ADDRESS = 0x0C;
+constexpr std::uint8_t TESTER_ADDRESS = 0xF9;
+constexpr std::uint32_t ENGINE_TEMPERATURE = 0xFEEE; // PDU2
+constexpr std::uint32_t VEHICLE_SPEED = 0xFEF1; // PDU2, not handled by the nodes
+constexpr std::uint32_t PROPRIETARY_A = 0xEF00; // PDU1
+
+CPPUNIT_TEST_SUITE_REGISTRATION(J1939BusTest);
+
+namespace
+{
+
+/// a node without NAME, which records the messages it gets
+class FakeNode : public J1939Node
+{
+public:
+    struct Message
+    {
+        std::vector<std::uint8_t> data;
+        std::uint8_t sourceAddress;
+        std::uint32_t pgn;
+        std::chrono::steady_clock::time_point receiveTime;
+    };
+
+    FakeNode(J1939Bus& bus, std::uint8_t address, const std::vector<std::uint32_t>& pgns)
+    : address_(address)
+    , pgns_(pgns)
+    , skt_(bus.openSendSocket(address))
+    {
+    }
+
+    virtual ~FakeNode()
+    {
+        close(skt_);
+    }
+
+    std::uint8_t getSourceAddress() const noexcept override { return address_; }
+    std::uint64_t getName() const noexcept override { return 0; }
+    int getSendSocket() const noexcept override { return skt_; }
+    std::vector<std::uint32_t> getReceivedPgns() const override { return pgns_; }
+
+    void processReceivedData(const std::uint8_t* buffer, std::size_t num_bytes,
+                             std::uint8_t sourceAddress, std::uint32_t pgn) noexcept override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        messages_.push_back({std::vector<std::uint8_t>(buffer, buffer + num_bytes), sourceAddress, pgn,
+                             J1939Bus::getReceiveTime()});
+        condition_.notify_all();
+    }
+
+    /// @return false if less than `count` messages arrived in time
+    bool waitFor(std::size_t count)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return condition_.wait_for(lock, WAIT_TIMEOUT, [this, count]() { return messages_.size() >= count; });
+    }
+
+    std::vector<Message> getMessages()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return messages_;
+    }
+
+private:
+    const std::uint8_t address_;
+    const std::vector<std::uint32_t> pgns_;
+    const int skt_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::vector<Message> messages_;
+};
+
+/// sends a PGN, `J1939_NO_ADDR` as destination broadcasts it
+void send(int skt, std::uint32_t pgn, std::uint8_t destinationAddress, const std::vector<std::uint8_t>& payload)
+{
+    struct sockaddr_can saddr = {};
+    saddr.can_family = AF_CAN;
+    saddr.can_addr.j1939.name = J1939_NO_NAME;
+    saddr.can_addr.j1939.addr = destinationAddress;
+    saddr.can_addr.j1939.pgn = pgn;
+    CPPUNIT_ASSERT_EQUAL(ssize_t(payload.size()),
+                         sendto(skt, payload.data(), payload.size(), 0,
+                                reinterpret_cast<const struct sockaddr*>(&saddr), sizeof(saddr)));
+}
+
+}
+
+void J1939BusTest::setUp()
+{
+}
+
+void J1939BusTest::tearDown()
+{
+}
+
+void J1939BusTest::testParseName()
+{
+    const std::uint8_t claim[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x88};
+    CPPUNIT_ASSERT_EQUAL(std::uint64_t(0x8807060504030201), J1939Bus::parseName(claim));
+}
+
+/**
+ * Only the PGNs of the nodes are received.
+ */
+void J1939BusTest::testKernelFilter()
+{
+    J1939Bus bus(DEVICE);
+    FakeNode node(bus, NODE_ADDRESS, {ENGINE_TEMPERATURE});
+    CPPUNIT_ASSERT(bus.addNode(&node));
+    const int tester = bus.openSendSocket(TESTER_ADDRESS);
+    CPPUNIT_ASSERT(tester >= 0);
+
+    send(tester, VEHICLE_SPEED, J1939_NO_ADDR, {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08});
+    send(tester, ENGINE_TEMPERATURE, J1939_NO_ADDR, {0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18});
+    CPPUNIT_ASSERT(node.waitFor(1));
+    std::this_thread::sleep_for(QUIET_TIME);
+
+    const std::vector<FakeNode::Message> messages = node.getMessages();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), messages.size());
+    CPPUNIT_ASSERT_EQUAL(ENGINE_TEMPERATURE, messages[0].pgn);
+    CPPUNIT_ASSERT_EQUAL(TESTER_ADDRESS, messages[0].sourceAddress);
+    const std::vector<std::uint8_t> payload = {0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18};
+    CPPUNIT_ASSERT(payload == messages[0].data);
+
+    // the filter follows the nodes
+    bus.removeNode(&node);
+    send(tester, ENGINE_TEMPERATURE, J1939_NO_ADDR, payload);
+    std::this_thread::sleep_for(QUIET_TIME);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), node.getMessages().size());
+    close(tester);
+}
+
+/**
+ * A PDU1 PGN passes the filter whatever its destination byte in the table,
+ * and is only dispatched to its destination.
+ */
+void J1939BusTest::testPdu1Filter()
+{
+    J1939Bus bus(DEVICE);
+    FakeNode node(bus, NODE_ADDRESS, {PROPRIETARY_A | NODE_ADDRESS});
+    FakeNode otherNode(bus, OTHER_NODE_ADDRESS, {});
+    CPPUNIT_ASSERT(bus.addNode(&node));
+    CPPUNIT_ASSERT(bus.addNode(&otherNode));
+    const int tester = bus.openSendSocket(TESTER_ADDRESS);
+    CPPUNIT_ASSERT(tester >= 0);
+
+    send(tester, PROPRIETARY_A, NODE_ADDRESS, {0x01, 0x02, 0x03});
+    send(tester, PROPRIETARY_A, OTHER_NODE_ADDRESS, {0x04, 0x05, 0x06});
+    CPPUNIT_ASSERT(node.waitFor(1));
+    CPPUNIT_ASSERT(otherNode.waitFor(1));
+    std::this_thread::sleep_for(QUIET_TIME);
+
+    const std::vector<FakeNode::Message> messages = node.getMessages();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), messages.size());
+    CPPUNIT_ASSERT_EQUAL(PROPRIETARY_A, messages[0].pgn);
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0x01), messages[0].data[0]);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), otherNode.getMessages().size());
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(0x04), otherNode.getMessages()[0].data[0]);
+    bus.removeNode(&otherNode);
+    bus.removeNode(&node);
+    close(tester);
+}
+
+/**
+ * A burst of more messages than one `recvmmsg()` reads arrives complete, in
+ * order and with the kernel receive time.
+ */
+void J1939BusTest::testBatchedReceive()
+{
+    constexpr std::size_t NUM_MESSAGES = 40;
+    J1939Bus bus(DEVICE);
+    FakeNode node(bus, NODE_ADDRESS, {ENGINE_TEMPERATURE});
+    CPPUNIT_ASSERT(bus.addNode(&node));
+    const int tester = bus.openSendSocket(TESTER_ADDRESS);
+    CPPUNIT_ASSERT(tester >= 0);
+
+    const auto sentAt = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < NUM_MESSAGES; ++i)
+    {
+        send(tester, ENGINE_TEMPERATURE, J1939_NO_ADDR, {std::uint8_t(i), 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
+    }
+    CPPUNIT_ASSERT(node.waitFor(NUM_MESSAGES));
+    const auto receivedAt = std::chrono::steady_clock::now();
+
+    const std::vector<FakeNode::Message> messages = node.getMessages();
+    CPPUNIT_ASSERT_EQUAL(NUM_MESSAGES, messages.size());
+    for (std::size_t i = 0; i < NUM_MESSAGES; ++i)
+    {
+        CPPUNIT_ASSERT_EQUAL(std::uint8_t(i), messages[i].data[0]);
+        CPPUNIT_ASSERT(messages[i].receiveTime >= sentAt);
+        CPPUNIT_ASSERT(messages[i].receiveTime <= receivedAt);
+        if (i > 0)
+        {
+            CPPUNIT_ASSERT(messages[i].receiveTime >= messages[i - 1].receiveTime);
+        }
+    }
+    bus.removeNode(&node);
+    close(tester);
+}
+
+/**
+ * A broadcast of a node goes to the other nodes, but not back to the sender.
+ */
+void J1939BusTest::testBroadcast()
+{
+    J1939Bus bus(DEVICE);
+    FakeNode node(bus, NODE_ADDRESS, {ENGINE_TEMPERATURE});
+    FakeNode otherNode(bus, OTHER_NODE_ADDRESS, {ENGINE_TEMPERATURE});
+    CPPUNIT_ASSERT(bus.addNode(&node));
+    CPPUNIT_ASSERT(bus.addNode(&otherNode));
+
+    send(node.getSendSocket(), ENGINE_TEMPERATURE, J1939_NO_ADDR, {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08});
+    CPPUNIT_ASSERT(otherNode.waitFor(1));
+    std::this_thread::sleep_for(QUIET_TIME);
+    CPPUNIT_ASSERT(node.getMessages().empty());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), otherNode.getMessages().size());
+    CPPUNIT_ASSERT_EQUAL(NODE_ADDRESS, otherNode.getMessages()[0].sourceAddress);
+    bus.removeNode(&otherNode);
+    bus.removeNode(&node);
+}
@@ -0,0 +1,39 @@
+/**
+ * @file j1939_bus_test.h
+ *
+ */
+
+#ifndef J1939_BUS_TEST_H
+#define J1939_BUS_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class J1939BusTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(J1939BusTest);
+
+    CPPUNIT_TEST(testParseName);
+    CPPUNIT_TEST(testKernelFilter);
+    CPPUNIT_TEST(testPdu1Filter);
+    CPPUNIT_TEST(testBatchedReceive);
+    CPPUNIT_TEST(testBroadcast);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    J1939BusTest() = default;
+    virtual ~J1939BusTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testParseName();
+    void testKernelFilter();
+    void testPdu1Filter();
+    void testBatchedReceive();
+    void testBroadcast();
+
+};
+
+#endif /* J1939_BUS_TEST_H */
+
@@ -0,0 +1,123 @@
+/**
+ * @file j1939_cyclic_scheduler_test.cpp
+ *
+ * Unit test for the scheduler of the cyclic J1939 PGNs. The source has no
+ * socket, so the transmissions fail and are counted as dropped, but the
+ * scheduler reads the payload of every due PGN. The timings are chosen
+ * generously, so the tests also pass on a busy machine.
+ */
+
+#include "j1939_cyclic_scheduler_test.h"
+#include "j1939_cyclic_scheduler.h"
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+
+using namespace std::chrono;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(J1939CyclicSchedulerTest);
+
+namespace
+{
+
+/// counts the payload reads per PGN, the cycle time is the PGN in milliseconds
+class FakeSource : public J1939CyclicSource
+{
+public:
+    int getCyclicSocket() const noexcept override { return -1; }
+    std::uint8_t getCyclicSourceAddress() const noexcept override { return 0x0B; }
+    std::uint8_t getCaptureInterface() const noexcept override { return 0; }
+    bool isBusActive() override { return true; }
+
+    void getCyclicPayload(const std::string& /*pgnKey*/,
+                          std::uint32_t pgn,
+                          std::vector<std::uint8_t>& payload,
+                          unsigned int& cycleTime) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reads_[pgn]++;
+        payload.assign(8, 0xFF);
+        cycleTime = pgn;
+    }
+
+    unsigned int getReads(std::uint32_t pgn)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return reads_[pgn];
+    }
+
+private:
+    std::mutex mutex_;
+    std::map<std::uint32_t, unsigned int> reads_;
+};
+
+}
+
+void J1939CyclicSchedulerTest::setUp() { }
+
+void J1939CyclicSchedulerTest::tearDown() { }
+
+/**
+ * Each PGN is read once per period, the PGNs do not delay each other.
+ */
+void J1939CyclicSchedulerTest::testCycleTimes()
+{
+    J1939CyclicScheduler scheduler;
+    FakeSource source;
+    scheduler.addPGN(&source, "20", 20);
+    scheduler.addPGN(&source, "50", 50);
+
+    std::this_thread::sleep_for(milliseconds(510));
+    scheduler.removeSource(&source);
+    // the first transmission is right away, then one per period
+    const unsigned int fast = source.getReads(20);
+    const unsigned int slow = source.getReads(50);
+    CPPUNIT_ASSERT(fast >= 20 && fast <= 27);
+    CPPUNIT_ASSERT(slow >= 8 && slow <= 11);
+}
+
+/**
+ * A PGN without cycle time is sent once, and the source's failed
+ * transmissions are counted.
+ */
+void J1939CyclicSchedulerTest::testSingleTransmission()
+{
+    J1939CyclicScheduler scheduler;
+    FakeSource source;
+    scheduler.addPGN(&source, "0", 0);
+    scheduler.addPGN(&source, "30", 30);
+
+    std::this_thread::sleep_for(milliseconds(200));
+    CPPUNIT_ASSERT_EQUAL(1u, source.getReads(0));
+    CPPUNIT_ASSERT(source.getReads(30) >= 4);
+    const auto statistics = scheduler.getStatistics(&source);
+    CPPUNIT_ASSERT(statistics.at(30).dropped >= 4);
+    CPPUNIT_ASSERT_EQUAL(std::uint64_t(0), statistics.at(30).sent);
+    scheduler.removeSource(&source);
+}
+
+/**
+ * A removed source is not called any more, the other sources keep their
+ * PGNs.
+ */
+void J1939CyclicSchedulerTest::testRemoveSource()
+{
+    J1939CyclicScheduler scheduler;
+    FakeSource removed;
+    FakeSource kept;
+    scheduler.addPGN(&removed, "20", 20);
+    scheduler.addPGN(&kept, "25", 25);
+
+    std::this_thread::sleep_for(milliseconds(100));
+    scheduler.removeSource(&removed);
+    const unsigned int removedReads = removed.getReads(20);
+    const unsigned int keptReads = kept.getReads(25);
+    CPPUNIT_ASSERT(removedReads > 0);
+
+    std::this_thread::sleep_for(milliseconds(200));
+    CPPUNIT_ASSERT_EQUAL(removedReads, removed.getReads(20));
+    CPPUNIT_ASSERT(kept.getReads(25) > keptReads);
+    CPPUNIT_ASSERT(scheduler.getStatistics(&removed).empty());
+    scheduler.removeSource(&kept);
+}
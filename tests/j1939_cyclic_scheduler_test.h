@@ -0,0 +1,35 @@
+/**
+ * @file j1939_cyclic_scheduler_test.h
+ *
+ */
+
+#ifndef J1939_CYCLIC_SCHEDULER_TEST_H
+#define J1939_CYCLIC_SCHEDULER_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class J1939CyclicSchedulerTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(J1939CyclicSchedulerTest);
+
+    CPPUNIT_TEST(testCycleTimes);
+    CPPUNIT_TEST(testSingleTransmission);
+    CPPUNIT_TEST(testRemoveSource);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    J1939CyclicSchedulerTest() = default;
+    virtual ~J1939CyclicSchedulerTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testCycleTimes();
+    void testSingleTransmission();
+    void testRemoveSource();
+
+};
+
+#endif /* J1939_CYCLIC_SCHEDULER_TEST_H */
+
@@ -0,0 +1,70 @@
+/**
+ * @file j1939_diagnostic_messages_test.cpp
+ *
+ * Unit test for the DM1 and DM2 payloads of the fault memory.
+ */
+
+#include "j1939_diagnostic_messages_test.h"
+#include "j1939_diagnostic_messages.h"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(J1939DiagnosticMessagesTest);
+
+/// SPN 100 (engine oil pressure), FMI 1
+static constexpr uint32_t OIL_PRESSURE_LOW = 0x640001;
+/// SPN 110 (coolant temperature), FMI 0
+static constexpr uint32_t COOLANT_TEMPERATURE_HIGH = 0x6E0000;
+
+void J1939DiagnosticMessagesTest::setUp()
+{
+}
+
+void J1939DiagnosticMessagesTest::tearDown()
+{
+}
+
+void J1939DiagnosticMessagesTest::testNoDtcs()
+{
+    DtcStore store;
+    vector<uint8_t> dm1;
+    vector<uint8_t> dm2;
+    J1939DiagnosticMessages::encode(store, dm1, dm2);
+    const vector<uint8_t> expected = {0x00, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF};
+    CPPUNIT_ASSERT(dm1 == expected);
+    CPPUNIT_ASSERT(dm2 == expected);
+}
+
+void J1939DiagnosticMessagesTest::testActiveAndPreviouslyActive()
+{
+    DtcStore store;
+    store.setDtc(OIL_PRESSURE_LOW, 0x89);
+    store.setDtc(COOLANT_TEMPERATURE_HIGH, 0x08);
+    store.setExtendedDataRecord(COOLANT_TEMPERATURE_HIGH, J1939DiagnosticMessages::OCCURRENCE_COUNTER_RECORD, {3});
+    vector<uint8_t> dm1;
+    vector<uint8_t> dm2;
+    J1939DiagnosticMessages::encode(store, dm1, dm2);
+
+    const vector<uint8_t> expectedDm1 = {0x40, 0xFF, 0x64, 0x00, 0x01, 0x01, 0xFF, 0xFF};
+    const vector<uint8_t> expectedDm2 = {0x00, 0xFF, 0x6E, 0x00, 0x00, 0x03, 0xFF, 0xFF};
+    CPPUNIT_ASSERT(dm1 == expectedDm1);
+    CPPUNIT_ASSERT(dm2 == expectedDm2);
+}
+
+void J1939DiagnosticMessagesTest::testMultiPacket()
+{
+    DtcStore store;
+    for (uint32_t fmi = 0; fmi < 3; ++fmi)
+    {
+        store.setDtc(OIL_PRESSURE_LOW + fmi, 0x01);
+    }
+    vector<uint8_t> dm1;
+    vector<uint8_t> dm2;
+    J1939DiagnosticMessages::encode(store, dm1, dm2);
+    // sent with the transport protocol of the kernel, not padded
+    CPPUNIT_ASSERT_EQUAL(size_t(2 + 3 * 4), dm1.size());
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x00), dm1[0]);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x03), dm1[12]);
+}
@@ -0,0 +1,34 @@
+/**
+ * @file j1939_diagnostic_messages_test.h
+ *
+ */
+
+#ifndef J1939_DIAGNOSTIC_MESSAGES_TEST_H
+#define J1939_DIAGNOSTIC_MESSAGES_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class J1939DiagnosticMessagesTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(J1939DiagnosticMessagesTest);
+
+    CPPUNIT_TEST(testNoDtcs);
+    CPPUNIT_TEST(testActiveAndPreviouslyActive);
+    CPPUNIT_TEST(testMultiPacket);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    J1939DiagnosticMessagesTest() = default;
+    virtual ~J1939DiagnosticMessagesTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testNoDtcs();
+    void testActiveAndPreviouslyActive();
+    void testMultiPacket();
+
+};
+
+#endif /* J1939_DIAGNOSTIC_MESSAGES_TEST_H */
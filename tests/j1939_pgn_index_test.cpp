@@ -0,0 +1,71 @@
+/**
+ * @file j1939_pgn_index_test.cpp
+ *
+ * Unit test for the numeric J1939 PGN index.
+ */
+
+#include "j1939_pgn_index_test.h"
+#include "j1939_pgn_index.h"
+#include <cstdint>
+#include <string>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(J1939PgnIndexTest);
+
+void J1939PgnIndexTest::setUp() { }
+
+void J1939PgnIndexTest::tearDown() { }
+
+void J1939PgnIndexTest::testFind()
+{
+    J1939PgnIndex<std::string> index;
+    CPPUNIT_ASSERT_EQUAL(true, index.empty());
+    CPPUNIT_ASSERT(index.find(0xFEF1) == nullptr);
+
+    index.add(0xFEF1, "CCVS");
+    index.add(0xF004, "EEC1");
+    index.add(0x0000, "TSC1");
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), index.size());
+
+    const std::string *value = index.find(0xFEF1);
+    CPPUNIT_ASSERT(value != nullptr);
+    CPPUNIT_ASSERT_EQUAL(std::string("CCVS"), *value);
+    value = index.find(0x0000);
+    CPPUNIT_ASSERT(value != nullptr);
+    CPPUNIT_ASSERT_EQUAL(std::string("TSC1"), *value);
+
+    CPPUNIT_ASSERT(index.find(0xFEF2) == nullptr);
+    CPPUNIT_ASSERT(index.find(0x3FFFF) == nullptr);
+}
+
+void J1939PgnIndexTest::testReplace()
+{
+    J1939PgnIndex<std::string> index;
+    index.add(0xF004, "old");
+    index.add(0xF004, "new");
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), index.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("new"), *index.find(0xF004));
+}
+
+void J1939PgnIndexTest::testGrow()
+{
+    // all group extensions of a PDU format and the destinations of a PDU1 PGN
+    J1939PgnIndex<std::uint32_t> index;
+    for (std::uint32_t pgn = 0xFE00; pgn <= 0xFEFF; ++pgn)
+    {
+        index.add(pgn, pgn + 1);
+    }
+    for (std::uint32_t pgn = 0x1EF00; pgn <= 0x1EFFF; ++pgn)
+    {
+        index.add(pgn, pgn + 1);
+    }
+    CPPUNIT_ASSERT_EQUAL(std::size_t(512), index.size());
+    for (std::uint32_t pgn = 0xFE00; pgn <= 0xFEFF; ++pgn)
+    {
+        CPPUNIT_ASSERT_EQUAL(pgn + 1, *index.find(pgn));
+    }
+    for (std::uint32_t pgn = 0x1EF00; pgn <= 0x1EFFF; ++pgn)
+    {
+        CPPUNIT_ASSERT_EQUAL(pgn + 1, *index.find(pgn));
+    }
+    CPPUNIT_ASSERT(index.find(0xFD00) == nullptr);
+}
@@ -0,0 +1,34 @@
+/**
+ * @file j1939_pgn_index_test.h
+ *
+ */
+
+#ifndef J1939_PGN_INDEX_TEST_H
+#define J1939_PGN_INDEX_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class J1939PgnIndexTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(J1939PgnIndexTest);
+
+    CPPUNIT_TEST(testFind);
+    CPPUNIT_TEST(testReplace);
+    CPPUNIT_TEST(testGrow);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    J1939PgnIndexTest() = default;
+    virtual ~J1939PgnIndexTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testFind();
+    void testReplace();
+    void testGrow();
+
+};
+
+#endif /* J1939_PGN_INDEX_TEST_H */
@@ -0,0 +1,155 @@
+/**
+ * @file j1939_simulator_test.cpp
+ *
+ * Unit test for the payload cache of the cyclic PGNs of the
+ * `J1939Simulator`. The payload functions return the number of their calls
+ * in the first byte, so the test sees whether Lua was called again. Like the
+ * other CAN tests, this needs the virtual CAN interface `vcan0` and the
+ * J1939 kernel module (`sudo modprobe can-j1939`).
+ */
+
+#include "j1939_simulator_test.h"
+#include "j1939_simulator.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+const std::string DEVICE = "vcan0";
+const std::string LUA_SCRIPT = "/tmp/j1939_simulator_test.lua";
+
+constexpr std::uint32_t STATIC_PGN = 65265;
+constexpr std::uint32_t CACHED_PGN = 65262;
+constexpr std::uint32_t UNCACHED_PGN = 65263;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(J1939SimulatorTest);
+
+namespace
+{
+
+/**
+ * The cycle times are long, so the scheduler only sends the first cycle
+ * while a test runs.
+ */
+void writeScript()
+{
+    std::ofstream(LUA_SCRIPT, std::ios::trunc)
+        << "cachedCalls = 0\n"
+        << "uncachedCalls = 0\n"
+        << "Main = {\n"
+        << "    J1939SourceAddress = 0x0B,\n"
+        << "    PGNs = {\n"
+        << "        [\"65265\"] = { payload = \"01 02 03 04 05 06 07 08\", cycleTime = 60000 },\n"
+        << "        [\"65262\"] = {\n"
+        << "            cycleTime = 61000,\n"
+        << "            cachePayload = true,\n"
+        << "            payload = function ()\n"
+        << "                cachedCalls = cachedCalls + 1\n"
+        << "                return string.format(\"%02X FF FF FF FF FF FF FF\", cachedCalls)\n"
+        << "            end\n"
+        << "        },\n"
+        << "        [\"65263\"] = {\n"
+        << "            cycleTime = 62000,\n"
+        << "            payload = function ()\n"
+        << "                uncachedCalls = uncachedCalls + 1\n"
+        << "                return string.format(\"%02X FF FF FF FF FF FF FF\", uncachedCalls)\n"
+        << "            end\n"
+        << "        },\n"
+        << "    }\n"
+        << "}\n";
+}
+
+std::vector<std::uint8_t> getPayload(J1939Simulator& simulator, std::uint32_t pgn)
+{
+    std::vector<std::uint8_t> payload;
+    unsigned int cycleTime = 0;
+    simulator.getCyclicPayload(std::to_string(pgn), pgn, payload, cycleTime);
+    return payload;
+}
+
+}
+
+void J1939SimulatorTest::setUp()
+{
+    writeScript();
+}
+
+void J1939SimulatorTest::tearDown()
+{
+    std::remove(LUA_SCRIPT.c_str());
+}
+
+void J1939SimulatorTest::testStaticPayload()
+{
+    EcuLuaScript script("Main", LUA_SCRIPT);
+    J1939Simulator simulator(DEVICE, &script);
+
+    const std::vector<std::uint8_t> tablePayload = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+    CPPUNIT_ASSERT(tablePayload == getPayload(simulator, STATIC_PGN));
+    CPPUNIT_ASSERT(simulator.isStaticPayload(STATIC_PGN));
+
+    const std::vector<std::uint8_t> setPayload = {0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18};
+    simulator.setPGNPayload(std::to_string(STATIC_PGN), setPayload);
+    CPPUNIT_ASSERT(setPayload == getPayload(simulator, STATIC_PGN));
+    CPPUNIT_ASSERT(setPayload == getPayload(simulator, STATIC_PGN));
+
+    // the payload of the table is read again
+    simulator.invalidatePGN(std::to_string(STATIC_PGN));
+    CPPUNIT_ASSERT(tablePayload == getPayload(simulator, STATIC_PGN));
+    simulator.stopSimulation();
+}
+
+void J1939SimulatorTest::testCachedPayload()
+{
+    EcuLuaScript script("Main", LUA_SCRIPT);
+    J1939Simulator simulator(DEVICE, &script);
+    // let the scheduler send the first cycle
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    const std::vector<std::uint8_t> first = getPayload(simulator, CACHED_PGN);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(8), first.size());
+    CPPUNIT_ASSERT(simulator.isStaticPayload(CACHED_PGN));
+    // unchanged, the function is not called again
+    CPPUNIT_ASSERT(first == getPayload(simulator, CACHED_PGN));
+    CPPUNIT_ASSERT(first == getPayload(simulator, CACHED_PGN));
+
+    simulator.invalidatePGN(std::to_string(CACHED_PGN));
+    const std::vector<std::uint8_t> invalidated = getPayload(simulator, CACHED_PGN);
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(first[0] + 1), invalidated[0]);
+    CPPUNIT_ASSERT(invalidated == getPayload(simulator, CACHED_PGN));
+
+    // the set payload is kept without calling the function
+    const std::vector<std::uint8_t> setPayload = {0xA0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    simulator.setPGNPayload(std::to_string(CACHED_PGN), setPayload);
+    CPPUNIT_ASSERT(setPayload == getPayload(simulator, CACHED_PGN));
+    CPPUNIT_ASSERT(setPayload == getPayload(simulator, CACHED_PGN));
+    simulator.invalidatePGN(std::to_string(CACHED_PGN));
+    CPPUNIT_ASSERT_EQUAL(std::uint8_t(invalidated[0] + 1), getPayload(simulator, CACHED_PGN)[0]);
+    simulator.stopSimulation();
+}
+
+void J1939SimulatorTest::testUncachedPayload()
+{
+    EcuLuaScript script("Main", LUA_SCRIPT);
+    J1939Simulator simulator(DEVICE, &script);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    CPPUNIT_ASSERT(!simulator.isStaticPayload(UNCACHED_PGN));
+    // the function is called on every cycle
+    const std::vector<std::uint8_t> first = getPayload(simulator, UNCACHED_PGN);
+    const std::vector<std::uint8_t> second = getPayload(simulator, UNCACHED_PGN);
+    CPPUNIT_ASSERT(second[0] > first[0]);
+
+    // a set payload is kept until the PGN is invalidated
+    const std::vector<std::uint8_t> setPayload = {0xA0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    simulator.setPGNPayload(std::to_string(UNCACHED_PGN), setPayload);
+    CPPUNIT_ASSERT(setPayload == getPayload(simulator, UNCACHED_PGN));
+    CPPUNIT_ASSERT(setPayload == getPayload(simulator, UNCACHED_PGN));
+    simulator.invalidatePGN(std::to_string(UNCACHED_PGN));
+    const std::vector<std::uint8_t> third = getPayload(simulator, UNCACHED_PGN);
+    CPPUNIT_ASSERT(third[0] > second[0]);
+    CPPUNIT_ASSERT(getPayload(simulator, UNCACHED_PGN)[0] > third[0]);
+    simulator.stopSimulation();
+}
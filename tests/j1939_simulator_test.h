@@ -0,0 +1,35 @@
+/**
+ * @file j1939_simulator_test.h
+ *
+ */
+
+#ifndef J1939_SIMULATOR_TEST_H
+#define J1939_SIMULATOR_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class J1939SimulatorTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(J1939SimulatorTest);
+
+    CPPUNIT_TEST(testStaticPayload);
+    CPPUNIT_TEST(testCachedPayload);
+    CPPUNIT_TEST(testUncachedPayload);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    J1939SimulatorTest() = default;
+    virtual ~J1939SimulatorTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testStaticPayload();
+    void testCachedPayload();
+    void testUncachedPayload();
+
+};
+
+#endif /* J1939_SIMULATOR_TEST_H */
+
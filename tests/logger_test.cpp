@@ -0,0 +1,76 @@
+/**
+ * @file logger_test.cpp
+ *
+ * Unit test for the asynchronous logger.
+ */
+
+#include "logger_test.h"
+#include "logger.h"
+#include <cstdint>
+#include <sstream>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(LoggerTest);
+
+void LoggerTest::setUp()
+{
+    Logger::setLevel(LogLevel::INFO);
+}
+
+void LoggerTest::tearDown()
+{
+    Logger::setLevel(LogLevel::INFO);
+}
+
+void LoggerTest::testParseLevel()
+{
+    LogLevel level = LogLevel::INFO;
+    CPPUNIT_ASSERT_EQUAL(true, Logger::parseLevel("debug", level));
+    CPPUNIT_ASSERT(level == LogLevel::DEBUG);
+    CPPUNIT_ASSERT_EQUAL(true, Logger::parseLevel("WARNING", level));
+    CPPUNIT_ASSERT(level == LogLevel::WARNING);
+    CPPUNIT_ASSERT_EQUAL(true, Logger::parseLevel("none", level));
+    CPPUNIT_ASSERT(level == LogLevel::NONE);
+    CPPUNIT_ASSERT_EQUAL(false, Logger::parseLevel("verbose", level));
+    CPPUNIT_ASSERT(level == LogLevel::NONE);
+}
+
+void LoggerTest::testIsEnabled()
+{
+    Logger::setLevel(LogLevel::WARNING);
+    CPPUNIT_ASSERT_EQUAL(false, Logger::isEnabled(LogLevel::INFO));
+    CPPUNIT_ASSERT_EQUAL(true, Logger::isEnabled(LogLevel::WARNING));
+    CPPUNIT_ASSERT_EQUAL(true, Logger::isEnabled(LogLevel::ERROR));
+
+    Logger::setLevel(LogLevel::NONE);
+    CPPUNIT_ASSERT_EQUAL(false, Logger::isEnabled(LogLevel::ERROR));
+}
+
+void LoggerTest::testArgumentsNotEvaluated()
+{
+    int evaluated = 0;
+    Logger::setLevel(LogLevel::ERROR);
+    LOG_INFO("not written " << ++evaluated);
+    CPPUNIT_ASSERT_EQUAL(0, evaluated);
+    LOG_ERROR("written " << ++evaluated);
+    CPPUNIT_ASSERT_EQUAL(1, evaluated);
+}
+
+void LoggerTest::testHexDump()
+{
+    const std::uint8_t bytes[] = {0x00, 0x1A, 0xFF};
+    std::ostringstream stream;
+    stream << std::dec << hexDump(bytes, sizeof(bytes));
+    CPPUNIT_ASSERT_EQUAL(std::string(" 0x00 0x1a 0xff"), stream.str());
+}
+
+void LoggerTest::testFlush()
+{
+    Logger& logger = Logger::getInstance();
+    const std::uint64_t dropped = logger.getDroppedMessages();
+    for (int i = 0; i < 100; ++i)
+    {
+        LOG_INFO("LoggerTest message " << i);
+    }
+    logger.flush();
+    CPPUNIT_ASSERT_EQUAL(dropped, logger.getDroppedMessages());
+}
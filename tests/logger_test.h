@@ -0,0 +1,39 @@
+/**
+ * @file logger_test.h
+ *
+ */
+
+#ifndef LOGGER_TEST_H
+#define LOGGER_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class LoggerTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(LoggerTest);
+
+    CPPUNIT_TEST(testParseLevel);
+    CPPUNIT_TEST(testIsEnabled);
+    CPPUNIT_TEST(testArgumentsNotEvaluated);
+    CPPUNIT_TEST(testHexDump);
+    CPPUNIT_TEST(testFlush);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    LoggerTest() = default;
+    virtual ~LoggerTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testParseLevel();
+    void testIsEnabled();
+    void testArgumentsNotEvaluated();
+    void testHexDump();
+    void testFlush();
+
+};
+
+#endif /* LOGGER_TEST_H */
+
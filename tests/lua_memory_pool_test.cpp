@@ -0,0 +1,121 @@
+/**
+ * @file lua_memory_pool_test.cpp
+ *
+ * Unit test for the allocator of the Lua states. The pool is called like Lua
+ * calls a `lua_Alloc`, so no Lua state is needed.
+ */
+
+#include "lua_memory_pool_test.h"
+#include "lua_memory_pool.h"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(LuaMemoryPoolTest);
+
+/// the type Lua passes as `osize` for a new table
+static constexpr size_t LUA_TABLE_TYPE = 5;
+
+void LuaMemoryPoolTest::setUp() { }
+
+void LuaMemoryPoolTest::tearDown() { }
+
+void LuaMemoryPoolTest::testReuseOfFreedBlocks()
+{
+    LuaMemoryPool pool;
+    void* pBlock = LuaMemoryPool::allocate(&pool, nullptr, LUA_TABLE_TYPE, 56);
+    CPPUNIT_ASSERT(pBlock != nullptr);
+    CPPUNIT_ASSERT_EQUAL(size_t(56), pool.getUsedBytes());
+    CPPUNIT_ASSERT_EQUAL(LuaMemoryPool::CHUNK_SIZE, pool.getReservedBytes());
+
+    CPPUNIT_ASSERT(LuaMemoryPool::allocate(&pool, pBlock, 56, 0) == nullptr);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), pool.getUsedBytes());
+    // a block of the same size class gets the freed one back
+    CPPUNIT_ASSERT(LuaMemoryPool::allocate(&pool, nullptr, 0, 50) == pBlock);
+    // other size classes are carved from the chunk
+    void* pOther = LuaMemoryPool::allocate(&pool, nullptr, 0, 24);
+    CPPUNIT_ASSERT(pOther != nullptr && pOther != pBlock);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), reinterpret_cast<uintptr_t>(pOther) % LuaMemoryPool::GRANULARITY);
+    CPPUNIT_ASSERT_EQUAL(LuaMemoryPool::CHUNK_SIZE, pool.getReservedBytes());
+
+    // large blocks are not pooled
+    void* pLarge = LuaMemoryPool::allocate(&pool, nullptr, 0, 1000);
+    CPPUNIT_ASSERT(pLarge != nullptr);
+    CPPUNIT_ASSERT_EQUAL(LuaMemoryPool::CHUNK_SIZE + 1000, pool.getReservedBytes());
+    LuaMemoryPool::allocate(&pool, pLarge, 1000, 0);
+    LuaMemoryPool::allocate(&pool, pOther, 24, 0);
+    LuaMemoryPool::allocate(&pool, pBlock, 50, 0);
+    CPPUNIT_ASSERT_EQUAL(LuaMemoryPool::CHUNK_SIZE, pool.getReservedBytes());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), pool.getUsedBytes());
+}
+
+void LuaMemoryPoolTest::testReallocate()
+{
+    LuaMemoryPool pool;
+    char* pBlock = static_cast<char*> (LuaMemoryPool::allocate(&pool, nullptr, 0, 20));
+    memcpy(pBlock, "0123456789012345678", 20);
+
+    // within the size class the block is kept
+    CPPUNIT_ASSERT(LuaMemoryPool::allocate(&pool, pBlock, 20, 32) == pBlock);
+    // the content is moved to a larger class and on to the heap
+    pBlock = static_cast<char*> (LuaMemoryPool::allocate(&pool, pBlock, 32, 200));
+    CPPUNIT_ASSERT_EQUAL(string("0123456789012345678"), string(pBlock));
+    pBlock = static_cast<char*> (LuaMemoryPool::allocate(&pool, pBlock, 200, 5000));
+    CPPUNIT_ASSERT_EQUAL(string("0123456789012345678"), string(pBlock));
+    pBlock = static_cast<char*> (LuaMemoryPool::allocate(&pool, pBlock, 5000, 10000));
+    CPPUNIT_ASSERT_EQUAL(string("0123456789012345678"), string(pBlock));
+    CPPUNIT_ASSERT_EQUAL(size_t(10000), pool.getUsedBytes());
+    // and back
+    pBlock = static_cast<char*> (LuaMemoryPool::allocate(&pool, pBlock, 10000, 20));
+    CPPUNIT_ASSERT_EQUAL(string("0123456789012345678"), string(pBlock));
+    CPPUNIT_ASSERT_EQUAL(size_t(20), pool.getUsedBytes());
+    CPPUNIT_ASSERT_EQUAL(LuaMemoryPool::CHUNK_SIZE, pool.getReservedBytes());
+    LuaMemoryPool::allocate(&pool, pBlock, 20, 0);
+}
+
+void LuaMemoryPoolTest::testLimit()
+{
+    auto pStatistics = make_shared<LuaMemoryStatistics>();
+    LuaMemoryPool pool(pStatistics);
+    pool.setLimit(1000);
+    CPPUNIT_ASSERT_EQUAL(size_t(1000), pStatistics->limitBytes.load());
+
+    void* pBlock = LuaMemoryPool::allocate(&pool, nullptr, 0, 800);
+    CPPUNIT_ASSERT(pBlock != nullptr);
+    CPPUNIT_ASSERT(LuaMemoryPool::allocate(&pool, nullptr, 0, 300) == nullptr);
+    CPPUNIT_ASSERT(LuaMemoryPool::allocate(&pool, pBlock, 800, 1200) == nullptr);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), pStatistics->failedAllocations.load());
+    CPPUNIT_ASSERT_EQUAL(size_t(800), pool.getUsedBytes());
+
+    // shrinking works beyond the limit
+    pool.setLimit(100);
+    pBlock = LuaMemoryPool::allocate(&pool, pBlock, 800, 400);
+    CPPUNIT_ASSERT(pBlock != nullptr);
+    CPPUNIT_ASSERT(LuaMemoryPool::allocate(&pool, nullptr, 0, 16) == nullptr);
+    LuaMemoryPool::allocate(&pool, pBlock, 400, 0);
+    CPPUNIT_ASSERT(LuaMemoryPool::allocate(&pool, nullptr, 0, 16) != nullptr);
+}
+
+void LuaMemoryPoolTest::testStatistics()
+{
+    auto pStatistics = make_shared<LuaMemoryStatistics>();
+    {
+        // e.g. the old and the new version during a reload
+        LuaMemoryPool oldPool(pStatistics);
+        LuaMemoryPool newPool(pStatistics);
+        void* pOld = LuaMemoryPool::allocate(&oldPool, nullptr, 0, 100);
+        void* pNew = LuaMemoryPool::allocate(&newPool, nullptr, 0, 2000);
+        CPPUNIT_ASSERT_EQUAL(size_t(2100), pStatistics->usedBytes.load());
+        CPPUNIT_ASSERT_EQUAL(LuaMemoryPool::CHUNK_SIZE + 2000, pStatistics->reservedBytes.load());
+        LuaMemoryPool::allocate(&newPool, pNew, 2000, 0);
+        CPPUNIT_ASSERT_EQUAL(size_t(100), pStatistics->usedBytes.load());
+        CPPUNIT_ASSERT_EQUAL(size_t(2100), pStatistics->peakBytes.load());
+        LuaMemoryPool::allocate(&oldPool, pOld, 100, 0);
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(0), pStatistics->usedBytes.load());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), pStatistics->reservedBytes.load());
+    CPPUNIT_ASSERT_EQUAL(size_t(2100), pStatistics->peakBytes.load());
+}
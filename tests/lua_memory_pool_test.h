@@ -0,0 +1,36 @@
+/**
+ * @file lua_memory_pool_test.h
+ *
+ */
+
+#ifndef LUA_MEMORY_POOL_TEST_H
+#define LUA_MEMORY_POOL_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class LuaMemoryPoolTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(LuaMemoryPoolTest);
+
+    CPPUNIT_TEST(testReuseOfFreedBlocks);
+    CPPUNIT_TEST(testReallocate);
+    CPPUNIT_TEST(testLimit);
+    CPPUNIT_TEST(testStatistics);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    LuaMemoryPoolTest() = default;
+    virtual ~LuaMemoryPoolTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testReuseOfFreedBlocks();
+    void testReallocate();
+    void testLimit();
+    void testStatistics();
+
+};
+
+#endif /* LUA_MEMORY_POOL_TEST_H */
@@ -0,0 +1,149 @@
+/**
+ * @file lua_profiler_test.cpp
+ *
+ * Unit test for the measurement of the Lua handlers. The handlers are
+ * simulated by sleeping, the sampling of the Lua stacks is not tested.
+ */
+
+#include "lua_profiler_test.h"
+#include "lua_profiler.h"
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(LuaProfilerTest);
+
+static constexpr uint64_t MS = 1000000; // in ns
+
+void LuaProfilerTest::setUp()
+{
+    LuaProfiler::getInstance().clear();
+    LuaProfiler::setEnabled(true);
+}
+
+void LuaProfilerTest::tearDown()
+{
+    LuaProfiler::setEnabled(false);
+    LuaProfiler::setQueueTime(chrono::steady_clock::duration::zero());
+}
+
+void LuaProfilerTest::testDisabled()
+{
+    LuaProfiler::setEnabled(false);
+    {
+        LuaProfiler::Scope profile("disabled.lua", LuaHandler::RAW, "22 F1 90");
+        CPPUNIT_ASSERT(LuaProfiler::getCurrentHandler() == nullptr);
+    }
+    LuaProfiler::HandlerStatistics* pHandler =
+        LuaProfiler::getInstance().getHandler("disabled.lua", LuaHandler::RAW, "22 F1 90");
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), pHandler->calls.load());
+}
+
+void LuaProfilerTest::testScope()
+{
+    for (int i = 0; i < 2; i++)
+    {
+        LuaProfiler::Scope profile("scope.lua", LuaHandler::RAW, "22 F1 90");
+        this_thread::sleep_for(chrono::milliseconds(5));
+    }
+    CPPUNIT_ASSERT(LuaProfiler::getCurrentHandler() == nullptr);
+
+    LuaProfiler::HandlerStatistics* pHandler =
+        LuaProfiler::getInstance().getHandler("scope.lua", LuaHandler::RAW, "22 F1 90");
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), pHandler->calls.load());
+    CPPUNIT_ASSERT(pHandler->runNs >= 10 * MS);
+    CPPUNIT_ASSERT(pHandler->maxRunNs >= 5 * MS);
+    CPPUNIT_ASSERT(pHandler->maxRunNs < pHandler->runNs);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), pHandler->waitNs.load());
+    CPPUNIT_ASSERT_EQUAL(string("scope.lua;Raw 22 F1 90"), pHandler->stackRoot);
+    // the same key of another table is another handler
+    CPPUNIT_ASSERT(pHandler != LuaProfiler::getInstance().getHandler("scope.lua", LuaHandler::J1939_RESPONSE, "22 F1 90"));
+}
+
+void LuaProfilerTest::testQueueTime()
+{
+    LuaProfiler::setQueueTime(chrono::milliseconds(3));
+    {
+        LuaProfiler::Scope profile("queue.lua", LuaHandler::DATA_IDENTIFIER, "F1 90");
+    }
+    // the queue time is only added to the first handler of a task
+    {
+        LuaProfiler::Scope profile("queue.lua", LuaHandler::DATA_IDENTIFIER, "F1 90");
+    }
+    LuaProfiler::HandlerStatistics* pHandler =
+        LuaProfiler::getInstance().getHandler("queue.lua", LuaHandler::DATA_IDENTIFIER, "F1 90");
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), pHandler->calls.load());
+    CPPUNIT_ASSERT_EQUAL(3 * MS, pHandler->waitNs.load());
+}
+
+void LuaProfilerTest::testNestedScope()
+{
+    LuaProfiler::setQueueTime(chrono::milliseconds(1));
+    {
+        LuaProfiler::Scope outer("nested.lua", LuaHandler::RAW, "22 F1 90");
+        {
+            LuaProfiler::Scope inner("nested.lua", LuaHandler::DATA_IDENTIFIER, "F1 90");
+            CPPUNIT_ASSERT_EQUAL(string("nested.lua;DID F1 90"), LuaProfiler::getCurrentHandler()->stackRoot);
+            this_thread::sleep_for(chrono::milliseconds(2));
+        }
+        CPPUNIT_ASSERT_EQUAL(string("nested.lua;Raw 22 F1 90"), LuaProfiler::getCurrentHandler()->stackRoot);
+    }
+    LuaProfiler::HandlerStatistics* pOuter =
+        LuaProfiler::getInstance().getHandler("nested.lua", LuaHandler::RAW, "22 F1 90");
+    LuaProfiler::HandlerStatistics* pInner =
+        LuaProfiler::getInstance().getHandler("nested.lua", LuaHandler::DATA_IDENTIFIER, "F1 90");
+    CPPUNIT_ASSERT(pOuter->runNs >= pInner->runNs);
+    CPPUNIT_ASSERT(pInner->runNs >= 2 * MS);
+    CPPUNIT_ASSERT_EQUAL(1 * MS, pOuter->waitNs.load());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), pInner->waitNs.load());
+}
+
+void LuaProfilerTest::testResumedScope()
+{
+    LuaProfiler::HandlerStatistics* pSuspended;
+    {
+        LuaProfiler::Scope profile("resumed.lua", LuaHandler::RAW, "31 01 FF 00");
+        pSuspended = LuaProfiler::getCurrentHandler();
+    }
+    // sleeping, not counted
+    this_thread::sleep_for(chrono::milliseconds(10));
+    {
+        LuaProfiler::Scope profile(pSuspended);
+        this_thread::sleep_for(chrono::milliseconds(2));
+    }
+    // a call which was not measured is not continued
+    {
+        LuaProfiler::Scope profile(nullptr);
+        CPPUNIT_ASSERT(LuaProfiler::getCurrentHandler() == nullptr);
+    }
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), pSuspended->calls.load());
+    CPPUNIT_ASSERT(pSuspended->runNs >= 2 * MS);
+    CPPUNIT_ASSERT(pSuspended->runNs < 10 * MS);
+}
+
+void LuaProfilerTest::testReport()
+{
+    {
+        LuaProfiler::Scope profile("report.lua", LuaHandler::J1939_PGN, "65262");
+        this_thread::sleep_for(chrono::milliseconds(2));
+    }
+    {
+        LuaProfiler::Scope profile("report.lua", LuaHandler::RAW, "22 F1 90");
+    }
+    ostringstream report;
+    LuaProfiler::getInstance().writeReport(report, 1);
+    // only the slowest handler is listed
+    CPPUNIT_ASSERT(report.str().find("report.lua PGN 65262") != string::npos);
+    CPPUNIT_ASSERT(report.str().find("report.lua Raw 22 F1 90") == string::npos);
+
+    ostringstream stacks;
+    LuaProfiler::getInstance().writeCollapsedStacks(stacks);
+    CPPUNIT_ASSERT(stacks.str().find("report.lua;PGN 65262 ") != string::npos);
+
+    LuaProfiler::getInstance().clear();
+    ostringstream cleared;
+    LuaProfiler::getInstance().writeCollapsedStacks(cleared);
+    CPPUNIT_ASSERT(cleared.str().empty());
+}
@@ -0,0 +1,41 @@
+/**
+ * @file lua_profiler_test.h
+ *
+ */
+
+#ifndef LUA_PROFILER_TEST_H
+#define LUA_PROFILER_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class LuaProfilerTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(LuaProfilerTest);
+
+    CPPUNIT_TEST(testDisabled);
+    CPPUNIT_TEST(testScope);
+    CPPUNIT_TEST(testQueueTime);
+    CPPUNIT_TEST(testNestedScope);
+    CPPUNIT_TEST(testResumedScope);
+    CPPUNIT_TEST(testReport);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    LuaProfilerTest() = default;
+    virtual ~LuaProfilerTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testDisabled();
+    void testScope();
+    void testQueueTime();
+    void testNestedScope();
+    void testResumedScope();
+    void testReport();
+
+};
+
+#endif /* LUA_PROFILER_TEST_H */
+
@@ -0,0 +1,169 @@
+/**
+ * @file lua_worker_test.cpp
+ *
+ * Unit test for the worker thread, which executes all Lua calls of one ECU.
+ * The tasks only record when and where they run, so no Lua state is needed.
+ */
+
+#include "lua_worker_test.h"
+#include "lua_worker.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(LuaWorkerTest);
+
+namespace
+{
+
+/// detects tasks running at the same time or outside of the worker
+class Task
+{
+public:
+    explicit Task(LuaWorker& worker)
+    : worker_(worker)
+    {
+    }
+
+    unsigned int operator ()()
+    {
+        if (isInside_.exchange(true) || !worker_.isWorkerThread())
+        {
+            isViolated_ = true;
+        }
+        this_thread::yield();
+        const unsigned int count = ++count_; // not atomic, like the Lua state
+        isInside_ = false;
+        return count;
+    }
+
+    unsigned int getCount() const { return count_; }
+    bool isViolated() const { return isViolated_; }
+
+private:
+    LuaWorker& worker_;
+    atomic<bool> isInside_{false};
+    atomic<bool> isViolated_{false};
+    unsigned int count_ = 0;
+};
+
+}
+
+void LuaWorkerTest::setUp()
+{
+}
+
+void LuaWorkerTest::tearDown()
+{
+}
+
+/**
+ * The calls of several threads (e.g. UDS, J1939 and DoIP) are executed one
+ * after the other on the worker thread, also mixed with posted tasks.
+ */
+void LuaWorkerTest::testSerializedCalls()
+{
+    constexpr unsigned int NUM_THREADS = 8;
+    constexpr unsigned int NUM_CALLS = 200;
+    LuaWorker worker;
+    Task task(worker);
+
+    vector<thread> callers;
+    for (unsigned int i = 0; i < NUM_THREADS; ++i)
+    {
+        callers.emplace_back([&worker, &task]()
+        {
+            for (unsigned int j = 0; j < NUM_CALLS; ++j)
+            {
+                worker.call([&task]() { return task(); });
+                worker.post([&task]() { task(); }, (j % 2 == 0) ? LuaWorker::Priority::HIGH
+                                                                : LuaWorker::Priority::LOW);
+            }
+        });
+    }
+    for (thread& caller : callers)
+    {
+        caller.join();
+    }
+    // the tasks of low priority are executed in the order they were posted
+    promise<void> done;
+    worker.post([&task, &done]()
+    {
+        task();
+        done.set_value();
+    }, LuaWorker::Priority::LOW);
+    done.get_future().wait();
+
+    CPPUNIT_ASSERT(!task.isViolated());
+    CPPUNIT_ASSERT(!worker.isWorkerThread());
+    CPPUNIT_ASSERT_EQUAL(2 * NUM_THREADS * NUM_CALLS + 1, task.getCount());
+}
+
+/**
+ * The tasks are executed in the order they were posted, the long running
+ * tasks of low priority only if no other task is queued, and the delayed
+ * tasks once they are due.
+ */
+void LuaWorkerTest::testOrder()
+{
+    LuaWorker worker;
+    mutex orderMutex;
+    vector<int> order;
+    const auto record = [&orderMutex, &order](int id)
+    {
+        lock_guard<mutex> lock(orderMutex);
+        order.push_back(id);
+    };
+
+    // keeps the worker busy until all tasks are queued
+    promise<void> release;
+    shared_future<void> released = release.get_future().share();
+    worker.post([released]() { released.wait(); });
+
+    worker.postDelayed(chrono::milliseconds(50), [&record]() { record(6); });
+    worker.post([&record]() { record(4); }, LuaWorker::Priority::LOW);
+    worker.post([&record]() { record(1); });
+    worker.post([&record]() { record(5); }, LuaWorker::Priority::LOW);
+    worker.post([&record]() { record(2); });
+    worker.post([&record]() { record(3); });
+    release.set_value();
+
+    this_thread::sleep_for(chrono::milliseconds(150));
+    worker.call([]() {});
+    const vector<int> expected = {1, 2, 3, 4, 5, 6};
+    lock_guard<mutex> lock(orderMutex);
+    CPPUNIT_ASSERT(expected == order);
+}
+
+/**
+ * A call from the worker thread itself (e.g. a C++ function called by Lua)
+ * is executed right away instead of waiting for itself.
+ */
+void LuaWorkerTest::testNestedCall()
+{
+    LuaWorker worker;
+    const int result = worker.call([&worker]()
+    {
+        return worker.call([&worker]() { return worker.isWorkerThread() ? 42 : 0; }) + 1;
+    });
+    CPPUNIT_ASSERT_EQUAL(43, result);
+}
+
+/**
+ * The exception of a call is thrown to its caller and the worker goes on with
+ * the next task.
+ */
+void LuaWorkerTest::testException()
+{
+    LuaWorker worker;
+    CPPUNIT_ASSERT_THROW(worker.call([]() -> int { throw runtime_error("Lua error"); }), runtime_error);
+    // an exception of a posted task is only logged
+    worker.post([]() { throw runtime_error("Lua error"); });
+    CPPUNIT_ASSERT_EQUAL(string("done"), worker.call([]() { return string("done"); }));
+}
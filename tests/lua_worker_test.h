@@ -0,0 +1,37 @@
+/**
+ * @file lua_worker_test.h
+ *
+ */
+
+#ifndef LUA_WORKER_TEST_H
+#define LUA_WORKER_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class LuaWorkerTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(LuaWorkerTest);
+
+    CPPUNIT_TEST(testSerializedCalls);
+    CPPUNIT_TEST(testOrder);
+    CPPUNIT_TEST(testNestedCall);
+    CPPUNIT_TEST(testException);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    LuaWorkerTest() = default;
+    virtual ~LuaWorkerTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testSerializedCalls();
+    void testOrder();
+    void testNestedCall();
+    void testException();
+
+};
+
+#endif /* LUA_WORKER_TEST_H */
+
@@ -0,0 +1,126 @@
+/**
+ * @file memory_service_test.cpp
+ *
+ * Unit test for the native ReadMemoryByAddress / WriteMemoryByAddress on
+ * memory images.
+ */
+
+#include "memory_service_test.h"
+#include "memory_service.h"
+#include "service_identifier.h"
+#include <unistd.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MemoryServiceTest);
+
+/// the size of the memory image, a page and a half
+static constexpr size_t IMAGE_SIZE = 6144;
+
+static vector<uint8_t> proceed(MemoryService& service, const vector<uint8_t>& request)
+{
+    vector<uint8_t> response;
+    service.proceedRequest(request.data(), request.size(), response);
+    return response;
+}
+
+void MemoryServiceTest::setUp()
+{
+    imageFile_ = "/tmp/memory_service_test_" + to_string(getpid()) + ".bin";
+    ofstream image(imageFile_, ios::binary | ios::trunc);
+    for (size_t i = 0; i < IMAGE_SIZE; ++i)
+    {
+        image.put(char(i & 0xFF));
+    }
+}
+
+void MemoryServiceTest::tearDown()
+{
+    remove(imageFile_.c_str());
+}
+
+void MemoryServiceTest::testReadMemory()
+{
+    MemoryRegionConfiguration calibration;
+    calibration.address = 0x00800000;
+    calibration.file = imageFile_;
+    MemoryRegionConfiguration page;
+    page.address = 0x00010000;
+    page.file = imageFile_;
+    page.offset = 4097; // not page aligned
+    page.size = 16;
+    MemoryService service({calibration, page}, 4095);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), service.getRegionCount());
+
+    // `23 24 address size`
+    CPPUNIT_ASSERT(proceed(service, {READ_MEMORY_BY_ADDRESS_REQ, 0x14, 0x00, 0x80, 0x01, 0x00, 0x04})
+                   == vector<uint8_t>({READ_MEMORY_BY_ADDRESS_RES, 0x00, 0x01, 0x02, 0x03}));
+    CPPUNIT_ASSERT(proceed(service, {READ_MEMORY_BY_ADDRESS_REQ, 0x14, 0x00, 0x01, 0x00, 0x0E, 0x02})
+                   == vector<uint8_t>({READ_MEMORY_BY_ADDRESS_RES, 0x0F, 0x10}));
+
+    // a full message from the end of the image
+    const vector<uint8_t> last = proceed(service, {READ_MEMORY_BY_ADDRESS_REQ, 0x24,
+                                                   0x00, 0x80, 0x08, 0x02, 0x0F, 0xFE});
+    CPPUNIT_ASSERT_EQUAL(size_t(4095), last.size());
+    CPPUNIT_ASSERT_EQUAL(uint8_t((IMAGE_SIZE - 1) & 0xFF), last.back());
+}
+
+void MemoryServiceTest::testWriteMemory()
+{
+    MemoryRegionConfiguration ram;
+    ram.address = 0x2000;
+    ram.file = imageFile_;
+    ram.size = 256;
+    ram.isWritable = true;
+    MemoryRegionConfiguration flash;
+    flash.address = 0x8000;
+    flash.file = imageFile_;
+    MemoryService service({ram, flash}, 4095);
+
+    CPPUNIT_ASSERT(proceed(service, {WRITE_MEMORY_BY_ADDRESS_REQ, 0x12, 0x20, 0x10, 0x02, 0xAA, 0xBB})
+                   == vector<uint8_t>({WRITE_MEMORY_BY_ADDRESS_RES, 0x12, 0x20, 0x10, 0x02}));
+    CPPUNIT_ASSERT(proceed(service, {READ_MEMORY_BY_ADDRESS_REQ, 0x12, 0x20, 0x0F, 0x04})
+                   == vector<uint8_t>({READ_MEMORY_BY_ADDRESS_RES, 0x0F, 0xAA, 0xBB, 0x12}));
+
+    // a read-only region is not written, a copy-on-write one not the file
+    CPPUNIT_ASSERT(proceed(service, {WRITE_MEMORY_BY_ADDRESS_REQ, 0x12, 0x80, 0x00, 0x01, 0xAA})
+                   == vector<uint8_t>({ERROR, WRITE_MEMORY_BY_ADDRESS_REQ, REQUEST_OUT_OF_RANGE}));
+    CPPUNIT_ASSERT(proceed(service, {READ_MEMORY_BY_ADDRESS_REQ, 0x12, 0x80, 0x10, 0x02})
+                   == vector<uint8_t>({READ_MEMORY_BY_ADDRESS_RES, 0x10, 0x11}));
+}
+
+void MemoryServiceTest::testInvalidRequests()
+{
+    MemoryRegionConfiguration region;
+    region.address = 0x1000;
+    region.file = imageFile_;
+    region.size = 0x100;
+    MemoryRegionConfiguration overlapping = region;
+    overlapping.address = 0x10FF;
+    MemoryRegionConfiguration missing = region;
+    missing.address = 0x4000;
+    missing.file = imageFile_ + ".missing";
+    MemoryService service({region, overlapping, missing}, 64);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), service.getRegionCount());
+
+    const vector<uint8_t> outOfRange = {ERROR, READ_MEMORY_BY_ADDRESS_REQ, REQUEST_OUT_OF_RANGE};
+    const vector<uint8_t> invalidFormat = {ERROR, READ_MEMORY_BY_ADDRESS_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT};
+    CPPUNIT_ASSERT(proceed(service, {READ_MEMORY_BY_ADDRESS_REQ}) == invalidFormat);
+    CPPUNIT_ASSERT(proceed(service, {READ_MEMORY_BY_ADDRESS_REQ, 0x12, 0x10, 0x00}) == invalidFormat);
+    CPPUNIT_ASSERT(proceed(service, {READ_MEMORY_BY_ADDRESS_REQ, 0x12, 0x10, 0x00, 0x01, 0x00}) == invalidFormat);
+    CPPUNIT_ASSERT(proceed(service, {READ_MEMORY_BY_ADDRESS_REQ, 0x15, 0x00, 0x00, 0x00, 0x10, 0x00, 0x01})
+                   == outOfRange);
+    // beyond the region, across its end, zero bytes and longer than a response
+    CPPUNIT_ASSERT(proceed(service, {READ_MEMORY_BY_ADDRESS_REQ, 0x12, 0x11, 0x00, 0x01}) == outOfRange);
+    CPPUNIT_ASSERT(proceed(service, {READ_MEMORY_BY_ADDRESS_REQ, 0x12, 0x10, 0xFF, 0x02}) == outOfRange);
+    CPPUNIT_ASSERT(proceed(service, {READ_MEMORY_BY_ADDRESS_REQ, 0x12, 0x10, 0x00, 0x00}) == outOfRange);
+    CPPUNIT_ASSERT(proceed(service, {READ_MEMORY_BY_ADDRESS_REQ, 0x12, 0x10, 0x00, 0x40}) == outOfRange);
+    CPPUNIT_ASSERT_EQUAL(size_t(64), proceed(service, {READ_MEMORY_BY_ADDRESS_REQ, 0x12, 0x10, 0x00, 0x3F}).size());
+    // the data has to match the memory size
+    CPPUNIT_ASSERT(proceed(service, {WRITE_MEMORY_BY_ADDRESS_REQ, 0x12, 0x10, 0x00, 0x02, 0xAA})
+                   == vector<uint8_t>({ERROR, WRITE_MEMORY_BY_ADDRESS_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT}));
+}
@@ -0,0 +1,37 @@
+/**
+ * @file memory_service_test.h
+ *
+ */
+
+#ifndef MEMORY_SERVICE_TEST_H
+#define MEMORY_SERVICE_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+class MemoryServiceTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(MemoryServiceTest);
+
+    CPPUNIT_TEST(testReadMemory);
+    CPPUNIT_TEST(testWriteMemory);
+    CPPUNIT_TEST(testInvalidRequests);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    MemoryServiceTest() = default;
+    virtual ~MemoryServiceTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    std::string imageFile_;
+
+    void testReadMemory();
+    void testWriteMemory();
+    void testInvalidRequests();
+
+};
+
+#endif /* MEMORY_SERVICE_TEST_H */
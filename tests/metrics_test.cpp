@@ -0,0 +1,181 @@
+/**
+ * @file metrics_test.cpp
+ *
+ * Unit test for the latency histograms and their Prometheus export.
+ */
+
+#include "metrics_test.h"
+#include "metrics.h"
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MetricsTest);
+
+void MetricsTest::setUp() { }
+
+void MetricsTest::tearDown() { }
+
+void MetricsTest::testBucketResolution()
+{
+    size_t lastIndex = 0;
+    for (uint64_t value = 0; value < 10000000; value += 1 + value / 64)
+    {
+        const size_t index = LatencyHistogram::getBucketIndex(value);
+        const uint64_t upperBound = LatencyHistogram::getBucketUpperBound(index);
+        CPPUNIT_ASSERT(index >= lastIndex);
+        CPPUNIT_ASSERT(upperBound >= value);
+        // at most 12.5 % too high
+        CPPUNIT_ASSERT(upperBound - value <= value / LatencyHistogram::SUB_BUCKETS);
+        if (index > 0)
+        {
+            CPPUNIT_ASSERT(LatencyHistogram::getBucketUpperBound(index - 1) < value);
+        }
+        lastIndex = index;
+    }
+    CPPUNIT_ASSERT_EQUAL(LatencyHistogram::BUCKET_COUNT - 1,
+                         LatencyHistogram::getBucketIndex(UINT64_MAX));
+}
+
+void MetricsTest::testQuantiles()
+{
+    LatencyHistogram histogram;
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), histogram.getValueAtQuantile(0.99));
+
+    for (uint64_t value = 1; value <= 1000; ++value)
+    {
+        histogram.record(value);
+    }
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1000), histogram.getCount());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(500500), histogram.getSumUs());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1000), histogram.getMaxUs());
+
+    const uint64_t median = histogram.getValueAtQuantile(0.5);
+    CPPUNIT_ASSERT(median >= 500 && median <= 500 + 500 / 8);
+    const uint64_t p99 = histogram.getValueAtQuantile(0.99);
+    CPPUNIT_ASSERT(p99 >= 990 && p99 <= 1000);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1000), histogram.getValueAtQuantile(1.0));
+
+    CPPUNIT_ASSERT_EQUAL(uint64_t(7), histogram.getCountAtOrBelow(7));
+    CPPUNIT_ASSERT(histogram.getCountAtOrBelow(100) <= 100);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1000), histogram.getCountAtOrBelow(2000));
+}
+
+void MetricsTest::testRequestTimer()
+{
+    EcuMetrics ecu("uds", 0x7E0);
+    const auto now = chrono::steady_clock::now();
+    const uint8_t positive[] = {0x62, 0xF1, 0x90};
+    const uint8_t negative[] = {0x7F, 0x22, 0x31};
+    {
+        RequestTimer timer(&ecu, 0x22, now);
+        timer.lookupFinished(true);
+        timer.luaStarted();
+        timer.luaFinished();
+        timer.responseSent(positive, sizeof(positive));
+        // only the first response counts
+        timer.responseSent(negative, sizeof(negative));
+    }
+    {
+        RequestTimer timer(&ecu, 0x22, now - chrono::milliseconds(60));
+        timer.lookupFinished(false);
+        timer.dispatched(DispatchLane::HIGH);
+        // taken along to the Lua worker
+        RequestTimer luaTimer(move(timer));
+        luaTimer.dispatched(DispatchLane::LOW);
+        timer.dispatched(DispatchLane::LOW);
+        luaTimer.responseSent(negative, sizeof(negative));
+    }
+    {
+        // nothing measured without metrics
+        RequestTimer timer(nullptr, 0x22, now);
+        timer.lookupFinished(true);
+        timer.responseSent(negative, sizeof(negative));
+    }
+
+    const ServiceMetrics* pService = ecu.findService(0x22);
+    CPPUNIT_ASSERT(pService != nullptr);
+    CPPUNIT_ASSERT(ecu.findService(0x10) == nullptr);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), pService->requests.load());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), pService->negativeResponses.load());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), pService->wildcardMatches.load());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), pService->p2Violations.load());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), pService->responseLatency.getCount());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), pService->lookupLatency.getCount());
+    CPPUNIT_ASSERT(pService->responseLatency.getMaxUs() >= 60000);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), ecu.queueLatency[size_t(DispatchLane::HIGH)].getCount());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), ecu.queueLatency[size_t(DispatchLane::LOW)].getCount());
+    CPPUNIT_ASSERT(ecu.queueLatency[size_t(DispatchLane::LOW)].getMaxUs() >= 60000);
+}
+
+void MetricsTest::testPrometheusOutput()
+{
+    Metrics metrics;
+    EcuMetrics* pEcu = metrics.registerEcu("uds", 0x7E0);
+    CPPUNIT_ASSERT(pEcu == metrics.registerEcu("uds", 0x7E0));
+    CPPUNIT_ASSERT(pEcu != metrics.registerEcu("doip", 0x7E0));
+    pEcu->sendRetries += 3;
+    pEcu->overloadResponses += 2;
+    auto pLuaMemory = make_shared<LuaMemoryStatistics>();
+    pLuaMemory->usedBytes = 4096;
+    pEcu->setLuaMemory(pLuaMemory);
+
+    pEcu->getService(0x22)->responseLatency.record(uint64_t(1500));
+    pEcu->getService(0x22)->requests++;
+    pEcu->queueLatency[size_t(DispatchLane::LOW)].record(uint64_t(1500));
+
+    ostringstream out;
+    metrics.writePrometheus(out);
+    const string text = out.str();
+    const string labels = "{transport=\"uds\",ecu=\"7E0\",sid=\"0x22\"";
+    CPPUNIT_ASSERT(text.find("# TYPE carsim_requests_total counter\n") != string::npos);
+    CPPUNIT_ASSERT(text.find("carsim_requests_total" + labels + "} 1\n") != string::npos);
+    CPPUNIT_ASSERT(text.find("carsim_response_latency_seconds_bucket" + labels + ",le=\"0.001000\"} 0\n") != string::npos);
+    CPPUNIT_ASSERT(text.find("carsim_response_latency_seconds_bucket" + labels + ",le=\"0.002500\"} 1\n") != string::npos);
+    CPPUNIT_ASSERT(text.find("carsim_response_latency_seconds_sum" + labels + "} 0.001500\n") != string::npos);
+    CPPUNIT_ASSERT(text.find("carsim_response_latency_quantile_seconds" + labels + ",quantile=\"1\"} 0.001500\n") != string::npos);
+    const string laneLabels = "{transport=\"uds\",ecu=\"7E0\",lane=\"low\"";
+    CPPUNIT_ASSERT(text.find("carsim_queue_latency_seconds_bucket" + laneLabels + ",le=\"0.002500\"} 1\n") != string::npos);
+    CPPUNIT_ASSERT(text.find("carsim_queue_latency_seconds_count" + laneLabels + "} 1\n") != string::npos);
+    // lanes without requests are skipped
+    CPPUNIT_ASSERT(text.find("lane=\"high\"") == string::npos);
+    CPPUNIT_ASSERT(text.find("carsim_send_retries_total{transport=\"uds\",ecu=\"7E0\"} 3\n") != string::npos);
+    CPPUNIT_ASSERT(text.find("carsim_dropped_frames_total{transport=\"doip\",ecu=\"7E0\"} 0\n") != string::npos);
+    CPPUNIT_ASSERT(text.find("carsim_overload_responses_total{transport=\"uds\",ecu=\"7E0\"} 2\n") != string::npos);
+    CPPUNIT_ASSERT(text.find("carsim_lua_memory_bytes{transport=\"uds\",ecu=\"7E0\"} 4096\n") != string::npos);
+    // ECUs without Lua memory statistics are skipped
+    CPPUNIT_ASSERT(text.find("carsim_lua_memory_bytes{transport=\"doip\"") == string::npos);
+}
+
+void MetricsTest::testRequestHits()
+{
+    Metrics metrics;
+    auto pRequestHits = make_shared<RequestHitStatistics>();
+    auto pCounters = make_shared<RequestHitCounters>(3);
+    pCounters->hit(1);
+    pCounters->add(1, 4);
+    auto pTables = make_shared<RequestHitStatistics::Tables>();
+    pTables->push_back(RequestHitStatistics::Table{"Raw", "", {"22 F1 90", "22 F1 XX", "31 01 *"}, pCounters});
+    pRequestHits->setTables(pTables);
+    // both transports of a script share the statistics
+    metrics.registerEcu("uds", 0x7E0)->setRequestHits(pRequestHits);
+    metrics.registerEcu("doip", 0x10)->setRequestHits(pRequestHits);
+    metrics.registerEcu("uds", 0x7E1);
+
+    ostringstream out;
+    metrics.writePrometheus(out);
+    const string text = out.str();
+    const string labels = "{transport=\"uds\",ecu=\"7E0\",table=\"Raw\",session=\"\"";
+    CPPUNIT_ASSERT(text.find("carsim_request_entries" + labels + "} 3\n") != string::npos);
+    CPPUNIT_ASSERT(text.find("carsim_request_entries_unused" + labels + "} 2\n") != string::npos);
+    CPPUNIT_ASSERT(text.find("carsim_request_hits_total" + labels + ",key=\"22 F1 XX\"} 5\n") != string::npos);
+    // only the entries which were hit
+    CPPUNIT_ASSERT(text.find("key=\"22 F1 90\"") == string::npos);
+
+    ostringstream unused;
+    metrics.writeUnusedRequests(unused);
+    CPPUNIT_ASSERT_EQUAL(string("# uds 7E0 Raw\n22 F1 90\n31 01 *\n"), unused.str());
+}
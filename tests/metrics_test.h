@@ -0,0 +1,38 @@
+/**
+ * @file metrics_test.h
+ *
+ */
+
+#ifndef METRICS_TEST_H
+#define METRICS_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class MetricsTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(MetricsTest);
+
+    CPPUNIT_TEST(testBucketResolution);
+    CPPUNIT_TEST(testQuantiles);
+    CPPUNIT_TEST(testRequestTimer);
+    CPPUNIT_TEST(testPrometheusOutput);
+    CPPUNIT_TEST(testRequestHits);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    MetricsTest() = default;
+    virtual ~MetricsTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testBucketResolution();
+    void testQuantiles();
+    void testRequestTimer();
+    void testPrometheusOutput();
+    void testRequestHits();
+
+};
+
+#endif /* METRICS_TEST_H */
@@ -0,0 +1,138 @@
+/**
+ * @file obd_service_test.cpp
+ *
+ * Unit test for the native OBD modes 0x01 and 0x09.
+ */
+
+#include "obd_service_test.h"
+#include "obd_service.h"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ObdServiceTest);
+
+namespace
+{
+
+const vector<ObdPidConfiguration> PIDS = {
+    {OBD_CURRENT_DATA_REQ, 0x0C, false, {0x1A, 0xF8}},
+    {OBD_CURRENT_DATA_REQ, 0x0D, false, {0x32}},
+    {OBD_CURRENT_DATA_REQ, 0x46, false, {0x40}},
+    {OBD_CURRENT_DATA_REQ, 0xA6, false, {0x00, 0x01, 0x02, 0x03}},
+    {OBD_CURRENT_DATA_REQ, 0x20, false, {0xFF, 0xFF, 0xFF, 0xFF}}, // ignored, calculated
+};
+
+vector<uint8_t> proceed(ObdService& service, const vector<uint8_t>& request)
+{
+    vector<uint8_t> response = {0xAA}; // replaced
+    service.proceedRequest(request.data(), request.size(), response);
+    return response;
+}
+
+} // namespace
+
+void ObdServiceTest::setUp() { }
+
+void ObdServiceTest::tearDown() { }
+
+void ObdServiceTest::testSupportedPids()
+{
+    ObdService service(PIDS, nullptr);
+    CPPUNIT_ASSERT(proceed(service, {0x01, 0x00}) == vector<uint8_t>({0x41, 0x00, 0x00, 0x18, 0x00, 0x01}));
+    CPPUNIT_ASSERT(proceed(service, {0x01, 0x20}) == vector<uint8_t>({0x41, 0x20, 0x00, 0x00, 0x00, 0x01}));
+    CPPUNIT_ASSERT(proceed(service, {0x01, 0x40}) == vector<uint8_t>({0x41, 0x40, 0x04, 0x00, 0x00, 0x01}));
+    CPPUNIT_ASSERT(proceed(service, {0x01, 0xA0}) == vector<uint8_t>({0x41, 0xA0, 0x04, 0x00, 0x00, 0x00}));
+    CPPUNIT_ASSERT(proceed(service, {0x01, 0xC0}).empty());
+    CPPUNIT_ASSERT(service.isSupported(0x01, 0x80));
+    CPPUNIT_ASSERT(!service.isSupported(0x01, 0xE0));
+
+    // a mode without PIDs is not answered at all
+    CPPUNIT_ASSERT(proceed(service, {0x09, 0x00}).empty());
+    CPPUNIT_ASSERT(!service.isSupported(0x09, 0x00));
+}
+
+void ObdServiceTest::testMultiplePids()
+{
+    ObdService service(PIDS, nullptr);
+    // unsupported PIDs are skipped
+    CPPUNIT_ASSERT(proceed(service, {0x01, 0x0C, 0x05, 0x0D, 0x46}) ==
+                   vector<uint8_t>({0x41, 0x0C, 0x1A, 0xF8, 0x0D, 0x32, 0x46, 0x40}));
+    CPPUNIT_ASSERT(proceed(service, {0x01, 0x00, 0x20}) ==
+                   vector<uint8_t>({0x41, 0x00, 0x00, 0x18, 0x00, 0x01, 0x20, 0x00, 0x00, 0x00, 0x01}));
+    CPPUNIT_ASSERT(proceed(service, {0x01, 0x05, 0x06}).empty());
+
+    // max. 6 PIDs
+    CPPUNIT_ASSERT(proceed(service, {0x01, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C}).size() == 19);
+    CPPUNIT_ASSERT(proceed(service, {0x01, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C}).empty());
+    CPPUNIT_ASSERT(proceed(service, {0x01}).empty());
+}
+
+void ObdServiceTest::testLuaPid()
+{
+    unsigned calls = 0;
+    const vector<ObdPidConfiguration> pids = {
+        {OBD_CURRENT_DATA_REQ, 0x0D, true, {}},
+        {OBD_CURRENT_DATA_REQ, 0x0F, true, {}},
+    };
+    ObdService service(pids, [&calls](uint8_t mode, uint8_t pid) -> optional<vector<uint8_t>> {
+        ++calls;
+        if (pid == 0x0F)
+        {
+            return {}; // failed
+        }
+        return vector<uint8_t>({uint8_t(calls)});
+    });
+    CPPUNIT_ASSERT(proceed(service, {0x01, 0x0D}) == vector<uint8_t>({0x41, 0x0D, 0x01}));
+    CPPUNIT_ASSERT(proceed(service, {0x01, 0x0D, 0x0F}) == vector<uint8_t>({0x41, 0x0D, 0x02}));
+    CPPUNIT_ASSERT(proceed(service, {0x01, 0x0F}).empty());
+    CPPUNIT_ASSERT_EQUAL(4u, calls);
+    CPPUNIT_ASSERT(proceed(service, {0x01, 0x00}) == vector<uint8_t>({0x41, 0x00, 0x00, 0x0A, 0x00, 0x00}));
+}
+
+void ObdServiceTest::testVehicleInformation()
+{
+    const vector<uint8_t> vin = {'W', 'V', 'W', 'Z', 'Z', 'Z', '1', 'J', 'Z', 'X', 'W', '0', '0', '0', '0', '0', '1'};
+    const vector<uint8_t> calibrationIds(32, 0x41);
+    const vector<ObdPidConfiguration> pids = {
+        {OBD_VEHICLE_INFORMATION_REQ, 0x02, false, vin},
+        {OBD_VEHICLE_INFORMATION_REQ, 0x04, false, calibrationIds},
+        {OBD_VEHICLE_INFORMATION_REQ, 0x06, false, {0x12, 0x34, 0x56, 0x78}},
+    };
+    ObdService service(pids, nullptr);
+    CPPUNIT_ASSERT(proceed(service, {0x09, 0x00}) == vector<uint8_t>({0x49, 0x00, 0x54, 0x00, 0x00, 0x00}));
+
+    vector<uint8_t> expected = {0x49, 0x02, 0x01};
+    expected.insert(expected.end(), vin.cbegin(), vin.cend());
+    CPPUNIT_ASSERT(proceed(service, {0x09, 0x02}) == expected);
+
+    const vector<uint8_t> response = proceed(service, {0x09, 0x04});
+    CPPUNIT_ASSERT_EQUAL(size_t(3 + 32), response.size());
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x02), response[2]);
+    CPPUNIT_ASSERT(proceed(service, {0x09, 0x06}) == vector<uint8_t>({0x49, 0x06, 0x01, 0x12, 0x34, 0x56, 0x78}));
+
+    // only the supported InfoTypes may be combined
+    CPPUNIT_ASSERT(proceed(service, {0x09, 0x02, 0x04}).empty());
+    CPPUNIT_ASSERT(proceed(service, {0x09, 0x00, 0x20}) == vector<uint8_t>({0x49, 0x00, 0x54, 0x00, 0x00, 0x00}));
+}
+
+void ObdServiceTest::testSignalPid()
+{
+    const VehicleSignals::SignalId speed = *VehicleSignals::getInstance().registerSignal("ObdTestSpeed");
+    SignalEncoding encoding;
+    encoding.signal = speed;
+    ObdPidConfiguration configuration;
+    configuration.pid = 0x0D;
+    configuration.pSignals = make_shared<const SignalRecord>(vector<SignalEncoding>({encoding}), 1, 0x00);
+    ObdService service({configuration}, nullptr);
+
+    // encoded on every request
+    VehicleSignals::getInstance().set(speed, 50.0);
+    CPPUNIT_ASSERT(proceed(service, {0x01, 0x0D}) == vector<uint8_t>({0x41, 0x0D, 0x32}));
+    VehicleSignals::getInstance().set(speed, 300.0);
+    CPPUNIT_ASSERT(proceed(service, {0x01, 0x0D}) == vector<uint8_t>({0x41, 0x0D, 0xFF}));
+    CPPUNIT_ASSERT(proceed(service, {0x01, 0x00}) == vector<uint8_t>({0x41, 0x00, 0x00, 0x08, 0x00, 0x00}));
+}
@@ -0,0 +1,38 @@
+/**
+ * @file obd_service_test.h
+ *
+ */
+
+#ifndef OBD_SERVICE_TEST_H
+#define OBD_SERVICE_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class ObdServiceTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(ObdServiceTest);
+
+    CPPUNIT_TEST(testSupportedPids);
+    CPPUNIT_TEST(testMultiplePids);
+    CPPUNIT_TEST(testLuaPid);
+    CPPUNIT_TEST(testVehicleInformation);
+    CPPUNIT_TEST(testSignalPid);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    ObdServiceTest() = default;
+    virtual ~ObdServiceTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testSupportedPids();
+    void testMultiplePids();
+    void testLuaPid();
+    void testVehicleInformation();
+    void testSignalPid();
+
+};
+
+#endif /* OBD_SERVICE_TEST_H */
@@ -0,0 +1,237 @@
+/**
+ * @file periodic_data_service_test.cpp
+ *
+ * Unit test for the periodic transmission of data identifiers.
+ */
+
+#include "periodic_data_service_test.h"
+#include "periodic_data_service.h"
+#include "service_identifier.h"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PeriodicDataServiceTest);
+
+namespace
+{
+
+/**
+ * Collects the sent batches, which are sent from the wheel thread.
+ */
+class SentFrames
+{
+public:
+    PeriodicDataService::Sender getSender()
+    {
+        return [this](const struct can_frame* frames, size_t count) {
+            lock_guard<mutex> lock(mutex_);
+            batches_.emplace_back(frames, frames + count);
+        };
+    }
+
+    vector<vector<struct can_frame>> get()
+    {
+        lock_guard<mutex> lock(mutex_);
+        return batches_;
+    }
+
+    /// @return the number of sent frames of the given periodic identifier
+    size_t count(uint8_t identifier)
+    {
+        lock_guard<mutex> lock(mutex_);
+        size_t count = 0;
+        for (const auto& batch : batches_)
+        {
+            for (const struct can_frame& frame : batch)
+            {
+                count += frame.data[0] == identifier ? 1 : 0;
+            }
+        }
+        return count;
+    }
+
+private:
+    mutex mutex_;
+    vector<vector<struct can_frame>> batches_;
+};
+
+/// F201 and F202 exist in every session, F203 in the extended session only and F2FF is too long
+bool readData(UdsSession session, uint16_t dataIdentifier, vector<uint8_t>& data)
+{
+    switch (dataIdentifier)
+    {
+        case 0xF201:
+            data.assign({0x11, 0x22});
+            return true;
+        case 0xF202:
+            data.assign({0x33});
+            return true;
+        case 0xF203:
+            data.assign({0x44});
+            return session == UdsSession::EXTENDED;
+        case 0xF2FF:
+            data.assign(8, 0x55);
+            return true;
+        default:
+            return false;
+    }
+}
+
+const PeriodicDataConfiguration CONFIGURATION = {0x6F1, chrono::milliseconds(200), chrono::milliseconds(100),
+                                                 chrono::milliseconds(20)};
+
+} // namespace
+
+void PeriodicDataServiceTest::setUp() { }
+
+void PeriodicDataServiceTest::tearDown() { }
+
+void PeriodicDataServiceTest::testInvalidRequests()
+{
+    SentFrames sent;
+    PeriodicDataService service(CONFIGURATION, nullptr, readData, sent.getSender());
+    vector<uint8_t> response;
+
+    const vector<uint8_t> noMode = {0x2A};
+    service.proceedRequest(noMode.data(), noMode.size(), response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({ERROR, 0x2A, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT}));
+
+    const vector<uint8_t> noIdentifier = {0x2A, 0x01};
+    service.proceedRequest(noIdentifier.data(), noIdentifier.size(), response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({ERROR, 0x2A, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT}));
+
+    const vector<uint8_t> invalidMode = {0x2A, 0x05, 0x01};
+    service.proceedRequest(invalidMode.data(), invalidMode.size(), response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({ERROR, 0x2A, REQUEST_OUT_OF_RANGE}));
+
+    // unknown, only in the extended session and too long for a single frame
+    const vector<uint8_t> unknown = {0x2A, 0x01, 0x10, 0x03, 0xFF};
+    service.proceedRequest(unknown.data(), unknown.size(), response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({ERROR, 0x2A, REQUEST_OUT_OF_RANGE}));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), service.getScheduledCount());
+
+    this_thread::sleep_for(chrono::milliseconds(30));
+    CPPUNIT_ASSERT(sent.get().empty());
+}
+
+void PeriodicDataServiceTest::testRates()
+{
+    SentFrames sent;
+    PeriodicDataService service(CONFIGURATION, nullptr, readData, sent.getSender());
+    vector<uint8_t> response;
+
+    // unknown identifiers are skipped
+    const vector<uint8_t> fast = {0x2A, 0x03, 0x01, 0x10};
+    service.proceedRequest(fast.data(), fast.size(), response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x6A}));
+    const vector<uint8_t> slow = {0x2A, 0x01, 0x02};
+    service.proceedRequest(slow.data(), slow.size(), response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x6A}));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), service.getScheduledCount());
+
+    this_thread::sleep_for(chrono::milliseconds(250));
+    const size_t fastCount = sent.count(0x01);
+    const size_t slowCount = sent.count(0x02);
+    CPPUNIT_ASSERT(fastCount >= 6 && fastCount <= 14);
+    CPPUNIT_ASSERT(slowCount >= 1 && slowCount <= 2);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(fastCount + slowCount), service.getSentCount());
+
+    struct can_frame frame = {};
+    for (const auto& batch : sent.get())
+    {
+        for (const struct can_frame& sentFrame : batch)
+        {
+            frame = sentFrame.data[0] == 0x01 ? sentFrame : frame;
+        }
+    }
+    CPPUNIT_ASSERT_EQUAL(canid_t(0x6F1), frame.can_id);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(3), frame.can_dlc);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x01), frame.data[0]);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x11), frame.data[1]);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x22), frame.data[2]);
+}
+
+void PeriodicDataServiceTest::testStopSending()
+{
+    SentFrames sent;
+    PeriodicDataService service(CONFIGURATION, nullptr, readData, sent.getSender());
+    vector<uint8_t> response;
+
+    const vector<uint8_t> fast = {0x2A, 0x03, 0x01, 0x02};
+    service.proceedRequest(fast.data(), fast.size(), response);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), service.getScheduledCount());
+
+    // the identifiers due at the same time are sent in one batch
+    this_thread::sleep_for(chrono::milliseconds(30));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), sent.get().front().size());
+
+    const vector<uint8_t> stopOne = {0x2A, 0x04, 0x01};
+    service.proceedRequest(stopOne.data(), stopOne.size(), response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x6A}));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), service.getScheduledCount());
+
+    const vector<uint8_t> stopAll = {0x2A, 0x04};
+    service.proceedRequest(stopAll.data(), stopAll.size(), response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x6A}));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), service.getScheduledCount());
+
+    // a running transmission may still finish
+    this_thread::sleep_for(chrono::milliseconds(30));
+    const size_t count = sent.get().size();
+    this_thread::sleep_for(chrono::milliseconds(60));
+    CPPUNIT_ASSERT_EQUAL(count, sent.get().size());
+}
+
+void PeriodicDataServiceTest::testSessionChange()
+{
+    SessionController sessionCtrl;
+    sessionCtrl.setCurrentUdsSession(UdsSession::EXTENDED);
+    SentFrames sent;
+    PeriodicDataService service(CONFIGURATION, &sessionCtrl, readData, sent.getSender());
+    vector<uint8_t> response;
+
+    const vector<uint8_t> fast = {0x2A, 0x03, 0x03};
+    service.proceedRequest(fast.data(), fast.size(), response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x6A}));
+    this_thread::sleep_for(chrono::milliseconds(50));
+    CPPUNIT_ASSERT(sent.count(0x03) >= 1);
+
+    // e.g. the S3 timeout
+    sessionCtrl.setCurrentUdsSession(UdsSession::DEFAULT);
+    this_thread::sleep_for(chrono::milliseconds(50));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), service.getScheduledCount());
+}
+
+void PeriodicDataServiceTest::testMaxIdentifiers()
+{
+    auto readAll = [](UdsSession session, uint16_t dataIdentifier, vector<uint8_t>& data) {
+        data.assign({uint8_t(dataIdentifier)});
+        return true;
+    };
+    SentFrames sent;
+    PeriodicDataService service(CONFIGURATION, nullptr, readAll, sent.getSender());
+    vector<uint8_t> response;
+
+    vector<uint8_t> request = {0x2A, 0x01};
+    for (uint8_t identifier = 0; identifier < MAX_PERIODIC_DATA_IDENTIFIERS; ++identifier)
+    {
+        request.push_back(identifier);
+    }
+    service.proceedRequest(request.data(), request.size(), response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x6A}));
+
+    // moving a scheduled identifier to another rate does not count
+    const vector<uint8_t> move = {0x2A, 0x03, 0x00};
+    service.proceedRequest(move.data(), move.size(), response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0x6A}));
+
+    const vector<uint8_t> tooMany = {0x2A, 0x03, 0xF0};
+    service.proceedRequest(tooMany.data(), tooMany.size(), response);
+    CPPUNIT_ASSERT(response == vector<uint8_t>({ERROR, 0x2A, REQUEST_OUT_OF_RANGE}));
+    CPPUNIT_ASSERT_EQUAL(MAX_PERIODIC_DATA_IDENTIFIERS, service.getScheduledCount());
+}
@@ -0,0 +1,38 @@
+/**
+ * @file periodic_data_service_test.h
+ *
+ */
+
+#ifndef PERIODIC_DATA_SERVICE_TEST_H
+#define PERIODIC_DATA_SERVICE_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class PeriodicDataServiceTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(PeriodicDataServiceTest);
+
+    CPPUNIT_TEST(testInvalidRequests);
+    CPPUNIT_TEST(testRates);
+    CPPUNIT_TEST(testStopSending);
+    CPPUNIT_TEST(testSessionChange);
+    CPPUNIT_TEST(testMaxIdentifiers);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    PeriodicDataServiceTest() = default;
+    virtual ~PeriodicDataServiceTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testInvalidRequests();
+    void testRates();
+    void testStopSending();
+    void testSessionChange();
+    void testMaxIdentifiers();
+
+};
+
+#endif /* PERIODIC_DATA_SERVICE_TEST_H */
@@ -0,0 +1,109 @@
+/**
+ * @file realtime_profile_test.cpp
+ *
+ * Unit test for the busy polling of the real-time profile.
+ */
+
+#include "realtime_profile_test.h"
+#include "realtime_profile.h"
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RealTimeProfileTest);
+
+namespace
+{
+
+void signal(int fd)
+{
+    const uint64_t one = 1;
+    CPPUNIT_ASSERT(write(fd, &one, sizeof(one)) == sizeof(one));
+}
+
+} // namespace
+
+void RealTimeProfileTest::setUp() { }
+
+void RealTimeProfileTest::tearDown()
+{
+    RealTimeProfile::setBusyPollWindow(chrono::microseconds(0));
+}
+
+void RealTimeProfileTest::testBlockingPoll()
+{
+    const int fd = eventfd(0, EFD_CLOEXEC);
+    const uint64_t hits = RealTimeProfile::getBusyPollHits();
+    thread writer([fd]()
+    {
+        this_thread::sleep_for(chrono::milliseconds(10));
+        signal(fd);
+    });
+    struct pollfd fds[1] = {{fd, POLLIN, 0}};
+    CPPUNIT_ASSERT_EQUAL(1, RealTimeProfile::poll(fds, 1));
+    CPPUNIT_ASSERT(fds[0].revents & POLLIN);
+    CPPUNIT_ASSERT_EQUAL(hits, RealTimeProfile::getBusyPollHits());
+    writer.join();
+    close(fd);
+}
+
+void RealTimeProfileTest::testBusyPoll()
+{
+    const int fd = eventfd(0, EFD_CLOEXEC);
+    RealTimeProfile::setBusyPollWindow(chrono::seconds(5));
+    CPPUNIT_ASSERT(RealTimeProfile::getBusyPollWindow() == chrono::seconds(5));
+    const uint64_t hits = RealTimeProfile::getBusyPollHits();
+    thread writer([fd]()
+    {
+        this_thread::sleep_for(chrono::milliseconds(10));
+        signal(fd);
+    });
+    struct pollfd fds[1] = {{fd, POLLIN, 0}};
+    CPPUNIT_ASSERT_EQUAL(1, RealTimeProfile::poll(fds, 1));
+    CPPUNIT_ASSERT(fds[0].revents & POLLIN);
+    CPPUNIT_ASSERT_EQUAL(hits + 1, RealTimeProfile::getBusyPollHits());
+    writer.join();
+
+    // after the window the thread blocks
+    uint64_t value;
+    CPPUNIT_ASSERT(read(fd, &value, sizeof(value)) == sizeof(value));
+    RealTimeProfile::setBusyPollWindow(chrono::microseconds(100));
+    thread lateWriter([fd]()
+    {
+        this_thread::sleep_for(chrono::milliseconds(20));
+        signal(fd);
+    });
+    CPPUNIT_ASSERT_EQUAL(1, RealTimeProfile::poll(fds, 1));
+    CPPUNIT_ASSERT_EQUAL(hits + 1, RealTimeProfile::getBusyPollHits());
+    lateWriter.join();
+    close(fd);
+}
+
+void RealTimeProfileTest::testBusyEpollWait()
+{
+    const int fd = eventfd(0, EFD_CLOEXEC);
+    const int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    CPPUNIT_ASSERT_EQUAL(0, epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event));
+
+    RealTimeProfile::setBusyPollWindow(chrono::seconds(5));
+    const uint64_t hits = RealTimeProfile::getBusyPollHits();
+    thread writer([fd]()
+    {
+        this_thread::sleep_for(chrono::milliseconds(10));
+        signal(fd);
+    });
+    struct epoll_event received = {};
+    CPPUNIT_ASSERT_EQUAL(1, RealTimeProfile::epollWait(epollFd, &received, 1));
+    CPPUNIT_ASSERT_EQUAL(fd, received.data.fd);
+    CPPUNIT_ASSERT_EQUAL(hits + 1, RealTimeProfile::getBusyPollHits());
+    writer.join();
+    close(epollFd);
+    close(fd);
+}
@@ -0,0 +1,34 @@
+/**
+ * @file realtime_profile_test.h
+ *
+ */
+
+#ifndef REALTIME_PROFILE_TEST_H
+#define REALTIME_PROFILE_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class RealTimeProfileTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(RealTimeProfileTest);
+
+    CPPUNIT_TEST(testBlockingPoll);
+    CPPUNIT_TEST(testBusyPoll);
+    CPPUNIT_TEST(testBusyEpollWait);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    RealTimeProfileTest() = default;
+    virtual ~RealTimeProfileTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testBlockingPoll();
+    void testBusyPoll();
+    void testBusyEpollWait();
+
+};
+
+#endif /* REALTIME_PROFILE_TEST_H */
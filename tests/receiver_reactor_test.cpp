@@ -0,0 +1,265 @@
+/**
+ * @file receiver_reactor_test.cpp
+ *
+ * Unit test for the epoll reactor. The handlers wait for an eventfd instead of
+ * a CAN socket, so no vcan is needed.
+ */
+
+#include "receiver_reactor_test.h"
+#include "receiver_reactor.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ReceiverReactorTest);
+
+namespace
+{
+
+const chrono::milliseconds WAIT_TIMEOUT(1000);
+const chrono::milliseconds QUIET_TIME(100);
+
+/// counts its calls, the test signals it with `notify()`
+class EventHandler : public ReactorHandler
+{
+public:
+    explicit EventHandler(uint32_t nextEvents = EPOLLIN)
+    : nextEvents_(nextEvents)
+    {
+        fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    }
+
+    virtual ~EventHandler()
+    {
+        close(fd_);
+    }
+
+    int getSocket() const noexcept override { return fd_; }
+
+    uint32_t handleEvents(uint32_t events) noexcept override
+    {
+        if (isInside_.exchange(true))
+        {
+            isOverlapped_ = true;
+        }
+        uint64_t value;
+        if ((events & EPOLLIN) != 0 && read(fd_, &value, sizeof(value)) < 0)
+        {
+            value = 0;
+        }
+        this_thread::sleep_for(delay_);
+        if (pSelfRemoveReactor_ != nullptr)
+        {
+            pSelfRemoveReactor_->removeHandler(this);
+        }
+        isInside_ = false;
+
+        lock_guard<mutex> lock(mutex_);
+        calls_++;
+        condition_.notify_all();
+        return nextEvents_;
+    }
+
+    void handlerRemoved() noexcept override
+    {
+        lock_guard<mutex> lock(mutex_);
+        isRemoved_ = true;
+        condition_.notify_all();
+    }
+
+    void notify()
+    {
+        const uint64_t value = 1;
+        CPPUNIT_ASSERT(write(fd_, &value, sizeof(value)) == sizeof(value));
+    }
+
+    /// @return false if the handler was called less than `count` times in time
+    bool waitForCalls(unsigned int count)
+    {
+        unique_lock<mutex> lock(mutex_);
+        return condition_.wait_for(lock, WAIT_TIMEOUT, [this, count]() { return calls_ >= count; });
+    }
+
+    bool waitForRemoved()
+    {
+        unique_lock<mutex> lock(mutex_);
+        return condition_.wait_for(lock, WAIT_TIMEOUT, [this]() { return isRemoved_; });
+    }
+
+    unsigned int getCalls()
+    {
+        lock_guard<mutex> lock(mutex_);
+        return calls_;
+    }
+
+    void setDelay(chrono::milliseconds delay) { delay_ = delay; }
+    void removeSelf(ReceiverReactor* pReactor) { pSelfRemoveReactor_ = pReactor; }
+    bool isOverlapped() const { return isOverlapped_; }
+
+private:
+    int fd_;
+    const uint32_t nextEvents_;
+    chrono::milliseconds delay_{0};
+    ReceiverReactor* pSelfRemoveReactor_ = nullptr;
+    atomic<bool> isInside_{false};
+    atomic<bool> isOverlapped_{false};
+
+    mutex mutex_;
+    condition_variable condition_;
+    unsigned int calls_ = 0;
+    bool isRemoved_ = false;
+};
+
+}
+
+void ReceiverReactorTest::setUp()
+{
+}
+
+void ReceiverReactorTest::tearDown()
+{
+}
+
+/**
+ * An event calls the handler, which is armed again with the returned events.
+ * The handlers are called independent of each other.
+ */
+void ReceiverReactorTest::testDispatch()
+{
+    ReceiverReactor reactor;
+    EventHandler handler1;
+    EventHandler handler2;
+    CPPUNIT_ASSERT_EQUAL(0, reactor.addHandler(&handler1, EPOLLIN));
+    CPPUNIT_ASSERT_EQUAL(0, reactor.addHandler(&handler2, EPOLLIN));
+    // handlers can be added before the start, the events wait for the workers
+    handler1.notify();
+    reactor.start(2);
+    CPPUNIT_ASSERT(handler1.waitForCalls(1));
+
+    handler1.notify();
+    CPPUNIT_ASSERT(handler1.waitForCalls(2));
+    handler2.notify();
+    CPPUNIT_ASSERT(handler2.waitForCalls(1));
+    this_thread::sleep_for(QUIET_TIME);
+    CPPUNIT_ASSERT_EQUAL(2u, handler1.getCalls());
+    CPPUNIT_ASSERT_EQUAL(1u, handler2.getCalls());
+
+    reactor.removeHandler(&handler1);
+    reactor.removeHandler(&handler2);
+    reactor.stop();
+    reactor.waitForStop();
+    CPPUNIT_ASSERT(!reactor.isRunning());
+}
+
+/**
+ * A handler that asks for no events is only called again after `rearm()`.
+ */
+void ReceiverReactorTest::testRearm()
+{
+    ReceiverReactor reactor;
+    EventHandler handler(0);
+    reactor.start(1);
+    CPPUNIT_ASSERT_EQUAL(0, reactor.addHandler(&handler, EPOLLIN));
+
+    handler.notify();
+    CPPUNIT_ASSERT(handler.waitForCalls(1));
+    handler.notify();
+    this_thread::sleep_for(QUIET_TIME);
+    CPPUNIT_ASSERT_EQUAL(1u, handler.getCalls());
+
+    reactor.rearm(&handler, EPOLLIN);
+    CPPUNIT_ASSERT(handler.waitForCalls(2));
+    reactor.removeHandler(&handler);
+}
+
+/**
+ * A removed handler is not called anymore, also if its event is pending, and
+ * an invalid handler is not added.
+ */
+void ReceiverReactorTest::testRemoveHandler()
+{
+    ReceiverReactor reactor;
+    EventHandler handler;
+    reactor.start(2);
+    CPPUNIT_ASSERT_EQUAL(0, reactor.addHandler(&handler, EPOLLIN));
+    handler.notify();
+    CPPUNIT_ASSERT(handler.waitForCalls(1));
+
+    reactor.removeHandler(&handler);
+    handler.notify();
+    reactor.rearm(&handler, EPOLLIN);
+    this_thread::sleep_for(QUIET_TIME);
+    CPPUNIT_ASSERT_EQUAL(1u, handler.getCalls());
+    // removing twice is harmless
+    reactor.removeHandler(&handler);
+
+    // the handler can be registered again
+    CPPUNIT_ASSERT_EQUAL(0, reactor.addHandler(&handler, EPOLLIN));
+    CPPUNIT_ASSERT(handler.waitForCalls(2));
+    reactor.removeHandler(&handler);
+
+    class InvalidHandler : public ReactorHandler
+    {
+        int getSocket() const noexcept override { return -1; }
+        uint32_t handleEvents(uint32_t) noexcept override { return 0; }
+    } invalidHandler;
+    CPPUNIT_ASSERT(reactor.addHandler(&invalidHandler, EPOLLIN) < 0);
+}
+
+/**
+ * A handler removing itself from `handleEvents()` does not block its worker
+ * and gets `handlerRemoved()` once it returned.
+ */
+void ReceiverReactorTest::testSelfRemove()
+{
+    ReceiverReactor reactor;
+    EventHandler handler;
+    handler.removeSelf(&reactor);
+    reactor.start(1);
+    CPPUNIT_ASSERT_EQUAL(0, reactor.addHandler(&handler, EPOLLIN));
+
+    handler.notify();
+    CPPUNIT_ASSERT(handler.waitForRemoved());
+    CPPUNIT_ASSERT_EQUAL(1u, handler.getCalls());
+    handler.notify();
+    this_thread::sleep_for(QUIET_TIME);
+    CPPUNIT_ASSERT_EQUAL(1u, handler.getCalls());
+}
+
+/**
+ * With several workers, a handler is still called by one worker at a time,
+ * while the other handlers are not delayed by it.
+ */
+void ReceiverReactorTest::testOneWorkerPerHandler()
+{
+    ReceiverReactor reactor;
+    EventHandler slowHandler;
+    EventHandler fastHandler;
+    slowHandler.setDelay(chrono::milliseconds(5));
+    reactor.start(4);
+    CPPUNIT_ASSERT_EQUAL(0, reactor.addHandler(&slowHandler, EPOLLIN));
+    CPPUNIT_ASSERT_EQUAL(0, reactor.addHandler(&fastHandler, EPOLLIN));
+
+    for (unsigned int i = 1; i <= 20; ++i)
+    {
+        slowHandler.notify();
+        reactor.rearm(&slowHandler, EPOLLIN);
+        fastHandler.notify();
+        CPPUNIT_ASSERT(fastHandler.waitForCalls(i));
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    CPPUNIT_ASSERT(slowHandler.waitForCalls(1));
+    CPPUNIT_ASSERT(!slowHandler.isOverlapped());
+    CPPUNIT_ASSERT(!fastHandler.isOverlapped());
+
+    reactor.removeHandler(&slowHandler);
+    reactor.removeHandler(&fastHandler);
+}
@@ -0,0 +1,39 @@
+/**
+ * @file receiver_reactor_test.h
+ *
+ */
+
+#ifndef RECEIVER_REACTOR_TEST_H
+#define RECEIVER_REACTOR_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class ReceiverReactorTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(ReceiverReactorTest);
+
+    CPPUNIT_TEST(testDispatch);
+    CPPUNIT_TEST(testRearm);
+    CPPUNIT_TEST(testRemoveHandler);
+    CPPUNIT_TEST(testSelfRemove);
+    CPPUNIT_TEST(testOneWorkerPerHandler);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    ReceiverReactorTest() = default;
+    virtual ~ReceiverReactorTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testDispatch();
+    void testRearm();
+    void testRemoveHandler();
+    void testSelfRemove();
+    void testOneWorkerPerHandler();
+
+};
+
+#endif /* RECEIVER_REACTOR_TEST_H */
+
@@ -0,0 +1,138 @@
+/**
+ * @file replay_trace_test.cpp
+ *
+ * Unit test for the replay of recorded traces. The candump logs are written
+ * as text, the capture files by the `TrafficCapture`.
+ */
+
+#include "replay_trace_test.h"
+#include "replay_trace.h"
+#include "traffic_capture.h"
+#include <unistd.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ReplayTraceTest);
+
+/**
+ * @return the replayed response, "none" if the request is not in the trace
+ */
+static string replay(const ReplayTrace& trace, const vector<uint8_t>& request)
+{
+    const optional<ReplayTrace::Response> response = trace.match(request.data(), request.size());
+    if (!response)
+    {
+        return "none";
+    }
+    string text;
+    char byteText[3];
+    for (size_t i = 0; i < response->length; ++i)
+    {
+        snprintf(byteText, sizeof(byteText), "%02X", response->data[i]);
+        text += byteText;
+    }
+    return text;
+}
+
+void ReplayTraceTest::setUp()
+{
+    traceFile_ = "/tmp/replay_trace_test_" + to_string(getpid()) + ".log";
+}
+
+void ReplayTraceTest::tearDown()
+{
+    remove(traceFile_.c_str());
+}
+
+void ReplayTraceTest::writeTrace(const string& text) const
+{
+    ofstream out(traceFile_);
+    out << text;
+}
+
+void ReplayTraceTest::testCandumpMultiFrame()
+{
+    writeTrace("(1500000000.000000) vcan0 7E0#0322F190CCCCCCCC\n"
+               "(1500000000.000100) vcan0 7E8#100A62F190010203\n"
+               "(1500000000.000200) vcan0 7E0#3000000000000000\n"
+               "(1500000000.000300) vcan0 7E8#2104050607CCCCCC\n");
+    auto pTrace = ReplayTrace::load(traceFile_, 0x7E0, 0x7E8);
+    CPPUNIT_ASSERT(pTrace);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), pTrace->getPairCount());
+    CPPUNIT_ASSERT_EQUAL(string("62F19001020304050607"), replay(*pTrace, {0x22, 0xF1, 0x90}));
+    CPPUNIT_ASSERT_EQUAL(string("none"), replay(*pTrace, {0x22, 0xF1, 0x91}));
+}
+
+void ReplayTraceTest::testResponsePending()
+{
+    writeTrace("(1.000000) vcan0 7E0#0431030102\n"
+               "(1.100000) vcan0 7E8#037F3178\n"
+               "(1.200000) vcan0 7E8#0471030101\n");
+    auto pTrace = ReplayTrace::load(traceFile_, 0x7E0, 0x7E8);
+    CPPUNIT_ASSERT(pTrace);
+    CPPUNIT_ASSERT_EQUAL(string("71030101"), replay(*pTrace, {0x31, 0x03, 0x01, 0x02}));
+}
+
+void ReplayTraceTest::testResponseSequence()
+{
+    // another ECU on the same bus must not interfere
+    writeTrace("(1.000000) vcan0 7E0#0431030102\n"
+               "(1.100000) vcan0 7E8#0471030101\n"
+               "(1.200000) vcan0 7E1#0431030102\n"
+               "(1.300000) vcan0 7E9#0471030103\n"
+               "(1.400000) vcan0 7E0#0431030102\n"
+               "(1.500000) vcan0 7E8#0471030102\n");
+    auto pTrace = ReplayTrace::load(traceFile_, 0x7E0, 0x7E8);
+    CPPUNIT_ASSERT(pTrace);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), pTrace->getPairCount());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), pTrace->size());
+    CPPUNIT_ASSERT_EQUAL(string("71030101"), replay(*pTrace, {0x31, 0x03, 0x01, 0x02}));
+    CPPUNIT_ASSERT_EQUAL(string("71030102"), replay(*pTrace, {0x31, 0x03, 0x01, 0x02}));
+    // starts over after the last response
+    CPPUNIT_ASSERT_EQUAL(string("71030101"), replay(*pTrace, {0x31, 0x03, 0x01, 0x02}));
+}
+
+void ReplayTraceTest::testNoResponse()
+{
+    writeTrace("(1.000000) vcan0 7E0#023E80\n"
+               "(1.100000) vcan0 7E0#0322F190\n"
+               "(1.200000) vcan0 7E8#0462F19001\n");
+    auto pTrace = ReplayTrace::load(traceFile_, 0x7E0, 0x7E8);
+    CPPUNIT_ASSERT(pTrace);
+    const vector<uint8_t> testerPresent = {0x3E, 0x80};
+    const optional<ReplayTrace::Response> response = pTrace->match(testerPresent.data(), testerPresent.size());
+    CPPUNIT_ASSERT(response);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), response->length);
+    CPPUNIT_ASSERT_EQUAL(string("62F19001"), replay(*pTrace, {0x22, 0xF1, 0x90}));
+}
+
+void ReplayTraceTest::testCaptureFile()
+{
+    traceFile_ = "/tmp/replay_trace_test_" + to_string(getpid()) + ".cap";
+    TrafficCapture capture;
+    CPPUNIT_ASSERT_EQUAL(0, capture.open(traceFile_, 64 * 1024));
+    const uint8_t iface = capture.getInterfaceIndex("vcan0");
+    const uint8_t request[] = {0x22, 0xF1, 0x90};
+    const uint8_t response[] = {0x62, 0xF1, 0x90, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07};
+    capture.record(TrafficCapture::Protocol::UDS, TrafficCapture::Direction::RX,
+                   iface, 0x7E0, 0, 0, request, sizeof(request));
+    capture.record(TrafficCapture::Protocol::UDS, TrafficCapture::Direction::TX,
+                   iface, 0x7E8, 0, 0, response, sizeof(response));
+    capture.close();
+
+    auto pTrace = ReplayTrace::load(traceFile_, 0x7E0, 0x7E8);
+    CPPUNIT_ASSERT(pTrace);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), pTrace->getPairCount());
+    CPPUNIT_ASSERT_EQUAL(string("62F19001020304050607"), replay(*pTrace, {0x22, 0xF1, 0x90}));
+}
+
+void ReplayTraceTest::testInvalidFile()
+{
+    writeTrace("no frames in here\n");
+    CPPUNIT_ASSERT(!ReplayTrace::load(traceFile_, 0x7E0, 0x7E8));
+    CPPUNIT_ASSERT(!ReplayTrace::load("/tmp/replay_trace_test_missing.log", 0x7E0, 0x7E8));
+}
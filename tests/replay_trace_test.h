@@ -0,0 +1,44 @@
+/**
+ * @file replay_trace_test.h
+ *
+ */
+
+#ifndef REPLAY_TRACE_TEST_H
+#define REPLAY_TRACE_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+class ReplayTraceTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(ReplayTraceTest);
+
+    CPPUNIT_TEST(testCandumpMultiFrame);
+    CPPUNIT_TEST(testResponsePending);
+    CPPUNIT_TEST(testResponseSequence);
+    CPPUNIT_TEST(testNoResponse);
+    CPPUNIT_TEST(testCaptureFile);
+    CPPUNIT_TEST(testInvalidFile);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    ReplayTraceTest() = default;
+    virtual ~ReplayTraceTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testCandumpMultiFrame();
+    void testResponsePending();
+    void testResponseSequence();
+    void testNoResponse();
+    void testCaptureFile();
+    void testInvalidFile();
+
+    void writeTrace(const std::string& text) const;
+
+    std::string traceFile_;
+};
+
+#endif /* REPLAY_TRACE_TEST_H */
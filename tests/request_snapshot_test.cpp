@@ -0,0 +1,151 @@
+/**
+ * @file request_snapshot_test.cpp
+ *
+ * Unit test for the snapshots of the compiled request tables.
+ */
+
+#include "request_snapshot_test.h"
+#include "request_snapshot.h"
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RequestSnapshotTest);
+
+using namespace std;
+
+using RequestTree = shared_ptr<RequestByteTreeNode<RequestResponse>>;
+
+/**
+ * Adds a static request like "22 F1 XX *" to the given tree.
+ */
+static void addRequest(const RequestTree &tree, const vector<string> &requestBytes, const string &response)
+{
+    auto node = tree.get();
+    for (const string &requestByte : requestBytes)
+    {
+        if (requestByte == "XX")
+        {
+            node = node->appendPlaceholder();
+        }
+        else if (requestByte == "*")
+        {
+            node = node->appendWildcard();
+        }
+        else
+        {
+            node = node->appendByte(uint8_t(stoul(requestByte, nullptr, 16)));
+        }
+    }
+    RequestResponse leaf;
+    leaf.literal = response;
+    leaf.bytes = {uint8_t(stoul(response.substr(0, 2), nullptr, 16))};
+    node->setLuaResponse(leaf);
+}
+
+static LuaRequestMatcher createMatcher()
+{
+    RequestTree tree(new RequestByteTreeNode<RequestResponse>());
+    addRequest(tree, {"22", "F1", "90"}, "62 F1 90");
+    addRequest(tree, {"22", "F1", "XX"}, "62 F1 00");
+    addRequest(tree, {"31", "*"}, "71 01");
+    for (unsigned i = 0; i < 40; ++i)
+    {
+        // enough edges for a dense node
+        addRequest(tree, {"2E", to_string(i + 10)}, "6E 00");
+    }
+    return LuaRequestMatcher(tree);
+}
+
+static string match(const LuaRequestMatcher &matcher, const vector<uint8_t> &request)
+{
+    const RequestResponse *response = matcher.match(request.data(), request.size());
+    return response ? response->literal : "<none>";
+}
+
+static shared_ptr<const LuaRequestMatcher> load(const string &snapshotFile, const string &scriptFile,
+                                                const string &ecuIdent = "Main")
+{
+    return RequestSnapshot::load(snapshotFile, scriptFile, ecuIdent,
+                                 [](const string &) { return RequestResponse(); });
+}
+
+void RequestSnapshotTest::setUp()
+{
+    char scriptFile[] = "/tmp/request_snapshot_test_XXXXXX";
+    const int fd = mkstemp(scriptFile);
+    CPPUNIT_ASSERT(fd >= 0);
+    CPPUNIT_ASSERT(::write(fd, "Main = {}\n", 10) == 10);
+    close(fd);
+    scriptFile_ = scriptFile;
+    snapshotFile_ = RequestSnapshot::getSnapshotFile(scriptFile_);
+}
+
+void RequestSnapshotTest::tearDown()
+{
+    remove(snapshotFile_.c_str());
+    remove(scriptFile_.c_str());
+}
+
+void RequestSnapshotTest::testRoundTrip()
+{
+    const LuaRequestMatcher matcher = createMatcher();
+    CPPUNIT_ASSERT_EQUAL(0, RequestSnapshot::write(snapshotFile_, scriptFile_, "Main", matcher));
+
+    auto pLoaded = load(snapshotFile_, scriptFile_);
+    CPPUNIT_ASSERT(pLoaded != nullptr);
+    CPPUNIT_ASSERT_EQUAL(matcher.getNodeCount(), pLoaded->getNodeCount());
+    CPPUNIT_ASSERT_EQUAL(matcher.getLeafCount(), pLoaded->getLeafCount());
+    const vector<vector<uint8_t>> requests = {
+        {0x22, 0xF1, 0x90}, {0x22, 0xF1, 0x42}, {0x31, 0x01, 0x02}, {0x2E, 0x35}, {0x2E, 0x01}, {0x10}
+    };
+    for (const vector<uint8_t> &request : requests)
+    {
+        CPPUNIT_ASSERT_EQUAL(match(matcher, request), match(*pLoaded, request));
+    }
+    const RequestResponse *pResponse = pLoaded->match(requests[0].data(), requests[0].size());
+    CPPUNIT_ASSERT(pResponse != nullptr);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), pResponse->bytes.size());
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x62), pResponse->bytes[0]);
+}
+
+void RequestSnapshotTest::testOutdatedSnapshot()
+{
+    CPPUNIT_ASSERT_EQUAL(0, RequestSnapshot::write(snapshotFile_, scriptFile_, "Main", createMatcher()));
+
+    // the script is changed after the snapshot was written
+    struct timeval times[2] = {{1000000000, 0}, {1000000000, 0}};
+    CPPUNIT_ASSERT_EQUAL(0, utimes(scriptFile_.c_str(), times));
+    CPPUNIT_ASSERT(load(snapshotFile_, scriptFile_) == nullptr);
+    CPPUNIT_ASSERT(load(snapshotFile_ + ".missing", scriptFile_) == nullptr);
+}
+
+void RequestSnapshotTest::testOtherEcu()
+{
+    CPPUNIT_ASSERT_EQUAL(0, RequestSnapshot::write(snapshotFile_, scriptFile_, "Main", createMatcher()));
+    CPPUNIT_ASSERT(load(snapshotFile_, scriptFile_, "PCM") == nullptr);
+}
+
+void RequestSnapshotTest::testCorruptSnapshot()
+{
+    CPPUNIT_ASSERT_EQUAL(0, RequestSnapshot::write(snapshotFile_, scriptFile_, "Main", createMatcher()));
+    struct stat st;
+    CPPUNIT_ASSERT_EQUAL(0, stat(snapshotFile_.c_str(), &st));
+
+    // every node index of the first node points beyond the node array
+    fstream snapshot(snapshotFile_, ios::in | ios::out | ios::binary);
+    snapshot.seekp(128);
+    const vector<char> garbage(64, char(0x7F));
+    snapshot.write(garbage.data(), streamsize(garbage.size()));
+    snapshot.close();
+    CPPUNIT_ASSERT(load(snapshotFile_, scriptFile_) == nullptr);
+
+    // truncated
+    CPPUNIT_ASSERT_EQUAL(0, truncate(snapshotFile_.c_str(), st.st_size / 2));
+    CPPUNIT_ASSERT(load(snapshotFile_, scriptFile_) == nullptr);
+}
@@ -0,0 +1,39 @@
+/**
+ * @file request_snapshot_test.h
+ *
+ */
+
+#ifndef REQUEST_SNAPSHOT_TEST_H
+#define REQUEST_SNAPSHOT_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+class RequestSnapshotTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(RequestSnapshotTest);
+
+    CPPUNIT_TEST(testRoundTrip);
+    CPPUNIT_TEST(testOutdatedSnapshot);
+    CPPUNIT_TEST(testOtherEcu);
+    CPPUNIT_TEST(testCorruptSnapshot);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    RequestSnapshotTest() = default;
+    virtual ~RequestSnapshotTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testRoundTrip();
+    void testOutdatedSnapshot();
+    void testOtherEcu();
+    void testCorruptSnapshot();
+
+    std::string scriptFile_;
+    std::string snapshotFile_;
+};
+
+#endif /* REQUEST_SNAPSHOT_TEST_H */
@@ -0,0 +1,100 @@
+/**
+ * @file response_cache_test.cpp
+ *
+ * Unit test for the cache of the `cached()` Lua functions.
+ */
+
+#include "response_cache_test.h"
+#include "response_cache.h"
+#include <chrono>
+#include <thread>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ResponseCacheTest);
+
+static const vector<uint8_t> REQUEST = {0x22, 0xF1, 0x90};
+static const vector<uint8_t> RESPONSE = {0x62, 0xF1, 0x90, 0x57};
+
+static string_view toKey(const vector<uint8_t>& bytes)
+{
+    return ResponseCache::toKey(bytes.data(), bytes.size());
+}
+
+void ResponseCacheTest::setUp()
+{
+}
+
+void ResponseCacheTest::tearDown()
+{
+}
+
+void ResponseCacheTest::testFind()
+{
+    ResponseCache cache(SimulationClock::Duration::zero(), make_shared<ResponseCache::Epoch>(0));
+    vector<uint8_t> response = {0xFF};
+    CPPUNIT_ASSERT(!cache.find(toKey(REQUEST), response));
+    CPPUNIT_ASSERT(response == vector<uint8_t>({0xFF}));
+
+    cache.insert(toKey(REQUEST), toKey(RESPONSE));
+    CPPUNIT_ASSERT(cache.find(toKey(REQUEST), response));
+    CPPUNIT_ASSERT(response == RESPONSE);
+    CPPUNIT_ASSERT(!cache.find(toKey({0x22, 0xF1, 0x91}), response));
+
+    // replaced by a later response of the same request
+    cache.insert(toKey(REQUEST), "\x62\xF1\x90\x58");
+    string value;
+    CPPUNIT_ASSERT(cache.find(toKey(REQUEST), value));
+    CPPUNIT_ASSERT_EQUAL(string("\x62\xF1\x90\x58"), value);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), cache.size());
+
+    cache.clear();
+    CPPUNIT_ASSERT(!cache.find(toKey(REQUEST), value));
+}
+
+void ResponseCacheTest::testLeastRecentlyUsed()
+{
+    ResponseCache cache(SimulationClock::Duration::zero(), make_shared<ResponseCache::Epoch>(0), 2);
+    cache.insert("1", "A");
+    cache.insert("2", "B");
+    string value;
+    CPPUNIT_ASSERT(cache.find("1", value));
+    cache.insert("3", "C");
+
+    // "2" was used least recently
+    CPPUNIT_ASSERT_EQUAL(size_t(2), cache.size());
+    CPPUNIT_ASSERT(!cache.find("2", value));
+    CPPUNIT_ASSERT(cache.find("1", value));
+    CPPUNIT_ASSERT_EQUAL(string("A"), value);
+    CPPUNIT_ASSERT(cache.find("3", value));
+    CPPUNIT_ASSERT_EQUAL(string("C"), value);
+}
+
+void ResponseCacheTest::testTtl()
+{
+    ResponseCache cache(chrono::milliseconds(50), make_shared<ResponseCache::Epoch>(0));
+    cache.insert(toKey(REQUEST), toKey(RESPONSE));
+    vector<uint8_t> response;
+    CPPUNIT_ASSERT(cache.find(toKey(REQUEST), response));
+    this_thread::sleep_for(chrono::milliseconds(80));
+    CPPUNIT_ASSERT(!cache.find(toKey(REQUEST), response));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), cache.size());
+}
+
+void ResponseCacheTest::testInvalidate()
+{
+    auto pEpoch = make_shared<ResponseCache::Epoch>(0);
+    ResponseCache cache1(SimulationClock::Duration::zero(), pEpoch);
+    ResponseCache cache2(chrono::hours(1), pEpoch);
+    cache1.insert(toKey(REQUEST), toKey(RESPONSE));
+    cache2.insert(toKey(REQUEST), toKey(RESPONSE));
+
+    // like `invalidateCache()`
+    pEpoch->fetch_add(1);
+    vector<uint8_t> response;
+    CPPUNIT_ASSERT(!cache1.find(toKey(REQUEST), response));
+    CPPUNIT_ASSERT(!cache2.find(toKey(REQUEST), response));
+
+    cache1.insert(toKey(REQUEST), toKey(RESPONSE));
+    CPPUNIT_ASSERT(cache1.find(toKey(REQUEST), response));
+}
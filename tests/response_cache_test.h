@@ -0,0 +1,37 @@
+/**
+ * @file response_cache_test.h
+ *
+ */
+
+#ifndef RESPONSE_CACHE_TEST_H
+#define RESPONSE_CACHE_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class ResponseCacheTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(ResponseCacheTest);
+
+    CPPUNIT_TEST(testFind);
+    CPPUNIT_TEST(testLeastRecentlyUsed);
+    CPPUNIT_TEST(testTtl);
+    CPPUNIT_TEST(testInvalidate);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    ResponseCacheTest() = default;
+    virtual ~ResponseCacheTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testFind();
+    void testLeastRecentlyUsed();
+    void testTtl();
+    void testInvalidate();
+
+};
+
+#endif /* RESPONSE_CACHE_TEST_H */
+
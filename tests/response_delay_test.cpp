@@ -0,0 +1,145 @@
+/**
+ * @file response_delay_test.cpp
+ *
+ * Unit test for the response time distributions and the delayed responses.
+ * The timings are chosen generously, so the tests also pass on a busy machine.
+ */
+
+#include "response_delay_test.h"
+#include "response_delay.h"
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ResponseDelayTest);
+
+static constexpr int SAMPLES = 10000;
+
+/**
+ * Records the sent responses.
+ */
+class RecordingTransport : public UdsTransport
+{
+public:
+    int sendData(const void* buffer, size_t size) noexcept override
+    {
+        lock_guard<mutex> lock(mutex_);
+        const uint8_t* pBytes = static_cast<const uint8_t*> (buffer);
+        responses_.emplace_back(pBytes, pBytes + size);
+        return int(size);
+    }
+
+    vector<vector<uint8_t>> getResponses()
+    {
+        lock_guard<mutex> lock(mutex_);
+        return responses_;
+    }
+
+private:
+    mutex mutex_;
+    vector<vector<uint8_t>> responses_;
+};
+
+void ResponseDelayTest::setUp() { }
+
+void ResponseDelayTest::tearDown() { }
+
+void ResponseDelayTest::testFixed()
+{
+    mt19937 random(1);
+    const ResponseDelay delay = ResponseDelay::fixed(12.4);
+    CPPUNIT_ASSERT(delay.isValid());
+    CPPUNIT_ASSERT_EQUAL(int64_t(12), int64_t(delay.sample(random).count()));
+    CPPUNIT_ASSERT_EQUAL(int64_t(0), int64_t(ResponseDelay::fixed(0).sample(random).count()));
+}
+
+void ResponseDelayTest::testUniform()
+{
+    mt19937 random(1);
+    const ResponseDelay delay = ResponseDelay::uniform(10, 20);
+    CPPUNIT_ASSERT(delay.isValid());
+    int64_t sum = 0;
+    for (int i = 0; i < SAMPLES; ++i)
+    {
+        const int64_t sample = delay.sample(random).count();
+        CPPUNIT_ASSERT(sample >= 10 && sample <= 20);
+        sum += sample;
+    }
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(15.0, double(sum) / SAMPLES, 0.2);
+}
+
+void ResponseDelayTest::testNormal()
+{
+    mt19937 random(1);
+    const ResponseDelay delay = ResponseDelay::normal(20, 4);
+    CPPUNIT_ASSERT(delay.isValid());
+    int64_t sum = 0;
+    for (int i = 0; i < SAMPLES; ++i)
+    {
+        sum += delay.sample(random).count();
+    }
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(20.0, double(sum) / SAMPLES, 0.2);
+
+    // negative samples are cut off
+    const ResponseDelay wide = ResponseDelay::normal(1, 10);
+    for (int i = 0; i < SAMPLES; ++i)
+    {
+        CPPUNIT_ASSERT(wide.sample(random).count() >= 0);
+    }
+}
+
+void ResponseDelayTest::testHistogram()
+{
+    mt19937 random(1);
+    const ResponseDelay delay = ResponseDelay::histogram({{8, 70}, {12, 25}, {40, 5}, {99, 0}});
+    CPPUNIT_ASSERT(delay.isValid());
+    map<int64_t, int> counts;
+    for (int i = 0; i < SAMPLES; ++i)
+    {
+        counts[delay.sample(random).count()]++;
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(3), counts.size());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.70, double(counts[8]) / SAMPLES, 0.02);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25, double(counts[12]) / SAMPLES, 0.02);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.05, double(counts[40]) / SAMPLES, 0.01);
+}
+
+void ResponseDelayTest::testInvalid()
+{
+    CPPUNIT_ASSERT(!ResponseDelay::fixed(-1).isValid());
+    CPPUNIT_ASSERT(!ResponseDelay::uniform(20, 10).isValid());
+    CPPUNIT_ASSERT(!ResponseDelay::normal(10, -1).isValid());
+    CPPUNIT_ASSERT(!ResponseDelay::histogram({{10, 0}}).isValid());
+    CPPUNIT_ASSERT(!ResponseDelay::histogram({{-5, 1}}).isValid());
+}
+
+void ResponseDelayTest::testDelayedResponses()
+{
+    TimerWheel wheel;
+    RecordingTransport transport;
+    DelayedResponses delayedResponses(&transport, wheel);
+    const uint8_t first[] = {0x62, 0xF1, 0x90};
+    const uint8_t second[] = {0x7E, 0x00};
+
+    // without a delay and nothing queued, the caller sends the response
+    RequestTimer timer(nullptr, 0x22, chrono::steady_clock::now());
+    CPPUNIT_ASSERT(!delayedResponses.send(first, sizeof(first), timer, chrono::milliseconds(0)));
+
+    CPPUNIT_ASSERT(delayedResponses.send(first, sizeof(first), timer, chrono::milliseconds(50)));
+    // queued behind the first response, although it has no delay
+    RequestTimer secondTimer(nullptr, 0x3E, chrono::steady_clock::now());
+    CPPUNIT_ASSERT(delayedResponses.send(second, sizeof(second), secondTimer, chrono::milliseconds(0)));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), delayedResponses.getQueuedResponses());
+    CPPUNIT_ASSERT(transport.getResponses().empty());
+
+    this_thread::sleep_for(chrono::milliseconds(300));
+    const vector<vector<uint8_t>> responses = transport.getResponses();
+    CPPUNIT_ASSERT_EQUAL(size_t(2), responses.size());
+    CPPUNIT_ASSERT(responses[0] == vector<uint8_t>(first, first + sizeof(first)));
+    CPPUNIT_ASSERT(responses[1] == vector<uint8_t>(second, second + sizeof(second)));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), delayedResponses.getQueuedResponses());
+}
@@ -0,0 +1,40 @@
+/**
+ * @file response_delay_test.h
+ *
+ */
+
+#ifndef RESPONSE_DELAY_TEST_H
+#define RESPONSE_DELAY_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class ResponseDelayTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(ResponseDelayTest);
+
+    CPPUNIT_TEST(testFixed);
+    CPPUNIT_TEST(testUniform);
+    CPPUNIT_TEST(testNormal);
+    CPPUNIT_TEST(testHistogram);
+    CPPUNIT_TEST(testInvalid);
+    CPPUNIT_TEST(testDelayedResponses);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    ResponseDelayTest() = default;
+    virtual ~ResponseDelayTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testFixed();
+    void testUniform();
+    void testNormal();
+    void testHistogram();
+    void testInvalid();
+    void testDelayedResponses();
+
+};
+
+#endif /* RESPONSE_DELAY_TEST_H */
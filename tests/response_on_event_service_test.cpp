@@ -0,0 +1,256 @@
+/**
+ * @file response_on_event_service_test.cpp
+ *
+ * Unit test for the responses sent on events.
+ */
+
+#include "response_on_event_service_test.h"
+#include "response_on_event_service.h"
+#include "service_identifier.h"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ResponseOnEventServiceTest);
+
+namespace
+{
+
+/// the value of F40D, changed by the tests
+vector<uint8_t> speed = {0x00, 0x50};
+
+mutex sentMutex;
+/// the responses sent on events
+vector<vector<uint8_t>> sent;
+
+bool readData(UdsSession, uint16_t dataIdentifier, vector<uint8_t>& data)
+{
+    lock_guard<mutex> lock(sentMutex);
+    switch (dataIdentifier)
+    {
+        case 0xF40D:
+            data = speed;
+            return true;
+        case 0xF190:
+            data.assign({'W', 'V', 'W'});
+            return true;
+        default:
+            return false;
+    }
+}
+
+/// answers every `ReadDTCInformation` request with `59 02 FF`
+void respond(const uint8_t*, size_t, vector<uint8_t>& response)
+{
+    response.assign({0x59, 0x02, 0xFF});
+}
+
+void send(const uint8_t* response, size_t length)
+{
+    lock_guard<mutex> lock(sentMutex);
+    sent.emplace_back(response, response + length);
+}
+
+vector<vector<uint8_t>> getSent()
+{
+    lock_guard<mutex> lock(sentMutex);
+    return sent;
+}
+
+void setSpeed(vector<uint8_t> value)
+{
+    lock_guard<mutex> lock(sentMutex);
+    speed = move(value);
+}
+
+vector<uint8_t> request(ResponseOnEventService& service, const vector<uint8_t>& request)
+{
+    vector<uint8_t> response;
+    service.proceedRequest(request.data(), request.size(), response);
+    return response;
+}
+
+PeriodicDataConfiguration getRates()
+{
+    PeriodicDataConfiguration rates;
+    rates.slowRate = chrono::milliseconds(100);
+    rates.mediumRate = chrono::milliseconds(50);
+    rates.fastRate = chrono::milliseconds(20);
+    return rates;
+}
+
+} // namespace
+
+void ResponseOnEventServiceTest::setUp()
+{
+    speed = {0x00, 0x50};
+    sent.clear();
+}
+
+void ResponseOnEventServiceTest::tearDown() { }
+
+void ResponseOnEventServiceTest::testInvalidRequests()
+{
+    ResponseOnEventService service(getRates(), nullptr, make_shared<DtcStore>(), readData, respond, send);
+
+    CPPUNIT_ASSERT(request(service, {0x86}) == vector<uint8_t>({ERROR, 0x86, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT}));
+    CPPUNIT_ASSERT(request(service, {0x86, 0x07, 0x02}) == vector<uint8_t>({ERROR, 0x86, SUBFUNCTION_NOT_SUPPORTED}));
+    // no service to respond to
+    CPPUNIT_ASSERT(request(service, {0x86, 0x03, 0x02, 0xF4, 0x0D})
+                   == vector<uint8_t>({ERROR, 0x86, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT}));
+    // only 0x22 and 0x19 are answered
+    CPPUNIT_ASSERT(request(service, {0x86, 0x03, 0x02, 0xF4, 0x0D, 0x31, 0x01})
+                   == vector<uint8_t>({ERROR, 0x86, REQUEST_OUT_OF_RANGE}));
+    // an incomplete data identifier
+    CPPUNIT_ASSERT(request(service, {0x86, 0x03, 0x02, 0xF4, 0x0D, 0x22, 0xF4})
+                   == vector<uint8_t>({ERROR, 0x86, REQUEST_OUT_OF_RANGE}));
+    // no event window
+    CPPUNIT_ASSERT(request(service, {0x86, 0x03, 0x00, 0xF4, 0x0D, 0x22, 0xF4, 0x0D})
+                   == vector<uint8_t>({ERROR, 0x86, REQUEST_OUT_OF_RANGE}));
+    // an unknown timer rate
+    CPPUNIT_ASSERT(request(service, {0x86, 0x02, 0x02, 0x04, 0x22, 0xF4, 0x0D})
+                   == vector<uint8_t>({ERROR, 0x86, REQUEST_OUT_OF_RANGE}));
+    // nothing to start
+    CPPUNIT_ASSERT(request(service, {0x86, 0x05, 0x02}) == vector<uint8_t>({ERROR, 0x86, REQUEST_SEQUENCE_ERROR}));
+    CPPUNIT_ASSERT(request(service, {0x86, 0x05}) == vector<uint8_t>({ERROR, 0x86, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT}));
+
+    for (uint8_t i = 0; i < MAX_RESPONSE_ON_EVENTS; ++i)
+    {
+        CPPUNIT_ASSERT_EQUAL(uint8_t(0xC6), request(service, {0x86, 0x03, 0x02, 0xF4, i, 0x22, 0xF4, 0x0D})[0]);
+    }
+    CPPUNIT_ASSERT(request(service, {0x86, 0x03, 0x02, 0xF5, 0x00, 0x22, 0xF4, 0x0D})
+                   == vector<uint8_t>({ERROR, 0x86, REQUEST_OUT_OF_RANGE}));
+    // the same event replaces the one set up before
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0xC6), request(service, {0x86, 0x03, 0x02, 0xF4, 0x00, 0x22, 0xF1, 0x90})[0]);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), service.getStartedCount());
+}
+
+void ResponseOnEventServiceTest::testChangeOfDataIdentifier()
+{
+    ResponseOnEventService service(getRates(), nullptr, make_shared<DtcStore>(), readData, respond, send);
+
+    CPPUNIT_ASSERT(request(service, {0x86, 0x03, 0x02, 0xF4, 0x0D, 0x22, 0xF4, 0x0D, 0xF1, 0x90})
+                   == vector<uint8_t>({0xC6, 0x03, 0x00, 0x02, 0xF4, 0x0D, 0x22, 0xF4, 0x0D, 0xF1, 0x90}));
+    CPPUNIT_ASSERT(request(service, {0x86, 0x05, 0x02}) == vector<uint8_t>({0xC6, 0x05, 0x00, 0x02}));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), service.getStartedCount());
+
+    // a change of another value is no event
+    service.notifyChange();
+    this_thread::sleep_for(chrono::milliseconds(30));
+    CPPUNIT_ASSERT(getSent().empty());
+
+    setSpeed({0x00, 0x60});
+    service.notifyChange();
+    this_thread::sleep_for(chrono::milliseconds(30));
+    vector<vector<uint8_t>> responses = getSent();
+    CPPUNIT_ASSERT_EQUAL(size_t(1), responses.size());
+    CPPUNIT_ASSERT(responses[0] == vector<uint8_t>({0x62, 0xF4, 0x0D, 0x00, 0x60, 0xF1, 0x90, 'W', 'V', 'W'}));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), service.getSentCount());
+
+    // a stopped event sees no change
+    service.stopAll();
+    setSpeed({0x00, 0x70});
+    service.notifyChange();
+    this_thread::sleep_for(chrono::milliseconds(30));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), getSent().size());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), service.getStartedCount());
+}
+
+void ResponseOnEventServiceTest::testDtcStatusChange()
+{
+    auto pDtcStore = make_shared<DtcStore>();
+    pDtcStore->setDtc(0x123456, 0x08);
+    ResponseOnEventService service(getRates(), nullptr, pDtcStore, readData, respond, send);
+
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0xC6), request(service, {0x86, 0x01, 0x02, 0x01, 0x19, 0x02, 0x01})[0]);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0xC6), request(service, {0x86, 0x05, 0x02})[0]);
+
+    // a bit outside of the mask
+    pDtcStore->setDtc(0x123456, 0x0C);
+    this_thread::sleep_for(chrono::milliseconds(30));
+    CPPUNIT_ASSERT(getSent().empty());
+
+    pDtcStore->setDtc(0x123456, 0x0D);
+    this_thread::sleep_for(chrono::milliseconds(30));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), getSent().size());
+    CPPUNIT_ASSERT(getSent()[0] == vector<uint8_t>({0x59, 0x02, 0xFF}));
+
+    // losing the bit is no event, gaining it again is
+    pDtcStore->setDtc(0x123456, 0x0C);
+    this_thread::sleep_for(chrono::milliseconds(30));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), getSent().size());
+    pDtcStore->setDtc(0x123456, 0x0D);
+    this_thread::sleep_for(chrono::milliseconds(30));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), getSent().size());
+
+    // a new DTC
+    pDtcStore->setDtc(0x654321, 0x01);
+    this_thread::sleep_for(chrono::milliseconds(30));
+    CPPUNIT_ASSERT_EQUAL(size_t(3), getSent().size());
+}
+
+void ResponseOnEventServiceTest::testTimerInterrupt()
+{
+    ResponseOnEventService service(getRates(), nullptr, make_shared<DtcStore>(), readData, respond, send);
+
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0xC6), request(service, {0x86, 0x02, 0x02, 0x03, 0x22, 0xF4, 0x0D})[0]);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0xC6), request(service, {0x86, 0x05, 0x02})[0]);
+    this_thread::sleep_for(chrono::milliseconds(110));
+    service.stopAll();
+    const vector<vector<uint8_t>> responses = getSent();
+    // every 20 ms
+    CPPUNIT_ASSERT(responses.size() >= 3 && responses.size() <= 6);
+    CPPUNIT_ASSERT(responses[0] == vector<uint8_t>({0x62, 0xF4, 0x0D, 0x00, 0x50}));
+    this_thread::sleep_for(chrono::milliseconds(50));
+    CPPUNIT_ASSERT_EQUAL(responses.size(), getSent().size());
+}
+
+void ResponseOnEventServiceTest::testStopClearReport()
+{
+    ResponseOnEventService service(getRates(), nullptr, make_shared<DtcStore>(), readData, respond, send);
+
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0xC6), request(service, {0x86, 0x03, 0x02, 0xF4, 0x0D, 0x22, 0xF4, 0x0D})[0]);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0xC6), request(service, {0x86, 0x01, 0x02, 0x09, 0x19, 0x02, 0x09})[0]);
+    CPPUNIT_ASSERT(request(service, {0x86, 0x04}) == vector<uint8_t>({0xC6, 0x04, 0x00}));
+
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0xC6), request(service, {0x86, 0x05, 0x02})[0]);
+    CPPUNIT_ASSERT(request(service, {0x86, 0x04})
+                   == vector<uint8_t>({0xC6, 0x04, 0x02, 0x03, 0x02, 0xF4, 0x0D, 0x22, 0xF4, 0x0D,
+                                       0x01, 0x02, 0x09, 0x19, 0x02, 0x09}));
+
+    CPPUNIT_ASSERT(request(service, {0x86, 0x00, 0x02}) == vector<uint8_t>({0xC6, 0x00, 0x00, 0x02}));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), service.getStartedCount());
+    // stopped events can be started again
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0xC6), request(service, {0x86, 0x05, 0x02})[0]);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), service.getStartedCount());
+
+    CPPUNIT_ASSERT(request(service, {0x86, 0x06, 0x02}) == vector<uint8_t>({0xC6, 0x06, 0x00, 0x02}));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), service.getStartedCount());
+    CPPUNIT_ASSERT(request(service, {0x86, 0x05, 0x02}) == vector<uint8_t>({ERROR, 0x86, REQUEST_SEQUENCE_ERROR}));
+}
+
+void ResponseOnEventServiceTest::testEventWindow()
+{
+    ResponseOnEventService service(getRates(), nullptr, make_shared<DtcStore>(), readData, respond, send);
+
+    // one second
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0xC6), request(service, {0x86, 0x03, 0x01, 0xF4, 0x0D, 0x22, 0xF4, 0x0D})[0]);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0xC6), request(service, {0x86, 0x05, 0x02})[0]);
+    setSpeed({0x00, 0x60});
+    service.notifyChange();
+    this_thread::sleep_for(chrono::milliseconds(30));
+    setSpeed({0x00, 0x70});
+    service.notifyChange();
+    this_thread::sleep_for(chrono::milliseconds(1100));
+
+    const vector<vector<uint8_t>> responses = getSent();
+    CPPUNIT_ASSERT_EQUAL(size_t(3), responses.size());
+    CPPUNIT_ASSERT(responses[1] == vector<uint8_t>({0x62, 0xF4, 0x0D, 0x00, 0x70}));
+    // the final response with the number of identified events
+    CPPUNIT_ASSERT(responses[2] == vector<uint8_t>({0xC6, 0x03, 0x02, 0x01}));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), service.getStartedCount());
+}
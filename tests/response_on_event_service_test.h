@@ -0,0 +1,40 @@
+/**
+ * @file response_on_event_service_test.h
+ *
+ */
+
+#ifndef RESPONSE_ON_EVENT_SERVICE_TEST_H
+#define RESPONSE_ON_EVENT_SERVICE_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class ResponseOnEventServiceTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(ResponseOnEventServiceTest);
+
+    CPPUNIT_TEST(testInvalidRequests);
+    CPPUNIT_TEST(testChangeOfDataIdentifier);
+    CPPUNIT_TEST(testDtcStatusChange);
+    CPPUNIT_TEST(testTimerInterrupt);
+    CPPUNIT_TEST(testStopClearReport);
+    CPPUNIT_TEST(testEventWindow);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    ResponseOnEventServiceTest() = default;
+    virtual ~ResponseOnEventServiceTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testInvalidRequests();
+    void testChangeOfDataIdentifier();
+    void testDtcStatusChange();
+    void testTimerInterrupt();
+    void testStopClearReport();
+    void testEventWindow();
+
+};
+
+#endif /* RESPONSE_ON_EVENT_SERVICE_TEST_H */
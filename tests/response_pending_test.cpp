@@ -0,0 +1,145 @@
+/**
+ * @file response_pending_test.cpp
+ *
+ * Unit test for the response pending messages of slow requests.
+ */
+
+#include "response_pending_test.h"
+#include "response_pending.h"
+#include "service_identifier.h"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ResponsePendingTest);
+
+namespace
+{
+
+/**
+ * Collects the sent responses, which are sent from several threads.
+ */
+class SentResponses
+{
+public:
+    ResponsePending::Sender getSender()
+    {
+        return [this](const uint8_t* response, size_t length) {
+            lock_guard<mutex> lock(mutex_);
+            responses_.emplace_back(response, response + length);
+        };
+    }
+
+    vector<vector<uint8_t>> get()
+    {
+        lock_guard<mutex> lock(mutex_);
+        return responses_;
+    }
+
+private:
+    mutex mutex_;
+    vector<vector<uint8_t>> responses_;
+};
+
+const ResponsePendingConfiguration TIMING = {chrono::milliseconds(20), chrono::milliseconds(40)};
+
+} // namespace
+
+void ResponsePendingTest::setUp() { }
+
+void ResponsePendingTest::tearDown() { }
+
+void ResponsePendingTest::testFastResponse()
+{
+    SentResponses sent;
+    ResponsePending pending(TIMING, sent.getSender());
+    RequestTimer timer(nullptr, 0x31, chrono::steady_clock::now());
+    CPPUNIT_ASSERT(pending.start(0x31, timer));
+    CPPUNIT_ASSERT(pending.isPending());
+    pending.getResponseBuffer().assign({0x71, 0x01, 0x02, 0x03});
+    pending.finish();
+    CPPUNIT_ASSERT(!pending.isPending());
+
+    // no response pending after the final response
+    this_thread::sleep_for(chrono::milliseconds(60));
+    const vector<vector<uint8_t>> responses = sent.get();
+    CPPUNIT_ASSERT_EQUAL(size_t(1), responses.size());
+    CPPUNIT_ASSERT(responses[0] == vector<uint8_t>({0x71, 0x01, 0x02, 0x03}));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), pending.getPendingCount());
+}
+
+void ResponsePendingTest::testSlowResponse()
+{
+    SentResponses sent;
+    ResponsePending pending(TIMING, sent.getSender());
+    RequestTimer timer(nullptr, 0x31, chrono::steady_clock::now());
+    CPPUNIT_ASSERT(pending.start(0x31, timer));
+
+    // P2 and at least one P2* interval
+    this_thread::sleep_for(chrono::milliseconds(100));
+    pending.getResponseBuffer().assign({0x71, 0x01});
+    pending.finish();
+
+    const vector<vector<uint8_t>> responses = sent.get();
+    CPPUNIT_ASSERT(responses.size() >= 3);
+    CPPUNIT_ASSERT_EQUAL(responses.size() - 1, pending.getPendingCount());
+    for (size_t i = 0; i + 1 < responses.size(); ++i)
+    {
+        CPPUNIT_ASSERT(responses[i] == vector<uint8_t>({ERROR, 0x31, RESPONSE_PENDING}));
+    }
+    CPPUNIT_ASSERT(responses.back() == vector<uint8_t>({0x71, 0x01}));
+}
+
+void ResponsePendingTest::testBusy()
+{
+    SentResponses sent;
+    ResponsePending pending(TIMING, sent.getSender());
+    RequestTimer timer(nullptr, 0x31, chrono::steady_clock::now());
+    CPPUNIT_ASSERT(pending.start(0x31, timer));
+    RequestTimer otherTimer(nullptr, 0x22, chrono::steady_clock::now());
+    CPPUNIT_ASSERT(!pending.start(0x22, otherTimer));
+
+    // no response at all
+    pending.finish();
+    CPPUNIT_ASSERT(sent.get().empty());
+    CPPUNIT_ASSERT(pending.start(0x22, otherTimer));
+    pending.finish();
+}
+
+void ResponsePendingTest::testSuppressPosRsp()
+{
+    const uint8_t request[] = {0x31, 0x81, 0x02, 0x03};
+    CPPUNIT_ASSERT(isSuppressPosRsp(request, sizeof(request)));
+    CPPUNIT_ASSERT(!isSuppressPosRsp(request, 1));
+    const uint8_t readRequest[] = {0x22, 0x80, 0x01};
+    CPPUNIT_ASSERT(!isSuppressPosRsp(readRequest, sizeof(readRequest)));
+
+    SentResponses sent;
+    ResponsePending pending(TIMING, sent.getSender());
+    RequestTimer timer(nullptr, 0x31, chrono::steady_clock::now());
+    CPPUNIT_ASSERT(pending.start(0x31, timer));
+    pending.getResponseBuffer().assign({0x71, 0x01, 0x02, 0x03});
+    pending.finish(true);
+    CPPUNIT_ASSERT(sent.get().empty());
+
+    // a negative response is sent anyway
+    RequestTimer negativeTimer(nullptr, 0x31, chrono::steady_clock::now());
+    CPPUNIT_ASSERT(pending.start(0x31, negativeTimer));
+    pending.getResponseBuffer().assign({ERROR, 0x31, REQUEST_OUT_OF_RANGE});
+    pending.finish(true);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), sent.get().size());
+
+    // and a positive one after a response pending message, the tester waits for it
+    RequestTimer slowTimer(nullptr, 0x31, chrono::steady_clock::now());
+    CPPUNIT_ASSERT(pending.start(0x31, slowTimer));
+    this_thread::sleep_for(chrono::milliseconds(40));
+    pending.getResponseBuffer().assign({0x71, 0x01});
+    pending.finish(true);
+    const vector<vector<uint8_t>> responses = sent.get();
+    CPPUNIT_ASSERT(responses.size() >= 3);
+    CPPUNIT_ASSERT(responses.back() == vector<uint8_t>({0x71, 0x01}));
+}
@@ -0,0 +1,36 @@
+/**
+ * @file response_pending_test.h
+ *
+ */
+
+#ifndef RESPONSE_PENDING_TEST_H
+#define RESPONSE_PENDING_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class ResponsePendingTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(ResponsePendingTest);
+
+    CPPUNIT_TEST(testFastResponse);
+    CPPUNIT_TEST(testSlowResponse);
+    CPPUNIT_TEST(testBusy);
+    CPPUNIT_TEST(testSuppressPosRsp);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    ResponsePendingTest() = default;
+    virtual ~ResponsePendingTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testFastResponse();
+    void testSlowResponse();
+    void testBusy();
+    void testSuppressPosRsp();
+
+};
+
+#endif /* RESPONSE_PENDING_TEST_H */
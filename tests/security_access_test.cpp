@@ -0,0 +1,197 @@
+/**
+ * @file security_access_test.cpp
+ *
+ * Unit test for the native seed/key engine of `SecurityAccess`.
+ */
+
+#include "security_access_test.h"
+#include "security_access.h"
+#include "uds_services.h"
+#include "service_identifier.h"
+#include <chrono>
+#include <cstdint>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SecurityAccessTest);
+
+static vector<uint8_t> proceed(UdsServiceHandler& service, const vector<uint8_t>& request)
+{
+    vector<uint8_t> response;
+    service.proceedRequest(request.data(), request.size(), response);
+    return response;
+}
+
+static SecurityLevelConfiguration makeXorLevel(uint8_t level)
+{
+    SecurityLevelConfiguration configuration;
+    configuration.level = level;
+    configuration.secret = {0xA5, 0x5A};
+    return configuration;
+}
+
+/**
+ * Requests a seed and sends the given key.
+ *
+ * @return the response of `sendKey`
+ */
+static vector<uint8_t> unlock(SecurityAccessService& service, uint8_t level, uint8_t keyXor = 0x00)
+{
+    const vector<uint8_t> seedResponse = proceed(service, {SECURITY_ACCESS_REQ, level});
+    CPPUNIT_ASSERT_EQUAL(SECURITY_ACCESS_RES, seedResponse[0]);
+    vector<uint8_t> request = {SECURITY_ACCESS_REQ, uint8_t(level + 1)};
+    const vector<uint8_t> seed(seedResponse.cbegin() + 2, seedResponse.cend());
+    const auto key = SecurityAccessService::calculateKey(makeXorLevel(level), seed);
+    request.insert(request.cend(), key->cbegin(), key->cend());
+    request.back() ^= keyXor;
+    return proceed(service, request);
+}
+
+void SecurityAccessTest::setUp() { }
+
+void SecurityAccessTest::tearDown() { }
+
+void SecurityAccessTest::testUnlock()
+{
+    SecurityAccessService service(nullptr);
+    service.setLevels({makeXorLevel(0x01), makeXorLevel(0x03)});
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x00), service.getUnlockedLevel());
+
+    const vector<uint8_t> seedResponse = proceed(service, {SECURITY_ACCESS_REQ, 0x01});
+    CPPUNIT_ASSERT_EQUAL(size_t(2 + DEFAULT_SEED_LENGTH), seedResponse.size());
+    CPPUNIT_ASSERT(unlock(service, 0x01) == vector<uint8_t>({SECURITY_ACCESS_RES, 0x02}));
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x01), service.getUnlockedLevel());
+
+    // an unlocked level gets a seed of zeros
+    CPPUNIT_ASSERT(proceed(service, {SECURITY_ACCESS_REQ, 0x01})
+                   == vector<uint8_t>({SECURITY_ACCESS_RES, 0x01, 0x00, 0x00, 0x00, 0x00}));
+
+    // many unlock cycles
+    for (int i = 0; i < 1000; ++i)
+    {
+        CPPUNIT_ASSERT(unlock(service, 0x03) == vector<uint8_t>({SECURITY_ACCESS_RES, 0x04}));
+        service.lock();
+    }
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x00), service.getUnlockedLevel());
+}
+
+void SecurityAccessTest::testSequence()
+{
+    SecurityAccessService service(nullptr);
+    service.setLevels({makeXorLevel(0x01)});
+    CPPUNIT_ASSERT(proceed(service, {SECURITY_ACCESS_REQ, 0x02, 0x12, 0x34})
+                   == vector<uint8_t>({ERROR, SECURITY_ACCESS_REQ, REQUEST_SEQUENCE_ERROR}));
+    CPPUNIT_ASSERT(proceed(service, {SECURITY_ACCESS_REQ, 0x05})
+                   == vector<uint8_t>({ERROR, SECURITY_ACCESS_REQ, SUBFUNCTION_NOT_SUPPORTED}));
+    CPPUNIT_ASSERT(proceed(service, {SECURITY_ACCESS_REQ})
+                   == vector<uint8_t>({ERROR, SECURITY_ACCESS_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT}));
+
+    // a seed is valid for one key only
+    CPPUNIT_ASSERT(unlock(service, 0x01, 0xFF) == vector<uint8_t>({ERROR, SECURITY_ACCESS_REQ, INVALID_KEY}));
+    CPPUNIT_ASSERT(proceed(service, {SECURITY_ACCESS_REQ, 0x02, 0x12, 0x34})
+                   == vector<uint8_t>({ERROR, SECURITY_ACCESS_REQ, REQUEST_SEQUENCE_ERROR}));
+}
+
+void SecurityAccessTest::testAttempts()
+{
+    SecurityLevelConfiguration level = makeXorLevel(0x01);
+    level.maxAttempts = 2;
+    level.delay = chrono::milliseconds(30);
+    SecurityAccessService service(nullptr);
+    service.setLevels({level});
+
+    CPPUNIT_ASSERT(unlock(service, 0x01, 0xFF) == vector<uint8_t>({ERROR, SECURITY_ACCESS_REQ, INVALID_KEY}));
+    CPPUNIT_ASSERT(unlock(service, 0x01, 0xFF) == vector<uint8_t>({ERROR, SECURITY_ACCESS_REQ, EXCEEDED_NUMBER_OF_ATTEMPTS}));
+    CPPUNIT_ASSERT(proceed(service, {SECURITY_ACCESS_REQ, 0x01})
+                   == vector<uint8_t>({ERROR, SECURITY_ACCESS_REQ, REQUIRED_TIME_DELAY_NOT_EXPIRED}));
+
+    this_thread::sleep_for(chrono::milliseconds(80));
+    CPPUNIT_ASSERT(unlock(service, 0x01) == vector<uint8_t>({SECURITY_ACCESS_RES, 0x02}));
+}
+
+void SecurityAccessTest::testSessionLock()
+{
+    SessionController sessionCtrl;
+    SecurityAccessService service(&sessionCtrl);
+    service.setLevels({makeXorLevel(0x01)});
+    sessionCtrl.setCurrentUdsSession(UdsSession::EXTENDED);
+    CPPUNIT_ASSERT(unlock(service, 0x01) == vector<uint8_t>({SECURITY_ACCESS_RES, 0x02}));
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x01), service.getUnlockedLevel());
+
+    // e.g. the S3 timeout
+    sessionCtrl.setCurrentUdsSession(UdsSession::DEFAULT);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x00), service.getUnlockedLevel());
+}
+
+void SecurityAccessTest::testKeyAlgorithms()
+{
+    SecurityLevelConfiguration level;
+    level.secret = {0xFF, 0x00};
+    CPPUNIT_ASSERT(*SecurityAccessService::calculateKey(level, {0x12, 0x34, 0x56})
+                   == vector<uint8_t>({0xED, 0x34, 0xA9}));
+
+    // CRC-32 of "123456789"
+    level.algorithm = KeyAlgorithm::CRC;
+    level.crcAlgorithm = CrcAlgorithm::CRC32;
+    level.secret = {'5', '6', '7', '8', '9'};
+    CPPUNIT_ASSERT(*SecurityAccessService::calculateKey(level, {'1', '2', '3', '4'})
+                   == vector<uint8_t>({0xCB, 0xF4, 0x39, 0x26}));
+
+    // FIPS-197, appendix C.1
+    level.algorithm = KeyAlgorithm::AES128;
+    level.secret.clear();
+    vector<uint8_t> seed;
+    for (uint8_t i = 0; i < 16; ++i)
+    {
+        level.secret.push_back(i);
+        seed.push_back(uint8_t(i * 0x11));
+    }
+    CPPUNIT_ASSERT(*SecurityAccessService::calculateKey(level, seed)
+                   == vector<uint8_t>({0x69, 0xC4, 0xE0, 0xD8, 0x6A, 0x7B, 0x04, 0x30,
+                                       0xD8, 0xCD, 0xB7, 0x80, 0x70, 0xB4, 0xC5, 0x5A}));
+    level.secret.pop_back();
+    CPPUNIT_ASSERT(!SecurityAccessService::calculateKey(level, seed));
+
+    level.algorithm = KeyAlgorithm::LUA;
+    CPPUNIT_ASSERT(!SecurityAccessService::calculateKey(level, seed));
+    level.keyFunction = [](const vector<uint8_t>& s) { return optional<vector<uint8_t>>(vector<uint8_t>(s.crbegin(), s.crend())); };
+    CPPUNIT_ASSERT(*SecurityAccessService::calculateKey(level, {0x01, 0x02}) == vector<uint8_t>({0x02, 0x01}));
+}
+
+void SecurityAccessTest::testSeedGenerator()
+{
+    SeedGenerator first(42);
+    SeedGenerator second(42);
+    set<uint64_t> values;
+    for (int i = 0; i < 100; ++i)
+    {
+        const uint64_t value = first.next();
+        CPPUNIT_ASSERT_EQUAL(value, second.next());
+        values.insert(value);
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(100), values.size());
+
+    uint8_t buffer[5] = {};
+    SeedGenerator().fill(buffer, sizeof(buffer));
+}
+
+void SecurityAccessTest::testUdsServices()
+{
+    UdsServices services(nullptr);
+    services.getSecurityAccessService().setLevels({makeXorLevel(0x01)});
+    CPPUNIT_ASSERT(UdsServices::isNativeService(SECURITY_ACCESS_REQ));
+    CPPUNIT_ASSERT(unlock(services.getSecurityAccessService(), 0x01) == vector<uint8_t>({SECURITY_ACCESS_RES, 0x02}));
+
+    // an ECU reset locks the ECU
+    vector<uint8_t> response;
+    const uint8_t reset[] = {ECU_RESET_REQ, 0x01};
+    CPPUNIT_ASSERT(services.proceedRequest(reset, sizeof(reset), response));
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x00), services.getSecurityAccessService().getUnlockedLevel());
+
+    // the suppressPosRspMsgIndicationBit
+    const uint8_t requestSeed[] = {SECURITY_ACCESS_REQ, 0x81};
+    CPPUNIT_ASSERT(!services.proceedRequest(requestSeed, sizeof(requestSeed), response));
+}
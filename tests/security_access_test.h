@@ -0,0 +1,42 @@
+/**
+ * @file security_access_test.h
+ *
+ */
+
+#ifndef SECURITY_ACCESS_TEST_H
+#define SECURITY_ACCESS_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class SecurityAccessTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(SecurityAccessTest);
+
+    CPPUNIT_TEST(testUnlock);
+    CPPUNIT_TEST(testSequence);
+    CPPUNIT_TEST(testAttempts);
+    CPPUNIT_TEST(testSessionLock);
+    CPPUNIT_TEST(testKeyAlgorithms);
+    CPPUNIT_TEST(testSeedGenerator);
+    CPPUNIT_TEST(testUdsServices);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    SecurityAccessTest() = default;
+    virtual ~SecurityAccessTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testUnlock();
+    void testSequence();
+    void testAttempts();
+    void testSessionLock();
+    void testKeyAlgorithms();
+    void testSeedGenerator();
+    void testUdsServices();
+
+};
+
+#endif /* SECURITY_ACCESS_TEST_H */
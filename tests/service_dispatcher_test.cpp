@@ -0,0 +1,144 @@
+/**
+ * @file service_dispatcher_test.cpp
+ *
+ * Unit test for the services shared by the UDS and the DoIP front-end. The
+ * same requests are sent to the `UdsReceiver` (with a `LoopbackTransport`, so
+ * no vcan is needed) and to the `DoIPSimulator` of one ECU.
+ */
+
+#include "service_dispatcher_test.h"
+#include "doip_simulator.h"
+#include "ecu_lua_script.h"
+#include "loopback_transport.h"
+#include "service_identifier.h"
+#include "session_controller.h"
+#include "uds_receiver.h"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ServiceDispatcherTest);
+
+namespace
+{
+
+const string ECU_IDENT = "Main";
+const string LUA_SCRIPT = "tests/dispatcher_config_dir/dispatcher.lua";
+
+/// one ECU, reachable over CAN and DoIP
+struct FrontEnds
+{
+    FrontEnds()
+    : script(ECU_IDENT, LUA_SCRIPT)
+    , receiver(script.getRequestId(), script.getResponseId(), &script, &transport, &sessionControl)
+    , doip(&script)
+    {
+    }
+
+    /// @return the response over CAN, empty if nothing is sent
+    vector<uint8_t> requestCan(const vector<uint8_t>& request)
+    {
+        transport.clear();
+        receiver.proceedReceivedData(request.data(), request.size());
+        vector<uint8_t> response;
+        if (transport.getResponseCount() > 0)
+        {
+            transport.copyResponse(response);
+        }
+        return response;
+    }
+
+    /// @return the response over DoIP, empty if nothing is sent
+    vector<uint8_t> requestDoIP(const vector<uint8_t>& request)
+    {
+        doip.proceedDoIPData(request.data(), request.size(), doipResponse);
+        const vector<uint8_t> response(doipResponse.data, doipResponse.data + doipResponse.size);
+        doipResponse.pRequestMatcher.reset();
+        return response;
+    }
+
+    EcuLuaScript script;
+    LoopbackTransport transport;
+    SessionController sessionControl;
+    UdsReceiver receiver;
+    DoIPSimulator doip;
+    DoIPResponse doipResponse;
+};
+
+}
+
+void ServiceDispatcherTest::setUp()
+{
+}
+
+void ServiceDispatcherTest::tearDown()
+{
+}
+
+/**
+ * A sequence of requests gets the same responses over CAN and over DoIP,
+ * incl. the session, the tables of the session and the allowed services.
+ */
+void ServiceDispatcherTest::testSameResponses()
+{
+    FrontEnds ecu;
+    const vector<vector<uint8_t>> requests = {
+        {0x22, 0xF1, 0x90},
+        {0x22, 0xF1, 0x86},
+        {0x22, 0xF1, 0x91},
+        {0x31, 0x01, 0xFF, 0x00},
+        {0x10, 0x03},
+        {0x22, 0xF1, 0x86},
+        {0x31, 0x01, 0xFF, 0x00},
+        {0x3E, 0x00},
+        {0x3E, 0x80},
+        {0x3E, 0x01},
+        {0x2C, 0x01, 0xF3, 0x00, 0xF1, 0x90, 0x01, 0x02},
+        {0x22, 0xF3, 0x00},
+        {0x86, 0x04},
+        {0x10, 0x60},
+        {0x22, 0xF1, 0x90},
+        {0x2E, 0xF1, 0x90, 0x01},
+        {0x10, 0x81},
+        {0x22, 0xF3, 0x00},
+        {0x10, 0x05},
+        {0xBA, 0x01}
+    };
+    for (const vector<uint8_t>& request : requests)
+    {
+        const vector<uint8_t> canResponse = ecu.requestCan(request);
+        const vector<uint8_t> doipResponse = ecu.requestDoIP(request);
+        CPPUNIT_ASSERT(canResponse == doipResponse);
+    }
+    CPPUNIT_ASSERT(ecu.sessionControl.getCurrentUdsSession() == UdsSession::DEFAULT);
+}
+
+/**
+ * Each front-end has a session of its own: a session started over CAN does
+ * not change the tables and the allowed services over DoIP.
+ */
+void ServiceDispatcherTest::testSeparateSessions()
+{
+    FrontEnds ecu;
+    const vector<uint8_t> extendedSession = {DIAGNOSTIC_SESSION_CONTROL_REQ, 0x03};
+    const vector<uint8_t> readIdentifier = {READ_DATA_BY_IDENTIFIER_REQ, 0xF1, 0x86};
+
+    const vector<uint8_t> sessionResponse = ecu.requestDoIP(extendedSession);
+    CPPUNIT_ASSERT(!sessionResponse.empty());
+    CPPUNIT_ASSERT_EQUAL(DIAGNOSTIC_SESSION_CONTROL_RES, sessionResponse[0]);
+    const vector<uint8_t> extendedIdentifier = {READ_DATA_BY_IDENTIFIER_RES, 0xF1, 0x86, 0x03};
+    CPPUNIT_ASSERT(extendedIdentifier == ecu.requestDoIP(readIdentifier));
+    const vector<uint8_t> defaultIdentifier = {READ_DATA_BY_IDENTIFIER_RES, 0xF1, 0x86, 0x01};
+    CPPUNIT_ASSERT(defaultIdentifier == ecu.requestCan(readIdentifier));
+
+    // the session 0x60 does not allow WriteDataByIdentifier
+    const vector<uint8_t> customSession = {DIAGNOSTIC_SESSION_CONTROL_REQ, 0x60};
+    const vector<uint8_t> writeIdentifier = {WRITE_DATA_BY_IDENTIFIER_REQ, 0xF1, 0x86, 0x02};
+    CPPUNIT_ASSERT(!ecu.requestCan(customSession).empty());
+    const vector<uint8_t> notAllowed = {ERROR, WRITE_DATA_BY_IDENTIFIER_REQ, SERVICE_NOT_SUPPORTED_IN_ACTIVE_SESSION};
+    CPPUNIT_ASSERT(notAllowed == ecu.requestCan(writeIdentifier));
+    const vector<uint8_t> written = ecu.requestDoIP(writeIdentifier);
+    CPPUNIT_ASSERT(!written.empty());
+    CPPUNIT_ASSERT_EQUAL(WRITE_DATA_BY_IDENTIFIER_RES, written[0]);
+}
@@ -0,0 +1,32 @@
+/**
+ * @file service_dispatcher_test.h
+ *
+ */
+
+#ifndef SERVICE_DISPATCHER_TEST_H
+#define SERVICE_DISPATCHER_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class ServiceDispatcherTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(ServiceDispatcherTest);
+
+    CPPUNIT_TEST(testSameResponses);
+    CPPUNIT_TEST(testSeparateSessions);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    ServiceDispatcherTest() = default;
+    virtual ~ServiceDispatcherTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testSameResponses();
+    void testSeparateSessions();
+
+};
+
+#endif /* SERVICE_DISPATCHER_TEST_H */
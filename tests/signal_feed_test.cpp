@@ -0,0 +1,188 @@
+/**
+ * @file signal_feed_test.cpp
+ *
+ * Unit test for the external feed of the vehicle signals.
+ */
+
+#include "signal_feed_test.h"
+#include "signal_feed.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SignalFeedTest);
+
+namespace
+{
+
+const string SHARED_MEMORY = "/carsim-signal-feed-test-" + to_string(getpid());
+
+/// writes a frame into the shared memory like a plant model
+class FeedWriter
+{
+public:
+    FeedWriter()
+    {
+        const int fd = shm_open(SHARED_MEMORY.c_str(), O_RDWR, 0);
+        CPPUNIT_ASSERT(fd >= 0);
+        struct stat status = {};
+        fstat(fd, &status);
+        size_ = size_t(status.st_size);
+        pMemory_ = static_cast<char*> (mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+        close(fd);
+        CPPUNIT_ASSERT(pMemory_ != MAP_FAILED);
+    }
+
+    ~FeedWriter()
+    {
+        munmap(pMemory_, size_);
+    }
+
+    SignalFeedHeader& header() { return *reinterpret_cast<SignalFeedHeader*> (pMemory_); }
+
+    void write(const vector<string>& names, const vector<double>& values, bool isNewLayout)
+    {
+        SignalFeedHeader& h = header();
+        h.sequence.fetch_add(1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        if (isNewLayout)
+        {
+            for (size_t slot = 0; slot < names.size(); ++slot)
+            {
+                strncpy(pMemory_ + h.namesOffset + slot * h.nameSize, names[slot].c_str(), h.nameSize);
+            }
+            h.count.store(uint32_t(names.size()), memory_order_relaxed);
+            h.layout.fetch_add(1, memory_order_relaxed);
+        }
+        memcpy(pMemory_ + h.valuesOffset, values.data(), values.size() * sizeof(double));
+        h.sequence.fetch_add(1, memory_order_release);
+    }
+
+private:
+    char *pMemory_;
+    size_t size_;
+};
+
+double getSignal(const char *name)
+{
+    return VehicleSignals::getInstance().get(*VehicleSignals::getInstance().findSignal(name));
+}
+
+void appendEntry(vector<uint8_t>& datagram, const string& name, double value)
+{
+    datagram.push_back(uint8_t(name.size()));
+    datagram.insert(datagram.end(), name.begin(), name.end());
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for (size_t byte = 0; byte < sizeof(bits); ++byte)
+    {
+        datagram.push_back(uint8_t(bits >> (8 * byte)));
+    }
+}
+
+vector<uint8_t> datagramHeader(uint16_t count)
+{
+    return {'C', 'S', 'F', '1', uint8_t(count), uint8_t(count >> 8)};
+}
+
+} // namespace
+
+void SignalFeedTest::setUp() { }
+
+void SignalFeedTest::tearDown()
+{
+    shm_unlink(SHARED_MEMORY.c_str());
+}
+
+void SignalFeedTest::testSharedMemory()
+{
+    SignalFeed feed;
+    CPPUNIT_ASSERT_EQUAL(0, feed.openSharedMemory(SHARED_MEMORY, 16));
+    FeedWriter writer;
+    CPPUNIT_ASSERT_EQUAL(SIGNAL_FEED_MAGIC, writer.header().magic);
+    CPPUNIT_ASSERT_EQUAL(16u, writer.header().capacity);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), feed.poll());
+
+    const uint64_t generation = VehicleSignals::getInstance().getGeneration();
+    writer.write({"FeedSpeed", "FeedRpm"}, {50.0, 2000.0}, true);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), feed.poll());
+    CPPUNIT_ASSERT_EQUAL(generation + 1, VehicleSignals::getInstance().getGeneration());
+    CPPUNIT_ASSERT_EQUAL(50.0, getSignal("FeedSpeed"));
+    CPPUNIT_ASSERT_EQUAL(2000.0, getSignal("FeedRpm"));
+
+    // no new frame, then only the changed value
+    CPPUNIT_ASSERT_EQUAL(size_t(0), feed.poll());
+    writer.write({}, {50.0, 2500.0}, false);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), feed.poll());
+    CPPUNIT_ASSERT_EQUAL(2500.0, getSignal("FeedRpm"));
+
+    // a frame being written is not read
+    writer.header().sequence.fetch_add(1);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), feed.poll());
+    writer.header().sequence.fetch_add(1);
+}
+
+void SignalFeedTest::testLayoutChange()
+{
+    SignalFeed feed;
+    CPPUNIT_ASSERT_EQUAL(0, feed.openSharedMemory(SHARED_MEMORY, 16));
+    FeedWriter writer;
+    writer.write({"FeedLayoutA", "FeedLayoutB"}, {1.0, 2.0}, true);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), feed.poll());
+
+    // the same values in other slots are published again
+    writer.write({"FeedLayoutB", "FeedLayoutA", "FeedLayoutC"}, {1.0, 2.0, 3.0}, true);
+    CPPUNIT_ASSERT_EQUAL(size_t(3), feed.poll());
+    CPPUNIT_ASSERT_EQUAL(2.0, getSignal("FeedLayoutA"));
+    CPPUNIT_ASSERT_EQUAL(1.0, getSignal("FeedLayoutB"));
+    CPPUNIT_ASSERT_EQUAL(3.0, getSignal("FeedLayoutC"));
+
+    // an existing shared memory keeps its capacity
+    SignalFeed other;
+    CPPUNIT_ASSERT_EQUAL(0, other.openSharedMemory(SHARED_MEMORY, 256));
+    CPPUNIT_ASSERT_EQUAL(16u, writer.header().capacity);
+    CPPUNIT_ASSERT_EQUAL(size_t(3), other.poll());
+}
+
+void SignalFeedTest::testDecodeDatagram()
+{
+    vector<pair<string_view, double>> values;
+    vector<uint8_t> datagram = datagramHeader(2);
+    appendEntry(datagram, "Speed", 88.5);
+    appendEntry(datagram, "Rpm", -1.0);
+    CPPUNIT_ASSERT(SignalFeed::decodeDatagram(datagram.data(), datagram.size(), values));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), values.size());
+    CPPUNIT_ASSERT(values[0].first == "Speed");
+    CPPUNIT_ASSERT_EQUAL(88.5, values[0].second);
+    CPPUNIT_ASSERT(values[1].first == "Rpm");
+    CPPUNIT_ASSERT_EQUAL(-1.0, values[1].second);
+
+    // truncated, trailing bytes, wrong magic
+    CPPUNIT_ASSERT(!SignalFeed::decodeDatagram(datagram.data(), datagram.size() - 1, values));
+    datagram.push_back(0);
+    CPPUNIT_ASSERT(!SignalFeed::decodeDatagram(datagram.data(), datagram.size(), values));
+    datagram.pop_back();
+    datagram[3] = '2';
+    CPPUNIT_ASSERT(!SignalFeed::decodeDatagram(datagram.data(), datagram.size(), values));
+}
+
+void SignalFeedTest::testReceive()
+{
+    SignalFeed feed;
+    vector<uint8_t> datagram = datagramHeader(2);
+    appendEntry(datagram, "FeedUdpSpeed", 12.0);
+    appendEntry(datagram, "FeedUdpRpm", 800.0);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), feed.receive(datagram.data(), datagram.size()));
+    CPPUNIT_ASSERT_EQUAL(12.0, getSignal("FeedUdpSpeed"));
+    CPPUNIT_ASSERT_EQUAL(800.0, getSignal("FeedUdpRpm"));
+
+    CPPUNIT_ASSERT_EQUAL(size_t(0), feed.receive(datagram.data(), 5));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), feed.getDroppedDatagrams());
+}
@@ -0,0 +1,36 @@
+/**
+ * @file signal_feed_test.h
+ *
+ */
+
+#ifndef SIGNAL_FEED_TEST_H
+#define SIGNAL_FEED_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class SignalFeedTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(SignalFeedTest);
+
+    CPPUNIT_TEST(testSharedMemory);
+    CPPUNIT_TEST(testLayoutChange);
+    CPPUNIT_TEST(testDecodeDatagram);
+    CPPUNIT_TEST(testReceive);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    SignalFeedTest() = default;
+    virtual ~SignalFeedTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testSharedMemory();
+    void testLayoutChange();
+    void testDecodeDatagram();
+    void testReceive();
+
+};
+
+#endif /* SIGNAL_FEED_TEST_H */
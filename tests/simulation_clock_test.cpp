@@ -0,0 +1,124 @@
+/**
+ * @file simulation_clock_test.cpp
+ *
+ * Unit test for the simulation clock. The timings are chosen generously, so
+ * the tests also pass on a busy machine.
+ */
+
+#include "simulation_clock_test.h"
+#include "simulation_clock.h"
+#include "timer_wheel.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SimulationClockTest);
+
+void SimulationClockTest::setUp() { }
+
+void SimulationClockTest::tearDown()
+{
+    SimulationClock::getInstance().configure(1.0, false);
+}
+
+void SimulationClockTest::testRealTime()
+{
+    SimulationClock& clock = SimulationClock::getInstance();
+    CPPUNIT_ASSERT_EQUAL(true, clock.isRealTime());
+    const auto difference = clock.now() - steady_clock::now();
+    CPPUNIT_ASSERT(difference < milliseconds(1) && difference > milliseconds(-1));
+}
+
+void SimulationClockTest::testTimeScale()
+{
+    SimulationClock& clock = SimulationClock::getInstance();
+    clock.configure(10.0, false);
+    CPPUNIT_ASSERT_EQUAL(false, clock.isRealTime());
+
+    const auto begin = steady_clock::now();
+    const auto simulatedBegin = clock.now();
+    clock.sleepFor(seconds(2));
+    const auto elapsed = steady_clock::now() - begin;
+    CPPUNIT_ASSERT(clock.now() - simulatedBegin >= seconds(2));
+    CPPUNIT_ASSERT(elapsed >= milliseconds(190));
+    CPPUNIT_ASSERT(elapsed < milliseconds(1000));
+}
+
+void SimulationClockTest::testVirtualTime()
+{
+    SimulationClock& clock = SimulationClock::getInstance();
+    clock.configure(1.0, true);
+    TimerWheel wheel;
+    std::atomic<int> fired{0};
+    TimerWheel::Timer timer(wheel, [&fired]() { fired++; });
+
+    // an hour passes within a second, since nothing else happens
+    const auto begin = steady_clock::now();
+    timer.schedule(hours(1));
+    while (fired == 0 && steady_clock::now() - begin < seconds(2))
+    {
+        std::this_thread::sleep_for(milliseconds(10));
+    }
+    CPPUNIT_ASSERT_EQUAL(1, fired.load());
+
+    const auto simulatedBegin = clock.now();
+    clock.sleepFor(minutes(10));
+    CPPUNIT_ASSERT(clock.now() - simulatedBegin >= minutes(10));
+    CPPUNIT_ASSERT(steady_clock::now() - begin < seconds(2));
+}
+
+void SimulationClockTest::testVirtualTimeOrder()
+{
+    SimulationClock::getInstance().configure(1.0, true);
+    TimerWheel wheel;
+    std::mutex mutex;
+    std::vector<int> order;
+    auto record = [&mutex, &order](int value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(value);
+    };
+    TimerWheel::Timer timer1(wheel, [&record]() { record(1); });
+    TimerWheel::Timer timer2(wheel, [&record]() { record(2); });
+    TimerWheel::Timer timer3(wheel, [&record]() { record(3); });
+
+    timer3.schedule(seconds(30));
+    timer1.schedule(seconds(10));
+    timer2.schedule(seconds(20));
+    const auto begin = steady_clock::now();
+    while (timer3.isArmed() && steady_clock::now() - begin < seconds(2))
+    {
+        std::this_thread::sleep_for(milliseconds(10));
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), order.size());
+    CPPUNIT_ASSERT_EQUAL(1, order[0]);
+    CPPUNIT_ASSERT_EQUAL(2, order[1]);
+    CPPUNIT_ASSERT_EQUAL(3, order[2]);
+}
+
+void SimulationClockTest::testActivity()
+{
+    SimulationClock& clock = SimulationClock::getInstance();
+    clock.configure(1.0, true);
+    TimerWheel wheel;
+    std::atomic<int> fired{0};
+    TimerWheel::Timer timer(wheel, [&fired]() { fired++; });
+
+    {
+        SimulationClock::Activity activity;
+        timer.schedule(seconds(10));
+        std::this_thread::sleep_for(milliseconds(100));
+        // busy, so the time passes as usual
+        CPPUNIT_ASSERT_EQUAL(0, fired.load());
+    }
+    const auto begin = steady_clock::now();
+    while (fired == 0 && steady_clock::now() - begin < seconds(2))
+    {
+        std::this_thread::sleep_for(milliseconds(10));
+    }
+    CPPUNIT_ASSERT_EQUAL(1, fired.load());
+}
@@ -0,0 +1,39 @@
+/**
+ * @file simulation_clock_test.h
+ *
+ */
+
+#ifndef SIMULATION_CLOCK_TEST_H
+#define SIMULATION_CLOCK_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class SimulationClockTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(SimulationClockTest);
+
+    CPPUNIT_TEST(testRealTime);
+    CPPUNIT_TEST(testTimeScale);
+    CPPUNIT_TEST(testVirtualTime);
+    CPPUNIT_TEST(testVirtualTimeOrder);
+    CPPUNIT_TEST(testActivity);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    SimulationClockTest() = default;
+    virtual ~SimulationClockTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testRealTime();
+    void testTimeScale();
+    void testVirtualTime();
+    void testVirtualTimeOrder();
+    void testActivity();
+
+};
+
+#endif /* SIMULATION_CLOCK_TEST_H */
+
@@ -0,0 +1,142 @@
+/**
+ * @file spsc_queue_test.cpp
+ *
+ * Unit test for the single producer / single consumer queue.
+ */
+
+#include "spsc_queue_test.h"
+#include "spsc_queue.h"
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SpscQueueTest);
+
+void SpscQueueTest::setUp() { }
+
+void SpscQueueTest::tearDown() { }
+
+void SpscQueueTest::testFullQueue()
+{
+    SpscQueue<int, 4> queue;
+    CPPUNIT_ASSERT_EQUAL(std::size_t(4), queue.capacity());
+    CPPUNIT_ASSERT(queue.empty());
+    CPPUNIT_ASSERT(queue.front() == nullptr);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        int* pSlot = queue.prepareBack();
+        CPPUNIT_ASSERT(pSlot != nullptr);
+        *pSlot = i;
+        queue.commitBack();
+        CPPUNIT_ASSERT_EQUAL(std::size_t(i + 1), queue.size());
+    }
+    // all slots are used, nothing is overwritten
+    CPPUNIT_ASSERT(queue.prepareBack() == nullptr);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(4), queue.size());
+    CPPUNIT_ASSERT_EQUAL(0, *queue.front());
+
+    // a released slot can be filled again
+    queue.pop();
+    int* pSlot = queue.prepareBack();
+    CPPUNIT_ASSERT(pSlot != nullptr);
+    *pSlot = 4;
+    queue.commitBack();
+    CPPUNIT_ASSERT(queue.prepareBack() == nullptr);
+
+    for (int i = 1; i <= 4; ++i)
+    {
+        CPPUNIT_ASSERT_EQUAL(i, *queue.front());
+        queue.pop();
+    }
+    CPPUNIT_ASSERT(queue.empty());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), queue.size());
+}
+
+void SpscQueueTest::testWraparound()
+{
+    SpscQueue<int, 3> queue;
+    int next = 0;
+    int expected = 0;
+
+    // the indices pass the end of the slots several times, with 0 to 3 queued elements
+    for (int round = 0; round < 20; ++round)
+    {
+        const int count = round % 4;
+        for (int i = 0; i < count; ++i)
+        {
+            int* pSlot = queue.prepareBack();
+            CPPUNIT_ASSERT(pSlot != nullptr);
+            *pSlot = next++;
+            queue.commitBack();
+        }
+        CPPUNIT_ASSERT_EQUAL(std::size_t(count), queue.size());
+        for (int i = 0; i < count; ++i)
+        {
+            CPPUNIT_ASSERT_EQUAL(expected++, *queue.front());
+            queue.pop();
+        }
+        CPPUNIT_ASSERT(queue.empty());
+    }
+    CPPUNIT_ASSERT_EQUAL(next, expected);
+}
+
+/**
+ * A producer which does not wait for the consumer drops the elements of a
+ * full queue. The consumer gets all other elements in order.
+ */
+void SpscQueueTest::testDroppedElements()
+{
+    constexpr std::uint32_t COUNT = 100000;
+    SpscQueue<std::uint32_t, 8> queue;
+    std::uint32_t dropped = 0;
+    std::vector<std::uint32_t> received;
+    received.reserve(COUNT);
+
+    std::thread producer([&queue, &dropped]() {
+        for (std::uint32_t i = 0; i < COUNT; ++i)
+        {
+            std::uint32_t* pSlot = queue.prepareBack();
+            if (pSlot == nullptr)
+            {
+                dropped++;
+                continue;
+            }
+            *pSlot = i;
+            queue.commitBack();
+        }
+        // the end marker is never dropped
+        std::uint32_t* pSlot;
+        while ((pSlot = queue.prepareBack()) == nullptr)
+        {
+            std::this_thread::yield();
+        }
+        *pSlot = COUNT;
+        queue.commitBack();
+    });
+
+    for (;;)
+    {
+        const std::uint32_t* pValue = queue.front();
+        if (pValue == nullptr)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        const std::uint32_t value = *pValue;
+        queue.pop();
+        if (value == COUNT)
+        {
+            break;
+        }
+        received.push_back(value);
+    }
+    producer.join();
+
+    CPPUNIT_ASSERT(queue.empty());
+    CPPUNIT_ASSERT_EQUAL(COUNT, std::uint32_t(received.size()) + dropped);
+    for (std::size_t i = 1; i < received.size(); ++i)
+    {
+        CPPUNIT_ASSERT(received[i - 1] < received[i]);
+    }
+}
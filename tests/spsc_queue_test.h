@@ -0,0 +1,35 @@
+/**
+ * @file spsc_queue_test.h
+ *
+ */
+
+#ifndef SPSC_QUEUE_TEST_H
+#define SPSC_QUEUE_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class SpscQueueTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(SpscQueueTest);
+
+    CPPUNIT_TEST(testFullQueue);
+    CPPUNIT_TEST(testWraparound);
+    CPPUNIT_TEST(testDroppedElements);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    SpscQueueTest() = default;
+    virtual ~SpscQueueTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testFullQueue();
+    void testWraparound();
+    void testDroppedElements();
+
+};
+
+#endif /* SPSC_QUEUE_TEST_H */
+
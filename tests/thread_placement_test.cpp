@@ -0,0 +1,80 @@
+/**
+ * @file thread_placement_test.cpp
+ *
+ * Unit test for the placement of the threads. Each test runs the placement in
+ * a thread of its own, so the test runner keeps its CPUs.
+ */
+
+#include "thread_placement_test.h"
+#include "thread_placement.h"
+#include <pthread.h>
+#include <sched.h>
+#include <thread>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ThreadPlacementTest);
+
+void ThreadPlacementTest::setUp() { }
+
+void ThreadPlacementTest::tearDown() { }
+
+void ThreadPlacementTest::testUnconfiguredRole()
+{
+    ThreadPlacement placement;
+    CPPUNIT_ASSERT(placement.getConfiguration(ThreadRole::LUA).cpus.empty());
+    CPPUNIT_ASSERT_EQUAL(0, placement.getConfiguration(ThreadRole::LUA).priority);
+
+    bool isApplied = false;
+    int policy = -1;
+    thread([&placement, &isApplied, &policy]()
+    {
+        isApplied = placement.apply(ThreadRole::LUA);
+        struct sched_param parameter;
+        pthread_getschedparam(pthread_self(), &policy, &parameter);
+    }).join();
+    CPPUNIT_ASSERT(isApplied);
+    CPPUNIT_ASSERT_EQUAL(SCHED_OTHER, policy);
+}
+
+void ThreadPlacementTest::testCpuAffinity()
+{
+    // one of the CPUs the test may run on
+    cpu_set_t allowed;
+    CPPUNIT_ASSERT_EQUAL(0, sched_getaffinity(0, sizeof(allowed), &allowed));
+    int cpu = 0;
+    while (!CPU_ISSET(cpu, &allowed))
+    {
+        ++cpu;
+    }
+
+    ThreadPlacement placement;
+    placement.configure(ThreadRole::IO, {{cpu}, 0});
+    bool isApplied = false;
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    thread([&placement, &isApplied, &cpus]()
+    {
+        isApplied = placement.apply(ThreadRole::IO);
+        sched_getaffinity(0, sizeof(cpus), &cpus);
+    }).join();
+    CPPUNIT_ASSERT(isApplied);
+    CPPUNIT_ASSERT_EQUAL(1, CPU_COUNT(&cpus));
+    CPPUNIT_ASSERT(CPU_ISSET(cpu, &cpus));
+}
+
+void ThreadPlacementTest::testPriorityFailure()
+{
+    ThreadPlacement placement;
+    placement.configure(ThreadRole::IO, {{}, 50});
+    bool isApplied = false;
+    int policy = -1;
+    thread([&placement, &isApplied, &policy]()
+    {
+        isApplied = placement.apply(ThreadRole::IO);
+        struct sched_param parameter;
+        pthread_getschedparam(pthread_self(), &policy, &parameter);
+    }).join();
+    // without CAP_SYS_NICE the thread keeps running with the normal scheduler
+    CPPUNIT_ASSERT_EQUAL(isApplied ? SCHED_FIFO : SCHED_OTHER, policy);
+}
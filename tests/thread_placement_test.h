@@ -0,0 +1,34 @@
+/**
+ * @file thread_placement_test.h
+ *
+ */
+
+#ifndef THREAD_PLACEMENT_TEST_H
+#define THREAD_PLACEMENT_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class ThreadPlacementTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(ThreadPlacementTest);
+
+    CPPUNIT_TEST(testUnconfiguredRole);
+    CPPUNIT_TEST(testCpuAffinity);
+    CPPUNIT_TEST(testPriorityFailure);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    ThreadPlacementTest() = default;
+    virtual ~ThreadPlacementTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testUnconfiguredRole();
+    void testCpuAffinity();
+    void testPriorityFailure();
+
+};
+
+#endif /* THREAD_PLACEMENT_TEST_H */
@@ -0,0 +1,77 @@
+/**
+ * @file thread_pool_test.cpp
+ *
+ * Unit test for the thread pool loading the configurations at startup.
+ */
+
+#include "thread_pool_test.h"
+#include "thread_pool.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ThreadPoolTest);
+
+void ThreadPoolTest::setUp() { }
+
+void ThreadPoolTest::tearDown() { }
+
+void ThreadPoolTest::testAllTasksRun()
+{
+    ThreadPool pool(3);
+    CPPUNIT_ASSERT_EQUAL(3u, pool.getThreadCount());
+
+    atomic<int> count{0};
+    for (int i = 0; i < 100; ++i)
+    {
+        pool.submit([&count]() { ++count; });
+    }
+    pool.wait();
+    CPPUNIT_ASSERT_EQUAL(100, count.load());
+
+    // the pool can be reused after waiting
+    pool.submit([&count]() { ++count; });
+    pool.wait();
+    CPPUNIT_ASSERT_EQUAL(101, count.load());
+
+    CPPUNIT_ASSERT(ThreadPool(0).getThreadCount() >= 1);
+}
+
+void ThreadPoolTest::testTasksRunInParallel()
+{
+    // both tasks wait for each other, so they only finish if they run at the same time
+    ThreadPool pool(2);
+    mutex m;
+    condition_variable started;
+    int running = 0;
+    atomic<int> finished{0};
+    for (int i = 0; i < 2; ++i)
+    {
+        pool.submit([&]()
+        {
+            unique_lock<mutex> lock(m);
+            ++running;
+            started.notify_all();
+            if (started.wait_for(lock, chrono::seconds(5), [&running]() { return running == 2; }))
+            {
+                ++finished;
+            }
+        });
+    }
+    pool.wait();
+    CPPUNIT_ASSERT_EQUAL(2, finished.load());
+}
+
+void ThreadPoolTest::testExceptionDoesNotStopPool()
+{
+    ThreadPool pool(1);
+    atomic<int> count{0};
+    pool.submit([]() { throw runtime_error("invalid config"); });
+    pool.submit([&count]() { ++count; });
+    pool.wait();
+    CPPUNIT_ASSERT_EQUAL(1, count.load());
+}
@@ -0,0 +1,34 @@
+/**
+ * @file thread_pool_test.h
+ *
+ */
+
+#ifndef THREAD_POOL_TEST_H
+#define THREAD_POOL_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class ThreadPoolTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(ThreadPoolTest);
+
+    CPPUNIT_TEST(testAllTasksRun);
+    CPPUNIT_TEST(testTasksRunInParallel);
+    CPPUNIT_TEST(testExceptionDoesNotStopPool);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    ThreadPoolTest() = default;
+    virtual ~ThreadPoolTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testAllTasksRun();
+    void testTasksRunInParallel();
+    void testExceptionDoesNotStopPool();
+
+};
+
+#endif /* THREAD_POOL_TEST_H */
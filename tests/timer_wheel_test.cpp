@@ -0,0 +1,144 @@
+/**
+ * @file timer_wheel_test.cpp
+ *
+ * Unit test for the timer wheel. The timings are chosen generously, so the
+ * tests also pass on a busy machine.
+ */
+
+#include "timer_wheel_test.h"
+#include "timer_wheel.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TimerWheelTest);
+
+void TimerWheelTest::setUp() { }
+
+void TimerWheelTest::tearDown() { }
+
+void TimerWheelTest::testExpire()
+{
+    TimerWheel wheel;
+    std::atomic<int> fired{0};
+    TimerWheel::Timer timer(wheel, [&fired]() { fired++; });
+
+    timer.schedule(milliseconds(20));
+    CPPUNIT_ASSERT_EQUAL(true, timer.isArmed());
+    std::this_thread::sleep_for(milliseconds(200));
+    CPPUNIT_ASSERT_EQUAL(1, fired.load());
+    CPPUNIT_ASSERT_EQUAL(false, timer.isArmed());
+}
+
+void TimerWheelTest::testPostpone()
+{
+    TimerWheel wheel;
+    std::atomic<int> fired{0};
+    TimerWheel::Timer timer(wheel, [&fired]() { fired++; });
+
+    timer.schedule(milliseconds(100));
+    for (int i = 0; i < 5; ++i)
+    {
+        std::this_thread::sleep_for(milliseconds(50));
+        timer.postpone(milliseconds(100));
+    }
+    // 250 ms passed, but the deadline was moved
+    CPPUNIT_ASSERT_EQUAL(0, fired.load());
+    std::this_thread::sleep_for(milliseconds(300));
+    CPPUNIT_ASSERT_EQUAL(1, fired.load());
+}
+
+void TimerWheelTest::testCancel()
+{
+    TimerWheel wheel;
+    std::atomic<int> fired{0};
+    TimerWheel::Timer timer(wheel, [&fired]() { fired++; });
+
+    timer.schedule(milliseconds(50));
+    timer.cancel();
+    CPPUNIT_ASSERT_EQUAL(false, timer.isArmed());
+    std::this_thread::sleep_for(milliseconds(150));
+    CPPUNIT_ASSERT_EQUAL(0, fired.load());
+
+    // postponing a cancelled timer must not arm it again
+    timer.postpone(milliseconds(10));
+    std::this_thread::sleep_for(milliseconds(100));
+    CPPUNIT_ASSERT_EQUAL(0, fired.load());
+}
+
+void TimerWheelTest::testLongerThanRevolution()
+{
+    TimerWheel wheel(milliseconds(1), 16);
+    std::atomic<int> fired{0};
+    TimerWheel::Timer timer(wheel, [&fired]() { fired++; });
+
+    timer.schedule(milliseconds(200));
+    std::this_thread::sleep_for(milliseconds(100));
+    CPPUNIT_ASSERT_EQUAL(0, fired.load());
+    std::this_thread::sleep_for(milliseconds(300));
+    CPPUNIT_ASSERT_EQUAL(1, fired.load());
+}
+
+/**
+ * The timers fire in the order of their deadlines, not in the order they
+ * were scheduled, also across a revolution of the wheel.
+ */
+void TimerWheelTest::testOrder()
+{
+    TimerWheel wheel(milliseconds(1), 64);
+    std::mutex mutex;
+    std::vector<int> order;
+    const std::vector<int> delays = {90, 10, 150, 40, 70, 20};
+    std::vector<std::unique_ptr<TimerWheel::Timer>> timers;
+    for (int delay : delays)
+    {
+        timers.push_back(std::make_unique<TimerWheel::Timer>(wheel, [&mutex, &order, delay]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(delay);
+        }));
+    }
+    for (std::size_t i = 0; i < timers.size(); ++i)
+    {
+        timers[i]->schedule(milliseconds(delays[i]));
+    }
+    // postponed beyond the others
+    timers[1]->postpone(milliseconds(180));
+
+    std::this_thread::sleep_for(milliseconds(400));
+    std::lock_guard<std::mutex> lock(mutex);
+    const std::vector<int> expected = {20, 40, 70, 90, 150, 10};
+    CPPUNIT_ASSERT(expected == order);
+}
+
+/**
+ * Cancelling a timer does not affect the other timers of its slot.
+ */
+void TimerWheelTest::testCancelAmongOthers()
+{
+    TimerWheel wheel;
+    std::atomic<int> firedFirst{0};
+    std::atomic<int> firedSecond{0};
+    std::atomic<int> firedThird{0};
+    TimerWheel::Timer first(wheel, [&firedFirst]() { firedFirst++; });
+    TimerWheel::Timer second(wheel, [&firedSecond]() { firedSecond++; });
+    TimerWheel::Timer third(wheel, [&firedThird]() { firedThird++; });
+
+    first.schedule(milliseconds(50));
+    second.schedule(milliseconds(50));
+    third.schedule(milliseconds(50));
+    second.cancel();
+    std::this_thread::sleep_for(milliseconds(200));
+    CPPUNIT_ASSERT_EQUAL(1, firedFirst.load());
+    CPPUNIT_ASSERT_EQUAL(0, firedSecond.load());
+    CPPUNIT_ASSERT_EQUAL(1, firedThird.load());
+
+    // a cancelled timer can be scheduled again
+    second.schedule(milliseconds(20));
+    std::this_thread::sleep_for(milliseconds(150));
+    CPPUNIT_ASSERT_EQUAL(1, firedSecond.load());
+    CPPUNIT_ASSERT_EQUAL(1, firedFirst.load());
+}
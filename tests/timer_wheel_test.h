@@ -0,0 +1,41 @@
+/**
+ * @file timer_wheel_test.h
+ *
+ */
+
+#ifndef TIMER_WHEEL_TEST_H
+#define TIMER_WHEEL_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class TimerWheelTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TimerWheelTest);
+
+    CPPUNIT_TEST(testExpire);
+    CPPUNIT_TEST(testPostpone);
+    CPPUNIT_TEST(testCancel);
+    CPPUNIT_TEST(testLongerThanRevolution);
+    CPPUNIT_TEST(testOrder);
+    CPPUNIT_TEST(testCancelAmongOthers);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    TimerWheelTest() = default;
+    virtual ~TimerWheelTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testExpire();
+    void testPostpone();
+    void testCancel();
+    void testLongerThanRevolution();
+    void testOrder();
+    void testCancelAmongOthers();
+
+};
+
+#endif /* TIMER_WHEEL_TEST_H */
+
@@ -0,0 +1,126 @@
+/**
+ * @file traffic_capture_test.cpp
+ *
+ * Unit test for the traffic capture and its candump export. The timestamps
+ * are not compared, only the interfaces, CAN IDs and data of the frames.
+ */
+
+#include "traffic_capture_test.h"
+#include "traffic_capture.h"
+#include <unistd.h>
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TrafficCaptureTest);
+
+/**
+ * @return the exported frames without the timestamps, one per line
+ */
+static vector<string> exportFrames(const string& captureFile, int& exported)
+{
+    ostringstream out;
+    exported = TrafficCapture::exportCandump(captureFile, out);
+    istringstream lines(out.str());
+    vector<string> frames;
+    string line;
+    while (getline(lines, line))
+    {
+        frames.push_back(line.substr(line.find(") ") + 2));
+    }
+    return frames;
+}
+
+void TrafficCaptureTest::setUp()
+{
+    captureFile_ = "/tmp/traffic_capture_test_" + to_string(getpid()) + ".cap";
+}
+
+void TrafficCaptureTest::tearDown()
+{
+    remove(captureFile_.c_str());
+}
+
+void TrafficCaptureTest::testExportUdsSingleFrame()
+{
+    TrafficCapture capture;
+    CPPUNIT_ASSERT_EQUAL(0, capture.open(captureFile_, 64 * 1024));
+    const uint8_t iface = capture.getInterfaceIndex("vcan0");
+    const uint8_t request[] = {0x22, 0xF1, 0x90};
+    capture.record(TrafficCapture::Protocol::UDS, TrafficCapture::Direction::RX,
+                   iface, 0x7E0, 0, 0, request, sizeof(request));
+    capture.close();
+
+    int exported;
+    const vector<string> frames = exportFrames(captureFile_, exported);
+    CPPUNIT_ASSERT_EQUAL(1, exported);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), frames.size());
+    CPPUNIT_ASSERT_EQUAL(string("vcan0 7E0#0322F190CCCCCCCC"), frames[0]);
+}
+
+void TrafficCaptureTest::testExportUdsMultiFrame()
+{
+    TrafficCapture capture;
+    CPPUNIT_ASSERT_EQUAL(0, capture.open(captureFile_, 64 * 1024));
+    const uint8_t iface = capture.getInterfaceIndex("vcan0");
+    const uint8_t response[] = {0x62, 0xF1, 0x90, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07};
+    capture.record(TrafficCapture::Protocol::UDS, TrafficCapture::Direction::TX,
+                   iface, 0x7E8, 0, 0, response, sizeof(response));
+    capture.close();
+
+    int exported;
+    const vector<string> frames = exportFrames(captureFile_, exported);
+    CPPUNIT_ASSERT_EQUAL(1, exported);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), frames.size());
+    CPPUNIT_ASSERT_EQUAL(string("vcan0 7E8#100A62F190010203"), frames[0]);
+    CPPUNIT_ASSERT_EQUAL(string("vcan0 7E8#2104050607CCCCCC"), frames[1]);
+}
+
+void TrafficCaptureTest::testExportJ1939Bam()
+{
+    TrafficCapture capture;
+    CPPUNIT_ASSERT_EQUAL(0, capture.open(captureFile_, 64 * 1024));
+    const uint8_t iface = capture.getInterfaceIndex("vcan1");
+    const uint8_t shortPayload[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+    capture.record(TrafficCapture::Protocol::J1939, TrafficCapture::Direction::TX,
+                   iface, 0xFEF1, 0x00, 0xFF, shortPayload, sizeof(shortPayload));
+    const uint8_t longPayload[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09};
+    capture.record(TrafficCapture::Protocol::J1939, TrafficCapture::Direction::TX,
+                   iface, 0xFEEC, 0x00, 0xFF, longPayload, sizeof(longPayload));
+    capture.close();
+
+    int exported;
+    const vector<string> frames = exportFrames(captureFile_, exported);
+    CPPUNIT_ASSERT_EQUAL(2, exported);
+    CPPUNIT_ASSERT_EQUAL(size_t(4), frames.size());
+    CPPUNIT_ASSERT_EQUAL(string("vcan1 18FEF100#0102030405060708"), frames[0]);
+    CPPUNIT_ASSERT_EQUAL(string("vcan1 18ECFF00#20090002FFECFE00"), frames[1]);
+    CPPUNIT_ASSERT_EQUAL(string("vcan1 18EBFF00#0101020304050607"), frames[2]);
+    CPPUNIT_ASSERT_EQUAL(string("vcan1 18EBFF00#020809FFFFFFFFFF"), frames[3]);
+}
+
+void TrafficCaptureTest::testOverwriteOldest()
+{
+    TrafficCapture capture;
+    CPPUNIT_ASSERT_EQUAL(0, capture.open(captureFile_, 64 * 1024));
+    const uint8_t iface = capture.getInterfaceIndex("vcan0");
+    // 48 bytes per record, so the ring is overwritten several times
+    for (uint32_t i = 0; i < 10000; ++i)
+    {
+        const uint8_t request[] = {0x3E, uint8_t(i)};
+        capture.record(TrafficCapture::Protocol::UDS, TrafficCapture::Direction::RX,
+                       iface, 0x7E0, 0, 0, request, sizeof(request));
+    }
+    capture.close();
+
+    int exported;
+    const vector<string> frames = exportFrames(captureFile_, exported);
+    CPPUNIT_ASSERT(exported > 1000);
+    CPPUNIT_ASSERT(exported < 10000);
+    CPPUNIT_ASSERT_EQUAL(size_t(exported), frames.size());
+    // the newest record is always complete
+    CPPUNIT_ASSERT_EQUAL(string("vcan0 7E0#023E0FCCCCCCCCCC"), frames.back());
+}
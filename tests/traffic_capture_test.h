@@ -0,0 +1,38 @@
+/**
+ * @file traffic_capture_test.h
+ *
+ */
+
+#ifndef TRAFFIC_CAPTURE_TEST_H
+#define TRAFFIC_CAPTURE_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+
+class TrafficCaptureTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TrafficCaptureTest);
+
+    CPPUNIT_TEST(testExportUdsSingleFrame);
+    CPPUNIT_TEST(testExportUdsMultiFrame);
+    CPPUNIT_TEST(testExportJ1939Bam);
+    CPPUNIT_TEST(testOverwriteOldest);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    TrafficCaptureTest() = default;
+    virtual ~TrafficCaptureTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testExportUdsSingleFrame();
+    void testExportUdsMultiFrame();
+    void testExportJ1939Bam();
+    void testOverwriteOldest();
+
+    std::string captureFile_;
+};
+
+#endif /* TRAFFIC_CAPTURE_TEST_H */
@@ -10,11 +10,14 @@
 
 #include "uds_receiver_test.h"
 #include "uds_receiver.h"
+#include "loopback_transport.h"
 #include "service_identifier.h"
 #include <thread>
 #include <unistd.h>
 #include <cstring>
 #include <iomanip>
+#include <cstdlib>
+#include <new>
 
 const std::string DEVICE = "vcan0";
 const std::string ECU_IDENT = "PCM";
@@ -22,6 +25,30 @@ const std::string LUA_SCRIPT = "tests/test_config_dir/testscript06.lua";
 
 CPPUNIT_TEST_SUITE_REGISTRATION(UdsReceiverTest);
 
+/// the heap allocations of the current thread, see `testStaticResponseAllocations()`
+static thread_local size_t allocationCount = 0;
+
+void* operator new(std::size_t size)
+{
+    ++allocationCount;
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
 UdsReceiverTest::UdsReceiverTest()
 {
 }
@@ -40,13 +67,13 @@ void UdsReceiverTest::tearDown()
 
 void UdsReceiverTest::testUdsReceiver()
 {
-    auto ecuScript = std::make_unique<EcuLuaScript>(ECU_IDENT, LUA_SCRIPT);
-    const uint16_t respId = ecuScript->getResponseId();
-    const uint16_t requId = ecuScript->getRequestId();
+    EcuLuaScript ecuScript(ECU_IDENT, LUA_SCRIPT);
+    const uint16_t respId = ecuScript.getResponseId();
+    const uint16_t requId = ecuScript.getRequestId();
     IsoTpSender sender(respId, requId, DEVICE);
     SessionController sesCtrl;
     UdsReceiver* udsReceiver;
-    CPPUNIT_ASSERT_NO_THROW(udsReceiver = new UdsReceiver(requId, respId, DEVICE, std::move(ecuScript), &sender, &sesCtrl));
+    CPPUNIT_ASSERT_NO_THROW(udsReceiver = new UdsReceiver(requId, respId, DEVICE, &ecuScript, &sender, &sesCtrl));
     delete udsReceiver;
 }
 
@@ -54,12 +81,12 @@ void UdsReceiverTest::testProceedReceivedData()
 {
     uint8_t* buffer;
     size_t num_bytes;
-    auto ecuScript = std::make_unique<EcuLuaScript>(ECU_IDENT, LUA_SCRIPT);
-    const uint16_t respId = ecuScript->getResponseId();
-    const uint16_t requId = ecuScript->getRequestId();
+    EcuLuaScript ecuScript(ECU_IDENT, LUA_SCRIPT);
+    const uint16_t respId = ecuScript.getResponseId();
+    const uint16_t requId = ecuScript.getRequestId();
     IsoTpSender sender(respId, requId, DEVICE);
     SessionController sesCtrl;
-    UdsReceiver udsReceiver(requId, respId, DEVICE, std::move(ecuScript), &sender, &sesCtrl);
+    UdsReceiver udsReceiver(requId, respId, DEVICE, &ecuScript, &sender, &sesCtrl);
     TestReceiver testReceiver(requId, respId, DEVICE);
     std::thread testThread(&IsoTpReceiver::readData, &testReceiver); // run async in thread
     usleep(4000); // wait some time to ensure the thread is set up and running
@@ -185,6 +212,66 @@ void UdsReceiverTest::testProceedReceivedData()
     testThread.join();
 }
 
+/**
+ * Static responses are sent without a single heap allocation, once the
+ * response arena and the lookup buffers of the thread are warmed up.
+ */
+void UdsReceiverTest::testStaticResponseAllocations()
+{
+    EcuLuaScript ecuScript(ECU_IDENT, LUA_SCRIPT);
+    const uint16_t respId = ecuScript.getResponseId();
+    const uint16_t requId = ecuScript.getRequestId();
+    IsoTpSender sender(respId, requId, DEVICE);
+    SessionController sesCtrl;
+    UdsReceiver udsReceiver(requId, respId, DEVICE, &ecuScript, &sender, &sesCtrl);
+
+    constexpr std::array<uint8_t, 2> rawRequest = {0x10, 0x02};
+    constexpr std::array<uint8_t, 5> readDataByIdRequest = {0x22, 0xf1, 0x90, 0x1e, 0x23};
+    constexpr std::array<uint8_t, 2> unsupportedRequest = {0x85, 0x01};
+    const auto proceedAll = [&]()
+    {
+        udsReceiver.proceedReceivedData(rawRequest.data(), rawRequest.size());
+        udsReceiver.proceedReceivedData(readDataByIdRequest.data(), readDataByIdRequest.size());
+        udsReceiver.proceedReceivedData(unsupportedRequest.data(), unsupportedRequest.size());
+    };
+
+    proceedAll(); // warm up
+    const size_t allocationsBefore = allocationCount;
+    for (int i = 0; i < 100; ++i)
+    {
+        proceedAll();
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(0), allocationCount - allocationsBefore);
+}
+
+/**
+ * A request with the suppressPosRspMsgIndicationBit is answered by the `Raw`
+ * entry of its sub-function, not by the native service, and its positive
+ * response is not sent.
+ */
+void UdsReceiverTest::testSuppressedRawRequest()
+{
+    EcuLuaScript ecuScript(ECU_IDENT, LUA_SCRIPT);
+    LoopbackTransport transport;
+    SessionController sesCtrl;
+    UdsReceiver udsReceiver(ecuScript.getRequestId(), ecuScript.getResponseId(), &ecuScript, &transport, &sesCtrl);
+
+    // the `Raw` entry `10 02` answers without switching the session
+    constexpr std::array<uint8_t, 2> suppressedRequest = {DIAGNOSTIC_SESSION_CONTROL_REQ, 0x82};
+    udsReceiver.proceedReceivedData(suppressedRequest.data(), suppressedRequest.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), transport.getResponseCount());
+    CPPUNIT_ASSERT(sesCtrl.getCurrentUdsSession() == UdsSession::DEFAULT);
+
+    constexpr std::array<uint8_t, 2> request = {DIAGNOSTIC_SESSION_CONTROL_REQ, 0x02};
+    udsReceiver.proceedReceivedData(request.data(), request.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), transport.getResponseCount());
+    std::vector<uint8_t> response;
+    transport.copyResponse(response);
+    const std::vector<uint8_t> expected = {0x50, 0x02, 0x00, 0x19, 0x01, 0xF4};
+    CPPUNIT_ASSERT(expected == response);
+    CPPUNIT_ASSERT(sesCtrl.getCurrentUdsSession() == UdsSession::DEFAULT);
+}
+
 void UdsReceiverTest::testGenerateSeed()
 {
     /* Testing a random number generator is somehow pointless. However, this is
@@ -8,8 +8,7 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 #include "isotp_receiver.h"
-
-constexpr size_t MAX_UDS_MSG_SIZE = 4096;
+#include "isotp_sender.h"
 
 /**
  * Simple test receiver class to mock a responding device. Only for testing.
@@ -45,6 +44,8 @@ class UdsReceiverTest : public CPPUNIT_NS::TestFixture
 
     CPPUNIT_TEST(testUdsReceiver);
     CPPUNIT_TEST(testProceedReceivedData);
+    CPPUNIT_TEST(testStaticResponseAllocations);
+    CPPUNIT_TEST(testSuppressedRawRequest);
     CPPUNIT_TEST(testGenerateSeed);
 
     CPPUNIT_TEST_SUITE_END();
@@ -58,6 +59,8 @@ public:
 private:
     void testUdsReceiver();
     void testProceedReceivedData();
+    void testStaticResponseAllocations();
+    void testSuppressedRawRequest();
     void testSetSessionController();
     void testGenerateSeed();
 
@@ -0,0 +1,216 @@
+/**
+ * @file uds_services_test.cpp
+ *
+ * Unit test for the natively implemented UDS services.
+ */
+
+#include "uds_services_test.h"
+#include "uds_services.h"
+#include "service_identifier.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(UdsServicesTest);
+
+static vector<uint8_t> proceed(UdsServices& services, const vector<uint8_t>& request)
+{
+    vector<uint8_t> response;
+    if (!services.proceedRequest(request.data(), request.size(), response))
+    {
+        response.clear();
+    }
+    return response;
+}
+
+void UdsServicesTest::setUp() { }
+
+void UdsServicesTest::tearDown() { }
+
+void UdsServicesTest::testDispatchTable()
+{
+    CPPUNIT_ASSERT(UdsServices::isNativeService(ECU_RESET_REQ));
+    CPPUNIT_ASSERT(UdsServices::isNativeService(CLEAR_DIAGNOSTIC_INFORMATION_REQ));
+    CPPUNIT_ASSERT(UdsServices::isNativeService(READ_DTC_INFORMATION_REQ));
+    CPPUNIT_ASSERT(UdsServices::isNativeService(WRITE_DATA_BY_IDENTIFIER_REQ));
+    CPPUNIT_ASSERT(UdsServices::isNativeService(ROUTINE_CONTROL_REQ));
+    CPPUNIT_ASSERT(UdsServices::isNativeService(COMMUNICATION_CONTROL_REQ));
+    CPPUNIT_ASSERT(UdsServices::isNativeService(CONTROL_DTC_SETTINGS_REQ));
+
+    // handled by the `UdsReceiver` itself
+    CPPUNIT_ASSERT(!UdsServices::isNativeService(READ_DATA_BY_IDENTIFIER_REQ));
+    CPPUNIT_ASSERT(!UdsServices::isNativeService(DIAGNOSTIC_SESSION_CONTROL_REQ));
+    CPPUNIT_ASSERT(!UdsServices::isNativeService(0xFF));
+
+    UdsServices services(nullptr);
+    CPPUNIT_ASSERT(proceed(services, {0xBA, 0x01}) == vector<uint8_t>({ERROR, 0xBA, SERVICE_NOT_SUPPORTED}));
+}
+
+void UdsServicesTest::testEcuReset()
+{
+    SessionController sessionCtrl;
+    sessionCtrl.setCurrentUdsSession(UdsSession::EXTENDED);
+    UdsServices services(&sessionCtrl);
+    proceed(services, {COMMUNICATION_CONTROL_REQ, 0x03, 0x01});
+
+    CPPUNIT_ASSERT(proceed(services, {ECU_RESET_REQ, 0x01}) == vector<uint8_t>({ECU_RESET_RES, 0x01}));
+    CPPUNIT_ASSERT_EQUAL(UdsSession::DEFAULT, sessionCtrl.getCurrentUdsSession());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), services.getEcuResetService().getResetCount());
+    CPPUNIT_ASSERT_EQUAL(CommunicationControlService::ENABLE_RX_AND_TX,
+                         services.getCommunicationControlService().getControlType());
+
+    CPPUNIT_ASSERT(proceed(services, {ECU_RESET_REQ, 0x03}) == vector<uint8_t>({ECU_RESET_RES, 0x03}));
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x03), services.getEcuResetService().getLastResetType());
+
+    CPPUNIT_ASSERT(proceed(services, {ECU_RESET_REQ, 0x42})
+                   == vector<uint8_t>({ERROR, ECU_RESET_REQ, SUBFUNCTION_NOT_SUPPORTED}));
+    CPPUNIT_ASSERT(proceed(services, {ECU_RESET_REQ})
+                   == vector<uint8_t>({ERROR, ECU_RESET_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT}));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), services.getEcuResetService().getResetCount());
+}
+
+void UdsServicesTest::testResetListener()
+{
+    UdsServices services(nullptr);
+    vector<uint8_t> resetTypes;
+    services.getEcuResetService().setResetListener([&resetTypes](uint8_t resetType) {
+        resetTypes.push_back(resetType);
+    });
+    proceed(services, {ECU_RESET_REQ, 0x01});
+    proceed(services, {ECU_RESET_REQ, 0x42});
+    proceed(services, {ECU_RESET_REQ, 0x83});
+    CPPUNIT_ASSERT(resetTypes == vector<uint8_t>({0x01, 0x03}));
+}
+
+void UdsServicesTest::testDtcs()
+{
+    UdsServices services(nullptr);
+    DtcStore& dtcs = services.getDtcService().getStore();
+    dtcs.setDtc(0xC01234, 0x09);
+    dtcs.setDtc(0x012345, 0x08);
+    dtcs.setDtc(0xC01234, 0x0B); // updated
+
+    CPPUNIT_ASSERT(proceed(services, {READ_DTC_INFORMATION_REQ, 0x01, 0x01})
+                   == vector<uint8_t>({READ_DTC_INFORMATION_RES, 0x01, 0xFF, 0x01, 0x00, 0x01}));
+    CPPUNIT_ASSERT(proceed(services, {READ_DTC_INFORMATION_REQ, 0x02, 0x08})
+                   == vector<uint8_t>({READ_DTC_INFORMATION_RES, 0x02, 0xFF, 0xC0, 0x12, 0x34, 0x0B, 0x01, 0x23, 0x45, 0x08}));
+    CPPUNIT_ASSERT(proceed(services, {READ_DTC_INFORMATION_REQ, 0x02, 0x02})
+                   == vector<uint8_t>({READ_DTC_INFORMATION_RES, 0x02, 0xFF, 0xC0, 0x12, 0x34, 0x0B}));
+    CPPUNIT_ASSERT(proceed(services, {READ_DTC_INFORMATION_REQ, 0x0A})
+                   == vector<uint8_t>({READ_DTC_INFORMATION_RES, 0x0A, 0xFF, 0xC0, 0x12, 0x34, 0x0B, 0x01, 0x23, 0x45, 0x08}));
+    dtcs.setSnapshotRecord(0xC01234, 0x01, {0x01, 0xF1, 0x90, 0x42});
+    CPPUNIT_ASSERT(proceed(services, {READ_DTC_INFORMATION_REQ, 0x04, 0xC0, 0x12, 0x34, 0xFF})
+                   == vector<uint8_t>({READ_DTC_INFORMATION_RES, 0x04, 0xC0, 0x12, 0x34, 0x0B, 0x01, 0x01, 0xF1, 0x90, 0x42}));
+    CPPUNIT_ASSERT(proceed(services, {READ_DTC_INFORMATION_REQ, 0x06, 0xC0, 0x12, 0x34, 0xFF})
+                   == vector<uint8_t>({READ_DTC_INFORMATION_RES, 0x06, 0xC0, 0x12, 0x34, 0x0B}));
+    CPPUNIT_ASSERT(proceed(services, {READ_DTC_INFORMATION_REQ, 0x04, 0x11, 0x11, 0x11, 0xFF})
+                   == vector<uint8_t>({ERROR, READ_DTC_INFORMATION_REQ, REQUEST_OUT_OF_RANGE}));
+    CPPUNIT_ASSERT(proceed(services, {READ_DTC_INFORMATION_REQ, 0x7E})
+                   == vector<uint8_t>({ERROR, READ_DTC_INFORMATION_REQ, SUBFUNCTION_NOT_SUPPORTED}));
+
+    // clear a single DTC, then all
+    CPPUNIT_ASSERT(proceed(services, {CLEAR_DIAGNOSTIC_INFORMATION_REQ, 0x01, 0x23, 0x45})
+                   == vector<uint8_t>({CLEAR_DIAGNOSTIC_INFORMATION_RES}));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), dtcs.size());
+    CPPUNIT_ASSERT(proceed(services, {CLEAR_DIAGNOSTIC_INFORMATION_REQ, 0x01, 0x23, 0x45})
+                   == vector<uint8_t>({ERROR, CLEAR_DIAGNOSTIC_INFORMATION_REQ, REQUEST_OUT_OF_RANGE}));
+    CPPUNIT_ASSERT(proceed(services, {CLEAR_DIAGNOSTIC_INFORMATION_REQ, 0xFF, 0xFF, 0xFF})
+                   == vector<uint8_t>({CLEAR_DIAGNOSTIC_INFORMATION_RES}));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), dtcs.size());
+
+    // no new DTCs while the DTC setting is off
+    CPPUNIT_ASSERT(proceed(services, {CONTROL_DTC_SETTINGS_REQ, 0x02}) == vector<uint8_t>({CONTROL_DTC_SETTINGS_RES, 0x02}));
+    dtcs.setDtc(0xC01234, 0x09);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), dtcs.size());
+    CPPUNIT_ASSERT(proceed(services, {CONTROL_DTC_SETTINGS_REQ, 0x01}) == vector<uint8_t>({CONTROL_DTC_SETTINGS_RES, 0x01}));
+    dtcs.setDtc(0xC01234, 0x09);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), dtcs.size());
+}
+
+void UdsServicesTest::testWriteDataByIdentifier()
+{
+    SessionController sessionCtrl;
+    auto pDids = make_shared<DidStore>();
+    UdsServices services(&sessionCtrl, make_shared<DtcStore>(), pDids);
+    vector<uint8_t> value;
+    CPPUNIT_ASSERT(!pDids->read(UdsSession::DEFAULT, 0xF190, value));
+
+    CPPUNIT_ASSERT(proceed(services, {WRITE_DATA_BY_IDENTIFIER_REQ, 0xF1, 0x90, 'V', 'I', 'N'})
+                   == vector<uint8_t>({WRITE_DATA_BY_IDENTIFIER_RES, 0xF1, 0x90}));
+    CPPUNIT_ASSERT(pDids->read(UdsSession::DEFAULT, 0xF190, value));
+    CPPUNIT_ASSERT(value == vector<uint8_t>({'V', 'I', 'N'}));
+
+    // written in the current session
+    sessionCtrl.setCurrentUdsSession(UdsSession::EXTENDED);
+    CPPUNIT_ASSERT(proceed(services, {WRITE_DATA_BY_IDENTIFIER_REQ, 0xF1, 0x90, 'X'})
+                   == vector<uint8_t>({WRITE_DATA_BY_IDENTIFIER_RES, 0xF1, 0x90}));
+    CPPUNIT_ASSERT(pDids->read(UdsSession::EXTENDED, 0xF190, value));
+    CPPUNIT_ASSERT(value == vector<uint8_t>({'X'}));
+    CPPUNIT_ASSERT(pDids->read(UdsSession::DEFAULT, 0xF190, value));
+    CPPUNIT_ASSERT(value == vector<uint8_t>({'V', 'I', 'N'}));
+
+    CPPUNIT_ASSERT(proceed(services, {WRITE_DATA_BY_IDENTIFIER_REQ, 0xF1, 0x90})
+                   == vector<uint8_t>({ERROR, WRITE_DATA_BY_IDENTIFIER_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT}));
+}
+
+void UdsServicesTest::testRoutineControl()
+{
+    UdsServices services(nullptr);
+    const vector<uint8_t> sequenceError = {ERROR, ROUTINE_CONTROL_REQ, REQUEST_SEQUENCE_ERROR};
+    CPPUNIT_ASSERT(proceed(services, {ROUTINE_CONTROL_REQ, 0x02, 0xFF, 0x00}) == sequenceError);
+    CPPUNIT_ASSERT(proceed(services, {ROUTINE_CONTROL_REQ, 0x03, 0xFF, 0x00}) == sequenceError);
+
+    CPPUNIT_ASSERT(proceed(services, {ROUTINE_CONTROL_REQ, 0x01, 0xFF, 0x00, 0x44})
+                   == vector<uint8_t>({ROUTINE_CONTROL_RES, 0x01, 0xFF, 0x00}));
+    CPPUNIT_ASSERT(services.getRoutineControlService().isRunning(0xFF00));
+    CPPUNIT_ASSERT(proceed(services, {ROUTINE_CONTROL_REQ, 0x02, 0xFF, 0x00})
+                   == vector<uint8_t>({ROUTINE_CONTROL_RES, 0x02, 0xFF, 0x00}));
+    CPPUNIT_ASSERT(!services.getRoutineControlService().isRunning(0xFF00));
+    CPPUNIT_ASSERT(proceed(services, {ROUTINE_CONTROL_REQ, 0x02, 0xFF, 0x00}) == sequenceError);
+    CPPUNIT_ASSERT(proceed(services, {ROUTINE_CONTROL_REQ, 0x03, 0xFF, 0x00})
+                   == vector<uint8_t>({ROUTINE_CONTROL_RES, 0x03, 0xFF, 0x00}));
+
+    CPPUNIT_ASSERT(proceed(services, {ROUTINE_CONTROL_REQ, 0x04, 0xFF, 0x00})
+                   == vector<uint8_t>({ERROR, ROUTINE_CONTROL_REQ, SUBFUNCTION_NOT_SUPPORTED}));
+}
+
+void UdsServicesTest::testCommunicationControl()
+{
+    UdsServices services(nullptr);
+    CPPUNIT_ASSERT(proceed(services, {COMMUNICATION_CONTROL_REQ, 0x03, 0x01})
+                   == vector<uint8_t>({COMMUNICATION_CONTROL_RES, 0x03}));
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x03), services.getCommunicationControlService().getControlType());
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x01), services.getCommunicationControlService().getCommunicationType());
+
+    CPPUNIT_ASSERT(proceed(services, {COMMUNICATION_CONTROL_REQ, 0x05, 0x01})
+                   == vector<uint8_t>({ERROR, COMMUNICATION_CONTROL_REQ, SUBFUNCTION_NOT_SUPPORTED}));
+    CPPUNIT_ASSERT(proceed(services, {COMMUNICATION_CONTROL_REQ, 0x00})
+                   == vector<uint8_t>({ERROR, COMMUNICATION_CONTROL_REQ, INCORRECT_MESSAGE_LENGTH_OR_INVALID_FORMAT}));
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x03), services.getCommunicationControlService().getControlType());
+
+    // the gate is shared by the transports of the ECU, e.g. CAN and DoIP
+    auto pGate = make_shared<CommunicationGate>();
+    UdsServices can(nullptr, make_shared<DtcStore>(), make_shared<DidStore>(), pGate);
+    UdsServices doip(nullptr, make_shared<DtcStore>(), make_shared<DidStore>(), pGate);
+    proceed(can, {COMMUNICATION_CONTROL_REQ, 0x01, 0x01});
+    CPPUNIT_ASSERT(!pGate->isTransmitEnabled());
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x01), doip.getCommunicationControlService().getControlType());
+    proceed(doip, {COMMUNICATION_CONTROL_REQ, 0x00, 0x01});
+    CPPUNIT_ASSERT(pGate->isTransmitEnabled());
+}
+
+void UdsServicesTest::testSuppressPositiveResponse()
+{
+    UdsServices services(nullptr);
+    CPPUNIT_ASSERT(proceed(services, {COMMUNICATION_CONTROL_REQ, 0x83, 0x01}).empty());
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x03), services.getCommunicationControlService().getControlType());
+
+    // negative responses are always sent
+    CPPUNIT_ASSERT(proceed(services, {ROUTINE_CONTROL_REQ, 0x82, 0x12, 0x34})
+                   == vector<uint8_t>({ERROR, ROUTINE_CONTROL_REQ, REQUEST_SEQUENCE_ERROR}));
+    // ClearDiagnosticInformation has no sub-function
+    CPPUNIT_ASSERT(proceed(services, {CLEAR_DIAGNOSTIC_INFORMATION_REQ, 0xFF, 0xFF, 0xFF})
+                   == vector<uint8_t>({CLEAR_DIAGNOSTIC_INFORMATION_RES}));
+}
@@ -0,0 +1,44 @@
+/**
+ * @file uds_services_test.h
+ *
+ */
+
+#ifndef UDS_SERVICES_TEST_H
+#define UDS_SERVICES_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class UdsServicesTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(UdsServicesTest);
+
+    CPPUNIT_TEST(testDispatchTable);
+    CPPUNIT_TEST(testEcuReset);
+    CPPUNIT_TEST(testResetListener);
+    CPPUNIT_TEST(testDtcs);
+    CPPUNIT_TEST(testWriteDataByIdentifier);
+    CPPUNIT_TEST(testRoutineControl);
+    CPPUNIT_TEST(testCommunicationControl);
+    CPPUNIT_TEST(testSuppressPositiveResponse);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    UdsServicesTest() = default;
+    virtual ~UdsServicesTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testDispatchTable();
+    void testEcuReset();
+    void testResetListener();
+    void testDtcs();
+    void testWriteDataByIdentifier();
+    void testRoutineControl();
+    void testCommunicationControl();
+    void testSuppressPositiveResponse();
+
+};
+
+#endif /* UDS_SERVICES_TEST_H */
@@ -0,0 +1,218 @@
+/**
+ * @file vehicle_signals_test.cpp
+ *
+ * Unit test for the shared vehicle signals and their encoding.
+ */
+
+#include "vehicle_signals_test.h"
+#include "vehicle_signals.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(VehicleSignalsTest);
+
+namespace
+{
+
+VehicleSignals::SignalId registerSignal(const char *name)
+{
+    return *VehicleSignals::getInstance().registerSignal(name);
+}
+
+SignalEncoding encoding(VehicleSignals::SignalId signal, unsigned startBit, unsigned bitLength, bool isBigEndian)
+{
+    SignalEncoding encoding;
+    encoding.signal = signal;
+    encoding.startBit = startBit;
+    encoding.bitLength = bitLength;
+    encoding.isBigEndian = isBigEndian;
+    return encoding;
+}
+
+} // namespace
+
+void VehicleSignalsTest::setUp() { }
+
+void VehicleSignalsTest::tearDown() { }
+
+void VehicleSignalsTest::testRegisterSignal()
+{
+    VehicleSignals& signals = VehicleSignals::getInstance();
+    const VehicleSignals::SignalId id = registerSignal("TestRegister");
+    CPPUNIT_ASSERT_EQUAL(id, registerSignal("TestRegister"));
+    CPPUNIT_ASSERT(signals.findSignal("TestRegister") == id);
+    CPPUNIT_ASSERT(!signals.findSignal("TestUnknown"));
+    CPPUNIT_ASSERT_EQUAL(0.0, signals.get(id));
+}
+
+void VehicleSignalsTest::testUpdate()
+{
+    VehicleSignals& signals = VehicleSignals::getInstance();
+    const VehicleSignals::SignalId speed = registerSignal("TestSpeed");
+    const VehicleSignals::SignalId rpm = registerSignal("TestRpm");
+    const uint64_t generation = signals.getGeneration();
+
+    signals.set(speed, 50.0);
+    signals.update({{speed, 80.0}, {rpm, 2000.0}});
+    CPPUNIT_ASSERT_EQUAL(generation + 2, signals.getGeneration());
+
+    const VehicleSignals::SignalId ids[] = {speed, rpm};
+    double values[2];
+    signals.snapshot(ids, 2, values);
+    CPPUNIT_ASSERT_EQUAL(80.0, values[0]);
+    CPPUNIT_ASSERT_EQUAL(2000.0, values[1]);
+
+    // the other values are kept by an update
+    signals.set(rpm, 800.0);
+    CPPUNIT_ASSERT_EQUAL(80.0, signals.get(speed));
+    CPPUNIT_ASSERT_EQUAL(800.0, signals.get(rpm));
+}
+
+void VehicleSignalsTest::testUpdateListener()
+{
+    VehicleSignals& signals = VehicleSignals::getInstance();
+    const VehicleSignals::SignalId speed = registerSignal("TestListenerSpeed");
+    unsigned calls = 0;
+    double value = 0.0;
+    const int id = signals.addUpdateListener([&]()
+    {
+        ++calls;
+        value = signals.get(speed);
+    });
+    unsigned otherCalls = 0;
+    const int otherId = signals.addUpdateListener([&otherCalls]() { ++otherCalls; });
+
+    signals.set(speed, 30.0);
+    signals.update({{speed, 40.0}});
+    CPPUNIT_ASSERT_EQUAL(2u, calls);
+    CPPUNIT_ASSERT_EQUAL(40.0, value); // called after the update is visible
+    CPPUNIT_ASSERT_EQUAL(2u, otherCalls);
+
+    signals.removeUpdateListener(id);
+    signals.set(speed, 50.0);
+    CPPUNIT_ASSERT_EQUAL(2u, calls);
+    CPPUNIT_ASSERT_EQUAL(3u, otherCalls);
+    signals.removeUpdateListener(otherId);
+}
+
+void VehicleSignalsTest::testConsistentSnapshot()
+{
+    VehicleSignals& signals = VehicleSignals::getInstance();
+    const VehicleSignals::SignalId first = registerSignal("TestFirst");
+    const VehicleSignals::SignalId second = registerSignal("TestSecond");
+
+    // both signals are always updated together, so a snapshot never sees different values
+    atomic<bool> isRunning{true};
+    thread writer([&]() {
+        for (double value = 0.0; isRunning; value += 1.0)
+        {
+            signals.update({{first, value}, {second, value}});
+        }
+    });
+    const VehicleSignals::SignalId ids[] = {first, second};
+    for (int i = 0; i < 10000; ++i)
+    {
+        double values[2];
+        signals.snapshot(ids, 2, values);
+        CPPUNIT_ASSERT_EQUAL(values[0], values[1]);
+    }
+    isRunning = false;
+    writer.join();
+}
+
+void VehicleSignalsTest::testBigEndian()
+{
+    const VehicleSignals::SignalId rpm = registerSignal("TestEngineSpeed");
+    const VehicleSignals::SignalId flag = registerSignal("TestFlag");
+    VehicleSignals::getInstance().update({{rpm, 0x1AF8}, {flag, 1.0}});
+
+    // a 16 bit value from the first byte and a single bit, the MSB of the third byte
+    const SignalRecord record({encoding(rpm, 0, 16, true), encoding(flag, 16, 1, true)}, 0, 0x00);
+    CPPUNIT_ASSERT_EQUAL(size_t(3), record.size());
+    vector<uint8_t> bytes = {0x62};
+    record.append(bytes);
+    CPPUNIT_ASSERT(bytes == vector<uint8_t>({0x62, 0x1A, 0xF8, 0x80}));
+
+    // a 12 bit value starting at the bit 4
+    VehicleSignals::getInstance().set(rpm, 0x0AF8);
+    const SignalRecord shifted({encoding(rpm, 4, 12, true)}, 3, 0xFF);
+    bytes.clear();
+    shifted.append(bytes);
+    CPPUNIT_ASSERT(bytes == vector<uint8_t>({0xFA, 0xF8, 0xFF}));
+}
+
+void VehicleSignalsTest::testLittleEndian()
+{
+    const VehicleSignals::SignalId speed = registerSignal("TestWheelSpeed");
+    const VehicleSignals::SignalId state = registerSignal("TestState");
+    VehicleSignals::getInstance().update({{speed, 0x1234}, {state, 2.0}});
+
+    // J1939 style: the LSB first, the bits of a byte counted from its LSB
+    const SignalRecord record({encoding(speed, 8, 16, false), encoding(state, 2, 2, false)}, 8, 0xFF);
+    vector<uint8_t> payload = {0x00, 0x00, 0x00, 0x00};
+    record.overlay(payload);
+    CPPUNIT_ASSERT(payload == vector<uint8_t>({0x08, 0x34, 0x12, 0x00, 0xFF, 0xFF, 0xFF, 0xFF}));
+}
+
+void VehicleSignalsTest::testScaleAndSaturation()
+{
+    VehicleSignals& signals = VehicleSignals::getInstance();
+    const VehicleSignals::SignalId temperature = registerSignal("TestCoolantTemperature");
+    SignalEncoding offset = encoding(temperature, 0, 8, true);
+    offset.offset = -40.0;
+    SignalEncoding scaled = encoding(temperature, 8, 16, true);
+    scaled.scale = 0.1;
+    SignalEncoding isSigned = encoding(temperature, 24, 8, true);
+    isSigned.isSigned = true;
+    const SignalRecord record({offset, scaled, isSigned}, 0, 0x00);
+
+    vector<uint8_t> bytes;
+    signals.set(temperature, 90.0);
+    record.append(bytes);
+    CPPUNIT_ASSERT(bytes == vector<uint8_t>({130, 0x03, 0x84, 90}));
+
+    // out of range values are saturated, negative values are two's complement
+    bytes.clear();
+    signals.set(temperature, -50.0);
+    record.append(bytes);
+    CPPUNIT_ASSERT(bytes == vector<uint8_t>({0x00, 0x00, 0x00, 0xCE}));
+
+    bytes.clear();
+    signals.set(temperature, 1000.0);
+    record.append(bytes);
+    CPPUNIT_ASSERT(bytes == vector<uint8_t>({0xFF, 0x27, 0x10, 0x7F}));
+}
+
+void VehicleSignalsTest::testUnalignedSpns()
+{
+    const VehicleSignals::SignalId load = registerSignal("TestEngineLoad");
+    const VehicleSignals::SignalId torque = registerSignal("TestEngineTorque");
+    VehicleSignals::getInstance().update({{load, 0xABC}, {torque, -171.0}});
+
+    // SPNs starting and ending within a byte keep the other bits of the bytes
+    SignalEncoding isSigned = encoding(torque, 20, 10, false);
+    isSigned.isSigned = true;
+    const SignalRecord record({encoding(load, 4, 12, false), isSigned}, 8, 0xFF);
+    vector<uint8_t> payload;
+    record.overlay(payload);
+    CPPUNIT_ASSERT(payload == vector<uint8_t>({0xCF, 0xAB, 0x5F, 0xF5, 0xFF, 0xFF, 0xFF, 0xFF}));
+
+    // more than 256 byte segments in a record
+    VehicleSignals::getInstance().set(load, 0x12345678);
+    vector<SignalEncoding> encodings;
+    for (unsigned i = 0; i < MAX_SIGNALS_PER_RECORD; ++i)
+    {
+        encodings.push_back(encoding(load, i * 40 + 4, 32, false));
+    }
+    const SignalRecord large(move(encodings), 0, 0x00);
+    CPPUNIT_ASSERT_EQUAL(size_t(320), large.size());
+    payload.clear();
+    large.append(payload);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x80), payload[315]);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x67), payload[316]);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(0x01), payload[319]);
+}
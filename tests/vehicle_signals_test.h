@@ -0,0 +1,44 @@
+/**
+ * @file vehicle_signals_test.h
+ *
+ */
+
+#ifndef VEHICLE_SIGNALS_TEST_H
+#define VEHICLE_SIGNALS_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class VehicleSignalsTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(VehicleSignalsTest);
+
+    CPPUNIT_TEST(testRegisterSignal);
+    CPPUNIT_TEST(testUpdate);
+    CPPUNIT_TEST(testUpdateListener);
+    CPPUNIT_TEST(testConsistentSnapshot);
+    CPPUNIT_TEST(testBigEndian);
+    CPPUNIT_TEST(testLittleEndian);
+    CPPUNIT_TEST(testScaleAndSaturation);
+    CPPUNIT_TEST(testUnalignedSpns);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    VehicleSignalsTest() = default;
+    virtual ~VehicleSignalsTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testRegisterSignal();
+    void testUpdate();
+    void testUpdateListener();
+    void testConsistentSnapshot();
+    void testBigEndian();
+    void testLittleEndian();
+    void testScaleAndSaturation();
+    void testUnalignedSpns();
+
+};
+
+#endif /* VEHICLE_SIGNALS_TEST_H */
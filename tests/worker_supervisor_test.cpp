@@ -0,0 +1,58 @@
+/**
+ * @file worker_supervisor_test.cpp
+ *
+ * Unit test for the sharding of the worker processes.
+ */
+
+#include "worker_supervisor_test.h"
+#include "worker_supervisor.h"
+#include <set>
+#include <string>
+
+using namespace std;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(WorkerSupervisorTest);
+
+void WorkerSupervisorTest::setUp() { }
+
+void WorkerSupervisorTest::tearDown() { }
+
+void WorkerSupervisorTest::testParseWorkerIndex()
+{
+    CPPUNIT_ASSERT_EQUAL(-1, WorkerSupervisor::parseWorkerIndex(nullptr));
+    CPPUNIT_ASSERT_EQUAL(-1, WorkerSupervisor::parseWorkerIndex(""));
+    CPPUNIT_ASSERT_EQUAL(0, WorkerSupervisor::parseWorkerIndex("0"));
+    CPPUNIT_ASSERT_EQUAL(12, WorkerSupervisor::parseWorkerIndex("12"));
+    CPPUNIT_ASSERT_EQUAL(-1, WorkerSupervisor::parseWorkerIndex("-1"));
+    CPPUNIT_ASSERT_EQUAL(-1, WorkerSupervisor::parseWorkerIndex("2x"));
+    CPPUNIT_ASSERT_EQUAL(-1, WorkerSupervisor::parseWorkerIndex("99999999999999999999"));
+}
+
+void WorkerSupervisorTest::testInterfaceOwner()
+{
+    // numbered interfaces are dealt round robin
+    CPPUNIT_ASSERT_EQUAL(0u, WorkerSupervisor::getInterfaceOwner("vcan0", 3));
+    CPPUNIT_ASSERT_EQUAL(1u, WorkerSupervisor::getInterfaceOwner("vcan1", 3));
+    CPPUNIT_ASSERT_EQUAL(2u, WorkerSupervisor::getInterfaceOwner("can2", 3));
+    CPPUNIT_ASSERT_EQUAL(0u, WorkerSupervisor::getInterfaceOwner("vcan3", 3));
+    CPPUNIT_ASSERT_EQUAL(0u, WorkerSupervisor::getInterfaceOwner("vcan7", 1));
+
+    // the others by their name, the same name always on the same worker
+    set<unsigned int> owners;
+    for (const string interface : {"body", "chassis", "powertrain", "infotainment", "diag", "gateway"})
+    {
+        const unsigned int owner = WorkerSupervisor::getInterfaceOwner(interface, 4);
+        CPPUNIT_ASSERT(owner < 4);
+        CPPUNIT_ASSERT_EQUAL(owner, WorkerSupervisor::getInterfaceOwner(interface, 4));
+        owners.insert(owner);
+    }
+    CPPUNIT_ASSERT(owners.size() > 1);
+}
+
+void WorkerSupervisorTest::testWorkerFile()
+{
+    CPPUNIT_ASSERT_EQUAL(string("/tmp/carsim.ckpt"), WorkerSupervisor::getWorkerFile("/tmp/carsim.ckpt", -1));
+    CPPUNIT_ASSERT_EQUAL(string("/tmp/carsim.2.ckpt"), WorkerSupervisor::getWorkerFile("/tmp/carsim.ckpt", 2));
+    CPPUNIT_ASSERT_EQUAL(string("/tmp/capture.0"), WorkerSupervisor::getWorkerFile("/tmp/capture", 0));
+    CPPUNIT_ASSERT_EQUAL(string(), WorkerSupervisor::getWorkerFile("", 1));
+}
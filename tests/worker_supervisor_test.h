@@ -0,0 +1,34 @@
+/**
+ * @file worker_supervisor_test.h
+ *
+ */
+
+#ifndef WORKER_SUPERVISOR_TEST_H
+#define WORKER_SUPERVISOR_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class WorkerSupervisorTest : public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE(WorkerSupervisorTest);
+
+    CPPUNIT_TEST(testParseWorkerIndex);
+    CPPUNIT_TEST(testInterfaceOwner);
+    CPPUNIT_TEST(testWorkerFile);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    WorkerSupervisorTest() = default;
+    virtual ~WorkerSupervisorTest() = default;
+    void setUp();
+    void tearDown();
+
+private:
+    void testParseWorkerIndex();
+    void testInterfaceOwner();
+    void testWorkerFile();
+
+};
+
+#endif /* WORKER_SUPERVISOR_TEST_H */
@@ -0,0 +1,308 @@
+/**
+ * @file doip_tester.cpp
+ *
+ * The DoIP messages consist of the generic header (protocol version, inverse
+ * protocol version, payload type and payload length, all big endian) followed
+ * by the payload.
+ */
+
+#include "doip_tester.h"
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+constexpr uint8_t PROTOCOL_VERSION = 0x02;
+constexpr size_t HEADER_SIZE = 8;
+constexpr size_t MAX_PAYLOAD_SIZE = 0x10000;
+
+constexpr uint16_t ROUTING_ACTIVATION_REQUEST = 0x0005;
+constexpr uint16_t ROUTING_ACTIVATION_RESPONSE = 0x0006;
+constexpr uint16_t ALIVE_CHECK_REQUEST = 0x0007;
+constexpr uint16_t ALIVE_CHECK_RESPONSE = 0x0008;
+constexpr uint16_t DIAGNOSTIC_MESSAGE = 0x8001;
+constexpr uint16_t DIAGNOSTIC_POSITIVE_ACK = 0x8002;
+constexpr uint16_t DIAGNOSTIC_NEGATIVE_ACK = 0x8003;
+constexpr uint8_t ROUTING_SUCCESSFULLY_ACTIVATED = 0x10;
+
+/**
+ * Constructor.
+ *
+ * @param sourceAddress: the logical address of the tester
+ */
+DoIPTester::DoIPTester(uint16_t sourceAddress) noexcept
+: sourceAddress_(sourceAddress)
+{
+}
+
+/**
+ * Destructor. Closes the connection.
+ */
+DoIPTester::~DoIPTester()
+{
+    disconnect();
+}
+
+/**
+ * Connects to the DoIP server and activates the routing.
+ *
+ * @param host: the host name or IP address of the server
+ * @param port: the TCP port of the server, usually `DOIP_TCP_PORT`
+ * @param timeoutMs: the max. time to wait for the routing activation
+ * @return 0 on success, otherwise a negative value
+ */
+int DoIPTester::connectTo(const string& host, uint16_t port, int timeoutMs) noexcept
+{
+    disconnect();
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* pAddresses = nullptr;
+    const int err = getaddrinfo(host.c_str(), to_string(port).c_str(), &hints, &pAddresses);
+    if (err != 0)
+    {
+        cerr << __func__ << "() getaddrinfo: " << gai_strerror(err) << endl;
+        return -1;
+    }
+    for (struct addrinfo* pAddress = pAddresses; pAddress != nullptr && skt_ < 0; pAddress = pAddress->ai_next)
+    {
+        skt_ = socket(pAddress->ai_family, pAddress->ai_socktype, pAddress->ai_protocol);
+        if (skt_ >= 0 && connect(skt_, pAddress->ai_addr, pAddress->ai_addrlen) < 0)
+        {
+            close(skt_);
+            skt_ = -1;
+        }
+    }
+    freeaddrinfo(pAddresses);
+    if (skt_ < 0)
+    {
+        cerr << __func__ << "() connect to " << host << ":" << port << ": " << strerror(errno) << endl;
+        return -2;
+    }
+    // the requests are small, do not delay them until the previous one is acknowledged
+    const int noDelay = 1;
+    setsockopt(skt_, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+    const uint8_t request[] = {uint8_t(sourceAddress_ >> 8), uint8_t(sourceAddress_), 0x00, 0, 0, 0, 0};
+    if (sendMessage(ROUTING_ACTIVATION_REQUEST, request, sizeof(request)) < 0)
+    {
+        disconnect();
+        return -3;
+    }
+
+    const auto deadline = chrono::steady_clock::now() + chrono::milliseconds(timeoutMs);
+    uint16_t payloadType = 0;
+    vector<uint8_t> payload;
+    while (receiveMessage(payloadType, payload, deadline) == 0)
+    {
+        if (payloadType == ROUTING_ACTIVATION_RESPONSE)
+        {
+            if (payload.size() < 5 || payload[4] != ROUTING_SUCCESSFULLY_ACTIVATED)
+            {
+                cerr << __func__ << "() routing activation denied" << endl;
+                break;
+            }
+            return 0;
+        }
+    }
+    disconnect();
+    return -4;
+}
+
+/**
+ * Closes the connection.
+ */
+void DoIPTester::disconnect() noexcept
+{
+    if (skt_ >= 0)
+    {
+        close(skt_);
+        skt_ = -1;
+    }
+}
+
+/**
+ * Sends a diagnostic message (i.e. an UDS request) to the given entity.
+ *
+ * @param targetAddress: the logical address of the DoIP entity
+ * @param data: the UDS request
+ * @param size: the length of the request
+ * @return 0 on success, otherwise a negative value
+ */
+int DoIPTester::sendDiagnosticMessage(uint16_t targetAddress, const uint8_t* data, size_t size) noexcept
+{
+    uint8_t payload[4 + MAX_PAYLOAD_SIZE];
+    if (size > MAX_PAYLOAD_SIZE)
+    {
+        return -1;
+    }
+    payload[0] = uint8_t(sourceAddress_ >> 8);
+    payload[1] = uint8_t(sourceAddress_);
+    payload[2] = uint8_t(targetAddress >> 8);
+    payload[3] = uint8_t(targetAddress);
+    memcpy(payload + 4, data, size);
+    return sendMessage(DIAGNOSTIC_MESSAGE, payload, 4 + size);
+}
+
+/**
+ * Waits for the diagnostic message (i.e. the UDS response) of the given
+ * entity. The positive acknowledgements of the request are skipped.
+ *
+ * @param targetAddress: the logical address of the DoIP entity
+ * @param response: receives the UDS response
+ * @param deadline: the max. time to wait
+ * @return 0 on success, 1 on a timeout, 2 if the server did not accept the
+ *         request (negative acknowledgement), otherwise a negative value
+ */
+int DoIPTester::receiveDiagnosticMessage(uint16_t targetAddress, vector<uint8_t>& response,
+                                         chrono::steady_clock::time_point deadline) noexcept
+{
+    uint16_t payloadType = 0;
+    vector<uint8_t> payload;
+    for (;;)
+    {
+        const int err = receiveMessage(payloadType, payload, deadline);
+        if (err != 0)
+        {
+            return err;
+        }
+        if (payload.size() < 4 || (payload[0] << 8 | payload[1]) != targetAddress)
+        {
+            continue;
+        }
+        if (payloadType == DIAGNOSTIC_NEGATIVE_ACK)
+        {
+            return 2;
+        }
+        if (payloadType == DIAGNOSTIC_MESSAGE)
+        {
+            response.assign(payload.begin() + 4, payload.end());
+            return 0;
+        }
+    }
+}
+
+int DoIPTester::sendMessage(uint16_t payloadType, const uint8_t* payload, size_t size) noexcept
+{
+    uint8_t message[HEADER_SIZE + 4 + MAX_PAYLOAD_SIZE];
+    if (skt_ < 0 || size > sizeof(message) - HEADER_SIZE)
+    {
+        return -1;
+    }
+    message[0] = PROTOCOL_VERSION;
+    message[1] = uint8_t(~PROTOCOL_VERSION);
+    message[2] = uint8_t(payloadType >> 8);
+    message[3] = uint8_t(payloadType);
+    message[4] = uint8_t(size >> 24);
+    message[5] = uint8_t(size >> 16);
+    message[6] = uint8_t(size >> 8);
+    message[7] = uint8_t(size);
+    memcpy(message + HEADER_SIZE, payload, size);
+
+    size_t sent = 0;
+    while (sent < HEADER_SIZE + size)
+    {
+        const ssize_t n = send(skt_, message + sent, HEADER_SIZE + size - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            cerr << __func__ << "() send: " << strerror(errno) << endl;
+            return -2;
+        }
+        sent += size_t(n);
+    }
+    return 0;
+}
+
+/**
+ * Receives the next message and answers the alive checks.
+ *
+ * @return 0 on success, 1 on a timeout, otherwise a negative value
+ */
+int DoIPTester::receiveMessage(uint16_t& payloadType, vector<uint8_t>& payload,
+                               chrono::steady_clock::time_point deadline) noexcept
+{
+    for (;;)
+    {
+        uint8_t header[HEADER_SIZE];
+        int err = receiveBytes(header, sizeof(header), deadline);
+        if (err != 0)
+        {
+            return err;
+        }
+        if (header[0] != uint8_t(~header[1]))
+        {
+            cerr << __func__ << "() invalid DoIP header" << endl;
+            return -3;
+        }
+        payloadType = uint16_t(header[2] << 8 | header[3]);
+        const uint32_t size = uint32_t(header[4]) << 24 | uint32_t(header[5]) << 16
+            | uint32_t(header[6]) << 8 | header[7];
+        if (size > 4 + MAX_PAYLOAD_SIZE)
+        {
+            cerr << __func__ << "() DoIP payload too large: " << size << endl;
+            return -3;
+        }
+        payload.resize(size);
+        err = receiveBytes(payload.data(), size, deadline);
+        if (err != 0)
+        {
+            return err == 1 ? -4 : err; // the rest of the message is still in the stream
+        }
+
+        if (payloadType != ALIVE_CHECK_REQUEST)
+        {
+            return 0;
+        }
+        const uint8_t response[] = {uint8_t(sourceAddress_ >> 8), uint8_t(sourceAddress_)};
+        sendMessage(ALIVE_CHECK_RESPONSE, response, sizeof(response));
+    }
+}
+
+/**
+ * @return 0 on success, 1 on a timeout, otherwise a negative value (-4 if
+ *         the timeout expired in the middle of the data)
+ */
+int DoIPTester::receiveBytes(uint8_t* buffer, size_t size, chrono::steady_clock::time_point deadline) noexcept
+{
+    size_t received = 0;
+    while (received < size)
+    {
+        const auto remaining = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now());
+        struct pollfd fd = {skt_, POLLIN, 0};
+        const int ready = poll(&fd, 1, int(max<chrono::milliseconds::rep>(remaining.count(), 0)));
+        if (ready < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (ready == 0)
+        {
+            return received == 0 ? 1 : -4;
+        }
+        const ssize_t n = ready < 0 ? -1 : recv(skt_, buffer + received, size - received, 0);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            cerr << __func__ << "() recv: " << (n == 0 ? "connection closed" : strerror(errno)) << endl;
+            return -2;
+        }
+        received += size_t(n);
+    }
+    return 0;
+}
@@ -0,0 +1,50 @@
+/**
+ * @file doip_tester.h
+ *
+ */
+
+#ifndef DOIP_TESTER_H
+#define DOIP_TESTER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+constexpr std::uint16_t DOIP_TCP_PORT = 13400;
+constexpr std::uint16_t DOIP_TESTER_ADDRESS = 0x0E00; ///< default logical address of the tester
+
+/**
+ * Minimal DoIP tester (ISO 13400-2) over TCP: it activates the routing once
+ * after connecting and then exchanges diagnostic messages with the DoIP
+ * entities behind the connection. Alive check requests of the server are
+ * answered while waiting for a response, so a connection survives long runs.
+ */
+class DoIPTester
+{
+public:
+    explicit DoIPTester(std::uint16_t sourceAddress = DOIP_TESTER_ADDRESS) noexcept;
+    DoIPTester(const DoIPTester& orig) = delete;
+    DoIPTester& operator =(const DoIPTester& orig) = delete;
+    virtual ~DoIPTester();
+
+    int connectTo(const std::string& host, std::uint16_t port, int timeoutMs) noexcept;
+    void disconnect() noexcept;
+    int sendDiagnosticMessage(std::uint16_t targetAddress, const std::uint8_t* data,
+                              std::size_t size) noexcept;
+    int receiveDiagnosticMessage(std::uint16_t targetAddress, std::vector<std::uint8_t>& response,
+                                 std::chrono::steady_clock::time_point deadline) noexcept;
+
+private:
+    std::uint16_t sourceAddress_;
+    int skt_ = -1;
+
+    int sendMessage(std::uint16_t payloadType, const std::uint8_t* payload, std::size_t size) noexcept;
+    int receiveMessage(std::uint16_t& payloadType, std::vector<std::uint8_t>& payload,
+                       std::chrono::steady_clock::time_point deadline) noexcept;
+    int receiveBytes(std::uint8_t* buffer, std::size_t size,
+                     std::chrono::steady_clock::time_point deadline) noexcept;
+};
+
+#endif /* DOIP_TESTER_H */
@@ -0,0 +1,505 @@
+/**
+ * @file load_generator.cpp
+ *
+ * Load generator and soak harness for a running simulator. It sends the
+ * requests of a request mix (see `request_mix.cpp`) to the simulated ECUs,
+ * over ISO-TP on a CAN device and/or over DoIP, and reports the throughput,
+ * the response latencies and the error rates:
+ *
+ *     load_generator -i vcan0 -r 2000 -c 4 -d 60 mix.txt
+ *     load_generator --doip 127.0.0.1 -d 0 -p 10 mix.txt   # soak until Ctrl+C
+ *
+ * Each target (ECU) of the mix gets `--concurrency` clients. With a `--rate`
+ * the clients send on a fixed schedule and the latency is measured from the
+ * scheduled send time, so a stalled simulator shows up in the latencies
+ * instead of silently lowering the send rate. Without a rate each client
+ * sends its next request as soon as it got the previous response. A
+ * "response pending" (NRC 0x78) extends the timeout by P2*.
+ */
+
+#include "doip_tester.h"
+#include "request_mix.h"
+#include "isotp_receiver.h"
+#include "isotp_sender.h"
+#include "logger.h"
+#include "metrics.h"
+#include "service_identifier.h"
+#include <getopt.h>
+#include <poll.h>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+constexpr chrono::milliseconds P2_STAR_SERVER_MAX(5000);
+
+namespace
+{
+
+volatile sig_atomic_t isStopRequested = 0;
+
+/**
+ * The results of one target or of all targets.
+ */
+struct Statistics
+{
+    atomic<uint64_t> sent{0};
+    atomic<uint64_t> responses{0};
+    atomic<uint64_t> negativeResponses{0};
+    atomic<uint64_t> timeouts{0};
+    atomic<uint64_t> errors{0}; ///< send errors, lost connections and rejected DoIP messages
+    LatencyHistogram latency;
+};
+
+struct Options
+{
+    string device = "vcan0";
+    string doipHost;
+    uint16_t doipPort = DOIP_TCP_PORT;
+    double rate = 0; ///< total requests per second, 0 means as fast as possible
+    unsigned concurrency = 1;
+    unsigned duration = 10; ///< seconds, 0 means until Ctrl+C
+    unsigned reportInterval = 0; ///< seconds, 0 means only the final report
+    chrono::milliseconds timeout{1000};
+};
+
+/**
+ * One client, i.e. one outstanding request at a time.
+ */
+class LoadClient
+{
+public:
+    virtual ~LoadClient() = default;
+    /// @return 0 on success, otherwise a negative value
+    virtual int send(const vector<uint8_t>& request) noexcept = 0;
+    /// @return 0 on success, 1 on a timeout, otherwise an error
+    virtual int receive(vector<uint8_t>& response, chrono::steady_clock::time_point deadline) noexcept = 0;
+};
+
+/**
+ * Client of an UDS ECU on the CAN bus, i.e. the tester side of the ISO-TP
+ * sockets of `ElectronicControlUnit`.
+ */
+class CanClient : public LoadClient, private IsoTpReceiver
+{
+public:
+    CanClient(const MixTarget& target, const string& device)
+    : IsoTpReceiver(target.requestId, target.responseId, device)
+    , sender_(target.requestId, target.responseId, device)
+    {
+    }
+
+    virtual ~CanClient()
+    {
+        closeReceiver();
+    }
+
+    virtual int send(const vector<uint8_t>& request) noexcept override
+    {
+        // drop the late responses of timed out requests
+        while (readSingleMessage() == 0)
+        {
+        }
+        hasResponse_ = false;
+        return sender_.sendData(request.data(), request.size()) < 0 ? -1 : 0;
+    }
+
+    virtual int receive(vector<uint8_t>& response, chrono::steady_clock::time_point deadline) noexcept override
+    {
+        hasResponse_ = false;
+        while (!hasResponse_)
+        {
+            const auto remaining = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now());
+            struct pollfd fd = {getSocket(), POLLIN, 0};
+            const int ready = poll(&fd, 1, int(max<chrono::milliseconds::rep>(remaining.count(), 0)));
+            if (ready == 0)
+            {
+                return 1;
+            }
+            if (ready > 0 && readSingleMessage() < 0)
+            {
+                return -1;
+            }
+        }
+        response.swap(response_);
+        return 0;
+    }
+
+protected:
+    virtual void proceedReceivedData(const uint8_t* buffer, const size_t num_bytes) noexcept override
+    {
+        response_.assign(buffer, buffer + num_bytes);
+        hasResponse_ = true;
+    }
+
+private:
+    IsoTpSender sender_;
+    vector<uint8_t> response_;
+    bool hasResponse_ = false;
+};
+
+/**
+ * Client of a DoIP entity. Each client has a connection of its own, which is
+ * reopened on the next request after an error or a timeout (a late response
+ * would otherwise be taken for the response of the next request).
+ */
+class DoIPClient : public LoadClient
+{
+public:
+    DoIPClient(const MixTarget& target, const Options& options)
+    : targetAddress_(uint16_t(target.requestId))
+    , options_(options)
+    {
+    }
+
+    virtual int send(const vector<uint8_t>& request) noexcept override
+    {
+        if (!isConnected_)
+        {
+            isConnected_ = tester_.connectTo(options_.doipHost, options_.doipPort, int(options_.timeout.count())) == 0;
+            if (!isConnected_)
+            {
+                return -1;
+            }
+        }
+        if (tester_.sendDiagnosticMessage(targetAddress_, request.data(), request.size()) < 0)
+        {
+            isConnected_ = false;
+            return -1;
+        }
+        return 0;
+    }
+
+    virtual int receive(vector<uint8_t>& response, chrono::steady_clock::time_point deadline) noexcept override
+    {
+        const int err = tester_.receiveDiagnosticMessage(targetAddress_, response, deadline);
+        if (err != 0 && err != 2)
+        {
+            tester_.disconnect();
+            isConnected_ = false;
+        }
+        return err;
+    }
+
+private:
+    DoIPTester tester_;
+    uint16_t targetAddress_;
+    const Options& options_;
+    bool isConnected_ = false;
+};
+
+bool isResponsePending(const vector<uint8_t>& response) noexcept
+{
+    return response.size() >= 3 && response[0] == ERROR && response[2] == RESPONSE_PENDING;
+}
+
+/**
+ * The loop of one client thread.
+ *
+ * @param client: the client of the target
+ * @param target: the requests to pick from
+ * @param results: the statistics of the target and the total statistics
+ * @param interval: the time between two requests, 0 means closed loop
+ * @param seed: the seed of the random numbers used to pick the requests
+ * @param options: the timeout
+ */
+void runClient(LoadClient& client, const MixTarget& target, Statistics* const results[2],
+               chrono::nanoseconds interval, uint32_t seed, const Options& options)
+{
+    mt19937 random(seed);
+    vector<uint8_t> response;
+    const bool isPaced = interval.count() > 0;
+    // spread the first requests of the clients over one interval
+    auto next = chrono::steady_clock::now() + chrono::nanoseconds(isPaced ? random() % interval.count() : 0);
+    while (!isStopRequested)
+    {
+        auto startedAt = chrono::steady_clock::now();
+        if (isPaced)
+        {
+            this_thread::sleep_until(next);
+            startedAt = next;
+            next += interval;
+        }
+
+        const MixEntry& entry = target.pick(uint32_t(random()));
+        for (Statistics* pStatistics : {results[0], results[1]})
+        {
+            pStatistics->sent.fetch_add(1, memory_order_relaxed);
+        }
+        int err = client.send(entry.request);
+        if (err == 0)
+        {
+            auto deadline = chrono::steady_clock::now() + options.timeout;
+            while ((err = client.receive(response, deadline)) == 0 && isResponsePending(response))
+            {
+                deadline = chrono::steady_clock::now() + P2_STAR_SERVER_MAX;
+            }
+        }
+        else if (!isPaced)
+        {
+            // do not spin while the target is not reachable
+            this_thread::sleep_for(options.timeout / 10);
+        }
+
+        const auto latency = chrono::steady_clock::now() - startedAt;
+        for (Statistics* pStatistics : {results[0], results[1]})
+        {
+            if (err == 0)
+            {
+                pStatistics->responses.fetch_add(1, memory_order_relaxed);
+                if (!response.empty() && response[0] == ERROR)
+                {
+                    pStatistics->negativeResponses.fetch_add(1, memory_order_relaxed);
+                }
+                pStatistics->latency.record(latency);
+            }
+            else if (err == 1)
+            {
+                pStatistics->timeouts.fetch_add(1, memory_order_relaxed);
+            }
+            else
+            {
+                pStatistics->errors.fetch_add(1, memory_order_relaxed);
+            }
+        }
+    }
+}
+
+double toMs(uint64_t valueUs) noexcept
+{
+    return double(valueUs) / 1000.0;
+}
+
+void printHeader() noexcept
+{
+    printf("%-22s %10s %10s %7s %8s %8s %9s %9s %9s %9s\n", "target", "requests", "resp/s", "NRC %",
+           "timeouts", "errors", "p50 ms", "p99 ms", "p999 ms", "max ms");
+}
+
+/**
+ * Prints one line of the report.
+ *
+ * @param name: the target
+ * @param statistics: the results of the target
+ * @param responseRate: the responses per second
+ */
+void printStatistics(const string& name, const Statistics& statistics, double responseRate) noexcept
+{
+    const uint64_t responses = statistics.responses.load(memory_order_relaxed);
+    const uint64_t negativeResponses = statistics.negativeResponses.load(memory_order_relaxed);
+    printf("%-22s %10llu %10.1f %7.2f %8llu %8llu %9.3f %9.3f %9.3f %9.3f\n", name.c_str(),
+           static_cast<unsigned long long>(statistics.sent.load(memory_order_relaxed)), responseRate,
+           responses > 0 ? 100.0 * double(negativeResponses) / double(responses) : 0.0,
+           static_cast<unsigned long long>(statistics.timeouts.load(memory_order_relaxed)),
+           static_cast<unsigned long long>(statistics.errors.load(memory_order_relaxed)),
+           toMs(statistics.latency.getValueAtQuantile(0.5)),
+           toMs(statistics.latency.getValueAtQuantile(0.99)),
+           toMs(statistics.latency.getValueAtQuantile(0.999)),
+           toMs(statistics.latency.getMaxUs()));
+    fflush(stdout);
+}
+
+void printUsage(const char* program) noexcept
+{
+    fprintf(stderr,
+            "Usage: %s [options] <request mix>\n"
+            "  -i, --interface <device>  CAN device of the simulator (default: vcan0)\n"
+            "  -D, --doip <host[:port]>  DoIP server of the simulator (default port: %u)\n"
+            "  -r, --rate <requests/s>   total request rate, 0 means as fast as possible (default: 0)\n"
+            "  -c, --concurrency <n>     clients per ECU (default: 1)\n"
+            "  -d, --duration <s>        test duration, 0 means until Ctrl+C (default: 10)\n"
+            "  -t, --timeout <ms>        response timeout (default: 1000)\n"
+            "  -p, --report-interval <s> print the totals every <s> seconds (default: off)\n",
+            program, DOIP_TCP_PORT);
+}
+
+bool parseOptions(int argc, char** argv, Options& options, string& mixFile) noexcept
+{
+    const struct option longOptions[] = {
+        {"interface", required_argument, nullptr, 'i'},
+        {"doip", required_argument, nullptr, 'D'},
+        {"rate", required_argument, nullptr, 'r'},
+        {"concurrency", required_argument, nullptr, 'c'},
+        {"duration", required_argument, nullptr, 'd'},
+        {"timeout", required_argument, nullptr, 't'},
+        {"report-interval", required_argument, nullptr, 'p'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+    int option;
+    while ((option = getopt_long(argc, argv, "i:D:r:c:d:t:p:h", longOptions, nullptr)) != -1)
+    {
+        switch (option)
+        {
+        case 'i':
+            options.device = optarg;
+            break;
+        case 'D':
+        {
+            options.doipHost = optarg;
+            const size_t colon = options.doipHost.rfind(':');
+            if (colon != string::npos && options.doipHost.find(':') == colon)
+            {
+                options.doipPort = uint16_t(atoi(options.doipHost.c_str() + colon + 1));
+                options.doipHost.resize(colon);
+            }
+            break;
+        }
+        case 'r':
+            options.rate = atof(optarg);
+            break;
+        case 'c':
+            options.concurrency = unsigned(atoi(optarg));
+            break;
+        case 'd':
+            options.duration = unsigned(atoi(optarg));
+            break;
+        case 't':
+            options.timeout = chrono::milliseconds(atoi(optarg));
+            break;
+        case 'p':
+            options.reportInterval = unsigned(atoi(optarg));
+            break;
+        default:
+            return false;
+        }
+    }
+    if (optind + 1 != argc || options.concurrency == 0 || options.rate < 0 || options.timeout.count() <= 0)
+    {
+        return false;
+    }
+    mixFile = argv[optind];
+    return true;
+}
+
+void stopHandler(int) noexcept
+{
+    isStopRequested = 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    string mixFile;
+    if (!parseOptions(argc, argv, options, mixFile))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    const vector<MixTarget> targets = readRequestMix(mixFile);
+    if (targets.empty())
+    {
+        cerr << "No requests in " << mixFile << endl;
+        return 1;
+    }
+
+    // the ISO-TP classes log every socket, only their errors are of interest
+    Logger::setLevel(LogLevel::ERROR);
+
+    unsigned totalWeight = 0;
+    for (const MixTarget& target : targets)
+    {
+        totalWeight += target.totalWeight;
+    }
+
+    Statistics total;
+    vector<unique_ptr<Statistics>> statistics;
+    vector<unique_ptr<LoadClient>> clients;
+    vector<thread> threads;
+    for (const MixTarget& target : targets)
+    {
+        statistics.push_back(std::make_unique<Statistics>());
+        Statistics* results[2] = {statistics.back().get(), &total};
+        // each client gets its share of the rate, weighted like the requests
+        const double clientRate = options.rate * target.totalWeight / totalWeight / options.concurrency;
+        const chrono::nanoseconds interval(clientRate > 0 ? int64_t(1e9 / clientRate) : 0);
+        for (unsigned i = 0; i < options.concurrency; ++i)
+        {
+            try
+            {
+                if (target.transport == MixTransport::CAN)
+                {
+                    clients.push_back(std::make_unique<CanClient>(target, options.device));
+                }
+                else if (!options.doipHost.empty())
+                {
+                    clients.push_back(std::make_unique<DoIPClient>(target, options));
+                }
+                else
+                {
+                    cerr << "Skipping " << target.getName() << ", no DoIP server given (--doip)" << endl;
+                    break;
+                }
+            }
+            catch (const exception&)
+            {
+                cerr << "Can not open the ISO-TP sockets of " << target.getName() << " on "
+                     << options.device << endl;
+                isStopRequested = 1;
+                break;
+            }
+            LoadClient* pClient = clients.back().get();
+            const uint32_t seed = uint32_t(threads.size() + 1);
+            threads.emplace_back([pClient, &target, results, interval, seed, &options]()
+            {
+                runClient(*pClient, target, results, interval, seed, options);
+            });
+        }
+    }
+
+    signal(SIGINT, stopHandler);
+    signal(SIGTERM, stopHandler);
+    const auto startedAt = chrono::steady_clock::now();
+    auto reportedAt = startedAt;
+    uint64_t reportedResponses = 0;
+    if (options.reportInterval > 0)
+    {
+        printf("%8s ", "time s");
+        printHeader();
+    }
+    while (!isStopRequested)
+    {
+        this_thread::sleep_for(chrono::milliseconds(100));
+        const auto now = chrono::steady_clock::now();
+        if (options.duration > 0 && now - startedAt >= chrono::seconds(options.duration))
+        {
+            break;
+        }
+        if (options.reportInterval > 0 && now - reportedAt >= chrono::seconds(options.reportInterval))
+        {
+            // the rate of the last interval, the other columns are totals
+            const uint64_t responses = total.responses.load(memory_order_relaxed);
+            const double seconds = chrono::duration<double>(now - reportedAt).count();
+            printf("%8.0f ", chrono::duration<double>(now - startedAt).count());
+            printStatistics("total", total, double(responses - reportedResponses) / seconds);
+            reportedAt = now;
+            reportedResponses = responses;
+        }
+    }
+    isStopRequested = 1;
+    for (thread& t : threads)
+    {
+        t.join();
+    }
+
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - startedAt).count();
+    printf("\n%.1f s, %zu clients\n", seconds, clients.size());
+    printHeader();
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        printStatistics(targets[i].getName(), *statistics[i], double(statistics[i]->responses) / seconds);
+    }
+    printStatistics("total", total, double(total.responses) / seconds);
+    return total.timeouts + total.errors > 0 ? 2 : 0;
+}
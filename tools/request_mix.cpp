@@ -0,0 +1,184 @@
+/**
+ * @file request_mix.cpp
+ *
+ * Reads the request mix of the load generator. Each line holds one request
+ * with its relative weight, the transport, the ECU and the request bytes:
+ *
+ *     # weight  transport  ECU (request:response ID or logical address)  request
+ *     10        can        7E0:7E8                                         22 F1 90
+ *     1         can        18DA01F1:18DAF101                               19 02 FF
+ *     5         doip       0x0E80                                          22 F1 86
+ *
+ * Empty lines and everything after a `#` are ignored. The CAN IDs and the
+ * logical addresses are hex, with or without the `0x` prefix.
+ */
+
+#include "request_mix.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+/**
+ * Parses a hex number with an optional `0x` prefix.
+ *
+ * @param text: the number, e.g. "7E0" or "0x0E80"
+ * @param value: receives the parsed number
+ * @return true on success, false if the text is no hex number
+ */
+static bool parseHex(const string& text, uint32_t& value) noexcept
+{
+    if (text.empty() || text.size() > 10)
+    {
+        return false;
+    }
+    char* pEnd = nullptr;
+    const unsigned long number = strtoul(text.c_str(), &pEnd, 16);
+    if (*pEnd != '\0' || number > 0xFFFFFFFFul)
+    {
+        return false;
+    }
+    value = uint32_t(number);
+    return true;
+}
+
+/**
+ * @return the target name as used in the reports, e.g. "can 7E0:7E8"
+ */
+string MixTarget::getName() const
+{
+    char name[32];
+    if (transport == MixTransport::CAN)
+    {
+        snprintf(name, sizeof(name), "can %X:%X", requestId, responseId);
+    }
+    else
+    {
+        snprintf(name, sizeof(name), "doip %04X", requestId);
+    }
+    return name;
+}
+
+/**
+ * Picks a request according to the weights.
+ *
+ * @param random: an uniformly distributed random number
+ * @return the picked request
+ */
+const MixEntry& MixTarget::pick(uint32_t random) const noexcept
+{
+    unsigned value = random % totalWeight;
+    for (const MixEntry& entry : entries)
+    {
+        if (value < entry.weight)
+        {
+            return entry;
+        }
+        value -= entry.weight;
+    }
+    return entries.back();
+}
+
+/**
+ * Reads the request mix from the given file.
+ *
+ * @param mixFile: the path of the mix file
+ * @return the requests grouped by their targets, empty on an error
+ * @see parseRequestMix()
+ */
+vector<MixTarget> readRequestMix(const string& mixFile)
+{
+    ifstream mix(mixFile);
+    if (!mix)
+    {
+        cerr << "Can not open the request mix " << mixFile << endl;
+        return {};
+    }
+    return parseRequestMix(mix, mixFile);
+}
+
+/**
+ * Parses a request mix, see the file description for the format. Invalid
+ * lines are reported on `cerr` and make the whole mix invalid, since a
+ * partially read mix would silently distort the distribution.
+ *
+ * @param mix: the stream to read
+ * @param mixFile: the file name used in the error messages
+ * @return the requests grouped by their targets, empty on an error
+ */
+vector<MixTarget> parseRequestMix(istream& mix, const string& mixFile)
+{
+    vector<MixTarget> targets;
+    string line;
+    unsigned lineNumber = 0;
+    while (getline(mix, line))
+    {
+        ++lineNumber;
+        line = line.substr(0, line.find('#'));
+        istringstream fields(line);
+        string weightText;
+        if (!(fields >> weightText))
+        {
+            continue;
+        }
+
+        string transportText;
+        string ecu;
+        fields >> transportText >> ecu;
+        MixTarget target;
+        char* pEnd = nullptr;
+        const unsigned long weight = strtoul(weightText.c_str(), &pEnd, 10);
+        bool isValid = *pEnd == '\0' && weight > 0 && weight <= 1000000;
+        if (transportText == "can")
+        {
+            target.transport = MixTransport::CAN;
+            const size_t colon = ecu.find(':');
+            isValid = isValid && colon != string::npos
+                && parseHex(ecu.substr(0, colon), target.requestId)
+                && parseHex(ecu.substr(colon + 1), target.responseId);
+        }
+        else if (transportText == "doip")
+        {
+            target.transport = MixTransport::DOIP;
+            target.responseId = 0;
+            isValid = isValid && parseHex(ecu, target.requestId) && target.requestId <= 0xFFFF;
+        }
+        else
+        {
+            isValid = false;
+        }
+
+        MixEntry entry;
+        entry.weight = unsigned(weight);
+        string byteText;
+        while (isValid && fields >> byteText)
+        {
+            uint32_t byte = 0;
+            isValid = byteText.size() <= 2 && parseHex(byteText, byte);
+            entry.request.push_back(uint8_t(byte));
+            entry.text += (entry.text.empty() ? "" : " ") + byteText;
+        }
+        if (!isValid || entry.request.empty())
+        {
+            cerr << mixFile << ":" << lineNumber << ": invalid request: " << line << endl;
+            return {};
+        }
+
+        auto it = targets.begin();
+        while (it != targets.end() && (it->transport != target.transport
+            || it->requestId != target.requestId || it->responseId != target.responseId))
+        {
+            ++it;
+        }
+        if (it == targets.end())
+        {
+            it = targets.insert(targets.end(), target);
+        }
+        it->totalWeight += entry.weight;
+        it->entries.push_back(move(entry));
+    }
+    return targets;
+}
@@ -0,0 +1,50 @@
+/**
+ * @file request_mix.h
+ *
+ */
+
+#ifndef REQUEST_MIX_H
+#define REQUEST_MIX_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+enum class MixTransport
+{
+    CAN,
+    DOIP
+};
+
+/**
+ * One request of a mix, e.g. `10 can 7E0:7E8 22 F1 90`.
+ */
+struct MixEntry
+{
+    unsigned weight;
+    std::vector<std::uint8_t> request;
+    std::string text; ///< the request as written in the mix file
+};
+
+/**
+ * All requests of a mix which are sent to the same ECU. The load generator
+ * runs its clients per target, so each target gets the share of the total
+ * rate given by its weight.
+ */
+struct MixTarget
+{
+    MixTransport transport;
+    std::uint32_t requestId; ///< CAN ID of the requests or the DoIP target address
+    std::uint32_t responseId; ///< CAN ID of the responses, not used for DoIP
+    std::vector<MixEntry> entries;
+    unsigned totalWeight = 0;
+
+    std::string getName() const;
+    const MixEntry& pick(std::uint32_t random) const noexcept;
+};
+
+std::vector<MixTarget> readRequestMix(const std::string& mixFile);
+std::vector<MixTarget> parseRequestMix(std::istream& mix, const std::string& mixFile);
+
+#endif /* REQUEST_MIX_H */
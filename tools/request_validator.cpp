@@ -0,0 +1,284 @@
+/**
+ * @file request_validator.cpp
+ *
+ * Replays the requests of a recorded trace against the `Raw` table of a
+ * simulation, without a CAN device or a running simulator, and reports:
+ *
+ * - the coverage, i.e. which entries of the table were hit how often
+ * - the requests no entry matches
+ * - the ambiguous requests, which match several entries of the same
+ *   priority, so only the definition order decides (see
+ *   `RequestByteTreeNode::getPriority()`)
+ *
+ *     request_validator -e Main -j 8 config.lua trace.txt
+ *
+ * With `-s 0x03` the `Raw` table of that session is validated, see
+ * `EcuLuaScript::getRawRequestMatcher()`.
+ *
+ * The trace lists one request per line as hex bytes, e.g. `22 F1 90`,
+ * anything after a `#` is ignored. The requests are matched by the compiled
+ * `Raw` table on all threads of a pool, Lua functions are not called.
+ */
+
+#include "ecu_lua_script.h"
+#include "logger.h"
+#include "thread_pool.h"
+#include <getopt.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+
+struct Options
+{
+    string ecuIdent = "Main";
+    uint8_t session = UdsSession::DEFAULT;
+    unsigned threads = ThreadPool::getDefaultThreadCount();
+    unsigned listLimit = 20; ///< the max. number of listed requests per category
+};
+
+/// the requests of the trace and their line numbers
+struct Trace
+{
+    vector<vector<uint8_t>> requests;
+    vector<unsigned> lineNumbers;
+};
+
+void printUsage(const char* program) noexcept
+{
+    fprintf(stderr,
+            "Usage: %s [options] <Lua script> <trace>\n"
+            "  -e, --ecu <ident>    the ECU table in the script (default: Main)\n"
+            "  -s, --session <id>   the session of the Raw table, e.g. 0x03 (default: 0x01)\n"
+            "  -j, --threads <n>    matching threads (default: %u)\n"
+            "  -n, --list <n>       the max. number of listed requests per category (default: 20)\n",
+            program, ThreadPool::getDefaultThreadCount());
+}
+
+bool parseOptions(int argc, char** argv, Options& options, string& luaScript, string& traceFile) noexcept
+{
+    const struct option longOptions[] = {
+        {"ecu", required_argument, nullptr, 'e'},
+        {"session", required_argument, nullptr, 's'},
+        {"threads", required_argument, nullptr, 'j'},
+        {"list", required_argument, nullptr, 'n'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+    int option;
+    while ((option = getopt_long(argc, argv, "e:s:j:n:h", longOptions, nullptr)) != -1)
+    {
+        switch (option)
+        {
+        case 'e':
+            options.ecuIdent = optarg;
+            break;
+        case 's':
+            options.session = uint8_t(strtoul(optarg, nullptr, 0));
+            break;
+        case 'j':
+            options.threads = unsigned(atoi(optarg));
+            break;
+        case 'n':
+            options.listLimit = unsigned(atoi(optarg));
+            break;
+        default:
+            return false;
+        }
+    }
+    if (optind + 2 != argc || options.threads == 0)
+    {
+        return false;
+    }
+    luaScript = argv[optind];
+    traceFile = argv[optind + 1];
+    return true;
+}
+
+/**
+ * Reads the trace. Invalid lines are reported on `cerr` and skipped, so one
+ * garbled line of a long recording does not void the whole run.
+ */
+bool readTrace(const string& traceFile, Trace& trace)
+{
+    ifstream in(traceFile);
+    if (!in)
+    {
+        cerr << "Can not open " << traceFile << endl;
+        return false;
+    }
+    string line;
+    unsigned lineNumber = 0;
+    while (getline(in, line))
+    {
+        ++lineNumber;
+        istringstream fields(line.substr(0, line.find('#')));
+        vector<uint8_t> request;
+        string byteText;
+        bool isValid = true;
+        while (isValid && fields >> byteText)
+        {
+            char* pEnd = nullptr;
+            const unsigned long byte = strtoul(byteText.c_str(), &pEnd, 16);
+            isValid = byteText.size() <= 2 && *pEnd == '\0';
+            request.push_back(uint8_t(byte));
+        }
+        if (!isValid)
+        {
+            cerr << traceFile << ":" << lineNumber << ": invalid request: " << line << endl;
+        }
+        else if (!request.empty())
+        {
+            trace.requests.push_back(move(request));
+            trace.lineNumbers.push_back(lineNumber);
+        }
+    }
+    return true;
+}
+
+string toHex(const vector<uint8_t>& bytes)
+{
+    string text;
+    char byteText[4];
+    for (const uint8_t byte : bytes)
+    {
+        snprintf(byteText, sizeof(byteText), text.empty() ? "%02X" : " %02X", byte);
+        text += byteText;
+    }
+    return text;
+}
+
+/**
+ * Prints the distinct requests of a category with their number and the line
+ * of their first occurrence.
+ */
+void printRequests(const char* title, const map<vector<uint8_t>, pair<size_t, unsigned>>& requests,
+                   const map<vector<uint8_t>, string>& keys, unsigned listLimit)
+{
+    cout << title << ": " << requests.size() << " distinct" << endl;
+    unsigned listed = 0;
+    for (const auto& request : requests)
+    {
+        if (listed++ == listLimit)
+        {
+            cout << "    ..." << endl;
+            break;
+        }
+        cout << "    " << toHex(request.first) << "  (" << request.second.first << "x, line "
+             << request.second.second << ")";
+        auto key = keys.find(request.first);
+        if (key != keys.end())
+        {
+            cout << " -> \"" << key->second << "\"";
+        }
+        cout << endl;
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    string luaScript;
+    string traceFile;
+    if (!parseOptions(argc, argv, options, luaScript, traceFile))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    Trace trace;
+    if (!readTrace(traceFile, trace))
+    {
+        return 1;
+    }
+
+    Logger::setLevel(LogLevel::ERROR);
+    shared_ptr<const LuaRequestMatcher> pMatcher;
+    try
+    {
+        EcuLuaScript script(options.ecuIdent, luaScript);
+        pMatcher = script.getRawRequestMatcher(options.session);
+    }
+    catch (const exception& e)
+    {
+        cerr << "Can not load " << luaScript << ": " << e.what() << endl;
+        return 1;
+    }
+
+    const auto start = chrono::steady_clock::now();
+    ThreadPool threadPool(options.threads);
+    const vector<LuaRequestMatcher::MatchResult> results = pMatcher->matchRequests(trace.requests, threadPool);
+    const chrono::duration<double> duration = chrono::steady_clock::now() - start;
+
+    vector<size_t> hits(pMatcher->getLeafCount(), 0);
+    size_t matched = 0;
+    map<vector<uint8_t>, pair<size_t, unsigned>> unmatched;
+    map<vector<uint8_t>, pair<size_t, unsigned>> ambiguous;
+    map<vector<uint8_t>, string> ambiguousKeys;
+    auto count = [&trace](map<vector<uint8_t>, pair<size_t, unsigned>>& requests, size_t i)
+    {
+        auto inserted = requests.emplace(trace.requests[i], make_pair(size_t(0), trace.lineNumbers[i]));
+        ++inserted.first->second.first;
+    };
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const LuaRequestMatcher::MatchResult& result = results[i];
+        if (!result.response)
+        {
+            count(unmatched, i);
+            continue;
+        }
+        ++matched;
+        ++hits[result.rank];
+        if (result.isAmbiguous)
+        {
+            count(ambiguous, i);
+            ambiguousKeys[trace.requests[i]] = result.response->tableKey;
+        }
+    }
+
+    size_t hitEntries = 0;
+    for (const size_t hitCount : hits)
+    {
+        hitEntries += hitCount > 0 ? 1 : 0;
+    }
+    cout << "Requests: " << results.size() << ", matched: " << matched << ", unmatched: "
+         << results.size() - matched << " (" << duration.count() << " s on " << options.threads
+         << " threads)" << endl;
+    cout << "Coverage: " << hitEntries << " of " << hits.size() << " Raw entries hit";
+    if (!hits.empty())
+    {
+        cout << " (" << 100.0 * double(hitEntries) / double(hits.size()) << " %)";
+    }
+    cout << endl;
+    printRequests("Unmatched requests", unmatched, {}, options.listLimit);
+    printRequests("Ambiguous requests", ambiguous, ambiguousKeys, options.listLimit);
+
+    cout << "Entries not hit:" << endl;
+    unsigned listed = 0;
+    for (size_t rank = 0; rank < hits.size(); ++rank)
+    {
+        if (hits[rank] > 0)
+        {
+            continue;
+        }
+        if (listed++ == options.listLimit)
+        {
+            cout << "    ..." << endl;
+            break;
+        }
+        cout << "    \"" << pMatcher->getLeaf(rank).tableKey << "\"" << endl;
+    }
+    return unmatched.empty() && ambiguous.empty() ? 0 : 2;
+}